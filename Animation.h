@@ -0,0 +1,531 @@
+#ifndef HEADER_ANIMATION_H
+#define HEADER_ANIMATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/wide.hpp>
+#include <glm/gtx/wide_quaternion.hpp>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "JobSystem.h"
+#include "Log.h"
+
+/****************************************************************************
+* ANIMATION: compressed clips, sampled in parallel                         *
+****************************************************************************/
+
+/* AnimationClip: the rotation and translation of each joint of a skeleton
+* over time, each joint a track of keys. A clip is built from a rotation
+* and translation for every joint in every frame, of which only the keys
+* are kept which the interpolation between their neighbours does not
+* reproduce within ANIMATION_ANGLE_TOLERANCE and
+* ANIMATION_DISTANCE_TOLERANCE, so a joint which holds still or moves
+* evenly needs just a few. The keys are quantized to 8 bytes each: a
+* rotation keeps its three smallest components as 16 bit integers and the
+* index of the largest one, which follows from them since the quaternion
+* has unit length; a translation keeps its components as 16 bit integers
+* within the bounds of its track. The frame of a key is in the same 8
+* bytes.
+* AnimationCursor: where the sampling of a clip stands, the key of each
+* track at or before the time last sampled. Sampling moves it forward
+* key by key, so as long as the time advances, finding the keys around it
+* takes constant time per track on average; it starts over when the clip
+* loops. The keys around the time of all tracks are decoded into arrays
+* and interpolated at once by slerpQuats() of glm/gtx/wide_quaternion.hpp.
+* Animator: characters, each playing two clips at its own offset and
+* blending between them with nlerpQuats(), sampled in parallel on the job
+* system, ANIMATION_GRAIN characters per job. Every ANIMATION_IDLE_EVERY-th
+* character stands still in its pose; a character is only sampled again
+* when its time moved, and counts up its version when it is, so whatever
+* is derived from its pose can be kept while the version stays the same. */
+#define ANIMATION_MAX_TRACKS 64		/* joints of a skeleton */
+#define ANIMATION_MAX_FRAMES 16384	/* frames of a clip, 14 bits */
+#define ANIMATION_ANGLE_TOLERANCE 0.002f	/* radians a reduced rotation may be off */
+#define ANIMATION_DISTANCE_TOLERANCE 0.001f	/* and a translation */
+#define ANIMATION_GRAIN 32		/* characters per job */
+#define ANIMATION_IDLE_EVERY 4		/* characters, one of which stands still */
+#define ANIMATION_CLIPS 2		/* played by each character */
+#define ANIMATION_DEMO_JOINTS 8		/* of the clips of initDemo() */
+#define ANIMATION_DEMO_FRAMES 121	/* 4 seconds at 30 Hz, the last is the first again */
+
+/* the frame of a key and the index of the component a rotation leaves out */
+#define ANIMATION_KEY_FRAME(k) ((int)((k).frame & 0x3fffu))
+#define ANIMATION_KEY_LARGEST(k) ((int)((k).frame >> 14))
+
+typedef struct {
+	unsigned short c[3];	/* the other components, or x, y and z in the bounds of the track */
+	unsigned short frame;	/* bits 0-13: the frame, 14-15: the component left out of a rotation */
+} AnimationKey;
+
+typedef struct {
+	int first, count;	/* the keys of the track */
+} AnimationTrack;
+
+/* 1 / sqrt(2), the largest magnitude of a component which is not the largest */
+#define ANIMATION_SMALLEST_MAX 0.70710678f
+
+static unsigned short animationQuantize(float v, float lo, float scale)
+{
+	float q = (v - lo) * scale + 0.5f;
+	if (q < 0.0f)
+		q = 0.0f;
+	if (q > 65535.0f)
+		q = 65535.0f;
+	return (unsigned short)q;
+}
+
+/* Quantize the unit quaternion q into key k at frame. */
+static void animationEncodeRotation(const glm::quat &q, int frame, AnimationKey *k)
+{
+	float v[4] = {q.x, q.y, q.z, q.w};
+	int i, j, largest = 0;
+	for (i = 1; i < 4; i++)
+		if (fabsf(v[i]) > fabsf(v[largest]))
+			largest = i;
+	/* q and -q are the same rotation, the largest is made positive */
+	float sign = (v[largest] < 0.0f) ? -1.0f : 1.0f;
+	for (i = 0, j = 0; i < 4; i++)
+		if (i != largest)
+			k->c[j++] = animationQuantize(sign * v[i], -ANIMATION_SMALLEST_MAX, 65535.0f / (2.0f * ANIMATION_SMALLEST_MAX));
+	k->frame = (unsigned short)(frame | (largest << 14));
+}
+
+static glm::quat animationDecodeRotation(const AnimationKey &k)
+{
+	const float scale = 2.0f * ANIMATION_SMALLEST_MAX / 65535.0f;
+	float v[4], sum = 0.0f;
+	int i, j, largest = ANIMATION_KEY_LARGEST(k);
+	for (i = 0, j = 0; i < 4; i++) {
+		if (i == largest)
+			continue;
+		v[i] = (float)k.c[j++] * scale - ANIMATION_SMALLEST_MAX;
+		sum += v[i] * v[i];
+	}
+	v[largest] = sqrtf(glm::max(1.0f - sum, 0.0f));
+	return glm::quat(v[3], v[0], v[1], v[2]);
+}
+
+typedef struct {
+	int tracks;		/* joints */
+	int frames;
+	float rate;		/* frames per second */
+	AnimationTrack *rotationTracks, *translationTracks;
+	AnimationKey *rotationKeys, *translationKeys;
+	glm::vec3 *translationMin, *translationStep;	/* per track, the bounds of the quantization */
+	int rotationKeyCount, translationKeyCount;
+	void *block;		/* the allocation holding all arrays */
+	size_t bytes;		/* of block */
+
+	void clear()
+	{
+		tracks = frames = 0;
+		rate = 30.0f;
+		block = NULL;
+		bytes = 0;
+		rotationKeyCount = translationKeyCount = 0;
+	}
+
+	/* Whether the rotations of track j between frames s and e are all
+	* within the tolerance of the interpolation between those two. */
+	static bool rotationsFit(const glm::quat *rotations, int tracks, int j, int s, int e)
+	{
+		const float cosHalf = cosf(0.5f * ANIMATION_ANGLE_TOLERANCE);
+		glm::quat a = rotations[s * tracks + j], b = rotations[e * tracks + j];
+		int f;
+		for (f = s + 1; f < e; f++) {
+			glm::quat q = glm::slerp(a, b, (float)(f - s) / (float)(e - s));
+			if (fabsf(glm::dot(q, rotations[f * tracks + j])) < cosHalf)
+				return false;
+		}
+		return true;
+	}
+
+	static bool translationsFit(const glm::vec3 *translations, int tracks, int j, int s, int e)
+	{
+		glm::vec3 a = translations[s * tracks + j], b = translations[e * tracks + j];
+		int f;
+		for (f = s + 1; f < e; f++) {
+			glm::vec3 p = glm::mix(a, b, (float)(f - s) / (float)(e - s));
+			if (glm::length(p - translations[f * tracks + j]) > ANIMATION_DISTANCE_TOLERANCE)
+				return false;
+		}
+		return true;
+	}
+
+	/* Reduce track j to the frames in keys, the first and the last always
+	* among them; rotations selects which of the two is reduced.
+	* Returns the number of keys. */
+	static int reduce(const glm::quat *rotations, const glm::vec3 *translations, int tracks, int frames, int j,
+		int *keys)
+	{
+		int n = 0, s = 0;
+		keys[n++] = 0;
+		while (s < frames - 1) {
+			int e = s + 1;
+			while (e + 1 < frames && (rotations ? rotationsFit(rotations, tracks, j, s, e + 1) :
+					translationsFit(translations, tracks, j, s, e + 1)))
+				e++;
+			keys[n++] = e;
+			s = e;
+		}
+		return n;
+	}
+
+	/* Build the clip from rotations and translations of tracks joints in
+	* each of frames frames, stored frame by frame, at rate frames per
+	* second.
+	* Returns true if successfull and false in case of an error. */
+	bool build(const glm::quat *rotations, const glm::vec3 *translations, int trackCount, int frameCount, float fps)
+	{
+		int j, k, *keys;
+		int *counts;
+
+		clear();
+		if (trackCount < 1 || trackCount > ANIMATION_MAX_TRACKS || frameCount < 2 || frameCount > ANIMATION_MAX_FRAMES) {
+			warn("animation: a clip of %d tracks and %d frames is not supported", trackCount, frameCount);
+			return false;
+		}
+		tracks = trackCount;
+		frames = frameCount;
+		rate = fps;
+		/* the frames of the keys of all tracks, rotations first */
+		keys = (int*)malloc(sizeof(int) * (size_t)(2 * tracks) * (size_t)frames);
+		counts = (int*)malloc(sizeof(int) * (size_t)(2 * tracks));
+		if (!keys || !counts) {
+			free(keys);
+			free(counts);
+			warn("animation: failed to allocate a clip of %d frames", frames);
+			return false;
+		}
+		for (j = 0; j < tracks; j++) {
+			counts[j] = reduce(rotations, NULL, tracks, frames, j, keys + j * frames);
+			counts[tracks + j] = reduce(NULL, translations, tracks, frames, j, keys + (tracks + j) * frames);
+			rotationKeyCount += counts[j];
+			translationKeyCount += counts[tracks + j];
+		}
+
+		bytes = sizeof(AnimationTrack) * 2 * tracks + sizeof(glm::vec3) * 2 * tracks +
+			sizeof(AnimationKey) * (size_t)(rotationKeyCount + translationKeyCount);
+		block = malloc(bytes);
+		if (!block) {
+			free(keys);
+			free(counts);
+			warn("animation: failed to allocate %u bytes of keys", (unsigned)bytes);
+			clear();
+			return false;
+		}
+		rotationTracks = (AnimationTrack*)block;
+		translationTracks = rotationTracks + tracks;
+		translationMin = (glm::vec3*)(translationTracks + tracks);
+		translationStep = translationMin + tracks;
+		rotationKeys = (AnimationKey*)(translationStep + tracks);
+		translationKeys = rotationKeys + rotationKeyCount;
+
+		int r = 0, t = 0;
+		for (j = 0; j < tracks; j++) {
+			const int *rk = keys + j * frames, *tk = keys + (tracks + j) * frames;
+			rotationTracks[j].first = r;
+			rotationTracks[j].count = counts[j];
+			for (k = 0; k < counts[j]; k++)
+				animationEncodeRotation(glm::normalize(rotations[rk[k] * tracks + j]), rk[k], &rotationKeys[r++]);
+
+			glm::vec3 lo(1e30f), hi(-1e30f);
+			for (k = 0; k < counts[tracks + j]; k++) {
+				lo = glm::min(lo, translations[tk[k] * tracks + j]);
+				hi = glm::max(hi, translations[tk[k] * tracks + j]);
+			}
+			translationMin[j] = lo;
+			translationStep[j] = (hi - lo) / 65535.0f;
+			translationTracks[j].first = t;
+			translationTracks[j].count = counts[tracks + j];
+			for (k = 0; k < counts[tracks + j]; k++) {
+				glm::vec3 p = translations[tk[k] * tracks + j];
+				AnimationKey *key = &translationKeys[t++];
+				int c;
+				for (c = 0; c < 3; c++)
+					key->c[c] = animationQuantize(p[c], lo[c], (hi[c] > lo[c]) ? 65535.0f / (hi[c] - lo[c]) : 0.0f);
+				key->frame = (unsigned short)tk[k];
+			}
+		}
+		free(keys);
+		free(counts);
+		return true;
+	}
+
+	void destroy()
+	{
+		free(block);
+		clear();
+	}
+
+	/* The bytes the keys would take without compression. */
+	size_t rawBytes() const
+	{
+		return (sizeof(glm::quat) + sizeof(glm::vec3)) * (size_t)tracks * (size_t)frames;
+	}
+
+	glm::vec3 decodeTranslation(int j, const AnimationKey &k) const
+	{
+		return translationMin[j] + translationStep[j] * glm::vec3((float)k.c[0], (float)k.c[1], (float)k.c[2]);
+	}
+} AnimationClip;
+
+typedef struct {
+	int *rotation, *translation;	/* per track, the key at or before frame */
+	float frame;		/* last sampled */
+
+	void reset(int tracks)
+	{
+		memset(rotation, 0, sizeof(int) * tracks);
+		memset(translation, 0, sizeof(int) * tracks);
+		frame = 0.0f;
+	}
+} AnimationCursor;
+
+/* Find the keys around frame in the track of keys, starting at *cursor,
+* which is left at the one before. Returns the interpolation weight of the
+* one after, which is stored in *next. */
+static float animationSeek(const AnimationKey *keys, int count, int *cursor, float frame, int *next)
+{
+	int k = *cursor;
+	while (k + 1 < count && (float)ANIMATION_KEY_FRAME(keys[k + 1]) <= frame)
+		k++;
+	*cursor = k;
+	*next = (k + 1 < count) ? k + 1 : k;
+	float f0 = (float)ANIMATION_KEY_FRAME(keys[k]), f1 = (float)ANIMATION_KEY_FRAME(keys[*next]);
+	return (f1 > f0) ? (frame - f0) / (f1 - f0) : 0.0f;
+}
+
+/* Sample clip at time seconds, looping, into the rotations and
+* translations of its tracks, moving cursor along. */
+static void animationSample(const AnimationClip *clip, AnimationCursor *cursor, double time, glm::quat *rotations,
+	glm::vec3 *translations)
+{
+	glm::quat a[ANIMATION_MAX_TRACKS], b[ANIMATION_MAX_TRACKS];
+	float t[ANIMATION_MAX_TRACKS];
+	float length = (float)(clip->frames - 1);
+	float frame = (float)fmod(time * clip->rate, (double)length);
+	int j, next;
+
+	if (frame < 0.0f)
+		frame += length;
+	/* looped, the keys are searched from the start again */
+	if (frame < cursor->frame)
+		cursor->reset(clip->tracks);
+	cursor->frame = frame;
+	for (j = 0; j < clip->tracks; j++) {
+		const AnimationTrack *track = &clip->rotationTracks[j];
+		const AnimationKey *keys = clip->rotationKeys + track->first;
+		t[j] = animationSeek(keys, track->count, &cursor->rotation[j], frame, &next);
+		a[j] = animationDecodeRotation(keys[cursor->rotation[j]]);
+		b[j] = animationDecodeRotation(keys[next]);
+	}
+	glm::slerpQuats(a, b, t, rotations, (size_t)clip->tracks);
+	for (j = 0; j < clip->tracks; j++) {
+		const AnimationTrack *track = &clip->translationTracks[j];
+		const AnimationKey *keys = clip->translationKeys + track->first;
+		float w = animationSeek(keys, track->count, &cursor->translation[j], frame, &next);
+		translations[j] = glm::mix(clip->decodeTranslation(j, keys[cursor->translation[j]]),
+			clip->decodeTranslation(j, keys[next]), w);
+	}
+}
+
+/* Blend the poses a and b of n joints by weight, 0 is a, into r and t,
+* which may be those of a. */
+static void animationBlend(const glm::quat *ra, const glm::vec3 *ta, const glm::quat *rb, const glm::vec3 *tb,
+	float weight, int n, glm::quat *r, glm::vec3 *t)
+{
+	float w[ANIMATION_MAX_TRACKS];
+	int j;
+	for (j = 0; j < n; j++) {
+		w[j] = weight;
+		t[j] = glm::mix(ta[j], tb[j], weight);
+	}
+	glm::nlerpQuats(ra, rb, w, r, (size_t)n);
+}
+
+static void animatorSampleChunk(void *user, int begin, int end);
+
+typedef struct {
+	AnimationClip clips[ANIMATION_CLIPS];
+	int count;		/* characters */
+	int tracks;		/* joints of each, the same in all clips */
+	float *offsets;		/* per character, seconds ahead of the time */
+	float *speeds;		/* per character, 0 standing still */
+	double *sampled;	/* per character, its time when last sampled */
+	unsigned int *versions;	/* per character, counts the poses sampled, 0 before the first */
+	AnimationCursor *cursors;	/* ANIMATION_CLIPS per character */
+	glm::mat4 *joints;	/* count * tracks, the local matrix of each joint */
+	void *block;		/* the allocation holding the arrays above */
+	double time;		/* of the current update() */
+
+	void clear()
+	{
+		int i;
+		for (i = 0; i < ANIMATION_CLIPS; i++)
+			clips[i].clear();
+		count = tracks = 0;
+		block = NULL;
+		joints = NULL;
+		time = 0.0;
+	}
+
+	/* Set up n characters playing clips, which must all have the same
+	* tracks, each at an offset of its own.
+	* Returns true if successfull and false in case of an error. */
+	bool initCharacters(int n)
+	{
+		int i, c;
+		tracks = clips[0].tracks;
+		for (c = 1; c < ANIMATION_CLIPS; c++)
+			if (clips[c].tracks != tracks) {
+				warn("animation: the clips have different skeletons");
+				return false;
+			}
+		size_t cursorKeys = sizeof(int) * 2 * (size_t)tracks;
+		block = malloc((sizeof(glm::mat4) * tracks + sizeof(double) + 2 * sizeof(float) + sizeof(unsigned int) +
+			ANIMATION_CLIPS * (sizeof(AnimationCursor) + cursorKeys)) * (size_t)n);
+		if (!block) {
+			warn("animation: failed to allocate %d characters", n);
+			return false;
+		}
+		count = n;
+		joints = (glm::mat4*)block;
+		sampled = (double*)(joints + (size_t)n * tracks);
+		cursors = (AnimationCursor*)(sampled + n);
+		int *keys = (int*)(cursors + (size_t)n * ANIMATION_CLIPS);
+		offsets = (float*)(keys + (size_t)n * ANIMATION_CLIPS * 2 * tracks);
+		speeds = offsets + n;
+		versions = (unsigned int*)(speeds + n);
+		unsigned int seed = 11;
+		for (i = 0; i < n * ANIMATION_CLIPS; i++) {
+			cursors[i].rotation = keys + i * 2 * tracks;
+			cursors[i].translation = cursors[i].rotation + tracks;
+			cursors[i].reset(tracks);
+		}
+		for (i = 0; i < n; i++) {
+			seed = seed * 1664525u + 1013904223u;
+			offsets[i] = (float)(seed >> 8) / 16777216.0f * 8.0f;
+			speeds[i] = (i % ANIMATION_IDLE_EVERY == ANIMATION_IDLE_EVERY - 1) ? 0.0f : 1.0f;
+			sampled[i] = 0.0;
+			versions[i] = 0;
+		}
+		return true;
+	}
+
+	/* Build the clips of a chain of ANIMATION_DEMO_JOINTS joints, one
+	* swaying and one twisting, each holding still for a while, and n
+	* characters playing them.
+	* Returns true if successfull and false in case of an error. */
+	bool initDemo(int n)
+	{
+		const int joints = ANIMATION_DEMO_JOINTS, frames = ANIMATION_DEMO_FRAMES;
+		glm::quat *r = (glm::quat*)malloc(sizeof(glm::quat) * joints * frames);
+		glm::vec3 *t = (glm::vec3*)malloc(sizeof(glm::vec3) * joints * frames);
+		int c, f, j;
+		size_t raw = 0, compressed = 0;
+
+		clear();
+		if (!r || !t) {
+			free(r);
+			free(t);
+			warn("animation: failed to allocate the demo clips");
+			return false;
+		}
+		for (c = 0; c < ANIMATION_CLIPS; c++) {
+			for (f = 0; f < frames; f++) {
+				/* one cycle over the clip, so it loops; the outer
+				* joints rest in the first half of the sway */
+				float phase = glm::two_pi<float>() * (float)f / (float)(frames - 1);
+				for (j = 0; j < joints; j++) {
+					float angle;
+					glm::vec3 axis;
+					if (c == 0) {
+						angle = (j >= joints / 2 && f < frames / 2) ? 0.0f : 0.4f * sinf(phase + 0.5f * j);
+						axis = glm::vec3(0.0f, 0.0f, 1.0f);
+					} else {
+						angle = 0.6f * sinf(2.0f * phase + (float)j);
+						axis = glm::vec3(0.0f, 1.0f, 0.0f);
+					}
+					r[f * joints + j] = glm::angleAxis(angle, axis);
+					t[f * joints + j] = glm::vec3(0.0f, (j == 0) ? 0.1f * sinf(phase) : 0.0f, 0.0f);
+				}
+			}
+			if (!clips[c].build(r, t, joints, frames, 30.0f)) {
+				free(r);
+				free(t);
+				destroy();
+				return false;
+			}
+			raw += clips[c].rawBytes();
+			compressed += clips[c].bytes;
+			info("animation: clip %d keeps %d of %d rotation and %d of %d translation keys", c,
+				clips[c].rotationKeyCount, joints * frames, clips[c].translationKeyCount, joints * frames);
+		}
+		free(r);
+		free(t);
+		info("animation: clips of %u bytes, %u uncompressed", (unsigned)compressed, (unsigned)raw);
+		if (!initCharacters(n)) {
+			destroy();
+			return false;
+		}
+		info("animation: %d characters of %d joints", count, tracks);
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < ANIMATION_CLIPS; i++)
+			clips[i].destroy();
+		free(block);
+		clear();
+	}
+
+	/* Sample the characters in [begin, end) at time: both clips, blended
+	* by a weight which goes back and forth, into their joint matrices.
+	* Those whose own time did not move keep their pose and version. */
+	void sampleRange(int begin, int end)
+	{
+		glm::quat r[ANIMATION_CLIPS][ANIMATION_MAX_TRACKS];
+		glm::vec3 t[ANIMATION_CLIPS][ANIMATION_MAX_TRACKS];
+		int i, j;
+
+		for (i = begin; i < end; i++) {
+			double local = time * speeds[i] + offsets[i];
+			if (versions[i] && local == sampled[i])
+				continue;
+			sampled[i] = local;
+			versions[i]++;
+			animationSample(&clips[0], &cursors[i * ANIMATION_CLIPS], local, r[0], t[0]);
+			animationSample(&clips[1], &cursors[i * ANIMATION_CLIPS + 1], local, r[1], t[1]);
+			float weight = 0.5f + 0.5f * (float)sin(0.5 * local);
+			animationBlend(r[0], t[0], r[1], t[1], weight, tracks, r[0], t[0]);
+			glm::mat4 *m = joints + (size_t)i * tracks;
+			glm::rotationMatrices(r[0], m, (size_t)tracks);
+			for (j = 0; j < tracks; j++)
+				m[j][3] = glm::vec4(t[0][j], 1.0f);
+		}
+	}
+
+	/* Sample all characters at time seconds, in parallel on jobs if
+	* given. Returns when all joint matrices are written. */
+	void update(double seconds, JobSystem *jobs)
+	{
+		time = seconds;
+		if (jobs)
+			jobs->run(animatorSampleChunk, this, count, ANIMATION_GRAIN);
+		else
+			sampleRange(0, count);
+	}
+} Animator;
+
+/* The loop body of Animator::update. */
+static void animatorSampleChunk(void *user, int begin, int end)
+{
+	((Animator*)user)->sampleRange(begin, end);
+}
+
+#endif
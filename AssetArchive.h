@@ -0,0 +1,537 @@
+#ifndef HEADER_ASSETARCHIVE_H
+#define HEADER_ASSETARCHIVE_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Log.h"
+#include "Lz.h"
+#include "JobSystem.h"
+
+/* 64 bit FNV-1a hash of len bytes, continuing from the hash value h.
+* Start with h = HASH_FNV1A_INIT. */
+#define HASH_FNV1A_INIT 0xcbf29ce484222325ULL
+static GLuint64 hashFNV1a(const void *data, size_t len, GLuint64 h)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	size_t i;
+	for (i = 0; i < len; i++) {
+		h ^= (GLuint64)p[i];
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+/****************************************************************************
+* ASSET ARCHIVE: many files in one mapping                                 *
+****************************************************************************/
+
+/* An asset archive packs the shader sources, mesh and texture files into a
+* single file, so a cold start opens and maps one file instead of one per
+* asset, which is what takes the time on network mounts. Files are looked
+* up by the relative path they were packed with (shaders/color.vs.glsl):
+*   AssetArchiveHeader, with where the tables are
+*   the buckets, the first entry plus one whose name hashes to each of a
+*   power of two of them, 0 for none
+*   the entries (AssetArchiveEntry), chained per bucket
+*   the blocks (AssetArchiveBlock) of the compressed entries
+*   the names, one after the other without terminators
+*   the data of the entries, each at a multiple of ASSET_ARCHIVE_ALIGN
+* The tables are used right from the mapping, a lookup hashes the name and
+* touches a bucket, an entry or two and the name, so only the pages of the
+* assets which are used are ever read.
+* An entry is compressed with lzCompress (Lz.h) in blocks of
+* ASSET_ARCHIVE_BLOCK bytes, each on its own, so the blocks of a big entry
+* are inflated in parallel on the job system. A block which does not get
+* smaller is stored as it is, and so is an entry which would not save
+* ASSET_ARCHIVE_MIN_SAVING of its size: a stored entry is used in place,
+* without a copy. All values are little endian. */
+#define ASSET_ARCHIVE_MAGIC 0x4b504348u	/* "HCPK" */
+#define ASSET_ARCHIVE_VERSION 1
+#define ASSET_ARCHIVE_ALIGN 16
+#define ASSET_ARCHIVE_BLOCK 65536	/* bytes per compressed block */
+#define ASSET_ARCHIVE_MIN_SAVING 16	/* an entry must get smaller by 1/16 */
+#define ASSET_ARCHIVE_NAME_MAX 1024	/* bytes of a name */
+
+typedef struct {
+	GLuint magic;		/* ASSET_ARCHIVE_MAGIC */
+	GLuint version;		/* ASSET_ARCHIVE_VERSION */
+	GLuint entryCount;
+	GLuint bucketCount;	/* a power of two */
+	GLuint blockCount;
+	GLuint nameBytes;
+	GLuint64 bucketOffset;	/* of the tables, from the start of the archive */
+	GLuint64 entryOffset;
+	GLuint64 blockOffset;
+	GLuint64 nameOffset;
+} AssetArchiveHeader;
+
+typedef struct {
+	GLuint64 hash;		/* hashFNV1a of the name */
+	GLuint64 offset;	/* of the data, from the start of the archive */
+	GLuint64 size;		/* of the file */
+	GLuint64 packedSize;	/* of the data, size if it is stored */
+	GLuint name, nameLength;	/* in the names */
+	GLuint firstBlock, blockCount;	/* none if it is stored */
+	GLuint next;		/* the next entry in the bucket, plus one */
+	GLuint pad;
+} AssetArchiveEntry;
+
+/* a block of a compressed entry, which inflates to ASSET_ARCHIVE_BLOCK
+* bytes, the last one to the rest; if it is as long as that, it is stored */
+typedef struct {
+	GLuint offset;		/* from the data of the entry */
+	GLuint length;
+} AssetArchiveBlock;
+
+/* An entry read from the archive: data points into the mapping if it is
+* stored, otherwise to the inflated copy in owned. */
+typedef struct {
+	const GLubyte *data;
+	GLuint64 size;
+	GLubyte *owned;		/* freed by assetDataRelease */
+} AssetData;
+
+static void assetDataRelease(AssetData *d)
+{
+	free(d->owned);
+	d->data = NULL;
+	d->owned = NULL;
+	d->size = 0;
+}
+
+/* the blocks of an entry being inflated by the jobs */
+typedef struct {
+	const GLubyte *src;
+	const AssetArchiveBlock *blocks;
+	GLubyte *dst;
+	GLuint64 size;
+	std::atomic<bool> corrupt;
+} AssetInflate;
+
+static void assetInflateBlocks(void *user, int begin, int end)
+{
+	AssetInflate *job = (AssetInflate*)user;
+	int i;
+
+	for (i = begin; i < end; i++) {
+		const AssetArchiveBlock *b = &job->blocks[i];
+		GLuint64 at = (GLuint64)i * ASSET_ARCHIVE_BLOCK;
+		size_t size = (size_t)(job->size - at < ASSET_ARCHIVE_BLOCK ? job->size - at : ASSET_ARCHIVE_BLOCK);
+		if (b->length == size)
+			memcpy(job->dst + at, job->src + b->offset, size);
+		else if (!lzDecompress(job->src + b->offset, b->length, job->dst + at, size))
+			job->corrupt.store(true, std::memory_order_relaxed);
+	}
+}
+
+typedef struct {
+	void *map;		/* NULL if no archive is open */
+	GLuint64 size;
+#ifdef WIN32
+	HANDLE mapping;
+#endif
+	const AssetArchiveHeader *header;	/* all of these point into the mapping */
+	const GLuint *buckets;
+	const AssetArchiveEntry *entries;
+	const AssetArchiveBlock *blocks;
+	const char *names;
+	JobSystem *jobs;	/* inflates the blocks of an entry, or NULL */
+	std::atomic<unsigned int> reads;
+	std::atomic<GLuint64> inflated;	/* bytes */
+
+	/* Check that the mapped file is an archive we can use and set up the
+	* tables. The entries themselves are checked when they are read, so
+	* opening does not touch more than the tables. Returns false if it is
+	* not. */
+	bool parse(const char *filename)
+	{
+		const AssetArchiveHeader *h = (const AssetArchiveHeader*)map;
+
+		if (size < sizeof(AssetArchiveHeader) || h->magic != ASSET_ARCHIVE_MAGIC) {
+			warn("'%s' is not an asset archive", filename);
+			return false;
+		}
+		if (h->version != ASSET_ARCHIVE_VERSION) {
+			warn("asset archive '%s' has version %u, expected %u", filename, h->version, ASSET_ARCHIVE_VERSION);
+			return false;
+		}
+		/* the counts are 32 bit, so none of these products overflow */
+		if (!h->bucketCount || (h->bucketCount & (h->bucketCount - 1)) ||
+			(h->bucketOffset | h->entryOffset | h->blockOffset) % sizeof(GLuint64) ||
+			h->bucketOffset + (GLuint64)sizeof(GLuint) * h->bucketCount > size ||
+			h->entryOffset + (GLuint64)sizeof(AssetArchiveEntry) * h->entryCount > size ||
+			h->blockOffset + (GLuint64)sizeof(AssetArchiveBlock) * h->blockCount > size ||
+			h->nameOffset + h->nameBytes > size) {
+			warn("asset archive '%s' is truncated", filename);
+			return false;
+		}
+		header = h;
+		buckets = (const GLuint*)((const GLubyte*)map + h->bucketOffset);
+		entries = (const AssetArchiveEntry*)((const GLubyte*)map + h->entryOffset);
+		blocks = (const AssetArchiveBlock*)((const GLubyte*)map + h->blockOffset);
+		names = (const char*)map + h->nameOffset;
+		return true;
+	}
+
+	/* Map the archive filename, from now on the loaders look for their
+	* files in there first.
+	* Returns true if successfull and false in case of an error. */
+	bool open(const char *filename)
+	{
+		close();
+#ifdef WIN32
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_RANDOM_ACCESS, NULL);
+		LARGE_INTEGER fileSize;
+		if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) {
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+			warn("failed to open asset archive '%s'", filename);
+			return false;
+		}
+		size = (GLuint64)fileSize.QuadPart;
+		mapping = size ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+		CloseHandle(file);
+		if (mapping)
+			map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+		if (!map) {
+			if (mapping)
+				CloseHandle(mapping);
+			warn("failed to map asset archive '%s'", filename);
+			return false;
+		}
+#else
+		struct stat st;
+		int fd = ::open(filename, O_RDONLY);
+		if (fd < 0 || fstat(fd, &st)) {
+			if (fd >= 0)
+				::close(fd);
+			warn("failed to open asset archive '%s'", filename);
+			return false;
+		}
+		size = (GLuint64)st.st_size;
+		if (size < sizeof(AssetArchiveHeader) || size > (GLuint64)(size_t)-1) {
+			::close(fd);
+			warn("'%s' is not an asset archive", filename);
+			return false;
+		}
+		void *m = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (m == MAP_FAILED) {
+			warn("failed to map asset archive '%s'", filename);
+			return false;
+		}
+		/* the assets are read in any order */
+		madvise(m, (size_t)size, MADV_RANDOM);
+		map = m;
+#endif
+		if (!parse(filename)) {
+			close();
+			return false;
+		}
+		info("asset archive '%s': %u files, %u MB", filename, header->entryCount, (unsigned)(size >> 20));
+		return true;
+	}
+
+	void close()
+	{
+		if (map) {
+			info("asset archive: %u files read, %u KB inflated", reads.load(),
+				(unsigned)(inflated.load() >> 10));
+#ifdef WIN32
+			UnmapViewOfFile(map);
+			CloseHandle(mapping);
+#else
+			munmap(map, (size_t)size);
+#endif
+		}
+		map = NULL;
+		size = 0;
+		header = NULL;
+		buckets = NULL;
+		entries = NULL;
+		blocks = NULL;
+		names = NULL;
+		reads.store(0);
+		inflated.store(0);
+	}
+
+	/* The entry of the file name, NULL if there is none or no archive is
+	* open. Any thread may call this. */
+	const AssetArchiveEntry *find(const char *name) const
+	{
+		size_t length = strlen(name);
+		GLuint64 hash = hashFNV1a(name, length, HASH_FNV1A_INIT);
+		GLuint i, steps = 0;
+
+		if (!map)
+			return NULL;
+		for (i = buckets[hash & (header->bucketCount - 1)]; i; i = entries[i - 1].next) {
+			const AssetArchiveEntry *e = &entries[i - 1];
+			/* a broken chain must not loop forever */
+			if (i > header->entryCount || ++steps > header->entryCount)
+				return NULL;
+			if (e->hash == hash && e->nameLength == length &&
+				(GLuint64)e->name + e->nameLength <= header->nameBytes && !memcmp(names + e->name, name, length))
+				return e;
+		}
+		return NULL;
+	}
+
+	/* Read the file name into d: in place if it is stored, otherwise
+	* inflated into a copy, by the jobs if it has more than one block.
+	* Any thread may call this.
+	* Returns false if the file is not in the archive or it is corrupt. */
+	bool read(const char *name, AssetData *d)
+	{
+		const AssetArchiveEntry *e = find(name);
+
+		d->data = NULL;
+		d->owned = NULL;
+		d->size = 0;
+		if (!e)
+			return false;
+		if (e->offset > size || e->packedSize > size - e->offset ||
+			(!e->blockCount && e->packedSize != e->size) ||
+			(e->blockCount && ((e->size + ASSET_ARCHIVE_BLOCK - 1) / ASSET_ARCHIVE_BLOCK != e->blockCount ||
+			(GLuint64)e->firstBlock + e->blockCount > header->blockCount)) ||
+			e->size > (GLuint64)(size_t)-1) {
+			warn("asset archive: '%s' is corrupt", name);
+			return false;
+		}
+		const GLubyte *src = (const GLubyte*)map + e->offset;
+		reads.fetch_add(1, std::memory_order_relaxed);
+		d->size = e->size;
+		if (!e->blockCount) {
+			d->data = src;
+			return true;
+		}
+
+		GLuint i;
+		for (i = 0; i < e->blockCount; i++) {
+			const AssetArchiveBlock *b = &blocks[e->firstBlock + i];
+			if ((GLuint64)b->offset + b->length > e->packedSize) {
+				warn("asset archive: '%s' is corrupt", name);
+				d->size = 0;
+				return false;
+			}
+		}
+		d->owned = (GLubyte*)malloc((size_t)(e->size ? e->size : 1));
+		if (!d->owned) {
+			warn("asset archive: failed to allocate %u KB for '%s'", (unsigned)(e->size >> 10), name);
+			d->size = 0;
+			return false;
+		}
+		AssetInflate job;
+		job.src = src;
+		job.blocks = &blocks[e->firstBlock];
+		job.dst = d->owned;
+		job.size = e->size;
+		job.corrupt.store(false, std::memory_order_relaxed);
+		if (jobs)
+			jobs->run(assetInflateBlocks, &job, (int)e->blockCount, 1);
+		else
+			assetInflateBlocks(&job, 0, (int)e->blockCount);
+		if (job.corrupt.load()) {
+			warn("asset archive: '%s' is corrupt", name);
+			assetDataRelease(d);
+			return false;
+		}
+		d->data = d->owned;
+		inflated.fetch_add(e->size, std::memory_order_relaxed);
+		return true;
+	}
+} AssetArchive;
+
+/* The archive of the process, see above. This is an inline function with
+* a static local, so all translation units share it; it starts out
+* closed. */
+inline AssetArchive *assetArchive()
+{
+	static AssetArchive archive;
+	return &archive;
+}
+
+/* Write zero bytes to file until it is at offset. */
+static bool assetArchivePad(FILE *file, GLuint64 offset)
+{
+	static const GLubyte zero[256] = { 0 };
+	long pos = ftell(file);
+	if (pos < 0 || (GLuint64)pos > offset)
+		return false;
+	while ((GLuint64)pos < offset) {
+		size_t n = (size_t)(offset - (GLuint64)pos < sizeof(zero) ? offset - (GLuint64)pos : sizeof(zero));
+		if (fwrite(zero, 1, n, file) != n)
+			return false;
+		pos += (long)n;
+	}
+	return true;
+}
+
+/* Read all of the file filename into memory. Returns NULL in case of an
+* error. */
+static GLubyte *assetFileRead(const char *filename, GLuint64 *size)
+{
+	FILE *file = fopen(filename, "rb");
+	GLubyte *data = NULL;
+	long length = -1;
+
+	if (file && !fseek(file, 0, SEEK_END))
+		length = ftell(file);
+	if (length >= 0 && !fseek(file, 0, SEEK_SET)) {
+		data = (GLubyte*)malloc(length ? (size_t)length : 1);
+		if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+			free(data);
+			data = NULL;
+		}
+	}
+	if (file)
+		fclose(file);
+	if (!data)
+		warn("failed to read '%s'", filename);
+	*size = (GLuint64)(length > 0 ? length : 0);
+	return data;
+}
+
+/* Pack the count files files into the archive filename, each under the
+* name it is given by, or the one in names if that is given, compressing
+* those which get smaller enough.
+* Returns true if successfull and false in case of an error. */
+static bool assetArchiveWrite(const char *filename, const char * const *files, int count,
+	const char * const *names = NULL)
+{
+	AssetArchiveHeader h;
+	AssetArchiveEntry *entries = (AssetArchiveEntry*)calloc(count ? count : 1, sizeof(AssetArchiveEntry));
+	GLuint *buckets = NULL;
+	AssetArchiveBlock *blocks = NULL;
+	GLubyte *packed = (GLubyte*)malloc(lzBound(ASSET_ARCHIVE_BLOCK));
+	GLuint64 offset, total = 0, stored = 0;
+	GLuint maxBlocks = 0, i, b;
+	FILE *file = NULL;
+	bool ok = entries && packed;
+
+	memset(&h, 0, sizeof(h));
+	h.magic = ASSET_ARCHIVE_MAGIC;
+	h.version = ASSET_ARCHIVE_VERSION;
+	h.entryCount = (GLuint)count;
+	for (h.bucketCount = 1; h.bucketCount < h.entryCount; h.bucketCount *= 2);
+	/* the names and room for the blocks of every file, before the data */
+	if (!names)
+		names = files;
+	for (i = 0; ok && i < h.entryCount; i++) {
+		size_t length = strlen(names[i]);
+		struct stat st;
+		if (!length || length > ASSET_ARCHIVE_NAME_MAX || stat(files[i], &st)) {
+			warn("asset archive: cannot pack '%s'", files[i]);
+			ok = false;
+			break;
+		}
+		GLuint64 size = (GLuint64)st.st_size;
+		entries[i].hash = hashFNV1a(names[i], length, HASH_FNV1A_INIT);
+		entries[i].name = h.nameBytes;
+		entries[i].nameLength = (GLuint)length;
+		h.nameBytes += (GLuint)length;
+		maxBlocks += (GLuint)((size + ASSET_ARCHIVE_BLOCK - 1) / ASSET_ARCHIVE_BLOCK);
+		for (b = 0; b < i; b++) {
+			if (entries[b].hash == entries[i].hash && !strcmp(names[b], names[i])) {
+				warn("asset archive: '%s' is given twice", names[i]);
+				ok = false;
+			}
+		}
+	}
+	buckets = (GLuint*)calloc(h.bucketCount, sizeof(GLuint));
+	blocks = (AssetArchiveBlock*)calloc(maxBlocks ? maxBlocks : 1, sizeof(AssetArchiveBlock));
+	ok = ok && buckets && blocks;
+	for (i = 0; ok && i < h.entryCount; i++) {
+		GLuint *bucket = &buckets[entries[i].hash & (h.bucketCount - 1)];
+		entries[i].next = *bucket;
+		*bucket = i + 1;
+	}
+	h.bucketOffset = sizeof(AssetArchiveHeader);
+	h.entryOffset = h.bucketOffset + ((sizeof(GLuint) * (GLuint64)h.bucketCount + 7) & ~(GLuint64)7);
+	h.blockOffset = h.entryOffset + sizeof(AssetArchiveEntry) * (GLuint64)h.entryCount;
+	h.nameOffset = h.blockOffset + sizeof(AssetArchiveBlock) * (GLuint64)maxBlocks;
+	offset = h.nameOffset + h.nameBytes;
+
+	/* the data, file by file, then the tables in front of it */
+	file = ok ? fopen(filename, "wb") : NULL;
+	ok = ok && file && !fseek(file, (long)offset, SEEK_SET);
+	for (i = 0; ok && i < h.entryCount; i++) {
+		AssetArchiveEntry *e = &entries[i];
+		GLubyte *data = assetFileRead(files[i], &e->size);
+		GLuint blockCount = (GLuint)((e->size + ASSET_ARCHIVE_BLOCK - 1) / ASSET_ARCHIVE_BLOCK);
+		GLuint64 at = 0, saved = 0;
+
+		offset = (offset + ASSET_ARCHIVE_ALIGN - 1) / ASSET_ARCHIVE_ALIGN * ASSET_ARCHIVE_ALIGN;
+		ok = data && e->size < 0xffffffffu && assetArchivePad(file, offset);
+		e->offset = offset;
+		e->firstBlock = h.blockCount;
+		e->blockCount = blockCount;
+		for (b = 0; ok && b < blockCount; b++) {
+			AssetArchiveBlock *block = &blocks[h.blockCount + b];
+			size_t size = (size_t)(e->size - at < ASSET_ARCHIVE_BLOCK ? e->size - at : ASSET_ARCHIVE_BLOCK);
+			/* smaller, or stored as it is */
+			size_t length = lzCompress(data + at, size, packed, size - 1);
+			block->offset = (GLuint)(offset - e->offset);
+			block->length = (GLuint)(length ? length : size);
+			ok = fwrite(length ? packed : data + at, 1, block->length, file) == block->length;
+			saved += size - block->length;
+			offset += block->length;
+			at += size;
+		}
+		if (ok && saved <= e->size / ASSET_ARCHIVE_MIN_SAVING) {
+			/* not worth inflating, overwrite the blocks by the file */
+			ok = !fseek(file, (long)e->offset, SEEK_SET) &&
+				fwrite(data, 1, (size_t)e->size, file) == (size_t)e->size;
+			offset = e->offset + e->size;
+			e->blockCount = 0;
+			e->firstBlock = 0;
+			stored++;
+		} else {
+			h.blockCount += blockCount;
+		}
+		e->packedSize = offset - e->offset;
+		total += e->size;
+		free(data);
+	}
+	ok = ok && !fflush(file) && !fseek(file, 0, SEEK_SET) &&
+		fwrite(&h, sizeof(h), 1, file) == 1 &&
+		assetArchivePad(file, h.bucketOffset) &&
+		fwrite(buckets, sizeof(GLuint), h.bucketCount, file) == h.bucketCount &&
+		assetArchivePad(file, h.entryOffset) &&
+		fwrite(entries, sizeof(AssetArchiveEntry), h.entryCount, file) == h.entryCount &&
+		fwrite(blocks, sizeof(AssetArchiveBlock), h.blockCount, file) == h.blockCount &&
+		assetArchivePad(file, h.nameOffset);
+	for (i = 0; ok && i < h.entryCount; i++)
+		ok = fwrite(names[i], 1, entries[i].nameLength, file) == entries[i].nameLength;
+	if ((file && fclose(file)) || !ok)
+		warn("failed to write asset archive '%s'", filename);
+	else
+		info("asset archive '%s': %u files, %u of them stored, %u KB packed to %u KB", filename, h.entryCount,
+			(unsigned)stored, (unsigned)(total >> 10), (unsigned)(offset >> 10));
+	free(entries);
+	free(buckets);
+	free(blocks);
+	free(packed);
+	return ok;
+}
+
+#endif
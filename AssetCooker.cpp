@@ -0,0 +1,100 @@
+#include <glad/glad.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Log.h"
+#include "JobSystem.h"
+#include "AssetCooker.h"
+
+/* The asset cooker, a program of its own: it converts the source assets
+ * given on the command line into the formats HelloCube loads, see
+ * AssetCooker.h. */
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [--out DIR] [--cache DIR] [--archive FILE] [--packed-vertices]\n"
+		"          [--texture-format BC1|BC3|BC4|BC5] [--texture-layers N] [--supercompress]\n"
+		"          [--spirv] [--compiler CMD] [--optimize-glsl] [--optimizer CMD]\n"
+		"          [--cross-compiler CMD] [--threads N] FILE...\n"
+		"Cooks OBJ and mesh files to mesh files, PPM, PAM and KTX2 images to texture\n"
+		"files, with --spirv GLSL stages to SPIR-V modules, with --optimize-glsl GLSL\n"
+		"stages to GLSL optimized through SPIR-V, and copies all other files,\n"
+		"to DIR (default: cooked) under their relative paths; only those whose input,\n"
+		"settings or cooker changed are cooked again, the others come from the cache\n"
+		"(default: DIR/.cache).\n", name);
+}
+
+int main (int argc, char **argv)
+{
+	CookSettings settings;
+	JobSystem jobs;
+	char cacheDir[COOK_PATH_MAX];
+	const char *cache = NULL;
+	bool spirv = false, optimize = false;
+	int i, threads = 0, result;
+
+	memset(&settings, 0, sizeof(settings));
+	settings.outDir = "cooked";
+	settings.textureFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	settings.textureLayers = 1;
+	settings.compiler = "glslangValidator";
+	settings.optimizer = "spirv-opt";
+	settings.crossCompiler = "spirv-cross";
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		const char *arg = argv[i];
+		bool hasValue = i+1 < argc;
+		if (!strcmp(arg, "--out") && hasValue) {
+			settings.outDir = argv[++i];
+		} else if (!strcmp(arg, "--cache") && hasValue) {
+			cache = argv[++i];
+		} else if (!strcmp(arg, "--archive") && hasValue) {
+			settings.archive = argv[++i];
+		} else if (!strcmp(arg, "--packed-vertices")) {
+			settings.packedVertices = true;
+		} else if (!strcmp(arg, "--texture-format") && hasValue) {
+			settings.textureFormat = textureFormatByName(argv[++i]);
+			if (!settings.textureFormat)
+				break;
+		} else if (!strcmp(arg, "--texture-layers") && hasValue) {
+			settings.textureLayers = (GLuint)atoi(argv[++i]);
+			if (!settings.textureLayers)
+				break;
+		} else if (!strcmp(arg, "--supercompress")) {
+			settings.supercompress = true;
+		} else if (!strcmp(arg, "--spirv")) {
+			spirv = true;
+		} else if (!strcmp(arg, "--compiler") && hasValue) {
+			settings.compiler = argv[++i];
+		} else if (!strcmp(arg, "--optimize-glsl")) {
+			optimize = true;
+		} else if (!strcmp(arg, "--optimizer") && hasValue) {
+			settings.optimizer = argv[++i];
+		} else if (!strcmp(arg, "--cross-compiler") && hasValue) {
+			settings.crossCompiler = argv[++i];
+		} else if (!strcmp(arg, "--threads") && hasValue) {
+			threads = atoi(argv[++i]);
+		} else {
+			break;
+		}
+	}
+	if (i >= argc || argv[i][0] == '-') {
+		usage(argv[0]);
+		return 2;
+	}
+	settings.modules = spirv;
+	if (!spirv && !optimize)
+		settings.compiler = NULL;
+	if (!optimize)
+		settings.optimizer = NULL;
+	mysnprintf(cacheDir, sizeof(cacheDir), "%s/.cache", settings.outDir);
+	settings.cacheDir = cache ? cache : cacheDir;
+
+	logStart();
+	jobs.init(threads);
+	result = cookAssets(&settings, argv + i, argc - i, &jobs) ? 0 : 1;
+	jobs.destroy();
+	logStop();
+	return result;
+}
@@ -0,0 +1,675 @@
+#ifndef HEADER_ASSETCOOKER_H
+#define HEADER_ASSETCOOKER_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "JobSystem.h"
+#include "ShaderHelpers.h"
+#include "AssetArchive.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "TextureEncoder.h"
+
+/****************************************************************************
+* ASSET COOKER: offline conversion of the source assets                    *
+****************************************************************************/
+
+/* The cooker turns source assets into the files the application loads as
+* they are, so loading never converts anything:
+* - Wavefront OBJ meshes (the positions and, as an extension some tools
+*   write, their colors) into mesh files, and mesh files into optimized
+*   ones (MeshOptimizer.h),
+* - PPM, PAM and KTX2 images into compressed texture files
+*   (TextureEncoder.h),
+* - GLSL stages, with their includes expanded, into SPIR-V modules next to
+*   them, by an external compiler such as glslangValidator; the sources
+*   themselves are copied, like any other file,
+* - GLSL stages into optimized GLSL, if asked to: compiled to SPIR-V as
+*   above, optimized by spirv-opt (or another optimizer) and turned back
+*   into GLSL of the same version by SPIRV-Cross, which replaces the copy
+*   of the source. Weak drivers compile what they are given about as it
+*   is; this way the constants are folded, the common expressions are
+*   computed once and the dead code is gone before they see it. A module
+*   cannot keep the #ifdefs by which the application picks the
+*   permutations of a stage (and the constants of UniformSpecializer.h),
+*   so only the stages without any are optimized, the others are copied,
+*   and so is a stage one of the tools rejects,
+* and packs the results into an asset archive (AssetArchive.h) if asked to.
+* Every output is content addressed: its key is a hash of the bytes of the
+* input (with everything it includes), of the settings which change the
+* output and of COOK_TOOL_VERSION (and the version the compiler reports),
+* and it is kept in the cache directory under that key. So an asset is only
+* cooked again when its key is new, identical inputs are cooked once, and
+* switching back to an older input or setting finds its output still there.
+* An output is written to a temporary file and renamed when it is
+* complete, so an interrupted run never leaves a broken entry behind. A
+* stage the compiler rejects is remembered as such (the application
+* compiles it from GLSL then), and not tried again until it changes.
+* The cache entries are copied to the output directory, under the path of
+* the source with the extension of the output, unless the copy there is
+* already up to date. The items are cooked in parallel on the job system. */
+#define COOK_TOOL_VERSION "1"	/* bump when a converter changes its output */
+#define COOK_PATH_MAX 512
+
+/* kinds of CookItems */
+enum {
+	COOK_COPY = 0,		/* the file as it is */
+	COOK_OBJ,		/* OBJ to mesh file */
+	COOK_MESH,		/* mesh file to optimized mesh file */
+	COOK_TEXTURE,		/* image or KTX2 to texture file */
+	COOK_SPIRV,		/* GLSL stage to SPIR-V module */
+	COOK_GLSL		/* GLSL stage to optimized GLSL */
+};
+
+/* results of a CookItem */
+enum {
+	COOK_FAILED = 0,
+	COOK_CACHED,		/* the output was in the cache */
+	COOK_COOKED,		/* cooked now */
+	COOK_NONE		/* the stage has no module */
+};
+
+typedef struct {
+	const char *outDir;	/* where the outputs go */
+	const char *cacheDir;	/* where they are kept by key */
+	const char *archive;	/* the archive of all outputs, or NULL */
+	bool packedVertices;	/* meshes in the packed vertex format */
+	GLenum textureFormat;	/* for images */
+	GLuint textureLayers;
+	bool supercompress;
+	const char *compiler;	/* the GLSL to SPIR-V compiler, NULL for none */
+	GLuint64 compilerHash;	/* of its version */
+	bool modules;		/* build the SPIR-V modules of the stages */
+	const char *optimizer;	/* the SPIR-V optimizer, NULL to copy the stages */
+	const char *crossCompiler;	/* SPIR-V back to GLSL */
+	GLuint64 optimizerHash;	/* of the versions of both */
+} CookSettings;
+
+typedef struct {
+	const char *source;	/* the path of the input, relative */
+	int kind;		/* COOK_* */
+	char name[COOK_PATH_MAX];	/* of the output, relative, also in the archive */
+	GLuint64 key;
+	int result;		/* COOK_FAILED etc. */
+} CookItem;
+
+/* The kind of the output of path, COOK_COPY for all it does not convert. */
+static int cookKind(const char *path)
+{
+	const char *ext = strrchr(path, '.');
+	if (!ext || strchr(ext, '/'))
+		return COOK_COPY;
+	if (!strcmp(ext, ".obj"))
+		return COOK_OBJ;
+	if (!strcmp(ext, ".mesh"))
+		return COOK_MESH;
+	if (!strcmp(ext, ".ppm") || !strcmp(ext, ".pam") || !strcmp(ext, ".ktx2"))
+		return COOK_TEXTURE;
+	return COOK_COPY;
+}
+
+/* The stage of the GLSL file path for the compiler, NULL if it is none
+* (e.g. a file which is only included). */
+static const char *cookShaderStage(const char *path)
+{
+	static const char *stages[][2] = {
+		{ ".vs.glsl", "vert" }, { ".fs.glsl", "frag" }, { ".cs.glsl", "comp" }, { ".gs.glsl", "geom" }
+	};
+	size_t i, length = strlen(path);
+	for (i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+		size_t n = strlen(stages[i][0]);
+		if (length > n && !strcmp(path + length - n, stages[i][0]))
+			return stages[i][1];
+	}
+	return NULL;
+}
+
+/* Set the name of the output of item: the source with the extension of
+* the output. Returns false if it does not fit. */
+static bool cookItemName(CookItem *item)
+{
+	static const char *extensions[] = { "", ".mesh", ".mesh", ".tex", ".spv", "" };
+	const char *source = item->source;
+	const char *ext = strrchr(source, '.');
+	int length = (int)strlen(source);
+
+	while (source[0] == '.' && source[1] == '/')
+		source += 2;
+	if (item->kind == COOK_SPIRV)
+		length -= 5;	/* ".glsl", see spirvModuleFilename */
+	else if (item->kind != COOK_COPY && item->kind != COOK_GLSL && ext)
+		length = (int)(ext - item->source);
+	length -= (int)(source - item->source);
+	if (source[0] == '/' || strstr(source, "../")) {
+		warn("asset cooker: '%s' is not a relative path below the current directory", item->source);
+		return false;
+	}
+	return mysnprintf(item->name, sizeof(item->name), "%.*s%s", length, source, extensions[item->kind]) <
+		(int)sizeof(item->name);
+}
+
+/* Create the directories of the file path. */
+static void cookMakeDirs(const char *path)
+{
+	char dir[COOK_PATH_MAX];
+	size_t i;
+	for (i = 0; path[i] && i + 1 < sizeof(dir); i++) {
+		if (i && path[i] == '/') {
+			dir[i] = 0;
+			myMkdir(dir);
+		}
+		dir[i] = path[i];
+	}
+}
+
+/* Write the size bytes data to the file path. */
+static bool cookFileWrite(const char *path, const void *data, size_t size)
+{
+	FILE *file = fopen(path, "wb");
+	bool ok = file && fwrite(data, 1, size, file) == size;
+	if ((file && fclose(file)) || !ok) {
+		warn("asset cooker: failed to write '%s'", path);
+		return false;
+	}
+	return true;
+}
+
+static bool cookFileCopy(const char *from, const char *to)
+{
+	GLuint64 size;
+	GLubyte *data = assetFileRead(from, &size);
+	bool ok = data && cookFileWrite(to, data, (size_t)size);
+	free(data);
+	return ok;
+}
+
+/* Replace to by from. */
+static bool cookFileRename(const char *from, const char *to)
+{
+#ifdef WIN32
+	/* rename does not replace on Windows */
+	remove(to);
+#endif
+	if (rename(from, to)) {
+		warn("asset cooker: failed to rename '%s' to '%s'", from, to);
+		remove(from);
+		return false;
+	}
+	return true;
+}
+
+/* Expand the GLSL file path with its includes into a string of its own,
+* in *size bytes, hashed into *hash. Returns NULL in case of an error. */
+static char *cookShaderExpand(const char *path, size_t *size, GLuint64 *hash)
+{
+	ShaderSourceCache *cache = (ShaderSourceCache*)malloc(sizeof(ShaderSourceCache));
+	ShaderSourceList list;
+	char *text = NULL;
+	int i;
+
+	if (!cache)
+		return NULL;
+	shaderSourceCacheInit(cache);
+	if (shaderSourceExpand(cache, &list, path)) {
+		*size = 0;
+		for (i = 0; i < list.count; i++)
+			*size += (size_t)list.lengths[i];
+		text = (char*)malloc(*size + 1);
+	}
+	if (text) {
+		size_t at = 0;
+		for (i = 0; i < list.count; i++) {
+			memcpy(text + at, list.strings[i], (size_t)list.lengths[i]);
+			at += (size_t)list.lengths[i];
+		}
+		text[at] = 0;
+		*hash = hashFNV1a(text, at, *hash);
+	}
+	shaderSourceCacheDestroy(cache);
+	free(cache);
+	return text;
+}
+
+/* The key of item under settings. Returns false if its input cannot be
+* read. */
+static bool cookItemKey(const CookSettings *settings, CookItem *item)
+{
+	GLuint64 h = hashFNV1a(COOK_TOOL_VERSION, strlen(COOK_TOOL_VERSION), HASH_FNV1A_INIT);
+	h = hashFNV1a(&item->kind, sizeof(item->kind), h);
+	if (item->kind == COOK_OBJ) {
+		h = hashFNV1a(&settings->packedVertices, sizeof(settings->packedVertices), h);
+	} else if (item->kind == COOK_TEXTURE) {
+		h = hashFNV1a(&settings->textureFormat, sizeof(settings->textureFormat), h);
+		h = hashFNV1a(&settings->textureLayers, sizeof(settings->textureLayers), h);
+		h = hashFNV1a(&settings->supercompress, sizeof(settings->supercompress), h);
+	}
+	if (item->kind == COOK_SPIRV || item->kind == COOK_GLSL) {
+		size_t size;
+		h = hashFNV1a(&settings->compilerHash, sizeof(settings->compilerHash), h);
+		if (item->kind == COOK_GLSL)
+			h = hashFNV1a(&settings->optimizerHash, sizeof(settings->optimizerHash), h);
+		char *text = cookShaderExpand(item->source, &size, &h);
+		if (!text)
+			return false;
+		free(text);
+	} else {
+		GLuint64 size;
+		GLubyte *data = assetFileRead(item->source, &size);
+		if (!data)
+			return false;
+		h = hashFNV1a(data, (size_t)size, h);
+		free(data);
+	}
+	item->key = h;
+	return true;
+}
+
+/* Read the OBJ file in: its vertices, with the colors of "v x y z r g b"
+* lines (white without), and its faces, split into fans of triangles.
+* Returns false in case of an error. */
+static bool cookReadObj(const char *in, Vertex **vertices, GLsizei *vertexCount, GLushort **indices,
+	GLsizei *indexCount)
+{
+	GLuint64 size;
+	char *text = (char*)assetFileRead(in, &size);
+	GLsizei vertexCapacity = 0, indexCapacity = 0, line = 0;
+	bool ok = text != NULL;
+
+	*vertices = NULL;
+	*indices = NULL;
+	*vertexCount = *indexCount = 0;
+	for (char *p = text, *end = text + size; ok && p < end; ) {
+		char *next = (char*)memchr(p, '\n', end - p);
+		next = next ? next + 1 : end;
+		char buf[1024];
+		size_t length = (size_t)(next - p) < sizeof(buf) ? (size_t)(next - p) : sizeof(buf) - 1;
+		memcpy(buf, p, length);
+		buf[length] = 0;
+		p = next;
+		line++;
+
+		if (buf[0] == 'v' && (buf[1] == ' ' || buf[1] == '\t')) {
+			float x, y, z, r = 1.0f, g = 1.0f, b = 1.0f;
+			int n = sscanf(buf + 2, "%f %f %f %f %f %f", &x, &y, &z, &r, &g, &b);
+			if (n != 3 && n != 6) {
+				warn("%s:%d: malformed vertex", in, (int)line);
+				ok = false;
+				break;
+			}
+			if (*vertexCount == 65536) {
+				warn("asset cooker: '%s' has more than 65536 vertices", in);
+				ok = false;
+				break;
+			}
+			if (*vertexCount == vertexCapacity) {
+				vertexCapacity = vertexCapacity ? 2 * vertexCapacity : 1024;
+				Vertex *grown = (Vertex*)realloc(*vertices, sizeof(Vertex) * vertexCapacity);
+				if (!(ok = grown != NULL))
+					break;
+				*vertices = grown;
+			}
+			Vertex *v = &(*vertices)[(*vertexCount)++];
+			v->pos[0] = x;
+			v->pos[1] = y;
+			v->pos[2] = z;
+			v->clr[0] = (GLubyte)(glm::clamp(r, 0.0f, 1.0f) * 255.0f + 0.5f);
+			v->clr[1] = (GLubyte)(glm::clamp(g, 0.0f, 1.0f) * 255.0f + 0.5f);
+			v->clr[2] = (GLubyte)(glm::clamp(b, 0.0f, 1.0f) * 255.0f + 0.5f);
+			v->clr[3] = 255;
+		} else if (buf[0] == 'f' && (buf[1] == ' ' || buf[1] == '\t')) {
+			/* "f a b c ...", each a position index, maybe with /texcoord/normal */
+			GLushort corners[3];
+			int corner = 0, offset;
+			long index;
+			for (char *q = buf + 2; ok && sscanf(q, "%ld%n", &index, &offset) == 1; ) {
+				q += offset;
+				while (*q && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\n')
+					q++;
+				if (index < 0)
+					index += *vertexCount + 1;
+				if (index < 1 || index > *vertexCount) {
+					warn("%s:%d: vertex %ld is out of range", in, (int)line, index);
+					ok = false;
+					break;
+				}
+				GLushort i = (GLushort)(index - 1);
+				if (corner < 2) {
+					corners[corner++] = i;
+					continue;
+				}
+				corners[2] = i;
+				if (*indexCount + 3 > indexCapacity) {
+					indexCapacity = indexCapacity ? 2 * indexCapacity : 4096;
+					GLushort *grown = (GLushort*)realloc(*indices, sizeof(GLushort) * indexCapacity);
+					if (!(ok = grown != NULL))
+						break;
+					*indices = grown;
+				}
+				memcpy(*indices + *indexCount, corners, sizeof(corners));
+				*indexCount += 3;
+				/* the next triangle of the fan */
+				corners[1] = i;
+			}
+		}
+	}
+	free(text);
+	if (ok && !*indexCount) {
+		warn("asset cooker: '%s' has no faces", in);
+		ok = false;
+	}
+	if (!ok) {
+		free(*vertices);
+		free(*indices);
+		*vertices = NULL;
+		*indices = NULL;
+	}
+	return ok;
+}
+
+/* Compile the GLSL stage in into the SPIR-V module out.
+* Returns COOK_COOKED, COOK_NONE if the compiler rejects it, or
+* COOK_FAILED. */
+static int cookCompileSpirv(const CookSettings *settings, const char *in, const char *out)
+{
+	char source[COOK_PATH_MAX + 8], command[3 * COOK_PATH_MAX];
+	GLuint64 hash = 0;
+	size_t size;
+	char *text = cookShaderExpand(in, &size, &hash);
+
+	mysnprintf(source, sizeof(source), "%s.glsl", out);
+	if (!text || !cookFileWrite(source, text, size)) {
+		free(text);
+		return COOK_FAILED;
+	}
+	free(text);
+	mysnprintf(command, sizeof(command), "\"%s\" -G -S %s -o \"%s\" \"%s\"", settings->compiler,
+		cookShaderStage(in), out, source);
+	int status = system(command);
+	remove(source);
+	if (status) {
+		warn("asset cooker: the compiler rejected '%s', it is compiled from GLSL at run time", in);
+		remove(out);
+		return COOK_NONE;
+	}
+	return COOK_COOKED;
+}
+
+/* Whether the GLSL text has preprocessor conditionals. */
+static bool cookShaderConditional(const char *text)
+{
+	const char *p;
+	for (p = text; (p = strchr(p, '#')) != NULL; p++) {
+		const char *q = p + 1;
+		while (*q == ' ' || *q == '\t')
+			q++;
+		if (q[0] == 'i' && q[1] == 'f')
+			return true;
+	}
+	return false;
+}
+
+/* Optimize the GLSL stage in into the GLSL file out, through SPIR-V, or
+* copy it if it has permutations or a tool rejects it.
+* Returns COOK_COOKED or COOK_FAILED. */
+static int cookOptimizeGlsl(const CookSettings *settings, const char *in, const char *out)
+{
+	char source[COOK_PATH_MAX + 8], module[COOK_PATH_MAX + 8], optimized[COOK_PATH_MAX + 16];
+	char command[4 * COOK_PATH_MAX], profile[16];
+	GLuint64 hash = 0;
+	size_t size;
+	int version = 0, status;
+	char *text = cookShaderExpand(in, &size, &hash);
+
+	if (!text)
+		return COOK_FAILED;
+	const char *v = strstr(text, "#version");
+	profile[0] = 0;
+	if (!v || sscanf(v + 8, "%d %15s", &version, profile) < 1 || cookShaderConditional(text)) {
+		free(text);
+		return cookFileCopy(in, out) ? COOK_COOKED : COOK_FAILED;
+	}
+	mysnprintf(source, sizeof(source), "%s.glsl", out);
+	mysnprintf(module, sizeof(module), "%s.spv", out);
+	mysnprintf(optimized, sizeof(optimized), "%s.opt.spv", out);
+	if (!cookFileWrite(source, text, size)) {
+		free(text);
+		return COOK_FAILED;
+	}
+	free(text);
+	mysnprintf(command, sizeof(command), "\"%s\" -G -S %s -o \"%s\" \"%s\"", settings->compiler,
+		cookShaderStage(in), module, source);
+	status = system(command);
+	if (!status) {
+		mysnprintf(command, sizeof(command), "\"%s\" -O \"%s\" -o \"%s\"", settings->optimizer, module, optimized);
+		status = system(command);
+	}
+	if (!status) {
+		mysnprintf(command, sizeof(command), "\"%s\" --version %d %s \"%s\" --output \"%s\"",
+			settings->crossCompiler, version, strcmp(profile, "es") ? "--no-es" : "--es", optimized, out);
+		status = system(command);
+	}
+	remove(source);
+	remove(module);
+	remove(optimized);
+	if (status) {
+		warn("asset cooker: '%s' could not be optimized, it is copied as it is", in);
+		return cookFileCopy(in, out) ? COOK_COOKED : COOK_FAILED;
+	}
+	return COOK_COOKED;
+}
+
+/* Convert the input of item into the file out.
+* Returns COOK_COOKED, COOK_NONE or COOK_FAILED. */
+static int cookConvert(const CookSettings *settings, const CookItem *item, const char *out)
+{
+	MeshOptimizeReport report;
+	Vertex *vertices;
+	GLushort *indices;
+	GLsizei vertexCount, indexCount;
+	char raw[COOK_PATH_MAX + 8];
+	bool ok;
+
+	switch (item->kind) {
+		case COOK_OBJ:
+			if (!cookReadObj(item->source, &vertices, &vertexCount, &indices, &indexCount))
+				return COOK_FAILED;
+			/* the vertices as they are, then optimized */
+			mysnprintf(raw, sizeof(raw), "%s.raw", out);
+			ok = meshFileWriteVertices(raw,
+				&vertexLayouts[settings->packedVertices ? VERTEX_FORMAT_PACKED : VERTEX_FORMAT_FLOAT],
+				vertices, vertexCount, indices, indexCount) &&
+				meshOptimizeFile(raw, out, &report);
+			remove(raw);
+			free(vertices);
+			free(indices);
+			return ok ? COOK_COOKED : COOK_FAILED;
+		case COOK_MESH:
+			return meshOptimizeFile(item->source, out, &report) ? COOK_COOKED : COOK_FAILED;
+		case COOK_TEXTURE:
+			return textureBuildFile(item->source, out, settings->textureFormat, settings->textureLayers,
+				settings->supercompress) ? COOK_COOKED : COOK_FAILED;
+		case COOK_SPIRV:
+			return cookCompileSpirv(settings, item->source, out);
+		case COOK_GLSL:
+			return cookOptimizeGlsl(settings, item->source, out);
+	}
+	return cookFileCopy(item->source, out) ? COOK_COOKED : COOK_FAILED;
+}
+
+/* Whether the file copy has the size of the file of entry and is not older
+* than it. */
+static bool cookUpToDate(const char *copy, const char *entry)
+{
+	GLuint64 copyTime, copySize, entryTime, entrySize;
+	return shaderSourceStat(copy, &copyTime, &copySize) && shaderSourceStat(entry, &entryTime, &entrySize) &&
+		copySize == entrySize && copyTime >= entryTime;
+}
+
+/* Cook item, or find it in the cache, and copy it to the output. */
+static void cookItem(const CookSettings *settings, CookItem *item)
+{
+	char entry[COOK_PATH_MAX], none[COOK_PATH_MAX + 8], temp[2 * COOK_PATH_MAX + 8], output[2 * COOK_PATH_MAX];
+	const char *base = strrchr(item->name, '/');
+	GLuint64 mtime, size;
+
+	item->result = COOK_FAILED;
+	if (!cookItemKey(settings, item))
+		return;
+	/* the extension stays, for whoever looks into the cache */
+	base = strrchr(base ? base : item->name, '.');
+	mysnprintf(entry, sizeof(entry), "%s/%016llx%s", settings->cacheDir, (unsigned long long)item->key,
+		base ? base : "");
+	mysnprintf(none, sizeof(none), "%s.none", entry);
+	mysnprintf(output, sizeof(output), "%s/%s", settings->outDir, item->name);
+
+	if (shaderSourceStat(entry, &mtime, &size)) {
+		item->result = COOK_CACHED;
+	} else if (shaderSourceStat(none, &mtime, &size)) {
+		item->result = COOK_NONE;
+	} else {
+		PROFILE_ZONE("cook");
+		mysnprintf(temp, sizeof(temp), "%s.tmp", entry);
+		item->result = cookConvert(settings, item, temp);
+		if (item->result == COOK_COOKED && !cookFileRename(temp, entry))
+			item->result = COOK_FAILED;
+		if (item->result == COOK_NONE)
+			cookFileWrite(none, "", 0);
+		if (item->result == COOK_FAILED)
+			remove(temp);
+	}
+	if (item->result == COOK_NONE) {
+		/* not an old module either */
+		remove(output);
+		return;
+	}
+	if (item->result == COOK_FAILED || cookUpToDate(output, entry))
+		return;
+	/* whole or not at all, the application may be loading it */
+	cookMakeDirs(output);
+	mysnprintf(temp, sizeof(temp), "%s.tmp", output);
+	if (!cookFileCopy(entry, temp) || !cookFileRename(temp, output))
+		item->result = COOK_FAILED;
+}
+
+typedef struct {
+	const CookSettings *settings;
+	CookItem *items;
+} CookJob;
+
+static void cookJob(void *user, int begin, int end)
+{
+	CookJob *job = (CookJob*)user;
+	int i;
+	for (i = begin; i < end; i++)
+		cookItem(job->settings, &job->items[i]);
+}
+
+/* The hash of the version the tool compiler reports when it is run with
+* flag, continuing from h, 0 if it does not run. */
+static GLuint64 cookCompilerHash(const char *compiler, const char *flag = "--version", GLuint64 h = HASH_FNV1A_INIT)
+{
+	char command[COOK_PATH_MAX + 32], buf[256];
+	size_t n, total = 0;
+
+	mysnprintf(command, sizeof(command), "\"%s\" %s", compiler, flag);
+#ifdef WIN32
+	FILE *pipe = _popen(command, "r");
+#else
+	FILE *pipe = popen(command, "r");
+#endif
+	if (!pipe)
+		return 0;
+	while ((n = fread(buf, 1, sizeof(buf), pipe)) > 0) {
+		h = hashFNV1a(buf, n, h);
+		total += n;
+	}
+#ifdef WIN32
+	int status = _pclose(pipe);
+#else
+	int status = pclose(pipe);
+#endif
+	return (status || !total) ? 0 : h;
+}
+
+/* Cook the count files sources under settings, see above, and pack them
+* into the archive of settings, if there is one. The items are cooked in
+* parallel on jobs.
+* Returns true if all of them were cooked and false otherwise. */
+static bool cookAssets(CookSettings *settings, const char * const *sources, int count, JobSystem *jobs)
+{
+	CookItem *items = (CookItem*)calloc(2 * (size_t)count + 1, sizeof(CookItem));
+	const char **files = (const char**)malloc(sizeof(char*) * (2 * (size_t)count + 1));
+	const char **names = (const char**)malloc(sizeof(char*) * (2 * (size_t)count + 1));
+	char *paths = (char*)malloc(2 * COOK_PATH_MAX * (2 * (size_t)count + 1));
+	int i, n = 0, results[4] = { 0, 0, 0, 0 };
+	CookJob job = { settings, items };
+	bool ok = items && files && names && paths;
+
+	if (settings->compiler) {
+		settings->compilerHash = cookCompilerHash(settings->compiler);
+		if (!settings->compilerHash) {
+			warn("asset cooker: '%s' does not run, no SPIR-V modules are built", settings->compiler);
+			settings->compiler = NULL;
+		}
+	}
+	if (settings->optimizer) {
+		/* SPIRV-Cross tells its revision, not a version */
+		settings->optimizerHash = cookCompilerHash(settings->optimizer);
+		if (settings->optimizerHash)
+			settings->optimizerHash = cookCompilerHash(settings->crossCompiler, "--revision", settings->optimizerHash);
+		if (!settings->compiler || !settings->optimizerHash) {
+			warn("asset cooker: '%s' or '%s' does not run, the stages are copied as they are", settings->optimizer,
+				settings->crossCompiler);
+			settings->optimizer = NULL;
+		}
+	}
+	for (i = 0; ok && i < count; i++) {
+		items[n].source = sources[i];
+		items[n].kind = cookKind(sources[i]);
+		if (items[n].kind == COOK_COPY && settings->optimizer && cookShaderStage(sources[i]))
+			items[n].kind = COOK_GLSL;
+		ok = cookItemName(&items[n++]);
+		if (ok && settings->modules && settings->compiler && cookShaderStage(sources[i])) {
+			items[n].source = sources[i];
+			items[n].kind = COOK_SPIRV;
+			ok = cookItemName(&items[n++]);
+		}
+	}
+	if (ok) {
+		myMkdir(settings->outDir);
+		myMkdir(settings->cacheDir);
+		jobs->run(cookJob, &job, n, 1);
+	}
+
+	/* what there is goes into the archive */
+	int packed = 0;
+	for (i = 0; ok && i < n; i++) {
+		results[items[i].result]++;
+		if (items[i].result == COOK_FAILED) {
+			warn("asset cooker: failed to cook '%s'", items[i].source);
+			continue;
+		}
+		if (items[i].result == COOK_NONE)
+			continue;
+		char *path = paths + (size_t)2 * COOK_PATH_MAX * packed;
+		mysnprintf(path, 2 * COOK_PATH_MAX, "%s/%s", settings->outDir, items[i].name);
+		files[packed] = path;
+		names[packed++] = items[i].name;
+	}
+	if (ok)
+		info("asset cooker: %d outputs, %d cooked, %d from the cache, %d without a module, %d failed", n,
+			results[COOK_COOKED], results[COOK_CACHED], results[COOK_NONE], results[COOK_FAILED]);
+	ok = ok && !results[COOK_FAILED];
+	if (ok && settings->archive)
+		ok = assetArchiveWrite(settings->archive, files, packed, names);
+	free(items);
+	free(files);
+	free(names);
+	free(paths);
+	return ok;
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef HEADER_ASSETTASKS_H
+#define HEADER_ASSETTASKS_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include "Log.h"
+#include "AsyncIO.h"
+#include "JobSystem.h"
+
+/****************************************************************************
+* ASSET TASKS: loading steps which wait without blocking                   *
+****************************************************************************/
+
+/* AssetTask: an asset on its way through the steps of loading it (read,
+* parse, upload, wait for the upload, publish), each step on whatever runs
+* it: the reads on AsyncIO, the parsing on the job system, the upload on
+* the thread which owns the context. A task is a function which returns
+* whenever it has to wait and is called again once what it waits for is
+* done, and then goes on where it left off: a coroutine without a stack of
+* its own, in the manner of protothreads. ASSET_TASK_BEGIN opens a switch
+* on the line the task stopped at, each ASSET_AWAIT_* records its line,
+* returns and puts a case label there. So
+* - whatever the task keeps across an await lives in its struct, locals
+*   are gone when it returns (and may not be initialized in the body, the
+*   jumps to the case labels would cross that),
+* - there is at most one await per line, and none inside another switch.
+* A task ends by running off ASSET_TASK_END or with ASSET_TASK_EXIT.
+* AssetScheduler: runs the tasks of one thread. poll() reaps the reads
+* which are done, checks the job counters and the fences the tasks wait
+* for and resumes those which can go on, in the order they were started.
+* It never blocks, so the thread goes on with its other work in between
+* and calls poll() again. destroy() cancels the tasks: it waits for what
+* they wait for, then resumes each once more with cancelled set, and the
+* task releases what it holds and ends. */
+
+/* what a task waits for */
+enum {
+	ASSET_WAIT_NONE = 0,	/* nothing, it goes on with the next poll() */
+	ASSET_WAIT_IO,		/* the reads of AssetScheduler::read() */
+	ASSET_WAIT_JOBS,	/* the jobs counted by jobs */
+	ASSET_WAIT_FENCE,	/* fence, which the scheduler deletes */
+	ASSET_WAIT_DONE		/* the task ended */
+};
+
+struct AssetTask;
+typedef void (*AssetTaskFunc)(struct AssetTask *t);
+
+typedef struct AssetTask {
+	AssetTaskFunc resume;
+	int line;		/* where resume goes on, 0 at the start */
+	int wait;		/* ASSET_WAIT_* */
+	bool cancelled;		/* the scheduler goes away, give up */
+	/* the reads */
+	const AsyncFile *file;
+	GLubyte *readDst;	/* where readStart goes */
+	GLuint64 readStart, readEnd;	/* the range */
+	GLuint64 readNext;	/* the next chunk to queue */
+	GLuint64 readBytes;	/* done so far */
+	int readsPending;	/* queued and not done */
+	bool readFailed;
+	JobCounter jobs;
+	GLsync fence;
+	struct AssetTask *next;	/* in the scheduler */
+} AssetTask;
+
+#define ASSET_TASK_BEGIN(t) switch ((t)->line) { case 0:
+#define ASSET_TASK_END(t) ; } (t)->wait = ASSET_WAIT_DONE
+#define ASSET_TASK_EXIT(t) do { (t)->wait = ASSET_WAIT_DONE; return; } while (0)
+#define ASSET_AWAIT(t, kind) do { (t)->wait = (kind); (t)->line = __LINE__; return; case __LINE__:; } while (0)
+#define ASSET_YIELD(t) ASSET_AWAIT(t, ASSET_WAIT_NONE)
+#define ASSET_AWAIT_IO(t) ASSET_AWAIT(t, ASSET_WAIT_IO)
+#define ASSET_AWAIT_JOBS(t) ASSET_AWAIT(t, ASSET_WAIT_JOBS)
+/* t->fence, which must have been flushed */
+#define ASSET_AWAIT_FENCE(t) ASSET_AWAIT(t, ASSET_WAIT_FENCE)
+
+typedef struct {
+	AsyncIO *io;
+	JobSystem *jobs;	/* NULL, or without workers, runs the jobs right away */
+	AssetTask *tasks;	/* started and not done, in order */
+	int count;
+
+	void init(AsyncIO *asyncIO, JobSystem *jobSystem)
+	{
+		io = asyncIO;
+		jobs = jobSystem;
+		tasks = NULL;
+		count = 0;
+	}
+
+	/* Start t with f, which runs up to its first await with the next
+	* poll(). t stays where it is until it ends. */
+	void start(AssetTask *t, AssetTaskFunc f)
+	{
+		AssetTask **link = &tasks;
+		t->resume = f;
+		t->line = 0;
+		t->wait = ASSET_WAIT_NONE;
+		t->cancelled = false;
+		t->file = NULL;
+		t->readsPending = 0;
+		t->readNext = t->readEnd = 0;
+		t->jobs.reset();
+		t->fence = 0;
+		t->next = NULL;
+		while (*link)
+			link = &(*link)->next;
+		*link = t;
+		count++;
+	}
+
+	/* Read size bytes at offset of f into dst for t, in chunks of
+	* ASYNC_IO_CHUNK, as many in flight as AsyncIO takes; await them with
+	* ASSET_AWAIT_IO and check readDone(). The same rules for direct files
+	* hold as for AsyncIO::readAll(). */
+	void read(AssetTask *t, const AsyncFile *f, GLuint64 offset, GLuint64 size, void *dst)
+	{
+		t->file = f;
+		t->readDst = (GLubyte*)dst;
+		t->readStart = t->readNext = offset;
+		t->readEnd = offset + size;
+		t->readBytes = 0;
+		t->readFailed = false;
+		issue(t);
+	}
+
+	/* Whether all of the last read() of t arrived. */
+	bool readDone(const AssetTask *t) const
+	{
+		GLuint64 end = (t->readEnd < t->file->size) ? t->readEnd : t->file->size;
+		return !t->readFailed && t->readStart + t->readBytes >= end;
+	}
+
+	/* Queue the chunks of t AsyncIO has room for. */
+	void issue(AssetTask *t)
+	{
+		while (t->readNext < t->readEnd && !t->cancelled) {
+			GLuint64 chunk = t->readEnd - t->readNext;
+			if (chunk > ASYNC_IO_CHUNK)
+				chunk = ASYNC_IO_CHUNK;
+			if (t->file->direct)
+				chunk = asyncIOAlign(chunk);
+			if (!io->read(t->file, t->readNext, (size_t)chunk, t->readDst + (t->readNext - t->readStart), t))
+				return;
+			t->readNext += chunk;
+			t->readsPending++;
+		}
+	}
+
+	/* Call f(u, begin, end) for [0, n) on the job system, in chunks of
+	* grain, counted for t; await them with ASSET_AWAIT_JOBS. */
+	void parallelFor(AssetTask *t, JobFunc f, void *u, int n, int grain)
+	{
+		if (jobs && jobs->threadCount)
+			jobs->parallelFor(f, u, n, grain, &t->jobs);
+		else if (n > 0)
+			f(u, 0, n);
+	}
+
+	/* Take the reads which are done, waiting for one if wait is set. */
+	void reap(bool wait)
+	{
+		AsyncIOCompletion c[ASYNC_IO_DEPTH];
+		int i, n = io->complete(c, ASYNC_IO_DEPTH, wait);
+		for (i = 0; i < n; i++) {
+			AssetTask *t = (AssetTask*)c[i].user;
+			t->readsPending--;
+			if (c[i].bytes < 0)
+				t->readFailed = true;
+			else
+				t->readBytes += (GLuint64)c[i].bytes;
+		}
+	}
+
+	/* Whether what t waits for is done. */
+	bool ready(AssetTask *t)
+	{
+		switch (t->wait) {
+			case ASSET_WAIT_IO:
+				issue(t);
+				return !t->readsPending && (t->readNext >= t->readEnd || t->cancelled);
+			case ASSET_WAIT_JOBS:
+				return t->jobs.done();
+			case ASSET_WAIT_FENCE: {
+				GLenum status = glClientWaitSync(t->fence, 0, 0);
+				if (status == GL_TIMEOUT_EXPIRED)
+					return false;
+				if (status == GL_WAIT_FAILED)
+					warn("asset tasks: waiting for a fence failed");
+				glDeleteSync(t->fence);
+				t->fence = 0;
+				return true;
+			}
+		}
+		return true;
+	}
+
+	/* Resume the tasks which can go on, once each.
+	* Returns the number of tasks which have not ended. */
+	int poll()
+	{
+		AssetTask **link = &tasks;
+
+		if (!tasks)
+			return 0;
+		reap(false);
+		while (*link) {
+			AssetTask *t = *link;
+			if (ready(t)) {
+				t->wait = ASSET_WAIT_NONE;
+				t->resume(t);
+			}
+			if (t->wait == ASSET_WAIT_DONE) {
+				*link = t->next;
+				count--;
+			} else {
+				link = &t->next;
+			}
+		}
+		io->submit();
+		return count;
+	}
+
+	/* Cancel the tasks which have not ended, see above. */
+	void destroy()
+	{
+		AssetTask *t;
+
+		for (t = tasks; t; t = t->next)
+			t->cancelled = true;
+		io->submit();
+		while (io->inFlight)
+			reap(true);
+		for (t = tasks; t; t = t->next) {
+			if (t->wait == ASSET_WAIT_JOBS && jobs)
+				jobs->wait(&t->jobs);
+			if (t->fence)
+				glDeleteSync(t->fence);
+			t->fence = 0;
+			t->wait = ASSET_WAIT_NONE;
+			t->resume(t);
+			if (t->wait != ASSET_WAIT_DONE)
+				warn("asset tasks: a task did not end when cancelled");
+		}
+		if (count)
+			info("asset tasks: cancelled %d", count);
+		tasks = NULL;
+		count = 0;
+	}
+} AssetScheduler;
+
+#endif
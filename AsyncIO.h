@@ -0,0 +1,459 @@
+#ifndef HEADER_ASYNCIO_H
+#define HEADER_ASYNCIO_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define ASYNC_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "Log.h"
+
+/****************************************************************************
+* ASYNC I/O: many reads in flight                                          *
+****************************************************************************/
+
+/* AsyncIO: a queue of reads from files into memory, which are all in
+* flight at the same time, so the drive sees a deep queue instead of one
+* blocking read after the other (an NVMe drive needs a few dozen requests
+* in flight to reach its throughput). read() queues a read, submit() hands
+* all queued ones to the kernel in one call, complete() reaps those which
+* are done, in any order. On Linux this is an io_uring, set up with the
+* raw system calls, on Windows overlapped ReadFile with a completion port;
+* where neither is there (or the io_uring is not allowed, as in some
+* containers), read() reads right away with pread and complete() only
+* hands the results back.
+* Files opened direct bypass the page cache, the data goes from the drive
+* into the destination; then the offsets, sizes and the memory must be
+* multiples of ASYNC_IO_ALIGN. readAll() does all of that for a whole
+* range, in chunks of ASYNC_IO_CHUNK.
+* An AsyncIO belongs to one thread. */
+#define ASYNC_IO_DEPTH 64	/* reads in flight */
+#define ASYNC_IO_ALIGN 4096	/* of direct reads */
+#define ASYNC_IO_CHUNK (256 << 10)	/* bytes per read of readAll */
+
+typedef struct {
+#ifdef WIN32
+	HANDLE handle;
+#else
+	int fd;
+#endif
+	GLuint64 size;
+	bool direct;		/* the page cache is bypassed */
+} AsyncFile;
+
+typedef struct {
+	void *user;		/* of read() */
+	long long bytes;	/* read, negative for an error */
+} AsyncIOCompletion;
+
+typedef struct {
+#ifdef WIN32
+	OVERLAPPED overlapped;	/* first, the completions point to it */
+#else
+	struct iovec iov;
+#endif
+	void *user;
+	long long result;	/* of a read which completed right away */
+	int next;		/* the next free slot, plus one */
+} AsyncIOSlot;
+
+/* Round size up to a multiple of ASYNC_IO_ALIGN. */
+static GLuint64 asyncIOAlign(GLuint64 size)
+{
+	return (size + ASYNC_IO_ALIGN - 1) / ASYNC_IO_ALIGN * ASYNC_IO_ALIGN;
+}
+
+typedef struct {
+	AsyncIOSlot slots[ASYNC_IO_DEPTH];
+	int firstFree;		/* plus one, 0 if all are in flight */
+	int ready[ASYNC_IO_DEPTH];	/* slots which completed right away */
+	int readyCount;
+	int queue[ASYNC_IO_DEPTH];	/* slots read() since the last submit() */
+	int queued;
+	int inFlight;		/* read() and not complete() yet */
+	const char *backend;
+#ifdef WIN32
+	HANDLE port;
+#elif defined(ASYNC_IO_URING)
+	int ring;		/* the io_uring, -1 without one */
+	void *sqMap, *cqMap;
+	size_t sqMapSize, cqMapSize;
+	struct io_uring_sqe *sqes;
+	size_t sqesSize;
+	unsigned int *sqHead, *sqTail, *sqMask, *sqArray;
+	unsigned int *cqHead, *cqTail, *cqMask;
+	struct io_uring_cqe *cqes;
+#endif
+
+	void init()
+	{
+		int i;
+		for (i = 0; i < ASYNC_IO_DEPTH; i++)
+			slots[i].next = (i + 1 < ASYNC_IO_DEPTH) ? i + 2 : 0;
+		firstFree = 1;
+		readyCount = 0;
+		queued = inFlight = 0;
+		backend = "pread";
+#ifdef WIN32
+		port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+		if (port)
+			backend = "IOCP";
+#elif defined(ASYNC_IO_URING)
+		ring = -1;
+		if (initRing())
+			backend = "io_uring";
+#endif
+		info("async I/O: %s, %d reads in flight", backend, ASYNC_IO_DEPTH);
+	}
+
+#ifdef ASYNC_IO_URING
+	/* Set up the io_uring and map its rings.
+	* Returns false if there is none. */
+	bool initRing()
+	{
+		struct io_uring_params p;
+
+		memset(&p, 0, sizeof(p));
+		ring = (int)syscall(__NR_io_uring_setup, ASYNC_IO_DEPTH, &p);
+		if (ring < 0) {
+			info("async I/O: no io_uring (%s)", strerror(errno));
+			ring = -1;
+			return false;
+		}
+		sqMapSize = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+		cqMapSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+		if (p.features & IORING_FEAT_SINGLE_MMAP)
+			sqMapSize = cqMapSize = (sqMapSize > cqMapSize) ? sqMapSize : cqMapSize;
+		sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+		sqMap = mmap(NULL, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+		cqMap = (p.features & IORING_FEAT_SINGLE_MMAP) ? sqMap :
+			mmap(NULL, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+		sqes = (struct io_uring_sqe*)mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring, IORING_OFF_SQES);
+		if (sqMap == MAP_FAILED || cqMap == MAP_FAILED || (void*)sqes == MAP_FAILED) {
+			warn("async I/O: failed to map the io_uring");
+			destroyRing();
+			return false;
+		}
+		GLubyte *sq = (GLubyte*)sqMap, *cq = (GLubyte*)cqMap;
+		sqHead = (unsigned int*)(sq + p.sq_off.head);
+		sqTail = (unsigned int*)(sq + p.sq_off.tail);
+		sqMask = (unsigned int*)(sq + p.sq_off.ring_mask);
+		sqArray = (unsigned int*)(sq + p.sq_off.array);
+		cqHead = (unsigned int*)(cq + p.cq_off.head);
+		cqTail = (unsigned int*)(cq + p.cq_off.tail);
+		cqMask = (unsigned int*)(cq + p.cq_off.ring_mask);
+		cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+		return true;
+	}
+
+	void destroyRing()
+	{
+		if (sqes && (void*)sqes != MAP_FAILED)
+			munmap(sqes, sqesSize);
+		if (cqMap && cqMap != MAP_FAILED && cqMap != sqMap)
+			munmap(cqMap, cqMapSize);
+		if (sqMap && sqMap != MAP_FAILED)
+			munmap(sqMap, sqMapSize);
+		sqMap = cqMap = NULL;
+		sqes = NULL;
+		::close(ring);
+		ring = -1;
+	}
+#endif
+
+	/* Wait for the reads in flight and free everything. */
+	void destroy()
+	{
+		AsyncIOCompletion c[ASYNC_IO_DEPTH];
+		submit();
+		while (inFlight && complete(c, ASYNC_IO_DEPTH, true) > 0);
+#ifdef WIN32
+		if (port)
+			CloseHandle(port);
+		port = NULL;
+#elif defined(ASYNC_IO_URING)
+		if (ring >= 0)
+			destroyRing();
+#endif
+	}
+
+	/* Open filename for reading, direct if possible and asked for.
+	* Returns true if successfull and false in case of an error. */
+	bool open(AsyncFile *f, const char *filename, bool direct)
+	{
+#ifdef WIN32
+		f->direct = direct;
+		f->handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_OVERLAPPED | (direct ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_SEQUENTIAL_SCAN), NULL);
+		if (f->handle == INVALID_HANDLE_VALUE && direct) {
+			f->direct = false;
+			f->handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+				FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		}
+		LARGE_INTEGER size;
+		if (f->handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(f->handle, &size) ||
+			(port && CreateIoCompletionPort(f->handle, port, 0, 0) != port)) {
+			if (f->handle != INVALID_HANDLE_VALUE)
+				CloseHandle(f->handle);
+			f->handle = INVALID_HANDLE_VALUE;
+			warn("async I/O: failed to open '%s'", filename);
+			return false;
+		}
+		f->size = (GLuint64)size.QuadPart;
+#else
+		struct stat st;
+		f->fd = -1;
+		f->direct = false;
+#ifdef O_DIRECT
+		/* not every file system can, tmpfs for one */
+		if (direct) {
+			f->fd = ::open(filename, O_RDONLY | O_DIRECT);
+			f->direct = f->fd >= 0;
+		}
+#endif
+		if (f->fd < 0)
+			f->fd = ::open(filename, O_RDONLY);
+		if (f->fd < 0 || fstat(f->fd, &st)) {
+			if (f->fd >= 0)
+				::close(f->fd);
+			f->fd = -1;
+			warn("async I/O: failed to open '%s'", filename);
+			return false;
+		}
+		f->size = (GLuint64)st.st_size;
+#endif
+		return true;
+	}
+
+	/* Close f, which has no reads in flight. */
+	void close(AsyncFile *f)
+	{
+#ifdef WIN32
+		if (f->handle != INVALID_HANDLE_VALUE)
+			CloseHandle(f->handle);
+		f->handle = INVALID_HANDLE_VALUE;
+#else
+		if (f->fd >= 0)
+			::close(f->fd);
+		f->fd = -1;
+#endif
+	}
+
+	/* Queue reading size bytes at offset of f into dst, which stay as
+	* they are until complete() returns the read, with user. For a direct
+	* f, offset, size and dst must be multiples of ASYNC_IO_ALIGN.
+	* Returns false if ASYNC_IO_DEPTH reads are in flight. */
+	bool read(const AsyncFile *f, GLuint64 offset, size_t size, void *dst, void *user)
+	{
+		if (!firstFree)
+			return false;
+		int i = firstFree - 1;
+		AsyncIOSlot *s = &slots[i];
+		firstFree = s->next;
+		s->user = user;
+		inFlight++;
+#ifdef WIN32
+		memset(&s->overlapped, 0, sizeof(s->overlapped));
+		s->overlapped.Offset = (DWORD)offset;
+		s->overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		if (port) {
+			if (!ReadFile(f->handle, dst, (DWORD)size, NULL, &s->overlapped) &&
+				GetLastError() != ERROR_IO_PENDING) {
+				s->result = -(long long)GetLastError();
+				ready[readyCount++] = i;
+			}
+			return true;
+		}
+		/* without a port, wait for each read */
+		DWORD bytes = 0;
+		s->overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+		if ((ReadFile(f->handle, dst, (DWORD)size, NULL, &s->overlapped) || GetLastError() == ERROR_IO_PENDING) &&
+			GetOverlappedResult(f->handle, &s->overlapped, &bytes, TRUE))
+			s->result = (long long)bytes;
+		else
+			s->result = -(long long)GetLastError();
+		if (s->overlapped.hEvent)
+			CloseHandle(s->overlapped.hEvent);
+		ready[readyCount++] = i;
+#else
+		s->iov.iov_base = dst;
+		s->iov.iov_len = size;
+#ifdef ASYNC_IO_URING
+		if (ring >= 0) {
+			unsigned int tail = *sqTail, index = tail & *sqMask;
+			struct io_uring_sqe *sqe = &sqes[index];
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = f->fd;
+			sqe->off = offset;
+			sqe->addr = (unsigned long long)(size_t)&s->iov;
+			sqe->len = 1;
+			sqe->user_data = (unsigned long long)i;
+			sqArray[index] = index;
+			/* the kernel sees the entry before the new tail */
+			__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+			queue[queued++] = i;
+			return true;
+		}
+#endif
+		ssize_t bytes = pread(f->fd, dst, size, (off_t)offset);
+		s->result = (bytes < 0) ? -(long long)errno : (long long)bytes;
+		ready[readyCount++] = i;
+#endif
+		return true;
+	}
+
+	/* Hand all reads queued since the last call to the kernel.
+	* Returns false in case of an error, then those which were not taken
+	* complete with one. */
+	bool submit()
+	{
+		int first = 0;
+#ifdef ASYNC_IO_URING
+		while (first < queued && ring >= 0) {
+			int n = (int)syscall(__NR_io_uring_enter, ring, queued - first, 0, 0, NULL, 0);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0) {
+				warn("async I/O: failed to submit %d reads (%s)", queued - first, strerror(errno));
+				/* the kernel takes the entries in order and only here,
+				* so the rest can be taken back */
+				__atomic_store_n(sqTail, *sqTail - (unsigned int)(queued - first), __ATOMIC_RELEASE);
+				for (; first < queued; first++) {
+					slots[queue[first]].result = -EIO;
+					ready[readyCount++] = queue[first];
+				}
+				queued = 0;
+				return false;
+			}
+			first += n;
+		}
+#endif
+		queued = 0;
+		return true;
+	}
+
+	/* Take up to max reads which are done into c, waiting for at least
+	* one if wait is set and any are in flight.
+	* Returns the number of reads taken. */
+	int complete(AsyncIOCompletion *c, int max, bool wait)
+	{
+		int n = 0;
+
+		while (n < max && readyCount) {
+			int i = ready[--readyCount];
+			n = take(c, n, i, slots[i].result);
+		}
+		if (n || !inFlight)
+			return n;
+#ifdef WIN32
+		OVERLAPPED_ENTRY entries[ASYNC_IO_DEPTH];
+		ULONG removed = 0;
+		if (!port || !GetQueuedCompletionStatusEx(port, entries, (ULONG)(max < ASYNC_IO_DEPTH ? max : ASYNC_IO_DEPTH),
+			&removed, wait ? INFINITE : 0, FALSE))
+			return n;
+		for (ULONG k = 0; k < removed; k++) {
+			AsyncIOSlot *s = (AsyncIOSlot*)entries[k].lpOverlapped;
+			/* Internal is the status of the read */
+			long long bytes = entries[k].lpOverlapped->Internal ? -1 : (long long)entries[k].dwNumberOfBytesTransferred;
+			n = take(c, n, (int)(s - slots), bytes);
+		}
+#elif defined(ASYNC_IO_URING)
+		if (ring < 0)
+			return n;
+		unsigned int head = *cqHead, tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+		if (head == tail && wait) {
+			while (syscall(__NR_io_uring_enter, ring, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno == EINTR);
+			tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+		}
+		for (; head != tail && n < max; head++) {
+			const struct io_uring_cqe *cqe = &cqes[head & *cqMask];
+			n = take(c, n, (int)cqe->user_data, (long long)cqe->res);
+		}
+		/* the kernel may reuse the entries */
+		__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+#else
+		(void)wait;
+#endif
+		return n;
+	}
+
+	int take(AsyncIOCompletion *c, int n, int i, long long bytes)
+	{
+		c[n].user = slots[i].user;
+		c[n].bytes = bytes;
+		slots[i].next = firstFree;
+		firstFree = i + 1;
+		inFlight--;
+		return n + 1;
+	}
+
+	/* Read size bytes at offset of f into dst, in chunks of
+	* ASYNC_IO_CHUNK which are all in flight together, and wait for them.
+	* For a direct f, offset and dst must be multiples of ASYNC_IO_ALIGN,
+	* and dst must have room for size rounded up to one.
+	* Returns true if successfull and false in case of an error. */
+	bool readAll(const AsyncFile *f, GLuint64 offset, GLuint64 size, void *dst)
+	{
+		AsyncIOCompletion c[ASYNC_IO_DEPTH];
+		GLuint64 issued = 0, end = offset + size;
+		bool ok = true;
+		int pending = 0, i, n;
+
+		while ((ok && issued < size) || pending) {
+			while (ok && issued < size) {
+				GLuint64 chunk = (size - issued < ASYNC_IO_CHUNK) ? size - issued : ASYNC_IO_CHUNK;
+				if (f->direct)
+					chunk = asyncIOAlign(chunk);
+				/* the user of a read is where it starts */
+				if (!read(f, offset + issued, (size_t)chunk, (GLubyte*)dst + issued, (void*)(size_t)issued))
+					break;
+				issued += chunk;
+				pending++;
+			}
+			if (!submit())
+				ok = false;
+			n = complete(c, ASYNC_IO_DEPTH, true);
+			if (!n && pending) {
+				warn("async I/O: %d reads got lost", pending);
+				return false;
+			}
+			for (i = 0; i < n; i++) {
+				GLuint64 at = offset + (GLuint64)(size_t)c[i].user;
+				GLuint64 expected = (end - at < ASYNC_IO_CHUNK) ? end : at + ASYNC_IO_CHUNK;
+				/* short only at the end of the file */
+				if (expected > f->size)
+					expected = f->size;
+				if (c[i].bytes < 0 || at + (GLuint64)c[i].bytes < expected)
+					ok = false;
+				pending--;
+			}
+		}
+		return ok;
+	}
+} AsyncIO;
+
+#endif
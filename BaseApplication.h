@@ -4,7 +4,108 @@
 #include <GLFW/glfw3.h>
 #include <glm/mat4x4.hpp>
 #include <glad/glad.h>
+#include "Camera.h"
 #include "Cube.h"
+#include "BufferPool.h"
+#include "Scene.h"
+#include "SceneGenerator.h"
+#include "SceneSnapshot.h"
+#include "VoxelWorld.h"
+#include "VoxelOctree.h"
+#include "MeshFile.h"
+#include "Meshlets.h"
+#include "Streamer.h"
+#include "VirtualTexture.h"
+#include "SdfScene.h"
+#include "SdfBake.h"
+#include "SdfCone.h"
+#include "SdfTemporal.h"
+#include "SdfCompute.h"
+#include "ClusteredLights.h"
+#include "ShadowMaps.h"
+#include "SdfField.h"
+#include "SpatialGrid.h"
+#include "GpuPrimitives.h"
+#include "Particles.h"
+#include "FrustumCuller.h"
+#include "Broadphase.h"
+#include "JobSystem.h"
+#include "RenderQueue.h"
+#include "Materials.h"
+#include "ProgramRegistry.h"
+#include "UniformSpecializer.h"
+#include "GpuProfiler.h"
+#include "FrameStats.h"
+#include "FlightRecorder.h"
+#include "Telemetry.h"
+#include "RenderTarget.h"
+#include "DynamicResolution.h"
+#include "ShadingRate.h"
+#include "PostProcess.h"
+#include "TemporalAA.h"
+#include "HalfResEffects.h"
+#include "Tessellation.h"
+#include "Displacement.h"
+#include "Impostors.h"
+#include "DebugDraw.h"
+#include "Picking.h"
+#include "SpriteBatch.h"
+#include "Overlay.h"
+#include "Capture.h"
+#include "FrameShare.h"
+#include "StreamServer.h"
+#include "Transparency.h"
+#include "Simulation.h"
+#include "Animation.h"
+#include "Skinning.h"
+#include "RenderThread.h"
+#include "InputQueue.h"
+#include "Replay.h"
+#include "FramePacer.h"
+#include "IdleMode.h"
+#include "ViewportWindows.h"
+#include "ShaderWatcher.h"
+#include "GLLoader.h"
+#include "GLTrace.h"
+#include "GLMemory.h"
+#include "Startup.h"
+#include "HeadlessContext.h"
+
+/* window flags for initBaseApp */
+#define APP_WINDOW_HIDDEN	0x1	/* do not show the window, implies offscreen rendering */
+#define APP_WINDOW_EGL		0x2	/* create the context via EGL (needs GLFW >= 3.2) */
+#define APP_WINDOW_GL_DEBUG	0x4	/* a debug context with debug output, also in release builds */
+#define APP_WINDOW_SAMPLES(n)	((unsigned int)(n) << 8)	/* multisample the default framebuffer */
+#define APP_WINDOW_SAMPLE_COUNT(flags)	(((flags) >> 8) & 0xffu)
+#define APP_WINDOW_HEADLESS	0x8	/* no window, an EGL context on a GPU, implies hidden */
+#define APP_WINDOW_DEVICE(n)	((unsigned int)(n) << 16)	/* the GPU of the headless context */
+#define APP_WINDOW_DEVICE_INDEX(flags)	((int)(((flags) >> 16) & 0xffu))
+#define APP_WINDOW_DIRECT_IO	0x10	/* the streamer reads the mesh files past the page cache */
+
+/* FrameUniforms: the per-frame state shared by all shaders, in the std140
+* layout of the "Frame" uniform block declared in the shaders. */
+typedef struct {
+	glm::mat4 projection;
+	glm::mat4 modelView;
+	glm::vec4 cameraPosition;	/* vec3 padded to vec4 as std140 requires */
+	GLfloat time;
+	GLuint frameIndex;		/* counts the frames */
+	GLuint lightCount;		/* of ClusteredLights.h, 0 without lighting */
+	GLfloat cutRadius;		/* of the sphere the CUT programs cut out of the cube */
+	glm::mat4 viewProjection;	/* without the model transform */
+	glm::mat4 viewProjectionInverse;	/* unprojects the rays of the raymarching program */
+	ShadowUniforms shadows;		/* the sun, see ShadowMaps.h */
+	glm::vec4 instanceBox;		/* of the packed instances, see BaseApplication::instanceBox */
+	glm::vec4 instanceEye;		/* the camera relative to BaseApplication::instanceOrigin */
+	glm::mat4 modelViewProjection;	/* projection * modelView, so no vertex multiplies the two */
+} FrameUniforms;
+
+/* the blocks of FrameUniforms written per frame: the frame's own and one
+* for each shadow map drawn, see BaseApplication::pushFrameUniforms */
+#define FRAME_UNIFORM_BLOCKS (1 + SHADOW_CASCADES)
+
+/* the numbers the pipeline states depend on, see updatePipelineStates */
+#define PIPELINE_KEY_SIZE 17
 
 /* CubeApp: We encapsulate all of our application state in this struct.
 * We use a single instance of this object (in main), and set a pointer to
@@ -16,92 +117,1722 @@ typedef struct {
 	GLFWwindow *win;
 	int width, height;
 	unsigned int flags;
+	bool hidden;		/* the window is not shown */
+	bool directIO;		/* APP_WINDOW_DIRECT_IO */
+
+	/* offscreen rendering: draw into an FBO instead of the window and
+	* optionally blit the result into the window */
+	RenderTarget offscreen;
+	bool renderOffscreen;
+	bool presentOffscreen;
+	/* the size frames are rendered at, smaller than the window with
+	* dynamic resolution */
+	DynamicResolution resolution;
+	int renderWidth, renderHeight;
+
+	/* timing */
+	double timeCur, timeDelta;
+	Simulation simulation;	/* advanced in fixed steps, the frames interpolate it */
+	RenderThread renderThread;	/* draws the frames if it is running */
+	FramePacer pacer;	/* starts the frames as late as possible, if enabled */
+	IdleMode idle;		/* draws only when something changes, if enabled */
+	ViewportSet viewports;	/* more windows showing columns of the frame */
+	bool tearControl;	/* swap interval -1: late frames tear instead of waiting */
+	double avg_frametime;
+	double avg_fps;
+	double avg_gputime;	/* GPU time per frame in ms, from gpuProfiler */
+	FrameStats frameStats;	/* per-frame time distribution, see updateFrameStats */
+	bool logFrameStats;	/* log the distribution whenever it is updated */
+	GpuProfiler gpuProfiler;
+	Overlay overlay;	/* the statistics on top of the frame, instead of the title */
+	const char *traceFile;	/* where exportTrace writes the zones of Profiler.h */
+	FlightRecorder flight;	/* writes them whenever a frame is slow */
+	Telemetry telemetry;	/* clocks, power and temperatures, if started */
+	FrameCapture capture;	/* screenshots and recordings of the frames */
+	FrameShare share;	/* the frames for another process, without a readback */
+	StreamServer stream;	/* the frames for a remote viewer, and its input */
+	const char *captureFile;	/* what toggleRecording records into */
+
+	/* the window events, from the callbacks to the main loop */
+	InputQueue input;
+	Replay replay;		/* records them with the time steps, or plays them back */
+
+	/* the cube we want to render */
+	Cube cube;
+	int vertexFormat;	/* VERTEX_FORMAT_* of the cube and the scene */
+	MeshletCuller meshlets;	/* GPU culling of the meshlets of a loaded mesh */
+	Streamer streamer;	/* loads mesh files in the background */
+	BufferPool meshPool;	/* holds the vertices and indices of the cube */
+	VirtualTexture virtualTexture;	/* its pages are committed by the streamer */
+
+	/* instanced mode: draw a grid of instanceGrid^3 cubes in one call */
+	bool instanced;
+	int instanceGrid;
+	bool vertexPulling;	/* the cubes are made up by the vertex shader, see Cube::drawPulled */
+	bool compactInstances;	/* 12 bytes per instance instead of a matrix, see Cube::drawCompact */
+	bool gpuAnimation;	/* the pulled cubes spin by themselves, see Cube::drawSpinning */
+	FrustumCuller instanceCuller;	/* bounding spheres of the instances */
+	bool cpuCulling;	/* cull the instances, it has no GPU culling */
+	SpatialGrid instanceCells;	/* the instances sorted by cell, see setGridCulling */
+	Broadphase instanceBroadphase;	/* the instances which overlap, see setBroadphase */
+
+	/* scene mode: draw a grid of sceneGrid^3 objects of several meshes
+	* with one multi-draw call, or the scene of sceneGen if it has objects */
+	Scene scene;
+	bool sceneMode;
+	int sceneGrid;
+	SceneGenParams sceneGen;
+	const char *snapshotFile;	/* resume the scene from this snapshot and write it on exit, or NULL */
+	/* draw the scene object by object from command lists recorded by the
+	* jobs, which it also does without multi-draw */
+	CommandQueue commands;
+	bool commandLists;
+
+	/* voxel mode: a terrain of voxelGrid x VOXEL_WORLD_HEIGHT x voxelGrid
+	* chunks, a draw per visible chunk, see VoxelWorld.h */
+	VoxelWorld voxels;
+	bool voxelMode;
+	int voxelGrid;
+	/* or raymarch them, see VoxelOctree.h */
+	VoxelOctree voxelOctree;
+	bool voxelRaymarch;
+	int voxelProgram;	/* registry index of the voxel raymarching program, -1 if none */
+
+	/* for culling and writing the matrices of the grids in parallel */
+	JobSystem jobs;
+
+	/* the distance between the objects of the grids above */
+	float gridSpacing;
+	bool culling;		/* cull the grids: the scene on the GPU, the instances on the CPU */
+	bool gridCulling;	/* cull them by the cells of a spatial hash first */
+	bool broadphase;	/* find the instances which overlap in every frame */
+	bool gpuTransforms;	/* the world matrices of the scene computed on the GPU */
+	float lodError;		/* the error of a level of detail in pixels we accept, 0 for none */
+
+	/* the OpenGL state we need for the shaders */
+	ProgramRegistry programs;	/* all shader combinations, prebuilt */
+	int currentProgram;	/* registry index of the selected program */
+	int keyPrograms[10];	/* registry index of the program on each number key */
+	int virtualProgram;	/* registry index of the one drawing with virtualTexture, -1 if none */
+	int sdfProgram;		/* registry index of the raymarching program drawing sdf, -1 if none */
+	SdfScene sdf;		/* the scene of the raymarching program */
+	SdfBaker sdfBaker;	/* its distances in a 3D texture */
+	SdfConeMarcher sdfCone;	/* the pre-pass of the raymarching program */
+	SdfTemporal sdfTemporal;	/* its checkerboard rendering */
+	SdfComputeMarcher sdfCompute;	/* the raymarching program as a compute shader */
+	SdfField sdfField;	/* many more primitives next to sdf */
+	GpuPrimitives primitives;	/* scan, compaction and sorting on the GPU, program 0 until needed */
+	GpuParticles particles;	/* a fountain simulated on the GPU, program 0 if off */
+	ClusteredLights lights;	/* point lights of the material shaders */
+	ShadowMaps shadows;	/* of the sun lighting the material shaders */
+	Animator animator;	/* the joints of the characters of the instanced grid */
+	double animationTime;	/* milliseconds of its last update */
+	SkinnedCharacters skinning;	/* its characters as skinned meshes instead of the grid */
+	ShadingRateImage shadingRate;	/* coarse shading of the programs with RASTER_COARSE */
+	PostProcess post;	/* between the offscreen target and the window */
+	TemporalAA taa;		/* jitters the frames and accumulates them */
+	HalfResEffects halfRes;	/* fog and the like, at a reduced size */
+	Tessellation tessellation;	/* of the wobbling cubes */
+	Displacement displacement;	/* or their vertices, wobbled once per frame */
+	Impostors impostors;	/* billboards for the distant instances */
+	Picking picking;	/* the object under the cursor, from the ids of the main pass */
+	TransparencyPass transparency;	/* draws the translucent packets of queue */
+	int translucentPrograms[OIT_MODES];	/* registry index of the translucent program per mode, -1 if none */
+	GLuint program;		/* the program (pipeline in separable mode) in use, owned by the registry */
+	ProgramReflection *uniforms;	/* reflection of program, set uniforms by name */
+	RenderQueue queue;	/* the draws of a frame, sorted by state */
+	bool depthPrepass;	/* draw with the depth pre-pass of the program */
+	GLuint prepassProgram;	/* of program, 0 if there is none or it is off */
+	GLuint shadowProgram;	/* of program casting shadows, 0 if they are off or it shows none */
+	unsigned int raster;	/* RASTER_* flags of program */
+	unsigned int pipelineKey[PIPELINE_KEY_SIZE];	/* what the pipeline states were built for */
+	bool faceCulling;	/* cull back faces for the programs which allow it */
+	MaterialTable materials;	/* of the scene objects */
+	ShaderWatcher shaderWatcher;	/* rebuilds programs whose files changed */
+	RingBuffer frameUBO;	/* per-frame FrameUniforms at FRAME_UBO_BINDING */
+	GLint uboAlignment;	/* GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT */
+	GLintptr frameOffset;	/* of this frame's block in frameUBO */
+	UniformSpecializer specializer;	/* program with the values of the frame which stay the same baked in */
+	GLfloat cutRadius;	/* of the sphere the CUT programs cut out of the cube */
+
+	/* the global transformation matrices, see Camera.h */
+	Camera camera;
+	bool cameraPlaced;	/* use cameraEye and cameraTarget, not the default position */
+	glm::vec3 cameraEye, cameraTarget;
+	/* large worlds: where the instance grid is, see gridOrigin(), and
+	 * whether its matrices are relative to the camera, see
+	 * instanceOrigin() */
+	glm::dvec3 worldOrigin;
+	bool cameraRelative;
+	/* those of the previous frame, for reprojecting it */
+	glm::mat4 previousProjection;
+	glm::mat4 previousView;
+	glm::mat4 previousRotation;	/* the view as seen from the origin */
+	glm::dvec3 previousEye;
+	glm::mat4 previousModel;	/* of the cube */
+	GLuint frameIndex;	/* counts the frames drawn */
+
+	/* Create the ring buffer for the per-frame uniforms.
+	* Returns true if successfull and false in case of an error. */
+	bool initFrameUniforms()
+	{
+		uboAlignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+		if (uboAlignment < 1)
+			uboAlignment = 1;
+		/* FRAME_UNIFORM_BLOCKS per frame, each rounded up so every
+		* one stays aligned */
+		GLsizeiptr size = (sizeof(FrameUniforms) + uboAlignment - 1) / uboAlignment * uboAlignment;
+		return frameUBO.init(GL_UNIFORM_BUFFER, size * FRAME_UNIFORM_BLOCKS, "frame uniforms");
+	}
+
+	/* Write this frame's uniforms with a single buffer write and bind them
+	* for all programs. */
+	void updateFrameUniforms(const FrameUniforms *data)
+	{
+		frameUBO.beginFrame();
+		frameOffset = pushFrameUniforms(data);
+	}
+
+	/* Write another block of uniforms for this frame, e.g. those of a
+	* shadow map, and bind it for all programs until bindFrameUniforms()
+	* goes back to the frame's own.
+	* Returns its offset, -1 if there is no room left. */
+	GLintptr pushFrameUniforms(const FrameUniforms *data)
+	{
+		GLintptr offset;
+		void *dst = frameUBO.map(sizeof(FrameUniforms), uboAlignment, &offset);
+		if (!dst)
+			return -1;
+		memcpy(dst, data, sizeof(FrameUniforms));
+		frameUBO.unmap();
+		glState()->bindBufferRange(GL_UNIFORM_BUFFER, FRAME_UBO_BINDING, frameUBO.buffer, offset, sizeof(FrameUniforms));
+		return offset;
+	}
+
+	/* Bind the frame's own uniforms again. */
+	void bindFrameUniforms()
+	{
+		if (frameOffset >= 0)
+			glState()->bindBufferRange(GL_UNIFORM_BUFFER, FRAME_UBO_BINDING, frameUBO.buffer, frameOffset,
+				sizeof(FrameUniforms));
+	}
+
+	/* Show the specializer this frame's values and let the queue draw the
+	* program in use with the values which stay the same baked in, as soon
+	* as that is built, see UniformSpecializer.h. Call this after
+	* updateFrameUniforms and before the draws are pushed. */
+	void specializeUniforms(const FrameUniforms *frame)
+	{
+		UniformSpecializer *s = &specializer;
+		if (!s->enabled || programs.separable || currentProgram < 0)
+			return;
+		/* in the order they were added in clear() */
+		s->observe(0, &frame->projection[0][0]);
+		s->observe(1, &frame->modelView[0][0]);
+		s->observe(2, &frame->lightCount);
+		s->observe(3, &frame->cutRadius);
+		s->observe(4, &frame->modelViewProjection[0][0]);
+		/* not while a switch to another program is pending */
+		int variant = drawVariant();
+		if (program == programs.get(currentProgram, variant))
+			s->select(currentProgram, variant, programs.entries[currentProgram].prepass, program, prepassProgram);
+		s->update(&programs);
+		queue.specialize(s->generic, s->genericPrepass, s->program, s->prepass);
+		/* the states of a new specialization are prewarmed like the others */
+		updatePipelineStates();
+	}
+
+	/* Select the registered program index. The switch happens as soon as
+	* the program for the current mode is linked, until then the previous
+	* program stays in use. Selecting the current program rebuilds it. */
+	void selectProgram(int index)
+	{
+		if (index < 0 || index >= programs.count) {
+			warn("no program %d registered", index);
+			return;
+		}
+		/* the translucent program has a variant for each transparency
+		* mode, and its pass draws into the offscreen target */
+		if (translucentMode(index) >= 0) {
+			if (!transparency.supported(transparency.mode)) {
+				warn("order-independent transparency is not supported");
+				return;
+			}
+			if (!renderOffscreen && !setOffscreen(true, true))
+				return;
+			index = translucentPrograms[transparency.mode];
+		}
+		if (index == currentProgram) {
+			/* selecting the current program again reloads it from the
+			* source files, so the shaders can be edited at runtime */
+			info("reloading program %d", index);
+			programs.rebuild(index);
+		}
+		currentProgram = index;
+		updateProgram();
+	}
+
+	/* Advance the background program builds and pick up the selected
+	* program once it is ready. Call this once per frame. */
+	void updateProgram()
+	{
+		char changed[SHADER_WATCHER_MAX_CHANGES][SHADER_WATCHER_PATH];
+		int i, n = shaderWatcher.poll(changed, SHADER_WATCHER_MAX_CHANGES);
+		for (i = 0; i < n; i++)
+			programs.rebuildFile(changed[i]);
+
+		programs.update();
+		updatePipelineStates();
+		if (currentProgram < 0)
+			return;
+		int variant = drawVariant();
+		GLuint p = programs.get(currentProgram, variant);
+		if (p && p != program) {
+			info("switching to program %u", p);
+			program = p;
+			/* the last frame's depth may hide what this program shows */
+			scene.hiz.invalidate();
+			scene.queries.invalidate();
+			uniforms = programs.getReflection(currentProgram, variant);
+			/* the shaders must agree with FrameUniforms */
+			const ReflectedBlock *frame = uniforms ? uniforms->findBlock("Frame") : NULL;
+			if (frame && frame->dataSize > (GLint)sizeof(FrameUniforms))
+				warn("program %u: block Frame has %d bytes, FrameUniforms only %d",
+					program, (int)frame->dataSize, (int)sizeof(FrameUniforms));
+		}
+		/* the pre-pass must belong to the program we draw with */
+		prepassProgram = 0;
+		if (depthPrepass && program == p)
+			prepassProgram = programs.get(programs.entries[currentProgram].prepass, variant);
+		/* and so must the shadows */
+		GLuint shadow = (program == p) ? programShadow(currentProgram, variant) : 0;
+		if (shadow != shadowProgram)
+			shadows.invalidate();
+		shadowProgram = shadow;
+		/* and so must the raster state */
+		if (program == p)
+			raster = programRaster(currentProgram);
+	}
+
+	/* The raster state registry entry index draws with, with the options. */
+	unsigned int programRaster(int index) const
+	{
+		unsigned int r = programs.getRaster(index);
+		if (!faceCulling)
+			r &= ~RASTER_CULL;
+		/* the checkerboard already halves the rate, and would have its
+		* pattern shaded at coarse rates */
+		if (!shadingRate.enabled || (index == sdfProgram && sdfTemporal.enabled))
+			r &= ~RASTER_COARSE;
+		return r;
+	}
+
+	/* The program casting the shadows of registry entry index for
+	* variant: its depth-only variant, if it receives them.
+	* Returns 0 if there is none, the shadows are off or index is not an
+	* entry. */
+	GLuint programShadow(int index, int variant)
+	{
+		if (index < 0 || index >= programs.count)
+			return 0;
+		ProgramReflection *r = programs.getReflection(index, variant);
+		if (!shadows.texture || programs.entries[index].prepass < 0 || !r || !r->find("shadowMap"))
+			return 0;
+		return programs.get(programs.entries[index].prepass, variant);
+	}
+
+	/* Create the pipeline states of every program of the registry, with
+	* the VAOs its variant draws and for each pass it is drawn in, and
+	* prewarm them, see PipelineState.h; again from scratch whenever a
+	* program, a VAO or an option they depend on changed. The queue finds
+	* them ready when the draws are pushed. */
+	void updatePipelineStates()
+	{
+		unsigned int key[PIPELINE_KEY_SIZE] = { programs.version, cube.vao, cube.pullVao, cube.compactVao, scene.vao,
+			skinning.vao, sdf.vao, voxels.vao, shadows.texture, renderFramebuffer(), (unsigned int)depthPrepass, (unsigned int)faceCulling,
+			(unsigned int)shadingRate.enabled, (unsigned int)sdfTemporal.enabled, (unsigned int)programs.separable,
+			specializer.program, specializer.prepass };
+		bool prepass[PROGRAM_REGISTRY_MAX] = { false };
+		int i, j, k, ids[RENDER_PASSES];
+
+		if (!memcmp(key, pipelineKey, sizeof(key)))
+			return;
+		memcpy(pipelineKey, key, sizeof(key));
+		queue.states.clear();
+		queue.states.separable = programs.separable;
+		for (i = 0; i < programs.count; i++)
+			if (programs.entries[i].prepass >= 0)
+				prepass[programs.entries[i].prepass] = true;
+		for (i = 0; i < programs.count; i++) {
+			/* the pre-pass programs draw in the passes of theirs */
+			if (prepass[i])
+				continue;
+			unsigned int r = programRaster(i);
+			for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+				GLuint p = programs.get(i, j);
+				if (!p)
+					continue;
+				bool raymarch = i == sdfProgram || i == voxelProgram;
+				GLuint depth = (depthPrepass && !raymarch) ? programs.get(programs.entries[i].prepass, j) : 0;
+				GLuint shadow = !raymarch ? programShadow(i, j) : 0;
+				GLuint vaos[3] = { cube.vao, 0, 0 };
+				if (raymarch) {
+					vaos[0] = sdf.vao;
+				} else if (j == PROGRAM_VARIANT_PULLED) {
+					if (!programs.hasVariant(i, j))
+						continue;
+					vaos[0] = cube.pullVao;
+				} else if (j == PROGRAM_VARIANT_COMPACT) {
+					if (!programs.hasVariant(i, j))
+						continue;
+					vaos[0] = cube.compactVao;
+				} else if (j == PROGRAM_VARIANT_INSTANCED) {
+					vaos[1] = scene.vao;
+					vaos[2] = skinning.vao;
+				} else {
+					vaos[1] = voxels.vao;
+				}
+				for (k = 0; k < 3; k++) {
+					if (!vaos[k])
+						continue;
+					queue.prepare(p, vaos[k], r, depth, shadow, ids);
+					/* and the specialization of p, see specializeUniforms */
+					if (p == specializer.generic && specializer.program)
+						queue.prepare(specializer.program, vaos[k], r, depth ? specializer.prepass : 0, shadow, ids);
+				}
+			}
+		}
+		GLuint targets[PIPELINE_TARGETS] = { renderFramebuffer(), shadows.fbo };
+		queue.states.prewarm(targets);
+	}
+
+	/* The transparency mode whose translucent program is the registry
+	* index, -1 if it is none of them. */
+	int translucentMode(int index) const
+	{
+		int i;
+		for (i = 0; i < OIT_MODES; i++)
+			if (index >= 0 && translucentPrograms[i] == index)
+				return i;
+		return -1;
+	}
+
+	/* Draw the translucent programs with order-independent transparency
+	* of mode OIT_*, see Transparency.h.
+	* Returns true if successfull and false if it is not supported. */
+	bool setTransparencyMode(int mode)
+	{
+		if (!transparency.setMode(mode)) {
+			warn("order-independent transparency with %s is not supported", oitModeNames[mode]);
+			return false;
+		}
+		info("order-independent transparency: %s", oitModeNames[mode]);
+		/* the shaders of the translucent program depend on the mode */
+		if (translucentMode(currentProgram) >= 0 && translucentPrograms[mode] >= 0) {
+			currentProgram = translucentPrograms[mode];
+			updateProgram();
+		}
+		return true;
+	}
+
+	/* Switch the checkerboard rendering of the raymarching program with
+	* temporal reprojection on or off, see SdfTemporal.h. */
+	bool setSdfTemporal(bool enable)
+	{
+		if (enable && !sdfTemporal.resolveProgram) {
+			warn("SDF temporal reprojection is not supported");
+			return false;
+		}
+		sdfTemporal.setEnabled(&sdf, enable);
+		info("SDF checkerboard rendering %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Shade the programs which allow it at the rates of a shading-rate
+	* image built from the previous frame, see ShadingRate.h. This renders
+	* offscreen.
+	* Returns true if successfull and false in case of an error. */
+	bool setShadingRate(bool enable)
+	{
+		if (enable && !shadingRate.program) {
+			warn("variable-rate shading is not supported");
+			return false;
+		}
+		if (enable && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		shadingRate.setEnabled(enable);
+		info("variable-rate shading %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Render offscreen with n samples per pixel, 1 for no multisampling.
+	* Returns true if successfull and false in case of an error. */
+	bool setMultisample(int n)
+	{
+		if (n > 1 && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		if (n > 1 && taa.enabled)
+			setTemporalAA(false);
+		if (n > 1 && picking.enabled)
+			setPicking(false);
+		if (offscreen.fbo && !offscreen.setSamples(n))
+			return false;
+		info("MSAA: %d samples per pixel offscreen", (int)offscreen.samples);
+		return true;
+	}
+
+	/* Tonemap and anti-alias the frames, see PostProcess.h. This renders
+	* offscreen, into a half float target.
+	* Returns true if successfull and false in case of an error. */
+	bool setPostProcess(bool enable)
+	{
+		if (enable && !post.tonemapProgram) {
+			warn("post-processing is not supported");
+			return false;
+		}
+		if (enable && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		if (offscreen.fbo && !offscreen.setFormat(enable ? POST_SCENE_FORMAT : GL_RGBA8))
+			return false;
+		post.enabled = enable;
+		info("post-processing %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Blend a blur of the bright parts into the frames, see PostProcess.h.
+	* This turns the post-processing on.
+	* Returns true if successfull and false in case of an error. */
+	bool setBloom(bool enable)
+	{
+		if (enable && !post.enabled && !setPostProcess(true))
+			return false;
+		if (!post.setBloom(enable)) {
+			warn("bloom is not supported");
+			return false;
+		}
+		info("bloom %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Adapt the exposure to the luminance of the frames, see
+	* PostProcess.h. This turns the post-processing on.
+	* Returns true if successfull and false in case of an error. */
+	bool setAutoExposure(bool enable)
+	{
+		if (enable && !post.enabled && !setPostProcess(true))
+			return false;
+		if (!post.setAutoExposure(enable)) {
+			warn("auto exposure is not supported");
+			return false;
+		}
+		info("auto exposure %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Anti-alias the frames by jittering them and blending them over time,
+	* see TemporalAA.h. With a scale below 1 the frames are rendered at
+	* scale times the window size, unless the dynamic resolution scales
+	* them, and reconstructed at the full size. This renders offscreen,
+	* without multisampling.
+	* Returns true if successfull and false in case of an error. */
+	bool setTemporalAA(bool enable, double scale = 1.0)
+	{
+		if (enable && !taa.resolveProgram) {
+			warn("temporal anti-aliasing is not supported");
+			return false;
+		}
+		if (enable && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		if (enable && offscreen.samples > 1 && !setMultisample(1))
+			return false;
+		taa.setEnabled(enable, scale);
+		post.temporal = taa.enabled;
+		if (enable)
+			info("TAA on, rendering at %.2f times the window size", taa.scale);
+		else
+			info("TAA off");
+		return true;
+	}
+
+	/* Draw the height fog at 1 / factor of the sides of the frames and
+	* blend it in with a bilateral upsample, see HalfResEffects.h. This
+	* renders offscreen.
+	* Returns true if successfull and false in case of an error. */
+	bool setFog(bool enable, int factor = HALFRES_FACTOR)
+	{
+		if (enable && halfRes.fog < 0) {
+			warn("fog is not supported");
+			return false;
+		}
+		if (enable && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		halfRes.setFactor(factor);
+		halfRes.setEnabled(halfRes.fog, enable);
+		if (enable)
+			info("fog on, at 1/%d of the frame size", halfRes.factor);
+		else
+			info("fog off");
+		return true;
+	}
+
+	/* Draw the wobbling cubes as patches, tessellated into segments of
+	* pixels on screen, see Tessellation.h.
+	* Returns true if successfull and false in case of an error. */
+	bool setTessellation(bool enable, float pixels = TESS_EDGE_PIXELS)
+	{
+		/* the programs have all their stages, the queue would bind
+		 * pipelines */
+		if (enable && queue.pipelines) {
+			warn("tessellation does not work with separable programs");
+			return false;
+		}
+		if (!tessellation.setEnabled(enable, pixels)) {
+			warn("tessellation is not supported");
+			return false;
+		}
+		if (enable)
+			info("tessellation on, %.1f pixels per segment", tessellation.edgePixels);
+		else
+			info("tessellation off");
+		return true;
+	}
+
+	/* Wobble the vertices of the cubes once per frame in a compute pass,
+	* which all passes read, see Displacement.h.
+	* Returns true if successfull and false in case of an error. */
+	bool setDisplacement(bool enable)
+	{
+		/* the programs are not separable, the queue would bind
+		 * pipelines */
+		if (enable && queue.pipelines) {
+			warn("displacement does not work with separable programs");
+			return false;
+		}
+		if (!displacement.setEnabled(enable)) {
+			warn("displacement is not supported");
+			return false;
+		}
+		info("displacement %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Draw the instances less than pixels wide on screen as billboards,
+	* see Impostors.h.
+	* Returns true if successfull and false in case of an error. */
+	bool setImpostors(bool enable, float pixels = IMPOSTOR_PIXELS)
+	{
+		/* the programs of the crossfade are not separable, the queue
+		 * would bind pipelines */
+		if (enable && queue.pipelines) {
+			warn("impostors do not work with separable programs");
+			return false;
+		}
+		if (!impostors.setEnabled(enable, pixels)) {
+			warn("impostors are not supported");
+			return false;
+		}
+		if (enable)
+			info("impostors on, below %.1f pixels", impostors.pixels);
+		else
+			info("impostors off");
+		return true;
+	}
+
+	/* Raymarch with the compute shader instead of the fragment shader of
+	* the raymarching program, see SdfCompute.h. */
+	bool setSdfCompute(bool enable)
+	{
+		if (enable && (!sdfCompute.program || !sdfTemporal.presentProgram)) {
+			warn("SDF compute raymarching is not supported");
+			return false;
+		}
+		sdfCompute.enabled = enable;
+		info("SDF compute raymarching %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Light the material shaders with count point lights, scattered over
+	* the grids, see ClusteredLights.h; 0 turns the lights off. */
+	bool setLights(int count)
+	{
+		if (count <= 0) {
+			lights.destroy();
+			return true;
+		}
+		if (!lights.program && !lights.init(&programs.sources)) {
+			warn("lights: not supported");
+			return false;
+		}
+		lights.initRandom(count);
+		return true;
+	}
+
+	/* Animate the instanced grid as count characters, one joint per
+	* cube, see Animation.h; 0 stops the animation.
+	* Returns true if successfull and false in case of an error. */
+	bool setAnimation(int count)
+	{
+		skinning.destroy();
+		animator.destroy();
+		animationTime = 0.0;
+		if (count <= 0)
+			return true;
+		return animator.initDemo(count);
+	}
+
+	/* Draw the characters of the animation as skinned meshes, standing on
+	* a square around the origin, instead of the cubes of the instanced
+	* grid, see Skinning.h.
+	* Returns true if successfull and false in case of an error. */
+	bool setSkinning(bool enable)
+	{
+		skinning.destroy();
+		if (enable && !animator.count) {
+			warn("skinning: there is no animation");
+			return false;
+		}
+		if (enable) {
+			int side = (int)ceilf(sqrtf((float)animator.count)), i;
+			float segment = 0.5f * gridSpacing;
+			glm::vec3 *bases = (glm::vec3*)malloc(sizeof(glm::vec3) * animator.count);
+			if (!bases)
+				return false;
+			for (i = 0; i < animator.count; i++)
+				bases[i] = glm::vec3(gridSpacing * ((float)(i % side) - 0.5f * (float)(side - 1)),
+					-0.5f * segment * (float)animator.tracks,
+					gridSpacing * ((float)(i / side) - 0.5f * (float)(side - 1)));
+			bool ok = skinning.init(&programs.sources, &animator, bases, segment, 0.3f * gridSpacing);
+			free(bases);
+			if (!ok) {
+				warn("skinning: not supported");
+				return false;
+			}
+		}
+		shadows.invalidate();
+		info("skinning %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Light the material shaders with a sun casting cascaded shadows, see
+	* ShadowMaps.h.
+	* Returns true if successfull and false in case of an error. */
+	bool setShadows(bool enable)
+	{
+		if (enable && !shadows.texture && !shadows.init())
+			return false;
+		if (!enable)
+			shadows.destroy();
+		info("shadows %s", enable ? "on" : "off");
+		updateProgram();
+		return true;
+	}
+
+	/* Scatter count moving primitives over the SDF scene, with a bounding
+	* volume hierarchy built on the GPU, see SdfField.h; 0 removes them. */
+	bool setSdfField(int count)
+	{
+		sdfField.destroy();
+		if (count <= 0)
+			return true;
+		if (!sdfField.init(&programs.sources, count)) {
+			warn("SDF field: not supported");
+			return false;
+		}
+		sdfField.initRandom(count);
+		return true;
+	}
+
+	/* Simulate a fountain of up to count particles on the GPU, sorted
+	* with primitives, see Particles.h; 0 removes it. */
+	bool setParticles(int count)
+	{
+		particles.destroy();
+		if (count <= 0) {
+			info("particles off");
+			return true;
+		}
+		if (!primitives.program && !primitives.init(&programs.sources)) {
+			warn("particles: not supported");
+			return false;
+		}
+		if (!particles.init(&programs.sources, count)) {
+			warn("particles: not supported");
+			return false;
+		}
+		return true;
+	}
+
+	/* Allow or forbid back-face culling for the programs which declare
+	* it, for measuring what it saves. */
+	void setFaceCulling(bool enable)
+	{
+		faceCulling = enable;
+		info("back-face culling %s", enable ? "on" : "off");
+		updateProgram();
+	}
+
+	/* Switch the depth pre-pass of the programs which have one on or off. */
+	void setDepthPrepass(bool enable)
+	{
+		depthPrepass = enable;
+		info("depth pre-pass %s", enable ? "on" : "off");
+		updateProgram();
+	}
+
+	/* The program variant the current mode draws with: the instanced and
+	* the scene mode both read the model matrix from the instance attribute,
+	* the instanced cubes with vertex pulling from a storage block, or
+	* packed into 12 bytes. */
+	int drawVariant() const
+	{
+		if (pulling())
+			return PROGRAM_VARIANT_PULLED;
+		if (compacting())
+			return PROGRAM_VARIANT_COMPACT;
+		return (instanced || sceneMode) ? PROGRAM_VARIANT_INSTANCED : PROGRAM_VARIANT_BASIC;
+	}
+
+	/* Returns true if the instanced cubes are drawn with vertex pulling:
+	* it is on, they are not skinned characters, and the current program
+	* has a variant for it. With gpuAnimation, that variant reads the
+	* spins, which must have been uploaded. */
+	bool pulling() const
+	{
+		return instanced && cube.pullVao && !skinning.vao && (!gpuAnimation || cube.spinBuffer) &&
+			programs.hasVariant(currentProgram, PROGRAM_VARIANT_PULLED);
+	}
+
+	/* Returns true if the instanced cubes are pulled and spin by
+	* themselves, see Cube::drawSpinning. */
+	bool spinning() const
+	{
+		return gpuAnimation && pulling();
+	}
+
+	/* Returns true if the instanced cubes are drawn packed, see
+	* Cube::drawCompact: it is on, they are neither skinned characters nor
+	* pulled, and the current program has a variant for it. */
+	bool compacting() const
+	{
+		return instanced && cube.compactVao && !skinning.vao && !pulling() &&
+			programs.hasVariant(currentProgram, PROGRAM_VARIANT_COMPACT);
+	}
+
+	/* The box the packed instances are in (see Cube::drawCompact), xyz
+	* its lowest corner relative to instanceOrigin() and w the step of their
+	* positions: the centers of the grid with a cell of room around them,
+	* for the animated joints. */
+	glm::vec4 instanceBox() const
+	{
+		double size = (double)gridSpacing * (double)(instanceGrid + 1);
+		return glm::vec4(glm::vec3(gridOrigin() - glm::dvec3(0.5 * size) - instanceOrigin()), (float)(size / 65535.0));
+	}
+
+	/* Where the instance grid is in the world, far from the origin for a
+	* large world; the characters and the other modes stay at the origin. */
+	glm::dvec3 gridOrigin() const
+	{
+		return (instanced && !skinning.vao) ? worldOrigin : glm::dvec3(0.0);
+	}
+
+	/* The point in the world the instance matrices are relative to: with
+	* camera-relative rendering the camera's position, so that they stay
+	* small close to the camera however large the world is, otherwise the
+	* origin. The world transforms are in double precision and only
+	* rounded to single precision relative to this point, see
+	* writeInstances in HelloCube.cpp. */
+	glm::dvec3 instanceOrigin() const
+	{
+		return (cameraRelative && instanced && !skinning.vao) ? camera.eye : glm::dvec3(0.0);
+	}
+
+	/* Draw the instances relative to the camera, see instanceOrigin(). */
+	void setCameraRelative(bool enable)
+	{
+		cameraRelative = enable;
+		info("camera-relative rendering %s", enable ? "on" : "off");
+	}
+
+	/* Switch between basic and instanced rendering.
+	* Returns true if successfull and false in case of an error. */
+	bool setInstanced(bool enable)
+	{
+		if (enable && !cube.instances.buffer) {
+			int n = instanceGrid;
+			if (!cube.initInstanced(n * n * n)) {
+				warn("failed to initialize instanced mode");
+				return false;
+			}
+			if (!instanceCuller.block && instanceCuller.init(n * n * n))
+				setInstanceSpheres();
+			cpuCulling = culling && instanceCuller.block;
+			if (gridCulling)
+				setGridCulling(true);
+			if (broadphase)
+				setBroadphase(true);
+		}
+		if (enable && vertexPulling && !cube.initPulling())
+			vertexPulling = false;
+		if (enable && gpuAnimation && cube.pullVao && !cube.spinBuffer)
+			initSpins();
+		if (enable && compactInstances && !cube.initCompact())
+			compactInstances = false;
+		instanced = enable;
+		if (enable)
+			sceneMode = voxelMode = false;
+		shadows.invalidate();
+		info("instanced mode %s", instanced ? "on" : "off");
+		updateProgram();
+		return true;
+	}
+
+	/* Upload the spins of the instanced cubes, see Cube::drawSpinning:
+	* each one at its grid position spins around an axis of its own, from a
+	* phase of its own, at up to 2 radians per second either way. The
+	* same seed gives every run the same ones.
+	* Returns true if successfull and false in case of an error. */
+	bool initSpins()
+	{
+		int x, y, z, i = 0, n = instanceGrid;
+		unsigned int seed = 1;
+		glm::vec3 corner(0.5f * gridSpacing * (float)(n + 1));
+		CubeSpin *spins = (CubeSpin*)malloc(sizeof(CubeSpin) * n * n * n);
+		if (!spins) {
+			warn("failed to allocate the spins of %d instances", n * n * n);
+			return false;
+		}
+		for (z = 0; z < n; z++)
+			for (y = 0; y < n; y++)
+				for (x = 0; x < n; x++, i++) {
+					/* uniform on the sphere */
+					float h = 2.0f * sceneGenRandom(&seed) - 1.0f;
+					float a = 6.2831853f * sceneGenRandom(&seed);
+					float r = sqrtf(1.0f - h * h);
+					float phase = 6.2831853f * sceneGenRandom(&seed);
+					float speed = 4.0f * sceneGenRandom(&seed) - 2.0f;
+					spins[i].position = glm::vec4(gridPosition(n, x, y, z) + corner, phase);
+					spins[i].axis = glm::vec4(r * cosf(a), r * sinf(a), h, speed);
+				}
+		bool ok = cube.initSpinning(spins, n * n * n);
+		free(spins);
+		return ok;
+	}
+
+	/* Set the bounding spheres of the instances around the cube. The cubes
+	* only rotate, so they only change with the mesh. */
+	void setInstanceSpheres()
+	{
+		int x, y, z, i = 0, n = instanceGrid;
+
+		for (z = 0; z < n; z++)
+			for (y = 0; y < n; y++)
+				for (x = 0; x < n; x++)
+					instanceCuller.set(i++, gridPosition(n, x, y, z), cube.radius);
+		instanceCuller.version = 0;
+	}
+
+	/* The center of the grid cell x, y, z of an n^3 grid around the origin. */
+	glm::vec3 gridPosition(int n, int x, int y, int z) const
+	{
+		float origin = -0.5f * gridSpacing * (float)(n - 1);
+		return glm::vec3(origin) + gridSpacing * glm::vec3((float)x, (float)y, (float)z);
+	}
+
+	/* Turn the culling of the instanced and scene grids and of the meshlets
+	* on or off. */
+	void setCulling(bool enable)
+	{
+		culling = enable;
+		cpuCulling = enable && instanceCuller.block;
+		scene.setCulling(enable);
+		info("culling %s", enable ? "on" : "off");
+	}
+
+	/* The size of the cells of a spatial hash over the grids, about
+	* SPATIAL_GRID_OBJECTS objects each. */
+	float gridCellSize() const
+	{
+		return gridSpacing * cbrtf((float)SPATIAL_GRID_OBJECTS);
+	}
+
+	/* Sort the instances and the scene objects into the cells of a spatial
+	* hash in every frame before they are culled, as if they all moved, and
+	* cull them cell by cell, see SpatialGrid.h: the instances on the CPU,
+	* the scene on the GPU. It is turned on for both as far as they have
+	* culling at all. */
+	void setGridCulling(bool enable)
+	{
+		if (enable && instanceCuller.block && !instanceCells.items) {
+			int count = instanceCuller.count;
+			if (!instanceCells.init(count, spatialGridSlots(count, 1 << 22)))
+				warn("spatial grid: not supported for the instances");
+		}
+		if (scene.vao)
+			scene.setGridCulling(enable, &programs.sources, gridCellSize());
+		gridCulling = enable;
+		info("grid culling %s", enable ? "on" : "off");
+	}
+
+	/* Find the instances whose spheres overlap in every frame, as if they
+	* moved, by a sweep and prune over the spheres of the instanceCuller,
+	* see Broadphase.h. */
+	void setBroadphase(bool enable)
+	{
+		if (enable && instanceCuller.block && !instanceBroadphase.order) {
+			int count = instanceCuller.count;
+			if (instanceBroadphase.init(count))
+				instanceBroadphase.setObjects(instanceCuller.x, instanceCuller.y, instanceCuller.z,
+					instanceCuller.radius, count);
+			else
+				warn("broadphase: not supported for the instances");
+		}
+		broadphase = enable;
+		info("broadphase %s", enable ? "on" : "off");
+	}
 
-	/* timing */
-	double timeCur, timeDelta;
-	double avg_frametime;
-	double avg_fps;
+	/* Switch between the cube and the scene of many objects.
+	* Returns true if successfull and false in case of an error. */
+	bool setSceneMode(bool enable)
+	{
+		if (enable && !scene.vao) {
+			const VertexLayout *layout = &vertexLayouts[vertexFormat];
+			if (!resumeScene(layout) && (sceneGen.objects > 0 ?
+				!sceneGenerate(&scene, &sceneGen, gridSpacing, materials.materialCount, layout) :
+				!scene.initGrid(sceneGrid, gridSpacing, materials.materialCount, layout))) {
+				warn("failed to initialize scene mode");
+				return false;
+			}
+			/* optional, without it the whole scene is drawn */
+			if (scene.initCulling(&programs.sources)) {
+				scene.setCulling(culling);
+				if (gridCulling)
+					scene.setGridCulling(true, &programs.sources, gridCellSize());
+			} else {
+				/* the occlusion culling can still use queries */
+				scene.initQueries(&programs.sources);
+			}
+			if (gpuTransforms)
+				scene.setGpuTransforms(true, &programs.sources);
+		}
+		sceneMode = enable;
+		if (enable)
+			instanced = voxelMode = false;
+		shadows.invalidate();
+		info("scene mode %s", sceneMode ? "on" : "off");
+		updateProgram();
+		return true;
+	}
 
-	/* keyboard handling */
-	bool pressedKeys[GLFW_KEY_LAST + 1];
-	bool releasedKeys[GLFW_KEY_LAST + 1];
+	/* The hash of what the scene is generated from, the key of its
+	* snapshots. */
+	GLuint64 sceneKey() const
+	{
+		int i;
+		GLuint64 h = hashFNV1a(&sceneGrid, sizeof(sceneGrid), HASH_FNV1A_INIT);
+		h = hashFNV1a(&gridSpacing, sizeof(gridSpacing), h);
+		h = hashFNV1a(&sceneGen.objects, sizeof(sceneGen.objects), h);
+		if (!sceneGen.objects)
+			return h;
+		h = hashFNV1a(sceneGen.meshWeights, sizeof(sceneGen.meshWeights), h);
+		h = hashFNV1a(&sceneGen.materials, sizeof(sceneGen.materials), h);
+		for (i = 0; i < sceneGen.shaders; i++)
+			h = hashFNV1a(&sceneGen.shaderWeights[i], sizeof(float), h);
+		h = hashFNV1a(&sceneGen.overlap, sizeof(sceneGen.overlap), h);
+		h = hashFNV1a(&sceneGen.animated, sizeof(sceneGen.animated), h);
+		return hashFNV1a(&sceneGen.seed, sizeof(sceneGen.seed), h);
+	}
 
-	/* the cube we want to render */
-	Cube cube;
+	/* Set up the scene and the camera from snapshotFile, if it is a
+	* snapshot of the scene sceneGrid or sceneGen would generate.
+	* Returns true if successfull, false if the scene is to be generated. */
+	bool resumeScene(const VertexLayout *layout)
+	{
+		SceneSnapshot snapshot;
 
-	/* the OpenGL state we need for the shaders */
-	GLuint program;		/* shader program */
-	GLint locProjection;
-	GLint locModelView;
-	GLint locTime;
-	GLint locCameraPos;
+		if (!snapshotFile || !snapshot.open(snapshotFile))
+			return false;
+		if (snapshot.header->key != sceneKey()) {
+			info("scene snapshot '%s' is of another scene", snapshotFile);
+			snapshot.close();
+			return false;
+		}
+		bool ok = sceneFromSnapshot(&scene, &snapshot, materials.materialCount, layout);
+		const SceneSnapshotCamera *c = &snapshot.header->camera;
+		if (ok && c->placed) {
+			cameraPlaced = true;
+			cameraEye = glm::vec3(c->eye[0], c->eye[1], c->eye[2]);
+			cameraTarget = glm::vec3(c->target[0], c->target[1], c->target[2]);
+		}
+		snapshot.close();
+		if (!ok)
+			warn("failed to resume scene snapshot '%s'", snapshotFile);
+		return ok;
+	}
 
-	/*  the gloabal transformation matrices */
-	glm::mat4 projection;
-	glm::mat4 view;
+	/* Write the scene and where the camera is to snapshotFile, if the
+	* scene is set up. */
+	void saveScene()
+	{
+		SceneSnapshotCamera c;
+
+		if (!snapshotFile || !scene.vao)
+			return;
+		glm::vec3 eye(camera.eye - gridOrigin());
+		glm::vec3 target = eye + camera.direction;
+		c.placed = cameraPlaced ? 1u : 0u;
+		c.eye[0] = eye.x;
+		c.eye[1] = eye.y;
+		c.eye[2] = eye.z;
+		c.target[0] = target.x;
+		c.target[1] = target.y;
+		c.target[2] = target.z;
+		sceneSnapshotWrite(snapshotFile, &scene, sceneKey(), &c);
+	}
+
+	/* Switch between the cube and the voxel terrain. The terrain is
+	* generated the first time, and meshed over the next frames, uploaded
+	* by the streamer if there is a window for its context.
+	* Returns true if successfull and false in case of an error. */
+	bool setVoxelMode(bool enable)
+	{
+		if (enable && !voxels.chunks) {
+			if (!voxels.init(voxelGrid, &jobs)) {
+				warn("failed to initialize voxel mode");
+				return false;
+			}
+			if (win && !streamer.context)
+				streamer.init(win, directIO, &jobs);
+		}
+		voxelMode = enable;
+		if (enable)
+			instanced = sceneMode = false;
+		shadows.invalidate();
+		info("voxel mode %s", voxelMode ? "on" : "off");
+		updateProgram();
+		return true;
+	}
 
-	/* Create and compile the shaders and link them to a program and qeury
-	* the locations of the uniforms we use.
+	/* Switch between meshing the voxels and raymarching them, which
+	* needs storage buffers. Turns voxel mode on.
 	* Returns true if successfull and false in case of an error. */
-	bool initShaders(const char *vs, const char *fs)
+	bool setVoxelRaymarch(bool enable)
 	{
-		destroyShaders();
-		program = programCreateFromFiles(vs, fs);
-		if (program == 0)
+		if (enable && voxelProgram < 0) {
+			warn("voxel raymarching needs storage buffers");
 			return false;
+		}
+		if (enable) {
+			programs.finish(voxelProgram);
+			if (!programs.get(voxelProgram, PROGRAM_VARIANT_BASIC)) {
+				warn("failed to build the voxel raymarching program");
+				return false;
+			}
+		}
+		if (enable && !voxelMode && !setVoxelMode(true))
+			return false;
+		voxelRaymarch = enable;
+		info("voxel raymarching %s", voxelRaymarch ? "on" : "off");
+		return true;
+	}
+
+	/* Store the vertices of the meshes in format (VERTEX_FORMAT_*). This
+	* recreates the cube; the instanced and the scene mode pick the format up
+	* when they are set up, so it must be chosen before either of them.
+	* Returns true if successfull and false in case of an error. */
+	bool setVertexFormat(int format)
+	{
+		if (format < 0 || format >= VERTEX_FORMAT_COUNT || !vertexFormatSupported(format)) {
+			warn("vertex format %d is not supported", format);
+			return false;
+		}
+		if (cube.instances.buffer || scene.vao) {
+			warn("the vertex format must be set before the instanced and scene mode");
+			return false;
+		}
+		vertexFormat = format;
+		meshlets.destroy();
+		cube.destroy();
+		cube.initBasic(&vertexLayouts[vertexFormat]);
+		cube.pack(&meshPool);
+		info("vertex format %s, %d bytes per vertex", vertexLayouts[vertexFormat].name,
+			(int)vertexLayouts[vertexFormat].stride);
+		return true;
+	}
+
+	/* Replace the cube by the mesh in the buffers b (see MeshBuffers),
+	* which it owns from now on; the instanced mode is set up again for
+	* it, the scene keeps its own meshes. If the mesh has meshlets, they are
+	* culled on the GPU where it is supported. */
+	void setMesh(const MeshBuffers *b)
+	{
+		GLsizei instances = cube.maxInstances;
 
-		locProjection = glGetUniformLocation(program, "projection");
-		locModelView = glGetUniformLocation(program, "modelView");
-		locTime = glGetUniformLocation(program, "time");
-		locCameraPos = glGetUniformLocation(program, "cameraPosition");
-		info("program %u: location for \"projection\" uniform: %d", program, locProjection);
-		info("program %u: location for \"modelView\" uniform: %d", program, locModelView);
-		info("program %u: location for \"time\" uniform: %d", program, locTime);
-		info("program %u: location for \"locCameraPos\" uniform: %d", program, locCameraPos);
+		meshlets.destroy();
+		cube.destroy();
+		cube.initMesh(&b->layout, b->vertexBuffer, b->indexBuffer, b->indexCount, b->indexType, b->radius,
+			b->lods, b->lodCount);
+		/* the streamer creates buffers of their own, the copy is on the GPU */
+		cube.pack(&meshPool);
+		if (b->meshletBuffer && meshlets.init(&programs.sources, b->meshletBuffer, b->meshletCount, b->indexType))
+			meshlets.indexBase = cube.indexBase();
+		if (instances) {
+			if (!cube.initInstanced(instances)) {
+				warn("failed to initialize instanced mode for the mesh");
+				instanced = false;
+				updateProgram();
+			} else if (compactInstances && !cube.initCompact()) {
+				compactInstances = false;
+			}
+			if (instanceCuller.block)
+				setInstanceSpheres();
+		}
+	}
+
+	/* Replace the cube by the mesh in the mesh file filename (see
+	* MeshFile.h), in the vertex layout of the file, see setMesh(). This
+	* waits until the file is read and uploaded, streamMesh() does not.
+	* Returns true if successfull and false in case of an error. */
+	bool loadMesh(const char *filename)
+	{
+		MeshFile file;
+		MeshBuffers b;
 
+		if (!file.open(filename))
+			return false;
+		file.createBuffers(&b);
+		file.close();
+		setMesh(&b);
 		return true;
 	}
 
-	/* Initialize the Cube Application.
-	* This will initialize the app object, create a windows and OpenGL context
-	* (via GLFW), initialize the GL function pointers via GLEW and initialize
-	* the cube.
-	* Returns true if successfull or false if an error occured. */
-	bool initBaseApp(int w, int h, const char* title, GLFWframebuffersizefun callback_Resize, GLFWkeyfun callback_Keyboard)
+	/* Like loadMesh(), but the file is read and uploaded on the loader
+	* thread of the streamer while the cube is still drawn, it replaces the
+	* cube in the first updateStreaming() after that. Without a loader, the
+	* mesh is loaded right away.
+	* Returns true if successfull and false in case of an error. */
+	bool streamMesh(const char *filename)
+	{
+		/* the loader thread shares the context of the window */
+		if (!win)
+			return loadMesh(filename);
+		if (!streamer.context && !streamer.init(win, directIO, &jobs))
+			return loadMesh(filename);
+		if (!streamer.requestMesh(filename))
+			return loadMesh(filename);
+		return true;
+	}
+
+	/* Replace the material textures by the layers of the compressed
+	* texture file filename (see TextureFile.h). The scene picks up the
+	* materials when it is set up, so call this before setSceneMode().
+	* Returns true if successfull, otherwise the default materials stay. */
+	bool loadTextures(const char *filename)
+	{
+		MaterialTable loaded;
+
+		if (!loaded.initFromFile(filename)) {
+			loaded.destroy();
+			return false;
+		}
+		materials.destroy();
+		materials = loaded;
+		return true;
+	}
+
+	/* Once per frame: compact the pool, which moves the ranges of the
+	* cube, so it follows them. */
+	void updateMemory()
+	{
+		if (meshPool.defragment() && cube.updatePool())
+			meshlets.indexBase = cube.indexBase();
+		meshPool.endFrame();
+	}
+
+	/* Take over the meshes and the pages of the virtual texture which
+	* finished streaming in and request the next pages, once per frame. */
+	void updateStreaming()
+	{
+		StreamItem done;
+
+		while (streamer.poll(&done)) {
+			if (done.kind == STREAM_MESH)
+				setMesh(&done.mesh);
+			else if (done.kind == STREAM_BUFFER)
+				voxels.uploaded(&done);
+			else
+				virtualTexture.pageDone(&done);
+		}
+		virtualTexture.update(&streamer);
+	}
+
+	/* Switch the occlusion culling of the scene on or off. The Hi-Z
+	* pyramid needs the depth of the previous frame, so this also turns on
+	* offscreen rendering; the occlusion queries of contexts without
+	* compute shaders do not.
+	* Returns true if successfull and false in case of an error. */
+	bool setOcclusion(bool enable)
+	{
+		if (enable && !scene.hiz.program && !scene.queries.program) {
+			warn("occlusion culling is not supported");
+			return false;
+		}
+		if (enable && scene.hiz.program && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		scene.setOcclusion(enable);
+		return true;
+	}
+
+	/* The refresh interval of the monitor the window is on in ms, or 0
+	* if it is not known. Windowed mode windows have no monitor, we then
+	* assume the primary one. */
+	double vsyncInterval()
+	{
+		if (!win)
+			return 0.0;
+		GLFWmonitor *mon = glfwGetWindowMonitor(win);
+		if (!mon)
+			mon = glfwGetPrimaryMonitor();
+		const GLFWvidmode *mode = mon ? glfwGetVideoMode(mon) : NULL;
+		if (!mode || mode->refreshRate <= 0)
+			return 0.0;
+		return 1000.0 / (double)mode->refreshRate;
+	}
+
+	/* Enable or disable synchronizing the buffer swaps to the VBLANK.
+	* Benchmarks turn it off so the frame rate is not capped. */
+	void setVsync(bool enable)
+	{
+		if (win)
+			glfwSwapInterval(enable ? 1 : 0);
+		frameStats.vsyncInterval = enable ? vsyncInterval() : 0.0;
+		info("vsync %s", enable ? "on" : "off");
+	}
+
+	/* Open n more windows of w x h pixels titled title, which show the
+	* columns of the frame, see ViewportWindows.h. Their keys go to
+	* keyCallback. This renders offscreen.
+	* Returns true if successfull and false in case of an error. */
+	bool openViewports(int n, int w, int h, const char *title, GLFWkeyfun keyCallback, bool vsync)
+	{
+		if (hidden) {
+			warn("viewport windows: not with a hidden window");
+			return false;
+		}
+		if (!renderOffscreen && !setOffscreen(true, true))
+			return false;
+		if (!viewports.create(win, n, w, h, title, keyCallback, vsync ? 1 : 0)) {
+			viewports.destroy();
+			return false;
+		}
+		return true;
+	}
+
+	/* Draw frames only while something changes, see IdleMode.h. */
+	void setIdleMode(bool enable)
+	{
+		idle.enabled = enable;
+		idle.invalidate();
+		info("idle mode %s", enable ? "on" : "off");
+	}
+
+	/* Start or stop the animation of the simulation. */
+	void setAnimate(bool enable)
+	{
+		idle.animate = enable;
+		idle.invalidate();
+		info("animation %s", enable ? "on" : "off");
+	}
+
+	/* Let the CPU run at most n frames ahead of the GPU, 0 for as far as
+	* the driver lets it, see FrameThrottle.h. */
+	void setFramesInFlight(int n)
+	{
+		frameThrottle()->setFramesInFlight(n);
+		info("frames in flight: %d", frameThrottle()->framesInFlight);
+	}
+
+	/* Start each frame as late as the GPU times of the last frames allow
+	* and only then sample the input, see FramePacer.h. This needs vsync,
+	* and the GL context on the thread of the main loop.
+	* Returns true if successfull and false if it is not supported. */
+	bool setLowLatency(bool enable)
+	{
+		if (enable && (renderThread.running || frameStats.vsyncInterval <= 0.0)) {
+			warn("low-latency mode needs vsync and no render thread");
+			return false;
+		}
+		pacer.setEnabled(enable, frameStats.vsyncInterval);
+		info("low-latency mode %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Sample the clocks, the power and the temperatures of the GPU we draw
+	* with and of the CPU, see Telemetry.h.
+	* Returns true if successfull and false if there is nothing to read. */
+	bool setTelemetry(bool enable)
+	{
+		if (!enable) {
+			telemetry.stop();
+			return true;
+		}
+		return telemetry.start((const char*)glGetString(GL_VENDOR));
+	}
+
+	/* Draw the statistics on top of the frames instead of putting them
+	* into the window title, see Overlay.h.
+	* Returns true if successfull and false if it is not available. */
+	bool setOverlay(bool enable)
+	{
+		if (enable && !overlay.available) {
+			warn("the overlay is not available");
+			return false;
+		}
+		overlay.setEnabled(enable);
+		info("overlay %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Draw the shapes of DebugDraw.h over the frame: the boxes around the
+	* visible instances of each chunk, the lights and the cascades of the
+	* shadows. Only debug builds have it.
+	* Returns true if successfull and false if it is not available. */
+	bool setDebugDraw(bool enable)
+	{
+#ifdef NDEBUG
+		if (enable) {
+			warn("debug drawing is only compiled into debug builds");
+			return false;
+		}
+#endif
+		if (enable && !debugDraw()->program) {
+			warn("debug drawing is not available");
+			return false;
+		}
+		debugDraw()->setEnabled(enable);
+		info("debug drawing %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Pick the objects of the scene from the ids the main pass writes
+	* next to the colors, see Picking.h, instead of casting rays. This
+	* renders offscreen, without multisampling.
+	* Returns true if successfull and false in case of an error. */
+	bool setPicking(bool enable)
+	{
+		if (enable && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		if (enable && offscreen.samples > 1 && !setMultisample(1))
+			return false;
+		if (!picking.setEnabled(enable))
+			return false;
+		info("ID buffer picking %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Synchronize the buffer swaps to the VBLANK, but let a frame which
+	* missed it tear rather than wait a whole refresh (swap interval -1),
+	* where the swap control extension of the window system allows it.
+	* Returns true if successfull and false if it is not supported. */
+	bool setTearControl(bool enable)
+	{
+		if (enable && !glfwExtensionSupported("GLX_EXT_swap_control_tear") &&
+			!glfwExtensionSupported("WGL_EXT_swap_control_tear")) {
+			warn("adaptive vsync is not supported");
+			return false;
+		}
+		tearControl = enable;
+		glfwSwapInterval(enable ? -1 : 1);
+		info("adaptive vsync %s", enable ? "on" : "off");
+		return true;
+	}
+
+	/* Render to the offscreen target instead of the window. If present is
+	* set the result is copied into the window at the end of each frame,
+	* otherwise the window is not updated at all.
+	* Returns true if successfull and false in case of an error. */
+	bool setOffscreen(bool enable, bool present)
+	{
+		if (enable && !offscreen.fbo) {
+			if (!offscreen.init(width, height)) {
+				offscreen.destroy();
+				warn("failed to initialize offscreen rendering");
+				return false;
+			}
+		}
+		renderOffscreen = enable;
+		presentOffscreen = enable && present;
+		if (!enable && resolution.enabled)
+			setDynamicResolution(false);
+		if (!enable && shadingRate.enabled)
+			setShadingRate(false);
+		if (!enable && post.enabled)
+			setPostProcess(false);
+		if (!enable && offscreen.samples > 1)
+			setMultisample(1);
+		if (!enable && taa.enabled)
+			setTemporalAA(false);
+		if (!enable && picking.enabled)
+			setPicking(false);
+		if (!enable && halfRes.active())
+			setFog(false);
+		info("offscreen rendering %s%s", enable ? "on" : "off", presentOffscreen ? " with present" : "");
+		return true;
+	}
+
+	/* Scale the resolution of the frames such that they take ms of GPU
+	* time, with the sides no smaller than minScale times those of the
+	* window, or render at the window size again. This renders offscreen.
+	* Returns true if successfull and false in case of an error. */
+	bool setDynamicResolution(bool enable, double ms = DYNRES_TARGET_MS, double minScale = DYNRES_MIN_SCALE)
+	{
+		if (enable && (!resolution.program || !gpuProfiler.supported)) {
+			warn("dynamic resolution is not supported");
+			return false;
+		}
+		if (enable && !renderOffscreen && !setOffscreen(true, true))
+			return false;
+		resolution.setEnabled(enable, ms, minScale);
+		if (enable)
+			info("dynamic resolution on, %.1fms per frame, scale %.2f to 1", ms, minScale);
+		else
+			info("dynamic resolution off");
+		return true;
+	}
+
+	/* Feed the GPU time of a frame to the dynamic resolution, see
+	* GpuProfiler::beginFrame. */
+	void updateResolution(double gpuMs)
+	{
+		resolution.update(gpuMs);
+	}
+
+	/* Bind the framebuffer this frame is rendered into and set the size of
+	* it. The offscreen target follows the window size, scaled by the
+	* dynamic resolution. */
+	void beginRender()
+	{
+		renderWidth = width;
+		renderHeight = height;
+		if (renderOffscreen) {
+			renderWidth = resolution.scaled(width);
+			renderHeight = resolution.scaled(height);
+			if (taa.enabled && !resolution.enabled) {
+				renderWidth = taa.scaled(width);
+				renderHeight = taa.scaled(height);
+			}
+			offscreen.resize(renderWidth, renderHeight);
+			/* the camera is up to date, that of the previous frame
+			 * is still kept */
+			if (taa.enabled)
+				taa.beginFrame(frameIndex, renderWidth, renderHeight, camera.viewProjection,
+					previousProjection * previousView);
+			offscreen.bind();
+		}
+		/* the translucent draws need the depth of a target of ours */
+		transparency.target = renderOffscreen ? &offscreen : NULL;
+	}
+
+	/* The framebuffer this frame is rendered into. */
+	GLuint renderFramebuffer() const
+	{
+		return renderOffscreen ? offscreen.fbo : 0;
+	}
+
+	/* Finish rendering a frame before the buffer swap.
+	* Returns true if the window should be swapped. */
+	bool endRender()
+	{
+		if (!renderOffscreen)
+			return true;
+		if (halfRes.active())
+			halfRes.execute(&offscreen, &camera, shadows.sun, timeCur);
+		/* the post-processing may resolve the samples while tonemapping,
+		 * but the shading rates need the resolved frame anyway */
+		if (!post.resolves(&offscreen) || !presentOffscreen || shadingRate.enabled || viewports.count)
+			offscreen.resolve();
+		if (presentOffscreen) {
+			/* the temporal anti-aliasing reconstructs the window size */
+			RenderTarget *scene = taa.enabled ? taa.resolve(&offscreen, width, height) : &offscreen;
+			if (post.enabled)
+				post.execute(scene, width, height, &resolution);
+			else if (scene->width != width || scene->height != height)
+				resolution.upscale(scene, width, height);
+			else
+				scene->present(width, height);
+			return true;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return false;
+	}
+
+	/* Record the times of a frame: cpuMs is the wall time since the last
+	* frame, gpuMs the result returned by gpuProfiler.beginFrame(), which
+	* belongs to an earlier frame and is negative if there is none. */
+	void recordFrame(double cpuMs, double gpuMs)
+	{
+		frameStats.pushCPU(cpuMs);
+		if (gpuMs >= 0.0)
+			frameStats.pushGPU(gpuMs);
+	}
+
+	/* Compute the frame time distribution of all frames recorded since the
+	* last call and log it if logFrameStats is set. */
+	void updateFrameStats()
 	{
+		const FrameTimeStats *c = &frameStats.cpuStats;
+		const FrameTimeStats *g = &frameStats.gpuStats;
+		char scopes[256];
+		size_t len = 0;
 		int i;
 
-		/* Initialize the app structure */
-		win = NULL;
-		width = w;
-		height = h;
-		flags = 1;
-		avg_frametime = -1.0;
-		avg_fps = -1.0;
+		frameStats.update();
+		if (!logFrameStats)
+			return;
+		info("frame time: %u frames, p50 %.2fms, p95 %.2fms, p99 %.2fms, max %.2fms, %u missed vsync",
+			c->count, c->p50, c->p95, c->p99, c->max, frameStats.missed);
+		if (g->count)
+			info("GPU time: %u frames, p50 %.2fms, p95 %.2fms, p99 %.2fms, max %.2fms",
+				g->count, g->p50, g->p95, g->p99, g->max);
+		/* and the average of each scope, as of the last gpuProfiler.report() */
+		if (gpuProfiler.avgFrame >= 0.0) {
+			scopes[0] = 0;
+			for (i = 0; i < gpuProfiler.scopeCount; i++) {
+				if (gpuProfiler.avg[i] < 0.0)
+					continue;
+				int n = mysnprintf(scopes + len, sizeof(scopes) - len, "%s%s %.3fms", len ? ", " : "",
+					gpuProfiler.names[i], gpuProfiler.avg[i]);
+				if (n < 0 || (size_t)n >= sizeof(scopes) - len)
+					break;
+				len += (size_t)n;
+			}
+			info("GPU average: %.2fms (%s)", gpuProfiler.avgFrame, scopes);
+		}
+		if (glState()->avgIssued >= 0.0)
+			info("GL state: %.1f calls issued, %.1f elided per frame",
+				glState()->avgIssued, glState()->avgElided);
+		frameArenas()->report();
+		largePages()->report();
+		memoryStats()->report();
+	}
+
+	/* Read the frame back for the capture, after endRender(): what is
+	* presented if it returned true, presented, else the offscreen target,
+	* which it resolved. */
+	void captureFrame(bool presented)
+	{
+		if (presented) {
+			capture.frame(0, width, height);
+			share.frame(0, width, height);
+		} else if (renderOffscreen) {
+			GLuint fbo = offscreen.resolveFbo ? offscreen.resolveFbo : offscreen.fbo;
+			capture.frame(fbo, offscreen.width, offscreen.height);
+			share.frame(fbo, offscreen.width, offscreen.height);
+		}
+	}
 
-		for (i = 0; i <= GLFW_KEY_LAST; i++)
-			pressedKeys[i] = releasedKeys[i] = false;
+	/* Start recording the frames into captureFile, or stop. */
+	void toggleRecording()
+	{
+		if (capture.recording)
+			capture.stop();
+		else
+			capture.start(captureFile, capture.fps);
+	}
 
-		cube.vbo[0] = cube.vbo[1] = cube.vao = 0;
-		program = 0;
+	/* Write the zones recorded by all threads, and by the GPU, into
+	* traceFile as a Chrome trace, see Profiler.h. */
+	void exportTrace()
+	{
+#ifdef PROFILE_ZONES
+		profileExport(traceFile);
+#else
+		warn("profiler: the zones are not compiled in, build with PROFILE_ZONES (make PROFILE=1)");
+#endif
+	}
+
+	/* Write a trace of the last seconds whenever a frame takes longer than
+	* budgetMs, or spikeFactor times the p99 of the last second, see
+	* FlightRecorder.h; 0 leaves either out. Traces go to prefix_N.json.
+	* Returns false if the zones are not compiled in. */
+	bool setFlightRecorder(double budgetMs, double spikeFactor, const char *prefix)
+	{
+#ifdef PROFILE_ZONES
+		flight.budgetMs = budgetMs;
+		flight.spikeFactor = spikeFactor;
+		if (prefix)
+			flight.prefix = prefix;
+		flight.enabled = budgetMs > 0.0 || spikeFactor > 0.0;
+		info("flight recorder: budget %.2fms, spikes over %.1f times the p99, traces to %s_N.json",
+			budgetMs, spikeFactor, flight.prefix);
+		return true;
+#else
+		(void)budgetMs;
+		(void)spikeFactor;
+		(void)prefix;
+		warn("flight recorder: the zones are not compiled in, build with PROFILE_ZONES (make PROFILE=1)");
+		return false;
+#endif
+	}
+
+	/* Debug builds, and windowFlags with APP_WINDOW_GL_DEBUG, ask for a
+	* debug context. */
+	static bool debugContext(unsigned int windowFlags)
+	{
+#ifdef NDEBUG
+		return (windowFlags & APP_WINDOW_GL_DEBUG) != 0;
+#else
+		(void)windowFlags;
+		return true;
+#endif
+	}
+
+	/* Create the window of w x h pixels titled title with its GL context,
+	* make the context current and register the callbacks.
+	* Returns true if successfull or false if an error occured. */
+	bool createWindow(int w, int h, const char *title, GLFWframebuffersizefun callback_Resize,
+		GLFWkeyfun callback_Keyboard, unsigned int windowFlags)
+	{
+		int i;
 
 		/* initialize GLFW library */
+		startupTimeline()->phase("GLFW");
 		info("initializing GLFW");
 		if (!glfwInit()) {
 			warn("Failed to initialze GLFW");
 			return false;
 		}
 
-		/* request a OpenGL 3.2 core profile context */
+		/* request a OpenGL core profile context, the version is set below */
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
 		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		/* which reports its errors through a callback, see GLDebug.h */
+		if (debugContext(windowFlags))
+			glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+		if (hidden)
+			glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+		if (APP_WINDOW_SAMPLE_COUNT(windowFlags) > 1)
+			glfwWindowHint(GLFW_SAMPLES, (int)APP_WINDOW_SAMPLE_COUNT(windowFlags));
+		if (windowFlags & APP_WINDOW_EGL) {
+#ifdef GLFW_CONTEXT_CREATION_API
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#else
+			warn("this GLFW version can not create EGL contexts, using the native API");
+#endif
+		}
 
-		/* create the window and the gl context */
+		/* create the window and the gl context, the newest version the
+		* driver has, down to 3.2 */
+		startupTimeline()->phase("window and context");
 		info("creating window and OpenGL context");
-		win = glfwCreateWindow(w, h, title, NULL, NULL);
+		for (i = 0; i < GL_CAPS_VERSIONS && !win; i++) {
+			if (!glCaps()->allowed(glCapsVersions[i][0], glCapsVersions[i][1]))
+				continue;
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glCapsVersions[i][0]);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glCapsVersions[i][1]);
+			win = glfwCreateWindow(w, h, title, NULL, NULL);
+		}
 		if (!win) {
 			warn("failed to get window with OpenGL 3.2 core context");
 			return false;
@@ -121,45 +1852,366 @@ typedef struct {
 		* VBLANK of the display. Depending on the driver and the user's
 		* setting, this may have no effect. But we can try... */
 		glfwSwapInterval(1);
+		frameStats.init(vsyncInterval());
+		return true;
+	}
+
+	/* Initialize the Cube Application.
+	* This will initialize the app object, create a windows and OpenGL context
+	* (via GLFW), initialize the GL function pointers via GLEW and initialize
+	* the cube. windowFlags is a combination of the APP_WINDOW_* flags.
+	* Returns true if successfull or false if an error occured. */
+	bool initBaseApp(int w, int h, const char* title, GLFWframebuffersizefun callback_Resize, GLFWkeyfun callback_Keyboard,
+		unsigned int windowFlags = 0)
+	{
+		int i;
+
+		/* Initialize the app structure */
+		win = NULL;
+		width = w;
+		height = h;
+		flags = 1;
+		hidden = (windowFlags & APP_WINDOW_HIDDEN) != 0;
+		directIO = (windowFlags & APP_WINDOW_DIRECT_IO) != 0;
+		offscreen.clear();
+		renderOffscreen = presentOffscreen = false;
+		resolution.clear();
+		overlay.clear();
+		renderWidth = w;
+		renderHeight = h;
+		avg_frametime = -1.0;
+		avg_fps = -1.0;
+		avg_gputime = -1.0;
+		logFrameStats = true;
+		traceFile = "hellocube_trace.json";
+		flight.clear();
+		telemetry.clear();
+		captureFile = "hellocube_capture.mp4";
+		capture.clear();
+		share.clear();
+		stream.clear();
+		gpuProfiler.supported = false;
+		simulation.init();
+		renderThread.clear();
+		pacer.clear();
+		idle.clear();
+		viewports.clear();
+		tearControl = false;
+		input.clear(w, h);
+		replay.clear();
+
+		cube.vbo[0] = cube.vbo[1] = cube.vao = 0;
+		cube.buffers[0].id = cube.buffers[1].id = cube.vertexArray.id = 0;
+		cube.pool = NULL;
+		meshPool.clear();
+		cube.instances.buffer = 0;
+		cube.pullVao = cube.compactVao = cube.spinBuffer = 0;
+		cube.spinCount = 0;
+		cube.maxInstances = cube.instanceCount = 0;
+		programs.init();
+		shaderWatcher.init();
+		/* an edited shader wakes the idle main loop */
+		shaderWatcher.onChange = idleWake;
+		shaderWatcher.onChangeUser = &idle;
+		currentProgram = -1;
+		program = 0;
+		uniforms = NULL;
+		queue.init();
+		queue.translucentBegin = TransparencyPass::queueBegin;
+		queue.translucentEnd = TransparencyPass::queueEnd;
+		queue.translucentObject = &transparency;
+		depthPrepass = false;
+		prepassProgram = 0;
+		shadowProgram = 0;
+		raster = RASTER_DEFAULT;
+		memset(pipelineKey, 0xff, sizeof(pipelineKey));
+		faceCulling = true;
+		for (i = 0; i < 10; i++)
+			keyPrograms[i] = -1;
+		frameUBO.buffer = 0;
+		frameOffset = -1;
+		/* the values of FrameUniforms it watches, see specializeUniforms */
+		specializer.clear();
+		specializer.add("projection", GL_FLOAT_MAT4);
+		specializer.add("modelView", GL_FLOAT_MAT4);
+		specializer.add("lightCount", GL_UNSIGNED_INT);
+		specializer.add("cutRadius", GL_FLOAT);
+		specializer.add("modelViewProjection", GL_FLOAT_MAT4);
+		cutRadius = 1.4f;
+		camera.clear();
+		cameraPlaced = false;
+		worldOrigin = glm::dvec3(0.0);
+		cameraRelative = false;
+
+		instanced = false;
+		vertexPulling = false;
+		compactInstances = false;
+		gpuAnimation = false;
+		vertexFormat = VERTEX_FORMAT_FLOAT;
+		instanceGrid = 16;
+		instanceCuller.block = NULL;
+		instanceCells.clear();
+		instanceBroadphase.clear();
+		meshlets.clear();
+		streamer.clear();
+		virtualTexture.clear();
+		virtualProgram = -1;
+		sdfProgram = -1;
+		sdf.clear();
+		sdfBaker.clear();
+		sdfCone.clear();
+		sdfTemporal.clear();
+		sdfCompute.clear();
+		sdfField.clear();
+		primitives.clear();
+		particles.clear();
+		lights.clear();
+		shadows.clear();
+		animator.clear();
+		skinning.clear();
+		animationTime = 0.0;
+		shadingRate.clear();
+		post.clear();
+		taa.clear();
+		halfRes.clear();
+		tessellation.clear();
+		displacement.clear();
+		impostors.clear();
+		picking.clear();
+		transparency.clear();
+		for (i = 0; i < OIT_MODES; i++)
+			translucentPrograms[i] = -1;
+		frameIndex = 0;
+		cpuCulling = false;
+		culling = true;
+		gridCulling = false;
+		broadphase = false;
+		gpuTransforms = false;
+		jobs.threadCount = 0;
+		scene.clear();
+		commands.clear();
+		commandLists = false;
+		voxels.clear();
+		voxelMode = false;
+		voxelGrid = 8;
+		voxelOctree.clear();
+		voxelRaymarch = false;
+		voxelProgram = -1;
+		materials.clear();
+		sceneMode = false;
+		sceneGrid = 16;
+		sceneGen.clear();
+		snapshotFile = NULL;
+		gridSpacing = 3.0f;
+		lodError = 1.0f;
+
+		if (windowFlags & APP_WINDOW_HEADLESS) {
+			/* no window system, an EGL context on a GPU which draws
+			* offscreen only, see HeadlessContext.h */
+			startupTimeline()->phase("headless context");
+			hidden = true;
+			if (!headlessContext()->init(APP_WINDOW_DEVICE_INDEX(windowFlags), debugContext(windowFlags)))
+				return false;
+			frameStats.init(0.0);
+		} else if (!createWindow(w, h, title, callback_Resize, callback_Keyboard, windowFlags)) {
+			return false;
+		}
 
 		/* initialize glad,
-		* this will load all OpenGL function pointers
+		* this will load the OpenGL function pointers we use
 		*/
-		info("initializing glad");
-		if (!gladLoadGL()) {
+		startupTimeline()->phase("GL functions");
+		if (!glLoaderLoad()) {
 			warn("failed to intialize OpenGL functions via glad");
 			return false;
 		}
+		/* the paths of the renderer depend on them */
+		glCaps()->detect();
+		glMemoryInstall();
+		if (glTrace()->path)
+			glTrace()->start();
+		glDebugInit(win, (windowFlags & APP_WINDOW_GL_DEBUG) != 0);
+
+		/* fence the frames, before the ring buffers use the fences */
+		startupTimeline()->phase("frame resources");
+		frameThrottle()->init(FRAME_THROTTLE_DEFAULT);
+
+		/* the transient data of the frames and the jobs goes there */
+		if (!frameArenas()->init())
+			return false;
+		/* the worker threads sleep until there are jobs, next to their
+		* arenas, and the drawing thread has a core of its own */
+		if (cpuTopology()->enabled && cpuTopology()->detect())
+			cpuTopology()->placeDrawingThread("main");
+		jobs.init(0, frameArenaTouch);
+		/* and inflate the big files of the asset archive */
+		assetArchive()->jobs = &jobs;
 
 		/* initialize the GL context */
+		startupTimeline()->phase("GL state");
 		initGLState();
-		cube.initBasic();
+		startupTimeline()->phase("renderer");
+		meshPool.init(BUFFER_POOL_BLOCK_SIZE, 0);
+		cube.initBasic(&vertexLayouts[vertexFormat]);
+		cube.pack(&meshPool);
+		/* before anything builds mip chains */
+		mipDownsampler()->init(&programs.sources);
+		materials.initDefault();
+		if (!sdf.init()) {
+			warn("failed to create the SDF scene");
+			return false;
+		}
+		sdf.initDefault();
+		if (!sdfBaker.init(&programs.sources, &sdf))
+			info("SDF bake: not supported, the raymarching program evaluates the scene");
+		setSdfMarch(SDF_CONE_TILE, SDF_CONE_STEPS, SDF_MARCH_STEPS);
+		if (!resolution.init(&programs.sources))
+			info("dynamic resolution: not available");
+		if (sdfTemporal.init(&programs.sources))
+			sdfTemporal.setEnabled(&sdf, true);
+		else
+			info("SDF temporal: not supported, every pixel is marched");
+		if (!sdfCompute.init(&programs.sources))
+			info("SDF compute raymarcher: not supported");
+		if (!shadingRate.init(&programs.sources))
+			info("variable-rate shading: not supported");
+		if (!post.init(&programs.sources))
+			info("post-processing: not available");
+		if (!taa.init(&programs.sources))
+			info("TAA: not available");
+		if (!halfRes.init(&programs.sources))
+			info("half-resolution effects: not available");
+		if (!tessellation.init(&programs.sources))
+			info("tessellation: not supported");
+		if (!displacement.init(&programs.sources, &cube))
+			info("displacement: not supported");
+		if (!impostors.init(&programs.sources, &cube))
+			info("impostors: not available");
+		picking.init(&programs.sources);
+		if (!transparency.init(&programs.sources))
+			info("order-independent transparency: not supported");
+		if (!spriteBatch()->init(&programs.sources))
+			info("sprite batch: not available");
+		if (!overlay.init())
+			info("overlay: not available, the statistics go into the window title");
+#ifndef NDEBUG
+		if (!debugDraw()->init(&programs.sources))
+			info("debug drawing: not available");
+#endif
+		capture.init(&programs.sources);
+		/* its pages are filled on the loader thread */
+		if (virtualTexture.init() && (!win || (!streamer.context && !streamer.init(win, directIO, &jobs))))
+			virtualTexture.destroy();
+		if (!initFrameUniforms()) {
+			warn("failed to create the per-frame uniform buffer");
+			return false;
+		}
+		/* nobody would see the window contents */
+		if (hidden && !setOffscreen(true, false))
+			return false;
 
 		/* initialize the timer */
-		timeCur = glfwGetTime();
+		timeCur = profileSeconds();
 
 		return true;
 	}
 	
+	/* Start the rays of the raymarching program where a cone pre-pass over
+	* tiles of tile x tile pixels got with up to coneSteps steps, 0 tiles
+	* start them at the camera. Each pixel takes up to marchSteps steps. */
+	void setSdfMarch(int tile, int coneSteps, int marchSteps)
+	{
+		sdfCone.destroy();
+		if (!sdfCone.init(&programs.sources, &sdf, tile, coneSteps) && tile > 0)
+			info("SDF cone pre-pass: not supported, the rays start at the camera");
+		sdf.setSteps(marchSteps);
+	}
+
 	/* Destroy all GL objects related to the shaders. */
 	void destroyShaders()
 	{
-		if (program) {
-			info("deleting program %u", program);
-			glDeleteProgram(program);
-			program = 0;
-		}
+		programs.destroy();
+		currentProgram = -1;
+		program = 0;
+		uniforms = NULL;
 	}
 
 	/* Clean up: destroy everything the cube app still holds */
 	void destroy()
 	{
 		if (flags) {
+			shaderWatcher.stop();
+			telemetry.stop();
+			capture.destroy();
+			share.destroy();
+			stream.destroy();
+			replay.destroy();
+			streamer.destroy();
+			virtualTexture.destroy();
+			voxelOctree.destroy();
+			voxels.destroy();
+			meshlets.destroy();
 			cube.destroy();
+			saveScene();
+			scene.destroy();
+			commands.destroy();
+			meshPool.destroy();
+			materials.destroy();
+			transparency.destroy();
+			post.destroy();
+			taa.destroy();
+			halfRes.destroy();
+			tessellation.destroy();
+			displacement.destroy();
+			impostors.destroy();
+			picking.destroy();
+			overlay.destroy();
+			spriteBatch()->destroy();
+			debugDraw()->destroy();
+			mipDownsampler()->destroy();
+			shadingRate.destroy();
+			sdfField.destroy();
+			particles.destroy();
+			primitives.destroy();
+			lights.destroy();
+			shadows.destroy();
+			skinning.destroy();
+			animator.destroy();
+			sdfCompute.destroy();
+			sdfTemporal.destroy();
+			sdfCone.destroy();
+			sdfBaker.destroy();
+			sdf.destroy();
+			instanceCuller.destroy();
+			instanceCells.destroy();
+			instanceBroadphase.destroy();
+			assetArchive()->jobs = NULL;
+			jobs.destroy();
+			frameArenas()->destroy();
+			gpuProfiler.destroy();
+			specializer.destroy();
 			destroyShaders();
+			infoLogRelease();
+			if (frameUBO.buffer)
+				frameUBO.destroy();
+			offscreen.destroy();
+			resolution.destroy();
+			/* what is left of the shared objects, and the deletes
+			* still waiting for their frames */
+			glResources()->destroy();
+			glState()->flushDeletes();
+			frameThrottle()->destroy();
+			viewports.destroy();
+			/* the last GL calls were made */
+			glTrace()->stop();
+			/* it reads strings of the context */
+			glCaps()->finish();
 			if (win)
 				glfwDestroyWindow(win);
-			glfwTerminate();
+			if (headlessContext()->display)
+				headlessContext()->destroy();
+			else
+				glfwTerminate();
 		}
 	}
 
@@ -0,0 +1,204 @@
+#ifndef HEADER_BATCH_H
+#define HEADER_BATCH_H
+
+#include <glm/glm.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Capture.h"
+
+/****************************************************************************
+* BATCH JOBS                                                               *
+****************************************************************************/
+
+/* The jobs of the --batch mode, which renders frames offline into files
+* instead of to the screen. The job file is text with one command per line,
+* # starts a comment:
+*   size W H                 the resolution of the frames (default: 800 600)
+*   program N                the program of number key N (default: 0)
+*   mode cube|instanced|scene  what is drawn (default: cube)
+*   frames N                 frames per job (default: 1)
+*   fps N                    frame rate of a video output (default: 60)
+*   camera EX EY EZ TX TY TZ a key of the camera path: the eye at E looking
+*                            at T, the keys are spread evenly over the frames
+*   output PATH              where the frames go, like --capture: PNG files
+*                            with .png (numbered by a %u in the path, or
+*                            _%05u is added if there is more than one
+*                            frame), RGBA8 frames with .raw, else a video
+*   render                   queue a job with the settings so far
+* The settings stay for the following jobs, only the camera keys and the
+* output start over after each render. A job without camera keys is seen
+* from the default position. */
+#define BATCH_LINE_MAX 512
+#define BATCH_CAMERA_KEYS 64	/* per job */
+
+/* what a job draws */
+enum {
+	BATCH_CUBE = 0,
+	BATCH_INSTANCED,
+	BATCH_SCENE,
+	BATCH_MODE_COUNT
+};
+
+static const char *batchModeNames[BATCH_MODE_COUNT] = { "cube", "instanced", "scene" };
+
+/* plain floats, so that the jobs can be copied with memcpy */
+typedef struct {
+	float eye[3], target[3];
+} BatchCameraKey;
+
+typedef struct {
+	char output[CAPTURE_PATH_MAX];
+	int width, height;
+	int program;		/* number key of the keyboard table */
+	int mode;		/* BATCH_* */
+	int frames;
+	int fps;
+	BatchCameraKey keys[BATCH_CAMERA_KEYS];
+	int keyCount;		/* 0 for the default camera */
+	int line;		/* of the render command, for the messages */
+
+	/* The camera of frame f, on the straight lines between the keys.
+	* Returns false if the job has no camera keys. */
+	bool camera(int f, glm::vec3 *eye, glm::vec3 *target) const
+	{
+		if (!keyCount)
+			return false;
+		float t = (keyCount > 1 && frames > 1) ? (float)f * (float)(keyCount - 1) / (float)(frames - 1) : 0.0f;
+		int k = (int)t;
+		const BatchCameraKey *a = &keys[glm::min(k, keyCount - 1)];
+		const BatchCameraKey *b = &keys[glm::min(k + 1, keyCount - 1)];
+		t -= (float)k;
+		*eye = glm::mix(glm::vec3(a->eye[0], a->eye[1], a->eye[2]), glm::vec3(b->eye[0], b->eye[1], b->eye[2]), t);
+		*target = glm::mix(glm::vec3(a->target[0], a->target[1], a->target[2]),
+			glm::vec3(b->target[0], b->target[1], b->target[2]), t);
+		return true;
+	}
+
+	/* The file name of frame f if the output is a PNG per frame.
+	* Returns false if the output is a single file. */
+	bool frameFile(int f, char *name, size_t size) const
+	{
+		if (captureFormatByPath(output) != CAPTURE_PNG)
+			return false;
+		if (strchr(output, '%'))
+			mysnprintf(name, size, output, (unsigned int)f);
+		else if (frames > 1)
+			mysnprintf(name, size, "%.*s_%05u.png", (int)strlen(output) - 4, output, (unsigned int)f);
+		else
+			mysnprintf(name, size, "%s", output);
+		return true;
+	}
+} BatchJob;
+
+typedef struct {
+	BatchJob *jobs;
+	int count;
+	int totalFrames;
+
+	void clear()
+	{
+		jobs = NULL;
+		count = totalFrames = 0;
+	}
+
+	/* Read the jobs in the text file filename, see above.
+	* Returns true if successfull and false in case of an error. */
+	bool load(const char *filename)
+	{
+		char line[BATCH_LINE_MAX], cmd[32], arg[CAPTURE_PATH_MAX];
+		FILE *file = fopen(filename, "rt");
+		BatchJob job;
+		int number = 0, capacity = 0, i;
+		bool ok = true;
+
+		if (!file) {
+			warn("failed to open batch file '%s'", filename);
+			return false;
+		}
+		memset(&job, 0, sizeof(job));
+		job.width = 800;
+		job.height = 600;
+		job.frames = 1;
+		job.fps = CAPTURE_FPS;
+		while (ok && fgets(line, sizeof(line), file)) {
+			float v[6];
+			char *comment = strchr(line, '#');
+			number++;
+			if (comment)
+				*comment = 0;
+			if (sscanf(line, " %31s", cmd) != 1)
+				continue;
+			if (!strcmp(cmd, "size")) {
+				ok = sscanf(line, " %*s %d %d", &job.width, &job.height) == 2 && job.width > 0 && job.height > 0;
+			} else if (!strcmp(cmd, "program")) {
+				ok = sscanf(line, " %*s %d", &job.program) == 1 && job.program >= 0 && job.program <= 9;
+			} else if (!strcmp(cmd, "mode")) {
+				ok = sscanf(line, " %*s %31s", arg) == 1;
+				for (i = 0; ok && i < BATCH_MODE_COUNT && strcmp(arg, batchModeNames[i]); i++)
+					;
+				ok = ok && i < BATCH_MODE_COUNT;
+				job.mode = i;
+			} else if (!strcmp(cmd, "frames")) {
+				ok = sscanf(line, " %*s %d", &job.frames) == 1 && job.frames > 0;
+			} else if (!strcmp(cmd, "fps")) {
+				ok = sscanf(line, " %*s %d", &job.fps) == 1 && job.fps > 0;
+			} else if (!strcmp(cmd, "camera")) {
+				ok = sscanf(line, " %*s %f %f %f %f %f %f", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) == 6;
+				if (ok && job.keyCount >= BATCH_CAMERA_KEYS) {
+					warn("%s:%d: more than %d camera keys", filename, number, BATCH_CAMERA_KEYS);
+					ok = false;
+					continue;
+				} else if (ok) {
+					memcpy(&job.keys[job.keyCount++], v, sizeof(BatchCameraKey));
+				}
+			} else if (!strcmp(cmd, "output")) {
+				ok = sscanf(line, " %*s %255s", job.output) == 1;
+			} else if (!strcmp(cmd, "render")) {
+				if (!job.output[0]) {
+					warn("%s:%d: render without an output", filename, number);
+					ok = false;
+					continue;
+				} else if (count == capacity) {
+					capacity = capacity ? 2 * capacity : 16;
+					BatchJob *more = (BatchJob*)realloc(jobs, sizeof(BatchJob) * capacity);
+					if (more)
+						jobs = more;
+					else
+						ok = false;
+				}
+				if (ok) {
+					job.line = number;
+					jobs[count++] = job;
+					totalFrames += job.frames;
+					job.keyCount = 0;
+					job.output[0] = 0;
+				}
+			} else {
+				ok = false;
+			}
+			if (!ok)
+				warn("%s:%d: malformed batch command '%s'", filename, number, cmd);
+		}
+		fclose(file);
+		if (ok && !count) {
+			warn("batch file '%s' has no render command", filename);
+			ok = false;
+		}
+		if (!ok) {
+			destroy();
+			return false;
+		}
+		info("batch file '%s': %d jobs, %d frames", filename, count, totalFrames);
+		return true;
+	}
+
+	void destroy()
+	{
+		free(jobs);
+		clear();
+	}
+} BatchFile;
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef HEADER_BATCHWORKERS_H
+#define HEADER_BATCHWORKERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "Log.h"
+#include "Profiler.h"
+#include "Batch.h"
+#include "HeadlessContext.h"
+
+/****************************************************************************
+* BATCH WORKERS                                                            *
+****************************************************************************/
+
+/* The coordinator of --batch-workers: one render worker process per GPU,
+* which share out the jobs of a batch file. A worker is this executable
+* again, with the same options plus --headless, --egl-device of its GPU and
+* --batch-worker; it creates no window and renders the jobs the coordinator
+* names on its standard input, one index per line, and answers each with
+* "index ok" (1 or 0) on the pipe of --batch-worker. The coordinator itself
+* creates no GL context.
+* The jobs are handed out by queue depth: the next job goes to the worker
+* with the fewest unfinished jobs, and no worker has more than
+* BATCH_WORKER_DEPTH, so each one has its next job at hand while it renders
+* and a slow or busy GPU simply gets fewer jobs. The jobs of a worker which
+* dies are handed to the others. Not available on Windows. */
+#define BATCH_WORKERS_MAX HEADLESS_DEVICES_MAX
+#define BATCH_WORKER_DEPTH 2
+
+/* The pipe fd of --batch-worker, for the answers of the worker. */
+static FILE *batchWorkerResults(int fd)
+{
+#ifdef _WIN32
+	return _fdopen(fd, "w");
+#else
+	return fdopen(fd, "w");
+#endif
+}
+
+typedef struct {
+	int pid;		/* 0 if the worker has ended */
+	int device;		/* its EGL device */
+	FILE *jobs;		/* its standard input */
+	int results;		/* the read end of its answers */
+	char line[64];		/* the answer read so far */
+	int lineLength;
+	int queue[BATCH_WORKER_DEPTH];	/* the jobs it has not finished, in order */
+	int depth;
+	int done, frames;	/* jobs and frames it has finished */
+} BatchWorker;
+
+typedef struct {
+	BatchWorker workers[BATCH_WORKERS_MAX];
+	int count;
+	int *pending;		/* the jobs still to hand out, as a stack */
+	int pendingCount;
+	int failed;
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+#ifndef _WIN32
+	/* Start worker w on EGL device, as executable with the options args
+	* (args[0] is skipped). Returns true if successfull. */
+	bool spawn(BatchWorker *w, int device, const char *executable, int argc, char **args)
+	{
+		int in[2], out[2];
+		char deviceArg[16], fdArg[16];
+		const char **childArgs;
+		int i, n = 0;
+
+		if (pipe(in) || pipe(out)) {
+			warn("batch workers: failed to create the pipes");
+			return false;
+		}
+		childArgs = (const char**)malloc(sizeof(char*) * (argc + 8));
+		if (!childArgs)
+			return false;
+		childArgs[n++] = executable;
+		for (i = 1; i < argc; i++) {
+			/* everything but the options of the coordinator */
+			if (!strcmp(args[i], "--batch-workers") || !strcmp(args[i], "--egl-device")) {
+				i++;
+				continue;
+			}
+			if (!strcmp(args[i], "--headless"))
+				continue;
+			childArgs[n++] = args[i];
+		}
+		mysnprintf(deviceArg, sizeof(deviceArg), "%d", device);
+		mysnprintf(fdArg, sizeof(fdArg), "%d", out[1]);
+		childArgs[n++] = "--headless";
+		childArgs[n++] = "--egl-device";
+		childArgs[n++] = deviceArg;
+		childArgs[n++] = "--batch-worker";
+		childArgs[n++] = fdArg;
+		childArgs[n] = NULL;
+
+		fflush(stdout);
+		fflush(stderr);
+		pid_t pid = fork();
+		if (pid == 0) {
+			dup2(in[0], 0);
+			close(in[0]);
+			close(in[1]);
+			close(out[0]);
+			/* the pipes of the workers started before */
+			for (i = 0; i < count; i++) {
+				if (workers[i].jobs)
+					close(fileno(workers[i].jobs));
+				close(workers[i].results);
+			}
+			execvp(executable, (char * const *)childArgs);
+			fprintf(stderr, "batch workers: failed to start '%s': %s\n", executable, strerror(errno));
+			_exit(127);
+		}
+		free(childArgs);
+		close(in[0]);
+		close(out[1]);
+		if (pid < 0) {
+			warn("batch workers: fork failed");
+			close(in[1]);
+			close(out[0]);
+			return false;
+		}
+		memset(w, 0, sizeof(*w));
+		w->pid = (int)pid;
+		w->device = device;
+		w->jobs = fdopen(in[1], "w");
+		w->results = out[0];
+		info("batch workers: worker %d (pid %d) on EGL device %d", (int)(w - workers), w->pid, device);
+		return w->jobs != NULL;
+	}
+
+	/* Hand the next pending job to the worker with the fewest unfinished
+	* jobs, if one has room. Returns false if none has. */
+	bool assign()
+	{
+		BatchWorker *best = NULL;
+		int i;
+		for (i = 0; i < count; i++) {
+			BatchWorker *w = &workers[i];
+			if (w->pid && w->depth < BATCH_WORKER_DEPTH && (!best || w->depth < best->depth))
+				best = w;
+		}
+		if (!best || !pendingCount)
+			return false;
+		int job = pending[--pendingCount];
+		best->queue[best->depth++] = job;
+		fprintf(best->jobs, "%d\n", job);
+		fflush(best->jobs);
+		return true;
+	}
+
+	/* Worker w has ended: wait for it and put its unfinished jobs back. */
+	void lost(BatchWorker *w)
+	{
+		int status = 0, i;
+		waitpid((pid_t)w->pid, &status, 0);
+		if (w->depth)
+			warn("batch workers: worker %d (EGL device %d) ended with %d jobs left (%s %d)", (int)(w - workers),
+				w->device, w->depth, WIFSIGNALED(status) ? "signal" : "exit code",
+				WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+		for (i = w->depth - 1; i >= 0; i--)
+			pending[pendingCount++] = w->queue[i];
+		fclose(w->jobs);
+		close(w->results);
+		w->jobs = NULL;
+		w->pid = 0;
+		w->depth = 0;
+	}
+
+	/* Worker w answered line: the job at the front of its queue is done. */
+	void answer(BatchWorker *w, const char *line, const BatchFile *batch)
+	{
+		int job, ok;
+		if (sscanf(line, "%d %d", &job, &ok) != 2 || !w->depth || job != w->queue[0]) {
+			warn("batch workers: worker %d: unexpected answer '%s'", (int)(w - workers), line);
+			return;
+		}
+		memmove(w->queue, w->queue + 1, sizeof(int) * (w->depth - 1));
+		w->depth--;
+		w->done++;
+		w->frames += batch->jobs[job].frames;
+		if (!ok)
+			failed++;
+	}
+
+	/* Read what worker w has written. */
+	void receive(BatchWorker *w, const BatchFile *batch)
+	{
+		char buffer[256];
+		ssize_t n = read(w->results, buffer, sizeof(buffer));
+		ssize_t i;
+		if (n <= 0) {
+			if (n < 0 && errno == EINTR)
+				return;
+			lost(w);
+			return;
+		}
+		for (i = 0; i < n; i++) {
+			if (buffer[i] == '\n') {
+				w->line[w->lineLength] = 0;
+				answer(w, w->line, batch);
+				w->lineLength = 0;
+			} else if (w->lineLength < (int)sizeof(w->line) - 1) {
+				w->line[w->lineLength++] = buffer[i];
+			}
+		}
+	}
+#endif
+
+	/* Render the jobs of batch with workers processes, on the EGL devices
+	* in turn, 0 for one per device. executable, argc and argv are those
+	* of main().
+	* Returns true if successfull and false in case of an error or if a job
+	* failed. */
+	bool run(const BatchFile *batch, int workerCount, const char *executable, int argc, char **argv)
+	{
+#ifdef _WIN32
+		(void)batch; (void)workerCount; (void)executable; (void)argc; (void)argv;
+		warn("batch workers: not supported on Windows");
+		return false;
+#else
+		struct pollfd fds[BATCH_WORKERS_MAX];
+		BatchWorker *polled[BATCH_WORKERS_MAX];
+		int devices = headlessContext()->deviceCount();
+		int i, n, done = 0, frames = 0;
+
+		clear();
+		if (!devices)
+			return false;
+		if (!workerCount)
+			workerCount = devices;
+		if (workerCount > BATCH_WORKERS_MAX)
+			workerCount = BATCH_WORKERS_MAX;
+		pending = (int*)malloc(sizeof(int) * batch->count);
+		if (!pending)
+			return false;
+		/* a stack, the first job on top */
+		for (i = 0; i < batch->count; i++)
+			pending[i] = batch->count - 1 - i;
+		pendingCount = batch->count;
+		/* a worker blocked on a full pipe must not kill us */
+		signal(SIGPIPE, SIG_IGN);
+
+		double start = profileSeconds();
+		for (i = 0; i < workerCount; i++) {
+			if (spawn(&workers[count], i % devices, executable, argc, argv))
+				count++;
+		}
+		info("batch workers: %d jobs on %d workers, %d EGL devices", batch->count, count, devices);
+		for (;;) {
+			while (assign())
+				;
+			for (n = 0, i = 0; i < count; i++) {
+				if (workers[i].pid && workers[i].depth) {
+					fds[n].fd = workers[i].results;
+					fds[n].events = POLLIN;
+					fds[n].revents = 0;
+					polled[n++] = &workers[i];
+				}
+			}
+			if (!n)
+				break;
+			if (poll(fds, (nfds_t)n, -1) < 0) {
+				if (errno == EINTR)
+					continue;
+				warn("batch workers: poll failed");
+				break;
+			}
+			for (i = 0; i < n; i++) {
+				if (fds[i].revents)
+					receive(polled[i], batch);
+			}
+		}
+
+		/* no more jobs: the workers flush their outputs and end */
+		for (i = 0; i < count; i++) {
+			BatchWorker *w = &workers[i];
+			done += w->done;
+			frames += w->frames;
+			if (!w->pid)
+				continue;
+			fclose(w->jobs);
+			w->jobs = NULL;
+			int status = 0;
+			waitpid((pid_t)w->pid, &status, 0);
+			if (!WIFEXITED(status) || WEXITSTATUS(status))
+				failed++;
+			close(w->results);
+			w->pid = 0;
+		}
+		double total = profileSeconds() - start;
+		for (i = 0; i < count; i++)
+			info("batch workers: worker %d (EGL device %d): %d jobs, %d frames", i, workers[i].device,
+				workers[i].done, workers[i].frames);
+		info("batch workers: %d of %d jobs, %d frames in %.3fs, %.1f frames per second", done, batch->count,
+			frames, total, total > 0.0 ? (double)frames / total : 0.0);
+		if (pendingCount)
+			warn("batch workers: %d jobs were not rendered, no worker was left", pendingCount);
+		bool ok = !failed && !pendingCount && done == batch->count;
+		free(pending);
+		pending = NULL;
+		return ok;
+#endif
+	}
+} BatchWorkers;
+
+#endif
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Log.h"
+#include "BenchCompare.h"
+
+/* The benchmark comparison, a program of its own: it compares the frame
+ * times of every program in two outputs of --bench, the baseline A and the
+ * candidate B, see BenchCompare.h. */
+
+static const char *verdictNames[] = { "same", "improved", "REGRESSED", "untested" };
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [--alpha P] [--threshold PERCENT] [--metric cpu|gpu|both] A.json B.json\n"
+		"Compares the frame times of each program in the --bench output B against those\n"
+		"in A with a Mann-Whitney U test, Cliff's delta and a bootstrap confidence\n"
+		"interval of the change of the median. A change is a regression if p < P\n"
+		"(default: %g) and the interval lies above +PERCENT (default: %g). Prints a\n"
+		"table and exits with 1 if there is a regression, with 2 on errors.\n",
+		name, BENCH_COMPARE_ALPHA, 100.0 * BENCH_COMPARE_THRESHOLD);
+}
+
+int main (int argc, char **argv)
+{
+	static const char *metrics[2] = { "cpu", "gpu" };
+	double alpha = BENCH_COMPARE_ALPHA;
+	double threshold = BENCH_COMPARE_THRESHOLD;
+	bool metric[2] = { true, true };
+	BenchRun runs[2];
+	int i, m, regressions = 0, compared = 0;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		const char *arg = argv[i];
+		bool hasValue = i+1 < argc;
+		if (!strcmp(arg, "--alpha") && hasValue) {
+			alpha = atof(argv[++i]);
+			if (alpha <= 0.0 || alpha >= 1.0)
+				break;
+		} else if (!strcmp(arg, "--threshold") && hasValue) {
+			threshold = 0.01 * atof(argv[++i]);
+			if (threshold < 0.0)
+				break;
+		} else if (!strcmp(arg, "--metric") && hasValue) {
+			arg = argv[++i];
+			metric[0] = !strcmp(arg, "cpu") || !strcmp(arg, "both");
+			metric[1] = !strcmp(arg, "gpu") || !strcmp(arg, "both");
+			if (!metric[0] && !metric[1])
+				break;
+		} else {
+			break;
+		}
+	}
+	if (argc - i != 2) {
+		usage(argv[0]);
+		return 2;
+	}
+	runs[0].clear();
+	runs[1].clear();
+	if (!runs[0].load(argv[i]) || !runs[1].load(argv[i + 1])) {
+		runs[0].destroy();
+		return 2;
+	}
+	if (strcmp(runs[0].renderer, runs[1].renderer))
+		warn("the runs are from different renderers: '%s' and '%s'", runs[0].renderer, runs[1].renderer);
+
+	printf("%-4s %-48s %-4s %6s %6s %10s %10s %8s %19s %9s %7s  %s\n", "key", "program", "time", "n_a", "n_b",
+		"median_a", "median_b", "change", "95% interval", "p", "delta", "verdict");
+	for (i = 0; i < runs[1].count; i++) {
+		const BenchSamples *b = &runs[1].programs[i];
+		const BenchSamples *a = runs[0].find(b);
+		if (!a) {
+			printf("%-4d %-48s only in B\n", b->key, b->name);
+			continue;
+		}
+		for (m = 0; m < 2; m++) {
+			BenchComparison c;
+			if (!metric[m])
+				continue;
+			benchCompare(a->samples[m], a->count[m], b->samples[m], b->count[m], alpha, threshold, &c);
+			printf("%-4d %-48s %-4s %6d %6d %8.3fms %8.3fms %+7.1f%% [%+7.1f%%, %+7.1f%%] %9.2g %+7.3f  %s\n",
+				b->key, b->name, metrics[m], c.n[0], c.n[1], c.median[0], c.median[1], 100.0 * c.change,
+				100.0 * c.low, 100.0 * c.high, c.p, c.delta, verdictNames[c.verdict]);
+			if (c.verdict == BENCH_REGRESSED)
+				regressions++;
+			if (c.verdict != BENCH_UNTESTED)
+				compared++;
+		}
+	}
+	for (i = 0; i < runs[0].count; i++)
+		if (!runs[1].find(&runs[0].programs[i]))
+			printf("%-4d %-48s only in A\n", runs[0].programs[i].key, runs[0].programs[i].name);
+	printf("%d comparisons, %d regressions past %+.1f%% at p < %g\n", compared, regressions, 100.0 * threshold, alpha);
+	runs[0].destroy();
+	runs[1].destroy();
+	return regressions ? 1 : 0;
+}
@@ -0,0 +1,512 @@
+#ifndef HEADER_BENCHCOMPARE_H
+#define HEADER_BENCHCOMPARE_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+
+/****************************************************************************
+* BENCHMARK COMPARISON                                                     *
+****************************************************************************/
+
+/* What the comparison tool (BenchCompare.cpp) needs: a reader for the JSON
+* of the --bench mode (see Benchmark.h) and the statistics comparing the
+* frame times of a program in two runs, A the baseline and B the candidate.
+* Frame times are skewed and have long tails, a few hitches move the mean
+* much, so nothing here uses the mean:
+* - the Mann-Whitney U test, whether a frame of B tends to take longer or
+*   shorter than one of A, with the normal approximation corrected for
+*   ties, which holds for the hundreds of frames of a run,
+* - Cliff's delta as its effect size, the probability that a frame of B
+*   takes longer than one of A minus that it takes shorter, from -1 to 1,
+* - the change of the median, with a percentile bootstrap confidence
+*   interval of BENCH_COMPARE_CONFIDENCE from resampling both runs.
+* A change is a regression if the test is significant at alpha and the
+* lower bound of the interval of the median is past the threshold, so both
+* chance and tiny real changes are not flagged. */
+#define BENCH_COMPARE_CONFIDENCE 0.95
+#define BENCH_COMPARE_RESAMPLES 2000
+#define BENCH_COMPARE_ALPHA 0.01
+#define BENCH_COMPARE_THRESHOLD 0.05	/* of the median */
+#define BENCH_COMPARE_MAX 64		/* programs per file */
+
+/* as in ShaderHelpers.h, which this does without */
+#ifndef mysnprintf
+#ifdef WIN32
+#define mysnprintf sprintf_s
+#else
+#define mysnprintf snprintf
+#endif
+#endif
+
+/* the verdict on a metric */
+enum {
+	BENCH_SAME = 0,
+	BENCH_IMPROVED,
+	BENCH_REGRESSED,
+	BENCH_UNTESTED		/* too few samples */
+};
+
+/* A node of a JSON document, the children of objects and arrays are
+* linked by next, -1 ends them. Strings are left escaped, the keys and
+* names of the bench output have no escapes. */
+enum {
+	JSON_NULL = 0,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+};
+
+typedef struct {
+	int type;
+	const char *key;	/* in the parent object, or NULL */
+	int keyLength;
+	const char *str;	/* of a string */
+	int strLength;
+	double number;		/* of a number or bool */
+	int first;		/* child, -1 if none */
+	int next;		/* sibling, -1 if none */
+} JsonNode;
+
+typedef struct {
+	char *text;
+	JsonNode *nodes;
+	int count, capacity;
+	const char *p, *end;	/* while parsing */
+
+	void clear()
+	{
+		text = NULL;
+		nodes = NULL;
+		count = capacity = 0;
+	}
+
+	void destroy()
+	{
+		free(text);
+		free(nodes);
+		clear();
+	}
+
+	void skipSpace()
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+	}
+
+	int add(int type)
+	{
+		if (count >= capacity) {
+			int n = capacity ? 2 * capacity : 1024;
+			JsonNode *grown = (JsonNode*)realloc(nodes, sizeof(JsonNode) * n);
+			if (!grown)
+				return -1;
+			nodes = grown;
+			capacity = n;
+		}
+		JsonNode *node = &nodes[count];
+		memset(node, 0, sizeof(*node));
+		node->type = type;
+		node->first = node->next = -1;
+		return count++;
+	}
+
+	/* the string at p, which is at its opening quote, into *str */
+	bool parseString(const char **str, int *length)
+	{
+		const char *start = ++p;
+		while (p < end && *p != '"') {
+			if (*p == '\\')
+				p++;
+			p++;
+		}
+		if (p >= end)
+			return false;
+		*str = start;
+		*length = (int)(p - start);
+		p++;
+		return true;
+	}
+
+	/* Returns the index of the value at p, -1 if it is malformed. */
+	int parseValue(int depth)
+	{
+		int node, last = -1;
+
+		skipSpace();
+		if (p >= end || depth > 64)
+			return -1;
+		if (*p == '{' || *p == '[') {
+			bool object = *p == '{';
+			char close = object ? '}' : ']';
+			node = add(object ? JSON_OBJECT : JSON_ARRAY);
+			if (node < 0)
+				return -1;
+			p++;
+			skipSpace();
+			if (p < end && *p == close) {
+				p++;
+				return node;
+			}
+			for (;;) {
+				const char *key = NULL;
+				int keyLength = 0;
+				if (object) {
+					skipSpace();
+					if (p >= end || *p != '"' || !parseString(&key, &keyLength))
+						return -1;
+					skipSpace();
+					if (p >= end || *p != ':')
+						return -1;
+					p++;
+				}
+				int child = parseValue(depth + 1);
+				if (child < 0)
+					return -1;
+				nodes[child].key = key;
+				nodes[child].keyLength = keyLength;
+				if (last < 0)
+					nodes[node].first = child;
+				else
+					nodes[last].next = child;
+				last = child;
+				skipSpace();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				if (p < end && *p == close) {
+					p++;
+					return node;
+				}
+				return -1;
+			}
+		}
+		if (*p == '"') {
+			node = add(JSON_STRING);
+			if (node < 0 || !parseString(&nodes[node].str, &nodes[node].strLength))
+				return -1;
+			return node;
+		}
+		if (end - p >= 4 && !strncmp(p, "true", 4)) {
+			node = add(JSON_BOOL);
+			p += 4;
+			if (node >= 0)
+				nodes[node].number = 1.0;
+			return node;
+		}
+		if (end - p >= 5 && !strncmp(p, "false", 5)) {
+			p += 5;
+			return add(JSON_BOOL);
+		}
+		if (end - p >= 4 && !strncmp(p, "null", 4)) {
+			p += 4;
+			return add(JSON_NULL);
+		}
+		char *next;
+		double v = strtod(p, &next);
+		if (next == p)
+			return -1;
+		p = next;
+		node = add(JSON_NUMBER);
+		if (node >= 0)
+			nodes[node].number = v;
+		return node;
+	}
+
+	/* Read and parse filename, the root is node 0.
+	* Returns true if successfull and false in case of an error. */
+	bool load(const char *filename)
+	{
+		clear();
+		FILE *f = fopen(filename, "rb");
+		if (!f) {
+			warn("failed to open '%s'", filename);
+			return false;
+		}
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		text = (char*)malloc(size > 0 ? (size_t)size + 1 : 1);
+		bool ok = text && size >= 0 && fread(text, 1, (size_t)size, f) == (size_t)size;
+		fclose(f);
+		if (!ok) {
+			warn("failed to read '%s'", filename);
+			destroy();
+			return false;
+		}
+		text[size] = 0;
+		p = text;
+		end = text + size;
+		if (parseValue(0) != 0) {
+			warn("'%s' is not valid JSON, near offset %ld", filename, (long)(p - text));
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	/* The child of object node under key, -1 if there is none. */
+	int child(int node, const char *key) const
+	{
+		int i;
+		size_t n = strlen(key);
+		if (node < 0 || nodes[node].type != JSON_OBJECT)
+			return -1;
+		for (i = nodes[node].first; i >= 0; i = nodes[i].next)
+			if ((size_t)nodes[i].keyLength == n && !strncmp(nodes[i].key, key, n))
+				return i;
+		return -1;
+	}
+
+	/* The number under key of object node, def if there is none. */
+	double number(int node, const char *key, double def) const
+	{
+		int c = child(node, key);
+		return (c >= 0 && (nodes[c].type == JSON_NUMBER || nodes[c].type == JSON_BOOL)) ? nodes[c].number : def;
+	}
+} JsonDoc;
+
+static int benchCompareFloats(const void *a, const void *b)
+{
+	float x = *(const float*)a;
+	float y = *(const float*)b;
+	return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+static int benchCompareDoubles(const void *a, const void *b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/* the frame times of a program in a run */
+typedef struct {
+	int key;
+	char name[128];		/* vs + fs, what the programs are matched by */
+	unsigned int defines;
+	float *samples[2];	/* cpu, gpu, NULL if there are none */
+	int count[2];
+} BenchSamples;
+
+typedef struct {
+	BenchSamples programs[BENCH_COMPARE_MAX];
+	int count;
+	char renderer[128];
+
+	void clear()
+	{
+		count = 0;
+		renderer[0] = 0;
+	}
+
+	void destroy()
+	{
+		int i, m;
+		for (i = 0; i < count; i++)
+			for (m = 0; m < 2; m++)
+				free(programs[i].samples[m]);
+		clear();
+	}
+
+	/* the array of samples of metric node m of a program, sorted */
+	static float *readSamples(const JsonDoc *doc, int m, int *n)
+	{
+		int i, k = 0;
+		int a = doc->child(m, "samples");
+		*n = 0;
+		if (a < 0 || doc->nodes[a].type != JSON_ARRAY)
+			return NULL;
+		for (i = doc->nodes[a].first; i >= 0; i = doc->nodes[i].next)
+			k++;
+		float *s = k ? (float*)malloc(sizeof(float) * k) : NULL;
+		if (!s)
+			return NULL;
+		k = 0;
+		for (i = doc->nodes[a].first; i >= 0; i = doc->nodes[i].next)
+			if (doc->nodes[i].type == JSON_NUMBER)
+				s[k++] = (float)doc->nodes[i].number;
+		qsort(s, k, sizeof(float), benchCompareFloats);
+		*n = k;
+		return s;
+	}
+
+	/* Read the programs of the --bench JSON in filename.
+	* Returns true if successfull and false in case of an error. */
+	bool load(const char *filename)
+	{
+		static const char *metrics[2] = { "cpu", "gpu" };
+		JsonDoc doc;
+		int i, m;
+
+		clear();
+		if (!doc.load(filename))
+			return false;
+		int r = doc.child(0, "renderer");
+		if (r >= 0 && doc.nodes[r].type == JSON_STRING)
+			mysnprintf(renderer, sizeof(renderer), "%.*s", doc.nodes[r].strLength, doc.nodes[r].str);
+		int shaders = doc.child(0, "shaders");
+		if (shaders < 0 || doc.nodes[shaders].type != JSON_ARRAY) {
+			warn("'%s' has no shaders, is it the output of --bench?", filename);
+			doc.destroy();
+			return false;
+		}
+		for (i = doc.nodes[shaders].first; i >= 0 && count < BENCH_COMPARE_MAX; i = doc.nodes[i].next) {
+			BenchSamples *b = &programs[count];
+			int vs = doc.child(i, "vs"), fs = doc.child(i, "fs");
+			if (vs < 0 || fs < 0 || doc.nodes[vs].type != JSON_STRING || doc.nodes[fs].type != JSON_STRING ||
+				!doc.number(i, "ok", 0.0))
+				continue;
+			b->key = (int)doc.number(i, "key", -1.0);
+			b->defines = (unsigned int)doc.number(i, "defines", 0.0);
+			mysnprintf(b->name, sizeof(b->name), "%.*s + %.*s", doc.nodes[vs].strLength, doc.nodes[vs].str,
+				doc.nodes[fs].strLength, doc.nodes[fs].str);
+			for (m = 0; m < 2; m++)
+				b->samples[m] = readSamples(&doc, doc.child(i, metrics[m]), &b->count[m]);
+			count++;
+		}
+		doc.destroy();
+		return true;
+	}
+
+	/* The program of other with the same shaders and defines, or NULL. */
+	const BenchSamples *find(const BenchSamples *other) const
+	{
+		int i;
+		for (i = 0; i < count; i++)
+			if (!strcmp(programs[i].name, other->name) && programs[i].defines == other->defines)
+				return &programs[i];
+		return NULL;
+	}
+} BenchRun;
+
+/* what compares the samples of a metric in two runs */
+typedef struct {
+	int n[2];
+	double median[2];
+	double change;		/* of the median, relative to A */
+	double low, high;	/* its confidence interval */
+	double p;		/* of the Mann-Whitney U test, two-sided */
+	double delta;		/* Cliff's delta, > 0 if B takes longer */
+	int verdict;		/* BENCH_* */
+} BenchComparison;
+
+static double benchMedian(const float *sorted, int n)
+{
+	return (n & 1) ? sorted[n / 2] : 0.5 * ((double)sorted[n / 2 - 1] + (double)sorted[n / 2]);
+}
+
+/* uniform in [0, n), the same on every platform */
+static int benchRandom(unsigned int *seed, int n)
+{
+	*seed = *seed * 1664525u + 1013904223u;
+	return (int)(((unsigned long long)(*seed >> 8) * (unsigned int)n) >> 24);
+}
+
+/* Mann-Whitney U of a against b, the samples of both sorted: U counts the
+* pairs in which the sample of b is larger, ties as a half. Returns the
+* two-sided p-value of the normal approximation and Cliff's delta in
+* *delta. */
+static double benchMannWhitney(const float *a, int na, const float *b, int nb, double *delta)
+{
+	int i = 0, j = 0;
+	double rankSumB = 0.0, ties = 0.0, rank = 1.0;
+
+	/* merge, the tied values share the mean of their ranks */
+	while (i < na || j < nb) {
+		float v = (j >= nb || (i < na && a[i] <= b[j])) ? a[i] : b[j];
+		int ta = 0, tb = 0;
+		while (i < na && a[i] == v) {
+			i++;
+			ta++;
+		}
+		while (j < nb && b[j] == v) {
+			j++;
+			tb++;
+		}
+		double t = (double)(ta + tb);
+		rankSumB += (double)tb * (rank + 0.5 * (t - 1.0));
+		ties += t * t * t - t;
+		rank += t;
+	}
+	double n1 = (double)na, n2 = (double)nb, n = n1 + n2;
+	double u = rankSumB - n2 * (n2 + 1.0) * 0.5;
+	*delta = 2.0 * u / (n1 * n2) - 1.0;
+	double sigma = sqrt(n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0))));
+	if (sigma <= 0.0)
+		return 1.0;
+	/* with the continuity correction */
+	double z = (fabs(u - 0.5 * n1 * n2) - 0.5) / sigma;
+	if (z < 0.0)
+		z = 0.0;
+	return erfc(z / sqrt(2.0));
+}
+
+/* Compare the na samples of a with the nb of b, both sorted, see above. */
+static void benchCompare(const float *a, int na, const float *b, int nb, double alpha, double threshold,
+	BenchComparison *c)
+{
+	int i, k;
+	c->n[0] = na;
+	c->n[1] = nb;
+	c->verdict = BENCH_UNTESTED;
+	c->median[0] = c->median[1] = c->change = c->low = c->high = c->delta = 0.0;
+	c->p = 1.0;
+	if (na < 8 || nb < 8)
+		return;
+	c->median[0] = benchMedian(a, na);
+	c->median[1] = benchMedian(b, nb);
+	if (c->median[0] <= 0.0)
+		return;
+	c->change = c->median[1] / c->median[0] - 1.0;
+	c->p = benchMannWhitney(a, na, b, nb, &c->delta);
+
+	/* the percentile bootstrap of the change of the median */
+	float *ra = (float*)malloc(sizeof(float) * na);
+	float *rb = (float*)malloc(sizeof(float) * nb);
+	double *changes = (double*)malloc(sizeof(double) * BENCH_COMPARE_RESAMPLES);
+	if (!ra || !rb || !changes) {
+		free(ra);
+		free(rb);
+		free(changes);
+		return;
+	}
+	unsigned int seed = 1;
+	int valid = 0;
+	for (k = 0; k < BENCH_COMPARE_RESAMPLES; k++) {
+		for (i = 0; i < na; i++)
+			ra[i] = a[benchRandom(&seed, na)];
+		for (i = 0; i < nb; i++)
+			rb[i] = b[benchRandom(&seed, nb)];
+		qsort(ra, na, sizeof(float), benchCompareFloats);
+		qsort(rb, nb, sizeof(float), benchCompareFloats);
+		double m = benchMedian(ra, na);
+		if (m > 0.0)
+			changes[valid++] = benchMedian(rb, nb) / m - 1.0;
+	}
+	if (valid) {
+		qsort(changes, valid, sizeof(double), benchCompareDoubles);
+		double tail = 0.5 * (1.0 - BENCH_COMPARE_CONFIDENCE);
+		c->low = changes[(int)(tail * (valid - 1))];
+		c->high = changes[(int)((1.0 - tail) * (valid - 1))];
+	}
+	free(ra);
+	free(rb);
+	free(changes);
+
+	if (c->p >= alpha)
+		c->verdict = BENCH_SAME;
+	else if (c->low > threshold)
+		c->verdict = BENCH_REGRESSED;
+	else if (c->high < -threshold)
+		c->verdict = BENCH_IMPROVED;
+	else
+		c->verdict = BENCH_SAME;
+}
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef HEADER_BENCHMARK_H
+#define HEADER_BENCHMARK_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "FrameStats.h"
+#include "MemoryStats.h"
+#include "Telemetry.h"
+
+/****************************************************************************
+* BENCHMARK RESULTS                                                        *
+****************************************************************************/
+
+/* The statistics gathered by the --bench mode, one result per program of
+* the keyboard table, and the writers for the machine-readable output. The
+* JSON has the time of every frame measured as well, in the order they
+* were drawn, for the tests of BenchCompare.cpp. With --telemetry each
+* result also has the average clocks, power and temperatures of its
+* measured frames and the energy per frame, see Telemetry.h. */
+#define BENCH_MAX_RESULTS 16
+
+enum {
+	BENCH_FORMAT_JSON = 0,
+	BENCH_FORMAT_CSV
+};
+
+typedef struct {
+	int key;		/* the number key / registry index */
+	const char *vs, *fs;
+	unsigned int defines;	/* feature define mask of the permutation */
+	unsigned int raster;	/* RASTER_* flags it was drawn with */
+	bool ok;		/* false if the program could not be built */
+	FrameTimeStats cpu;	/* wall time per frame */
+	FrameTimeStats gpu;	/* GPU time per frame, count 0 if unavailable */
+	float *cpuSamples, *gpuSamples;	/* cpu.count and gpu.count of them, or NULL */
+	TelemetryDelta telemetry;	/* of the measured frames, seconds 0 without */
+} BenchResult;
+
+typedef struct {
+	int frames;		/* frames measured per program */
+	int warmup;		/* frames rendered before measuring */
+	bool instanced;
+	bool scene;		/* the scene mode was on */
+	const char *target;	/* what we rendered into */
+	const char *vertexFormat;	/* name of the VertexLayout of the meshes, "pulled" with vertex pulling */
+	int width, height;
+	BenchResult results[BENCH_MAX_RESULTS];
+	int count;
+
+	/* per-frame samples of the program currently measured */
+	float *cpuTimes, *gpuTimes;
+	int cpuCount, gpuCount;
+
+	bool init(int frameCount, int warmupCount)
+	{
+		int i;
+		for (i = 0; i < BENCH_MAX_RESULTS; i++)
+			results[i].cpuSamples = results[i].gpuSamples = NULL;
+		frames = frameCount;
+		instanced = false;
+		scene = false;
+		target = "window";
+		vertexFormat = "float";
+		warmup = warmupCount;
+		count = 0;
+		cpuCount = gpuCount = 0;
+		cpuTimes = (float*)malloc(sizeof(float) * frames);
+		gpuTimes = (float*)malloc(sizeof(float) * frames);
+		if (!cpuTimes || !gpuTimes) {
+			warn("failed to allocate benchmark samples");
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < BENCH_MAX_RESULTS; i++) {
+			free(results[i].cpuSamples);
+			free(results[i].gpuSamples);
+			results[i].cpuSamples = results[i].gpuSamples = NULL;
+		}
+		free(cpuTimes);
+		free(gpuTimes);
+		cpuTimes = gpuTimes = NULL;
+	}
+
+	/* A copy of the n samples in times, NULL if there are none. */
+	static float *copySamples(const float *times, int n)
+	{
+		float *copy = n ? (float*)malloc(sizeof(float) * n) : NULL;
+		if (copy)
+			memcpy(copy, times, sizeof(float) * n);
+		return copy;
+	}
+
+	/* Start measuring a new program. Returns NULL if there is no room. */
+	BenchResult *begin(int key, const char *vs, const char *fs, unsigned int defines)
+	{
+		if (count >= BENCH_MAX_RESULTS)
+			return NULL;
+		BenchResult *r = &results[count++];
+		r->key = key;
+		r->vs = vs;
+		r->fs = fs;
+		r->defines = defines;
+		r->raster = RASTER_DEFAULT;
+		r->ok = false;
+		free(r->cpuSamples);
+		free(r->gpuSamples);
+		r->cpuSamples = r->gpuSamples = NULL;
+		frameTimeStatsCompute(&r->cpu, cpuTimes, 0);
+		frameTimeStatsCompute(&r->gpu, gpuTimes, 0);
+		r->telemetry.seconds = 0.0;
+		cpuCount = gpuCount = 0;
+		return r;
+	}
+
+	void addCPU(double ms)
+	{
+		if (cpuCount < frames)
+			cpuTimes[cpuCount++] = (float)ms;
+	}
+
+	void addGPU(double ms)
+	{
+		if (ms >= 0.0 && gpuCount < frames)
+			gpuTimes[gpuCount++] = (float)ms;
+	}
+
+	/* Compute the statistics of the samples added since begin(). */
+	void end(BenchResult *r)
+	{
+		/* in the order of the frames, the statistics sort them */
+		r->cpuSamples = copySamples(cpuTimes, cpuCount);
+		r->gpuSamples = copySamples(gpuTimes, gpuCount);
+		frameTimeStatsCompute(&r->cpu, cpuTimes, cpuCount);
+		frameTimeStatsCompute(&r->gpu, gpuTimes, gpuCount);
+		r->ok = true;
+	}
+
+	/* Write all results to filename, or to stdout if it is NULL.
+	* Returns true if successfull. */
+	bool write(const char *filename, int format) const
+	{
+		FILE *f = filename ? fopen(filename, "wt") : stdout;
+		if (!f) {
+			warn("failed to open benchmark output '%s'", filename);
+			return false;
+		}
+		if (format == BENCH_FORMAT_CSV)
+			writeCSV(f);
+		else
+			writeJSON(f);
+		bool ok = !ferror(f);
+		if (filename) {
+			ok = (fclose(f) == 0) && ok;
+			info("benchmark results written to '%s'", filename);
+		}
+		return ok;
+	}
+
+	static void writeJSONString(FILE *f, const char *str)
+	{
+		fputc('"', f);
+		for (; str && *str; str++) {
+			if (*str == '"' || *str == '\\')
+				fputc('\\', f);
+			if ((unsigned char)*str >= 0x20)
+				fputc(*str, f);
+		}
+		fputc('"', f);
+	}
+
+	/* with the samples if there are any */
+	static void writeJSONStats(FILE *f, const char *name, const FrameTimeStats *s, const float *samples = NULL)
+	{
+		unsigned int i;
+		fprintf(f, "\"%s\": {\"frames\": %u, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f",
+			name, s->count, s->mean, s->p50, s->p95, s->p99, s->max);
+		if (samples) {
+			fprintf(f, ",\n      \"samples\": [");
+			for (i = 0; i < s->count; i++)
+				fprintf(f, "%s%.4f", i ? (i % 16 ? ", " : ",\n        ") : "", samples[i]);
+			fprintf(f, "]");
+		}
+		fprintf(f, "}");
+	}
+
+	/* the averages of the metrics which are known and the energy per
+	* frame, -1 if unknown */
+	static void writeJSONTelemetry(FILE *f, const TelemetryDelta *t, unsigned int frames)
+	{
+		int m;
+		fprintf(f, "\"telemetry\": {\"seconds\": %.3f", t->seconds);
+		for (m = 0; m < TELEMETRY_METRICS; m++)
+			fprintf(f, ", \"%s\": %.2f", telemetryKeys[m], t->average[m]);
+		fprintf(f, ", \"joules\": %.4f, \"mj_per_frame\": %.4f}", t->joules,
+			(t->joules >= 0.0 && frames) ? 1000.0 * t->joules / (double)frames : -1.0);
+	}
+
+	void writeJSON(FILE *f) const
+	{
+		int i;
+		fprintf(f, "{\n  \"renderer\": ");
+		writeJSONString(f, (const char*)glGetString(GL_RENDERER));
+		fprintf(f, ",\n  \"version\": ");
+		writeJSONString(f, (const char*)glGetString(GL_VERSION));
+		fprintf(f, ",\n  \"frames\": %d,\n  \"warmup\": %d,\n  \"instanced\": %s,\n  \"scene\": %s,\n  \"target\": ",
+			frames, warmup, instanced ? "true" : "false", scene ? "true" : "false");
+		writeJSONString(f, target);
+		fprintf(f, ",\n  \"vertex_format\": ");
+		writeJSONString(f, vertexFormat);
+		fprintf(f, ",\n  \"width\": %d,\n  \"height\": %d,\n", width, height);
+		fprintf(f, "  \"unit\": \"ms\",\n  \"shaders\": [");
+		for (i = 0; i < count; i++) {
+			const BenchResult *r = &results[i];
+			fprintf(f, "%s\n    {\"key\": %d, \"vs\": ", i ? "," : "", r->key);
+			writeJSONString(f, r->vs);
+			fprintf(f, ", \"fs\": ");
+			writeJSONString(f, r->fs);
+			fprintf(f, ", \"defines\": %u, \"raster\": %u, \"ok\": %s", r->defines, r->raster,
+				r->ok ? "true" : "false");
+			if (r->ok) {
+				fprintf(f, ",\n     ");
+				writeJSONStats(f, "cpu", &r->cpu, r->cpuSamples);
+				fprintf(f, ",\n     ");
+				writeJSONStats(f, "gpu", &r->gpu, r->gpuSamples);
+				if (r->telemetry.seconds > 0.0) {
+					fprintf(f, ",\n     ");
+					writeJSONTelemetry(f, &r->telemetry, r->cpu.count);
+				}
+			}
+			fprintf(f, "}");
+		}
+		fprintf(f, "\n  ],\n  \"memory\": ");
+		memoryStats()->writeJSON(f);
+		fprintf(f, "\n}\n");
+	}
+
+	void writeCSV(FILE *f) const
+	{
+		int i, m;
+		fprintf(f, "key,vs,fs,defines,raster,ok,instanced,scene,target,vertex_format,width,height,frames,"
+			"cpu_mean,cpu_p50,cpu_p95,cpu_p99,cpu_max,"
+			"gpu_frames,gpu_mean,gpu_p50,gpu_p95,gpu_p99,gpu_max");
+		/* the telemetry, -1 where it is unknown or off */
+		for (m = 0; m < TELEMETRY_METRICS; m++)
+			fprintf(f, ",%s", telemetryKeys[m]);
+		fprintf(f, ",mj_per_frame\n");
+		for (i = 0; i < count; i++) {
+			const BenchResult *r = &results[i];
+			const FrameTimeStats *c = &r->cpu;
+			const FrameTimeStats *g = &r->gpu;
+			const TelemetryDelta *t = &r->telemetry;
+			bool known = t->seconds > 0.0;
+			fprintf(f, "%d,%s,%s,%u,%u,%d,%d,%d,%s,%s,%d,%d,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%u,%.4f,%.4f,%.4f,%.4f,%.4f",
+				r->key, r->vs, r->fs, r->defines, r->raster, r->ok ? 1 : 0, instanced ? 1 : 0, scene ? 1 : 0, target, vertexFormat, width, height,
+				c->count, c->mean, c->p50, c->p95, c->p99, c->max,
+				g->count, g->mean, g->p50, g->p95, g->p99, g->max);
+			for (m = 0; m < TELEMETRY_METRICS; m++)
+				fprintf(f, ",%.2f", known ? t->average[m] : -1.0);
+			fprintf(f, ",%.4f\n", (known && t->joules >= 0.0 && c->count) ? 1000.0 * t->joules / (double)c->count : -1.0);
+		}
+	}
+} Benchmark;
+
+#endif
@@ -0,0 +1,318 @@
+#ifndef HEADER_BROADPHASE_H
+#define HEADER_BROADPHASE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtx/wide.hpp>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include "JobSystem.h"
+#include "LargePages.h"
+#include "Log.h"
+#include "MemoryStats.h"
+
+/****************************************************************************
+* BROADPHASE: the pairs of overlapping objects, by sweep and prune         *
+****************************************************************************/
+
+/* Broadphase: which of many moving spheres overlap, for the gameplay and
+* physics which must not test every pair. The objects are kept sorted by
+* the low end of their extent on one axis (sweep and prune): the ones an
+* object may touch follow it in that order, up to the first which starts
+* beyond its high end, so each is only tested against those. The axis is
+* the one along which the centers vary the most, picked by each full sort,
+* so the runs are short for scenes spread out more on one axis than the
+* others; a dense grid, as wide as it is deep, is the worst case.
+* The spheres are not copied: the sweep reads them through the sort order
+* from the arrays of the FrustumCuller (or any like them), and the sort
+* keeps only its key, the low end, next to the order.
+* update() refreshes the keys and sorts them by insertion, which costs
+* next to nothing when the objects moved a little since the last frame and
+* the order hardly changed (the first one, and any after setObjects(), is
+* a full sort). Then the sweep splits the sorted objects across the job
+* system, and tests the followers of each in BROADPHASE_LANES at a time,
+* the SoA lanes of glm/gtx/wide.hpp: the sphere against sphere test, and
+* the end of the run on the axis. Each thread writes the pairs it finds
+* into a list of its own (by jobWorkerIndex() + 1, like the CommandQueue),
+* which grows as needed, so the threads share nothing; forEach() goes
+* through all of them. No objects may move during update(). */
+#define BROADPHASE_GRAIN 4096	/* sorted objects per parallel chunk */
+#define BROADPHASE_THREADS (JOB_MAX_WORKERS + 1)
+#define BROADPHASE_PAIRS 4096	/* pairs a list starts with */
+#if GLM_ARCH & GLM_ARCH_AVX
+#define BROADPHASE_LANES 8
+#else
+#define BROADPHASE_LANES 4
+#endif
+
+typedef struct {
+	int a, b;	/* a precedes b in the sort order */
+} BroadphasePair;
+
+/* Called for each pair forEach() goes through. */
+typedef void (*BroadphasePairFunc)(void *user, int a, int b);
+
+/* the pairs one thread found */
+typedef struct {
+	BroadphasePair *pairs;
+	int count, capacity;
+	bool failed;		/* could not grow, pairs were lost */
+
+	void clear()
+	{
+		pairs = NULL;
+		count = capacity = 0;
+		failed = false;
+	}
+
+	void add(int a, int b)
+	{
+		if (count == capacity) {
+			int n = capacity ? 2 * capacity : BROADPHASE_PAIRS;
+			BroadphasePair *p = (BroadphasePair*)realloc(pairs, sizeof(BroadphasePair) * n);
+			if (!p) {
+				failed = true;
+				return;
+			}
+			pairs = p;
+			capacity = n;
+		}
+		pairs[count].a = a;
+		pairs[count++].b = b;
+	}
+} BroadphaseList;
+
+static void broadphaseKeysJob(void *user, int begin, int end);
+static void broadphaseSweepJob(void *user, int begin, int end);
+
+typedef struct {
+	/* the spheres of the last setObjects(), not owned */
+	const float *x, *y, *z, *radius;
+	const float *axis;	/* x, y or z, the one sorted along */
+	int count, capacity;
+	int *order;		/* the objects, sorted by the low end on the axis */
+	float *low;		/* that end, in the same order */
+	bool sorted;		/* order holds the objects of x, y, z and radius */
+	BroadphaseList lists[BROADPHASE_THREADS];	/* by jobWorkerIndex() + 1 */
+	int pairCount;		/* of the last update() */
+	unsigned long long swaps;	/* of the insertion sorts, in total */
+	unsigned int updates;
+
+	void clear()
+	{
+		int i;
+		x = y = z = radius = NULL;
+		axis = NULL;
+		count = capacity = 0;
+		order = NULL;
+		low = NULL;
+		sorted = false;
+		for (i = 0; i < BROADPHASE_THREADS; i++)
+			lists[i].clear();
+		pairCount = 0;
+		swaps = 0;
+		updates = 0;
+	}
+
+	/* Allocate room for up to cap objects.
+	* Returns true if successfull and false in case of an error. */
+	bool init(int cap)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		/* the lanes read past the last object, into keys which are
+		* beyond every object and the order of the first one */
+		order = (int*)largePageAlloc(sizeof(int) * (cap + BROADPHASE_LANES));
+		low = (float*)largePageAlloc(sizeof(float) * (cap + BROADPHASE_LANES));
+		if (!order || !low) {
+			warn("broadphase: failed to allocate %d objects", cap);
+			destroy();
+			return false;
+		}
+		capacity = cap;
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		if (updates)
+			info("broadphase: %d objects, %d pairs in the last of %u updates, %.1f swaps per update",
+				count, pairCount, updates, (double)swaps / (double)updates);
+		largePageFree(order);
+		largePageFree(low);
+		for (i = 0; i < BROADPHASE_THREADS; i++)
+			free(lists[i].pairs);
+		clear();
+	}
+
+	/* Take the n spheres in the arrays px, py, pz and pr, which must stay
+	* valid until the next call. The next update() sorts them from
+	* scratch. */
+	void setObjects(const float *px, const float *py, const float *pz, const float *pr, int n)
+	{
+		x = px;
+		y = py;
+		z = pz;
+		radius = pr;
+		count = n < capacity ? n : capacity;
+		sorted = false;
+	}
+
+	/* Find the pairs of spheres which overlap, after the objects moved,
+	* in parallel on jobs (which may be NULL). */
+	void update(JobSystem *jobs)
+	{
+		int i;
+		if (!count) {
+			pairCount = 0;
+			return;
+		}
+		if (sorted) {
+			run(jobs, broadphaseKeysJob, count, BROADPHASE_GRAIN);
+			insertionSort();
+		} else {
+			fullSort();
+		}
+		for (i = 0; i < BROADPHASE_LANES; i++) {
+			order[count + i] = order[0];
+			low[count + i] = 1e30f;
+		}
+		for (i = 0; i < BROADPHASE_THREADS; i++) {
+			lists[i].count = 0;
+			lists[i].failed = false;
+		}
+		run(jobs, broadphaseSweepJob, count, BROADPHASE_GRAIN);
+		pairCount = 0;
+		for (i = 0; i < BROADPHASE_THREADS; i++) {
+			pairCount += lists[i].count;
+			if (lists[i].failed)
+				warn("broadphase: out of memory for the pairs, some were lost");
+		}
+		updates++;
+	}
+
+	void run(JobSystem *jobs, JobFunc f, int n, int grain)
+	{
+		if (jobs)
+			jobs->run(f, this, n, grain);
+		else if (n > 0)
+			f(this, 0, n);
+	}
+
+	/* the order sorted from scratch along the axis of the largest
+	* variance, by the keys of the objects */
+	void fullSort()
+	{
+		const float *axes[3] = { x, y, z };
+		double sum[3] = { 0.0, 0.0, 0.0 }, squares[3] = { 0.0, 0.0, 0.0 }, best = -1.0;
+		int i, a;
+		for (i = 0; i < count; i++) {
+			for (a = 0; a < 3; a++) {
+				sum[a] += axes[a][i];
+				squares[a] += (double)axes[a][i] * axes[a][i];
+			}
+		}
+		for (a = 0; a < 3; a++) {
+			double variance = squares[a] - sum[a] * sum[a] / count;
+			if (variance > best) {
+				best = variance;
+				axis = axes[a];
+			}
+		}
+		const float *pa = axis, *pr = radius;
+		for (i = 0; i < count; i++)
+			order[i] = i;
+		std::sort(order, order + count, [pa, pr](int l, int r) {
+			return pa[l] - pr[l] < pa[r] - pr[r];
+		});
+		for (i = 0; i < count; i++)
+			low[i] = axis[order[i]] - radius[order[i]];
+		sorted = true;
+	}
+
+	/* the keys of the objects where they are now, in the last order */
+	void keysRange(int begin, int end)
+	{
+		int k;
+		for (k = begin; k < end; k++)
+			low[k] = axis[order[k]] - radius[order[k]];
+	}
+
+	/* the order fixed up for objects which moved past others: each moves
+	* down until the one before does not start after it, a swap per
+	* object it passed, few if the motion is coherent */
+	void insertionSort()
+	{
+		int i, j;
+		for (i = 1; i < count; i++) {
+			float key = low[i];
+			int object = order[i];
+			for (j = i; j > 0 && low[j - 1] > key; j--) {
+				low[j] = low[j - 1];
+				order[j] = order[j - 1];
+			}
+			low[j] = key;
+			order[j] = object;
+			swaps += (unsigned long long)(i - j);
+		}
+	}
+
+	/* The pairs of the sorted objects in [begin, end) with those after
+	* them, into the list of the calling thread. */
+	void sweepRange(int begin, int end)
+	{
+		typedef glm::wide::scalar<float, BROADPHASE_LANES> Lanes;
+		BroadphaseList *list = &lists[jobWorkerIndex() + 1];
+		int k, m, i;
+		for (k = begin; k < end; k++) {
+			int a = order[k];
+			float r = radius[a];
+			Lanes high(axis[a] + r), ax(x[a]), ay(y[a]), az(z[a]), ar(r);
+			for (m = k + 1; m < count; m += BROADPHASE_LANES) {
+				Lanes start, bx, by, bz, br;
+				for (i = 0; i < BROADPHASE_LANES; i++) {
+					int b = order[m + i];
+					start[i] = low[m + i];
+					bx[i] = x[b];
+					by[i] = y[b];
+					bz[i] = z[b];
+					br[i] = radius[b];
+				}
+				Lanes dx = bx - ax, dy = by - ay, dz = bz - az, s = br + ar;
+				/* the lanes which start beyond the high end, the
+				* run ends with the first */
+				unsigned int beyond = glm::wide::lessThan(high, start);
+				unsigned int apart = glm::wide::lessThan(s * s, dx * dx + dy * dy + dz * dz);
+				unsigned int hits = ~(beyond | apart) & ((1u << BROADPHASE_LANES) - 1);
+				for (i = 0; hits; i++, hits >>= 1)
+					if (hits & 1)
+						list->add(a, order[m + i]);
+				if (beyond)
+					break;
+			}
+		}
+	}
+
+	/* Call f for each pair the last update() found. */
+	void forEach(BroadphasePairFunc f, void *user) const
+	{
+		int i, j;
+		for (i = 0; i < BROADPHASE_THREADS; i++)
+			for (j = 0; j < lists[i].count; j++)
+				f(user, lists[i].pairs[j].a, lists[i].pairs[j].b);
+	}
+} Broadphase;
+
+/* the passes of Broadphase::update, as jobs */
+static void broadphaseKeysJob(void *user, int begin, int end)
+{
+	((Broadphase*)user)->keysRange(begin, end);
+}
+
+static void broadphaseSweepJob(void *user, int begin, int end)
+{
+	((Broadphase*)user)->sweepRange(begin, end);
+}
+
+#endif
@@ -0,0 +1,536 @@
+#ifndef HEADER_BUFFERPOOL_H
+#define HEADER_BUFFERPOOL_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* GPU MEMORY                                                               *
+****************************************************************************/
+
+/* What the driver reports about the video memory, in bytes. Only NVIDIA
+* (GL_NVX_gpu_memory_info) and AMD (GL_ATI_meminfo) tell; AMD only reports
+* what is free, so total is 0 there. */
+typedef struct {
+	GLint64 total;		/* dedicated video memory, 0 if unknown */
+	GLint64 available;	/* what is free right now */
+} GpuMemoryInfo;
+
+/* Query the video memory into m.
+* Returns true if successfull and false if the driver does not tell. */
+static bool gpuMemoryQuery(GpuMemoryInfo *m)
+{
+	GLint kb[4] = { 0, 0, 0, 0 };
+
+	m->total = m->available = 0;
+	if (GLAD_GL_NVX_gpu_memory_info) {
+		glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &kb[0]);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &kb[1]);
+		m->total = (GLint64)kb[0] << 10;
+		m->available = (GLint64)kb[1] << 10;
+		return true;
+	}
+	if (GLAD_GL_ATI_meminfo) {
+		/* the total free memory of the pool of buffer objects first */
+		glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, kb);
+		m->available = (GLint64)kb[0] << 10;
+		return true;
+	}
+	return false;
+}
+
+/****************************************************************************
+* BUFFER POOL                                                              *
+****************************************************************************/
+
+/* BufferPool: carves ranges for meshes out of a few big buffer objects,
+* the blocks, instead of one buffer object per vertex or index buffer.
+* Thousands of small buffers fragment the memory of the driver, and draws
+* from different buffers cannot be batched into one multi-draw. Each block
+* has immutable storage where GL_ARB_buffer_storage is available, it is
+* only written with glBufferSubData and glCopyBufferSubData.
+* Within a block, a buddy allocator hands out power of two ranges of at
+* least BUFFER_POOL_MIN_SIZE, aligned to their size, which is enough for
+* any index type and for binding them as uniform or storage buffers. The
+* free ranges are kept in a binary tree over the block, each node holding
+* the order of the largest free range below it plus one, so allocating and
+* freeing are a walk from the root to a leaf and back. Ranges bigger than a
+* block get a dedicated block of their own.
+* An allocation is a handle, its buffer and offset are looked up whenever
+* they are needed, as defragment() may move it: it empties the blocks which
+* are used least by moving their ranges into the others on the GPU, then
+* deletes them, and bumps generation, so the owners can rebind.
+* The pool keeps to a budget: up to the limit given to init(), or a share of
+* the video memory still available if the driver tells (see gpuMemoryQuery),
+* and never more than BUFFER_POOL_BLOCKS_MAX blocks. When a new block would
+* exceed it, the least recently used (see touch()) evictable allocations
+* are evicted; their handles stay valid but are no longer resident, so the
+* owner knows to load them again. */
+#define BUFFER_POOL_BLOCK_SIZE (16 << 20)	/* a power of two */
+#define BUFFER_POOL_MIN_SIZE 256	/* the smallest range and alignment, a power of two */
+#define BUFFER_POOL_BLOCKS_MAX 16
+#define BUFFER_POOL_BUDGET_SHARE 0.5f	/* of the available video memory */
+#define BUFFER_POOL_DEFRAG_USAGE 0.25f	/* empty blocks used less than this */
+
+/* states of a BufferPoolAlloc */
+enum {
+	BUFFER_POOL_FREE = 0,	/* the handle is unused */
+	BUFFER_POOL_RESIDENT,
+	BUFFER_POOL_EVICTED	/* allocated, but its range was taken back */
+};
+
+typedef struct {
+	GLuint buffer;		/* 0 if the block is not in use */
+	GLsizeiptr size;
+	GLsizeiptr used;	/* bytes in allocated ranges */
+	int levels;		/* log2 of the size in BUFFER_POOL_MIN_SIZE units */
+	unsigned char *tree;	/* the buddy tree, NULL for a dedicated block */
+} BufferPoolBlock;
+
+typedef struct {
+	int block;
+	GLintptr offset;
+	GLsizeiptr size;	/* as requested */
+	int order;		/* the range is BUFFER_POOL_MIN_SIZE << order bytes */
+	unsigned int lastUse;	/* frame of the last touch() */
+	unsigned char state;	/* BUFFER_POOL_* */
+	bool evictable;
+} BufferPoolAlloc;
+
+typedef struct {
+	BufferPoolBlock blocks[BUFFER_POOL_BLOCKS_MAX];
+	BufferPoolAlloc *allocs;	/* indexed by handle - 1 */
+	int allocCapacity;
+	GLsizeiptr blockSize;
+	GLsizeiptr budget;	/* for the sum of the block sizes */
+	GLsizeiptr reserved;	/* the sum of the block sizes */
+	GLsizeiptr used;	/* bytes in allocated ranges */
+	unsigned int frame;
+	unsigned int generation;	/* bumped whenever ranges move */
+	bool immutable;		/* blocks have immutable storage */
+
+	void clear()
+	{
+		memset(blocks, 0, sizeof(blocks));
+		allocs = NULL;
+		allocCapacity = 0;
+		blockSize = budget = reserved = used = 0;
+		frame = generation = 0;
+		immutable = false;
+	}
+
+	/* Set up the pool with blocks of size bytes (a power of two, at least
+	* BUFFER_POOL_MIN_SIZE) and a budget of limit bytes, 0 for a share of
+	* the video memory. The blocks are created when they are needed. */
+	void init(GLsizeiptr size, GLsizeiptr limit)
+	{
+		GpuMemoryInfo m;
+
+		clear();
+		blockSize = size;
+		immutable = glCaps()->bufferStorage;
+		budget = (GLsizeiptr)BUFFER_POOL_BLOCKS_MAX * blockSize;
+		if (gpuMemoryQuery(&m)) {
+			info("pool: %u of %u MiB video memory available", (unsigned)(m.available >> 20),
+				(unsigned)(m.total >> 20));
+			if (!limit)
+				limit = (GLsizeiptr)((double)m.available * BUFFER_POOL_BUDGET_SHARE);
+		}
+		/* from a budget of at least one block up to all of them */
+		if (limit && limit < budget)
+			budget = (limit > blockSize) ? limit : blockSize;
+		info("pool: blocks of %u KiB, budget %u MiB", (unsigned)(blockSize >> 10), (unsigned)(budget >> 20));
+	}
+
+	void destroy()
+	{
+		int i;
+
+		for (i = 0; i < BUFFER_POOL_BLOCKS_MAX; i++)
+			blockDestroy(i);
+		free(allocs);
+		clear();
+	}
+
+	/* The size of the ranges of order. */
+	static GLsizeiptr orderSize(int order)
+	{
+		return (GLsizeiptr)BUFFER_POOL_MIN_SIZE << order;
+	}
+
+	/* The smallest order whose ranges hold size bytes. */
+	static int sizeOrder(GLsizeiptr size)
+	{
+		int order = 0;
+
+		while (orderSize(order) < size)
+			order++;
+		return order;
+	}
+
+	/* Create a block of size bytes, dedicated to a single range if it is
+	* not blockSize. Returns its index, -1 if it would exceed the budget or
+	* in case of an error. */
+	int blockCreate(GLsizeiptr size)
+	{
+		int i, n;
+		BufferPoolBlock *b = NULL;
+		MemoryScope scope(MEMORY_MESHES);
+
+		if (reserved + size > budget)
+			return -1;
+		for (i = 0; i < BUFFER_POOL_BLOCKS_MAX && !b; i++) {
+			if (!blocks[i].buffer)
+				b = &blocks[i];
+		}
+		if (!b)
+			return -1;
+		memset(b, 0, sizeof(*b));
+		if (size == blockSize) {
+			b->levels = sizeOrder(size);
+			b->tree = (unsigned char*)malloc(((size_t)2 << b->levels) - 1);
+			if (!b->tree) {
+				warn("pool: failed to allocate the tree of a block");
+				return -1;
+			}
+			/* all free: every node holds its own order plus one */
+			for (n = 0; n < (2 << b->levels) - 1; n++)
+				b->tree[n] = (unsigned char)(b->levels - treeDepth(n) + 1);
+		}
+		glGenBuffers(1, &b->buffer);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, b->buffer);
+		if (immutable)
+			glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, GL_DYNAMIC_STORAGE_BIT);
+		else
+			glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STATIC_DRAW);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		if (glGetError() == GL_OUT_OF_MEMORY) {
+			warn("pool: out of memory for a block of %u KiB", (unsigned)(size >> 10));
+			memoryStats()->report();
+			glState()->deleteBuffers(1, &b->buffer);
+			free(b->tree);
+			memset(b, 0, sizeof(*b));
+			return -1;
+		}
+		b->size = size;
+		reserved += size;
+		info("pool: created block %u of %u KiB, %u of %u MiB reserved", b->buffer, (unsigned)(size >> 10),
+			(unsigned)(reserved >> 20), (unsigned)(budget >> 20));
+		return (int)(b - blocks);
+	}
+
+	void blockDestroy(int i)
+	{
+		BufferPoolBlock *b = &blocks[i];
+
+		if (!b->buffer)
+			return;
+		glState()->deleteBuffers(1, &b->buffer);
+		free(b->tree);
+		reserved -= b->size;
+		memset(b, 0, sizeof(*b));
+	}
+
+	/* The depth of node n of a buddy tree, the root is 0. */
+	static int treeDepth(int n)
+	{
+		int d = 0;
+
+		while (n > 0) {
+			n = (n - 1) / 2;
+			d++;
+		}
+		return d;
+	}
+
+	/* Recompute node n of which both children have the given order. */
+	static void treeUpdate(unsigned char *tree, int n, int childOrder)
+	{
+		unsigned char l = tree[2 * n + 1], r = tree[2 * n + 2];
+
+		/* two free buddies merge into one range of the order above */
+		if (l == childOrder + 1 && r == childOrder + 1)
+			tree[n] = (unsigned char)(childOrder + 2);
+		else
+			tree[n] = (l > r) ? l : r;
+	}
+
+	/* Take a range of order from block b.
+	* Returns its offset, -1 if there is none. */
+	GLintptr blockAlloc(BufferPoolBlock *b, int order)
+	{
+		int n = 0, o;
+
+		if (!b->tree) {
+			/* a dedicated block is its single range */
+			if (b->used)
+				return -1;
+			b->used = b->size;
+			return 0;
+		}
+		if (order > b->levels || b->tree[0] < order + 1)
+			return -1;
+		for (o = b->levels; o > order; o--)
+			n = (b->tree[2 * n + 1] >= order + 1) ? 2 * n + 1 : 2 * n + 2;
+		b->tree[n] = 0;
+		GLintptr offset = (GLintptr)(n + 1 - (1 << (b->levels - order))) * orderSize(order);
+		for (o = order; n > 0; o++) {
+			n = (n - 1) / 2;
+			treeUpdate(b->tree, n, o);
+		}
+		b->used += orderSize(order);
+		return offset;
+	}
+
+	/* Give the range of order at offset back to block b. */
+	void blockFree(BufferPoolBlock *b, GLintptr offset, int order)
+	{
+		int o, n;
+
+		if (!b->tree) {
+			b->used = 0;
+			return;
+		}
+		n = (1 << (b->levels - order)) - 1 + (int)(offset / orderSize(order));
+		b->tree[n] = (unsigned char)(order + 1);
+		for (o = order; n > 0; o++) {
+			n = (n - 1) / 2;
+			treeUpdate(b->tree, n, o);
+		}
+		b->used -= orderSize(order);
+	}
+
+	/* Place a of a->order in any block but skip, creating one if needed.
+	* Returns true if successfull and false if there is no room. */
+	bool place(BufferPoolAlloc *a, int skip, bool create)
+	{
+		int i;
+		GLintptr offset;
+		GLsizeiptr size = orderSize(a->order);
+
+		if (size > blockSize) {
+			i = create ? blockCreate(size) : -1;
+			if (i < 0)
+				return false;
+			a->block = i;
+			a->offset = blockAlloc(&blocks[i], a->order);
+			return true;
+		}
+		for (i = 0; i < BUFFER_POOL_BLOCKS_MAX; i++) {
+			if (i == skip || !blocks[i].buffer)
+				continue;
+			if ((offset = blockAlloc(&blocks[i], a->order)) >= 0) {
+				a->block = i;
+				a->offset = offset;
+				return true;
+			}
+		}
+		if (!create || (i = blockCreate(blockSize)) < 0)
+			return false;
+		a->block = i;
+		a->offset = blockAlloc(&blocks[i], a->order);
+		return true;
+	}
+
+	/* Give the range of a back, its handle stays allocated. */
+	void unplace(BufferPoolAlloc *a)
+	{
+		blockFree(&blocks[a->block], a->offset, a->order);
+		used -= orderSize(a->order);
+		if (!blocks[a->block].used && (blocks[a->block].size != blockSize || reserved > blockSize))
+			blockDestroy(a->block);
+		a->block = -1;
+		a->offset = 0;
+	}
+
+	/* Allocate size bytes, which evict() may take back if evictable.
+	* Returns the handle, 0 in case of an error. */
+	int alloc(GLsizeiptr size, bool evictable)
+	{
+		int h;
+		BufferPoolAlloc a;
+
+		if (size < 1 || !blockSize)
+			return 0;
+		memset(&a, 0, sizeof(a));
+		a.size = size;
+		a.order = sizeOrder(size);
+		a.lastUse = frame;
+		a.state = BUFFER_POOL_RESIDENT;
+		a.evictable = evictable;
+		if (!place(&a, -1, true)) {
+			/* over the budget: make room and try again */
+			evict(orderSize(a.order));
+			if (!place(&a, -1, true)) {
+				warn("pool: no room for %u KiB within the budget of %u MiB", (unsigned)(size >> 10),
+					(unsigned)(budget >> 20));
+				return 0;
+			}
+		}
+		used += orderSize(a.order);
+		for (h = 0; h < allocCapacity && allocs[h].state != BUFFER_POOL_FREE; h++)
+			;
+		if (h == allocCapacity) {
+			int capacity = allocCapacity ? 2 * allocCapacity : 64;
+			frameHeapAlloc("the buffer pool handles", sizeof(BufferPoolAlloc) * capacity);
+			BufferPoolAlloc *p = (BufferPoolAlloc*)realloc(allocs, sizeof(BufferPoolAlloc) * capacity);
+			if (!p) {
+				warn("pool: failed to allocate %d handles", capacity);
+				unplace(&a);
+				return 0;
+			}
+			memset(p + allocCapacity, 0, sizeof(BufferPoolAlloc) * (capacity - allocCapacity));
+			allocs = p;
+			allocCapacity = capacity;
+		}
+		allocs[h] = a;
+		return h + 1;
+	}
+
+	void release(int handle)
+	{
+		BufferPoolAlloc *a = get(handle);
+
+		if (!a)
+			return;
+		if (a->state == BUFFER_POOL_RESIDENT)
+			unplace(a);
+		a->state = BUFFER_POOL_FREE;
+	}
+
+	BufferPoolAlloc *get(int handle)
+	{
+		if (handle < 1 || handle > allocCapacity || allocs[handle - 1].state == BUFFER_POOL_FREE)
+			return NULL;
+		return &allocs[handle - 1];
+	}
+
+	bool resident(int handle)
+	{
+		BufferPoolAlloc *a = get(handle);
+		return a && a->state == BUFFER_POOL_RESIDENT;
+	}
+
+	/* The buffer and the offset in it of a resident allocation. */
+	GLuint buffer(int handle)
+	{
+		return resident(handle) ? blocks[allocs[handle - 1].block].buffer : 0;
+	}
+
+	GLintptr offset(int handle)
+	{
+		return resident(handle) ? allocs[handle - 1].offset : 0;
+	}
+
+	/* Write size bytes of data at offset within the allocation. */
+	void upload(int handle, GLintptr offset, GLsizeiptr size, const void *data)
+	{
+		if (!resident(handle))
+			return;
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, buffer(handle));
+		glBufferSubData(GL_COPY_WRITE_BUFFER, this->offset(handle) + offset, size, data);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	/* Copy size bytes at srcOffset in the buffer src into the allocation,
+	* on the GPU. */
+	void copy(int handle, GLuint src, GLintptr srcOffset, GLsizeiptr size)
+	{
+		if (!resident(handle))
+			return;
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, src);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, buffer(handle));
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, srcOffset, offset(handle), size);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+
+	/* Mark the allocation as used in this frame. */
+	void touch(int handle)
+	{
+		BufferPoolAlloc *a = get(handle);
+		if (a)
+			a->lastUse = frame;
+	}
+
+	void endFrame()
+	{
+		frame++;
+	}
+
+	/* Evict the least recently used evictable allocations which were not
+	* used in this frame, until size bytes are free.
+	* Returns the bytes freed. */
+	GLsizeiptr evict(GLsizeiptr size)
+	{
+		GLsizeiptr freed = 0;
+		int i;
+
+		while (freed < size) {
+			BufferPoolAlloc *lru = NULL;
+			for (i = 0; i < allocCapacity; i++) {
+				BufferPoolAlloc *a = &allocs[i];
+				if (a->state == BUFFER_POOL_RESIDENT && a->evictable && a->lastUse != frame &&
+					(!lru || frame - a->lastUse > frame - lru->lastUse))
+					lru = a;
+			}
+			if (!lru)
+				break;
+			freed += orderSize(lru->order);
+			unplace(lru);
+			lru->state = BUFFER_POOL_EVICTED;
+		}
+		if (freed)
+			info("pool: evicted %u KiB", (unsigned)(freed >> 10));
+		return freed;
+	}
+
+	/* Empty the shared block used least, if it is used less than
+	* BUFFER_POOL_DEFRAG_USAGE, by moving its ranges into the other blocks.
+	* This never creates blocks.
+	* Returns the number of allocations moved. */
+	int defragment()
+	{
+		int i, victim = -1, moved = 0, blockCount = 0;
+
+		for (i = 0; i < BUFFER_POOL_BLOCKS_MAX; i++) {
+			const BufferPoolBlock *b = &blocks[i];
+			if (!b->buffer || !b->tree)
+				continue;
+			blockCount++;
+			if ((float)b->used < BUFFER_POOL_DEFRAG_USAGE * (float)b->size &&
+				(victim < 0 || b->used < blocks[victim].used))
+				victim = i;
+		}
+		if (victim < 0 || blockCount < 2)
+			return 0;
+		GLuint src = blocks[victim].buffer;
+		for (i = 0; i < allocCapacity; i++) {
+			BufferPoolAlloc *a = &allocs[i];
+			if (a->state != BUFFER_POOL_RESIDENT || a->block != victim)
+				continue;
+			BufferPoolAlloc to = *a;
+			if (!place(&to, victim, false))
+				continue;
+			GLintptr from = a->offset;
+			blockFree(&blocks[victim], a->offset, a->order);
+			a->block = to.block;
+			a->offset = to.offset;
+			copy(i + 1, src, from, a->size);
+			moved++;
+		}
+		if (!blocks[victim].used)
+			blockDestroy(victim);
+		if (moved) {
+			generation++;
+			info("pool: moved %d allocations, %u of %u KiB used", moved, (unsigned)(used >> 10),
+				(unsigned)(reserved >> 10));
+		}
+		return moved;
+	}
+} BufferPool;
+
+#endif
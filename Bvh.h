@@ -0,0 +1,808 @@
+#ifndef HEADER_BVH_H
+#define HEADER_BVH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtx/wide_intersect.hpp>
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include "JobSystem.h"
+#include "Log.h"
+
+/****************************************************************************
+* BVH: a dynamic tree of axis aligned bounding boxes                       *
+****************************************************************************/
+
+/* BvhTree: a binary tree of boxes over objects, which are indices the
+* caller picks, for the queries which would otherwise test every object:
+* the rays of picking, the boxes and frustums of culling.
+* A node is 32 bytes: its box, its parent, and either its first child or,
+* in a leaf, the object. The two children of a node are allocated as a
+* pair, so the second is always child + 1 and the sibling of node n is
+* n + 1 or n - 1: pairs start at odd indices, and 0 is the root.
+* insert() walks down from the root to the node which the new leaf adds
+* the least surface area to, counting what it adds to the ancestors too
+* (the surface area heuristic, as in Box2D's dynamic tree), and pairs the
+* leaf with it. The leaves hold their box enlarged by margin, so an object
+* which moves a little does not touch the tree at all. One which moves
+* out of its box is refit: its leaf gets the new box and the ancestors are
+* recomputed up to the first which does not change. On the way up, each
+* node may swap a child with a grandchild if that makes the other child
+* smaller (the tree rotations of Kopta et al., "Fast, Effective BVH
+* Updates for Animated Scenes"), which keeps refitting from degrading the
+* tree as fast as it would otherwise.
+* It still degrades. maintain() compares the cost of the subtrees at
+* BVH_REBUILD_DEPTH (the surface areas of their inner nodes relative to
+* that of their root) with the cost they had when they were last built,
+* and rebuilds those which got BVH_DEGRADE times worse from scratch with a
+* binned SAH build, each on a worker of the job system, in the nodes they
+* already occupy. No queries may run meanwhile.
+* raycast() tests the children of BVH_RAY_LANES / 2 nodes at a time with
+* the ray against N boxes kernel of glm/gtx/wide_intersect.hpp, nearest
+* first. */
+#define BVH_REBUILD_DEPTH 4	/* up to 16 subtrees */
+#define BVH_DEGRADE 1.3f
+#define BVH_BINS 16		/* of the SAH build */
+#define BVH_STACK 1024		/* nodes pending in a query */
+#if GLM_ARCH & GLM_ARCH_AVX
+#define BVH_RAY_LANES 8
+#else
+#define BVH_RAY_LANES 4
+#endif
+
+typedef struct {
+	glm::vec3 min;
+	int parent;		/* -1 for the root */
+	glm::vec3 max;
+	int child;		/* first child, or ~object in a leaf */
+} BvhNode;
+
+/* Test the object against the ray of raycast(). Returns true if it is hit
+* closer than *dist, and sets *dist to where. */
+typedef bool (*BvhRayFunc)(void *user, int object, float *dist);
+
+/* Called for each object a query finds. */
+typedef void (*BvhQueryFunc)(void *user, int object);
+
+/* an object of a build, with its box */
+typedef struct {
+	glm::vec3 min, max;
+	int object;
+} BvhItem;
+
+/* a range of items which becomes the subtree at slot */
+typedef struct {
+	int slot, parent, begin, end;
+} BvhBuildTask;
+
+struct BvhTree;
+
+/* a subtree maintain() rebuilds on a job */
+typedef struct {
+	struct BvhTree *tree;
+	int slot, path;
+} BvhRebuild;
+
+typedef struct BvhTree {
+	BvhNode *nodes;		/* 2 * maxObjects */
+	int nodeCount;		/* used so far, the free pairs included */
+	int freePair;		/* first node of a free pair, linked by parent, or -1 */
+	int *objectNode;	/* leaf of each object, -1 if not inserted */
+	int maxObjects, count;
+	float margin;		/* the leaves are this much larger than their objects */
+
+	/* the cost of each subtree of maintain() after it was last built, by
+	* its path from the root, bit d for the child taken at depth d */
+	float builtCost[1 << BVH_REBUILD_DEPTH];
+	BvhRebuild rebuilds[1 << BVH_REBUILD_DEPTH];
+
+	void clear()
+	{
+		nodes = NULL;
+		objectNode = NULL;
+		nodeCount = 0;
+		freePair = -1;
+		maxObjects = count = 0;
+		margin = 0.0f;
+	}
+
+	/* Allocate room for the objects [0, objects).
+	* Returns true if successfull and false if out of memory. */
+	bool init(int objects, float leafMargin = 0.0f)
+	{
+		int i;
+		clear();
+		maxObjects = objects;
+		margin = leafMargin;
+		nodes = (BvhNode*)malloc(sizeof(BvhNode) * 2 * (objects ? objects : 1));
+		objectNode = (int*)malloc(sizeof(int) * (objects ? objects : 1));
+		if (!nodes || !objectNode) {
+			warn("BvhTree: failed to allocate %d objects", objects);
+			destroy();
+			return false;
+		}
+		for (i = 0; i < objects; i++)
+			objectNode[i] = -1;
+		nodeCount = 1;
+		for (i = 0; i < (1 << BVH_REBUILD_DEPTH); i++)
+			builtCost[i] = FLT_MAX;
+		return true;
+	}
+
+	void destroy()
+	{
+		free(nodes);
+		free(objectNode);
+		clear();
+	}
+
+	/* Replace the tree by one over the objects [0, n) with the boxes
+	* mins[i] to maxs[i], built top-down with the SAH.
+	* Returns true if successfull and false if out of memory. */
+	bool build(const glm::vec3 *mins, const glm::vec3 *maxs, int n)
+	{
+		int i;
+		BvhItem *items = (BvhItem*)malloc(sizeof(BvhItem) * (n ? n : 1));
+		int *pairs = (int*)malloc(sizeof(int) * (n ? n : 1));
+		if (!items || !pairs || n > maxObjects) {
+			warn("BvhTree: failed to build over %d objects", n);
+			free(items);
+			free(pairs);
+			return false;
+		}
+		for (i = 0; i < maxObjects; i++)
+			objectNode[i] = -1;
+		for (i = 0; i < n; i++) {
+			items[i].min = mins[i] - margin;
+			items[i].max = maxs[i] + margin;
+			items[i].object = i;
+		}
+		for (i = 0; i + 1 < n; i++)
+			pairs[i] = 1 + 2 * i;
+		nodeCount = 1 + 2 * (n > 0 ? n - 1 : 0);
+		freePair = -1;
+		count = n;
+		bool ok = n == 0 || buildRange(0, -1, items, n, pairs);
+		free(items);
+		free(pairs);
+		for (i = 0; i < (1 << BVH_REBUILD_DEPTH); i++)
+			builtCost[i] = FLT_MAX;
+		recordCosts();
+		return ok;
+	}
+
+	/* Replace the tree by the n nodes of one built before over the
+	* objects [0, objects), e.g. read back from a file: the nodes only
+	* refer to each other by index, so they are copied as they are.
+	* Returns false if they do not form such a tree. */
+	bool load(const BvhNode *src, int n, int objects)
+	{
+		int i, leaves = 0;
+		if (objects > maxObjects || n != 1 + 2 * (objects > 0 ? objects - 1 : 0)) {
+			warn("BvhTree: %d nodes are no tree over %d objects", n, objects);
+			return false;
+		}
+		for (i = 0; i < maxObjects; i++)
+			objectNode[i] = -1;
+		for (i = 0; i < n && objects > 0; i++) {
+			int c = src[i].child;
+			if (c < 0 ? ~c >= objects || objectNode[~c] >= 0 : !(c & 1) || c + 1 >= n) {
+				warn("BvhTree: node %d of the tree is invalid", i);
+				return false;
+			}
+			if (c < 0) {
+				objectNode[~c] = i;
+				leaves++;
+			}
+		}
+		if (leaves != objects) {
+			warn("BvhTree: the tree has %d of %d objects", leaves, objects);
+			return false;
+		}
+		for (i = 0; i < n; i++)
+			nodes[i] = src[i];
+		nodeCount = n;
+		freePair = -1;
+		count = objects;
+		for (i = 0; i < (1 << BVH_REBUILD_DEPTH); i++)
+			builtCost[i] = FLT_MAX;
+		recordCosts();
+		return true;
+	}
+
+	/* Add object with the box from bmin to bmax. */
+	void insert(int object, const glm::vec3 &bmin, const glm::vec3 &bmax)
+	{
+		glm::vec3 lo = bmin - margin, hi = bmax + margin;
+		if (count++ == 0) {
+			setLeaf(0, -1, object, lo, hi);
+			return;
+		}
+
+		/* the sibling moves down into the first node of a new pair, the
+		* leaf into the second, and its node becomes their parent */
+		int s = findSibling(lo, hi);
+		int p = allocatePair();
+		int up = nodes[s].parent;
+		nodes[p] = nodes[s];
+		nodes[p].parent = s;
+		adopt(p);
+		setLeaf(p + 1, s, object, lo, hi);
+		nodes[s].child = p;
+		nodes[s].parent = up;
+		nodes[s].min = glm::min(nodes[p].min, lo);
+		nodes[s].max = glm::max(nodes[p].max, hi);
+		refit(up);
+	}
+
+	/* Remove object, its sibling takes the place of their parent. */
+	void remove(int object)
+	{
+		int n = objectNode[object];
+		if (n < 0)
+			return;
+		objectNode[object] = -1;
+		if (--count == 0)
+			return;
+		int p = nodes[n].parent;
+		int sibling = (n & 1) ? n + 1 : n - 1;
+		int up = nodes[p].parent;
+		nodes[p] = nodes[sibling];
+		nodes[p].parent = up;
+		adopt(p);
+		freePairAt((n & 1) ? n : sibling);
+		refit(up);
+	}
+
+	/* Object now has the box from bmin to bmax. Returns true if that
+	* changed the tree, false if it is still inside its leaf. */
+	bool update(int object, const glm::vec3 &bmin, const glm::vec3 &bmax)
+	{
+		int n = objectNode[object];
+		if (n < 0)
+			return false;
+		BvhNode *leaf = &nodes[n];
+		if (glm::all(glm::greaterThanEqual(bmin, leaf->min)) && glm::all(glm::lessThanEqual(bmax, leaf->max)))
+			return false;
+		leaf->min = bmin - margin;
+		leaf->max = bmax + margin;
+		refit(leaf->parent);
+		return true;
+	}
+
+	/* Rebuild the subtrees which degraded since they were built, on jobs
+	* if it is given. Returns the number rebuilt. */
+	int maintain(JobSystem *jobs = NULL)
+	{
+		int slots[1 << BVH_REBUILD_DEPTH], paths[1 << BVH_REBUILD_DEPTH];
+		int i, n = 0, found = subtrees(slots, paths);
+
+		for (i = 0; i < found; i++) {
+			if (cost(slots[i]) <= BVH_DEGRADE * builtCost[paths[i]])
+				continue;
+			rebuilds[n].tree = this;
+			rebuilds[n].slot = slots[i];
+			rebuilds[n].path = paths[i];
+			n++;
+		}
+		if (jobs)
+			jobs->run(rebuildJob, rebuilds, n, 1);
+		else
+			rebuildJob(rebuilds, 0, n);
+		/* a rebuilt subtree may be smaller than the old one */
+		for (i = 0; i < n; i++)
+			refit(nodes[rebuilds[i].slot].parent);
+		return n;
+	}
+
+	/* The nearest object the ray from orig along dir hits before maxDist,
+	* as hit tells, or if that is NULL, the nearest leaf box. Sets *dist to
+	* where. Returns the object or -1 if there is none. */
+	int raycast(const glm::vec3 &orig, const glm::vec3 &dir, float maxDist, BvhRayFunc hit, void *user,
+		float *dist) const
+	{
+		typedef glm::wide::vec3<float, BVH_RAY_LANES> Boxes;
+		typedef glm::wide::scalar<float, BVH_RAY_LANES> Distances;
+		struct {
+			int node;
+			float dist;
+		} stack[BVH_STACK], found[BVH_RAY_LANES];
+		int i, j, sp = 0, best = -1;
+		float bestDist = maxDist;
+		glm::vec3 invDir = 1.0f / dir;
+
+		if (!count)
+			return -1;
+		stack[sp].node = 0;
+		stack[sp++].dist = 0.0f;
+		while (sp > 0) {
+			/* the children of up to half the lanes of nodes */
+			int inner[BVH_RAY_LANES / 2], n = 0;
+			while (sp > 0 && n < BVH_RAY_LANES / 2) {
+				sp--;
+				if (stack[sp].dist >= bestDist)
+					continue;
+				const BvhNode *node = &nodes[stack[sp].node];
+				if (node->child >= 0) {
+					inner[n++] = stack[sp].node;
+					continue;
+				}
+				float d = hit ? bestDist : stack[sp].dist;
+				if (!hit || hit(user, ~node->child, &d)) {
+					best = ~node->child;
+					bestDist = d;
+				}
+			}
+			if (!n)
+				continue;
+
+			Boxes lo, hi;
+			Distances entry;
+			for (i = 0; i < BVH_RAY_LANES; i++) {
+				const BvhNode *c = &nodes[nodes[inner[(i / 2 < n) ? i / 2 : 0]].child + (i & 1)];
+				lo.x[i] = c->min.x; lo.y[i] = c->min.y; lo.z[i] = c->min.z;
+				hi.x[i] = c->max.x; hi.y[i] = c->max.y; hi.z[i] = c->max.z;
+			}
+			unsigned int mask = glm::wide::intersectRayBox(orig, invDir, lo, hi, entry) & ((1u << (2 * n)) - 1);
+
+			/* pushed farthest first, so the nearest are taken first */
+			int hits = 0;
+			for (i = 0; i < 2 * n; i++) {
+				if (!(mask & (1u << i)) || entry[i] >= bestDist)
+					continue;
+				for (j = hits++; j > 0 && found[j - 1].dist < entry[i]; j--)
+					found[j] = found[j - 1];
+				found[j].node = nodes[inner[i / 2]].child + (i & 1);
+				found[j].dist = entry[i];
+			}
+			if (sp + hits > BVH_STACK) {
+				warn("BvhTree: the query is too deep");
+				break;
+			}
+			for (i = 0; i < hits; i++)
+				stack[sp++] = found[i];
+		}
+		if (dist && best >= 0)
+			*dist = bestDist;
+		return best;
+	}
+
+	/* Call f for every object whose leaf box overlaps the box from bmin to
+	* bmax. */
+	void overlap(const glm::vec3 &bmin, const glm::vec3 &bmax, BvhQueryFunc f, void *user) const
+	{
+		int stack[BVH_STACK], sp = 0;
+
+		if (!count)
+			return;
+		stack[sp++] = 0;
+		while (sp > 0) {
+			const BvhNode *node = &nodes[stack[--sp]];
+			if (glm::any(glm::lessThan(node->max, bmin)) || glm::any(glm::greaterThan(node->min, bmax)))
+				continue;
+			if (node->child < 0) {
+				f(user, ~node->child);
+			} else if (sp + 2 <= BVH_STACK) {
+				stack[sp++] = node->child;
+				stack[sp++] = node->child + 1;
+			}
+		}
+	}
+
+	/* Call f for every object whose leaf box is not entirely outside one of
+	* the six planes (see frustumPlanes in FrustumCuller.h). Subtrees
+	* entirely inside all of them are taken without any more tests. */
+	void frustum(const glm::vec4 planes[6], BvhQueryFunc f, void *user) const
+	{
+		int stack[BVH_STACK], sp = 0, i;
+
+		if (!count)
+			return;
+		stack[sp++] = 0;
+		while (sp > 0) {
+			int n = stack[--sp];
+			const BvhNode *node = &nodes[n];
+			bool inside = true, outside = false;
+			for (i = 0; i < 6 && !outside; i++) {
+				glm::vec3 normal(planes[i]);
+				/* the corners farthest along and against the normal */
+				glm::vec3 far = glm::mix(node->min, node->max, glm::vec3(glm::greaterThanEqual(normal, glm::vec3(0.0f))));
+				glm::vec3 near = node->min + node->max - far;
+				outside = glm::dot(normal, far) + planes[i].w < 0.0f;
+				inside = inside && glm::dot(normal, near) + planes[i].w >= 0.0f;
+			}
+			if (outside)
+				continue;
+			if (inside)
+				report(n, f, user);
+			else if (node->child < 0)
+				f(user, ~node->child);
+			else if (sp + 2 <= BVH_STACK) {
+				stack[sp++] = node->child;
+				stack[sp++] = node->child + 1;
+			}
+		}
+	}
+
+	/* The surface area of the inner nodes of the subtree at slot, relative
+	* to its own: the expected number of inner nodes a ray through it
+	* visits. */
+	float cost(int slot) const
+	{
+		int stack[BVH_STACK], sp = 0;
+		float sum = 0.0f, root = area(nodes[slot].min, nodes[slot].max);
+
+		stack[sp++] = slot;
+		while (sp > 0) {
+			const BvhNode *node = &nodes[stack[--sp]];
+			if (node->child < 0)
+				continue;
+			sum += area(node->min, node->max);
+			if (sp + 2 <= BVH_STACK) {
+				stack[sp++] = node->child;
+				stack[sp++] = node->child + 1;
+			}
+		}
+		return (root > 0.0f) ? sum / root : 0.0f;
+	}
+
+	/* half the surface area of the box */
+	static float area(const glm::vec3 &lo, const glm::vec3 &hi)
+	{
+		glm::vec3 d = hi - lo;
+		return d.x * d.y + d.y * d.z + d.z * d.x;
+	}
+
+	void setLeaf(int n, int parent, int object, const glm::vec3 &lo, const glm::vec3 &hi)
+	{
+		nodes[n].min = lo;
+		nodes[n].max = hi;
+		nodes[n].parent = parent;
+		nodes[n].child = ~object;
+		objectNode[object] = n;
+	}
+
+	/* Point the children of node n, or its object, back at n. */
+	void adopt(int n)
+	{
+		if (nodes[n].child >= 0) {
+			nodes[nodes[n].child].parent = n;
+			nodes[nodes[n].child + 1].parent = n;
+		} else {
+			objectNode[~nodes[n].child] = n;
+		}
+	}
+
+	int allocatePair()
+	{
+		int p = freePair;
+		if (p >= 0) {
+			freePair = nodes[p].parent;
+			return p;
+		}
+		p = nodeCount;
+		nodeCount += 2;
+		return p;
+	}
+
+	void freePairAt(int p)
+	{
+		nodes[p].parent = freePair;
+		freePair = p;
+	}
+
+	/* The node below which a leaf from lo to hi adds the least area. */
+	int findSibling(const glm::vec3 &lo, const glm::vec3 &hi) const
+	{
+		int n = 0, k;
+
+		while (nodes[n].child >= 0) {
+			const BvhNode *node = &nodes[n];
+			float combined = area(glm::min(node->min, lo), glm::max(node->max, hi));
+			/* pairing with n makes a new parent of the combined area, and
+			* going down grows n by as much as it grows */
+			float here = 2.0f * combined;
+			float inherited = 2.0f * (combined - area(node->min, node->max));
+			float down[2];
+			for (k = 0; k < 2; k++) {
+				const BvhNode *c = &nodes[node->child + k];
+				float grown = area(glm::min(c->min, lo), glm::max(c->max, hi));
+				down[k] = inherited + ((c->child < 0) ? grown : grown - area(c->min, c->max));
+			}
+			if (here < down[0] && here < down[1])
+				break;
+			n = node->child + ((down[1] < down[0]) ? 1 : 0);
+		}
+		return n;
+	}
+
+	/* Recompute the boxes from n up to the root, rotating on the way,
+	* until one does not change. */
+	void refit(int n)
+	{
+		while (n >= 0) {
+			BvhNode *node = &nodes[n];
+			rotate(n);
+			glm::vec3 lo = glm::min(nodes[node->child].min, nodes[node->child + 1].min);
+			glm::vec3 hi = glm::max(nodes[node->child].max, nodes[node->child + 1].max);
+			if (lo == node->min && hi == node->max)
+				break;
+			node->min = lo;
+			node->max = hi;
+			n = node->parent;
+		}
+	}
+
+	/* Swap a child of n with a child of its sibling, if that shrinks the
+	* sibling the most. */
+	void rotate(int n)
+	{
+		int k, g, bestChild = -1, bestGrand = -1;
+		float bestGain = 0.0f;
+
+		for (k = 0; k < 2; k++) {
+			int a = nodes[n].child + k, b = nodes[n].child + 1 - k;
+			if (nodes[b].child < 0)
+				continue;
+			/* a goes down into b, in place of grandchild g */
+			for (g = 0; g < 2; g++) {
+				int gc = nodes[b].child + g, other = nodes[b].child + 1 - g;
+				float after = area(glm::min(nodes[a].min, nodes[other].min), glm::max(nodes[a].max, nodes[other].max));
+				float gain = area(nodes[b].min, nodes[b].max) - after;
+				if (gain > bestGain) {
+					bestGain = gain;
+					bestChild = a;
+					bestGrand = gc;
+				}
+			}
+		}
+		if (bestChild < 0)
+			return;
+		int b = (bestChild & 1) ? bestChild + 1 : bestChild - 1;
+		swap(bestChild, bestGrand);
+		BvhNode *node = &nodes[b];
+		node->min = glm::min(nodes[node->child].min, nodes[node->child + 1].min);
+		node->max = glm::max(nodes[node->child].max, nodes[node->child + 1].max);
+	}
+
+	/* Exchange the subtrees at the nodes a and b, which keep their parents. */
+	void swap(int a, int b)
+	{
+		BvhNode t = nodes[a];
+		int pa = nodes[a].parent, pb = nodes[b].parent;
+		nodes[a] = nodes[b];
+		nodes[b] = t;
+		nodes[a].parent = pa;
+		nodes[b].parent = pb;
+		adopt(a);
+		adopt(b);
+	}
+
+	/* Call f for all objects below n. */
+	void report(int n, BvhQueryFunc f, void *user) const
+	{
+		int stack[BVH_STACK], sp = 0;
+		stack[sp++] = n;
+		while (sp > 0) {
+			const BvhNode *node = &nodes[stack[--sp]];
+			if (node->child < 0) {
+				f(user, ~node->child);
+			} else if (sp + 2 <= BVH_STACK) {
+				stack[sp++] = node->child;
+				stack[sp++] = node->child + 1;
+			}
+		}
+	}
+
+	/* The inner nodes at BVH_REBUILD_DEPTH, and their paths. */
+	int subtrees(int *slots, int *paths) const
+	{
+		int d, i, n = 0;
+		int level[1 << BVH_REBUILD_DEPTH], levelPaths[1 << BVH_REBUILD_DEPTH];
+
+		if (count < 2)
+			return 0;
+		level[0] = 0;
+		levelPaths[0] = 0;
+		n = 1;
+		for (d = 0; d < BVH_REBUILD_DEPTH; d++) {
+			int next = 0;
+			for (i = 0; i < n; i++) {
+				int c = nodes[level[i]].child;
+				if (c < 0)
+					continue;
+				slots[next] = c;
+				paths[next++] = levelPaths[i];
+				slots[next] = c + 1;
+				paths[next++] = levelPaths[i] | (1 << d);
+			}
+			memcpy(level, slots, sizeof(int) * next);
+			memcpy(levelPaths, paths, sizeof(int) * next);
+			n = next;
+		}
+		/* only the inner ones have anything to rebuild */
+		int found = 0;
+		for (i = 0; i < n; i++) {
+			if (nodes[level[i]].child < 0)
+				continue;
+			slots[found] = level[i];
+			paths[found++] = levelPaths[i];
+		}
+		return found;
+	}
+
+	void recordCosts()
+	{
+		int slots[1 << BVH_REBUILD_DEPTH], paths[1 << BVH_REBUILD_DEPTH];
+		int i, n = subtrees(slots, paths);
+		for (i = 0; i < n; i++)
+			builtCost[paths[i]] = cost(slots[i]);
+	}
+
+	static void rebuildJob(void *user, int begin, int end)
+	{
+		BvhRebuild *r = (BvhRebuild*)user;
+		int i;
+		for (i = begin; i < end; i++)
+			r[i].tree->rebuild(r[i].slot, r[i].path);
+	}
+
+	/* Build the subtree at slot again from its leaves, into the pairs it
+	* occupies already. */
+	void rebuild(int slot, int path)
+	{
+		int stack[BVH_STACK], sp = 0, leaves = 0, inner = 0;
+		int n = leafCount(slot);
+		BvhItem *items = (BvhItem*)malloc(sizeof(BvhItem) * n);
+		int *pairs = (int*)malloc(sizeof(int) * n);
+		if (!items || !pairs) {
+			warn("BvhTree: failed to rebuild %d objects", n);
+			free(items);
+			free(pairs);
+			return;
+		}
+		stack[sp++] = slot;
+		while (sp > 0) {
+			const BvhNode *node = &nodes[stack[--sp]];
+			if (node->child < 0) {
+				items[leaves].min = node->min;
+				items[leaves].max = node->max;
+				items[leaves++].object = ~node->child;
+			} else if (sp + 2 <= BVH_STACK) {
+				pairs[inner++] = node->child;
+				stack[sp++] = node->child;
+				stack[sp++] = node->child + 1;
+			}
+		}
+		if (leaves == n && buildRange(slot, nodes[slot].parent, items, n, pairs))
+			builtCost[path] = cost(slot);
+		free(items);
+		free(pairs);
+	}
+
+	int leafCount(int slot) const
+	{
+		int stack[BVH_STACK], sp = 0, n = 0;
+		stack[sp++] = slot;
+		while (sp > 0) {
+			const BvhNode *node = &nodes[stack[--sp]];
+			if (node->child < 0) {
+				n++;
+			} else if (sp + 2 <= BVH_STACK) {
+				stack[sp++] = node->child;
+				stack[sp++] = node->child + 1;
+			}
+		}
+		return n;
+	}
+
+	/* Build the n items into a subtree at slot below parent, taking the
+	* n - 1 pairs it needs from pairs. Splits each range where the SAH over
+	* BVH_BINS bins of the centroids along the longest axis is least.
+	* Returns false if out of memory. */
+	bool buildRange(int slot, int parent, BvhItem *items, int n, const int *pairs)
+	{
+		int used = 0, sp = 0, i, b;
+		BvhBuildTask *tasks = (BvhBuildTask*)malloc(sizeof(BvhBuildTask) * n);
+		if (!tasks)
+			return false;
+		tasks[sp].slot = slot;
+		tasks[sp].parent = parent;
+		tasks[sp].begin = 0;
+		tasks[sp++].end = n;
+		while (sp > 0) {
+			BvhBuildTask t = tasks[--sp];
+			if (t.end - t.begin == 1) {
+				setLeaf(t.slot, t.parent, items[t.begin].object, items[t.begin].min, items[t.begin].max);
+				continue;
+			}
+			glm::vec3 lo(FLT_MAX), hi(-FLT_MAX), clo(FLT_MAX), chi(-FLT_MAX);
+			for (i = t.begin; i < t.end; i++) {
+				glm::vec3 c = items[i].min + items[i].max;
+				lo = glm::min(lo, items[i].min);
+				hi = glm::max(hi, items[i].max);
+				clo = glm::min(clo, c);
+				chi = glm::max(chi, c);
+			}
+			glm::vec3 extent = chi - clo;
+			int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z) ? 1 : 2;
+			int mid = (t.begin + t.end) / 2;
+			if (extent[axis] > 0.0f) {
+				/* bin the centroids, then sweep the bins from both sides */
+				int counts[BVH_BINS] = { 0 };
+				glm::vec3 binLo[BVH_BINS], binHi[BVH_BINS];
+				float scale = (float)BVH_BINS / extent[axis];
+				for (b = 0; b < BVH_BINS; b++) {
+					binLo[b] = glm::vec3(FLT_MAX);
+					binHi[b] = glm::vec3(-FLT_MAX);
+				}
+				for (i = t.begin; i < t.end; i++) {
+					b = binOf(items[i], axis, clo[axis], scale);
+					counts[b]++;
+					binLo[b] = glm::min(binLo[b], items[i].min);
+					binHi[b] = glm::max(binHi[b], items[i].max);
+				}
+				float rightCost[BVH_BINS];
+				glm::vec3 rlo(FLT_MAX), rhi(-FLT_MAX);
+				int right = 0;
+				for (b = BVH_BINS - 1; b > 0; b--) {
+					right += counts[b];
+					rlo = glm::min(rlo, binLo[b]);
+					rhi = glm::max(rhi, binHi[b]);
+					rightCost[b] = right ? area(rlo, rhi) * (float)right : 0.0f;
+				}
+				glm::vec3 llo(FLT_MAX), lhi(-FLT_MAX);
+				int left = 0, split = -1;
+				float bestCost = FLT_MAX;
+				for (b = 0; b < BVH_BINS - 1; b++) {
+					left += counts[b];
+					llo = glm::min(llo, binLo[b]);
+					lhi = glm::max(lhi, binHi[b]);
+					if (!left || left == t.end - t.begin)
+						continue;
+					float c = area(llo, lhi) * (float)left + rightCost[b + 1];
+					if (c < bestCost) {
+						bestCost = c;
+						split = b;
+					}
+				}
+				if (split >= 0) {
+					int l = t.begin, r = t.end - 1;
+					while (l <= r) {
+						if (binOf(items[l], axis, clo[axis], scale) <= split) {
+							l++;
+						} else {
+							BvhItem tmp = items[l];
+							items[l] = items[r];
+							items[r--] = tmp;
+						}
+					}
+					mid = l;
+				}
+			}
+			int p = pairs[used++];
+			nodes[t.slot].min = lo;
+			nodes[t.slot].max = hi;
+			nodes[t.slot].parent = t.parent;
+			nodes[t.slot].child = p;
+			tasks[sp].slot = p;
+			tasks[sp].parent = t.slot;
+			tasks[sp].begin = t.begin;
+			tasks[sp++].end = mid;
+			tasks[sp].slot = p + 1;
+			tasks[sp].parent = t.slot;
+			tasks[sp].begin = mid;
+			tasks[sp++].end = t.end;
+		}
+		free(tasks);
+		return true;
+	}
+
+	static int binOf(const BvhItem &item, int axis, float lo, float scale)
+	{
+		int b = (int)((item.min[axis] + item.max[axis] - lo) * scale);
+		return (b < BVH_BINS - 1) ? b : BVH_BINS - 1;
+	}
+} BvhTree;
+
+#endif
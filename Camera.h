@@ -0,0 +1,151 @@
+#ifndef HEADER_CAMERA_H
+#define HEADER_CAMERA_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "FrustumCuller.h"
+
+/****************************************************************************
+* CAMERA                                                                   *
+****************************************************************************/
+
+/* Camera: the projection and view of the frames, and what is derived from
+* them, recomputed only when something they depend on changed. The setters
+* just compare and mark what changed, so they may be called every frame;
+* update() then rebuilds the projection if the field of view, the aspect
+* ratio or the depth range changed, the view if the position or the
+* direction did, and the
+* view projection, its inverse and the frustum planes if either did.
+* Every change counts up version, so whatever only depends on the camera
+* can keep its result while the version stays the same, e.g. the culling
+* of objects which do not move.
+* The position is kept in double precision, and so is the view built from
+* it; rotation is the view without the translation, which camera-relative
+* rendering draws with, and relativeView() the view of what is placed
+* relative to a point in the world, both exact however far from the origin
+* the camera is. */
+#define CAMERA_PROJECTION_DIRTY 1u
+#define CAMERA_VIEW_DIRTY 2u
+
+typedef struct {
+	float fov;		/* vertical, in radians */
+	float aspect;		/* width / height */
+	float zNear, zFar;
+	glm::dvec3 eye;		/* the position */
+	glm::vec3 position;	/* the same in single precision */
+	glm::vec3 direction;	/* normalized, -z unless set otherwise */
+	glm::mat4 projection;
+	glm::mat4 view;
+	glm::mat4 rotation;	/* the view as seen from the origin */
+	glm::mat4 viewProjection;
+	glm::mat4 viewProjectionInverse;
+	glm::vec4 planes[6];	/* of viewProjection in world space, see frustumPlanes() */
+	unsigned int version;	/* counts the changes, 0 before the first update() */
+	unsigned int dirty;	/* CAMERA_*_DIRTY */
+
+	void clear()
+	{
+		fov = glm::half_pi<float>();
+		aspect = 1.0f;
+		zNear = 0.1f;
+		zFar = 10.0f;
+		eye = glm::dvec3(0.0, 0.0, 4.0);
+		position = glm::vec3(eye);
+		direction = glm::vec3(0.0f, 0.0f, -1.0f);
+		version = 0;
+		dirty = CAMERA_PROJECTION_DIRTY | CAMERA_VIEW_DIRTY;
+	}
+
+	void setFov(float radians)
+	{
+		if (radians != fov) {
+			fov = radians;
+			dirty |= CAMERA_PROJECTION_DIRTY;
+		}
+	}
+
+	/* The size of the framebuffer, which sets the aspect ratio. */
+	void setViewport(int width, int height)
+	{
+		float a = (height > 0) ? (float)width / (float)height : 1.0f;
+		if (a != aspect) {
+			aspect = a;
+			dirty |= CAMERA_PROJECTION_DIRTY;
+		}
+	}
+
+	void setDepthRange(float n, float f)
+	{
+		if (n != zNear || f != zFar) {
+			zNear = n;
+			zFar = f;
+			dirty |= CAMERA_PROJECTION_DIRTY;
+		}
+	}
+
+	void setPosition(const glm::dvec3 &p)
+	{
+		if (p != eye) {
+			eye = p;
+			position = glm::vec3(p);
+			dirty |= CAMERA_VIEW_DIRTY;
+		}
+	}
+
+	/* The direction to look at, normalized. */
+	void setDirection(const glm::vec3 &d)
+	{
+		if (d != direction) {
+			direction = d;
+			dirty |= CAMERA_VIEW_DIRTY;
+		}
+	}
+
+	/* Look from the position towards target. */
+	void lookAt(const glm::dvec3 &target)
+	{
+		glm::dvec3 d = target - eye;
+		double l = glm::length(d);
+		if (l > 0.0)
+			setDirection(glm::vec3(d / l));
+	}
+
+	/* The view of what is placed relative to origin, a point in the
+	* world: the translation between the two is taken in double precision
+	* and only then rounded. */
+	glm::mat4 relativeView(const glm::dvec3 &origin) const
+	{
+		return rotation * glm::translate(glm::mat4(1.0f), glm::vec3(origin - eye));
+	}
+
+	/* Rebuild what changed since the last call.
+	* Returns true if anything did. */
+	bool update()
+	{
+		if (!dirty)
+			return false;
+		if (dirty & CAMERA_PROJECTION_DIRTY)
+			projection = glm::perspective(fov, aspect, zNear, zFar);
+		if (dirty & CAMERA_VIEW_DIRTY) {
+			if (direction == glm::vec3(0.0f, 0.0f, -1.0f)) {
+				rotation = glm::mat4(1.0f);
+			} else {
+				/* +y is up, unless looking straight up or down */
+				glm::vec3 up(0.0f, 1.0f, 0.0f);
+				if (fabsf(direction.y) > 0.999f)
+					up = glm::vec3(0.0f, 0.0f, -1.0f);
+				rotation = glm::lookAt(glm::vec3(0.0f), direction, up);
+			}
+			view = glm::mat4(glm::dmat4(rotation) * glm::translate(glm::dmat4(1.0), -eye));
+		}
+		viewProjection = projection * view;
+		viewProjectionInverse = glm::inverse(viewProjection);
+		frustumPlanes(viewProjection, planes);
+		dirty = 0;
+		version++;
+		return true;
+	}
+} Camera;
+
+#endif
@@ -0,0 +1,943 @@
+#ifndef HEADER_CAPTURE_H
+#define HEADER_CAPTURE_H
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* FRAME CAPTURE: screenshots and video                                     *
+****************************************************************************/
+
+/* FrameCapture: reads frames back without stalling the pipeline. glReadPixels
+* into client memory waits until the GPU has drawn the frame; into a
+* pixel-pack buffer it only queues a copy. So frame() copies the
+* framebuffer into the next of CAPTURE_SLOTS pixel-pack buffers and places a
+* fence behind it, and maps the buffers whose fence has signaled, a few
+* frames later, copies the pixels into a frame of the queue of the encoder
+* thread and hands the buffer back. The encoder flips
+* the rows (GL starts at the bottom) and writes
+*   CAPTURE_PNG, a PNG per frame, numbered by the %u in the path,
+*   CAPTURE_RAW, all frames back to back as rows of RGBA8 from the top,
+*   CAPTURE_VIDEO, the same into the standard input of ffmpeg, which
+*     encodes them into the file at the path,
+* and each screenshot as a PNG of its own, named by the caller (the batch
+* mode names the frames of its jobs this way) or CAPTURE_SCREENSHOT. The
+* PNG files are not compressed (stored deflate blocks), which needs no zlib
+* and keeps the encoder fast.
+* Nothing of this waits for the GPU or for the encoder, so recording does not
+* change the frame times it records: a frame arriving while the queue is
+* full is dropped and counted (unless lossless is set, then the render
+* thread waits for the encoder), and a slot whose copy is not done yet when it
+* comes around again is waited for only then, counted as a stall (with
+* CAPTURE_SLOTS larger than the frames in flight, it never is). What the
+* capture costs on the thread of the context is measured as well.
+* The frames of CAPTURE_VIDEO are not read as RGBA8: a pass converts them into
+* NV12 (BT.601, limited range) on the GPU, the luma rows and below them the
+* interleaved chroma of 2x2 pixels, 1.5 bytes a pixel instead of 4, which is
+* what the hardware encoders take as it is. So the read, the copy into the
+* queue and the pipe move 2.7 times less, and ffmpeg converts nothing; frames
+* which come as RGBA8 anyway (with a screenshot, or from writeVideo()) are
+* converted by the encoder thread. Which encoder ffmpeg runs is picked by
+* captureEncoders, and a path with "://" is a live stream, see openPipe(). */
+#define CAPTURE_SLOTS 4		/* pixel-pack buffers in flight */
+#define CAPTURE_QUEUE 8		/* frames waiting for the encoder */
+#define CAPTURE_PATH_MAX 256
+#define CAPTURE_FPS 60		/* of the video */
+#define CAPTURE_SCREENSHOT "screenshot_%04u.png"	/* numbered from 0 */
+#define CAPTURE_NV12_FS "shaders/capture_nv12.fs.glsl"
+#define CAPTURE_NV12_VS "shaders/raymarch.vs.glsl"	/* the full-screen triangle */
+#define CAPTURE_VAAPI_DEVICE "/dev/dri/renderD128"
+
+/* what the frames are written as */
+enum {
+	CAPTURE_PNG = 0,
+	CAPTURE_RAW,
+	CAPTURE_VIDEO
+};
+
+/* A URL like rtmp://host/app/key or srt://host:port, which ffmpeg streams
+* to, rather than a file. */
+static bool captureIsStream(const char *path)
+{
+	return strstr(path, "://") != NULL;
+}
+
+/* The format of path by its extension: .png or .raw, anything else is a
+* video for ffmpeg, and so is a stream. */
+static int captureFormatByPath(const char *path)
+{
+	const char *ext = strrchr(path, '.');
+	if (captureIsStream(path))
+		return CAPTURE_VIDEO;
+	if (ext && !strcmp(ext, ".png"))
+		return CAPTURE_PNG;
+	if (ext && !strcmp(ext, ".raw"))
+		return CAPTURE_RAW;
+	return CAPTURE_VIDEO;
+}
+
+/* The encoders of CAPTURE_VIDEO: what ffmpeg is told after the input, and
+* added to that for a live stream. The software one is the default of the
+* container (libx264 for .mp4) and converts to yuv420p on the CPU of ffmpeg;
+* the others are the H.264 encoders of the GPU vendors, which take the NV12
+* frames as they are. They leave the CPU to the renderer, and keep up with
+* 4K at 60 frames per second where libx264 does not. */
+enum {
+	CAPTURE_ENCODER_AUTO = -1,	/* the first hardware one which works, else software */
+	CAPTURE_ENCODER_SOFTWARE = 0,
+	CAPTURE_ENCODER_NVENC,
+	CAPTURE_ENCODER_QSV,
+	CAPTURE_ENCODER_VAAPI,
+	CAPTURE_ENCODERS
+};
+
+typedef struct {
+	const char *name;
+	const char *args;
+	const char *live;	/* low latency */
+} CaptureEncoder;
+
+static const CaptureEncoder captureEncoders[CAPTURE_ENCODERS] = {
+	{ "software", "-pix_fmt yuv420p", "-preset veryfast -tune zerolatency" },
+	{ "nvenc", "-c:v h264_nvenc", "-zerolatency 1 -rc-lookahead 0" },
+	{ "qsv", "-c:v h264_qsv", "-async_depth 1" },
+	{ "vaapi", "-vaapi_device " CAPTURE_VAAPI_DEVICE " -vf format=nv12,hwupload -c:v h264_vaapi", "-bf 0" }
+};
+
+/* The CAPTURE_ENCODER_* of name, or "auto".
+* Returns -2 if there is no such encoder. */
+static int captureEncoderByName(const char *name)
+{
+	int i;
+	if (!strcmp(name, "auto"))
+		return CAPTURE_ENCODER_AUTO;
+	for (i = 0; i < CAPTURE_ENCODERS; i++)
+		if (!strcmp(name, captureEncoders[i].name))
+			return i;
+	return -2;
+}
+
+/* The encoder of choice, with CAPTURE_ENCODER_AUTO the first hardware one
+* with which ffmpeg encodes a test frame. ffmpeg lists the encoders it was
+* built with whether there is such a GPU or not, so only a try tells. The
+* answer is kept, the try takes a moment. */
+static int captureEncoderPick(int choice)
+{
+	static std::mutex lock;
+	static int picked = -2;
+	char command[512];
+	int i;
+
+	if (choice != CAPTURE_ENCODER_AUTO)
+		return choice;
+	std::lock_guard<std::mutex> guard(lock);
+	for (i = CAPTURE_ENCODER_SOFTWARE + 1; i < CAPTURE_ENCODERS && picked == -2; i++) {
+		mysnprintf(command, sizeof(command), "ffmpeg -nostdin -loglevel quiet -f lavfi -i color=size=256x256 "
+			"-frames:v 1 %s -f null -", captureEncoders[i].args);
+		if (system(command) == 0)
+			picked = i;
+	}
+	if (picked == -2)
+		picked = CAPTURE_ENCODER_SOFTWARE;
+	return picked;
+}
+
+/* Convert width x height RGBA8 pixels, rows from the bottom as GL reads
+* them, into the NV12 frame nv12 of the sides rounded up to even, from the
+* top, like the conversion pass does; the last row and column are repeated.
+* nv12 holds captureNv12Size(width, height) bytes. */
+static size_t captureNv12Size(int width, int height)
+{
+	size_t w = (size_t)(width + 1) & ~(size_t)1, h = (size_t)(height + 1) & ~(size_t)1;
+	return w * h * 3 / 2;
+}
+
+static void captureRgbaToNv12(unsigned char *nv12, const unsigned char *pixels, int width, int height)
+{
+	int w = (width + 1) & ~1, h = (height + 1) & ~1, x, y, i;
+	unsigned char *luma = nv12, *chroma = nv12 + (size_t)w * h;
+
+	for (y = 0; y < h; y++) {
+		int row = height - 1 - (y < height ? y : height - 1);
+		for (x = 0; x < w; x++) {
+			const unsigned char *p = pixels + ((size_t)row * width + (x < width ? x : width - 1)) * 4;
+			luma[(size_t)y * w + x] = (unsigned char)((66 * p[0] + 129 * p[1] + 25 * p[2] + 128 + 4096) >> 8);
+		}
+	}
+	for (y = 0; y < h / 2; y++) {
+		for (x = 0; x < w / 2; x++) {
+			int r = 0, g = 0, b = 0;
+			for (i = 0; i < 4; i++) {
+				int px = 2 * x + (i & 1), py = 2 * y + (i >> 1);
+				int row = height - 1 - (py < height ? py : height - 1);
+				const unsigned char *p = pixels + ((size_t)row * width + (px < width ? px : width - 1)) * 4;
+				r += p[0];
+				g += p[1];
+				b += p[2];
+			}
+			/* the sums are 4 times the mean */
+			chroma[(size_t)y * w + 2 * x] = (unsigned char)((-38 * r - 74 * g + 112 * b + 512 + 131072) >> 10);
+			chroma[(size_t)y * w + 2 * x + 1] = (unsigned char)((112 * r - 94 * g - 18 * b + 512 + 131072) >> 10);
+		}
+	}
+}
+
+/* The CRC-32 of the PNG chunks, continued from crc. */
+static unsigned int captureCrc32(unsigned int crc, const unsigned char *data, size_t length)
+{
+	static unsigned int table[256];
+	static bool tableReady = false;
+	size_t i;
+
+	if (!tableReady) {
+		unsigned int n, c, k;
+		for (n = 0; n < 256; n++) {
+			c = n;
+			for (k = 0; k < 8; k++)
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		}
+		tableReady = true;
+	}
+	crc = ~crc;
+	for (i = 0; i < length; i++)
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+/* Write value as 4 bytes big endian to out. */
+static void capturePutBE32(unsigned char *out, unsigned int value)
+{
+	out[0] = (unsigned char)(value >> 24);
+	out[1] = (unsigned char)(value >> 16);
+	out[2] = (unsigned char)(value >> 8);
+	out[3] = (unsigned char)value;
+}
+
+/* A PNG chunk being written to f, its data may come in pieces. */
+typedef struct {
+	FILE *f;
+	unsigned int crc;
+} CapturePngChunk;
+
+/* Start a chunk of type with length bytes of data. */
+static void captureChunkBegin(CapturePngChunk *c, FILE *f, const char *type, unsigned int length)
+{
+	unsigned char header[8];
+	capturePutBE32(header, length);
+	memcpy(header + 4, type, 4);
+	fwrite(header, 1, 8, f);
+	c->f = f;
+	c->crc = captureCrc32(0, header + 4, 4);
+}
+
+static void captureChunkData(CapturePngChunk *c, const unsigned char *data, size_t length)
+{
+	fwrite(data, 1, length, c->f);
+	c->crc = captureCrc32(c->crc, data, length);
+}
+
+static void captureChunkEnd(CapturePngChunk *c)
+{
+	unsigned char crc[4];
+	capturePutBE32(crc, c->crc);
+	fwrite(crc, 1, 4, c->f);
+}
+
+/* The zlib stream of the image data, as stored deflate blocks of at most
+* 65535 bytes, each behind a header of its own. */
+typedef struct {
+	CapturePngChunk *chunk;
+	size_t left;		/* bytes of the stream still to come */
+	size_t inBlock;		/* bytes still to come in the current block */
+	unsigned int s1, s2;	/* of the Adler-32 */
+
+	void put(const unsigned char *data, size_t length)
+	{
+		size_t n, i;
+		while (length) {
+			if (!inBlock) {
+				unsigned char header[5];
+				inBlock = (left < 65535) ? left : 65535;
+				header[0] = (left == inBlock) ? 1 : 0;	/* the last block */
+				header[1] = (unsigned char)inBlock;
+				header[2] = (unsigned char)(inBlock >> 8);
+				header[3] = (unsigned char)~header[1];
+				header[4] = (unsigned char)~header[2];
+				captureChunkData(chunk, header, 5);
+			}
+			n = (length < inBlock) ? length : inBlock;
+			captureChunkData(chunk, data, n);
+			/* the sums do not overflow in 5552 bytes */
+			for (i = 0; i < n;) {
+				size_t end = (n - i > 5552) ? i + 5552 : n;
+				for (; i < end; i++) {
+					s1 += data[i];
+					s2 += s1;
+				}
+				s1 %= 65521;
+				s2 %= 65521;
+			}
+			data += n;
+			length -= n;
+			inBlock -= n;
+			left -= n;
+		}
+	}
+} CaptureStoredStream;
+
+/* Write the width x height RGBA8 pixels, rows from the bottom as GL reads
+* them, into the PNG file filename, without compression.
+* Returns true if successfull and false in case of an error. */
+static bool captureWritePng(const char *filename, const unsigned char *pixels, int width, int height)
+{
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	const size_t row = (size_t)width * 4;
+	const size_t raw = (row + 1) * (size_t)height;	/* a filter byte per row */
+	const size_t blocks = (raw + 65534) / 65535;
+	const unsigned char zlib[2] = { 0x78, 0x01 }, filter = 0;
+	unsigned char header[13], adler[4];
+	CapturePngChunk chunk;
+	CaptureStoredStream stream;
+	int y;
+	FILE *f;
+
+	if ((double)raw + (double)blocks * 5.0 + 6.0 > 2147483647.0) {
+		warn("capture: %dx%d is too large for a PNG without compression", width, height);
+		return false;
+	}
+	f = fopen(filename, "wb");
+	if (!f) {
+		warn("capture: failed to open '%s'", filename);
+		return false;
+	}
+	fwrite(signature, 1, 8, f);
+	capturePutBE32(header, (unsigned int)width);
+	capturePutBE32(header + 4, (unsigned int)height);
+	header[8] = 8;		/* bits per channel */
+	header[9] = 6;		/* RGBA */
+	header[10] = header[11] = header[12] = 0;
+	captureChunkBegin(&chunk, f, "IHDR", 13);
+	captureChunkData(&chunk, header, 13);
+	captureChunkEnd(&chunk);
+
+	captureChunkBegin(&chunk, f, "IDAT", (unsigned int)(2 + raw + blocks * 5 + 4));
+	captureChunkData(&chunk, zlib, 2);
+	stream.chunk = &chunk;
+	stream.left = raw;
+	stream.inBlock = 0;
+	stream.s1 = 1;
+	stream.s2 = 0;
+	for (y = height - 1; y >= 0; y--) {
+		stream.put(&filter, 1);
+		stream.put(pixels + (size_t)y * row, row);
+	}
+	capturePutBE32(adler, (stream.s2 << 16) | stream.s1);
+	captureChunkData(&chunk, adler, 4);
+	captureChunkEnd(&chunk);
+
+	captureChunkBegin(&chunk, f, "IEND", 0);
+	captureChunkEnd(&chunk);
+	if (fclose(f)) {
+		warn("capture: failed to write '%s'", filename);
+		return false;
+	}
+	return true;
+}
+
+/* Start command with a pipe to its standard input.
+* Returns NULL in case of an error. */
+static FILE *captureOpenPipe(const char *command)
+{
+#ifdef WIN32
+	return _popen(command, "wb");
+#else
+	return popen(command, "w");
+#endif
+}
+
+/* Close a pipe of captureOpenPipe and wait for the command.
+* Returns its exit status, -1 in case of an error. */
+static int captureClosePipe(FILE *pipe)
+{
+#ifdef WIN32
+	return _pclose(pipe);
+#else
+	return pclose(pipe);
+#endif
+}
+
+/* Takes the screenshots instead of the PNG files, on the encoder thread:
+* the name they were taken with and width x height RGBA8 pixels, rows from
+* the bottom. The render farm sends them to its coordinator this way. */
+typedef void (*CaptureSinkFunc)(void *user, const char *name, const unsigned char *pixels, int width, int height);
+
+/* a read into a pixel-pack buffer */
+typedef struct {
+	GLuint buffer;
+	GLsizeiptr capacity;	/* of buffer */
+	GLsync fence;		/* behind the read, 0 if the slot is free */
+	int width, height;
+	bool video;		/* the frame goes to the recording */
+	bool nv12;		/* read converted, see convert() */
+	char screenshot[CAPTURE_PATH_MAX];	/* and into this PNG file, if not empty */
+} CaptureSlot;
+
+/* a frame in the queue of the encoder */
+typedef struct {
+	unsigned char *pixels;	/* RGBA8 rows from the bottom, or NV12 */
+	size_t capacity;	/* of pixels */
+	int width, height;
+	bool video;
+	bool nv12;		/* pixels are NV12 from the top, see captureRgbaToNv12 */
+	unsigned int videoIndex;	/* number of the frame in the recording */
+	char screenshot[CAPTURE_PATH_MAX];	/* empty if none */
+} CaptureFrame;
+
+typedef struct {
+	bool recording;		/* every frame goes to the video */
+	bool lossless;		/* wait for the encoder rather than drop frames */
+	char screenshotPath[CAPTURE_PATH_MAX];	/* the next frame goes there, if not empty */
+	int format;		/* CAPTURE_* of the recording */
+	char path[CAPTURE_PATH_MAX];
+	int fps;		/* of CAPTURE_VIDEO */
+	int videoEncoder;	/* CAPTURE_ENCODER_* of CAPTURE_VIDEO */
+	bool live;		/* path is a stream, frames are dropped rather than waited for */
+	int videoWidth, videoHeight;	/* of CAPTURE_RAW and CAPTURE_VIDEO, set by the first frame */
+	FILE *out;		/* of CAPTURE_RAW or the pipe of CAPTURE_VIDEO, written by the encoder */
+	CaptureSinkFunc sink;	/* of the screenshots, NULL to write them */
+	void *sinkUser;
+	CaptureSlot slots[CAPTURE_SLOTS];
+	unsigned int nextSlot;
+	unsigned char *nv12;	/* the frame converted by the encoder thread */
+	size_t nv12Capacity;
+
+	/* the conversion into NV12, 0 if it is not available */
+	GLuint convertProgram;
+	GLuint convertVao;	/* empty, for the full-screen triangle */
+	GLuint sourceFbo, sourceTexture;	/* the frame, flipped */
+	GLuint targetFbo, targetTexture;	/* R8, the planes one below the other */
+	int convertWidth, convertHeight;	/* of the source */
+	GLint sourceSizeLoc, lumaRowsLoc;
+
+	/* what happened, since the start */
+	unsigned int frames;	/* of the video, queued */
+	unsigned int screenshots;
+	unsigned int dropped;	/* the queue was full */
+	unsigned int stalls;	/* a slot was still being copied */
+	unsigned long long cpuTime;	/* ns on the thread of the context */
+
+	/* the encoder thread, the queue is protected by lock */
+	std::thread thread;
+	bool threadRunning;
+	std::mutex lock;
+	std::condition_variable wake;	/* a frame was queued, or quit */
+	std::condition_variable idle;	/* the encoder finished a frame */
+	CaptureFrame queue[CAPTURE_QUEUE];
+	unsigned int queued;	/* frames handed to the encoder */
+	unsigned int encoded;	/* frames the encoder is done with */
+	bool quit;
+	bool failed;		/* writing the recording failed, set by the encoder */
+
+	void clear()
+	{
+		recording = lossless = false;
+		screenshotPath[0] = 0;
+		format = CAPTURE_PNG;
+		path[0] = 0;
+		fps = CAPTURE_FPS;
+		videoEncoder = CAPTURE_ENCODER_AUTO;
+		live = false;
+		videoWidth = videoHeight = 0;
+		out = NULL;
+		sink = NULL;
+		sinkUser = NULL;
+		memset(slots, 0, sizeof(slots));
+		nextSlot = 0;
+		nv12 = NULL;
+		nv12Capacity = 0;
+		convertProgram = convertVao = 0;
+		sourceFbo = sourceTexture = targetFbo = targetTexture = 0;
+		convertWidth = convertHeight = 0;
+		sourceSizeLoc = lumaRowsLoc = -1;
+		frames = screenshots = dropped = stalls = 0;
+		cpuTime = 0;
+		threadRunning = false;
+		memset(queue, 0, sizeof(queue));
+		queued = encoded = 0;
+		quit = failed = false;
+	}
+
+	/* Create the pixel-pack buffers and the conversion program, its
+	* sources are loaded via cache, and start the encoder thread.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		int i;
+		clear();
+		for (i = 0; i < CAPTURE_SLOTS; i++) {
+			glGenBuffers(1, &slots[i].buffer);
+			glDebugLabel(GL_BUFFER, slots[i].buffer, "capture %d", i);
+		}
+		convertProgram = programBuild(cache, CAPTURE_NV12_VS, CAPTURE_NV12_FS);
+		if (convertProgram) {
+			glState()->useProgram(convertProgram);
+			glUniform1i(glGetUniformLocation(convertProgram, "source"), 0);
+			sourceSizeLoc = glGetUniformLocation(convertProgram, "sourceSize");
+			lumaRowsLoc = glGetUniformLocation(convertProgram, "lumaRows");
+			glState()->useProgram(0);
+			glGenVertexArrays(1, &convertVao);
+			glGenFramebuffers(1, &sourceFbo);
+			glGenFramebuffers(1, &targetFbo);
+		} else {
+			info("capture: no NV12 conversion on the GPU, the encoder thread converts the video frames");
+		}
+		GL_ERROR_DBG("capture initialization");
+		threadRunning = true;
+		thread = std::thread([this]() { encoder(); });
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		if (recording)
+			stop();
+		if (threadRunning) {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				quit = true;
+			}
+			wake.notify_one();
+			thread.join();
+		}
+		for (i = 0; i < CAPTURE_SLOTS; i++) {
+			if (slots[i].fence)
+				glDeleteSync(slots[i].fence);
+			if (slots[i].buffer)
+				glState()->deleteBuffers(1, &slots[i].buffer);
+		}
+		for (i = 0; i < CAPTURE_QUEUE; i++)
+			free(queue[i].pixels);
+		if (convertProgram)
+			glState()->deleteProgram(convertProgram);
+		if (convertVao)
+			glState()->deleteVertexArrays(1, &convertVao);
+		if (sourceFbo)
+			glDeleteFramebuffers(1, &sourceFbo);
+		if (targetFbo)
+			glDeleteFramebuffers(1, &targetFbo);
+		if (sourceTexture)
+			glState()->deleteTextures(1, &sourceTexture);
+		if (targetTexture)
+			glState()->deleteTextures(1, &targetTexture);
+		clear();
+	}
+
+	/* Start recording every frame into filename, in the format of its
+	* extension (see captureFormatByPath), a video with rate frames per
+	* second.
+	* Returns true if successfull and false in case of an error. */
+	bool start(const char *filename, int rate = CAPTURE_FPS)
+	{
+		if (!threadRunning)
+			return false;
+		return record(filename, rate);
+	}
+
+	/* Start the recording like start(), but for frames which are handed to
+	* writeVideo() directly instead of being read back, so this needs
+	* neither init() nor a GL context; the render farm coordinator writes
+	* the frames of its nodes this way.
+	* Returns true if successfull and false in case of an error. */
+	bool record(const char *filename, int rate = CAPTURE_FPS)
+	{
+		if (recording)
+			stop();
+		mysnprintf(path, sizeof(path), "%s", filename);
+		format = captureFormatByPath(path);
+		/* a PNG per frame needs a number in the name */
+		if (format == CAPTURE_PNG && !strchr(path, '%'))
+			mysnprintf(path, sizeof(path), "%.*s_%%05u.png", (int)strlen(filename) - 4, filename);
+		fps = (rate > 0) ? rate : CAPTURE_FPS;
+		live = captureIsStream(path);
+		videoWidth = videoHeight = 0;
+		failed = false;
+		/* the file of CAPTURE_RAW and the pipe to ffmpeg are opened with
+		* the first frame, which tells the size */
+		recording = true;
+		frames = dropped = stalls = 0;
+		cpuTime = 0;
+		info("capture: recording into '%s'", path);
+		return true;
+	}
+
+	/* Stop recording: wait until the frames read so far are written and
+	* close the file. */
+	void stop()
+	{
+		if (!recording)
+			return;
+		recording = false;
+		flush();
+		if (out) {
+			if (format == CAPTURE_VIDEO)
+				failed |= captureClosePipe(out) != 0;
+			else
+				failed |= fclose(out) != 0;
+			out = NULL;
+		}
+		free(nv12);
+		nv12 = NULL;
+		nv12Capacity = 0;
+		if (failed)
+			warn("capture: writing '%s' failed", path);
+		info("capture: %u frames into '%s', %u dropped, %u stalls, %.3f ms per frame on the render thread",
+			frames, path, dropped, stalls, frames ? (double)cpuTime * 1.0e-6 / (double)frames : 0.0);
+	}
+
+	/* Write the next frame into the PNG file filename, or name it by
+	* CAPTURE_SCREENSHOT if it is NULL. */
+	void screenshot(const char *filename = NULL)
+	{
+		if (!threadRunning)
+			return;
+		if (filename)
+			mysnprintf(screenshotPath, sizeof(screenshotPath), "%s", filename);
+		else
+			mysnprintf(screenshotPath, sizeof(screenshotPath), CAPTURE_SCREENSHOT, screenshots++);
+	}
+
+	/* Something to read from this frame. */
+	bool wanted() const
+	{
+		return recording || screenshotPath[0];
+	}
+
+	/* Copy the color of framebuffer fbo (0 for the back buffer of the
+	* window) of width x height pixels into the next slot, if the frame is
+	* wanted, and collect the slots which are done. */
+	void frame(GLuint fbo, int width, int height)
+	{
+		unsigned long long start;
+		CaptureSlot *s;
+		MemoryScope scope(MEMORY_STAGING);
+
+		if (!wanted() && !pending())
+			return;
+		start = profileNow();
+		collect(false);
+		if (wanted() && width > 0 && height > 0) {
+			s = &slots[nextSlot];
+			nextSlot = (nextSlot + 1) % CAPTURE_SLOTS;
+			/* all slots are in flight, the oldest has to be done now */
+			if (s->fence) {
+				stalls++;
+				collectSlot(s, true);
+			}
+			/* a screenshot needs the RGBA8 pixels */
+			s->nv12 = recording && format == CAPTURE_VIDEO && !screenshotPath[0] && convertProgram;
+			s->width = width;
+			s->height = height;
+			GLsizeiptr size = (GLsizeiptr)slotSize(s);
+			glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, s->buffer);
+			if (s->capacity < size) {
+				glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+				s->capacity = size;
+			}
+			if (s->nv12) {
+				convert(fbo, width, height);
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, targetFbo);
+				glReadBuffer(GL_COLOR_ATTACHMENT0);
+				/* the rows of R8 are not padded to 4 bytes */
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+				glReadPixels(0, 0, (width + 1) & ~1, ((height + 1) & ~1) * 3 / 2, GL_RED, GL_UNSIGNED_BYTE,
+					BUFFER_OFFSET(0));
+				glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			} else {
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+				glReadBuffer(fbo ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+				glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, BUFFER_OFFSET(0));
+			}
+			glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			s->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			s->video = recording;
+			memcpy(s->screenshot, screenshotPath, sizeof(s->screenshot));
+			screenshotPath[0] = 0;
+		}
+		cpuTime += profileNow() - start;
+		GL_ERROR_DBG("capture frame");
+	}
+
+	/* The bytes read into slot s. */
+	static size_t slotSize(const CaptureSlot *s)
+	{
+		return s->nv12 ? captureNv12Size(s->width, s->height) : (size_t)s->width * s->height * 4;
+	}
+
+	/* Convert the color of framebuffer fbo of width x height pixels into
+	* NV12 in targetTexture: a blit flips it into sourceTexture (the back
+	* buffer cannot be sampled), and a full-screen pass writes the luma and
+	* the chroma rows below them, see capture_nv12.fs.glsl. */
+	void convert(GLuint fbo, int width, int height)
+	{
+		GL_DEBUG_GROUP("capture NV12");
+		int w = (width + 1) & ~1, h = (height + 1) & ~1;
+		GLint viewport[4], drawFbo = 0;
+		MemoryScope scope(MEMORY_TARGETS);
+
+		if (width != convertWidth || height != convertHeight) {
+			if (sourceTexture)
+				glState()->deleteTextures(1, &sourceTexture);
+			if (targetTexture)
+				glState()->deleteTextures(1, &targetTexture);
+			glGenTextures(1, &sourceTexture);
+			glState()->bindTexture(GL_TEXTURE_2D, sourceTexture);
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+			glGenTextures(1, &targetTexture);
+			glState()->bindTexture(GL_TEXTURE_2D, targetTexture);
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, w, h * 3 / 2);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sourceFbo);
+			glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sourceTexture, 0);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFbo);
+			glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTexture, 0);
+			glDebugLabel(GL_TEXTURE, targetTexture, "capture NV12 %dx%d", w, h);
+			convertWidth = width;
+			convertHeight = height;
+		}
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+		glReadBuffer(fbo ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sourceFbo);
+		glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFbo);
+		glState()->viewport(0, 0, w, h * 3 / 2);
+		glState()->disable(GL_DEPTH_TEST);
+		glState()->raster(0);
+		glState()->useProgram(convertProgram);
+		glUniform2i(sourceSizeLoc, width, height);
+		glUniform1i(lumaRowsLoc, h);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, sourceTexture);
+		glState()->bindVertexArray(convertVao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+		/* as the frame left it, like DynamicResolution::upscale() */
+		glState()->raster(RASTER_DEFAULT);
+		glState()->enable(GL_DEPTH_TEST);
+		glState()->viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)drawFbo);
+	}
+
+	/* Some slot was read into and not collected yet. */
+	bool pending() const
+	{
+		int i;
+		for (i = 0; i < CAPTURE_SLOTS; i++)
+			if (slots[i].fence)
+				return true;
+		return false;
+	}
+
+	/* Hand the slots which are done to the encoder, in the order they were
+	* read, all of them if wait is set. */
+	void collect(bool wait)
+	{
+		int i;
+		for (i = 0; i < CAPTURE_SLOTS; i++) {
+			CaptureSlot *s = &slots[(nextSlot + i) % CAPTURE_SLOTS];
+			if (s->fence && !collectSlot(s, wait))
+				break;
+		}
+	}
+
+	/* Hand slot s to the encoder if its copy is done, or after waiting for
+	* it if wait is set.
+	* Returns false if the copy is not done yet. */
+	bool collectSlot(CaptureSlot *s, bool wait)
+	{
+		GLenum res = glClientWaitSync(s->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+		if (res == GL_TIMEOUT_EXPIRED && !wait)
+			return false;
+		glDeleteSync(s->fence);
+		s->fence = 0;
+		if (res == GL_WAIT_FAILED || res == GL_TIMEOUT_EXPIRED) {
+			warn("capture: waiting for a read failed");
+			return true;
+		}
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, s->buffer);
+		const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)slotSize(s), GL_MAP_READ_BIT);
+		if (pixels) {
+			enqueue(s, pixels);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		} else {
+			warn("capture: failed to map buffer %u", s->buffer);
+		}
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		return true;
+	}
+
+	/* Copy the pixels of slot s into the queue of the encoder. If it is
+	* full, wait for it with lossless set, otherwise drop them; a live
+	* stream never waits, the renderer must not fall behind it. */
+	void enqueue(const CaptureSlot *s, const void *pixels)
+	{
+		size_t size = slotSize(s);
+		CaptureFrame *f;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			if (lossless && !live)
+				idle.wait(guard, [&]() { return queued - encoded < CAPTURE_QUEUE; });
+			if (queued - encoded >= CAPTURE_QUEUE) {
+				if (s->video)
+					dropped++;
+				if (s->screenshot[0])
+					warn("capture: the encoder is busy, '%s' dropped", s->screenshot);
+				return;
+			}
+			/* the encoder does not touch the frames behind the queued ones */
+			f = &queue[queued % CAPTURE_QUEUE];
+		}
+		if (f->capacity < size) {
+			free(f->pixels);
+			f->pixels = (unsigned char*)malloc(size);
+			f->capacity = f->pixels ? size : 0;
+			if (!f->pixels) {
+				warn("capture: failed to allocate %u bytes", (unsigned)size);
+				return;
+			}
+		}
+		memcpy(f->pixels, pixels, size);
+		f->width = s->width;
+		f->height = s->height;
+		f->video = s->video;
+		f->nv12 = s->nv12;
+		memcpy(f->screenshot, s->screenshot, sizeof(f->screenshot));
+		f->videoIndex = s->video ? frames++ : 0;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			queued++;
+		}
+		wake.notify_one();
+	}
+
+	/* Wait until everything read so far is written. */
+	void flush()
+	{
+		collect(true);
+		std::unique_lock<std::mutex> guard(lock);
+		idle.wait(guard, [&]() { return encoded == queued; });
+	}
+
+	/* Open the pipe to ffmpeg for a video of width x height pixels, NV12
+	* frames of the sides rounded up to even, encoded by videoEncoder. A
+	* live stream goes out as FLV for rtmp:// and MPEG-TS otherwise, with
+	* the frames stamped as they arrive (a dropped frame leaves a gap rather
+	* than speeding the stream up), a key frame every 2 seconds, the encoder
+	* tuned for latency and every packet sent as soon as it is muxed.
+	* Returns NULL in case of an error. */
+	FILE *openPipe(int width, int height)
+	{
+		char command[CAPTURE_PATH_MAX + 512];
+		const CaptureEncoder *e = &captureEncoders[captureEncoderPick(videoEncoder)];
+		int w = (width + 1) & ~1, h = (height + 1) & ~1;
+
+		if (live)
+			mysnprintf(command, sizeof(command), "ffmpeg -loglevel error -y -use_wallclock_as_timestamps 1 "
+				"-f rawvideo -pix_fmt nv12 -s %dx%d -i - %s %s -r %d -g %d -flush_packets 1 -muxdelay 0 -f %s \"%s\"", w, h, e->args, e->live,
+				fps, fps * 2, strncmp(path, "rtmp", 4) ? "mpegts" : "flv", path);
+		else
+			mysnprintf(command, sizeof(command), "ffmpeg -loglevel error -y -f rawvideo -pix_fmt nv12 -s %dx%d -r %d "
+				"-i - %s \"%s\"", w, h, fps, e->args, path);
+		info("capture: %s encoder%s", e->name, live ? ", live stream" : "");
+		return captureOpenPipe(command);
+	}
+
+	/* Write frame f of the recording. Encoder thread.
+	* Returns true if successfull and false in case of an error. */
+	bool writeVideo(const CaptureFrame *f)
+	{
+		char filename[CAPTURE_PATH_MAX + 16];
+		int y;
+
+		if (format == CAPTURE_PNG) {
+			mysnprintf(filename, sizeof(filename), path, f->videoIndex);
+			return captureWritePng(filename, f->pixels, f->width, f->height);
+		}
+		if (!out) {
+			videoWidth = f->width;
+			videoHeight = f->height;
+			out = (format == CAPTURE_VIDEO) ? openPipe(f->width, f->height) : fopen(path, "wb");
+			if (!out) {
+				warn("capture: failed to open '%s'", path);
+				return false;
+			}
+			info("capture: %dx%d %s frames into '%s'", videoWidth, videoHeight,
+				(format == CAPTURE_VIDEO) ? "NV12" : "RGBA8", path);
+		}
+		/* one size for all frames of the stream */
+		if (f->width != videoWidth || f->height != videoHeight)
+			return true;
+		if (format == CAPTURE_VIDEO) {
+			size_t size = captureNv12Size(f->width, f->height);
+			const unsigned char *frame = f->pixels;
+			if (!f->nv12) {
+				if (nv12Capacity < size) {
+					free(nv12);
+					nv12 = (unsigned char*)malloc(size);
+					nv12Capacity = nv12 ? size : 0;
+					if (!nv12)
+						return false;
+				}
+				captureRgbaToNv12(nv12, f->pixels, f->width, f->height);
+				frame = nv12;
+			}
+			return fwrite(frame, 1, size, out) == size;
+		}
+		for (y = f->height - 1; y >= 0; y--)
+			if (fwrite(f->pixels + (size_t)y * f->width * 4, 4, (size_t)f->width, out) != (size_t)f->width)
+				return false;
+		return true;
+	}
+
+	/* The encoder thread. */
+	void encoder()
+	{
+		PROFILE_THREAD("capture");
+		std::unique_lock<std::mutex> guard(lock);
+		for (;;) {
+			wake.wait(guard, [&]() { return quit || encoded != queued; });
+			if (encoded == queued)
+				break;
+			CaptureFrame *f = &queue[encoded % CAPTURE_QUEUE];
+			guard.unlock();
+			{
+				PROFILE_ZONE("capture encode");
+				if (f->video && !failed && !writeVideo(f))
+					failed = true;
+				if (f->screenshot[0] && sink)
+					sink(sinkUser, f->screenshot, f->pixels, f->width, f->height);
+				else if (f->screenshot[0] && captureWritePng(f->screenshot, f->pixels, f->width, f->height))
+					info("capture: screenshot '%s'", f->screenshot);
+			}
+			guard.lock();
+			encoded++;
+			idle.notify_all();
+		}
+	}
+} FrameCapture;
+
+#endif
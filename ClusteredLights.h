@@ -0,0 +1,215 @@
+#ifndef HEADER_CLUSTEREDLIGHTS_H
+#define HEADER_CLUSTEREDLIGHTS_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* CLUSTERED LIGHTS                                                         *
+****************************************************************************/
+
+/* ClusteredLights: point lights for the material shaders, as many as
+* LIGHT_MAX, of which each fragment only evaluates those near it (clustered
+* forward shading). The view frustum is split into LIGHT_CLUSTERS_X x
+* LIGHT_CLUSTERS_Y screen tiles, and each tile into LIGHT_CLUSTERS_Z slices
+* of exponentially growing depth, so a cluster (a froxel) is about as deep
+* as it is wide. Every frame, a compute pass (shaders/light_cull.cs.glsl)
+* tests the lights against the box of each cluster and packs the indices
+* of the lights of all clusters into one list, each cluster with the start
+* and length of its part. A fragment finds its cluster from its pixel and
+* depth and loops over that part only (see shaders/lights.glsl), so the
+* cost of lighting follows how many lights overlap there, not how many
+* there are.
+* The lights are placed in a cube from -1 to 1, which the caller scales
+* into the world, and uploaded in view space each frame, with the number of
+* lights in the Frame block telling the shaders whether to light at all.
+* The material shaders before GL 4.3 need
+* GL_ARB_shader_storage_buffer_object for the lists; without it, or
+* without compute shaders, there are no lights. */
+#define LIGHT_SHADER "shaders/light_cull.cs.glsl"
+#define LIGHT_MAX 1024			/* also in shaders/lights.glsl */
+#define LIGHT_CLUSTERS_X 16		/* these three too */
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+#define LIGHT_INDEX_MAX (LIGHT_CLUSTER_COUNT * 64)	/* entries of the index list */
+#define LIGHT_CULL_GROUP 64		/* local size of the compute shader */
+
+/* a light as the shaders see it, std430 */
+typedef struct {
+	glm::vec4 position;	/* view space, w: radius */
+	glm::vec4 color;	/* rgb, a unused */
+} GpuLight;
+
+/* the start of the storage block "Lights", std430; the lights, the
+* clusters and the index list follow */
+typedef struct {
+	GLuint grid[4];		/* clusters in x, y and z, lights */
+	glm::vec4 slices;	/* pixels per cluster in x and y, scale and bias of a slice in log(depth) */
+	GLuint indexCount[4];	/* used, capacity */
+} GpuLightHeader;
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint projectionInverseLoc, viewportLoc;
+	GLuint buffer;		/* the storage block "Lights", at LIGHT_SSBO_BINDING */
+	GpuLight *lights;	/* in the cube, at most LIGHT_MAX */
+	GpuLight *view;		/* this frame's, in view space */
+	int count;
+	bool updated;		/* update() ran this frame */
+	/* what the clusters were last assigned for, see update() */
+	unsigned int cameraVersion;
+	int width, height;
+
+	void clear()
+	{
+		program = buffer = 0;
+		lights = view = NULL;
+		count = 0;
+		updated = false;
+		cameraVersion = 0;
+		width = height = 0;
+	}
+
+	/* Build the program and the buffer, the sources are loaded via cache.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		if (!computeShaderSupported() || !glCaps()->storageBuffers)
+			return false;
+		lights = (GpuLight*)malloc(2 * sizeof(GpuLight) * LIGHT_MAX);
+		if (!lights) {
+			warn("lights: failed to allocate %d lights", LIGHT_MAX);
+			return false;
+		}
+		view = lights + LIGHT_MAX;
+		program = computeProgramBuild(cache, LIGHT_SHADER);
+		if (!program) {
+			destroy();
+			return false;
+		}
+		projectionInverseLoc = glGetUniformLocation(program, "projectionInverse");
+		viewportLoc = glGetUniformLocation(program, "viewport");
+		glGenBuffers(1, &buffer);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size(), NULL, GL_DYNAMIC_DRAW);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		GL_ERROR_DBG("lights initialization");
+		info("lights: clusters of %dx%dx%d, program %u", LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z,
+			program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (buffer)
+			glState()->deleteBuffers(1, &buffer);
+		free(lights);
+		clear();
+	}
+
+	/* the bytes of the storage block */
+	static GLsizeiptr size()
+	{
+		return sizeof(GpuLightHeader) + sizeof(GpuLight) * LIGHT_MAX + 2 * sizeof(GLuint) * LIGHT_CLUSTER_COUNT +
+			sizeof(GLuint) * LIGHT_INDEX_MAX;
+	}
+
+	/* Scatter n lights of random colors over the cube, each reaching a
+	* fifth of it. */
+	void initRandom(int n)
+	{
+		unsigned int seed = 7;
+		int i, k;
+		count = (n < LIGHT_MAX) ? n : LIGHT_MAX;
+		for (i = 0; i < count; i++) {
+			float r[6];
+			for (k = 0; k < 6; k++) {
+				seed = seed * 1664525u + 1013904223u;
+				r[k] = (float)(seed >> 8) / 16777216.0f;
+			}
+			lights[i].position = glm::vec4(2.0f * r[0] - 1.0f, 2.0f * r[1] - 1.0f, 2.0f * r[2] - 1.0f, 0.4f);
+			/* saturated, one channel is always bright */
+			glm::vec3 c(r[3], r[4], r[5]);
+			lights[i].color = glm::vec4(c / glm::max(c.x, glm::max(c.y, c.z)), 1.0f);
+		}
+		cameraVersion = 0;
+		info("lights: %d", count);
+	}
+
+	/* Assign the lights to the clusters of this frame's view: the cube
+	* of the lights is placed by modelView, which scales it by scale, the
+	* projection has the near and far planes zNear and zFar, and the target
+	* has width x height pixels. This uses its own program. The lights do
+	* not move, so as long as the version of the Camera these come from
+	* and the size stay the same, the clusters are kept as they are.
+	* Returns the number of lights the shaders should use. */
+	GLuint update(const glm::mat4 &modelView, float scale, const glm::mat4 &projection, float zNear, float zFar,
+		int width, int height, unsigned int version)
+	{
+		GpuLightHeader header;
+		int i;
+
+		updated = false;
+		if (!program || !count)
+			return 0;
+		GL_DEBUG_GROUP("light culling");
+		updated = true;
+		if (version && version == cameraVersion && width == this->width && height == this->height)
+			return (GLuint)count;
+		cameraVersion = version;
+		this->width = width;
+		this->height = height;
+		for (i = 0; i < count; i++) {
+			view[i].position = glm::vec4(glm::vec3(modelView * glm::vec4(glm::vec3(lights[i].position), 1.0f)),
+				lights[i].position.w * scale);
+			view[i].color = lights[i].color;
+		}
+		/* slice = log(depth) * scale + bias puts the near plane at 0 and
+		* the far plane at LIGHT_CLUSTERS_Z */
+		float slices = (float)LIGHT_CLUSTERS_Z / logf(zFar / zNear);
+		header.grid[0] = LIGHT_CLUSTERS_X;
+		header.grid[1] = LIGHT_CLUSTERS_Y;
+		header.grid[2] = LIGHT_CLUSTERS_Z;
+		header.grid[3] = (GLuint)count;
+		header.slices = glm::vec4(ceilf((float)width / LIGHT_CLUSTERS_X), ceilf((float)height / LIGHT_CLUSTERS_Y),
+			slices, -logf(zNear) * slices);
+		header.indexCount[0] = 0;
+		header.indexCount[1] = LIGHT_INDEX_MAX;
+		header.indexCount[2] = header.indexCount[3] = 0;
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), &header);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(header), sizeof(GpuLight) * count, view);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		glm::mat4 projectionInverse = glm::inverse(projection);
+		glState()->useProgram(program);
+		glUniformMatrix4fv(projectionInverseLoc, 1, GL_FALSE, &projectionInverse[0][0]);
+		glUniform2f(viewportLoc, (float)width, (float)height);
+		bind();
+		glDispatchCompute((LIGHT_CLUSTER_COUNT + LIGHT_CULL_GROUP - 1) / LIGHT_CULL_GROUP, 1, 1);
+		glState()->useProgram(0);
+		/* the fragment shaders read the lists written above */
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		GL_ERROR_DBG("light culling");
+		return (GLuint)count;
+	}
+
+	/* Make the lights available to the material shaders; the culling
+	* passes use the same binding for other buffers. */
+	void bind() const
+	{
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_SSBO_BINDING, buffer);
+	}
+} ClusteredLights;
+
+#endif
@@ -0,0 +1,400 @@
+#ifndef HEADER_COMMANDLIST_H
+#define HEADER_COMMANDLIST_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "Cube.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "RenderQueue.h"
+
+/****************************************************************************
+* COMMAND LISTS: draws recorded in parallel                                *
+****************************************************************************/
+
+/* A GL context only takes calls from one thread, but deciding what to
+* draw does not need it. CommandList holds the draws of one thread as a
+* stream of plain structs in linear memory: binds, uniforms and draw calls
+* with their arguments, no pointers and no GL calls. The commands are
+* grouped, each group starts with a sort key (see renderSortKey) and holds
+* the commands of one object.
+* CommandQueue has a list per worker of the job system and one for the
+* thread which runs the jobs (the render thread), so jobs record into the
+* list of the thread they run on, without any locking, each on cache lines
+* of its own. On the render
+* thread, merge() sorts the groups of all lists by key with the radix sort
+* of the render queue, and replay() issues their commands in that order.
+* The binds go through the state cache, so those which repeat from one
+* group to the next cost nothing. The same merged stream may be replayed
+* more than once per frame, e.g. for a depth pre-pass; it is only cleared
+* by begin().
+* The lists live in the arena of their thread, the merged order in the
+* frame arena (see FrameArena.h), so recording never touches the heap. A
+* list which outgrows its block moves to one twice the size; the old one
+* is only given back with the arena, at the next frame.
+* When a list is replayed inside a packet of the render queue, it must not
+* bind a program: the pre-pass draws the same list with another one. */
+#define COMMAND_LISTS (JOB_MAX_WORKERS + 1)
+#define COMMAND_LIST_BYTES 65536	/* initial size of a list, it grows as needed */
+#define COMMAND_GROUPS_MAX 65535	/* per frame, the sort orders them by an unsigned short */
+
+/* the commands */
+enum {
+	CMD_USE_PROGRAM = 0,
+	CMD_BIND_VERTEX_ARRAY,
+	CMD_BIND_TEXTURE,
+	CMD_UNIFORM_MATRIX4,
+	CMD_INSTANCE_POINTER,	/* see meshInstancePointer */
+	CMD_MATERIAL_POINTER,	/* see meshMaterialPointer */
+	CMD_DRAW_ELEMENTS
+};
+
+/* every command starts with this, size includes it */
+typedef struct {
+	GLuint type;
+	GLuint size;
+} CommandHeader;
+
+typedef struct {
+	CommandHeader h;
+	GLenum target;		/* of a texture, on unit 0 */
+	GLuint name;
+} CmdBind;
+
+typedef struct {
+	CommandHeader h;
+	GLint location;
+	GLfloat m[16];
+} CmdUniformMatrix4;
+
+typedef struct {
+	CommandHeader h;
+	GLuint vao, buffer;
+	GLintptr offset;
+} CmdPointer;
+
+typedef struct {
+	CommandHeader h;
+	GLenum mode, type;
+	GLsizei count, instances;
+	GLint baseVertex;
+	GLuint baseInstance;	/* where the instance attributes start, see GLCaps::baseInstance */
+	GLintptr offset;	/* of the first index */
+} CmdDraw;
+
+/* a group of commands: the byte range [begin, end) of a list */
+typedef struct {
+	GLuint64 key;
+	unsigned int begin, end;
+} CommandGroup;
+
+typedef struct alignas(CACHE_LINE) {
+	LinearArena *arena;	/* of the recording thread */
+	unsigned char *data;
+	size_t size, capacity;
+	CommandGroup *groups;
+	int groupCount, groupCapacity;
+	bool failed;		/* out of memory, the rest of the frame is dropped */
+
+	void clear()
+	{
+		arena = NULL;
+		data = NULL;
+		size = capacity = 0;
+		groups = NULL;
+		groupCount = groupCapacity = 0;
+		failed = false;
+	}
+
+	/* Start an empty list in a, which was just reset. */
+	void reset(LinearArena *a)
+	{
+		clear();
+		arena = a;
+	}
+
+	/* Room for a command of type with bytes in total, NULL if out of
+	* memory. The commands stay 8 byte aligned. */
+	void *append(GLuint type, size_t bytes)
+	{
+		bytes = (bytes + 7) & ~(size_t)7;
+		if (failed || !groupCount)
+			return NULL;
+		if (size + bytes > capacity) {
+			size_t c = capacity ? 2 * capacity : COMMAND_LIST_BYTES;
+			while (c < size + bytes)
+				c *= 2;
+			unsigned char *d = arena ? (unsigned char*)arena->alloc(c) : NULL;
+			if (!d) {
+				warn("command list: failed to grow to %u bytes", (unsigned)c);
+				failed = true;
+				return NULL;
+			}
+			if (size)
+				memcpy(d, data, size);
+			data = d;
+			capacity = c;
+		}
+		CommandHeader *h = (CommandHeader*)(data + size);
+		h->type = type;
+		h->size = (GLuint)bytes;
+		size += bytes;
+		groups[groupCount - 1].end = (unsigned int)size;
+		return h;
+	}
+
+	/* Start the commands of an object, ordered by key. */
+	void group(GLuint64 key)
+	{
+		if (failed)
+			return;
+		if (groupCount >= groupCapacity) {
+			int c = groupCapacity ? 2 * groupCapacity : 256;
+			CommandGroup *g = arena ? arena->allocArray<CommandGroup>(c) : NULL;
+			if (!g) {
+				warn("command list: failed to grow to %d groups", c);
+				failed = true;
+				return;
+			}
+			if (groupCount)
+				memcpy(g, groups, sizeof(CommandGroup) * groupCount);
+			groups = g;
+			groupCapacity = c;
+		}
+		CommandGroup *g = &groups[groupCount++];
+		g->key = key;
+		g->begin = g->end = (unsigned int)size;
+	}
+
+	void useProgram(GLuint program)
+	{
+		CmdBind *c = (CmdBind*)append(CMD_USE_PROGRAM, sizeof(CmdBind));
+		if (c)
+			c->name = program;
+	}
+
+	void bindVertexArray(GLuint vao)
+	{
+		CmdBind *c = (CmdBind*)append(CMD_BIND_VERTEX_ARRAY, sizeof(CmdBind));
+		if (c)
+			c->name = vao;
+	}
+
+	void bindTexture(GLenum target, GLuint texture)
+	{
+		CmdBind *c = (CmdBind*)append(CMD_BIND_TEXTURE, sizeof(CmdBind));
+		if (c) {
+			c->target = target;
+			c->name = texture;
+		}
+	}
+
+	void uniformMatrix4(GLint location, const glm::mat4 &m)
+	{
+		CmdUniformMatrix4 *c = (CmdUniformMatrix4*)append(CMD_UNIFORM_MATRIX4, sizeof(CmdUniformMatrix4));
+		if (c) {
+			c->location = location;
+			memcpy(c->m, &m[0][0], sizeof(c->m));
+		}
+	}
+
+	void instancePointer(GLuint vao, GLuint buffer, GLintptr offset)
+	{
+		CmdPointer *c = (CmdPointer*)append(CMD_INSTANCE_POINTER, sizeof(CmdPointer));
+		if (c) {
+			c->vao = vao;
+			c->buffer = buffer;
+			c->offset = offset;
+		}
+	}
+
+	void materialPointer(GLuint vao, GLuint buffer, GLintptr offset)
+	{
+		CmdPointer *c = (CmdPointer*)append(CMD_MATERIAL_POINTER, sizeof(CmdPointer));
+		if (c) {
+			c->vao = vao;
+			c->buffer = buffer;
+			c->offset = offset;
+		}
+	}
+
+	/* glDrawElementsInstancedBaseVertex, or glDrawElements for a single
+	* instance without a base vertex, or with a base instance
+	* glDrawElementsInstancedBaseVertexBaseInstance, which the context must
+	* have. */
+	void drawElements(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instances = 1,
+		GLint baseVertex = 0, GLuint baseInstance = 0)
+	{
+		CmdDraw *c = (CmdDraw*)append(CMD_DRAW_ELEMENTS, sizeof(CmdDraw));
+		if (c) {
+			c->mode = mode;
+			c->type = type;
+			c->count = count;
+			c->instances = instances;
+			c->baseVertex = baseVertex;
+			c->baseInstance = baseInstance;
+			c->offset = offset;
+		}
+	}
+} CommandList;
+
+/* Issue the commands in the byte range [begin, end) of data. */
+static void commandReplay(const unsigned char *data, unsigned int begin, unsigned int end)
+{
+	while (begin < end) {
+		const CommandHeader *h = (const CommandHeader*)(data + begin);
+		switch (h->type) {
+			case CMD_USE_PROGRAM:
+				glState()->useProgram(((const CmdBind*)h)->name);
+				break;
+			case CMD_BIND_VERTEX_ARRAY:
+				glState()->bindVertexArray(((const CmdBind*)h)->name);
+				break;
+			case CMD_BIND_TEXTURE:
+				glState()->activeTexture(GL_TEXTURE0);
+				glState()->bindTexture(((const CmdBind*)h)->target, ((const CmdBind*)h)->name);
+				break;
+			case CMD_UNIFORM_MATRIX4: {
+				const CmdUniformMatrix4 *c = (const CmdUniformMatrix4*)h;
+				glUniformMatrix4fv(c->location, 1, GL_FALSE, c->m);
+				break;
+			}
+			case CMD_INSTANCE_POINTER: {
+				const CmdPointer *c = (const CmdPointer*)h;
+				meshInstancePointer(c->vao, c->buffer, c->offset);
+				break;
+			}
+			case CMD_MATERIAL_POINTER: {
+				const CmdPointer *c = (const CmdPointer*)h;
+				meshMaterialPointer(c->vao, c->buffer, c->offset);
+				break;
+			}
+			case CMD_DRAW_ELEMENTS: {
+				const CmdDraw *c = (const CmdDraw*)h;
+				if (c->baseInstance)
+					glDrawElementsInstancedBaseVertexBaseInstance(c->mode, c->count, c->type,
+						BUFFER_OFFSET(c->offset), c->instances, c->baseVertex, c->baseInstance);
+				else if (c->instances == 1 && !c->baseVertex)
+					glDrawElements(c->mode, c->count, c->type, BUFFER_OFFSET(c->offset));
+				else
+					glDrawElementsInstancedBaseVertex(c->mode, c->count, c->type, BUFFER_OFFSET(c->offset),
+						c->instances, c->baseVertex);
+				glState()->countDraw();
+				break;
+			}
+		}
+		begin += h->size;
+	}
+}
+
+typedef struct {
+	CommandList lists[COMMAND_LISTS];
+	/* the merged groups of all lists, sorted by merge() */
+	GLuint64 *keys, *tmpKeys;
+	unsigned short *order, *tmpOrder;
+	const CommandList **groupList;	/* the list of each merged group */
+	const CommandGroup **groups;
+	int count;
+	bool merged;
+
+	void clear()
+	{
+		int i;
+		for (i = 0; i < COMMAND_LISTS; i++)
+			lists[i].clear();
+		keys = tmpKeys = NULL;
+		order = tmpOrder = NULL;
+		groupList = NULL;
+		groups = NULL;
+		count = 0;
+		merged = false;
+	}
+
+	void destroy()
+	{
+		clear();
+	}
+
+	/* Start recording a new frame, after FrameArenas::beginFrame(). No
+	* jobs may be recording. */
+	void begin()
+	{
+		int i;
+		for (i = 0; i < COMMAND_LISTS; i++)
+			lists[i].reset(&frameArenas()->threads[i]);
+		count = 0;
+		merged = false;
+	}
+
+	/* The list of the calling thread, a worker of the job system or the
+	* one thread which is none. */
+	CommandList *list()
+	{
+		return &lists[jobWorkerIndex() + 1];
+	}
+
+	/* Room for n merged groups in the frame arena. */
+	bool reserve(int n)
+	{
+		LinearArena *a = frameArenas()->current();
+		if (!n)
+			n = 1;
+		keys = a->allocArray<GLuint64>(n);
+		tmpKeys = a->allocArray<GLuint64>(n);
+		order = a->allocArray<unsigned short>(n);
+		tmpOrder = a->allocArray<unsigned short>(n);
+		groupList = a->allocArray<const CommandList*>(n);
+		groups = a->allocArray<const CommandGroup*>(n);
+		if (!keys || !tmpKeys || !order || !tmpOrder || !groupList || !groups) {
+			warn("command queue: no room for %d groups in the frame arena", n);
+			return false;
+		}
+		return true;
+	}
+
+	/* Sort the groups of all lists by their keys. Call this on the render
+	* thread once all jobs recording this frame are done. */
+	void merge()
+	{
+		int i, j, n = 0;
+
+		for (i = 0; i < COMMAND_LISTS; i++)
+			n += lists[i].groupCount;
+		if (n > COMMAND_GROUPS_MAX) {
+			warn("command queue: more than %d groups, dropping the rest", COMMAND_GROUPS_MAX);
+			n = COMMAND_GROUPS_MAX;
+		}
+		count = 0;
+		if (reserve(n)) {
+			for (i = 0; i < COMMAND_LISTS; i++) {
+				const CommandList *l = &lists[i];
+				for (j = 0; j < l->groupCount && count < n; j++) {
+					keys[count] = l->groups[j].key;
+					order[count] = (unsigned short)count;
+					groupList[count] = l;
+					groups[count] = &l->groups[j];
+					count++;
+				}
+			}
+			radixSort(keys, order, tmpKeys, tmpOrder, count);
+		}
+		merged = true;
+	}
+
+	/* Issue the merged commands in the order of their keys, merging them
+	* first if that did not happen yet. */
+	void replay()
+	{
+		int i;
+		if (!merged)
+			merge();
+		for (i = 0; i < count; i++) {
+			const CommandGroup *g = groups[order[i]];
+			commandReplay(groupList[order[i]]->data, g->begin, g->end);
+		}
+	}
+} CommandQueue;
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef HEADER_CPUTOPOLOGY_H
+#define HEADER_CPUTOPOLOGY_H
+
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define CPU_TOPOLOGY_LINUX
+#endif
+#include "Log.h"
+
+/****************************************************************************
+* CPU TOPOLOGY: where the threads run                                      *
+****************************************************************************/
+
+/* CpuTopology: which logical CPUs are threads of the same core (SMT) and
+* which NUMA node each belongs to, from sysfs on Linux and from
+* GetLogicalProcessorInformation on Windows (the first 64 CPUs). Threads
+* which the scheduler moves around lose their caches, and on a machine of
+* several sockets their memory may end up on the other node. With
+* --pin-threads the threads are placed instead:
+* - the thread which draws (the main thread, or the render thread if there
+*   is one) gets the first core of node 0 to itself, with a raised priority
+*   where the system allows it (Windows, or Linux with CAP_SYS_NICE),
+* - the main thread, while a render thread draws, runs anywhere on node 0,
+* - the workers of the job system take one CPU each, in order: the first
+*   threads of the cores of node 0, of node 1, ..., then the SMT siblings
+*   of node 0, of node 1, ..., so two workers only share a core when all
+*   cores have one. Idle workers steal from the workers of their own node
+*   first (JobSystem::take), and each worker writes its frame arena first,
+*   so the kernel puts those pages on its node (FrameArena.h).
+* Without the option, or where nothing is known, nothing is pinned. */
+#define CPU_TOPOLOGY_MAX_CPUS 256
+#define CPU_TOPOLOGY_MAX_NODES 16
+
+typedef struct {
+	bool online;
+	int node;		/* NUMA node, 0 without NUMA */
+	int core;		/* index of its core over all packages */
+	int smt;		/* 0 for the first thread of its core, 1, ... for its siblings */
+} CpuTopologyCpu;
+
+typedef struct {
+	bool enabled;		/* --pin-threads */
+	bool detected;
+	int cpuCount;		/* online */
+	int coreCount, nodeCount;
+	CpuTopologyCpu cpus[CPU_TOPOLOGY_MAX_CPUS];	/* by the number of the system */
+	int order[CPU_TOPOLOGY_MAX_CPUS];	/* the online CPUs in the order they are handed out */
+
+#ifdef CPU_TOPOLOGY_LINUX
+	static bool readInt(const char *path, int *value)
+	{
+		FILE *f = fopen(path, "r");
+		if (!f)
+			return false;
+		bool ok = fscanf(f, "%d", value) == 1;
+		fclose(f);
+		return ok;
+	}
+#endif
+
+	/* Find the cores and nodes of the online CPUs.
+	* Returns true if successfull and false if nothing is known. */
+	bool detect()
+	{
+		int packages[CPU_TOPOLOGY_MAX_CPUS], coreIds[CPU_TOPOLOGY_MAX_CPUS];
+		int i, j, k;
+
+		memset(cpus, 0, sizeof(cpus));
+		cpuCount = coreCount = 0;
+		nodeCount = 1;
+#ifdef CPU_TOPOLOGY_LINUX
+		char path[128];
+		for (i = 0; i < CPU_TOPOLOGY_MAX_CPUS; i++) {
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", i);
+			if (!readInt(path, &coreIds[i]))
+				continue;
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", i);
+			if (!readInt(path, &packages[i]))
+				packages[i] = 0;
+			cpus[i].online = true;
+			for (k = 0; k < CPU_TOPOLOGY_MAX_NODES; k++) {
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", i, k);
+				if (access(path, F_OK) == 0) {
+					cpus[i].node = k;
+					break;
+				}
+			}
+		}
+#elif defined(_WIN32)
+		SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+		DWORD bytes = sizeof(info);
+		if (!GetLogicalProcessorInformation(info, &bytes))
+			return false;
+		int core = 0;
+		for (j = 0; j < (int)(bytes / sizeof(info[0])); j++) {
+			ULONG_PTR mask = info[j].ProcessorMask;
+			for (i = 0; i < (int)sizeof(mask) * 8 && i < CPU_TOPOLOGY_MAX_CPUS; i++) {
+				if (!(mask & ((ULONG_PTR)1 << i)))
+					continue;
+				if (info[j].Relationship == RelationProcessorCore) {
+					cpus[i].online = true;
+					coreIds[i] = core;
+					packages[i] = 0;
+				} else if (info[j].Relationship == RelationNumaNode) {
+					cpus[i].node = (int)info[j].NumaNode.NodeNumber;
+				}
+			}
+			if (info[j].Relationship == RelationProcessorCore)
+				core++;
+		}
+#else
+		return false;
+#endif
+		/* number the cores and the threads of each */
+		for (i = 0; i < CPU_TOPOLOGY_MAX_CPUS; i++) {
+			if (!cpus[i].online)
+				continue;
+			cpuCount++;
+			if (cpus[i].node >= nodeCount)
+				nodeCount = cpus[i].node + 1;
+			cpus[i].core = -1;
+			for (j = 0; j < i; j++)
+				if (cpus[j].online && packages[j] == packages[i] && coreIds[j] == coreIds[i]) {
+					cpus[i].core = cpus[j].core;
+					cpus[i].smt++;
+				}
+			if (cpus[i].core < 0)
+				cpus[i].core = coreCount++;
+		}
+		if (!cpuCount)
+			return false;
+		/* by the thread of the core, then by node, then by number */
+		k = 0;
+		for (int smt = 0; k < cpuCount; smt++)
+			for (j = 0; j < nodeCount; j++)
+				for (i = 0; i < CPU_TOPOLOGY_MAX_CPUS; i++)
+					if (cpus[i].online && cpus[i].smt == smt && cpus[i].node == j)
+						order[k++] = i;
+		detected = true;
+		info("CPU topology: %d CPUs, %d cores, %d NUMA nodes", cpuCount, coreCount, nodeCount);
+		return true;
+	}
+
+	/* The CPU of the drawing thread, -1 if the threads are not placed. */
+	int drawingCpu() const
+	{
+		return (enabled && detected) ? order[0] : -1;
+	}
+
+	/* The CPU of worker index of the job system, -1 if the threads are not
+	* placed. The drawing thread's core is left out while there are others. */
+	int workerCpu(int index) const
+	{
+		if (!enabled || !detected)
+			return -1;
+		if (cpuCount == 1)
+			return order[0];
+		return order[1 + index % (cpuCount - 1)];
+	}
+
+	/* The NUMA node of cpu, 0 if it is unknown. */
+	int node(int cpu) const
+	{
+		return (cpu >= 0 && cpu < CPU_TOPOLOGY_MAX_CPUS) ? cpus[cpu].node : 0;
+	}
+
+	/* Let the calling thread run only on the CPUs of mask, by the number
+	* of the system.
+	* Returns true if successfull. */
+	bool pin(const bool *mask) const
+	{
+		int i;
+#ifdef CPU_TOPOLOGY_LINUX
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (i = 0; i < CPU_TOPOLOGY_MAX_CPUS && i < CPU_SETSIZE; i++)
+			if (mask[i])
+				CPU_SET(i, &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+		DWORD_PTR bits = 0;
+		for (i = 0; i < (int)sizeof(bits) * 8; i++)
+			if (mask[i])
+				bits |= (DWORD_PTR)1 << i;
+		return bits && SetThreadAffinityMask(GetCurrentThread(), bits) != 0;
+#else
+		(void)mask;
+		(void)i;
+		return false;
+#endif
+	}
+
+	/* Pin the calling thread to cpu. */
+	bool pinCpu(int cpu) const
+	{
+		bool mask[CPU_TOPOLOGY_MAX_CPUS] = { false };
+		if (cpu < 0 || cpu >= CPU_TOPOLOGY_MAX_CPUS)
+			return false;
+		mask[cpu] = true;
+		return pin(mask);
+	}
+
+	/* Pin the calling thread to the CPUs of node. */
+	bool pinNode(int n) const
+	{
+		bool mask[CPU_TOPOLOGY_MAX_CPUS];
+		int i;
+		for (i = 0; i < CPU_TOPOLOGY_MAX_CPUS; i++)
+			mask[i] = cpus[i].online && cpus[i].node == n;
+		return pin(mask);
+	}
+
+	/* Raise the priority of the calling thread above the others.
+	* Returns false if the system did not allow it. */
+	static bool raisePriority()
+	{
+#ifdef CPU_TOPOLOGY_LINUX
+		/* a nice value of the thread alone, which needs CAP_SYS_NICE */
+		return setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), -10) == 0;
+#elif defined(_WIN32)
+		return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST) != 0;
+#else
+		return false;
+#endif
+	}
+
+	/* Give the calling thread the normal priority again. */
+	static void normalPriority()
+	{
+#ifdef CPU_TOPOLOGY_LINUX
+		setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 0);
+#elif defined(_WIN32)
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+#endif
+	}
+
+	/* Place the calling thread as the one which draws, name is for the
+	* log. */
+	void placeDrawingThread(const char *name) const
+	{
+		int cpu = drawingCpu();
+		if (cpu < 0)
+			return;
+		if (!pinCpu(cpu))
+			warn("CPU topology: failed to pin the %s thread to CPU %d", name, cpu);
+		else if (!raisePriority())
+			info("CPU topology: %s thread on CPU %d, no permission to raise its priority", name, cpu);
+		else
+			info("CPU topology: %s thread on CPU %d, with a raised priority", name, cpu);
+	}
+
+	/* Let the calling thread, which no longer draws, run anywhere on the
+	* node of the drawing thread. */
+	void placeMainThread() const
+	{
+		int cpu = drawingCpu();
+		if (cpu < 0)
+			return;
+		if (!pinNode(node(cpu)))
+			warn("CPU topology: failed to pin the main thread to node %d", node(cpu));
+		normalPriority();
+	}
+} CpuTopology;
+
+/* The topology of the machine, shared by all translation units like
+* largePages(). */
+inline CpuTopology *cpuTopology()
+{
+	/* zero-initialized, as a static */
+	static CpuTopology topology;
+	return &topology;
+}
+
+#endif
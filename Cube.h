@@ -2,10 +2,18 @@
 #define HEADER_CUBE_H
 
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/wide_packing.hpp>
 #include <glad/glad.h>
 #include "ShaderHelpers.h"
+#include "BufferPool.h"
+#include "GLResources.h"
+#include "FrameThrottle.h"
+#include <stdlib.h>
+#include <string.h>
 
-/* We use the following layout for vertex data */
+/* We use the following layout for vertex data, i.e. how meshes are written
+ * down. The vertex buffers store it in one of the VertexLayouts below. */
 typedef struct {
 	GLfloat pos[3]; /* 3D cartesian coordinates */
 	GLubyte clr[4]; /* RGBA (8bit per channel is typically enough) */
@@ -55,58 +63,1071 @@ static const GLushort basicCubeConnectivity[] = {
 	20,21,22, 22,21,23	/* bottom */
 };
 
-/* Cube: state required for the cube. */
+/* RingBuffer: a buffer object split into RING_BUFFER_FRAMES regions which
+ * are used round-robin, one per frame, for data we re-upload every frame.
+ * If GL_ARB_buffer_storage is available, the whole buffer is mapped once
+ * (persistent and coherent) and we write directly into it. Otherwise each
+ * write maps the range unsynchronized. In both cases, a region remembers
+ * the frame which used it last, and the fence the FrameThrottle placed
+ * behind that frame guarantees that the GPU is done with it before the CPU
+ * overwrites it three frames later. With the throttle at less than three
+ * frames in flight, that never waits. */
+#define RING_BUFFER_FRAMES 3
+
+typedef struct {
+	GLuint buffer;		/* the buffer object name */
+	GLenum target;		/* the binding point used for mapping */
+	GLsizeiptr regionSize;	/* size of one per-frame region in bytes */
+	GLsizeiptr used;	/* bytes already handed out in the current region */
+	unsigned int region;	/* index of the current region */
+	GLubyte *mapped;	/* persistent mapping, NULL if not persistent */
+	unsigned long long frames[RING_BUFFER_FRAMES];	/* of the FrameThrottle, which used each region */
+	unsigned int stalls;	/* number of times we had to wait for the GPU */
+
+	/* Create the buffer with room for size bytes per frame, labeled
+	 * label for GL debuggers.
+	 * Returns true if successfull and false in case of an error. */
+	bool init(GLenum bufferTarget, GLsizeiptr size, const char *label = "ring buffer")
+	{
+		unsigned int i;
+		GLsizeiptr total;
+		MemoryScope scope(MEMORY_TRANSIENT);
+
+		target = bufferTarget;
+		regionSize = size;
+		used = 0;
+		region = 0;
+		mapped = NULL;
+		stalls = 0;
+		for (i = 0; i < RING_BUFFER_FRAMES; i++)
+			frames[i] = 0;
+
+		total = regionSize * RING_BUFFER_FRAMES;
+		glGenBuffers(1, &buffer);
+		glState()->bindBuffer(target, buffer);
+		glDebugLabel(GL_BUFFER, buffer, "%s", label);
+		if (glCaps()->bufferStorage) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(target, total, NULL, flags);
+			mapped = (GLubyte*)glMapBufferRange(target, 0, total, flags);
+			if (!mapped) {
+				warn("RingBuffer: failed to map buffer %u persistently", buffer);
+				glState()->bindBuffer(target, 0);
+				destroy();
+				return false;
+			}
+		} else {
+			glBufferData(target, total, NULL, GL_STREAM_DRAW);
+		}
+		glState()->bindBuffer(target, 0);
+		info("RingBuffer: created buffer %u with %u x %u bytes (%s)", buffer,
+			(unsigned)RING_BUFFER_FRAMES, (unsigned)regionSize,
+			mapped ? "persistent" : "unsynchronized");
+		GL_ERROR_DBG("ring buffer initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (buffer) {
+			if (mapped) {
+				glState()->bindBuffer(target, buffer);
+				glUnmapBuffer(target);
+				glState()->bindBuffer(target, 0);
+				mapped = NULL;
+			}
+			info("RingBuffer: deleting buffer %u", buffer);
+			glState()->deleteBuffers(1, &buffer);
+			buffer = 0;
+		}
+	}
+
+	/* Switch to the next region. If the GPU still uses it, this blocks
+	 * until the frame which used it last is done. */
+	void beginFrame()
+	{
+		region = (region + 1) % RING_BUFFER_FRAMES;
+		used = 0;
+		if (frameThrottle()->waitFrame(frames[region]))
+			stalls++;
+		frames[region] = 0;
+	}
+
+	/* Get a pointer to size bytes of the current region, aligned to
+	 * alignment bytes. The offset of the range relative to the start of
+	 * the buffer object is stored in offset. Call unmap when done writing.
+	 * Returns NULL if the region is exhausted. */
+	void *map(GLsizeiptr size, GLsizeiptr alignment, GLintptr *offset)
+	{
+		GLsizeiptr start = used;
+		if (alignment > 1)
+			start = (start + alignment - 1) / alignment * alignment;
+		if (start + size > regionSize) {
+			warn("RingBuffer: buffer %u: %u bytes requested but only %u left", buffer,
+				(unsigned)size, (unsigned)(regionSize - start));
+			return NULL;
+		}
+		used = start + size;
+		*offset = (GLintptr)(region * regionSize + start);
+		if (mapped)
+			return mapped + *offset;
+
+		glState()->bindBuffer(target, buffer);
+		return glMapBufferRange(target, *offset, size, GL_MAP_WRITE_BIT |
+			GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	}
+
+	/* Finish writing a range returned by map. */
+	void unmap()
+	{
+		if (!mapped) {
+			glUnmapBuffer(target);
+			glState()->bindBuffer(target, 0);
+		}
+	}
+
+	/* Mark the current region as read by the commands of this frame. */
+	void endFrame()
+	{
+		frames[region] = frameThrottle()->frame;
+	}
+} RingBuffer;
+
+/* the per-instance model matrix occupies the attribute locations
+ * CUBE_ATTRIB_INSTANCE .. CUBE_ATTRIB_INSTANCE+3 (one vec4 column each),
+ * a packed instance (see Cube::drawCompact) only the first */
+#define CUBE_ATTRIB_INSTANCE 4
+
+/* the per-instance material index, see Materials.h */
+#define MESH_ATTRIB_MATERIAL 8
+
+/* the per-instance entity id of the scene objects, see Picking.h */
+#define MESH_ATTRIB_OBJECT 9
+
+/* number of indices needed to draw the cube */
+#define CUBE_INDEX_COUNT ((GLsizei)(sizeof(basicCubeConnectivity) / sizeof(basicCubeConnectivity[0])))
+
+/* Set the instance divisor of a vertex attribute.
+ * glVertexAttribDivisor is core only since GL 3.3, so for our 3.2 context
+ * we have to fall back to GL_ARB_instanced_arrays if it is not there.
+ * Returns true if successfull and false if instancing is not supported. */
+static bool cubeAttribDivisor(GLuint index, GLuint divisor)
+{
+	if (glVertexAttribDivisor) {
+		glVertexAttribDivisor(index, divisor);
+		return true;
+	}
+	if (GLAD_GL_ARB_instanced_arrays && glVertexAttribDivisorARB) {
+		glVertexAttribDivisorARB(index, divisor);
+		return true;
+	}
+	return false;
+}
+
+/* Object creation. With direct state access (GL 4.5 or
+ * GL_ARB_direct_state_access), buffers and VAOs are created and filled by
+ * name, without binding them (and disturbing whatever is bound), and the
+ * static buffers get immutable storage, so the driver knows they never
+ * change and can place them wherever drawing from them is fastest.
+ * Otherwise we use the bind-to-edit functions of GL 3.2.
+ * A DSA VAO reads the vertices from binding point MESH_BINDING_VERTEX and
+ * the instance attributes from MESH_BINDING_INSTANCE, so moving the
+ * instance data is a single glVertexArrayVertexBuffer. */
+#define MESH_BINDING_VERTEX 0
+#define MESH_BINDING_INSTANCE 1
+#define MESH_BINDING_MATERIAL 2
+#define MESH_BINDING_OBJECT 3
+
+static bool directStateAccessSupported()
+{
+	return glCaps()->directStateAccess;
+}
+
+/* Create a buffer object with the size bytes at data, which are never
+ * changed afterwards. target is only used without DSA, for binding it.
+ * With GL_ARB_buffer_storage, the buffer gets immutable storage too.
+ * label names it for GL debuggers, by default after target.
+ * Returns the buffer name. */
+static GLuint meshBufferCreate(GLenum target, GLsizeiptr size, const void *data, const char *label = NULL)
+{
+	GLuint buffer;
+	MemoryScope scope(MEMORY_MESHES);
+	if (directStateAccessSupported()) {
+		glCreateBuffers(1, &buffer);
+		glNamedBufferStorage(buffer, size, data, 0);
+	} else {
+		glGenBuffers(1, &buffer);
+		glState()->bindBuffer(target, buffer);
+		if (glCaps()->bufferStorage)
+			glBufferStorage(target, size, data, 0);
+		else
+			glBufferData(target, size, data, GL_STATIC_DRAW);
+		glState()->bindBuffer(target, 0);
+	}
+	if (!label) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: label = "mesh vertices"; break;
+		case GL_ELEMENT_ARRAY_BUFFER: label = "mesh indices"; break;
+		case GL_DRAW_INDIRECT_BUFFER: label = "mesh draw commands"; break;
+		case GL_SHADER_STORAGE_BUFFER: label = "mesh storage"; break;
+		default: label = "mesh buffer";
+		}
+	}
+	glDebugLabel(GL_BUFFER, buffer, "%s", label);
+	return buffer;
+}
+
+/* Like meshBufferCreate, but an identical buffer still alive in
+ * glResources() is shared instead of uploaded again.
+ * Returns a handle to the buffer, release it there. */
+static BufferHandle meshBufferShared(GLenum target, GLsizeiptr size, const void *data, const char *label = NULL)
+{
+	GLuint64 hash = glResourceHash(data, (size_t)size);
+	BufferHandle h = glResources()->findBuffer(hash, size);
+	if (!h.id)
+		h = glResources()->adoptBuffer(meshBufferCreate(target, size, data, label), hash, size);
+	return h;
+}
+
+/* Vertex formats. The float format stores Vertex as it is. The packed
+ * format adds a normal and texture coordinates, derived from the faces of
+ * the mesh, but still takes just 20 bytes instead of the 36 their floats
+ * would: the position as four half floats, the normal as signed normalized
+ * 10_10_10_2 and the texture coordinates as two half floats, packed with
+ * glm/gtc/packing.hpp, and the color as RGBA8. It needs
+ * GL_INT_2_10_10_10_REV, core only since GL 3.3.
+ * A VertexLayout describes where the attributes of a format are, and
+ * meshVertexArrayCreate sets up the attribute pointers from it. The
+ * attribute locations are the ones programSetupLinked binds. */
+enum {
+	VERTEX_FORMAT_FLOAT = 0,
+	VERTEX_FORMAT_PACKED,
+	VERTEX_FORMAT_COUNT
+};
+
+#define VERTEX_ATTRIB_POS 0	/* "pos" */
+#define VERTEX_ATTRIB_NRM 1	/* "nrm" */
+#define VERTEX_ATTRIB_CLR 2	/* "clr" */
+#define VERTEX_ATTRIB_TEX 3	/* "tex" */
+#define VERTEX_LAYOUT_MAX_ATTRIBS 4
+
+/* the packed format */
+typedef struct {
+	GLushort pos[4];	/* packHalf4x16(x, y, z, 1) */
+	GLuint nrm;		/* packSnorm3x10_1x2(x, y, z, 0) */
+	GLuint tex;		/* packHalf2x16(u, v) */
+	GLubyte clr[4];
+} PackedVertex;
+
+typedef struct {
+	GLuint location;
+	GLint size;		/* components */
+	GLenum type;
+	GLboolean normalized;
+	GLuint offset;		/* in the vertex */
+} VertexAttribDesc;
+
+typedef struct {
+	const char *name;
+	GLsizei stride;		/* bytes per vertex */
+	int attribCount;
+	VertexAttribDesc attribs[VERTEX_LAYOUT_MAX_ATTRIBS];
+} VertexLayout;
+
+static const VertexLayout vertexLayouts[VERTEX_FORMAT_COUNT] = {
+	{ "float", sizeof(Vertex), 2, {
+		{ VERTEX_ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, pos) },
+		{ VERTEX_ATTRIB_CLR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Vertex, clr) } } },
+	{ "packed", sizeof(PackedVertex), 4, {
+		{ VERTEX_ATTRIB_POS, 4, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, pos) },
+		{ VERTEX_ATTRIB_NRM, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, nrm) },
+		{ VERTEX_ATTRIB_TEX, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, tex) },
+		{ VERTEX_ATTRIB_CLR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(PackedVertex, clr) } } }
+};
+
+/* Returns true if the context can read vertex format. */
+static bool vertexFormatSupported(int format)
+{
+	if (format == VERTEX_FORMAT_PACKED)
+		return glCaps()->packedVertices;
+	return format == VERTEX_FORMAT_FLOAT;
+}
+
+/* Store the count vertices v of a mesh in layout at dst, which has room
+ * for count * layout->stride bytes. The normals and texture coordinates of
+ * the packed format are derived from the indexCount indices idx of the
+ * mesh: each vertex gets the normalized sum of the normals of its
+ * triangles, flat for meshes whose faces do not share vertices, and the
+ * position projected along the largest component of the normal, as
+ * materialTexCoord in shaders/material.glsl does. */
+static void vertexLayoutFill(const VertexLayout *layout, const Vertex *v, GLsizei count,
+	const GLushort *idx, GLsizei indexCount, void *dst)
+{
+	GLsizei i;
+
+	if (layout == &vertexLayouts[VERTEX_FORMAT_FLOAT]) {
+		memcpy(dst, v, sizeof(Vertex) * count);
+		return;
+	}
+	glm::vec3 *normals = (glm::vec3*)calloc(count ? count : 1, sizeof(glm::vec3));
+	if (normals) {
+		for (i = 0; i + 2 < indexCount; i += 3) {
+			const GLfloat *a = v[idx[i]].pos, *b = v[idx[i + 1]].pos, *c = v[idx[i + 2]].pos;
+			glm::vec3 n = glm::cross(glm::vec3(b[0] - a[0], b[1] - a[1], b[2] - a[2]),
+				glm::vec3(c[0] - a[0], c[1] - a[1], c[2] - a[2]));
+			normals[idx[i]] += n;
+			normals[idx[i + 1]] += n;
+			normals[idx[i + 2]] += n;
+		}
+	}
+	for (i = 0; i < count; i++) {
+		PackedVertex *p = (PackedVertex*)dst + i;
+		glm::vec3 pos(v[i].pos[0], v[i].pos[1], v[i].pos[2]);
+		glm::vec3 n = normals ? normals[i] : glm::vec3(0.0f);
+		glm::uint64 half = glm::packHalf4x16(glm::vec4(pos, 1.0f));
+		memcpy(p->pos, &half, sizeof(p->pos));
+		if (glm::dot(n, n) > 0.0f)
+			n = glm::normalize(n);
+		p->nrm = glm::packSnorm3x10_1x2(glm::vec4(n, 0.0f));
+		glm::vec3 a = glm::abs(n);
+		glm::vec2 uv = (a.x > a.y && a.x > a.z) ? glm::vec2(pos.y, pos.z) :
+			((a.y > a.z) ? glm::vec2(pos.x, pos.z) : glm::vec2(pos.x, pos.y));
+		p->tex = glm::packHalf2x16(0.5f * uv + 0.5f);
+		memcpy(p->clr, v[i].clr, sizeof(p->clr));
+	}
+	free(normals);
+}
+
+/* Point the vertex attributes in layout of vao at vertexOffset in
+ * vertexBuffer and its indices at indexBuffer. */
+static void meshVertexArrayBuffers(GLuint vao, const VertexLayout *layout, GLuint vertexBuffer, GLintptr vertexOffset,
+	GLuint indexBuffer)
+{
+	int i;
+	if (directStateAccessSupported()) {
+		glVertexArrayVertexBuffer(vao, MESH_BINDING_VERTEX, vertexBuffer, vertexOffset, layout->stride);
+		glVertexArrayElementBuffer(vao, indexBuffer);
+		return;
+	}
+
+	glState()->bindVertexArray(vao);
+	glState()->bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glState()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	for (i = 0; i < layout->attribCount; i++) {
+		const VertexAttribDesc *a = &layout->attribs[i];
+		glVertexAttribPointer(a->location, a->size, a->type, a->normalized, layout->stride,
+			BUFFER_OFFSET(vertexOffset + a->offset));
+	}
+	glState()->bindVertexArray(0);
+	glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* Create a VAO reading vertices in layout from vertexOffset in
+ * vertexBuffer and the indices from indexBuffer, labeled label (by default
+ * after the layout) for GL debuggers.
+ * Returns the VAO name. */
+static GLuint meshVertexArrayCreate(const VertexLayout *layout, GLuint vertexBuffer, GLuint indexBuffer,
+	GLintptr vertexOffset = 0, const char *label = NULL)
+{
+	GLuint vao;
+	int i;
+	if (directStateAccessSupported()) {
+		glCreateVertexArrays(1, &vao);
+		glDebugLabel(GL_VERTEX_ARRAY, vao, "%s", label ? label : layout->name);
+		for (i = 0; i < layout->attribCount; i++) {
+			const VertexAttribDesc *a = &layout->attribs[i];
+			glVertexArrayAttribFormat(vao, a->location, a->size, a->type, a->normalized, a->offset);
+			glVertexArrayAttribBinding(vao, a->location, MESH_BINDING_VERTEX);
+			glEnableVertexArrayAttrib(vao, a->location);
+		}
+		meshVertexArrayBuffers(vao, layout, vertexBuffer, vertexOffset, indexBuffer);
+		return vao;
+	}
+
+	glGenVertexArrays(1, &vao);
+	glState()->bindVertexArray(vao);
+	/* a name from glGen* is only an object once it was bound */
+	glDebugLabel(GL_VERTEX_ARRAY, vao, "%s", label ? label : layout->name);
+	for (i = 0; i < layout->attribCount; i++)
+		glEnableVertexAttribArray(layout->attribs[i].location);
+	meshVertexArrayBuffers(vao, layout, vertexBuffer, vertexOffset, indexBuffer);
+	return vao;
+}
+
+/* Point the per-instance model matrix of vao at the matrices starting at
+ * offset in buffer. Without DSA, this leaves vao bound. */
+static void meshInstancePointer(GLuint vao, GLuint buffer, GLintptr offset)
+{
+	GLuint i;
+	if (directStateAccessSupported()) {
+		glVertexArrayVertexBuffer(vao, MESH_BINDING_INSTANCE, buffer, offset, sizeof(glm::mat4));
+		return;
+	}
+	glState()->bindVertexArray(vao);
+	glState()->bindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (i = 0; i < 4; i++)
+		glVertexAttribPointer(CUBE_ATTRIB_INSTANCE + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), BUFFER_OFFSET(offset + i * sizeof(glm::vec4)));
+	glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* Add the per-instance model matrix attribute to vao, reading from buffer.
+ * A mat4 attribute is specified as four consecutive vec4 columns.
+ * Returns true if successfull and false if instancing is not supported. */
+static bool meshInstanceAttribs(GLuint vao, GLuint buffer)
+{
+	GLuint i;
+	if (directStateAccessSupported()) {
+		for (i = 0; i < 4; i++) {
+			GLuint loc = CUBE_ATTRIB_INSTANCE + i;
+			glVertexArrayAttribFormat(vao, loc, 4, GL_FLOAT, GL_FALSE, i * sizeof(glm::vec4));
+			glVertexArrayAttribBinding(vao, loc, MESH_BINDING_INSTANCE);
+			glEnableVertexArrayAttrib(vao, loc);
+		}
+		glVertexArrayBindingDivisor(vao, MESH_BINDING_INSTANCE, 1);
+		meshInstancePointer(vao, buffer, 0);
+		return true;
+	}
+
+	meshInstancePointer(vao, buffer, 0);
+	for (i = 0; i < 4; i++) {
+		GLuint loc = CUBE_ATTRIB_INSTANCE + i;
+		glEnableVertexAttribArray(loc);
+		if (!cubeAttribDivisor(loc, 1)) {
+			glState()->bindVertexArray(0);
+			return false;
+		}
+	}
+	glState()->bindVertexArray(0);
+	return true;
+}
+
+/* Point the packed instances of vao (see Cube::drawCompact) at those
+* starting at offset in buffer. Without DSA, this leaves vao bound. */
+static void meshCompactPointer(GLuint vao, GLuint buffer, GLintptr offset)
+{
+	if (directStateAccessSupported()) {
+		glVertexArrayVertexBuffer(vao, MESH_BINDING_INSTANCE, buffer, offset, sizeof(glm::u32vec3));
+		return;
+	}
+	glState()->bindVertexArray(vao);
+	glState()->bindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribIPointer(CUBE_ATTRIB_INSTANCE, 3, GL_UNSIGNED_INT, sizeof(glm::u32vec3), BUFFER_OFFSET(offset));
+	glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* Add the packed instance attribute to vao, a uvec3 read from buffer.
+* Returns true if successfull and false if instancing is not supported. */
+static bool meshCompactAttrib(GLuint vao, GLuint buffer)
+{
+	if (directStateAccessSupported()) {
+		glVertexArrayAttribIFormat(vao, CUBE_ATTRIB_INSTANCE, 3, GL_UNSIGNED_INT, 0);
+		glVertexArrayAttribBinding(vao, CUBE_ATTRIB_INSTANCE, MESH_BINDING_INSTANCE);
+		glEnableVertexArrayAttrib(vao, CUBE_ATTRIB_INSTANCE);
+		glVertexArrayBindingDivisor(vao, MESH_BINDING_INSTANCE, 1);
+		meshCompactPointer(vao, buffer, 0);
+		return true;
+	}
+
+	meshCompactPointer(vao, buffer, 0);
+	glEnableVertexAttribArray(CUBE_ATTRIB_INSTANCE);
+	bool ok = cubeAttribDivisor(CUBE_ATTRIB_INSTANCE, 1);
+	glState()->bindVertexArray(0);
+	return ok;
+}
+
+/* Point the per-instance material index of vao at the GLuint indices
+* starting at offset in buffer. Without DSA, this leaves vao bound. */
+static void meshMaterialPointer(GLuint vao, GLuint buffer, GLintptr offset)
+{
+	if (directStateAccessSupported()) {
+		glVertexArrayVertexBuffer(vao, MESH_BINDING_MATERIAL, buffer, offset, sizeof(GLuint));
+		return;
+	}
+	glState()->bindVertexArray(vao);
+	glState()->bindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribIPointer(MESH_ATTRIB_MATERIAL, 1, GL_UNSIGNED_INT, sizeof(GLuint), BUFFER_OFFSET(offset));
+	glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* Add the per-instance material index to vao, reading from buffer.
+ * Returns true if successfull and false if instancing is not supported. */
+static bool meshMaterialAttrib(GLuint vao, GLuint buffer)
+{
+	if (directStateAccessSupported()) {
+		glVertexArrayAttribIFormat(vao, MESH_ATTRIB_MATERIAL, 1, GL_UNSIGNED_INT, 0);
+		glVertexArrayAttribBinding(vao, MESH_ATTRIB_MATERIAL, MESH_BINDING_MATERIAL);
+		glEnableVertexArrayAttrib(vao, MESH_ATTRIB_MATERIAL);
+		glVertexArrayBindingDivisor(vao, MESH_BINDING_MATERIAL, 1);
+		meshMaterialPointer(vao, buffer, 0);
+		return true;
+	}
+
+	meshMaterialPointer(vao, buffer, 0);
+	glEnableVertexAttribArray(MESH_ATTRIB_MATERIAL);
+	bool ok = cubeAttribDivisor(MESH_ATTRIB_MATERIAL, 1);
+	glState()->bindVertexArray(0);
+	return ok;
+}
+
+/* Point the per-instance entity id of vao at the GLuint ids starting at
+* offset in buffer. Without DSA, this leaves vao bound. */
+static void meshObjectPointer(GLuint vao, GLuint buffer, GLintptr offset)
+{
+	if (directStateAccessSupported()) {
+		glVertexArrayVertexBuffer(vao, MESH_BINDING_OBJECT, buffer, offset, sizeof(GLuint));
+		return;
+	}
+	glState()->bindVertexArray(vao);
+	glState()->bindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribIPointer(MESH_ATTRIB_OBJECT, 1, GL_UNSIGNED_INT, sizeof(GLuint), BUFFER_OFFSET(offset));
+	glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* Add the per-instance entity id to vao, reading from buffer.
+ * Returns true if successfull and false if instancing is not supported. */
+static bool meshObjectAttrib(GLuint vao, GLuint buffer)
+{
+	if (directStateAccessSupported()) {
+		glVertexArrayAttribIFormat(vao, MESH_ATTRIB_OBJECT, 1, GL_UNSIGNED_INT, 0);
+		glVertexArrayAttribBinding(vao, MESH_ATTRIB_OBJECT, MESH_BINDING_OBJECT);
+		glEnableVertexArrayAttrib(vao, MESH_ATTRIB_OBJECT);
+		glVertexArrayBindingDivisor(vao, MESH_BINDING_OBJECT, 1);
+		meshObjectPointer(vao, buffer, 0);
+		return true;
+	}
+
+	meshObjectPointer(vao, buffer, 0);
+	glEnableVertexAttribArray(MESH_ATTRIB_OBJECT);
+	bool ok = cubeAttribDivisor(MESH_ATTRIB_OBJECT, 1);
+	glState()->bindVertexArray(0);
+	return ok;
+}
+
+/* Disable the per-instance attribute of vao again. */
+static void meshInstanceDisable(GLuint vao)
+{
+	GLuint i;
+	if (directStateAccessSupported()) {
+		for (i = 0; i < 4; i++)
+			glDisableVertexArrayAttrib(vao, CUBE_ATTRIB_INSTANCE + i);
+		return;
+	}
+	glState()->bindVertexArray(vao);
+	for (i = 0; i < 4; i++)
+		glDisableVertexAttribArray(CUBE_ATTRIB_INSTANCE + i);
+	glState()->bindVertexArray(0);
+}
+
+/* A level of detail of a mesh: a range of its index buffer, drawn with the
+ * same vertices as the others, and how far its surface is from the full
+ * mesh at most, in the units of the mesh (see MeshSimplifier.h). Level 0 is
+ * the full mesh, with an error of 0. The layout is the same in std430. */
+#define MESH_LOD_MAX 8
+
+typedef struct {
+	GLuint firstIndex;
+	GLuint indexCount;
+	GLfloat error;
+	GLuint pad;
+} MeshLod;
+
+/* The scale from the error of a level of detail at a distance of 1 to
+ * pixels of a viewport height pixels high with projection, divided by the
+ * error in pixels which is acceptable. */
+static float meshLodScale(const glm::mat4 &projection, int height, float pixelError)
+{
+	return projection[1][1] * 0.5f * (float)height / pixelError;
+}
+
+/* Select the coarsest of the count levels of detail lods whose error does
+ * not show at distance, with lodScale from meshLodScale. The errors grow
+ * from level to level. A lodScale of 0 always selects level 0. */
+static int meshLodSelect(const MeshLod *lods, int count, float distance, float lodScale)
+{
+	int i = 0;
+
+	if (lodScale <= 0.0f)
+		return 0;
+	while (i + 1 < count && lods[i + 1].error * lodScale <= distance)
+		i++;
+	return i;
+}
+
+/* The procedural animation of an instance, see Cube::drawSpinning: the
+ * xyz of position is where it is, relative to the lowest corner of
+ * BaseApplication::instanceBox, and w its phase in radians; the xyz of axis
+ * is the unit axis it spins around and w its angular velocity in radians
+ * per second. The layout is the same in std430. */
+typedef struct {
+	glm::vec4 position;
+	glm::vec4 axis;
+} CubeSpin;
+
+/* Cube: state required for the cube. It holds its buffers and VAO by the
+ * handles of glResources(), and their names for drawing. */
 typedef struct {
 	GLuint vbo[2];		/* vertex and index buffer names */
+	GLintptr vboOffset[2];	/* of the vertices and indices in them */
+	BufferHandle buffers[2];	/* of vbo, unless they are ranges of pool */
 	GLuint vao;		/* vertex array object */
+	VertexArrayHandle vertexArray;	/* of vao */
+	VertexLayout layout;	/* of the vertex buffer */
+	GLsizei vertexCount;	/* the vertex buffer has room for */
+	GLsizei indexCount;	/* of all levels of detail */
+	GLenum indexType;
+	GLfloat radius;		/* of the bounding sphere around the origin */
 	glm::mat4 model;	/* local model transformation */
+	MeshLod lods[MESH_LOD_MAX];
+	int lodCount;
+	int lod;		/* the level of detail draw() draws */
+
+	/* the vertices and indices may be ranges of a BufferPool */
+	BufferPool *pool;	/* NULL if the cube owns vbo */
+	int poolAlloc[2];	/* the handles of the vertices and indices */
+	unsigned int poolGeneration;	/* of the pool when vboOffset was set */
+
+	/* instanced mode */
+	RingBuffer instances;	/* per-instance model matrices */
+	GLsizei maxInstances;	/* capacity of one frame in instances */
+	GLsizei instanceCount;	/* number of instances written last */
+	GLintptr instanceOffset;	/* of the matrices written last in instances */
+
+	/* vertex pulling, see drawPulled */
+	bool procedural;	/* the geometry is basicCubeGeometry, which the shader can generate */
+	GLuint pullVao;		/* without any attributes, 0 if vertex pulling is off */
+
+	/* procedural animation, see drawSpinning */
+	GLuint spinBuffer;	/* a CubeSpin per instance, 0 if off */
+	GLsizei spinCount;
+
+	/* packed instances, see drawCompact */
+	GLuint compactVao;	/* the vertices and a uvec3 per instance, 0 if off */
 
 	void destroy()
 	{
-		glBindVertexArray(0);
+		destroyInstanced();
+		glState()->bindVertexArray(0);
 		if (vao) {
-			info("Cube: deleting VAO %u", vao);
-			glDeleteVertexArrays(1, &vao);
+			info("Cube: releasing VAO %u", vao);
+			glResources()->release(vertexArray);
 			vao = 0;
 		}
-		if (vbo[0] || vbo[1]) {
-			info("Cube: deleting VBOs %u %u", vbo[0], vbo[1]);
-			glDeleteBuffers(2, vbo);
-			vbo[0] = 0;
-			vbo[1] = 0;
+		if (pool) {
+			pool->release(poolAlloc[0]);
+			pool->release(poolAlloc[1]);
+			pool = NULL;
+		} else if (vbo[0] || vbo[1]) {
+			info("Cube: releasing VBOs %u %u", vbo[0], vbo[1]);
+			glResources()->release(buffers[0]);
+			glResources()->release(buffers[1]);
 		}
+		vbo[0] = 0;
+		vbo[1] = 0;
+		buffers[0].id = buffers[1].id = 0;
+		vertexArray.id = 0;
 	}
-	void initBasic()
+	/* Set up the cube with its vertices stored in vertex layout l. */
+	void initBasic(const VertexLayout *l = &vertexLayouts[VERTEX_FORMAT_FLOAT])
 	{
-		/* set up VAO and vertex and element array buffers */
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-		info("Cube: created VAO %u", vao);
-
-		glGenBuffers(2, vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(basicCubeGeometry), basicCubeGeometry, GL_STATIC_DRAW);
-		info("Cube: created VBO %u for %u bytes of vertex data", vbo[0], (unsigned)sizeof(basicCubeGeometry));
+		const GLsizei vertexCount = sizeof(basicCubeGeometry) / sizeof(Vertex);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[1]);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(basicCubeConnectivity), basicCubeConnectivity, GL_STATIC_DRAW);
-		info("Cube: created VBO %u for %u bytes of element data", vbo[1], (unsigned)sizeof(basicCubeConnectivity));
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), BUFFER_OFFSET(offsetof(Vertex, pos)));
-		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), BUFFER_OFFSET(offsetof(Vertex, clr)));
+		/* set up the vertex and element array buffers and the VAO, the
+		 * same cube in the same layout shares them */
+		GLsizeiptr size = (GLsizeiptr)l->stride * vertexCount;
+		void *data = malloc(size);
+		if (!data) {
+			warn("Cube: failed to allocate %u vertices", (unsigned)vertexCount);
+			return;
+		}
+		vertexLayoutFill(l, basicCubeGeometry, vertexCount, basicCubeConnectivity, CUBE_INDEX_COUNT, data);
+		BufferHandle vertexBuffer = meshBufferShared(GL_ARRAY_BUFFER, size, data, "cube vertices");
+		free(data);
+		info("Cube: using VBO %u for %u bytes of %s vertex data", glResources()->name(vertexBuffer),
+			(unsigned)size, l->name);
+		BufferHandle indexBuffer = meshBufferShared(GL_ELEMENT_ARRAY_BUFFER, sizeof(basicCubeConnectivity),
+			basicCubeConnectivity, "cube indices");
+		info("Cube: using VBO %u for %u bytes of element data", glResources()->name(indexBuffer),
+			(unsigned)sizeof(basicCubeConnectivity));
+		initBuffers(l, vertexBuffer, indexBuffer, CUBE_INDEX_COUNT, GL_UNSIGNED_SHORT, glm::sqrt(3.0f));
+		procedural = true;
+	}
 
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(2);
+	/* Set up the cube with another mesh: count indices of type in
+	 * indexBuffer, of triangles of the vertices in layout l in
+	 * vertexBuffer, all within radius of the origin. The cube owns the
+	 * buffers from now on. The indices are the lodTableCount levels of
+	 * detail lodTable, or a single one without a table. */
+	void initMesh(const VertexLayout *l, GLuint vertexBuffer, GLuint indexBuffer, GLsizei count, GLenum type, GLfloat r,
+		const MeshLod *lodTable = NULL, int lodTableCount = 0)
+	{
+		initBuffers(l, glResources()->adoptBuffer(vertexBuffer), glResources()->adoptBuffer(indexBuffer), count, type,
+			r, lodTable, lodTableCount);
+	}
 
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	/* The same with references to buffers of glResources(), which the cube
+	 * releases. */
+	void initBuffers(const VertexLayout *l, BufferHandle vertexBuffer, BufferHandle indexBuffer, GLsizei count,
+		GLenum type, GLfloat r, const MeshLod *lodTable = NULL, int lodTableCount = 0)
+	{
+		layout = *l;
+		procedural = false;
+		buffers[0] = vertexBuffer;
+		buffers[1] = indexBuffer;
+		vbo[0] = glResources()->name(vertexBuffer);
+		vbo[1] = glResources()->name(indexBuffer);
+		vboOffset[0] = vboOffset[1] = 0;
+		pool = NULL;
+		GLint size = 0;
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, vbo[0]);
+		glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		vertexCount = (GLsizei)(size / layout.stride);
+		indexCount = count;
+		indexType = type;
+		radius = r;
+		memset(lods, 0, sizeof(lods));
+		if (lodTable && lodTableCount > 0) {
+			lodCount = (lodTableCount < MESH_LOD_MAX) ? lodTableCount : MESH_LOD_MAX;
+			memcpy(lods, lodTable, sizeof(MeshLod) * lodCount);
+		} else {
+			lodCount = 1;
+			lods[0].indexCount = (GLuint)count;
+		}
+		lod = 0;
+		vertexArray = glResources()->adoptVertexArray(meshVertexArrayCreate(&layout, vbo[0], vbo[1], 0, "cube"));
+		vao = glResources()->name(vertexArray);
+		info("Cube: created VAO %u (%s)", vao, directStateAccessSupported() ? "direct state access" : "bind to edit");
 
 		model = glm::mat4();
 		GL_ERROR_DBG("cube initialization");
 
 	}
 
+	/* Move the vertices and indices into ranges of p, if it has room,
+	 * and release the buffers they were in. They are copied on the GPU.
+	 * Returns true if successfull and false if the cube keeps them. */
+	bool pack(BufferPool *p)
+	{
+		GLint size[2];
+		int i;
+
+		if (pool || !vbo[0] || !vbo[1])
+			return false;
+		for (i = 0; i < 2; i++) {
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, vbo[i]);
+			glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size[i]);
+			poolAlloc[i] = p->alloc(size[i], false);
+		}
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		if (!poolAlloc[0] || !poolAlloc[1]) {
+			p->release(poolAlloc[0]);
+			p->release(poolAlloc[1]);
+			return false;
+		}
+		for (i = 0; i < 2; i++)
+			p->copy(poolAlloc[i], vbo[i], 0, size[i]);
+		info("Cube: moved VBOs %u %u into the pool", vbo[0], vbo[1]);
+		glResources()->release(buffers[0]);
+		glResources()->release(buffers[1]);
+		buffers[0].id = buffers[1].id = 0;
+		pool = p;
+		poolGeneration = pool->generation - 1;
+		updatePool();
+		return true;
+	}
+
+	/* Follow the ranges in the pool after it moved them.
+	 * Returns true if they moved. */
+	bool updatePool()
+	{
+		int i;
+
+		if (!pool || poolGeneration == pool->generation)
+			return false;
+		for (i = 0; i < 2; i++) {
+			vbo[i] = pool->buffer(poolAlloc[i]);
+			vboOffset[i] = pool->offset(poolAlloc[i]);
+		}
+		meshVertexArrayBuffers(vao, &layout, vbo[0], vboOffset[0], vbo[1]);
+		if (compactVao)
+			meshVertexArrayBuffers(compactVao, &layout, vbo[0], vboOffset[0], vbo[1]);
+		poolGeneration = pool->generation;
+		return true;
+	}
+
+	/* The index of the first index in vbo[1]. */
+	GLuint indexBase() const
+	{
+		return (GLuint)(vboOffset[1] / (indexType == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort)));
+	}
+
+	/* Add the per-instance model matrix attribute to the VAO, with room
+	 * for up to count instances. Must be called after initBasic.
+	 * Returns true if successfull and false in case of an error. */
+	bool initInstanced(GLsizei count)
+	{
+		destroyInstanced();
+		if (!vao || count < 1)
+			return false;
+
+		/* the regions start where they can be bound as storage buffers,
+		 * for vertex pulling */
+		GLsizeiptr size = count * sizeof(glm::mat4);
+		GLint alignment = 0;
+		if (glCaps()->storageBuffers)
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (alignment > 1)
+			size = (size + alignment - 1) / alignment * alignment;
+		if (!instances.init(GL_ARRAY_BUFFER, size, "cube instances"))
+			return false;
+		info("Cube: using buffer %u for %u instances", instances.buffer, (unsigned)count);
+
+		/* the actual offsets are set per frame in mapInstances */
+		if (!meshInstanceAttribs(vao, instances.buffer)) {
+			warn("Cube: instanced arrays are not supported");
+			destroyInstanced();
+			return false;
+		}
+
+		maxInstances = count;
+		instanceCount = 0;
+		instanceOffset = 0;
+		GL_ERROR_DBG("cube instancing initialization");
+		return true;
+	}
+
+	/* Draw the instances with vertex pulling, see drawPulled: set up the
+	 * VAO without attributes. Must be called after initInstanced, and only
+	 * works for the cube itself, not for meshes.
+	 * Returns true if successfull and false if it is not supported. */
+	bool initPulling()
+	{
+		if (pullVao)
+			return true;
+		if (!instances.buffer || !procedural) {
+			warn("Cube: vertex pulling needs the instanced cube");
+			return false;
+		}
+		if (!glCaps()->storageBuffers) {
+			warn("Cube: vertex pulling needs storage buffers");
+			return false;
+		}
+		if (directStateAccessSupported()) {
+			glCreateVertexArrays(1, &pullVao);
+		} else {
+			glGenVertexArrays(1, &pullVao);
+			glState()->bindVertexArray(pullVao);
+			glState()->bindVertexArray(0);
+		}
+		glDebugLabel(GL_VERTEX_ARRAY, pullVao, "cube pulling");
+		info("Cube: created VAO %u without attributes for vertex pulling", pullVao);
+		return true;
+	}
+
+	/* Animate the instances on the GPU, see drawSpinning: upload the count
+	 * spins once. Must be called after initPulling.
+	 * Returns true if successfull and false in case of an error. */
+	bool initSpinning(const CubeSpin *spins, GLsizei count)
+	{
+		if (spinBuffer) {
+			glState()->deleteBuffers(1, &spinBuffer);
+			spinBuffer = 0;
+		}
+		if (!pullVao || count < 1) {
+			warn("Cube: the procedural animation needs vertex pulling");
+			return false;
+		}
+		spinBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, count * sizeof(CubeSpin), spins, "cube spins");
+		spinCount = count;
+		info("Cube: using buffer %u for the spins of %u instances", spinBuffer, (unsigned)count);
+		GL_ERROR_DBG("cube spinning initialization");
+		return true;
+	}
+
+	/* Draw the instances packed, see drawCompact: set up the VAO reading
+	 * them. Must be called after initInstanced, works for meshes as well.
+	 * Returns true if successfull and false in case of an error. */
+	bool initCompact()
+	{
+		if (compactVao)
+			return true;
+		if (!instances.buffer) {
+			warn("Cube: packed instances need the instanced cube");
+			return false;
+		}
+		compactVao = meshVertexArrayCreate(&layout, vbo[0], vbo[1], vboOffset[0], "cube compact");
+		if (!meshCompactAttrib(compactVao, instances.buffer)) {
+			glState()->deleteVertexArrays(1, &compactVao);
+			compactVao = 0;
+			return false;
+		}
+		info("Cube: created VAO %u for packed instances", compactVao);
+		return true;
+	}
+
+	/* Release the instance buffer. The VAO keeps the (now disabled)
+	 * attribute state, so the basic draw path is not affected. */
+	void destroyInstanced()
+	{
+		if (compactVao) {
+			info("Cube: deleting VAO %u", compactVao);
+			glState()->deleteVertexArrays(1, &compactVao);
+			compactVao = 0;
+		}
+		if (spinBuffer) {
+			info("Cube: deleting buffer %u", spinBuffer);
+			glState()->deleteBuffers(1, &spinBuffer);
+			spinBuffer = 0;
+			spinCount = 0;
+		}
+		if (pullVao) {
+			info("Cube: deleting VAO %u", pullVao);
+			glState()->deleteVertexArrays(1, &pullVao);
+			pullVao = 0;
+		}
+		if (instances.buffer) {
+			if (vao)
+				meshInstanceDisable(vao);
+			instances.destroy();
+		}
+		maxInstances = 0;
+		instanceCount = 0;
+	}
+
+	/* Start a new frame of instance data and get a pointer to room for
+	 * count model matrices, which the caller writes directly into the
+	 * (mapped) buffer. Call unmapInstances when done.
+	 * Returns NULL in case of an error. */
+	glm::mat4 *mapInstances(GLsizei count)
+	{
+		GLintptr offset;
+		glm::mat4 *ptr;
+
+		if (count > maxInstances)
+			count = maxInstances;
+		instances.beginFrame();
+		ptr = (glm::mat4*)instances.map(count * sizeof(glm::mat4), sizeof(glm::vec4), &offset);
+		if (!ptr) {
+			instanceCount = 0;
+			return NULL;
+		}
+		instanceCount = count;
+		instanceOffset = offset;
+
+		/* point the instance attribute to this frame's region */
+		meshInstancePointer(vao, instances.buffer, offset);
+		return ptr;
+	}
+
+	/* The same as mapInstances for count packed instances, see
+	 * drawCompact. */
+	glm::u32vec3 *mapCompactInstances(GLsizei count)
+	{
+		GLintptr offset;
+		glm::u32vec3 *ptr;
+
+		if (count > maxInstances)
+			count = maxInstances;
+		instances.beginFrame();
+		ptr = (glm::u32vec3*)instances.map(count * sizeof(glm::u32vec3), sizeof(glm::vec4), &offset);
+		if (!ptr) {
+			instanceCount = 0;
+			return NULL;
+		}
+		instanceCount = count;
+		instanceOffset = offset;
+		meshCompactPointer(compactVao, instances.buffer, offset);
+		return ptr;
+	}
+
+	/* Finish writing the instance data returned by mapInstances. */
+	void unmapInstances()
+	{
+		instances.unmap();
+	}
+
+	/* Upload the model matrices of count instances. */
+	void updateInstances(const glm::mat4 *models, GLsizei count)
+	{
+		GLsizei i;
+		glm::mat4 *dst = mapInstances(count);
+		if (dst) {
+			for (i = 0; i < instanceCount; i++)
+				dst[i] = models[i];
+			unmapInstances();
+		}
+	}
+
+	/* Draw the cube once, in its current level of detail. The VAO must be
+	 * bound. The draws of the cube take GL_PATCHES as mode for the
+	 * programs with tessellation shaders, see Tessellation.h. */
+	void draw(GLenum mode = GL_TRIANGLES)
+	{
+		const MeshLod *l = &lods[lod];
+		glDrawElements(mode, (GLsizei)l->indexCount, indexType,
+			BUFFER_OFFSET((size_t)(indexBase() + l->firstIndex) * (indexType == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort))));
+		glState()->countDraw();
+	}
+
+	/* Draw all instances written this frame with a single call. The VAO
+	 * must be bound. This may be called more than once per frame. */
+	void drawInstanced(GLenum mode = GL_TRIANGLES)
+	{
+		if (instanceCount > 0) {
+			glDrawElementsInstanced(mode, (GLsizei)lods[0].indexCount, indexType, BUFFER_OFFSET(vboOffset[1]),
+				instanceCount);
+			glState()->countDraw();
+		}
+		/* the region may only be reused once the GPU is done with it */
+		instances.endFrame();
+	}
+
+	/* Draw all instances written this frame with a single call, with
+	 * vertex pulling: nothing is fetched through the VAO, which must be
+	 * pullVao. The vertex shader (cube.vs.glsl with PULLED) makes up the
+	 * corners and colors of basicCubeGeometry from gl_VertexID, six
+	 * vertices per face, and reads the model matrix of gl_InstanceID
+	 * from the storage block "Instances", which is this frame's region
+	 * of the instance buffer. This may be called more than once per
+	 * frame. */
+	void drawPulled(GLenum mode = GL_TRIANGLES)
+	{
+		if (instanceCount > 0) {
+			glState()->bindBufferRange(GL_SHADER_STORAGE_BUFFER, CUBE_INSTANCE_SSBO_BINDING, instances.buffer,
+				instanceOffset, instanceCount * sizeof(glm::mat4));
+			glDrawArraysInstanced(mode, 0, CUBE_INDEX_COUNT, instanceCount);
+			glState()->countDraw();
+		}
+		instances.endFrame();
+	}
+
+	/* Draw all instances with vertex pulling like drawPulled, but without
+	 * anything written this frame: the storage block "Instances" is the
+	 * CubeSpin of each instance, uploaded once by initSpinning, and the
+	 * vertex shader (cube.vs.glsl with PULLED and SPINNING) turns it into
+	 * the model matrix at the time in the Frame uniforms. The VAO must be
+	 * pullVao. This may be called more than once per frame. */
+	void drawSpinning(GLenum mode = GL_TRIANGLES)
+	{
+		if (spinCount > 0) {
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, CUBE_INSTANCE_SSBO_BINDING, spinBuffer);
+			glDrawArraysInstanced(mode, 0, CUBE_INDEX_COUNT, spinCount);
+			glState()->countDraw();
+		}
+	}
+
+	/* Draw all instances written this frame by mapCompactInstances with a
+	 * single call. The VAO must be compactVao, whose instance attribute is
+	 * 12 bytes instead of the 64 of a matrix: the rotation, position and
+	 * uniform scale packed by glm::packInstances, which the vertex shader
+	 * (cube.vs.glsl with COMPACT) unpacks with the box of the positions
+	 * from BaseApplication::instanceBox, in the Frame uniforms. This may
+	 * be called more than once per frame. */
+	void drawCompact(GLenum mode = GL_TRIANGLES)
+	{
+		drawInstanced(mode);
+	}
+
 } Cube;
 
 
@@ -0,0 +1,392 @@
+#ifndef HEADER_DEBUGDRAW_H
+#define HEADER_DEBUGDRAW_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Cube.h"
+#include "GLState.h"
+#include "JobSystem.h"
+#include "LargePages.h"
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* DEBUG DRAWING: lines and points from any thread, drawn once per frame    *
+****************************************************************************/
+
+/* DebugDraw: an immediate-mode renderer for lines, boxes, spheres and
+* frusta, for showing what the culling, the lights or the shadows work
+* with. Any thread may add shapes at any time: every worker of the job
+* system, and the one thread which is none, appends to a list of its own
+* (by jobWorkerIndex() + 1, like the CommandQueue), so there is no lock.
+* Once per frame, after all jobs of the frame are done, flush() copies the
+* lists of all threads behind each other into a RingBuffer and draws them
+* with one glDrawArrays per primitive type, GL_LINES and GL_POINTS, then
+* empties the lists. The shapes are depth tested against the frame, but do
+* not write depth, and are given relative to the grid's origin, see
+* BaseApplication::gridOrigin.
+* A list which runs full drops what does not fit, and flush() reports it.
+* The shapes are only added through the DEBUG_DRAW_* macros, which compile
+* to nothing in release builds, as does DEBUG_DRAW_ENABLED, so code
+* computing what to draw under it goes as well. */
+#define DEBUG_DRAW_VS "shaders/debug_draw.vs.glsl"
+#define DEBUG_DRAW_FS "shaders/overlay.fs.glsl"
+#define DEBUG_DRAW_THREAD_VERTICES 16384	/* per thread, primitive type and frame */
+#define DEBUG_DRAW_MAX_VERTICES 65536	/* of all threads, per frame */
+#define DEBUG_DRAW_SEGMENTS 24	/* of each circle of a sphere */
+#define DEBUG_DRAW_THREADS (JOB_MAX_WORKERS + 1)
+
+/* the primitive types, drawn in this order */
+#define DEBUG_DRAW_LINES 0
+#define DEBUG_DRAW_POINTS 1
+#define DEBUG_DRAW_TYPES 2
+
+/* colors, as 0xRRGGBBAA */
+#define DEBUG_DRAW_WHITE 0xffffffffu
+#define DEBUG_DRAW_RED 0xff4040ffu
+#define DEBUG_DRAW_GREEN 0x40ff40ffu
+#define DEBUG_DRAW_BLUE 0x4080ffffu
+#define DEBUG_DRAW_YELLOW 0xffe040ffu
+
+typedef struct {
+	GLfloat x, y, z;	/* relative to the grid's origin */
+	GLubyte color[4];	/* RGBA */
+} DebugDrawVertex;
+
+/* rgba (0xRRGGBBAA) of the color c, components from 0 to 1 */
+static inline GLuint debugDrawColor(const glm::vec4 &c)
+{
+	glm::vec4 v = glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f;
+	return ((GLuint)v.r << 24) | ((GLuint)v.g << 16) | ((GLuint)v.b << 8) | (GLuint)v.a;
+}
+
+/* the 12 edges of a box, between its corners numbered by the bits x, y
+* and z, 1 for the high side */
+static const unsigned char debugDrawBoxEdges[24] = {
+	0, 1, 2, 3, 4, 5, 6, 7,	/* along x */
+	0, 2, 1, 3, 4, 6, 5, 7,	/* along y */
+	0, 4, 1, 5, 2, 6, 3, 7	/* along z */
+};
+
+/* the shapes one thread added since the last flush() */
+typedef struct alignas(CACHE_LINE) {
+	DebugDrawVertex *vertices[DEBUG_DRAW_TYPES];	/* DEBUG_DRAW_THREAD_VERTICES each */
+	int count[DEBUG_DRAW_TYPES];
+	unsigned int dropped;	/* vertices which did not fit */
+
+	/* Room for n vertices of type, NULL if they do not fit. */
+	DebugDrawVertex *add(int type, int n)
+	{
+		if (!vertices[type] || count[type] + n > DEBUG_DRAW_THREAD_VERTICES) {
+			dropped += (unsigned int)n;
+			return NULL;
+		}
+		DebugDrawVertex *v = vertices[type] + count[type];
+		count[type] += n;
+		return v;
+	}
+} DebugDrawList;
+
+typedef struct {
+	bool enabled;
+	GLuint program;		/* 0 if not available */
+	GLint viewProjectionLoc;
+	GLuint vao;		/* the layout of DebugDrawVertex in vertices */
+	RingBuffer vertices;	/* DEBUG_DRAW_MAX_VERTICES per frame */
+	DebugDrawList lists[DEBUG_DRAW_THREADS];	/* by jobWorkerIndex() + 1 */
+	int drawn[DEBUG_DRAW_TYPES];	/* vertices by the last flush() */
+	unsigned int dropped;	/* since init, of the lists and of the buffer */
+
+	void clear()
+	{
+		int i;
+		enabled = false;
+		program = vao = 0;
+		memset(&vertices, 0, sizeof(vertices));
+		memset(lists, 0, sizeof(lists));
+		for (i = 0; i < DEBUG_DRAW_TYPES; i++)
+			drawn[i] = 0;
+		dropped = 0;
+	}
+
+	/* Build the program, the vertex buffer and the lists of the threads,
+	* sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		int i, t;
+
+		clear();
+		program = programBuild(cache, DEBUG_DRAW_VS, DEBUG_DRAW_FS);
+		if (!program)
+			return false;
+		viewProjectionLoc = glGetUniformLocation(program, "debugViewProjection");
+		for (i = 0; i < DEBUG_DRAW_THREADS; i++)
+			for (t = 0; t < DEBUG_DRAW_TYPES; t++) {
+				lists[i].vertices[t] = (DebugDrawVertex*)malloc(sizeof(DebugDrawVertex) * DEBUG_DRAW_THREAD_VERTICES);
+				if (!lists[i].vertices[t]) {
+					warn("debug draw: failed to allocate the lists");
+					destroy();
+					return false;
+				}
+			}
+		if (!vertices.init(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(DebugDrawVertex) * DEBUG_DRAW_MAX_VERTICES),
+			"debug draw vertices")) {
+			warn("debug draw: failed to create the vertices");
+			destroy();
+			return false;
+		}
+		/* at the start of the buffer, flush() picks the region by the
+		* first vertex */
+		glGenVertexArrays(1, &vao);
+		glState()->bindVertexArray(vao);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugDrawVertex), BUFFER_OFFSET(0));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugDrawVertex),
+			BUFFER_OFFSET(offsetof(DebugDrawVertex, color)));
+		glState()->bindVertexArray(0);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+		glDebugLabel(GL_VERTEX_ARRAY, vao, "debug draw");
+		info("debug draw: program %u, %d threads of %d vertices", program, DEBUG_DRAW_THREADS,
+			DEBUG_DRAW_THREAD_VERTICES);
+		return true;
+	}
+
+	void destroy()
+	{
+		int i, t;
+		if (dropped)
+			info("debug draw: %u vertices dropped", dropped);
+		if (program)
+			glState()->deleteProgram(program);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		vertices.destroy();
+		for (i = 0; i < DEBUG_DRAW_THREADS; i++)
+			for (t = 0; t < DEBUG_DRAW_TYPES; t++)
+				free(lists[i].vertices[t]);
+		clear();
+	}
+
+	/* Draw the shapes or not, those added meanwhile are dropped. */
+	void setEnabled(bool enable)
+	{
+		enabled = enable && program;
+		reset();
+	}
+
+	/* Empty the lists of all threads. No thread may be adding. */
+	void reset()
+	{
+		int i, t;
+		for (i = 0; i < DEBUG_DRAW_THREADS; i++) {
+			for (t = 0; t < DEBUG_DRAW_TYPES; t++)
+				lists[i].count[t] = 0;
+			dropped += lists[i].dropped;
+			lists[i].dropped = 0;
+		}
+	}
+
+	/* The list of the calling thread. */
+	DebugDrawList *list()
+	{
+		return &lists[jobWorkerIndex() + 1];
+	}
+
+	static void vertex(DebugDrawVertex *v, const glm::vec3 &p, GLuint rgba)
+	{
+		v->x = p.x;
+		v->y = p.y;
+		v->z = p.z;
+		v->color[0] = (GLubyte)(rgba >> 24);
+		v->color[1] = (GLubyte)(rgba >> 16);
+		v->color[2] = (GLubyte)(rgba >> 8);
+		v->color[3] = (GLubyte)rgba;
+	}
+
+	/* Add the n lines between the corners at the pairs of indices,
+	* all of them or none. */
+	void edges(const glm::vec3 *corners, const unsigned char *pairs, int n, GLuint rgba)
+	{
+		DebugDrawVertex *v = list()->add(DEBUG_DRAW_LINES, 2 * n);
+		int i;
+		if (!v)
+			return;
+		for (i = 0; i < 2 * n; i++)
+			vertex(v + i, corners[pairs[i]], rgba);
+	}
+
+	void line(const glm::vec3 &a, const glm::vec3 &b, GLuint rgba)
+	{
+		DebugDrawVertex *v = list()->add(DEBUG_DRAW_LINES, 2);
+		if (!v)
+			return;
+		vertex(v, a, rgba);
+		vertex(v + 1, b, rgba);
+	}
+
+	void point(const glm::vec3 &p, GLuint rgba)
+	{
+		DebugDrawVertex *v = list()->add(DEBUG_DRAW_POINTS, 1);
+		if (v)
+			vertex(v, p, rgba);
+	}
+
+	/* The edges of the box from low to high. */
+	void box(const glm::vec3 &low, const glm::vec3 &high, GLuint rgba)
+	{
+		glm::vec3 corners[8];
+		int i;
+		for (i = 0; i < 8; i++)
+			corners[i] = glm::vec3((i & 1) ? high.x : low.x, (i & 2) ? high.y : low.y, (i & 4) ? high.z : low.z);
+		edges(corners, debugDrawBoxEdges, 12, rgba);
+	}
+
+	/* The circles around the axes of the sphere at center with
+	* radius. */
+	void sphere(const glm::vec3 &center, float radius, GLuint rgba)
+	{
+		DebugDrawVertex *v = list()->add(DEBUG_DRAW_LINES, 3 * 2 * DEBUG_DRAW_SEGMENTS);
+		int i, axis;
+		if (!v)
+			return;
+		for (axis = 0; axis < 3; axis++) {
+			glm::vec3 previous;
+			for (i = 0; i <= DEBUG_DRAW_SEGMENTS; i++) {
+				float a = 6.28318531f * (float)i / DEBUG_DRAW_SEGMENTS;
+				glm::vec3 p(0.0f);
+				p[(axis + 1) % 3] = radius * cosf(a);
+				p[(axis + 2) % 3] = radius * sinf(a);
+				p += center;
+				if (i) {
+					vertex(v++, previous, rgba);
+					vertex(v++, p, rgba);
+				}
+				previous = p;
+			}
+		}
+	}
+
+	/* The edges of the frustum of a view projection, given its inverse,
+	* which takes the corners of clip space back. */
+	void frustum(const glm::mat4 &inverse, GLuint rgba)
+	{
+		glm::vec3 corners[8];
+		int i;
+		for (i = 0; i < 8; i++) {
+			glm::vec4 c = inverse * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f,
+				(i & 4) ? 1.0f : -1.0f, 1.0f);
+			corners[i] = glm::vec3(c) / c.w;
+		}
+		edges(corners, debugDrawBoxEdges, 12, rgba);
+	}
+
+	/* Draw what all threads added into the bound framebuffer with
+	* viewProjection, from the grid's origin, and empty the lists. Call
+	* this on the drawing thread once the jobs of the frame are done. */
+	void flush(const glm::mat4 &viewProjection)
+	{
+		DebugDrawVertex *first, *v;
+		GLintptr offset;
+		unsigned int before = dropped;
+		int i, t, n = 0;
+
+		if (!enabled) {
+			reset();
+			return;
+		}
+		for (i = 0; i < DEBUG_DRAW_THREADS; i++)
+			for (t = 0; t < DEBUG_DRAW_TYPES; t++)
+				n += lists[i].count[t];
+		for (t = 0; t < DEBUG_DRAW_TYPES; t++)
+			drawn[t] = 0;
+		if (!n) {
+			reset();
+			return;
+		}
+		GL_DEBUG_GROUP("debug draw");
+		vertices.beginFrame();
+		if (n > DEBUG_DRAW_MAX_VERTICES) {
+			dropped += (unsigned int)(n - DEBUG_DRAW_MAX_VERTICES);
+			n = DEBUG_DRAW_MAX_VERTICES;
+		}
+		first = (DebugDrawVertex*)vertices.map((GLsizeiptr)(sizeof(DebugDrawVertex) * n),
+			sizeof(DebugDrawVertex), &offset);
+		if (!first) {
+			reset();
+			return;
+		}
+		/* the lines of all threads, then the points; the lines of a
+		* shape are whole, so only a point may be split off at the end */
+		v = first;
+		for (t = 0; t < DEBUG_DRAW_TYPES; t++)
+			for (i = 0; i < DEBUG_DRAW_THREADS; i++) {
+				int count = lists[i].count[t];
+				if (count > n - (int)(v - first))
+					count = (n - (int)(v - first)) & (t == DEBUG_DRAW_LINES ? ~1 : ~0);
+				memcpy(v, lists[i].vertices[t], sizeof(DebugDrawVertex) * count);
+				v += count;
+				drawn[t] += count;
+			}
+		vertices.unmap();
+		reset();
+		if (dropped && !before)
+			warn("debug draw: out of room, dropping shapes from now on");
+
+		glState()->enable(GL_DEPTH_TEST);
+		glState()->depthFunc(GL_LEQUAL);
+		glState()->raster(RASTER_BLEND);
+		glState()->useProgram(program);
+		glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, &viewProjection[0][0]);
+		glState()->bindVertexArray(vao);
+		GLint base = (GLint)(offset / (GLintptr)sizeof(DebugDrawVertex));
+		if (drawn[DEBUG_DRAW_LINES]) {
+			glDrawArrays(GL_LINES, base, drawn[DEBUG_DRAW_LINES]);
+			glState()->countDraw();
+		}
+		if (drawn[DEBUG_DRAW_POINTS]) {
+			/* their size comes from the vertex shader */
+			glState()->enable(GL_PROGRAM_POINT_SIZE);
+			glDrawArrays(GL_POINTS, base + drawn[DEBUG_DRAW_LINES], drawn[DEBUG_DRAW_POINTS]);
+			glState()->countDraw();
+			glState()->disable(GL_PROGRAM_POINT_SIZE);
+		}
+		glState()->raster(RASTER_DEFAULT);
+		glState()->depthFunc(GL_LESS);
+		vertices.endFrame();
+		GL_ERROR_DBG("debug draw");
+	}
+} DebugDraw;
+
+/* the one renderer, of the thread which owns the context */
+inline DebugDraw *debugDraw()
+{
+	static DebugDraw draw;
+	return &draw;
+}
+
+/* The shapes, relative to the grid's origin, in color rgba (0xRRGGBBAA).
+* In release builds, their arguments are not even evaluated. */
+#ifndef NDEBUG
+#define DEBUG_DRAW_ENABLED (debugDraw()->enabled)
+#define DEBUG_DRAW_LINE(a, b, rgba) (DEBUG_DRAW_ENABLED ? debugDraw()->line(a, b, rgba) : (void)0)
+#define DEBUG_DRAW_POINT(p, rgba) (DEBUG_DRAW_ENABLED ? debugDraw()->point(p, rgba) : (void)0)
+#define DEBUG_DRAW_BOX(low, high, rgba) (DEBUG_DRAW_ENABLED ? debugDraw()->box(low, high, rgba) : (void)0)
+#define DEBUG_DRAW_SPHERE(center, radius, rgba) \
+	(DEBUG_DRAW_ENABLED ? debugDraw()->sphere(center, radius, rgba) : (void)0)
+#define DEBUG_DRAW_FRUSTUM(inverse, rgba) (DEBUG_DRAW_ENABLED ? debugDraw()->frustum(inverse, rgba) : (void)0)
+#else
+#define DEBUG_DRAW_ENABLED false
+#define DEBUG_DRAW_LINE(a, b, rgba) ((void)0)
+#define DEBUG_DRAW_POINT(p, rgba) ((void)0)
+#define DEBUG_DRAW_BOX(low, high, rgba) ((void)0)
+#define DEBUG_DRAW_SPHERE(center, radius, rgba) ((void)0)
+#define DEBUG_DRAW_FRUSTUM(inverse, rgba) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef HEADER_DISPLACEMENT_H
+#define HEADER_DISPLACEMENT_H
+
+#include <glad/glad.h>
+#include "Cube.h"
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* DISPLACEMENT: vertices deformed once per frame by a compute pass         *
+****************************************************************************/
+
+/* Displacement: the wobble shader (shaders/cube.vs.glsl with WOBBLE) moves
+* every vertex in each pass which draws the cube, the depth pre-pass, each
+* cascade of the shadows, the main pass and the velocity of TAA, always to
+* the same place: the wobble only depends on the position in the model and
+* the time. Instead, a compute pass (shaders/displace.cs.glsl) wobbles the
+* vertices of the cube once per frame into a storage buffer, and the
+* programs here (DISPLACED instead of WOBBLE) fetch them by gl_VertexID,
+* the index of the vertex in the cube's vertex buffer. The colors still
+* come from the vertex attributes, and all instances share the positions.
+* The pass copies the vertices of the cube on the GPU when they change, in
+* either vertex format, so it works for loaded meshes as it does for the
+* cube. Like SkinnedCharacters in Skinning.h, the passes then only read
+* what the compute pass wrote.
+* There is a variant per way of drawing the instances and a depth-only one
+* for the pre-pass and the shadows, built when first used. Vertex pulling
+* makes up the vertices from gl_VertexID itself and keeps the wobble
+* shader. It needs compute shaders and storage buffers, GL 4.3. */
+#define DISPLACE_SHADER "shaders/displace.cs.glsl"
+#define DISPLACE_VS "shaders/cube.vs.glsl"
+#define DISPLACE_FS "shaders/cube.fs.glsl"
+#define DISPLACE_GROUP 64	/* local size of the compute shader */
+
+/* the programs, by the features of the cube program they match */
+#define DISPLACE_INSTANCED 1u
+#define DISPLACE_COMPACT 2u
+#define DISPLACE_DEPTH_ONLY 4u
+#define DISPLACE_VARIANTS 8
+#define DISPLACE_DEFINES 8u	/* DISPLACED, in every variant */
+
+static const char *const displaceDefines[] = { "INSTANCED", "COMPACT", "DEPTH_ONLY", "DISPLACED" };
+
+typedef struct {
+	bool enabled;
+	GLuint program;		/* the compute pass, 0 if not supported */
+	GLint countsLoc, secondsLoc;
+	ShaderSourceCache *sources;
+	GLuint programs[DISPLACE_VARIANTS];	/* 0 until first used */
+	bool failed[DISPLACE_VARIANTS];		/* do not try to build them again */
+	Cube *cube;
+	GLuint restBuffer;	/* the vertices of the cube, copied as they are */
+	GLuint positionBuffer;	/* a vec4 per vertex, displaced */
+	GLsizei capacity;	/* vertices the buffers have room for */
+	GLsizei count;		/* vertices copied */
+	GLuint restVbo;		/* where they were copied from */
+	GLintptr restOffset;
+	GLsizei restStride;
+	bool written;		/* the positions, since it was enabled */
+
+	void clear()
+	{
+		int i;
+		enabled = false;
+		program = 0;
+		sources = NULL;
+		for (i = 0; i < DISPLACE_VARIANTS; i++) {
+			programs[i] = 0;
+			failed[i] = false;
+		}
+		cube = NULL;
+		restBuffer = positionBuffer = 0;
+		capacity = count = 0;
+		restVbo = 0;
+		restOffset = 0;
+		restStride = 0;
+		written = false;
+	}
+
+	/* Whether the context can displace with the compute pass. */
+	static bool supported()
+	{
+		return computeShaderSupported() && glCaps()->storageBuffers;
+	}
+
+	/* Build the compute pass for the vertices of c, the programs are built
+	* when first used from the sources of cache.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache, Cube *c)
+	{
+		clear();
+		if (!supported())
+			return false;
+		program = computeProgramBuild(cache, DISPLACE_SHADER);
+		if (!program)
+			return false;
+		countsLoc = glGetUniformLocation(program, "counts");
+		secondsLoc = glGetUniformLocation(program, "seconds");
+		sources = cache;
+		cube = c;
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < DISPLACE_VARIANTS; i++)
+			if (programs[i])
+				glState()->deleteProgram(programs[i]);
+		if (restBuffer)
+			glState()->deleteBuffers(1, &restBuffer);
+		if (positionBuffer)
+			glState()->deleteBuffers(1, &positionBuffer);
+		if (program)
+			glState()->deleteProgram(program);
+		clear();
+	}
+
+	/* Turn the compute pass on or off.
+	* Returns false if it is not supported. */
+	bool setEnabled(bool enable)
+	{
+		if (enable && !program)
+			return false;
+		enabled = enable;
+		written = false;
+		return true;
+	}
+
+	/* Copy the vertices of the cube into restBuffer, if they are not
+	* there yet, growing the buffers as needed.
+	* Returns true if successfull and false in case of an error. */
+	bool copyVertices()
+	{
+		if (!cube->vbo[0] || cube->vertexCount <= 0)
+			return false;
+		if (restVbo == cube->vbo[0] && restOffset == cube->vboOffset[0] && restStride == cube->layout.stride &&
+			count == cube->vertexCount)
+			return true;
+		if (cube->vertexCount > capacity) {
+			if (restBuffer)
+				glState()->deleteBuffers(1, &restBuffer);
+			if (positionBuffer)
+				glState()->deleteBuffers(1, &positionBuffer);
+			/* neither layout is larger than 32 bytes per vertex */
+			restBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)cube->vertexCount * 32, NULL,
+				"displacement rest");
+			positionBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER,
+				(GLsizeiptr)cube->vertexCount * sizeof(glm::vec4), NULL, "displaced positions");
+			if (!restBuffer || !positionBuffer) {
+				capacity = 0;
+				return false;
+			}
+			capacity = cube->vertexCount;
+		}
+		GLsizeiptr size = (GLsizeiptr)cube->vertexCount * cube->layout.stride;
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, cube->vbo[0]);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, restBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, cube->vboOffset[0], 0, size);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		restVbo = cube->vbo[0];
+		restOffset = cube->vboOffset[0];
+		restStride = cube->layout.stride;
+		count = cube->vertexCount;
+		info("displacement: %d %s vertices from VBO %u", (int)count, cube->layout.name, restVbo);
+		return true;
+	}
+
+	/* Displace the vertices of the cube for time seconds, once per frame
+	* before anything draws them. */
+	void update(float seconds)
+	{
+		if (!enabled || !program)
+			return;
+		GL_DEBUG_GROUP("displacement");
+		if (!copyVertices())
+			return;
+		bool half = cube->layout.attribs[0].type == GL_HALF_FLOAT;
+		glState()->useProgram(program);
+		glUniform4ui(countsLoc, (GLuint)count, (GLuint)(restStride / 4), half ? 1u : 0u, 0u);
+		glUniform1f(secondsLoc, seconds);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, restBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, positionBuffer);
+		glDispatchCompute((GLuint)((count + DISPLACE_GROUP - 1) / DISPLACE_GROUP), 1, 1);
+		glState()->useProgram(0);
+		/* all passes read the positions written above */
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		GL_ERROR_DBG("displacement");
+		written = true;
+	}
+
+	/* Whether the passes of this frame draw the displaced vertices. */
+	bool active() const
+	{
+		return enabled && written && count == cube->vertexCount;
+	}
+
+	/* Bind the positions for the next draw. */
+	void bind() const
+	{
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, CUBE_DISPLACED_SSBO_BINDING, positionBuffer);
+	}
+
+	/* The program of variant (DISPLACE_*), built when first used.
+	* Returns 0 if it failed to build. */
+	GLuint get(unsigned int variant)
+	{
+		if (!programs[variant] && !failed[variant]) {
+			programs[variant] = programBuild(sources, DISPLACE_VS, DISPLACE_FS, displaceDefines,
+				(int)(sizeof(displaceDefines) / sizeof(displaceDefines[0])), variant | DISPLACE_DEFINES);
+			if (!programs[variant]) {
+				warn("displacement: the program for variant 0x%x failed to build", variant);
+				failed[variant] = true;
+				return 0;
+			}
+			info("displacement: program %u for variant 0x%x", programs[variant], variant);
+		}
+		return programs[variant];
+	}
+} Displacement;
+
+#endif
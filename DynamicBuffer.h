@@ -0,0 +1,242 @@
+#ifndef HEADER_DYNAMICBUFFER_H
+#define HEADER_DYNAMICBUFFER_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Profiler.h"
+#include "Cube.h"
+
+/****************************************************************************
+* DYNAMIC BUFFER: uploads of only what changed                             *
+****************************************************************************/
+
+/* DynamicBuffer: a buffer object the GPU reads from, with a copy on the
+* CPU which is written in place, and only the parts written since the last
+* flush() are uploaded. The CPU copy is split into pages of a few bytes, a
+* bit per page tells which ones were written; they are set atomically, so
+* the jobs may write different parts at the same time.
+* flush() collects the runs of dirty pages into ranges, merging runs with
+* at most DYNAMIC_BUFFER_GAP clean pages in between (copying a few clean
+* bytes along is cheaper than another copy), and more of them if there are
+* still more than DYNAMIC_BUFFER_MAX_RANGES ranges. The ranges go into a
+* RingBuffer, persistently mapped if it can be, and from there into the
+* buffer by glCopyNamedBufferSubData or glCopyBufferSubData, in order with
+* the draws before and after, so the buffer itself needs no regions per
+* frame: when only a few percent of it change, only a few percent of it
+* are uploaded, and nothing when nothing changes.
+* The buffer has immutable storage where it can, the copies are allowed
+* into that. */
+#define DYNAMIC_BUFFER_GAP 4		/* clean pages a range may span */
+#define DYNAMIC_BUFFER_MAX_RANGES 64	/* copies per flush, about */
+
+typedef struct {
+	GLintptr offset;
+	GLsizeiptr size;
+} DynamicBufferRange;
+
+typedef struct {
+	GLuint buffer;		/* the buffer object the GPU reads */
+	GLubyte *data;		/* the copy the CPU writes */
+	GLsizeiptr size;	/* of both in bytes */
+	GLsizeiptr page;	/* bytes per dirty bit */
+	int pages, words;
+	std::atomic<unsigned int> *dirty;	/* a bit per page, written since flush() */
+	DynamicBufferRange *ranges;	/* scratch of flush() */
+	RingBuffer staging;	/* what flush() uploads, a region per frame */
+	GLsizeiptr uploaded;	/* bytes, of the last flush() */
+	int copies;		/* ranges, of the last flush() */
+
+	void clear()
+	{
+		buffer = 0;
+		data = NULL;
+		size = page = 0;
+		pages = words = 0;
+		dirty = NULL;
+		ranges = NULL;
+		staging.buffer = 0;
+		uploaded = 0;
+		copies = 0;
+	}
+
+	/* Create the buffer for target with room for bytes bytes, tracked
+	* in pages of pageSize bytes, labeled label for GL debuggers. Its
+	* contents are undefined until written and flushed.
+	* Returns true if successfull and false in case of an error. */
+	bool init(GLenum target, GLsizeiptr bytes, GLsizeiptr pageSize, const char *label)
+	{
+		int i;
+
+		clear();
+		if (bytes < 1)
+			bytes = 1;
+		size = bytes;
+		page = pageSize > 0 ? pageSize : 1;
+		pages = (int)((size + page - 1) / page);
+		words = (pages + 31) / 32;
+		data = (GLubyte*)malloc(size);
+		ranges = (DynamicBufferRange*)malloc(sizeof(DynamicBufferRange) * (pages / 2 + 1));
+		dirty = new std::atomic<unsigned int>[words];
+		if (!data || !ranges) {
+			warn("DynamicBuffer: failed to allocate %u bytes (%s)", (unsigned)size, label);
+			destroy();
+			return false;
+		}
+		for (i = 0; i < words; i++)
+			dirty[i].store(0, std::memory_order_relaxed);
+		buffer = meshBufferCreate(target, size, NULL, label);
+		if (!staging.init(target, size, label)) {
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void destroy()
+	{
+		if (buffer)
+			glState()->deleteBuffers(1, &buffer);
+		if (staging.buffer)
+			staging.destroy();
+		free(data);
+		free(ranges);
+		delete[] dirty;
+		clear();
+	}
+
+	/* The CPU copy of the bytes at offset, mark what is written there with
+	* touch(). */
+	void *at(GLintptr offset) const
+	{
+		return data + offset;
+	}
+
+	/* Mark bytes bytes at offset as written. Any thread may call this. */
+	void touch(GLintptr offset, GLsizeiptr bytes)
+	{
+		int first = (int)(offset / page), last = (int)((offset + bytes - 1) / page);
+		int p;
+		for (p = first; p <= last; p++)
+			dirty[p >> 5].fetch_or(1u << (p & 31), std::memory_order_relaxed);
+	}
+
+	/* Copy bytes bytes from src to offset and mark them. Any thread may
+	* call this, for different pages. */
+	void write(GLintptr offset, const void *src, GLsizeiptr bytes)
+	{
+		memcpy(data + offset, src, bytes);
+		touch(offset, bytes);
+	}
+
+	/* Collect the runs of dirty pages, at most gap clean pages apart, into
+	* ranges and clear their bits.
+	* Returns the number of ranges. */
+	int collect(int gap)
+	{
+		int i, b, n = 0, run = -1, last = -1;
+
+		for (i = 0; i < words; i++) {
+			unsigned int bits = dirty[i].exchange(0, std::memory_order_relaxed);
+			for (b = 0; bits; b++, bits >>= 1) {
+				if (!(bits & 1u))
+					continue;
+				int p = i * 32 + b;
+				if (run >= 0 && p - last - 1 <= gap) {
+					last = p;
+					continue;
+				}
+				if (run >= 0)
+					n = addRange(n, run, last);
+				run = last = p;
+			}
+		}
+		if (run >= 0)
+			n = addRange(n, run, last);
+		return n;
+	}
+
+	int addRange(int n, int first, int last)
+	{
+		GLsizeiptr end = (GLsizeiptr)(last + 1) * page;
+		ranges[n].offset = (GLintptr)first * page;
+		ranges[n].size = (end < size ? end : size) - ranges[n].offset;
+		return n + 1;
+	}
+
+	/* Merge the n ranges which are at most gap bytes apart.
+	* Returns the number of ranges left. */
+	int merge(int n, GLsizeiptr gap)
+	{
+		int i, m = 0;
+		for (i = 1; i < n; i++) {
+			DynamicBufferRange *r = &ranges[m];
+			if (ranges[i].offset - (r->offset + r->size) <= gap)
+				r->size = ranges[i].offset + ranges[i].size - r->offset;
+			else
+				ranges[++m] = ranges[i];
+		}
+		return n ? m + 1 : 0;
+	}
+
+	/* Upload what was written since the last flush, before the draws
+	* which read it. Call once per frame, after the writes are done. */
+	void flush()
+	{
+		PROFILE_ZONE("dynamic buffer flush");
+		int i, n = collect(DYNAMIC_BUFFER_GAP);
+		GLsizeiptr gap = DYNAMIC_BUFFER_GAP * page;
+
+		while (n > DYNAMIC_BUFFER_MAX_RANGES) {
+			gap *= 2;
+			n = merge(n, gap);
+		}
+		uploaded = 0;
+		copies = n;
+		if (!n)
+			return;
+		for (i = 0; i < n; i++)
+			uploaded += ranges[i].size;
+
+		GLintptr base;
+		staging.beginFrame();
+		GLubyte *dst = (GLubyte*)staging.map(uploaded, 16, &base);
+		if (!dst) {
+			/* keep the pages for the next try */
+			for (i = 0; i < n; i++)
+				touch(ranges[i].offset, ranges[i].size);
+			uploaded = 0;
+			copies = 0;
+			return;
+		}
+		GLsizeiptr at = 0;
+		for (i = 0; i < n; i++) {
+			memcpy(dst + at, data + ranges[i].offset, ranges[i].size);
+			at += ranges[i].size;
+		}
+		staging.unmap();
+
+		bool dsa = directStateAccessSupported();
+		if (!dsa) {
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+			glState()->bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		}
+		for (i = 0, at = base; i < n; i++) {
+			if (dsa)
+				glCopyNamedBufferSubData(staging.buffer, buffer, at, ranges[i].offset, ranges[i].size);
+			else
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, at, ranges[i].offset, ranges[i].size);
+			at += ranges[i].size;
+		}
+		if (!dsa) {
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+			glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		staging.endFrame();
+		GL_ERROR_DBG("dynamic buffer flush");
+	}
+} DynamicBuffer;
+
+#endif
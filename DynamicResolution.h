@@ -0,0 +1,157 @@
+#ifndef HEADER_DYNAMICRESOLUTION_H
+#define HEADER_DYNAMICRESOLUTION_H
+
+#include <glad/glad.h>
+#include <math.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "RenderTarget.h"
+
+/****************************************************************************
+* DYNAMIC RESOLUTION                                                       *
+****************************************************************************/
+
+/* DynamicResolution: renders the frames offscreen at a fraction of the
+* window size, such that the GPU time of a frame meets targetMs on whatever
+* hardware we run on. The GPU time is what the timer queries of GpuProfiler
+* measured, and the GPU time of a frame is roughly proportional to the
+* number of pixels. So a PI controller adjusts the area relative to the
+* window, in the velocity form, which cannot wind up when the area hits its
+* limits: each result changes it by KP times the change of the relative
+* error plus KI times the error. The results lag a few frames behind, so
+* the gains are small.
+* The scale of the sides only changes in steps of DYNRES_SCALE_STEP, since
+* each change reallocates the render target and what depends on its size.
+* upscale() stretches the target to the window with bilinear filtering and
+* sharpens it again with an unsharp mask (shaders/upscale.fs.glsl), which is
+* limited to the range of the neighbouring texels so edges do not ring. */
+#define DYNRES_UPSCALE_VS "shaders/raymarch.vs.glsl"	/* a full-screen triangle */
+#define DYNRES_UPSCALE_FS "shaders/upscale.fs.glsl"
+#define DYNRES_TARGET_MS 16.6
+#define DYNRES_MIN_SCALE 0.5
+#define DYNRES_SCALE_STEP 0.05
+#define DYNRES_KP 0.1
+#define DYNRES_KI 0.02
+#define DYNRES_SHARPNESS 0.5f
+
+typedef struct {
+	bool enabled;
+	double targetMs;	/* GPU time of a frame to aim for */
+	double minScale;	/* of the sides */
+	double area;		/* relative to the window, what the controller wants */
+	double error;		/* relative error of the last result */
+	double scale;		/* of the sides the frames are rendered at */
+	GLuint program;		/* 0 if not available */
+	GLint sourceSizeLoc, sharpnessLoc;
+	GLuint vao;		/* empty, for the full-screen triangle */
+
+	void clear()
+	{
+		enabled = false;
+		targetMs = DYNRES_TARGET_MS;
+		minScale = DYNRES_MIN_SCALE;
+		area = scale = 1.0;
+		error = 0.0;
+		program = vao = 0;
+	}
+
+	/* Build the upscaling program, sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		program = programBuild(cache, DYNRES_UPSCALE_VS, DYNRES_UPSCALE_FS);
+		if (!program)
+			return false;
+		sourceSizeLoc = glGetUniformLocation(program, "sourceSize");
+		sharpnessLoc = glGetUniformLocation(program, "sharpness");
+		glState()->useProgram(program);
+		glUniform1i(glGetUniformLocation(program, "source"), 0);
+		glUniform1f(sharpnessLoc, DYNRES_SHARPNESS);
+		glState()->useProgram(0);
+		glGenVertexArrays(1, &vao);
+		info("dynamic resolution: upscaling program %u", program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		clear();
+	}
+
+	/* Start or stop scaling toward a GPU time of ms per frame, with the
+	* sides no smaller than minimum times those of the window. */
+	void setEnabled(bool enable, double ms, double minimum)
+	{
+		enabled = enable && program;
+		targetMs = ms;
+		minScale = minimum;
+		area = scale = 1.0;
+		error = 0.0;
+	}
+
+	/* Feed the GPU time of a frame in ms, negative if there is none. */
+	void update(double gpuMs)
+	{
+		if (!enabled || gpuMs <= 0.0)
+			return;
+		double e = (targetMs - gpuMs) / targetMs;
+		area += DYNRES_KP * (e - error) + DYNRES_KI * e;
+		error = e;
+		if (area < minScale * minScale)
+			area = minScale * minScale;
+		if (area > 1.0)
+			area = 1.0;
+		/* only whole steps, and only if the area is a step away */
+		double s = sqrt(area);
+		if (fabs(s - scale) >= DYNRES_SCALE_STEP || (area >= 1.0 && scale < 1.0)) {
+			scale = floor(s / DYNRES_SCALE_STEP + 0.5) * DYNRES_SCALE_STEP;
+			if (scale < minScale)
+				scale = minScale;
+			if (scale > 1.0)
+				scale = 1.0;
+			info("dynamic resolution: scale %.2f for %.2fms GPU time", scale, gpuMs);
+		}
+	}
+
+	/* The size of a side of length size at the current scale. */
+	GLsizei scaled(GLsizei size) const
+	{
+		GLsizei s = enabled ? (GLsizei)(scale * (double)size + 0.5) : size;
+		return (s < 1) ? 1 : s;
+	}
+
+	/* Stretch texture of w x h texels over the current viewport, with the
+	* depth test off. */
+	void draw(GLuint texture, GLsizei w, GLsizei h)
+	{
+		glState()->useProgram(program);
+		glUniform2f(sourceSizeLoc, (GLfloat)w, (GLfloat)h);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+	}
+
+	/* Stretch the color buffer of src over the default framebuffer of size
+	* w x h and make that the current framebuffer again. */
+	void upscale(const RenderTarget *src, GLsizei w, GLsizei h)
+	{
+		GL_DEBUG_GROUP("upscale");
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glState()->viewport(0, 0, w, h);
+		glState()->disable(GL_DEPTH_TEST);
+		glState()->raster(0);
+		draw(src->color, src->width, src->height);
+		/* the next frame clears the depth, which needs depth writes */
+		glState()->raster(RASTER_DEFAULT);
+		glState()->enable(GL_DEPTH_TEST);
+	}
+} DynamicResolution;
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef HEADER_ENTITIES_H
+#define HEADER_ENTITIES_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "JobSystem.h"
+#include "Log.h"
+
+/****************************************************************************
+* ENTITIES: components stored in archetype chunks                          *
+****************************************************************************/
+
+/* EntityStore: an entity is an id, and its data are components, plain
+* structs registered with component() which get a bit each. All entities
+* with the same set of components (the archetype) are stored together, in
+* chunks of ECS_CHUNK_BYTES: a chunk holds the ids of up to capacity
+* entities and, after them, one array per component, so a system which
+* reads two components of every entity walks through two dense arrays and
+* never touches the others, and a chunk stays in the L1 cache while it
+* does. All chunks of an archetype are full but the last: removing an
+* entity moves the last one of the archetype into its place, so rows and
+* pointers into them only remain valid until the next create(), remove()
+* or change().
+* forEach() calls a function per chunk of every archetype which has the
+* components asked for, and with a job system, the chunks are spread over
+* the workers; each call may write the rows of its chunk, but must not
+* create or remove entities.
+* An id holds the index of its entry in the table of locations and the
+* generation of that entry, so the id of a removed entity no longer
+* resolves once its entry is reused (for the next 255 times). */
+#define ECS_CHUNK_BYTES 16384
+#define ECS_MAX_COMPONENTS 32
+#define ECS_MAX_ARCHETYPES 64
+#define ECS_ALIGN 16		/* of each array in a chunk */
+#define ECS_INDEX_BITS 24	/* of an id, the rest is the generation */
+#define ECS_NO_ENTITY 0xFFFFFFFFu
+
+typedef unsigned int EntityId;
+typedef unsigned int EcsMask;	/* bit c for component c */
+
+/* The arrays of one chunk, see forEach(). array<T>(c) is NULL for the
+* components the archetype does not have. */
+typedef struct {
+	const EntityId *entities;
+	unsigned char *components[ECS_MAX_COMPONENTS];
+	int count;		/* rows */
+
+	template <typename T> T *array(int c) const
+	{
+		return (T*)components[c];
+	}
+} EcsView;
+
+typedef void (*EcsChunkFunc)(void *user, const EcsView *view);
+
+typedef struct {
+	EcsMask mask;
+	int capacity;		/* rows per chunk */
+	size_t offsets[ECS_MAX_COMPONENTS];	/* of the arrays in a chunk */
+	unsigned char **chunks;	/* the empty ones are kept for reuse */
+	int chunkCount;
+	int count;		/* rows, in chunks row / capacity */
+} EcsArchetype;
+
+/* where the entity of an entry is */
+typedef struct {
+	int archetype;		/* -1 if the entry is free */
+	int row;		/* or the next free entry, -1 if none */
+	unsigned int generation;
+} EcsLocation;
+
+/* a chunk to visit */
+typedef struct {
+	int archetype, chunk;
+} EcsChunkRef;
+
+struct EntityStore;
+
+/* The jobs of forEach(). */
+typedef struct {
+	const struct EntityStore *store;
+	EcsChunkFunc func;
+	void *user;
+} EcsVisit;
+
+typedef struct EntityStore {
+	size_t sizes[ECS_MAX_COMPONENTS];
+	int componentCount;
+	EcsArchetype archetypes[ECS_MAX_ARCHETYPES];
+	int archetypeCount;
+	EcsLocation *locations;
+	int locationCount, locationSlots;
+	int firstFree;		/* free entry, -1 if none */
+	int count;		/* entities alive */
+
+	/* the chunks of a forEach(), room for all chunks */
+	EcsChunkRef *visits;
+	int visitCount, visitSlots;
+
+	/* Reset to an empty store without any memory, destroy() then has
+	* nothing to do. */
+	void clear()
+	{
+		componentCount = archetypeCount = 0;
+		locations = NULL;
+		locationCount = locationSlots = 0;
+		firstFree = -1;
+		count = 0;
+		visits = NULL;
+		visitCount = visitSlots = 0;
+	}
+
+	void destroy()
+	{
+		int a, c;
+		for (a = 0; a < archetypeCount; a++) {
+			for (c = 0; c < archetypes[a].chunkCount; c++)
+				free(archetypes[a].chunks[c]);
+			free(archetypes[a].chunks);
+		}
+		free(locations);
+		free(visits);
+		clear();
+	}
+
+	/* Register a component of size bytes, a plain struct of at most
+	* ECS_ALIGN alignment.
+	* Returns its index, or -1 if there are ECS_MAX_COMPONENTS already. */
+	int component(size_t size)
+	{
+		if (componentCount >= ECS_MAX_COMPONENTS) {
+			warn("EntityStore: no room for another component");
+			return -1;
+		}
+		sizes[componentCount] = size;
+		return componentCount++;
+	}
+
+	/* Add an entity with the components of mask, all zero.
+	* Returns its id or ECS_NO_ENTITY in case of an error. */
+	EntityId create(EcsMask mask)
+	{
+		int a = archetype(mask);
+		int e = (a >= 0) ? allocateEntry() : -1;
+		if (e < 0)
+			return ECS_NO_ENTITY;
+		if (!appendRow(a, e)) {
+			freeEntry(e);
+			return ECS_NO_ENTITY;
+		}
+		count++;
+		return (EntityId)e | (locations[e].generation << ECS_INDEX_BITS);
+	}
+
+	/* Remove the entity id. Does nothing if it is not alive. */
+	void remove(EntityId id)
+	{
+		int e = entry(id);
+		if (e < 0)
+			return;
+		removeRow(locations[e].archetype, locations[e].row);
+		freeEntry(e);
+		count--;
+	}
+
+	bool alive(EntityId id) const
+	{
+		return entry(id) >= 0;
+	}
+
+	/* Move the entity id to the archetype of mask, with the components it
+	* keeps unchanged and those it gains zero.
+	* Returns false if id is not alive or in case of an error. */
+	bool change(EntityId id, EcsMask mask)
+	{
+		int c, e = entry(id);
+		if (e < 0)
+			return false;
+		int from = locations[e].archetype, row = locations[e].row;
+		int to = archetype(mask);
+		if (to == from)
+			return true;
+		if (to < 0 || !appendRow(to, e))
+			return false;
+		for (c = 0; c < componentCount; c++)
+			if (mask & archetypes[from].mask & (1u << c))
+				memcpy(address(to, locations[e].row, c), address(from, row, c), sizes[c]);
+		removeRow(from, row);
+		return true;
+	}
+
+	/* Component c of the entity id, NULL if it has none or is not alive. */
+	void *get(EntityId id, int c) const
+	{
+		int e = entry(id);
+		if (e < 0 || !(archetypes[locations[e].archetype].mask & (1u << c)))
+			return NULL;
+		return address(locations[e].archetype, locations[e].row, c);
+	}
+
+	template <typename T> T *get(EntityId id, int c) const
+	{
+		return (T*)get(id, c);
+	}
+
+	/* Call f(user, view) for each chunk of the entities which have all the
+	* components of mask, on jobs if it is given, grain chunks per job.
+	* Returns when all are done. Only one forEach() may run at a time. */
+	void forEach(EcsMask mask, EcsChunkFunc f, void *user, JobSystem *jobs = NULL, int grain = 1)
+	{
+		int a, c;
+		EcsVisit v;
+
+		visitCount = 0;
+		for (a = 0; a < archetypeCount; a++) {
+			const EcsArchetype *t = &archetypes[a];
+			if ((t->mask & mask) != mask)
+				continue;
+			for (c = 0; c * t->capacity < t->count; c++) {
+				visits[visitCount].archetype = a;
+				visits[visitCount].chunk = c;
+				visitCount++;
+			}
+		}
+		v.store = this;
+		v.func = f;
+		v.user = user;
+		if (jobs)
+			jobs->run(visitChunks, &v, visitCount, grain);
+		else
+			visitChunks(&v, 0, visitCount);
+	}
+
+	/* The arrays of chunk c of archetype a. */
+	void view(int a, int c, EcsView *v) const
+	{
+		int i;
+		const EcsArchetype *t = &archetypes[a];
+		unsigned char *chunk = t->chunks[c];
+		int rows = t->count - c * t->capacity;
+		v->entities = (const EntityId*)chunk;
+		v->count = (rows < t->capacity) ? rows : t->capacity;
+		for (i = 0; i < ECS_MAX_COMPONENTS; i++)
+			v->components[i] = (t->mask & (1u << i)) ? chunk + t->offsets[i] : NULL;
+	}
+
+	static void visitChunks(void *user, int begin, int end)
+	{
+		const EcsVisit *v = (const EcsVisit*)user;
+		int i;
+		EcsView view;
+		for (i = begin; i < end; i++) {
+			v->store->view(v->store->visits[i].archetype, v->store->visits[i].chunk, &view);
+			v->func(v->user, &view);
+		}
+	}
+
+	/* The archetype of mask, added if there is none yet.
+	* Returns its index or -1 in case of an error. */
+	int archetype(EcsMask mask)
+	{
+		int a, c, capacity;
+		size_t perRow = sizeof(EntityId);
+
+		for (a = 0; a < archetypeCount; a++)
+			if (archetypes[a].mask == mask)
+				return a;
+		if (archetypeCount >= ECS_MAX_ARCHETYPES || (componentCount < 32 && (mask >> componentCount))) {
+			warn("EntityStore: no room for the archetype %08x", mask);
+			return -1;
+		}
+		for (c = 0; c < componentCount; c++)
+			if (mask & (1u << c))
+				perRow += sizes[c];
+		/* as many rows as fit with the padding of the arrays */
+		for (capacity = (int)(ECS_CHUNK_BYTES / perRow); capacity > 0; capacity--)
+			if (layout(mask, capacity, NULL) <= ECS_CHUNK_BYTES)
+				break;
+		if (capacity <= 0) {
+			warn("EntityStore: the components of %08x do not fit into a chunk", mask);
+			return -1;
+		}
+		EcsArchetype *t = &archetypes[archetypeCount];
+		t->mask = mask;
+		t->capacity = capacity;
+		layout(mask, capacity, t->offsets);
+		t->chunks = NULL;
+		t->chunkCount = 0;
+		t->count = 0;
+		return archetypeCount++;
+	}
+
+	/* The size of a chunk of capacity rows of mask, and the offsets of its
+	* arrays if offsets is given. */
+	size_t layout(EcsMask mask, int capacity, size_t *offsets) const
+	{
+		int c;
+		size_t end = sizeof(EntityId) * capacity;
+		for (c = 0; c < componentCount; c++) {
+			if (!(mask & (1u << c)))
+				continue;
+			end = (end + ECS_ALIGN - 1) & ~(size_t)(ECS_ALIGN - 1);
+			if (offsets)
+				offsets[c] = end;
+			end += sizes[c] * capacity;
+		}
+		return end;
+	}
+
+	unsigned char *address(int a, int row, int c) const
+	{
+		const EcsArchetype *t = &archetypes[a];
+		return t->chunks[row / t->capacity] + t->offsets[c] + sizes[c] * (row % t->capacity);
+	}
+
+	/* The entry of id, -1 if it is not alive. */
+	int entry(EntityId id) const
+	{
+		int e = (int)(id & ((1u << ECS_INDEX_BITS) - 1));
+		if (id == ECS_NO_ENTITY || e >= locationCount || locations[e].archetype < 0 ||
+			locations[e].generation != (id >> ECS_INDEX_BITS))
+			return -1;
+		return e;
+	}
+
+	int allocateEntry()
+	{
+		int e = firstFree;
+		if (e >= 0) {
+			firstFree = locations[e].row;
+			return e;
+		}
+		if (locationCount >= (1 << ECS_INDEX_BITS) - 1) {
+			warn("EntityStore: no room for another entity");
+			return -1;
+		}
+		if (locationCount == locationSlots) {
+			int slots = locationSlots ? 2 * locationSlots : 1024;
+			EcsLocation *l = (EcsLocation*)realloc(locations, sizeof(EcsLocation) * slots);
+			if (!l) {
+				warn("EntityStore: failed to allocate %d entities", slots);
+				return -1;
+			}
+			locations = l;
+			locationSlots = slots;
+		}
+		locations[locationCount].generation = 0;
+		return locationCount++;
+	}
+
+	/* the next generation of the entry no longer resolves the old ids */
+	void freeEntry(int e)
+	{
+		locations[e].archetype = -1;
+		locations[e].row = firstFree;
+		locations[e].generation = (locations[e].generation + 1) & ((1u << (32 - ECS_INDEX_BITS)) - 1);
+		firstFree = e;
+	}
+
+	/* Append a row of zeros to archetype a for entry e.
+	* Returns false if out of memory. */
+	bool appendRow(int a, int e)
+	{
+		int c;
+		EcsArchetype *t = &archetypes[a];
+		if (t->count == t->chunkCount * t->capacity && !addChunk(t))
+			return false;
+		int row = t->count++;
+		unsigned char *chunk = t->chunks[row / t->capacity];
+		((EntityId*)chunk)[row % t->capacity] = (EntityId)e | (locations[e].generation << ECS_INDEX_BITS);
+		for (c = 0; c < componentCount; c++)
+			if (t->mask & (1u << c))
+				memset(address(a, row, c), 0, sizes[c]);
+		locations[e].archetype = a;
+		locations[e].row = row;
+		return true;
+	}
+
+	bool addChunk(EcsArchetype *t)
+	{
+		int chunks = 0, a;
+		for (a = 0; a < archetypeCount; a++)
+			chunks += archetypes[a].chunkCount;
+		unsigned char **list = (unsigned char**)realloc(t->chunks, sizeof(unsigned char*) * (t->chunkCount + 1));
+		if (list)
+			t->chunks = list;
+		unsigned char *chunk = list ? (unsigned char*)malloc(ECS_CHUNK_BYTES) : NULL;
+		if (chunk && chunks + 1 > visitSlots) {
+			EcsChunkRef *v = (EcsChunkRef*)realloc(visits, sizeof(EcsChunkRef) * 2 * (chunks + 1));
+			if (v) {
+				visits = v;
+				visitSlots = 2 * (chunks + 1);
+			} else {
+				free(chunk);
+				chunk = NULL;
+			}
+		}
+		if (!chunk) {
+			warn("EntityStore: failed to allocate a chunk");
+			return false;
+		}
+		t->chunks[t->chunkCount++] = chunk;
+		return true;
+	}
+
+	/* Remove the row of archetype a, the last row takes its place. */
+	void removeRow(int a, int row)
+	{
+		int c;
+		EcsArchetype *t = &archetypes[a];
+		int last = --t->count;
+		if (row == last)
+			return;
+		EntityId moved = ((EntityId*)t->chunks[last / t->capacity])[last % t->capacity];
+		((EntityId*)t->chunks[row / t->capacity])[row % t->capacity] = moved;
+		for (c = 0; c < componentCount; c++)
+			if (t->mask & (1u << c))
+				memcpy(address(a, row, c), address(a, last, c), sizes[c]);
+		locations[moved & ((1u << ECS_INDEX_BITS) - 1)].row = row;
+	}
+} EntityStore;
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef HEADER_FILLBENCH_H
+#define HEADER_FILLBENCH_H
+
+#include <glad/glad.h>
+#include <math.h>
+#include <stdio.h>
+#include "Benchmark.h"
+#include "DynamicResolution.h"
+#include "FrameStats.h"
+#include "Log.h"
+
+/****************************************************************************
+* FILL RATE BENCHMARK                                                      *
+****************************************************************************/
+
+/* The statistics gathered by the --bench-fill mode: every program of the
+* keyboard table renders the frame offscreen at each scale of the sides of
+* the window in fillBenchScales and each overdraw of fillBenchOverdraws
+* (see RenderQueue::overdraw), and the median GPU time of each of those
+* points is fitted with least squares to
+*     gpu ms = fixed ms + ns per pixel * pixels * overdraw / 10^6,
+* the fixed part being what does not scale with the pixels, e.g. the
+* culling, the shadow maps and the draw calls. From the fit follow the
+* pixels a program can draw once in DYNRES_TARGET_MS, the budget of the
+* dynamic resolution, and the scale of the sides of the window that comes
+* to. r2 tells how well the line fits, a program which is not bound by its
+* fragments is far from one. */
+#define FILL_BENCH_SCALES 4
+#define FILL_BENCH_OVERDRAWS 4
+#define FILL_BENCH_POINTS (FILL_BENCH_SCALES * FILL_BENCH_OVERDRAWS)
+
+static const double fillBenchScales[FILL_BENCH_SCALES] = { 0.25, 0.5, 0.75, 1.0 };
+static const int fillBenchOverdraws[FILL_BENCH_OVERDRAWS] = { 1, 2, 4, 8 };
+
+/* one point of the sweep */
+typedef struct {
+	int width, height;
+	int overdraw;
+	FrameTimeStats gpu;	/* count 0 if there were no GPU times */
+} FillSample;
+
+typedef struct {
+	int key;		/* the number key / registry index */
+	const char *vs, *fs;
+	unsigned int defines;	/* feature define mask of the permutation */
+	bool ok;		/* false if the program could not be built */
+	FillSample samples[FILL_BENCH_POINTS];
+	int count;
+	/* the fit, fitted is the number of points it has */
+	int fitted;
+	double fixedMs;
+	double nsPerPixel;	/* also ms per megapixel */
+	double r2;
+	double budgetPixels;	/* drawn once in DYNRES_TARGET_MS, -1 if unbounded */
+	double budgetScale;	/* of the sides of the window for those */
+} FillResult;
+
+typedef struct {
+	Benchmark frames;	/* the samples of the point being measured */
+	int width, height;	/* of the window, scale 1 */
+	const char *target;	/* what we rendered into */
+	FillResult results[BENCH_MAX_RESULTS];
+	int count;
+
+	bool init(int frameCount, int warmupCount, int w, int h)
+	{
+		width = w;
+		height = h;
+		target = "offscreen";
+		count = 0;
+		return frames.init(frameCount, warmupCount);
+	}
+
+	void destroy()
+	{
+		frames.destroy();
+	}
+
+	/* Start measuring a new program. Returns NULL if there is no room. */
+	FillResult *begin(int key, const char *vs, const char *fs, unsigned int defines)
+	{
+		if (count >= BENCH_MAX_RESULTS)
+			return NULL;
+		FillResult *r = &results[count++];
+		r->key = key;
+		r->vs = vs;
+		r->fs = fs;
+		r->defines = defines;
+		r->ok = false;
+		r->count = 0;
+		r->fitted = 0;
+		r->fixedMs = r->nsPerPixel = r->r2 = 0.0;
+		r->budgetPixels = r->budgetScale = -1.0;
+		return r;
+	}
+
+	/* Start measuring a point of the sweep, the frames go to
+	* frames.addGPU. */
+	void beginPoint()
+	{
+		frames.count = 0;
+		frames.begin(0, NULL, NULL, 0);
+	}
+
+	/* Record the frames since beginPoint() as the point of w x h pixels
+	* drawn overdraw times. */
+	void endPoint(FillResult *r, int w, int h, int overdraw)
+	{
+		BenchResult *b = &frames.results[0];
+		frames.end(b);
+		if (r->count >= FILL_BENCH_POINTS)
+			return;
+		FillSample *s = &r->samples[r->count++];
+		s->width = w;
+		s->height = h;
+		s->overdraw = overdraw;
+		s->gpu = b->gpu;
+	}
+
+	/* Fit the line through the medians of the points of r. */
+	void end(FillResult *r)
+	{
+		double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, syy = 0.0;
+		int i;
+
+		r->ok = true;
+		for (i = 0; i < r->count; i++) {
+			const FillSample *s = &r->samples[i];
+			if (!s->gpu.count)
+				continue;
+			/* in megapixels, so the slope is in ns per pixel */
+			double x = 1e-6 * (double)s->width * (double)s->height * (double)s->overdraw;
+			double y = s->gpu.p50;
+			n += 1.0;
+			sx += x;
+			sy += y;
+			sxx += x * x;
+			sxy += x * y;
+			syy += y * y;
+		}
+		r->fitted = (int)n;
+		double dx = n * sxx - sx * sx;
+		if (r->fitted < 2 || dx <= 0.0) {
+			warn("fill benchmark: program %d has no GPU times to fit", r->key);
+			return;
+		}
+		r->nsPerPixel = (n * sxy - sx * sy) / dx;
+		r->fixedMs = (sy - r->nsPerPixel * sx) / n;
+		double dy = n * syy - sy * sy;
+		r->r2 = (dy > 0.0) ? (n * sxy - sx * sy) * (n * sxy - sx * sy) / (dx * dy) : 1.0;
+		if (r->nsPerPixel > 0.0) {
+			r->budgetPixels = 1e6 * (DYNRES_TARGET_MS - r->fixedMs) / r->nsPerPixel;
+			if (r->budgetPixels < 0.0)
+				r->budgetPixels = 0.0;
+			r->budgetScale = sqrt(r->budgetPixels / ((double)width * (double)height));
+		}
+	}
+
+	/* Write all results to filename, or to stdout if it is NULL.
+	* Returns true if successfull. */
+	bool write(const char *filename, int format) const
+	{
+		FILE *f = filename ? fopen(filename, "wt") : stdout;
+		if (!f) {
+			warn("failed to open benchmark output '%s'", filename);
+			return false;
+		}
+		if (format == BENCH_FORMAT_CSV)
+			writeCSV(f);
+		else
+			writeJSON(f);
+		bool ok = !ferror(f);
+		if (filename) {
+			ok = (fclose(f) == 0) && ok;
+			info("fill benchmark results written to '%s'", filename);
+		}
+		return ok;
+	}
+
+	void writeJSON(FILE *f) const
+	{
+		int i, j;
+		fprintf(f, "{\n  \"renderer\": ");
+		Benchmark::writeJSONString(f, (const char*)glGetString(GL_RENDERER));
+		fprintf(f, ",\n  \"version\": ");
+		Benchmark::writeJSONString(f, (const char*)glGetString(GL_VERSION));
+		fprintf(f, ",\n  \"frames\": %d,\n  \"warmup\": %d,\n  \"target\": ", frames.frames, frames.warmup);
+		Benchmark::writeJSONString(f, target);
+		fprintf(f, ",\n  \"width\": %d,\n  \"height\": %d,\n  \"budget_ms\": %.2f,\n", width, height,
+			DYNRES_TARGET_MS);
+		fprintf(f, "  \"unit\": \"ms\",\n  \"shaders\": [");
+		for (i = 0; i < count; i++) {
+			const FillResult *r = &results[i];
+			fprintf(f, "%s\n    {\"key\": %d, \"vs\": ", i ? "," : "", r->key);
+			Benchmark::writeJSONString(f, r->vs);
+			fprintf(f, ", \"fs\": ");
+			Benchmark::writeJSONString(f, r->fs);
+			fprintf(f, ", \"defines\": %u, \"ok\": %s", r->defines, r->ok ? "true" : "false");
+			if (r->ok) {
+				fprintf(f, ",\n     \"fit\": {\"points\": %d, \"fixed_ms\": %.4f, \"ns_per_pixel\": %.4f, "
+					"\"r2\": %.4f, \"budget_pixels\": %.0f, \"budget_scale\": %.3f},\n     \"points\": [",
+					r->fitted, r->fixedMs, r->nsPerPixel, r->r2, r->budgetPixels, r->budgetScale);
+				for (j = 0; j < r->count; j++) {
+					const FillSample *s = &r->samples[j];
+					fprintf(f, "%s\n       {\"width\": %d, \"height\": %d, \"overdraw\": %d, ", j ? "," : "",
+						s->width, s->height, s->overdraw);
+					Benchmark::writeJSONStats(f, "gpu", &s->gpu);
+					fprintf(f, "}");
+				}
+				fprintf(f, "\n     ]");
+			}
+			fprintf(f, "}");
+		}
+		fprintf(f, "\n  ]\n}\n");
+	}
+
+	/* a row per point, with the fit of its program */
+	void writeCSV(FILE *f) const
+	{
+		int i, j;
+		fprintf(f, "key,vs,fs,defines,ok,target,width,height,overdraw,pixels,"
+			"gpu_frames,gpu_mean,gpu_p50,gpu_p95,gpu_max,"
+			"fixed_ms,ns_per_pixel,r2,budget_pixels,budget_scale\n");
+		for (i = 0; i < count; i++) {
+			const FillResult *r = &results[i];
+			for (j = 0; j < r->count; j++) {
+				const FillSample *s = &r->samples[j];
+				const FrameTimeStats *g = &s->gpu;
+				fprintf(f, "%d,%s,%s,%u,%d,%s,%d,%d,%d,%.0f,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.0f,%.3f\n",
+					r->key, r->vs, r->fs, r->defines, r->ok ? 1 : 0, target, s->width, s->height,
+					s->overdraw, (double)s->width * (double)s->height * (double)s->overdraw,
+					g->count, g->mean, g->p50, g->p95, g->max,
+					r->fixedMs, r->nsPerPixel, r->r2, r->budgetPixels, r->budgetScale);
+			}
+		}
+	}
+} FillBench;
+
+#endif
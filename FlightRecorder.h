@@ -0,0 +1,141 @@
+#ifndef HEADER_FLIGHTRECORDER_H
+#define HEADER_FLIGHTRECORDER_H
+
+#include "FrameStats.h"
+#include "GpuProfiler.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* FLIGHT RECORDER: a trace of the last seconds whenever a frame is slow    *
+****************************************************************************/
+
+/* FlightRecorder: the rings of Profiler.h always hold the last zones of
+* every thread, the GPU scopes and, with the debug output on, the driver
+* performance warnings (see GLDebug.h), at the cost of two clock reads per
+* zone. The recorder watches the time of each frame and when one is slow,
+* writes the zones of the last FLIGHT_WINDOW seconds as a Chrome trace, so
+* a hitch which is gone by the time someone looks is caught with what led
+* up to it. A frame is slow if its CPU or GPU time is over budgetMs, or over
+* spikeFactor times the p99 of the frames of the last second (see
+* FrameStats), whichever are set; nothing is checked before the first second
+* of statistics, which the loading fills with slow frames anyway. The trace
+* is written GPU_PROFILER_FRAMES + 1 frames after the slow one, when its
+* GPU times were collected, and the slow frame is marked on the track
+* "flight recorder". Writing a trace takes a while itself, so there is at
+* most one every FLIGHT_INTERVAL seconds and FLIGHT_MAX_TRACES per run; the
+* slow frames in between are only counted. The traces are prefix_1.json,
+* prefix_2.json, ... The zones need PROFILE_ZONES (make PROFILE=1). */
+#define FLIGHT_WINDOW 5.0	/* s of zones in a trace */
+#define FLIGHT_INTERVAL 30.0	/* s at least between two traces */
+#define FLIGHT_MAX_TRACES 16	/* per run */
+#define FLIGHT_PATH_MAX 256
+
+typedef struct {
+	bool enabled;
+	double budgetMs;	/* a frame over this is slow, 0 for none */
+	double spikeFactor;	/* or over this many times the p99, 0 for none */
+	const char *prefix;	/* of the file names of the traces */
+	int written;		/* traces so far */
+	unsigned int slow;	/* slow frames so far, those of the traces too */
+	int pending;		/* frames until the trace of the last slow one, 0 if none */
+	double lastTrace;	/* profileSeconds() when it was written, -1 before */
+
+	void clear()
+	{
+		enabled = false;
+		budgetMs = 0.0;
+		spikeFactor = 0.0;
+		prefix = "hellocube_flight";
+		written = 0;
+		slow = 0;
+		pending = 0;
+		lastTrace = -1.0;
+	}
+
+	/* Check a frame which took cpuMs of wall time, gpuMs is the GPU time
+	* of an earlier one and negative if there is none, stats the
+	* distribution of the last second. */
+	void frame(double cpuMs, double gpuMs, const FrameStats *stats)
+	{
+		const FrameTimeStats *c = &stats->cpuStats;
+		const FrameTimeStats *g = &stats->gpuStats;
+		const char *why;
+		double ms, limit;
+
+		if (!enabled)
+			return;
+		if (pending > 0) {
+			if (--pending == 0)
+				write();
+			return;
+		}
+		if (!c->count)
+			return;
+		if (budgetMs > 0.0 && cpuMs > budgetMs) {
+			why = "slow frame: CPU over budget";
+			ms = cpuMs;
+			limit = budgetMs;
+		} else if (budgetMs > 0.0 && gpuMs > budgetMs) {
+			why = "slow frame: GPU over budget";
+			ms = gpuMs;
+			limit = budgetMs;
+		} else if (spikeFactor > 0.0 && cpuMs > spikeFactor * c->p99) {
+			why = "slow frame: CPU spike";
+			ms = cpuMs;
+			limit = spikeFactor * c->p99;
+		} else if (spikeFactor > 0.0 && g->count && gpuMs > spikeFactor * g->p99) {
+			why = "slow frame: GPU spike";
+			ms = gpuMs;
+			limit = spikeFactor * g->p99;
+		} else {
+			return;
+		}
+		slow++;
+		if (written >= FLIGHT_MAX_TRACES || (lastTrace >= 0.0 && profileSeconds() - lastTrace < FLIGHT_INTERVAL))
+			return;
+		mark(why, cpuMs);
+		info("flight recorder: %s, %.2fms over %.2fms", why, ms, limit);
+		pending = GPU_PROFILER_FRAMES + 1;
+	}
+
+	/* Mark the frame which just ended after cpuMs as why, a string
+	* literal. */
+	static void mark(const char *why, double cpuMs)
+	{
+#ifdef PROFILE_ZONES
+		static ProfileThread *track = profileCreateRing("flight recorder");
+		unsigned long long now = profileNow();
+		unsigned long long length = (unsigned long long)(cpuMs * 1.0e6);
+		if (track)
+			track->record(why, (now > length) ? now - length : 0, now, 0);
+#else
+		(void)why;
+		(void)cpuMs;
+#endif
+	}
+
+	/* Write the zones of the last FLIGHT_WINDOW seconds. */
+	void write()
+	{
+		char path[FLIGHT_PATH_MAX];
+		unsigned long long now = profileNow();
+		unsigned long long window = (unsigned long long)(FLIGHT_WINDOW * 1.0e9);
+
+		mysnprintf(path, sizeof(path), "%s_%d.json", prefix, ++written);
+		if (profileExport(path, (now > window) ? now - window : 0) >= 0)
+			info("flight recorder: wrote the last %.0f s to '%s'", FLIGHT_WINDOW, path);
+		/* after the writing, which is slow itself */
+		lastTrace = profileSeconds();
+	}
+
+	/* Log what was caught, at exit. */
+	void report() const
+	{
+		if (enabled)
+			info("flight recorder: %u slow frames, %d traces written", slow, written);
+	}
+} FlightRecorder;
+
+#endif
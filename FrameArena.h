@@ -0,0 +1,227 @@
+#ifndef HEADER_FRAMEARENA_H
+#define HEADER_FRAMEARENA_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "JobSystem.h"
+#include "LargePages.h"
+#include "Log.h"
+
+/****************************************************************************
+* FRAME ARENAS: linear memory for the data of one frame                    *
+****************************************************************************/
+
+/* LinearArena: a block of memory allocated once, handed out by bumping an
+* offset and freed all at once by reset(). An allocation costs an add and
+* a compare, there is no fragmentation, and no lock: each arena belongs to
+* one thread.
+* FrameArenas holds the arenas of the frame loop. The transient data of a
+* frame (the draw lists, the sort buffers, scratch copies) comes from the
+* frame arena of the drawing thread; there are FRAME_ARENA_FRAMES of them,
+* used in turn, so what a frame allocates stays valid during the next one
+* as well, and is overwritten the frame after. Every worker of the job
+* system, and the one thread which is none, has an arena of its own, so
+* jobs allocate without contention; those are reset every frame, when no
+* jobs are running.
+* The blocks come from largePageAlloc(), in huge pages with --huge-pages,
+* and each arena is a cache line of its own, so the workers bumping their
+* offsets do not share one. The workers write their arenas first when they
+* start (see frameArenaTouch()), so with --pin-threads the memory is on their
+* NUMA node.
+* An arena which runs out returns NULL, counts the failure and keeps its
+* peak, so the sizes can be tuned from the log. The heap is not meant to be
+* touched inside the frame loop: in debug builds, the remaining malloc and
+* realloc calls which may happen there report through frameHeapAlloc()
+* when they do, on the drawing thread between beginFrame() and endFrame()
+* or on a worker. */
+#define FRAME_ARENA_FRAMES 2
+#define FRAME_ARENA_BYTES (4u << 20)	/* per frame */
+#define THREAD_ARENA_BYTES (1u << 20)	/* per thread and frame */
+#define FRAME_ARENA_ALIGN 16
+
+typedef struct alignas(CACHE_LINE) {
+	unsigned char *base;
+	size_t capacity, used;
+	size_t peak;		/* most used since init */
+	unsigned int failures;	/* allocations which did not fit */
+
+	void clear()
+	{
+		base = NULL;
+		capacity = used = peak = 0;
+		failures = 0;
+	}
+
+	/* Allocate the block of bytes.
+	* Returns true if successfull and false if out of memory. */
+	bool init(size_t bytes)
+	{
+		clear();
+		base = (unsigned char*)largePageAlloc(bytes);
+		if (!base)
+			return false;
+		capacity = bytes;
+		return true;
+	}
+
+	void destroy()
+	{
+		largePageFree(base);
+		clear();
+	}
+
+	/* Write the whole block, so its pages are placed on the NUMA node of
+	* the calling thread, which the kernel does on the first write. */
+	void touch()
+	{
+		if (base)
+			memset(base, 0, capacity);
+	}
+
+	/* Free everything allocated so far. */
+	void reset()
+	{
+		used = 0;
+	}
+
+	/* bytes aligned to align (a power of two), NULL if they do not fit */
+	void *alloc(size_t bytes, size_t align = FRAME_ARENA_ALIGN)
+	{
+		size_t start = (used + align - 1) & ~(align - 1);
+		if (start + bytes > capacity) {
+			failures++;
+			return NULL;
+		}
+		used = start + bytes;
+		if (used > peak)
+			peak = used;
+		return base + start;
+	}
+
+	template <typename T> T *allocArray(size_t n)
+	{
+		return (T*)alloc(sizeof(T) * n, (alignof(T) > FRAME_ARENA_ALIGN) ? alignof(T) : FRAME_ARENA_ALIGN);
+	}
+} LinearArena;
+
+/* Whether the calling thread is drawing a frame. */
+inline bool &frameActive()
+{
+	static thread_local bool active = false;
+	return active;
+}
+
+/* Report a heap allocation of bytes for what, if it happens inside the
+* frame loop. Compiled out in release builds. */
+inline void frameHeapAlloc(const char *what, size_t bytes)
+{
+#ifndef NDEBUG
+	if (frameActive() || jobWorkerIndex() >= 0)
+		warn("heap allocation inside the frame loop: %u bytes for %s", (unsigned)bytes, what);
+#else
+	(void)what;
+	(void)bytes;
+#endif
+}
+
+typedef struct {
+	LinearArena frames[FRAME_ARENA_FRAMES];
+	LinearArena threads[JOB_MAX_WORKERS + 1];	/* by jobWorkerIndex() + 1 */
+	unsigned int frame;
+
+	/* Allocate the arenas.
+	* Returns true if successfull and false if out of memory. */
+	bool init(size_t frameBytes = FRAME_ARENA_BYTES, size_t threadBytes = THREAD_ARENA_BYTES)
+	{
+		int i;
+		bool ok = true;
+		MemoryScope scope(MEMORY_TRANSIENT);
+		frame = 0;
+		for (i = 0; i < FRAME_ARENA_FRAMES; i++)
+			ok = frames[i].init(frameBytes) && ok;
+		for (i = 0; i <= JOB_MAX_WORKERS; i++)
+			ok = threads[i].init(threadBytes) && ok;
+		if (!ok) {
+			warn("frame arenas: failed to allocate %u + %u KiB", (unsigned)(FRAME_ARENA_FRAMES * frameBytes >> 10),
+				(unsigned)((JOB_MAX_WORKERS + 1) * threadBytes >> 10));
+			destroy();
+		}
+		return ok;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < FRAME_ARENA_FRAMES; i++)
+			frames[i].destroy();
+		for (i = 0; i <= JOB_MAX_WORKERS; i++)
+			threads[i].destroy();
+	}
+
+	/* On the drawing thread, before the frame allocates anything. No jobs
+	* may be running. */
+	void beginFrame()
+	{
+		int i;
+		frame++;
+		frames[frame % FRAME_ARENA_FRAMES].reset();
+		for (i = 0; i <= JOB_MAX_WORKERS; i++)
+			threads[i].reset();
+		frameActive() = true;
+	}
+
+	/* On the drawing thread, after the frame was swapped. */
+	void endFrame()
+	{
+		frameActive() = false;
+	}
+
+	/* The arena of the current frame, drawing thread only. */
+	LinearArena *current()
+	{
+		return &frames[frame % FRAME_ARENA_FRAMES];
+	}
+
+	/* The arena of the calling thread. */
+	LinearArena *thread()
+	{
+		return &threads[jobWorkerIndex() + 1];
+	}
+
+	/* Log the peaks and the allocations which did not fit. */
+	void report()
+	{
+		int i;
+		size_t framePeak = 0, threadPeak = 0;
+		unsigned int failures = 0;
+		for (i = 0; i < FRAME_ARENA_FRAMES; i++) {
+			if (frames[i].peak > framePeak)
+				framePeak = frames[i].peak;
+			failures += frames[i].failures;
+		}
+		for (i = 0; i <= JOB_MAX_WORKERS; i++) {
+			if (threads[i].peak > threadPeak)
+				threadPeak = threads[i].peak;
+			failures += threads[i].failures;
+		}
+		info("frame arenas: peak %u KiB per frame, %u KiB per thread, %u allocations did not fit",
+			(unsigned)(framePeak >> 10), (unsigned)(threadPeak >> 10), failures);
+	}
+} FrameArenas;
+
+/* The arenas of the process, see above. This is an inline function with a
+* static local, so all translation units share it. */
+inline FrameArenas *frameArenas()
+{
+	static FrameArenas arenas;
+	return &arenas;
+}
+
+/* Place the arena of job worker index, called by that worker before it
+* runs any job, see JobSystem::init(). */
+inline void frameArenaTouch(int index)
+{
+	frameArenas()->threads[index + 1].touch();
+}
+
+#endif
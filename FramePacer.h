@@ -0,0 +1,122 @@
+#ifndef HEADER_FRAMEPACER_H
+#define HEADER_FRAMEPACER_H
+
+#include <GLFW/glfw3.h>
+#include <glad/glad.h>
+#include <chrono>
+#include <thread>
+#include "Log.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* LOW-LATENCY FRAME PACING                                                 *
+****************************************************************************/
+
+/* FramePacer: by default a frame samples the input, is submitted as fast
+* as possible and then waits in the buffer swap (or a few frames later,
+* wherever the driver blocks) until the display takes it. The input is as
+* old as that wait. In the low-latency mode, the frame starts as late as
+* possible instead: after the swap, a fence is waited for, so the queue of
+* the GPU is empty and the time from sampling the input to the GPU being
+* done is known. The next frame sleeps until the predicted deadline minus
+* the longest of the last PACER_HISTORY of these times and a margin, and
+* only then polls the events and renders.
+* The deadlines are one refresh interval apart. Their phase is taken from
+* when the GPU finished the last frame: with vsync, the commands behind a
+* swap wait for the flip, so the fence signals about at the vblank. A frame
+* which misses its deadline just moves the next ones.
+* sleep_for is only accurate to a millisecond or so on most systems, so
+* the last PACER_SPIN_MS before the start are spent yielding instead. */
+#define PACER_HISTORY 16	/* frames the cost is predicted from */
+#define PACER_MARGIN_MS 1.0	/* slack before the deadline */
+#define PACER_SPIN_MS 1.5	/* of the wait, spent yielding */
+#define PACER_TIMEOUT_NS 100000000ull	/* give up on the fence after 100ms */
+
+typedef struct {
+	bool enabled;
+	double interval;	/* ms between the deadlines, 0 if it is not known */
+	double costs[PACER_HISTORY];	/* ms from the input to the GPU being done */
+	int costIndex, costCount;
+	double frameStart;	/* s, when the current frame sampled its input */
+	double lastDone;	/* s, when the GPU finished the last frame, 0 for not yet */
+	double predicted;	/* ms the current frame was given */
+	double slept;		/* ms the current frame waited before its input */
+
+	void clear()
+	{
+		enabled = false;
+		interval = 0.0;
+		costIndex = costCount = 0;
+		frameStart = lastDone = 0.0;
+		predicted = slept = 0.0;
+	}
+
+	/* Start or stop pacing to deadlines intervalMs apart. */
+	void setEnabled(bool enable, double intervalMs)
+	{
+		enabled = enable && intervalMs > 0.0;
+		interval = intervalMs;
+		costIndex = costCount = 0;
+		lastDone = 0.0;
+	}
+
+	/* The time to reserve for the next frame: the longest recent one and
+	* the margin. */
+	double predict() const
+	{
+		int i;
+		double worst = 0.0;
+		for (i = 0; i < costCount; i++)
+			if (costs[i] > worst)
+				worst = costs[i];
+		return worst + PACER_MARGIN_MS;
+	}
+
+	/* Before sampling the input: sleep until the frame must start to be
+	* done by the next deadline it can still make. */
+	void wait()
+	{
+		double now = profileSeconds(), begin = now;
+		slept = 0.0;
+		if (enabled && costCount && lastDone > 0.0) {
+			predicted = predict();
+			double deadline = lastDone + interval * 0.001;
+			double start = deadline - predicted * 0.001;
+			while (start < now) {
+				deadline += interval * 0.001;
+				start += interval * 0.001;
+			}
+			/* one interval late means the frame has a full one anyway */
+			if (start - now < interval * 0.001) {
+				double coarse = (start - now) * 1000.0 - PACER_SPIN_MS;
+				if (coarse > 0.0)
+					std::this_thread::sleep_for(std::chrono::microseconds((long long)(coarse * 1000.0)));
+				while ((now = profileSeconds()) < start)
+					std::this_thread::yield();
+				slept = (now - begin) * 1000.0;
+			}
+		}
+		frameStart = profileSeconds();
+	}
+
+	/* After the buffer swap: wait until the GPU is done with the frame and
+	* record how long it took since wait(). */
+	void endFrame()
+	{
+		if (!enabled)
+			return;
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		if (!fence)
+			return;
+		if (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, PACER_TIMEOUT_NS) == GL_WAIT_FAILED)
+			warn("frame pacer: waiting for the fence failed");
+		glDeleteSync(fence);
+		lastDone = profileSeconds();
+		costs[costIndex] = (lastDone - frameStart) * 1000.0;
+		costIndex = (costIndex + 1) % PACER_HISTORY;
+		if (costCount < PACER_HISTORY)
+			costCount++;
+	}
+} FramePacer;
+
+#endif
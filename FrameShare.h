@@ -0,0 +1,456 @@
+#ifndef HEADER_FRAMESHARE_H
+#define HEADER_FRAMESHARE_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include "Log.h"
+#include "GLState.h"
+#include "GLLoader.h"
+
+/****************************************************************************
+* FRAME SHARING                                                            *
+****************************************************************************/
+
+/* FrameShare: hands the frames to another process, an encoder or a
+* compositor, without reading them back. The other process (the consumer,
+* typically Vulkan with NVENC or VAAPI behind it) allocates a ring of up to
+* FRAME_SHARE_IMAGES images and exports their memory, and optionally two
+* semaphores per image, as opaque file descriptors. It connects to the
+* SOCK_SEQPACKET Unix socket of --share-frames PATH and sends them with a
+* FrameShareSetup message; we import them with GL_EXT_memory_object_fd and
+* GL_EXT_semaphore_fd as textures of the size and format it chose, and blit
+* each frame into the next free one:
+*   consumer -> us  FrameShareSetup with the fds (SCM_RIGHTS): the memory
+*                   of each image, then if semaphores is set the "ready"
+*                   semaphore of each image, then its "released" one
+*   us -> consumer  FrameShareMessage FRAME_SHARE_FRAME: image holds frame
+*   consumer -> us  FrameShareMessage FRAME_SHARE_RELEASE: we may draw
+*                   into image again
+* With semaphores, "ready" is signaled on the GPU behind the blit, so the
+* frame message goes out right away, and the next blit into an image waits
+* on the GPU for its "released" semaphore, which the consumer signals
+* before it sends the release. Without them (the driver or the consumer
+* lacks GL_EXT_semaphore_fd), a fence behind the blit is polled and the
+* message goes out once the blit is done; the consumer then releases the
+* image only when it is done reading. Either way nothing waits on the CPU:
+* a frame finding no free image is dropped and counted. The images are
+* GPU memory of the same device, so both processes must use the same GPU.
+* Not available on Windows. */
+#define FRAME_SHARE_IMAGES 4
+#define FRAME_SHARE_MAGIC 0x53464348u	/* "HCFS" */
+#define FRAME_SHARE_VERSION 1
+
+/* the message types */
+enum {
+	FRAME_SHARE_FRAME = 1,
+	FRAME_SHARE_RELEASE
+};
+
+/* GL_EXT_memory_object, GL_EXT_memory_object_fd, GL_EXT_semaphore and
+* GL_EXT_semaphore_fd, which our glad does not know */
+#ifndef GL_EXT_memory_object
+#define GL_TEXTURE_TILING_EXT 0x9580
+#define GL_DEDICATED_MEMORY_OBJECT_EXT 0x9581
+#define GL_OPTIMAL_TILING_EXT 0x9584
+#define GL_LINEAR_TILING_EXT 0x9585
+#endif
+#ifndef GL_EXT_memory_object_fd
+#define GL_HANDLE_TYPE_OPAQUE_FD_EXT 0x9586
+#endif
+#ifndef GL_EXT_semaphore
+#define GL_LAYOUT_GENERAL_EXT 0x958D
+#define GL_LAYOUT_SHADER_READ_ONLY_EXT 0x9591
+#define GL_LAYOUT_TRANSFER_SRC_EXT 0x9592
+#endif
+typedef void (APIENTRYP FrameShareCreateMemoryProc)(GLsizei n, GLuint *memoryObjects);
+typedef void (APIENTRYP FrameShareDeleteMemoryProc)(GLsizei n, const GLuint *memoryObjects);
+typedef void (APIENTRYP FrameShareMemoryParameterProc)(GLuint memoryObject, GLenum pname, const GLint *params);
+typedef void (APIENTRYP FrameShareImportMemoryProc)(GLuint memory, GLuint64 size, GLenum handleType, GLint fd);
+typedef void (APIENTRYP FrameShareTexStorageProc)(GLenum target, GLsizei levels, GLenum internalFormat,
+	GLsizei width, GLsizei height, GLuint memory, GLuint64 offset);
+typedef void (APIENTRYP FrameShareGenSemaphoresProc)(GLsizei n, GLuint *semaphores);
+typedef void (APIENTRYP FrameShareDeleteSemaphoresProc)(GLsizei n, const GLuint *semaphores);
+typedef void (APIENTRYP FrameShareImportSemaphoreProc)(GLuint semaphore, GLenum handleType, GLint fd);
+typedef void (APIENTRYP FrameShareSemaphoreProc)(GLuint semaphore, GLuint numBufferBarriers, const GLuint *buffers,
+	GLuint numTextureBarriers, const GLuint *textures, const GLenum *layouts);
+
+/* what the consumer sends first, in the byte order of the machine */
+typedef struct {
+	unsigned int magic;	/* FRAME_SHARE_MAGIC */
+	unsigned int version;	/* FRAME_SHARE_VERSION */
+	unsigned int count;	/* images, up to FRAME_SHARE_IMAGES */
+	unsigned int width, height;
+	unsigned int format;	/* sized internal format, e.g. GL_RGBA8 */
+	unsigned int tiling;	/* GL_OPTIMAL_TILING_EXT or GL_LINEAR_TILING_EXT */
+	unsigned int dedicated;	/* the memory is a dedicated allocation */
+	unsigned int semaphores;	/* 1 if the fds of the semaphores follow */
+	unsigned int layout;	/* of an image while the consumer has it, GL_LAYOUT_*_EXT */
+	unsigned long long size[FRAME_SHARE_IMAGES];	/* of the memory of each image */
+} FrameShareSetup;
+
+typedef struct {
+	unsigned int type;	/* FRAME_SHARE_FRAME or FRAME_SHARE_RELEASE */
+	unsigned int image;
+	unsigned int frame;	/* counting from 0 since the consumer connected */
+	unsigned int layout;	/* of the image, for FRAME_SHARE_FRAME */
+} FrameShareMessage;
+
+/* where an image is */
+enum {
+	FRAME_SHARE_FREE = 0,	/* ours */
+	FRAME_SHARE_BLIT,	/* the blit into it is in flight, without semaphores */
+	FRAME_SHARE_CONSUMER	/* the consumer has it */
+};
+
+typedef struct {
+	GLuint memory, texture, fbo;
+	GLuint ready, released;	/* the semaphores, 0 without */
+	GLsync fence;		/* behind the blit, without semaphores */
+	int state;		/* FRAME_SHARE_* */
+	bool used;		/* the consumer had it, so its "released" will be signaled */
+	unsigned int frame;
+} FrameShareImage;
+
+typedef struct {
+	FrameShareCreateMemoryProc createMemory;
+	FrameShareDeleteMemoryProc deleteMemory;
+	FrameShareMemoryParameterProc memoryParameter;
+	FrameShareImportMemoryProc importMemory;
+	FrameShareTexStorageProc texStorage;
+	FrameShareGenSemaphoresProc genSemaphores;
+	FrameShareDeleteSemaphoresProc deleteSemaphores;
+	FrameShareImportSemaphoreProc importSemaphore;
+	FrameShareSemaphoreProc waitSemaphore, signalSemaphore;
+	bool semaphoresSupported;
+	char path[108];		/* of the socket */
+	int listener, consumer;	/* -1 if none */
+	FrameShareSetup setup;
+	FrameShareImage images[FRAME_SHARE_IMAGES];
+	int count;		/* images imported, 0 before the setup */
+	int next;		/* image of the next frame */
+	unsigned int frames, dropped;	/* since the consumer connected */
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+		listener = consumer = -1;
+	}
+
+	bool enabled() const
+	{
+		return listener >= 0;
+	}
+
+	/* Load the extensions and listen on the Unix socket at socketPath.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(const char *socketPath)
+	{
+		clear();
+#ifdef _WIN32
+		(void)socketPath;
+		warn("frame sharing: not supported on Windows");
+		return false;
+#else
+		if (!glExtensionSupported("GL_EXT_memory_object_fd")) {
+			warn("frame sharing: GL_EXT_memory_object_fd is not supported");
+			return false;
+		}
+		createMemory = (FrameShareCreateMemoryProc)glLoaderProc("glCreateMemoryObjectsEXT");
+		deleteMemory = (FrameShareDeleteMemoryProc)glLoaderProc("glDeleteMemoryObjectsEXT");
+		memoryParameter = (FrameShareMemoryParameterProc)glLoaderProc("glMemoryObjectParameterivEXT");
+		importMemory = (FrameShareImportMemoryProc)glLoaderProc("glImportMemoryFdEXT");
+		texStorage = (FrameShareTexStorageProc)glLoaderProc("glTexStorageMem2DEXT");
+		if (!createMemory || !deleteMemory || !memoryParameter || !importMemory || !texStorage)
+			return false;
+		if (glExtensionSupported("GL_EXT_semaphore_fd")) {
+			genSemaphores = (FrameShareGenSemaphoresProc)glLoaderProc("glGenSemaphoresEXT");
+			deleteSemaphores = (FrameShareDeleteSemaphoresProc)glLoaderProc("glDeleteSemaphoresEXT");
+			importSemaphore = (FrameShareImportSemaphoreProc)glLoaderProc("glImportSemaphoreFdEXT");
+			waitSemaphore = (FrameShareSemaphoreProc)glLoaderProc("glWaitSemaphoreEXT");
+			signalSemaphore = (FrameShareSemaphoreProc)glLoaderProc("glSignalSemaphoreEXT");
+			semaphoresSupported = genSemaphores && deleteSemaphores && importSemaphore && waitSemaphore &&
+				signalSemaphore;
+		}
+
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+			warn("frame sharing: the socket path '%s' is too long", socketPath);
+			return false;
+		}
+		mysnprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socketPath);
+		mysnprintf(path, sizeof(path), "%s", socketPath);
+		unlink(path);
+		listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listener < 0 || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) || listen(listener, 1)) {
+			warn("frame sharing: failed to listen on '%s': %s", path, strerror(errno));
+			if (listener >= 0)
+				close(listener);
+			listener = -1;
+			return false;
+		}
+		info("frame sharing: waiting for a consumer on '%s', %s semaphores", path,
+			semaphoresSupported ? "with" : "without");
+		return true;
+#endif
+	}
+
+#ifndef _WIN32
+	/* Import the images of the setup s with the fds, count of them.
+	* Returns true if successfull. */
+	bool import(const FrameShareSetup *s, int *fds, int fdCount)
+	{
+		unsigned int i;
+		int needed = (int)s->count * (s->semaphores ? 3 : 1);
+		if (s->magic != FRAME_SHARE_MAGIC || s->version != FRAME_SHARE_VERSION || s->count < 1 ||
+			s->count > FRAME_SHARE_IMAGES || !s->width || !s->height || fdCount != needed ||
+			(s->semaphores && !semaphoresSupported)) {
+			warn("frame sharing: the consumer sent an unusable setup (%u images, %d fds%s)", s->count, fdCount,
+				s->semaphores && !semaphoresSupported ? ", semaphores are not supported" : "");
+			return false;
+		}
+		setup = *s;
+		for (i = 0; i < s->count; i++) {
+			FrameShareImage *m = &images[i];
+			GLint dedicated = s->dedicated ? GL_TRUE : GL_FALSE;
+			createMemory(1, &m->memory);
+			memoryParameter(m->memory, GL_DEDICATED_MEMORY_OBJECT_EXT, &dedicated);
+			/* the fd belongs to GL from here on */
+			importMemory(m->memory, s->size[i], GL_HANDLE_TYPE_OPAQUE_FD_EXT, fds[i]);
+			fds[i] = -1;
+			glGenTextures(1, &m->texture);
+			glState()->bindTexture(GL_TEXTURE_2D, m->texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_TILING_EXT, (GLint)s->tiling);
+			texStorage(GL_TEXTURE_2D, 1, (GLenum)s->format, (GLsizei)s->width, (GLsizei)s->height, m->memory, 0);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+			glGenFramebuffers(1, &m->fbo);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m->fbo);
+			glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m->texture, 0);
+			GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glDebugLabel(GL_TEXTURE, m->texture, "shared frame %u", i);
+			if (s->semaphores) {
+				genSemaphores(1, &m->ready);
+				importSemaphore(m->ready, GL_HANDLE_TYPE_OPAQUE_FD_EXT, fds[s->count + i]);
+				fds[s->count + i] = -1;
+				genSemaphores(1, &m->released);
+				importSemaphore(m->released, GL_HANDLE_TYPE_OPAQUE_FD_EXT, fds[2 * s->count + i]);
+				fds[2 * s->count + i] = -1;
+			}
+			count++;
+			if (status != GL_FRAMEBUFFER_COMPLETE || glGetError() != GL_NO_ERROR) {
+				warn("frame sharing: failed to import image %u (framebuffer status 0x%x)", i, status);
+				return false;
+			}
+		}
+		next = 0;
+		frames = dropped = 0;
+		info("frame sharing: %u images of %ux%u, format 0x%x, %s", s->count, s->width, s->height, s->format,
+			s->semaphores ? "synchronized by semaphores" : "synchronized by fences");
+		return true;
+	}
+
+	/* Accept a consumer if one is waiting and none is connected. */
+	void accept()
+	{
+		if (consumer >= 0)
+			return;
+		consumer = ::accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (consumer >= 0)
+			info("frame sharing: consumer connected");
+	}
+
+	/* Read the messages of the consumer. Returns false if it is gone or
+	* broke the protocol. */
+	bool receive()
+	{
+		union {
+			FrameShareSetup setup;
+			FrameShareMessage message;
+		} m;
+		union {
+			char buffer[CMSG_SPACE(sizeof(int) * FRAME_SHARE_IMAGES * 3)];
+			struct cmsghdr align;
+		} control;
+		for (;;) {
+			struct iovec iov = { &m, sizeof(m) };
+			struct msghdr msg;
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = &iov;
+			msg.msg_iovlen = 1;
+			msg.msg_control = control.buffer;
+			msg.msg_controllen = sizeof(control.buffer);
+			ssize_t n = recvmsg(consumer, &msg, MSG_CMSG_CLOEXEC);
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				return true;
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				return false;
+			int fds[FRAME_SHARE_IMAGES * 3], fdCount = 0, i;
+			struct cmsghdr *c;
+			for (c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+				if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS)
+					continue;
+				int k = (int)((c->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+				for (i = 0; i < k && fdCount < FRAME_SHARE_IMAGES * 3; i++)
+					memcpy(&fds[fdCount++], CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+			}
+			bool ok;
+			if (!count)
+				ok = n == (ssize_t)sizeof(FrameShareSetup) && import(&m.setup, fds, fdCount);
+			else
+				ok = n == (ssize_t)sizeof(FrameShareMessage) && !fdCount && release(&m.message);
+			/* those GL did not take */
+			for (i = 0; i < fdCount; i++)
+				if (fds[i] >= 0)
+					close(fds[i]);
+			if (!ok)
+				return false;
+		}
+	}
+
+	/* The consumer gave an image back. */
+	bool release(const FrameShareMessage *m)
+	{
+		if (m->type != FRAME_SHARE_RELEASE || m->image >= (unsigned int)count ||
+			images[m->image].state != FRAME_SHARE_CONSUMER)
+			return false;
+		images[m->image].state = FRAME_SHARE_FREE;
+		return true;
+	}
+
+	/* Tell the consumer that image holds its frame. */
+	bool send(int image)
+	{
+		FrameShareMessage m;
+		m.type = FRAME_SHARE_FRAME;
+		m.image = (unsigned int)image;
+		m.frame = images[image].frame;
+		m.layout = setup.layout;
+		images[image].state = FRAME_SHARE_CONSUMER;
+		images[image].used = true;
+		return ::send(consumer, &m, sizeof(m), MSG_NOSIGNAL) == (ssize_t)sizeof(m);
+	}
+
+	/* Send the frames whose blit is done, without semaphores. */
+	bool collect()
+	{
+		int i;
+		for (i = 0; i < count; i++) {
+			FrameShareImage *m = &images[i];
+			if (m->state != FRAME_SHARE_BLIT)
+				continue;
+			if (glClientWaitSync(m->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+				continue;
+			glDeleteSync(m->fence);
+			m->fence = 0;
+			if (!send(i))
+				return false;
+		}
+		return true;
+	}
+
+	/* Forget the consumer and its images. */
+	void disconnect()
+	{
+		int i;
+		for (i = 0; i < count; i++) {
+			FrameShareImage *m = &images[i];
+			if (m->fence)
+				glDeleteSync(m->fence);
+			if (m->fbo)
+				glDeleteFramebuffers(1, &m->fbo);
+			if (m->texture)
+				glState()->deleteTextures(1, &m->texture);
+			if (m->ready)
+				deleteSemaphores(1, &m->ready);
+			if (m->released)
+				deleteSemaphores(1, &m->released);
+			if (m->memory)
+				deleteMemory(1, &m->memory);
+		}
+		memset(images, 0, sizeof(images));
+		if (consumer >= 0) {
+			close(consumer);
+			info("frame sharing: consumer gone after %u frames, %u dropped", frames, dropped);
+		}
+		consumer = -1;
+		count = 0;
+	}
+#endif
+
+	/* Hand the color of framebuffer fbo (0 for the back buffer of the
+	* window), of width x height pixels, to the consumer, scaled to the size
+	* of its images. */
+	void frame(GLuint fbo, int width, int height)
+	{
+#ifndef _WIN32
+		if (listener < 0)
+			return;
+		accept();
+		if (consumer < 0)
+			return;
+		if (!receive() || (count && !collect())) {
+			disconnect();
+			return;
+		}
+		if (!count || width <= 0 || height <= 0)
+			return;
+		FrameShareImage *m = &images[next];
+		if (m->state != FRAME_SHARE_FREE) {
+			dropped++;
+			return;
+		}
+		next = (next + 1) % count;
+		GLenum layout = (GLenum)setup.layout;
+		/* the consumer may still read it on the GPU */
+		if (m->released && m->used)
+			waitSemaphore(m->released, 0, NULL, 1, &m->texture, &layout);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+		glReadBuffer(fbo ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m->fbo);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, (GLint)setup.width, (GLint)setup.height, GL_COLOR_BUFFER_BIT,
+			(width == (int)setup.width && height == (int)setup.height) ? GL_NEAREST : GL_LINEAR);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		m->frame = frames++;
+		if (m->ready) {
+			signalSemaphore(m->ready, 0, NULL, 1, &m->texture, &layout);
+			/* the signal has to reach the GPU before the consumer waits on it */
+			glFlush();
+			if (!send((int)(m - images)))
+				disconnect();
+		} else {
+			m->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			m->state = FRAME_SHARE_BLIT;
+		}
+		GL_ERROR_DBG("frame sharing");
+#else
+		(void)fbo; (void)width; (void)height;
+#endif
+	}
+
+	void destroy()
+	{
+#ifndef _WIN32
+		if (listener >= 0) {
+			disconnect();
+			close(listener);
+			unlink(path);
+		}
+#endif
+		clear();
+	}
+} FrameShare;
+
+#endif
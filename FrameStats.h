@@ -0,0 +1,146 @@
+#ifndef HEADER_FRAMESTATS_H
+#define HEADER_FRAMESTATS_H
+
+#include <stdlib.h>
+#include <atomic>
+
+/****************************************************************************
+* FRAME TIME STATISTICS                                                    *
+****************************************************************************/
+
+/* FrameTimeRing: the last FRAME_STATS_SIZE frame times in milliseconds.
+* There is a single writer (the main loop) which never waits: it stores the
+* sample and then publishes it by advancing the write counter. Readers only
+* look at samples below the published counter, so a reader on another thread
+* needs no lock either; it just must not lag behind by more than the size of
+* the ring. */
+#define FRAME_STATS_SIZE 1024	/* must be a power of two */
+
+typedef struct {
+	float samples[FRAME_STATS_SIZE];
+	std::atomic<unsigned int> written;	/* total number of samples pushed */
+
+	void init()
+	{
+		written.store(0, std::memory_order_relaxed);
+	}
+
+	/* Append a sample, overwriting the oldest one. */
+	void push(double ms)
+	{
+		unsigned int w = written.load(std::memory_order_relaxed);
+		samples[w & (FRAME_STATS_SIZE - 1)] = (float)ms;
+		written.store(w + 1, std::memory_order_release);
+	}
+
+	/* Copy the samples pushed since sample number since (at most
+	* FRAME_STATS_SIZE) into dst. Returns the number of samples copied and
+	* the current counter in *now. */
+	unsigned int read(unsigned int since, float *dst, unsigned int *now) const
+	{
+		unsigned int w = written.load(std::memory_order_acquire);
+		unsigned int n = w - since;
+		unsigned int i;
+
+		if (n > FRAME_STATS_SIZE)
+			n = FRAME_STATS_SIZE;
+		for (i = 0; i < n; i++)
+			dst[i] = samples[(w - n + i) & (FRAME_STATS_SIZE - 1)];
+		*now = w;
+		return n;
+	}
+} FrameTimeRing;
+
+/* the distribution of a set of frame times, in milliseconds */
+typedef struct {
+	unsigned int count;	/* 0 if there were no samples */
+	double mean;
+	double p50, p95, p99;
+	double max;
+} FrameTimeStats;
+
+static int frameStatsCompare(const void *a, const void *b)
+{
+	float x = *(const float*)a;
+	float y = *(const float*)b;
+	return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/* Compute the distribution of the n samples in values, which are sorted
+* in place. Percentiles use the nearest-rank method. */
+static void frameTimeStatsCompute(FrameTimeStats *stats, float *values, unsigned int n)
+{
+	unsigned int i;
+	double sum = 0.0;
+
+	stats->count = n;
+	if (!n) {
+		stats->mean = stats->p50 = stats->p95 = stats->p99 = stats->max = -1.0;
+		return;
+	}
+	qsort(values, n, sizeof(float), frameStatsCompare);
+	for (i = 0; i < n; i++)
+		sum += values[i];
+	stats->mean = sum / (double)n;
+	stats->p50 = values[((n - 1) * 50) / 100];
+	stats->p95 = values[((n - 1) * 95) / 100];
+	stats->p99 = values[((n - 1) * 99) / 100];
+	stats->max = values[n - 1];
+}
+
+/* FrameStats: per-frame CPU and GPU times plus the frames which took longer
+* than a vsync interval. The CPU time is the wall time between two frames,
+* the GPU time arrives a few frames late from the GpuProfiler. update()
+* computes the statistics of everything since its previous call. */
+typedef struct {
+	FrameTimeRing cpu, gpu;
+	std::atomic<unsigned int> missedVsync;	/* frames longer than a vsync interval */
+	double vsyncInterval;			/* ms, 0 if unknown or vsync is off */
+
+	/* state of the last update() */
+	unsigned int cpuRead, gpuRead, missedRead;
+	FrameTimeStats cpuStats, gpuStats;
+	unsigned int missed;
+	float scratch[FRAME_STATS_SIZE];
+
+	void init(double vsyncMs)
+	{
+		cpu.init();
+		gpu.init();
+		missedVsync.store(0, std::memory_order_relaxed);
+		vsyncInterval = vsyncMs;
+		cpuRead = gpuRead = missedRead = 0;
+		missed = 0;
+		frameTimeStatsCompute(&cpuStats, scratch, 0);
+		frameTimeStatsCompute(&gpuStats, scratch, 0);
+	}
+
+	void pushCPU(double ms)
+	{
+		/* allow some jitter before calling a frame late */
+		if (vsyncInterval > 0.0 && ms > 1.5 * vsyncInterval)
+			missedVsync.fetch_add(1, std::memory_order_relaxed);
+		cpu.push(ms);
+	}
+
+	void pushGPU(double ms)
+	{
+		gpu.push(ms);
+	}
+
+	/* Compute the statistics of the frames since the last call. */
+	void update()
+	{
+		unsigned int n, m;
+
+		n = cpu.read(cpuRead, scratch, &cpuRead);
+		frameTimeStatsCompute(&cpuStats, scratch, n);
+		n = gpu.read(gpuRead, scratch, &gpuRead);
+		frameTimeStatsCompute(&gpuStats, scratch, n);
+		m = missedVsync.load(std::memory_order_relaxed);
+		missed = m - missedRead;
+		missedRead = m;
+	}
+} FrameStats;
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef HEADER_FRAMETHROTTLE_H
+#define HEADER_FRAMETHROTTLE_H
+
+#include <GLFW/glfw3.h>
+#include <glad/glad.h>
+#include "Log.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* FRAME THROTTLE: frames in flight                                         *
+****************************************************************************/
+
+/* FrameThrottle: nothing in GL limits how far the CPU may run ahead of the
+* GPU. Depending on the driver, the CPU blocks in the buffer swap, or
+* queues three or more frames, which all add to the latency. The throttle
+* places a fence behind each frame and, before the CPU starts the next one,
+* waits until at most framesInFlight frames are still queued: with 1 the
+* CPU and the GPU take turns, with 2 (the default) the CPU records a frame
+* while the GPU draws the one before.
+* The frames are numbered from 1. The fences of the last FRAME_THROTTLE_MAX
+* frames are kept, so it also tells whether the GPU is done with a given
+* frame: the RingBuffer regions remember the frame which used them last and
+* wait for that before they are reused, instead of holding fences of their
+* own. Since the GPU finishes the commands in order, a signaled fence also
+* means that all earlier frames are done. More than FRAME_THROTTLE_MAX frames
+* are never in flight, even with the throttle off (framesInFlight 0).
+* There is one throttle per process, on the thread which owns the context. */
+#define FRAME_THROTTLE_MAX 4
+#define FRAME_THROTTLE_DEFAULT 2
+
+typedef struct {
+	int framesInFlight;	/* frames the CPU may be ahead, 0 for no throttle */
+	GLsync fences[FRAME_THROTTLE_MAX];	/* behind frame f at f % FRAME_THROTTLE_MAX */
+	unsigned long long frame;	/* the frame being recorded */
+	unsigned long long completed;	/* the GPU is done with all frames before */
+	unsigned int stalls;	/* times the CPU had to wait */
+	double waitTime;	/* ms waited in the last beginFrame() */
+
+	void init(int n)
+	{
+		int i;
+		for (i = 0; i < FRAME_THROTTLE_MAX; i++)
+			fences[i] = 0;
+		frame = completed = 1;
+		stalls = 0;
+		waitTime = 0.0;
+		setFramesInFlight(n);
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < FRAME_THROTTLE_MAX; i++) {
+			if (fences[i]) {
+				glDeleteSync(fences[i]);
+				fences[i] = 0;
+			}
+		}
+	}
+
+	/* Allow n frames in flight, 0 for no limit but FRAME_THROTTLE_MAX. */
+	void setFramesInFlight(int n)
+	{
+		framesInFlight = (n < 0) ? 0 : (n > FRAME_THROTTLE_MAX ? FRAME_THROTTLE_MAX : n);
+	}
+
+	/* Wait until the GPU is done with frame f. Frames which were not
+	* submitted yet count as done, there is nothing to wait for.
+	* Returns true if the CPU actually had to wait. */
+	bool waitFrame(unsigned long long f)
+	{
+		GLsync fence;
+		GLbitfield waitFlags = 0;
+		GLuint64 timeout = 0;
+		GLenum res;
+		bool stalled = false;
+
+		if (f < completed || f >= frame)
+			return false;
+		fence = fences[f % FRAME_THROTTLE_MAX];
+		if (fence) {
+			/* first just poll, so we can tell whether we actually stalled */
+			while ((res = glClientWaitSync(fence, waitFlags, timeout)) == GL_TIMEOUT_EXPIRED) {
+				stalled = true;
+				waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+				timeout = 1000000; /* 1ms */
+			}
+			if (res == GL_WAIT_FAILED)
+				warn("FrameThrottle: waiting for the fence of frame %llu failed", f);
+		}
+		/* this and all earlier frames are done, their fences can go */
+		for (; completed <= f; completed++) {
+			GLsync *done = &fences[completed % FRAME_THROTTLE_MAX];
+			if (*done) {
+				glDeleteSync(*done);
+				*done = 0;
+			}
+		}
+		return stalled;
+	}
+
+	/* Advance completed past the frames the GPU is done with, without
+	* waiting for any. */
+	void poll()
+	{
+		while (completed < frame) {
+			GLsync *fence = &fences[completed % FRAME_THROTTLE_MAX];
+			if (*fence) {
+				GLenum res = glClientWaitSync(*fence, 0, 0);
+				if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED)
+					return;
+				glDeleteSync(*fence);
+				*fence = 0;
+			}
+			completed++;
+		}
+	}
+
+	/* Before the first GL command of a frame: wait until no more than
+	* framesInFlight frames are queued. */
+	void beginFrame()
+	{
+		double start;
+		waitTime = 0.0;
+		if (!framesInFlight || frame <= (unsigned long long)framesInFlight)
+			return;
+		start = profileSeconds();
+		if (waitFrame(frame - framesInFlight)) {
+			stalls++;
+			waitTime = (profileSeconds() - start) * 1000.0;
+		}
+	}
+
+	/* After the buffer swap: fence the frame and start the next one. */
+	void endFrame()
+	{
+		/* the slot still holds the frame FRAME_THROTTLE_MAX before */
+		if (frame > FRAME_THROTTLE_MAX)
+			waitFrame(frame - FRAME_THROTTLE_MAX);
+		fences[frame % FRAME_THROTTLE_MAX] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		frame++;
+	}
+} FrameThrottle;
+
+/* The throttle of the process, see above. This is an inline function with
+* a static local, so all translation units share it. */
+inline FrameThrottle *frameThrottle()
+{
+	static FrameThrottle throttle = { 0 };
+	return &throttle;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef HEADER_FRUSTUMCULLER_H
+#define HEADER_FRUSTUMCULLER_H
+
+#include <glm/glm.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "JobSystem.h"
+#include "LargePages.h"
+
+#if (GLM_ARCH & GLM_ARCH_SSE2)
+#include <glm/gtx/simd_vec4.hpp>
+#define FRUSTUM_CULLER_SIMD
+#endif
+
+/****************************************************************************
+* CPU FRUSTUM CULLING                                                      *
+****************************************************************************/
+
+/* Extract the six frustum planes (left, right, bottom, top, near, far) of
+* the view projection matrix m, in the space m transforms from. The normals
+* point inside and are normalized, so a sphere at c with radius r is outside
+* if dot(plane.xyz, c) + plane.w < -r for any of them. */
+static void frustumPlanes(const glm::mat4 &m, glm::vec4 planes[6])
+{
+	int i;
+	glm::vec4 row[4];
+	for (i = 0; i < 4; i++)
+		row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+	for (i = 0; i < 3; i++) {
+		planes[2 * i] = row[3] + row[i];
+		planes[2 * i + 1] = row[3] - row[i];
+	}
+	for (i = 0; i < 6; i++)
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+/* FrustumCuller: bounding spheres culled against the frustum on the CPU,
+* for when there are no compute shaders to do it on the GPU. The spheres
+* are stored as structure of arrays, so one SSE2 register holds the same
+* coordinate of FRUSTUM_CULL_BATCH spheres and each plane is tested against
+* a whole batch with a few multiply-adds (via glm's simdVec4). The arrays
+* are padded to whole batches with spheres which are never visible. The
+* batches are split across the cores by the job system, each chunk
+* writing its own range of visible[], so the threads share nothing. */
+#define FRUSTUM_CULL_BATCH 4	/* floats per SSE2 register */
+#define FRUSTUM_CULL_GRAIN 1024	/* spheres per parallel chunk, multiple of the batch */
+
+static void frustumCullChunk(void *user, int begin, int end);
+
+typedef struct {
+	float *x, *y, *z, *radius;	/* the spheres, aligned to a cache line */
+	unsigned char *visible;		/* per sphere, the result of cull() */
+	void *block;			/* the allocation holding all arrays */
+	int count;			/* number of spheres */
+	int padded;			/* count rounded up to whole batches */
+	float radiusScale;		/* applied to all radii, see Scene::radiusScale */
+	glm::vec4 planes[6];		/* of the current cull() */
+	unsigned int version;		/* of the Camera visible[] is for, 0 if none, kept by the caller */
+
+	/* Allocate room for n spheres, all of them invisible.
+	* Returns true if successfull and false in case of an error. */
+	bool init(int n)
+	{
+		int i;
+		MemoryScope scope(MEMORY_SCENE);
+		count = n;
+		radiusScale = 1.0f;
+		version = 0;
+		padded = (n + FRUSTUM_CULL_BATCH - 1) / FRUSTUM_CULL_BATCH * FRUSTUM_CULL_BATCH;
+		/* one block, in huge pages with --huge-pages */
+		size_t size = sizeof(float) * (size_t)padded;
+		block = largePageAlloc(4 * size + (size_t)padded);
+		if (!block) {
+			warn("frustum culler: failed to allocate %d spheres", n);
+			x = y = z = radius = NULL;
+			visible = NULL;
+			return false;
+		}
+		x = (float*)block;
+		y = x + padded;
+		z = y + padded;
+		radius = z + padded;
+		visible = (unsigned char*)(radius + padded);
+		for (i = 0; i < padded; i++) {
+			x[i] = y[i] = z[i] = 0.0f;
+			radius[i] = -1e30f;	/* outside of every plane */
+		}
+		memset(visible, 0, (size_t)padded);
+		return true;
+	}
+
+	void destroy()
+	{
+		largePageFree(block);
+		block = NULL;
+		x = y = z = radius = NULL;
+		visible = NULL;
+		count = padded = 0;
+	}
+
+	/* Set sphere i. */
+	void set(int i, const glm::vec3 &center, float r)
+	{
+		x[i] = center.x;
+		y[i] = center.y;
+		z[i] = center.z;
+		radius[i] = r;
+	}
+
+	/* Cull the spheres in [begin, end), both multiples of the batch. */
+	void cullRange(int begin, int end)
+	{
+		int i, p;
+#ifdef FRUSTUM_CULLER_SIMD
+		glm::simdVec4 px[6], py[6], pz[6], pw[6];
+		__m128 scale = _mm_set1_ps(-radiusScale);
+		for (p = 0; p < 6; p++) {
+			px[p] = glm::simdVec4(planes[p].x);
+			py[p] = glm::simdVec4(planes[p].y);
+			pz[p] = glm::simdVec4(planes[p].z);
+			pw[p] = glm::simdVec4(planes[p].w);
+		}
+		for (i = begin; i < end; i += FRUSTUM_CULL_BATCH) {
+			glm::simdVec4 cx(_mm_load_ps(x + i)), cy(_mm_load_ps(y + i)), cz(_mm_load_ps(z + i));
+			__m128 r = _mm_mul_ps(scale, _mm_load_ps(radius + i));
+			/* bit k is set if sphere i+k is outside of any plane */
+			int outside = 0;
+			for (p = 0; p < 6; p++) {
+				glm::simdVec4 d = px[p] * cx + py[p] * cy + pz[p] * cz + pw[p];
+				outside |= _mm_movemask_ps(_mm_cmplt_ps(d.Data, r));
+			}
+			visible[i + 0] = !(outside & 1);
+			visible[i + 1] = !(outside & 2);
+			visible[i + 2] = !(outside & 4);
+			visible[i + 3] = !(outside & 8);
+		}
+#else
+		for (i = begin; i < end; i++) {
+			bool inside = true;
+			for (p = 0; p < 6 && inside; p++)
+				inside = planes[p].x * x[i] + planes[p].y * y[i] + planes[p].z * z[i] + planes[p].w >= -radius[i] * radiusScale;
+			visible[i] = inside;
+		}
+#endif
+	}
+
+	/* Cull all spheres against the frustum of the view projection matrix
+	* vp and set visible[] accordingly, in parallel on jobs. If done is
+	* given, this returns at once and the jobs count down done, otherwise
+	* it returns when visible[] is complete. */
+	void cull(const glm::mat4 &vp, JobSystem *jobs, JobCounter *done = NULL)
+	{
+		frustumPlanes(vp, planes);
+		if (done)
+			jobs->parallelFor(frustumCullChunk, this, padded, FRUSTUM_CULL_GRAIN, done);
+		else
+			jobs->run(frustumCullChunk, this, padded, FRUSTUM_CULL_GRAIN);
+	}
+} FrustumCuller;
+
+/* The loop body of FrustumCuller::cull. Chunks start at multiples of the
+* grain and padded is a multiple of the batch, so every chunk consists of
+* whole batches. */
+static void frustumCullChunk(void *user, int begin, int end)
+{
+	((FrustumCuller*)user)->cullRange(begin, end);
+}
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef HEADER_GLCAPS_H
+#define HEADER_GLCAPS_H
+
+#include <glad/glad.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include "Log.h"
+
+/****************************************************************************
+* GL CAPABILITIES                                                          *
+****************************************************************************/
+
+/* What the context can do, probed once after the functions are loaded, so
+* that each part of the renderer picks its fastest path from the same
+* answers instead of checking versions, extensions and entry points on its
+* own. A capability needs the entry points it calls and either the GL
+* version it became core in or its extension.
+* initBaseApp asks for the newest context of glCapsVersions first and steps
+* down until the driver creates one. limit() (--gl-version) caps both the
+* context asked for and the capabilities: those of a newer version are off
+* even if the driver has their extension, so one machine can run the paths
+* of an older one. Extensions which never became core count as 4.6.
+* report() logs the context at the level of detail of verbosity
+* (--gl-info): 0 the version and the capabilities, 1 also the limits, 2 also
+* every extension. The extensions come from the table glad built when it
+* loaded, so they are not fetched from the driver again. dump()
+* (--gl-info-out) writes all of it as JSON from a thread of its own, which
+* finish() waits for before the context goes away. */
+static const int glCapsVersions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 4, 1 }, { 3, 3 }, { 3, 2 } };
+#define GL_CAPS_VERSIONS ((int)(sizeof(glCapsVersions) / sizeof(glCapsVersions[0])))
+
+/* the limits of the report, queried where the context has them */
+typedef struct {
+	GLenum name;
+	const char *label;
+	int major, minor;	/* the version which has it */
+} GLCapsLimit;
+
+static const GLCapsLimit glCapsLimits[] = {
+	{ GL_MAX_TEXTURE_SIZE, "max_texture_size", 3, 2 },
+	{ GL_MAX_ARRAY_TEXTURE_LAYERS, "max_array_texture_layers", 3, 2 },
+	{ GL_MAX_SAMPLES, "max_samples", 3, 2 },
+	{ GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, "max_combined_texture_image_units", 3, 2 },
+	{ GL_MAX_VERTEX_ATTRIBS, "max_vertex_attribs", 3, 2 },
+	{ GL_MAX_UNIFORM_BLOCK_SIZE, "max_uniform_block_size", 3, 2 },
+	{ GL_MAX_UNIFORM_BUFFER_BINDINGS, "max_uniform_buffer_bindings", 3, 2 },
+	{ GL_MAX_DRAW_BUFFERS, "max_draw_buffers", 3, 2 },
+	{ GL_MAX_SHADER_STORAGE_BLOCK_SIZE, "max_shader_storage_block_size", 4, 3 },
+	{ GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, "max_shader_storage_buffer_bindings", 4, 3 },
+	{ GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, "max_compute_work_group_invocations", 4, 3 },
+	{ GL_MAX_COMPUTE_SHARED_MEMORY_SIZE, "max_compute_shared_memory_size", 4, 3 }
+};
+#define GL_CAPS_LIMITS ((int)(sizeof(glCapsLimits) / sizeof(glCapsLimits[0])))
+
+typedef struct {
+	int major, minor;	/* of the context, limited */
+	int limitMajor, limitMinor;	/* --gl-version, 0 for none */
+	bool directStateAccess;	/* glCreate*, glNamed*, glVertexArray* */
+	bool bufferStorage;	/* immutable and persistently mapped buffers */
+	bool multiDrawIndirect;
+	bool baseInstance;	/* instanced draws which start the instance attributes at a base instance */
+	bool drawIndirectCount;	/* the GPU writes the number of draws */
+	bool computeShader;
+	bool storageBuffers;
+	bool bindlessTexture;
+	bool parallelShaderCompile;
+	bool spirv;
+	bool separateShaders;	/* program pipelines */
+	bool sparseTexture;
+	bool timerQuery;
+	bool debug;		/* KHR_debug */
+	bool packedVertices;	/* GL_INT_2_10_10_10_REV attributes */
+	bool tessellation;	/* tessellation control and evaluation shaders */
+	bool occlusionQueries;	/* GL_ANY_SAMPLES_PASSED and conditional rendering */
+	bool conservativeQueries;	/* GL_ANY_SAMPLES_PASSED_CONSERVATIVE */
+	const char *vendor, *renderer, *versionString, *glsl;	/* owned by the driver */
+	GLint limits[GL_CAPS_LIMITS];	/* -1 where the context has none */
+	int verbosity;		/* of report() */
+	const char *reportFile;	/* dump() writes there, or NULL */
+	std::thread reportThread;
+
+	/* Never ask for a context newer than major.minor, nor use what only
+	* such a context has. */
+	void limit(int maxMajor, int maxMinor)
+	{
+		limitMajor = maxMajor;
+		limitMinor = maxMinor;
+	}
+
+	/* Returns true if major.minor is within the limit. */
+	bool allowed(int mj, int mn) const
+	{
+		return !limitMajor || mj < limitMajor || (mj == limitMajor && mn <= limitMinor);
+	}
+
+	/* Returns true if the context is at least major.minor. */
+	bool version(int mj, int mn) const
+	{
+		return major > mj || (major == mj && minor >= mn);
+	}
+
+	/* Returns true if the feature of version mj.mn is there, as core or by
+	* the extension flag ext, and within the limit. */
+	bool feature(int mj, int mn, int ext) const
+	{
+		return version(mj, mn) || (ext && allowed(mj, mn));
+	}
+
+	/* Probe the context which is current, after glLoaderLoad(). */
+	void detect()
+	{
+		major = GLVersion.major;
+		minor = GLVersion.minor;
+		if (limitMajor && !allowed(major, minor)) {
+			major = limitMajor;
+			minor = limitMinor;
+		}
+		directStateAccess = feature(4, 5, GLAD_GL_ARB_direct_state_access) && glCreateBuffers &&
+			glNamedBufferStorage && glCreateVertexArrays && glVertexArrayVertexBuffer &&
+			glVertexArrayElementBuffer && glVertexArrayAttribFormat && glVertexArrayAttribBinding &&
+			glVertexArrayBindingDivisor && glEnableVertexArrayAttrib && glDisableVertexArrayAttrib &&
+			glVertexArrayAttribIFormat && glCopyNamedBufferSubData;
+		bufferStorage = feature(4, 4, GLAD_GL_ARB_buffer_storage) && glBufferStorage;
+		multiDrawIndirect = feature(4, 3, GLAD_GL_ARB_multi_draw_indirect) && glMultiDrawElementsIndirect;
+		baseInstance = feature(4, 2, GLAD_GL_ARB_base_instance) && glDrawElementsInstancedBaseVertexBaseInstance;
+		/* core in 4.6, which glad was not generated for */
+		drawIndirectCount = multiDrawIndirect && feature(4, 6, GLAD_GL_ARB_indirect_parameters) &&
+			GLAD_GL_ARB_indirect_parameters && glMultiDrawElementsIndirectCountARB;
+		computeShader = version(4, 3) && glDispatchCompute && glMemoryBarrier;
+		storageBuffers = feature(4, 3, GLAD_GL_ARB_shader_storage_buffer_object) && glShaderStorageBlockBinding;
+		bindlessTexture = version(4, 3) && feature(4, 6, GLAD_GL_ARB_bindless_texture) &&
+			GLAD_GL_ARB_bindless_texture && glGetTextureHandleARB && glMakeTextureHandleResidentARB &&
+			glMakeTextureHandleNonResidentARB;
+		parallelShaderCompile = feature(4, 6, GLAD_GL_ARB_parallel_shader_compile) &&
+			GLAD_GL_ARB_parallel_shader_compile;
+		spirv = feature(4, 6, GLAD_GL_ARB_gl_spirv) && GLAD_GL_ARB_gl_spirv && glSpecializeShaderARB && glShaderBinary;
+		separateShaders = feature(4, 1, GLAD_GL_ARB_separate_shader_objects) && glUseProgramStages &&
+			glGenProgramPipelines;
+		sparseTexture = version(4, 3) && feature(4, 6, GLAD_GL_ARB_sparse_texture) && GLAD_GL_ARB_sparse_texture &&
+			glTexPageCommitmentARB && glTexStorage2D && glGetInternalformativ && glWaitSync;
+		/* glQueryCounter is core since GL 3.3 */
+		timerQuery = feature(3, 3, GLAD_GL_ARB_timer_query) && glQueryCounter;
+		debug = feature(4, 3, GLAD_GL_KHR_debug) && glDebugMessageCallback && glDebugMessageControl &&
+			glObjectLabel && glPushDebugGroup && glPopDebugGroup;
+		packedVertices = feature(3, 3, GLAD_GL_ARB_vertex_type_2_10_10_10_rev);
+		tessellation = feature(4, 0, GLAD_GL_ARB_tessellation_shader) && glPatchParameteri;
+		occlusionQueries = feature(3, 3, GLAD_GL_ARB_occlusion_query2) && glBeginConditionalRender &&
+			glGetQueryObjectuiv;
+		conservativeQueries = occlusionQueries && feature(4, 3, GLAD_GL_ARB_ES3_compatibility);
+		vendor = (const char*)glGetString(GL_VENDOR);
+		renderer = (const char*)glGetString(GL_RENDERER);
+		versionString = (const char*)glGetString(GL_VERSION);
+		glsl = (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
+		for (int i = 0; i < GL_CAPS_LIMITS; i++) {
+			limits[i] = -1;
+			if (version(glCapsLimits[i].major, glCapsLimits[i].minor))
+				glGetIntegerv(glCapsLimits[i].name, &limits[i]);
+		}
+	}
+
+	/* Log the context at the level of verbosity. */
+	void report() const
+	{
+		int i, length;
+		info("OpenGL: %s %s %s", vendor, renderer, versionString);
+		info("OpenGL Shading language: %s", glsl);
+		logCapabilities();
+		if (verbosity >= 1)
+			for (i = 0; i < GL_CAPS_LIMITS; i++)
+				if (limits[i] >= 0)
+					info("  %s: %d", glCapsLimits[i].label, limits[i]);
+		info("GL extensions supported: %d", gladGetExtensionCount());
+		if (verbosity >= 2)
+			for (i = 0; i < gladGetExtensionCount(); i++) {
+				const char *name = gladGetExtension(i, &length);
+				info("  %.*s", length, name);
+			}
+	}
+
+	/* Log what the context can and can not do. */
+	void logCapabilities() const
+	{
+		const struct { const char *name; bool has; } caps[] = {
+			{ "DSA", directStateAccess }, { "buffer storage", bufferStorage },
+			{ "multi-draw indirect", multiDrawIndirect }, { "base instance", baseInstance },
+			{ "indirect count", drawIndirectCount },
+			{ "compute", computeShader }, { "storage buffers", storageBuffers },
+			{ "bindless textures", bindlessTexture }, { "parallel compile", parallelShaderCompile },
+			{ "SPIR-V", spirv }, { "separate shaders", separateShaders }, { "sparse textures", sparseTexture },
+			{ "timer queries", timerQuery }, { "KHR_debug", debug }, { "packed vertices", packedVertices },
+			{ "tessellation", tessellation }, { "occlusion queries", occlusionQueries },
+			{ "conservative queries", conservativeQueries }
+		};
+		char has[512], lacks[512];
+		size_t h = 0, l = 0;
+		int i;
+		has[0] = lacks[0] = 0;
+		for (i = 0; i < (int)(sizeof(caps) / sizeof(caps[0])); i++) {
+			char *s = caps[i].has ? has : lacks;
+			size_t *n = caps[i].has ? &h : &l;
+			int w = snprintf(s + *n, sizeof(has) - *n, "%s%s", *n ? ", " : "", caps[i].name);
+			if (w > 0 && *n + (size_t)w < sizeof(has))
+				*n += (size_t)w;
+		}
+		info("GL %d.%d%s: %s", major, minor, limitMajor ? " (limited)" : "", h ? has : "none of the features");
+		if (l)
+			info("GL %d.%d lacks: %s", major, minor, lacks);
+	}
+
+	static void writeJSONString(FILE *f, const char *str, int length)
+	{
+		fputc('"', f);
+		for (; str && length > 0 && *str; str++, length--) {
+			if (*str == '"' || *str == '\\')
+				fputc('\\', f);
+			if ((unsigned char)*str >= 0x20)
+				fputc(*str, f);
+		}
+		fputc('"', f);
+	}
+
+	/* Write the report as JSON into reportFile, called by dump(). */
+	void write() const
+	{
+		const struct { const char *name; bool has; } caps[] = {
+			{ "direct_state_access", directStateAccess }, { "buffer_storage", bufferStorage },
+			{ "multi_draw_indirect", multiDrawIndirect }, { "base_instance", baseInstance },
+			{ "draw_indirect_count", drawIndirectCount },
+			{ "compute_shader", computeShader }, { "storage_buffers", storageBuffers },
+			{ "bindless_texture", bindlessTexture }, { "parallel_shader_compile", parallelShaderCompile },
+			{ "spirv", spirv }, { "separate_shaders", separateShaders }, { "sparse_texture", sparseTexture },
+			{ "timer_query", timerQuery }, { "debug", debug }, { "packed_vertices", packedVertices },
+			{ "tessellation", tessellation }, { "occlusion_queries", occlusionQueries },
+			{ "conservative_queries", conservativeQueries }
+		};
+		FILE *f = fopen(reportFile, "wt");
+		int i, length, n;
+		if (!f) {
+			warn("failed to open GL info output '%s'", reportFile);
+			return;
+		}
+		fprintf(f, "{\n  \"vendor\": ");
+		writeJSONString(f, vendor, INT_MAX);
+		fprintf(f, ",\n  \"renderer\": ");
+		writeJSONString(f, renderer, INT_MAX);
+		fprintf(f, ",\n  \"version\": ");
+		writeJSONString(f, versionString, INT_MAX);
+		fprintf(f, ",\n  \"glsl\": ");
+		writeJSONString(f, glsl, INT_MAX);
+		fprintf(f, ",\n  \"context\": \"%d.%d\",\n  \"limited\": %s,\n  \"capabilities\": {", major, minor,
+			limitMajor ? "true" : "false");
+		for (i = 0; i < (int)(sizeof(caps) / sizeof(caps[0])); i++)
+			fprintf(f, "%s\n    \"%s\": %s", i ? "," : "", caps[i].name, caps[i].has ? "true" : "false");
+		fprintf(f, "\n  },\n  \"limits\": {");
+		for (i = n = 0; i < GL_CAPS_LIMITS; i++)
+			if (limits[i] >= 0)
+				fprintf(f, "%s\n    \"%s\": %d", n++ ? "," : "", glCapsLimits[i].label, limits[i]);
+		fprintf(f, "\n  },\n  \"extensions\": [");
+		for (i = 0; i < gladGetExtensionCount(); i++) {
+			const char *name = gladGetExtension(i, &length);
+			fprintf(f, "%s\n    ", i ? "," : "");
+			writeJSONString(f, name, length);
+		}
+		fprintf(f, "\n  ]\n}\n");
+		bool ok = !ferror(f);
+		if (fclose(f) || !ok)
+			warn("failed to write GL info output '%s'", reportFile);
+		else
+			info("GL info written to '%s'", reportFile);
+	}
+
+	/* Start writing the report into reportFile on a thread of its own. */
+	void dump()
+	{
+		if (reportFile && !reportThread.joinable())
+			reportThread = std::thread([this]() { write(); });
+	}
+
+	/* Wait until the report is written, before the context goes away. */
+	void finish()
+	{
+		if (reportThread.joinable())
+			reportThread.join();
+	}
+} GLCapabilities;
+
+/* The capabilities of the context, shared by all translation units like
+* logSink(). */
+inline GLCapabilities *glCaps()
+{
+	/* zero-initialized, as a static */
+	static GLCapabilities caps;
+	return &caps;
+}
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef HEADER_GLDEBUG_H
+#define HEADER_GLDEBUG_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdarg.h>
+#include <stdio.h>
+#ifdef WIN32
+#include <intrin.h>
+#else
+#include <signal.h>
+#endif
+#include "Log.h"
+#include "GLCaps.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* GL DEBUG OUTPUT: messages by callback, object labels and debug groups    *
+****************************************************************************/
+
+/* With KHR_debug (core in GL 4.3) the driver reports errors, performance
+* warnings and the like to a callback, with a text telling what went wrong,
+* while GL_ERROR_DBG() has to ask with glGetError, which costs a round trip
+* into the driver each time and only tells that something failed since the
+* last check. In debug builds glDebugInit() asks for synchronous output, so
+* that the callback runs in the GL call at fault, and GL_ERROR_DBG() stops
+* polling on a context which reports this way (glDebugReporting()).
+* glDebugLabel() names GL objects and GLDebugGroup (GL_DEBUG_GROUP(name))
+* brackets a pass with glPushDebugGroup/glPopDebugGroup, in all builds:
+* RenderDoc, Nsight and apitrace show the names of the objects and the passes
+* as a tree of the frame, and the callback tells the pass it happened in.
+* Without KHR_debug all of this does nothing.
+* Performance warnings of the driver (GL_DEBUG_TYPE_PERFORMANCE: a buffer
+* upload which waits for the GPU, a shader recompiled for the current state,
+* ...) are counted per message ID instead of being logged each time: the
+* first one of an ID is logged with its text, the table is summed up once
+* per second and listed by glDebugPerformanceDump() at exit. With
+* breakOnPerformance set, the first one of each ID also traps into the
+* debugger, in the GL call which caused it. With PROFILE_ZONES each
+* warning is also a zone of the track "GL performance" of Profiler.h, named
+* by the first message of its ID, so the traces of the flight recorder show
+* them next to the frame they slowed down. Release builds only install the
+* callback on request (--gl-debug), the driver has to do extra work for it. */
+#define GL_DEBUG_LABEL_MAX 128	/* bytes of an object label */
+#define GL_DEBUG_GROUP_DEPTH 16	/* nested groups the callback can name */
+#define GL_DEBUG_PERF_IDS 64	/* performance message IDs counted apart */
+#define GL_DEBUG_PERF_TEXT 160	/* bytes kept of the first message of an ID */
+
+/* the performance warnings with one message ID */
+typedef struct {
+	GLuint id;
+	GLenum source;		/* GL_DEBUG_SOURCE_* */
+	unsigned int count;	/* since the start */
+	char text[GL_DEBUG_PERF_TEXT];	/* of the first one, with its debug group */
+} GLDebugPerformance;
+
+typedef struct {
+	GLFWwindow *context;	/* which reports through the callback, or NULL */
+	bool supported;		/* KHR_debug functions are loaded */
+	unsigned int messages;	/* reported by the callback */
+	/* the performance warnings, written by the callback only: it is set
+	* up for a single context, which only one thread uses at a time */
+	GLDebugPerformance performance[GL_DEBUG_PERF_IDS];
+	int performanceIds;	/* entries used */
+	unsigned int performanceTotal;	/* warnings of all IDs, those not in the table too */
+	unsigned int performanceReported;	/* performanceTotal at the last report */
+	bool breakOnPerformance;	/* trap on the first warning of an ID */
+} GLDebugState;
+
+/* The state of the application, shared by all translation units like
+* logSink(). */
+inline GLDebugState *glDebug()
+{
+	/* zero-initialized, as a static */
+	static GLDebugState state;
+	return &state;
+}
+
+/* Stop in the debugger, or end the process if there is none. */
+inline void glDebugBreak()
+{
+#ifdef WIN32
+	__debugbreak();
+#else
+	raise(SIGTRAP);
+#endif
+}
+
+/* Record a performance warning as a zone of its own track, named by the
+* first message of its ID, or by a generic name beyond the table. */
+inline void glDebugPerformanceZone(const GLDebugPerformance *p)
+{
+#ifdef PROFILE_ZONES
+	static ProfileThread *track = profileCreateRing("GL performance");
+	unsigned long long now = profileNow();
+	if (track)
+		track->record(p ? p->text : "GL performance warning", now, now, 0);
+#else
+	(void)p;
+#endif
+}
+
+/* Count a performance warning of the callback, seen in the debug group
+* group. The first one of an ID is logged, and traps with
+* breakOnPerformance. */
+static void glDebugRecordPerformance(GLenum source, GLuint id, const char *group, const GLchar *message)
+{
+	GLDebugState *state = glDebug();
+	GLDebugPerformance *p = NULL;
+	int i;
+
+	state->performanceTotal++;
+	for (i = 0; i < state->performanceIds; i++)
+		if (state->performance[i].id == id && state->performance[i].source == source) {
+			state->performance[i].count++;
+			glDebugPerformanceZone(&state->performance[i]);
+			return;
+		}
+	if (state->performanceIds < GL_DEBUG_PERF_IDS) {
+		p = &state->performance[state->performanceIds++];
+		p->id = id;
+		p->source = source;
+		p->count = 1;
+		snprintf(p->text, sizeof(p->text), "%s: %s", group, message);
+	}
+	glDebugPerformanceZone(p);
+	warn("GL performance 0x%x in %s: %s", id, group, message);
+	if (state->breakOnPerformance)
+		glDebugBreak();
+}
+
+/* the names of the debug groups open on the calling thread, for the
+* messages of the callback */
+typedef struct {
+	const char *names[GL_DEBUG_GROUP_DEPTH];
+	int depth;		/* may exceed GL_DEBUG_GROUP_DEPTH */
+} GLDebugGroupStack;
+
+inline GLDebugGroupStack *glDebugGroups()
+{
+	static thread_local GLDebugGroupStack stack = { { NULL }, 0 };
+	return &stack;
+}
+
+/* The callback of the debug output. Errors and high severity messages are
+* warnings, the others infos. */
+static void APIENTRY glDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei length, const GLchar *message, const void *userParam)
+{
+	GLDebugGroupStack *groups = glDebugGroups();
+	const char *group = "frame";
+	(void)length;
+	(void)userParam;
+
+	if (groups->depth > 0 && groups->depth <= GL_DEBUG_GROUP_DEPTH)
+		group = groups->names[groups->depth - 1];
+	glDebug()->messages++;
+	if (type == GL_DEBUG_TYPE_PERFORMANCE)
+		glDebugRecordPerformance(source, id, group, message);
+	else if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH)
+		warn("GL debug 0x%x (type 0x%x) in %s: %s", id, type, group, message);
+	else
+		info("GL debug 0x%x (type 0x%x) in %s: %s", id, type, group, message);
+}
+
+/* The KHR_debug functions were loaded, see glLoaderFunctions. */
+inline bool glDebugSupported()
+{
+	return glDebug()->supported;
+}
+
+/* Set up the debug output for the current context, after the GL functions
+* were loaded. In debug builds, or with output set, the callback receives
+* the messages if the context is a debug context (see the
+* GLFW_OPENGL_DEBUG_CONTEXT hint) and replaces the polling of
+* GL_ERROR_DBG(); notifications other than performance warnings and the
+* messages of our own debug groups are muted. */
+static void glDebugInit(GLFWwindow *context, bool output = false)
+{
+	GLDebugState *state = glDebug();
+	state->supported = glCaps()->debug;
+	state->context = NULL;
+	if (!state->supported) {
+		info("GL debug: KHR_debug not available, no labels, groups or callback");
+		return;
+	}
+#ifndef NDEBUG
+	output = true;
+#endif
+	if (!output)
+		return;
+	GLint flags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+	if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+		info("GL debug: no debug context, checking for errors with glGetError");
+		return;
+	}
+	glEnable(GL_DEBUG_OUTPUT);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	glDebugMessageCallback(glDebugCallback, NULL);
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
+	glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_TRUE);
+	glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, NULL, GL_FALSE);
+	glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, NULL, GL_FALSE);
+	state->context = context;
+	info("GL debug: synchronous debug output enabled");
+}
+
+/* Log the performance warnings since the last call, if there were any.
+* Returns their number. */
+static unsigned int glDebugPerformanceReport()
+{
+	GLDebugState *state = glDebug();
+	unsigned int n = state->performanceTotal - state->performanceReported;
+	if (n) {
+		info("GL performance: %u warnings, %u since the start, of %d IDs", n, state->performanceTotal,
+			state->performanceIds);
+		state->performanceReported = state->performanceTotal;
+	}
+	return n;
+}
+
+/* List the performance warnings of each ID since the start. */
+static void glDebugPerformanceDump()
+{
+	GLDebugState *state = glDebug();
+	unsigned int listed = 0;
+	int i;
+
+	if (!state->performanceTotal)
+		return;
+	info("GL performance: %u warnings of %d IDs", state->performanceTotal, state->performanceIds);
+	for (i = 0; i < state->performanceIds; i++) {
+		const GLDebugPerformance *p = &state->performance[i];
+		info("  0x%x (source 0x%x) %u times, first in %s", p->id, p->source, p->count, p->text);
+		listed += p->count;
+	}
+	if (listed < state->performanceTotal)
+		info("  %u more of IDs beyond the first %d", state->performanceTotal - listed, GL_DEBUG_PERF_IDS);
+}
+
+/* The current context reports its errors through the callback. */
+inline bool glDebugReporting()
+{
+	GLFWwindow *context = glDebug()->context;
+	return context && context == glfwGetCurrentContext();
+}
+
+/* Name the GL object name of the kind identifier (GL_BUFFER, GL_VERTEX_ARRAY,
+* GL_PROGRAM, ...), use printf syntax. */
+static void glDebugLabel(GLenum identifier, GLuint name, const char *format, ...)
+{
+	char label[GL_DEBUG_LABEL_MAX];
+	va_list args;
+
+	if (!glDebugSupported() || !name)
+		return;
+	va_start(args, format);
+	vsnprintf(label, sizeof(label), format, args);
+	va_end(args);
+	glObjectLabel(identifier, name, -1, label);
+}
+
+/* Open a debug group called name, a string which has to live until the
+* group is closed. */
+inline void glDebugPush(const char *name)
+{
+	GLDebugGroupStack *groups = glDebugGroups();
+	if (!glDebugSupported())
+		return;
+	if (groups->depth < GL_DEBUG_GROUP_DEPTH)
+		groups->names[groups->depth] = name;
+	groups->depth++;
+	glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+/* Close the innermost debug group. */
+inline void glDebugPop()
+{
+	GLDebugGroupStack *groups = glDebugGroups();
+	if (!glDebugSupported() || groups->depth <= 0)
+		return;
+	groups->depth--;
+	glPopDebugGroup();
+}
+
+/* The debug group of GL_DEBUG_GROUP, closed when it goes out of scope. */
+struct GLDebugGroup {
+	explicit GLDebugGroup(const char *name)
+	{
+		glDebugPush(name);
+	}
+
+	~GLDebugGroup()
+	{
+		glDebugPop();
+	}
+};
+
+#define GL_DEBUG_CONCAT2(a, b) a##b
+#define GL_DEBUG_CONCAT(a, b) GL_DEBUG_CONCAT2(a, b)
+#define GL_DEBUG_GROUP(name) GLDebugGroup GL_DEBUG_CONCAT(glDebugGroup, __LINE__)(name)
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef HEADER_GLLOADER_H
+#define HEADER_GLLOADER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "HeadlessContext.h"
+
+/****************************************************************************
+* OPENGL FUNCTION LOADING                                                  *
+****************************************************************************/
+
+/* gladLoadGL resolves every entry point of GL 4.5 and of all the extensions
+* glad was generated with, which means thousands of glXGetProcAddress (or
+* wglGetProcAddress) calls at startup, while we only use a few dozen
+* functions. glLoaderLoad hands glad a loader which resolves only the
+* functions in glLoaderFunctions and leaves all others NULL. The extension
+* flags (GLAD_GL_*) are set as before, they do not need any entry points.
+* Every GL function the application calls must be in the list, which must
+* stay sorted (by strcmp); "make check-gl" finds missing ones. Define
+* GL_LOADER_ALL to let glad load everything again. The list is a macro
+* taking a macro F which is applied to each name, so the GL call trace of
+* GLTrace.h can hook the same functions. */
+#define GL_LOADER_FUNCTIONS(F) \
+	F(glActiveTexture) \
+	F(glAttachShader) \
+	F(glBeginConditionalRender) \
+	F(glBeginPerfMonitorAMD) \
+	F(glBeginPerfQueryINTEL) \
+	F(glBeginQuery) \
+	F(glBindAttribLocation) \
+	F(glBindBuffer) \
+	F(glBindBufferBase) \
+	F(glBindBufferRange) \
+	F(glBindFragDataLocation) \
+	F(glBindFramebuffer) \
+	F(glBindImageTexture) \
+	F(glBindProgramPipeline) \
+	F(glBindRenderbuffer) \
+	F(glBindTexture) \
+	F(glBindVertexArray) \
+	F(glBlendFunc) \
+	F(glBlendFunci) \
+	F(glBlitFramebuffer) \
+	F(glBufferData) \
+	F(glBufferStorage) \
+	F(glBufferSubData) \
+	F(glCheckFramebufferStatus) \
+	F(glClear) \
+	F(glClearBufferData) \
+	F(glClearBufferSubData) \
+	F(glClearBufferfv) \
+	F(glClearBufferuiv) \
+	F(glClearColor) \
+	F(glClientWaitSync) \
+	F(glColorMask) \
+	F(glCompileShader) \
+	F(glCompressedTexImage2D) \
+	F(glCompressedTexImage3D) \
+	F(glCompressedTexSubImage2D) \
+	F(glCompressedTexSubImage3D) \
+	F(glCopyBufferSubData) \
+	F(glCopyNamedBufferSubData) \
+	F(glCreateBuffers) \
+	F(glCreatePerfQueryINTEL) \
+	F(glCreateProgram) \
+	F(glCreateShader) \
+	F(glCreateVertexArrays) \
+	F(glCullFace) \
+	F(glDebugMessageCallback) \
+	F(glDebugMessageControl) \
+	F(glDeleteBuffers) \
+	F(glDeleteFramebuffers) \
+	F(glDeletePerfMonitorsAMD) \
+	F(glDeletePerfQueryINTEL) \
+	F(glDeleteProgram) \
+	F(glDeleteProgramPipelines) \
+	F(glDeleteQueries) \
+	F(glDeleteRenderbuffers) \
+	F(glDeleteShader) \
+	F(glDeleteSync) \
+	F(glDeleteTextures) \
+	F(glDeleteVertexArrays) \
+	F(glDepthFunc) \
+	F(glDepthMask) \
+	F(glDisable) \
+	F(glDisableVertexArrayAttrib) \
+	F(glDisableVertexAttribArray) \
+	F(glDispatchCompute) \
+	F(glDispatchComputeIndirect) \
+	F(glDrawArrays) \
+	F(glDrawArraysIndirect) \
+	F(glDrawArraysInstanced) \
+	F(glDrawBuffer) \
+	F(glDrawBuffers) \
+	F(glDrawElements) \
+	F(glDrawElementsInstanced) \
+	F(glDrawElementsInstancedBaseVertex) \
+	F(glDrawElementsInstancedBaseVertexBaseInstance) \
+	F(glEnable) \
+	F(glEnableVertexArrayAttrib) \
+	F(glEnableVertexAttribArray) \
+	F(glEndConditionalRender) \
+	F(glEndPerfMonitorAMD) \
+	F(glEndPerfQueryINTEL) \
+	F(glEndQuery) \
+	F(glFenceSync) \
+	F(glFinish) \
+	F(glFlush) \
+	F(glFramebufferRenderbuffer) \
+	F(glFramebufferTexture2D) \
+	F(glFramebufferTextureLayer) \
+	F(glGenBuffers) \
+	F(glGenFramebuffers) \
+	F(glGenPerfMonitorsAMD) \
+	F(glGenProgramPipelines) \
+	F(glGenQueries) \
+	F(glGenRenderbuffers) \
+	F(glGenTextures) \
+	F(glGenVertexArrays) \
+	F(glGenerateMipmap) \
+	F(glGetActiveAttrib) \
+	F(glGetActiveUniform) \
+	F(glGetActiveUniformBlockName) \
+	F(glGetActiveUniformBlockiv) \
+	F(glGetAttribLocation) \
+	F(glGetBufferParameteriv) \
+	F(glGetBufferSubData) \
+	F(glGetError) \
+	F(glGetFirstPerfQueryIdINTEL) \
+	F(glGetInteger64v) \
+	F(glGetIntegerv) \
+	F(glGetInternalformativ) \
+	F(glGetNextPerfQueryIdINTEL) \
+	F(glGetPerfCounterInfoINTEL) \
+	F(glGetPerfMonitorCounterDataAMD) \
+	F(glGetPerfMonitorCounterInfoAMD) \
+	F(glGetPerfMonitorCounterStringAMD) \
+	F(glGetPerfMonitorCountersAMD) \
+	F(glGetPerfMonitorGroupStringAMD) \
+	F(glGetPerfMonitorGroupsAMD) \
+	F(glGetPerfQueryDataINTEL) \
+	F(glGetPerfQueryInfoINTEL) \
+	F(glGetProgramBinary) \
+	F(glGetProgramInfoLog) \
+	F(glGetProgramPipelineiv) \
+	F(glGetProgramResourceIndex) \
+	F(glGetProgramiv) \
+	F(glGetQueryObjectiv) \
+	F(glGetQueryObjectui64v) \
+	F(glGetQueryObjectuiv) \
+	F(glGetShaderInfoLog) \
+	F(glGetShaderiv) \
+	F(glGetString) \
+	F(glGetStringi) \
+	F(glGetTexParameteriv) \
+	F(glGetTextureHandleARB) \
+	F(glGetUniformBlockIndex) \
+	F(glGetUniformLocation) \
+	F(glGetVertexAttribiv) \
+	F(glLinkProgram) \
+	F(glMakeTextureHandleNonResidentARB) \
+	F(glMakeTextureHandleResidentARB) \
+	F(glMapBufferRange) \
+	F(glMaxShaderCompilerThreadsARB) \
+	F(glMemoryBarrier) \
+	F(glMultiDrawElementsBaseVertex) \
+	F(glMultiDrawElementsIndirect) \
+	F(glMultiDrawElementsIndirectCountARB) \
+	F(glNamedBufferStorage) \
+	F(glObjectLabel) \
+	F(glPatchParameteri) \
+	F(glPixelStorei) \
+	F(glPolygonOffset) \
+	F(glPopDebugGroup) \
+	F(glProgramBinary) \
+	F(glProgramParameteri) \
+	F(glPushDebugGroup) \
+	F(glQueryCounter) \
+	F(glReadBuffer) \
+	F(glReadPixels) \
+	F(glRenderbufferStorage) \
+	F(glRenderbufferStorageMultisample) \
+	F(glScissor) \
+	F(glSelectPerfMonitorCountersAMD) \
+	F(glShaderBinary) \
+	F(glShaderSource) \
+	F(glShaderStorageBlockBinding) \
+	F(glSpecializeShaderARB) \
+	F(glTexBuffer) \
+	F(glTexImage2D) \
+	F(glTexImage2DMultisample) \
+	F(glTexImage3D) \
+	F(glTexPageCommitmentARB) \
+	F(glTexParameterfv) \
+	F(glTexParameteri) \
+	F(glTexStorage2D) \
+	F(glTexStorage3D) \
+	F(glTexSubImage2D) \
+	F(glTexSubImage3D) \
+	F(glTextureView) \
+	F(glUniform1f) \
+	F(glUniform1i) \
+	F(glUniform1ui) \
+	F(glUniform2f) \
+	F(glUniform2i) \
+	F(glUniform3fv) \
+	F(glUniform3i) \
+	F(glUniform4f) \
+	F(glUniform4fv) \
+	F(glUniform4ui) \
+	F(glUniformBlockBinding) \
+	F(glUniformMatrix4fv) \
+	F(glUnmapBuffer) \
+	F(glUseProgram) \
+	F(glUseProgramStages) \
+	F(glVertexArrayAttribBinding) \
+	F(glVertexArrayAttribFormat) \
+	F(glVertexArrayAttribIFormat) \
+	F(glVertexArrayBindingDivisor) \
+	F(glVertexArrayElementBuffer) \
+	F(glVertexArrayVertexBuffer) \
+	F(glVertexAttribDivisor) \
+	F(glVertexAttribDivisorARB) \
+	F(glVertexAttribI4ui) \
+	F(glVertexAttribIPointer) \
+	F(glVertexAttribPointer) \
+	F(glViewport) \
+	F(glWaitSync)
+
+#define GL_LOADER_NAME(f) #f,
+
+static const char * const glLoaderFunctions[] = {
+	GL_LOADER_FUNCTIONS(GL_LOADER_NAME)
+};
+
+#define GL_LOADER_FUNCTION_COUNT (sizeof(glLoaderFunctions) / sizeof(glLoaderFunctions[0]))
+
+typedef struct {
+	unsigned int resolved;	/* entry points looked up */
+	unsigned int skipped;	/* entry points glad asked for which we do not use */
+} GLLoaderStats;
+
+inline GLLoaderStats *glLoaderStats()
+{
+	static GLLoaderStats stats = { 0, 0 };
+	return &stats;
+}
+
+static int glLoaderCompare(const void *a, const void *b)
+{
+	return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+/* The entry point name of the current context, from EGL for the headless
+* context and from GLFW otherwise. */
+static void *glLoaderProc(const char *name)
+{
+	if (headlessContext()->display)
+		return headlessContext()->proc(name);
+	return (void*)glfwGetProcAddress(name);
+}
+
+/* The GLADloadproc: resolve name if we use it. */
+static void *glLoaderGetProc(const char *name)
+{
+	GLLoaderStats *stats = glLoaderStats();
+	if (!bsearch(&name, glLoaderFunctions, GL_LOADER_FUNCTION_COUNT, sizeof(glLoaderFunctions[0]), glLoaderCompare)) {
+		stats->skipped++;
+		return NULL;
+	}
+	stats->resolved++;
+	return glLoaderProc(name);
+}
+
+/* Load the OpenGL functions for the current context.
+* Returns true if successfull. */
+static bool glLoaderLoad()
+{
+#ifdef GL_LOADER_ALL
+	info("initializing glad, loading all functions");
+	if (headlessContext()->display)
+		return gladLoadGLLoader((GLADloadproc)glLoaderProc) != 0;
+	return gladLoadGL() != 0;
+#else
+	GLLoaderStats *stats = glLoaderStats();
+	stats->resolved = stats->skipped = 0;
+	if (!gladLoadGLLoader((GLADloadproc)glLoaderGetProc))
+		return false;
+	info("initializing glad: resolved %u functions, skipped %u", stats->resolved, stats->skipped);
+	return true;
+#endif
+}
+
+#endif
@@ -0,0 +1,292 @@
+#ifndef HEADER_GLMEMORY_H
+#define HEADER_GLMEMORY_H
+
+#include <glad/glad.h>
+#include "GLLoader.h"
+#include "TextureFile.h"
+#include "MemoryStats.h"
+
+/****************************************************************************
+* GPU MEMORY ACCOUNTING: the allocating GL functions, hooked               *
+****************************************************************************/
+
+/* GL allocates in many places (buffer pools, ring buffers, render targets,
+* the textures of every pass), so rather than counting at each of them,
+* glMemoryInstall() swaps the glad pointers of the functions which give an
+* object storage or delete it for hooks, the way GLTrace.h does. Each hook
+* calls the real function, finds the object by the binding of its target,
+* works out the bytes from the size and format and hands them to
+* memoryStats() in the category of the calling thread. A texture given
+* storage level by level (glTexImage*) adds up its levels: level 0 (of the
+* first face of a cube map) starts it anew. The hooks use the real
+* glGetIntegerv, so that a GL trace started later records what the
+* application called, not what the accounting did. */
+typedef struct {
+	PFNGLGETINTEGERVPROC getIntegerv;
+	PFNGLBUFFERDATAPROC bufferData;
+	PFNGLBUFFERSTORAGEPROC bufferStorage;
+	PFNGLNAMEDBUFFERSTORAGEPROC namedBufferStorage;
+	PFNGLTEXSTORAGE2DPROC texStorage2D;
+	PFNGLTEXSTORAGE3DPROC texStorage3D;
+	PFNGLTEXIMAGE2DPROC texImage2D;
+	PFNGLTEXIMAGE3DPROC texImage3D;
+	PFNGLTEXIMAGE2DMULTISAMPLEPROC texImage2DMultisample;
+	PFNGLCOMPRESSEDTEXIMAGE2DPROC compressedTexImage2D;
+	PFNGLCOMPRESSEDTEXIMAGE3DPROC compressedTexImage3D;
+	PFNGLRENDERBUFFERSTORAGEPROC renderbufferStorage;
+	PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC renderbufferStorageMultisample;
+	PFNGLDELETEBUFFERSPROC deleteBuffers;
+	PFNGLDELETETEXTURESPROC deleteTextures;
+	PFNGLDELETERENDERBUFFERSPROC deleteRenderbuffers;
+	PFNGLDELETEPROGRAMPROC deleteProgram;
+} GLMemoryReal;
+
+/* The real functions, shared by all translation units. */
+inline GLMemoryReal *glMemoryReal()
+{
+	/* zero-initialized, as a static */
+	static GLMemoryReal real;
+	return &real;
+}
+
+/* The name of the object bound to target, 0 if none or if target is
+* not one we know (a proxy). */
+static GLuint glMemoryBound(GLenum target)
+{
+	GLenum binding;
+	GLint name = 0;
+	switch (target) {
+	case GL_ARRAY_BUFFER: binding = GL_ARRAY_BUFFER_BINDING; break;
+	case GL_ELEMENT_ARRAY_BUFFER: binding = GL_ELEMENT_ARRAY_BUFFER_BINDING; break;
+	case GL_COPY_READ_BUFFER: binding = GL_COPY_READ_BUFFER_BINDING; break;
+	case GL_COPY_WRITE_BUFFER: binding = GL_COPY_WRITE_BUFFER_BINDING; break;
+	case GL_PIXEL_PACK_BUFFER: binding = GL_PIXEL_PACK_BUFFER_BINDING; break;
+	case GL_PIXEL_UNPACK_BUFFER: binding = GL_PIXEL_UNPACK_BUFFER_BINDING; break;
+	case GL_UNIFORM_BUFFER: binding = GL_UNIFORM_BUFFER_BINDING; break;
+	case GL_SHADER_STORAGE_BUFFER: binding = GL_SHADER_STORAGE_BUFFER_BINDING; break;
+	case GL_DRAW_INDIRECT_BUFFER: binding = GL_DRAW_INDIRECT_BUFFER_BINDING; break;
+	case GL_DISPATCH_INDIRECT_BUFFER: binding = GL_DISPATCH_INDIRECT_BUFFER_BINDING; break;
+	case GL_ATOMIC_COUNTER_BUFFER: binding = GL_ATOMIC_COUNTER_BUFFER_BINDING; break;
+	case GL_QUERY_BUFFER: binding = GL_QUERY_BUFFER_BINDING; break;
+	case GL_TRANSFORM_FEEDBACK_BUFFER: binding = GL_TRANSFORM_FEEDBACK_BUFFER_BINDING; break;
+	case GL_TEXTURE_BUFFER: binding = GL_TEXTURE_BUFFER; break;
+	case GL_TEXTURE_2D: binding = GL_TEXTURE_BINDING_2D; break;
+	case GL_TEXTURE_2D_ARRAY: binding = GL_TEXTURE_BINDING_2D_ARRAY; break;
+	case GL_TEXTURE_3D: binding = GL_TEXTURE_BINDING_3D; break;
+	case GL_TEXTURE_1D_ARRAY: binding = GL_TEXTURE_BINDING_1D_ARRAY; break;
+	case GL_TEXTURE_RECTANGLE: binding = GL_TEXTURE_BINDING_RECTANGLE; break;
+	case GL_TEXTURE_CUBE_MAP:
+	case GL_TEXTURE_CUBE_MAP_POSITIVE_X: case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+	case GL_TEXTURE_CUBE_MAP_POSITIVE_Y: case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+	case GL_TEXTURE_CUBE_MAP_POSITIVE_Z: case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+		binding = GL_TEXTURE_BINDING_CUBE_MAP; break;
+	case GL_TEXTURE_CUBE_MAP_ARRAY: binding = GL_TEXTURE_BINDING_CUBE_MAP_ARRAY; break;
+	case GL_TEXTURE_2D_MULTISAMPLE: binding = GL_TEXTURE_BINDING_2D_MULTISAMPLE; break;
+	case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: binding = GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY; break;
+	case GL_RENDERBUFFER: binding = GL_RENDERBUFFER_BINDING; break;
+	default: return 0;
+	}
+	glMemoryReal()->getIntegerv(binding, &name);
+	return (GLuint)name;
+}
+
+/* Bytes per texel of an uncompressed internal format, 0 for a block
+* compressed one. The formats with three components count three, what
+* the driver pads them to is its business. */
+static GLuint glMemoryTexelBytes(GLenum format)
+{
+	switch (format) {
+	case GL_R8: case GL_R8_SNORM: case GL_R8UI: case GL_R8I: case GL_RED:
+		return 1;
+	case GL_R16: case GL_R16F: case GL_R16UI: case GL_R16I: case GL_RG8: case GL_RG8_SNORM:
+	case GL_RG8UI: case GL_RG8I: case GL_RG: case GL_DEPTH_COMPONENT16:
+		return 2;
+	case GL_RGB8: case GL_SRGB8: case GL_RGB8UI: case GL_RGB8I: case GL_RGB:
+		return 3;
+	case GL_RGB16: case GL_RGB16F: case GL_RGB16UI: case GL_RGB16I:
+		return 6;
+	case GL_RGBA16: case GL_RGBA16F: case GL_RGBA16UI: case GL_RGBA16I: case GL_RG32F: case GL_RG32UI:
+	case GL_RG32I: case GL_DEPTH32F_STENCIL8:
+		return 8;
+	case GL_RGB32F: case GL_RGB32UI: case GL_RGB32I:
+		return 12;
+	case GL_RGBA32F: case GL_RGBA32UI: case GL_RGBA32I:
+		return 16;
+	default:
+		/* RGBA8 and the other 32 bit formats, depth included */
+		return textureFormatDesc(format) ? 0 : 4;
+	}
+}
+
+/* Bytes of levels mip levels of a width x height x depth texture in
+* format, depth only shrinking with the levels if shrinkDepth (3D). */
+static GLuint64 glMemoryTextureBytes(GLenum format, GLsizei width, GLsizei height, GLsizei depth, GLsizei levels,
+	bool shrinkDepth)
+{
+	const TextureFormatDesc *desc = textureFormatDesc(format);
+	GLuint bw = desc ? desc->blockWidth : 1, bh = desc ? desc->blockHeight : 1;
+	GLuint bb = desc ? desc->blockBytes : glMemoryTexelBytes(format);
+	GLuint64 bytes = 0;
+	GLsizei l;
+	for (l = 0; l < levels; l++) {
+		GLuint64 d = shrinkDepth ? (GLuint64)((depth >> l) ? depth >> l : 1) : (GLuint64)depth;
+		bytes += textureLevelSize((GLuint)width, (GLuint)height, (GLuint)l, bw, bh, bb) * d;
+	}
+	return bytes;
+}
+
+/* whether the level of target starts the texture anew, see above */
+static bool glMemoryFirstLevel(GLenum target, GLint level)
+{
+	return !level && (target < GL_TEXTURE_CUBE_MAP_NEGATIVE_X || target > GL_TEXTURE_CUBE_MAP_NEGATIVE_Z);
+}
+
+static void APIENTRY glMemoryBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+	glMemoryReal()->bufferData(target, size, data, usage);
+	memoryStats()->setObject(MEMORY_BUFFER, glMemoryBound(target), (long long)size, memoryCategory());
+}
+
+static void APIENTRY glMemoryBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+	glMemoryReal()->bufferStorage(target, size, data, flags);
+	memoryStats()->setObject(MEMORY_BUFFER, glMemoryBound(target), (long long)size, memoryCategory());
+}
+
+static void APIENTRY glMemoryNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+	glMemoryReal()->namedBufferStorage(buffer, size, data, flags);
+	memoryStats()->setObject(MEMORY_BUFFER, buffer, (long long)size, memoryCategory());
+}
+
+static void APIENTRY glMemoryTexStorage2D(GLenum target, GLsizei levels, GLenum format, GLsizei width, GLsizei height)
+{
+	glMemoryReal()->texStorage2D(target, levels, format, width, height);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target),
+		(long long)glMemoryTextureBytes(format, width, height, target == GL_TEXTURE_CUBE_MAP ? 6 : 1, levels, false),
+		memoryCategory());
+}
+
+static void APIENTRY glMemoryTexStorage3D(GLenum target, GLsizei levels, GLenum format, GLsizei width, GLsizei height,
+	GLsizei depth)
+{
+	glMemoryReal()->texStorage3D(target, levels, format, width, height, depth);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target),
+		(long long)glMemoryTextureBytes(format, width, height, depth, levels, target == GL_TEXTURE_3D), memoryCategory());
+}
+
+static void APIENTRY glMemoryTexImage2D(GLenum target, GLint level, GLint format, GLsizei width, GLsizei height,
+	GLint border, GLenum pixelFormat, GLenum type, const void *pixels)
+{
+	glMemoryReal()->texImage2D(target, level, format, width, height, border, pixelFormat, type, pixels);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target),
+		(long long)glMemoryTextureBytes((GLenum)format, width, height, 1, 1, false), memoryCategory(),
+		!glMemoryFirstLevel(target, level));
+}
+
+static void APIENTRY glMemoryTexImage3D(GLenum target, GLint level, GLint format, GLsizei width, GLsizei height,
+	GLsizei depth, GLint border, GLenum pixelFormat, GLenum type, const void *pixels)
+{
+	glMemoryReal()->texImage3D(target, level, format, width, height, depth, border, pixelFormat, type, pixels);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target),
+		(long long)glMemoryTextureBytes((GLenum)format, width, height, depth, 1, false), memoryCategory(), level != 0);
+}
+
+static void APIENTRY glMemoryTexImage2DMultisample(GLenum target, GLsizei samples, GLenum format, GLsizei width,
+	GLsizei height, GLboolean fixedLocations)
+{
+	glMemoryReal()->texImage2DMultisample(target, samples, format, width, height, fixedLocations);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target),
+		(long long)glMemoryTextureBytes(format, width, height, samples > 1 ? samples : 1, 1, false), memoryCategory());
+}
+
+static void APIENTRY glMemoryCompressedTexImage2D(GLenum target, GLint level, GLenum format, GLsizei width,
+	GLsizei height, GLint border, GLsizei imageSize, const void *data)
+{
+	glMemoryReal()->compressedTexImage2D(target, level, format, width, height, border, imageSize, data);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target), (long long)imageSize, memoryCategory(),
+		!glMemoryFirstLevel(target, level));
+}
+
+static void APIENTRY glMemoryCompressedTexImage3D(GLenum target, GLint level, GLenum format, GLsizei width,
+	GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void *data)
+{
+	glMemoryReal()->compressedTexImage3D(target, level, format, width, height, depth, border, imageSize, data);
+	memoryStats()->setObject(MEMORY_TEXTURE, glMemoryBound(target), (long long)imageSize, memoryCategory(), level != 0);
+}
+
+static void APIENTRY glMemoryRenderbufferStorage(GLenum target, GLenum format, GLsizei width, GLsizei height)
+{
+	glMemoryReal()->renderbufferStorage(target, format, width, height);
+	memoryStats()->setObject(MEMORY_RENDERBUFFER, glMemoryBound(target),
+		(long long)glMemoryTextureBytes(format, width, height, 1, 1, false), memoryCategory());
+}
+
+static void APIENTRY glMemoryRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum format,
+	GLsizei width, GLsizei height)
+{
+	glMemoryReal()->renderbufferStorageMultisample(target, samples, format, width, height);
+	memoryStats()->setObject(MEMORY_RENDERBUFFER, glMemoryBound(target),
+		(long long)glMemoryTextureBytes(format, width, height, samples > 1 ? samples : 1, 1, false), memoryCategory());
+}
+
+static void APIENTRY glMemoryDeleteBuffers(GLsizei n, const GLuint *names)
+{
+	GLsizei i;
+	for (i = 0; i < n; i++)
+		memoryStats()->releaseObject(MEMORY_BUFFER, names[i]);
+	glMemoryReal()->deleteBuffers(n, names);
+}
+
+static void APIENTRY glMemoryDeleteTextures(GLsizei n, const GLuint *names)
+{
+	GLsizei i;
+	for (i = 0; i < n; i++)
+		memoryStats()->releaseObject(MEMORY_TEXTURE, names[i]);
+	glMemoryReal()->deleteTextures(n, names);
+}
+
+static void APIENTRY glMemoryDeleteRenderbuffers(GLsizei n, const GLuint *names)
+{
+	GLsizei i;
+	for (i = 0; i < n; i++)
+		memoryStats()->releaseObject(MEMORY_RENDERBUFFER, names[i]);
+	glMemoryReal()->deleteRenderbuffers(n, names);
+}
+
+static void APIENTRY glMemoryDeleteProgram(GLuint program)
+{
+	memoryStats()->releaseObject(MEMORY_PROGRAM, program);
+	glMemoryReal()->deleteProgram(program);
+}
+
+/* Swap the glad pointers for the hooks, once the functions are loaded and
+* before a GL trace hooks them in turn. Functions the context lacks stay
+* NULL. */
+#define GL_MEMORY_HOOK(f, member, hook) \
+	if ((real->member = glad_##f) != NULL) \
+		glad_##f = hook;
+static void glMemoryInstall()
+{
+	GLMemoryReal *real = glMemoryReal();
+	real->getIntegerv = glad_glGetIntegerv;
+	GL_MEMORY_HOOK(glBufferData, bufferData, glMemoryBufferData)
+	GL_MEMORY_HOOK(glBufferStorage, bufferStorage, glMemoryBufferStorage)
+	GL_MEMORY_HOOK(glNamedBufferStorage, namedBufferStorage, glMemoryNamedBufferStorage)
+	GL_MEMORY_HOOK(glTexStorage2D, texStorage2D, glMemoryTexStorage2D)
+	GL_MEMORY_HOOK(glTexStorage3D, texStorage3D, glMemoryTexStorage3D)
+	GL_MEMORY_HOOK(glTexImage2D, texImage2D, glMemoryTexImage2D)
+	GL_MEMORY_HOOK(glTexImage3D, texImage3D, glMemoryTexImage3D)
+	GL_MEMORY_HOOK(glTexImage2DMultisample, texImage2DMultisample, glMemoryTexImage2DMultisample)
+	GL_MEMORY_HOOK(glCompressedTexImage2D, compressedTexImage2D, glMemoryCompressedTexImage2D)
+	GL_MEMORY_HOOK(glCompressedTexImage3D, compressedTexImage3D, glMemoryCompressedTexImage3D)
+	GL_MEMORY_HOOK(glRenderbufferStorage, renderbufferStorage, glMemoryRenderbufferStorage)
+	GL_MEMORY_HOOK(glRenderbufferStorageMultisample, renderbufferStorageMultisample, glMemoryRenderbufferStorageMultisample)
+	GL_MEMORY_HOOK(glDeleteBuffers, deleteBuffers, glMemoryDeleteBuffers)
+	GL_MEMORY_HOOK(glDeleteTextures, deleteTextures, glMemoryDeleteTextures)
+	GL_MEMORY_HOOK(glDeleteRenderbuffers, deleteRenderbuffers, glMemoryDeleteRenderbuffers)
+	GL_MEMORY_HOOK(glDeleteProgram, deleteProgram, glMemoryDeleteProgram)
+}
+#undef GL_MEMORY_HOOK
+
+#endif
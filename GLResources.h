@@ -0,0 +1,293 @@
+#ifndef HEADER_GLRESOURCES_H
+#define HEADER_GLRESOURCES_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include "Log.h"
+#include "GLState.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* GL RESOURCES: shared objects behind generational handles                 *
+****************************************************************************/
+
+/* GLResourceTable: the buffers, VAOs, programs and textures of the
+* application which may be shared, each an entry with its GL name, a
+* reference count and, for objects made from data, a hash of that data.
+* Whoever creates an object from data first looks for an entry with the
+* same hash and takes a reference to it instead, so the same mesh or
+* texture file loaded twice is a single object on the GPU, uploaded once.
+* The last release() deletes the object via the state cache, so the delete
+* waits for the frames which may still use it (see GLState.h).
+* A handle holds the index of its entry plus one and the generation of
+* that entry, and a handle type per kind of object keeps them apart; a
+* handle whose entry was released and reused (for the next 255 times) no
+* longer resolves, name() returns 0 for it. The entries are a dense array
+* with a free list, the hashes chained into GL_RESOURCE_BUCKETS buckets.
+* The table belongs to the thread which owns the context, see
+* glResources(). */
+#define GL_RESOURCE_INDEX_BITS 24	/* of a handle, the rest is the generation */
+#define GL_RESOURCE_BUCKETS 256
+
+typedef struct { unsigned int id; } BufferHandle;
+typedef struct { unsigned int id; } VertexArrayHandle;
+typedef struct { unsigned int id; } ProgramHandle;
+typedef struct { unsigned int id; } TextureHandle;
+
+typedef struct {
+	GLuint name;
+	GLenum type;		/* GL_BUFFER, GL_VERTEX_ARRAY, GL_PROGRAM or GL_TEXTURE, 0 if free */
+	int refs;
+	unsigned int generation;
+	GLuint64 hash;		/* of the data it was made from, 0 if it is not shared */
+	GLsizeiptr size;	/* bytes of that data */
+	int next;		/* the next entry in the bucket of hash, or the next free one, plus one */
+} GLResourceEntry;
+
+/* Delete the object name of type, via the state cache. */
+static void glResourceDelete(GLenum type, GLuint name)
+{
+	switch (type) {
+		case GL_BUFFER: glState()->deleteBuffers(1, &name); break;
+		case GL_VERTEX_ARRAY: glState()->deleteVertexArrays(1, &name); break;
+		case GL_PROGRAM: glState()->deleteProgram(name); break;
+		case GL_TEXTURE: glState()->deleteTextures(1, &name); break;
+	}
+}
+
+/* The hash of the size bytes at data, never 0. */
+static GLuint64 glResourceHash(const void *data, size_t size)
+{
+	GLuint64 h = hashFNV1a(&size, sizeof(size), HASH_FNV1A_INIT);
+	h = hashFNV1a(data, size, h);
+	return h ? h : 1;
+}
+
+typedef struct {
+	GLResourceEntry *entries;
+	int count, capacity;	/* entries used at some point, allocated */
+	/* entries plus one, 0 for none, so an all zero table is empty */
+	int firstFree;
+	int buckets[GL_RESOURCE_BUCKETS];	/* the first entry per hash */
+	int live;		/* objects */
+	unsigned int shared;	/* times an object was found instead of made */
+	GLsizeiptr sharedBytes;	/* the uploads that saved */
+
+	void clear()
+	{
+		int i;
+		entries = NULL;
+		count = capacity = 0;
+		firstFree = 0;
+		for (i = 0; i < GL_RESOURCE_BUCKETS; i++)
+			buckets[i] = 0;
+		live = 0;
+		shared = 0;
+		sharedBytes = 0;
+	}
+
+	/* Delete whatever is still referenced and free the table. */
+	void destroy()
+	{
+		int i;
+		if (live)
+			info("GL resources: %d objects left, %u loads shared %u KB", live, shared,
+				(unsigned)(sharedBytes >> 10));
+		for (i = 0; i < count; i++) {
+			if (entries[i].type)
+				remove(i);
+		}
+		free(entries);
+		clear();
+	}
+
+	/* The index of the live entry of type id refers to, -1 if none. */
+	int entry(unsigned int id, GLenum type) const
+	{
+		int i = (int)(id & ((1u << GL_RESOURCE_INDEX_BITS) - 1)) - 1;
+		if (i < 0 || i >= count || entries[i].type != type ||
+			entries[i].generation != (id >> GL_RESOURCE_INDEX_BITS))
+			return -1;
+		return i;
+	}
+
+	unsigned int handle(int i) const
+	{
+		return (unsigned int)(i + 1) | (entries[i].generation << GL_RESOURCE_INDEX_BITS);
+	}
+
+	/* Add an entry for name of type, made from size bytes hashing to
+	* hash, 0 if it is not to be shared. The table owns name from now on.
+	* Returns its id, 0 for a name of 0 or in case of an error. */
+	unsigned int add(GLenum type, GLuint name, GLuint64 hash, GLsizeiptr size)
+	{
+		int i;
+		if (!name)
+			return 0;
+		if (firstFree) {
+			i = firstFree - 1;
+			firstFree = entries[i].next;
+		} else {
+			if (count == capacity) {
+				int n = capacity ? capacity * 2 : 64;
+				GLResourceEntry *grown = (n < (1 << GL_RESOURCE_INDEX_BITS)) ?
+					(GLResourceEntry*)realloc(entries, sizeof(GLResourceEntry) * n) : NULL;
+				if (!grown) {
+					warn("GL resources: no room for another object");
+					glResourceDelete(type, name);
+					return 0;
+				}
+				entries = grown;
+				capacity = n;
+			}
+			i = count++;
+			entries[i].generation = 0;
+		}
+		GLResourceEntry *e = &entries[i];
+		e->name = name;
+		e->type = type;
+		e->refs = 1;
+		e->hash = hash;
+		e->size = size;
+		e->next = 0;
+		if (hash) {
+			int *b = &buckets[hash % GL_RESOURCE_BUCKETS];
+			e->next = *b;
+			*b = i + 1;
+		}
+		live++;
+		return handle(i);
+	}
+
+	/* Take a reference to the object of type made from size bytes hashing
+	* to hash.
+	* Returns its id, 0 if there is none. */
+	unsigned int find(GLenum type, GLuint64 hash, GLsizeiptr size)
+	{
+		int i;
+		for (i = buckets[hash % GL_RESOURCE_BUCKETS] - 1; i >= 0; i = entries[i].next - 1) {
+			GLResourceEntry *e = &entries[i];
+			if (e->type == type && e->hash == hash && e->size == size) {
+				e->refs++;
+				shared++;
+				sharedBytes += size;
+				return handle(i);
+			}
+		}
+		return 0;
+	}
+
+	/* Delete the object of entry i and free the entry. */
+	void remove(int i)
+	{
+		GLResourceEntry *e = &entries[i];
+		if (e->hash) {
+			int *link = &buckets[e->hash % GL_RESOURCE_BUCKETS];
+			while (*link != i + 1)
+				link = &entries[*link - 1].next;
+			*link = e->next;
+		}
+		glResourceDelete(e->type, e->name);
+		e->type = 0;
+		e->name = 0;
+		/* the next generation of the entry no longer resolves the old handles */
+		e->generation = (e->generation + 1) & ((1u << (32 - GL_RESOURCE_INDEX_BITS)) - 1);
+		e->next = firstFree;
+		firstFree = i + 1;
+		live--;
+	}
+
+	/* The references to the object of id, 0 if it is gone. */
+	int references(unsigned int id, GLenum type) const
+	{
+		int i = entry(id, type);
+		return (i >= 0) ? entries[i].refs : 0;
+	}
+
+	/* Take another reference to the object of id.
+	* Returns id, 0 if it is gone. */
+	unsigned int acquire(unsigned int id, GLenum type)
+	{
+		int i = entry(id, type);
+		if (i < 0)
+			return 0;
+		entries[i].refs++;
+		return id;
+	}
+
+	/* Drop a reference to the object of id, the last one deletes it.
+	* Does nothing for 0 or a handle which no longer resolves. */
+	void release(unsigned int id, GLenum type)
+	{
+		int i = entry(id, type);
+		if (i >= 0 && --entries[i].refs == 0)
+			remove(i);
+	}
+
+	GLuint name(unsigned int id, GLenum type) const
+	{
+		int i = entry(id, type);
+		return (i >= 0) ? entries[i].name : 0;
+	}
+
+	/* the same per type of handle: adopt takes over a name, with the
+	* hash and size of its data if it may be shared, find looks for one
+	* to share */
+	BufferHandle adoptBuffer(GLuint n, GLuint64 hash = 0, GLsizeiptr size = 0)
+	{
+		BufferHandle h = { add(GL_BUFFER, n, hash, size) };
+		return h;
+	}
+	BufferHandle findBuffer(GLuint64 hash, GLsizeiptr size)
+	{
+		BufferHandle h = { find(GL_BUFFER, hash, size) };
+		return h;
+	}
+	VertexArrayHandle adoptVertexArray(GLuint n)
+	{
+		VertexArrayHandle h = { add(GL_VERTEX_ARRAY, n, 0, 0) };
+		return h;
+	}
+	ProgramHandle adoptProgram(GLuint n, GLuint64 hash = 0)
+	{
+		ProgramHandle h = { add(GL_PROGRAM, n, hash, 0) };
+		return h;
+	}
+	ProgramHandle findProgram(GLuint64 hash)
+	{
+		ProgramHandle h = { find(GL_PROGRAM, hash, 0) };
+		return h;
+	}
+	TextureHandle adoptTexture(GLuint n, GLuint64 hash = 0, GLsizeiptr size = 0)
+	{
+		TextureHandle h = { add(GL_TEXTURE, n, hash, size) };
+		return h;
+	}
+	TextureHandle findTexture(GLuint64 hash, GLsizeiptr size)
+	{
+		TextureHandle h = { find(GL_TEXTURE, hash, size) };
+		return h;
+	}
+
+	GLuint name(BufferHandle h) const { return name(h.id, GL_BUFFER); }
+	GLuint name(VertexArrayHandle h) const { return name(h.id, GL_VERTEX_ARRAY); }
+	GLuint name(ProgramHandle h) const { return name(h.id, GL_PROGRAM); }
+	GLuint name(TextureHandle h) const { return name(h.id, GL_TEXTURE); }
+	int references(TextureHandle h) const { return references(h.id, GL_TEXTURE); }
+	BufferHandle acquire(BufferHandle h) { h.id = acquire(h.id, GL_BUFFER); return h; }
+	TextureHandle acquire(TextureHandle h) { h.id = acquire(h.id, GL_TEXTURE); return h; }
+	void release(BufferHandle h) { release(h.id, GL_BUFFER); }
+	void release(VertexArrayHandle h) { release(h.id, GL_VERTEX_ARRAY); }
+	void release(ProgramHandle h) { release(h.id, GL_PROGRAM); }
+	void release(TextureHandle h) { release(h.id, GL_TEXTURE); }
+} GLResourceTable;
+
+/* The table of the process, see above. This is an inline function with a
+* static local, so all translation units share it. */
+inline GLResourceTable *glResources()
+{
+	static GLResourceTable table = { 0 };
+	return &table;
+}
+
+#endif
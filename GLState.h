@@ -0,0 +1,518 @@
+#ifndef HEADER_GLSTATE_H
+#define HEADER_GLSTATE_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+
+/****************************************************************************
+* GL STATE CACHE                                                           *
+****************************************************************************/
+
+/* GLStateCache: a shadow copy of the GL state the application changes
+* during a frame: the program and pipeline, the VAO, the buffer and texture
+* bindings, the viewport, the color mask and the depth, blend and cull
+* state. All changes of that state go through it, so a call which would set
+* the value which is already set is skipped. issued and elided count the calls which reached
+* the driver and the ones which were skipped, draws the draw calls, which
+* the passes report with countDraw().
+* The cache only knows what went through it. invalidate() forgets
+* everything, e.g. after code which changed the state behind its back, and
+* the next change of every value is issued again. Objects must be deleted
+* via the cache too, since GL unbinds a deleted object and may reuse its
+* name.
+* Deleting an object the GPU may still use makes some drivers wait until
+* it is idle. Once deferDeletes() gave it the frame being recorded, the
+* cache only queues the buffers, textures, VAOs, programs and pipelines
+* deleted during it, and releaseDeletes() deletes them in batches, those
+* of a frame once the GPU is done with it (see FrameThrottle.h). Until
+* then their names stay taken, and their bindings unknown. */
+#define GL_STATE_UNKNOWN 0xffffffffu	/* a value no GL name or enum has */
+#define GL_STATE_TEXTURE_UNITS 16	/* units above go uncached */
+
+/* the buffer binding points shadowed, see glStateBufferSlot */
+#define GL_STATE_BUFFER_ARRAY 0
+#define GL_STATE_BUFFER_ELEMENT_ARRAY 1	/* part of the bound VAO */
+#define GL_STATE_BUFFER_UNIFORM 2
+#define GL_STATE_BUFFER_SHADER_STORAGE 3
+#define GL_STATE_BUFFER_DRAW_INDIRECT 4
+#define GL_STATE_BUFFER_PARAMETER 5
+#define GL_STATE_BUFFER_ATOMIC_COUNTER 6
+#define GL_STATE_BUFFER_COPY_READ 7
+#define GL_STATE_BUFFER_COPY_WRITE 8
+#define GL_STATE_BUFFER_TARGETS 9
+
+/* the texture targets shadowed per unit */
+#define GL_STATE_TEXTURE_2D 0
+#define GL_STATE_TEXTURE_2D_ARRAY 1
+#define GL_STATE_TEXTURE_TARGETS 2
+
+/* The raster state a program draws with, as set by GLStateCache::raster:
+* back-face culling, depth writes, alpha blending and coarse shading. The
+* depth test itself is always on. Translucent programs leave the blending
+* to the transparency pass they draw in, see Transparency.h. */
+#define RASTER_CULL 1u		/* cull back faces (counter-clockwise is front) */
+#define RASTER_DEPTH_WRITE 2u	/* write the depth of the fragments */
+#define RASTER_BLEND 4u		/* blend with source alpha */
+#define RASTER_COARSE 8u	/* shade at the rates of the shading-rate image, see ShadingRate.h */
+#define RASTER_TRANSLUCENT 16u	/* order-independent transparency, blending is not touched */
+#define RASTER_DEFAULT RASTER_DEPTH_WRITE	/* what the context starts with */
+#define RASTER_OPAQUE (RASTER_CULL | RASTER_DEPTH_WRITE)
+
+/* an object deleted while a frame was recorded */
+typedef struct {
+	GLenum type;		/* GL_BUFFER, GL_TEXTURE, GL_VERTEX_ARRAY, GL_PROGRAM or GL_PROGRAM_PIPELINE */
+	GLuint name;
+	unsigned long long frame;	/* of the FrameThrottle */
+} GLStateDeleted;
+
+#define GL_STATE_DELETE_BATCH 64	/* names per glDelete* call */
+
+/* Delete n objects of type, as named in GLStateDeleted. */
+static void glStateDelete(GLenum type, GLsizei n, const GLuint *names)
+{
+	GLsizei i;
+	switch (type) {
+		case GL_BUFFER: glDeleteBuffers(n, names); break;
+		case GL_TEXTURE: glDeleteTextures(n, names); break;
+		case GL_VERTEX_ARRAY: glDeleteVertexArrays(n, names); break;
+		case GL_PROGRAM_PIPELINE: glDeleteProgramPipelines(n, names); break;
+		case GL_PROGRAM:
+			for (i = 0; i < n; i++)
+				glDeleteProgram(names[i]);
+			break;
+	}
+}
+
+/* The shadow slot of a buffer binding point, -1 for other targets. */
+static int glStateBufferSlot(GLenum target)
+{
+	switch (target) {
+		case GL_ARRAY_BUFFER: return GL_STATE_BUFFER_ARRAY;
+		case GL_ELEMENT_ARRAY_BUFFER: return GL_STATE_BUFFER_ELEMENT_ARRAY;
+		case GL_UNIFORM_BUFFER: return GL_STATE_BUFFER_UNIFORM;
+		case GL_SHADER_STORAGE_BUFFER: return GL_STATE_BUFFER_SHADER_STORAGE;
+		case GL_DRAW_INDIRECT_BUFFER: return GL_STATE_BUFFER_DRAW_INDIRECT;
+		case GL_PARAMETER_BUFFER_ARB: return GL_STATE_BUFFER_PARAMETER;
+		case GL_ATOMIC_COUNTER_BUFFER: return GL_STATE_BUFFER_ATOMIC_COUNTER;
+		case GL_COPY_READ_BUFFER: return GL_STATE_BUFFER_COPY_READ;
+		case GL_COPY_WRITE_BUFFER: return GL_STATE_BUFFER_COPY_WRITE;
+	}
+	return -1;
+}
+
+/* The shadow slot of a texture target, -1 for other targets. */
+static int glStateTextureSlot(GLenum target)
+{
+	switch (target) {
+		case GL_TEXTURE_2D: return GL_STATE_TEXTURE_2D;
+		case GL_TEXTURE_2D_ARRAY: return GL_STATE_TEXTURE_2D_ARRAY;
+	}
+	return -1;
+}
+
+typedef struct {
+	GLuint program, pipeline, vao;
+	GLuint buffers[GL_STATE_BUFFER_TARGETS];
+	GLuint activeUnit;	/* 0 based, not GL_TEXTURE0 based */
+	GLuint textures[GL_STATE_TEXTURE_UNITS][GL_STATE_TEXTURE_TARGETS];
+	GLint viewportRect[4];
+	GLuint depthTest, blend, cullFace;	/* GL_TRUE, GL_FALSE or unknown */
+	GLenum coarseCap;	/* what RASTER_COARSE enables, 0 while it has no effect */
+	GLuint coarse;		/* the shadow of coarseCap */
+	GLuint depthFuncValue, depthMaskValue;
+	GLuint blendSrc, blendDst;
+	GLuint cullFaceMode;
+	GLuint colorMaskBits;	/* bit i is component i */
+
+	/* calls since the last report() */
+	unsigned int issued;	/* reached the driver */
+	unsigned int elided;	/* skipped, the value was already set */
+	unsigned int draws;	/* glDraw* and glMultiDraw* calls */
+	/* per frame averages, computed by report() */
+	double avgIssued, avgElided, avgDraws;
+
+	/* the deferred deletes */
+	unsigned long long deleteFrame;	/* being recorded, 0 to delete at once */
+	GLStateDeleted *deleted;	/* in the order of their frames */
+	int deletedCount, deletedCapacity;
+
+	/* Forget all shadowed values. */
+	void invalidate()
+	{
+		int i, j;
+		program = pipeline = vao = GL_STATE_UNKNOWN;
+		for (i = 0; i < GL_STATE_BUFFER_TARGETS; i++)
+			buffers[i] = GL_STATE_UNKNOWN;
+		activeUnit = GL_STATE_UNKNOWN;
+		for (i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+			for (j = 0; j < GL_STATE_TEXTURE_TARGETS; j++)
+				textures[i][j] = GL_STATE_UNKNOWN;
+		viewportRect[0] = viewportRect[1] = viewportRect[2] = viewportRect[3] = -1;
+		depthTest = blend = cullFace = coarse = GL_STATE_UNKNOWN;
+		depthFuncValue = depthMaskValue = GL_STATE_UNKNOWN;
+		blendSrc = blendDst = GL_STATE_UNKNOWN;
+		cullFaceMode = GL_STATE_UNKNOWN;
+		colorMaskBits = GL_STATE_UNKNOWN;
+	}
+
+	/* Called once per second with the number of frames since the last
+	* call, updates the averages and restarts counting. */
+	void report(unsigned int frames)
+	{
+		avgIssued = frames ? (double)issued / (double)frames : -1.0;
+		avgElided = frames ? (double)elided / (double)frames : -1.0;
+		avgDraws = frames ? (double)draws / (double)frames : -1.0;
+		issued = elided = draws = 0;
+	}
+
+	/* Count a draw call, a multi-draw counts once. */
+	void countDraw()
+	{
+		draws++;
+	}
+
+	/* Set *shadow to value. Returns true if the call must be issued. */
+	bool change(GLuint *shadow, GLuint value)
+	{
+		if (*shadow == value) {
+			elided++;
+			return false;
+		}
+		*shadow = value;
+		issued++;
+		return true;
+	}
+
+	void useProgram(GLuint p)
+	{
+		if (change(&program, p))
+			glUseProgram(p);
+	}
+
+	void bindProgramPipeline(GLuint p)
+	{
+		if (change(&pipeline, p))
+			glBindProgramPipeline(p);
+	}
+
+	void bindVertexArray(GLuint v)
+	{
+		if (change(&vao, v)) {
+			glBindVertexArray(v);
+			/* the element buffer binding belongs to the VAO */
+			buffers[GL_STATE_BUFFER_ELEMENT_ARRAY] = GL_STATE_UNKNOWN;
+		}
+	}
+
+	void bindBuffer(GLenum target, GLuint buffer)
+	{
+		int slot = glStateBufferSlot(target);
+		if (slot < 0) {
+			issued++;
+			glBindBuffer(target, buffer);
+		} else if (change(&buffers[slot], buffer)) {
+			glBindBuffer(target, buffer);
+		}
+	}
+
+	/* The indexed bindings are not shadowed, but these also set the
+	* generic binding of target. */
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+	{
+		int slot = glStateBufferSlot(target);
+		issued++;
+		glBindBufferBase(target, index, buffer);
+		if (slot >= 0)
+			buffers[slot] = buffer;
+	}
+
+	void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		int slot = glStateBufferSlot(target);
+		issued++;
+		glBindBufferRange(target, index, buffer, offset, size);
+		if (slot >= 0)
+			buffers[slot] = buffer;
+	}
+
+	/* unit is GL_TEXTURE0 based, as for glActiveTexture */
+	void activeTexture(GLenum unit)
+	{
+		if (change(&activeUnit, unit - GL_TEXTURE0))
+			glActiveTexture(unit);
+	}
+
+	void bindTexture(GLenum target, GLuint texture)
+	{
+		int slot = glStateTextureSlot(target);
+		if (slot < 0 || activeUnit >= GL_STATE_TEXTURE_UNITS) {
+			issued++;
+			glBindTexture(target, texture);
+		} else if (change(&textures[activeUnit][slot], texture)) {
+			glBindTexture(target, texture);
+		}
+	}
+
+	void viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+	{
+		if (viewportRect[0] == x && viewportRect[1] == y && viewportRect[2] == w && viewportRect[3] == h) {
+			elided++;
+			return;
+		}
+		viewportRect[0] = x;
+		viewportRect[1] = y;
+		viewportRect[2] = w;
+		viewportRect[3] = h;
+		issued++;
+		glViewport(x, y, w, h);
+	}
+
+	/* The shadow of a capability, NULL if it is not shadowed. */
+	GLuint *capability(GLenum cap)
+	{
+		if (coarseCap && cap == coarseCap)
+			return &coarse;
+		switch (cap) {
+			case GL_DEPTH_TEST: return &depthTest;
+			case GL_BLEND: return &blend;
+			case GL_CULL_FACE: return &cullFace;
+		}
+		return NULL;
+	}
+
+	void enable(GLenum cap)
+	{
+		GLuint *shadow = capability(cap);
+		if (!shadow) {
+			issued++;
+			glEnable(cap);
+		} else if (change(shadow, GL_TRUE)) {
+			glEnable(cap);
+		}
+	}
+
+	void disable(GLenum cap)
+	{
+		GLuint *shadow = capability(cap);
+		if (!shadow) {
+			issued++;
+			glDisable(cap);
+		} else if (change(shadow, GL_FALSE)) {
+			glDisable(cap);
+		}
+	}
+
+	void depthFunc(GLenum func)
+	{
+		if (change(&depthFuncValue, func))
+			glDepthFunc(func);
+	}
+
+	void depthMask(GLboolean mask)
+	{
+		if (change(&depthMaskValue, mask))
+			glDepthMask(mask);
+	}
+
+	void blendFunc(GLenum src, GLenum dst)
+	{
+		if (blendSrc == src && blendDst == dst) {
+			elided++;
+			return;
+		}
+		blendSrc = src;
+		blendDst = dst;
+		issued++;
+		glBlendFunc(src, dst);
+	}
+
+	/* The blend function of draw buffer buf only. The functions of the
+	* buffers differ afterwards, so blendFunc sets them all again. */
+	void blendFunci(GLuint buf, GLenum src, GLenum dst)
+	{
+		blendSrc = blendDst = GL_STATE_UNKNOWN;
+		issued++;
+		glBlendFunci(buf, src, dst);
+	}
+
+	void cullFaceSide(GLenum mode)
+	{
+		if (change(&cullFaceMode, mode))
+			glCullFace(mode);
+	}
+
+	void colorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+	{
+		GLuint bits = (r ? 1u : 0u) | (g ? 2u : 0u) | (b ? 4u : 0u) | (a ? 8u : 0u);
+		if (change(&colorMaskBits, bits))
+			glColorMask(r, g, b, a);
+	}
+
+	/* Set the raster state of flags, a mask of RASTER_* bits. */
+	void raster(unsigned int flags)
+	{
+		if (flags & RASTER_CULL) {
+			enable(GL_CULL_FACE);
+			cullFaceSide(GL_BACK);
+		} else {
+			disable(GL_CULL_FACE);
+		}
+		depthMask((flags & RASTER_DEPTH_WRITE) ? GL_TRUE : GL_FALSE);
+		if (flags & RASTER_TRANSLUCENT) {
+			/* set up by the transparency pass */
+		} else if (flags & RASTER_BLEND) {
+			enable(GL_BLEND);
+			blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		} else {
+			disable(GL_BLEND);
+		}
+		if (coarseCap) {
+			if (flags & RASTER_COARSE)
+				enable(coarseCap);
+			else
+				disable(coarseCap);
+		}
+	}
+
+	/* Deleting objects: GL unbinds them wherever they are bound in the
+	* current context, and the names may be handed out again. */
+	/* Queue the n objects of type in names, if deletes are deferred.
+	* Returns false if they must be deleted now. */
+	bool defer(GLenum type, GLsizei n, const GLuint *names)
+	{
+		GLsizei i;
+		if (!deleteFrame)
+			return false;
+		if (deletedCount + n > deletedCapacity) {
+			int capacity = deletedCapacity ? deletedCapacity : 256;
+			while (capacity < deletedCount + n)
+				capacity *= 2;
+			GLStateDeleted *grown = (GLStateDeleted*)realloc(deleted, sizeof(GLStateDeleted) * capacity);
+			if (!grown)
+				return false;
+			deleted = grown;
+			deletedCapacity = capacity;
+		}
+		for (i = 0; i < n; i++) {
+			if (!names[i])
+				continue;
+			GLStateDeleted *d = &deleted[deletedCount++];
+			d->type = type;
+			d->name = names[i];
+			d->frame = deleteFrame;
+		}
+		return true;
+	}
+
+	/* From now on, defer the deletes to frame, 0 to delete at once. */
+	void deferDeletes(unsigned long long frame)
+	{
+		deleteFrame = frame;
+	}
+
+	/* Delete the objects queued in the frames before completed, a batch
+	* of consecutive ones of a type at a time. */
+	void releaseDeletes(unsigned long long completed)
+	{
+		GLuint names[GL_STATE_DELETE_BATCH];
+		int i, n = 0, count = 0;
+		while (count < deletedCount && deleted[count].frame < completed)
+			count++;
+		for (i = 0; i < count; i++) {
+			names[n++] = deleted[i].name;
+			if (n == GL_STATE_DELETE_BATCH || i + 1 == count || deleted[i + 1].type != deleted[i].type) {
+				glStateDelete(deleted[i].type, n, names);
+				n = 0;
+			}
+		}
+		if (!count)
+			return;
+		deletedCount -= count;
+		for (i = 0; i < deletedCount; i++)
+			deleted[i] = deleted[count + i];
+	}
+
+	/* Delete everything queued and stop deferring, before the context
+	* goes away. */
+	void flushDeletes()
+	{
+		deleteFrame = 0;
+		releaseDeletes(~0ull);
+		free(deleted);
+		deleted = NULL;
+		deletedCount = deletedCapacity = 0;
+	}
+
+	/* A deferred object stays bound until it is deleted, so what is bound
+	* is unknown. */
+	GLuint unbound() const
+	{
+		return deleteFrame ? GL_STATE_UNKNOWN : 0;
+	}
+
+	void deleteBuffers(GLsizei n, const GLuint *names)
+	{
+		int i, j;
+		for (i = 0; i < n; i++)
+			for (j = 0; j < GL_STATE_BUFFER_TARGETS; j++)
+				if (names[i] && buffers[j] == names[i])
+					buffers[j] = unbound();
+		if (!defer(GL_BUFFER, n, names))
+			glDeleteBuffers(n, names);
+	}
+
+	void deleteTextures(GLsizei n, const GLuint *names)
+	{
+		int i, j, k;
+		for (i = 0; i < n; i++)
+			for (j = 0; j < GL_STATE_TEXTURE_UNITS; j++)
+				for (k = 0; k < GL_STATE_TEXTURE_TARGETS; k++)
+					if (names[i] && textures[j][k] == names[i])
+						textures[j][k] = unbound();
+		if (!defer(GL_TEXTURE, n, names))
+			glDeleteTextures(n, names);
+	}
+
+	void deleteVertexArrays(GLsizei n, const GLuint *names)
+	{
+		int i;
+		for (i = 0; i < n; i++)
+			if (names[i] && vao == names[i])
+				vao = unbound();
+		if (!defer(GL_VERTEX_ARRAY, n, names))
+			glDeleteVertexArrays(n, names);
+	}
+
+	/* a program in use stays alive until it is replaced, but its name
+	* may be reused afterwards */
+	void deleteProgram(GLuint p)
+	{
+		if (p && program == p)
+			program = GL_STATE_UNKNOWN;
+		if (!defer(GL_PROGRAM, 1, &p))
+			glDeleteProgram(p);
+	}
+
+	void deleteProgramPipelines(GLsizei n, const GLuint *names)
+	{
+		int i;
+		for (i = 0; i < n; i++)
+			if (names[i] && pipeline == names[i])
+				pipeline = unbound();
+		if (!defer(GL_PROGRAM_PIPELINE, n, names))
+			glDeleteProgramPipelines(n, names);
+	}
+} GLStateCache;
+
+/* The state cache of the GL context current on the calling thread. This is
+* an inline function with a static local, so all translation units share
+* it. The bindings are per context, and a thread only ever uses its own
+* context (the render thread the one of the window, the loader of
+* Streamer.h a shared one), so each thread gets its own cache. */
+inline GLStateCache *glState()
+{
+	static thread_local GLStateCache cache = { 0 };
+	return &cache;
+}
+
+#endif
@@ -0,0 +1,753 @@
+#ifndef HEADER_GLTRACE_H
+#define HEADER_GLTRACE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "GLLoader.h"
+#include "Log.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* GL CALL TRACE                                                            *
+****************************************************************************/
+
+/* GLTrace: an API-level profile without vendor tools. Every GL function is
+* called through its glad_gl* pointer, so start() swaps the pointers of all
+* functions of GL_LOADER_FUNCTIONS for hooks, which call the real function
+* and record the call: its number, when it started (relative to the last
+* call of the thread), how long it took and its arguments (integers and
+* enums as they are, floats by their bits, pointers by their address). The
+* numbers are written as variable-length integers (7 bits per byte), so a
+* call takes a few bytes. frame() marks the end of each frame.
+* Each thread with a context records into a block of its own, without a
+* lock; full blocks go to a writer thread, which appends them to the file.
+* Only if GL_TRACE_QUEUE blocks are waiting does a thread wait for it.
+* The file starts with GLTraceFileHeader and the number of arguments and
+* the name of every function (0 is the frame mark), followed by the blocks,
+* each a GLTraceBlockHeader and its records. glTraceReport() reads it back
+* and reports the calls per frame and function, the redundant state changes
+* (a bind or state set to what it already was) and the large uploads.
+* Without a file name, nothing is hooked and tracing costs nothing. */
+#define GL_TRACE_MAGIC 0x52544748u	/* "HGTR" */
+#define GL_TRACE_VERSION 1
+#define GL_TRACE_BLOCK_SIZE 65536	/* bytes of records per block */
+#define GL_TRACE_RECORD_MAX 256		/* bytes of a record at most: 3 + 12 arguments of 10 */
+#define GL_TRACE_QUEUE 64		/* full blocks waiting for the writer */
+#define GL_TRACE_THREADS 16		/* threads making GL calls */
+#define GL_TRACE_TOP_UPLOADS 10		/* the largest uploads in the report */
+
+/* the function numbers in the trace, after the frame mark */
+#define GL_TRACE_ENUM(f) GL_TRACE_##f,
+enum {
+	GL_TRACE_FRAME = 0,
+	GL_LOADER_FUNCTIONS(GL_TRACE_ENUM)
+	GL_TRACE_FUNCTION_COUNT
+};
+
+typedef struct {
+	GLuint magic;		/* GL_TRACE_MAGIC */
+	GLuint version;		/* GL_TRACE_VERSION */
+	GLuint functions;	/* GL_TRACE_FUNCTION_COUNT */
+} GLTraceFileHeader;
+
+typedef struct {
+	GLuint thread;		/* which thread made the calls */
+	GLuint size;		/* bytes of records following */
+	GLuint64 start;		/* profileNow() the first call is relative to */
+} GLTraceBlockHeader;
+
+typedef struct {
+	GLTraceBlockHeader header;
+	GLuint64 last;		/* start of the last call recorded */
+	unsigned char data[GL_TRACE_BLOCK_SIZE];
+} GLTraceBlock;
+
+static unsigned char *glTracePut(unsigned char *p, GLuint64 v)
+{
+	while (v >= 0x80) {
+		*p++ = (unsigned char)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (unsigned char)v;
+	return p;
+}
+
+/* The arguments as they are recorded. */
+template <typename T> inline GLuint64 glTraceValue(T v)
+{
+	/* integers and enums, the signed ones sign-extended */
+	return (GLuint64)(long long)v;
+}
+
+template <typename T> inline GLuint64 glTraceValue(T *p)
+{
+	return (GLuint64)(uintptr_t)p;
+}
+
+inline GLuint64 glTraceValue(GLfloat v)
+{
+	GLuint bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return bits;
+}
+
+inline GLuint64 glTraceValue(GLdouble v)
+{
+	GLuint64 bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return bits;
+}
+
+typedef struct {
+	const char *path;	/* where start() writes the trace, NULL for no trace */
+	bool running;
+	FILE *file;
+	unsigned char argCounts[GL_TRACE_FUNCTION_COUNT];
+
+	/* the block each thread records into, by the index of the thread */
+	GLTraceBlock *blocks[GL_TRACE_THREADS];
+	int threadCount;
+
+	/* the writer thread and its queue, protected by lock */
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable wake;	/* a block was queued, or quit */
+	std::condition_variable room;	/* the writer took a block */
+	GLTraceBlock *queue[GL_TRACE_QUEUE];
+	unsigned int queued, written;
+	GLTraceBlock *spare[GL_TRACE_QUEUE];	/* written blocks to reuse */
+	int spareCount;
+	bool quit;
+	bool failed;		/* writing failed, set by the writer */
+
+	/* what happened */
+	GLuint64 bytes;		/* of the blocks queued */
+	unsigned int waits;	/* a thread waited for the writer */
+
+	/* Open the file at path, start the writer and hook the functions.
+	* Call this right after they were loaded.
+	* Returns true if successfull and false in case of an error. */
+	bool start();
+
+	/* Mark the end of a frame, on the thread drawing it. */
+	void frame()
+	{
+		if (running) {
+			GLuint64 now = profileNow();
+			record(GL_TRACE_FRAME, now, now, NULL, 0);
+		}
+	}
+
+	/* The block of the calling thread, NULL if there are too many threads. */
+	GLTraceBlock *local()
+	{
+		static thread_local int index = -1;
+		if (index < 0) {
+			std::lock_guard<std::mutex> guard(lock);
+			if (threadCount >= GL_TRACE_THREADS)
+				return NULL;
+			index = threadCount++;
+			blocks[index] = take(index);
+		}
+		return blocks[index];
+	}
+
+	/* A spare block for thread index, or a new one. Under lock. */
+	GLTraceBlock *take(int index)
+	{
+		GLTraceBlock *b = spareCount ? spare[--spareCount] : (GLTraceBlock*)malloc(sizeof(GLTraceBlock));
+		if (b) {
+			b->header.thread = (GLuint)index;
+			b->header.size = 0;
+		}
+		return b;
+	}
+
+	/* Hand the block b of thread index to the writer and replace it.
+	* Under lock. */
+	void submit(std::unique_lock<std::mutex> &guard, GLTraceBlock *b, int index)
+	{
+		if (queued - written >= GL_TRACE_QUEUE) {
+			waits++;
+			room.wait(guard, [&]() { return queued - written < GL_TRACE_QUEUE; });
+		}
+		queue[queued++ % GL_TRACE_QUEUE] = b;
+		bytes += b->header.size;
+		blocks[index] = take(index);
+		wake.notify_one();
+	}
+
+	/* Record a call of function id from start to end with the n
+	* arguments args. */
+	void record(int id, GLuint64 start, GLuint64 end, const GLuint64 *args, int n)
+	{
+		GLTraceBlock *b = local();
+		int i;
+		if (!b)
+			return;
+		if (b->header.size + GL_TRACE_RECORD_MAX > GL_TRACE_BLOCK_SIZE) {
+			/* b belongs to the writer once it is queued */
+			int index = (int)b->header.thread;
+			std::unique_lock<std::mutex> guard(lock);
+			submit(guard, b, index);
+			b = blocks[index];
+			if (!b)
+				return;
+		}
+		if (!b->header.size)
+			b->header.start = b->last = start;
+		unsigned char *p = b->data + b->header.size;
+		p = glTracePut(p, (GLuint64)id);
+		p = glTracePut(p, start - b->last);
+		p = glTracePut(p, end - start);
+		for (i = 0; i < n; i++)
+			p = glTracePut(p, args[i]);
+		b->last = start;
+		b->header.size = (GLuint)(p - b->data);
+	}
+
+	/* The writer thread. */
+	void writer()
+	{
+		PROFILE_THREAD("gl trace");
+		std::unique_lock<std::mutex> guard(lock);
+		for (;;) {
+			wake.wait(guard, [&]() { return quit || written != queued; });
+			if (written == queued)
+				break;
+			GLTraceBlock *b = queue[written % GL_TRACE_QUEUE];
+			guard.unlock();
+			if (!failed && (fwrite(&b->header, sizeof(b->header), 1, file) != 1 ||
+				fwrite(b->data, 1, b->header.size, file) != b->header.size))
+				failed = true;
+			guard.lock();
+			written++;
+			if (spareCount < GL_TRACE_QUEUE)
+				spare[spareCount++] = b;
+			else
+				free(b);
+			room.notify_all();
+		}
+	}
+
+	/* Unhook the functions, write what the threads recorded since their
+	* last full block and close the file. Call this when no thread makes
+	* GL calls any more. */
+	void stop();
+} GLTrace;
+
+inline GLTrace *glTrace()
+{
+	/* zero-initialized, as a static */
+	static GLTrace trace;
+	return &trace;
+}
+
+/* The hook of the function number id with the type of its glad pointer. */
+template <int id, typename F> struct GLTraceHook;
+
+template <int id, typename R, typename... A> struct GLTraceHook<id, R (APIENTRYP)(A...)> {
+	typedef R (APIENTRYP Proc)(A...);
+	static Proc real;
+	static Proc *slot;
+
+	/* records the call when it returns, whatever it returns */
+	struct Call {
+		GLuint64 start;
+		GLuint64 args[sizeof...(A) + 1];
+		Call(A... a) : start(profileNow()), args{ glTraceValue(a)..., 0 } {}
+		~Call() { glTrace()->record(id, start, profileNow(), args, (int)sizeof...(A)); }
+	};
+
+	static R APIENTRY call(A... a)
+	{
+		Call c(a...);
+		return real(a...);
+	}
+
+	static void install(Proc *p)
+	{
+		glTrace()->argCounts[id] = (unsigned char)sizeof...(A);
+		slot = p;
+		real = *p;
+		if (real)
+			*p = call;
+	}
+
+	static void uninstall()
+	{
+		if (slot && real)
+			*slot = real;
+	}
+};
+
+template <int id, typename R, typename... A>
+typename GLTraceHook<id, R (APIENTRYP)(A...)>::Proc GLTraceHook<id, R (APIENTRYP)(A...)>::real = NULL;
+template <int id, typename R, typename... A>
+typename GLTraceHook<id, R (APIENTRYP)(A...)>::Proc *GLTraceHook<id, R (APIENTRYP)(A...)>::slot = NULL;
+
+#define GL_TRACE_INSTALL(f) GLTraceHook<GL_TRACE_##f, decltype(glad_##f)>::install(&glad_##f);
+#define GL_TRACE_UNINSTALL(f) GLTraceHook<GL_TRACE_##f, decltype(glad_##f)>::uninstall();
+
+inline bool GLTrace::start()
+{
+	GLTraceFileHeader h;
+	int i;
+
+	file = fopen(path, "wb");
+	if (!file) {
+		warn("GL trace: failed to open '%s'", path);
+		return false;
+	}
+	GL_LOADER_FUNCTIONS(GL_TRACE_INSTALL)
+	h.magic = GL_TRACE_MAGIC;
+	h.version = GL_TRACE_VERSION;
+	h.functions = GL_TRACE_FUNCTION_COUNT;
+	bool ok = fwrite(&h, sizeof(h), 1, file) == 1 && fwrite(argCounts, 1, GL_TRACE_FUNCTION_COUNT, file) ==
+		GL_TRACE_FUNCTION_COUNT && fwrite("frame", 1, 6, file) == 6;
+	for (i = 1; ok && i < GL_TRACE_FUNCTION_COUNT; i++) {
+		const char *name = glLoaderFunctions[i - 1];
+		ok = fwrite(name, 1, strlen(name) + 1, file) == strlen(name) + 1;
+	}
+	if (!ok) {
+		GL_LOADER_FUNCTIONS(GL_TRACE_UNINSTALL)
+		fclose(file);
+		file = NULL;
+		warn("GL trace: failed to write '%s'", path);
+		return false;
+	}
+	threadCount = spareCount = 0;
+	queued = written = 0;
+	bytes = 0;
+	waits = 0;
+	quit = failed = false;
+	thread = std::thread(&GLTrace::writer, this);
+	running = true;
+	info("GL trace: recording the calls into '%s'", path);
+	return true;
+}
+
+inline void GLTrace::stop()
+{
+	int i;
+	if (!running)
+		return;
+	GL_LOADER_FUNCTIONS(GL_TRACE_UNINSTALL)
+	running = false;
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		for (i = 0; i < threadCount; i++) {
+			if (blocks[i] && blocks[i]->header.size)
+				submit(guard, blocks[i], i);
+			free(blocks[i]);
+			blocks[i] = NULL;
+		}
+		quit = true;
+	}
+	wake.notify_one();
+	thread.join();
+	for (i = 0; i < spareCount; i++)
+		free(spare[i]);
+	spareCount = 0;
+	if (fclose(file))
+		failed = true;
+	file = NULL;
+	if (failed)
+		warn("GL trace: writing '%s' failed", path);
+	else
+		info("GL trace: %.1f MB from %d threads into '%s', waited for the writer %u times",
+			(double)bytes / (1024.0 * 1024.0), threadCount, path, waits);
+}
+
+/****************************************************************************
+* GL TRACE REPORT                                                          *
+****************************************************************************/
+
+/* what the report knows about some of the functions */
+enum {
+	GL_TRACE_PLAIN = 0,
+	GL_TRACE_STATE,		/* sets state, keyed by its first keyArgs arguments */
+	GL_TRACE_UPLOAD		/* sends data, sizeArg bytes if dataArg is not NULL */
+};
+
+typedef struct {
+	const char *name;
+	int kind;
+	int keyArgs;		/* GL_TRACE_STATE */
+	int sizeArg, dataArg;	/* GL_TRACE_UPLOAD, sizeArg < 0 for the size of an image */
+} GLTraceFunctionInfo;
+
+static const GLTraceFunctionInfo glTraceFunctionInfos[] = {
+	{ "glActiveTexture", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glBindBuffer", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glBindBufferBase", GL_TRACE_STATE, 2, 0, 0 },
+	{ "glBindBufferRange", GL_TRACE_STATE, 2, 0, 0 },
+	{ "glBindFramebuffer", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glBindImageTexture", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glBindProgramPipeline", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glBindRenderbuffer", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glBindTexture", GL_TRACE_STATE, 1, 0, 0 },	/* and the active unit */
+	{ "glBindVertexArray", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glBlendFunc", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glBlendFunci", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glBufferData", GL_TRACE_UPLOAD, 0, 1, 2 },
+	{ "glBufferStorage", GL_TRACE_UPLOAD, 0, 1, 2 },
+	{ "glBufferSubData", GL_TRACE_UPLOAD, 0, 2, 3 },
+	{ "glClearColor", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glColorMask", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glCompressedTexImage2D", GL_TRACE_UPLOAD, 0, 6, 7 },
+	{ "glCompressedTexImage3D", GL_TRACE_UPLOAD, 0, 7, 8 },
+	{ "glCompressedTexSubImage2D", GL_TRACE_UPLOAD, 0, 7, 8 },
+	{ "glCompressedTexSubImage3D", GL_TRACE_UPLOAD, 0, 9, 10 },
+	{ "glCullFace", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glDepthFunc", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glDepthMask", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glDisable", GL_TRACE_STATE, 1, 0, 0 },	/* shares the state with glEnable */
+	{ "glDrawBuffer", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glEnable", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glNamedBufferStorage", GL_TRACE_UPLOAD, 0, 1, 2 },
+	{ "glPixelStorei", GL_TRACE_STATE, 1, 0, 0 },
+	{ "glPolygonOffset", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glReadBuffer", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glTexImage2D", GL_TRACE_UPLOAD, 0, -1, 8 },
+	{ "glTexImage3D", GL_TRACE_UPLOAD, 0, -1, 9 },
+	{ "glTexSubImage2D", GL_TRACE_UPLOAD, 0, -1, 8 },
+	{ "glTexSubImage3D", GL_TRACE_UPLOAD, 0, -1, 10 },
+	{ "glUseProgram", GL_TRACE_STATE, 0, 0, 0 },
+	{ "glUseProgramStages", GL_TRACE_STATE, 2, 0, 0 },
+	{ "glViewport", GL_TRACE_STATE, 0, 0, 0 },
+};
+
+#define GL_TRACE_STATE_SLOTS 1024	/* per thread, a power of two */
+
+typedef struct {
+	GLuint64 key;		/* 0 for an empty slot */
+	GLuint64 value;
+} GLTraceStateSlot;
+
+typedef struct {
+	GLuint64 last;		/* start of the last call */
+	GLuint64 frameStart;	/* of the frame being parsed */
+	GLuint64 activeTexture;
+	GLTraceStateSlot state[GL_TRACE_STATE_SLOTS];
+	int stateCount;		/* slots in use */
+} GLTraceThreadState;
+
+typedef struct {
+	GLuint64 calls, ns, maxNs;
+	GLuint64 redundant;
+	GLuint64 uploaded;	/* bytes */
+	const GLTraceFunctionInfo *info;
+	const char *name;
+	int argCount;
+} GLTraceFunctionStats;
+
+typedef struct {
+	GLuint64 bytes;
+	const char *function;
+	unsigned int frame;
+} GLTraceUpload;
+
+typedef struct {
+	GLuint64 calls, redundant, uploaded, ns;
+} GLTraceFrameStats;
+
+static GLuint64 glTraceMix(GLuint64 h, GLuint64 v)
+{
+	h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+	return h;
+}
+
+/* Bytes of a pixel of format and type, for the image uploads. */
+static GLuint64 glTracePixelSize(GLuint64 format, GLuint64 type)
+{
+	GLuint64 components;
+	switch (type) {
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+		case GL_UNSIGNED_INT_10F_11F_11F_REV:
+		case GL_UNSIGNED_INT_24_8:
+		case GL_UNSIGNED_INT_8_8_8_8_REV:
+			return 4;
+		case GL_UNSIGNED_SHORT_5_6_5:
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_5_5_5_1:
+			return 2;
+	}
+	switch (format) {
+		case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+			components = 1;
+			break;
+		case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+			components = 2;
+			break;
+		case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+			components = 3;
+			break;
+		default:
+			components = 4;
+	}
+	switch (type) {
+		case GL_UNSIGNED_BYTE: case GL_BYTE:
+			return components;
+		case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+			return 2 * components;
+		default:
+			return 4 * components;
+	}
+}
+
+/* The bytes sent by a call of upload function f with the arguments args. */
+static GLuint64 glTraceUploadSize(const GLTraceFunctionInfo *f, const GLuint64 *args)
+{
+	if (!args[f->dataArg])
+		return 0;
+	if (f->sizeArg >= 0)
+		return args[f->sizeArg];
+	/* the image functions: the size, format and type are the arguments
+	* before the pixels, with depth or border in between for some */
+	if (!strcmp(f->name, "glTexImage2D"))
+		return args[3] * args[4] * glTracePixelSize(args[6], args[7]);
+	if (!strcmp(f->name, "glTexImage3D"))
+		return args[3] * args[4] * args[5] * glTracePixelSize(args[7], args[8]);
+	if (!strcmp(f->name, "glTexSubImage2D"))
+		return args[4] * args[5] * glTracePixelSize(args[6], args[7]);
+	return args[5] * args[6] * args[7] * glTracePixelSize(args[8], args[9]);
+}
+
+static bool glTraceGet(const unsigned char **p, const unsigned char *end, GLuint64 *v)
+{
+	int shift = 0;
+	*v = 0;
+	while (*p < end && shift < 64) {
+		unsigned char c = *(*p)++;
+		*v |= (GLuint64)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return true;
+		shift += 7;
+	}
+	return false;
+}
+
+/* Whether the state call of function f with args on thread t sets what is
+* set already, and remember it. */
+static bool glTraceRedundant(GLTraceThreadState *t, int function, const GLTraceFunctionStats *f,
+	const GLuint64 *args)
+{
+	GLuint64 key = glTraceMix(0, (GLuint64)function), value = 0;
+	int i;
+	if (!strcmp(f->name, "glEnable") || !strcmp(f->name, "glDisable")) {
+		key = glTraceMix(0, GL_TRACE_glEnable);
+		value = f->name[2] == 'E';
+	}
+	for (i = 0; i < f->info->keyArgs; i++)
+		key = glTraceMix(key, args[i]);
+	if (!strcmp(f->name, "glBindTexture"))
+		key = glTraceMix(key, t->activeTexture);
+	for (i = f->info->keyArgs; i < f->argCount; i++)
+		value = glTraceMix(value, args[i]);
+	if (!strcmp(f->name, "glActiveTexture"))
+		t->activeTexture = args[0];
+	key |= 1;	/* never 0 */
+	/* a table filling up forgets everything, which misses a few */
+	if (t->stateCount >= GL_TRACE_STATE_SLOTS / 2) {
+		memset(t->state, 0, sizeof(t->state));
+		t->stateCount = 0;
+	}
+	unsigned int s = (unsigned int)key & (GL_TRACE_STATE_SLOTS - 1);
+	while (t->state[s].key && t->state[s].key != key)
+		s = (s + 1) & (GL_TRACE_STATE_SLOTS - 1);
+	bool same = t->state[s].key == key && t->state[s].value == value;
+	if (!t->state[s].key)
+		t->stateCount++;
+	t->state[s].key = key;
+	t->state[s].value = value;
+	return same;
+}
+
+static int glTraceCompareTime(const void *a, const void *b)
+{
+	const GLTraceFunctionStats *x = (const GLTraceFunctionStats*)a, *y = (const GLTraceFunctionStats*)b;
+	return (x->ns < y->ns) - (x->ns > y->ns);
+}
+
+/* Read the trace in the file filename and write the report to out.
+* Returns true if successfull and false in case of an error. */
+static bool glTraceReport(const char *filename, FILE *out)
+{
+	GLTraceFileHeader h;
+	GLTraceBlockHeader b;
+	GLTraceFunctionStats *functions = NULL;
+	GLTraceThreadState *threads = NULL;
+	GLTraceUpload top[GL_TRACE_TOP_UPLOADS];
+	GLTraceFrameStats frame, total, worst;
+	unsigned char *data = (unsigned char*)malloc(GL_TRACE_BLOCK_SIZE);
+	unsigned int frames = 0, frameThread = GL_TRACE_THREADS, topCount = 0;
+	GLuint64 calls = 0;
+	unsigned int i, j, k;
+	bool ok;
+
+	FILE *file = fopen(filename, "rb");
+	ok = file && data && fread(&h, sizeof(h), 1, file) == 1 && h.magic == GL_TRACE_MAGIC &&
+		h.version == GL_TRACE_VERSION && h.functions > 0 && h.functions < 65536;
+	if (ok) {
+		functions = (GLTraceFunctionStats*)calloc(h.functions, sizeof(GLTraceFunctionStats));
+		threads = (GLTraceThreadState*)calloc(GL_TRACE_THREADS, sizeof(GLTraceThreadState));
+		ok = functions && threads;
+	}
+	/* the argument counts, then the names */
+	for (i = 0; ok && i < h.functions; i++) {
+		int c = fgetc(file);
+		functions[i].argCount = c;
+		ok = c >= 0 && c <= 12;
+	}
+	for (i = 0; ok && i < h.functions; i++) {
+		char name[128];
+		for (j = 0; j < sizeof(name) - 1; j++) {
+			int c = fgetc(file);
+			if (c <= 0)
+				break;
+			name[j] = (char)c;
+		}
+		name[j] = 0;
+		functions[i].name = NULL;
+		for (k = 0; k < GL_TRACE_FUNCTION_COUNT - 1; k++)
+			if (!strcmp(name, glLoaderFunctions[k]))
+				functions[i].name = glLoaderFunctions[k];
+		if (!functions[i].name)
+			functions[i].name = i ? "(unknown)" : "frame";
+		for (k = 0; k < sizeof(glTraceFunctionInfos) / sizeof(glTraceFunctionInfos[0]); k++)
+			if (!strcmp(functions[i].name, glTraceFunctionInfos[k].name))
+				functions[i].info = &glTraceFunctionInfos[k];
+	}
+	if (!ok) {
+		warn("'%s' is no GL trace of version %u", filename, GL_TRACE_VERSION);
+		if (file)
+			fclose(file);
+		free(functions);
+		free(threads);
+		free(data);
+		return false;
+	}
+
+	memset(&frame, 0, sizeof(frame));
+	memset(&total, 0, sizeof(total));
+	memset(&worst, 0, sizeof(worst));
+	while (ok && fread(&b, sizeof(b), 1, file) == 1) {
+		ok = b.thread < GL_TRACE_THREADS && b.size <= GL_TRACE_BLOCK_SIZE && fread(data, 1, b.size, file) == b.size;
+		if (!ok)
+			break;
+		GLTraceThreadState *t = &threads[b.thread];
+		const unsigned char *p = data, *end = data + b.size;
+		t->last = b.start;
+		if (!t->frameStart)
+			t->frameStart = b.start;
+		while (ok && p < end) {
+			GLuint64 id, delta, ns, args[16];
+			ok = glTraceGet(&p, end, &id) && id < h.functions && glTraceGet(&p, end, &delta) &&
+				glTraceGet(&p, end, &ns);
+			GLTraceFunctionStats *f = ok ? &functions[id] : NULL;
+			for (j = 0; ok && j < (unsigned int)f->argCount; j++)
+				ok = glTraceGet(&p, end, &args[j]);
+			if (!ok)
+				break;
+			GLuint64 start = t->last + delta;
+			t->last = start;
+			if (id == GL_TRACE_FRAME) {
+				/* the frames are those of the thread which marks them,
+				* from its first mark on */
+				if (frameThread != b.thread) {
+					frameThread = b.thread;
+					t->frameStart = start;
+					memset(&frame, 0, sizeof(frame));
+					continue;
+				}
+				frame.ns = start - t->frameStart;
+				t->frameStart = start;
+				total.calls += frame.calls;
+				total.redundant += frame.redundant;
+				total.uploaded += frame.uploaded;
+				total.ns += frame.ns;
+				worst.calls = glm::max(worst.calls, frame.calls);
+				worst.redundant = glm::max(worst.redundant, frame.redundant);
+				worst.uploaded = glm::max(worst.uploaded, frame.uploaded);
+				worst.ns = glm::max(worst.ns, frame.ns);
+				memset(&frame, 0, sizeof(frame));
+				frames++;
+				continue;
+			}
+			calls++;
+			f->calls++;
+			f->ns += ns;
+			f->maxNs = glm::max(f->maxNs, ns);
+			bool inFrame = b.thread == frameThread;
+			if (inFrame)
+				frame.calls++;
+			if (f->info && f->info->kind == GL_TRACE_STATE && glTraceRedundant(t, (int)id, f, args)) {
+				f->redundant++;
+				if (inFrame)
+					frame.redundant++;
+			}
+			if (f->info && f->info->kind == GL_TRACE_UPLOAD) {
+				GLuint64 size = glTraceUploadSize(f->info, args);
+				f->uploaded += size;
+				if (inFrame)
+					frame.uploaded += size;
+				/* keep the largest, sorted by size */
+				for (k = 0; k < topCount && top[k].bytes >= size; k++)
+					;
+				if (size && k < GL_TRACE_TOP_UPLOADS) {
+					if (topCount < GL_TRACE_TOP_UPLOADS)
+						topCount++;
+					memmove(&top[k + 1], &top[k], sizeof(top[0]) * (topCount - 1 - k));
+					top[k].bytes = size;
+					top[k].function = f->name;
+					top[k].frame = frames;
+				}
+			}
+		}
+	}
+	fclose(file);
+	free(data);
+	if (!ok)
+		warn("GL trace '%s' is truncated, reporting what was read", filename);
+
+	fprintf(out, "GL trace '%s': %llu calls, %u frames\n", filename, (unsigned long long)calls, frames);
+	if (frames) {
+		double n = (double)frames;
+		fprintf(out, "per frame          average      max\n");
+		fprintf(out, "  calls         %10.1f %8llu\n", (double)total.calls / n, (unsigned long long)worst.calls);
+		fprintf(out, "  redundant     %10.1f %8llu\n", (double)total.redundant / n,
+			(unsigned long long)worst.redundant);
+		fprintf(out, "  uploaded KB   %10.1f %8.1f\n", (double)total.uploaded / (1024.0 * n),
+			(double)worst.uploaded / 1024.0);
+		fprintf(out, "  CPU ms        %10.3f %8.3f\n", (double)total.ns * 1.0e-6 / n, (double)worst.ns * 1.0e-6);
+	}
+	/* by the time spent in them */
+	qsort(functions, h.functions, sizeof(functions[0]), glTraceCompareTime);
+	fprintf(out, "%-36s %10s %10s %9s %9s %10s %12s\n", "function", "calls", "per frame", "total ms",
+		"avg us", "redundant", "uploaded KB");
+	for (i = 0; i < h.functions && functions[i].calls; i++) {
+		const GLTraceFunctionStats *f = &functions[i];
+		fprintf(out, "%-36s %10llu %10.1f %9.3f %9.3f %10llu %12.1f\n", f->name, (unsigned long long)f->calls,
+			frames ? (double)f->calls / (double)frames : 0.0, (double)f->ns * 1.0e-6,
+			(double)f->ns * 1.0e-3 / (double)f->calls, (unsigned long long)f->redundant,
+			(double)f->uploaded / 1024.0);
+	}
+	if (topCount)
+		fprintf(out, "largest uploads\n");
+	for (i = 0; i < topCount; i++)
+		fprintf(out, "  frame %6u  %-28s %12llu bytes\n", top[i].frame, top[i].function,
+			(unsigned long long)top[i].bytes);
+	free(functions);
+	free(threads);
+	return true;
+}
+
+#endif
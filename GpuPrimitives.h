@@ -0,0 +1,430 @@
+#ifndef HEADER_GPUPRIMITIVES_H
+#define HEADER_GPUPRIMITIVES_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* GPU PRIMITIVES: scan, compaction, reduction and sorting in compute       *
+****************************************************************************/
+
+/* GpuPrimitives: the building blocks of the compute passes which bring
+* their items into some order, on buffers of uints, by
+* shaders/primitives.cs.glsl:
+*   scan():    the exclusive prefix sums of the items, and their total
+*   compact(): the items whose flags are set, packed to the front, and how
+*              many they are
+*   reduce():  the sum, the smallest or the largest item
+*   sort():    the keys, with the values going with them, by a radix sort
+*              of 4 bits per pass
+* The scan and the compaction are single passes: each group takes the next
+* tile, and learns the sum of the tiles before it from the states they
+* publish (the decoupled look-back), so the items are read and written only
+* once instead of a pass for the sums of the tiles and one to add them. The
+* sort counts the digits of all of its passes at once, so a pass is a
+* single dispatch too. The sums carry 30 bits, so there are less than
+* GPU_PRIMITIVES_MAX items, and the sums of a scan stay below it as well.
+* Each call runs right away with its own program, and ends with a barrier
+* for storage buffer reads of the results; any other use of them needs a
+* barrier of its own. */
+#define GPU_PRIMITIVES_SHADER "shaders/primitives.cs.glsl"
+#define GPU_PRIMITIVES_GROUP 256	/* local size of the compute shader */
+#define GPU_PRIMITIVES_ITEMS 4		/* per thread of a scan or a reduction */
+#define GPU_PRIMITIVES_TILE (GPU_PRIMITIVES_GROUP * GPU_PRIMITIVES_ITEMS)
+#define GPU_PRIMITIVES_RADIX 16		/* the digits of a sort pass */
+#define GPU_PRIMITIVES_PASSES 8		/* of a sort of 32 bits */
+#define GPU_PRIMITIVES_MAX (1 << 30)
+
+/* the stages of the compute shader, a dispatch each */
+enum {
+	GPU_PRIMITIVES_SCAN = 0,	/* prefix sums, a tile per group */
+	GPU_PRIMITIVES_COMPACT,		/* the same for the flags, and the scatter */
+	GPU_PRIMITIVES_REDUCE,		/* a tile per group, into the result */
+	GPU_PRIMITIVES_HISTOGRAM,	/* the digits of all sort passes */
+	GPU_PRIMITIVES_OFFSETS,		/* where the digits of each pass start */
+	GPU_PRIMITIVES_SCATTER		/* a sort pass */
+};
+
+/* the operations of reduce() */
+enum {
+	GPU_REDUCE_ADD = 0,
+	GPU_REDUCE_MIN,
+	GPU_REDUCE_MAX
+};
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint stageLoc, countLoc, countIndexLoc, opLoc, passLoc, passesLoc, hasValuesLoc;
+	GLuint states;		/* the next tile and the look-back states of the tiles */
+	GLuint result;		/* totals, and the digit offsets of a sort */
+	GLuint keys, values;	/* the other half of the keys and values of a sort */
+	GLsizeiptr statesSize, keysSize, valuesSize;
+
+	void clear()
+	{
+		program = 0;
+		states = result = keys = values = 0;
+		statesSize = keysSize = valuesSize = 0;
+	}
+
+	/* Build the program, the sources are loaded via cache.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache)
+	{
+		MemoryScope scope(MEMORY_TRANSIENT);
+		clear();
+		if (!computeShaderSupported())
+			return false;
+		program = computeProgramBuild(cache, GPU_PRIMITIVES_SHADER);
+		if (!program)
+			return false;
+		stageLoc = glGetUniformLocation(program, "stage");
+		countLoc = glGetUniformLocation(program, "count");
+		countIndexLoc = glGetUniformLocation(program, "countIndex");
+		opLoc = glGetUniformLocation(program, "op");
+		passLoc = glGetUniformLocation(program, "pass");
+		passesLoc = glGetUniformLocation(program, "passes");
+		hasValuesLoc = glGetUniformLocation(program, "hasValues");
+		glGenBuffers(1, &result);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, result);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * GPU_PRIMITIVES_PASSES * GPU_PRIMITIVES_RADIX, NULL,
+			GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		GL_ERROR_DBG("gpu primitives initialization");
+		info("gpu primitives: program %u", program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		GLuint buffers[4] = { states, result, keys, values };
+		int i;
+		for (i = 0; i < 4; i++) {
+			if (buffers[i])
+				glState()->deleteBuffers(1, &buffers[i]);
+		}
+		clear();
+	}
+
+	/* Make the storage buffer *buffer hold at least size bytes, it
+	* grows by half again so that slowly growing inputs do not reallocate
+	* each time. */
+	static void reserve(GLuint *buffer, GLsizeiptr *capacity, GLsizeiptr size)
+	{
+		MemoryScope scope(MEMORY_TRANSIENT);
+		if (*buffer && *capacity >= size)
+			return;
+		if (!*buffer)
+			glGenBuffers(1, buffer);
+		*capacity = size + size / 2;
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, *buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, *capacity, NULL, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	/* Set the first n uints of buffer to value. */
+	static void fill(GLuint buffer, int n, GLuint value)
+	{
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint) * n, GL_RED_INTEGER,
+			GL_UNSIGNED_INT, &value);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	/* The tile counter and lanes look-back states for each of tiles,
+	* all 0. */
+	void resetStates(int tiles, int lanes)
+	{
+		int n = 1 + tiles * lanes;
+		reserve(&states, &statesSize, sizeof(GLuint) * n);
+		fill(states, n, 0);
+	}
+
+	/* Run stage with groups groups, after the commands before. */
+	void dispatch(int stage, int groups)
+	{
+		glUniform1i(stageLoc, stage);
+		glDispatchCompute((GLuint)groups, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	}
+
+	static int tiles(int n, int size)
+	{
+		return (n + size - 1) / size;
+	}
+
+	/* Write the exclusive prefix sums of the n uints in in to out, which
+	* may be in, and their total to the first uint of total if it is not 0. */
+	void scan(GLuint in, GLuint out, int n, GLuint total = 0)
+	{
+		if (!program || n < 1)
+			return;
+		GL_DEBUG_GROUP("gpu scan");
+		resetStates(tiles(n, GPU_PRIMITIVES_TILE), 1);
+		glState()->useProgram(program);
+		glUniform1i(countLoc, n);
+		glUniform1i(countIndexLoc, -1);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, in);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, out);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, states);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, total ? total : result);
+		dispatch(GPU_PRIMITIVES_SCAN, tiles(n, GPU_PRIMITIVES_TILE));
+		glState()->useProgram(0);
+		GL_ERROR_DBG("gpu scan");
+	}
+
+	/* Pack the uints of the n in in whose uints in flags are not 0 to the
+	* front of out, in their order, and write how many they are to the
+	* first uint of count. */
+	void compact(GLuint in, GLuint flags, GLuint out, int n, GLuint count)
+	{
+		if (!program || n < 1) {
+			if (program && count)
+				fill(count, 1, 0);
+			return;
+		}
+		GL_DEBUG_GROUP("gpu compact");
+		resetStates(tiles(n, GPU_PRIMITIVES_TILE), 1);
+		glState()->useProgram(program);
+		glUniform1i(countLoc, n);
+		glUniform1i(countIndexLoc, -1);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, in);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, out);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, states);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, flags);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, count);
+		dispatch(GPU_PRIMITIVES_COMPACT, tiles(n, GPU_PRIMITIVES_TILE));
+		glState()->useProgram(0);
+		GL_ERROR_DBG("gpu compact");
+	}
+
+	/* Combine the n uints in in by op (GPU_REDUCE_*) into the first uint
+	* of out. */
+	void reduce(GLuint in, int n, int op, GLuint out)
+	{
+		if (!program)
+			return;
+		fill(out, 1, (op == GPU_REDUCE_MIN) ? 0xffffffffu : 0u);
+		if (n < 1)
+			return;
+		GL_DEBUG_GROUP("gpu reduce");
+		glState()->useProgram(program);
+		glUniform1i(countLoc, n);
+		glUniform1i(countIndexLoc, -1);
+		glUniform1i(opLoc, op);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, in);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, out);
+		dispatch(GPU_PRIMITIVES_REDUCE, tiles(n, GPU_PRIMITIVES_TILE));
+		glState()->useProgram(0);
+		GL_ERROR_DBG("gpu reduce");
+	}
+
+	/* Sort the n uints in keys by their lowest bits bits (the others
+	* must be 0), and the uints in values along with them unless it is 0;
+	* stable, in place. If counts is not 0, the number of keys is its uint
+	* at countIndex instead, written by the GPU, and n is how many there
+	* may be at most: the groups for those which are not there return
+	* right away.
+	* Returns true if successfull and false in case of an error. */
+	bool sort(GLuint keyBuffer, GLuint valueBuffer, int n, int bits = 32, GLuint counts = 0, int countIndex = 0)
+	{
+		int pass, passes = (bits + 3) / 4, groups = tiles(n, GPU_PRIMITIVES_GROUP);
+		GLuint in[2] = { keyBuffer, valueBuffer }, out[2];
+
+		if (!program)
+			return false;
+		if (n < 2 || passes < 1)
+			return true;
+		if (passes > GPU_PRIMITIVES_PASSES)
+			passes = GPU_PRIMITIVES_PASSES;
+		GL_DEBUG_GROUP("gpu sort");
+		reserve(&keys, &keysSize, sizeof(GLuint) * n);
+		if (valueBuffer)
+			reserve(&values, &valuesSize, sizeof(GLuint) * n);
+		out[0] = keys;
+		out[1] = values;
+
+		fill(result, passes * GPU_PRIMITIVES_RADIX, 0);
+		glState()->useProgram(program);
+		glUniform1i(countLoc, n);
+		glUniform1i(countIndexLoc, counts ? countIndex : -1);
+		glUniform1i(passesLoc, passes);
+		glUniform1i(hasValuesLoc, valueBuffer != 0);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keyBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, result);
+		if (counts)
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, counts);
+		dispatch(GPU_PRIMITIVES_HISTOGRAM, tiles(n, GPU_PRIMITIVES_TILE));
+		dispatch(GPU_PRIMITIVES_OFFSETS, 1);
+		for (pass = 0; pass < passes; pass++) {
+			resetStates(groups, GPU_PRIMITIVES_RADIX);
+			glState()->useProgram(program);
+			glUniform1i(passLoc, pass);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, in[0]);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, out[0]);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, states);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, in[1]);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, out[1]);
+			dispatch(GPU_PRIMITIVES_SCATTER, groups);
+			GLuint t[2] = { in[0], in[1] };
+			in[0] = out[0];
+			in[1] = out[1];
+			out[0] = t[0];
+			out[1] = t[1];
+		}
+		glState()->useProgram(0);
+		/* after an odd number of passes, the result is in the other half */
+		if (passes & 1) {
+			copy(keys, keyBuffer, n);
+			if (valueBuffer)
+				copy(values, valueBuffer, n);
+		}
+		GL_ERROR_DBG("gpu sort");
+		return true;
+	}
+
+	static void copy(GLuint from, GLuint to, int n)
+	{
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, from);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, to);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(GLuint) * n);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+} GpuPrimitives;
+
+static int gpuPrimitivesCompare(const void *a, const void *b)
+{
+	GLuint x = *(const GLuint*)a, y = *(const GLuint*)b;
+	return (x > y) - (x < y);
+}
+
+/* For the --bench-primitives mode: run each primitive on n random uints
+* runs times, check the last result against the CPU, and print the
+* average GPU time of a run to out.
+* Returns true if all results were right and false otherwise. */
+static bool gpuPrimitivesBenchmark(GpuPrimitives *p, int n, int runs, FILE *out)
+{
+	enum { SCAN = 0, COMPACT, REDUCE, SORT, SORT_PAIRS, TESTS };
+	static const char *names[TESTS] = { "scan", "compact", "reduce (max)", "sort 32 bits", "sort 32 bits, values" };
+	GLuint *items = (GLuint*)malloc(sizeof(GLuint) * n);
+	GLuint *expected = (GLuint*)malloc(sizeof(GLuint) * n);
+	GLuint *results = (GLuint*)malloc(sizeof(GLuint) * n);
+	GLuint buffers[5], queries[2], total;
+	GLuint seed = 12345u;
+	int i, t, r;
+	bool ok = true;
+
+	if (!p->program || !items || !expected || !results || n < 1 || n >= GPU_PRIMITIVES_MAX / 64) {
+		warn("gpu primitives: no benchmark of %d items", n);
+		free(items);
+		free(expected);
+		free(results);
+		return false;
+	}
+	/* the sums of the scan stay below 2^30 */
+	for (i = 0; i < n; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		items[i] = seed;
+	}
+	glGenBuffers(5, buffers);
+	glGenQueries(2, queries);
+	for (i = 0; i < 5; i++) {
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * n, NULL, GL_DYNAMIC_COPY);
+	}
+	glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	fprintf(out, "%-22s %10s %10s %12s  %s\n", "primitive", "items", "ms", "Mitems/s", "result");
+	for (t = 0; t < TESTS; t++) {
+		GLuint64 elapsed = 0;
+		/* 0: the items, 1: the output or the values, 2: the flags,
+		* 3: the total */
+		for (i = 0; i < n; i++)
+			results[i] = (t == SCAN) ? items[i] & 63u : items[i];
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[4]);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * n, results);
+		for (i = 0; i < n; i++)
+			results[i] = (items[i] >> 7) & 1u;
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[2]);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * n, results);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		for (r = 0; r <= runs; r++) {
+			GLuint64 begin, end;
+			/* the sorts work in place, on fresh keys each run */
+			GpuPrimitives::copy(buffers[4], buffers[0], n);
+			if (t == SORT_PAIRS)
+				GpuPrimitives::copy(buffers[4], buffers[1], n);
+			glQueryCounter(queries[0], GL_TIMESTAMP);
+			if (t == SCAN)
+				p->scan(buffers[0], buffers[1], n, buffers[3]);
+			else if (t == COMPACT)
+				p->compact(buffers[0], buffers[2], buffers[1], n, buffers[3]);
+			else if (t == REDUCE)
+				p->reduce(buffers[0], n, GPU_REDUCE_MAX, buffers[3]);
+			else
+				p->sort(buffers[0], t == SORT_PAIRS ? buffers[1] : 0, n);
+			glQueryCounter(queries[1], GL_TIMESTAMP);
+			glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+			/* the first run warms up */
+			if (r > 0)
+				elapsed += end - begin;
+		}
+
+		/* what the CPU makes of it */
+		int m = n;
+		GLuint sum = 0;
+		for (i = 0; i < n; i++) {
+			expected[i] = (t == SCAN) ? items[i] & 63u : items[i];
+			if (t == SCAN) {
+				GLuint v = expected[i];
+				expected[i] = sum;
+				sum += v;
+			}
+		}
+		if (t == COMPACT) {
+			for (i = m = 0; i < n; i++)
+				if ((items[i] >> 7) & 1u)
+					expected[m++] = items[i];
+			sum = (GLuint)m;
+		} else if (t == REDUCE) {
+			for (i = 0; i < n; i++)
+				sum = items[i] > sum ? items[i] : sum;
+			m = 0;
+		} else if (t >= SORT) {
+			qsort(expected, n, sizeof(GLuint), gpuPrimitivesCompare);
+		}
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[3]);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &total);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[t >= SORT ? 0 : 1]);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * m, results);
+		bool right = (t >= SORT || total == sum) && !memcmp(results, expected, sizeof(GLuint) * m);
+		/* the values went along with their keys, which were the same */
+		if (right && t == SORT_PAIRS) {
+			glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[1]);
+			glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * m, results);
+			right = !memcmp(results, expected, sizeof(GLuint) * m);
+		}
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		double ms = 1e-6 * (double)elapsed / (double)runs;
+		fprintf(out, "%-22s %10d %10.3f %12.1f  %s\n", names[t], n, ms, ms > 0.0 ? 1e-3 * n / ms : 0.0,
+			right ? "ok" : "WRONG");
+		ok = ok && right;
+	}
+	glDeleteQueries(2, queries);
+	for (i = 0; i < 5; i++)
+		glState()->deleteBuffers(1, &buffers[i]);
+	free(items);
+	free(expected);
+	free(results);
+	return ok;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef HEADER_GPUPROFILER_H
+#define HEADER_GPUPROFILER_H
+
+#include <glad/glad.h>
+#include "ShaderHelpers.h"
+#include "Profiler.h"
+#include "PerfCounters.h"
+
+/****************************************************************************
+* GPU PROFILER                                                             *
+****************************************************************************/
+
+/* GpuProfiler: measures how long the GPU spends in named scopes of a frame.
+* Each scope is bracketed by two GL_TIMESTAMP queries (GL_TIME_ELAPSED
+* queries can not be nested, timestamps can). The queries of a frame are only
+* read back GPU_PROFILER_FRAMES frames later, and only if the results are
+* already available, so reading them never stalls the pipeline. Results are
+* accumulated until report() is called, which computes the averages.
+* With PROFILE_ZONES, every scope collected is also recorded as a zone of
+* the GPU track of Profiler.h. The GPU timestamps count from some point of
+* their own, so the profiler reads the GPU clock (GL_TIMESTAMP) and the CPU
+* clock one right after the other when it starts and at every report(), and
+* moves the scopes by the difference.
+* Each scope is a debug group as well (see GLDebug.h), with or without timer
+* queries, so graphics debuggers show the frame split the same way.
+* counters samples hardware counters per scope, once counters.init() picked
+* some (see PerfCounters.h). */
+#define GPU_PROFILER_MAX_SCOPES 16
+#define GPU_PROFILER_FRAMES 3
+
+typedef struct {
+	bool supported;		/* timer queries available */
+	int scopeCount;
+	const char *names[GPU_PROFILER_MAX_SCOPES];
+
+	/* the queries of each frame slot, [slot][scope][begin/end] */
+	GLuint queries[GPU_PROFILER_FRAMES][GPU_PROFILER_MAX_SCOPES][2];
+	bool issued[GPU_PROFILER_FRAMES][GPU_PROFILER_MAX_SCOPES];
+	bool frameIssued[GPU_PROFILER_FRAMES];
+	unsigned int slot;	/* the slot of the current frame */
+
+	/* accumulated results since the last report */
+	double sum[GPU_PROFILER_MAX_SCOPES];
+	unsigned int samples[GPU_PROFILER_MAX_SCOPES];
+	double frameSum;
+	unsigned int frameSamples;
+	unsigned int dropped;	/* frames whose results were not ready in time */
+
+	double lastFrame;	/* ms of the most recently collected frame */
+	long long clockOffset;	/* profileNow() - GPU timestamp, see calibrate() */
+
+	/* averages in milliseconds, as of the last report */
+	double avg[GPU_PROFILER_MAX_SCOPES];
+	double avgFrame;
+
+	PerfCounters counters;	/* of the scopes, none unless chosen */
+
+	/* Create the queries for the scopes named in scopeNames, the index
+	* into that array is the id passed to begin/end.
+	* Returns true if timer queries are supported. */
+	bool init(const char * const *scopeNames, int count)
+	{
+		int i, j;
+
+		scopeCount = (count < GPU_PROFILER_MAX_SCOPES) ? count : GPU_PROFILER_MAX_SCOPES;
+		for (i = 0; i < scopeCount; i++) {
+			names[i] = scopeNames[i];
+			avg[i] = -1.0;
+		}
+		avgFrame = -1.0;
+		lastFrame = -1.0;
+		slot = 0;
+		counters.clear();
+		reset();
+		for (i = 0; i < GPU_PROFILER_FRAMES; i++) {
+			frameIssued[i] = false;
+			for (j = 0; j < GPU_PROFILER_MAX_SCOPES; j++)
+				issued[i][j] = false;
+		}
+
+		supported = glCaps()->timerQuery;
+		if (!supported) {
+			info("GPU profiler: timer queries not supported");
+			return false;
+		}
+		for (i = 0; i < GPU_PROFILER_FRAMES; i++)
+			glGenQueries(2 * GPU_PROFILER_MAX_SCOPES, &queries[i][0][0]);
+		info("GPU profiler: %d scopes, results delayed by %d frames", scopeCount, GPU_PROFILER_FRAMES);
+		calibrate();
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		counters.destroy();
+		if (supported) {
+			for (i = 0; i < GPU_PROFILER_FRAMES; i++)
+				glDeleteQueries(2 * GPU_PROFILER_MAX_SCOPES, &queries[i][0][0]);
+			supported = false;
+		}
+	}
+
+	/* Measure the offset of the GPU clock to that of Profiler.h. The
+	* timestamp is taken when the GL gets here, without waiting for the
+	* commands before. */
+	void calibrate()
+	{
+		GLint64 gpu;
+		clockOffset = 0;
+		if (!supported || !glGetInteger64v)
+			return;
+		glGetInteger64v(GL_TIMESTAMP, &gpu);
+		clockOffset = (long long)profileNow() - (long long)gpu;
+	}
+
+	/* Clear the accumulated results. */
+	void reset()
+	{
+		int i;
+		for (i = 0; i < GPU_PROFILER_MAX_SCOPES; i++) {
+			sum[i] = 0.0;
+			samples[i] = 0;
+		}
+		frameSum = 0.0;
+		frameSamples = 0;
+		dropped = 0;
+	}
+
+	/* Start a new frame: collect the results of the frame which used the
+	* next slot, if they are available, and reuse its queries.
+	* Returns the GPU time of the collected frame in ms, or -1 if there
+	* was no result. */
+	double beginFrame()
+	{
+		int i;
+		bool collected = false;
+
+		counters.beginFrame();
+		if (!supported)
+			return -1.0;
+		slot = (slot + 1) % GPU_PROFILER_FRAMES;
+		if (frameIssued[slot])
+			collected = collect(slot);
+		frameIssued[slot] = true;
+		for (i = 0; i < scopeCount; i++)
+			issued[slot][i] = false;
+		return collected ? lastFrame : -1.0;
+	}
+
+	/* Read back the results of frame slot s without waiting.
+	* Returns true if the results were available. */
+	bool collect(unsigned int s)
+	{
+		GLuint64 t0, t1, frameBegin = 0, frameEnd = 0;
+		GLint available;
+		bool first = true;
+		int i;
+
+		/* only read the results if all of them are there already */
+		for (i = 0; i < scopeCount; i++) {
+			if (!issued[s][i])
+				continue;
+			glGetQueryObjectiv(queries[s][i][1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) {
+				dropped++;
+				return false;
+			}
+		}
+
+		for (i = 0; i < scopeCount; i++) {
+			if (!issued[s][i])
+				continue;
+			glGetQueryObjectui64v(queries[s][i][0], GL_QUERY_RESULT, &t0);
+			glGetQueryObjectui64v(queries[s][i][1], GL_QUERY_RESULT, &t1);
+			sum[i] += (double)(t1 - t0) * 1.0e-6;
+			samples[i]++;
+#ifdef PROFILE_ZONES
+			profileGpuZone(names[i], (unsigned long long)((long long)t0 + clockOffset),
+				(unsigned long long)((long long)t1 + clockOffset));
+#endif
+			if (first || t0 < frameBegin)
+				frameBegin = t0;
+			if (first || t1 > frameEnd)
+				frameEnd = t1;
+			first = false;
+		}
+		if (first)
+			return false;
+		lastFrame = (double)(frameEnd - frameBegin) * 1.0e-6;
+		frameSum += lastFrame;
+		frameSamples++;
+		return true;
+	}
+
+	/* Mark the GPU begin of scope id. */
+	void begin(int id)
+	{
+		if (id < 0 || id >= scopeCount)
+			return;
+		/* the scopes are the outermost debug groups of a frame too */
+		glDebugPush(names[id]);
+		if (supported)
+			glQueryCounter(queries[slot][id][0], GL_TIMESTAMP);
+		counters.begin(id);
+	}
+
+	/* Mark the GPU end of scope id. */
+	void end(int id)
+	{
+		if (id < 0 || id >= scopeCount)
+			return;
+		counters.end(id);
+		if (supported) {
+			glQueryCounter(queries[slot][id][1], GL_TIMESTAMP);
+			issued[slot][id] = true;
+		}
+		glDebugPop();
+	}
+
+	/* Compute the averages of everything collected since the last report
+	* and start over. */
+	void report()
+	{
+		int i;
+		for (i = 0; i < scopeCount; i++)
+			avg[i] = samples[i] ? sum[i] / (double)samples[i] : -1.0;
+		avgFrame = frameSamples ? frameSum / (double)frameSamples : -1.0;
+		reset();
+		counters.report(names);
+#ifdef PROFILE_ZONES
+		/* the two clocks drift apart */
+		calibrate();
+#endif
+	}
+} GpuProfiler;
+
+#endif
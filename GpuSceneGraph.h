@@ -0,0 +1,230 @@
+#ifndef HEADER_GPUSCENEGRAPH_H
+#define HEADER_GPUSCENEGRAPH_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <atomic>
+#include <stdlib.h>
+#include "DynamicBuffer.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "SceneGraph.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* GPU SCENE GRAPH: the world matrices propagated by a compute pass         *
+****************************************************************************/
+
+/* GpuSceneGraph: keeps the local transforms of a SceneGraph on the GPU and
+* computes the world matrices there (shaders/hierarchy.cs.glsl), for scenes
+* where even the batched update() on the job system and the upload of its
+* matrices cost too much. The nodes must be sorted by level (sortLevels),
+* so each level is a range, and the pass takes one dispatch per level, a
+* thread per node, with a barrier in between: a node only reads the world
+* matrix of its parent, which the dispatch before wrote.
+* The CPU only writes the local transforms of the dirty nodes, into a
+* DynamicBuffer, so the upload is as small as what changed, stamped with
+* the version of the update. A node is computed again if its stamp is the
+* current version or its parent was computed in this one, as update()
+* does with the dirty and changed flags; the others keep their world
+* matrix, and an update without any dirty node dispatches nothing.
+* The world matrix of a node with a draw goes right into the model matrix
+* of that draw, in the instance buffer the draws read, and the center of
+* its bounding sphere into the buffer of the culling pass, which both read
+* the results where they are, nothing comes back to the CPU. The world
+* matrices of the SceneGraph itself are not kept up to date meanwhile.
+* It needs compute shaders and storage buffers, GL 4.3. */
+#define GPU_SCENE_GRAPH_SHADER "shaders/hierarchy.cs.glsl"
+#define GPU_SCENE_GRAPH_GROUP 64	/* local size of the compute shader */
+#define GPU_SCENE_GRAPH_MAX_GROUPS 65535	/* per dispatch, the minimum of GL_MAX_COMPUTE_WORK_GROUP_COUNT */
+#define GPU_SCENE_GRAPH_GRAIN 4096	/* nodes per job of the upload */
+
+/* a local transform as the compute shader reads it, std430 */
+typedef struct {
+	glm::vec4 translation;	/* w: the version it was written in, as the bits of a uint */
+	glm::vec4 rotation;	/* quaternion x, y, z, w */
+	glm::vec4 scale;
+} GpuSceneNode;
+
+typedef struct GpuSceneGraph {
+	GLuint program;		/* 0 if not supported */
+	GLint firstLoc, countLoc, versionLoc, spheresLoc;
+	SceneGraph *graph;
+	DynamicBuffer locals;	/* GpuSceneNode per node */
+	GLuint parentBuffer;	/* parent per node, -1 for the roots */
+	GLuint drawBuffer;	/* draw per node, -1 for those without */
+	GLuint worldBuffer;	/* world matrix per node */
+	GLuint changedBuffer;	/* per node, the version it was last computed in */
+	GLuint version;		/* of the last update, 0 before the first */
+	std::atomic<int> written;	/* nodes uploaded by the last update */
+
+	void clear()
+	{
+		program = 0;
+		graph = NULL;
+		locals.clear();
+		parentBuffer = drawBuffer = worldBuffer = changedBuffer = 0;
+		version = 0;
+		written.store(0, std::memory_order_relaxed);
+	}
+
+	/* Build the program, loaded via cache, and the buffers for the nodes
+	* of g, which must be sorted by level; draws[i] is the draw of node i,
+	* -1 if it has none. All nodes are computed by the first update().
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache, SceneGraph *g, const GLint *draws)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		if (!computeShaderSupported() || !glCaps()->storageBuffers)
+			return false;
+		if (!g->levelCount) {
+			warn("GpuSceneGraph: the nodes are not sorted by level");
+			return false;
+		}
+		program = computeProgramBuild(cache, GPU_SCENE_GRAPH_SHADER);
+		if (!program)
+			return false;
+		firstLoc = glGetUniformLocation(program, "first");
+		countLoc = glGetUniformLocation(program, "count");
+		versionLoc = glGetUniformLocation(program, "version");
+		spheresLoc = glGetUniformLocation(program, "writeSpheres");
+		graph = g;
+		int count = g->count;
+		if (!locals.init(GL_SHADER_STORAGE_BUFFER, sizeof(GpuSceneNode) * count, sizeof(GpuSceneNode),
+			"scene graph locals")) {
+			destroy();
+			return false;
+		}
+		parentBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(GLint) * count, g->parent,
+			"scene graph parents");
+		drawBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(GLint) * count, draws, "scene graph draws");
+		worldBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(glm::mat4) * count, NULL,
+			"scene graph worlds");
+		GLuint *zeros = (GLuint*)calloc(count, sizeof(GLuint));
+		if (zeros)
+			changedBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * count, zeros,
+				"scene graph changed");
+		free(zeros);
+		if (!parentBuffer || !drawBuffer || !worldBuffer || !changedBuffer) {
+			warn("GpuSceneGraph: failed to create the buffers for %d nodes", count);
+			destroy();
+			return false;
+		}
+		invalidate();
+		info("GpuSceneGraph: %d nodes in %d levels, program %u", count, g->levelCount, program);
+		GL_ERROR_DBG("GPU scene graph initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (parentBuffer || drawBuffer || worldBuffer || changedBuffer) {
+			GLuint buffers[4] = { parentBuffer, drawBuffer, worldBuffer, changedBuffer };
+			glState()->deleteBuffers(4, buffers);
+		}
+		locals.destroy();
+		if (program)
+			glState()->deleteProgram(program);
+		clear();
+	}
+
+	/* Compute all nodes again by the next update(), e.g. since the world
+	* matrices were written by the CPU meanwhile. */
+	void invalidate()
+	{
+		int i;
+		for (i = 0; i < graph->count; i++)
+			graph->dirty[i] = 1;
+	}
+
+	/* Upload the local transforms of the dirty nodes on jobs, if given,
+	* and compute the world matrices of those and of everything below them,
+	* writing the matrices of the nodes with draws into models, a mat4 per
+	* draw, and the centers of their bounding spheres into spheres, a vec4
+	* per draw, if that is not 0. Issues the barriers for drawing with the
+	* models and culling with the spheres after.
+	* Returns the number of nodes uploaded. */
+	int update(JobSystem *jobs, GLuint models, GLuint spheres)
+	{
+		int l;
+
+		version++;
+		written.store(0, std::memory_order_relaxed);
+		if (jobs)
+			jobs->run(uploadNodes, this, graph->count, GPU_SCENE_GRAPH_GRAIN);
+		else
+			uploadRange(0, graph->count);
+		int n = written.load(std::memory_order_relaxed);
+		if (!n)
+			return 0;
+		locals.flush();
+
+		GL_DEBUG_GROUP("scene graph");
+		glState()->useProgram(program);
+		glUniform1ui(versionLoc, version);
+		glUniform1i(spheresLoc, spheres != 0);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, locals.buffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, parentBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, worldBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, changedBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, models);
+		/* never written without spheres, but a buffer must be bound */
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, spheres ? spheres : worldBuffer);
+		for (l = 0; l < graph->levelCount; l++) {
+			GLuint first = (GLuint)graph->levels[l];
+			GLuint count = (GLuint)(graph->levels[l + 1] - graph->levels[l]);
+			while (count > 0) {
+				GLuint groups = (count + GPU_SCENE_GRAPH_GROUP - 1) / GPU_SCENE_GRAPH_GROUP;
+				if (groups > GPU_SCENE_GRAPH_MAX_GROUPS)
+					groups = GPU_SCENE_GRAPH_MAX_GROUPS;
+				GLuint nodes = groups * GPU_SCENE_GRAPH_GROUP < count ? groups * GPU_SCENE_GRAPH_GROUP : count;
+				glUniform1ui(firstLoc, first);
+				glUniform1ui(countLoc, nodes);
+				glDispatchCompute(groups, 1, 1);
+				first += nodes;
+				count -= nodes;
+			}
+			/* the next level reads the world matrices of this one */
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+		glState()->useProgram(0);
+		/* the draws read the models as instance attributes */
+		glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+		return n;
+	}
+
+	/* The upload of update() for the nodes [begin, end). */
+	void uploadRange(int begin, int end)
+	{
+		int i, n = 0;
+		GpuSceneNode node;
+		GLuint stamp = version;
+		memcpy(&node.translation.w, &stamp, sizeof(stamp));
+		for (i = begin; i < end; i++) {
+			if (!graph->dirty[i])
+				continue;
+			graph->dirty[i] = 0;
+			const glm::vec3 &t = graph->translation[i];
+			const glm::quat &r = graph->rotation[i];
+			const glm::vec3 &s = graph->scale[i];
+			node.translation.x = t.x;
+			node.translation.y = t.y;
+			node.translation.z = t.z;
+			node.rotation = glm::vec4(r.x, r.y, r.z, r.w);
+			node.scale = glm::vec4(s, 0.0f);
+			locals.write(i * sizeof(GpuSceneNode), &node, sizeof(node));
+			n++;
+		}
+		if (n)
+			written.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	static void uploadNodes(void *user, int begin, int end)
+	{
+		((GpuSceneGraph*)user)->uploadRange(begin, end);
+	}
+} GpuSceneGraph;
+
+#endif
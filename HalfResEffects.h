@@ -0,0 +1,349 @@
+#ifndef HEADER_HALFRESEFFECTS_H
+#define HEADER_HALFRESEFFECTS_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "RenderGraph.h"
+#include "RenderTarget.h"
+#include "Camera.h"
+
+/****************************************************************************
+* REDUCED RESOLUTION EFFECTS                                               *
+****************************************************************************/
+
+/* HalfResEffects: screen-space effects which are smooth enough to be
+* computed at half or a quarter of the resolution of the scene, like fog,
+* volumetric light or ambient occlusion, and which would cost four or
+* sixteen times as much at the full size. After the scene is drawn, its
+* depth is copied into a texture and reduced to the size of the effects
+* (shaders/depth_down.fs.glsl): each reduced texel takes the nearest depth
+* of the pixels it covers if it is on a black square of a checkerboard and
+* the farthest if it is on a white one, so along every edge the reduced
+* depth keeps samples of both sides. Each effect is a fragment shader
+* drawing a full-screen triangle into a target of that size, which holds
+* the light it adds in rgb and how much of the scene shows through in
+* alpha. A bilateral upsample (shaders/bilateral_upsample.fs.glsl) blends
+* it into the scene: each pixel weights the four reduced texels around it
+* by their distance, as bilinear filtering would, and also by how close
+* their linear depth is to its own, so the effect of the background does
+* not bleed over the edges of objects in front of it, and the other way
+* round. All of this is a RenderGraph, with the scene imported once per
+* effect so the effects blend in the order they were added.
+* The effect programs get the reduced depth in unit 0 and the uniforms
+* clipToWorld (the inverse view projection), eye (the camera position),
+* sun (towards the sun in world space), depthRange (near and far plane)
+* and seconds, which they may leave out; the names of the frame uniforms
+* are taken by the block of shaders/frame.glsl. The first effect is the
+* height fog of shaders/fog.fs.glsl, which raymarches through a layer of
+* noisy fog to the depth of each pixel. */
+#define HALFRES_VS "shaders/raymarch.vs.glsl"	/* a full-screen triangle */
+#define HALFRES_DEPTH_FS "shaders/depth_down.fs.glsl"
+#define HALFRES_UPSAMPLE_FS "shaders/bilateral_upsample.fs.glsl"
+#define HALFRES_FOG_FS "shaders/fog.fs.glsl"
+#define HALFRES_FACTOR 2	/* the default, the sides of the scene over those of the effects */
+#define HALFRES_MAX_FACTOR 4
+#define HALFRES_MAX_EFFECTS 4
+#define HALFRES_FORMAT GL_RGBA16F	/* rgb: added light, a: transmittance */
+#define HALFRES_DEPTH_FORMAT GL_R32F
+
+/* the texture units of the upsample */
+#define HALFRES_EFFECT_UNIT 0
+#define HALFRES_REDUCED_UNIT 1
+#define HALFRES_DEPTH_UNIT 2
+
+static const char *const halfResUpsampleNames[HALFRES_MAX_EFFECTS] = {
+	"upsample 1", "upsample 2", "upsample 3", "upsample 4"
+};
+static const char *const halfResSceneNames[HALFRES_MAX_EFFECTS + 1] = {
+	"scene", "scene + 1", "scene + 2", "scene + 3", "scene + 4"
+};
+
+struct HalfResEffects;
+
+typedef struct {
+	const char *name;
+	bool enabled;
+	GLuint program;
+	GLint clipToWorldLoc, eyeLoc, sunLoc, depthRangeLoc, secondsLoc;
+	struct HalfResEffects *owner;
+} HalfResEffect;
+
+typedef struct HalfResEffects {
+	int factor;		/* HALFRES_FACTOR or HALFRES_MAX_FACTOR */
+	HalfResEffect effects[HALFRES_MAX_EFFECTS];
+	int effectCount;
+	int fog;		/* the effect of the height fog, -1 if not available */
+	ShaderSourceCache *sources;
+	GLuint depthProgram, upsampleProgram;	/* 0 if not supported */
+	GLint depthFactorLoc, upsampleSizeLoc, upsampleRangeLoc;
+	GLuint vao;		/* empty, for the full-screen triangle */
+	GLuint depthFbo;
+	GLuint depth;		/* a copy of the depth of the scene */
+	GLsizei width, height;	/* of the scene */
+	RenderGraph graph;
+	/* while executing */
+	const Camera *camera;
+	glm::vec3 sun;
+	float time;
+	GLsizei reducedWidth, reducedHeight;
+
+	void clear()
+	{
+		factor = HALFRES_FACTOR;
+		effectCount = 0;
+		fog = -1;
+		sources = NULL;
+		depthProgram = upsampleProgram = vao = 0;
+		depthFbo = depth = 0;
+		width = height = 0;
+		camera = NULL;
+		sun = glm::vec3(0.0f, 1.0f, 0.0f);
+		time = 0.0f;
+		reducedWidth = reducedHeight = 0;
+	}
+
+	/* Build the depth reduction and the upsample, and add the fog, the
+	* sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		sources = cache;
+		depthProgram = programBuild(cache, HALFRES_VS, HALFRES_DEPTH_FS);
+		upsampleProgram = programBuild(cache, HALFRES_VS, HALFRES_UPSAMPLE_FS);
+		if (!depthProgram || !upsampleProgram) {
+			destroy();
+			return false;
+		}
+		depthFactorLoc = glGetUniformLocation(depthProgram, "factor");
+		upsampleSizeLoc = glGetUniformLocation(upsampleProgram, "reducedSize");
+		upsampleRangeLoc = glGetUniformLocation(upsampleProgram, "depthRange");
+		glState()->useProgram(upsampleProgram);
+		glUniform1i(glGetUniformLocation(upsampleProgram, "effect"), HALFRES_EFFECT_UNIT);
+		glUniform1i(glGetUniformLocation(upsampleProgram, "reduced"), HALFRES_REDUCED_UNIT);
+		glUniform1i(glGetUniformLocation(upsampleProgram, "depth"), HALFRES_DEPTH_UNIT);
+		glState()->useProgram(0);
+		glGenVertexArrays(1, &vao);
+		graph.init();
+		fog = addEffect("fog", HALFRES_FOG_FS);
+		info("half-resolution effects: depth program %u, upsample program %u", depthProgram, upsampleProgram);
+		return true;
+	}
+
+	void destroyDepth()
+	{
+		if (depthFbo)
+			glDeleteFramebuffers(1, &depthFbo);
+		if (depth)
+			glState()->deleteTextures(1, &depth);
+		depthFbo = depth = 0;
+		width = height = 0;
+	}
+
+	void destroy()
+	{
+		int i;
+		destroyDepth();
+		for (i = 0; i < effectCount; i++)
+			glState()->deleteProgram(effects[i].program);
+		if (depthProgram)
+			glState()->deleteProgram(depthProgram);
+		if (upsampleProgram)
+			glState()->deleteProgram(upsampleProgram);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		graph.destroy();
+		clear();
+	}
+
+	/* Add an effect drawn by the fragment shader fs, off until enabled.
+	* Returns its index, or -1 in case of an error. */
+	int addEffect(const char *name, const char *fs)
+	{
+		if (!depthProgram || effectCount >= HALFRES_MAX_EFFECTS)
+			return -1;
+		GLuint program = programBuild(sources, HALFRES_VS, fs);
+		if (!program) {
+			warn("half-resolution effects: %s is not supported", name);
+			return -1;
+		}
+		HalfResEffect *e = &effects[effectCount];
+		e->name = name;
+		e->enabled = false;
+		e->program = program;
+		e->clipToWorldLoc = glGetUniformLocation(program, "clipToWorld");
+		e->eyeLoc = glGetUniformLocation(program, "eye");
+		e->sunLoc = glGetUniformLocation(program, "sun");
+		e->depthRangeLoc = glGetUniformLocation(program, "depthRange");
+		e->secondsLoc = glGetUniformLocation(program, "seconds");
+		e->owner = this;
+		glState()->useProgram(program);
+		glUniform1i(glGetUniformLocation(program, "depth"), 0);
+		glState()->useProgram(0);
+		info("half-resolution effects: %s program %u", name, program);
+		return effectCount++;
+	}
+
+	/* Turn effect index on or off.
+	* Returns false if there is no such effect. */
+	bool setEnabled(int index, bool enable)
+	{
+		if (index < 0 || index >= effectCount)
+			return false;
+		effects[index].enabled = enable;
+		return true;
+	}
+
+	/* Compute the effects at 1 / f of the sides of the scene, f is 2 or
+	* 4. */
+	void setFactor(int f)
+	{
+		factor = (f >= HALFRES_MAX_FACTOR) ? HALFRES_MAX_FACTOR : HALFRES_FACTOR;
+	}
+
+	/* Whether any effect is on. */
+	bool active() const
+	{
+		int i;
+		for (i = 0; i < effectCount; i++)
+			if (effects[i].enabled)
+				return true;
+		return false;
+	}
+
+	/* (Re-)allocate the copy of the depth for a scene of w x h pixels.
+	* Returns true if successfull and false in case of an error. */
+	bool resizeDepth(GLsizei w, GLsizei h)
+	{
+		if (w == width && h == height)
+			return true;
+		destroyDepth();
+		MemoryScope scope(MEMORY_TARGETS);
+		glGenTextures(1, &depth);
+		glState()->bindTexture(GL_TEXTURE_2D, depth);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, w, h, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glGenFramebuffers(1, &depthFbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!RenderTarget::checkComplete(depthFbo)) {
+			destroyDepth();
+			return false;
+		}
+		width = w;
+		height = h;
+		return true;
+	}
+
+	void drawTriangle()
+	{
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+	}
+
+	/* The depth of the scene, reduced by the factor. */
+	static void runDepthDown(void *object, const RenderPass *p)
+	{
+		HalfResEffects *h = (HalfResEffects*)object;
+		glState()->useProgram(h->depthProgram);
+		glUniform1i(h->depthFactorLoc, h->factor);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[0]);
+		h->drawTriangle();
+	}
+
+	/* An effect, from the reduced depth. */
+	static void runEffect(void *object, const RenderPass *p)
+	{
+		HalfResEffect *e = (HalfResEffect*)object;
+		HalfResEffects *h = e->owner;
+		glState()->useProgram(e->program);
+		glUniformMatrix4fv(e->clipToWorldLoc, 1, GL_FALSE, &h->camera->viewProjectionInverse[0][0]);
+		glUniform3fv(e->eyeLoc, 1, &h->camera->position[0]);
+		glUniform3fv(e->sunLoc, 1, &h->sun[0]);
+		glUniform2f(e->depthRangeLoc, h->camera->zNear, h->camera->zFar);
+		glUniform1f(e->secondsLoc, h->time);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[0]);
+		h->drawTriangle();
+	}
+
+	/* Blend an effect into the scene: the scene times its alpha plus its
+	* color. */
+	static void runUpsample(void *object, const RenderPass *p)
+	{
+		HalfResEffects *h = (HalfResEffects*)object;
+		glState()->useProgram(h->upsampleProgram);
+		glUniform2f(h->upsampleSizeLoc, (GLfloat)h->reducedWidth, (GLfloat)h->reducedHeight);
+		glUniform2f(h->upsampleRangeLoc, h->camera->zNear, h->camera->zFar);
+		glState()->activeTexture(GL_TEXTURE0 + HALFRES_EFFECT_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[0]);
+		glState()->activeTexture(GL_TEXTURE0 + HALFRES_REDUCED_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[1]);
+		glState()->activeTexture(GL_TEXTURE0 + HALFRES_DEPTH_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[2]);
+		glState()->raster(RASTER_TRANSLUCENT);
+		glState()->enable(GL_BLEND);
+		glState()->blendFunc(GL_ONE, GL_SRC_ALPHA);
+		h->drawTriangle();
+		glState()->raster(0);
+	}
+
+	/* Blend the effects which are on into scene, before its samples are
+	* resolved, seen by cam with the sun in direction sunDirection at time
+	* seconds.
+	* Returns true if successfull and false in case of an error. */
+	bool execute(RenderTarget *scene, const Camera *cam, const glm::vec3 &sunDirection, double seconds)
+	{
+		GLsizei w = scene->width, h = scene->height;
+		int i, n = 0;
+
+		if (!resizeDepth(w, h)) {
+			warn("half-resolution effects: failed to create the depth copy, off");
+			for (i = 0; i < effectCount; i++)
+				effects[i].enabled = false;
+			return false;
+		}
+		GL_DEBUG_GROUP("half-resolution effects");
+		camera = cam;
+		sun = sunDirection;
+		time = (float)seconds;
+		reducedWidth = (w + factor - 1) / factor;
+		reducedHeight = (h + factor - 1) / factor;
+		/* the depth of the scene, as a texture */
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, scene->fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFbo);
+		glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+		graph.begin();
+		int full = graph.import("depth", depth, depthFbo, w, h);
+		int reduced = graph.create("reduced depth", HALFRES_DEPTH_FORMAT, reducedWidth, reducedHeight);
+		int color = graph.import(halfResSceneNames[0], scene->color, scene->fbo, w, h);
+		graph.addPass("depth down", runDepthDown, this, 0, &full, 1, reduced);
+		for (i = 0; i < effectCount; i++) {
+			HalfResEffect *e = &effects[i];
+			if (!e->enabled)
+				continue;
+			int output = graph.create(e->name, HALFRES_FORMAT, reducedWidth, reducedHeight);
+			graph.addPass(e->name, runEffect, e, 0, &reduced, 1, output);
+			/* the scene before, as an input, keeps the order */
+			int inputs[4] = { output, reduced, full, color };
+			color = graph.import(halfResSceneNames[n + 1], scene->color, scene->fbo, w, h);
+			graph.addPass(halfResUpsampleNames[n], runUpsample, this, 0, inputs, 4, color);
+			n++;
+		}
+		return graph.execute();
+	}
+} HalfResEffects;
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef HEADER_HEADLESSCONTEXT_H
+#define HEADER_HEADLESSCONTEXT_H
+
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+#include "Log.h"
+#include "GLCaps.h"
+
+/****************************************************************************
+* HEADLESS CONTEXT                                                         *
+****************************************************************************/
+
+/* An OpenGL context without a window system, for GPU servers without an X
+* server: EGL_EXT_device_enumeration lists the GPUs, EGL_EXT_platform_device
+* opens a display on one of them directly, and the context is made current
+* without a surface (EGL_KHR_surfaceless_context). Everything is drawn into
+* the offscreen framebuffer, so the context is only good for the modes which
+* never show a frame, the benchmark and the batch mode.
+* libEGL is loaded at run time, so the application neither links against it
+* nor needs its headers; the few types and enums used are declared here.
+* Like the window, the context is the newest core profile of
+* glCapsVersions the driver creates. Not available on Windows. */
+typedef void *HeadlessEGLDisplay;
+typedef void *HeadlessEGLConfig;
+typedef void *HeadlessEGLContext;
+typedef void *HeadlessEGLDevice;
+typedef int HeadlessEGLint;
+
+#define HEADLESS_EGL_NONE 0x3038
+#define HEADLESS_EGL_EXTENSIONS 0x3055
+#define HEADLESS_EGL_RENDERABLE_TYPE 0x3040
+#define HEADLESS_EGL_SURFACE_TYPE 0x3033
+#define HEADLESS_EGL_OPENGL_BIT 0x0008
+#define HEADLESS_EGL_OPENGL_API 0x30A2
+#define HEADLESS_EGL_PLATFORM_DEVICE 0x313F	/* EGL_PLATFORM_DEVICE_EXT */
+#define HEADLESS_EGL_DRM_DEVICE_FILE 0x3233	/* EGL_DRM_DEVICE_FILE_EXT */
+#define HEADLESS_EGL_CONTEXT_MAJOR_VERSION 0x3098	/* EGL_KHR_create_context */
+#define HEADLESS_EGL_CONTEXT_MINOR_VERSION 0x30FB
+#define HEADLESS_EGL_CONTEXT_FLAGS 0x30FC
+#define HEADLESS_EGL_CONTEXT_OPENGL_PROFILE_MASK 0x30FD
+#define HEADLESS_EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT 0x1
+#define HEADLESS_EGL_CONTEXT_OPENGL_DEBUG_BIT 0x1
+#define HEADLESS_EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT 0x2
+#define HEADLESS_DEVICES_MAX 16
+
+typedef struct {
+	void *library;		/* libEGL */
+	void *(*getProcAddress)(const char *name);
+	unsigned int (*initialize)(HeadlessEGLDisplay, HeadlessEGLint*, HeadlessEGLint*);
+	unsigned int (*terminate)(HeadlessEGLDisplay);
+	const char *(*queryString)(HeadlessEGLDisplay, HeadlessEGLint);
+	unsigned int (*chooseConfig)(HeadlessEGLDisplay, const HeadlessEGLint*, HeadlessEGLConfig*, HeadlessEGLint,
+		HeadlessEGLint*);
+	unsigned int (*bindAPI)(unsigned int);
+	HeadlessEGLContext (*createContext)(HeadlessEGLDisplay, HeadlessEGLConfig, HeadlessEGLContext,
+		const HeadlessEGLint*);
+	unsigned int (*destroyContext)(HeadlessEGLDisplay, HeadlessEGLContext);
+	unsigned int (*makeCurrent)(HeadlessEGLDisplay, void*, void*, HeadlessEGLContext);
+	HeadlessEGLint (*getError)(void);
+	unsigned int (*queryDevices)(HeadlessEGLint, HeadlessEGLDevice*, HeadlessEGLint*);
+	const char *(*queryDeviceString)(HeadlessEGLDevice, HeadlessEGLint);
+	HeadlessEGLDisplay (*getPlatformDisplay)(unsigned int, void*, const HeadlessEGLint*);
+	HeadlessEGLDisplay display;	/* NULL if there is no headless context */
+	HeadlessEGLContext context;
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	/* Load libEGL and the functions used.
+	* Returns true if successfull and false in case of an error. */
+	bool load()
+	{
+#ifdef _WIN32
+		warn("headless: EGL devices are not supported on Windows");
+		return false;
+#else
+		library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+		if (!library)
+			library = dlopen("libEGL.so", RTLD_NOW | RTLD_LOCAL);
+		if (!library) {
+			warn("headless: failed to load libEGL");
+			return false;
+		}
+		*(void**)&getProcAddress = dlsym(library, "eglGetProcAddress");
+		*(void**)&initialize = dlsym(library, "eglInitialize");
+		*(void**)&terminate = dlsym(library, "eglTerminate");
+		*(void**)&queryString = dlsym(library, "eglQueryString");
+		*(void**)&chooseConfig = dlsym(library, "eglChooseConfig");
+		*(void**)&bindAPI = dlsym(library, "eglBindAPI");
+		*(void**)&createContext = dlsym(library, "eglCreateContext");
+		*(void**)&destroyContext = dlsym(library, "eglDestroyContext");
+		*(void**)&makeCurrent = dlsym(library, "eglMakeCurrent");
+		*(void**)&getError = dlsym(library, "eglGetError");
+		if (!getProcAddress || !initialize || !terminate || !queryString || !chooseConfig || !bindAPI ||
+			!createContext || !destroyContext || !makeCurrent || !getError) {
+			warn("headless: libEGL lacks EGL 1.4 functions");
+			return false;
+		}
+		/* the client extensions, no display needed */
+		const char *ext = queryString(NULL, HEADLESS_EGL_EXTENSIONS);
+		if (!ext || !strstr(ext, "EGL_EXT_device_enumeration") || !strstr(ext, "EGL_EXT_platform_device")) {
+			warn("headless: EGL has no EGL_EXT_device_enumeration and EGL_EXT_platform_device");
+			return false;
+		}
+		*(void**)&queryDevices = getProcAddress("eglQueryDevicesEXT");
+		*(void**)&queryDeviceString = getProcAddress("eglQueryDeviceStringEXT");
+		*(void**)&getPlatformDisplay = getProcAddress("eglGetPlatformDisplayEXT");
+		return queryDevices && getPlatformDisplay;
+#endif
+	}
+
+	/* Query the EGL devices into devices and log them with their DRM device
+	* files, after load(), and list them in list as well unless it is NULL.
+	* Returns their number, 0 in case of an error. */
+	int queryAll(HeadlessEGLDevice *devices, FILE *list = NULL)
+	{
+		HeadlessEGLint count = 0, i;
+		if (!queryDevices(HEADLESS_DEVICES_MAX, devices, &count) || count < 1) {
+			warn("headless: no EGL devices");
+			return 0;
+		}
+		for (i = 0; i < count; i++) {
+			const char *file = queryDeviceString ? queryDeviceString(devices[i], HEADLESS_EGL_DRM_DEVICE_FILE) : NULL;
+			info("headless: EGL device %d%s%s", (int)i, file ? ": " : "", file ? file : "");
+			if (list)
+				fprintf(list, "%d %s\n", (int)i, file ? file : "-");
+		}
+		return (int)count;
+	}
+
+	/* The number of EGL devices, without creating a context; they are
+	* logged and listed in list, see queryAll().
+	* Returns 0 if there are none or EGL is not available. */
+	int deviceCount(FILE *list = NULL)
+	{
+		HeadlessEGLDevice devices[HEADLESS_DEVICES_MAX];
+		int count = 0;
+		clear();
+		if (load())
+			count = queryAll(devices, list);
+		destroy();
+		return count;
+	}
+
+	/* Create the context on GPU number device of the EGL devices, a debug
+	* context if debug is set, and make it current.
+	* Returns true if successfull and false in case of an error. */
+	bool init(int device, bool debug)
+	{
+		HeadlessEGLDevice devices[HEADLESS_DEVICES_MAX];
+		HeadlessEGLint major = 0, minor = 0, configs = 0, i;
+		int count;
+		HeadlessEGLConfig config;
+		const HeadlessEGLint configAttribs[] = {
+			HEADLESS_EGL_RENDERABLE_TYPE, HEADLESS_EGL_OPENGL_BIT,
+			/* any, the default would ask for window surfaces */
+			HEADLESS_EGL_SURFACE_TYPE, 0,
+			HEADLESS_EGL_NONE
+		};
+
+		clear();
+		if (!load()) {
+			destroy();
+			return false;
+		}
+		count = queryAll(devices);
+		if (!count) {
+			destroy();
+			return false;
+		}
+		if (device < 0 || device >= count) {
+			warn("headless: there is no EGL device %d", device);
+			destroy();
+			return false;
+		}
+		display = getPlatformDisplay(HEADLESS_EGL_PLATFORM_DEVICE, devices[device], NULL);
+		if (!display || !initialize(display, &major, &minor)) {
+			warn("headless: failed to initialize EGL on device %d (0x%x)", device, (unsigned)getError());
+			display = NULL;
+			destroy();
+			return false;
+		}
+		const char *ext = queryString(display, HEADLESS_EGL_EXTENSIONS);
+		if (!ext || !strstr(ext, "EGL_KHR_surfaceless_context") || !strstr(ext, "EGL_KHR_create_context")) {
+			warn("headless: EGL %d.%d on device %d has no surfaceless contexts", (int)major, (int)minor, device);
+			destroy();
+			return false;
+		}
+		if (!bindAPI(HEADLESS_EGL_OPENGL_API) || !chooseConfig(display, configAttribs, &config, 1, &configs) ||
+			configs < 1) {
+			warn("headless: no OpenGL config on device %d", device);
+			destroy();
+			return false;
+		}
+		for (i = 0; i < GL_CAPS_VERSIONS && !context; i++) {
+			if (!glCaps()->allowed(glCapsVersions[i][0], glCapsVersions[i][1]))
+				continue;
+			const HeadlessEGLint attribs[] = {
+				HEADLESS_EGL_CONTEXT_MAJOR_VERSION, glCapsVersions[i][0],
+				HEADLESS_EGL_CONTEXT_MINOR_VERSION, glCapsVersions[i][1],
+				HEADLESS_EGL_CONTEXT_OPENGL_PROFILE_MASK, HEADLESS_EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+				HEADLESS_EGL_CONTEXT_FLAGS, HEADLESS_EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT |
+					(debug ? HEADLESS_EGL_CONTEXT_OPENGL_DEBUG_BIT : 0),
+				HEADLESS_EGL_NONE
+			};
+			context = createContext(display, config, NULL, attribs);
+		}
+		if (!context || !makeCurrent(display, NULL, NULL, context)) {
+			warn("headless: failed to create an OpenGL 3.2 core context on device %d (0x%x)", device,
+				(unsigned)getError());
+			destroy();
+			return false;
+		}
+		info("headless: EGL %d.%d context on device %d", (int)major, (int)minor, device);
+		return true;
+	}
+
+	/* The GL function name of the context, for the loader. */
+	void *proc(const char *name) const
+	{
+		return getProcAddress ? getProcAddress(name) : NULL;
+	}
+
+	void destroy()
+	{
+		if (display) {
+			makeCurrent(display, NULL, NULL, NULL);
+			if (context)
+				destroyContext(display, context);
+			terminate(display);
+		}
+#ifndef _WIN32
+		if (library)
+			dlclose(library);
+#endif
+		clear();
+	}
+} HeadlessContext;
+
+/* The headless context of the application, shared by all translation units
+* like logSink(). */
+inline HeadlessContext *headlessContext()
+{
+	static HeadlessContext context;
+	return &context;
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <float.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,112 +16,1459 @@
 #include "ShaderHelpers.h"
 
 #include "BaseApplication.h"
+#include "Batch.h"
+#include "BatchWorkers.h"
+#include "RenderFarm.h"
+#include "Benchmark.h"
+#include "SubmitBench.h"
+#include "VertexBench.h"
+#include "FillBench.h"
 #include "Cube.h"
+#include "MeshOptimizer.h"
+#include "TextureEncoder.h"
+
+/* The feature defines of the shader permutations, bit i of a define mask
+ * selects shaderFeatureNames[i]. See shaders/cube.vs.glsl. */
+enum {
+	SHADER_FEATURE_INSTANCED = 1 << 0,	/* per-instance model matrix */
+	SHADER_FEATURE_CUT       = 1 << 1,	/* cut a sphere out of the cube */
+	SHADER_FEATURE_WOBBLE    = 1 << 2,	/* animated vertices */
+	SHADER_FEATURE_PATTERN   = 1 << 3,	/* experimental fragment pattern */
+	SHADER_FEATURE_DEPTH_ONLY = 1 << 4,	/* depth pre-pass, no color work */
+	SHADER_FEATURE_TRANSLUCENT = 1 << 5,	/* see-through, with order-independent transparency */
+	SHADER_FEATURE_OIT_LIST  = 1 << 6,	/* ... into per-pixel lists, see Transparency.h */
+	SHADER_FEATURE_PULLED    = 1 << 7,	/* no vertex attributes, see Cube::drawPulled */
+	SHADER_FEATURE_VOXELS    = 1 << 8,	/* the raymarching program marches VoxelOctree.h */
+	SHADER_FEATURE_COMPACT   = 1 << 9,	/* packed instances, see Cube::drawCompact */
+	SHADER_FEATURE_SPINNING  = 1 << 10	/* animated on the GPU, see Cube::drawSpinning */
+};
+static const char* shaderFeatureNames[]={"INSTANCED", "CUT", "WOBBLE", "PATTERN", "DEPTH_ONLY", "TRANSLUCENT", "OIT_LIST",
+	"PULLED", "VOXELS", "COMPACT", "SPINNING"};
+#define SHADER_FEATURE_COUNT ((int)(sizeof(shaderFeatureNames)/sizeof(shaderFeatureNames[0])))
+
+/* A shader combination: a vertex and a fragment shader, built with the
+ * feature defines in defines. The instanced mode uses vsInstanced if there
+ * is one, otherwise the same shaders with the defines in instancedDefines
+ * added, or no special variant if both are unset. fsBindless replaces fs
+ * if bindless textures are supported, see Materials.h. Combinations with
+ * prepass get a depth pre-pass variant built with DEPTH_ONLY, see
+ * RenderQueue.h. raster is the raster state they draw with: the opaque
+ * cube shaders cull back faces, but the "cut" shader lets one see the
+ * inside of the cube through the hole, so it must not. The translucent
+ * ones are drawn by the transparency pass, which needs a variant of them
+ * per mode, see Transparency.h; they are registered with OIT_LIST added
+ * as well. With --vertex-pulling, the instanced cubes are drawn without
+ * vertex attributes by those with pulledDefines, added to the basic
+ * defines, see Cube::drawPulled, and with --compact-instances from packed
+ * instances by those with compactDefines, see Cube::drawCompact. With
+ * --gpu-animation, the pulled ones get SPINNING added, see
+ * Cube::drawSpinning. */
+typedef struct {
+	const char *vs, *fs, *vsInstanced;
+	unsigned int defines, instancedDefines;
+	const char *fsBindless;
+	bool prepass;
+	unsigned int raster;
+	unsigned int pulledDefines;
+	unsigned int compactDefines;
+} ShaderCombination;
+
+/* the cube shaders can make up the cube themselves, and unpack the
+ * instances */
+#define CUBE_PULLED (SHADER_FEATURE_INSTANCED | SHADER_FEATURE_PULLED)
+#define CUBE_COMPACT (SHADER_FEATURE_INSTANCED | SHADER_FEATURE_COMPACT)
+
+/* The shaders we select on the number keys. All of them are registered in
+ * the program registry at startup, so they are built before they are
+ * needed. Most are permutations of the cube shaders. */
+static const ShaderCombination shaderTable[10]={
+	/* 0 */ {"shaders/minimal.vs.glsl", "shaders/minimal.fs.glsl", NULL, 0, 0, NULL, false, RASTER_DEFAULT, 0},
+	/* 1 */ {"shaders/cube.vs.glsl", "shaders/cube.fs.glsl", NULL, 0, SHADER_FEATURE_INSTANCED, NULL, true, RASTER_OPAQUE, CUBE_PULLED, CUBE_COMPACT},
+	/* 2 */ {"shaders/cube.vs.glsl", "shaders/cube.fs.glsl", NULL, SHADER_FEATURE_CUT, SHADER_FEATURE_INSTANCED, NULL, true, RASTER_DEFAULT, CUBE_PULLED, CUBE_COMPACT},
+	/* 3 */ {"shaders/cube.vs.glsl", "shaders/cube.fs.glsl", NULL, SHADER_FEATURE_WOBBLE, SHADER_FEATURE_INSTANCED, NULL, true, RASTER_OPAQUE, CUBE_PULLED, CUBE_COMPACT},
+	/* 4 */ {"shaders/cube.vs.glsl", "shaders/cube.fs.glsl", NULL, SHADER_FEATURE_PATTERN, SHADER_FEATURE_INSTANCED, NULL, true, RASTER_OPAQUE | RASTER_COARSE, CUBE_PULLED, CUBE_COMPACT},
+	/* 5 */ {"shaders/material.vs.glsl", MATERIAL_FS, NULL, 0, SHADER_FEATURE_INSTANCED, MATERIAL_FS_BINDLESS, true, RASTER_OPAQUE, 0},
+	/* 6 */ {"shaders/material.vs.glsl", VIRTUAL_TEXTURE_FS, NULL, 0, SHADER_FEATURE_INSTANCED, NULL, true, RASTER_OPAQUE, 0},
+	/* 7 */ {"shaders/cube.vs.glsl", "shaders/cube.fs.glsl", NULL, SHADER_FEATURE_CUT | SHADER_FEATURE_TRANSLUCENT, SHADER_FEATURE_INSTANCED, NULL, false, RASTER_TRANSLUCENT, CUBE_PULLED, CUBE_COMPACT},
+	/* placeholders for additional shaders */
+	/* 8 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl", NULL, 0, 0, NULL, false, RASTER_DEFAULT, 0},
+	/* 9 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl", NULL, 0, 0, NULL, false, RASTER_DEFAULT, 0}
+};
+
+/* the default program, used until a number key is pressed */
+static const ShaderCombination shaderDefault={"shaders/raymarch.vs.glsl", "shaders/raymarch.fs.glsl", NULL, 0, 0, NULL, false, RASTER_DEFAULT | RASTER_COARSE, 0};
+
+/* the scopes of a frame we measure on the GPU */
+enum {
+	GPU_SCOPE_CLEAR = 0,
+	GPU_SCOPE_CULL,
+	GPU_SCOPE_DRAW,
+	GPU_SCOPE_HIZ,
+	GPU_SCOPE_SWAP,
+	GPU_SCOPE_OVERLAY,
+	GPU_SCOPE_COUNT
+};
+static const char* gpuScopeNames[GPU_SCOPE_COUNT]={"clear", "cull", "draw", "hiz", "swap", "overlay"};
 
 /* This function is registered as the framebuffer size callback for GLFW,
- * so GLFW will call this whenever the window is resized. */
+ * so GLFW will call this whenever the window is resized. Like the other
+ * callbacks, it only records the event, see InputQueue.h. */
 static void callback_Resize(GLFWwindow *win, int w, int h)
 {
 	BaseApplication *app=(BaseApplication*)glfwGetWindowUserPointer(win);
-	info("new framebuffer size: %dx%d pixels",w,h);
+	app->input.pushResize(w, h);
+	app->idle.invalidate();
+}
+
+/* This function is registered as the window refresh callback for GLFW,
+ * so GLFW will call this whenever the window was exposed. */
+static void callback_Refresh(GLFWwindow *win)
+{
+	BaseApplication *app=(BaseApplication*)glfwGetWindowUserPointer(win);
+	app->idle.invalidate();
+}
+
+/* End the main loop: close the window, or without one tell the stream
+ * server, whose viewer pressed escape, see StreamServer.h. */
+static void requestClose(BaseApplication *app)
+{
+	if (app->win)
+		glfwSetWindowShouldClose(app->win,1);
+	else
+		app->stream.quit=true;
+}
 
-	/* store curent size for later use in the main loop */
-	app->width=w;
-	app->height=h;
+/* React to a press of key. This switches programs and modes, which
+ * creates GL objects, so it runs where the frames are drawn (with a
+ * render thread there, see RenderThread.h), never inside a callback. */
+static void handleKey(BaseApplication *app, int key)
+{
+	if (key >= '0' && key <= '9') {
+		app->selectProgram(app->keyPrograms[key - '0']);
+		return;
+	}
+	switch (key) {
+		case GLFW_KEY_ESCAPE:
+			requestClose(app);
+			break;
+		case GLFW_KEY_I:
+			app->setInstanced(!app->instanced);
+			break;
+		case GLFW_KEY_M:
+			app->setSceneMode(!app->sceneMode);
+			break;
+		case GLFW_KEY_N:
+			app->setVoxelMode(!app->voxelMode);
+			break;
+		case GLFW_KEY_Q:
+			app->setVoxelRaymarch(!app->voxelRaymarch);
+			break;
+		case GLFW_KEY_Y:
+			app->setParticles(app->particles.program ? 0 : PARTICLE_DEFAULT_COUNT);
+			break;
+		case GLFW_KEY_E:
+			if (app->voxelMode)
+				app->voxels.carve(VOXEL_CRATER_RADIUS);
+			break;
+		case GLFW_KEY_C:
+			app->setCulling(!app->culling);
+			break;
+		case GLFW_KEY_H:
+			app->setOcclusion(!app->scene.occlusion);
+			break;
+		case GLFW_KEY_U:
+			app->setGridCulling(!app->gridCulling);
+			break;
+		case GLFW_KEY_S:
+			app->setShadows(!app->shadows.texture);
+			break;
+		case GLFW_KEY_Z:
+			app->setDepthPrepass(!app->depthPrepass);
+			break;
+		case GLFW_KEY_B:
+			app->setFaceCulling(!app->faceCulling);
+			break;
+		case GLFW_KEY_T:
+			app->setSdfTemporal(!app->sdfTemporal.enabled);
+			break;
+		case GLFW_KEY_G:
+			app->setSdfCompute(!app->sdfCompute.enabled);
+			break;
+		case GLFW_KEY_V:
+			app->setShadingRate(!app->shadingRate.enabled);
+			break;
+		case GLFW_KEY_P:
+			app->setPostProcess(!app->post.enabled);
+			break;
+		case GLFW_KEY_A:
+			/* 1, 2, 4, 8 samples and around again */
+			app->setMultisample((app->renderOffscreen && app->offscreen.samples < 8) ?
+				app->offscreen.samples * 2 : 1);
+			break;
+		case GLFW_KEY_R:
+			app->setDynamicResolution(!app->resolution.enabled);
+			break;
+		case GLFW_KEY_W:
+			app->setTemporalAA(!app->taa.enabled, app->taa.scale);
+			break;
+		case GLFW_KEY_D:
+			app->setTessellation(!app->tessellation.enabled, app->tessellation.edgePixels);
+			break;
+		case GLFW_KEY_O:
+			app->setTransparencyMode(app->transparency.mode == OIT_WEIGHTED ? OIT_LIST : OIT_WEIGHTED);
+			break;
+		case GLFW_KEY_L:
+			app->setLowLatency(!app->pacer.enabled);
+			break;
+		case GLFW_KEY_X:
+			app->exportTrace();
+			break;
+		case GLFW_KEY_F:
+			app->setOverlay(!app->overlay.enabled);
+			break;
+		case GLFW_KEY_K:
+			app->capture.screenshot();
+			break;
+		case GLFW_KEY_J:
+			app->toggleRecording();
+			break;
+	}
 }
 
 /* This function is registered as the keyboard callback for GLFW, so GLFW
  * will call this whenever a key is pressed. */
 static void callback_Keyboard(GLFWwindow *win, int key, int scancode, int action, int mods)
 {
-	/* The shaders we load on the number keys. We always load a combination of
-	 * a vertex and a fragment shader. */
-	static const char* shaders[][2]={
-		/* 0 */ {"shaders/minimal.vs.glsl", "shaders/minimal.fs.glsl"},
-		/* 1 */ {"shaders/color.vs.glsl", "shaders/color.fs.glsl"},
-		/* 2 */ {"shaders/cut.vs.glsl", "shaders/cut.fs.glsl"},
-		/* 3 */ {"shaders/wobble.vs.glsl", "shaders/color.fs.glsl"},
-		/* 4 */ {"shaders/experimental.vs.glsl", "shaders/experimental.fs.glsl"},
-		/* placeholders for additional shaders */
-		/* 5 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl"},
-		/* 6 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl"},
-		/* 7 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl"},
-		/* 8 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl"},
-		/* 9 */ {"shaders/yourshader.vs.glsl", "shaders/yourshader.fs.glsl"}
-	};
-
 	BaseApplication *app=(BaseApplication*)glfwGetWindowUserPointer(win);
 
 	if (key < 0 || key > GLFW_KEY_LAST) {
 		warn("invalid key code %d?!",key);
 		return;
 	}
+	app->input.pushKey(key, scancode, action, mods);
+	app->idle.invalidate();
+}
+
+/* This function is registered as the mouse button callback for GLFW, so
+ * GLFW will call this whenever a mouse button is pressed or released. */
+static void callback_MouseButton(GLFWwindow *win, int button, int action, int mods)
+{
+	BaseApplication *app=(BaseApplication*)glfwGetWindowUserPointer(win);
+	double x, y;
+	int w, h;
+
+	glfwGetCursorPos(win, &x, &y);
+	glfwGetWindowSize(win, &w, &h);
+	app->input.pushButton(button, action, mods, x, y, w, h);
+	app->idle.invalidate();
+}
+
+/* Add the window event e to the input state and to packet p. */
+static void consumeEvent(BaseApplication *app, FramePacket *p, const InputEvent &e)
+{
+	if (e.type == INPUT_RESIZE) {
+		info("new framebuffer size: %dx%d pixels", e.key, e.scancode);
+		return;
+	}
+	if (e.type == INPUT_BUTTON) {
+		if (e.key == GLFW_MOUSE_BUTTON_LEFT && e.action == GLFW_PRESS) {
+			p->pick=true;
+			p->pickX=e.x;
+			p->pickY=e.y;
+		}
+		return;
+	}
+	if (!app->input.updateKey(&e))
+		return;
+	/* the animation belongs to the simulation, the other keys
+	 * switch programs and modes on the render thread */
+	if (e.key == GLFW_KEY_SPACE) {
+		app->setAnimate(!app->idle.animate);
+	} else if (p->eventCount < FRAME_PACKET_EVENTS) {
+		p->events[p->eventCount].key=e.key;
+		p->events[p->eventCount].action=e.action;
+		p->eventCount++;
+	} else {
+		warn("more than %d key presses in a frame", FRAME_PACKET_EVENTS);
+	}
+}
 
-	if (action == GLFW_RELEASE) {
-		app->pressedKeys[key] = false;
+/* Let GLFW call our callbacks with the window events, there are none for
+ * the headless context, and take the input of a remote viewer. */
+static void pollEvents(BaseApplication *app)
+{
+	if (app->win)
+		glfwPollEvents();
+	app->stream.poll(&app->input, &app->capture, app->width, app->height);
+}
+
+/* Take the window events since the last frame out of the input queue, or
+ * the replay, and put what the renderer must act on into packet p: the
+ * framebuffer size, the keys which were pressed and the last left click.
+ * This runs on the main thread, which advances the simulation. */
+static void consumeInput(BaseApplication *app, FramePacket *p)
+{
+	InputEvent e;
+	PROFILE_ZONE("input");
+
+	p->eventCount=0;
+	p->pick=false;
+	if (app->replay.beginFrame()) {
+		/* of the live events, only the window size counts, and escape
+		 * still quits */
+		while (app->input.pop(&e)) {
+			if (e.type == INPUT_RESIZE)
+				consumeEvent(app, p, e);
+			else if (e.type == INPUT_KEY && e.key == GLFW_KEY_ESCAPE && e.action == GLFW_PRESS)
+				requestClose(app);
+		}
+		while (app->replay.nextEvent(&e)) {
+			if (e.type != INPUT_RESIZE)
+				consumeEvent(app, p, e);
+		}
 	} else {
-		if (!app->pressedKeys[key]) {
-			/* handle certain keys */
-			if (key >= '0' && key <= '9') {
-				app->initShaders(shaders[key - '0'][0], shaders[key - '0'][1]);
-			} else {
-				switch (key) {
-					case GLFW_KEY_ESCAPE:
-						glfwSetWindowShouldClose(win,1);
-						break;
-				}
-			}
+		while (app->input.pop(&e)) {
+			app->replay.recordEvent(e);
+			consumeEvent(app, p, e);
 		}
-		app->pressedKeys[key] = true;
 	}
+	p->width=app->input.width;
+	p->height=app->input.height;
 }
 
 /****************************************************************************
  * DRAWING FUNCTION                                                         *
  ****************************************************************************/
 
-/* The main drawing function. This is responsible for drawing the next frame,
- * it is called in a loop as long as the application runs */
+/* the draw calls of the render queue packets, with their state bound */
+static void drawCube(void *object, const DrawPacket *)
+{
+	((Cube*)object)->draw();
+}
+
+static void drawCubeInstanced(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawInstanced();
+}
+
+static void drawCubePulled(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawPulled();
+}
+
+static void drawCubeSpinning(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawSpinning();
+}
+
+static void drawCubeCompact(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawCompact();
+}
+
+/* the same as patches, for the tessellation programs */
+static void drawCubePatches(void *object, const DrawPacket *)
+{
+	((Cube*)object)->draw(GL_PATCHES);
+}
+
+static void drawCubeInstancedPatches(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawInstanced(GL_PATCHES);
+}
+
+static void drawCubePulledPatches(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawPulled(GL_PATCHES);
+}
+
+static void drawCubeCompactPatches(void *object, const DrawPacket *)
+{
+	((Cube*)object)->drawCompact(GL_PATCHES);
+}
+
+/* the same with the positions of the compute pass, see Displacement.h */
+static void drawCubeDisplaced(void *object, const DrawPacket *)
+{
+	Displacement *d = (Displacement*)object;
+	d->bind();
+	d->cube->draw();
+}
+
+static void drawCubeInstancedDisplaced(void *object, const DrawPacket *)
+{
+	Displacement *d = (Displacement*)object;
+	d->bind();
+	d->cube->drawInstanced();
+}
+
+static void drawCubeCompactDisplaced(void *object, const DrawPacket *)
+{
+	Displacement *d = (Displacement*)object;
+	d->bind();
+	d->cube->drawCompact();
+}
+
+/* the instances of Impostors.h in the crossfade, and the billboards */
+static void drawImpostorsFading(void *object, const DrawPacket *)
+{
+	((Impostors*)object)->drawFading();
+}
+
+static void drawImpostors(void *object, const DrawPacket *)
+{
+	((Impostors*)object)->draw();
+}
+
+static void drawSkinned(void *object, const DrawPacket *)
+{
+	((SkinnedCharacters*)object)->draw();
+}
+
+static void drawMeshlets(void *object, const DrawPacket *)
+{
+	((MeshletCuller*)object)->draw();
+}
+
+static void drawScene(void *object, const DrawPacket *)
+{
+	((Scene*)object)->draw();
+}
+
+/* with the occlusion queries, but not into the shadow maps: the sun sees
+ * what the camera does not */
+static void drawSceneQueried(void *object, const DrawPacket *)
+{
+	BaseApplication *app=(BaseApplication*)object;
+	if (app->queue.currentPass == RENDER_PASS_SHADOW)
+		app->scene.draw();
+	else
+		app->scene.drawQueried();
+}
+
+/* with the ids of the objects, into the picking target of the main pass */
+static void drawScenePicked(void *object, const DrawPacket *)
+{
+	BaseApplication *app=(BaseApplication*)object;
+	bool ids = app->queue.currentPass == RENDER_PASS_MAIN;
+	if (ids)
+		app->picking.begin();
+	app->scene.draw();
+	if (ids)
+		app->picking.end();
+}
+
+/* a batch of a generated scene, see SceneGenerator.h */
+static void drawSceneBatch(void *object, const DrawPacket *)
+{
+	const SceneBatch *b=(const SceneBatch*)object;
+	b->scene->drawRange(b->first, b->count);
+}
+
+static void drawSceneCommands(void *object, const DrawPacket *)
+{
+	BaseApplication *app=(BaseApplication*)object;
+	app->scene.drawRecorded(&app->commands);
+}
+
+static void drawVoxels(void *object, const DrawPacket *)
+{
+	((VoxelWorld*)object)->draw();
+}
+
+static void drawVoxelOctree(void *object, const DrawPacket *)
+{
+	((VoxelOctree*)object)->draw();
+}
+
+static void drawSdf(void *object, const DrawPacket *)
+{
+	((SdfScene*)object)->draw();
+}
+
+/* Draw the shadow maps of the cascades in the mask cascades from the
+ * packets of the queue, each with the uniforms of frame seen from the sun;
+ * modelView is that of frame. */
+/* The programs the cube is drawn with as patches, if the tessellation is
+* on and the program of the features defines wobbles: variant holds the
+* TESS_* bits of the way the instances are drawn. *program, *prepass and
+* *shadow are those of the frame, and replaced if it returns true. */
+static bool tessellateCube(BaseApplication *app, unsigned int defines, unsigned int variant, GLuint *program,
+	GLuint *prepass, GLuint *shadow)
+{
+	if (!app->tessellation.enabled || !(defines & SHADER_FEATURE_WOBBLE))
+		return false;
+	GLuint p = app->tessellation.program(variant, app->renderWidth, app->renderHeight);
+	GLuint s = *shadow ? app->tessellation.program(variant | TESS_DEPTH_ONLY, app->renderWidth, app->renderHeight) : 0;
+	if (!p || (*shadow && !s))
+		return false;
+	*program = p;
+	*prepass = 0;
+	*shadow = s;
+	return true;
+}
+
+/* Replace the programs of the cube by those reading the positions the
+ * compute pass wrote this frame, of variant (DISPLACE_*), if it is on and
+ * defines are those of the wobble shader; the depth-only variant serves the
+ * pre-pass and the shadows, if they are drawn at all.
+ * Returns true if the cube draws the displaced vertices. */
+static bool displaceCube(BaseApplication *app, unsigned int defines, unsigned int variant, GLuint *program,
+	GLuint *prepass, GLuint *shadow)
+{
+	if (!app->displacement.active() || !(defines & SHADER_FEATURE_WOBBLE))
+		return false;
+	GLuint p = app->displacement.get(variant);
+	GLuint d = (*prepass || *shadow) ? app->displacement.get(variant | DISPLACE_DEPTH_ONLY) : 0;
+	if (!p || ((*prepass || *shadow) && !d))
+		return false;
+	*program = p;
+	if (*prepass)
+		*prepass = d;
+	if (*shadow)
+		*shadow = d;
+	return true;
+}
+
+/* The program the scene is drawn with to write the ids of its objects for
+ * picking, see Picking.h, if it is on and the cube program with defines
+ * draws it; *program is that of the frame, and replaced if it returns
+ * true. */
+static bool pickScene(BaseApplication *app, unsigned int defines, GLuint *program)
+{
+	if (!app->picking.enabled || app->pulling() || app->compacting() ||
+		(defines & ~(SHADER_FEATURE_INSTANCED | SHADER_FEATURE_CUT | SHADER_FEATURE_WOBBLE | SHADER_FEATURE_PATTERN)))
+		return false;
+	const char *vs = app->programs.entries[app->currentProgram].vs[PROGRAM_VARIANT_INSTANCED];
+	if (!vs || strcmp(vs, PICKING_VS) != 0)
+		return false;
+	GLuint p = app->picking.get(((defines & SHADER_FEATURE_CUT) ? PICKING_CUT : 0u) |
+		((defines & SHADER_FEATURE_WOBBLE) ? PICKING_WOBBLE : 0u) |
+		((defines & SHADER_FEATURE_PATTERN) ? PICKING_PATTERN : 0u));
+	if (!p)
+		return false;
+	*program = p;
+	return true;
+}
+
+/* Whether the distant instances are billboards this frame, see
+ * Impostors.h: they are on, and the cubes are drawn by the plain cube
+ * program, defines, with matrix instances. The atlas is baked first if the
+ * mesh changed, the frame's framebuffer is bound again after it. */
+/* Put the program of each class of the shader mix of a generated scene
+ * into programs and its raster state into rasters: the selected program,
+ * then those of the keyboard table after it which have the variant of the
+ * scene and are built, over again if there are not enough of them. */
+static void sceneBatchPrograms(BaseApplication *app, GLuint *programs, unsigned int *rasters)
+{
+	int i, key=0, n=1;
+	int variant=app->drawVariant();
+
+	programs[0]=app->program;
+	rasters[0]=app->raster;
+	for (i=0; i<10; i++)
+		if (app->keyPrograms[i] == app->currentProgram)
+			key=i;
+	for (i=1; i<10 && n<app->scene.batchCount; i++) {
+		int index=app->keyPrograms[(key + i) % 10];
+		if (index < 0 || index == app->sdfProgram || !app->programs.entries[index].vs[variant])
+			continue;
+		GLuint program=app->programs.get(index, variant);
+		if (!program)
+			continue;
+		programs[n]=program;
+		rasters[n++]=app->programRaster(index);
+	}
+	for (i=n; i<app->scene.batchCount; i++) {
+		programs[i]=programs[i % n];
+		rasters[i]=rasters[i % n];
+	}
+}
+
+static bool impostorCubes(BaseApplication *app, unsigned int defines)
+{
+	Impostors *im = &app->impostors;
+	if (!im->enabled || app->pulling() || app->compacting() || defines != SHADER_FEATURE_INSTANCED)
+		return false;
+	const char *vs = app->programs.entries[app->currentProgram].vs[PROGRAM_VARIANT_INSTANCED];
+	if (!vs || strcmp(vs, IMPOSTOR_FADE_VS) != 0)
+		return false;
+	if (!im->baked()) {
+		bool baked = im->bake();
+		glBindFramebuffer(GL_FRAMEBUFFER, app->renderFramebuffer());
+		glState()->viewport(0, 0, app->renderWidth, app->renderHeight);
+		if (!baked) {
+			warn("impostors: failed to bake the atlas, turning them off");
+			im->enabled = false;
+			return false;
+		}
+	}
+	return true;
+}
+
+static void drawShadows(BaseApplication *app, const FrameUniforms *frame, const glm::mat4 &modelView,
+	unsigned int cascades)
+{
+	PROFILE_ZONE("shadows");
+	GL_DEBUG_GROUP("shadows");
+	FrameUniforms f = *frame;
+	/* the model transform, if the frame has one */
+	glm::mat4 model = glm::inverse(app->camera.view) * modelView;
+	int i;
+
+	for (i = 0; i < SHADOW_CASCADES; i++) {
+		if (!(cascades & (1u << i)))
+			continue;
+		f.projection = app->shadows.viewProjection[i];
+		f.modelView = model;
+		f.viewProjection = app->shadows.viewProjection[i];
+		f.modelViewProjection = f.projection * model;
+		if (app->pushFrameUniforms(&f) < 0)
+			break;
+		app->shadows.begin(i);
+		app->queue.submitShadow();
+	}
+	app->shadows.end(app->renderFramebuffer());
+	glState()->viewport(0, 0, app->renderWidth, app->renderHeight);
+	app->bindFrameUniforms();
+}
+
+/* Draw the velocity of the cube or of the instances into the target of
+ * TAA, see TemporalAA.h; modelView is that of the frame, defines the
+ * features of its program. The instance matrices already hold the model
+ * transform of this frame, which the motion program turns into that of the
+ * previous one. Everything else only moves with the camera, as do the
+ * instances spinning on the GPU, which have no matrices to turn. */
+static void drawMotion(BaseApplication *app, const glm::mat4 &modelView, unsigned int defines)
+{
+	bool sdfMode = app->currentProgram >= 0 && app->currentProgram == app->sdfProgram;
+	if (sdfMode || app->sceneMode || app->voxelMode || (app->instanced && app->skinning.vao) || app->spinning())
+		return;
+	TemporalAA *taa = &app->taa;
+	Cube *cube = &app->cube;
+	glm::mat4 current = app->camera.projection * modelView;
+	glm::mat4 previous = app->previousProjection * app->previousView;
+	unsigned int variant = (defines & SHADER_FEATURE_WOBBLE) ? TAA_MOTION_WOBBLE : 0;
+	/* the displaced positions are those of this frame in both */
+	Displacement *d = &app->displacement;
+	bool displaced = variant && d->active() && !app->pulling();
+	if (displaced)
+		variant = TAA_MOTION_DISPLACED;
+
+	taa->beginMotion(app->offscreen.depth, app->raster);
+	if (app->instanced) {
+		/* the instance matrices are relative to instanceOrigin, which
+		 * the previous view sees from the previous position */
+		glm::mat4 model = glm::inverse(cube->model) * app->previousModel;
+		previous = app->previousProjection * app->previousRotation *
+			glm::translate(glm::mat4(1.0f), glm::vec3(app->instanceOrigin() - app->previousEye));
+		variant |= TAA_MOTION_INSTANCED;
+		if (app->pulling())
+			taa->drawMotion(variant | TAA_MOTION_PULLED, current, previous, model, cube->pullVao, drawCubePulled, cube);
+		else if (app->compacting())
+			taa->drawMotion(variant | TAA_MOTION_COMPACT, current, previous, model, cube->compactVao,
+				displaced ? drawCubeCompactDisplaced : drawCubeCompact, displaced ? (void*)d : (void*)cube);
+		else
+			taa->drawMotion(variant, current, previous, model, cube->vao,
+				displaced ? drawCubeInstancedDisplaced : drawCubeInstanced, displaced ? (void*)d : (void*)cube);
+	} else {
+		taa->drawMotion(variant, current, previous * app->previousModel, glm::mat4(1.0f), cube->vao,
+			displaced ? drawCubeDisplaced : drawCube, displaced ? (void*)d : (void*)cube);
+	}
+	taa->endMotion(app->renderFramebuffer());
+}
+
+/* The jobs writing the model matrices of the grids, in chunks of grain
+ * objects, see JobSystem.h. The instanced mode only writes the instances
+ * which survive the culling, packed in order: the chunks are counted
+ * first, and each one writes from where those before it end. With the
+ * impostors, the instances are counted and written by their distance in
+ * three runs, those drawn as meshes, those in the crossfade and the
+ * billboards, see Impostors.h. The scene mode writes a chunk of entities
+ * per job. */
+#define MODEL_JOB_GRAIN 256	/* objects per chunk */
+#define MODEL_JOB_CHUNKS 64	/* at most, the grain grows with the grid */
+
+typedef struct {
+	BaseApplication *app;
+	const FrustumCuller *culler;	/* NULL if every instance is visible */
+	const SpatialGrid *cells;	/* or the instances in the order of its cells */
+	glm::mat4 *models;	/* mapped, of the visible objects */
+	glm::u32vec3 *packed;	/* or the instances packed into them, see Cube::drawCompact */
+	glm::vec4 box;		/* of the packed positions, see BaseApplication::instanceBox */
+	/* if doubles is set, the world transforms are taken in double
+	 * precision, from the grid moved by shift to instanceOrigin, see
+	 * BaseApplication::instanceOrigin */
+	bool doubles;
+	glm::dvec3 shift;
+	int n;			/* objects per side of the instance grid */
+	int grain;
+	int offsets[MODEL_JOB_CHUNKS + 1];	/* visible objects per chunk at [c + 1], then where chunk c starts */
+	/* the same for the crossfade and the billboards, 0 and 1, if
+	 * impostors is set, at the squared distances from camera in
+	 * impostorStart */
+	bool impostors;
+	int impostorOffsets[2][MODEL_JOB_CHUNKS + 1];
+	glm::vec2 impostorStart;
+	/* the scene objects also record their draws if commands is set,
+	 * sorted front to back from camera up to far */
+	CommandQueue *commands;
+	glm::vec3 camera;
+	float far;
+} ModelJobs;
+
+/* the run of an instance at position: 0 for the meshes, 1 for the
+ * crossfade and 2 for the billboards */
+static int impostorRun(const ModelJobs *w, const glm::vec3 &position)
+{
+	glm::vec3 d=position - w->camera;
+	float d2=glm::dot(d, d);
+	return (d2 < w->impostorStart.x) ? 0 : (d2 < w->impostorStart.y) ? 1 : 2;
+}
+
+static void countInstances(void *user, int begin, int end)
+{
+	ModelJobs *w=(ModelJobs*)user;
+	const unsigned char *v=w->cells ? w->cells->visible : (w->culler ? w->culler->visible : NULL);
+	int i, n=w->n, c=begin / w->grain + 1, visible[3]={0, 0, 0};
+	bool bounds=DEBUG_DRAW_ENABLED;
+	glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+	for (i=begin; i<end; i++) {
+		if (v && !v[i])
+			continue;
+		if (w->impostors || bounds) {
+			int k=w->cells ? w->cells->items[i] : i;
+			glm::vec3 position=w->app->gridPosition(n, k % n, (k / n) % n, k / (n * n));
+			visible[w->impostors ? impostorRun(w, position) : 0]++;
+			if (bounds) {
+				low=glm::min(low, position);
+				high=glm::max(high, position);
+			}
+		} else {
+			visible[0]++;
+		}
+	}
+	/* the box around the visible instances of the chunk */
+	if (bounds && visible[0] + visible[1] + visible[2]) {
+		glm::vec3 r(w->app->cube.radius);
+		DEBUG_DRAW_BOX(low - r, high + r, DEBUG_DRAW_GREEN);
+	}
+	w->offsets[c]=visible[0];
+	w->impostorOffsets[0][c]=visible[1];
+	w->impostorOffsets[1][c]=visible[2];
+}
+
+/* each instance gets its grid offset applied to the rotated cube, and
+ * with an animation the joint it stands for in between; with cells, i
+ * counts the instances in their order. Far from instanceOrigin, the grid
+ * offset is added in double precision, with the AVX paths of glm's dmat4
+ * where the CPU has them, and only the result relative to it is rounded.
+ * Packed instances are packed MODEL_JOB_PACK matrices at a time. */
+#define MODEL_JOB_PACK 64
+
+static void writeInstances(void *user, int begin, int end)
+{
+	ModelJobs *w=(ModelJobs*)user;
+	const Cube *cube=&w->app->cube;
+	const unsigned char *v=w->cells ? w->cells->visible : (w->culler ? w->culler->visible : NULL);
+	const Animator *animator=&w->app->animator;
+	int i, n=w->n, chunk=begin / w->grain, dst=w->offsets[chunk];
+	int joints=animator->count * animator->tracks;
+	glm::mat4 batch[MODEL_JOB_PACK];
+	glm::mat4 *models=w->packed ? batch : w->models + dst;
+	glm::vec3 origin=glm::vec3(w->box);
+	int count=0;
+	for (i=begin; i<end; i++) {
+		if (v && !v[i])
+			continue;
+		int k=w->cells ? w->cells->items[i] : i;
+		glm::vec3 position=w->app->gridPosition(n, k % n, (k / n) % n, k / (n * n));
+		int run=w->impostors ? impostorRun(w, position) : 0;
+		glm::mat4 *m=run ? w->models + w->impostorOffsets[run - 1][chunk]++ : &models[count++];
+		glm::mat4 local=joints ? animator->joints[k % joints] * cube->model : cube->model;
+		if (w->doubles)
+			*m=glm::mat4(glm::translate(glm::dmat4(1.0), glm::dvec3(position) + w->shift) * glm::dmat4(local));
+		else
+			*m=glm::translate(position) * local;
+		if (w->packed && count == MODEL_JOB_PACK) {
+			glm::packInstances(batch, w->packed + dst, count, origin, w->box.w);
+			dst+=count;
+			count=0;
+		}
+	}
+	if (w->packed && count)
+		glm::packInstances(batch, w->packed + dst, count, origin, w->box.w);
+}
+
+/* a line between the centers of two instances which overlap, see
+ * Broadphase.h */
+static void drawOverlap(void *user, int a, int b)
+{
+	const FrustumCuller *c=(const FrustumCuller*)user;
+	(void)c;
+	DEBUG_DRAW_LINE(glm::vec3(c->x[a], c->y[a], c->z[a]), glm::vec3(c->x[b], c->y[b], c->z[b]), DEBUG_DRAW_RED);
+}
+
+/* the world matrices of the scene objects which changed, see
+ * Scene::animate, a chunk of entities at a time */
+static void writeSceneModels(void *user, const EcsView *v)
+{
+	ModelJobs *w=(ModelJobs*)user;
+	Scene *scene=&w->app->scene;
+	const SceneTransform *t=v->array<SceneTransform>(scene->transformComponent);
+	const SceneDrawable *d=v->array<SceneDrawable>(scene->drawableComponent);
+	const SceneBounds *b=v->array<SceneBounds>(scene->boundsComponent);
+	CommandList *list=w->commands ? w->commands->list() : NULL;
+	int i;
+	for (i=0; i<v->count; i++) {
+		scene->writeModel((GLsizei)d[i].draw, t[i].node);
+		if (list)
+			scene->recordObject(list, (GLsizei)d[i].draw, renderSortKey(0, (GLuint)d[i].mesh, 0,
+				glm::length(glm::vec3(b[i].sphere) - w->camera) / w->far));
+	}
+}
+
+/* The simulation step: the cube rotates at a quarter turn per second,
+ * around the same axis as ever. */
+static void simulateCube(void *, SimState *s, double dt)
+{
+	s->rotation = s->rotation * glm::angleAxis((float)(glm::half_pi<double>() * dt),
+		glm::normalize(glm::vec3(0.8f, 0.6f, 0.1f)));
+}
+
+/* The update stage: advance the simulation by dt seconds, the time since
+ * the last frame, in fixed steps, see Simulation.h. */
+static void updateFunc(BaseApplication *app, double dt)
+{
+	/* a stopped animation keeps the state, the frames stay the same */
+	app->simulation.advance(app->idle.animate ? dt : 0.0, simulateCube, NULL);
+}
+
+/* Fill the CPU side of the frame packet p: the time of the frame and the
+ * simulation. This runs on the main thread, also with a render thread. */
+static void prepareFrame(BaseApplication *app, FramePacket *p)
+{
+	PROFILE_ZONE("prepare");
+	/* update the current time and time delta to last frame */
+	double now=profileSeconds();
+	app->timeDelta = now - app->timeCur;
+	app->timeCur = now;
+	p->time = now;
+	p->timeDelta = app->timeDelta;
+
+	/* advance the simulation, the cube is rendered between its last two
+	 * steps; a replay advances it by the recorded time instead */
+	updateFunc(app, app->replay.endFrame(app->timeDelta));
+	p->state = app->simulation.interpolate();
+	p->model = glm::mat4_cast(p->state.rotation);
+}
+
+/* Find the scene object under x, y, from -1 to 1 on screen, and report it
+ * with the time it took. */
+static void pickObject(BaseApplication *app, const glm::mat4 &viewProjection, float x, float y)
+{
+	glm::mat4 inverse = glm::inverse(viewProjection);
+	glm::vec4 nearPoint = inverse * glm::vec4(x, y, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverse * glm::vec4(x, y, 1.0f, 1.0f);
+	glm::vec3 orig = glm::vec3(nearPoint) / nearPoint.w;
+	glm::vec3 dir = glm::normalize(glm::vec3(farPoint) / farPoint.w - orig);
+	float dist = 0.0f;
+
+	double start = profileSeconds();
+	int object = app->scene.pick(orig, dir, &dist);
+	double elapsed = profileSeconds() - start;
+	if (object >= 0)
+		info("picked object %d at distance %.2f in %.1f us", object, dist, elapsed * 1.0e6);
+	else
+		info("picked nothing in %.1f us", elapsed * 1.0e6);
+}
+
+/* Report the objects the reads of the ID buffer found, which were clicked
+ * a frame or more ago, with the frames and the CPU time it took. The ids
+ * of objects removed meanwhile are no longer alive. */
+static void pickedObjects(BaseApplication *app)
+{
+	PickingResult result;
+	while (app->picking.collect(&result)) {
+		const SceneDrawable *d = (result.id != ECS_NO_ENTITY) ?
+			app->scene.entities.get<SceneDrawable>(result.id, app->scene.drawableComponent) : NULL;
+		if (d)
+			info("picked object %u (entity 0x%08x) after %d frames in %.1f us", d->draw, result.id,
+				result.frames, result.cpuMs * 1.0e3);
+		else
+			info("picked nothing after %d frames in %.1f us", result.frames, result.cpuMs * 1.0e3);
+	}
+}
+
+/* The main drawing function. This is responsible for drawing the next frame
+ * of packet p, it is called in a loop as long as the application runs */
+#ifndef NDEBUG
+/* the shapes of --debug-draw the drawing thread adds, relative to origin
+ * like the grid: the lights, scaled by lightScale like the clusters see
+ * them, and the frusta of the cascades of the shadows */
+static void debugShapes(BaseApplication *app, const glm::dvec3 &origin, float lightScale, unsigned int cascades)
+{
+	const GpuLight *lights = app->lights.lights;
+	int i;
+	for (i = 0; app->lights.program && i < app->lights.count; i++) {
+		DEBUG_DRAW_SPHERE(lightScale * glm::vec3(lights[i].position), lightScale * lights[i].position.w,
+			debugDrawColor(lights[i].color));
+		DEBUG_DRAW_POINT(lightScale * glm::vec3(lights[i].position), DEBUG_DRAW_WHITE);
+	}
+	glm::mat4 toGrid = glm::translate(glm::vec3(-origin));
+	for (i = 0; i < (int)cascades; i++)
+		DEBUG_DRAW_FRUSTUM(toGrid * glm::inverse(app->shadows.viewProjection[i]), DEBUG_DRAW_YELLOW);
+}
+#endif
+
 static void
-displayFunc(BaseApplication *app)
+displayFunc(BaseApplication *app, const FramePacket *p)
 {
-	/* set up projection and view matrices
-	 * (we do this every frame although we do not strictly have to do it,
-	 * as those matrixes do never change in our small example) */
-	app->projection=glm::perspective( glm::half_pi<float>(), (float)app->width/(float)app->height, 0.1f, 10.0f);
-	app->view=glm::translate(glm::vec3(0.0f, 0.0f, -4.0f));
+	PROFILE_ZONE("display");
+	/* in instanced and scene mode, the objects are placed on a grid */
+	const float spacing = app->gridSpacing;
+	float extent = 0.0f;
+	if (app->instanced)
+		extent = spacing * (float)app->instanceGrid;
+	else if (app->sceneMode)
+		extent = app->scene.extent;
+	else if (app->voxelMode)
+		extent = (float)(VOXEL_CHUNK_SIZE * app->voxelGrid);
+
+	/* set up projection and view matrices, which the camera only
+	 * recomputes when the window size or the grid changed */
+	float far = 10.0f + 2.0f * extent;
+	Camera *camera = &app->camera;
+	camera->setViewport(app->width, app->height);
+	/* the instance grid may be far from the origin of the world, the
+	 * camera goes along */
+	glm::dvec3 origin = app->gridOrigin();
+	if (app->cameraPlaced) {
+		/* placed by the batch mode, far enough to see the whole grid */
+		far += glm::length(app->cameraEye);
+		camera->setPosition(origin + glm::dvec3(app->cameraEye));
+		camera->lookAt(origin + glm::dvec3(app->cameraTarget));
+	} else if (app->voxelMode) {
+		/* looking down onto the terrain */
+		camera->setPosition(glm::dvec3(0.0, 0.4 * extent, 0.6 * extent));
+		camera->lookAt(glm::dvec3(0.0));
+	} else {
+		camera->setPosition(origin + glm::dvec3(0.0, 0.0, 4.0 + extent));
+		camera->setDirection(glm::vec3(0.0f, 0.0f, -1.0f));
+	}
+	camera->setDepthRange(0.1f, far);
+	camera->update();
+
+	app->cube.model = p->model;
+
+	/* do not run further ahead of the GPU than the frames in flight allow,
+	 * this also makes the ring buffer regions of that frame free again */
+	frameThrottle()->beginFrame();
+	/* the objects deleted in the frames the GPU is done with go now,
+	 * those deleted in this one wait for it in turn */
+	frameThrottle()->poll();
+	glState()->releaseDeletes(frameThrottle()->completed);
+	glState()->deferDeletes(frameThrottle()->frame);
+	/* and the arenas of two frames ago may be reused */
+	frameArenas()->beginFrame();
+	/* any thread may add quads to the sprite batch from now on */
+	spriteBatch()->begin();
 
-	/* rotate the cube */
-	app->cube.model = glm::rotate(app->cube.model, (float)(glm::half_pi<double>() * app->timeDelta), glm::vec3(0.8f, 0.6f, 0.1f));
 	/* combine model and view matrices to the modelView matrix our
-	 * shader expects */
-	glm::mat4 modelView = app->view * app->cube.model;
+	 * shader expects. In instanced and scene mode, the per-instance
+	 * matrices already contain the model transform, relative to
+	 * instanceOrigin for the instances, and the voxels are where they
+	 * are. */
+	bool world = app->instanced || app->sceneMode || app->voxelMode;
+	glm::mat4 modelView = !world ? camera->view * app->cube.model :
+		app->instanced ? camera->relativeView(app->instanceOrigin()) : camera->view;
 
-	/* set the viewport (might have changed since last iteration) */
-	glViewport(0, 0, app->width, app->height);
+	/* select the framebuffer to draw into and set the viewport (might
+	 * have changed since last iteration, the dynamic resolution changes
+	 * its size) */
+	app->beginRender();
+	glState()->viewport(0, 0, app->renderWidth, app->renderHeight);
+
+	/* the shading rates of this frame follow the detail of the last one,
+	 * which is still in the target */
+	if (app->raster & RASTER_COARSE)
+		app->shadingRate.update(app->offscreen.color, app->renderWidth, app->renderHeight);
 
 	/* real drawing starts here drawing */
+	app->gpuProfiler.begin(GPU_SCOPE_CLEAR);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); /* clear the buffers */
+	bool pickIds = app->sceneMode && app->picking.enabled &&
+		app->picking.attach(app->renderFramebuffer(), app->offscreen.width, app->offscreen.height);
+	app->gpuProfiler.end(GPU_SCOPE_CLEAR);
+
+	/* the bounds for culling, the wobble shader moves the vertices up to
+	 * 25% outwards */
+	const glm::mat4 &viewProjection = camera->viewProjection;
+	unsigned int defines = (app->currentProgram >= 0) ?
+		app->programs.entries[app->currentProgram].defines[app->drawVariant()] : 0;
+	float radiusScale = (defines & SHADER_FEATURE_WOBBLE) ? 1.25f : 1.0f;
+	glm::vec3 cameraPosition = camera->position;
+
+	/* the levels of detail are picked by the size of their error on
+	 * screen, for the cube right here from its distance */
+	float lodScale = (app->lodError > 0.0f) ? meshLodScale(camera->projection, app->height, app->lodError) : 0.0f;
+	app->cube.lod = world ? 0 :
+		meshLodSelect(app->cube.lods, app->cube.lodCount, glm::length(modelView[3]) - app->cube.radius, lodScale);
+
+	/* in scene mode, find the visible objects on the GPU, and the visible
+	 * meshlets of a loaded mesh, which are all in the full level. The
+	 * normal cones only hold as long as back faces are culled and the
+	 * vertices stay where they are. */
+	app->gpuProfiler.begin(GPU_SCOPE_CULL);
+	app->meshlets.culled = false;
+	if (app->sceneMode && app->picking.enabled)
+		pickedObjects(app);
+	if (app->sceneMode && p->pick && !pickIds)
+		pickObject(app, viewProjection, p->pickX, p->pickY);
+	if (app->sceneMode) {
+		app->scene.radiusScale = radiusScale;
+		app->scene.lodScale = lodScale;
+		app->scene.cull(viewProjection, cameraPosition);
+	} else if (!world && app->meshlets.program && app->culling && app->cube.lod == 0) {
+		app->meshlets.cull(viewProjection * app->cube.model, glm::vec3(glm::inverse(modelView)[3]), radiusScale,
+			(app->raster & RASTER_CULL) && radiusScale == 1.0f);
+	}
+	/* and the lights of each cluster of the view, the lights are spread
+	 * over the grid or around the cube */
+	float lightScale = glm::max(0.5f * extent, 3.0f);
+	GLuint lightCount = app->lights.update(camera->relativeView(origin) * glm::scale(glm::vec3(lightScale)), lightScale,
+		camera->projection, 0.1f, far, app->renderWidth, app->renderHeight, camera->version);
+	/* and the wobble of the cube's vertices, which every pass reads */
+	if ((defines & SHADER_FEATURE_WOBBLE) && !app->sceneMode && !app->voxelMode && !app->pulling())
+		app->displacement.update((GLfloat)p->state.time);
+	/* and the particles, a fountain over the cube, sorted for the view */
+	if (app->particles.program)
+		app->particles.update(p->state.time, glm::vec3(origin), lightScale, cameraPosition, far, &app->primitives);
+	/* and the cascades of the sun, the casters reach as far as the grid */
+	unsigned int shadowCascades = app->shadowProgram ?
+		app->shadows.update(camera->view, camera->projection, 0.1f, far, extent + 2.0f) : 0;
+	app->gpuProfiler.end(GPU_SCOPE_CULL);
+
+	app->gpuProfiler.begin(GPU_SCOPE_DRAW);
+
+	/* update the per-frame uniforms, this is a single write into the
+	 * uniform buffer which all of the programs read from */
+	FrameUniforms frame;
+	frame.projection = camera->projection;
+	frame.modelView = modelView;
+	frame.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+	frame.time = (GLfloat)p->state.time;
+	frame.frameIndex = app->frameIndex;
+	frame.lightCount = lightCount;
+	frame.cutRadius = app->cutRadius;
+	frame.viewProjection = viewProjection;
+	frame.viewProjectionInverse = camera->viewProjectionInverse;
+	frame.instanceBox = app->instanceBox();
+	frame.instanceEye = glm::vec4(glm::vec3(camera->eye - app->instanceOrigin()), 1.0f);
+	app->shadows.uniforms(camera->view, app->shadowProgram != 0, &frame.shadows);
+	/* with TAA, the frame is shifted by a subpixel offset, the culling
+	 * and the shadows do without it */
+	if (app->taa.enabled) {
+		glm::mat4 jitter = app->taa.jitterMatrix();
+		frame.projection = jitter * frame.projection;
+		frame.viewProjection = jitter * frame.viewProjection;
+		frame.viewProjectionInverse = glm::inverse(frame.viewProjection);
+	}
+	frame.modelViewProjection = frame.projection * frame.modelView;
+	app->updateFrameUniforms(&frame);
+	/* the values which stay the same are baked into the program in the
+	 * background, the draws below get it once it is built */
+	app->specializeUniforms(&frame);
+
+	/* record the draws of this frame, with the state they need */
+	RenderQueue *queue = &app->queue;
+	queue->begin();
+	bool sdfMode = app->currentProgram >= 0 && app->currentProgram == app->sdfProgram;
+	if (sdfMode) {
+		/* the raymarching program draws its own scene in every mode, with
+		 * one triangle covering the screen, unless the compute raymarcher
+		 * does it after the queue */
+		if (!app->sdfCompute.enabled)
+			queue->push(renderSortKey(app->program, 0, app->sdf.vao, 0.0f), app->program, 0,
+				app->sdf.vao, drawSdf, &app->sdf, 0, app->raster);
+	} else if (app->instanced && app->skinning.vao) {
+		PROFILE_ZONE("skinning");
+		/* the characters are sampled, then those whose pose changed are
+		 * skinned, once for all passes which draw them */
+		double start = profileSeconds();
+		app->animator.update(p->state.time, &app->jobs);
+		app->animationTime = 1000.0 * (profileSeconds() - start);
+		app->skinning.update(&app->jobs);
+		queue->push(renderSortKey(app->program, 0, app->skinning.vao, 0.0f), app->program, 0,
+			app->skinning.vao, drawSkinned, &app->skinning, app->prepassProgram, app->raster, app->shadowProgram);
+	} else if (app->spinning()) {
+		/* the instances spin by themselves in the vertex shader, from
+		 * the spins uploaded once and the time of the frame: nothing is
+		 * culled or written, every one of them is drawn */
+		GLuint program = app->program;
+		queue->push(renderSortKey(program, 0, app->cube.pullVao, 0.0f), program, 0, app->cube.pullVao,
+			drawCubeSpinning, &app->cube, app->prepassProgram, app->raster, app->shadowProgram);
+	} else if (app->instanced) {
+		PROFILE_ZONE("instances");
+		/* the instances are culled on the CPU, and the matrices of those
+		 * which survive are written straight into the mapped ring buffer
+		 * and all of them are drawn with a single call. Each chunk is
+		 * counted as soon as it is culled, while the buffer is mapped. */
+		int n = app->instanceGrid, count = n * n * n, c;
+		FrustumCuller *culler = &app->instanceCuller;
+		bool cull = app->cpuCulling;
+		SpatialGrid *cells = (cull && app->gridCulling && app->instanceCells.items) ? &app->instanceCells : NULL;
+		ModelJobs w;
+		JobCounter culled, counted, written;
+		culled.reset();
+		counted.reset();
+		written.reset();
+		w.app = app;
+		w.culler = cull ? culler : NULL;
+		w.cells = cells;
+		w.n = n;
+		/* the culling and the grid positions are relative to the
+		 * grid's origin, the matrices to instanceOrigin */
+		glm::mat4 gridViewProjection = camera->projection * camera->relativeView(origin);
+		w.shift = origin - app->instanceOrigin();
+		w.doubles = w.shift != glm::dvec3(0.0);
+		/* the distant ones are billboards past the levels of detail */
+		w.impostors = impostorCubes(app, defines);
+		w.camera = glm::vec3(camera->eye - origin);
+		if (w.impostors) {
+			app->impostors.distances(meshLodScale(camera->projection, app->height, 1.0f));
+			w.impostorStart = glm::vec2(app->impostors.fadeStart * app->impostors.fadeStart,
+				app->impostors.fadeEnd * app->impostors.fadeEnd);
+		}
+		w.grain = (count + MODEL_JOB_CHUNKS - 1) / MODEL_JOB_CHUNKS;
+		if (w.grain < MODEL_JOB_GRAIN)
+			w.grain = MODEL_JOB_GRAIN;
+		int chunks = (count + w.grain - 1) / w.grain;
+		if (cells) {
+			/* sorted from scratch as if the instances moved, like
+			 * particles would */
+			cells->build(culler->x, culler->y, culler->z, culler->radius, count, app->gridCellSize(), &app->jobs);
+			cells->cull(gridViewProjection, radiusScale, &app->jobs, &culled);
+			app->jobs.parallelFor(countInstances, &w, count, w.grain, &counted, &culled);
+		} else if (cull) {
+			/* the instances stay where they are, so what is visible
+			 * only changes with the camera */
+			if (culler->version != camera->version || culler->radiusScale != radiusScale) {
+				culler->radiusScale = radiusScale;
+				culler->cull(gridViewProjection, &app->jobs, &culled);
+				culler->version = camera->version;
+			}
+			app->jobs.parallelFor(countInstances, &w, count, w.grain, &counted, &culled);
+		} else if (w.impostors) {
+			app->jobs.parallelFor(countInstances, &w, count, w.grain, &counted);
+		}
+		/* the overlaps as if the instances moved, while they are culled */
+		if (app->broadphase && app->instanceBroadphase.order) {
+			PROFILE_ZONE("broadphase");
+			app->instanceBroadphase.update(&app->jobs);
+			if (DEBUG_DRAW_ENABLED)
+				app->instanceBroadphase.forEach(drawOverlap, culler);
+		}
+		/* the characters are sampled meanwhile, the thread helps the
+		 * jobs until all of them are */
+		if (app->animator.count) {
+			double start = profileSeconds();
+			app->animator.update(p->state.time, &app->jobs);
+			app->animationTime = 1000.0 * (profileSeconds() - start);
+		}
+		bool compact = app->compacting();
+		w.models = NULL;
+		w.packed = NULL;
+		w.box = app->instanceBox();
+		if (compact)
+			w.packed = app->cube.mapCompactInstances(count);
+		else
+			w.models = app->cube.mapInstances(count);
+		app->jobs.wait(&counted);
+		bool counts = cull || w.impostors;
+		w.offsets[0] = 0;
+		for (c = 0; c < chunks; c++)
+			w.offsets[c + 1] = counts ? w.offsets[c] + w.offsets[c + 1] : (c + 1) * w.grain;
+		int meshes = counts ? w.offsets[chunks] : count, fading = 0, billboards = 0;
+		if (w.impostors) {
+			/* the crossfade follows the meshes, the billboards it */
+			w.impostorOffsets[0][0] = w.impostorOffsets[1][0] = 0;
+			for (c = 0; c < chunks; c++) {
+				w.impostorOffsets[0][c + 1] += w.impostorOffsets[0][c];
+				w.impostorOffsets[1][c + 1] += w.impostorOffsets[1][c];
+			}
+			fading = w.impostorOffsets[0][chunks];
+			billboards = w.impostorOffsets[1][chunks];
+			for (c = 0; c < chunks; c++) {
+				w.impostorOffsets[0][c] += meshes;
+				w.impostorOffsets[1][c] += meshes + fading;
+			}
+		}
+		if (w.models || w.packed) {
+			app->jobs.parallelFor(writeInstances, &w, count, w.grain, &written);
+			app->jobs.wait(&written);
+			/* only the visible instances are drawn, the cube draws the
+			 * meshes */
+			app->cube.instanceCount = meshes;
+			app->cube.unmapInstances();
+			if (w.impostors)
+				app->impostors.setInstances(fading, billboards);
+		}
+		GLuint program = app->program, prepass = app->prepassProgram, shadow = app->shadowProgram;
+		unsigned int tess = TESS_INSTANCED | (app->pulling() ? TESS_PULLED : compact ? TESS_COMPACT : 0u);
+		bool patches = tessellateCube(app, defines, tess, &program, &prepass, &shadow);
+		bool displaced = !patches && !app->pulling() &&
+			displaceCube(app, defines, DISPLACE_INSTANCED | (compact ? DISPLACE_COMPACT : 0u), &program, &prepass, &shadow);
+		if (app->pulling())
+			queue->push(renderSortKey(program, 0, app->cube.pullVao, 0.0f), program, 0, app->cube.pullVao,
+				patches ? drawCubePulledPatches : drawCubePulled, &app->cube, prepass, app->raster, shadow);
+		else if (displaced)
+			queue->push(renderSortKey(program, 0, compact ? app->cube.compactVao : app->cube.vao, 0.0f), program, 0,
+				compact ? app->cube.compactVao : app->cube.vao,
+				compact ? drawCubeCompactDisplaced : drawCubeInstancedDisplaced, &app->displacement, prepass,
+				app->raster, shadow);
+		else if (compact)
+			queue->push(renderSortKey(program, 0, app->cube.compactVao, 0.0f), program, 0, app->cube.compactVao,
+				patches ? drawCubeCompactPatches : drawCubeCompact, &app->cube, prepass, app->raster, shadow);
+		else
+			queue->push(renderSortKey(program, 0, app->cube.vao, 0.0f), program, 0, app->cube.vao,
+				patches ? drawCubeInstancedPatches : drawCubeInstanced, &app->cube, prepass, app->raster, shadow);
+		if (w.impostors && w.models) {
+			/* the crossfade casts the shadows of the meshes, the
+			 * billboards none */
+			Impostors *im = &app->impostors;
+			GLuint fade = im->fadeProgram(0);
+			GLuint fadePrepass = prepass ? im->fadeProgram(IMPOSTOR_FADE_DEPTH_ONLY) : 0;
+			if (fade && (!prepass || fadePrepass))
+				queue->push(renderSortKey(fade, 0, im->fadeVao, 0.0f), fade, 0, im->fadeVao, drawImpostorsFading,
+					im, fadePrepass, app->raster, shadow);
+			queue->push(renderSortKey(im->program, im->atlas, im->vao, 0.0f), im->program, im->atlas, im->vao,
+				drawImpostors, im, 0, app->raster & ~RASTER_CULL);
+		}
+	} else if (app->sceneMode) {
+		PROFILE_ZONE("scene");
+		/* every object spins like the cube, around its own position;
+		 * all of them are submitted at once, or without multi-draw, from
+		 * the command lists the same jobs record, or one by one under
+		 * their occlusion queries */
+		Scene *scene = &app->scene;
+		bool record = !scene->culled && !scene->queries.enabled && (!scene->multiDraw || app->commandLists);
+		ModelJobs w;
+		w.app = app;
+		w.commands = record ? &app->commands : NULL;
+		w.camera = cameraPosition;
+		w.far = far;
+		app->commands.begin();
+		scene->animate(p->state.rotation, &app->jobs);
+		/* the compute pass of the GPU transforms wrote the matrices */
+		if (record || !scene->gpuTransforms)
+			scene->entities.forEach(scene->objectMask, writeSceneModels, &w, &app->jobs);
+		scene->flushModels();
+		/* with the ID buffer, the objects are picked from the pixels
+		 * around the cursor after this frame, when the program writes
+		 * their ids, otherwise right away */
+		GLuint program = app->program;
+		bool picked = !scene->queries.enabled && !record && pickIds && pickScene(app, defines, &program);
+		if (p->pick && picked)
+			app->picking.request(p->pickX, p->pickY);
+		else if (p->pick && pickIds)
+			pickObject(app, viewProjection, p->pickX, p->pickY);
+		if (scene->queries.enabled)
+			queue->push(renderSortKey(app->program, 0, scene->vao, 0.0f), app->program, 0,
+				scene->vao, drawSceneQueried, app, app->prepassProgram, app->raster, app->shadowProgram);
+		else if (record)
+			queue->push(renderSortKey(app->program, 0, scene->vao, 0.0f), app->program, 0,
+				scene->vao, drawSceneCommands, app, app->prepassProgram, app->raster, app->shadowProgram);
+		else if (picked)
+			queue->push(renderSortKey(program, 0, scene->vao, 0.0f), program, 0,
+				scene->vao, drawScenePicked, app, app->prepassProgram, app->raster, app->shadowProgram);
+		else if (scene->batchCount && !scene->culled) {
+			/* the shader mix of a generated scene, the pre-pass only
+			 * fits the selected program */
+			GLuint programs[SCENE_MAX_BATCHES];
+			unsigned int rasters[SCENE_MAX_BATCHES];
+			int b;
+			sceneBatchPrograms(app, programs, rasters);
+			for (b = 0; b < scene->batchCount; b++)
+				queue->push(renderSortKey(programs[b], 0, scene->vao, 0.0f), programs[b], 0, scene->vao,
+					drawSceneBatch, &scene->batches[b], b ? 0 : app->prepassProgram, rasters[b], app->shadowProgram);
+		} else
+			queue->push(renderSortKey(app->program, 0, scene->vao, 0.0f), app->program, 0,
+				scene->vao, drawScene, scene, app->prepassProgram, app->raster, app->shadowProgram);
+	} else if (app->voxelMode) {
+		PROFILE_ZONE("voxels");
+		VoxelWorld *voxels = &app->voxels;
+		if (app->voxelRaymarch) {
+			/* the voxels are raymarched, from the octree of their last
+			 * change; the chunks stay dirty until they are meshed */
+			if (app->voxelOctree.version != voxels->version)
+				app->voxelOctree.build(voxels, &app->jobs);
+			GLuint program = app->programs.get(app->voxelProgram, PROGRAM_VARIANT_BASIC);
+			if (program && app->voxelOctree.buffer)
+				queue->push(renderSortKey(program, 0, app->sdf.vao, 0.0f), program, 0, app->sdf.vao,
+					drawVoxelOctree, &app->voxelOctree, 0, app->programRaster(app->voxelProgram));
+		} else {
+			/* the dirty chunks are meshed on the jobs and uploaded by
+			 * the streamer, meanwhile they draw their old meshes. The
+			 * VAO comes with the first mesh, the pipeline states follow
+			 * it. */
+			voxels->update(&app->jobs, &app->streamer);
+			app->updatePipelineStates();
+			voxels->cull(camera->planes);
+			if (voxels->vao && voxels->visibleCount)
+				queue->push(renderSortKey(app->program, 0, voxels->vao, 0.0f), app->program, 0,
+					voxels->vao, drawVoxels, voxels, app->prepassProgram, app->raster, app->shadowProgram);
+		}
+	} else {
+		/* the cube, sorted by its distance relative to the far plane */
+		float depth = -(modelView[3].z) / far;
+		GLuint program = app->program, prepass = app->prepassProgram, shadow = app->shadowProgram;
+		if (app->meshlets.culled)
+			queue->push(renderSortKey(app->program, 0, app->cube.vao, depth), app->program, 0,
+				app->cube.vao, drawMeshlets, &app->meshlets, app->prepassProgram, app->raster, app->shadowProgram);
+		else if (tessellateCube(app, defines, 0, &program, &prepass, &shadow))
+			queue->push(renderSortKey(program, 0, app->cube.vao, depth), program, 0,
+				app->cube.vao, drawCubePatches, &app->cube, prepass, app->raster, shadow);
+		else if (displaceCube(app, defines, 0, &program, &prepass, &shadow))
+			queue->push(renderSortKey(program, 0, app->cube.vao, depth), program, 0,
+				app->cube.vao, drawCubeDisplaced, &app->displacement, prepass, app->raster, shadow);
+		else
+			queue->push(renderSortKey(app->program, 0, app->cube.vao, depth), app->program, 0,
+				app->cube.vao, drawCube, &app->cube, app->prepassProgram, app->raster, app->shadowProgram);
+	}
+
+	/* the shadow maps which are due are drawn from the same packets,
+	 * before the main pass samples them */
+	if (shadowCascades)
+		drawShadows(app, &frame, modelView, shadowCascades);
+
+	/* all objects of the scene are drawn with their own material, lit by
+	 * the lights, whose binding the culling passes used meanwhile, and
+	 * the sun */
+	app->materials.bind();
+	if (app->lights.updated)
+		app->lights.bind();
+	if (app->shadowProgram)
+		app->shadows.bind();
+	if (sdfMode) {
+		/* rebake what changed in the scene, a few bricks at a time, and
+		 * rebuild the hierarchy of the moving field */
+		app->sdfBaker.update(&app->sdf);
+		app->sdfField.update();
+		app->sdfField.bind(&app->sdf);
+		app->sdf.bind();
+		app->sdfBaker.bind();
+		/* find how far the rays of each tile can skip */
+		app->sdfCone.march(app->renderWidth, app->renderHeight);
+		app->sdfCone.bind();
+	}
+	if (app->currentProgram == app->virtualProgram)
+		app->virtualTexture.bind();
+
+	/* with checkerboard rendering, the raymarching program only marches
+	 * half of the pixels into a target of its own, the resolve fills in
+	 * the others from the previous frame */
+	bool temporal = sdfMode && !app->sdfCompute.enabled &&
+		app->sdfTemporal.begin(&app->sdf, app->renderWidth, app->renderHeight);
+
+	/* sort and draw. We do not "unbind" the VAO and the program
+	 * afterwards: OpenGL is a state machine, and the next frame binds
+	 * what it needs anyway. Only debug builds unbind, so that code
+	 * relying on leftover bindings shows up. */
+	{
+		PROFILE_ZONE("submit");
+		queue->submit();
+	}
+	if (pickIds)
+		app->picking.read(app->renderWidth, app->renderHeight);
+	if (temporal)
+		app->sdfTemporal.resolve(app->renderFramebuffer(), app->previousProjection * app->previousView,
+			app->sdf.vao);
+	/* the compute raymarcher fills the same march target, which is
+	 * resolved as above, or just copied with every pixel marched */
+	if (sdfMode && app->sdfCompute.enabled) {
+		if (app->sdfCompute.march(&app->sdfTemporal, &app->sdf, app->renderWidth, app->renderHeight)) {
+			glState()->raster(RASTER_DEFAULT);
+			if (app->sdfTemporal.enabled)
+				app->sdfTemporal.resolve(app->renderFramebuffer(),
+					app->previousProjection * app->previousView, app->sdf.vao);
+			else
+				app->sdfTemporal.present(app->renderFramebuffer(), &app->sdfTemporal.march, app->sdf.vao);
+		} else {
+			app->setSdfCompute(false);
+		}
+	}
 
-	/* use the program and update the uniforms */
-	glUseProgram(app->program);
-	glUniformMatrix4fv(app->locProjection, 1, GL_FALSE, glm::value_ptr(app->projection));
-	glUniformMatrix4fv(app->locModelView, 1, GL_FALSE, glm::value_ptr(modelView));
-	glUniform1f(app->locTime, app->timeCur);
+	/* the particles blend over everything */
+	app->particles.draw();
 
-	/* draw the cube */
-	glBindVertexArray(app->cube.vao);
-	glDrawElements(GL_TRIANGLES, 6 * 6, GL_UNSIGNED_SHORT, BUFFER_OFFSET(0));
+	/* and the shapes of the debug drawing over them, which the jobs
+	 * added as well */
+#ifndef NDEBUG
+	if (DEBUG_DRAW_ENABLED) {
+		glm::mat4 debugViewProjection = camera->projection * camera->relativeView(origin);
+		if (app->taa.enabled)
+			debugViewProjection = app->taa.jitterMatrix() * debugViewProjection;
+		debugShapes(app, origin, lightScale, shadowCascades);
+		debugDraw()->flush(debugViewProjection);
+	}
+#endif
+
+	/* the cubes move by themselves, TAA needs to know how far */
+	if (app->taa.enabled)
+		drawMotion(app, modelView, defines);
+
+	/* the uniform buffer region may be reused once this frame is done */
+	app->frameUBO.endFrame();
+	app->virtualTexture.endFrame();
 
-	/* "unbind" the VAO and the program. We do not have to do this.
-	 * OpenGL is a state machine. The last binings will stay effective
-	 * until we actively change them by binding something else. */
-	glBindVertexArray(0);
-	glUseProgram(0);
+	app->gpuProfiler.end(GPU_SCOPE_DRAW);
+
+	/* the depth of this frame is what the next frame culls against */
+	app->gpuProfiler.begin(GPU_SCOPE_HIZ);
+	if (app->sceneMode)
+		app->scene.queryOcclusion(viewProjection);
+	if (app->sceneMode && app->renderOffscreen)
+		app->scene.updateOcclusion(&app->offscreen, viewProjection);
+	app->gpuProfiler.end(GPU_SCOPE_HIZ);
 
 	/* finished with drawing, swap FRONT and BACK buffers to show what we
-	 * have rendered */
-	glfwSwapBuffers(app->win);
+	 * have rendered. The swap scope includes the present blit when we
+	 * render offscreen; without a present there is nothing to swap. The
+	 * overlay goes on top of what is shown, in a scope of its own, so
+	 * that its cost can be told apart from that of the frame. */
+	app->gpuProfiler.begin(GPU_SCOPE_SWAP);
+	bool present=app->endRender();
+	app->gpuProfiler.end(GPU_SCOPE_SWAP);
+	/* screenshots and recordings, without the overlay */
+	app->captureFrame(present);
+	if (present && app->overlay.enabled) {
+		app->gpuProfiler.begin(GPU_SCOPE_OVERLAY);
+		app->overlay.draw(&app->frameStats, app->width, app->height);
+		app->gpuProfiler.end(GPU_SCOPE_OVERLAY);
+	} else {
+		/* the quads of the others, on top of the frame as well */
+		spriteBatch()->flush(present ? app->width : 0, app->height);
+	}
+	if (present) {
+		PROFILE_ZONE("swap");
+		glfwSwapBuffers(app->win);
+	}
+	/* and the columns of the frame in the other windows */
+	if (app->renderOffscreen)
+		app->viewports.present(app->offscreen.color, app->offscreen.width, app->offscreen.height);
+	frameThrottle()->endFrame();
+	frameArenas()->endFrame();
+	glTrace()->frame();
+	startupTimeline()->firstFrame();
+
+	/* the next frame reprojects this one */
+	app->previousProjection = camera->projection;
+	app->previousView = camera->view;
+	app->previousRotation = camera->rotation;
+	app->previousEye = camera->eye;
+	app->previousModel = app->cube.model;
+	app->frameIndex++;
 
 	/* In DEBUG builds, we also check for GL errors in the display
 	 * function, to make sure no GL error goes unnoticed. */
@@ -131,72 +1479,1919 @@ displayFunc(BaseApplication *app)
  * MAIN LOOP                                                                *
  ****************************************************************************/
 
+/* the frame counters of the main loop */
+typedef struct {
+	BaseApplication *app;
+	unsigned int frame, framesTotal;	/* since the last report, and before */
+	double startTime, lastTime;	/* of the loop, and of the last report */
+	TelemetrySample telemetryStart, telemetryLast;	/* of the loop, and of the last report */
+} FrameLoop;
+
+/* The GL side of a frame: the statistics, the per-frame updates and the
+ * drawing of packet p. With a render thread, this runs there. */
+static void renderFrame(void *user, const FramePacket *p)
+{
+	FrameLoop *loop=(FrameLoop*)user;
+	BaseApplication *app=loop->app;
+	int i;
+	PROFILE_ZONE("frame");
+
+	/* the framebuffer size and the keys pressed on the main thread */
+	app->width=p->width;
+	app->height=p->height;
+	for (i=0; i<p->eventCount; i++)
+		handleKey(app, p->events[i].key);
+
+	/* update the frame time statistics at most once every second */
+	double elapsed = p->time - loop->lastTime;
+	if (elapsed >= 1.0) {
+		app->avg_frametime=1000.0 * elapsed/(double)loop->frame;
+		app->avg_fps=(double)loop->frame/elapsed;
+		loop->lastTime=p->time;
+		/* GL calls per frame which the state cache issued and elided */
+		unsigned int frames=loop->frame;
+		glState()->report(frames);
+		loop->framesTotal += loop->frame;
+		loop->frame=0;
+		/* GPU times of the frames finished in the meantime */
+		app->gpuProfiler.report();
+		app->avg_gputime=app->gpuProfiler.avgFrame;
+		app->updateFrameStats();
+		/* and the driver performance warnings, see GLDebug.h */
+		glDebugPerformanceReport();
+		/* the clocks, power and energy of those frames */
+		TelemetrySample telemetry;
+		if (app->telemetry.latest(&telemetry)) {
+			TelemetryDelta d;
+			char text[256];
+			telemetryDelta(&loop->telemetryLast, &telemetry, &d);
+			telemetryFormat(&d, frames, text, sizeof(text));
+			info("telemetry:%s", text);
+			loop->telemetryLast=telemetry;
+		}
+		if (app->sceneMode)
+			info("scene: %u bytes of model matrices uploaded in %d copies", (unsigned)app->scene.models.uploaded,
+				app->scene.models.copies);
+		if (app->animator.count)
+			info("animation: %d characters sampled in %.3f ms, %d skinned in the last frame", app->animator.count,
+				app->animationTime, app->skinning.skinned);
+		/* the overlay shows the statistics on top of the frame, or
+		 * update window title, only the main thread may do that */
+		if (app->overlay.enabled) {
+			OverlayStats stats;
+			stats.frames=frames;
+			stats.fps=app->avg_fps;
+			stats.cpuMs=app->frameStats.cpuStats.count ? app->frameStats.cpuStats.mean : app->avg_frametime;
+			stats.gpuMs=app->avg_gputime;
+			stats.overlayGpuMs=app->gpuProfiler.avg[GPU_SCOPE_OVERLAY];
+			stats.pool=&app->meshPool;
+			app->overlay.update(&stats);
+		} else {
+			char WinTitle[160];
+			int len=mysnprintf(WinTitle, sizeof(WinTitle), APP_TITLE "   /// %.1ffps p50: %4.2fms p99: %4.2fms max: %4.2fms GPU: %4.2fms",
+				app->avg_fps, app->frameStats.cpuStats.p50, app->frameStats.cpuStats.p99,
+				app->frameStats.cpuStats.max, app->avg_gputime);
+			if (glDebug()->performanceTotal && len > 0 && len < (int)sizeof(WinTitle))
+				mysnprintf(WinTitle + len, sizeof(WinTitle) - len, " perf warnings: %u", glDebug()->performanceTotal);
+			if (app->renderThread.running)
+				app->renderThread.setTitle(WinTitle);
+			else if (app->win)
+				glfwSetWindowTitle(app->win, WinTitle);
+		}
+	}
+
+	/* start a new frame of GPU timer queries, this also collects
+	 * the results of earlier frames which are already available */
+	double gpu_time=app->gpuProfiler.beginFrame();
+	if (loop->framesTotal + loop->frame > 0) {
+		app->recordFrame(1000.0 * p->timeDelta, gpu_time);
+		/* a trace of the last seconds if the frame was slow */
+		app->flight.frame(1000.0 * p->timeDelta, gpu_time, &app->frameStats);
+	}
+	/* and scale the resolution toward the frame time we aim for */
+	app->updateResolution(gpu_time);
+
+	/* advance background program builds and switch to a newly
+	 * selected program once it is ready */
+	app->updateProgram();
+	/* swap in meshes which finished streaming in, compact their memory */
+	app->updateStreaming();
+	app->updateMemory();
+	/* what is still building or streaming in lands in a later frame */
+	if (app->programs.busy() || app->streamer.pending)
+		app->idle.invalidate(1);
+
+	displayFunc(app, p);
+	loop->frame++;
+}
+
 /* The main loop of the application. This will call the display function
  *  until the application is closed. This function also keeps timing
- *  statistics. */
-static void mainLoop(BaseApplication *app)
+ *  statistics. With framePackets of 2 or 3, the frames are drawn by a
+ *  render thread, see RenderThread.h, 0 draws them right here. */
+static void mainLoop(BaseApplication *app, int framePackets)
 {
-	unsigned int frame=0,frames_total=0;
-	double start_time=glfwGetTime();
-	double last_time=start_time;
+	FrameLoop loop;
+	FramePacket packet;
+	RenderThread *rt=&app->renderThread;
+
+	loop.app=app;
+	loop.frame=loop.framesTotal=0;
+	loop.startTime=loop.lastTime=profileSeconds();
+	app->telemetry.latest(&loop.telemetryStart);
+	loop.telemetryLast=loop.telemetryStart;
 
 	info("entering main loop");
-	while (!glfwWindowShouldClose(app->win)) {
-		/* update the current time and time delta to last frame */
-		double now=glfwGetTime();
-		app->timeDelta = now - app->timeCur;
-		app->timeCur = now;
-
-		/* update FPS estimate at most once every second */
-		double elapsed = app->timeCur - last_time;
-		if (elapsed >= 1.0) {
-			char WinTitle[80];
-			app->avg_frametime=1000.0 * elapsed/(double)frame;
-			app->avg_fps=(double)frame/elapsed;
-			last_time=app->timeCur;
-			frames_total += frame;
-			frame=0;
-			/* update window title */
-			mysnprintf(WinTitle, sizeof(WinTitle), APP_TITLE "   /// AVG: %4.2fms/frame (%.1ffps)", app->avg_frametime, app->avg_fps);
-			glfwSetWindowTitle(app->win, WinTitle);
-			info("frame time: %4.2fms/frame (%.1ffps)",app->avg_frametime, app->avg_fps);
-		}
-
-		/* call the display function */
-		displayFunc(app);
-		frame++;
+	PROFILE_THREAD("main");
+	if (framePackets > 0)
+		rt->start(app->win, framePackets, renderFrame, &loop);
+	while (!(app->win && glfwWindowShouldClose(app->win)) && !app->viewports.shouldClose() && !app->replay.done() &&
+		!app->stream.quit && !startupTimeline()->exit()) {
+		/* in the idle mode, sleep until there is something new to draw;
+		 * the time asleep does not count as a frame time */
+		if (!app->idle.needsFrame()) {
+			app->idle.wait();
+			rt->updateTitle();
+			app->timeCur=profileSeconds();
+			continue;
+		}
+		app->idle.frameDrawn();
+		if (rt->running) {
+			/* this waits while the render thread is behind */
+			FramePacket *p=rt->acquire();
+			consumeInput(app, p);
+			prepareFrame(app, p);
+			rt->submit();
+			rt->updateTitle();
+		} else {
+			/* in the low-latency mode, the input is sampled right before
+			 * the frame, as late as it can start */
+			if (app->pacer.enabled) {
+				app->pacer.wait();
+				pollEvents(app);
+			}
+			consumeInput(app, &packet);
+			prepareFrame(app, &packet);
+			renderFrame(&loop, &packet);
+			if (app->pacer.enabled) {
+				app->pacer.endFrame();
+				continue;
+			}
+		}
 
 		/* This is needed for GLFW event handling. This function
 		 * will call the registered callback functions to forward
 		 * the events to us. */
-		glfwPollEvents();
+		pollEvents(app);
 	}
-	frames_total += frame;
+	/* the frames still in the ring are drawn first */
+	rt->stop();
+	loop.framesTotal += loop.frame;
 	info("left main loop\n%u frames rendered in %.1fs seconds == %.1ffps",
-		frames_total, (app->timeCur-start_time),
-		(double)frames_total/(app->timeCur-start_time) );
+		loop.framesTotal, (app->timeCur-loop.startTime),
+		(double)loop.framesTotal/(app->timeCur-loop.startTime) );
+	/* the energy of the whole run, the idle mode saves some */
+	TelemetrySample telemetry;
+	if (app->telemetry.latest(&telemetry)) {
+		TelemetryDelta d;
+		char text[256];
+		telemetryDelta(&loop.telemetryStart, &telemetry, &d);
+		telemetryFormat(&d, loop.framesTotal, text, sizeof(text));
+		info("telemetry of the main loop:%s, %.1f J in all", text, d.joules);
+	}
+}
+
+/****************************************************************************
+ * BENCHMARK MODE                                                           *
+ ****************************************************************************/
+
+/* Collect the GPU times of the frames still in flight, or throw them away
+ * if bench is NULL. */
+static void benchDrainGPU(BaseApplication *app, Benchmark *bench)
+{
+	int i;
+	glFinish();
+	for (i = 0; i < GPU_PROFILER_FRAMES; i++) {
+		double gpu_time=app->gpuProfiler.beginFrame();
+		if (bench)
+			bench->addGPU(gpu_time);
+	}
+}
+
+/* Render bench->warmup + bench->frames frames with every program of the
+ * keyboard table and record the time of each measured frame.
+ * Returns false if the window was closed before we were done. */
+static bool benchLoop(BaseApplication *app, Benchmark *bench)
+{
+	int i,f;
+	int variant=app->drawVariant();
+	FramePacket packet;
+
+	for (i=0; i<10; i++) {
+		const ShaderCombination *c=&shaderTable[i];
+		int index=app->keyPrograms[i];
+		BenchResult *r=bench->begin(i, c->vs, c->fs, c->defines);
+		if (!r)
+			break;
+		app->programs.finish(index);
+		if (!app->programs.get(index, variant)) {
+			warn("benchmark: skipping program %d, it failed to build", i);
+			continue;
+		}
+		if (index != app->currentProgram)
+			app->selectProgram(index);
+		r->raster=app->raster;
+		info("benchmark: program %d, %d frames", i, bench->frames);
+
+		/* do not attribute the previous program's frames to this one */
+		benchDrainGPU(app, NULL);
+		double last_time=profileSeconds();
+		TelemetrySample telemetry;
+		bool measured=false;
+		for (f=0; f<bench->warmup + bench->frames; f++) {
+			double gpu_time=app->gpuProfiler.beginFrame();
+			if (f == bench->warmup)
+				measured=app->telemetry.latest(&telemetry);
+			if (f >= bench->warmup)
+				bench->addGPU(gpu_time);
+			/* the mode keys are ignored while measuring, a resize is not */
+			consumeInput(app, &packet);
+			app->width=packet.width;
+			app->height=packet.height;
+			prepareFrame(app, &packet);
+			displayFunc(app, &packet);
+			pollEvents(app);
+			if (app->win && glfwWindowShouldClose(app->win)) {
+				warn("benchmark: window closed, aborting");
+				return false;
+			}
+
+			/* wall time of the whole frame, including the swap */
+			double now=profileSeconds();
+			if (f >= bench->warmup)
+				bench->addCPU(1000.0 * (now - last_time));
+			last_time=now;
+		}
+		benchDrainGPU(app, bench);
+		bench->end(r);
+		info("benchmark: program %d: p50 %.3fms, p99 %.3fms, max %.3fms, GPU p50 %.3fms",
+			i, r->cpu.p50, r->cpu.p99, r->cpu.max, r->gpu.p50);
+		/* the samples of the measured frames, give or take a period */
+		TelemetrySample end;
+		if (measured && app->telemetry.latest(&end)) {
+			char text[256];
+			telemetryDelta(&telemetry, &end, &r->telemetry);
+			telemetryFormat(&r->telemetry, r->cpu.count, text, sizeof(text));
+			info("benchmark: program %d:%s", i, text);
+		}
+	}
+	return true;
+}
+
+/* Render bench->frames.warmup + bench->frames.frames frames with every
+ * program of the keyboard table at every size and overdraw of FillBench.h
+ * and fit its fill rate. The camera is close to the cube, so it covers
+ * most of the target; the scene and the grids are seen as usual.
+ * Returns false if the window was closed before we were done. */
+static bool fillBenchLoop(BaseApplication *app, FillBench *bench)
+{
+	int i,s,o,f;
+	int variant=app->drawVariant();
+	FramePacket packet;
+
+	packet.eventCount=0;
+	packet.pick=false;
+	/* the sizes are those of the sweep, the cube holds still */
+	if (app->resolution.enabled)
+		app->setDynamicResolution(false);
+	app->setAnimate(false);
+	app->cameraPlaced=!app->instanced && !app->sceneMode && !app->voxelMode;
+	app->cameraEye=glm::vec3(0.0f, 0.0f, 2.5f);
+	app->cameraTarget=glm::vec3(0.0f);
+	for (i=0; i<10; i++) {
+		const ShaderCombination *c=&shaderTable[i];
+		int index=app->keyPrograms[i];
+		FillResult *r=bench->begin(i, c->vs, c->fs, c->defines);
+		if (!r)
+			break;
+		app->programs.finish(index);
+		if (!app->programs.get(index, variant)) {
+			warn("fill benchmark: skipping program %d, it failed to build", i);
+			continue;
+		}
+		if (index != app->currentProgram)
+			app->selectProgram(index);
+		info("fill benchmark: program %d, %d points of %d frames", i, FILL_BENCH_POINTS, bench->frames.frames);
+		for (s=0; s<FILL_BENCH_SCALES; s++) {
+			packet.width=(int)(fillBenchScales[s] * (double)bench->width + 0.5);
+			packet.height=(int)(fillBenchScales[s] * (double)bench->height + 0.5);
+			app->width=packet.width;
+			app->height=packet.height;
+			for (o=0; o<FILL_BENCH_OVERDRAWS; o++) {
+				app->queue.overdraw=fillBenchOverdraws[o];
+				benchDrainGPU(app, NULL);
+				bench->beginPoint();
+				for (f=0; f<bench->frames.warmup + bench->frames.frames; f++) {
+					double gpu_time=app->gpuProfiler.beginFrame();
+					if (f >= bench->frames.warmup)
+						bench->frames.addGPU(gpu_time);
+					prepareFrame(app, &packet);
+					displayFunc(app, &packet);
+					pollEvents(app);
+					if (app->win && glfwWindowShouldClose(app->win)) {
+						warn("fill benchmark: window closed, aborting");
+						app->queue.overdraw=1;
+						return false;
+					}
+				}
+				benchDrainGPU(app, &bench->frames);
+				/* what was drawn, a TAA upscale draws less */
+				bench->endPoint(r, app->renderWidth, app->renderHeight, fillBenchOverdraws[o]);
+			}
+		}
+		bench->end(r);
+		info("fill benchmark: program %d: %.3fms + %.3fns per pixel (r2 %.3f), %.2f of the sides in %.1fms",
+			i, r->fixedMs, r->nsPerPixel, r->r2, r->budgetScale, DYNRES_TARGET_MS);
+	}
+	app->queue.overdraw=1;
+	app->cameraPlaced=false;
+	app->width=bench->width;
+	app->height=bench->height;
+	return true;
+}
+
+/****************************************************************************
+ * BATCH MODE                                                               *
+ ****************************************************************************/
+
+/* Render job i of batch in the hidden window, as fast as the GPU and the
+ * encoder of the capture allow, see Batch.h. The frames of a PNG output are
+ * taken as named screenshots, so the encoder still writes the last frames
+ * of a job while the next one renders; a video or raw output is a
+ * recording of its own. A render node of the farm renders only count
+ * frames from first, and names every frame "job frame" for the sink of
+ * the capture whatever the output is, see RenderFarm.h.
+ * Returns false if the job failed. */
+static bool batchJob(BaseApplication *app, const BatchFile *batch, int i, int first=0, int count=-1,
+	bool farm=false)
+{
+	const BatchJob *job=&batch->jobs[i];
+	int index=app->keyPrograms[job->program];
+	char name[CAPTURE_PATH_MAX];
+	FramePacket packet;
+	bool ok=true;
+	int f;
+	double job_time=profileSeconds();
+
+	/* the mode first, it selects the variant of the program */
+	if (job->mode == BATCH_INSTANCED)
+		ok=app->instanced || app->setInstanced(true);
+	else if (job->mode == BATCH_SCENE)
+		ok=app->sceneMode || app->setSceneMode(true);
+	else if (app->instanced)
+		ok=app->setInstanced(false);
+	else if (app->sceneMode)
+		ok=app->setSceneMode(false);
+	else if (app->voxelMode)
+		ok=app->setVoxelMode(false);
+	if (!ok)
+		return false;
+	if (index >= 0)
+		app->programs.finish(index);
+	if (index < 0 || !app->programs.get(index, app->drawVariant())) {
+		warn("batch: job %d (line %d): program %d is not available", i, job->line, job->program);
+		return false;
+	}
+	if (index != app->currentProgram)
+		app->selectProgram(index);
+	app->width=job->width;
+	app->height=job->height;
+	bool stills=farm || job->frameFile(0, name, sizeof(name));
+	if (!stills && !app->capture.start(job->output, job->fps))
+		return false;
+	if (count < 0)
+		count=job->frames - first;
+
+	packet.eventCount=0;
+	packet.pick=false;
+	packet.width=job->width;
+	packet.height=job->height;
+	for (f=first; f<first + count; f++) {
+		app->cameraPlaced=job->camera(f, &app->cameraEye, &app->cameraTarget);
+		if (farm)
+			mysnprintf(name, sizeof(name), "%d %d", i, f);
+		else if (stills)
+			job->frameFile(f, name, sizeof(name));
+		if (stills)
+			app->capture.screenshot(name);
+		app->gpuProfiler.beginFrame();
+		prepareFrame(app, &packet);
+		displayFunc(app, &packet);
+		pollEvents(app);
+	}
+	if (!stills)
+		app->capture.stop();
+	info("batch: job %d (line %d): %d frames of %dx%d into '%s' in %.3fs", i, job->line, count,
+		job->width, job->height, job->output, profileSeconds() - job_time);
+	return true;
+}
+
+/* Render the jobs of batch one after the other, see batchJob().
+ * Returns false if a job failed. */
+static bool batchLoop(BaseApplication *app, const BatchFile *batch)
+{
+	int i;
+	int frames=0;
+	bool ok=true;
+
+	/* every frame is written, and the frames only depend on the jobs */
+	app->capture.lossless=true;
+	app->setAnimate(false);
+	double start_time=profileSeconds();
+	for (i=0; i<batch->count && ok; i++) {
+		ok=batchJob(app, batch, i);
+		if (ok)
+			frames+=batch->jobs[i].frames;
+	}
+	/* wait for the last frames to be written */
+	app->capture.flush();
+	app->cameraPlaced=false;
+	double total=profileSeconds() - start_time;
+	info("batch: %d jobs, %d frames in %.3fs, %.1f frames per second", i, frames, total,
+		total > 0.0 ? (double)frames / total : 0.0);
+	return ok;
+}
+
+/* A worker of --batch-workers: render the jobs of batch whose indices the
+ * coordinator writes to stdin, one per line, and answer each with the
+ * index and 1 or 0 for success on the pipe results, see BatchWorkers.h.
+ * Returns false if a job failed. */
+static bool batchWorkerLoop(BaseApplication *app, const BatchFile *batch, FILE *results)
+{
+	char line[64];
+	int frames=0, jobs=0;
+	bool ok=true;
+
+	app->capture.lossless=true;
+	app->setAnimate(false);
+	double start_time=profileSeconds();
+	while (fgets(line, sizeof(line), stdin)) {
+		int i;
+		if (sscanf(line, "%d", &i) != 1 || i < 0 || i >= batch->count) {
+			warn("batch worker: no job '%s'", line);
+			ok=false;
+			break;
+		}
+		bool done=batchJob(app, batch, i);
+		if (done) {
+			frames+=batch->jobs[i].frames;
+			jobs++;
+		}
+		ok=ok && done;
+		fprintf(results, "%d %d\n", i, done ? 1 : 0);
+		fflush(results);
+	}
+	app->capture.flush();
+	app->cameraPlaced=false;
+	double total=profileSeconds() - start_time;
+	info("batch worker: %d jobs, %d frames in %.3fs, %.1f frames per second", jobs, frames, total,
+		total > 0.0 ? (double)frames / total : 0.0);
+	return ok;
+}
+
+/* A render node of the farm: build every program, then render the shards
+ * the coordinator sends on farm until it closes the connection. The frames
+ * go back through the sink of the capture, see RenderFarm.h.
+ * Returns false if a shard failed or the connection broke. */
+static bool farmNodeLoop(BaseApplication *app, FarmConnection *farm)
+{
+	BatchFile batch;
+	char type[4];
+	unsigned char *payload=NULL;
+	size_t capacity=0, length=0;
+	int i, shards=0;
+	bool ok=true;
+
+	/* no shard waits for the compiler, and the program binary cache of
+	 * this machine is warm for the next run */
+	double start_time=profileSeconds();
+	for (i=0; i<app->programs.count; i++)
+		app->programs.finish(i);
+	info("farm: %d programs built in %.3fs", app->programs.count, profileSeconds() - start_time);
+
+	/* the coordinator sends the jobs as soon as we connect */
+	batch.clear();
+	if (!farm->receive(type, &payload, &capacity, &length) || memcmp(type, "JOBS", 4) || !length ||
+		length % sizeof(BatchJob)) {
+		warn("farm: the coordinator sent no jobs");
+		free(payload);
+		return false;
+	}
+	batch.jobs=(BatchJob*)payload;
+	batch.count=(int)(length / sizeof(BatchJob));
+	payload=NULL;
+	capacity=0;
+
+	app->capture.lossless=true;
+	app->capture.sink=FarmConnection::sink;
+	app->capture.sinkUser=farm;
+	app->setAnimate(false);
+	const char *renderer=glCaps()->renderer ? glCaps()->renderer : "unknown";
+	ok=farm->send("HELO", renderer, strlen(renderer));
+	start_time=profileSeconds();
+	while (ok && !farm->failed && farm->receive(type, &payload, &capacity, &length)) {
+		if (memcmp(type, "SHRD", 4) || length != 12) {
+			warn("farm: unexpected '%.4s' message", type);
+			ok=false;
+			break;
+		}
+		int job=(int)farmGet32(payload), first=(int)farmGet32(payload + 4), count=(int)farmGet32(payload + 8);
+		if (job < 0 || job >= batch.count || first < 0 || count < 1 || first + count > batch.jobs[job].frames) {
+			warn("farm: no frames %d to %d of job %d", first, first + count - 1, job);
+			ok=false;
+			break;
+		}
+		if (!batchJob(app, &batch, job, first, count, true))
+			ok=farm->send("FAIL", payload, length);
+		shards++;
+	}
+	/* the last frames are still being sent */
+	app->capture.flush();
+	app->capture.sink=NULL;
+	app->cameraPlaced=false;
+	double total=profileSeconds() - start_time;
+	info("farm: %d shards, %u frames in %.3fs, %.1f frames per second, %.1f MB sent (%.1f%% of the pixels)",
+		shards, farm->frames, total, total > 0.0 ? (double)farm->frames / total : 0.0, (double)farm->sent / 1048576.0,
+		farm->raw ? 100.0 * (double)farm->sent / (double)farm->raw : 0.0);
+	free(payload);
+	batch.destroy();
+	return ok && !farm->failed;
 }
 
 /****************************************************************************
  * PROGRAM ENTRY POINT                                                      *
  ****************************************************************************/
 
+/* the command line options */
+typedef struct {
+	int benchFrames;		/* > 0 enables the benchmark mode */
+	int benchWarmup;
+	int benchPrimitives;		/* > 0 benchmarks GpuPrimitives.h on that many items */
+	int benchSubmit;		/* > 0 benchmarks the draw submission up to that many cubes */
+	int benchVertex;		/* > 0 benchmarks the vertex layouts on that many vertices */
+	int benchFill;			/* > 0 benchmarks the fill rate with that many frames per point */
+	const char *benchOut;		/* NULL or "-" writes to stdout */
+	int benchFormat;
+	const char *batch;		/* render the jobs in this file, or NULL */
+	int batchWorkers;		/* worker processes for the jobs, 0 for one per GPU, -1 for none */
+	int batchWorker;		/* the pipe of the answers of a worker, or -1 */
+	bool listDevices;		/* list the EGL devices and exit */
+	int farmListen;			/* coordinate the render nodes on this port, 0 for none */
+	const char *farmNode;		/* render for the coordinator at host:port, or NULL */
+	int farmShard;			/* frames per shard of the farm */
+	bool instanced;
+	bool vertexPulling;		/* draw the instanced cubes without vertex attributes */
+	bool compactInstances;		/* pack the instanced cubes into 12 bytes each */
+	bool gpuAnimation;		/* spin the instanced cubes in the vertex shader */
+	bool scene;			/* start in scene mode */
+	int sceneGrid;			/* objects per side of the scene grid */
+	SceneGenParams sceneGen;	/* a generated scene instead if it has objects */
+	const char *snapshot;		/* resume the scene from and save it to this file, or NULL */
+	int voxels;			/* chunks per side of the voxel terrain, 0 for none */
+	bool voxelRaymarch;		/* raymarch the voxels instead of meshing them */
+	bool cull;			/* cull the scene on the GPU */
+	bool hiz;			/* also cull occluded objects */
+	bool gridCulling;		/* cull the grids by the cells of a spatial hash */
+	bool broadphase;		/* find the instances which overlap */
+	bool gpuTransforms;		/* the world matrices of the scene on the GPU */
+	bool offscreen;			/* render into an FBO and blit it to the window */
+	bool separable;			/* use separable programs and pipelines */
+	bool spirv;			/* load precompiled SPIR-V modules */
+	bool prepass;			/* draw with a depth pre-pass */
+	bool faceCulling;		/* cull back faces where the program allows it */
+	bool packedVertices;		/* store the meshes in VERTEX_FORMAT_PACKED */
+	const char *mesh;		/* mesh file to draw instead of the cube, or NULL */
+	const char *saveMesh;		/* write the cube to this mesh file and exit, or NULL */
+	const char *optimizeIn, *optimizeOut;	/* the mesh files of --optimize-mesh, or NULL */
+	float lodError;			/* in pixels, 0 always draws the full meshes */
+	const char *textures;		/* texture file with the material textures, or NULL */
+	const char *buildTextureIn, *buildTextureOut;	/* the files of --build-texture, or NULL */
+	GLenum textureFormat;		/* what --build-texture encodes images to */
+	int textureLayers;		/* layers stacked in the image of --build-texture */
+	bool supercompress;		/* --build-texture compresses the levels with Lz.h */
+	const char *archive;		/* asset archive to load the files from first, or NULL */
+	const char *buildArchive;	/* the archive --build-archive writes, or NULL */
+	char **archiveFiles;		/* and the files it packs */
+	int archiveFileCount;
+	const char *sdfScene;		/* text file with the scene of the raymarching program, or NULL */
+	int sdfTile;			/* pixels per side of the tiles of the cone pre-pass, 0 for none */
+	int sdfConeSteps, sdfSteps;	/* step limits of a cone and of a pixel */
+	bool sdfTemporal;		/* checkerboard rendering with temporal reprojection */
+	bool sdfCompute;		/* raymarch with the compute shader */
+	int sdfField;			/* moving primitives next to the SDF scene */
+	int particles;			/* particles of the fountain on the GPU */
+	int lights;			/* point lights of the material shaders */
+	bool shadows;			/* a sun with cascaded shadow maps */
+	int animation;			/* characters animating the instanced grid */
+	bool skinning;			/* draw them as skinned meshes */
+	const char *trace;		/* write the profiler zones here at exit, or NULL */
+	double flightBudget;		/* ms of the flight recorder, 0 for spikes only, -1 if off */
+	double flightSpike;		/* times the p99 which is a spike, 0 for none */
+	const char *flightOut;		/* prefix of the traces of the flight recorder, or NULL */
+	const char *perfCounters;	/* the hardware counters to sample, or NULL */
+	const char *glTrace;		/* record the GL calls into this file, or NULL */
+	const char *glTraceReport;	/* report on this GL trace and exit, or NULL */
+	bool startupBench;		/* exit after the first frame and print the startup phases */
+	const char *startupOut;		/* write the startup phases here as JSON, "-" for stdout, or NULL */
+	bool overlay;			/* the statistics on top of the frames */
+	bool telemetry;			/* sample the clocks, power and temperatures */
+	bool debugDraw;			/* the shapes of DebugDraw.h over the frames */
+	bool picking;			/* pick from the ids of the main pass, see Picking.h */
+	const char *capture;		/* record the frames into this file, or NULL */
+	const char *shareFrames;	/* the socket of the frame sharing, or NULL */
+	int streamPort;			/* UDP port of the stream server, 0 for none */
+	const char *programCache;	/* URL of the shared program binary cache, or NULL */
+	int captureFps;			/* of the video */
+	int captureEncoder;		/* CAPTURE_ENCODER_* of the video */
+	bool shadingRate;		/* variable-rate shading */
+	bool post;			/* tonemap and FXAA */
+	bool bloom;			/* ... and bloom */
+	bool autoExposure;		/* ... and adapt the exposure */
+	int msaa;			/* samples per pixel offscreen */
+	double taaScale;		/* temporal anti-aliasing at this render scale, 0 for none */
+	int fogFactor;			/* height fog at 1 / this of the frame size, 0 for none */
+	double tessEdge;		/* tessellate the wobble into segments of these pixels, 0 for none */
+	bool displace;			/* wobble the vertices once per frame in a compute pass */
+	double impostorPixels;		/* instances narrower than this are billboards, 0 for none */
+	double worldOrigin[3];		/* of the instance grid */
+	bool cameraRelative;		/* the instance matrices are relative to the camera */
+	bool oitList;			/* per-pixel lists for the translucent shader */
+	double simHz;			/* simulation steps per second */
+	int renderThread;		/* frame packets of the render thread, 0 for none */
+	bool commandLists;		/* draw the scene from command lists recorded in parallel */
+	bool lowLatency;		/* start the frames as late as possible */
+	bool tearControl;		/* adaptive vsync */
+	bool hugePages;			/* the big arrays in 2 MiB pages */
+	bool pinThreads;		/* the threads on cores of their own */
+	bool perLevelMips;		/* no single-pass mip generation */
+	int specialize;			/* frames until a value is baked into the program, 0 for never */
+	double cutRadius;		/* of the sphere the CUT programs cut out of the cube */
+	int framesInFlight;		/* the CPU may be ahead of the GPU, 0 for no limit */
+	bool idle;			/* draw only when something changes */
+	bool paused;			/* start with the animation stopped */
+	const char *record;		/* record the input into this file, or NULL */
+	const char *replay;		/* play the recording in this file, or NULL */
+	double replayStep;		/* seconds per replayed frame, 0 for the recorded ones */
+	int viewports;			/* more windows showing columns of the frame */
+	bool viewportVsync;		/* the viewport windows wait for the VBLANK too */
+	double dynamicResolution;	/* GPU time per frame to scale the resolution for, 0 for none */
+	double minRenderScale;		/* the least the dynamic resolution may scale to */
+	unsigned int windowFlags;	/* APP_WINDOW_* */
+} Options;
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [--bench N] [--bench-out FILE] [--bench-format json|csv]\n"
+		"          [--bench-warmup N] [--bench-primitives N] [--bench-submit N] [--bench-vertex N]\n"
+		"          [--bench-fill N] [--instanced] [--vertex-pulling] [--gpu-animation]\n"
+		"          [--scene] [--scene-grid N] [--scene-gen SPEC] [--snapshot FILE] [--voxels N]\n"
+		"          [--voxel-raymarch] [--no-cull] [--hiz] [--compact-instances]\n"
+		"          [--grid-culling] [--gpu-transforms] [--offscreen] [--hidden] [--egl]\n"
+		"          [--separable] [--spirv] [--prepass] [--no-face-culling] [--packed-vertices]\n"
+		"          [--mesh FILE] [--save-mesh FILE] [--optimize-mesh IN OUT]\n"
+		"          [--lod-error PIXELS] [--textures FILE] [--build-texture IN OUT]\n"
+		"          [--texture-format BC1|BC3|BC4|BC5] [--texture-layers N] [--supercompress]\n"
+		"          [--archive FILE] [--build-archive OUT FILE...] [--direct-io]\n"
+		"          [--sdf-scene FILE] [--sdf-tile N] [--sdf-cone-steps N] [--sdf-steps N]\n"
+		"          [--no-sdf-temporal] [--sdf-compute] [--sdf-field N] [--particles N]\n"
+		"          [--dynamic-resolution MS] [--min-render-scale S] [--vrs] [--post]\n"
+		"          [--bloom] [--auto-exposure] [--msaa N] [--taa] [--taa-upscale S]\n"
+		"          [--fog] [--fog-factor 2|4] [--tessellate] [--tessellate-edge PIXELS]\n"
+		"          [--displace-compute] [--impostors] [--impostor-pixels PIXELS]\n"
+		"          [--world-origin X,Y,Z] [--camera-relative] [--broadphase]\n"
+		"          [--window-samples N] [--oit-list] [--sim-hz HZ]\n"
+		"          [--render-thread N] [--lights N] [--command-lists] [--low-latency]\n"
+		"          [--tear-control] [--shadows] [--huge-pages] [--pin-threads]\n"
+		"          [--per-level-mips] [--specialize FRAMES] [--cut-radius R]\n"
+		"          [--animation N] [--skinning] [--trace FILE] [--gl-debug] [--perf-break]\n"
+		"          [--flight-recorder MS] [--flight-spike X] [--flight-out PREFIX]\n"
+		"          [--perf-counters LIST] [--gl-trace FILE] [--gl-trace-report FILE]\n"
+		"          [--overlay] [--telemetry] [--capture FILE] [--capture-fps N]\n"
+		"          [--capture-encoder NAME]\n"
+		"          [--share-frames PATH] [--stream-server PORT] [--debug-draw] [--picking]\n"
+		"          [--frames-in-flight N] [--idle] [--paused] [--viewports N]\n"
+		"          [--viewport-vsync] [--batch FILE] [--record FILE] [--replay FILE]\n"
+		"          [--replay-step MS] [--startup-bench] [--startup-out FILE]\n"
+		"          [--gl-version X.Y] [--gl-info N] [--gl-info-out FILE]\n"
+		"          [--headless] [--egl-device N] [--list-devices] [--batch-workers N]\n"
+		"          [--farm-listen PORT] [--farm-shard N] [--farm-node HOST:PORT]\n"
+		"          [--program-cache URL]\n"
+		"  --bench N          render N frames with every shader of the keyboard table,\n"
+		"                     with vsync off, write the frame time statistics and exit\n"
+		"  --bench-out FILE   where to write the statistics (default: bench.json, - for stdout)\n"
+		"  --bench-format F   json or csv (default: derived from the file name)\n"
+		"  --bench-warmup N   frames per shader which are not measured (default: 30)\n"
+		"  --bench-primitives N  time the GPU scan, compaction, reduction and sorts of\n"
+		"                     GpuPrimitives.h on N items, check them, print the times and exit\n"
+		"  --bench-submit N   draw 1, 10, 100, ... up to N cubes one by one, instanced, by\n"
+		"                     multi-draw with and without GPU culling and pulled, print the\n"
+		"                     CPU and GPU times and the GL calls as CSV and exit, see SubmitBench.h\n"
+		"  --bench-vertex N   draw a grid of N vertices in each vertex layout, print the GPU\n"
+		"                     times, the bandwidth and the --perf-counters as CSV and exit,\n"
+		"                     see VertexBench.h\n"
+		"  --bench-fill N     render N frames with every shader of the keyboard table at\n"
+		"                     each of 4 sizes and 4 overdraws offscreen, fit the fixed GPU\n"
+		"                     time and that per pixel, write them to --bench-out and exit,\n"
+		"                     see FillBench.h\n"
+		"  --batch FILE       render the jobs of the text file FILE into image and video\n"
+		"                     files with a hidden window and exit, see Batch.h\n"
+		"  --instanced        start in instanced mode\n"
+		"  --vertex-pulling   draw the instanced cubes without vertex attributes: the\n"
+		"                     vertex shader makes them up and reads the instances from\n"
+		"                     a storage buffer\n"
+		"  --compact-instances  draw the instanced cubes from 12 bytes per instance instead\n"
+		"                     of a matrix: a packed rotation, position and scale\n"
+		"  --gpu-animation    spin each instanced cube around an axis of its own in the\n"
+		"                     vertex shader, with nothing uploaded per frame; implies\n"
+		"                     --vertex-pulling\n"
+		"  --scene            start in scene mode (many meshes in one multi-draw call)\n"
+		"  --scene-grid N     the scene has N^3 objects (default: 16)\n"
+		"  --scene-gen SPEC   start in scene mode, with a scene generated from SPEC instead\n"
+		"                     of the grid, e.g. objects=100000,meshes=1:1:1:1,materials=8,\n"
+		"                     shaders=4:1,overlap=4,animated=0.5,seed=1, see SceneGenerator.h\n"
+		"  --snapshot FILE    start in scene mode, resumed from the scene snapshot FILE if it\n"
+		"                     is one of the same scene, and write it there on exit, see\n"
+		"                     SceneSnapshot.h\n"
+		"  --voxels N         start in voxel mode, a terrain of N x 2 x N chunks of 32^3\n"
+		"                     voxels with greedy meshes, see VoxelWorld.h (key N, and E\n"
+		"                     digs a crater)\n"
+		"  --voxel-raymarch   raymarch the voxels from a sparse octree of bricks instead\n"
+		"                     of meshing them, see VoxelOctree.h (implies voxel mode, key Q)\n"
+		"  --no-cull          do not cull the scene on the GPU\n"
+		"  --hiz              also cull occluded objects in the scene (implies --offscreen),\n"
+		"                     by occlusion queries without compute shaders\n"
+		"  --grid-culling     sort the instances and the scene into the cells of a spatial\n"
+		"                     hash every frame and cull them cell by cell, see SpatialGrid.h\n"
+		"  --broadphase       find the instances whose spheres overlap every frame by a sweep\n"
+		"                     and prune, drawn as lines with --debug-draw, see Broadphase.h\n"
+		"  --gpu-transforms   compute the world matrices of the scene level by level in a\n"
+		"                     compute pass, the CPU only uploads the changed rotations,\n"
+		"                     see GpuSceneGraph.h\n"
+		"  --offscreen        render into an offscreen framebuffer and blit it to the window\n"
+		"  --dynamic-resolution MS  render offscreen at the resolution which takes MS of\n"
+		"                     GPU time per frame and upscale it, see DynamicResolution.h\n"
+		"  --min-render-scale S  never render at less than S times the window size\n"
+		"                     (default: 0.5)\n"
+		"  --vrs              shade the raymarching and pattern shaders at coarse rates\n"
+		"                     where there is little detail, see ShadingRate.h\n"
+		"  --post             tonemap and anti-alias the frames, see PostProcess.h\n"
+		"  --bloom            blend a blur of the bright parts in, from a mip chain\n"
+		"                     (implies --post)\n"
+		"  --auto-exposure    adapt the exposure to a histogram of the luminance\n"
+		"                     (implies --post)\n"
+		"  --msaa N           render offscreen with N samples per pixel, see RenderTarget.h\n"
+		"  --taa              anti-alias by jittering the frames and blending them over\n"
+		"                     time, see TemporalAA.h (key W)\n"
+		"  --taa-upscale S    the same, rendering at S times the window size and\n"
+		"                     reconstructing the full size from the jittered frames\n"
+		"  --fog              raymarch a height fog at half the frame size and blend it\n"
+		"                     in with a depth-aware upsample, see HalfResEffects.h\n"
+		"  --fog-factor 2|4   the same, at 1/2 or 1/4 of the sides of the frames\n"
+		"  --tessellate       tessellate the cubes of the wobble shader by their size on\n"
+		"                     screen, see Tessellation.h (key D)\n"
+		"  --tessellate-edge PIXELS  the same, with edges split into segments of PIXELS\n"
+		"                     (default: 8)\n"
+		"  --displace-compute  wobble the vertices of the cubes once per frame in a compute\n"
+		"                     pass, which all passes read, see Displacement.h\n"
+		"  --impostors        draw the distant instances of the cube shader as billboards\n"
+		"                     of views baked into an atlas, see Impostors.h\n"
+		"  --impostor-pixels PIXELS  the same, for the instances less than PIXELS wide\n"
+		"                     on screen (default: 16)\n"
+		"  --world-origin X,Y,Z  place the instance grid and the camera at X,Y,Z in the\n"
+		"                     world, to see the precision far from the origin\n"
+		"  --camera-relative  compute the instance matrices relative to the camera from\n"
+		"                     world transforms in double precision, see\n"
+		"                     BaseApplication::instanceOrigin\n"
+		"  --window-samples N  ask for a window with N samples per pixel\n"
+		"  --oit-list         draw the translucent shader into per-pixel fragment lists\n"
+		"                     instead of weighted blending, see Transparency.h\n"
+		"  --sim-hz HZ        update the simulation HZ times per second (default: 60),\n"
+		"                     frames interpolate between the steps, see Simulation.h\n"
+		"  --render-thread N  draw on a render thread, N = 2 or 3 frame packets in\n"
+		"                     flight between it and the main thread, see RenderThread.h\n"
+		"  --command-lists    draw the scene object by object from command lists recorded\n"
+		"                     in parallel, also with multi-draw, see CommandList.h\n"
+		"  --low-latency      start each frame as late as it can and still make the next\n"
+		"                     refresh, and sample the input only then, see FramePacer.h\n"
+		"  --tear-control     let frames which miss the refresh tear instead of waiting\n"
+		"                     for the next one (swap interval -1)\n"
+		"  --huge-pages       put the frame arenas, scene graph and culling arrays into\n"
+		"                     2 MiB pages, see LargePages.h\n"
+		"  --pin-threads      pin the drawing thread and the job workers to cores of\n"
+		"                     their own, SMT siblings and other NUMA nodes last, see\n"
+		"                     CpuTopology.h\n"
+		"  --per-level-mips   build the Hi-Z pyramid, bloom chain and texture mipmaps a\n"
+		"                     level at a time instead of in a single compute pass, see\n"
+		"                     MipDownsampler.h\n"
+		"  --specialize FRAMES  build the program in use again in the background with the\n"
+		"                     per-frame values which did not change for FRAMES frames\n"
+		"                     as constants, see UniformSpecializer.h\n"
+		"  --cut-radius R     the radius of the sphere the CUT programs cut out of the\n"
+		"                     cube (default: 1.4)\n"
+		"  --frames-in-flight N  let the CPU run at most N = 1 to 4 frames ahead of the GPU,\n"
+		"                     0 for no limit (default: 2), see FrameThrottle.h\n"
+		"  --idle             draw only while something changes, and sleep until the\n"
+		"                     next event otherwise, see IdleMode.h\n"
+		"  --paused           start with the animation stopped (space toggles it)\n"
+		"  --record FILE      record the input events and time steps of the frames into\n"
+		"                     FILE, to be replayed, see Replay.h\n"
+		"  --replay FILE      play the recording FILE back instead of the live input and\n"
+		"                     exit after its last frame\n"
+		"  --replay-step MS   advance the simulation MS milliseconds per replayed frame\n"
+		"                     instead of the recorded time steps\n"
+		"  --viewports N      open N more windows sharing the GL objects, each showing one\n"
+		"                     of N columns of the frame, see ViewportWindows.h\n"
+		"  --viewport-vsync   synchronize the swaps of the viewport windows as well\n"
+		"  --hidden           do not show the window, render offscreen only\n"
+		"  --egl              create the OpenGL context via EGL\n"
+		"  --headless         no window and no window system, an EGL context on a GPU,\n"
+		"                     for --bench, --batch, --replay or --startup-bench only\n"
+		"  --egl-device N     the GPU of the headless context (default: 0), they are\n"
+		"                     listed in the log\n"
+		"  --list-devices     list the EGL devices with their DRM device files and exit\n"
+		"  --batch-workers N  render the jobs of --batch with N headless worker processes\n"
+		"                     on the EGL devices in turn, 0 for one per device\n"
+		"  --farm-listen PORT  render the jobs of --batch on the render nodes which\n"
+		"                     connect to PORT, see RenderFarm.h\n"
+		"  --farm-shard N     frames per shard the nodes render (default: 16)\n"
+		"  --farm-node H:P    render the shards of the coordinator at host H, port P\n"
+		"  --gl-version X.Y   use no more of OpenGL than version X.Y (3.2 or newer) has,\n"
+		"                     even where the driver has more, see GLCaps.h\n"
+		"  --gl-info N        log the context with its capabilities (0, default), also\n"
+		"                     its limits (1) or also every extension (2)\n"
+		"  --gl-info-out FILE  write the context, capabilities, limits and extensions\n"
+		"                     as JSON to FILE\n"
+		"  --separable        link every shader stage once and combine them in pipelines\n"
+		"  --spirv            use shaders/*.spv SPIR-V modules where they exist\n"
+		"  --prepass          lay down the depth first, then shade each pixel once\n"
+		"  --no-face-culling  rasterize back faces with every program\n"
+		"  --packed-vertices  store positions and texture coordinates as half floats and\n"
+		"                     normals as 10_10_10_2\n"
+		"  --mesh FILE        draw the mesh in the mesh file FILE instead of the cube,\n"
+		"                     the cube is drawn until it has streamed in\n"
+		"  --save-mesh FILE   write the cube in the selected vertex format to the mesh\n"
+		"                     file FILE and exit\n"
+		"  --optimize-mesh IN OUT  reorder the mesh file IN for the vertex cache, overdraw\n"
+		"                     and vertex fetch, split it into meshlets and levels of\n"
+		"                     detail, write it to OUT, report the cache efficiency\n"
+		"                     and exit\n"
+		"  --lod-error PIXELS  draw the coarsest level of detail whose error stays below\n"
+		"                     PIXELS on screen (default: 1, 0 always draws the full meshes)\n"
+		"  --textures FILE    take the material textures from the layers of the\n"
+		"                     compressed texture file FILE\n"
+		"  --build-texture IN OUT  encode the PPM or PAM image IN with all levels, or\n"
+		"                     copy the blocks of the KTX2 file IN, into the texture\n"
+		"                     file OUT and exit\n"
+		"  --texture-format F  BC1, BC3, BC4 or BC5 for images (default: BC1)\n"
+		"  --texture-layers N  the image has N layers stacked from the top (default: 1)\n"
+		"  --supercompress    compress the levels of the texture file on top\n"
+		"  --archive FILE     load the shaders, meshes and textures from the asset\n"
+		"                     archive FILE, the files it does not have from disk\n"
+		"  --build-archive OUT FILE...  pack the files into the asset archive OUT,\n"
+		"                     under the paths they are given by, and exit; must\n"
+		"                     be the last option\n"
+		"  --direct-io        stream the mesh files past the page cache\n"
+		"  --sdf-scene FILE   raymarch the signed distance scene in the text file FILE\n"
+		"                     with the default program, see SdfScene.h\n"
+		"  --sdf-tile N       march a cone per tile of NxN pixels first, 0 for none,\n"
+		"                     see SdfCone.h (default: %d)\n"
+		"  --sdf-cone-steps N  up to N steps per cone (default: %d)\n"
+		"  --sdf-steps N      up to N steps per pixel (default: %d)\n"
+		"  --no-sdf-temporal  march every pixel in every frame, see SdfTemporal.h\n"
+		"  --sdf-compute      raymarch in tiles with a compute shader, see SdfCompute.h\n"
+		"  --sdf-field N      add N moving primitives with a BVH built on the GPU,\n"
+		"                     see SdfField.h\n"
+		"  --particles N      a fountain of N particles emitted, simulated and sorted\n"
+		"                     on the GPU, see Particles.h (key Y, a million)\n"
+		"  --lights N         light the materials with N point lights, each fragment\n"
+		"                     only shading those of its cluster, see ClusteredLights.h\n"
+		"  --shadows          light the materials with a sun casting cascaded shadows,\n"
+		"                     see ShadowMaps.h\n"
+		"  --animation N      animate the instanced grid as N characters sampling\n"
+		"                     compressed clips on the job system, see Animation.h\n"
+		"  --skinning         draw the characters as meshes skinned by a compute pass,\n"
+		"                     see Skinning.h\n"
+		"  --trace FILE       write the CPU and GPU zones of the last frames as a Chrome\n"
+		"                     trace to FILE at exit and on key X (default:\n"
+		"                     hellocube_trace.json), needs make PROFILE=1, see Profiler.h\n"
+		"  --flight-recorder MS  write the zones of the last seconds as a trace whenever\n"
+		"                     a frame takes longer than MS, or is a spike (0: only\n"
+		"                     spikes), at most one every 30 s, needs make PROFILE=1,\n"
+		"                     see FlightRecorder.h\n"
+		"  --flight-spike X   a frame over X times the p99 of the last second is a spike,\n"
+		"                     0 for none (default: 3)\n"
+		"  --flight-out PREFIX  the traces are PREFIX_1.json, ... (default:\n"
+		"                     hellocube_flight)\n"
+		"  --gl-debug         use a debug context which reports errors and driver\n"
+		"                     performance warnings, as debug builds always do, see GLDebug.h\n"
+		"  --perf-break       trap into the debugger on the first driver performance\n"
+		"                     warning of each kind, implies --gl-debug\n"
+		"  --perf-counters L  sample the GPU counters whose names contain one of the\n"
+		"                     comma separated parts in L per profiler scope, or list\n"
+		"                     them all with L = list, see PerfCounters.h\n"
+		"  --gl-trace FILE    record every GL call with its arguments and times into\n"
+		"                     FILE, see GLTrace.h\n"
+		"  --gl-trace-report FILE  report the calls, redundant state changes and uploads\n"
+		"                     per frame of the GL trace FILE and exit\n"
+		"  --startup-bench    exit after the first frame and print how long each phase\n"
+		"                     of the startup took, see Startup.h\n"
+		"  --startup-out FILE  write the startup phases as JSON to FILE (- for stdout)\n"
+		"  --overlay          draw the frame times and counters on top of the frames\n"
+		"                     instead of into the window title (key F), see Overlay.h\n"
+		"  --telemetry        sample the clocks, power and temperatures of the GPU and\n"
+		"                     the CPU, log them with the energy per frame, put them\n"
+		"                     into the traces and the --bench output, see Telemetry.h\n"
+		"  --debug-draw       draw the boxes around the visible instances of each chunk,\n"
+		"                     the lights and the cascades of the shadows as lines over\n"
+		"                     the frames, debug builds only, see DebugDraw.h\n"
+		"  --picking          pick the objects of the scene by their ids, which the main\n"
+		"                     pass writes into a second target, read back a frame later,\n"
+		"                     instead of casting a ray; renders offscreen, see Picking.h\n"
+		"  --capture FILE     record every frame into FILE: PNG files with .png (numbered\n"
+		"                     by a %%u in the name), RGBA8 frames with .raw, else a video\n"
+		"                     encoded by ffmpeg; key J toggles it (default:\n"
+		"                     hellocube_capture.mp4), key K takes a screenshot, see Capture.h\n"
+		"  --capture-fps N    frame rate of the video (default: %d)\n"
+		"  --capture-encoder NAME  encoder of the video: software, nvenc, qsv, vaapi or\n"
+		"                     auto, the first hardware one which works (default); FILE\n"
+		"                     may be a stream URL like rtmp://host/app/key or srt://host:port\n"
+		"  --share-frames PATH  hand the frames to the process connecting to the Unix\n"
+		"                     socket PATH in GPU memory it exported, see FrameShare.h\n"
+		"  --stream-server PORT  stream the frames to a remote viewer which says hello on\n"
+		"                     UDP port PORT, and take its input, see StreamServer.h\n"
+		"  --program-cache URL  share the program binaries with other machines through\n"
+		"                     the HTTP store http://HOST[:PORT]/PATH, see RemoteCache.h\n", name, SDF_CONE_TILE, SDF_CONE_STEPS,
+		SDF_MARCH_STEPS, CAPTURE_FPS);
+}
+
+/* Parse the command line. Returns false if it is invalid. */
+static bool parseOptions(Options *opts, int argc, char **argv)
+{
+	int i;
+	bool formatSet=false;
+
+	opts->benchFrames=0;
+	opts->benchWarmup=30;
+	opts->benchPrimitives=0;
+	opts->benchSubmit=0;
+	opts->benchVertex=0;
+	opts->benchFill=0;
+	opts->benchOut="bench.json";
+	opts->benchFormat=BENCH_FORMAT_JSON;
+	opts->batch=NULL;
+	opts->batchWorkers=-1;
+	opts->batchWorker=-1;
+	opts->listDevices=false;
+	opts->farmListen=0;
+	opts->farmNode=NULL;
+	opts->farmShard=FARM_SHARD_FRAMES;
+	opts->instanced=false;
+	opts->vertexPulling=false;
+	opts->compactInstances=false;
+	opts->gpuAnimation=false;
+	opts->scene=false;
+	opts->sceneGrid=16;
+	opts->sceneGen.clear();
+	opts->snapshot=NULL;
+	opts->voxels=0;
+	opts->voxelRaymarch=false;
+	opts->cull=true;
+	opts->hiz=false;
+	opts->gridCulling=false;
+	opts->broadphase=false;
+	opts->gpuTransforms=false;
+	opts->offscreen=false;
+	opts->separable=false;
+	opts->spirv=false;
+	opts->prepass=false;
+	opts->faceCulling=true;
+	opts->packedVertices=false;
+	opts->mesh=NULL;
+	opts->saveMesh=NULL;
+	opts->optimizeIn=opts->optimizeOut=NULL;
+	opts->lodError=1.0f;
+	opts->textures=NULL;
+	opts->buildTextureIn=opts->buildTextureOut=NULL;
+	opts->textureFormat=GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	opts->textureLayers=1;
+	opts->supercompress=false;
+	opts->archive=NULL;
+	opts->buildArchive=NULL;
+	opts->archiveFiles=NULL;
+	opts->archiveFileCount=0;
+	opts->sdfScene=NULL;
+	opts->sdfTile=SDF_CONE_TILE;
+	opts->sdfConeSteps=SDF_CONE_STEPS;
+	opts->sdfSteps=SDF_MARCH_STEPS;
+	opts->sdfTemporal=true;
+	opts->sdfCompute=false;
+	opts->sdfField=0;
+	opts->particles=0;
+	opts->lights=0;
+	opts->shadows=false;
+	opts->animation=0;
+	opts->skinning=false;
+	opts->trace=NULL;
+	opts->flightBudget=-1.0;
+	opts->flightSpike=3.0;
+	opts->flightOut=NULL;
+	opts->perfCounters=NULL;
+	opts->glTrace=NULL;
+	opts->glTraceReport=NULL;
+	opts->startupBench=false;
+	opts->startupOut=NULL;
+	opts->overlay=false;
+	opts->telemetry=false;
+	opts->debugDraw=false;
+	opts->picking=false;
+	opts->capture=NULL;
+	opts->shareFrames=NULL;
+	opts->streamPort=0;
+	opts->programCache=NULL;
+	opts->captureFps=CAPTURE_FPS;
+	opts->captureEncoder=CAPTURE_ENCODER_AUTO;
+	opts->shadingRate=false;
+	opts->post=false;
+	opts->bloom=false;
+	opts->autoExposure=false;
+	opts->msaa=1;
+	opts->taaScale=0.0;
+	opts->fogFactor=0;
+	opts->tessEdge=0.0;
+	opts->displace=false;
+	opts->impostorPixels=0.0;
+	opts->worldOrigin[0]=opts->worldOrigin[1]=opts->worldOrigin[2]=0.0;
+	opts->cameraRelative=false;
+	opts->oitList=false;
+	opts->simHz=SIM_DEFAULT_HZ;
+	opts->renderThread=0;
+	opts->commandLists=false;
+	opts->lowLatency=false;
+	opts->tearControl=false;
+	opts->hugePages=false;
+	opts->pinThreads=false;
+	opts->perLevelMips=false;
+	opts->specialize=0;
+	opts->cutRadius=1.4;
+	opts->framesInFlight=FRAME_THROTTLE_DEFAULT;
+	opts->idle=false;
+	opts->paused=false;
+	opts->record=NULL;
+	opts->replay=NULL;
+	opts->replayStep=0.0;
+	opts->viewports=0;
+	opts->viewportVsync=false;
+	opts->dynamicResolution=0.0;
+	opts->minRenderScale=DYNRES_MIN_SCALE;
+	opts->windowFlags=0;
+
+	for (i=1; i<argc; i++) {
+		const char *arg=argv[i];
+		bool hasValue=(i+1 < argc);
+		if (!strcmp(arg, "--bench") && hasValue) {
+			opts->benchFrames=atoi(argv[++i]);
+			if (opts->benchFrames <= 0)
+				return false;
+		} else if (!strcmp(arg, "--bench-warmup") && hasValue) {
+			opts->benchWarmup=atoi(argv[++i]);
+			if (opts->benchWarmup < 0)
+				return false;
+		} else if (!strcmp(arg, "--bench-primitives") && hasValue) {
+			opts->benchPrimitives=atoi(argv[++i]);
+			if (opts->benchPrimitives <= 0)
+				return false;
+			opts->windowFlags |= APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--bench-submit") && hasValue) {
+			opts->benchSubmit=atoi(argv[++i]);
+			if (opts->benchSubmit <= 0)
+				return false;
+			opts->windowFlags |= APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--bench-vertex") && hasValue) {
+			opts->benchVertex=atoi(argv[++i]);
+			if (opts->benchVertex <= 0)
+				return false;
+			opts->windowFlags |= APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--bench-fill") && hasValue) {
+			opts->benchFill=atoi(argv[++i]);
+			if (opts->benchFill <= 0)
+				return false;
+		} else if (!strcmp(arg, "--batch") && hasValue) {
+			opts->batch=argv[++i];
+			opts->windowFlags |= APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--bench-out") && hasValue) {
+			opts->benchOut=argv[++i];
+		} else if (!strcmp(arg, "--bench-format") && hasValue) {
+			arg=argv[++i];
+			if (!strcmp(arg, "json"))
+				opts->benchFormat=BENCH_FORMAT_JSON;
+			else if (!strcmp(arg, "csv"))
+				opts->benchFormat=BENCH_FORMAT_CSV;
+			else
+				return false;
+			formatSet=true;
+		} else if (!strcmp(arg, "--instanced")) {
+			opts->instanced=true;
+		} else if (!strcmp(arg, "--vertex-pulling")) {
+			opts->vertexPulling=true;
+		} else if (!strcmp(arg, "--compact-instances")) {
+			opts->compactInstances=true;
+		} else if (!strcmp(arg, "--gpu-animation")) {
+			opts->gpuAnimation=true;
+			opts->vertexPulling=true;
+		} else if (!strcmp(arg, "--scene")) {
+			opts->scene=true;
+		} else if (!strcmp(arg, "--scene-gen") && hasValue) {
+			if (!opts->sceneGen.parse(argv[++i]) || opts->sceneGen.objects <= 0)
+				return false;
+			opts->scene=true;
+		} else if (!strcmp(arg, "--snapshot") && hasValue) {
+			opts->snapshot=argv[++i];
+			opts->scene=true;
+		} else if (!strcmp(arg, "--scene-grid") && hasValue) {
+			opts->sceneGrid=atoi(argv[++i]);
+			if (opts->sceneGrid <= 0)
+				return false;
+		} else if (!strcmp(arg, "--voxels") && hasValue) {
+			opts->voxels=atoi(argv[++i]);
+			if (opts->voxels <= 0)
+				return false;
+		} else if (!strcmp(arg, "--voxel-raymarch")) {
+			opts->voxelRaymarch=true;
+		} else if (!strcmp(arg, "--no-cull")) {
+			opts->cull=false;
+		} else if (!strcmp(arg, "--hiz")) {
+			opts->hiz=true;
+		} else if (!strcmp(arg, "--grid-culling")) {
+			opts->gridCulling=true;
+		} else if (!strcmp(arg, "--broadphase")) {
+			opts->broadphase=true;
+		} else if (!strcmp(arg, "--gpu-transforms")) {
+			opts->gpuTransforms=true;
+		} else if (!strcmp(arg, "--offscreen")) {
+			opts->offscreen=true;
+		} else if (!strcmp(arg, "--dynamic-resolution") && hasValue) {
+			opts->dynamicResolution=atof(argv[++i]);
+			if (opts->dynamicResolution <= 0.0)
+				return false;
+		} else if (!strcmp(arg, "--min-render-scale") && hasValue) {
+			opts->minRenderScale=atof(argv[++i]);
+			if (opts->minRenderScale <= 0.0 || opts->minRenderScale > 1.0)
+				return false;
+		} else if (!strcmp(arg, "--separable")) {
+			opts->separable=true;
+		} else if (!strcmp(arg, "--spirv")) {
+			opts->spirv=true;
+		} else if (!strcmp(arg, "--prepass")) {
+			opts->prepass=true;
+		} else if (!strcmp(arg, "--no-face-culling")) {
+			opts->faceCulling=false;
+		} else if (!strcmp(arg, "--packed-vertices")) {
+			opts->packedVertices=true;
+		} else if (!strcmp(arg, "--mesh") && hasValue) {
+			opts->mesh=argv[++i];
+		} else if (!strcmp(arg, "--save-mesh") && hasValue) {
+			opts->saveMesh=argv[++i];
+		} else if (!strcmp(arg, "--optimize-mesh") && i+2 < argc) {
+			opts->optimizeIn=argv[++i];
+			opts->optimizeOut=argv[++i];
+		} else if (!strcmp(arg, "--lod-error") && hasValue) {
+			opts->lodError=(float)atof(argv[++i]);
+			if (opts->lodError < 0.0f)
+				return false;
+		} else if (!strcmp(arg, "--textures") && hasValue) {
+			opts->textures=argv[++i];
+		} else if (!strcmp(arg, "--build-texture") && i+2 < argc) {
+			opts->buildTextureIn=argv[++i];
+			opts->buildTextureOut=argv[++i];
+		} else if (!strcmp(arg, "--texture-format") && hasValue) {
+			opts->textureFormat=textureFormatByName(argv[++i]);
+			if (!opts->textureFormat)
+				return false;
+		} else if (!strcmp(arg, "--texture-layers") && hasValue) {
+			opts->textureLayers=atoi(argv[++i]);
+			if (opts->textureLayers <= 0)
+				return false;
+		} else if (!strcmp(arg, "--supercompress")) {
+			opts->supercompress=true;
+		} else if (!strcmp(arg, "--direct-io")) {
+			opts->windowFlags |= APP_WINDOW_DIRECT_IO;
+		} else if (!strcmp(arg, "--archive") && hasValue) {
+			opts->archive=argv[++i];
+		} else if (!strcmp(arg, "--build-archive") && i+2 < argc) {
+			/* all that follows are the files */
+			opts->buildArchive=argv[++i];
+			opts->archiveFiles=argv+i+1;
+			opts->archiveFileCount=argc-i-1;
+			i=argc;
+		} else if (!strcmp(arg, "--sdf-scene") && hasValue) {
+			opts->sdfScene=argv[++i];
+		} else if (!strcmp(arg, "--sdf-tile") && hasValue) {
+			opts->sdfTile=atoi(argv[++i]);
+			if (opts->sdfTile < 0)
+				return false;
+		} else if (!strcmp(arg, "--sdf-cone-steps") && hasValue) {
+			opts->sdfConeSteps=atoi(argv[++i]);
+			if (opts->sdfConeSteps <= 0)
+				return false;
+		} else if (!strcmp(arg, "--no-sdf-temporal")) {
+			opts->sdfTemporal=false;
+		} else if (!strcmp(arg, "--sdf-compute")) {
+			opts->sdfCompute=true;
+		} else if (!strcmp(arg, "--shadows")) {
+			opts->shadows=true;
+		} else if (!strcmp(arg, "--trace") && hasValue) {
+			opts->trace=argv[++i];
+		} else if (!strcmp(arg, "--flight-recorder") && hasValue) {
+			opts->flightBudget=atof(argv[++i]);
+		} else if (!strcmp(arg, "--flight-spike") && hasValue) {
+			opts->flightSpike=atof(argv[++i]);
+		} else if (!strcmp(arg, "--flight-out") && hasValue) {
+			opts->flightOut=argv[++i];
+		} else if (!strcmp(arg, "--perf-counters") && hasValue) {
+			opts->perfCounters=argv[++i];
+		} else if (!strcmp(arg, "--gl-trace") && hasValue) {
+			opts->glTrace=argv[++i];
+		} else if (!strcmp(arg, "--gl-trace-report") && hasValue) {
+			opts->glTraceReport=argv[++i];
+		} else if (!strcmp(arg, "--startup-bench")) {
+			opts->startupBench=true;
+			startupTimeline()->exitAfterFirstFrame=true;
+		} else if (!strcmp(arg, "--startup-out") && hasValue) {
+			opts->startupOut=argv[++i];
+		} else if (!strcmp(arg, "--overlay")) {
+			opts->overlay=true;
+		} else if (!strcmp(arg, "--telemetry")) {
+			opts->telemetry=true;
+		} else if (!strcmp(arg, "--debug-draw")) {
+			opts->debugDraw=true;
+		} else if (!strcmp(arg, "--picking")) {
+			opts->picking=true;
+		} else if (!strcmp(arg, "--capture") && hasValue) {
+			opts->capture=argv[++i];
+		} else if (!strcmp(arg, "--share-frames") && hasValue) {
+			opts->shareFrames=argv[++i];
+		} else if (!strcmp(arg, "--stream-server") && hasValue) {
+			opts->streamPort=atoi(argv[++i]);
+			if (opts->streamPort <= 0 || opts->streamPort > 65535)
+				return false;
+		} else if (!strcmp(arg, "--program-cache") && hasValue) {
+			opts->programCache=argv[++i];
+		} else if (!strcmp(arg, "--capture-fps") && hasValue) {
+			opts->captureFps=atoi(argv[++i]);
+			if (opts->captureFps <= 0)
+				return false;
+		} else if (!strcmp(arg, "--capture-encoder") && hasValue) {
+			opts->captureEncoder=captureEncoderByName(argv[++i]);
+			if (opts->captureEncoder < CAPTURE_ENCODER_AUTO)
+				return false;
+		} else if (!strcmp(arg, "--skinning")) {
+			opts->skinning=true;
+		} else if (!strcmp(arg, "--animation") && hasValue) {
+			opts->animation=atoi(argv[++i]);
+			if (opts->animation < 0)
+				return false;
+		} else if (!strcmp(arg, "--lights") && hasValue) {
+			opts->lights=atoi(argv[++i]);
+			if (opts->lights < 0)
+				return false;
+		} else if (!strcmp(arg, "--sdf-field") && hasValue) {
+			opts->sdfField=atoi(argv[++i]);
+			if (opts->sdfField < 0)
+				return false;
+		} else if (!strcmp(arg, "--particles") && hasValue) {
+			opts->particles=atoi(argv[++i]);
+			if (opts->particles < 0)
+				return false;
+		} else if (!strcmp(arg, "--vrs")) {
+			opts->shadingRate=true;
+		} else if (!strcmp(arg, "--post")) {
+			opts->post=true;
+		} else if (!strcmp(arg, "--bloom")) {
+			opts->bloom=true;
+		} else if (!strcmp(arg, "--auto-exposure")) {
+			opts->autoExposure=true;
+		} else if (!strcmp(arg, "--msaa") && hasValue) {
+			opts->msaa=atoi(argv[++i]);
+			if (opts->msaa < 1)
+				return false;
+		} else if (!strcmp(arg, "--taa")) {
+			opts->taaScale=1.0;
+		} else if (!strcmp(arg, "--taa-upscale") && hasValue) {
+			opts->taaScale=atof(argv[++i]);
+			if (opts->taaScale <= 0.0 || opts->taaScale > 1.0)
+				return false;
+		} else if (!strcmp(arg, "--fog")) {
+			opts->fogFactor=HALFRES_FACTOR;
+		} else if (!strcmp(arg, "--fog-factor") && hasValue) {
+			opts->fogFactor=atoi(argv[++i]);
+			if (opts->fogFactor != 2 && opts->fogFactor != 4)
+				return false;
+		} else if (!strcmp(arg, "--tessellate")) {
+			opts->tessEdge=TESS_EDGE_PIXELS;
+		} else if (!strcmp(arg, "--tessellate-edge") && hasValue) {
+			opts->tessEdge=atof(argv[++i]);
+			if (opts->tessEdge <= 0.0)
+				return false;
+		} else if (!strcmp(arg, "--displace-compute")) {
+			opts->displace=true;
+		} else if (!strcmp(arg, "--impostors")) {
+			opts->impostorPixels=IMPOSTOR_PIXELS;
+		} else if (!strcmp(arg, "--impostor-pixels") && hasValue) {
+			opts->impostorPixels=atof(argv[++i]);
+			if (opts->impostorPixels <= 0.0)
+				return false;
+		} else if (!strcmp(arg, "--world-origin") && hasValue) {
+			if (sscanf(argv[++i], "%lf,%lf,%lf", &opts->worldOrigin[0], &opts->worldOrigin[1],
+				&opts->worldOrigin[2]) != 3)
+				return false;
+		} else if (!strcmp(arg, "--camera-relative")) {
+			opts->cameraRelative=true;
+		} else if (!strcmp(arg, "--sim-hz") && hasValue) {
+			opts->simHz=atof(argv[++i]);
+			if (opts->simHz <= 0.0)
+				return false;
+		} else if (!strcmp(arg, "--record") && hasValue) {
+			opts->record=argv[++i];
+		} else if (!strcmp(arg, "--replay") && hasValue) {
+			opts->replay=argv[++i];
+		} else if (!strcmp(arg, "--replay-step") && hasValue) {
+			opts->replayStep=atof(argv[++i]) / 1000.0;
+			if (opts->replayStep <= 0.0)
+				return false;
+		} else if (!strcmp(arg, "--render-thread") && hasValue) {
+			opts->renderThread=atoi(argv[++i]);
+			if (opts->renderThread < 2 || opts->renderThread > FRAME_PACKETS_MAX)
+				return false;
+		} else if (!strcmp(arg, "--low-latency")) {
+			opts->lowLatency=true;
+		} else if (!strcmp(arg, "--tear-control")) {
+			opts->tearControl=true;
+		} else if (!strcmp(arg, "--huge-pages")) {
+			opts->hugePages=true;
+		} else if (!strcmp(arg, "--pin-threads")) {
+			opts->pinThreads=true;
+		} else if (!strcmp(arg, "--per-level-mips")) {
+			opts->perLevelMips=true;
+		} else if (!strcmp(arg, "--specialize") && hasValue) {
+			opts->specialize=atoi(argv[++i]);
+			if (opts->specialize < 1)
+				return false;
+		} else if (!strcmp(arg, "--cut-radius") && hasValue) {
+			opts->cutRadius=atof(argv[++i]);
+			if (opts->cutRadius < 0.0)
+				return false;
+		} else if (!strcmp(arg, "--frames-in-flight") && hasValue) {
+			opts->framesInFlight=atoi(argv[++i]);
+			if (opts->framesInFlight < 0 || opts->framesInFlight > FRAME_THROTTLE_MAX)
+				return false;
+		} else if (!strcmp(arg, "--idle")) {
+			opts->idle=true;
+		} else if (!strcmp(arg, "--paused")) {
+			opts->paused=true;
+		} else if (!strcmp(arg, "--viewports") && hasValue) {
+			opts->viewports=atoi(argv[++i]);
+			if (opts->viewports < 1 || opts->viewports > VIEWPORT_WINDOWS_MAX)
+				return false;
+		} else if (!strcmp(arg, "--viewport-vsync")) {
+			opts->viewportVsync=true;
+		} else if (!strcmp(arg, "--command-lists")) {
+			opts->commandLists=true;
+		} else if (!strcmp(arg, "--oit-list")) {
+			opts->oitList=true;
+		} else if (!strcmp(arg, "--window-samples") && hasValue) {
+			int samples=atoi(argv[++i]);
+			if (samples < 0 || samples > 255)
+				return false;
+			opts->windowFlags |= APP_WINDOW_SAMPLES(samples);
+		} else if (!strcmp(arg, "--sdf-steps") && hasValue) {
+			opts->sdfSteps=atoi(argv[++i]);
+			if (opts->sdfSteps <= 0)
+				return false;
+		} else if (!strcmp(arg, "--hidden")) {
+			opts->windowFlags |= APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--egl")) {
+			opts->windowFlags |= APP_WINDOW_EGL;
+		} else if (!strcmp(arg, "--headless")) {
+			opts->windowFlags |= APP_WINDOW_HEADLESS | APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--egl-device") && hasValue) {
+			int device=atoi(argv[++i]);
+			if (device < 0 || device > 255)
+				return false;
+			opts->windowFlags |= APP_WINDOW_DEVICE(device);
+		} else if (!strcmp(arg, "--list-devices")) {
+			opts->listDevices=true;
+		} else if (!strcmp(arg, "--batch-workers") && hasValue) {
+			opts->batchWorkers=atoi(argv[++i]);
+			if (opts->batchWorkers < 0 || opts->batchWorkers > BATCH_WORKERS_MAX)
+				return false;
+		} else if (!strcmp(arg, "--farm-listen") && hasValue) {
+			opts->farmListen=atoi(argv[++i]);
+			if (opts->farmListen <= 0 || opts->farmListen > 65535)
+				return false;
+		} else if (!strcmp(arg, "--farm-shard") && hasValue) {
+			opts->farmShard=atoi(argv[++i]);
+			if (opts->farmShard <= 0)
+				return false;
+		} else if (!strcmp(arg, "--farm-node") && hasValue) {
+			opts->farmNode=argv[++i];
+			opts->windowFlags |= APP_WINDOW_HIDDEN;
+		} else if (!strcmp(arg, "--batch-worker") && hasValue) {
+			/* internal, added by --batch-workers to the options of its workers */
+			opts->batchWorker=atoi(argv[++i]);
+			if (opts->batchWorker < 0)
+				return false;
+		} else if (!strcmp(arg, "--gl-version") && hasValue) {
+			int major=0, minor=0;
+			if (sscanf(argv[++i], "%d.%d", &major, &minor) != 2 || major < 3 || (major == 3 && minor < 2))
+				return false;
+			glCaps()->limit(major, minor);
+		} else if (!strcmp(arg, "--gl-info") && hasValue) {
+			glCaps()->verbosity=atoi(argv[++i]);
+			if (glCaps()->verbosity < 0 || glCaps()->verbosity > 2)
+				return false;
+		} else if (!strcmp(arg, "--gl-info-out") && hasValue) {
+			glCaps()->reportFile=argv[++i];
+		} else if (!strcmp(arg, "--gl-debug")) {
+			opts->windowFlags |= APP_WINDOW_GL_DEBUG;
+		} else if (!strcmp(arg, "--perf-break")) {
+			opts->windowFlags |= APP_WINDOW_GL_DEBUG;
+			glDebug()->breakOnPerformance=true;
+		} else {
+			return false;
+		}
+	}
+
+	/* a replay is not recorded again */
+	if (opts->record && opts->replay)
+		return false;
+	if ((opts->batchWorkers >= 0 || opts->batchWorker >= 0 || opts->farmListen) && !opts->batch)
+		return false;
+	/* without a window, nothing but a remote viewer ends the interactive
+	 * modes, and the other windows and threads share its context */
+	if ((opts->windowFlags & APP_WINDOW_HEADLESS) && ((!opts->benchFrames && !opts->benchFill && !opts->batch && !opts->replay &&
+		!opts->startupBench && !opts->farmNode && !opts->streamPort) || opts->renderThread || opts->viewports ||
+		opts->idle))
+		return false;
+	/* the viewer starts the capture where the events are polled, and
+	 * its input must not wait for an idle loop */
+	if (opts->streamPort && (opts->renderThread || opts->idle))
+		return false;
+	if (!formatSet) {
+		size_t len=strlen(opts->benchOut);
+		if (len >= 4 && !strcmp(opts->benchOut + len - 4, ".csv"))
+			opts->benchFormat=BENCH_FORMAT_CSV;
+	}
+	if (!strcmp(opts->benchOut, "-"))
+		opts->benchOut=NULL;
+	return true;
+}
+
 int main (int argc, char **argv)
 {
 	BaseApplication app;	/* the cube application stata stucture */
+	BatchFile batch;
+	Options opts;
+	int result=0;
+
+	/* the time to the first frame counts from here */
+	startupTimeline()->start();
+	startupTimeline()->phase("options");
+	if (!parseOptions(&opts, argc, argv)) {
+		usage(argv[0]);
+		return 2;
+	}
+	/* keep stdio out of the frame loop */
+	logStart();
+	/* before anything big is allocated */
+	largePages()->enabled=opts.hugePages;
+	cpuTopology()->enabled=opts.pinThreads;
+	mipDownsampler()->enabled=!opts.perLevelMips;
 
-	if (app.initBaseApp(800, 600, APP_TITLE, callback_Resize, callback_Keyboard)) {
-		if (!app.initShaders("shaders/raymarch.vs.glsl", "shaders/raymarch.fs.glsl")) {
+	/* these need no GL context */
+	if (opts.listDevices) {
+		/* the list goes to stdout, after all messages */
+		logStop();
+		return headlessContext()->deviceCount(stdout) ? 0 : 1;
+	}
+	if (opts.saveMesh) {
+		const VertexLayout *layout=&vertexLayouts[opts.packedVertices ? VERTEX_FORMAT_PACKED : VERTEX_FORMAT_FLOAT];
+		result=meshFileWriteVertices(opts.saveMesh, layout, basicCubeGeometry,
+			sizeof(basicCubeGeometry) / sizeof(Vertex), basicCubeConnectivity, CUBE_INDEX_COUNT) ? 0 : 1;
+		logStop();
+		return result;
+	}
+	if (opts.optimizeIn) {
+		MeshOptimizeReport report;
+		result=meshOptimizeFile(opts.optimizeIn, opts.optimizeOut, &report) ? 0 : 1;
+		/* the report goes to stdout, after all messages */
+		logStop();
+		if (!result)
+			printf("%u triangles, %u vertices, cache of %d: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %u meshlets, "
+				"%d levels of detail (error %g)%s\n",
+				report.triangleCount, report.vertexCount, MESH_CACHE_SIZE, report.before.acmr, report.after.acmr,
+				report.before.atvr, report.after.atvr, report.meshletCount, report.lodCount, report.lodError,
+				report.overdraw ? "" : " (overdraw order kept)");
+		return result;
+	}
+	if (opts.glTraceReport) {
+		/* the report goes to stdout, after all messages */
+		logStop();
+		return glTraceReport(opts.glTraceReport, stdout) ? 0 : 1;
+	}
+	if (opts.buildTextureIn) {
+		result=textureBuildFile(opts.buildTextureIn, opts.buildTextureOut, opts.textureFormat,
+			(GLuint)opts.textureLayers, opts.supercompress) ? 0 : 1;
+		logStop();
+		return result;
+	}
+	if (opts.buildArchive) {
+		result=assetArchiveWrite(opts.buildArchive, opts.archiveFiles, opts.archiveFileCount) ? 0 : 1;
+		logStop();
+		return result;
+	}
+	/* before anything is loaded */
+	if (opts.archive && !assetArchive()->open(opts.archive)) {
+		logStop();
+		return 1;
+	}
+	/* the functions are hooked as soon as they are loaded */
+	glTrace()->path=opts.glTrace;
+	/* before opening the window, for the mistakes in the file */
+	batch.clear();
+	if (opts.batch && !batch.load(opts.batch)) {
+		logStop();
+		return 1;
+	}
+	/* the coordinator of the workers renders nothing itself */
+	if (opts.batchWorkers >= 0) {
+		BatchWorkers workers;
+		result=workers.run(&batch, opts.batchWorkers, argv[0], argc, argv) ? 0 : 1;
+		batch.destroy();
+		logStop();
+		return result;
+	}
+	/* and neither does the coordinator of the farm */
+	if (opts.farmListen) {
+		FarmCoordinator farm;
+		result=farm.run(&batch, opts.farmListen, opts.farmShard, opts.captureEncoder) ? 0 : 1;
+		batch.destroy();
+		logStop();
+		return result;
+	}
+
+	if (app.initBaseApp(800, 600, APP_TITLE, callback_Resize, callback_Keyboard, opts.windowFlags)) {
+		startupTimeline()->phase("settings");
+		app.gpuProfiler.init(gpuScopeNames, GPU_SCOPE_COUNT);
+		if (opts.perfCounters)
+			app.gpuProfiler.counters.init(opts.perfCounters, GPU_SCOPE_COUNT);
+		app.sceneGrid=opts.sceneGrid;
+		app.sceneGen=opts.sceneGen;
+		app.snapshotFile=opts.snapshot;
+		if (opts.voxels > 0)
+			app.voxelGrid=opts.voxels;
+		app.culling=opts.cull;
+		app.gridCulling=opts.gridCulling;
+		app.broadphase=opts.broadphase;
+		app.gpuTransforms=opts.gpuTransforms;
+		app.cutRadius=(GLfloat)opts.cutRadius;
+		if (opts.specialize) {
+			app.specializer.enabled=true;
+			app.specializer.frames=(unsigned int)opts.specialize;
+		}
+		app.lodError=opts.lodError;
+		app.depthPrepass=opts.prepass;
+		app.faceCulling=opts.faceCulling;
+		if (opts.sdfTile != SDF_CONE_TILE || opts.sdfConeSteps != SDF_CONE_STEPS || opts.sdfSteps != SDF_MARCH_STEPS)
+			app.setSdfMarch(opts.sdfTile, opts.sdfConeSteps, opts.sdfSteps);
+		if (!opts.sdfTemporal)
+			app.setSdfTemporal(false);
+		if (opts.sdfCompute)
+			app.setSdfCompute(true);
+		if (opts.sdfField)
+			app.setSdfField(opts.sdfField);
+		if (opts.particles)
+			app.setParticles(opts.particles);
+		if (opts.lights)
+			app.setLights(opts.lights);
+		if (opts.shadows)
+			app.setShadows(true);
+		if (opts.animation)
+			app.setAnimation(opts.animation);
+		if (opts.skinning)
+			app.setSkinning(true);
+		if (opts.trace)
+			app.traceFile=opts.trace;
+		if (opts.flightBudget >= 0.0)
+			app.setFlightRecorder(opts.flightBudget, opts.flightSpike, opts.flightOut);
+		if (opts.overlay)
+			app.setOverlay(true);
+		if (opts.telemetry)
+			app.setTelemetry(true);
+		if (opts.debugDraw)
+			app.setDebugDraw(true);
+		if (opts.picking)
+			app.setPicking(true);
+		app.capture.fps=opts.captureFps;
+		app.capture.videoEncoder=opts.captureEncoder;
+		if (opts.capture) {
+			app.captureFile=opts.capture;
+			app.capture.start(opts.capture, opts.captureFps);
+		}
+		if (opts.shareFrames)
+			app.share.init(opts.shareFrames);
+		if (opts.shadingRate)
+			app.setShadingRate(true);
+		if (opts.post)
+			app.setPostProcess(true);
+		if (opts.bloom)
+			app.setBloom(true);
+		if (opts.autoExposure)
+			app.setAutoExposure(true);
+		if (opts.msaa > 1)
+			app.setMultisample(opts.msaa);
+		if (opts.taaScale > 0.0)
+			app.setTemporalAA(true, opts.taaScale);
+		if (opts.fogFactor)
+			app.setFog(true, opts.fogFactor);
+		if (opts.oitList)
+			app.setTransparencyMode(OIT_LIST);
+		app.simulation.setRate(opts.simHz);
+		app.commandLists=opts.commandLists;
+		if (app.win) {
+			glfwSetWindowRefreshCallback(app.win, callback_Refresh);
+			glfwSetMouseButtonCallback(app.win, callback_MouseButton);
+		}
+		if (opts.framesInFlight != FRAME_THROTTLE_DEFAULT)
+			app.setFramesInFlight(opts.framesInFlight);
+		/* falls back to the float format if it is not supported */
+		if (opts.packedVertices)
+			app.setVertexFormat(VERTEX_FORMAT_PACKED);
+		app.vertexPulling=opts.vertexPulling;
+		app.compactInstances=opts.compactInstances;
+		app.gpuAnimation=opts.gpuAnimation;
+
+		/* register every program we may switch to */
+		int i, def;
+		unsigned int spinning=opts.gpuAnimation ? SHADER_FEATURE_SPINNING : 0u;
+		startupTimeline()->phase("programs");
+		app.programs.setDefines(shaderFeatureNames, SHADER_FEATURE_COUNT);
+		if (opts.separable)
+			app.programs.useSeparable(true);
+		app.queue.pipelines=app.programs.separable;
+		if (opts.tessEdge > 0.0)
+			app.setTessellation(true, (float)opts.tessEdge);
+		if (opts.displace)
+			app.setDisplacement(true);
+		if (opts.impostorPixels > 0.0)
+			app.setImpostors(true, (float)opts.impostorPixels);
+		app.worldOrigin = glm::dvec3(opts.worldOrigin[0], opts.worldOrigin[1], opts.worldOrigin[2]);
+		if (opts.cameraRelative)
+			app.setCameraRelative(true);
+		if (opts.spirv)
+			app.programs.useSpirv(true);
+		for (i = 0; i < 10; i++) {
+			const ShaderCombination *c=&shaderTable[i];
+			const char *fs=(c->fsBindless && app.materials.bindless) ? c->fsBindless : c->fs;
+			/* without sparse textures, the plain materials */
+			bool virtualTexture=!strcmp(fs, VIRTUAL_TEXTURE_FS);
+			if (virtualTexture && !app.virtualTexture.texture)
+				fs=MATERIAL_FS;
+			app.keyPrograms[i] = app.programs.add(c->vs, fs, c->vsInstanced, c->defines, c->instancedDefines);
+			if (virtualTexture && app.virtualTexture.texture)
+				app.virtualProgram = app.keyPrograms[i];
+			app.programs.setRaster(app.keyPrograms[i], c->raster);
+			if (c->prepass)
+				app.programs.addPrepass(app.keyPrograms[i], SHADER_FEATURE_DEPTH_ONLY);
+			if (opts.vertexPulling && c->pulledDefines)
+				app.programs.addPulled(app.keyPrograms[i], c->pulledDefines | spinning);
+			if (opts.compactInstances && c->compactDefines)
+				app.programs.addCompact(app.keyPrograms[i], c->compactDefines);
+			if (c->raster & RASTER_TRANSLUCENT) {
+				app.translucentPrograms[OIT_WEIGHTED] = app.keyPrograms[i];
+				app.translucentPrograms[OIT_LIST] = app.programs.add(c->vs, fs, c->vsInstanced,
+					c->defines | SHADER_FEATURE_OIT_LIST, c->instancedDefines);
+				app.programs.setRaster(app.translucentPrograms[OIT_LIST], c->raster);
+				if (opts.vertexPulling && c->pulledDefines)
+					app.programs.addPulled(app.translucentPrograms[OIT_LIST], c->pulledDefines | spinning);
+				if (opts.compactInstances && c->compactDefines)
+					app.programs.addCompact(app.translucentPrograms[OIT_LIST], c->compactDefines);
+			}
+		}
+		def = app.programs.add(shaderDefault.vs, shaderDefault.fs, shaderDefault.vsInstanced,
+			shaderDefault.defines, shaderDefault.instancedDefines);
+		app.programs.setRaster(def, shaderDefault.raster);
+		app.sdfProgram = def;
+		/* the voxels are marched in the same program */
+		if (glCaps()->storageBuffers) {
+			app.voxelProgram = app.programs.add(shaderDefault.vs, shaderDefault.fs, NULL, SHADER_FEATURE_VOXELS, 0);
+			app.programs.setRaster(app.voxelProgram, RASTER_DEFAULT);
+		}
+
+		/* fetch what other machines built already, build all of them in
+		 * the background, but we need the default program right away */
+		if (opts.programCache && remoteProgramCache()->init(opts.programCache))
+			app.programs.prefetch();
+		app.programs.buildAll();
+		app.programs.finish(def);
+		app.selectProgram(def);
+		startupTimeline()->phase("content");
+		if (!app.program) {
 			warn("something wrong with our shaders...");
+			result=1;
+		}
+		else if (opts.textures && !app.loadTextures(opts.textures)) {
+			result=1;
+		}
+		else if (opts.sdfScene && !app.sdf.load(opts.sdfScene)) {
+			result=1;
+		}
+		/* a benchmark measures the mesh from its first frame */
+		else if (opts.mesh && !(opts.benchFrames > 0 || opts.benchFill > 0 ? app.loadMesh(opts.mesh) : app.streamMesh(opts.mesh))) {
+			result=1;
+		}
+		else if (opts.instanced && !app.setInstanced(true)) {
+			result=1;
+		}
+		else if (opts.scene && !app.setSceneMode(true)) {
+			result=1;
+		}
+		else if (opts.voxels > 0 && !app.setVoxelMode(true)) {
+			result=1;
+		}
+		else if (opts.voxelRaymarch && !app.setVoxelRaymarch(true)) {
+			result=1;
+		}
+		else if (opts.hiz && !(app.setSceneMode(true) && app.setOcclusion(true))) {
+			result=1;
+		}
+		else if (opts.offscreen && !app.hidden && !app.setOffscreen(true, true)) {
+			result=1;
+		}
+		else if (opts.dynamicResolution > 0.0 &&
+			!app.setDynamicResolution(true, opts.dynamicResolution, opts.minRenderScale)) {
+			result=1;
+		}
+		else if (opts.streamPort && !app.stream.init(opts.streamPort)) {
+			result=1;
+		}
+		else if (opts.farmNode) {
+			FarmConnection farm;
+			app.setVsync(false);
+			if (!farm.connect(opts.farmNode) || !farmNodeLoop(&app, &farm))
+				result=1;
+			farm.destroy();
+		}
+		else if (opts.batch) {
+			/* render the jobs as fast as they go */
+			app.setVsync(false);
+			if (opts.batchWorker >= 0) {
+				FILE *results=batchWorkerResults(opts.batchWorker);
+				if (!results || !batchWorkerLoop(&app, &batch, results))
+					result=1;
+				if (results)
+					fclose(results);
+			}
+			else if (!batchLoop(&app, &batch))
+				result=1;
+		}
+		else if (opts.benchPrimitives > 0) {
+			if (!app.primitives.init(&app.programs.sources)) {
+				warn("--bench-primitives needs compute shaders");
+				result=1;
+			} else {
+				/* the times go to stdout, after all messages */
+				logStop();
+				if (!gpuPrimitivesBenchmark(&app.primitives, opts.benchPrimitives, 10, stdout))
+					result=1;
+			}
+		}
+		else if (opts.benchSubmit > 0) {
+			/* the table goes to stdout, after all messages */
+			app.setVsync(false);
+			glBindFramebuffer(GL_FRAMEBUFFER, app.renderFramebuffer());
+			logStop();
+			if (!submitBenchmark(&app.programs.sources, opts.benchSubmit, app.width, app.height, stdout))
+				result=1;
+		}
+		else if (opts.benchVertex > 0) {
+			/* the table goes to stdout, after all messages */
+			glBindFramebuffer(GL_FRAMEBUFFER, app.renderFramebuffer());
+			logStop();
+			if (!vertexBenchmark(&app.programs.sources, opts.benchVertex, app.width, app.height, opts.perfCounters,
+				stdout))
+				result=1;
+		}
+		else if (opts.benchFill > 0) {
+			/* the sizes may be larger than the window */
+			FillBench bench;
+			if (bench.init(opts.benchFill, opts.benchWarmup, app.width, app.height) &&
+				(app.renderOffscreen || app.setOffscreen(true, true))) {
+				app.setVsync(false);
+				if (!fillBenchLoop(&app, &bench))
+					result=1;
+				/* the results may go to stdout, after all messages */
+				logStop();
+				if (!bench.write(opts.benchOut, opts.benchFormat))
+					result=1;
+			}
+			else
+				result=1;
+			bench.destroy();
+		}
+		else if (opts.benchFrames > 0) {
+			/* measure every shader with an uncapped frame rate */
+			Benchmark bench;
+			if (bench.init(opts.benchFrames, opts.benchWarmup)) {
+				bench.instanced=app.instanced;
+				bench.scene=app.sceneMode;
+				/* the cubes made up by the shader fetch no vertices */
+				bench.vertexFormat=app.sceneMode ? vertexLayouts[app.vertexFormat].name :
+					(app.instanced && app.cube.pullVao) ? "pulled" : app.cube.layout.name;
+				bench.target=app.renderOffscreen ? (app.presentOffscreen ? "offscreen+present" : "offscreen") : "window";
+				bench.width=app.width;
+				bench.height=app.height;
+				app.setVsync(false);
+				if (!benchLoop(&app, &bench))
+					result=1;
+				/* the results may go to stdout, after all messages */
+				logStop();
+				if (!bench.write(opts.benchOut, opts.benchFormat))
+					result=1;
+				bench.destroy();
+			}
+			else
+				result=1;
 		}
 		else {
-			/* initialization succeeded, enter the main loop */
-			mainLoop(&app);
+			if (opts.tearControl)
+				app.setTearControl(true);
+			/* the pacer needs the context on this thread */
+			if (opts.lowLatency && !opts.renderThread)
+				app.setLowLatency(true);
+			else if (opts.lowLatency)
+				warn("--low-latency does not work with --render-thread");
+			/* no vsync paces a headless session, the pacer does, to the
+			 * frame rate of the stream with the input sampled late */
+			if (opts.streamPort && !app.win) {
+				app.pacer.setEnabled(true, 1000.0 / app.capture.fps);
+				info("stream server: frames paced to %d per second", app.capture.fps);
+			}
+			if (opts.viewports > 0 &&
+				!app.openViewports(opts.viewports, 640, 480, APP_TITLE, callback_Keyboard, opts.viewportVsync))
+				warn("--viewports: continuing with the main window only");
+			/* a replay draws every recorded frame */
+			if (opts.idle && opts.replay)
+				warn("--idle does not work with --replay");
+			else if (opts.idle)
+				app.setIdleMode(true);
+			if (opts.paused)
+				app.setAnimate(false);
+			if (opts.record)
+				app.replay.record(opts.record, app.input.width, app.input.height, app.simulation.step);
+			if (opts.replay && !app.replay.play(opts.replay, opts.replayStep, app.input.width,
+				app.input.height, app.simulation.step)) {
+				result=1;
+			} else {
+				/* pick up edits of the shader files automatically */
+				app.shaderWatcher.start("shaders");
+				/* initialization succeeded, enter the main loop */
+				startupTimeline()->phase("first frame");
+				mainLoop(&app, opts.renderThread);
+				if (!app.replay.stop())
+					result=1;
+			}
+			if (opts.trace)
+				app.exportTrace();
+			app.flight.report();
+			glDebugPerformanceDump();
 		}
 	}
+	else
+		result=1;
+	if (opts.startupBench || opts.startupOut) {
+		/* the breakdown may go to stdout, after all messages */
+		logStop();
+		if (opts.startupBench)
+			startupTimeline()->print(stdout);
+		if (opts.startupOut && !startupTimeline()->write(strcmp(opts.startupOut, "-") ? opts.startupOut : NULL))
+			result=1;
+	}
 
 	/* clean everything up */
 	app.destroy();
-	return 0;
+	batch.destroy();
+	remoteProgramCache()->destroy();
+	assetArchive()->close();
+	logStop();
+	return result;
 }
-
@@ -0,0 +1,206 @@
+#ifndef HEADER_HIZ_H
+#define HEADER_HIZ_H
+
+#include <glm/mat4x4.hpp>
+#include <glad/glad.h>
+#include "ShaderHelpers.h"
+#include "MipDownsampler.h"
+#include "RenderTarget.h"
+
+/****************************************************************************
+* HIERARCHICAL Z BUFFER                                                    *
+****************************************************************************/
+
+/* HiZBuffer: a depth pyramid for occlusion culling. Level 0 is a copy of a
+* depth buffer, every further level holds the farthest depth of the 2x2 (at
+* odd sizes up to 3x3) texels below it, so a single texel tells whether
+* anything in its area is closer than a given depth. The pyramid is built
+* from the depth of the previous frame, which is the only one we have before
+* drawing; see shaders/hiz.cs.glsl and the culling in Scene.h.
+* The depth buffer is copied with glBlitFramebuffer, which requires the same
+* depth format on both sides, so the source must be a RenderTarget.
+* Where the mip downsampler is available (see MipDownsampler.h), a single
+* dispatch copies the depth into level 0 and builds all levels from it; its
+* tiles halve exactly, so level 0 is padded to a multiple of MIP_TILE, the
+* padding repeating the edge, and the culling maps the depth buffer size
+* onto the pyramid, not the size of its level 0. */
+#define HIZ_SHADER "shaders/hiz.cs.glsl"
+#define HIZ_GROUP_SIZE 8	/* local_size_x and _y of the compute shader */
+
+/* The size of a pyramid level, for size at level 0. */
+static GLsizei hizLevelSize(GLsizei size, int level)
+{
+	return (size >> level) ? (size >> level) : 1;
+}
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint fromDepthLoc, srcSizeLoc, dstSizeLoc;
+	GLuint fbo;		/* the blit target, with depth attached */
+	GLuint depth;		/* GL_DEPTH_COMPONENT24 copy of the depth buffer */
+	GLuint pyramid;		/* GL_R32F with all levels */
+	GLsizei width, height;	/* of the depth buffer */
+	GLsizei pyramidWidth, pyramidHeight;	/* of level 0, padded for the single pass */
+	int levels;
+	glm::mat4 viewProjection;	/* of the frame the pyramid was built from */
+	bool valid;		/* the pyramid may be used for culling */
+
+	/* Build the reduction program, sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		program = fbo = depth = pyramid = 0;
+		width = height = pyramidWidth = pyramidHeight = 0;
+		levels = 0;
+		valid = false;
+		if (!computeShaderSupported() || !glTexStorage2D || !glBindImageTexture)
+			return false;
+		program = computeProgramBuild(cache, HIZ_SHADER);
+		if (!program)
+			return false;
+		fromDepthLoc = glGetUniformLocation(program, "fromDepth");
+		srcSizeLoc = glGetUniformLocation(program, "srcSize");
+		dstSizeLoc = glGetUniformLocation(program, "dstSize");
+		glState()->useProgram(program);
+		glUniform1i(glGetUniformLocation(program, "depthBuffer"), 0);
+		glState()->useProgram(0);
+		glGenFramebuffers(1, &fbo);
+		info("HiZ: created program %u", program);
+		return true;
+	}
+
+	void destroyTextures()
+	{
+		if (depth) {
+			glState()->deleteTextures(1, &depth);
+			depth = 0;
+		}
+		if (pyramid) {
+			glState()->deleteTextures(1, &pyramid);
+			pyramid = 0;
+		}
+		width = height = pyramidWidth = pyramidHeight = 0;
+		levels = 0;
+		valid = false;
+	}
+
+	void destroy()
+	{
+		destroyTextures();
+		if (fbo) {
+			glDeleteFramebuffers(1, &fbo);
+			fbo = 0;
+		}
+		if (program) {
+			glState()->deleteProgram(program);
+			program = 0;
+		}
+	}
+
+	/* (Re-)allocate the textures for a w x h depth buffer if the size
+	* changed, which also invalidates the pyramid.
+	* Returns true if successfull and false in case of an error. */
+	bool resize(GLsizei w, GLsizei h)
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		if (w == width && h == height)
+			return true;
+		destroyTextures();
+		width = w;
+		height = h;
+		pyramidWidth = w;
+		pyramidHeight = h;
+		if (mipDownsampler()->available()) {
+			pyramidWidth = (w + MIP_TILE - 1) & ~(MIP_TILE - 1);
+			pyramidHeight = (h + MIP_TILE - 1) & ~(MIP_TILE - 1);
+		}
+		levels = mipLevelCount(pyramidWidth, pyramidHeight);
+
+		/* immutable storage, rebinding the textures never reallocates */
+		glGenTextures(1, &depth);
+		glState()->bindTexture(GL_TEXTURE_2D, depth);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glGenTextures(1, &pyramid);
+		glState()->bindTexture(GL_TEXTURE_2D, pyramid);
+		glTexStorage2D(GL_TEXTURE_2D, levels, GL_R32F, pyramidWidth, pyramidHeight);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE) {
+			warn("HiZ: FBO %u is incomplete: 0x%x", fbo, (unsigned)status);
+			destroyTextures();
+			return false;
+		}
+		info("HiZ: %dx%d pixels, %d levels of %dx%d", (int)width, (int)height, levels, (int)pyramidWidth,
+			(int)pyramidHeight);
+		GL_ERROR_DBG("Hi-Z initialization");
+		return true;
+	}
+
+	/* Build the pyramid from the depth of the render target src, which was
+	* rendered with vp. src is bound again afterwards.
+	* Returns true if successfull and false in case of an error. */
+	bool build(const RenderTarget *src, const glm::mat4 &vp)
+	{
+		int i;
+
+		if (!program || !resize(src->width, src->height))
+			return false;
+		GL_DEBUG_GROUP("hiz build");
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, src->fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, src->fbo);
+
+		if (mipDownsampler()->available()) {
+			if (!mipDownsampler()->reduce(pyramid, GL_R32F, pyramidWidth, pyramidHeight, 0, levels, MIP_MAX,
+				depth, width, height))
+				return false;
+			viewProjection = vp;
+			valid = true;
+			return true;
+		}
+		glState()->useProgram(program);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, depth);
+		for (i = 0; i < levels; i++) {
+			GLsizei w = hizLevelSize(width, i);
+			GLsizei h = hizLevelSize(height, i);
+			glUniform1i(fromDepthLoc, i == 0);
+			glUniform2i(srcSizeLoc, hizLevelSize(width, i ? i - 1 : 0), hizLevelSize(height, i ? i - 1 : 0));
+			glUniform2i(dstSizeLoc, w, h);
+			if (i)
+				glBindImageTexture(0, pyramid, i - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+			glBindImageTexture(1, pyramid, i, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+			glDispatchCompute((w + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (h + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+			/* the next level reads this one */
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glState()->useProgram(0);
+		/* the culling pass samples the pyramid */
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		viewProjection = vp;
+		valid = true;
+		return true;
+	}
+
+	/* Do not cull against the current pyramid, e.g. because the frame it
+	* was built from is not representative of the next one. */
+	void invalidate()
+	{
+		valid = false;
+	}
+} HiZBuffer;
+
+#endif
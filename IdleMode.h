@@ -0,0 +1,85 @@
+#ifndef HEADER_IDLEMODE_H
+#define HEADER_IDLEMODE_H
+
+#include <GLFW/glfw3.h>
+#include <atomic>
+
+/****************************************************************************
+* IDLE MODE: frames on demand                                              *
+****************************************************************************/
+
+/* IdleMode: by default a frame is drawn every refresh, even if it is the
+* same as the last one. In the idle mode, the main loop only draws while
+* something changes: while the simulation is animated, and for a few frames
+* after anything which changes the picture (a key, a resize, the window
+* being exposed, a shader file being edited). Otherwise it sleeps in
+* glfwWaitEventsTimeout until the next event. Threads other than the main
+* one (the shader watcher) wake it with glfwPostEmptyEvent.
+* After a change, IDLE_SETTLE_FRAMES are drawn, so the effects which
+* converge over several frames (the temporal reprojection, the dynamic
+* resolution, the occlusion culling against the last frame's depth) reach
+* their final picture. Work which lands in later frames (a program built in
+* the background, a mesh being streamed in) asks for more frames as long as
+* it is in flight. With GLFW 3.2 and later, the loop also wakes every
+* IDLE_TIMEOUT seconds, in case something else was missed; older versions
+* only have glfwWaitEvents. */
+#define IDLE_SETTLE_FRAMES 8
+#define IDLE_TIMEOUT 0.5	/* s */
+
+typedef struct {
+	bool enabled;
+	bool animate;		/* the simulation advances, set by the main thread */
+	std::atomic<int> redraw;	/* frames still to draw for the last change */
+	unsigned int waits;	/* times the loop went to sleep */
+
+	void clear()
+	{
+		enabled = false;
+		animate = true;
+		redraw.store(IDLE_SETTLE_FRAMES, std::memory_order_relaxed);
+		waits = 0;
+	}
+
+	/* Something changed the picture, draw at least frames more. Any
+	* thread may call this. */
+	void invalidate(int frames = IDLE_SETTLE_FRAMES)
+	{
+		int cur = redraw.load(std::memory_order_relaxed);
+		while (cur < frames && !redraw.compare_exchange_weak(cur, frames, std::memory_order_relaxed))
+			;
+	}
+
+	/* Main thread: whether the next frame must be drawn. */
+	bool needsFrame() const
+	{
+		return !enabled || animate || redraw.load(std::memory_order_relaxed) > 0;
+	}
+
+	/* Main thread: a frame was handed to the renderer. */
+	void frameDrawn()
+	{
+		int cur = redraw.load(std::memory_order_relaxed);
+		while (cur > 0 && !redraw.compare_exchange_weak(cur, cur - 1, std::memory_order_relaxed))
+			;
+	}
+
+	/* Main thread: sleep until an event arrives and handle it. */
+	void wait()
+	{
+		waits++;
+#if GLFW_VERSION_MAJOR > 3 || GLFW_VERSION_MINOR >= 2
+		glfwWaitEventsTimeout(IDLE_TIMEOUT);
+#else
+		glfwWaitEvents();
+#endif
+	}
+} IdleMode;
+
+/* Invalidate the IdleMode user and wake the main loop, from any thread. */
+inline void idleWake(void *user)
+{
+	((IdleMode*)user)->invalidate();
+	glfwPostEmptyEvent();
+}
+
+#endif
@@ -0,0 +1,346 @@
+#ifndef HEADER_IMPOSTORS_H
+#define HEADER_IMPOSTORS_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include "Cube.h"
+#include "Log.h"
+#include "MipDownsampler.h"
+#include "RenderTarget.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* IMPOSTORS: billboards for the distant instances                          *
+****************************************************************************/
+
+/* Impostors: an instance a few pixels wide still costs all of its vertices
+* and triangles. When the mesh of the cube first shows up, and whenever it
+* changes, it is baked into an octahedral atlas (see shaders/impostor.glsl):
+* IMPOSTOR_VIEWS x IMPOSTOR_VIEWS views of IMPOSTOR_CELL pixels from the
+* directions of an octahedral map of the sphere, with mipmaps (a single pass
+* of MipDownsampler.h where available). The instances
+* whose bounding sphere is less than `pixels` wide on screen are drawn as
+* billboards instead, four vertices each pulled from gl_VertexID, which show
+* the view closest to the camera (shaders/impostor.vs.glsl), a further
+* level of detail past those of MeshLod. In between, from IMPOSTOR_FADE
+* times `pixels` down to `pixels`, the instances are drawn both ways and
+* crossfade: the mesh (shaders/cube.vs.glsl with FADE) drops the pixels the
+* billboard keeps by the same dither per pixel, so there is neither blending
+* nor sorting. The instances are written in three runs, see countInstances
+* in HelloCube.cpp: the meshes, those in the crossfade and the billboards;
+* the meshes are drawn by the cube, the others by the VAOs here, which point
+* into the same region of the instance buffer.
+* The billboards do not cast shadows, and only the plain program of the
+* cubes (key 1) draws them with its matrix instances. */
+#define IMPOSTOR_BAKE_VS "shaders/impostor_bake.vs.glsl"
+#define IMPOSTOR_BAKE_FS "shaders/cube.fs.glsl"
+#define IMPOSTOR_VS "shaders/impostor.vs.glsl"
+#define IMPOSTOR_FS "shaders/impostor.fs.glsl"
+#define IMPOSTOR_FADE_VS "shaders/cube.vs.glsl"
+#define IMPOSTOR_FADE_FS "shaders/cube.fs.glsl"
+#define IMPOSTOR_VIEWS 8	/* per side of the atlas, as in shaders/impostor.glsl */
+#define IMPOSTOR_CELL 64	/* pixels per side of a view */
+#define IMPOSTOR_PIXELS 16.0f	/* the default width below which instances are billboards */
+#define IMPOSTOR_FADE 1.5f	/* the crossfade starts at this times the width */
+#define IMPOSTOR_LEVELS 5	/* of the atlas, down to views of 4 pixels */
+
+/* the programs of the instances in the crossfade */
+#define IMPOSTOR_FADE_DEPTH_ONLY 1u
+#define IMPOSTOR_FADE_VARIANTS 2
+#define IMPOSTOR_FADE_DEFINES 6u	/* INSTANCED and FADE, in every variant */
+
+static const char *const impostorFadeDefines[] = { "DEPTH_ONLY", "INSTANCED", "FADE" };
+
+typedef struct {
+	bool enabled;
+	float pixels;		/* the width on screen at which the billboards take over */
+	ShaderSourceCache *sources;
+	Cube *cube;
+	GLuint bakeProgram, program;	/* 0 if not supported */
+	GLint bakeCellLoc, bakeRadiusLoc;
+	GLint fadeLoc, radiusLoc;
+	GLuint fadePrograms[IMPOSTOR_FADE_VARIANTS];	/* 0 until first used */
+	GLint fadeLocs[IMPOSTOR_FADE_VARIANTS];
+	glm::vec2 fadeValues[IMPOSTOR_FADE_VARIANTS];	/* the uniforms they were last given */
+	bool failed[IMPOSTOR_FADE_VARIANTS];		/* do not try to build them again */
+	GLuint atlas, depth, fbo;
+	bool atlasStorage;	/* atlas has immutable storage, for the downsampler */
+	GLuint vao;		/* the billboards, only the instance attribute */
+	GLuint fadeVao;		/* the instances in the crossfade, the vertices of the cube */
+	/* the mesh baked into the atlas */
+	GLuint bakedVbo[2];
+	GLintptr bakedOffset[2];
+	GLuint bakedIndices;
+	/* of this frame, see setInstances */
+	float fadeStart, fadeEnd;	/* distances of the crossfade */
+	GLsizei fading, far;	/* instances in the crossfade and beyond */
+
+	void clear()
+	{
+		int i;
+		enabled = false;
+		pixels = IMPOSTOR_PIXELS;
+		sources = NULL;
+		cube = NULL;
+		bakeProgram = program = 0;
+		for (i = 0; i < IMPOSTOR_FADE_VARIANTS; i++) {
+			fadePrograms[i] = 0;
+			failed[i] = false;
+		}
+		atlas = depth = fbo = 0;
+		atlasStorage = false;
+		vao = fadeVao = 0;
+		bakedVbo[0] = bakedVbo[1] = 0;
+		bakedOffset[0] = bakedOffset[1] = 0;
+		bakedIndices = 0;
+		fadeStart = fadeEnd = 0.0f;
+		fading = far = 0;
+	}
+
+	/* Build the programs of the billboards of the instances of c, the
+	* programs of the crossfade are built when first used from the sources
+	* of cache; the atlas is baked when first drawn.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache, Cube *c)
+	{
+		clear();
+		bakeProgram = programBuild(cache, IMPOSTOR_BAKE_VS, IMPOSTOR_BAKE_FS);
+		program = programBuild(cache, IMPOSTOR_VS, IMPOSTOR_FS);
+		if (!bakeProgram || !program) {
+			destroy();
+			return false;
+		}
+		bakeCellLoc = glGetUniformLocation(bakeProgram, "bakeCell");
+		bakeRadiusLoc = glGetUniformLocation(bakeProgram, "bakeRadius");
+		fadeLoc = glGetUniformLocation(program, "impostorFade");
+		radiusLoc = glGetUniformLocation(program, "impostorRadius");
+		sources = cache;
+		cube = c;
+
+		MemoryScope scope(MEMORY_TARGETS);
+		const GLsizei size = IMPOSTOR_VIEWS * IMPOSTOR_CELL;
+		glGenTextures(1, &atlas);
+		glState()->bindTexture(GL_TEXTURE_2D, atlas);
+		/* the mipmaps stop where a view is still a few texels wide, the
+		* views bleed into each other below */
+		atlasStorage = mipDownsampler()->available();
+		if (atlasStorage) {
+			glTexStorage2D(GL_TEXTURE_2D, IMPOSTOR_LEVELS, GL_RGBA8, size, size);
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, IMPOSTOR_LEVELS - 1);
+		glGenTextures(1, &depth);
+		glState()->bindTexture(GL_TEXTURE_2D, depth);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glGenFramebuffers(1, &fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!RenderTarget::checkComplete(fbo)) {
+			destroy();
+			return false;
+		}
+		GL_ERROR_DBG("impostors initialization");
+		info("impostors: atlas of %dx%d views of %d pixels", IMPOSTOR_VIEWS, IMPOSTOR_VIEWS, IMPOSTOR_CELL);
+		return true;
+	}
+
+	void destroyVertexArrays()
+	{
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		if (fadeVao)
+			glState()->deleteVertexArrays(1, &fadeVao);
+		vao = fadeVao = 0;
+		bakedVbo[0] = bakedVbo[1] = 0;
+	}
+
+	void destroy()
+	{
+		int i;
+		destroyVertexArrays();
+		for (i = 0; i < IMPOSTOR_FADE_VARIANTS; i++)
+			if (fadePrograms[i])
+				glState()->deleteProgram(fadePrograms[i]);
+		if (fbo)
+			glDeleteFramebuffers(1, &fbo);
+		if (atlas)
+			glState()->deleteTextures(1, &atlas);
+		if (depth)
+			glState()->deleteTextures(1, &depth);
+		if (bakeProgram)
+			glState()->deleteProgram(bakeProgram);
+		if (program)
+			glState()->deleteProgram(program);
+		clear();
+	}
+
+	/* Turn the billboards on or off, for the instances less than pixels
+	* wide on screen.
+	* Returns false if they are not supported. */
+	bool setEnabled(bool enable, float width)
+	{
+		if (enable && !program)
+			return false;
+		enabled = enable;
+		if (width > 0.0f)
+			pixels = width;
+		return true;
+	}
+
+	/* Whether the atlas shows the mesh the cube has now. */
+	bool baked() const
+	{
+		return bakedVbo[0] == cube->vbo[0] && bakedVbo[1] == cube->vbo[1] &&
+			bakedOffset[0] == cube->vboOffset[0] && bakedOffset[1] == cube->vboOffset[1] &&
+			bakedIndices == cube->lods[0].indexCount;
+	}
+
+	/* Bake the views of the mesh of the cube into the atlas, and set up
+	* the VAOs reading its vertices and instances. This binds the default
+	* framebuffer and changes the viewport.
+	* Returns true if successfull and false in case of an error. */
+	bool bake()
+	{
+		int x, y;
+		GL_DEBUG_GROUP("impostor bake");
+		destroyVertexArrays();
+		if (!cube->vao || !cube->instances.buffer)
+			return false;
+		fadeVao = meshVertexArrayCreate(&cube->layout, cube->vbo[0], cube->vbo[1], cube->vboOffset[0],
+			"impostor crossfade");
+		if (!meshInstanceAttribs(fadeVao, cube->instances.buffer)) {
+			destroyVertexArrays();
+			return false;
+		}
+		if (directStateAccessSupported()) {
+			glCreateVertexArrays(1, &vao);
+		} else {
+			glGenVertexArrays(1, &vao);
+			glState()->bindVertexArray(vao);
+		}
+		glDebugLabel(GL_VERTEX_ARRAY, vao, "impostor billboards");
+		meshInstanceAttribs(vao, cube->instances.buffer);
+
+		const GLfloat clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f}, clearDepth = 1.0f;
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glClearBufferfv(GL_COLOR, 0, clearColor);
+		glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+		glState()->useProgram(bakeProgram);
+		glUniform1f(bakeRadiusLoc, cube->radius);
+		glState()->bindVertexArray(cube->vao);
+		glState()->enable(GL_DEPTH_TEST);
+		glState()->depthFunc(GL_LESS);
+		glState()->raster(RASTER_OPAQUE);
+		int lod = cube->lod;
+		cube->lod = 0;
+		for (y = 0; y < IMPOSTOR_VIEWS; y++)
+			for (x = 0; x < IMPOSTOR_VIEWS; x++) {
+				glState()->viewport(x * IMPOSTOR_CELL, y * IMPOSTOR_CELL, IMPOSTOR_CELL, IMPOSTOR_CELL);
+				glUniform2f(bakeCellLoc, (GLfloat)x, (GLfloat)y);
+				cube->draw();
+			}
+		cube->lod = lod;
+		glState()->raster(RASTER_DEFAULT);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (atlasStorage) {
+			const GLsizei size = IMPOSTOR_VIEWS * IMPOSTOR_CELL;
+			mipDownsampler()->generate(atlas, GL_RGBA8, size, size, IMPOSTOR_LEVELS);
+		} else {
+			glState()->bindTexture(GL_TEXTURE_2D, atlas);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+		}
+		GL_ERROR_DBG("impostor bake");
+
+		bakedVbo[0] = cube->vbo[0];
+		bakedVbo[1] = cube->vbo[1];
+		bakedOffset[0] = cube->vboOffset[0];
+		bakedOffset[1] = cube->vboOffset[1];
+		bakedIndices = cube->lods[0].indexCount;
+		info("impostors: baked %d views of %d triangles", IMPOSTOR_VIEWS * IMPOSTOR_VIEWS,
+			(int)(bakedIndices / 3u));
+		return true;
+	}
+
+	/* The distances from the camera at which the crossfade starts and
+	* ends, for lodScale of meshLodScale for a pixel. */
+	void distances(float lodScale)
+	{
+		fadeEnd = 2.0f * cube->radius * lodScale / pixels;
+		fadeStart = fadeEnd / IMPOSTOR_FADE;
+	}
+
+	/* The instances of this frame: after the meshes the cube draws come n
+	* in the crossfade, then m billboards only. */
+	void setInstances(GLsizei n, GLsizei m)
+	{
+		GLintptr offset = cube->instanceOffset + (GLintptr)cube->instanceCount * sizeof(glm::mat4);
+		fading = n;
+		far = m;
+		meshInstancePointer(fadeVao, cube->instances.buffer, offset);
+		meshInstancePointer(vao, cube->instances.buffer, offset);
+		glState()->bindVertexArray(0);
+	}
+
+	/* The program of the instances in the crossfade, of variant
+	* (IMPOSTOR_FADE_*), built when first used, for the distances of this
+	* frame.
+	* Returns 0 if it failed to build. */
+	GLuint fadeProgram(unsigned int variant)
+	{
+		if (!fadePrograms[variant] && !failed[variant]) {
+			fadePrograms[variant] = programBuild(sources, IMPOSTOR_FADE_VS, IMPOSTOR_FADE_FS, impostorFadeDefines,
+				(int)(sizeof(impostorFadeDefines) / sizeof(impostorFadeDefines[0])), variant | IMPOSTOR_FADE_DEFINES);
+			if (!fadePrograms[variant]) {
+				warn("impostors: the program for variant 0x%x failed to build", variant);
+				failed[variant] = true;
+				return 0;
+			}
+			fadeLocs[variant] = glGetUniformLocation(fadePrograms[variant], "impostorFade");
+			fadeValues[variant] = glm::vec2(0.0f);
+			info("impostors: program %u for variant 0x%x", fadePrograms[variant], variant);
+		}
+		glm::vec2 fade(fadeStart, fadeEnd);
+		if (fadePrograms[variant] && fadeValues[variant] != fade) {
+			glState()->useProgram(fadePrograms[variant]);
+			glUniform2f(fadeLocs[variant], fade.x, fade.y);
+			fadeValues[variant] = fade;
+		}
+		return fadePrograms[variant];
+	}
+
+	/* Draw the instances in the crossfade, with fadeVao and a program of
+	* fadeProgram bound. */
+	void drawFading()
+	{
+		if (fading > 0) {
+			glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)cube->lods[0].indexCount, cube->indexType,
+				BUFFER_OFFSET(cube->vboOffset[1]), fading);
+			glState()->countDraw();
+		}
+	}
+
+	/* Draw the billboards, with vao, program and the atlas bound. */
+	void draw()
+	{
+		glUniform2f(fadeLoc, fadeStart, fadeEnd);
+		glUniform1f(radiusLoc, cube->radius);
+		if (fading + far > 0) {
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, fading + far);
+			glState()->countDraw();
+		}
+	}
+} Impostors;
+
+#endif
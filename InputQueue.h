@@ -0,0 +1,156 @@
+#ifndef HEADER_INPUTQUEUE_H
+#define HEADER_INPUTQUEUE_H
+
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include "Log.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* INPUT QUEUE: window events from the callbacks                            *
+****************************************************************************/
+
+/* InputQueue: the GLFW callbacks only record what happened: each event is
+* pushed, with the time it arrived, into a single-producer single-consumer
+* ring without a lock. Nothing else runs inside glfwPollEvents. The thread
+* which advances the simulation (the main thread) takes the events out once
+* per frame, keeps the state they add up to (which keys are down, the size
+* of the framebuffer) and hands what the renderer must act on (the key
+* presses switching programs and modes, the clicks picking objects) on in
+* the frame packet.
+* The producer is whichever thread polls the window events, the consumer
+* the one which prepares the frames; they may be different threads. A full
+* ring drops the new events and counts them. */
+#define INPUT_QUEUE_SIZE 256	/* events, a power of two */
+#define INPUT_KEY_WORDS ((GLFW_KEY_LAST + 32) / 32)
+
+enum {
+	INPUT_KEY = 0,		/* key, scancode, action, mods */
+	INPUT_RESIZE,		/* the framebuffer is width x height */
+	INPUT_BUTTON		/* mouse button key, action, mods at x, y */
+};
+
+typedef struct {
+	double time;		/* profileSeconds() when the event arrived */
+	unsigned char type;	/* INPUT_* */
+	unsigned char action;	/* GLFW_PRESS, _RELEASE or _REPEAT */
+	unsigned short mods;
+	int key, scancode;	/* or width and height for INPUT_RESIZE */
+	float x, y;		/* the cursor for INPUT_BUTTON, -1 to 1 from the lower left */
+} InputEvent;
+
+typedef struct {
+	InputEvent events[INPUT_QUEUE_SIZE];
+	std::atomic<unsigned int> head;	/* written by the producer */
+	std::atomic<unsigned int> tail;	/* written by the consumer */
+	std::atomic<unsigned int> dropped;
+
+	/* consumer only: the state of all events taken so far */
+	unsigned int keysDown[INPUT_KEY_WORDS];
+	int width, height;
+
+	void clear(int w, int h)
+	{
+		int i;
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+		dropped.store(0, std::memory_order_relaxed);
+		for (i = 0; i < INPUT_KEY_WORDS; i++)
+			keysDown[i] = 0;
+		width = w;
+		height = h;
+	}
+
+	/* Producer: append e. Returns false if the ring is full. */
+	bool push(const InputEvent &e)
+	{
+		unsigned int h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) >= INPUT_QUEUE_SIZE) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		events[h & (INPUT_QUEUE_SIZE - 1)] = e;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Producer: a key event of the GLFW key callback. */
+	bool pushKey(int key, int scancode, int action, int mods)
+	{
+		InputEvent e;
+		e.time = profileSeconds();
+		e.type = INPUT_KEY;
+		e.action = (unsigned char)action;
+		e.mods = (unsigned short)mods;
+		e.key = key;
+		e.scancode = scancode;
+		e.x = e.y = 0.0f;
+		return push(e);
+	}
+
+	/* Producer: a framebuffer size event. */
+	bool pushResize(int w, int h)
+	{
+		InputEvent e;
+		e.time = profileSeconds();
+		e.type = INPUT_RESIZE;
+		e.action = 0;
+		e.mods = 0;
+		e.key = w;
+		e.scancode = h;
+		e.x = e.y = 0.0f;
+		return push(e);
+	}
+
+	/* Producer: a mouse button event with the cursor at x, y in a window
+	* of w x h, in window coordinates as GLFW reports them. */
+	bool pushButton(int button, int action, int mods, double x, double y, int w, int h)
+	{
+		InputEvent e;
+		e.time = profileSeconds();
+		e.type = INPUT_BUTTON;
+		e.action = (unsigned char)action;
+		e.mods = (unsigned short)mods;
+		e.key = button;
+		e.scancode = 0;
+		e.x = (w > 0) ? (float)(2.0 * x / w - 1.0) : 0.0f;
+		e.y = (h > 0) ? (float)(1.0 - 2.0 * y / h) : 0.0f;
+		return push(e);
+	}
+
+	/* Consumer: take the oldest event and add it to the state.
+	* Returns false if there is none. */
+	bool pop(InputEvent *e)
+	{
+		unsigned int t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire))
+			return false;
+		*e = events[t & (INPUT_QUEUE_SIZE - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		if (e->type == INPUT_RESIZE) {
+			width = e->key;
+			height = e->scancode;
+		}
+		return true;
+	}
+
+	/* Consumer: whether key is down after the events taken so far. */
+	bool keyDown(int key) const
+	{
+		return (keysDown[key >> 5] >> (key & 31)) & 1u;
+	}
+
+	/* Consumer: record the key event e. Returns true if it pressed a key
+	* which was up, false for repeats and releases. */
+	bool updateKey(const InputEvent *e)
+	{
+		bool wasDown = keyDown(e->key);
+		if (e->action == GLFW_RELEASE)
+			keysDown[e->key >> 5] &= ~(1u << (e->key & 31));
+		else
+			keysDown[e->key >> 5] |= 1u << (e->key & 31);
+		return e->action != GLFW_RELEASE && !wasDown;
+	}
+} InputQueue;
+
+#endif
@@ -0,0 +1,392 @@
+#ifndef HEADER_JOBSYSTEM_H
+#define HEADER_JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "CpuTopology.h"
+#include "Log.h"
+#include "LargePages.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* JOB SYSTEM: work stealing                                                *
+****************************************************************************/
+
+/* JobSystem: a fixed set of worker threads running small jobs, each a
+* plain function called on a range [begin, end) of items. Every worker has
+* a Chase-Lev deque of its own: it pushes and pops the jobs it spawns at
+* the bottom without any lock, and idle workers steal the oldest (and
+* usually biggest) jobs from the top of the others'. Threads which are no
+* workers (the main and the render thread) push into a shared queue under
+* a mutex instead, which the workers take from when their own deque is
+* empty.
+* A parallel for is a single job over the whole range which splits itself:
+* as long as its range is larger than the grain, it spawns the upper half
+* as a new job and goes on with the lower half, so thieves take big pieces
+* and the owner works through its own part in order, without contention.
+* The chunks start at multiples of the grain.
+* Jobs report to a JobCounter, which counts those not done yet. wait()
+* does not block: the waiting thread runs jobs itself until the counter is
+* zero. Instead of waiting, a job may be scheduled to start once a counter
+* is zero, so a chain of dependent stages (cull, then count, then write)
+* runs without any thread sitting idle in between.
+* The jobs are taken from a ring of JOB_POOL_SIZE, so no more than that
+* may be in flight; there are just a few per frame. There is one job system
+* per process, the index of the worker a thread is, is thread-local.
+* Idle workers sleep on a condition variable, so the threads cost nothing
+* between frames. With --pin-threads every worker runs on a CPU of its own
+* and steals from the workers of its NUMA node before the others, see
+* CpuTopology.h. */
+#define JOB_MAX_WORKERS 16
+#define JOB_DEQUE_SIZE 1024	/* jobs per worker, a power of two */
+#define JOB_POOL_SIZE 4096	/* jobs in flight, a power of two */
+#define JOB_SHARED_SIZE 1024	/* jobs queued by other threads, a power of two */
+
+typedef void (*JobFunc)(void *user, int begin, int end);
+
+struct Job;
+
+/* Counts the jobs of a stage which are not done yet, and holds the jobs
+* which start once that reaches zero. Reset it only when nothing is
+* pending. */
+typedef struct {
+	std::atomic<int> pending;
+	std::atomic<Job*> continuations;
+
+	void reset()
+	{
+		pending.store(0, std::memory_order_relaxed);
+		continuations.store(NULL, std::memory_order_relaxed);
+	}
+
+	bool done() const
+	{
+		return pending.load(std::memory_order_acquire) == 0;
+	}
+} JobCounter;
+
+typedef struct Job {
+	JobFunc func;
+	void *user;
+	int begin, end;
+	int grain;		/* split while the range is larger */
+	JobCounter *counter;	/* decremented when done, or NULL */
+	struct Job *next;	/* in the continuations of a counter */
+} Job;
+
+/* marks the continuations of a counter which reached zero */
+#define JOB_CLOSED ((Job*)1)
+
+/* JobDeque: the Chase-Lev work-stealing deque, with the memory orders of
+* Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+* Only the owner calls push() and pop(), any thread steal(). The thieves
+* write top and the owner bottom, each on a cache line of its own, and the
+* deques of the workers do not share one either. */
+typedef struct {
+	alignas(CACHE_LINE) std::atomic<long long> top;
+	alignas(CACHE_LINE) std::atomic<long long> bottom;
+	alignas(CACHE_LINE) std::atomic<Job*> jobs[JOB_DEQUE_SIZE];
+
+	void init()
+	{
+		top.store(0, std::memory_order_relaxed);
+		bottom.store(0, std::memory_order_relaxed);
+	}
+
+	/* Returns false if the deque is full. */
+	bool push(Job *j)
+	{
+		long long b = bottom.load(std::memory_order_relaxed);
+		long long t = top.load(std::memory_order_acquire);
+		if (b - t >= JOB_DEQUE_SIZE)
+			return false;
+		jobs[b & (JOB_DEQUE_SIZE - 1)].store(j, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/* The newest job, NULL if there is none. */
+	Job *pop()
+	{
+		long long b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return NULL;
+		}
+		Job *j = jobs[b & (JOB_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+		if (t == b) {
+			/* the last one, a thief may be after it too */
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				j = NULL;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return j;
+	}
+
+	/* The oldest job, NULL if there is none or another thread won it. */
+	Job *steal()
+	{
+		long long t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return NULL;
+		Job *j = jobs[t & (JOB_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return NULL;
+		return j;
+	}
+} JobDeque;
+
+/* The worker index of the calling thread, -1 for threads which are no
+* workers. */
+inline int &jobWorkerIndex()
+{
+	static thread_local int index = -1;
+	return index;
+}
+
+typedef struct {
+	std::thread threads[JOB_MAX_WORKERS];
+	JobDeque deques[JOB_MAX_WORKERS];
+	int nodes[JOB_MAX_WORKERS];	/* NUMA node of each worker, 0 if not pinned */
+	int threadCount;
+	Job pool[JOB_POOL_SIZE];
+	std::atomic<unsigned int> allocated;
+
+	/* the jobs of the other threads, protected by sharedLock */
+	std::mutex sharedLock;
+	Job *shared[JOB_SHARED_SIZE];
+	unsigned int sharedHead, sharedTail;
+
+	/* sleeping workers, protected by lock */
+	std::mutex lock;
+	std::condition_variable wake;
+	std::atomic<int> queued;	/* pushed and not taken yet */
+	std::atomic<int> sleepers;
+	bool quit;
+
+	/* Start count worker threads, 0 picks one less than the number of
+	* cores, since the threads waiting for jobs run them too. Each worker
+	* calls start with its index first, once it runs where it was placed. */
+	void init(int count = 0, void (*start)(int index) = NULL)
+	{
+		int i;
+		if (count <= 0)
+			count = (int)std::thread::hardware_concurrency() - 1;
+		if (count > JOB_MAX_WORKERS)
+			count = JOB_MAX_WORKERS;
+		allocated.store(0, std::memory_order_relaxed);
+		sharedHead = sharedTail = 0;
+		queued.store(0, std::memory_order_relaxed);
+		sleepers.store(0, std::memory_order_relaxed);
+		quit = false;
+		for (i = 0; i < count; i++) {
+			deques[i].init();
+			nodes[i] = cpuTopology()->node(cpuTopology()->workerCpu(i));
+		}
+		/* the workers steal from each other right away */
+		threadCount = (count > 0) ? count : 0;
+		for (i = 0; i < threadCount; i++)
+			threads[i] = std::thread([this, i, start]() { worker(i, start); });
+		info("job system: %d worker threads", threadCount);
+	}
+
+	void destroy()
+	{
+		int i;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quit = true;
+		}
+		wake.notify_all();
+		for (i = 0; i < threadCount; i++)
+			threads[i].join();
+		threadCount = 0;
+	}
+
+	/* Queue j where the calling thread's jobs go, or run it right away if
+	* there is no room. */
+	void push(Job *j)
+	{
+		int self = jobWorkerIndex();
+		bool pushed;
+		if (self >= 0) {
+			pushed = deques[self].push(j);
+		} else {
+			std::lock_guard<std::mutex> guard(sharedLock);
+			pushed = sharedHead - sharedTail < JOB_SHARED_SIZE;
+			if (pushed)
+				shared[sharedHead++ & (JOB_SHARED_SIZE - 1)] = j;
+		}
+		if (!pushed) {
+			execute(j);
+			return;
+		}
+		queued.fetch_add(1);
+		/* a worker going to sleep either sees the job, or is woken */
+		if (sleepers.load() > 0) {
+			{ std::lock_guard<std::mutex> guard(lock); }
+			wake.notify_one();
+		}
+	}
+
+	/* A job for the calling thread: its own newest, a shared one, or the
+	* oldest of another worker, of the same NUMA node first. NULL if there
+	* is none. */
+	Job *take()
+	{
+		int self = jobWorkerIndex();
+		Job *j = NULL;
+		int i;
+		if (self >= 0)
+			j = deques[self].pop();
+		if (!j) {
+			std::lock_guard<std::mutex> guard(sharedLock);
+			if (sharedTail != sharedHead)
+				j = shared[sharedTail++ & (JOB_SHARED_SIZE - 1)];
+		}
+		/* the pass over the other nodes is empty without NUMA */
+		int node = (self >= 0) ? nodes[self] : 0;
+		for (int local = 1; local >= 0 && !j; local--)
+			for (i = 1; !j && i <= threadCount; i++) {
+				int victim = (self + i) % threadCount;
+				if (victim != self && (nodes[victim] == node) == (local != 0))
+					j = deques[victim].steal();
+			}
+		if (j)
+			queued.fetch_sub(1);
+		return j;
+	}
+
+	Job *allocate(JobFunc f, void *u, int begin, int end, int grain, JobCounter *counter)
+	{
+		Job *j = &pool[allocated.fetch_add(1, std::memory_order_relaxed) & (JOB_POOL_SIZE - 1)];
+		j->func = f;
+		j->user = u;
+		j->begin = begin;
+		j->end = end;
+		j->grain = (grain < 1) ? 1 : grain;
+		j->counter = counter;
+		j->next = NULL;
+		if (counter)
+			counter->pending.fetch_add(1);
+		return j;
+	}
+
+	/* Run j, splitting off the upper halves of its range as new jobs while
+	* it is larger than the grain, then count it as done. */
+	void execute(Job *j)
+	{
+		int begin = j->begin, end = j->end;
+		int chunks;
+		while ((chunks = (end - begin + j->grain - 1) / j->grain) > 1) {
+			int mid = begin + (chunks / 2) * j->grain;
+			push(allocate(j->func, j->user, mid, end, j->grain, j->counter));
+			end = mid;
+		}
+		if (end > begin) {
+			PROFILE_ZONE("job");
+			j->func(j->user, begin, end);
+		}
+		if (j->counter)
+			finish(j->counter);
+	}
+
+	/* One job of counter c is done. The last one starts the jobs which
+	* waited for the counter. */
+	void finish(JobCounter *c)
+	{
+		if (c->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;
+		Job *j = c->continuations.exchange(JOB_CLOSED, std::memory_order_acq_rel);
+		while (j && j != JOB_CLOSED) {
+			Job *next = j->next;
+			push(j);
+			j = next;
+		}
+	}
+
+	/* Call f(user, begin, end) for chunks of at most grain items covering
+	* [0, n), in parallel, counted by counter (which may be NULL). If after
+	* is given, the work starts once that counter is zero. Returns at once. */
+	void parallelFor(JobFunc f, void *u, int n, int grain, JobCounter *counter, JobCounter *after = NULL)
+	{
+		if (n <= 0)
+			return;
+		Job *j = allocate(f, u, 0, n, grain, counter);
+		if (!after || after->done()) {
+			push(j);
+			return;
+		}
+		Job *head = after->continuations.load(std::memory_order_acquire);
+		do {
+			if (head == JOB_CLOSED) {
+				push(j);
+				return;
+			}
+			j->next = head;
+		} while (!after->continuations.compare_exchange_weak(head, j, std::memory_order_acq_rel,
+			std::memory_order_acquire));
+	}
+
+	/* Run jobs until counter c is zero. */
+	void wait(JobCounter *c)
+	{
+		while (!c->done()) {
+			Job *j = take();
+			if (j)
+				execute(j);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	/* Call f(user, begin, end) for consecutive chunks of at most g items
+	* covering [0, n), in parallel. Returns when all chunks are done. */
+	void run(JobFunc f, void *u, int n, int g)
+	{
+		JobCounter c;
+		if (!threadCount || n <= g) {
+			if (n > 0)
+				f(u, 0, n);
+			return;
+		}
+		c.reset();
+		parallelFor(f, u, n, g, &c);
+		wait(&c);
+	}
+
+	/* The worker threads. */
+	void worker(int index, void (*start)(int index))
+	{
+		int cpu = cpuTopology()->workerCpu(index);
+		if (cpu >= 0 && !cpuTopology()->pinCpu(cpu))
+			warn("CPU topology: failed to pin job worker %d to CPU %d", index, cpu);
+		jobWorkerIndex() = index;
+		PROFILE_THREAD("job %d", index);
+		if (start)
+			start(index);
+		for (;;) {
+			Job *j = take();
+			if (j) {
+				execute(j);
+				continue;
+			}
+			std::unique_lock<std::mutex> guard(lock);
+			sleepers.fetch_add(1);
+			wake.wait(guard, [&]() { return quit || queued.load() > 0; });
+			sleepers.fetch_sub(1);
+			if (quit)
+				break;
+		}
+	}
+} JobSystem;
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef HEADER_LARGEPAGES_H
+#define HEADER_LARGEPAGES_H
+
+#include <stdlib.h>
+#include <atomic>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "Log.h"
+#include "MemoryStats.h"
+
+/****************************************************************************
+* LARGE PAGES: big arrays with fewer TLB misses                            *
+****************************************************************************/
+
+/* The big arrays the frame walks through (the frame arenas, the scene
+* graph, the culling arrays) span hundreds of MiB with a million objects,
+* and with 4 KiB pages every few KiB of them cost a TLB entry. With
+* --huge-pages, largePageAlloc() puts the arrays of at least half a
+* LARGE_PAGE_BYTES into 2 MiB pages: explicit huge pages where the system
+* has them (MAP_HUGETLB from the pages reserved in /proc/sys/vm/nr_hugepages
+* on Linux, MEM_LARGE_PAGES with the "Lock pages in memory" right on
+* Windows), and otherwise a mapping aligned to 2 MiB which the kernel backs
+* with transparent huge pages (madvise MADV_HUGEPAGE). Without the option,
+* or for smaller arrays, it is the heap.
+* Whatever it returns is aligned to CACHE_LINE, and freed by
+* largePageFree(), which finds out from a header in front how it was
+* allocated. The bytes asked for count as CPU memory of the category of
+* the calling thread, see MemoryStats.h.
+* CACHE_LINE is also what the data written by different threads is aligned
+* to (alignas), so that two workers never write to the same line. */
+#define LARGE_PAGE_BYTES (2u << 20)
+#define CACHE_LINE 64
+
+enum {
+	LARGE_PAGE_HEAP = 0,	/* malloc */
+	LARGE_PAGE_MAPPED,	/* a mapping of small or transparent huge pages */
+	LARGE_PAGE_HUGE		/* explicit huge pages */
+};
+
+/* in front of each allocation */
+typedef struct {
+	void *base;		/* of the malloc or mapping */
+	size_t size;		/* of the mapping */
+	size_t bytes;		/* asked for */
+	int kind;		/* LARGE_PAGE_* */
+	int category;		/* MEMORY_* */
+} LargePageHeader;
+
+typedef struct {
+	bool enabled;		/* --huge-pages */
+	std::atomic<bool> hugeFailed;	/* there are no explicit huge pages, do not ask again */
+	std::atomic<size_t> huge, mapped;	/* bytes allocated of each kind */
+
+	/* Log what the large arrays got. */
+	void report()
+	{
+		if (enabled)
+			info("large pages: %u MiB in huge pages, %u MiB in transparent huge pages",
+				(unsigned)(huge.load() >> 20), (unsigned)(mapped.load() >> 20));
+	}
+} LargePages;
+
+/* The settings of the process, shared by all translation units. */
+inline LargePages *largePages()
+{
+	/* zero-initialized, as a static */
+	static LargePages pages;
+	return &pages;
+}
+
+/* Map size bytes, a multiple of LARGE_PAGE_BYTES, in huge pages if there
+* are any, and set *kind.
+* Returns the mapping, or NULL if out of memory. */
+static void *largePageMap(size_t size, int *kind)
+{
+	LargePages *lp = largePages();
+#ifdef _WIN32
+	SIZE_T minimum = GetLargePageMinimum();
+	void *m;
+	if (!lp->hugeFailed && minimum && !(size % minimum)) {
+		m = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (m) {
+			*kind = LARGE_PAGE_HUGE;
+			return m;
+		}
+		if (!lp->hugeFailed.exchange(true))
+			info("large pages: no large pages without the \"Lock pages in memory\" right, using small ones");
+	}
+	m = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	*kind = LARGE_PAGE_MAPPED;
+	return m;
+#else
+	unsigned char *m, *aligned;
+	size_t head;
+#ifdef MAP_HUGETLB
+	if (!lp->hugeFailed) {
+		m = (unsigned char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (m != MAP_FAILED) {
+			*kind = LARGE_PAGE_HUGE;
+			return m;
+		}
+		if (!lp->hugeFailed.exchange(true))
+			info("large pages: no huge pages reserved in /proc/sys/vm/nr_hugepages, using transparent ones");
+	}
+#endif
+	/* a page more, to cut out a range aligned to one */
+	m = (unsigned char*)mmap(NULL, size + LARGE_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (m == MAP_FAILED)
+		return NULL;
+	aligned = (unsigned char*)(((size_t)m + LARGE_PAGE_BYTES - 1) & ~(size_t)(LARGE_PAGE_BYTES - 1));
+	head = (size_t)(aligned - m);
+	if (head)
+		munmap(m, head);
+	if (LARGE_PAGE_BYTES - head)
+		munmap(aligned + size, LARGE_PAGE_BYTES - head);
+#ifdef MADV_HUGEPAGE
+	madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+	*kind = LARGE_PAGE_MAPPED;
+	return aligned;
+#endif
+}
+
+/* Allocate bytes for a big array, see above.
+* Returns NULL if out of memory. */
+static void *largePageAlloc(size_t bytes)
+{
+	LargePages *lp = largePages();
+	unsigned char *base = NULL, *p;
+	size_t size = 0;
+	int kind = LARGE_PAGE_HEAP;
+
+	if (lp->enabled && bytes + CACHE_LINE >= LARGE_PAGE_BYTES / 2) {
+		size = (bytes + CACHE_LINE + LARGE_PAGE_BYTES - 1) & ~(size_t)(LARGE_PAGE_BYTES - 1);
+		base = (unsigned char*)largePageMap(size, &kind);
+		if (base)
+			(kind == LARGE_PAGE_HUGE ? lp->huge : lp->mapped) += size;
+	}
+	if (!base) {
+		/* room for the header and the alignment */
+		kind = LARGE_PAGE_HEAP;
+		base = (unsigned char*)malloc(bytes + 2 * CACHE_LINE);
+		if (!base)
+			return NULL;
+	}
+	p = (unsigned char*)(((size_t)base + sizeof(LargePageHeader) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1));
+	LargePageHeader *h = (LargePageHeader*)p - 1;
+	h->base = base;
+	h->size = size;
+	h->bytes = bytes;
+	h->kind = kind;
+	h->category = memoryCategory();
+	memoryStats()->add(MEMORY_CPU, h->category, (long long)bytes);
+	return p;
+}
+
+/* Free what largePageAlloc() returned, NULL is fine. */
+static void largePageFree(void *p)
+{
+	if (!p)
+		return;
+	LargePageHeader *h = (LargePageHeader*)p - 1;
+	memoryStats()->add(MEMORY_CPU, h->category, -(long long)h->bytes);
+	if (h->kind == LARGE_PAGE_HEAP) {
+		free(h->base);
+		return;
+	}
+	(h->kind == LARGE_PAGE_HUGE ? largePages()->huge : largePages()->mapped) -= h->size;
+#ifdef _WIN32
+	VirtualFree(h->base, 0, MEM_RELEASE);
+#else
+	munmap(h->base, h->size);
+#endif
+}
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef HEADER_LOG_H
+#define HEADER_LOG_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/****************************************************************************
+* LOGGING: levels, log sink, asynchronous writer                           *
+****************************************************************************/
+
+/* Messages below LOG_MIN_LEVEL are compiled out: info() expands to dead code
+* in release builds (NDEBUG, e.g. make RELEASE=1), so its arguments are not
+* even evaluated. Define LOG_MIN_LEVEL to override this. */
+#define LOG_LEVEL_INFO 0
+#define LOG_LEVEL_WARN 1
+
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_WARN
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+
+/* All messages go to a log sink. The default one writes info messages to
+* stdout and warnings to stderr; logSetSink installs another one, e.g. to
+* forward messages to a log window. A sink gets the text of a single
+* message without the trailing newline, which is not NUL-terminated. While
+* the asynchronous writer runs, the sink is called on its thread. */
+#define LOG_MESSAGE_MAX 1024	/* longer formatted messages are truncated */
+
+typedef void (*LogSinkFunc)(void *user, int level, const char *text, size_t length);
+
+typedef struct {
+	LogSinkFunc func;	/* NULL for the default sink */
+	void *user;
+} LogSink;
+
+/* The log sink of the application. This is an inline function with a
+* static local, not a static variable, so all translation units share it. */
+inline LogSink *logSink()
+{
+	static LogSink sink = { NULL, NULL };
+	return &sink;
+}
+
+/* Send all messages to func, or to stdout/stderr if it is NULL. */
+inline void logSetSink(LogSinkFunc func, void *user)
+{
+	LogSink *sink = logSink();
+	sink->func = func;
+	sink->user = user;
+}
+
+/* Hand length bytes of text to the log sink right away. */
+inline void logSinkWrite(int level, const char *text, size_t length)
+{
+	LogSink *sink = logSink();
+	if (sink->func) {
+		sink->func(sink->user, level, text, length);
+		return;
+	}
+	FILE *f = (level == LOG_LEVEL_INFO) ? stdout : stderr;
+	fwrite(text, 1, length, f);
+	fputc('\n', f);
+}
+
+/* LogQueue: the asynchronous writer. The thread which started it (the
+* render thread, see logSetProducer) only copies its messages into a
+* single-producer single-consumer ring and never waits: if the ring is
+* full, the message is dropped and counted. A writer thread drains the ring into the sink, so
+* slow stdio (e.g. stdout piped into a log collector) never stalls a frame.
+* Messages from other threads are written synchronously. The ring holds
+* variable-sized records, so bursts of short messages (like the ones while
+* the shaders are built) fit in. */
+#define LOG_QUEUE_BYTES 65536	/* must be a power of two */
+#define LOG_QUEUE_IDLE_MS 2	/* writer sleep when the ring is empty */
+#define LOG_RECORD_SKIP -1	/* level of the padding up to the end of the ring */
+
+/* followed by the text, padded to a multiple of the header size */
+typedef struct {
+	int level;
+	unsigned int length;
+} LogRecord;
+
+typedef struct {
+	char data[LOG_QUEUE_BYTES];
+	std::atomic<unsigned int> head;		/* bytes written, advanced by the producer */
+	std::atomic<unsigned int> tail;		/* bytes read, advanced by the writer */
+	std::atomic<unsigned int> dropped;	/* messages lost to a full ring */
+	std::atomic<bool> running;
+	std::atomic<std::thread::id> producer;
+	std::thread thread;
+
+	static unsigned int recordSize(size_t length)
+	{
+		return (unsigned int)(sizeof(LogRecord) + ((length + sizeof(LogRecord) - 1) & ~(sizeof(LogRecord) - 1)));
+	}
+
+	/* Queue a message. Returns false if the ring is full. */
+	bool push(int level, const char *text, size_t length)
+	{
+		LogRecord r;
+		if (length > LOG_MESSAGE_MAX)
+			length = LOG_MESSAGE_MAX;
+		unsigned int h = head.load(std::memory_order_relaxed);
+		unsigned int pos = h & (LOG_QUEUE_BYTES - 1);
+		unsigned int size = recordSize(length);
+		/* records never wrap, skip the rest of the ring instead */
+		unsigned int skip = (size > LOG_QUEUE_BYTES - pos) ? LOG_QUEUE_BYTES - pos : 0;
+		if (h + skip + size - tail.load(std::memory_order_acquire) > LOG_QUEUE_BYTES) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		if (skip) {
+			r.level = LOG_RECORD_SKIP;
+			r.length = 0;
+			memcpy(data + pos, &r, sizeof(r));
+			pos = 0;
+		}
+		r.level = level;
+		r.length = (unsigned int)length;
+		memcpy(data + pos, &r, sizeof(r));
+		memcpy(data + pos + sizeof(r), text, length);
+		head.store(h + skip + size, std::memory_order_release);
+		return true;
+	}
+
+	/* Write all queued messages to the sink. Returns their number. */
+	unsigned int drain()
+	{
+		unsigned int t = tail.load(std::memory_order_relaxed);
+		unsigned int h = head.load(std::memory_order_acquire);
+		unsigned int n = 0;
+		LogRecord r;
+		while (t != h) {
+			unsigned int pos = t & (LOG_QUEUE_BYTES - 1);
+			memcpy(&r, data + pos, sizeof(r));
+			if (r.level == LOG_RECORD_SKIP) {
+				t += LOG_QUEUE_BYTES - pos;
+			} else {
+				logSinkWrite(r.level, data + pos + sizeof(r), r.length);
+				t += recordSize(r.length);
+				n++;
+			}
+			tail.store(t, std::memory_order_release);
+		}
+		return n;
+	}
+
+	/* The writer thread. */
+	void run()
+	{
+		unsigned int reported = 0;
+		char buf[64];
+
+		for (;;) {
+			bool active = running.load(std::memory_order_acquire);
+			unsigned int lost = dropped.load(std::memory_order_relaxed);
+			if (lost != reported) {
+				int n = snprintf(buf, sizeof(buf), "%u log messages dropped", lost - reported);
+				logSinkWrite(LOG_LEVEL_WARN, buf, (size_t)n);
+				reported = lost;
+			}
+			if (drain())
+				continue;
+			if (!active)
+				break;
+			fflush(stdout);
+			std::this_thread::sleep_for(std::chrono::milliseconds(LOG_QUEUE_IDLE_MS));
+		}
+		fflush(stdout);
+		fflush(stderr);
+	}
+} LogQueue;
+
+/* The asynchronous writer of the application, NULL if it is not running. */
+inline LogQueue **logQueue()
+{
+	static LogQueue *queue = NULL;
+	return &queue;
+}
+
+/* Stop the asynchronous writer after it wrote all queued messages. Must be
+* called by the thread which started it, or at exit. */
+inline void logStop()
+{
+	LogQueue *q = *logQueue();
+	if (!q)
+		return;
+	q->running.store(false, std::memory_order_release);
+	q->thread.join();
+	*logQueue() = NULL;
+	delete q;
+}
+
+/* Start the asynchronous writer. The calling thread becomes the producer
+* whose messages are queued. The writer is stopped at exit at the latest.
+* Returns true if successfull. */
+inline bool logStart()
+{
+	static bool registered = false;
+	if (*logQueue())
+		return true;
+	LogQueue *q = new LogQueue;
+	q->head.store(0, std::memory_order_relaxed);
+	q->tail.store(0, std::memory_order_relaxed);
+	q->dropped.store(0, std::memory_order_relaxed);
+	q->running.store(true, std::memory_order_relaxed);
+	q->producer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+	q->thread = std::thread([q]() { q->run(); });
+	*logQueue() = q;
+	if (!registered) {
+		atexit(logStop);
+		registered = true;
+	}
+	return true;
+}
+
+/* Make thread the producer whose messages are queued, e.g. when the frames
+* move to another thread. The old producer must not log while this runs,
+* since there is only ever one thread pushing into the ring. */
+inline void logSetProducer(std::thread::id thread)
+{
+	LogQueue *q = *logQueue();
+	if (q)
+		q->producer.store(thread, std::memory_order_release);
+}
+
+/* Hand length bytes of text to the log: to the writer thread if it runs and
+* this is the producer thread, and to the sink directly otherwise. */
+inline void logWrite(int level, const char *text, size_t length)
+{
+	LogQueue *q = *logQueue();
+	if (q && q->producer.load(std::memory_order_acquire) == std::this_thread::get_id()) {
+		q->push(level, text, length);
+		return;
+	}
+	logSinkWrite(level, text, length);
+}
+
+inline void logFormat(int level, const char *format, va_list args)
+{
+	char buf[LOG_MESSAGE_MAX];
+	int n = vsnprintf(buf, sizeof(buf), format, args);
+	if (n < 0)
+		return;
+	if (n >= (int)sizeof(buf))
+		n = (int)sizeof(buf) - 1;
+	logWrite(level, buf, (size_t)n);
+}
+
+#if (LOG_MIN_LEVEL > LOG_LEVEL_INFO)
+/* never called, it only keeps the arguments of info() referenced */
+inline void logDiscard(const char *, ...) {}
+#define info(...) ((void)(0 && (logDiscard(__VA_ARGS__), 1)))
+#else
+/* Print a info message to stdout, use printf syntax. */
+static void info(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	logFormat(LOG_LEVEL_INFO, format, args);
+	va_end(args);
+}
+#endif
+
+/* Print a warning message to stderr, use printf syntax. */
+static void warn(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	logFormat(LOG_LEVEL_WARN, format, args);
+	va_end(args);
+}
+
+#endif
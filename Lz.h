@@ -0,0 +1,163 @@
+#ifndef HEADER_LZ_H
+#define HEADER_LZ_H
+
+#include <glad/glad.h>
+#include <string.h>
+
+/****************************************************************************
+* LZ COMPRESSION                                                           *
+****************************************************************************/
+
+/* A small LZ77 codec in the block format of LZ4, so files written with it
+* can be inspected with the lz4 tools and the other way round. A block is a
+* sequence of (literals, match) pairs, each starting with a token byte:
+* the high nibble is the number of literals, the low one the length of the
+* match minus LZ_MIN_MATCH, 15 meaning more length bytes follow, each
+* adding up to 255. The literals come next, then the distance of the match
+* back into the output, 16 bit little endian. The last pair has literals
+* only. Decompressing is copying bytes, it runs at memory speed and needs
+* no state, so the loader can inflate data straight from a mapped file.
+* The compressor is greedy with a single hash table entry per position,
+* which is fast and good for data with many repeats, like texture blocks. */
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+#define LZ_MAX_DISTANCE 65535
+#define LZ_LAST_LITERALS 5	/* the format ends with at least these literals */
+#define LZ_MATCH_LIMIT 12	/* no match starts in the last bytes */
+
+/* The most bytes lzCompress writes for n bytes of input. */
+static size_t lzBound(size_t n)
+{
+	return n + n / 255 + 16;
+}
+
+static GLuint lzRead32(const GLubyte *p)
+{
+	GLuint v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/* Write the length len beyond what fits in a token nibble. */
+static GLubyte *lzWriteLength(GLubyte *o, size_t len)
+{
+	for (; len >= 255; len -= 255)
+		*o++ = 255;
+	*o++ = (GLubyte)len;
+	return o;
+}
+
+/* Append the literals lit of count bytes and a match of len bytes at
+* distance back (len 0 for none) to o, which must have room.
+* Returns the end of the output. */
+static GLubyte *lzWriteSequence(GLubyte *o, const GLubyte *lit, size_t count, size_t distance, size_t len)
+{
+	GLubyte *token = o++;
+	size_t m = len ? len - LZ_MIN_MATCH : 0;
+
+	*token = (GLubyte)(((count < 15 ? count : 15) << 4) | (m < 15 ? m : 15));
+	if (count >= 15)
+		o = lzWriteLength(o, count - 15);
+	memcpy(o, lit, count);
+	o += count;
+	if (len) {
+		*o++ = (GLubyte)(distance & 0xff);
+		*o++ = (GLubyte)(distance >> 8);
+		if (m >= 15)
+			o = lzWriteLength(o, m - 15);
+	}
+	return o;
+}
+
+/* Compress the n bytes src into dst of capacity bytes.
+* Returns the size of the compressed block, 0 if it does not fit. */
+static size_t lzCompress(const GLubyte *src, size_t n, GLubyte *dst, size_t capacity)
+{
+	/* the position plus one of the last 4 bytes with each hash */
+	static thread_local size_t table[1 << LZ_HASH_BITS];
+	size_t i = 0, anchor = 0;
+	GLubyte *o = dst, *end = dst + capacity;
+
+	memset(table, 0, sizeof(table));
+	while (i + LZ_MATCH_LIMIT <= n) {
+		GLuint seq = lzRead32(src + i);
+		GLuint h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+		size_t candidate = table[h];
+		table[h] = i + 1;
+		if (!candidate || i - (candidate - 1) > LZ_MAX_DISTANCE || lzRead32(src + candidate - 1) != seq) {
+			i++;
+			continue;
+		}
+		candidate--;
+		size_t len = LZ_MIN_MATCH, maxLen = n - LZ_LAST_LITERALS - i;
+		while (len < maxLen && src[candidate + len] == src[i + len])
+			len++;
+		/* token, lengths, literals and distance */
+		size_t count = i - anchor;
+		if ((size_t)(end - o) < 1 + count / 255 + 1 + count + 2 + len / 255 + 1)
+			return 0;
+		o = lzWriteSequence(o, src + anchor, count, i - candidate, len);
+		i += len;
+		anchor = i;
+	}
+	if ((size_t)(end - o) < 1 + (n - anchor) / 255 + 1 + (n - anchor))
+		return 0;
+	o = lzWriteSequence(o, src + anchor, n - anchor, 0, 0);
+	return (size_t)(o - dst);
+}
+
+/* Read a length continued beyond a token nibble from src[*i] on.
+* Returns false if the block ends first. */
+static bool lzReadLength(const GLubyte *src, size_t n, size_t *i, size_t *len)
+{
+	GLubyte b;
+	do {
+		if (*i >= n)
+			return false;
+		b = src[(*i)++];
+		*len += b;
+	} while (b == 255);
+	return true;
+}
+
+/* Decompress the block src of n bytes into dst, which it must fill
+* exactly with size bytes. Every length and distance is checked, so a
+* corrupt block never reads or writes outside of the buffers.
+* Returns true if successfull and false if the block is corrupt. */
+static bool lzDecompress(const GLubyte *src, size_t n, GLubyte *dst, size_t size)
+{
+	size_t i = 0, o = 0, k;
+
+	while (i < n) {
+		GLubyte token = src[i++];
+		size_t count = token >> 4;
+		if (count == 15 && !lzReadLength(src, n, &i, &count))
+			return false;
+		if (count > n - i || count > size - o)
+			return false;
+		memcpy(dst + o, src + i, count);
+		i += count;
+		o += count;
+		if (i == n)
+			break;
+
+		if (n - i < 2)
+			return false;
+		size_t distance = src[i] | ((size_t)src[i + 1] << 8);
+		i += 2;
+		size_t len = token & 15;
+		if (len == 15 && !lzReadLength(src, n, &i, &len))
+			return false;
+		len += LZ_MIN_MATCH;
+		if (!distance || distance > o || len > size - o)
+			return false;
+		/* the match may overlap what it writes, byte by byte repeats it */
+		const GLubyte *from = dst + o - distance;
+		for (k = 0; k < len; k++)
+			dst[o + k] = from[k];
+		o += len;
+	}
+	return o == size;
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef HEADER_MATERIALS_H
+#define HEADER_MATERIALS_H
+
+#include <glm/vec4.hpp>
+#include <glad/glad.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "MipDownsampler.h"
+#include "Cube.h"
+#include "TextureFile.h"
+
+/****************************************************************************
+* MATERIALS                                                                *
+****************************************************************************/
+
+/* MaterialTable: all textures and materials of the scene, available to the
+* shaders at once, so drawing objects with different materials needs no
+* binds in between and a whole scene stays one indirect draw. A material is
+* a texture and a tint; the vertex shader gets the material index of each
+* object as a per-instance attribute (MESH_ATTRIB_MATERIAL), which survives
+* the compaction of the draws by the culling pass, unlike gl_DrawID.
+* With GL_ARB_bindless_texture (and shader storage buffers), every texture
+* is a texture of its own, made resident, and the materials in a shader
+* storage buffer hold the bindless handles; see
+* shaders/material_bindless.fs.glsl. Otherwise all textures are layers of a
+* single 2D array texture, which is bound with the materials in a uniform
+* buffer; see shaders/material.fs.glsl.
+* The textures are either the RGBA8 patterns of initDefault or the layers
+* of a block compressed texture file (see TextureFile.h), which initFromFile
+* uploads from the mapping of the file with all of its levels. */
+#define MATERIAL_MAX 64			/* also in shaders/material.glsl */
+#define MATERIAL_TEXTURE_MAX 16
+#define MATERIAL_TEXTURE_SIZE 64	/* width and height of all textures */
+#define MATERIAL_SSBO_BINDING 3		/* the culling pass uses 0 to 2 */
+
+#define MATERIAL_FS "shaders/material.fs.glsl"
+#define MATERIAL_FS_BINDLESS "shaders/material_bindless.fs.glsl"
+
+/* a material as the shaders see it, the same in std140 and std430 layout */
+typedef struct {
+	GLuint64 handle;	/* bindless texture handle, 0 without */
+	GLuint layer;		/* array texture layer, without bindless */
+	GLuint pad;
+	glm::vec4 tint;
+} GpuMaterial;
+
+static bool bindlessTextureSupported()
+{
+	return glCaps()->bindlessTexture;
+}
+
+/* Fill a MATERIAL_TEXTURE_SIZE^2 RGBA image with gray pattern number
+* pattern: checkers, stripes, dots or bricks. The material tints it. */
+static void materialPattern(GLubyte *rgba, int pattern)
+{
+	int x, y;
+	const int n = MATERIAL_TEXTURE_SIZE;
+
+	for (y = 0; y < n; y++) {
+		for (x = 0; x < n; x++) {
+			bool on;
+			switch (pattern & 3) {
+				case 0:
+					on = ((x / 8) ^ (y / 8)) & 1;
+					break;
+				case 1:
+					on = ((x + y) / 6) & 1;
+					break;
+				case 2: {
+					int dx = x % 16 - 8, dy = y % 16 - 8;
+					on = dx * dx + dy * dy < 25;
+					break;
+				}
+				default: {
+					int row = y / 8;
+					on = (y % 8) && ((x + (row & 1) * 8) % 16);
+					break;
+				}
+			}
+			GLubyte v = on ? 255 : 96;
+			GLubyte *p = rgba + 4 * (y * n + x);
+			p[0] = p[1] = p[2] = v;
+			p[3] = 255;
+		}
+	}
+}
+
+/* the tints of the materials of each texture */
+static const glm::vec4 materialTints[] = {
+	glm::vec4(1.0f, 0.4f, 0.3f, 1.0f),
+	glm::vec4(0.3f, 0.9f, 0.4f, 1.0f),
+	glm::vec4(0.3f, 0.5f, 1.0f, 1.0f),
+	glm::vec4(1.0f, 0.9f, 0.3f, 1.0f),
+};
+
+typedef struct {
+	bool bindless;		/* handles in a storage buffer, or an array texture */
+	GLuint textures[MATERIAL_TEXTURE_MAX];	/* bindless only */
+	TextureHandle textureHandles[MATERIAL_TEXTURE_MAX];	/* of textures in glResources() */
+	GLuint64 handles[MATERIAL_TEXTURE_MAX];
+	GLuint array;		/* GL_TEXTURE_2D_ARRAY, without bindless */
+	TextureHandle arrayHandle;
+	bool compressed;	/* the textures come with all levels, see initFromFile */
+	int textureCount;
+	GpuMaterial materials[MATERIAL_MAX];
+	int materialCount;
+	GLuint buffer;		/* the materials */
+
+	/* Reset to an empty table without any GL objects, destroy() then has
+	* nothing to do. */
+	void clear()
+	{
+		bindless = false;
+		memset(textures, 0, sizeof(textures));
+		memset(textureHandles, 0, sizeof(textureHandles));
+		memset(handles, 0, sizeof(handles));
+		array = 0;
+		arrayHandle.id = 0;
+		compressed = false;
+		textureCount = 0;
+		materialCount = 0;
+		buffer = 0;
+	}
+
+	/* Prepare an empty table, using bindless textures if supported. */
+	void init()
+	{
+		MemoryScope scope(MEMORY_TEXTURES);
+		clear();
+		bindless = bindlessTextureSupported();
+		/* objects without a material attribute use material 0 */
+		glVertexAttribI4ui(MESH_ATTRIB_MATERIAL, 0, 0, 0, 0);
+		if (!bindless) {
+			glGenTextures(1, &array);
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, array);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE,
+				MATERIAL_TEXTURE_MAX, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			arrayHandle = glResources()->adoptTexture(array);
+		}
+		info("materials: using %s", bindless ? "bindless textures" : "an array texture");
+	}
+
+	/* Add a MATERIAL_TEXTURE_SIZE^2 RGBA8 texture.
+	* Returns its index, or -1 if there is no room. */
+	int addTexture(const GLubyte *rgba)
+	{
+		MemoryScope scope(MEMORY_TEXTURES);
+		if (textureCount >= MATERIAL_TEXTURE_MAX) {
+			warn("materials: more than %d textures", MATERIAL_TEXTURE_MAX);
+			return -1;
+		}
+		if (bindless) {
+			GLuint tex;
+			glGenTextures(1, &tex);
+			glState()->bindTexture(GL_TEXTURE_2D, tex);
+			if (mipDownsampler()->available()) {
+				/* the downsampler needs immutable storage */
+				int levels = mipLevelCount(MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE);
+				glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE,
+					GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+				mipDownsampler()->generate(tex, GL_RGBA8, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, levels);
+				glState()->bindTexture(GL_TEXTURE_2D, tex);
+			} else {
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE,
+					0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+				glGenerateMipmap(GL_TEXTURE_2D);
+			}
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+			/* the handle freezes the texture state, so set it first */
+			textures[textureCount] = tex;
+			textureHandles[textureCount] = glResources()->adoptTexture(tex);
+			handles[textureCount] = glGetTextureHandleARB(tex);
+			glMakeTextureHandleResidentARB(handles[textureCount]);
+		} else {
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, array);
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, textureCount, MATERIAL_TEXTURE_SIZE,
+				MATERIAL_TEXTURE_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+		return textureCount++;
+	}
+
+	/* Add a material. Returns its index, or -1 if there is no room. */
+	int addMaterial(int texture, const glm::vec4 &tint)
+	{
+		if (materialCount >= MATERIAL_MAX) {
+			warn("materials: more than %d materials", MATERIAL_MAX);
+			return -1;
+		}
+		GpuMaterial *m = &materials[materialCount];
+		m->handle = bindless ? handles[texture] : 0;
+		m->layer = (GLuint)texture;
+		m->pad = 0;
+		m->tint = tint;
+		return materialCount++;
+	}
+
+	/* Create the buffer with everything added so far. Materials added
+	* afterwards are not visible to the shaders. */
+	void upload()
+	{
+		GLenum target = bindless ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER;
+
+		if (!bindless && !compressed) {
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, array);
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+		/* the uniform block is declared with all MATERIAL_MAX entries */
+		buffer = meshBufferCreate(target, sizeof(materials), materials, "materials");
+		info("materials: %d materials, %d textures in buffer %u", materialCount, textureCount, buffer);
+		GL_ERROR_DBG("material initialization");
+	}
+
+	/* Set up a few patterns in a few colors. */
+	void initDefault()
+	{
+		static GLubyte rgba[4 * MATERIAL_TEXTURE_SIZE * MATERIAL_TEXTURE_SIZE];
+		int i, j;
+
+		init();
+		for (i = 0; i < 4; i++) {
+			materialPattern(rgba, i);
+			int texture = addTexture(rgba);
+			for (j = 0; j < 4; j++)
+				addMaterial(texture, materialTints[(i + j) % 4]);
+		}
+		upload();
+	}
+
+	/* Use the layers of the texture file filename as the textures, each in
+	* the tints of initDefault. The texture file is closed again. Textures
+	* of the same file which are still alive, e.g. of the table this one
+	* replaces, are shared instead of uploaded again.
+	* Returns true if successfull and false in case of an error, then the
+	* table is empty. */
+	bool initFromFile(const char *filename)
+	{
+		TextureFile file;
+		int i, j;
+
+		clear();
+		bindless = bindlessTextureSupported();
+		compressed = true;
+		glVertexAttribI4ui(MESH_ATTRIB_MATERIAL, 0, 0, 0, 0);
+		if (!file.open(filename))
+			return false;
+		if (!textureFormatSupported((GLenum)file.header->format)) {
+			warn("materials: the context cannot sample %s textures", file.desc->name);
+			file.close();
+			return false;
+		}
+		textureCount = (int)file.header->layerCount;
+		if (textureCount > MATERIAL_TEXTURE_MAX) {
+			warn("materials: using %d of the %d layers of '%s'", MATERIAL_TEXTURE_MAX, textureCount, filename);
+			textureCount = MATERIAL_TEXTURE_MAX;
+		}
+		const char *format = file.desc->name;
+		GLsizeiptr size = (GLsizeiptr)file.size;
+		GLuint64 hash = glResourceHash(file.map, (size_t)file.size);
+		bool ok = true, found = true;
+		if (bindless) {
+			/* layer i hashes to hash + i */
+			for (i = 0; i < textureCount; i++) {
+				textureHandles[i] = glResources()->findTexture(hash + i, size);
+				found = found && textureHandles[i].id;
+			}
+			if (found) {
+				for (i = 0; i < textureCount; i++) {
+					textures[i] = glResources()->name(textureHandles[i]);
+					handles[i] = glGetTextureHandleARB(textures[i]);
+				}
+			} else {
+				for (i = 0; i < textureCount; i++)
+					glResources()->release(textureHandles[i]);
+				ok = file.createLayers(0, (GLuint)textureCount, textures);
+				for (i = 0; i < textureCount && ok; i++) {
+					textureHandles[i] = glResources()->adoptTexture(textures[i], hash + i, size);
+					handles[i] = glGetTextureHandleARB(textures[i]);
+					glMakeTextureHandleResidentARB(handles[i]);
+				}
+			}
+		} else {
+			arrayHandle = glResources()->findTexture(hash, size);
+			found = arrayHandle.id != 0;
+			if (!found)
+				arrayHandle = glResources()->adoptTexture(file.createArray(), hash, size);
+			array = glResources()->name(arrayHandle);
+			ok = array != 0;
+		}
+		file.close();
+		if (!ok) {
+			memset(textures, 0, sizeof(textures));
+			memset(textureHandles, 0, sizeof(textureHandles));
+			textureCount = 0;
+			return false;
+		}
+		for (i = 0; i < textureCount; i++)
+			for (j = 0; j < 4; j++)
+				addMaterial(i, materialTints[(i + j) % 4]);
+		info("materials: %d %s textures from '%s'%s", textureCount, format, filename, found ? ", shared" : "");
+		upload();
+		return true;
+	}
+
+	/* Make the materials available to the shaders. */
+	void bind()
+	{
+		if (bindless) {
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_SSBO_BINDING, buffer);
+		} else {
+			glState()->bindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_UBO_BINDING, buffer);
+			glState()->activeTexture(GL_TEXTURE0 + MATERIAL_TEXTURE_UNIT);
+			glState()->bindTexture(GL_TEXTURE_2D_ARRAY, array);
+			glState()->activeTexture(GL_TEXTURE0);
+		}
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < textureCount; i++) {
+			if (textures[i]) {
+				/* the last table which uses it */
+				if (glResources()->references(textureHandles[i]) == 1)
+					glMakeTextureHandleNonResidentARB(handles[i]);
+				glResources()->release(textureHandles[i]);
+				textures[i] = 0;
+				textureHandles[i].id = 0;
+				handles[i] = 0;
+			}
+		}
+		if (array) {
+			glResources()->release(arrayHandle);
+			array = 0;
+			arrayHandle.id = 0;
+		}
+		if (buffer) {
+			glState()->deleteBuffers(1, &buffer);
+			buffer = 0;
+		}
+		textureCount = materialCount = 0;
+	}
+} MaterialTable;
+
+#endif
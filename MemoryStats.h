@@ -0,0 +1,199 @@
+#ifndef HEADER_MEMORYSTATS_H
+#define HEADER_MEMORYSTATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include "Log.h"
+
+/****************************************************************************
+* MEMORY ACCOUNTING: what the CPU and the GPU hold, by category            *
+****************************************************************************/
+
+/* MemoryStats adds up the bytes allocated in the CPU memory (the big arrays
+* of largePageAlloc(), the mapped shader sources) and in the GPU memory (the
+* buffers, textures, renderbuffers and program binaries, counted by the
+* hooks of GLMemory.h), each under one of the categories below, and keeps
+* the current and the peak value of each. Which category an allocation
+* goes to is the one of the innermost MemoryScope of the thread making it,
+* MEMORY_OTHER outside of any; the GPU objects remember theirs, so that
+* deleting one takes its bytes off where they were added.
+* The counts are what was asked for: drivers add alignment, mip tails and
+* copies of their own, so the real use is somewhat higher, see
+* gpuMemoryQuery() for what the driver reports. report() logs them, the
+* overlay and the benchmark JSON show them, and a GL_OUT_OF_MEMORY logs
+* them as well, to tell what the memory went to. */
+enum {
+	MEMORY_MESHES = 0,	/* vertices and indices */
+	MEMORY_TEXTURES,	/* loaded images and materials */
+	MEMORY_SHADERS,		/* sources and program binaries */
+	MEMORY_SCENE,		/* the scene graph, the culling and instance arrays */
+	MEMORY_TARGETS,		/* render targets and the textures of the passes */
+	MEMORY_TRANSIENT,	/* per-frame arenas and ring buffers */
+	MEMORY_STAGING,		/* uploads and read-backs on their way */
+	MEMORY_OTHER,
+	MEMORY_CATEGORIES
+};
+
+enum {
+	MEMORY_CPU = 0,
+	MEMORY_GPU,
+	MEMORY_DOMAINS
+};
+
+/* the GPU objects, by their GL names */
+enum {
+	MEMORY_BUFFER = 0,
+	MEMORY_TEXTURE,
+	MEMORY_RENDERBUFFER,
+	MEMORY_PROGRAM,
+	MEMORY_OBJECT_TYPES
+};
+
+static const char *const memoryCategoryNames[MEMORY_CATEGORIES] = {
+	"meshes", "textures", "shaders", "scene", "targets", "transient", "staging", "other"
+};
+
+static const char *const memoryDomainNames[MEMORY_DOMAINS] = { "cpu", "gpu" };
+
+typedef struct {
+	long long bytes;	/* 0 if there is no such object */
+	int category;
+} MemoryObject;
+
+typedef struct {
+	std::atomic<long long> current[MEMORY_DOMAINS][MEMORY_CATEGORIES];
+	std::atomic<long long> peak[MEMORY_DOMAINS][MEMORY_CATEGORIES];
+	std::atomic<long long> total[MEMORY_DOMAINS];		/* of all categories */
+	std::atomic<long long> totalPeak[MEMORY_DOMAINS];
+	std::mutex lock;				/* of objects */
+	MemoryObject *objects[MEMORY_OBJECT_TYPES];	/* by GL name */
+	unsigned int objectCounts[MEMORY_OBJECT_TYPES];
+
+	static void raise(std::atomic<long long> *peak, long long value)
+	{
+		long long p = peak->load(std::memory_order_relaxed);
+		while (value > p && !peak->compare_exchange_weak(p, value, std::memory_order_relaxed))
+			;
+	}
+
+	/* Add delta bytes, negative to take them off, to category of domain. */
+	void add(int domain, int category, long long delta)
+	{
+		if (!delta)
+			return;
+		raise(&peak[domain][category], current[domain][category].fetch_add(delta, std::memory_order_relaxed) + delta);
+		raise(&totalPeak[domain], total[domain].fetch_add(delta, std::memory_order_relaxed) + delta);
+	}
+
+	/* The entry of the object name of type, growing the table for it.
+	* Returns NULL if out of memory; to be called with lock held. */
+	MemoryObject *object(int type, unsigned int name)
+	{
+		if (name >= objectCounts[type]) {
+			unsigned int count = objectCounts[type] ? objectCounts[type] : 256;
+			while (count <= name)
+				count *= 2;
+			MemoryObject *grown = (MemoryObject*)realloc(objects[type], count * sizeof(MemoryObject));
+			if (!grown)
+				return NULL;
+			memset(grown + objectCounts[type], 0, (count - objectCounts[type]) * sizeof(MemoryObject));
+			objects[type] = grown;
+			objectCounts[type] = count;
+		}
+		return &objects[type][name];
+	}
+
+	/* The GPU object name of type now holds bytes of category, instead of
+	* whatever it held before (new storage for it); with append, bytes are
+	* added to what it holds, in the category it has (another mip level). */
+	void setObject(int type, unsigned int name, long long bytes, int category, bool append = false)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		MemoryObject *o;
+		if (!name || !(o = object(type, name)))
+			return;
+		if (append && o->bytes) {
+			o->bytes += bytes;
+			add(MEMORY_GPU, o->category, bytes);
+			return;
+		}
+		add(MEMORY_GPU, o->category, -o->bytes);
+		o->bytes = bytes;
+		o->category = category;
+		add(MEMORY_GPU, category, bytes);
+	}
+
+	/* The GPU object name of type was deleted. */
+	void releaseObject(int type, unsigned int name)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (name < objectCounts[type] && objects[type][name].bytes) {
+			MemoryObject *o = &objects[type][name];
+			add(MEMORY_GPU, o->category, -o->bytes);
+			o->bytes = 0;
+		}
+	}
+
+	/* Log the current and peak bytes of each domain and category. */
+	void report()
+	{
+		int d, c;
+		for (d = 0; d < MEMORY_DOMAINS; d++) {
+			char line[512];	/* room for all categories */
+			int n = 0;
+			for (c = 0; c < MEMORY_CATEGORIES; c++) {
+				if (peak[d][c])
+					n += snprintf(line + n, sizeof(line) - n, "%s%s %.1f/%.1f", n ? ", " : "",
+						memoryCategoryNames[c], (double)current[d][c] / 1048576.0, (double)peak[d][c] / 1048576.0);
+			}
+			line[n] = '\0';
+			info("memory: %s %.1f MiB, peak %.1f MiB%s%s", memoryDomainNames[d], (double)total[d] / 1048576.0,
+				(double)totalPeak[d] / 1048576.0, n ? ", current/peak MiB of " : "", line);
+		}
+	}
+
+	/* Write the counts as a JSON object, indented for the benchmark
+	* results. */
+	void writeJSON(FILE *f)
+	{
+		int d, c;
+		fprintf(f, "{");
+		for (d = 0; d < MEMORY_DOMAINS; d++) {
+			fprintf(f, "%s\n    \"%s\": {\"current\": %lld, \"peak\": %lld, \"categories\": {", d ? "," : "",
+				memoryDomainNames[d], total[d].load(), totalPeak[d].load());
+			for (c = 0; c < MEMORY_CATEGORIES; c++)
+				fprintf(f, "%s\n      \"%s\": {\"current\": %lld, \"peak\": %lld}", c ? "," : "",
+					memoryCategoryNames[c], current[d][c].load(), peak[d][c].load());
+			fprintf(f, "\n    }}");
+		}
+		fprintf(f, "\n  }");
+	}
+} MemoryStats;
+
+/* The counts of the process, shared by all translation units. */
+inline MemoryStats *memoryStats()
+{
+	/* zero-initialized, as a static */
+	static MemoryStats stats;
+	return &stats;
+}
+
+/* The category the allocations of the calling thread go to. */
+inline int &memoryCategory()
+{
+	static thread_local int category = MEMORY_OTHER;
+	return category;
+}
+
+/* Puts the allocations of the calling thread into category until it goes
+* out of scope. */
+struct MemoryScope {
+	int previous;
+	explicit MemoryScope(int category) : previous(memoryCategory()) { memoryCategory() = category; }
+	~MemoryScope() { memoryCategory() = previous; }
+};
+
+#endif
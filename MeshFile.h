@@ -0,0 +1,469 @@
+#ifndef HEADER_MESHFILE_H
+#define HEADER_MESHFILE_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "Cube.h"
+
+/****************************************************************************
+* BINARY MESH FILES                                                        *
+****************************************************************************/
+
+/* A mesh file holds a mesh exactly as the GPU reads it, so loading it is
+* mapping the file and handing the blobs to GL, without parsing anything
+* and without a copy on the heap:
+*   MeshFileHeader, with the vertex layout and where the blobs are
+*   the vertices, in that layout
+*   the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, of all levels of
+*   detail one after the other (see MeshLod in Cube.h)
+*   the meshlets (MeshFileMeshlet), if any
+* Every blob starts at a multiple of MESH_FILE_ALIGN from the start of the
+* file, so each one begins on a page of the mapping. All values are little
+* endian, as the GPU reads them on every platform we run on.
+* MeshFile::createBuffers creates the buffer objects straight from the
+* mapping with meshBufferCreate, which gives them immutable storage if the
+* context has it: the driver reads the pages of the file once, as it
+* copies them into the buffers, and nothing else happens to them. */
+#define MESH_FILE_MAGIC 0x534d4348u	/* "HCMS" */
+#define MESH_FILE_VERSION 2	/* 2 added the levels of detail */
+#define MESH_FILE_ALIGN 4096
+
+/* VertexAttribDesc with fixed size fields */
+typedef struct {
+	GLuint location;
+	GLuint size;
+	GLuint type;
+	GLuint normalized;
+	GLuint offset;
+} MeshFileAttrib;
+
+typedef struct {
+	GLuint magic;		/* MESH_FILE_MAGIC */
+	GLuint version;		/* MESH_FILE_VERSION */
+	GLuint stride;		/* bytes per vertex */
+	GLuint attribCount;
+	MeshFileAttrib attribs[VERTEX_LAYOUT_MAX_ATTRIBS];
+	GLuint vertexCount;
+	GLuint indexCount;
+	GLuint indexType;	/* GL_UNSIGNED_SHORT or GL_UNSIGNED_INT */
+	GLuint meshletCount;
+	GLuint64 vertexOffset;	/* of the blobs, from the start of the file */
+	GLuint64 indexOffset;
+	GLuint64 meshletOffset;
+	GLfloat center[3];	/* bounding sphere of all vertices */
+	GLfloat radius;
+	GLuint lodCount;	/* at least 1 */
+	MeshLod lods[MESH_LOD_MAX];	/* the meshlets are in level 0 */
+} MeshFileHeader;
+
+/* A cluster of triangles, a range of the indices, with the bounds to cull
+* it by: a sphere around its vertices and a cone around the normals of its
+* triangles. All its triangles face away from a viewer at v if
+* dot(center - v, coneAxis) >= coneCutoff * length(center - v) + radius; a
+* cutoff of 1 or more means they face too many directions to ever say. The
+* layout is the same in std430, so the meshlets can be used by shaders as
+* they are. See Meshlets.h. */
+typedef struct {
+	GLfloat center[3];
+	GLfloat radius;
+	GLfloat coneAxis[3];
+	GLfloat coneCutoff;
+	GLuint firstIndex;
+	GLuint indexCount;
+	GLuint pad[2];
+} MeshFileMeshlet;
+
+/* Returns the size of an index of type, 0 if the type is not supported. */
+static GLuint meshFileIndexSize(GLenum type)
+{
+	if (type == GL_UNSIGNED_SHORT)
+		return sizeof(GLushort);
+	if (type == GL_UNSIGNED_INT)
+		return sizeof(GLuint);
+	return 0;
+}
+
+/* Round offset up to a multiple of MESH_FILE_ALIGN. */
+static GLuint64 meshFileAlign(GLuint64 offset)
+{
+	return (offset + MESH_FILE_ALIGN - 1) / MESH_FILE_ALIGN * MESH_FILE_ALIGN;
+}
+
+/* The buffer objects of a mesh file and what it takes to draw them, see
+* MeshFile::createBuffers. */
+typedef struct {
+	GLuint vertexBuffer, indexBuffer;
+	GLuint meshletBuffer;	/* the MeshFileMeshlets, 0 if there are none */
+	VertexLayout layout;
+	GLsizei indexCount;
+	GLenum indexType;
+	GLfloat radius;		/* of the bounding sphere around the origin */
+	MeshLod lods[MESH_LOD_MAX];
+	int lodCount;
+	GLuint meshletCount;
+} MeshBuffers;
+
+typedef struct {
+	const MeshFileHeader *header;
+	VertexLayout layout;		/* of the vertices, named "file" */
+	const void *vertices;		/* all of these point into the mapping */
+	const void *indices;
+	const MeshFileMeshlet *meshlets;	/* NULL if there are none */
+	void *map;
+	GLuint64 size;
+	AssetData asset;	/* map, if it came from the asset archive */
+#ifdef WIN32
+	HANDLE mapping;
+#endif
+
+	/* Check that the mapped file is a mesh we can use and set up the
+	* pointers into it. Returns false if it is not. */
+	bool parse(const char *filename)
+	{
+		GLuint i, indexSize;
+		const MeshFileHeader *h = (const MeshFileHeader*)map;
+
+		if (size < sizeof(MeshFileHeader) || h->magic != MESH_FILE_MAGIC) {
+			warn("'%s' is not a mesh file", filename);
+			return false;
+		}
+		if (h->version != MESH_FILE_VERSION) {
+			warn("mesh file '%s' has version %u, expected %u", filename, h->version, MESH_FILE_VERSION);
+			return false;
+		}
+		indexSize = meshFileIndexSize((GLenum)h->indexType);
+		if (!h->stride || h->attribCount > VERTEX_LAYOUT_MAX_ATTRIBS || !indexSize) {
+			warn("mesh file '%s' has an unsupported layout", filename);
+			return false;
+		}
+		/* the counts are 32 bit, so none of these products overflow */
+		if ((h->vertexOffset | h->indexOffset | h->meshletOffset) % MESH_FILE_ALIGN ||
+			h->vertexOffset + (GLuint64)h->stride * h->vertexCount > size ||
+			h->indexOffset + (GLuint64)indexSize * h->indexCount > size ||
+			h->meshletOffset + (GLuint64)sizeof(MeshFileMeshlet) * h->meshletCount > size) {
+			warn("mesh file '%s' is truncated", filename);
+			return false;
+		}
+
+		layout.name = "file";
+		layout.stride = (GLsizei)h->stride;
+		layout.attribCount = (int)h->attribCount;
+		for (i = 0; i < h->attribCount; i++) {
+			const MeshFileAttrib *a = &h->attribs[i];
+			if (a->location >= VERTEX_LAYOUT_MAX_ATTRIBS || a->offset >= h->stride) {
+				warn("mesh file '%s' has an invalid attribute %u", filename, i);
+				return false;
+			}
+			layout.attribs[i].location = a->location;
+			layout.attribs[i].size = (GLint)a->size;
+			layout.attribs[i].type = (GLenum)a->type;
+			layout.attribs[i].normalized = a->normalized ? GL_TRUE : GL_FALSE;
+			layout.attribs[i].offset = a->offset;
+		}
+		if (!h->lodCount || h->lodCount > MESH_LOD_MAX) {
+			warn("mesh file '%s' has %u levels of detail", filename, h->lodCount);
+			return false;
+		}
+		for (i = 0; i < h->lodCount; i++) {
+			if ((GLuint64)h->lods[i].firstIndex + h->lods[i].indexCount > h->indexCount) {
+				warn("mesh file '%s' has an invalid level of detail %u", filename, i);
+				return false;
+			}
+		}
+		for (i = 0; i < h->meshletCount; i++) {
+			const MeshFileMeshlet *m = (const MeshFileMeshlet*)((const GLubyte*)map + h->meshletOffset) + i;
+			if ((GLuint64)m->firstIndex + m->indexCount > h->lods[0].firstIndex + h->lods[0].indexCount) {
+				warn("mesh file '%s' has an invalid meshlet %u", filename, i);
+				return false;
+			}
+		}
+		/* the indices themselves are trusted, checking them would mean
+		* reading all of them */
+		header = h;
+		vertices = (const GLubyte*)map + h->vertexOffset;
+		indices = (const GLubyte*)map + h->indexOffset;
+		meshlets = h->meshletCount ? (const MeshFileMeshlet*)((const GLubyte*)map + h->meshletOffset) : NULL;
+		return true;
+	}
+
+	/* Map the file filename, outside of the asset archive.
+	* Returns true if successfull and false in case of an error. */
+	bool mapFile(const char *filename)
+	{
+		GLuint64 mtime;
+
+		if (!shaderSourceStat(filename, &mtime, &size)) {
+			warn("failed to open mesh file '%s'", filename);
+			return false;
+		}
+		if (size < sizeof(MeshFileHeader) || size > (GLuint64)(size_t)-1) {
+			warn("'%s' is not a mesh file", filename);
+			return false;
+		}
+#ifdef WIN32
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			warn("failed to open mesh file '%s'", filename);
+			return false;
+		}
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (mapping)
+			map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+		if (!map) {
+			if (mapping)
+				CloseHandle(mapping);
+			warn("failed to map mesh file '%s'", filename);
+			return false;
+		}
+#else
+		int fd = ::open(filename, O_RDONLY);
+		if (fd < 0) {
+			warn("failed to open mesh file '%s'", filename);
+			return false;
+		}
+		void *m = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (m == MAP_FAILED) {
+			warn("failed to map mesh file '%s'", filename);
+			return false;
+		}
+		/* the blobs are read once, front to back */
+		madvise(m, (size_t)size, MADV_SEQUENTIAL);
+		map = m;
+#endif
+		return true;
+	}
+
+	/* Map filename, or find it in the asset archive. The pointers stay
+	* valid until close().
+	* Returns true if successfull and false in case of an error. */
+	bool open(const char *filename)
+	{
+		header = NULL;
+		vertices = indices = NULL;
+		meshlets = NULL;
+		map = NULL;
+		asset.data = NULL;
+		asset.owned = NULL;
+		if (assetArchive()->read(filename, &asset)) {
+			map = (void*)asset.data;
+			size = asset.size;
+		} else if (!mapFile(filename)) {
+			return false;
+		}
+		if (!parse(filename)) {
+			close();
+			return false;
+		}
+		info("mesh file '%s': %u vertices of %u bytes, %u indices in %u levels of detail, %u meshlets", filename,
+			header->vertexCount, header->stride, header->indexCount, header->lodCount, header->meshletCount);
+		return true;
+	}
+
+	/* Use the mesh file filename which was read into data, of bytes
+	* bytes, which stays as it is until close(); close() leaves it alone.
+	* Returns true if successfull and false if it is not a mesh file. */
+	bool openMemory(const char *filename, const void *data, GLuint64 bytes)
+	{
+		header = NULL;
+		vertices = indices = NULL;
+		meshlets = NULL;
+		asset.data = (const GLubyte*)data;
+		asset.owned = NULL;
+		asset.size = bytes;
+		map = (void*)data;
+		size = bytes;
+		if (!parse(filename)) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close()
+	{
+		if (asset.data) {
+			assetDataRelease(&asset);
+		} else if (map) {
+#ifdef WIN32
+			UnmapViewOfFile(map);
+			CloseHandle(mapping);
+#else
+			munmap(map, (size_t)size);
+#endif
+		}
+		map = NULL;
+		header = NULL;
+		vertices = indices = NULL;
+		meshlets = NULL;
+	}
+
+	/* Create the vertex, index and meshlet buffers from the mapping, or
+	* if source is given, by copies on the GPU from that buffer, which holds
+	* the file at offset 0. The file may be closed afterwards. */
+	void createBuffers(MeshBuffers *b, GLuint source = 0) const
+	{
+		b->vertexBuffer = createBuffer(GL_ARRAY_BUFFER, (GLsizeiptr)header->stride * header->vertexCount, vertices,
+			source, "mesh file vertices");
+		b->indexBuffer = createBuffer(GL_ELEMENT_ARRAY_BUFFER,
+			(GLsizeiptr)meshFileIndexSize((GLenum)header->indexType) * header->indexCount, indices, source,
+			"mesh file indices");
+		/* bound as a storage buffer only when it is used */
+		b->meshletBuffer = meshlets ?
+			createBuffer(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(MeshFileMeshlet) * header->meshletCount, meshlets,
+				source, "mesh file meshlets") : 0;
+		b->layout = layout;
+		b->indexCount = (GLsizei)header->indexCount;
+		b->indexType = (GLenum)header->indexType;
+		b->radius = originRadius();
+		memcpy(b->lods, header->lods, sizeof(b->lods));
+		b->lodCount = (int)header->lodCount;
+		b->meshletCount = header->meshletCount;
+		GL_ERROR_DBG("mesh file buffers");
+	}
+
+	GLuint createBuffer(GLenum target, GLsizeiptr bytes, const void *data, GLuint source, const char *label) const
+	{
+		if (!source)
+			return meshBufferCreate(target, bytes, data, label);
+		GLuint buffer = meshBufferCreate(target, bytes, NULL, label);
+		GLintptr offset = (GLintptr)((const GLubyte*)data - (const GLubyte*)map);
+		if (directStateAccessSupported()) {
+			glCopyNamedBufferSubData(source, buffer, offset, 0, bytes);
+			return buffer;
+		}
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, source);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, 0, bytes);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return buffer;
+	}
+
+	/* The radius of the bounding sphere around the origin of the mesh. */
+	GLfloat originRadius() const
+	{
+		return glm::length(glm::vec3(header->center[0], header->center[1], header->center[2])) + header->radius;
+	}
+} MeshFile;
+
+/* Write zero bytes to file until it is at offset. */
+static bool meshFilePad(FILE *file, GLuint64 offset)
+{
+	static const GLubyte zero[MESH_FILE_ALIGN] = { 0 };
+	long pos = ftell(file);
+	if (pos < 0 || (GLuint64)pos > offset)
+		return false;
+	return fwrite(zero, 1, (size_t)(offset - (GLuint64)pos), file) == (size_t)(offset - (GLuint64)pos);
+}
+
+/* Write a mesh file: vertexCount vertices in layout, indexCount indices of
+* indexType in lodCount levels of detail lods, and meshletCount meshlets of
+* level 0. lods and meshlets may be NULL if there are none, then all
+* indices are the only level. sphere is the bounding sphere (center,
+* radius) of the vertices.
+* Returns true if successfull and false in case of an error. */
+static bool meshFileWrite(const char *filename, const VertexLayout *layout, const void *vertices, GLuint vertexCount,
+	const void *indices, GLuint indexCount, GLenum indexType, const MeshFileMeshlet *meshlets, GLuint meshletCount,
+	const MeshLod *lods, int lodCount, const glm::vec4 &sphere)
+{
+	MeshFileHeader h;
+	GLuint i, indexSize = meshFileIndexSize(indexType);
+	FILE *file;
+	bool ok;
+
+	if (!indexSize || layout->attribCount > VERTEX_LAYOUT_MAX_ATTRIBS || lodCount > MESH_LOD_MAX) {
+		warn("mesh file '%s': unsupported layout", filename);
+		return false;
+	}
+	memset(&h, 0, sizeof(h));
+	h.magic = MESH_FILE_MAGIC;
+	h.version = MESH_FILE_VERSION;
+	h.stride = (GLuint)layout->stride;
+	h.attribCount = (GLuint)layout->attribCount;
+	for (i = 0; i < h.attribCount; i++) {
+		const VertexAttribDesc *a = &layout->attribs[i];
+		h.attribs[i].location = a->location;
+		h.attribs[i].size = (GLuint)a->size;
+		h.attribs[i].type = (GLuint)a->type;
+		h.attribs[i].normalized = a->normalized;
+		h.attribs[i].offset = a->offset;
+	}
+	h.vertexCount = vertexCount;
+	h.indexCount = indexCount;
+	h.indexType = (GLuint)indexType;
+	h.meshletCount = meshletCount;
+	h.vertexOffset = meshFileAlign(sizeof(h));
+	h.indexOffset = meshFileAlign(h.vertexOffset + (GLuint64)h.stride * vertexCount);
+	h.meshletOffset = meshFileAlign(h.indexOffset + (GLuint64)indexSize * indexCount);
+	h.center[0] = sphere.x;
+	h.center[1] = sphere.y;
+	h.center[2] = sphere.z;
+	h.radius = sphere.w;
+	if (lods && lodCount > 0) {
+		h.lodCount = (GLuint)lodCount;
+		memcpy(h.lods, lods, sizeof(MeshLod) * lodCount);
+	} else {
+		h.lodCount = 1;
+		h.lods[0].indexCount = indexCount;
+	}
+
+	file = fopen(filename, "wb");
+	if (!file) {
+		warn("failed to write mesh file '%s'", filename);
+		return false;
+	}
+	ok = fwrite(&h, sizeof(h), 1, file) == 1 &&
+		meshFilePad(file, h.vertexOffset) &&
+		fwrite(vertices, h.stride, vertexCount, file) == vertexCount &&
+		meshFilePad(file, h.indexOffset) &&
+		fwrite(indices, indexSize, indexCount, file) == indexCount &&
+		meshFilePad(file, h.meshletOffset) &&
+		(!meshletCount || fwrite(meshlets, sizeof(MeshFileMeshlet), meshletCount, file) == meshletCount);
+	if (fclose(file) || !ok) {
+		warn("failed to write mesh file '%s'", filename);
+		return false;
+	}
+	info("wrote mesh file '%s' with %u %s vertices, %u indices in %u levels of detail, %u meshlets", filename,
+		vertexCount, layout->name, indexCount, h.lodCount, meshletCount);
+	return true;
+}
+
+/* Write the count vertices v and indexCount indices idx stored in layout
+* as a mesh file without meshlets, with a single level of detail.
+* Returns true if successfull and false in case of an error. */
+static bool meshFileWriteVertices(const char *filename, const VertexLayout *layout, const Vertex *v, GLsizei count,
+	const GLushort *idx, GLsizei indexCount)
+{
+	GLsizei i;
+	glm::vec3 lo(0.0f), hi(0.0f);
+	float radius = 0.0f;
+
+	void *data = malloc((size_t)layout->stride * (count ? count : 1));
+	if (!data) {
+		warn("failed to allocate %u vertices", (unsigned)count);
+		return false;
+	}
+	vertexLayoutFill(layout, v, count, idx, indexCount, data);
+	/* the sphere around the center of the bounding box */
+	for (i = 0; i < count; i++) {
+		glm::vec3 p(v[i].pos[0], v[i].pos[1], v[i].pos[2]);
+		lo = i ? glm::min(lo, p) : p;
+		hi = i ? glm::max(hi, p) : p;
+	}
+	glm::vec3 center = 0.5f * (lo + hi);
+	for (i = 0; i < count; i++)
+		radius = glm::max(radius, glm::length(glm::vec3(v[i].pos[0], v[i].pos[1], v[i].pos[2]) - center));
+	bool ok = meshFileWrite(filename, layout, data, (GLuint)count, idx, (GLuint)indexCount, GL_UNSIGNED_SHORT,
+		NULL, 0, NULL, 0, glm::vec4(center, radius));
+	free(data);
+	return ok;
+}
+
+#endif
@@ -0,0 +1,427 @@
+#ifndef HEADER_MESHOPTIMIZER_H
+#define HEADER_MESHOPTIMIZER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Cube.h"
+#include "MeshFile.h"
+#include "Meshlets.h"
+#include "MeshSimplifier.h"
+
+/****************************************************************************
+* MESH OPTIMIZER                                                           *
+****************************************************************************/
+
+/* Offline reordering of a triangle mesh for the GPU, in three steps:
+*  1. vertex cache: the triangles are reordered with Tipsify (Sander, Nehab
+*     and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+*     Overdraw", 2007), which fans around recently used vertices so their
+*     transformed results are still in the post-transform cache. It runs
+*     in linear time.
+*  2. overdraw: the Tipsify order is cut into clusters where it restarts
+*     on cold vertices (a triangle with three cache misses), and the
+*     clusters are sorted so those facing out of the mesh are drawn first;
+*     they tend to occlude the rest. Clusters start cold anyway, so this
+*     costs next to nothing in cache efficiency.
+*  3. vertex fetch: the vertices are renumbered in the order the triangles
+*     first use them, so fetching them walks the vertex buffer front to
+*     back. Unused vertices are dropped.
+* Then the triangles are split into meshlets (see Meshlets.h), which works
+* best on the final order, and simplified into levels of detail (see
+* MeshSimplifier.h), which only reference vertices of the full mesh and get
+* their own vertex cache order.
+* The efficiency is measured on a simulated FIFO cache of MESH_CACHE_SIZE
+* entries as ACMR (cache misses per triangle, 0.5 is ideal for big regular
+* meshes, 3 the worst) and ATVR (misses per vertex, 1 is ideal). */
+#define MESH_CACHE_SIZE 16
+
+typedef struct {
+	float acmr;	/* average cache miss ratio: misses per triangle */
+	float atvr;	/* average transform to vertex ratio: misses per vertex */
+} MeshCacheStats;
+
+/* Simulate drawing the indexCount indices idx of triangles of vertexCount
+* vertices through a FIFO cache of cacheSize entries. */
+static MeshCacheStats meshCacheStats(const GLuint *idx, GLuint indexCount, GLuint vertexCount, int cacheSize)
+{
+	MeshCacheStats stats = { 0.0f, 0.0f };
+	GLuint i, misses = 0, time = (GLuint)cacheSize + 1;
+	/* the time a vertex entered the cache; in a FIFO, it is still there
+	* if fewer than cacheSize others entered since */
+	GLuint *entered = (GLuint*)calloc(vertexCount ? vertexCount : 1, sizeof(GLuint));
+
+	if (!entered || indexCount < 3) {
+		free(entered);
+		return stats;
+	}
+	for (i = 0; i < indexCount; i++) {
+		GLuint v = idx[i];
+		if (time - entered[v] > (GLuint)cacheSize) {
+			entered[v] = time++;
+			misses++;
+		}
+	}
+	stats.acmr = (float)misses / (float)(indexCount / 3);
+	stats.atvr = vertexCount ? (float)misses / (float)vertexCount : 0.0f;
+	free(entered);
+	return stats;
+}
+
+/* Reorder the triangles of idx in place with Tipsify for a cache of
+* cacheSize entries.
+* Returns true if successfull and false in case of an error. */
+static bool meshOptimizeVertexCache(GLuint *idx, GLuint indexCount, GLuint vertexCount, int cacheSize)
+{
+	MeshAdjacency adj;
+	GLuint i, j, time = (GLuint)cacheSize + 1, cursor = 0, out = 0, deadEndCount = 0;
+	GLuint triangleCount = indexCount / 3;
+	GLuint *live = (GLuint*)malloc(sizeof(GLuint) * (vertexCount ? vertexCount : 1));
+	GLuint *entered = (GLuint*)calloc(vertexCount ? vertexCount : 1, sizeof(GLuint));
+	GLuint *deadEnd = (GLuint*)malloc(sizeof(GLuint) * (indexCount ? indexCount : 1));
+	GLuint *candidates = (GLuint*)malloc(sizeof(GLuint) * (indexCount ? indexCount : 1));
+	GLuint *result = (GLuint*)malloc(sizeof(GLuint) * (indexCount ? indexCount : 1));
+	bool *emitted = (bool*)calloc(triangleCount ? triangleCount : 1, sizeof(bool));
+	bool ok = meshAdjacencyBuild(&adj, idx, indexCount, vertexCount) &&
+		live && entered && deadEnd && candidates && result && emitted;
+	int fan = vertexCount && indexCount ? (int)idx[0] : -1;
+
+	if (!ok) {
+		warn("mesh optimizer: failed to allocate %u triangles", (unsigned)triangleCount);
+		fan = -1;
+	}
+	for (i = 0; ok && i < vertexCount; i++)
+		live[i] = adj.offsets[i + 1] - adj.offsets[i];
+
+	while (fan >= 0) {
+		GLuint candidateCount = 0;
+
+		/* emit all remaining triangles around the fanning vertex */
+		for (i = adj.offsets[fan]; i < adj.offsets[fan + 1]; i++) {
+			GLuint t = adj.triangles[i];
+			if (emitted[t])
+				continue;
+			for (j = 0; j < 3; j++) {
+				GLuint v = idx[3 * t + j];
+				result[out++] = v;
+				deadEnd[deadEndCount++] = v;
+				candidates[candidateCount++] = v;
+				live[v]--;
+				if (time - entered[v] > (GLuint)cacheSize)
+					entered[v] = time++;
+			}
+			emitted[t] = true;
+		}
+
+		/* continue with the candidate which is still in the cache after
+		* its remaining triangles are emitted, and has been in it longest */
+		int best = -1, bestPriority = -1;
+		for (i = 0; i < candidateCount; i++) {
+			GLuint v = candidates[i];
+			if (!live[v])
+				continue;
+			int priority = 0;
+			if (time - entered[v] + 2 * live[v] <= (GLuint)cacheSize)
+				priority = (int)(time - entered[v]);
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = (int)v;
+			}
+		}
+		if (best < 0) {
+			/* dead end: the most recent vertex with triangles left, or
+			* the next one in input order */
+			while (deadEndCount && best < 0) {
+				GLuint v = deadEnd[--deadEndCount];
+				if (live[v])
+					best = (int)v;
+			}
+			while (best < 0 && cursor < vertexCount) {
+				if (live[cursor])
+					best = (int)cursor;
+				cursor++;
+			}
+		}
+		fan = best;
+	}
+	if (ok)
+		memcpy(idx, result, sizeof(GLuint) * out);
+
+	meshAdjacencyDestroy(&adj);
+	free(live);
+	free(entered);
+	free(deadEnd);
+	free(candidates);
+	free(result);
+	free(emitted);
+	return ok;
+}
+
+/* a run of triangles of the Tipsify order, see meshOptimizeOverdraw */
+typedef struct {
+	GLuint first, count;	/* triangles */
+	float sortKey;
+} MeshCluster;
+
+static int meshClusterCompare(const void *a, const void *b)
+{
+	float ka = ((const MeshCluster*)a)->sortKey, kb = ((const MeshCluster*)b)->sortKey;
+	return (ka > kb) ? -1 : (ka < kb) ? 1 : 0;
+}
+
+/* Reorder the clusters of the vertex cache optimized indices idx so those
+* facing out of the mesh come first. positions are the vertex positions.
+* Returns true if successfull and false in case of an error. */
+static bool meshOptimizeOverdraw(GLuint *idx, GLuint indexCount, const glm::vec3 *positions, GLuint vertexCount,
+	int cacheSize)
+{
+	GLuint i, t, time = (GLuint)cacheSize + 1, clusterCount = 0;
+	GLuint triangleCount = indexCount / 3;
+	GLuint *entered = (GLuint*)calloc(vertexCount ? vertexCount : 1, sizeof(GLuint));
+	MeshCluster *clusters = (MeshCluster*)malloc(sizeof(MeshCluster) * (triangleCount ? triangleCount : 1));
+	GLuint *result = (GLuint*)malloc(sizeof(GLuint) * (indexCount ? indexCount : 1));
+	glm::vec3 center(0.0f);
+	float area = 0.0f;
+
+	if (!entered || !clusters || !result) {
+		warn("mesh optimizer: failed to allocate %u triangles", (unsigned)triangleCount);
+		free(entered);
+		free(clusters);
+		free(result);
+		return false;
+	}
+
+	/* cut where a triangle misses the cache with all its vertices */
+	for (t = 0; t < triangleCount; t++) {
+		int misses = 0;
+		for (i = 0; i < 3; i++) {
+			GLuint v = idx[3 * t + i];
+			if (time - entered[v] > (GLuint)cacheSize) {
+				entered[v] = time++;
+				misses++;
+			}
+		}
+		if (misses == 3 || !clusterCount) {
+			clusters[clusterCount].first = t;
+			clusters[clusterCount].count = 0;
+			clusterCount++;
+		}
+		clusters[clusterCount - 1].count++;
+	}
+
+	/* the area weighted centroid of the mesh */
+	for (t = 0; t < triangleCount; t++) {
+		const glm::vec3 &a = positions[idx[3 * t]], &b = positions[idx[3 * t + 1]], &c = positions[idx[3 * t + 2]];
+		float w = glm::length(glm::cross(b - a, c - a));
+		center += w * (a + b + c) / 3.0f;
+		area += w;
+	}
+	if (area > 0.0f)
+		center /= area;
+
+	/* how much each cluster faces out: its centroid's distance from the
+	* mesh centroid along its average normal */
+	for (i = 0; i < clusterCount; i++) {
+		MeshCluster *c = &clusters[i];
+		glm::vec3 centroid(0.0f), normal(0.0f);
+		float w = 0.0f;
+		for (t = c->first; t < c->first + c->count; t++) {
+			const glm::vec3 &p0 = positions[idx[3 * t]], &p1 = positions[idx[3 * t + 1]], &p2 = positions[idx[3 * t + 2]];
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float a = glm::length(n);
+			centroid += a * (p0 + p1 + p2) / 3.0f;
+			normal += n;
+			w += a;
+		}
+		if (w > 0.0f)
+			centroid /= w;
+		if (glm::dot(normal, normal) > 0.0f)
+			normal = glm::normalize(normal);
+		c->sortKey = glm::dot(centroid - center, normal);
+	}
+	qsort(clusters, clusterCount, sizeof(MeshCluster), meshClusterCompare);
+
+	GLuint out = 0;
+	for (i = 0; i < clusterCount; i++) {
+		memcpy(result + out, idx + 3 * clusters[i].first, sizeof(GLuint) * 3 * clusters[i].count);
+		out += 3 * clusters[i].count;
+	}
+	memcpy(idx, result, sizeof(GLuint) * out);
+	free(entered);
+	free(clusters);
+	free(result);
+	return true;
+}
+
+/* Renumber the vertices in the order idx uses them first and move the
+* vertexCount vertices of stride bytes accordingly, from src to dst. The
+* unused vertices are dropped.
+* Returns the new number of vertices, or 0 in case of an error. */
+static GLuint meshOptimizeVertexFetch(GLuint *idx, GLuint indexCount, const void *src, void *dst, GLuint vertexCount,
+	GLuint stride)
+{
+	GLuint i, count = 0;
+	GLuint *remap = (GLuint*)malloc(sizeof(GLuint) * (vertexCount ? vertexCount : 1));
+
+	if (!remap) {
+		warn("mesh optimizer: failed to allocate %u vertices", (unsigned)vertexCount);
+		return 0;
+	}
+	memset(remap, 0xff, sizeof(GLuint) * vertexCount);
+	for (i = 0; i < indexCount; i++) {
+		GLuint v = idx[i];
+		if (remap[v] == 0xffffffffu) {
+			remap[v] = count;
+			memcpy((GLubyte*)dst + (size_t)stride * count, (const GLubyte*)src + (size_t)stride * v, stride);
+			count++;
+		}
+		idx[i] = remap[v];
+	}
+	free(remap);
+	return count;
+}
+
+/* Read the position of the vertex at v in layout, if it is stored as at
+* least three floats or half floats. Returns false if it is not. */
+static bool vertexLayoutPosition(const VertexLayout *layout, const void *v, glm::vec3 *pos)
+{
+	int i;
+	for (i = 0; i < layout->attribCount; i++) {
+		const VertexAttribDesc *a = &layout->attribs[i];
+		const GLubyte *p = (const GLubyte*)v + a->offset;
+		if (a->location != VERTEX_ATTRIB_POS || a->size < 3)
+			continue;
+		if (a->type == GL_FLOAT) {
+			GLfloat f[3];
+			memcpy(f, p, sizeof(f));
+			*pos = glm::vec3(f[0], f[1], f[2]);
+			return true;
+		}
+		if (a->type == GL_HALF_FLOAT) {
+			GLushort h[3];
+			memcpy(h, p, sizeof(h));
+			*pos = glm::vec3(glm::unpackHalf1x16(h[0]), glm::unpackHalf1x16(h[1]), glm::unpackHalf1x16(h[2]));
+			return true;
+		}
+	}
+	return false;
+}
+
+/* the result of meshOptimizeFile */
+typedef struct {
+	GLuint vertexCount, triangleCount;
+	MeshCacheStats before, after;
+	bool overdraw;		/* the clusters were reordered */
+	GLuint meshletCount;	/* 0 without float positions */
+	int lodCount;		/* 1 without float positions */
+	float lodError;		/* of the coarsest level */
+} MeshOptimizeReport;
+
+/* The steps of meshOptimizeFile on the mesh in file, with idx holding its
+* indexCount indices, into the scratch space of the same sizes; idx and
+* indices have room for twice the indices for the levels of detail, and
+* meshlets for one per triangle. */
+static bool meshOptimizeMesh(const MeshFile *file, const char *out, GLuint *idx, GLuint indexCount,
+	glm::vec3 *positions, void *vertices, void *indices, MeshFileMeshlet *meshlets, MeshOptimizeReport *report)
+{
+	const MeshFileHeader *h = file->header;
+	GLuint i, vertexCount = h->vertexCount, first = h->lods[0].firstIndex;
+
+	/* the full mesh, the other levels are built again */
+	for (i = 0; i < indexCount; i++) {
+		idx[i] = h->indexType == GL_UNSIGNED_SHORT ? ((const GLushort*)file->indices)[first + i] :
+			((const GLuint*)file->indices)[first + i];
+		if (idx[i] >= vertexCount) {
+			warn("mesh optimizer: index %u is out of range", i);
+			return false;
+		}
+	}
+	report->triangleCount = indexCount / 3;
+	report->before = meshCacheStats(idx, indexCount, vertexCount, MESH_CACHE_SIZE);
+
+	if (!meshOptimizeVertexCache(idx, indexCount, vertexCount, MESH_CACHE_SIZE))
+		return false;
+	report->overdraw = true;
+	for (i = 0; i < vertexCount && report->overdraw; i++)
+		report->overdraw = vertexLayoutPosition(&file->layout, (const GLubyte*)file->vertices + (size_t)h->stride * i, &positions[i]);
+	if (!report->overdraw)
+		info("mesh optimizer: no float positions, keeping the overdraw order");
+	else if (!meshOptimizeOverdraw(idx, indexCount, positions, vertexCount, MESH_CACHE_SIZE))
+		return false;
+	vertexCount = meshOptimizeVertexFetch(idx, indexCount, file->vertices, vertices, vertexCount, h->stride);
+	if (!vertexCount && indexCount)
+		return false;
+	report->vertexCount = vertexCount;
+	report->after = meshCacheStats(idx, indexCount, vertexCount, MESH_CACHE_SIZE);
+
+	/* the positions of the renumbered vertices */
+	if (report->overdraw) {
+		for (i = 0; i < vertexCount; i++)
+			vertexLayoutPosition(&file->layout, (const GLubyte*)vertices + (size_t)h->stride * i, &positions[i]);
+		report->meshletCount = meshletBuild(idx, indexCount, positions, vertexCount, meshlets);
+	}
+
+	MeshLod lods[MESH_LOD_MAX];
+	memset(lods, 0, sizeof(lods));
+	lods[0].indexCount = indexCount;
+	report->lodCount = 1;
+	if (report->overdraw) {
+		report->lodCount = meshLodChain(idx, indexCount, 2 * indexCount, positions, vertexCount, lods);
+		if (!report->lodCount)
+			return false;
+	}
+	for (i = 1; i < (GLuint)report->lodCount; i++) {
+		if (!meshOptimizeVertexCache(idx + lods[i].firstIndex, lods[i].indexCount, vertexCount, MESH_CACHE_SIZE))
+			return false;
+	}
+	report->lodError = lods[report->lodCount - 1].error;
+	GLuint total = lods[report->lodCount - 1].firstIndex + lods[report->lodCount - 1].indexCount;
+
+	for (i = 0; i < total; i++) {
+		if (h->indexType == GL_UNSIGNED_SHORT)
+			((GLushort*)indices)[i] = (GLushort)idx[i];
+		else
+			((GLuint*)indices)[i] = idx[i];
+	}
+	return meshFileWrite(out, &file->layout, vertices, vertexCount, indices, total, (GLenum)h->indexType,
+		meshlets, report->meshletCount, lods, report->lodCount,
+		glm::vec4(h->center[0], h->center[1], h->center[2], h->radius));
+}
+
+/* Optimize the mesh in the mesh file in and write it to out. The vertex
+* layout and the index type stay the same. The meshlets and levels of
+* detail are built anew from the full mesh, the ones of in are dropped.
+* Returns true if successfull and false in case of an error. */
+static bool meshOptimizeFile(const char *in, const char *out, MeshOptimizeReport *report)
+{
+	MeshFile file;
+	bool ok = false;
+
+	memset(report, 0, sizeof(*report));
+	if (!file.open(in))
+		return false;
+	const MeshFileHeader *h = file.header;
+	GLuint indexCount = h->lods[0].indexCount / 3 * 3, vertexCount = h->vertexCount;
+	GLuint *idx = (GLuint*)malloc(sizeof(GLuint) * (2 * indexCount + 1));
+	glm::vec3 *positions = (glm::vec3*)malloc(sizeof(glm::vec3) * (vertexCount ? vertexCount : 1));
+	void *vertices = malloc((size_t)h->stride * (vertexCount ? vertexCount : 1));
+	void *indices = malloc((size_t)meshFileIndexSize((GLenum)h->indexType) * (2 * indexCount + 1));
+	MeshFileMeshlet *meshlets = (MeshFileMeshlet*)malloc(sizeof(MeshFileMeshlet) * (indexCount / 3 + 1));
+
+	if (!idx || !positions || !vertices || !indices || !meshlets)
+		warn("mesh optimizer: failed to allocate mesh '%s'", in);
+	else
+		ok = meshOptimizeMesh(&file, out, idx, indexCount, positions, vertices, indices, meshlets, report);
+	file.close();
+	free(idx);
+	free(positions);
+	free(vertices);
+	free(indices);
+	free(meshlets);
+	return ok;
+}
+
+#endif
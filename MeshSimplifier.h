@@ -0,0 +1,364 @@
+#ifndef HEADER_MESHSIMPLIFIER_H
+#define HEADER_MESHSIMPLIFIER_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Cube.h"
+
+/****************************************************************************
+* MESH SIMPLIFIER                                                          *
+****************************************************************************/
+
+/* The triangles around each vertex, as offsets into one list. */
+typedef struct {
+	GLuint *offsets;	/* vertexCount + 1 entries */
+	GLuint *triangles;
+} MeshAdjacency;
+
+static bool meshAdjacencyBuild(MeshAdjacency *a, const GLuint *idx, GLuint indexCount, GLuint vertexCount)
+{
+	GLuint i;
+
+	a->offsets = (GLuint*)calloc(vertexCount + 1, sizeof(GLuint));
+	a->triangles = (GLuint*)malloc(sizeof(GLuint) * (indexCount ? indexCount : 1));
+	if (!a->offsets || !a->triangles)
+		return false;
+	for (i = 0; i < indexCount; i++)
+		a->offsets[idx[i] + 1]++;
+	for (i = 0; i < vertexCount; i++)
+		a->offsets[i + 1] += a->offsets[i];
+	/* fill using offsets[v] as the cursor of v, which moves it to the
+	* start of v + 1; shift back afterwards */
+	for (i = 0; i < indexCount; i++)
+		a->triangles[a->offsets[idx[i]]++] = i / 3;
+	for (i = vertexCount; i > 0; i--)
+		a->offsets[i] = a->offsets[i - 1];
+	a->offsets[0] = 0;
+	return true;
+}
+
+static void meshAdjacencyDestroy(MeshAdjacency *a)
+{
+	free(a->offsets);
+	free(a->triangles);
+	a->offsets = a->triangles = NULL;
+}
+
+/* The simplifier removes triangles by collapsing edges: all triangles of
+* one vertex are moved onto a neighbour, and the two triangles of the edge
+* vanish (Garland and Heckbert, "Surface Simplification Using Quadric Error
+* Metrics", 1997). Each vertex has a quadric, the sum of the squared
+* distances to the planes of the original triangles around it, and the
+* collapse which moves a vertex least away from those planes goes first.
+* The vertices stay where they are and keep their attributes, a level of
+* detail only has fewer triangles, so all levels of a mesh share one vertex
+* buffer; the collapsed vertices are simply no longer referenced.
+* Vertices on an edge with only one triangle are locked: these are the
+* holes of the mesh as well as the seams where vertices are split for
+* their attributes (the flat shaded faces of the cube, the colors of the
+* pyramid), which would tear open otherwise. Collapses which flip a
+* triangle or would fold the surface onto itself are skipped.
+* Each pass collapses the cheapest edges of which no other collapse of the
+* pass touches a triangle, so passes repeat until the target is reached or
+* nothing can be collapsed any more. */
+#define MESH_LOD_RATIO 0.5f	/* triangles of a level relative to the one before */
+#define MESH_LOD_MIN_TRIANGLES 16	/* no levels below this */
+
+/* a symmetric 4x4 matrix in double precision: the plane distance quadric */
+typedef struct {
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+	double weight;		/* the area of the planes */
+} MeshQuadric;
+
+/* an edge collapse: u moves onto v */
+typedef struct {
+	GLuint u, v;
+	double cost;
+} MeshCollapse;
+
+static int meshCollapseCompare(const void *a, const void *b)
+{
+	double ca = ((const MeshCollapse*)a)->cost, cb = ((const MeshCollapse*)b)->cost;
+	return (ca < cb) ? -1 : (ca > cb) ? 1 : 0;
+}
+
+static int meshEdgeCompare(const void *a, const void *b)
+{
+	GLuint64 ea = *(const GLuint64*)a, eb = *(const GLuint64*)b;
+	return (ea < eb) ? -1 : (ea > eb) ? 1 : 0;
+}
+
+/* Add the plane through p with the normal n (of length 2 * area) to q. */
+static void meshQuadricAddPlane(MeshQuadric *q, const glm::vec3 &n, const glm::vec3 &p)
+{
+	double area = 0.5 * (double)glm::length(n);
+	if (area <= 0.0)
+		return;
+	glm::dvec3 m = glm::dvec3(n) / (2.0 * area);
+	double d = -glm::dot(m, glm::dvec3(p));
+	q->a2 += area * m.x * m.x; q->ab += area * m.x * m.y; q->ac += area * m.x * m.z; q->ad += area * m.x * d;
+	q->b2 += area * m.y * m.y; q->bc += area * m.y * m.z; q->bd += area * m.y * d;
+	q->c2 += area * m.z * m.z; q->cd += area * m.z * d;
+	q->d2 += area * d * d;
+	q->weight += area;
+}
+
+static void meshQuadricAdd(MeshQuadric *q, const MeshQuadric *r)
+{
+	q->a2 += r->a2; q->ab += r->ab; q->ac += r->ac; q->ad += r->ad;
+	q->b2 += r->b2; q->bc += r->bc; q->bd += r->bd;
+	q->c2 += r->c2; q->cd += r->cd;
+	q->d2 += r->d2;
+	q->weight += r->weight;
+}
+
+/* The area weighted sum of the squared distances of p to the planes of q. */
+static double meshQuadricError(const MeshQuadric *q, const glm::vec3 &p)
+{
+	double x = p.x, y = p.y, z = p.z;
+	double e = q->a2 * x * x + 2.0 * q->ab * x * y + 2.0 * q->ac * x * z + 2.0 * q->ad * x +
+		q->b2 * y * y + 2.0 * q->bc * y * z + 2.0 * q->bd * y +
+		q->c2 * z * z + 2.0 * q->cd * z + q->d2;
+	return e > 0.0 ? e : 0.0;
+}
+
+typedef struct {
+	const glm::vec3 *positions;
+	GLuint vertexCount;
+	GLuint *idx;		/* the triangles left */
+	GLuint indexCount;
+	MeshQuadric *quadrics;	/* per vertex */
+	bool *locked;		/* per vertex, never moved */
+	GLuint *remap;		/* per vertex, scratch space of a pass */
+	GLuint *stamp;		/* per vertex, scratch space of collapseValid */
+	GLuint mark;		/* the next unused stamp */
+	bool *touched;		/* per vertex, a collapse of this pass changed it */
+	MeshCollapse *collapses;	/* per index, scratch space of a pass */
+	float error;		/* the largest distance moved so far */
+
+	/* Start simplifying the indexCount indices indices of triangles of
+	* vertexCount vertices at positions, which must stay valid until
+	* destroy().
+	* Returns true if successfull and false in case of an error. */
+	bool init(const GLuint *indices, GLuint count, const glm::vec3 *p, GLuint vertices)
+	{
+		GLuint i, j, edgeCount = 0;
+
+		positions = p;
+		vertexCount = vertices;
+		indexCount = count / 3 * 3;
+		error = 0.0f;
+		idx = (GLuint*)malloc(sizeof(GLuint) * (indexCount ? indexCount : 1));
+		quadrics = (MeshQuadric*)calloc(vertexCount ? vertexCount : 1, sizeof(MeshQuadric));
+		locked = (bool*)calloc(vertexCount ? vertexCount : 1, sizeof(bool));
+		remap = (GLuint*)malloc(sizeof(GLuint) * (vertexCount ? vertexCount : 1));
+		stamp = (GLuint*)calloc(vertexCount ? vertexCount : 1, sizeof(GLuint));
+		mark = 1;
+		touched = (bool*)malloc(sizeof(bool) * (vertexCount ? vertexCount : 1));
+		collapses = (MeshCollapse*)malloc(sizeof(MeshCollapse) * (indexCount ? indexCount : 1));
+		/* the edges, the smaller vertex in the upper half */
+		GLuint64 *edges = (GLuint64*)malloc(sizeof(GLuint64) * (indexCount ? indexCount : 1));
+		if (!idx || !quadrics || !locked || !remap || !stamp || !touched || !collapses || !edges) {
+			warn("mesh simplifier: failed to allocate %u vertices", (unsigned)vertexCount);
+			free(edges);
+			destroy();
+			return false;
+		}
+		memcpy(idx, indices, sizeof(GLuint) * indexCount);
+
+		for (i = 0; i < indexCount; i += 3) {
+			const glm::vec3 &a = positions[idx[i]], &b = positions[idx[i + 1]], &c = positions[idx[i + 2]];
+			glm::vec3 n = glm::cross(b - a, c - a);
+			for (j = 0; j < 3; j++) {
+				GLuint v = idx[i + j], w = idx[i + (j + 1) % 3];
+				meshQuadricAddPlane(&quadrics[v], n, a);
+				if (v != w)
+					edges[edgeCount++] = ((GLuint64)glm::min(v, w) << 32) | glm::max(v, w);
+			}
+		}
+		/* lock the vertices of the edges which do not have exactly two
+		* triangles: holes, seams and non-manifold edges */
+		qsort(edges, edgeCount, sizeof(GLuint64), meshEdgeCompare);
+		for (i = 0; i < edgeCount; i = j) {
+			for (j = i + 1; j < edgeCount && edges[j] == edges[i]; j++)
+				;
+			if (j - i != 2) {
+				locked[edges[i] >> 32] = true;
+				locked[edges[i] & 0xffffffffu] = true;
+			}
+		}
+		free(edges);
+		return true;
+	}
+
+	void destroy()
+	{
+		free(idx);
+		free(quadrics);
+		free(locked);
+		free(remap);
+		free(stamp);
+		free(touched);
+		free(collapses);
+		idx = remap = stamp = NULL;
+		quadrics = NULL;
+		locked = touched = NULL;
+		collapses = NULL;
+		indexCount = 0;
+	}
+
+	/* Returns true if moving u onto v keeps the triangles around u facing
+	* the way they did and the surface a manifold. */
+	bool collapseValid(const MeshAdjacency *adj, GLuint u, GLuint v)
+	{
+		GLuint i, j, shared = 0;
+
+		for (i = adj->offsets[u]; i < adj->offsets[u + 1]; i++) {
+			const GLuint *t = &idx[3 * adj->triangles[i]];
+			if (t[0] == v || t[1] == v || t[2] == v)
+				continue;	/* vanishes */
+			glm::vec3 p[3], q[3];
+			for (j = 0; j < 3; j++) {
+				p[j] = positions[t[j]];
+				q[j] = (t[j] == u) ? positions[v] : p[j];
+			}
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			if (glm::dot(before, after) <= 0.0f)
+				return false;
+		}
+		/* an edge of a manifold has two triangles, so its ends share two
+		* neighbours; more would pinch the surface */
+		mark += 2;
+		for (i = adj->offsets[u]; i < adj->offsets[u + 1]; i++) {
+			const GLuint *t = &idx[3 * adj->triangles[i]];
+			for (j = 0; j < 3; j++)
+				stamp[t[j]] = mark;
+		}
+		for (i = adj->offsets[v]; i < adj->offsets[v + 1]; i++) {
+			const GLuint *t = &idx[3 * adj->triangles[i]];
+			for (j = 0; j < 3; j++) {
+				if (t[j] != u && t[j] != v && stamp[t[j]] == mark) {
+					stamp[t[j]] = mark + 1;
+					shared++;
+				}
+			}
+		}
+		return shared <= 2;
+	}
+
+	/* Collapse edges until at most targetIndexCount indices are left, or
+	* none can be collapsed any more.
+	* Returns true if successfull and false in case of an error. */
+	bool simplify(GLuint targetIndexCount)
+	{
+		GLuint i, j;
+
+		while (indexCount > targetIndexCount) {
+			MeshAdjacency adj;
+			GLuint collapseCount = 0, removed = 0, collapsed = 0;
+
+			if (!meshAdjacencyBuild(&adj, idx, indexCount, vertexCount)) {
+				warn("mesh simplifier: failed to allocate %u triangles", (unsigned)(indexCount / 3));
+				meshAdjacencyDestroy(&adj);
+				return false;
+			}
+			for (i = 0; i < indexCount; i += 3) {
+				for (j = 0; j < 3; j++) {
+					GLuint u = idx[i + j], v = idx[i + (j + 1) % 3];
+					/* the collapse of each edge is looked at from both of
+					* its triangles, in both directions */
+					if (locked[u] || u == v)
+						continue;
+					MeshQuadric q = quadrics[u];
+					meshQuadricAdd(&q, &quadrics[v]);
+					MeshCollapse *c = &collapses[collapseCount++];
+					c->u = u;
+					c->v = v;
+					c->cost = meshQuadricError(&q, positions[v]) / (q.weight > 0.0 ? q.weight : 1.0);
+				}
+			}
+			qsort(collapses, collapseCount, sizeof(MeshCollapse), meshCollapseCompare);
+
+			for (i = 0; i < vertexCount; i++)
+				remap[i] = i;
+			memset(touched, 0, sizeof(bool) * vertexCount);
+			for (i = 0; i < collapseCount && indexCount - 3 * removed > targetIndexCount; i++) {
+				const MeshCollapse *c = &collapses[i];
+				if (touched[c->u] || touched[c->v] || !collapseValid(&adj, c->u, c->v))
+					continue;
+				/* the triangles around u change, so nothing else may
+				* touch them in this pass */
+				for (j = adj.offsets[c->u]; j < adj.offsets[c->u + 1]; j++) {
+					const GLuint *t = &idx[3 * adj.triangles[j]];
+					touched[t[0]] = touched[t[1]] = touched[t[2]] = true;
+					removed += (t[0] == c->v || t[1] == c->v || t[2] == c->v);
+				}
+				remap[c->u] = c->v;
+				meshQuadricAdd(&quadrics[c->v], &quadrics[c->u]);
+				error = glm::max(error, (float)sqrt(c->cost));
+				collapsed++;
+			}
+			meshAdjacencyDestroy(&adj);
+			if (!collapsed)
+				break;
+
+			/* move the triangles and drop those which vanished */
+			GLuint out = 0;
+			for (i = 0; i < indexCount; i += 3) {
+				GLuint a = remap[idx[i]], b = remap[idx[i + 1]], c = remap[idx[i + 2]];
+				if (a == b || b == c || c == a)
+					continue;
+				idx[out++] = a;
+				idx[out++] = b;
+				idx[out++] = c;
+			}
+			indexCount = out;
+		}
+		return true;
+	}
+} MeshSimplifier;
+
+/* Build the levels of detail of a mesh of vertexCount vertices at
+* positions. The first indexCount indices of idx are level 0, the others
+* are appended after them, as long as they fit into the capacity indices
+* of idx; each has MESH_LOD_RATIO of the triangles of the one before,
+* down to MESH_LOD_MIN_TRIANGLES, as long as the simplifier gets there.
+* lods gets up to MESH_LOD_MAX levels.
+* Returns the number of levels, at least one, or 0 in case of an error. */
+static int meshLodChain(GLuint *idx, GLuint indexCount, GLuint capacity, const glm::vec3 *positions,
+	GLuint vertexCount, MeshLod *lods)
+{
+	MeshSimplifier s;
+	int count = 1;
+	GLuint end = indexCount;
+
+	memset(lods, 0, sizeof(MeshLod) * MESH_LOD_MAX);
+	lods[0].indexCount = indexCount;
+	if (!s.init(idx, indexCount, positions, vertexCount))
+		return 0;
+	while (count < MESH_LOD_MAX && s.indexCount / 3 > MESH_LOD_MIN_TRIANGLES) {
+		GLuint previous = s.indexCount;
+		GLuint target = (GLuint)((float)(previous / 3) * MESH_LOD_RATIO) * 3;
+		if (!s.simplify(glm::max(target, 3u * MESH_LOD_MIN_TRIANGLES))) {
+			s.destroy();
+			return 0;
+		}
+		/* stop when it gets stuck, a level must save something */
+		if (s.indexCount > previous - previous / 8 || end + s.indexCount > capacity)
+			break;
+		memcpy(idx + end, s.idx, sizeof(GLuint) * s.indexCount);
+		lods[count].firstIndex = end;
+		lods[count].indexCount = s.indexCount;
+		lods[count].error = s.error;
+		end += s.indexCount;
+		count++;
+	}
+	s.destroy();
+	return count;
+}
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef HEADER_MESHLETS_H
+#define HEADER_MESHLETS_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "MeshFile.h"
+#include "FrustumCuller.h"
+#include "Scene.h"
+
+/****************************************************************************
+* MESHLETS                                                                 *
+****************************************************************************/
+
+/* A big mesh is split into meshlets, clusters of up to MESHLET_MAX_VERTICES
+* vertices and MESHLET_MAX_TRIANGLES triangles (the sizes mesh shaders work
+* best with), which are consecutive triangles of the index buffer. Each has
+* a bounding sphere and a cone around the normals of its triangles (see
+* MeshFileMeshlet), so a compute pass can drop the clusters which are
+* outside of the frustum or face away from the camera before any of their
+* triangles reach the setup stage. The triangles should be in vertex cache
+* order first (see MeshOptimizer.h), then consecutive triangles share many
+* vertices and the meshlets are compact. */
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+/* below this, the normals of a meshlet spread too far for a cone */
+#define MESHLET_CONE_MIN_DOT 0.1f
+
+/* Compute the bounds of the meshlet m from its triangles in idx. */
+static void meshletBounds(MeshFileMeshlet *m, const GLuint *idx, const glm::vec3 *positions)
+{
+	GLuint i;
+	const GLuint *tri = idx + m->firstIndex;
+	glm::vec3 lo = positions[tri[0]], hi = lo, axis(0.0f);
+
+	for (i = 0; i < m->indexCount; i++) {
+		lo = glm::min(lo, positions[tri[i]]);
+		hi = glm::max(hi, positions[tri[i]]);
+	}
+	glm::vec3 center = 0.5f * (lo + hi);
+	float radius = 0.0f;
+	for (i = 0; i < m->indexCount; i++)
+		radius = glm::max(radius, glm::length(positions[tri[i]] - center));
+
+	/* the cone axis is the average direction of the triangle normals, its
+	* angle the largest between the axis and one of them */
+	for (i = 0; i < m->indexCount; i += 3) {
+		glm::vec3 n = glm::cross(positions[tri[i + 1]] - positions[tri[i]], positions[tri[i + 2]] - positions[tri[i]]);
+		if (glm::dot(n, n) > 0.0f)
+			axis += glm::normalize(n);
+	}
+	float minDot = -1.0f;
+	if (glm::dot(axis, axis) > 0.0f) {
+		axis = glm::normalize(axis);
+		minDot = 1.0f;
+		for (i = 0; i < m->indexCount; i += 3) {
+			glm::vec3 n = glm::cross(positions[tri[i + 1]] - positions[tri[i]], positions[tri[i + 2]] - positions[tri[i]]);
+			if (glm::dot(n, n) > 0.0f)
+				minDot = glm::min(minDot, glm::dot(glm::normalize(n), axis));
+		}
+	}
+
+	memcpy(m->center, &center[0], sizeof(m->center));
+	m->radius = radius;
+	memcpy(m->coneAxis, &axis[0], sizeof(m->coneAxis));
+	/* all triangles face away from any direction within 90 degrees minus
+	* the cone angle of the axis, so the cutoff is the sine of that angle */
+	m->coneCutoff = (minDot < MESHLET_CONE_MIN_DOT) ? 1.0f : glm::sqrt(1.0f - minDot * minDot);
+	m->pad[0] = m->pad[1] = 0;
+}
+
+/* Split the indexCount indices idx of triangles of vertexCount vertices
+* at positions into meshlets, in order. meshlets must have room for one
+* meshlet per triangle.
+* Returns the number of meshlets, 0 in case of an error. */
+static GLuint meshletBuild(const GLuint *idx, GLuint indexCount, const glm::vec3 *positions, GLuint vertexCount,
+	MeshFileMeshlet *meshlets)
+{
+	GLuint i, j, count = 0, vertices = 0;
+	/* the meshlet each vertex was last counted for, plus one */
+	GLuint *owner = (GLuint*)calloc(vertexCount ? vertexCount : 1, sizeof(GLuint));
+	MeshFileMeshlet *m = NULL;
+
+	if (!owner) {
+		warn("meshlets: failed to allocate %u vertices", (unsigned)vertexCount);
+		return 0;
+	}
+	for (i = 0; i + 2 < indexCount; i += 3) {
+		GLuint added = 0;
+		if (m) {
+			for (j = 0; j < 3; j++)
+				added += (owner[idx[i + j]] != count);
+		}
+		if (!m || vertices + added > MESHLET_MAX_VERTICES || m->indexCount >= 3 * MESHLET_MAX_TRIANGLES) {
+			m = &meshlets[count++];
+			m->firstIndex = i;
+			m->indexCount = 0;
+			vertices = 0;
+		}
+		for (j = 0; j < 3; j++) {
+			if (owner[idx[i + j]] != count) {
+				owner[idx[i + j]] = count;
+				vertices++;
+			}
+		}
+		m->indexCount += 3;
+	}
+	for (i = 0; i < count; i++)
+		meshletBounds(&meshlets[i], idx, positions);
+	free(owner);
+	return count;
+}
+
+/* MeshletCuller: culls the meshlets of the cube's mesh on the GPU, see
+* shaders/meshlet_cull.cs.glsl. The pass writes a draw command (an index
+* range) per visible meshlet and their number, which a single
+* glMultiDrawElementsIndirectCountARB draws. It needs compute shaders,
+* multi-draw indirect and GL_ARB_indirect_parameters.
+* GL_NV_mesh_shader would let a task shader do the same test and skip the
+* round trip through the command buffer, but our loader has no entry points
+* for it, so the compute path is used on all hardware. The meshlet buffer
+* is laid out as a task shader would read it. */
+#define MESHLET_CULL_SHADER "shaders/meshlet_cull.cs.glsl"
+#define MESHLET_CULL_GROUP_SIZE 64	/* local_size_x of the compute shader */
+
+typedef struct {
+	GLuint program;		/* 0 if not set up */
+	GLint planesLoc, cameraLoc, countLoc, radiusScaleLoc, conesLoc, indexBaseLoc;
+	GLuint meshletBuffer;	/* the MeshFileMeshlets */
+	GLuint visibleBuffer;	/* the commands of the visible meshlets */
+	GLuint counterBuffer;	/* atomic counter, the number of visible meshlets */
+	GLuint meshletCount;
+	GLenum indexType;
+	GLuint indexBase;	/* of the mesh in its index buffer, see Cube::indexBase */
+	bool culled;		/* cull() ran for this frame */
+
+	void clear()
+	{
+		program = meshletBuffer = visibleBuffer = counterBuffer = 0;
+		meshletCount = indexBase = 0;
+		culled = false;
+	}
+
+	/* Set up culling the count meshlets (MeshFileMeshlets) in buffer of a
+	* mesh with indices of type, the compute shader is loaded via cache.
+	* The culler owns buffer from now on, also if this fails.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache, GLuint buffer, GLuint count, GLenum type)
+	{
+		GLuint zero = 0;
+		MemoryScope scope(MEMORY_MESHES);
+
+		clear();
+		if (!count || !computeShaderSupported() || !glCaps()->drawIndirectCount) {
+			info("meshlets: culling is not supported");
+			glState()->deleteBuffers(1, &buffer);
+			return false;
+		}
+		program = computeProgramBuild(cache, MESHLET_CULL_SHADER);
+		if (!program) {
+			glState()->deleteBuffers(1, &buffer);
+			return false;
+		}
+		planesLoc = glGetUniformLocation(program, "planes");
+		cameraLoc = glGetUniformLocation(program, "cameraPosition");
+		countLoc = glGetUniformLocation(program, "meshletCount");
+		radiusScaleLoc = glGetUniformLocation(program, "radiusScale");
+		conesLoc = glGetUniformLocation(program, "cones");
+		indexBaseLoc = glGetUniformLocation(program, "indexBase");
+
+		meshletCount = count;
+		indexType = type;
+		meshletBuffer = buffer;
+		GLuint buffers[2];
+		glGenBuffers(2, buffers);
+		visibleBuffer = buffers[0];
+		counterBuffer = buffers[1];
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawElementsIndirectCommand) * count, NULL, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+		glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+		info("meshlets: culling %u meshlets with program %u", (unsigned)count, program);
+		GL_ERROR_DBG("meshlet culling initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program) {
+			glState()->deleteProgram(program);
+			program = 0;
+		}
+		if (meshletBuffer || visibleBuffer || counterBuffer) {
+			GLuint buffers[3] = { meshletBuffer, visibleBuffer, counterBuffer };
+			glState()->deleteBuffers(3, buffers);
+		}
+		clear();
+	}
+
+	/* Cull the meshlets of a mesh drawn with the model view projection
+	* matrix mvp, seen from camera in the space of the mesh; the next draw()
+	* only draws the visible ones. cones enables the back face test, which
+	* is only valid if the program culls back faces and keeps the vertices
+	* where they are. This uses its own program, so it must be called
+	* before the program for drawing is bound. */
+	void cull(const glm::mat4 &mvp, const glm::vec3 &camera, float radiusScale, bool cones)
+	{
+		GLuint zero = 0;
+		glm::vec4 planes[6];
+
+		culled = false;
+		if (!program)
+			return;
+		GL_DEBUG_GROUP("meshlet culling");
+		/* the planes of mvp are in the space of the mesh */
+		frustumPlanes(mvp, planes);
+
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+		glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+		glState()->useProgram(program);
+		glUniform4fv(planesLoc, 6, &planes[0][0]);
+		glUniform3fv(cameraLoc, 1, &camera[0]);
+		glUniform1ui(countLoc, meshletCount);
+		glUniform1f(radiusScaleLoc, radiusScale);
+		glUniform1i(conesLoc, cones);
+		glUniform1ui(indexBaseLoc, indexBase);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, meshletBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer);
+		glState()->bindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer);
+		glDispatchCompute((meshletCount + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, 1, 1);
+		glState()->useProgram(0);
+
+		/* the draw reads the commands and their count written above */
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+		culled = true;
+	}
+
+	/* Draw the visible meshlets. The VAO of the mesh must be bound, and
+	* cull() must have run this frame. */
+	void draw()
+	{
+		glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, visibleBuffer);
+		glState()->bindBuffer(GL_PARAMETER_BUFFER_ARB, counterBuffer);
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, indexType, 0, 0, meshletCount, 0);
+		glState()->countDraw();
+		glState()->bindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+		glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+} MeshletCuller;
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef HEADER_MIPDOWNSAMPLER_H
+#define HEADER_MIPDOWNSAMPLER_H
+
+#include <glad/glad.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* SINGLE-PASS MIP GENERATION                                               *
+****************************************************************************/
+
+/* MipDownsampler: builds the levels of a mip chain with a single compute
+* dispatch (shaders/downsample.cs.glsl), after AMD's single-pass
+* downsampler, instead of glGenerateMipmap or a pass per level with a
+* barrier in between. Every work group reduces a tile of 64x64 texels to
+* one in shared memory, writing MIP_TILE_LEVELS levels on the way, and the
+* last group to finish, which an atomic counter tells, takes the texels of
+* all groups through the rest of the levels. A dispatch writes as many
+* levels as there are image units for them: MIP_IMAGES_WIDE where the
+* context has that many, MIP_IMAGES (the minimum of GL 4.3) otherwise, and
+* a longer chain takes another dispatch from the last level written.
+* The texels are reduced to their minimum, their maximum (the Hi-Z pyramid,
+* see HiZ.h) or their average (the bloom chain of PostProcess.h and the
+* textures of Materials.h and Impostors.h), for GL_R32F, GL_R11F_G11F_B10F
+* and GL_RGBA8 textures with immutable storage. Texels beyond the source
+* repeat its edge. The levels within a tile halve exactly, so at an odd
+* size the last row or column only reaches the levels of the last group,
+* which cover it like shaders/hiz.cs.glsl; a chain which must not lose any
+* texel (the Hi-Z pyramid) pads its level 0 to a multiple of MIP_TILE.
+* The programs are built when first used. Without compute shaders, or with
+* --per-level-mips, available() is false and the callers build the levels
+* as before. */
+#define MIP_DOWNSAMPLE_CS "shaders/downsample.cs.glsl"
+#define MIP_TILE 64		/* source texels per side of a work group */
+#define MIP_TILE_LEVELS 6	/* levels a work group reduces its tile through */
+#define MIP_IMAGES 8		/* levels per dispatch, also in the shader */
+#define MIP_IMAGES_WIDE 12	/* with WIDE, where the context has the image units */
+#define MIP_COUNTER_BINDING 0	/* of the storage block "MipCounter", also in the shader */
+
+/* how the texels of a level are reduced */
+enum {
+	MIP_AVERAGE = 0,
+	MIP_MIN,
+	MIP_MAX,
+	MIP_REDUCTIONS
+};
+
+/* the formats of the images */
+enum {
+	MIP_FORMAT_RGBA8 = 0,
+	MIP_FORMAT_R32F,
+	MIP_FORMAT_R11F_G11F_B10F,
+	MIP_FORMATS
+};
+
+/* the feature defines of the shader */
+static const char *const mipDefines[] = { "MIN", "MAX", "FORMAT_R32F", "FORMAT_R11F_G11F_B10F", "COPY", "WIDE" };
+#define MIP_DEFINE_MIN 0x1u
+#define MIP_DEFINE_MAX 0x2u
+#define MIP_DEFINE_R32F 0x4u
+#define MIP_DEFINE_R11F_G11F_B10F 0x8u
+#define MIP_DEFINE_COPY 0x10u
+#define MIP_DEFINE_WIDE 0x20u
+#define MIP_PROGRAMS (MIP_REDUCTIONS * MIP_FORMATS * 2)
+
+/* The size of a mip level, for size at level 0. */
+static GLsizei mipLevelSize(GLsizei size, int level)
+{
+	return (size >> level) ? (size >> level) : 1;
+}
+
+/* The number of levels of a full chain of a w x h texture. */
+static int mipLevelCount(GLsizei w, GLsizei h)
+{
+	int levels;
+	for (levels = 1; (w >> levels) || (h >> levels); levels++);
+	return levels;
+}
+
+typedef struct {
+	GLuint program;		/* 0 until built */
+	bool failed;		/* do not try to build it again */
+	GLint sourceLevelLoc, sourceSizeLoc, levelsLoc;
+} MipProgram;
+
+typedef struct {
+	bool enabled;		/* not --per-level-mips */
+	ShaderSourceCache *cache;
+	MipProgram programs[MIP_PROGRAMS];	/* by reduction, format and copy */
+	GLuint counter;		/* the groups done, 0 if not available */
+	int images;		/* levels per dispatch */
+	unsigned int dispatches;	/* so far, for the log */
+
+	/* Prepare the downsampler, whose programs are loaded via sourceCache
+	* when first used. Without compute shaders, it is not available. */
+	void init(ShaderSourceCache *sourceCache)
+	{
+		static const GLuint zero = 0;
+		GLint units = 0, computeImages = 0;
+
+		memset(programs, 0, sizeof(programs));
+		cache = sourceCache;
+		counter = 0;
+		images = 0;
+		dispatches = 0;
+		if (!enabled || !computeShaderSupported() || !glCaps()->storageBuffers || !glTexStorage2D ||
+			!glBindImageTexture) {
+			info("mip downsampler: not available, mip chains are built a level at a time");
+			return;
+		}
+		glGetIntegerv(GL_MAX_IMAGE_UNITS, &units);
+		glGetIntegerv(GL_MAX_COMPUTE_IMAGE_UNIFORMS, &computeImages);
+		images = (units >= MIP_IMAGES_WIDE && computeImages >= MIP_IMAGES_WIDE) ? MIP_IMAGES_WIDE : MIP_IMAGES;
+		glGenBuffers(1, &counter);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, counter);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zero), &zero, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glDebugLabel(GL_BUFFER, counter, "mip downsampler");
+		info("mip downsampler: up to %d levels per dispatch", images);
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < MIP_PROGRAMS; i++)
+			if (programs[i].program)
+				glState()->deleteProgram(programs[i].program);
+		memset(programs, 0, sizeof(programs));
+		if (counter)
+			glState()->deleteBuffers(1, &counter);
+		counter = 0;
+	}
+
+	/* Returns true if mip chains can be built in a single pass. */
+	bool available() const
+	{
+		return counter != 0;
+	}
+
+	/* The MIP_FORMAT_* of the internal format, -1 if there is none. */
+	static int formatIndex(GLenum format)
+	{
+		switch (format) {
+			case GL_RGBA8: return MIP_FORMAT_RGBA8;
+			case GL_R32F: return MIP_FORMAT_R32F;
+			case GL_R11F_G11F_B10F: return MIP_FORMAT_R11F_G11F_B10F;
+		}
+		return -1;
+	}
+
+	/* The program reducing by reduction images of format (a MIP_FORMAT_*),
+	* built if it is not yet. NULL in case of an error. */
+	MipProgram *program(int reduction, int format, bool copy)
+	{
+		static const unsigned int reductionDefines[MIP_REDUCTIONS] = { 0, MIP_DEFINE_MIN, MIP_DEFINE_MAX };
+		static const unsigned int formatDefines[MIP_FORMATS] = { 0, MIP_DEFINE_R32F, MIP_DEFINE_R11F_G11F_B10F };
+		MipProgram *p = &programs[(reduction * MIP_FORMATS + format) * 2 + (copy ? 1 : 0)];
+
+		if (p->program || p->failed)
+			return p->program ? p : NULL;
+		unsigned int defines = reductionDefines[reduction] | formatDefines[format] | (copy ? MIP_DEFINE_COPY : 0) |
+			(images == MIP_IMAGES_WIDE ? MIP_DEFINE_WIDE : 0);
+		p->program = computeProgramBuild(cache, MIP_DOWNSAMPLE_CS, mipDefines,
+			(int)(sizeof(mipDefines) / sizeof(mipDefines[0])), defines);
+		if (!p->program) {
+			warn("mip downsampler: failed to build the program 0x%x", defines);
+			p->failed = true;
+			return NULL;
+		}
+		p->sourceLevelLoc = glGetUniformLocation(p->program, "sourceLevel");
+		p->sourceSizeLoc = glGetUniformLocation(p->program, "sourceSize");
+		p->levelsLoc = glGetUniformLocation(p->program, "levels");
+		glState()->useProgram(p->program);
+		glUniform1i(glGetUniformLocation(p->program, "source"), 0);
+		return p;
+	}
+
+	/* Write levels [first, first + count) of texture, of internal format
+	* format and w x h texels at level 0, reducing the texels by reduction.
+	* They are reduced from level first - 1 of texture, or with copy, from
+	* level 0 of source (e.g. a depth texture), of sw x sh texels, which is
+	* copied into level first. The texture must have immutable storage with
+	* all those levels. Issues the barriers for sampling the levels after.
+	* Returns true if successfull and false if it is not available. */
+	bool reduce(GLuint texture, GLenum format, GLsizei w, GLsizei h, int first, int count, int reduction,
+		GLuint source = 0, GLsizei sw = 0, GLsizei sh = 0)
+	{
+		int formatId = formatIndex(format);
+		bool copy = source != 0;
+		int i;
+
+		if (!available() || formatId < 0 || count < (copy ? 2 : 1) || (!copy && first < 1))
+			return false;
+		GL_DEBUG_GROUP("mip downsample");
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, MIP_COUNTER_BINDING, counter);
+		glState()->activeTexture(GL_TEXTURE0);
+		while (count > 0) {
+			MipProgram *p = program(reduction, formatId, copy);
+			if (!p)
+				return false;
+			int sourceLevel = copy ? 0 : first - 1;
+			if (!copy) {
+				source = texture;
+				sw = mipLevelSize(w, sourceLevel);
+				sh = mipLevelSize(h, sourceLevel);
+			}
+			/* the tiles cover the source, and with copy the first level */
+			GLsizei cw = copy && mipLevelSize(w, first) > sw ? mipLevelSize(w, first) : sw;
+			GLsizei ch = copy && mipLevelSize(h, first) > sh ? mipLevelSize(h, first) : sh;
+			int n = (count < images) ? count : images;
+			glState()->useProgram(p->program);
+			glUniform1i(p->sourceLevelLoc, sourceLevel);
+			glUniform2i(p->sourceSizeLoc, sw, sh);
+			glUniform1i(p->levelsLoc, n);
+			glState()->bindTexture(GL_TEXTURE_2D, source);
+			for (i = 0; i < n; i++)
+				glBindImageTexture(i, texture, first + i, GL_FALSE, 0, GL_READ_WRITE, format);
+			glDispatchCompute((GLuint)((cw + MIP_TILE - 1) / MIP_TILE), (GLuint)((ch + MIP_TILE - 1) / MIP_TILE), 1);
+			dispatches++;
+			/* the next dispatch and the caller sample the levels */
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			first += n;
+			count -= n;
+			copy = false;
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glState()->useProgram(0);
+		return true;
+	}
+
+	/* Build the levels 1 to levels - 1 of the GL_TEXTURE_2D texture of
+	* format and w x h texels from level 0, as averages, and fall back to
+	* glGenerateMipmap if that is not possible.
+	* Returns true if it was built in a single pass. */
+	bool generate(GLuint texture, GLenum format, GLsizei w, GLsizei h, int levels)
+	{
+		if (reduce(texture, format, w, h, 1, levels - 1, MIP_AVERAGE))
+			return true;
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		return false;
+	}
+} MipDownsampler;
+
+/* The downsampler of the process, see above. This is an inline function
+* with a static local, so all translation units share it. */
+inline MipDownsampler *mipDownsampler()
+{
+	static MipDownsampler downsampler = { 0 };
+	return &downsampler;
+}
+
+#endif
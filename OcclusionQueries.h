@@ -0,0 +1,249 @@
+#ifndef HEADER_OCCLUSIONQUERIES_H
+#define HEADER_OCCLUSIONQUERIES_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FrustumCuller.h"
+#include "GLCaps.h"
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* OCCLUSION QUERIES                                                        *
+****************************************************************************/
+
+/* OcclusionQueries: occlusion culling for contexts without compute
+* shaders, which can not build the Hi-Z pyramid of HiZ.h. After the scene
+* is drawn, the boxes around the bounding spheres of the objects are drawn
+* against its depth with an occlusion query each (GL_ANY_SAMPLES_PASSED,
+* conservative where the context has it), without writing anything. The
+* next frame draws each object under glBeginConditionalRender with
+* GL_QUERY_NO_WAIT: the GPU skips the object if its box was hidden, and
+* draws it anyway if the answer is not there yet, so the CPU never waits
+* for a query. The results are still read back, but only once they are
+* available, to decide which objects to query again: a hidden object is
+* queried every frame, so it shows up one frame after it comes out, and a
+* visible one only every OCCLUSION_QUERY_INTERVAL frames, spread over the
+* objects, since it most likely stays visible (temporal coherence); its
+* last query keeps it drawn meanwhile.
+* The objects outside the frustum are neither drawn nor queried; one which
+* just came in, and one the camera is inside the box of, is drawn without
+* a condition. The shadows are drawn without any, they see other objects. */
+#define OCCLUSION_QUERY_VS "shaders/occlusion_box.vs.glsl"
+#define OCCLUSION_QUERY_FS "shaders/minimal.fs.glsl"
+#define OCCLUSION_QUERY_INTERVAL 8	/* frames between the queries of a visible object */
+
+/* the state of an object */
+#define OCCLUSION_IN_FRUSTUM 1u		/* this frame */
+#define OCCLUSION_WAS_IN_FRUSTUM 2u	/* the last frame */
+#define OCCLUSION_ISSUED 4u		/* its query has been issued at all */
+#define OCCLUSION_PENDING 8u		/* ... and its result was not read yet */
+#define OCCLUSION_VISIBLE 16u		/* the last result read */
+#define OCCLUSION_INSIDE 32u		/* the camera is in its box */
+
+typedef struct {
+	GLuint program;		/* the boxes, 0 if not supported */
+	GLint boxLoc, viewProjectionLoc;
+	GLenum target;		/* of the queries */
+	GLuint vao;		/* without any attributes */
+	GLuint *ids;		/* a query per object */
+	unsigned char *state;	/* OCCLUSION_* per object */
+	int count;
+	unsigned int frame;
+	bool enabled;
+	int issued;		/* queries by the last issue() */
+	int hidden;		/* objects in the frustum whose last result read was hidden */
+
+	void clear()
+	{
+		program = 0;
+		vao = 0;
+		ids = NULL;
+		state = NULL;
+		count = 0;
+		frame = 0;
+		enabled = false;
+		issued = hidden = 0;
+	}
+
+	/* Whether the context can cull with occlusion queries. */
+	static bool supported()
+	{
+		return glCaps()->occlusionQueries;
+	}
+
+	/* Set up a query for each of n objects, the program for the boxes is
+	* loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache, int n)
+	{
+		clear();
+		if (!supported() || n <= 0)
+			return false;
+		ids = (GLuint*)malloc(sizeof(GLuint) * n);
+		state = (unsigned char*)calloc((size_t)n, 1);
+		if (!ids || !state) {
+			warn("occlusion queries: failed to allocate %d objects", n);
+			destroy();
+			return false;
+		}
+		program = programBuild(cache, OCCLUSION_QUERY_VS, OCCLUSION_QUERY_FS);
+		if (!program) {
+			destroy();
+			return false;
+		}
+		boxLoc = glGetUniformLocation(program, "box");
+		viewProjectionLoc = glGetUniformLocation(program, "boxViewProjection");
+		glGenQueries(n, ids);
+		glGenVertexArrays(1, &vao);
+		count = n;
+		target = glCaps()->conservativeQueries ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+		GL_ERROR_DBG("occlusion queries initialization");
+		info("occlusion queries: %d objects, %s", n, glCaps()->conservativeQueries ? "conservative" : "exact");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (ids && count)
+			glDeleteQueries(count, ids);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		if (program)
+			glState()->deleteProgram(program);
+		free(ids);
+		free(state);
+		clear();
+	}
+
+	/* Turn the culling on or off. All objects start out visible.
+	* Returns false if it is not supported. */
+	bool setEnabled(bool enable)
+	{
+		if (enable && !program)
+			return false;
+		enabled = enable;
+		invalidate();
+		return true;
+	}
+
+	/* Forget all results, every object is drawn until it is queried
+	* again. */
+	void invalidate()
+	{
+		if (state)
+			memset(state, 0, (size_t)count);
+	}
+
+	/* Find the objects of this frame, those of the spheres scaled by
+	* radiusScale inside the frustum of planes, and whether camera is in
+	* their boxes, and read the results of the queries which are there. */
+	void select(const glm::vec4 planes[6], const glm::vec4 *spheres, float radiusScale, const glm::vec3 &camera)
+	{
+		int i, p;
+		GLuint available, result;
+
+		if (!enabled)
+			return;
+		frame++;
+		hidden = 0;
+		for (i = 0; i < count; i++) {
+			unsigned char s = state[i];
+			glm::vec3 c(spheres[i]);
+			float r = spheres[i].w * radiusScale;
+			s = (unsigned char)((s & ~(OCCLUSION_IN_FRUSTUM | OCCLUSION_WAS_IN_FRUSTUM | OCCLUSION_INSIDE)) |
+				((s & OCCLUSION_IN_FRUSTUM) ? OCCLUSION_WAS_IN_FRUSTUM : 0u));
+			for (p = 0; p < 6; p++)
+				if (glm::dot(glm::vec3(planes[p]), c) + planes[p].w < -r)
+					break;
+			if (p == 6)
+				s |= OCCLUSION_IN_FRUSTUM;
+			/* the box is clipped by the near plane this close */
+			if (glm::all(glm::lessThan(glm::abs(camera - c), glm::vec3(r + 0.1f))))
+				s |= OCCLUSION_INSIDE;
+			if (s & OCCLUSION_PENDING) {
+				glGetQueryObjectuiv(ids[i], GL_QUERY_RESULT_AVAILABLE, &available);
+				if (available) {
+					glGetQueryObjectuiv(ids[i], GL_QUERY_RESULT, &result);
+					s = (unsigned char)((s & ~(OCCLUSION_PENDING | OCCLUSION_VISIBLE)) |
+						(result ? OCCLUSION_VISIBLE : 0u));
+				}
+			}
+			if ((s & (OCCLUSION_IN_FRUSTUM | OCCLUSION_ISSUED | OCCLUSION_VISIBLE)) ==
+				(OCCLUSION_IN_FRUSTUM | OCCLUSION_ISSUED))
+				hidden++;
+			state[i] = s;
+		}
+	}
+
+	/* Whether object i is drawn this frame at all. */
+	bool inFrustum(int i) const
+	{
+		return !enabled || (state[i] & OCCLUSION_IN_FRUSTUM);
+	}
+
+	/* Whether the draw of object i depends on its query, see begin(). */
+	bool conditional(int i) const
+	{
+		const unsigned int need = OCCLUSION_IN_FRUSTUM | OCCLUSION_WAS_IN_FRUSTUM | OCCLUSION_ISSUED;
+		return enabled && (state[i] & (need | OCCLUSION_INSIDE)) == need;
+	}
+
+	/* Draw what follows only if the box of object i was visible, or
+	* unconditionally. Returns true if end() must follow. */
+	bool begin(int i) const
+	{
+		if (!conditional(i))
+			return false;
+		glBeginConditionalRender(ids[i], GL_QUERY_NO_WAIT);
+		return true;
+	}
+
+	void end() const
+	{
+		glEndConditionalRender();
+	}
+
+	/* Query the boxes of the objects which are due against the depth of
+	* the framebuffer bound, drawn with viewProjection: those in the
+	* frustum whose last query was read, the hidden ones every frame and
+	* the visible ones every OCCLUSION_QUERY_INTERVAL frames. */
+	void issue(const glm::mat4 &viewProjection, const glm::vec4 *spheres, float radiusScale)
+	{
+		int i;
+
+		issued = 0;
+		if (!enabled)
+			return;
+		GL_DEBUG_GROUP("occlusion queries");
+		glState()->useProgram(program);
+		glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, &viewProjection[0][0]);
+		glState()->bindVertexArray(vao);
+		glState()->enable(GL_DEPTH_TEST);
+		glState()->depthFunc(GL_LEQUAL);
+		glState()->raster(0);
+		glState()->colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		for (i = 0; i < count; i++) {
+			unsigned char s = state[i];
+			if (!(s & OCCLUSION_IN_FRUSTUM) || (s & (OCCLUSION_PENDING | OCCLUSION_INSIDE)))
+				continue;
+			if ((s & OCCLUSION_VISIBLE) && ((frame + (unsigned int)i) % OCCLUSION_QUERY_INTERVAL) != 0)
+				continue;
+			glUniform4f(boxLoc, spheres[i].x, spheres[i].y, spheres[i].z, spheres[i].w * radiusScale);
+			glBeginQuery(target, ids[i]);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+			glEndQuery(target);
+			glState()->countDraw();
+			state[i] = (unsigned char)(s | OCCLUSION_ISSUED | OCCLUSION_PENDING);
+			issued++;
+		}
+		glState()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glState()->raster(RASTER_DEFAULT);
+		glState()->depthFunc(GL_LESS);
+		GL_ERROR_DBG("occlusion queries");
+	}
+} OcclusionQueries;
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef HEADER_OVERLAY_H
+#define HEADER_OVERLAY_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "GLState.h"
+#include "BufferPool.h"
+#include "FrameStats.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
+#include "SpriteBatch.h"
+
+/****************************************************************************
+* PERFORMANCE OVERLAY                                                      *
+****************************************************************************/
+
+/* Overlay: the frame times and counters drawn on top of the frame, instead
+* of the window title, which costs a round trip to the window system each
+* time it is set. Everything is a quad of one color: the graph of the CPU
+* and GPU times of the last OVERLAY_GRAPH_FRAMES frames, with a line at the
+* frame time of 60 Hz, and the text, in a font of 3x5 pixels (overlayGlyph)
+* where each run of lit pixels in a row is a quad. The quads go through the
+* SpriteBatch, which draws them with whatever else the frame added to it
+* in a single glDrawArrays, so the overlay has no program or buffer of its
+* own and draw() only writes quads and flushes the batch.
+* The text only changes in update(), once per second, so it is built there
+* and copied behind the graph each frame.
+* The overlay times itself: draw() measures its CPU time and counts the GL
+* calls it issues, its GPU time is a scope of the GpuProfiler (see
+* GPU_SCOPE_OVERLAY in HelloCube.cpp), and update() subtracts all of it
+* from the numbers shown and from the graph, which therefore tell what the
+* frame costs without the overlay. Its own cost is shown apart. */
+#define OVERLAY_TEXT_QUADS 2048	/* of the text */
+#define OVERLAY_GRAPH_FRAMES 120	/* frames shown by the graph */
+#define OVERLAY_GRAPH_MS 33.3f	/* the top of the graph */
+#define OVERLAY_TARGET_MS 16.7f	/* where the line across the graph is */
+#define OVERLAY_GRAPH_HEIGHT 80	/* pixels */
+#define OVERLAY_BAR 2		/* pixels of a frame in the graph */
+#define OVERLAY_PIXEL 2		/* pixels per pixel of the font */
+#define OVERLAY_MARGIN 8	/* pixels around the overlay and its parts */
+#define OVERLAY_LINE ((5 + 2) * OVERLAY_PIXEL)	/* pixels from one line of text to the next */
+#define OVERLAY_ADVANCE (4 * OVERLAY_PIXEL)	/* pixels from one character to the next */
+
+/* colors, as 0xRRGGBBAA */
+#define OVERLAY_BACKGROUND 0x000000a0u
+#define OVERLAY_TEXT 0xe0e0e0ffu
+#define OVERLAY_CPU 0x40d040ffu
+#define OVERLAY_GPU 0xf09030ffu
+#define OVERLAY_TARGET 0xd04040ffu	/* the line at OVERLAY_TARGET_MS */
+
+/* The pixels of character c, ' ' to '_' (lower case is shown as upper
+* case): five rows of three bits from the top, one octal digit per row,
+* the highest bit is the left column. Others are blank. */
+static unsigned int overlayGlyph(char c)
+{
+	static const unsigned short glyphs[64] = {
+		000000, 022202, 055000, 057575, 036236, 051245, 025253, 022000,	/*  !"#$%&' */
+		012221, 042224, 005250, 002720, 000024, 000700, 000002, 011244,	/* ()*+,-./ */
+		075557, 026227, 071747, 071317, 055711, 074717, 074757, 071122,	/* 01234567 */
+		075757, 075717, 002020, 002024, 012421, 007070, 042124, 071302,	/* 89:;<=>? */
+		075747, 025755, 065656, 034443, 065556, 074647, 074644, 034553,	/* @ABCDEFG */
+		055755, 072227, 011152, 055655, 044447, 057755, 065555, 025552,	/* HIJKLMNO */
+		065644, 025563, 065655, 034216, 072222, 055557, 055552, 055775,	/* PQRSTUVW */
+		055255, 055222, 071247, 064446, 044211, 031113, 025000, 000007	/* XYZ[\]^_ */
+	};
+	if (c >= 'a' && c <= 'z')
+		c -= 'a' - 'A';
+	if (c < ' ' || c > '_')
+		return 0;
+	return glyphs[c - ' '];
+}
+
+/* Write a quad from (x0, y0) to (x1, y1) of color rgba (0xRRGGBBAA) at q.
+* Returns the quad behind it. */
+static SpriteQuad *overlayQuad(SpriteQuad *q, float x0, float y0, float x1, float y1, GLuint rgba)
+{
+	spriteSolid(q, x0, y0, x1, y1, rgba);
+	return q + 1;
+}
+
+/* Write text at (x, y), its top left corner, in color rgba into the
+* quads from q to end, as far as they go. Returns the quad behind the last
+* one written. */
+static SpriteQuad *overlayText(SpriteQuad *q, SpriteQuad *end, float x, float y, GLuint rgba, const char *text)
+{
+	for (; *text; text++, x += OVERLAY_ADVANCE) {
+		unsigned int glyph = overlayGlyph(*text);
+		int row, col, run;
+		for (row = 0; row < 5; row++) {
+			unsigned int bits = (glyph >> (3 * (4 - row))) & 7u;
+			for (col = 0; col < 3; col += run) {
+				run = 1;
+				if (!(bits & (4u >> col)))
+					continue;
+				while (col + run < 3 && (bits & (4u >> (col + run))))
+					run++;
+				if (q >= end)
+					return q;
+				q = overlayQuad(q, x + col * OVERLAY_PIXEL, y + row * OVERLAY_PIXEL,
+					x + (col + run) * OVERLAY_PIXEL, y + (row + 1) * OVERLAY_PIXEL, rgba);
+			}
+		}
+	}
+	return q;
+}
+
+/* the numbers update() shows, the cost of the overlay taken out */
+typedef struct {
+	unsigned int frames;	/* since the last update */
+	double fps;
+	double cpuMs;		/* mean frame time */
+	double gpuMs;		/* GPU time per frame, negative if unknown */
+	double overlayGpuMs;	/* of the overlay scope, negative if unknown */
+	const BufferPool *pool;	/* of the meshes */
+} OverlayStats;
+
+typedef struct {
+	bool enabled;
+	bool available;		/* the SpriteBatch is */
+	SpriteQuad *text;	/* built by update() */
+	int textQuads;
+	int textLines;
+	float samples[OVERLAY_GRAPH_FRAMES];	/* scratch of the graph */
+
+	/* the cost of the overlay since the last update(), and per frame
+	* as of the last update() */
+	unsigned long long cpuTime;	/* in ns */
+	unsigned int issued;	/* GL calls through glState() */
+	unsigned int drawn;	/* frames */
+	double cpuMs, gpuMs;	/* negative if unknown */
+	double subtractCpuMs, subtractGpuMs;	/* taken from the graph, not negative */
+
+	void clear()
+	{
+		enabled = available = false;
+		text = NULL;
+		textQuads = textLines = 0;
+		cpuTime = 0;
+		issued = drawn = 0;
+		cpuMs = gpuMs = -1.0;
+		subtractCpuMs = subtractGpuMs = 0.0;
+	}
+
+	/* Allocate the text, the quads are drawn by the spriteBatch(), which
+	* must be initialized before.
+	* Returns true if successfull and false in case of an error. */
+	bool init()
+	{
+		clear();
+		if (!spriteBatch()->program)
+			return false;
+		text = (SpriteQuad*)malloc(sizeof(SpriteQuad) * OVERLAY_TEXT_QUADS);
+		if (!text) {
+			warn("overlay: failed to allocate the text");
+			return false;
+		}
+		available = true;
+		return true;
+	}
+
+	void destroy()
+	{
+		free(text);
+		clear();
+	}
+
+	/* Show the overlay or not, the text follows with the next
+	* update(). */
+	void setEnabled(bool enable)
+	{
+		enabled = enable && available;
+		textQuads = textLines = 0;
+		cpuTime = 0;
+		issued = drawn = 0;
+		cpuMs = gpuMs = -1.0;
+		subtractCpuMs = subtractGpuMs = 0.0;
+	}
+
+	/* Add a line of text in color rgba. */
+	void addLine(GLuint rgba, const char *line)
+	{
+		float y = (float)(3 * OVERLAY_MARGIN + OVERLAY_GRAPH_HEIGHT + textLines * OVERLAY_LINE);
+		SpriteQuad *q = overlayText(text + textQuads, text + OVERLAY_TEXT_QUADS, (float)(2 * OVERLAY_MARGIN), y,
+			rgba, line);
+		textQuads = (int)(q - text);
+		textLines++;
+	}
+
+	/* Add the lines of the memory counts of domain (MEMORY_CPU or
+	* MEMORY_GPU), see MemoryStats.h: the total and its peak, then the
+	* categories holding anything, as many to a line as fit. */
+	void addMemoryLines(int domain, GLuint rgba)
+	{
+		MemoryStats *m = memoryStats();
+		char line[64];
+		int c, n;
+
+		mysnprintf(line, sizeof(line), "%s MEM %.1f MB  PEAK %.1f MB", memoryDomainNames[domain],
+			(double)m->total[domain] / 1048576.0, (double)m->totalPeak[domain] / 1048576.0);
+		addLine(rgba, line);
+		n = 0;
+		for (c = 0; c < MEMORY_CATEGORIES; c++) {
+			long long bytes = m->current[domain][c];
+			char item[32];
+			int length;
+			if (bytes <= 0)
+				continue;
+			length = mysnprintf(item, sizeof(item), "  %s %.1f", memoryCategoryNames[c], (double)bytes / 1048576.0);
+			if (n && n + length >= (int)sizeof(line)) {
+				addLine(OVERLAY_TEXT, line);
+				n = 0;
+			}
+			memcpy(line + n, item, (size_t)length + 1);
+			n += length;
+		}
+		if (n)
+			addLine(OVERLAY_TEXT, line);
+	}
+
+	/* Compute the cost of the overlay since the last call and build the
+	* text of s, to be called once per second after glState()->report(). */
+	void update(const OverlayStats *s)
+	{
+		GLStateCache *gl = glState();
+		GpuMemoryInfo memory;
+		double draws, calls;
+		char line[64];
+
+		if (!enabled)
+			return;
+		cpuMs = drawn ? (double)cpuTime * 1.0e-6 / (double)drawn : -1.0;
+		gpuMs = s->overlayGpuMs;
+		subtractCpuMs = (cpuMs > 0.0) ? cpuMs : 0.0;
+		subtractGpuMs = (gpuMs > 0.0) ? gpuMs : 0.0;
+		/* our own draw and GL calls, per frame */
+		draws = gl->avgDraws - (s->frames ? (double)drawn / (double)s->frames : 0.0);
+		calls = gl->avgIssued - (s->frames ? (double)issued / (double)s->frames : 0.0);
+		cpuTime = 0;
+		issued = drawn = 0;
+
+		textQuads = textLines = 0;
+		mysnprintf(line, sizeof(line), "FPS %.1f", s->fps);
+		addLine(OVERLAY_TEXT, line);
+		mysnprintf(line, sizeof(line), "CPU %.2f MS", s->cpuMs - subtractCpuMs);
+		addLine(OVERLAY_CPU, line);
+		if (s->gpuMs >= 0.0)
+			mysnprintf(line, sizeof(line), "GPU %.2f MS", s->gpuMs - subtractGpuMs);
+		else
+			mysnprintf(line, sizeof(line), "GPU -");
+		addLine(OVERLAY_GPU, line);
+		mysnprintf(line, sizeof(line), "DRAWS %.0f  GL CALLS %.0f  ELIDED %.0f", draws > 0.0 ? draws : 0.0,
+			calls > 0.0 ? calls : 0.0, gl->avgElided > 0.0 ? gl->avgElided : 0.0);
+		addLine(OVERLAY_TEXT, line);
+		if (s->pool) {
+			mysnprintf(line, sizeof(line), "MESHES %.1f / %.1f MB", (double)s->pool->used / 1048576.0,
+				(double)s->pool->reserved / 1048576.0);
+			addLine(OVERLAY_TEXT, line);
+		}
+		if (gpuMemoryQuery(&memory)) {
+			if (memory.total)
+				mysnprintf(line, sizeof(line), "VRAM %.0f / %.0f MB FREE", (double)memory.available / 1048576.0,
+					(double)memory.total / 1048576.0);
+			else
+				mysnprintf(line, sizeof(line), "VRAM %.0f MB FREE", (double)memory.available / 1048576.0);
+			addLine(OVERLAY_TEXT, line);
+		}
+		addMemoryLines(MEMORY_CPU, OVERLAY_CPU);
+		addMemoryLines(MEMORY_GPU, OVERLAY_GPU);
+		if (gpuMs >= 0.0)
+			mysnprintf(line, sizeof(line), "OVERLAY %.3f CPU %.3f GPU MS", cpuMs, gpuMs);
+		else
+			mysnprintf(line, sizeof(line), "OVERLAY %.3f CPU MS", cpuMs);
+		addLine(OVERLAY_TEXT, line);
+		if (glDebug()->performanceTotal) {
+			mysnprintf(line, sizeof(line), "PERF WARNINGS %u", glDebug()->performanceTotal);
+			addLine(OVERLAY_GPU, line);
+		}
+	}
+
+	/* Read the last OVERLAY_GRAPH_FRAMES samples of ring into samples.
+	* Returns how many there are. */
+	int readGraph(const FrameTimeRing *ring)
+	{
+		unsigned int w = ring->written.load(std::memory_order_acquire), now;
+		return (int)ring->read(w > OVERLAY_GRAPH_FRAMES ? w - OVERLAY_GRAPH_FRAMES : 0, samples, &now);
+	}
+
+	/* Write the bars of the samples read by readGraph, less subtract, in
+	* color rgba and as wide as width. */
+	SpriteQuad *graphBars(SpriteQuad *q, int n, double subtract, float width, GLuint rgba)
+	{
+		const float bottom = (float)(2 * OVERLAY_MARGIN + OVERLAY_GRAPH_HEIGHT);
+		int i;
+
+		for (i = 0; i < n; i++) {
+			float ms = samples[i] - (float)subtract;
+			float x = (float)(2 * OVERLAY_MARGIN + (OVERLAY_GRAPH_FRAMES - n + i) * OVERLAY_BAR);
+			if (ms <= 0.0f)
+				continue;
+			if (ms > OVERLAY_GRAPH_MS)
+				ms = OVERLAY_GRAPH_MS;
+			q = overlayQuad(q, x, bottom - ms * (OVERLAY_GRAPH_HEIGHT / OVERLAY_GRAPH_MS), x + width, bottom, rgba);
+		}
+		return q;
+	}
+
+	/* Draw the overlay into the bound framebuffer of width x height
+	* pixels, the graph from the frame times of stats, and with it the
+	* rest of the quads of the spriteBatch(). */
+	void draw(const FrameStats *stats, int width, int height)
+	{
+		const float left = (float)(2 * OVERLAY_MARGIN), bottom = (float)(2 * OVERLAY_MARGIN + OVERLAY_GRAPH_HEIGHT);
+		const float target = bottom - OVERLAY_TARGET_MS * (OVERLAY_GRAPH_HEIGHT / OVERLAY_GRAPH_MS);
+		/* the panel, the line and at most two bars per frame */
+		const int graphQuads = 2 + 2 * OVERLAY_GRAPH_FRAMES;
+		SpriteBatch *batch = spriteBatch();
+		unsigned long long start;
+		unsigned int calls;
+		SpriteQuad *first, *q;
+		int n;
+
+		if (!enabled || width <= 0 || height <= 0)
+			return;
+		start = profileNow();
+		calls = glState()->issued;
+		first = batch->reserve(SPRITE_BLEND_ALPHA, graphQuads + textQuads);
+		if (first) {
+			/* the panel, the bars and the line at 60 Hz, the CPU bars
+			* are wider, so the GPU ones in front of them leave them
+			* visible */
+			q = overlayQuad(first, (float)OVERLAY_MARGIN, (float)OVERLAY_MARGIN,
+				left + OVERLAY_GRAPH_FRAMES * OVERLAY_BAR + OVERLAY_MARGIN,
+				bottom + OVERLAY_MARGIN + textLines * OVERLAY_LINE + OVERLAY_MARGIN / 2, OVERLAY_BACKGROUND);
+			n = readGraph(&stats->cpu);
+			q = graphBars(q, n, subtractCpuMs, (float)OVERLAY_BAR, OVERLAY_CPU);
+			n = readGraph(&stats->gpu);
+			q = graphBars(q, n, subtractGpuMs, (float)OVERLAY_BAR * 0.5f, OVERLAY_GPU);
+			q = overlayQuad(q, left, target, left + OVERLAY_GRAPH_FRAMES * OVERLAY_BAR, target + 1.0f,
+				OVERLAY_TARGET);
+			/* the bars left out for frames without a time are empty
+			* quads, which draw nothing */
+			memset(q, 0, sizeof(SpriteQuad) * (graphQuads - (q - first)));
+			memcpy(first + graphQuads, text, sizeof(SpriteQuad) * textQuads);
+		}
+		batch->flush(width, height);
+
+		cpuTime += profileNow() - start;
+		issued += glState()->issued - calls;
+		drawn++;
+	}
+} Overlay;
+
+#endif
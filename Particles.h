@@ -0,0 +1,252 @@
+#ifndef HEADER_PARTICLES_H
+#define HEADER_PARTICLES_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "Cube.h"
+#include "GpuPrimitives.h"
+
+/****************************************************************************
+* PARTICLES: emitted, moved, sorted and drawn on the GPU                   *
+****************************************************************************/
+
+/* GpuParticles: a fountain of up to millions of particles which never
+* touch the CPU. They are kept as arrays of their positions and their
+* velocities (each particle a vec4 in both, the part of its life left and
+* how fast it goes in w), with a dead list of the free ones and an alive
+* list, which shaders/particles.cs.glsl updates each frame (see there):
+* it pops the dead to emit them, moves the alive ones and pushes them to
+* the next alive list, or back to the dead ones at the end of their lives.
+* How many there are stays on the GPU: the simulation is dispatched
+* indirectly, with the groups the emission left, and so is the draw.
+* They blend, so the next alive list is sorted back to front by
+* GpuPrimitives::sort, by 16 bits of distance with the count from the
+* counters, and drawn in that order: an instance of a camera facing quad
+* per particle, its corners from the vertex index and its particle from
+* the storage buffers (shaders/particles.vs.glsl), without any vertex
+* buffers. The pool is refilled as fast as particles die, so it stays
+* about full.
+* It needs compute shaders and storage buffers, GL 4.3. */
+#define PARTICLE_SHADER "shaders/particles.cs.glsl"
+#define PARTICLE_VS "shaders/particles.vs.glsl"
+#define PARTICLE_FS "shaders/particles.fs.glsl"
+#define PARTICLE_GROUP 256	/* local size of the compute shader */
+#define PARTICLE_LIFE 3.0f	/* seconds a particle lives on average */
+#define PARTICLE_DEFAULT_COUNT (1 << 20)	/* of the key which turns them on */
+
+/* the stages of the compute shader */
+enum {
+	PARTICLE_BEGIN = 0,	/* how many to emit */
+	PARTICLE_EMIT,		/* indirect, per particle to emit */
+	PARTICLE_ARGS,		/* how many to move */
+	PARTICLE_SIMULATE,	/* indirect, per alive particle */
+	PARTICLE_END		/* the draw */
+};
+
+/* the counters and the indirect arguments, the block Counters of the
+* compute shader */
+typedef struct {
+	GLuint dead;
+	GLuint alive[2];
+	GLuint emit;
+	GLuint emitArgs[4];	/* for glDispatchComputeIndirect, w unused */
+	GLuint simulateArgs[4];
+	GLuint drawArgs[4];	/* for glDrawArraysIndirect */
+} ParticleCounters;
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint stageLoc, currentLoc, emitRequestLoc, seedLoc, dtLoc, emitterLoc, eyeLoc;
+	GLuint drawProgram;
+	GLint sizeLoc;
+	GLuint vao;		/* empty, the quads need no attributes */
+	GLuint counters;	/* ParticleCounters */
+	GLuint positions, velocities;
+	GLuint dead;
+	GLuint alive[2];	/* alive[current] at the start of the frame */
+	GLuint keys;		/* the sort keys of the next alive list */
+	int capacity;
+	int current;
+	double time;		/* of the last update(), negative before the first */
+	float emitCarry;	/* the part of a particle to emit next frame */
+	unsigned int frame;
+	float size;		/* of a particle, of the last update() */
+
+	void clear()
+	{
+		program = drawProgram = 0;
+		vao = counters = positions = velocities = dead = keys = 0;
+		alive[0] = alive[1] = 0;
+		capacity = 0;
+		current = 0;
+		time = -1.0;
+		emitCarry = 0.0f;
+		frame = 0;
+		size = 0.0f;
+	}
+
+	/* Build the programs and allocate count particles, all dead, the
+	* sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache, int count)
+	{
+		clear();
+		if (count < 1 || !computeShaderSupported())
+			return false;
+		program = computeProgramBuild(cache, PARTICLE_SHADER);
+		drawProgram = program ? programBuild(cache, PARTICLE_VS, PARTICLE_FS) : 0;
+		if (!program || !drawProgram) {
+			destroy();
+			return false;
+		}
+		stageLoc = glGetUniformLocation(program, "stage");
+		currentLoc = glGetUniformLocation(program, "current");
+		emitRequestLoc = glGetUniformLocation(program, "emitRequest");
+		seedLoc = glGetUniformLocation(program, "seed");
+		dtLoc = glGetUniformLocation(program, "dt");
+		emitterLoc = glGetUniformLocation(program, "emitter");
+		eyeLoc = glGetUniformLocation(program, "eye");
+		sizeLoc = glGetUniformLocation(drawProgram, "particleSize");
+		capacity = count;
+
+		/* every particle is dead */
+		GLuint *indices = (GLuint*)malloc(sizeof(GLuint) * count);
+		if (!indices) {
+			warn("particles: failed to allocate %d particles", count);
+			destroy();
+			return false;
+		}
+		int i;
+		for (i = 0; i < count; i++)
+			indices[i] = (GLuint)(count - 1 - i);
+		ParticleCounters c;
+		memset(&c, 0, sizeof(c));
+		c.dead = (GLuint)count;
+		c.drawArgs[0] = 6;
+		counters = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(c), &c, "particle counters");
+		dead = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * count, indices, "particle dead list");
+		free(indices);
+		positions = allocate(sizeof(glm::vec4) * count, "particle positions");
+		velocities = allocate(sizeof(glm::vec4) * count, "particle velocities");
+		alive[0] = allocate(sizeof(GLuint) * count, "particle alive list");
+		alive[1] = allocate(sizeof(GLuint) * count, "particle alive list");
+		keys = allocate(sizeof(GLuint) * count, "particle sort keys");
+		glGenVertexArrays(1, &vao);
+		GL_ERROR_DBG("particles initialization");
+		if (!counters || !dead || !positions || !velocities || !alive[0] || !alive[1] || !keys) {
+			warn("particles: failed to allocate the buffers of %d particles", count);
+			destroy();
+			return false;
+		}
+		info("particles: up to %d, %u MB", count,
+			(unsigned)(((sizeof(glm::vec4) * 2 + sizeof(GLuint) * 4) * (size_t)count) >> 20));
+		return true;
+	}
+
+	static GLuint allocate(GLsizeiptr size, const char *label)
+	{
+		return meshBufferCreate(GL_SHADER_STORAGE_BUFFER, size, NULL, label);
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (drawProgram)
+			glState()->deleteProgram(drawProgram);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		GLuint buffers[7] = { counters, positions, velocities, dead, alive[0], alive[1], keys };
+		int i;
+		for (i = 0; i < 7; i++) {
+			if (buffers[i])
+				glState()->deleteBuffers(1, &buffers[i]);
+		}
+		clear();
+	}
+
+	/* Run stage, with groups groups or indirectly with the arguments at
+	* offset of the counters if groups is negative. */
+	void dispatch(int stage, int groups, GLintptr offset = 0)
+	{
+		glUniform1i(stageLoc, stage);
+		if (groups >= 0) {
+			glDispatchCompute((GLuint)groups, 1, 1);
+		} else {
+			glState()->bindBuffer(GL_DISPATCH_INDIRECT_BUFFER, counters);
+			glDispatchComputeIndirect(offset);
+		}
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+	}
+
+	/* Advance the particles to the time now in seconds (they stand still
+	* while it does), with a fountain of size scale at emitter, and sort
+	* them for a camera at eye which sees as far as far, with primitives. */
+	void update(double now, const glm::vec3 &emitter, float scale, const glm::vec3 &eye, float far,
+		GpuPrimitives *primitives)
+	{
+		if (!program)
+			return;
+		float dt = (time < 0.0) ? 0.0f : (float)(now - time);
+		time = now;
+		if (dt > 0.1f)
+			dt = 0.1f;
+		/* as many as die on average, for a full pool */
+		float emit = emitCarry + dt * (float)capacity / PARTICLE_LIFE;
+		GLuint request = (GLuint)emit;
+		emitCarry = emit - (float)request;
+		size = 0.01f * scale;
+
+		GL_DEBUG_GROUP("particles");
+		glState()->useProgram(program);
+		glUniform1i(currentLoc, current);
+		glUniform1ui(emitRequestLoc, request);
+		glUniform1ui(seedLoc, ++frame * 0x9e3779b9u);
+		glUniform1f(dtLoc, dt);
+		glUniform4f(emitterLoc, emitter.x, emitter.y, emitter.z, scale);
+		glUniform4f(eyeLoc, eye.x, eye.y, eye.z, far);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, counters);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, positions);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, velocities);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dead);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, alive[current]);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, alive[1 - current]);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, keys);
+		dispatch(PARTICLE_BEGIN, 1);
+		dispatch(PARTICLE_EMIT, -1, offsetof(ParticleCounters, emitArgs));
+		dispatch(PARTICLE_ARGS, 1);
+		dispatch(PARTICLE_SIMULATE, -1, offsetof(ParticleCounters, simulateArgs));
+		dispatch(PARTICLE_END, 1);
+		current = 1 - current;
+		/* back to front, by the number the simulation counted */
+		primitives->sort(keys, alive[current], capacity, 16, counters,
+			(int)(offsetof(ParticleCounters, alive) / sizeof(GLuint)) + current);
+		GL_ERROR_DBG("particles update");
+	}
+
+	/* Blend the alive particles over what was drawn, with the Frame
+	* uniforms of the view bound. */
+	void draw()
+	{
+		if (!program)
+			return;
+		GL_DEBUG_GROUP("particles draw");
+		glState()->useProgram(drawProgram);
+		glUniform1f(sizeLoc, size);
+		glState()->bindVertexArray(vao);
+		glState()->raster(RASTER_BLEND);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_POSITION_BINDING, positions);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_ORDER_BINDING, alive[current]);
+		glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, counters);
+		glDrawArraysIndirect(GL_TRIANGLES, (const void*)offsetof(ParticleCounters, drawArgs));
+		glState()->countDraw();
+		GL_ERROR_DBG("particles draw");
+	}
+} GpuParticles;
+
+#endif
@@ -0,0 +1,480 @@
+#ifndef HEADER_PERFCOUNTERS_H
+#define HEADER_PERFCOUNTERS_H
+
+#include <glad/glad.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* HARDWARE PERFORMANCE COUNTERS                                            *
+****************************************************************************/
+
+/* PerfCounters samples counters of the GPU, e.g. the shader invocations,
+* cache misses or the memory traffic, for each scope of GpuProfiler, which
+* tells why a pass takes the time it does: a pass which moves a lot of
+* bytes per invocation is bound by the bandwidth, one which does not by the
+* ALUs. Three sources are tried in turn:
+* - GL_AMD_performance_monitor (AMD, Mesa): a monitor per scope and frame
+*   slot, with the chosen counters of any group selected into it;
+* - GL_INTEL_performance_query (Intel, Mesa): a query per scope and frame
+*   slot; the counters all have to be in the same query kind, those of the
+*   first kind which has one of the chosen ones are used;
+* - GL_ARB_pipeline_statistics_query (most drivers): the vertex, fragment and
+*   compute shader invocations and the like, a query per counter.
+* The counters are chosen by a comma separated list of parts of their names,
+* case insensitive, each picking the first counter it matches; "list" logs
+* all counters there are. Like the timer queries, the results of a frame are
+* read back PERF_COUNTER_FRAMES frames later, only if they are ready, and the
+* averages per frame are logged once per second. The scopes must not nest,
+* which neither extension allows. */
+#define PERF_COUNTER_MAX 8	/* counters sampled at once */
+#define PERF_COUNTER_SCOPES 16	/* as GPU_PROFILER_MAX_SCOPES */
+#define PERF_COUNTER_FRAMES 3	/* as GPU_PROFILER_FRAMES */
+#define PERF_COUNTER_NAME 64	/* bytes of a counter name */
+#define PERF_COUNTER_DATA 4096	/* bytes of the result of a monitor or query */
+
+enum {
+	PERF_COUNTERS_NONE = 0,
+	PERF_COUNTERS_AMD,	/* GL_AMD_performance_monitor */
+	PERF_COUNTERS_INTEL,	/* GL_INTEL_performance_query */
+	PERF_COUNTERS_PIPELINE	/* GL_ARB_pipeline_statistics_query */
+};
+
+typedef struct {
+	char name[PERF_COUNTER_NAME];
+	GLuint group, counter;	/* AMD: the ids; INTEL: the offset in the data; pipeline: the query target */
+	GLenum type;		/* of the value, see perfCounterValue; GL_UNSIGNED_INT64_ARB for pipeline statistics */
+	double sum[PERF_COUNTER_SCOPES];	/* since the last report */
+	double avg[PERF_COUNTER_SCOPES];	/* per frame, as of the last report, -1 for none */
+} PerfCounter;
+
+/* the pipeline statistics, with the names we give them */
+static const struct {
+	GLenum target;
+	const char *name;
+} perfPipelineStatistics[] = {
+	{ GL_VERTICES_SUBMITTED_ARB, "vertices submitted" },
+	{ GL_PRIMITIVES_SUBMITTED_ARB, "primitives submitted" },
+	{ GL_VERTEX_SHADER_INVOCATIONS_ARB, "vertex shader invocations" },
+	{ GL_CLIPPING_INPUT_PRIMITIVES_ARB, "clipping input primitives" },
+	{ GL_CLIPPING_OUTPUT_PRIMITIVES_ARB, "clipping output primitives" },
+	{ GL_FRAGMENT_SHADER_INVOCATIONS_ARB, "fragment shader invocations" },
+	{ GL_COMPUTE_SHADER_INVOCATIONS_ARB, "compute shader invocations" }
+};
+
+/* Returns true if name contains part, ignoring the case. */
+static bool perfCounterMatch(const char *name, const char *part, size_t length)
+{
+	size_t i, k;
+	for (i = 0; name[i]; i++) {
+		for (k = 0; k < length && name[i + k]; k++)
+			if (tolower((unsigned char)name[i + k]) != tolower((unsigned char)part[k]))
+				break;
+		if (k == length)
+			return true;
+	}
+	return false;
+}
+
+/* Returns the index of the part of the comma separated selection which
+* name matches, or -1. */
+static int perfCounterSelected(const char *selection, const char *name)
+{
+	int index = 0;
+	while (*selection) {
+		const char *end = strchr(selection, ',');
+		size_t length = end ? (size_t)(end - selection) : strlen(selection);
+		if (length && perfCounterMatch(name, selection, length))
+			return index;
+		index++;
+		selection += length + (end ? 1 : 0);
+	}
+	return -1;
+}
+
+/* The bytes of a value of type. */
+static GLuint perfCounterSize(GLenum type)
+{
+	switch (type) {
+	case GL_UNSIGNED_INT64_AMD:
+	case GL_PERFQUERY_COUNTER_DATA_UINT64_INTEL:
+	case GL_PERFQUERY_COUNTER_DATA_DOUBLE_INTEL:
+		return 8;
+	default:
+		return 4;
+	}
+}
+
+/* The value of a counter of type at data. */
+static double perfCounterValue(GLenum type, const void *data)
+{
+	GLuint u32;
+	GLuint64 u64;
+	float f;
+	double d;
+	switch (type) {
+	case GL_UNSIGNED_INT64_AMD:
+	case GL_PERFQUERY_COUNTER_DATA_UINT64_INTEL:
+		memcpy(&u64, data, sizeof(u64));
+		return (double)u64;
+	case GL_FLOAT:
+	case GL_PERCENTAGE_AMD:
+	case GL_PERFQUERY_COUNTER_DATA_FLOAT_INTEL:
+		memcpy(&f, data, sizeof(f));
+		return (double)f;
+	case GL_PERFQUERY_COUNTER_DATA_DOUBLE_INTEL:
+		memcpy(&d, data, sizeof(d));
+		return d;
+	default:
+		memcpy(&u32, data, sizeof(u32));
+		return (double)u32;
+	}
+}
+
+typedef struct {
+	int backend;		/* PERF_COUNTERS_* */
+	PerfCounter counters[PERF_COUNTER_MAX];
+	int count;
+	int scopeCount;
+	/* AMD monitors and INTEL queries, [slot][scope][0]; pipeline queries [slot][scope][counter] */
+	GLuint objects[PERF_COUNTER_FRAMES][PERF_COUNTER_SCOPES][PERF_COUNTER_MAX];
+	bool issued[PERF_COUNTER_FRAMES][PERF_COUNTER_SCOPES];
+	bool frameIssued[PERF_COUNTER_FRAMES];
+	unsigned int slot;	/* the slot of the current frame */
+	GLuint intelQuery;	/* the query kind */
+	GLuint dataSize;	/* of its results */
+	unsigned char *data;	/* the results read back */
+	unsigned int samples[PERF_COUNTER_SCOPES];	/* frames collected since the last report */
+	unsigned int dropped;	/* frames not ready in time */
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	/* Pick the counters in selection (see above) for scopes scopes.
+	* Returns true if at least one counter is sampled. */
+	bool init(const char *selection, int scopes)
+	{
+		bool list;
+
+		clear();
+		if (!selection)
+			return false;
+		list = !strcmp(selection, "list");
+		scopeCount = (scopes < PERF_COUNTER_SCOPES) ? scopes : PERF_COUNTER_SCOPES;
+		data = (unsigned char*)malloc(PERF_COUNTER_DATA);
+		if (!data) {
+			warn("perf counters: failed to allocate the results");
+			return false;
+		}
+		if (GLAD_GL_AMD_performance_monitor && glGenPerfMonitorsAMD)
+			backend = initAmd(selection, list);
+		else if (GLAD_GL_INTEL_performance_query && glCreatePerfQueryINTEL)
+			backend = initIntel(selection, list);
+		else if (GLAD_GL_ARB_pipeline_statistics_query)
+			backend = initPipeline(selection, list);
+		else
+			info("perf counters: neither GL_AMD_performance_monitor, GL_INTEL_performance_query "
+				"nor GL_ARB_pipeline_statistics_query is supported");
+		if (!count) {
+			if (!list)
+				warn("perf counters: none of '%s' found, try --perf-counters list", selection);
+			destroy();
+			return false;
+		}
+		createObjects();
+		for (int i = 0; i < count; i++)
+			info("perf counters: sampling '%s' per scope", counters[i].name);
+		reset();
+		GL_ERROR_DBG("perf counters initialization");
+		return true;
+	}
+
+	/* Add a counter unless there are enough. */
+	bool add(const char *name, GLuint group, GLuint counter, GLenum type)
+	{
+		if (count >= PERF_COUNTER_MAX) {
+			warn("perf counters: only %d counters at once, skipping '%s'", PERF_COUNTER_MAX, name);
+			return false;
+		}
+		PerfCounter *c = &counters[count++];
+		mysnprintf(c->name, sizeof(c->name), "%s", name);
+		c->group = group;
+		c->counter = counter;
+		c->type = type;
+		return true;
+	}
+
+	int initAmd(const char *selection, bool list)
+	{
+		GLint groupCount = 0, counterCount, maxActive;
+		GLuint *groups, *ids;
+		char group[PERF_COUNTER_NAME], name[PERF_COUNTER_NAME];
+		GLenum type;
+		int g, i;
+
+		glGetPerfMonitorGroupsAMD(&groupCount, 0, NULL);
+		groups = (GLuint*)malloc(sizeof(GLuint) * (groupCount > 0 ? groupCount : 1));
+		if (!groups)
+			return PERF_COUNTERS_AMD;
+		glGetPerfMonitorGroupsAMD(&groupCount, groupCount, groups);
+		for (g = 0; g < groupCount; g++) {
+			glGetPerfMonitorGroupStringAMD(groups[g], sizeof(group), NULL, group);
+			glGetPerfMonitorCountersAMD(groups[g], &counterCount, &maxActive, 0, NULL);
+			ids = (GLuint*)malloc(sizeof(GLuint) * (counterCount > 0 ? counterCount : 1));
+			if (!ids)
+				break;
+			glGetPerfMonitorCountersAMD(groups[g], &counterCount, &maxActive, counterCount, ids);
+			int active = 0;
+			for (i = 0; i < counterCount; i++) {
+				glGetPerfMonitorCounterStringAMD(groups[g], ids[i], sizeof(name), NULL, name);
+				if (list) {
+					info("perf counters: %s: %s", group, name);
+					continue;
+				}
+				if (active >= maxActive || perfCounterSelected(selection, name) < 0)
+					continue;
+				glGetPerfMonitorCounterInfoAMD(groups[g], ids[i], GL_COUNTER_TYPE_AMD, &type);
+				if (add(name, groups[g], ids[i], type))
+					active++;
+			}
+			free(ids);
+		}
+		free(groups);
+		return PERF_COUNTERS_AMD;
+	}
+
+	int initIntel(const char *selection, bool list)
+	{
+		char query[PERF_COUNTER_NAME], name[PERF_COUNTER_NAME], desc[8];
+		GLuint id = 0, next, size, counterCount, instances, caps, i;
+		GLuint offset, dataBytes, kind, dataType;
+		GLuint64 maxValue;
+
+		glGetFirstPerfQueryIdINTEL(&id);
+		for (; id; id = next) {
+			glGetPerfQueryInfoINTEL(id, sizeof(query), query, &size, &counterCount, &instances, &caps);
+			for (i = 1; i <= counterCount; i++) {
+				glGetPerfCounterInfoINTEL(id, i, sizeof(name), name, sizeof(desc), desc, &offset, &dataBytes,
+					&kind, &dataType, &maxValue);
+				if (list) {
+					info("perf counters: %s: %s", query, name);
+					continue;
+				}
+				/* the counters of the first kind with a chosen one */
+				if ((intelQuery && intelQuery != id) || perfCounterSelected(selection, name) < 0)
+					continue;
+				if (size > PERF_COUNTER_DATA) {
+					warn("perf counters: the results of '%s' take %u bytes, more than %d", query, size,
+						PERF_COUNTER_DATA);
+					break;
+				}
+				if (add(name, 0, offset, dataType)) {
+					intelQuery = id;
+					dataSize = size;
+				}
+			}
+			next = 0;
+			glGetNextPerfQueryIdINTEL(id, &next);
+		}
+		return PERF_COUNTERS_INTEL;
+	}
+
+	int initPipeline(const char *selection, bool list)
+	{
+		size_t i;
+		for (i = 0; i < sizeof(perfPipelineStatistics) / sizeof(perfPipelineStatistics[0]); i++) {
+			if (list)
+				info("perf counters: pipeline statistics: %s", perfPipelineStatistics[i].name);
+			else if (perfCounterSelected(selection, perfPipelineStatistics[i].name) >= 0)
+				add(perfPipelineStatistics[i].name, 0, perfPipelineStatistics[i].target, GL_UNSIGNED_INT64_ARB);
+		}
+		return PERF_COUNTERS_PIPELINE;
+	}
+
+	/* Create the monitors or queries of all slots and scopes. */
+	void createObjects()
+	{
+		int s, i, k;
+		for (s = 0; s < PERF_COUNTER_FRAMES; s++) {
+			for (i = 0; i < scopeCount; i++) {
+				GLuint *o = objects[s][i];
+				if (backend == PERF_COUNTERS_AMD) {
+					glGenPerfMonitorsAMD(1, o);
+					for (k = 0; k < count; k++)
+						glSelectPerfMonitorCountersAMD(o[0], GL_TRUE, counters[k].group, 1, &counters[k].counter);
+				} else if (backend == PERF_COUNTERS_INTEL) {
+					glCreatePerfQueryINTEL(intelQuery, o);
+				} else {
+					glGenQueries(count, o);
+				}
+			}
+		}
+	}
+
+	void destroy()
+	{
+		int s, i;
+		for (s = 0; s < PERF_COUNTER_FRAMES; s++)
+			for (i = 0; i < scopeCount && count; i++) {
+				if (backend == PERF_COUNTERS_AMD)
+					glDeletePerfMonitorsAMD(1, objects[s][i]);
+				else if (backend == PERF_COUNTERS_INTEL)
+					glDeletePerfQueryINTEL(objects[s][i][0]);
+				else if (backend == PERF_COUNTERS_PIPELINE)
+					glDeleteQueries(count, objects[s][i]);
+			}
+		free(data);
+		clear();
+	}
+
+	/* Clear the accumulated results. */
+	void reset()
+	{
+		int i, k;
+		for (i = 0; i < PERF_COUNTER_SCOPES; i++) {
+			samples[i] = 0;
+			for (k = 0; k < count; k++)
+				counters[k].sum[i] = 0.0;
+		}
+		dropped = 0;
+	}
+
+	/* Start a new frame: collect the results of the frame which used the
+	* next slot, if they are ready, and reuse its monitors or queries. */
+	void beginFrame()
+	{
+		int i;
+		if (!count)
+			return;
+		slot = (slot + 1) % PERF_COUNTER_FRAMES;
+		if (frameIssued[slot])
+			collect(slot);
+		frameIssued[slot] = true;
+		for (i = 0; i < scopeCount; i++)
+			issued[slot][i] = false;
+	}
+
+	/* Read back the results of scope i of slot s without waiting.
+	* Returns false if they are not ready yet. */
+	bool collectScope(unsigned int s, int i)
+	{
+		GLuint available = 0;
+		GLint written = 0;
+		GLuint bytes = 0;
+		int k;
+
+		if (backend == PERF_COUNTERS_AMD) {
+			glGetPerfMonitorCounterDataAMD(objects[s][i][0], GL_PERFMON_RESULT_AVAILABLE_AMD, sizeof(available),
+				&available, &written);
+			if (!available)
+				return false;
+			glGetPerfMonitorCounterDataAMD(objects[s][i][0], GL_PERFMON_RESULT_AMD, PERF_COUNTER_DATA,
+				(GLuint*)data, &written);
+			/* group, counter and the value, of the size of its type */
+			GLint w = 0, words = written / (GLint)sizeof(GLuint);
+			const GLuint *d = (const GLuint*)data;
+			while (w + 2 < words) {
+				PerfCounter *c = NULL;
+				for (k = 0; k < count && !c; k++)
+					if (counters[k].group == d[w] && counters[k].counter == d[w + 1])
+						c = &counters[k];
+				GLint size = c ? (GLint)(perfCounterSize(c->type) / sizeof(GLuint)) : 1;
+				if (c && w + 2 + size <= words)
+					c->sum[i] += perfCounterValue(c->type, &d[w + 2]);
+				w += 2 + size;
+			}
+		} else if (backend == PERF_COUNTERS_INTEL) {
+			glGetPerfQueryDataINTEL(objects[s][i][0], GL_PERFQUERY_DONOT_FLUSH_INTEL, (GLsizei)dataSize, data, &bytes);
+			if (!bytes)
+				return false;
+			for (k = 0; k < count; k++)
+				if (counters[k].counter + perfCounterSize(counters[k].type) <= bytes)
+					counters[k].sum[i] += perfCounterValue(counters[k].type, data + counters[k].counter);
+		} else {
+			GLint ready;
+			for (k = 0; k < count; k++) {
+				glGetQueryObjectiv(objects[s][i][k], GL_QUERY_RESULT_AVAILABLE, &ready);
+				if (!ready)
+					return false;
+			}
+			for (k = 0; k < count; k++) {
+				GLuint64 value;
+				glGetQueryObjectui64v(objects[s][i][k], GL_QUERY_RESULT, &value);
+				counters[k].sum[i] += (double)value;
+			}
+		}
+		samples[i]++;
+		return true;
+	}
+
+	/* Read back the results of frame slot s without waiting. */
+	void collect(unsigned int s)
+	{
+		int i;
+		for (i = 0; i < scopeCount; i++)
+			if (issued[s][i] && !collectScope(s, i))
+				dropped++;
+	}
+
+	/* Start sampling scope id. */
+	void begin(int id)
+	{
+		int k;
+		if (!count || id < 0 || id >= scopeCount)
+			return;
+		if (backend == PERF_COUNTERS_AMD)
+			glBeginPerfMonitorAMD(objects[slot][id][0]);
+		else if (backend == PERF_COUNTERS_INTEL)
+			glBeginPerfQueryINTEL(objects[slot][id][0]);
+		else
+			for (k = 0; k < count; k++)
+				glBeginQuery(counters[k].counter, objects[slot][id][k]);
+	}
+
+	/* Stop sampling scope id. */
+	void end(int id)
+	{
+		int k;
+		if (!count || id < 0 || id >= scopeCount)
+			return;
+		if (backend == PERF_COUNTERS_AMD)
+			glEndPerfMonitorAMD(objects[slot][id][0]);
+		else if (backend == PERF_COUNTERS_INTEL)
+			glEndPerfQueryINTEL(objects[slot][id][0]);
+		else
+			for (k = 0; k < count; k++)
+				glEndQuery(counters[k].counter);
+		issued[slot][id] = true;
+	}
+
+	/* Compute and log the averages per frame of the scopes called names
+	* since the last report, and start over. */
+	void report(const char * const *names)
+	{
+		char line[512];
+		int i, k, length;
+
+		if (!count)
+			return;
+		for (i = 0; i < scopeCount; i++) {
+			for (k = 0; k < count; k++)
+				counters[k].avg[i] = samples[i] ? counters[k].sum[i] / (double)samples[i] : -1.0;
+			if (!samples[i])
+				continue;
+			length = 0;
+			for (k = 0; k < count && length >= 0 && length < (int)sizeof(line); k++)
+				length += mysnprintf(line + length, sizeof(line) - length, "%s%s %.4g", k ? ", " : "",
+					counters[k].name, counters[k].avg[i]);
+			info("perf counters: %s: %s", names[i], line);
+		}
+		if (dropped)
+			info("perf counters: %u scopes not ready in time", dropped);
+		reset();
+	}
+} PerfCounters;
+
+#endif
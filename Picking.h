@@ -0,0 +1,353 @@
+#ifndef HEADER_PICKING_H
+#define HEADER_PICKING_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <string.h>
+#include "Entities.h"
+#include "FrameThrottle.h"
+#include "GLMemory.h"
+#include "GLState.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* PICKING: the object under the cursor from an ID target                   *
+****************************************************************************/
+
+/* Picking: instead of casting a ray through the BVH of the scene (see
+* Scene::pick), the main pass writes the entity id of the object each
+* pixel shows into a second target, an R32UI texture attached to the
+* offscreen framebuffer as GL_COLOR_ATTACHMENT1. The cube programs have a
+* variant per feature for it (PICKING, see shaders/cube.vs.glsl), which
+* read the id as the per-instance attribute instObject, like the material,
+* and only the draws of the scene turn the second target on, so nothing
+* else leaves ids behind. A click reads the pixels around the cursor, in a
+* square of 2 * PICKING_RADIUS + 1, into a pixel pack buffer with
+* glReadPixels right after the main pass, which does not wait for the GPU,
+* and a fence goes behind it. A frame or so later, once the fence has
+* signaled, the pixels are mapped and the id under the cursor, or the
+* nearest one around it, resolves through the generational table of the
+* entities, so an object removed meanwhile is not picked. The cost does not
+* depend on the scene at all.
+* With PICKING_SLOTS reads in flight, a click while all of them are waits
+* for the oldest one. The ids need a single sample per pixel. */
+#define PICKING_VS "shaders/cube.vs.glsl"
+#define PICKING_FS "shaders/cube.fs.glsl"
+#define PICKING_RADIUS 4	/* pixels around the cursor */
+#define PICKING_SIDE (2 * PICKING_RADIUS + 1)
+#define PICKING_SLOTS 3		/* reads in flight */
+
+/* the programs, by the features of the cube program they match */
+#define PICKING_CUT 1u
+#define PICKING_WOBBLE 2u
+#define PICKING_PATTERN 4u
+#define PICKING_VARIANTS 8
+#define PICKING_DEFINES 24u	/* INSTANCED and PICKING, in every variant */
+
+static const char *const pickingDefines[] = { "CUT", "WOBBLE", "PATTERN", "INSTANCED", "PICKING" };
+
+/* a read of the pixels around a click */
+typedef struct {
+	GLuint buffer;		/* GL_PIXEL_PACK_BUFFER of PICKING_SIDE^2 ids */
+	GLsync fence;		/* behind the read, 0 if the slot is free */
+	int width, height;	/* of the pixels read, clipped to the target */
+	int x, y;		/* of the cursor among them */
+	unsigned long long frame;	/* of the FrameThrottle, which read them */
+	unsigned long long cpuTime;	/* spent on the read, in ns */
+} PickingSlot;
+
+/* what collect() found */
+typedef struct {
+	EntityId id;		/* ECS_NO_ENTITY if there is no object */
+	int frames;		/* after the click */
+	double cpuMs;		/* spent on the click */
+} PickingResult;
+
+typedef struct {
+	bool enabled;
+	ShaderSourceCache *sources;
+	GLuint programs[PICKING_VARIANTS];	/* 0 until first used */
+	bool failed[PICKING_VARIANTS];		/* do not try to build them again */
+	GLuint ids;		/* GL_R32UI texture, the entity id per pixel */
+	GLuint fbo;		/* which it is attached to */
+	GLsizei width, height;	/* of ids */
+	PickingSlot slots[PICKING_SLOTS];
+	int nextSlot;
+	bool requested;		/* a click waits for the main pass */
+	float requestX, requestY;	/* -1 to 1 on screen */
+	bool written;		/* the ids of this frame */
+	unsigned int stalls;	/* clicks which waited for a read */
+
+	void clear()
+	{
+		enabled = false;
+		sources = NULL;
+		memset(programs, 0, sizeof(programs));
+		memset(failed, 0, sizeof(failed));
+		ids = fbo = 0;
+		width = height = 0;
+		memset(slots, 0, sizeof(slots));
+		nextSlot = 0;
+		requested = written = false;
+		requestX = requestY = 0.0f;
+		stalls = 0;
+	}
+
+	/* Remember where to load the programs from, they are built when first
+	* used. */
+	void init(ShaderSourceCache *cache)
+	{
+		clear();
+		sources = cache;
+	}
+
+	void destroy()
+	{
+		int i;
+		detach();
+		for (i = 0; i < PICKING_VARIANTS; i++)
+			if (programs[i])
+				glState()->deleteProgram(programs[i]);
+		for (i = 0; i < PICKING_SLOTS; i++) {
+			if (slots[i].fence)
+				glDeleteSync(slots[i].fence);
+			if (slots[i].buffer)
+				glState()->deleteBuffers(1, &slots[i].buffer);
+		}
+		clear();
+	}
+
+	/* Write the ids or not. The buffers of the reads are created the
+	* first time.
+	* Returns true if successfull and false in case of an error. */
+	bool setEnabled(bool enable)
+	{
+		int i;
+		MemoryScope scope(MEMORY_STAGING);
+
+		requested = written = false;
+		if (!enable) {
+			detach();
+			enabled = false;
+			return true;
+		}
+		for (i = 0; i < PICKING_SLOTS; i++) {
+			if (slots[i].buffer)
+				continue;
+			glGenBuffers(1, &slots[i].buffer);
+			glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].buffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint) * PICKING_SIDE * PICKING_SIDE, NULL, GL_STREAM_READ);
+			glDebugLabel(GL_BUFFER, slots[i].buffer, "picking read %d", i);
+		}
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		enabled = true;
+		return true;
+	}
+
+	/* Take the ids out of the framebuffer they are attached to and delete
+	* them. */
+	void detach()
+	{
+		if (!ids)
+			return;
+		if (fbo) {
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, 0, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		}
+		glState()->deleteTextures(1, &ids);
+		ids = fbo = 0;
+		width = height = 0;
+	}
+
+	/* Attach the ids to framebuffer, of w x h pixels and with a single
+	* sample, and clear them to ECS_NO_ENTITY, once per frame before the
+	* main pass. The framebuffer stays bound.
+	* Returns true if successfull and false in case of an error. */
+	bool attach(GLuint framebuffer, GLsizei w, GLsizei h)
+	{
+		static const GLuint none[4] = { ECS_NO_ENTITY, 0, 0, 0 };
+		MemoryScope scope(MEMORY_TARGETS);
+
+		written = false;
+		if (!enabled || !framebuffer)
+			return false;
+		if (framebuffer != fbo)
+			detach();
+		if (!ids) {
+			glGenTextures(1, &ids);
+			glDebugLabel(GL_TEXTURE, ids, "picking ids");
+		}
+		if (w != width || h != height || framebuffer != fbo) {
+			width = w;
+			height = h;
+			fbo = framebuffer;
+			glState()->bindTexture(GL_TEXTURE_2D, ids);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, ids, 0);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+				warn("picking: the ids do not fit FBO %u, turning it off", fbo);
+				setEnabled(false);
+				return false;
+			}
+			info("picking: %dx%d ids on FBO %u", (int)width, (int)height, fbo);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		begin();
+		glClearBufferuiv(GL_COLOR, 1, none);
+		end();
+		written = false;
+		GL_ERROR_DBG("picking attach");
+		return true;
+	}
+
+	/* Write the ids in the draws which follow, until end(). */
+	void begin()
+	{
+		static const GLenum both[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, both);
+		written = true;
+	}
+
+	void end()
+	{
+		static const GLenum color = GL_COLOR_ATTACHMENT0;
+		glDrawBuffers(1, &color);
+	}
+
+	/* The program of variant (PICKING_*), built when first used.
+	* Returns 0 if it failed to build. */
+	GLuint get(unsigned int variant)
+	{
+		if (!programs[variant] && !failed[variant]) {
+			programs[variant] = programBuild(sources, PICKING_VS, PICKING_FS, pickingDefines,
+				(int)(sizeof(pickingDefines) / sizeof(pickingDefines[0])), variant | PICKING_DEFINES);
+			if (!programs[variant]) {
+				warn("picking: the program for variant 0x%x failed to build", variant);
+				failed[variant] = true;
+				return 0;
+			}
+			info("picking: program %u for variant 0x%x", programs[variant], variant);
+		}
+		return programs[variant];
+	}
+
+	/* Pick what is at x, y, from -1 to 1 on screen, once this frame's ids
+	* are written. */
+	void request(float x, float y)
+	{
+		requested = true;
+		requestX = x;
+		requestY = y;
+	}
+
+	/* Read the pixels around the click of this frame, if there is one and
+	* the ids were written, after the main pass, which drew w x h pixels of
+	* them. This binds their framebuffer.
+	* Returns false if there was no read. */
+	bool read(GLsizei w, GLsizei h)
+	{
+		unsigned long long start;
+		PickingSlot *s;
+		int px, py, x0, y0;
+		PickingResult dropped;
+
+		if (!requested || !written)
+			return false;
+		requested = false;
+		start = profileNow();
+		s = &slots[nextSlot];
+		nextSlot = (nextSlot + 1) % PICKING_SLOTS;
+		/* all reads are in flight, the oldest has to be done now */
+		if (s->fence) {
+			stalls++;
+			if (collectSlot(s, true, &dropped))
+				warn("picking: a click came before the last one was done, dropping that");
+		}
+		w = glm::min(w, width);
+		h = glm::min(h, height);
+		px = (int)((requestX * 0.5f + 0.5f) * (float)w);
+		py = (int)((requestY * 0.5f + 0.5f) * (float)h);
+		x0 = glm::clamp(px - PICKING_RADIUS, 0, (int)w - 1);
+		y0 = glm::clamp(py - PICKING_RADIUS, 0, (int)h - 1);
+		s->width = glm::min(px + PICKING_RADIUS + 1, (int)w) - x0;
+		s->height = glm::min(py + PICKING_RADIUS + 1, (int)h) - y0;
+		s->x = px - x0;
+		s->y = py - y0;
+		if (s->width <= 0 || s->height <= 0)
+			return false;
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, s->buffer);
+		glReadBuffer(GL_COLOR_ATTACHMENT1);
+		glReadPixels(x0, y0, s->width, s->height, GL_RED_INTEGER, GL_UNSIGNED_INT, BUFFER_OFFSET(0));
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		s->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		s->frame = frameThrottle()->frame;
+		s->cpuTime = profileNow() - start;
+		GL_ERROR_DBG("picking read");
+		return true;
+	}
+
+	/* The result of the oldest read which is done, if there is one, in
+	* result. Call this once per frame, or until it returns false. */
+	bool collect(PickingResult *result)
+	{
+		int i;
+		for (i = 0; i < PICKING_SLOTS; i++) {
+			PickingSlot *s = &slots[(nextSlot + i) % PICKING_SLOTS];
+			if (s->fence && collectSlot(s, false, result))
+				return true;
+		}
+		return false;
+	}
+
+	/* Find the id nearest to the cursor among the pixels of slot s if its
+	* read is done, or after waiting for it if wait is set.
+	* Returns false if the read is not done yet or failed. */
+	bool collectSlot(PickingSlot *s, bool wait, PickingResult *result)
+	{
+		unsigned long long start = profileNow();
+		GLenum res = glClientWaitSync(s->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+		int x, y, best = -1;
+
+		if (res == GL_TIMEOUT_EXPIRED && !wait)
+			return false;
+		glDeleteSync(s->fence);
+		s->fence = 0;
+		if (res == GL_WAIT_FAILED || res == GL_TIMEOUT_EXPIRED) {
+			warn("picking: waiting for a read failed");
+			return false;
+		}
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, s->buffer);
+		const GLuint *pixels = (const GLuint*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+			(GLsizeiptr)(sizeof(GLuint) * s->width * s->height), GL_MAP_READ_BIT);
+		result->id = ECS_NO_ENTITY;
+		if (pixels) {
+			for (y = 0; y < s->height; y++)
+				for (x = 0; x < s->width; x++) {
+					int d = (x - s->x) * (x - s->x) + (y - s->y) * (y - s->y);
+					GLuint id = pixels[y * s->width + x];
+					if (id != ECS_NO_ENTITY && (best < 0 || d < best)) {
+						best = d;
+						result->id = id;
+					}
+				}
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		} else {
+			warn("picking: failed to map buffer %u", s->buffer);
+		}
+		glState()->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		result->frames = (int)(frameThrottle()->frame - s->frame);
+		result->cpuMs = (double)(s->cpuTime + profileNow() - start) * 1.0e-6;
+		return pixels != NULL;
+	}
+} Picking;
+
+#endif
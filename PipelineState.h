@@ -0,0 +1,223 @@
+#ifndef HEADER_PIPELINESTATE_H
+#define HEADER_PIPELINESTATE_H
+
+#include <glad/glad.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* PIPELINE STATE OBJECTS                                                   *
+****************************************************************************/
+
+/* PipelineStateCache: the complete state a draw needs besides its buffers
+* and textures, as immutable objects: the program (or pipeline in separable
+* mode), the VAO standing for the vertex format, the raster state (RASTER_*
+* in GLState.h: culling, depth writes and blending), the depth function and
+* the color writes, and which target it draws into. OpenGL has no such
+* object, and drivers compile the shaders again behind our back for the
+* state they find at the draw, which shows as a hitch the first time a
+* combination is drawn. So every state is
+*   created once, when the programs are loaded, and checked right then
+*   (linked, the pipeline complete, the attributes the vertex shader reads
+*   enabled in the VAO), instead of failing at the draw,
+*   prewarmed by prewarm(): one draw of each into its target, which covers
+*   no pixel since the scissor box is empty, but makes the driver build
+*   its variant of the shaders during the load,
+*   bound with a single bind(id), which goes through the state cache, so
+*   only what differs from the state before reaches the driver.
+* Equal states are created once and share their id. The ids stay valid
+* until clear(), which the application calls when the programs change.
+* States created after the last prewarm() are counted as late, since their
+* variant may be compiled at the draw. */
+#define PIPELINE_STATE_MAX 512
+
+/* where a state draws */
+#define PIPELINE_TARGET_SCENE 0	/* the render target of the frame */
+#define PIPELINE_TARGET_SHADOW 1	/* a depth-only map, see ShadowMaps.h */
+#define PIPELINE_TARGETS 2
+
+typedef struct {
+	GLuint program;		/* program, or pipeline in separable mode */
+	GLuint vao;
+	unsigned int raster;	/* RASTER_* flags */
+	GLenum depthFunc;
+	bool colorWrite;
+	int target;		/* PIPELINE_TARGET_* */
+	bool valid;		/* passed validate() */
+	bool warm;		/* drawn by prewarm() */
+} PipelineState;
+
+typedef struct {
+	PipelineState states[PIPELINE_STATE_MAX];
+	int count;
+	bool separable;		/* the programs are program pipelines */
+	bool loaded;		/* prewarm() ran, later states are late */
+	unsigned int late;	/* states created after prewarm() */
+	unsigned int invalid;	/* states which failed validate() */
+
+	void clear()
+	{
+		count = 0;
+		loaded = false;
+		late = invalid = 0;
+	}
+
+	/* Find the state equal to s. Returns its id, -1 if there is none. */
+	int find(const PipelineState *s) const
+	{
+		int i;
+		for (i = 0; i < count; i++) {
+			const PipelineState *t = &states[i];
+			if (t->program == s->program && t->vao == s->vao && t->raster == s->raster &&
+				t->depthFunc == s->depthFunc && t->colorWrite == s->colorWrite && t->target == s->target)
+				return i;
+		}
+		return -1;
+	}
+
+	/* Get the state of program with vertex array vao, raster flags,
+	* depthFunc and colorWrite, drawing into target, creating and
+	* validating it the first time.
+	* Returns its id, -1 if the cache is full. */
+	int create(GLuint program, GLuint vao, unsigned int raster, GLenum depthFunc, bool colorWrite, int target)
+	{
+		PipelineState s;
+		s.program = program;
+		s.vao = vao;
+		s.raster = raster;
+		s.depthFunc = depthFunc;
+		s.colorWrite = colorWrite;
+		s.target = target;
+		s.valid = false;
+		s.warm = false;
+		int id = find(&s);
+		if (id >= 0)
+			return id;
+		if (count >= PIPELINE_STATE_MAX) {
+			warn("pipeline states: more than %d", PIPELINE_STATE_MAX);
+			return -1;
+		}
+		s.valid = validate(&s);
+		if (!s.valid)
+			invalid++;
+		if (loaded && !late++)
+			warn("pipeline states: program %u with VAO %u was not prebuilt", program, vao);
+		states[count] = s;
+		return count++;
+	}
+
+	/* Check the state s: the program linked, or the pipeline has both
+	* stages, the raster flags do not contradict each other, and the VAO
+	* enables what the vertex shader reads; a disabled attribute reads the
+	* current value, which is legal, so that is only reported.
+	* Returns true if it can be drawn with. */
+	bool validate(const PipelineState *s) const
+	{
+		GLint status = 0, vs = 0, fs = 0;
+		GLuint vertex = s->program;
+
+		if (!s->program || !s->vao) {
+			warn("pipeline states: program %u with VAO %u is incomplete", s->program, s->vao);
+			return false;
+		}
+		if (separable) {
+			glGetProgramPipelineiv(s->program, GL_VERTEX_SHADER, &vs);
+			glGetProgramPipelineiv(s->program, GL_FRAGMENT_SHADER, &fs);
+			if (!vs || !fs) {
+				warn("pipeline states: pipeline %u lacks a stage", s->program);
+				return false;
+			}
+			vertex = (GLuint)vs;
+		} else {
+			glGetProgramiv(s->program, GL_LINK_STATUS, &status);
+			if (!status) {
+				warn("pipeline states: program %u is not linked", s->program);
+				return false;
+			}
+		}
+		if ((s->raster & RASTER_TRANSLUCENT) && (s->raster & RASTER_BLEND)) {
+			warn("pipeline states: program %u blends and is translucent", s->program);
+			return false;
+		}
+
+		GLint i, n = 0, size;
+		GLenum type;
+		char name[64];
+		glGetProgramiv(vertex, GL_ACTIVE_ATTRIBUTES, &n);
+		glState()->bindVertexArray(s->vao);
+		for (i = 0; i < n; i++) {
+			GLint enabled = 0;
+			glGetActiveAttrib(vertex, (GLuint)i, sizeof(name), NULL, &size, &type, name);
+			GLint location = glGetAttribLocation(vertex, name);
+			/* the built-in inputs have none */
+			if (location < 0)
+				continue;
+			glGetVertexAttribiv((GLuint)location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+			if (!enabled)
+				info("pipeline states: VAO %u does not feed '%s' of program %u", s->vao, name, s->program);
+		}
+		GL_ERROR_DBG("pipeline state validation");
+		return true;
+	}
+
+	/* Set state id, changing only what differs from the current state. */
+	void bind(int id)
+	{
+		const PipelineState *s = &states[id];
+		if (separable)
+			glState()->bindProgramPipeline(s->program);
+		else
+			glState()->useProgram(s->program);
+		glState()->bindVertexArray(s->vao);
+		glState()->depthFunc(s->depthFunc);
+		glState()->raster(s->raster);
+		GLboolean c = s->colorWrite ? GL_TRUE : GL_FALSE;
+		glState()->colorMask(c, c, c, c);
+	}
+
+	/* Draw every valid state which was not drawn yet once into its target
+	* of targets (framebuffer names, 0 is the default framebuffer, a
+	* target which is not complete is skipped), with an empty scissor box,
+	* so the driver builds the shaders for it now instead of at the first
+	* real draw. Afterwards the draw framebuffer is bound again and the
+	* raster state is back to RASTER_DEFAULT.
+	* Returns the number of states drawn. */
+	int prewarm(const GLuint targets[PIPELINE_TARGETS])
+	{
+		GLint framebuffer = 0;
+		int i, t, n = 0;
+
+		loaded = true;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+		glDebugPush("pipeline prewarm");
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(0, 0, 0, 0);
+		if (separable)
+			glState()->useProgram(0);
+		for (t = 0; t < PIPELINE_TARGETS; t++) {
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targets[t]);
+			bool complete = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+			for (i = 0; i < count; i++) {
+				PipelineState *s = &states[i];
+				if (s->target != t || s->warm || !s->valid || !complete)
+					continue;
+				bind(i);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+				s->warm = true;
+				n++;
+			}
+		}
+		glDisable(GL_SCISSOR_TEST);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)framebuffer);
+		glState()->depthFunc(GL_LESS);
+		glState()->raster(RASTER_DEFAULT);
+		glState()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glDebugPop();
+		GL_ERROR_DBG("pipeline prewarm");
+		if (n)
+			info("pipeline states: prebuilt %d of %d, %u invalid", n, count, invalid);
+		return n;
+	}
+} PipelineStateCache;
+
+#endif
@@ -0,0 +1,567 @@
+#ifndef HEADER_POSTPROCESS_H
+#define HEADER_POSTPROCESS_H
+
+#include <glad/glad.h>
+#include <math.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "RenderGraph.h"
+#include "RenderTarget.h"
+#include "DynamicResolution.h"
+#include "MipDownsampler.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* POST-PROCESSING                                                          *
+****************************************************************************/
+
+/* PostProcess: the passes between the scene and the window, as a
+* RenderGraph. The scene is rendered into a half float target; the tonemap
+* (shaders/tonemap.fs.glsl) maps it to the display range, FXAA
+* (shaders/fxaa.fs.glsl) smoothes the edges after that, and if the dynamic
+* resolution renders at less than the window size, its upscale stretches
+* the result over the window. Otherwise FXAA writes into the window right
+* away, so the graph has a single transient target. The passes draw a
+* full-screen triangle, like the raymarching program.
+* A multisampled scene is resolved and tonemapped in the same pass
+* (shaders/resolve_tonemap.fs.glsl), which reads the samples itself, so
+* the blit resolve of RenderTarget is not needed; the edges are then
+* anti-aliased already, and FXAA is skipped, as it is after the temporal
+* anti-aliasing of TemporalAA.h.
+* With bloom, the scene is taken down a mip chain of POST_BLOOM_LEVELS
+* levels, each half the size of the one above (shaders/bloom_down.fs.glsl),
+* and back up again, each level adding a blur of the one below to its own
+* (shaders/bloom_up.fs.glsl). So the blur grows to a sixteenth of the
+* screen, while all passes together cost less than two at the full size;
+* blurring at the full size instead would cost as much as the scene. The
+* tonemap blends the top of the chain into the scene.
+* Where the mip downsampler is available (see MipDownsampler.h), and
+* texture views (GL 4.3), the chain is the levels of one texture instead:
+* the first level is still drawn from the scene by the 13 taps, which keep
+* single bright pixels from blinking, but the others are the averages of
+* 2x2 texels, all from a single dispatch rather than a pass each. The up
+* passes read the levels through views of one level each.
+* The auto exposure counts the luminance of the first level of the same
+* chain into a histogram with a compute shader (shaders/histogram.cs.glsl),
+* and a second one (shaders/exposure.cs.glsl) moves the exposure towards
+* the one which maps the mean to middle gray, at POST_EXPOSURE_RATE per
+* second, into a texel the tonemap reads. So neither the frame nor the
+* exposure come back to the CPU. The exposure set by hand scales it. */
+#define POST_VS "shaders/raymarch.vs.glsl"
+#define POST_TONEMAP_FS "shaders/tonemap.fs.glsl"
+#define POST_FXAA_FS "shaders/fxaa.fs.glsl"
+#define POST_RESOLVE_FS "shaders/resolve_tonemap.fs.glsl"
+#define POST_SCENE_FORMAT GL_RGBA16F
+#define POST_EXPOSURE 1.0f
+#define POST_BLOOM_DOWN_FS "shaders/bloom_down.fs.glsl"
+#define POST_BLOOM_UP_FS "shaders/bloom_up.fs.glsl"
+#define POST_HISTOGRAM_CS "shaders/histogram.cs.glsl"
+#define POST_EXPOSURE_CS "shaders/exposure.cs.glsl"
+#define POST_BLOOM_LEVELS 5
+#define POST_BLOOM_FORMAT GL_R11F_G11F_B10F
+#define POST_BLOOM_STRENGTH 0.05f	/* of the bloom in the tonemapped color */
+#define POST_HISTOGRAM_BINS 64		/* also in the shaders */
+#define POST_HISTOGRAM_GROUP 16		/* pixels per side of a work group */
+#define POST_HISTOGRAM_BINDING 0	/* of the bins, during the exposure pass */
+#define POST_EXPOSURE_RATE 1.5		/* per second */
+
+/* the texture units of the tonemap */
+#define POST_BLOOM_UNIT 1
+#define POST_EXPOSURE_UNIT 2
+
+/* the programs of the bloom */
+enum {
+	POST_BLOOM_FIRST = 0,	/* down from the scene */
+	POST_BLOOM_FIRST_SAMPLES,	/* down from the samples of a multisampled one */
+	POST_BLOOM_DOWN,
+	POST_BLOOM_UP,
+	POST_BLOOM_PROGRAMS
+};
+
+static const char *const postBloomDefines[] = { "FIRST", "MULTISAMPLE" };
+static const char *const postBloomDownNames[POST_BLOOM_LEVELS] = {
+	"bloom down 1", "bloom down 2", "bloom down 3", "bloom down 4", "bloom down 5"
+};
+static const char *const postBloomUpNames[POST_BLOOM_LEVELS] = {
+	"bloom up 1", "bloom up 2", "bloom up 3", "bloom up 4", "bloom up 5"
+};
+
+typedef struct PostProcess {
+	bool enabled;
+	bool fxaa;		/* smooth the edges */
+	bool temporal;		/* the scene comes anti-aliased from TemporalAA.h */
+	float exposure;		/* scale of the linear scene colors before the tonemap */
+	bool bloom;		/* blend a blur of the bright parts in */
+	float bloomStrength;
+	bool autoExposure;	/* adapt the exposure to the luminance of the frames */
+	GLuint tonemapProgram, fxaaProgram;	/* 0 if not available */
+	GLuint resolveProgram;	/* 0 if not available, then the samples are blitted */
+	GLint exposureLoc, sourceSizeLoc, resolveExposureLoc, sampleCountLoc;
+	GLint bloomMixLoc, autoExposureLoc, resolveBloomMixLoc, resolveAutoExposureLoc;
+	GLuint bloomPrograms[POST_BLOOM_PROGRAMS];	/* 0 if not available */
+	GLint bloomSizeLocs[POST_BLOOM_PROGRAMS];
+	GLuint bloomChain;	/* the levels of the single pass, 0 if not allocated */
+	GLuint bloomViews[POST_BLOOM_LEVELS];	/* a level of bloomChain each */
+	GLuint bloomFbo;	/* with the first level attached */
+	GLsizei bloomWidth, bloomHeight;	/* of the first level */
+	GLuint histogramProgram, exposureProgram;	/* 0 without compute shaders */
+	GLint adaptationLoc;
+	GLuint histogramBuffer;	/* POST_HISTOGRAM_BINS counts */
+	GLuint exposureTexture;	/* 1x1 GL_R32F, the adapted exposure */
+	double exposureTime;	/* profileSeconds() of the last adaptation, 0 before the first */
+	GLuint vao;		/* empty, for the full-screen triangle */
+	DynamicResolution *resolution;	/* upscales, while executing */
+	GLsizei samples;	/* per pixel of the scene, while executing */
+	bool resolving;		/* the first pass reads the samples, while executing */
+	int bloomInput, exposureInput;	/* of the tonemap pass, -1 if none, while executing */
+	RenderGraph graph;
+
+	void clear()
+	{
+		enabled = false;
+		fxaa = true;
+		temporal = false;
+		exposure = POST_EXPOSURE;
+		bloom = false;
+		bloomStrength = POST_BLOOM_STRENGTH;
+		autoExposure = false;
+		tonemapProgram = fxaaProgram = resolveProgram = vao = 0;
+		memset(bloomPrograms, 0, sizeof(bloomPrograms));
+		bloomChain = bloomFbo = 0;
+		memset(bloomViews, 0, sizeof(bloomViews));
+		bloomWidth = bloomHeight = 0;
+		histogramProgram = exposureProgram = histogramBuffer = exposureTexture = 0;
+		exposureTime = 0.0;
+		resolution = NULL;
+		samples = 1;
+		resolving = false;
+		bloomInput = exposureInput = -1;
+		graph.init();
+	}
+
+	/* Build the programs, sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		tonemapProgram = programBuild(cache, POST_VS, POST_TONEMAP_FS);
+		fxaaProgram = programBuild(cache, POST_VS, POST_FXAA_FS);
+		if (!tonemapProgram || !fxaaProgram) {
+			destroy();
+			return false;
+		}
+		exposureLoc = glGetUniformLocation(tonemapProgram, "exposure");
+		bloomMixLoc = glGetUniformLocation(tonemapProgram, "bloomMix");
+		autoExposureLoc = glGetUniformLocation(tonemapProgram, "autoExposure");
+		sourceSizeLoc = glGetUniformLocation(fxaaProgram, "sourceSize");
+		glState()->useProgram(tonemapProgram);
+		glUniform1i(glGetUniformLocation(tonemapProgram, "source"), 0);
+		glUniform1i(glGetUniformLocation(tonemapProgram, "bloom"), POST_BLOOM_UNIT);
+		glUniform1i(glGetUniformLocation(tonemapProgram, "adaptedExposure"), POST_EXPOSURE_UNIT);
+		glState()->useProgram(fxaaProgram);
+		glUniform1i(glGetUniformLocation(fxaaProgram, "source"), 0);
+		resolveProgram = programBuild(cache, POST_VS, POST_RESOLVE_FS);
+		if (resolveProgram) {
+			resolveExposureLoc = glGetUniformLocation(resolveProgram, "exposure");
+			resolveBloomMixLoc = glGetUniformLocation(resolveProgram, "bloomMix");
+			resolveAutoExposureLoc = glGetUniformLocation(resolveProgram, "autoExposure");
+			sampleCountLoc = glGetUniformLocation(resolveProgram, "sampleCount");
+			glState()->useProgram(resolveProgram);
+			glUniform1i(glGetUniformLocation(resolveProgram, "samples"), 0);
+			glUniform1i(glGetUniformLocation(resolveProgram, "bloom"), POST_BLOOM_UNIT);
+			glUniform1i(glGetUniformLocation(resolveProgram, "adaptedExposure"), POST_EXPOSURE_UNIT);
+		}
+		initBloom(cache);
+		initExposure(cache);
+		glState()->useProgram(0);
+		glGenVertexArrays(1, &vao);
+		info("post-processing: tonemap program %u, FXAA program %u", tonemapProgram, fxaaProgram);
+		return true;
+	}
+
+	/* Build the programs of the bloom; without them there is none. */
+	void initBloom(ShaderSourceCache *cache)
+	{
+		int i;
+		bloomPrograms[POST_BLOOM_FIRST] = programBuild(cache, POST_VS, POST_BLOOM_DOWN_FS, postBloomDefines, 2, 1u);
+		bloomPrograms[POST_BLOOM_FIRST_SAMPLES] = programBuild(cache, POST_VS, POST_BLOOM_DOWN_FS,
+			postBloomDefines, 2, 3u);
+		bloomPrograms[POST_BLOOM_DOWN] = programBuild(cache, POST_VS, POST_BLOOM_DOWN_FS);
+		bloomPrograms[POST_BLOOM_UP] = programBuild(cache, POST_VS, POST_BLOOM_UP_FS);
+		for (i = 0; i < POST_BLOOM_PROGRAMS; i++) {
+			if (!bloomPrograms[i]) {
+				info("post-processing: bloom not available");
+				destroyBloom();
+				return;
+			}
+			bloomSizeLocs[i] = glGetUniformLocation(bloomPrograms[i], "sourceSize");
+			glState()->useProgram(bloomPrograms[i]);
+			glUniform1i(glGetUniformLocation(bloomPrograms[i], "source"), 0);
+		}
+		glState()->useProgram(bloomPrograms[POST_BLOOM_UP]);
+		glUniform1i(glGetUniformLocation(bloomPrograms[POST_BLOOM_UP], "base"), 1);
+	}
+
+	void destroyBloom()
+	{
+		int i;
+		for (i = 0; i < POST_BLOOM_PROGRAMS; i++) {
+			if (bloomPrograms[i])
+				glState()->deleteProgram(bloomPrograms[i]);
+			bloomPrograms[i] = 0;
+		}
+		destroyBloomChain();
+	}
+
+	/* Returns true if the bloom chain is built in a single pass. */
+	bool bloomSinglePass() const
+	{
+		return mipDownsampler()->available() && glTextureView && glCaps()->version(4, 3);
+	}
+
+	/* (Re-)allocate the texture of the single pass for a first level of
+	* w x h texels if the size changed.
+	* Returns true if successfull and false in case of an error. */
+	bool resizeBloomChain(GLsizei w, GLsizei h)
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		int i;
+		if (bloomChain && w == bloomWidth && h == bloomHeight)
+			return true;
+		destroyBloomChain();
+		glGenTextures(1, &bloomChain);
+		glState()->bindTexture(GL_TEXTURE_2D, bloomChain);
+		glTexStorage2D(GL_TEXTURE_2D, POST_BLOOM_LEVELS, POST_BLOOM_FORMAT, w, h);
+		glGenTextures(POST_BLOOM_LEVELS, bloomViews);
+		for (i = 0; i < POST_BLOOM_LEVELS; i++) {
+			glTextureView(bloomViews[i], GL_TEXTURE_2D, bloomChain, POST_BLOOM_FORMAT, i, 1, 0, 1);
+			glState()->bindTexture(GL_TEXTURE_2D, bloomViews[i]);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glGenFramebuffers(1, &bloomFbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, bloomFbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bloomChain, 0);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE) {
+			warn("post-processing: bloom FBO %u is incomplete: 0x%x", bloomFbo, (unsigned)status);
+			destroyBloomChain();
+			return false;
+		}
+		bloomWidth = w;
+		bloomHeight = h;
+		return true;
+	}
+
+	void destroyBloomChain()
+	{
+		if (bloomFbo)
+			glDeleteFramebuffers(1, &bloomFbo);
+		if (bloomViews[0])
+			glState()->deleteTextures(POST_BLOOM_LEVELS, bloomViews);
+		if (bloomChain)
+			glState()->deleteTextures(1, &bloomChain);
+		bloomChain = bloomFbo = 0;
+		memset(bloomViews, 0, sizeof(bloomViews));
+		bloomWidth = bloomHeight = 0;
+	}
+
+	/* Build the programs and the objects of the auto exposure, which
+	* needs compute shaders. */
+	void initExposure(ShaderSourceCache *cache)
+	{
+		static const GLuint zeros[POST_HISTOGRAM_BINS] = { 0 };
+		static const GLfloat one = 1.0f;
+		MemoryScope scope(MEMORY_TARGETS);
+
+		if (!computeShaderSupported() || !glBindImageTexture)
+			return;
+		histogramProgram = computeProgramBuild(cache, POST_HISTOGRAM_CS);
+		exposureProgram = computeProgramBuild(cache, POST_EXPOSURE_CS);
+		if (!histogramProgram || !exposureProgram || !bloomPrograms[POST_BLOOM_FIRST]) {
+			info("post-processing: auto exposure not available");
+			destroyExposure();
+			return;
+		}
+		adaptationLoc = glGetUniformLocation(exposureProgram, "adaptation");
+		glState()->useProgram(histogramProgram);
+		glUniform1i(glGetUniformLocation(histogramProgram, "source"), 0);
+		glGenBuffers(1, &histogramBuffer);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, histogramBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zeros), zeros, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glGenTextures(1, &exposureTexture);
+		glState()->bindTexture(GL_TEXTURE_2D, exposureTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, 1, 1, 0, GL_RED, GL_FLOAT, &one);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void destroyExposure()
+	{
+		if (histogramProgram)
+			glState()->deleteProgram(histogramProgram);
+		if (exposureProgram)
+			glState()->deleteProgram(exposureProgram);
+		if (histogramBuffer)
+			glState()->deleteBuffers(1, &histogramBuffer);
+		if (exposureTexture)
+			glState()->deleteTextures(1, &exposureTexture);
+		histogramProgram = exposureProgram = histogramBuffer = exposureTexture = 0;
+	}
+
+	/* Turn the bloom on or off.
+	* Returns false if it is not available. */
+	bool setBloom(bool enable)
+	{
+		bloom = enable && bloomPrograms[POST_BLOOM_FIRST];
+		return bloom == enable;
+	}
+
+	/* Turn the auto exposure on or off, starting over from the exposure
+	* of the first frame.
+	* Returns false if it is not available. */
+	bool setAutoExposure(bool enable)
+	{
+		autoExposure = enable && exposureProgram;
+		exposureTime = 0.0;
+		return autoExposure == enable;
+	}
+
+	void destroy()
+	{
+		graph.destroy();
+		if (tonemapProgram)
+			glState()->deleteProgram(tonemapProgram);
+		if (fxaaProgram)
+			glState()->deleteProgram(fxaaProgram);
+		if (resolveProgram)
+			glState()->deleteProgram(resolveProgram);
+		destroyBloom();
+		destroyExposure();
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		clear();
+	}
+
+	/* Draw the full-screen triangle with program and the first input of p. */
+	void drawPass(GLuint program, const RenderPass *p)
+	{
+		glState()->useProgram(program);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[0]);
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+	}
+
+	/* Bind the bloom and the exposure of the tonemap pass p, and set the
+	* uniforms of the program in use saying which it has. */
+	void bindTonemapInputs(const RenderPass *p, GLint mixLoc, GLint autoLoc)
+	{
+		float strength = (bloomInput >= 0) ? bloomStrength : 0.0f;
+		/* the top of the chain adds up all levels */
+		glUniform2f(mixLoc, 1.0f - strength, strength / (float)POST_BLOOM_LEVELS);
+		glUniform1i(autoLoc, exposureInput >= 0);
+		if (bloomInput >= 0) {
+			glState()->activeTexture(GL_TEXTURE0 + POST_BLOOM_UNIT);
+			glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[bloomInput]);
+		}
+		if (exposureInput >= 0) {
+			glState()->activeTexture(GL_TEXTURE0 + POST_EXPOSURE_UNIT);
+			glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[exposureInput]);
+		}
+	}
+
+	static void runTonemap(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		glState()->useProgram(post->tonemapProgram);
+		glUniform1f(post->exposureLoc, post->exposure);
+		post->bindTonemapInputs(p, post->bloomMixLoc, post->autoExposureLoc);
+		post->drawPass(post->tonemapProgram, p);
+	}
+
+	static void runResolve(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		glState()->useProgram(post->resolveProgram);
+		glUniform1f(post->resolveExposureLoc, post->exposure);
+		glUniform1i(post->sampleCountLoc, (GLint)post->samples);
+		post->bindTonemapInputs(p, post->resolveBloomMixLoc, post->resolveAutoExposureLoc);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, p->inputTextures[0]);
+		glState()->bindVertexArray(post->vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+	}
+
+	static void runFxaa(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		glState()->useProgram(post->fxaaProgram);
+		/* FXAA keeps the size, so the input has that of the output */
+		glUniform2f(post->sourceSizeLoc, (GLfloat)p->width, (GLfloat)p->height);
+		post->drawPass(post->fxaaProgram, p);
+	}
+
+	/* A step down the bloom chain, the first one from the scene. */
+	static void runBloomDown(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		const RenderResource *src = &post->graph.resources[p->inputs[0]];
+		int program = !src->imported ? POST_BLOOM_DOWN : post->resolving ? POST_BLOOM_FIRST_SAMPLES : POST_BLOOM_FIRST;
+		glState()->useProgram(post->bloomPrograms[program]);
+		glUniform2f(post->bloomSizeLocs[program], (GLfloat)src->width, (GLfloat)src->height);
+		if (program == POST_BLOOM_FIRST_SAMPLES) {
+			glState()->activeTexture(GL_TEXTURE0);
+			glState()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, p->inputTextures[0]);
+			glState()->bindVertexArray(post->vao);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			glState()->countDraw();
+			return;
+		}
+		post->drawPass(post->bloomPrograms[program], p);
+	}
+
+	/* The rest of the bloom chain from its first level, in a single pass. */
+	static void runBloomChain(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		(void)p;
+		mipDownsampler()->reduce(post->bloomChain, POST_BLOOM_FORMAT, post->bloomWidth, post->bloomHeight, 1,
+			POST_BLOOM_LEVELS - 1, MIP_AVERAGE);
+	}
+
+	/* A step up the bloom chain: the level below, then this one. */
+	static void runBloomUp(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		const RenderResource *src = &post->graph.resources[p->inputs[0]];
+		GLuint program = post->bloomPrograms[POST_BLOOM_UP];
+		glState()->useProgram(program);
+		glUniform2f(post->bloomSizeLocs[POST_BLOOM_UP], (GLfloat)src->width, (GLfloat)src->height);
+		glState()->activeTexture(GL_TEXTURE1);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[1]);
+		post->drawPass(program, p);
+	}
+
+	/* The histogram of the first level of the bloom chain, and the
+	* exposure adapted to it, into the output texture. */
+	static void runExposure(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		const RenderResource *src = &post->graph.resources[p->inputs[0]];
+		double now = profileSeconds();
+		float adaptation = post->exposureTime > 0.0 ?
+			(float)(1.0 - exp(-POST_EXPOSURE_RATE * (now - post->exposureTime))) : 1.0f;
+		post->exposureTime = now;
+
+		/* the bins and the exposure of the last frame are written */
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, POST_HISTOGRAM_BINDING, post->histogramBuffer);
+		glState()->useProgram(post->histogramProgram);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, p->inputTextures[0]);
+		glDispatchCompute((GLuint)(src->width + POST_HISTOGRAM_GROUP - 1) / POST_HISTOGRAM_GROUP,
+			(GLuint)(src->height + POST_HISTOGRAM_GROUP - 1) / POST_HISTOGRAM_GROUP, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		glState()->useProgram(post->exposureProgram);
+		glUniform1f(post->adaptationLoc, adaptation);
+		glBindImageTexture(0, p->outputTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32F);
+		glDispatchCompute(1, 1, 1);
+	}
+
+	static void runUpscale(void *object, const RenderPass *p)
+	{
+		PostProcess *post = (PostProcess*)object;
+		const RenderResource *src = &post->graph.resources[p->inputs[0]];
+		post->resolution->draw(p->inputTextures[0], src->width, src->height);
+	}
+
+	/* Whether executing resolves the samples of scene itself. */
+	bool resolves(const RenderTarget *scene) const
+	{
+		return enabled && resolveProgram && scene->samples > 1;
+	}
+
+	/* Process the color of scene into the default framebuffer of size w x h
+	* and make that the current framebuffer again. Upscaling uses res.
+	* Returns true if successfull and false in case of an error. */
+	bool execute(const RenderTarget *scene, GLsizei w, GLsizei h, DynamicResolution *res)
+	{
+		GLsizei sw = scene->width, sh = scene->height;
+		bool upscale = sw != w || sh != h;
+		bool resolve = resolves(scene);
+		bool smooth = fxaa && !temporal && scene->samples < 2;
+		/* the auto exposure shares the first level of the bloom chain */
+		int levels = bloom ? POST_BLOOM_LEVELS : autoExposure ? 1 : 0;
+		int tonemapInputs[3], inputCount = 0, i;
+
+		GL_DEBUG_GROUP("post-processing");
+		resolution = res;
+		samples = scene->samples;
+		resolving = resolve;
+		graph.begin();
+		int color = resolve ? graph.import("samples", scene->sampleColor, scene->fbo, sw, sh) :
+			graph.import("scene", scene->color, scene->resolveFbo ? scene->resolveFbo : scene->fbo, sw, sh);
+		int window = graph.import("window", 0, 0, w, h);
+		int display = graph.create("tonemapped", GL_RGBA8, sw, sh);
+		int down[POST_BLOOM_LEVELS] = { 0 };
+		bool singlePass = bloom && bloomSinglePass() &&
+			resizeBloomChain(mipLevelSize(sw, 1), mipLevelSize(sh, 1));
+		for (i = 0; i < levels; i++) {
+			GLsizei lw = (sw >> (i + 1)) > 0 ? sw >> (i + 1) : 1;
+			GLsizei lh = (sh >> (i + 1)) > 0 ? sh >> (i + 1) : 1;
+			if (singlePass) {
+				down[i] = graph.import(postBloomDownNames[i], bloomViews[i], i ? 0 : bloomFbo, lw, lh);
+				if (!i)
+					graph.addPass(postBloomDownNames[i], runBloomDown, this, 0, &color, 1, down[i]);
+				continue;
+			}
+			down[i] = graph.create(postBloomDownNames[i], POST_BLOOM_FORMAT, lw, lh);
+			graph.addPass(postBloomDownNames[i], runBloomDown, this, 0, i ? &down[i - 1] : &color, 1, down[i]);
+		}
+		/* the levels of the single pass have no passes of their own, the
+		* up passes start after the pass writing the last one */
+		if (singlePass)
+			graph.addPass("bloom chain", runBloomChain, this, RENDER_PASS_IMAGE_STORE, &down[0], 1, down[levels - 1]);
+		tonemapInputs[inputCount++] = color;
+		bloomInput = exposureInput = -1;
+		if (bloom) {
+			int up = down[levels - 1];
+			for (i = levels - 2; i >= 0; i--) {
+				const RenderResource *r = &graph.resources[down[i]];
+				int inputs[2] = { up, down[i] };
+				up = graph.create(postBloomUpNames[i], POST_BLOOM_FORMAT, r->width, r->height);
+				graph.addPass(postBloomUpNames[i], runBloomUp, this, 0, inputs, 2, up);
+			}
+			bloomInput = inputCount;
+			tonemapInputs[inputCount++] = up;
+		}
+		if (autoExposure) {
+			int adapted = graph.import("exposure", exposureTexture, 0, 1, 1);
+			graph.addPass("exposure", runExposure, this, RENDER_PASS_IMAGE_STORE, &down[0], 1, adapted);
+			exposureInput = inputCount;
+			tonemapInputs[inputCount++] = adapted;
+		}
+		graph.addPass(resolve ? "resolve" : "tonemap", resolve ? runResolve : runTonemap, this, 0,
+			tonemapInputs, inputCount, (smooth || upscale) ? display : window);
+		if (smooth) {
+			int smooth = upscale ? graph.create("antialiased", GL_RGBA8, sw, sh) : window;
+			graph.addPass("fxaa", runFxaa, this, 0, &display, 1, smooth);
+			display = smooth;
+		}
+		if (upscale)
+			graph.addPass("upscale", runUpscale, this, 0, &display, 1, window);
+		return graph.execute();
+	}
+} PostProcess;
+
+#endif
@@ -0,0 +1,332 @@
+#ifndef HEADER_PROFILER_H
+#define HEADER_PROFILER_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include "Log.h"
+
+/****************************************************************************
+* CPU PROFILER: nested zones per thread, exported as a Chrome trace        *
+****************************************************************************/
+
+/* PROFILE_ZONE(name) measures the rest of the enclosing block as a zone
+* called name, a string literal: it takes the time when it starts and when
+* the block is left, and records both with how deep it is nested into a
+* ring of the thread it runs on. Each thread has a ring of its own, which
+* only that thread writes, so recording a zone takes no lock and touches
+* no shared cache line; PROFILE_THREAD(format, ...) names the ring of the
+* calling thread, the others are called by their index. The rings keep the last
+* PROFILE_EVENTS zones of each thread, and profileExport() writes all of
+* them as a Chrome trace (JSON, "X" events), which chrome://tracing and
+* ui.perfetto.dev open, the threads one above the other on the same time
+* line. It may run on any thread while the others go on recording: what
+* they overwrite meanwhile is left out.
+* GpuProfiler adds the times of its scopes as the zones of a track "GPU",
+* moved onto the clock of the CPU zones by the offset between the two
+* clocks it measures now and then, so the GPU work lines up with the frame
+* which submitted it.
+* profileExport() can also leave out the zones which ended before some
+* time, so the flight recorder (FlightRecorder.h) writes just the last
+* seconds around a slow frame.
+* profileCounter() records a value over time instead, e.g. the clocks and
+* the power of Telemetry.h; the export writes those as counter tracks
+* ("C" events), which the viewers draw as graphs above the threads. The
+* counters share one ring, which only one thread may write.
+* The zones are only compiled in with PROFILE_ZONES defined (make
+* PROFILE=1); otherwise the macros are empty and there is nothing to
+* export. The clock is std::chrono::steady_clock, in nanoseconds. */
+#define PROFILE_MAX_THREADS 64	/* rings, the GPU track included */
+#define PROFILE_EVENTS 32768	/* zones per ring, a power of two */
+#define PROFILE_NAME_MAX 32	/* bytes of the name of a thread */
+#define PROFILE_COUNTER_EVENTS 16384	/* values of all counters, a power of two */
+
+typedef struct {
+	const char *name;	/* of the zone, see PROFILE_ZONE */
+	unsigned long long begin, end;	/* profileNow() */
+	int depth;		/* of the zones open around it */
+} ProfileEvent;
+
+/* the ring of a thread, written only by that thread */
+typedef struct {
+	char name[PROFILE_NAME_MAX];
+	ProfileEvent events[PROFILE_EVENTS];
+	std::atomic<unsigned int> head;	/* zones recorded, the newest at head - 1 */
+	int depth;		/* of the zones open right now */
+
+	/* Append a zone, overwriting the oldest once the ring is full. */
+	void record(const char *zone, unsigned long long begin, unsigned long long end, int level)
+	{
+		unsigned int h = head.load(std::memory_order_relaxed);
+		ProfileEvent *e = &events[h & (PROFILE_EVENTS - 1)];
+		e->name = zone;
+		e->begin = begin;
+		e->end = end;
+		e->depth = level;
+		head.store(h + 1, std::memory_order_release);
+	}
+} ProfileThread;
+
+/* all rings, for the export */
+typedef struct {
+	std::atomic<ProfileThread*> threads[PROFILE_MAX_THREADS];	/* NULL until set up */
+	std::atomic<int> count;		/* slots taken */
+} ProfileRegistry;
+
+/* The registry of the application, shared by all translation units like
+* logSink(). */
+inline ProfileRegistry *profileRegistry()
+{
+	/* zero-initialized, as a static */
+	static ProfileRegistry registry;
+	return &registry;
+}
+
+typedef struct {
+	const char *name;	/* of the counter, a string literal */
+	unsigned long long time;	/* profileNow() */
+	double value;
+} ProfileCounterEvent;
+
+/* the values of the counters, written by a single thread */
+typedef struct {
+	ProfileCounterEvent events[PROFILE_COUNTER_EVENTS];
+	std::atomic<unsigned int> head;	/* values recorded, the newest at head - 1 */
+} ProfileCounterRing;
+
+inline ProfileCounterRing *profileCounters()
+{
+	/* zero-initialized, as a static */
+	static ProfileCounterRing ring;
+	return &ring;
+}
+
+/* Now, in nanoseconds. */
+inline unsigned long long profileNow()
+{
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Now, in seconds since the first call: the clock of the frame loop and of
+* the input events. Unlike glfwGetTime it runs without GLFW, e.g. with the
+* headless context of HeadlessContext.h. */
+inline double profileSeconds()
+{
+	static const unsigned long long origin = profileNow();
+	return (double)(profileNow() - origin) * 1e-9;
+}
+
+/* A new ring called name, registered for the export. The rings live as
+* long as the application.
+* Returns NULL if there are PROFILE_MAX_THREADS already. */
+inline ProfileThread *profileCreateRing(const char *name)
+{
+	ProfileRegistry *r = profileRegistry();
+	int index = r->count.load(std::memory_order_relaxed);
+	do {
+		if (index >= PROFILE_MAX_THREADS)
+			return NULL;
+	} while (!r->count.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+	ProfileThread *t = new ProfileThread;
+	snprintf(t->name, sizeof(t->name), "%s", name);
+	t->head.store(0, std::memory_order_relaxed);
+	t->depth = 0;
+	/* the export skips the slot until it is set */
+	r->threads[index].store(t, std::memory_order_release);
+	return t;
+}
+
+/* The ring of the calling thread, created on first use. */
+inline ProfileThread *profileThread()
+{
+	static thread_local ProfileThread *ring = NULL;
+	if (!ring) {
+		char name[PROFILE_NAME_MAX];
+		snprintf(name, sizeof(name), "thread %d", profileRegistry()->count.load(std::memory_order_relaxed));
+		ring = profileCreateRing(name);
+	}
+	return ring;
+}
+
+/* Name the ring of the calling thread, use printf syntax. */
+inline void profileSetThreadName(const char *format, ...)
+{
+	ProfileThread *t = profileThread();
+	va_list args;
+	if (!t)
+		return;
+	va_start(args, format);
+	vsnprintf(t->name, sizeof(t->name), format, args);
+	va_end(args);
+}
+
+/* The track of the GPU scopes, only GpuProfiler writes it. */
+inline ProfileThread *profileGpuTrack()
+{
+	static ProfileThread *track = profileCreateRing("GPU");
+	return track;
+}
+
+/* Record a zone of the GPU track, begin and end already on the clock of
+* profileNow(). */
+inline void profileGpuZone(const char *name, unsigned long long begin, unsigned long long end)
+{
+	ProfileThread *t = profileGpuTrack();
+	if (t)
+		t->record(name, begin, end, 0);
+}
+
+/* Record value as the counter name, a string literal, now. Only one
+* thread may record counters. */
+inline void profileCounter(const char *name, double value)
+{
+	ProfileCounterRing *r = profileCounters();
+	unsigned int h = r->head.load(std::memory_order_relaxed);
+	ProfileCounterEvent *e = &r->events[h & (PROFILE_COUNTER_EVENTS - 1)];
+	e->name = name;
+	e->time = profileNow();
+	e->value = value;
+	r->head.store(h + 1, std::memory_order_release);
+}
+
+/* The zone of PROFILE_ZONE, recorded when it goes out of scope. */
+struct ProfileZone {
+	ProfileThread *thread;
+	const char *name;
+	unsigned long long begin;
+
+	explicit ProfileZone(const char *zone) : thread(profileThread()), name(zone), begin(profileNow())
+	{
+		if (thread)
+			thread->depth++;
+	}
+
+	~ProfileZone()
+	{
+		if (thread) {
+			thread->depth--;
+			thread->record(name, begin, profileNow(), thread->depth);
+		}
+	}
+};
+
+/* Write str as a JSON string: the names of the zones are ours, but those
+* of the driver messages (see GLDebug.h) may hold anything. */
+inline void profileWriteString(FILE *f, const char *str)
+{
+	fputc('"', f);
+	for (; *str; str++) {
+		unsigned char c = (unsigned char)*str;
+		if (c == '"' || c == '\\')
+			fprintf(f, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(f, "\\u%04x", c);
+		else
+			fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+/* Write the zones of all rings as a Chrome trace into filename, only
+* those which ended at since (profileNow()) or later.
+* Returns the number of zones written, or -1 in case of an error. */
+inline int profileExport(const char *filename, unsigned long long since = 0)
+{
+	ProfileRegistry *r = profileRegistry();
+	int count = r->count.load(std::memory_order_acquire), i, written = 0, tracks = 0;
+	ProfileEvent *copy = (ProfileEvent*)malloc(sizeof(ProfileEvent) * PROFILE_EVENTS);
+	unsigned long long origin = ~0ull;
+	FILE *f;
+	unsigned int k;
+
+	if (!copy) {
+		warn("profiler: failed to allocate the export");
+		return -1;
+	}
+	/* the times are written relative to the oldest zone of any ring, or
+	 * the oldest value of a counter */
+	for (i = 0; i < count; i++) {
+		ProfileThread *t = r->threads[i].load(std::memory_order_acquire);
+		unsigned int h = t ? t->head.load(std::memory_order_acquire) : 0;
+		unsigned int first = (h > PROFILE_EVENTS) ? h - PROFILE_EVENTS : 0;
+		for (k = first; k < h; k++) {
+			const ProfileEvent *e = &t->events[k & (PROFILE_EVENTS - 1)];
+			if (e->end >= since && e->begin < origin)
+				origin = e->begin;
+		}
+	}
+	ProfileCounterRing *counters = profileCounters();
+	unsigned int values = counters->head.load(std::memory_order_acquire);
+	for (k = (values > PROFILE_COUNTER_EVENTS) ? values - PROFILE_COUNTER_EVENTS : 0; k < values; k++) {
+		const ProfileCounterEvent *e = &counters->events[k & (PROFILE_COUNTER_EVENTS - 1)];
+		if (e->time >= since && e->time < origin)
+			origin = e->time;
+	}
+	f = fopen(filename, "w");
+	if (!f) {
+		warn("profiler: failed to open '%s'", filename);
+		free(copy);
+		return -1;
+	}
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (i = 0; i < count; i++) {
+		ProfileThread *t = r->threads[i].load(std::memory_order_acquire);
+		if (!t)
+			continue;
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+			tracks++ ? ",\n" : "", i);
+		profileWriteString(f, t->name);
+		fprintf(f, "}}");
+		unsigned int h = t->head.load(std::memory_order_acquire);
+		unsigned int first = (h > PROFILE_EVENTS) ? h - PROFILE_EVENTS : 0;
+		for (k = first; k < h; k++)
+			copy[k - first] = t->events[k & (PROFILE_EVENTS - 1)];
+		/* what the thread wrote meanwhile replaced the oldest zones */
+		unsigned int now = t->head.load(std::memory_order_acquire);
+		unsigned int valid = (now > PROFILE_EVENTS) ? now - PROFILE_EVENTS : 0;
+		for (k = (valid > first) ? valid : first; k < h; k++) {
+			const ProfileEvent *e = &copy[k - first];
+			if (e->begin < origin || e->end < since)
+				continue;
+			fprintf(f, ",\n{\"name\":");
+			profileWriteString(f, e->name);
+			fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", i,
+				(double)(e->begin - origin) * 1.0e-3, (double)(e->end - e->begin) * 1.0e-3);
+			written++;
+		}
+	}
+	/* the counters, from the same time on as the zones */
+	for (k = (values > PROFILE_COUNTER_EVENTS) ? values - PROFILE_COUNTER_EVENTS : 0; k < values; k++) {
+		ProfileCounterEvent e = counters->events[k & (PROFILE_COUNTER_EVENTS - 1)];
+		if (e.time < origin || e.time < since)
+			continue;
+		fprintf(f, "%s{\"name\":", tracks++ ? ",\n" : "");
+		profileWriteString(f, e.name);
+		fprintf(f, ",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%.3f}}",
+			(double)(e.time - origin) * 1.0e-3, e.value);
+	}
+	fprintf(f, "\n]}\n");
+	free(copy);
+	if (fclose(f)) {
+		warn("profiler: failed to write '%s'", filename);
+		return -1;
+	}
+	info("profiler: wrote %d zones of %d threads to '%s'", written, count, filename);
+	return written;
+}
+
+#ifdef PROFILE_ZONES
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(...) profileSetThreadName(__VA_ARGS__)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(...) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef HEADER_PROGRAMREFLECTION_H
+#define HEADER_PROGRAMREFLECTION_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* PROGRAM REFLECTION                                                       *
+****************************************************************************/
+
+/* ProgramReflection: the active uniforms and uniform blocks of a linked
+* program, queried once right after linking. Uniforms are found by name via
+* an open-addressing hash table, so setting a uniform by name needs no GL
+* round trip, and the last value set is remembered so that setting the same
+* value again does not call GL at all. The setters use glUniform*, so the
+* program must be in use. Uniforms inside blocks have no location and are
+* only listed with their block. */
+#define REFLECTION_MAX_UNIFORMS 64
+#define REFLECTION_MAX_BLOCKS 16
+#define REFLECTION_HASH_SIZE 128	/* power of two, > 1.5 * REFLECTION_MAX_UNIFORMS */
+#define REFLECTION_NAME_MAX 64
+
+typedef struct {
+	char name[REFLECTION_NAME_MAX];
+	GLint location;
+	GLenum type;
+	GLint size;		/* array size */
+	bool known;		/* value holds what was set last */
+	GLfloat value[16];	/* large enough for a mat4, ints are stored bitwise */
+} ReflectedUniform;
+
+typedef struct {
+	char name[REFLECTION_NAME_MAX];
+	GLuint index;
+	GLint dataSize;		/* GL_UNIFORM_BLOCK_DATA_SIZE */
+	GLint binding;
+} ReflectedBlock;
+
+typedef struct {
+	GLuint program;
+	ReflectedUniform uniforms[REFLECTION_MAX_UNIFORMS];
+	int uniformCount;
+	short slots[REFLECTION_HASH_SIZE];	/* index into uniforms, or -1 */
+	ReflectedBlock blocks[REFLECTION_MAX_BLOCKS];
+	int blockCount;
+	unsigned int skipped;	/* redundant sets which were skipped */
+
+	/* Query the active uniforms and blocks of the linked program prog. */
+	void reflect(GLuint prog)
+	{
+		GLint n = 0, i;
+		GLsizei len;
+
+		program = prog;
+		uniformCount = blockCount = 0;
+		skipped = 0;
+		for (i = 0; i < REFLECTION_HASH_SIZE; i++)
+			slots[i] = -1;
+
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &n);
+		for (i = 0; i < n; i++) {
+			ReflectedUniform *u = &uniforms[uniformCount];
+			glGetActiveUniform(program, (GLuint)i, sizeof(u->name), &len, &u->size, &u->type, u->name);
+			u->location = glGetUniformLocation(program, u->name);
+			if (u->location < 0)
+				continue;	/* block member */
+			if (uniformCount >= REFLECTION_MAX_UNIFORMS) {
+				warn("program %u: too many uniforms to reflect", program);
+				break;
+			}
+			/* "name[0]" is also found as "name" */
+			char *bracket = strchr(u->name, '[');
+			if (bracket)
+				*bracket = 0;
+			u->known = false;
+			insert(uniformCount++);
+		}
+
+		n = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &n);
+		for (i = 0; i < n && blockCount < REFLECTION_MAX_BLOCKS; i++) {
+			ReflectedBlock *b = &blocks[blockCount++];
+			b->index = (GLuint)i;
+			glGetActiveUniformBlockName(program, b->index, sizeof(b->name), &len, b->name);
+			glGetActiveUniformBlockiv(program, b->index, GL_UNIFORM_BLOCK_DATA_SIZE, &b->dataSize);
+			glGetActiveUniformBlockiv(program, b->index, GL_UNIFORM_BLOCK_BINDING, &b->binding);
+		}
+		info("program %u: %d uniforms, %d uniform blocks", program, uniformCount, blockCount);
+	}
+
+	static GLuint64 hash(const char *name)
+	{
+		return hashFNV1a(name, strlen(name), HASH_FNV1A_INIT);
+	}
+
+	void insert(int index)
+	{
+		unsigned int slot = (unsigned int)hash(uniforms[index].name) & (REFLECTION_HASH_SIZE - 1);
+		while (slots[slot] >= 0)
+			slot = (slot + 1) & (REFLECTION_HASH_SIZE - 1);
+		slots[slot] = (short)index;
+	}
+
+	/* Returns the uniform called name, or NULL if it is not active. */
+	ReflectedUniform *find(const char *name)
+	{
+		unsigned int slot = (unsigned int)hash(name) & (REFLECTION_HASH_SIZE - 1);
+		while (slots[slot] >= 0) {
+			ReflectedUniform *u = &uniforms[slots[slot]];
+			if (!strcmp(u->name, name))
+				return u;
+			slot = (slot + 1) & (REFLECTION_HASH_SIZE - 1);
+		}
+		return NULL;
+	}
+
+	/* Returns the uniform block called name, or NULL if it is not active. */
+	const ReflectedBlock *findBlock(const char *name) const
+	{
+		int i;
+		for (i = 0; i < blockCount; i++)
+			if (!strcmp(blocks[i].name, name))
+				return &blocks[i];
+		return NULL;
+	}
+
+	/* Remember count values of u. Returns false if they did not change. */
+	bool update(ReflectedUniform *u, const void *values, size_t size)
+	{
+		if (u->known && !memcmp(u->value, values, size)) {
+			skipped++;
+			return false;
+		}
+		memcpy(u->value, values, size);
+		u->known = true;
+		return true;
+	}
+
+	/* Set uniforms by name. Inactive uniforms are silently ignored.
+	* Returns true if the uniform exists. */
+	bool set1f(const char *name, GLfloat v)
+	{
+		ReflectedUniform *u = find(name);
+		if (u && update(u, &v, sizeof(v)))
+			glUniform1f(u->location, v);
+		return (u != NULL);
+	}
+
+	bool set1i(const char *name, GLint v)
+	{
+		ReflectedUniform *u = find(name);
+		if (u && update(u, &v, sizeof(v)))
+			glUniform1i(u->location, v);
+		return (u != NULL);
+	}
+
+	bool set4fv(const char *name, const GLfloat *v)
+	{
+		ReflectedUniform *u = find(name);
+		if (u && update(u, v, 4 * sizeof(GLfloat)))
+			glUniform4fv(u->location, 1, v);
+		return (u != NULL);
+	}
+
+	bool setMatrix4fv(const char *name, const GLfloat *v)
+	{
+		ReflectedUniform *u = find(name);
+		if (u && update(u, v, 16 * sizeof(GLfloat)))
+			glUniformMatrix4fv(u->location, 1, GL_FALSE, v);
+		return (u != NULL);
+	}
+} ProgramReflection;
+
+#endif
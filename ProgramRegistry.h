@@ -0,0 +1,658 @@
+#ifndef HEADER_PROGRAMREGISTRY_H
+#define HEADER_PROGRAMREGISTRY_H
+
+#include <glad/glad.h>
+#include "ShaderHelpers.h"
+#include "ProgramReflection.h"
+
+/****************************************************************************
+* PROGRAM REGISTRY                                                         *
+****************************************************************************/
+
+/* The registry knows every shader combination the application may use and
+* builds all of them up front, in the background via ProgramBuild. Switching
+* programs is then just a lookup of an already linked object. Each entry
+* has a program per variant; an entry without a special vertex shader for a
+* variant simply uses its basic program for it.
+* In separable mode (see SEPARABLE PROGRAMS in ShaderHelpers.h) every
+* distinct stage is built only once as a StageEntry, and the "program" of
+* an entry variant is a program pipeline combining two stages.
+* Each entry also declares the raster state its programs draw with (the
+* RASTER_* flags of GLState.h), which the render queue applies per draw:
+* opaque closed meshes cull their back faces, shaders which let one see
+* inside of a mesh must not, and expensive fragment shaders may be shaded
+* at coarse rates. */
+#define PROGRAM_REGISTRY_MAX 32
+#define PROGRAM_REGISTRY_MAX_STAGES (PROGRAM_REGISTRY_MAX * PROGRAM_VARIANT_COUNT * 2)
+
+enum {
+	PROGRAM_VARIANT_BASIC = 0,	/* single cube */
+	PROGRAM_VARIANT_INSTANCED,	/* per-instance model matrix */
+	PROGRAM_VARIANT_PULLED,		/* instanced without vertex attributes, see addPulled */
+	PROGRAM_VARIANT_COMPACT,	/* instanced with packed instances, see addCompact */
+	PROGRAM_VARIANT_COUNT
+};
+
+typedef struct {
+	const char *vs[PROGRAM_VARIANT_COUNT];	/* vertex shader per variant, or NULL */
+	const char *fs;				/* fragment shader shared by all variants */
+	unsigned int defines[PROGRAM_VARIANT_COUNT];	/* feature define mask per variant */
+	ProgramBuild build[PROGRAM_VARIANT_COUNT];
+	GLuint program[PROGRAM_VARIANT_COUNT];	/* linked programs, 0 if not ready */
+	bool failed[PROGRAM_VARIANT_COUNT];	/* true if the last build failed */
+	ProgramReflection *reflection[PROGRAM_VARIANT_COUNT];	/* of program[], or NULL */
+	int stages[PROGRAM_VARIANT_COUNT][2];	/* separable mode: vertex and fragment stage */
+	int prepass;		/* entry of the depth pre-pass, -1 for none */
+	unsigned int raster;	/* RASTER_* flags, RASTER_DEFAULT unless set */
+} ProgramEntry;
+
+/* a single separable shader stage */
+typedef struct {
+	GLenum type;
+	const char *file;
+	unsigned int defines;
+	ProgramBuild build;
+	GLuint program;		/* separable program, 0 if not ready */
+	bool failed;
+} StageEntry;
+
+typedef struct {
+	ProgramEntry entries[PROGRAM_REGISTRY_MAX];
+	int count;
+	ShaderSourceCache sources;	/* the mapped shader files */
+	ShaderSourceList scratch;	/* for finding the includes of a shader */
+	const char * const *defineNames;	/* the names of the feature define bits */
+	int defineCount;
+	bool separable;		/* build stages and combine them in pipelines */
+	bool spirv;		/* prefer SPIR-V modules over GLSL sources */
+	StageEntry stages[PROGRAM_REGISTRY_MAX_STAGES];
+	int stageCount;
+	unsigned int version;	/* counts the programs and pipelines replaced */
+
+	void init()
+	{
+		count = 0;
+		version = 0;
+		separable = false;
+		spirv = false;
+		stageCount = 0;
+		defineNames = NULL;
+		defineCount = 0;
+		shaderSourceCacheInit(&sources);
+	}
+
+	/* Set the names of the feature define bits, see SHADER PERMUTATIONS
+	* in ShaderHelpers.h. names must stay valid. */
+	void setDefines(const char * const *names, int n)
+	{
+		defineNames = names;
+		defineCount = n;
+	}
+
+	/* Use separable programs and pipelines, if the context supports them.
+	* This must be chosen before any program is added.
+	* Returns true if separable mode is active. */
+	bool useSeparable(bool enable)
+	{
+		if (count) {
+			warn("program registry: separable mode must be set before adding programs");
+			return separable;
+		}
+		separable = enable && separateShaderObjectsSupported();
+		if (enable && !separable)
+			warn("program registry: GL_ARB_separate_shader_objects is not supported");
+		info("program registry: separable mode %s", separable ? "on" : "off");
+		return separable;
+	}
+
+	/* Load stages from SPIR-V modules where they exist, see SPIR-V MODULES in
+	* ShaderHelpers.h. Applies to the builds started afterwards.
+	* Returns true if SPIR-V modules are used. */
+	bool useSpirv(bool enable)
+	{
+		spirv = enable && spirvSupported();
+		if (enable && !spirv)
+			warn("program registry: GL_ARB_gl_spirv is not supported");
+		return spirv;
+	}
+
+	/* Find or add the stage of type from file with defines.
+	* Returns its index or -1 if there is no room. */
+	int addStage(GLenum type, const char *file, unsigned int defines)
+	{
+		int i;
+		for (i = 0; i < stageCount; i++) {
+			const StageEntry *st = &stages[i];
+			if (st->type == type && st->defines == defines && !strcmp(st->file, file))
+				return i;
+		}
+		if (stageCount >= PROGRAM_REGISTRY_MAX_STAGES) {
+			warn("program registry: too many stages, ignoring '%s'", file);
+			return -1;
+		}
+		StageEntry *st = &stages[stageCount];
+		st->type = type;
+		st->file = file;
+		st->defines = defines;
+		st->build.state = PROGRAM_BUILD_IDLE;
+		st->build.vs = st->build.fs = st->build.program = 0;
+		st->program = 0;
+		st->failed = false;
+		return stageCount++;
+	}
+
+	/* Register a shader combination built with the feature define mask
+	* defines. The instanced variant uses vsInstanced if it is not NULL,
+	* otherwise the same files with the additional defines in
+	* instancedDefines, and there is none if both are unset. Registering
+	* the same combination twice returns the existing entry.
+	* Returns the index of the entry, or -1 if the registry is full. */
+	int add(const char *vs, const char *fs, const char *vsInstanced,
+		unsigned int defines = 0, unsigned int instancedDefines = 0)
+	{
+		int i;
+		const char *vsInst = vsInstanced ? vsInstanced : (instancedDefines ? vs : NULL);
+		unsigned int instDefines = defines | (vsInstanced ? 0 : instancedDefines);
+
+		for (i = 0; i < count; i++) {
+			const ProgramEntry *e = &entries[i];
+			if (!strcmp(e->vs[PROGRAM_VARIANT_BASIC], vs) && !strcmp(e->fs, fs) &&
+				e->defines[PROGRAM_VARIANT_BASIC] == defines &&
+				((!e->vs[PROGRAM_VARIANT_INSTANCED] && !vsInst) ||
+				 (e->vs[PROGRAM_VARIANT_INSTANCED] && vsInst &&
+				  !strcmp(e->vs[PROGRAM_VARIANT_INSTANCED], vsInst) &&
+				  e->defines[PROGRAM_VARIANT_INSTANCED] == instDefines)))
+				return i;
+		}
+		if (count >= PROGRAM_REGISTRY_MAX) {
+			warn("program registry is full, ignoring '%s' '%s'", vs, fs);
+			return -1;
+		}
+		ProgramEntry *e = &entries[count];
+		e->vs[PROGRAM_VARIANT_BASIC] = vs;
+		e->vs[PROGRAM_VARIANT_INSTANCED] = vsInst;
+		e->vs[PROGRAM_VARIANT_PULLED] = NULL;
+		e->vs[PROGRAM_VARIANT_COMPACT] = NULL;
+		e->fs = fs;
+		e->defines[PROGRAM_VARIANT_BASIC] = defines;
+		e->defines[PROGRAM_VARIANT_INSTANCED] = instDefines;
+		e->defines[PROGRAM_VARIANT_PULLED] = 0;
+		e->defines[PROGRAM_VARIANT_COMPACT] = 0;
+		e->prepass = -1;
+		e->raster = RASTER_DEFAULT;
+		for (i = 0; i < PROGRAM_VARIANT_COUNT; i++) {
+			e->build[i].state = PROGRAM_BUILD_IDLE;
+			e->build[i].vs = e->build[i].fs = e->build[i].program = 0;
+			e->program[i] = 0;
+			e->failed[i] = false;
+			e->reflection[i] = NULL;
+			e->stages[i][0] = e->stages[i][1] = -1;
+			if (separable && e->vs[i]) {
+				e->stages[i][0] = addStage(GL_VERTEX_SHADER, e->vs[i], e->defines[i]);
+				e->stages[i][1] = addStage(GL_FRAGMENT_SHADER, e->fs, e->defines[i]);
+			}
+		}
+		return count++;
+	}
+
+	/* Give entry index a depth pre-pass: the same shaders with the
+	* additional defines in depthDefines, which should drop all color work
+	* but keep any discard, see RenderQueue. Like any other entry, it is
+	* built by buildAll and rebuilt when its files change.
+	* Returns the index of the pre-pass entry, or -1 if the registry is
+	* full. */
+	int addPrepass(int index, unsigned int depthDefines)
+	{
+		if (index < 0 || index >= count)
+			return -1;
+		const ProgramEntry *e = &entries[index];
+		const char *vsInst = e->vs[PROGRAM_VARIANT_INSTANCED];
+		unsigned int instDefines = 0;
+		/* an instanced variant of the same file was made by defines */
+		if (vsInst && !strcmp(vsInst, e->vs[PROGRAM_VARIANT_BASIC]) &&
+			e->defines[PROGRAM_VARIANT_INSTANCED] != e->defines[PROGRAM_VARIANT_BASIC]) {
+			instDefines = e->defines[PROGRAM_VARIANT_INSTANCED] & ~e->defines[PROGRAM_VARIANT_BASIC];
+			vsInst = NULL;
+		}
+		int prepass = add(e->vs[PROGRAM_VARIANT_BASIC], e->fs, vsInst,
+			e->defines[PROGRAM_VARIANT_BASIC] | depthDefines, instDefines);
+		entries[index].prepass = prepass;
+		/* it must cover the same faces */
+		if (prepass >= 0)
+			entries[prepass].raster = e->raster;
+		return prepass;
+	}
+
+	/* Give entry index a vertex pulling variant (PROGRAM_VARIANT_PULLED):
+	* its basic vertex shader with the additional defines in pulledDefines,
+	* which must make up the vertices without any attributes, see
+	* Cube::drawPulled; and its pre-pass as well, if it has one already.
+	* Unlike the instanced variant, it does not fall back to the basic
+	* program, the caller checks hasVariant() before drawing with it. */
+	void addPulled(int index, unsigned int pulledDefines)
+	{
+		addDerived(index, PROGRAM_VARIANT_PULLED, pulledDefines);
+	}
+
+	/* Give entry index a variant for packed instances
+	* (PROGRAM_VARIANT_COMPACT), the same way: with the additional defines
+	* in compactDefines, which must read the instances packed by
+	* glm::packInstances, see Cube::drawCompact. */
+	void addCompact(int index, unsigned int compactDefines)
+	{
+		addDerived(index, PROGRAM_VARIANT_COMPACT, compactDefines);
+	}
+
+	/* Set variant of entry index and of its pre-pass to their basic
+	* vertex shaders with the additional defines in extraDefines. */
+	void addDerived(int index, int variant, unsigned int extraDefines)
+	{
+		if (index < 0 || index >= count)
+			return;
+		ProgramEntry *e = &entries[index];
+		setVariant(index, variant, e->vs[PROGRAM_VARIANT_BASIC],
+			e->defines[PROGRAM_VARIANT_BASIC] | extraDefines);
+		if (e->prepass >= 0) {
+			const ProgramEntry *d = &entries[e->prepass];
+			setVariant(e->prepass, variant, d->vs[PROGRAM_VARIANT_BASIC],
+				d->defines[PROGRAM_VARIANT_BASIC] | extraDefines);
+		}
+	}
+
+	/* Set the vertex shader of variant of entry index to vs with defines. */
+	void setVariant(int index, int variant, const char *vs, unsigned int defines)
+	{
+		ProgramEntry *e = &entries[index];
+		e->vs[variant] = vs;
+		e->defines[variant] = defines;
+		if (separable) {
+			e->stages[variant][0] = addStage(GL_VERTEX_SHADER, vs, defines);
+			e->stages[variant][1] = addStage(GL_FRAGMENT_SHADER, e->fs, defines);
+		}
+	}
+
+	/* Returns true if entry index has a vertex shader of its own for
+	* variant, rather than using its basic program for it. */
+	bool hasVariant(int index, int variant) const
+	{
+		return index >= 0 && index < count && entries[index].vs[variant];
+	}
+
+	/* Set the raster state entry index draws with, a mask of RASTER_*
+	* flags. Set it before addPrepass, which copies it. */
+	void setRaster(int index, unsigned int flags)
+	{
+		if (index >= 0 && index < count)
+			entries[index].raster = flags;
+	}
+
+	/* Get the raster state of entry index, RASTER_DEFAULT if there is no
+	* such entry. */
+	unsigned int getRaster(int index) const
+	{
+		return (index >= 0 && index < count) ? entries[index].raster : RASTER_DEFAULT;
+	}
+
+	/* (Re-)start the build of stage s. */
+	void rebuildStage(int s)
+	{
+		StageEntry *st = &stages[s];
+		programBuildCancel(&st->build);
+		if (!stageBuildStart(&st->build, &sources, st->type, st->file, defineNames, defineCount, st->defines, spirv)) {
+			st->failed = true;
+			st->build.state = PROGRAM_BUILD_IDLE;
+		}
+	}
+
+	/* (Re-)start the build of one variant of entry index. The program
+	* built before stays usable until the new one is linked. */
+	void rebuildVariant(int index, int variant)
+	{
+		ProgramEntry *e = &entries[index];
+		if (!e->vs[variant])
+			return;
+		if (separable) {
+			if (e->stages[variant][0] >= 0)
+				rebuildStage(e->stages[variant][0]);
+			if (e->stages[variant][1] >= 0)
+				rebuildStage(e->stages[variant][1]);
+			return;
+		}
+		programBuildCancel(&e->build[variant]);
+		if (!programBuildStart(&e->build[variant], &sources, e->vs[variant], e->fs,
+			defineNames, defineCount, e->defines[variant], spirv)) {
+			e->failed[variant] = true;
+			e->build[variant].state = PROGRAM_BUILD_IDLE;
+		}
+	}
+
+	/* (Re-)start the build of all variants of entry index. */
+	void rebuild(int index)
+	{
+		int i;
+		for (i = 0; i < PROGRAM_VARIANT_COUNT; i++)
+			rebuildVariant(index, i);
+	}
+
+	/* Returns true if the shader file root is filename or includes it. */
+	bool uses(const char *root, const char *filename)
+	{
+		int i;
+		char module[SHADER_SOURCE_PATH];
+		if (!strcmp(root, filename))
+			return true;
+		if (spirv && spirvModuleFilename(module, sizeof(module), root) && !strcmp(module, filename))
+			return true;
+		if (!shaderSourceExpand(&sources, &scratch, root))
+			return true;	/* let the rebuild report the error */
+		for (i = 1; i < scratch.fileCount; i++)
+			if (!strcmp(scratch.files[i], filename))
+				return true;
+		return false;
+	}
+
+	/* Rebuild every program which uses the shader file filename, directly
+	* or via #include.
+	* Returns the number of builds started. */
+	int rebuildFile(const char *filename)
+	{
+		int i, j, n = 0;
+		for (i = 0; separable && i < stageCount; i++) {
+			if (uses(stages[i].file, filename)) {
+				rebuildStage(i);
+				n++;
+			}
+		}
+		for (i = 0; !separable && i < count; i++) {
+			ProgramEntry *e = &entries[i];
+			for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+				if (!e->vs[j])
+					continue;
+				if (uses(e->vs[j], filename) || uses(e->fs, filename)) {
+					rebuildVariant(i, j);
+					n++;
+				}
+			}
+		}
+		if (n)
+			info("program registry: '%s' changed, rebuilding %d programs", filename, n);
+		return n;
+	}
+
+	/* Download the binaries of the registered programs which are not in
+	* the local program binary cache from the remote cache, if there is one,
+	* so buildAll finds them; call it right before. Separable stages are not
+	* cached. Blocks until the downloads are done.
+	* Returns the number of binaries downloaded. */
+	int prefetch()
+	{
+		RemoteCache *remote = remoteProgramCache();
+		char (*files)[REMOTE_CACHE_PATH];
+		const char **list;
+		int i, j, k, n = 0, fetched;
+		GLuint64 mtime, size;
+
+		if (!remote->enabled || separable || !count || !programCacheSupported())
+			return 0;
+		files = (char (*)[REMOTE_CACHE_PATH])malloc(count * PROGRAM_VARIANT_COUNT * sizeof(*files));
+		list = (const char**)malloc(count * PROGRAM_VARIANT_COUNT * sizeof(*list));
+		for (i = 0; files && list && i < count; i++) {
+			for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+				ProgramEntry *e = &entries[i];
+				GLuint64 key;
+				if (!e->vs[j] || !(key = programBuildKey(&sources, e->vs[j], e->fs, defineNames, defineCount,
+					e->defines[j], spirv)))
+					continue;
+				programCacheFilename(files[n], sizeof(files[n]), key);
+				if (shaderSourceStat(files[n], &mtime, &size))
+					continue;
+				/* variants may share a program */
+				for (k = 0; k < n && strcmp(list[k], files[n]); k++)
+					;
+				if (k == n) {
+					list[n] = files[n];
+					n++;
+				}
+			}
+		}
+		myMkdir(SHADER_CACHE_DIR);
+		fetched = n ? remote->fetchAll(list, n, programCacheValid) : 0;
+		info("program registry: %d of %d missing program binaries downloaded", fetched, n);
+		free(list);
+		free(files);
+		return fetched;
+	}
+
+	/* Start building every registered program. */
+	void buildAll()
+	{
+		int i;
+		if (separable) {
+			info("program registry: building %d stages for %d shader combinations", stageCount, count);
+			for (i = 0; i < stageCount; i++)
+				rebuildStage(i);
+			return;
+		}
+		info("program registry: building %d shader combinations", count);
+		for (i = 0; i < count; i++)
+			rebuild(i);
+	}
+
+	/* Advance all builds in flight. If the driver cannot compile in
+	* parallel, each poll compiles synchronously, so we only finish one
+	* build per call to spread the cost over several frames. Call this
+	* once per frame. */
+	void update()
+	{
+		int i, j;
+		bool parallel = parallelShaderCompileSupported();
+		for (i = 0; i < stageCount; i++) {
+			ProgramBuild *b = &stages[i].build;
+			if (b->state == PROGRAM_BUILD_IDLE)
+				continue;
+			if (programBuildPoll(b)) {
+				stageFinished(i);
+				if (!parallel)
+					return;
+			}
+		}
+		for (i = 0; i < count; i++) {
+			for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+				ProgramBuild *b = &entries[i].build[j];
+				if (b->state == PROGRAM_BUILD_IDLE)
+					continue;
+				if (programBuildPoll(b)) {
+					finished(i, j);
+					if (!parallel)
+						return;
+				}
+			}
+		}
+	}
+
+	/* Block until the builds of entry index are finished. */
+	void finish(int index)
+	{
+		int j, k;
+		for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+			for (k = 0; k < 2; k++) {
+				int st = entries[index].stages[j][k];
+				if (st < 0 || stages[st].build.state == PROGRAM_BUILD_IDLE)
+					continue;
+				programBuildPoll(&stages[st].build, true);
+				stageFinished(st);
+			}
+		}
+		for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+			ProgramBuild *b = &entries[index].build[j];
+			if (b->state == PROGRAM_BUILD_IDLE)
+				continue;
+			programBuildPoll(b, true);
+			finished(index, j);
+		}
+	}
+
+	/* Publish the result of a finished stage build and update the
+	* pipelines using it. */
+	void stageFinished(int s)
+	{
+		StageEntry *st = &stages[s];
+		ProgramBuild *b = &st->build;
+		int i, j;
+
+		if (b->state == PROGRAM_BUILD_DONE) {
+			GLuint old = st->program;
+			st->program = b->program;
+			st->failed = false;
+			info("program registry: stage %d '%s' is program %u", s, st->file, st->program);
+			for (i = 0; i < count; i++)
+				for (j = 0; j < PROGRAM_VARIANT_COUNT; j++)
+					if (entries[i].stages[j][0] == s || entries[i].stages[j][1] == s)
+						updatePipeline(i, j);
+			if (old) {
+				info("deleting program %u", old);
+				glState()->deleteProgram(old);
+			}
+		} else {
+			st->failed = true;
+			warn("program registry: failed to build stage %d '%s'", s, st->file);
+		}
+		b->program = 0;
+		b->state = PROGRAM_BUILD_IDLE;
+	}
+
+	/* Combine the stages of entry index for variant once both are ready. */
+	void updatePipeline(int index, int variant)
+	{
+		ProgramEntry *e = &entries[index];
+		int vs = e->stages[variant][0], fs = e->stages[variant][1];
+		if (vs < 0 || fs < 0 || !stages[vs].program || !stages[fs].program)
+			return;
+		if (!e->program[variant]) {
+			glGenProgramPipelines(1, &e->program[variant]);
+			info("program registry: entry %d variant %d is pipeline %u", index, variant, e->program[variant]);
+		}
+		glUseProgramStages(e->program[variant], GL_VERTEX_SHADER_BIT, stages[vs].program);
+		glUseProgramStages(e->program[variant], GL_FRAGMENT_SHADER_BIT, stages[fs].program);
+		/* a generated pipeline name is an object once its stages are set */
+		glDebugLabel(GL_PROGRAM_PIPELINE, e->program[variant], "%s + %s (%d)", stages[vs].file, stages[fs].file, variant);
+		e->failed[variant] = false;
+		version++;
+	}
+
+	/* Publish the result of a finished build. */
+	void finished(int index, int variant)
+	{
+		ProgramEntry *e = &entries[index];
+		ProgramBuild *b = &e->build[variant];
+		if (b->state == PROGRAM_BUILD_DONE) {
+			if (e->program[variant]) {
+				info("deleting program %u", e->program[variant]);
+				glState()->deleteProgram(e->program[variant]);
+			}
+			e->program[variant] = b->program;
+			e->failed[variant] = false;
+			version++;
+			if (!e->reflection[variant])
+				e->reflection[variant] = (ProgramReflection*)malloc(sizeof(ProgramReflection));
+			if (e->reflection[variant])
+				e->reflection[variant]->reflect(b->program);
+			info("program registry: entry %d variant %d is program %u", index, variant, b->program);
+		} else {
+			e->failed[variant] = true;
+			warn("program registry: failed to build entry %d variant %d", index, variant);
+		}
+		b->program = 0;
+		b->state = PROGRAM_BUILD_IDLE;
+	}
+
+	/* Get the program of entry index for variant, in separable mode the
+	* program pipeline. Entries without a vertex shader for the variant fall
+	* back to the basic variant.
+	* Returns 0 if the program is not (yet) available. */
+	GLuint get(int index, int variant) const
+	{
+		if (index < 0 || index >= count)
+			return 0;
+		const ProgramEntry *e = &entries[index];
+		if (!e->vs[variant])
+			variant = PROGRAM_VARIANT_BASIC;
+		return e->program[variant];
+	}
+
+	/* Get the reflection of the program returned by get(), or NULL.
+	* Pipelines are not reflected. */
+	ProgramReflection *getReflection(int index, int variant)
+	{
+		if (index < 0 || index >= count)
+			return NULL;
+		ProgramEntry *e = &entries[index];
+		if (!e->vs[variant])
+			variant = PROGRAM_VARIANT_BASIC;
+		return e->program[variant] ? e->reflection[variant] : NULL;
+	}
+
+	/* Returns true if entry index has builds in flight. */
+	bool pending(int index) const
+	{
+		int j, k;
+		for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+			if (entries[index].build[j].state != PROGRAM_BUILD_IDLE)
+				return true;
+			for (k = 0; k < 2; k++) {
+				int st = entries[index].stages[j][k];
+				if (st >= 0 && stages[st].build.state != PROGRAM_BUILD_IDLE)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	/* Returns true if any builds are in flight. */
+	bool busy() const
+	{
+		int i;
+		for (i = 0; i < count; i++)
+			if (pending(i))
+				return true;
+		return false;
+	}
+
+	/* Delete all programs and cancel all builds. */
+	void destroy()
+	{
+		int i, j;
+		for (i = 0; i < count; i++) {
+			for (j = 0; j < PROGRAM_VARIANT_COUNT; j++) {
+				programBuildCancel(&entries[i].build[j]);
+				free(entries[i].reflection[j]);
+				entries[i].reflection[j] = NULL;
+				if (entries[i].program[j]) {
+					if (separable) {
+						info("deleting pipeline %u", entries[i].program[j]);
+						glState()->deleteProgramPipelines(1, &entries[i].program[j]);
+					} else {
+						info("deleting program %u", entries[i].program[j]);
+						glState()->deleteProgram(entries[i].program[j]);
+					}
+					entries[i].program[j] = 0;
+				}
+			}
+		}
+		for (i = 0; i < stageCount; i++) {
+			programBuildCancel(&stages[i].build);
+			if (stages[i].program) {
+				info("deleting program %u", stages[i].program);
+				glState()->deleteProgram(stages[i].program);
+				stages[i].program = 0;
+			}
+		}
+		count = 0;
+		stageCount = 0;
+		version++;
+		info("program registry: %u shader source cache hits, %u misses", sources.hits, sources.misses);
+		shaderSourceCacheDestroy(&sources);
+	}
+} ProgramRegistry;
+
+#endif
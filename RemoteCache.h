@@ -0,0 +1,428 @@
+#ifndef HEADER_REMOTECACHE_H
+#define HEADER_REMOTECACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <strings.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+#include "Log.h"
+
+/****************************************************************************
+* REMOTE CACHE: the program binary cache shared by a fleet                 *
+****************************************************************************/
+
+/* RemoteCache: a cache shared by many machines behind the local program
+* binary cache (see PROGRAM BINARY CACHE in ShaderHelpers.h), given as
+* --program-cache http://HOST[:PORT]/PATH. It is a plain HTTP store: the
+* entry NAME is fetched with GET PATH/NAME and stored with PUT PATH/NAME,
+* which any web server with PUT enabled serves (nginx with dav_methods PUT,
+* for one). The names are those of the local cache files, whose key hashes
+* the sources with GL_RENDERER and GL_VERSION, so each GPU and driver has
+* entries of its own.
+* At startup, fetchAll() downloads the entries missing locally, several at a
+* time, into the local cache, before the programs are built from it. What a
+* machine compiles anyway is queued by upload() and sent by a thread of its
+* own, so the frame never waits for the network. After a driver update the
+* first machine compiles and the others download.
+* Nothing from the network is trusted: an entry is written to the local
+* cache only if the check of the caller accepts it, and a binary the driver
+* rejects is compiled from source like a stale local one. The first request
+* which cannot connect turns the remote cache off for the run, so a server
+* which is down costs a single timeout. Not available on Windows. */
+
+#define REMOTE_CACHE_PATH 256		/* the longest local file name */
+#define REMOTE_CACHE_QUEUE 64		/* uploads waiting, more are dropped */
+#define REMOTE_CACHE_CONNECTIONS 8	/* downloads at a time */
+#define REMOTE_CACHE_TIMEOUT 2000	/* ms to connect, and for each send or receive */
+#define REMOTE_CACHE_ENTRY_MAX (64u << 20)	/* the largest entry accepted */
+
+/* whether data of size bytes is a valid entry */
+typedef bool (*RemoteCacheCheck)(const unsigned char *data, size_t size);
+
+/* The name of the entry of the local file file: its base name. */
+static const char *remoteCacheName(const char *file)
+{
+	const char *slash = strrchr(file, '/');
+	return slash ? slash + 1 : file;
+}
+
+#ifndef _WIN32
+/* Connect to port of host, giving up after REMOTE_CACHE_TIMEOUT.
+* Returns the socket, or -1. */
+static int remoteCacheConnect(const char *host, const char *port)
+{
+	struct addrinfo hints, *list = NULL, *a;
+	struct timeval timeout = { REMOTE_CACHE_TIMEOUT / 1000, (REMOTE_CACHE_TIMEOUT % 1000) * 1000 };
+	int fd = -1;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host, port, &hints, &list))
+		return -1;
+	for (a = list; a && fd < 0; a = a->ai_next) {
+		struct pollfd p;
+		int error = 0, result;
+		socklen_t length = sizeof(error);
+		fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+		if (fd < 0)
+			continue;
+		/* connect without blocking, to wait no longer than the timeout */
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		result = connect(fd, a->ai_addr, a->ai_addrlen);
+		if (result && errno == EINPROGRESS) {
+			p.fd = fd;
+			p.events = POLLOUT;
+			if (poll(&p, 1, REMOTE_CACHE_TIMEOUT) != 1 ||
+				getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length))
+				error = ETIMEDOUT;
+		} else if (result) {
+			error = errno;
+		}
+		if (error) {
+			close(fd);
+			fd = -1;
+			continue;
+		}
+		fcntl(fd, F_SETFL, 0);
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+	}
+	freeaddrinfo(list);
+	return fd;
+}
+
+/* Send length bytes of data on socket fd.
+* Returns true if successfull. */
+static bool remoteCacheSend(int fd, const void *data, size_t length)
+{
+	size_t done = 0;
+	while (done < length) {
+		ssize_t n = send(fd, (const unsigned char*)data + done, length - done, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		done += (size_t)n;
+	}
+	return true;
+}
+#endif
+
+typedef struct RemoteCache {
+	char host[256], port[8], path[256];	/* of the URL, path without the last '/' */
+	bool enabled;
+	std::atomic<bool> down;		/* a request failed to connect */
+	std::thread uploader;
+	std::mutex lock;		/* the queue */
+	std::condition_variable wake;
+	char queue[REMOTE_CACHE_QUEUE][REMOTE_CACHE_PATH];	/* local files to upload */
+	int head, queued;
+	bool quit;			/* the uploader ends once the queue is empty */
+	std::atomic<int> fetched, uploaded;
+
+	void clear()
+	{
+		host[0] = port[0] = path[0] = 0;
+		enabled = false;
+		down = false;
+		head = queued = 0;
+		quit = false;
+		fetched = uploaded = 0;
+	}
+
+	/* Use the store at url, "http://host[:port]/path".
+	* Returns false if url is not of that form. */
+	bool init(const char *url)
+	{
+#ifdef _WIN32
+		(void)url;
+		clear();
+		warn("remote cache: not supported on Windows");
+		return false;
+#else
+		const char *h, *end, *colon;
+		size_t length;
+
+		clear();
+		if (strncmp(url, "http://", 7)) {
+			warn("remote cache: '%s' is not an http:// URL", url);
+			return false;
+		}
+		h = url + 7;
+		end = h + strcspn(h, "/");
+		colon = (const char*)memchr(h, ':', (size_t)(end - h));
+		if (!colon)
+			colon = end;
+		if (colon == h || (size_t)(colon - h) >= sizeof(host) || (colon < end &&
+			(end - colon < 2 || (size_t)(end - colon) > sizeof(port))) || strlen(end) >= sizeof(path)) {
+			warn("remote cache: invalid URL '%s'", url);
+			return false;
+		}
+		snprintf(host, sizeof(host), "%.*s", (int)(colon - h), h);
+		if (colon < end)
+			snprintf(port, sizeof(port), "%.*s", (int)(end - colon - 1), colon + 1);
+		else
+			snprintf(port, sizeof(port), "80");
+		snprintf(path, sizeof(path), "%s", end);
+		length = strlen(path);
+		while (length && path[length - 1] == '/')
+			path[--length] = 0;
+		enabled = true;
+		uploader = std::thread([this]() { uploadLoop(); });
+		info("remote cache: using http://%s:%s%s/", host, port, path);
+		return true;
+#endif
+	}
+
+	/* Send the uploads still queued and stop. */
+	void destroy()
+	{
+		if (uploader.joinable()) {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				quit = true;
+			}
+			wake.notify_one();
+			uploader.join();
+		}
+		if (enabled)
+			info("remote cache: %d entries downloaded, %d uploaded", (int)fetched, (int)uploaded);
+		clear();
+	}
+
+	/* Send the request method for the entry name with length bytes of body
+	* and read the response, its body into *reply (malloced, for the caller
+	* to free) if reply is not NULL.
+	* Returns the HTTP status, or -1 if the request failed. */
+	int request(const char *method, const char *name, const void *body, size_t length,
+		unsigned char **reply, size_t *replyLength)
+	{
+#ifdef _WIN32
+		(void)method; (void)name; (void)body; (void)length; (void)reply; (void)replyLength;
+		return -1;
+#else
+		char header[1024];
+		unsigned char *data = NULL;
+		size_t size = 0, capacity = 0, start, contentLength = (size_t)-1;
+		int fd, n, status = -1;
+		const char *line;
+
+		if (reply)
+			*reply = NULL;
+		if (!enabled || down)
+			return -1;
+		fd = remoteCacheConnect(host, port);
+		if (fd < 0) {
+			if (!down.exchange(true))
+				warn("remote cache: failed to connect to %s:%s, not using it for this run", host, port);
+			return -1;
+		}
+		/* HTTP/1.0, so the response is neither chunked nor kept alive */
+		n = snprintf(header, sizeof(header), "%s %s/%s HTTP/1.0\r\nHost: %s:%s\r\n"
+			"Content-Type: application/octet-stream\r\nContent-Length: %lu\r\n\r\n",
+			method, path, name, host, port, (unsigned long)length);
+		if (n <= 0 || (size_t)n >= sizeof(header) || !remoteCacheSend(fd, header, (size_t)n) ||
+			!remoteCacheSend(fd, body, length)) {
+			close(fd);
+			return -1;
+		}
+		/* the response ends with the connection */
+		for (;;) {
+			if (capacity - size < 4096) {
+				unsigned char *more = NULL;
+				if (capacity < REMOTE_CACHE_ENTRY_MAX + 65536)
+					more = (unsigned char*)realloc(data, capacity = 2 * capacity + 65536);
+				if (!more) {
+					size = 0;
+					break;
+				}
+				data = more;
+			}
+			ssize_t got = recv(fd, data + size, capacity - size - 1, 0);
+			if (got < 0 && errno == EINTR)
+				continue;
+			if (got < 0)
+				size = 0;
+			if (got <= 0)
+				break;
+			size += (size_t)got;
+		}
+		close(fd);
+		if (!data || !size) {
+			free(data);
+			return -1;
+		}
+		data[size] = 0;
+		for (start = 0; start + 4 <= size && memcmp(data + start, "\r\n\r\n", 4); start++)
+			;
+		if (start + 4 > size || sscanf((const char*)data, "HTTP/%*d.%*d %d", &status) != 1) {
+			free(data);
+			return -1;
+		}
+		for (line = strstr((const char*)data, "\r\n"); line && line < (const char*)data + start;
+			line = strstr(line + 2, "\r\n")) {
+			if (!strncasecmp(line + 2, "Content-Length:", 15))
+				contentLength = (size_t)strtoull(line + 17, NULL, 10);
+		}
+		start += 4;
+		/* a response cut short is no response */
+		if (contentLength != (size_t)-1 && contentLength != size - start) {
+			free(data);
+			return -1;
+		}
+		if (reply && status == 200) {
+			memmove(data, data + start, size - start);
+			*reply = data;
+			*replyLength = size - start;
+		} else {
+			free(data);
+		}
+		return status;
+#endif
+	}
+
+	/* Download the entry of the local cache file file and write it there
+	* if check accepts it, through a temporary file, so the local cache never
+	* sees half an entry.
+	* Returns true if the file was written. */
+	bool fetch(const char *file, RemoteCacheCheck check)
+	{
+		char temp[REMOTE_CACHE_PATH + 8];
+		const char *name = remoteCacheName(file);
+		unsigned char *data = NULL;
+		size_t size = 0;
+		bool ok = false;
+		FILE *f;
+
+		int status = request("GET", name, NULL, 0, &data, &size);
+		if (status == 200 && check && !check(data, size)) {
+			warn("remote cache: ignoring the invalid entry '%s'", name);
+		} else if (status == 200) {
+			snprintf(temp, sizeof(temp), "%s.part", file);
+			f = fopen(temp, "wb");
+			ok = f && fwrite(data, 1, size, f) == size;
+			if (f && fclose(f))
+				ok = false;
+			if (ok && rename(temp, file))
+				ok = false;
+			if (ok) {
+				fetched++;
+			} else {
+				warn("remote cache: failed to write '%s'", file);
+				remove(temp);
+			}
+		} else if (status >= 0 && status != 404) {
+			warn("remote cache: GET '%s' returned %d", name, status);
+		}
+		free(data);
+		return ok;
+	}
+
+	/* fetch() the count local files files, REMOTE_CACHE_CONNECTIONS at a
+	* time.
+	* Returns the number of files written. */
+	int fetchAll(const char * const *files, int count, RemoteCacheCheck check)
+	{
+		std::thread threads[REMOTE_CACHE_CONNECTIONS];
+		std::atomic<int> next(0), written(0);
+		int i, n = (count < REMOTE_CACHE_CONNECTIONS) ? count : REMOTE_CACHE_CONNECTIONS;
+
+		if (!enabled || down)
+			return 0;
+		for (i = 0; i < n; i++) {
+			threads[i] = std::thread([&]() {
+				int j;
+				while ((j = next++) < count)
+					if (fetch(files[j], check))
+						written++;
+			});
+		}
+		for (i = 0; i < n; i++)
+			threads[i].join();
+		return written;
+	}
+
+	/* Queue the local cache file file for upload. It is read when its
+	* turn comes, so it must be complete; uploads beyond
+	* REMOTE_CACHE_QUEUE are dropped. */
+	void upload(const char *file)
+	{
+		if (!enabled || down || strlen(file) >= REMOTE_CACHE_PATH)
+			return;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (queued == REMOTE_CACHE_QUEUE)
+				return;
+			snprintf(queue[(head + queued) % REMOTE_CACHE_QUEUE], REMOTE_CACHE_PATH, "%s", file);
+			queued++;
+		}
+		wake.notify_one();
+	}
+
+	/* Read the local file file and PUT it. */
+	void put(const char *file)
+	{
+		const char *name = remoteCacheName(file);
+		unsigned char *data = NULL;
+		long size = -1;
+		FILE *f = fopen(file, "rb");
+
+		if (f && !fseek(f, 0, SEEK_END) && (size = ftell(f)) > 0 && size <= (long)REMOTE_CACHE_ENTRY_MAX &&
+			!fseek(f, 0, SEEK_SET) && (data = (unsigned char*)malloc((size_t)size)) &&
+			fread(data, 1, (size_t)size, f) == (size_t)size) {
+			int status = request("PUT", name, data, (size_t)size, NULL, NULL);
+			if (status >= 200 && status < 300)
+				uploaded++;
+			else if (status >= 0)
+				warn("remote cache: PUT '%s' returned %d", name, status);
+		} else {
+			warn("remote cache: failed to read '%s'", file);
+		}
+		free(data);
+		if (f)
+			fclose(f);
+	}
+
+	/* The uploader thread. */
+	void uploadLoop()
+	{
+		char file[REMOTE_CACHE_PATH];
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				wake.wait(guard, [&]() { return quit || queued; });
+				if (!queued)
+					return;
+				memcpy(file, queue[head], sizeof(file));
+				head = (head + 1) % REMOTE_CACHE_QUEUE;
+				queued--;
+			}
+			put(file);
+		}
+	}
+} RemoteCache;
+
+/* The remote cache of the program binaries, off unless init() was called. */
+inline RemoteCache *remoteProgramCache()
+{
+	/* zero-initialized, as a static */
+	static RemoteCache cache;
+	return &cache;
+}
+
+#endif
@@ -0,0 +1,698 @@
+#ifndef HEADER_RENDERFARM_H
+#define HEADER_RENDERFARM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#ifndef _WIN32
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+#include "Log.h"
+#include "Profiler.h"
+#include "Lz.h"
+#include "Batch.h"
+#include "Capture.h"
+
+/****************************************************************************
+* RENDER FARM                                                              *
+****************************************************************************/
+
+/* The jobs of a batch file rendered by other machines: the coordinator
+* (--farm-listen PORT) renders nothing, it waits for render nodes
+* (--farm-node HOST:PORT) to connect, cuts the jobs into shards and hands
+* them out, and writes the frames the nodes send back into the outputs of
+* the jobs. Nodes may join at any time; the shards of a node which goes
+* away are handed to the others.
+* A shard is a range of up to --farm-shard frames of a job with PNG
+* outputs; a video or raw output is written in frame order, so its job is a
+* single shard. The shards go out by queue depth like the jobs of
+* BatchWorkers.h: to the node with the fewest unfinished ones, at most
+* FARM_NODE_DEPTH each, so a node always has the next shard at hand.
+* A node renders each frame into a named screenshot of its FrameCapture,
+* whose encoder thread compresses the pixels with Lz.h and sends them,
+* so the transfer overlaps the rendering. A shard is done when all its
+* frames are back. Before a node asks for work it builds every program,
+* which fills its program binary cache, so neither the first shard nor a
+* later run of the node waits for the shader compiler.
+* The protocol is TCP, each message an 8 byte header, the type as 4
+* characters and the length of the payload as a big endian 32 bit number,
+* then the payload of big endian 32 bit numbers:
+*   HELO  node -> coordinator, the GL renderer of the node as text
+*   JOBS  coordinator -> node, the BatchJob array as it is in memory, so
+*         all machines must run the same build on the same architecture
+*   SHRD  coordinator -> node, job, first frame, frame count
+*   FRAM  node -> coordinator, job, frame, width, height, then the RGBA8
+*         pixels (rows from the bottom) compressed with lzCompress
+*   FAIL  node -> coordinator, job, first frame, frame count
+* Either side ends by closing the connection. Not available on Windows. */
+#define FARM_NODES_MAX 64
+#define FARM_NODE_DEPTH 2
+#define FARM_SHARD_FRAMES 16	/* default frames per shard */
+#define FARM_HEADER 8
+#define FARM_MESSAGE_MAX (64u << 20)	/* the largest payload accepted */
+
+static void farmPut32(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v >> 24);
+	p[1] = (unsigned char)(v >> 16);
+	p[2] = (unsigned char)(v >> 8);
+	p[3] = (unsigned char)v;
+}
+
+static unsigned int farmGet32(const unsigned char *p)
+{
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+/* a range of frames of a job */
+typedef struct {
+	int job, first, count;
+	int received;		/* frames back so far */
+} FarmShard;
+
+#ifndef _WIN32
+/* Send the message type with the length bytes of payload on socket fd.
+* Returns true if successfull. */
+static bool farmSend(int fd, const char *type, const void *payload, size_t length)
+{
+	unsigned char header[FARM_HEADER];
+	memcpy(header, type, 4);
+	farmPut32(header + 4, (unsigned int)length);
+	const unsigned char *parts[2] = { header, (const unsigned char*)payload };
+	size_t sizes[2] = { sizeof(header), length };
+	for (int i = 0; i < 2; i++) {
+		size_t done = 0;
+		while (done < sizes[i]) {
+			ssize_t n = send(fd, parts[i] + done, sizes[i] - done, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				return false;
+			done += (size_t)n;
+		}
+	}
+	return true;
+}
+
+/* Read exactly length bytes from socket fd into data.
+* Returns false if the connection ended or failed. */
+static bool farmReceive(int fd, void *data, size_t length)
+{
+	size_t done = 0;
+	while (done < length) {
+		ssize_t n = recv(fd, (unsigned char*)data + done, length - done, 0);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		done += (size_t)n;
+	}
+	return true;
+}
+
+/****************************************************************************
+* COORDINATOR                                                              *
+****************************************************************************/
+
+typedef struct {
+	int fd;			/* -1 if the slot is free */
+	char name[128];		/* its renderer */
+	bool ready;		/* it said hello, after building its programs */
+	unsigned char *buffer;	/* the message being received */
+	size_t capacity, length;
+	int queue[FARM_NODE_DEPTH];	/* its unfinished shards */
+	int depth;
+	int shards, frames;	/* finished */
+	size_t bytes;		/* compressed frame data received */
+} FarmNode;
+
+typedef struct {
+	const BatchFile *batch;
+	FarmShard *shards;
+	int shardCount;
+	int *pending;		/* the shards to hand out, as a stack */
+	int pendingCount;
+	int finished;		/* shards complete */
+	int failed;
+	FarmNode nodes[FARM_NODES_MAX];
+	int listener;
+	FrameCapture **streams;	/* per job, the open raw or video output, or NULL */
+	int videoEncoder;	/* CAPTURE_ENCODER_* of the videos */
+	unsigned char *pixels;	/* a decompressed frame */
+	size_t pixelCapacity;
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+		listener = -1;
+		for (int i = 0; i < FARM_NODES_MAX; i++)
+			nodes[i].fd = -1;
+	}
+
+	/* Cut the jobs of batch into shards of shardFrames frames.
+	* Returns true if successfull. */
+	bool split(int shardFrames)
+	{
+		char name[CAPTURE_PATH_MAX];
+		int i, f, n = 0;
+		for (i = 0; i < batch->count; i++) {
+			const BatchJob *job = &batch->jobs[i];
+			n += job->frameFile(0, name, sizeof(name)) ? (job->frames + shardFrames - 1) / shardFrames : 1;
+		}
+		shards = (FarmShard*)calloc(n, sizeof(FarmShard));
+		pending = (int*)malloc(sizeof(int) * n);
+		streams = (FrameCapture**)calloc(batch->count, sizeof(FrameCapture*));
+		if (!shards || !pending || !streams)
+			return false;
+		for (i = 0; i < batch->count; i++) {
+			const BatchJob *job = &batch->jobs[i];
+			int step = job->frameFile(0, name, sizeof(name)) ? shardFrames : job->frames;
+			for (f = 0; f < job->frames; f += step) {
+				FarmShard *s = &shards[shardCount++];
+				s->job = i;
+				s->first = f;
+				s->count = (job->frames - f < step) ? job->frames - f : step;
+			}
+		}
+		/* a stack, the first shard on top */
+		for (i = 0; i < shardCount; i++)
+			pending[i] = shardCount - 1 - i;
+		pendingCount = shardCount;
+		return true;
+	}
+
+	/* Listen for nodes on port.
+	* Returns true if successfull. */
+	bool listen(int port)
+	{
+		struct sockaddr_in6 addr;
+		int one = 1, off = 0;
+		listener = socket(AF_INET6, SOCK_STREAM, 0);
+		if (listener < 0) {
+			warn("farm: failed to create a socket: %s", strerror(errno));
+			return false;
+		}
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		/* IPv4 nodes as well */
+		setsockopt(listener, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+		memset(&addr, 0, sizeof(addr));
+		addr.sin6_family = AF_INET6;
+		addr.sin6_addr = in6addr_any;
+		addr.sin6_port = htons((unsigned short)port);
+		if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) || ::listen(listener, 16)) {
+			warn("farm: failed to listen on port %d: %s", port, strerror(errno));
+			return false;
+		}
+		info("farm: %d jobs in %d shards, waiting for nodes on port %d", batch->count, shardCount, port);
+		return true;
+	}
+
+	void accept()
+	{
+		int fd = ::accept(listener, NULL, NULL), i, one = 1;
+		if (fd < 0)
+			return;
+		/* the slots of the nodes which rendered something keep their counts */
+		for (i = 0; i < FARM_NODES_MAX && (nodes[i].fd >= 0 || nodes[i].frames); i++)
+			;
+		if (i == FARM_NODES_MAX) {
+			warn("farm: more than %d nodes, refusing one", FARM_NODES_MAX);
+			close(fd);
+			return;
+		}
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		FarmNode *node = &nodes[i];
+		unsigned char *buffer = node->buffer;
+		size_t capacity = node->capacity;
+		memset(node, 0, sizeof(*node));
+		node->fd = fd;
+		node->buffer = buffer;
+		node->capacity = capacity;
+		mysnprintf(node->name, sizeof(node->name), "node %d", i);
+		if (!farmSend(fd, "JOBS", batch->jobs, sizeof(BatchJob) * batch->count))
+			lost(node);
+	}
+
+	/* Node node has gone: put its unfinished shards back. */
+	void lost(FarmNode *node)
+	{
+		int i;
+		if (node->depth)
+			warn("farm: %s went away with %d shards left", node->name, node->depth);
+		else
+			info("farm: %s left after %d shards", node->name, node->shards);
+		for (i = node->depth - 1; i >= 0; i--) {
+			shards[node->queue[i]].received = 0;
+			pending[pendingCount++] = node->queue[i];
+		}
+		close(node->fd);
+		node->fd = -1;
+		node->depth = 0;
+	}
+
+	/* Hand the next pending shard to the node with the fewest unfinished
+	* ones, if one has room. Returns false if none has. */
+	bool assign()
+	{
+		FarmNode *best = NULL;
+		unsigned char payload[12];
+		int i;
+		for (i = 0; i < FARM_NODES_MAX; i++) {
+			FarmNode *n = &nodes[i];
+			if (n->fd >= 0 && n->ready && n->depth < FARM_NODE_DEPTH && (!best || n->depth < best->depth))
+				best = n;
+		}
+		if (!best || !pendingCount)
+			return false;
+		int index = pending[--pendingCount];
+		const FarmShard *s = &shards[index];
+		best->queue[best->depth++] = index;
+		farmPut32(payload, (unsigned int)s->job);
+		farmPut32(payload + 4, (unsigned int)s->first);
+		farmPut32(payload + 8, (unsigned int)s->count);
+		if (!farmSend(best->fd, "SHRD", payload, sizeof(payload)))
+			lost(best);
+		return true;
+	}
+
+	/* The shard of node whose job is job and which holds frame, its index
+	* in the queue of node or -1. */
+	int find(const FarmNode *node, int job, int frame) const
+	{
+		for (int i = 0; i < node->depth; i++) {
+			const FarmShard *s = &shards[node->queue[i]];
+			if (s->job == job && frame >= s->first && frame < s->first + s->count)
+				return i;
+		}
+		return -1;
+	}
+
+	/* Frame queue entry q of node is back: count it and retire the shard
+	* once it is complete. */
+	void shardFrame(FarmNode *node, int q)
+	{
+		FarmShard *s = &shards[node->queue[q]];
+		if (++s->received < s->count)
+			return;
+		memmove(node->queue + q, node->queue + q + 1, sizeof(int) * (node->depth - q - 1));
+		node->depth--;
+		node->shards++;
+		finished++;
+	}
+
+	/* Write a frame of width x height pixels of job to its output.
+	* Returns true if successfull. */
+	bool write(int job, int frame, const unsigned char *data, int width, int height)
+	{
+		const BatchJob *j = &batch->jobs[job];
+		char name[CAPTURE_PATH_MAX];
+		if (j->frameFile(frame, name, sizeof(name)))
+			return captureWritePng(name, data, width, height);
+		FrameCapture *stream = streams[job];
+		/* the shard starts over, after its node went away */
+		if (frame == 0 && stream) {
+			stream->stop();
+			delete stream;
+			stream = streams[job] = NULL;
+		}
+		if (!stream) {
+			stream = streams[job] = new FrameCapture;
+			stream->clear();
+			stream->videoEncoder = videoEncoder;
+			if (!stream->record(j->output, j->fps))
+				return false;
+		}
+		CaptureFrame f;
+		memset(&f, 0, sizeof(f));
+		f.pixels = (unsigned char*)data;
+		f.width = width;
+		f.height = height;
+		f.video = true;
+		f.videoIndex = (unsigned int)frame;
+		bool ok = stream->writeVideo(&f);
+		stream->frames++;
+		if (frame == j->frames - 1) {
+			stream->stop();
+			ok = ok && !stream->failed;
+			delete stream;
+			streams[job] = NULL;
+		}
+		return ok;
+	}
+
+	/* Act on the complete message in the buffer of node.
+	* Returns false if the node broke the protocol. */
+	bool message(FarmNode *node)
+	{
+		const unsigned char *m = node->buffer;
+		size_t length = node->length - FARM_HEADER;
+		const unsigned char *p = m + FARM_HEADER;
+		if (!memcmp(m, "HELO", 4)) {
+			mysnprintf(node->name, sizeof(node->name), "'%.*s'", (int)(length < 120 ? length : 120), (const char*)p);
+			info("farm: %s joined", node->name);
+			node->ready = true;
+			return true;
+		}
+		if (length < 12)
+			return false;
+		int job = (int)farmGet32(p), frame = (int)farmGet32(p + 4), count = (int)farmGet32(p + 8), q;
+		if (job < 0 || job >= batch->count || (q = find(node, job, frame)) < 0)
+			return false;
+		if (!memcmp(m, "FAIL", 4)) {
+			warn("farm: %s failed frames %d to %d of job %d", node->name, frame, frame + count - 1, job);
+			failed++;
+			shards[node->queue[q]].received = shards[node->queue[q]].count - 1;
+			shardFrame(node, q);
+			return true;
+		}
+		if (memcmp(m, "FRAM", 4) || length < 16)
+			return false;
+		int width = count, height = (int)farmGet32(p + 12);
+		const BatchJob *j = &batch->jobs[job];
+		if (width != j->width || height != j->height)
+			return false;
+		size_t size = (size_t)width * height * 4;
+		if (pixelCapacity < size) {
+			free(pixels);
+			pixels = (unsigned char*)malloc(size);
+			pixelCapacity = pixels ? size : 0;
+			if (!pixels)
+				return false;
+		}
+		if (!lzDecompress(p + 16, length - 16, pixels, size))
+			return false;
+		if (!write(job, frame, pixels, width, height)) {
+			warn("farm: writing frame %d of job %d into '%s' failed", frame, job, j->output);
+			failed++;
+		}
+		node->frames++;
+		node->bytes += length - 16;
+		shardFrame(node, q);
+		return true;
+	}
+
+	/* Read what node has sent. */
+	void receive(FarmNode *node)
+	{
+		size_t want = FARM_HEADER;
+		if (node->length >= FARM_HEADER)
+			want += farmGet32(node->buffer + 4);
+		if (node->capacity < want) {
+			unsigned char *more = (unsigned char*)realloc(node->buffer, want);
+			if (!more) {
+				lost(node);
+				return;
+			}
+			node->buffer = more;
+			node->capacity = want;
+		}
+		ssize_t n = recv(node->fd, node->buffer + node->length, want - node->length, 0);
+		if (n < 0 && errno == EINTR)
+			return;
+		if (n <= 0) {
+			lost(node);
+			return;
+		}
+		node->length += (size_t)n;
+		if (node->length == FARM_HEADER && farmGet32(node->buffer + 4) > FARM_MESSAGE_MAX) {
+			warn("farm: %s sent a message of %u bytes", node->name, farmGet32(node->buffer + 4));
+			lost(node);
+			return;
+		}
+		if (node->length < FARM_HEADER || node->length < FARM_HEADER + farmGet32(node->buffer + 4))
+			return;
+		if (!message(node)) {
+			warn("farm: %s sent a malformed '%.4s' message", node->name, (const char*)node->buffer);
+			lost(node);
+			return;
+		}
+		node->length = 0;
+	}
+
+	/* Render the jobs of batch on the nodes which connect to port, in
+	* shards of shardFrames frames, and encode the videos with encoder.
+	* Returns true if successfull and false in case of an error or if a
+	* frame failed. */
+	bool run(const BatchFile *jobs, int port, int shardFrames, int encoder = CAPTURE_ENCODER_AUTO)
+	{
+		struct pollfd fds[FARM_NODES_MAX + 1];
+		FarmNode *polled[FARM_NODES_MAX + 1];
+		int i, n, frames = 0;
+		size_t bytes = 0;
+		double start = 0.0;
+
+		clear();
+		batch = jobs;
+		videoEncoder = encoder;
+		if (!split(shardFrames) || !listen(port)) {
+			destroy();
+			return false;
+		}
+		signal(SIGPIPE, SIG_IGN);
+		while (finished < shardCount) {
+			while (assign())
+				;
+			fds[0].fd = listener;
+			fds[0].events = POLLIN;
+			polled[0] = NULL;
+			for (n = 1, i = 0; i < FARM_NODES_MAX; i++) {
+				if (nodes[i].fd >= 0) {
+					fds[n].fd = nodes[i].fd;
+					fds[n].events = POLLIN;
+					polled[n++] = &nodes[i];
+				}
+			}
+			if (poll(fds, (nfds_t)n, -1) < 0) {
+				if (errno == EINTR)
+					continue;
+				warn("farm: poll failed");
+				break;
+			}
+			if (fds[0].revents & POLLIN) {
+				if (start == 0.0)
+					start = profileSeconds();
+				accept();
+			}
+			for (i = 1; i < n; i++) {
+				if (fds[i].revents && polled[i]->fd >= 0)
+					receive(polled[i]);
+			}
+		}
+		double total = start > 0.0 ? profileSeconds() - start : 0.0;
+		for (i = 0; i < FARM_NODES_MAX; i++) {
+			FarmNode *node = &nodes[i];
+			if (!node->frames && node->fd < 0)
+				continue;
+			frames += node->frames;
+			bytes += node->bytes;
+			info("farm: %s: %d shards, %d frames, %.1f MB", node->name, node->shards, node->frames,
+				(double)node->bytes / 1048576.0);
+		}
+		info("farm: %d of %d shards, %d frames in %.3fs, %.1f frames per second, %.1f MB received",
+			finished, shardCount, frames, total, total > 0.0 ? (double)frames / total : 0.0,
+			(double)bytes / 1048576.0);
+		bool ok = finished == shardCount && !failed;
+		destroy();
+		return ok;
+	}
+
+	/* Close all connections, the nodes end. */
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < FARM_NODES_MAX; i++) {
+			if (nodes[i].fd >= 0)
+				close(nodes[i].fd);
+			free(nodes[i].buffer);
+		}
+		if (listener >= 0)
+			close(listener);
+		if (streams) {
+			for (i = 0; i < batch->count; i++) {
+				if (streams[i]) {
+					streams[i]->stop();
+					delete streams[i];
+				}
+			}
+		}
+		free(streams);
+		free(shards);
+		free(pending);
+		free(pixels);
+		clear();
+	}
+} FarmCoordinator;
+
+/****************************************************************************
+* NODE                                                                     *
+****************************************************************************/
+
+/* The connection of a render node to the coordinator. The main thread
+* reads the shards, the encoder thread of the capture sends the frames. */
+typedef struct FarmConnection {
+	int fd;
+	std::mutex sendLock;	/* the frames are sent from the encoder thread */
+	unsigned char *compressed;	/* of the encoder thread */
+	size_t capacity;
+	bool failed;		/* sending failed */
+	unsigned int frames;
+	unsigned long long raw, sent;	/* bytes */
+
+	void clear()
+	{
+		fd = -1;
+		compressed = NULL;
+		capacity = 0;
+		failed = false;
+		frames = 0;
+		raw = sent = 0;
+	}
+
+	/* Connect to the coordinator at address, "host:port".
+	* Returns true if successfull. */
+	bool connect(const char *address)
+	{
+		char host[256];
+		const char *colon = strrchr(address, ':');
+		struct addrinfo hints, *list = NULL, *a;
+		int one = 1;
+
+		clear();
+		if (!colon || colon == address || (size_t)(colon - address) >= sizeof(host)) {
+			warn("farm: '%s' is not host:port", address);
+			return false;
+		}
+		mysnprintf(host, sizeof(host), "%.*s", (int)(colon - address), address);
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		if (getaddrinfo(host, colon + 1, &hints, &list)) {
+			warn("farm: failed to resolve '%s'", host);
+			return false;
+		}
+		for (a = list; a && fd < 0; a = a->ai_next) {
+			fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+			if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen)) {
+				close(fd);
+				fd = -1;
+			}
+		}
+		freeaddrinfo(list);
+		if (fd < 0) {
+			warn("farm: failed to connect to '%s'", address);
+			return false;
+		}
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		signal(SIGPIPE, SIG_IGN);
+		info("farm: connected to '%s'", address);
+		return true;
+	}
+
+	/* Send a message of the main thread. */
+	bool send(const char *type, const void *payload, size_t length)
+	{
+		std::lock_guard<std::mutex> guard(sendLock);
+		return farmSend(fd, type, payload, length);
+	}
+
+	/* Receive the next message of the coordinator into *type, the
+	* payload into *payload (realloced, of *capacity bytes) and its length
+	* into *length. Returns false if the coordinator is gone. */
+	bool receive(char *type, unsigned char **payload, size_t *capacity, size_t *length)
+	{
+		unsigned char header[FARM_HEADER];
+		if (!farmReceive(fd, header, sizeof(header)))
+			return false;
+		memcpy(type, header, 4);
+		*length = farmGet32(header + 4);
+		if (*length > FARM_MESSAGE_MAX)
+			return false;
+		if (*capacity < *length) {
+			unsigned char *more = (unsigned char*)realloc(*payload, *length);
+			if (!more)
+				return false;
+			*payload = more;
+			*capacity = *length;
+		}
+		return farmReceive(fd, *payload, *length);
+	}
+
+	/* The capture sink of the node: compress and send the frame named
+	* "job frame" by the render loop. Encoder thread. */
+	static void sink(void *user, const char *name, const unsigned char *pixels, int width, int height)
+	{
+		FarmConnection *c = (FarmConnection*)user;
+		size_t size = (size_t)width * height * 4, bound = 16 + lzBound(size), n;
+		int job, frame;
+
+		if (c->failed || sscanf(name, "%d %d", &job, &frame) != 2)
+			return;
+		if (c->capacity < bound) {
+			free(c->compressed);
+			c->compressed = (unsigned char*)malloc(bound);
+			c->capacity = c->compressed ? bound : 0;
+			if (!c->compressed) {
+				c->failed = true;
+				return;
+			}
+		}
+		farmPut32(c->compressed, (unsigned int)job);
+		farmPut32(c->compressed + 4, (unsigned int)frame);
+		farmPut32(c->compressed + 8, (unsigned int)width);
+		farmPut32(c->compressed + 12, (unsigned int)height);
+		n = lzCompress(pixels, size, c->compressed + 16, bound - 16);
+		if (!n || !c->send("FRAM", c->compressed, 16 + n)) {
+			c->failed = true;
+			return;
+		}
+		c->frames++;
+		c->raw += size;
+		c->sent += n;
+	}
+
+	void destroy()
+	{
+		if (fd >= 0)
+			close(fd);
+		free(compressed);
+		clear();
+	}
+} FarmConnection;
+#else
+/* no sockets on Windows */
+typedef struct {
+	bool run(const BatchFile *jobs, int port, int shardFrames, int encoder = CAPTURE_ENCODER_AUTO)
+	{
+		(void)jobs; (void)port; (void)shardFrames; (void)encoder;
+		warn("farm: not supported on Windows");
+		return false;
+	}
+} FarmCoordinator;
+
+typedef struct {
+	bool failed;
+	unsigned int frames;
+	unsigned long long raw, sent;
+
+	bool connect(const char *address)
+	{
+		(void)address;
+		warn("farm: not supported on Windows");
+		return false;
+	}
+	bool send(const char *, const void *, size_t) { return false; }
+	bool receive(char *, unsigned char **, size_t *, size_t *) { return false; }
+	static void sink(void *, const char *, const unsigned char *, int, int) {}
+	void destroy() {}
+} FarmConnection;
+#endif
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef HEADER_RENDERGRAPH_H
+#define HEADER_RENDERGRAPH_H
+
+#include <glad/glad.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* RENDER GRAPH                                                             *
+****************************************************************************/
+
+/* RenderGraph: the passes of a frame which work on whole images, like the
+* post-processing (see PostProcess.h). They are declared anew each frame:
+* every pass names the resources it reads and the one it renders into, and
+* execute() works out the rest. It orders the passes such that each runs
+* after the passes producing its inputs, and drops the passes nobody
+* needs, i.e. those which do not lead to an imported resource. Imported
+* resources, like the scene target and the window, belong to the caller.
+* Transient resources only live from the pass writing them to the last pass
+* reading them; they get textures from a pool, and a texture goes back to
+* the pool as soon as its last reader ran, so the next pass writing a
+* resource of the same format and size reuses it: a chain of full screen
+* passes needs two such textures, however long it is. Pool textures which
+* were not used in a frame are freed.
+* GL orders rendering into a texture before sampling it later by itself, so
+* barriers are only needed after passes which write their output with
+* image stores (RENDER_PASS_IMAGE_STORE), and the graph issues one before
+* the first pass sampling what such a pass wrote. */
+#define RENDER_GRAPH_MAX_PASSES 24
+#define RENDER_GRAPH_MAX_RESOURCES 24
+#define RENDER_GRAPH_MAX_INPUTS 4
+#define RENDER_GRAPH_POOL_SIZE 16
+
+#define RENDER_PASS_IMAGE_STORE 1u	/* writes its output with image stores, not the framebuffer */
+
+/* The format and type of the pixels for a texture of internal format
+* internalFormat, for glTexImage2D without data. */
+static void renderPixelFormat(GLenum internalFormat, GLenum *format, GLenum *type)
+{
+	switch (internalFormat) {
+		case GL_R8: *format = GL_RED; *type = GL_UNSIGNED_BYTE; return;
+		case GL_R16F: case GL_R32F: *format = GL_RED; *type = GL_FLOAT; return;
+		case GL_RGBA16F: case GL_RGBA32F: case GL_R11F_G11F_B10F: *format = GL_RGBA; *type = GL_FLOAT; return;
+	}
+	*format = GL_RGBA;
+	*type = GL_UNSIGNED_BYTE;
+}
+
+struct RenderPass;
+
+/* Runs pass p, with the framebuffer of its output bound and the viewport
+* set to its size. */
+typedef void (*RenderPassFunc)(void *object, const RenderPass *p);
+
+typedef struct {
+	const char *name;
+	GLenum format;		/* internal format of transient ones */
+	GLsizei width, height;
+	GLuint texture;		/* imported, or the pool texture while it lives */
+	GLuint fbo;		/* with texture attached, 0 for the default framebuffer */
+	bool imported;
+	int producer;		/* the pass writing it, -1 if none */
+	int lastUse;		/* position in the order of the last pass using it */
+	int pool;		/* the pool entry of a transient one, -1 if none */
+	GLbitfield barrier;	/* to issue before sampling it */
+} RenderResource;
+
+typedef struct RenderPass {
+	const char *name;
+	RenderPassFunc run;
+	void *object;		/* passed to run */
+	unsigned int flags;	/* RENDER_PASS_* */
+	int inputs[RENDER_GRAPH_MAX_INPUTS];
+	int inputCount;
+	int output;
+	/* set while it runs */
+	GLuint inputTextures[RENDER_GRAPH_MAX_INPUTS];
+	GLuint outputTexture;
+	GLsizei width, height;	/* of the output */
+} RenderPass;
+
+/* a texture of the pool, with an FBO it is attached to */
+typedef struct {
+	GLenum format;
+	GLsizei width, height;
+	GLuint texture, fbo;	/* 0 if the entry is free */
+	bool busy;		/* held by a live resource */
+	bool used;		/* in the current frame */
+} RenderPoolEntry;
+
+typedef struct {
+	RenderPass passes[RENDER_GRAPH_MAX_PASSES];
+	int passCount;
+	RenderResource resources[RENDER_GRAPH_MAX_RESOURCES];
+	int resourceCount;
+	RenderPoolEntry pool[RENDER_GRAPH_POOL_SIZE];
+	int order[RENDER_GRAPH_MAX_PASSES];	/* the passes to run */
+	int orderCount;
+
+	/* of the last execute() */
+	int transientCount;	/* transient resources */
+	int textureCount;	/* pool textures they needed */
+
+	void init()
+	{
+		memset(pool, 0, sizeof(pool));
+		passCount = resourceCount = orderCount = 0;
+		transientCount = textureCount = 0;
+	}
+
+	/* Start declaring the passes of a new frame. */
+	void begin()
+	{
+		passCount = resourceCount = orderCount = 0;
+	}
+
+	int addResource(const char *name, GLenum format, GLsizei w, GLsizei h)
+	{
+		if (resourceCount >= RENDER_GRAPH_MAX_RESOURCES) {
+			warn("render graph: too many resources for %s", name);
+			return -1;
+		}
+		RenderResource *r = &resources[resourceCount];
+		r->name = name;
+		r->format = format;
+		r->width = w;
+		r->height = h;
+		r->texture = r->fbo = 0;
+		r->imported = false;
+		r->producer = -1;
+		r->lastUse = -1;
+		r->pool = -1;
+		r->barrier = 0;
+		return resourceCount++;
+	}
+
+	/* Declare a resource owned by the caller: texture to be sampled, and
+	* fbo to render into it, both of w x h pixels. The default framebuffer
+	* has neither. Returns its index, or -1 in case of an error. */
+	int import(const char *name, GLuint texture, GLuint fbo, GLsizei w, GLsizei h)
+	{
+		int index = addResource(name, 0, w, h);
+		if (index >= 0) {
+			resources[index].texture = texture;
+			resources[index].fbo = fbo;
+			resources[index].imported = true;
+		}
+		return index;
+	}
+
+	/* Declare a transient resource of w x h pixels of the internal format
+	* format. Returns its index, or -1 in case of an error. */
+	int create(const char *name, GLenum format, GLsizei w, GLsizei h)
+	{
+		return addResource(name, format, w, h);
+	}
+
+	/* Declare a pass reading count resources of inputs and writing output,
+	* run calls run with object. Returns false in case of an error. */
+	bool addPass(const char *name, RenderPassFunc run, void *object, unsigned int flags,
+		const int *inputs, int count, int output)
+	{
+		int i;
+
+		if (passCount >= RENDER_GRAPH_MAX_PASSES || count > RENDER_GRAPH_MAX_INPUTS ||
+			output < 0 || resources[output].producer >= 0) {
+			warn("render graph: cannot add pass %s", name);
+			return false;
+		}
+		for (i = 0; i < count; i++)
+			if (inputs[i] < 0)
+				return false;
+		RenderPass *p = &passes[passCount];
+		p->name = name;
+		p->run = run;
+		p->object = object;
+		p->flags = flags;
+		p->inputCount = count;
+		for (i = 0; i < count; i++)
+			p->inputs[i] = inputs[i];
+		p->output = output;
+		resources[output].producer = passCount++;
+		return true;
+	}
+
+	/* Append pass index to the order after the producers of its inputs,
+	* state holds 0 for unvisited passes, 1 for those being visited and 2
+	* for those done. Returns false if the passes depend on each other. */
+	bool visit(int index, int *state)
+	{
+		int i;
+
+		if (state[index] == 2)
+			return true;
+		if (state[index] == 1) {
+			warn("render graph: pass %s depends on itself", passes[index].name);
+			return false;
+		}
+		state[index] = 1;
+		for (i = 0; i < passes[index].inputCount; i++) {
+			int producer = resources[passes[index].inputs[i]].producer;
+			if (producer >= 0 && !visit(producer, state))
+				return false;
+		}
+		state[index] = 2;
+		order[orderCount++] = index;
+		return true;
+	}
+
+	/* Order the passes leading to imported resources and find how long
+	* each resource lives. Returns false in case of an error. */
+	bool compile()
+	{
+		int state[RENDER_GRAPH_MAX_PASSES] = { 0 };
+		int i, j;
+
+		orderCount = 0;
+		for (i = 0; i < passCount; i++)
+			if (resources[passes[i].output].imported && !visit(i, state))
+				return false;
+		for (i = 0; i < orderCount; i++) {
+			const RenderPass *p = &passes[order[i]];
+			for (j = 0; j < p->inputCount; j++) {
+				RenderResource *r = &resources[p->inputs[j]];
+				if (!r->imported && r->producer < 0) {
+					warn("render graph: pass %s reads %s, which nobody writes", p->name, r->name);
+					return false;
+				}
+				r->lastUse = i;
+			}
+			if (resources[p->output].lastUse < i)
+				resources[p->output].lastUse = i;
+		}
+		return true;
+	}
+
+	/* Take a pool texture for transient resource r, reusing a free one of
+	* the same format and size. Returns false if the pool is full. */
+	bool acquire(RenderResource *r)
+	{
+		static const GLenum buffers[1] = { GL_COLOR_ATTACHMENT0 };
+		int i, empty = -1;
+		MemoryScope scope(MEMORY_TARGETS);
+
+		for (i = 0; i < RENDER_GRAPH_POOL_SIZE; i++) {
+			RenderPoolEntry *e = &pool[i];
+			if (!e->texture) {
+				if (empty < 0)
+					empty = i;
+			} else if (!e->busy && e->format == r->format && e->width == r->width && e->height == r->height) {
+				break;
+			}
+		}
+		if (i == RENDER_GRAPH_POOL_SIZE) {
+			if (empty < 0) {
+				warn("render graph: no texture left for %s", r->name);
+				return false;
+			}
+			i = empty;
+			RenderPoolEntry *e = &pool[i];
+			e->format = r->format;
+			e->width = r->width;
+			e->height = r->height;
+			glGenTextures(1, &e->texture);
+			glState()->bindTexture(GL_TEXTURE_2D, e->texture);
+			GLenum format, type;
+			renderPixelFormat(e->format, &format, &type);
+			glTexImage2D(GL_TEXTURE_2D, 0, e->format, e->width, e->height, 0, format, type, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+			glGenFramebuffers(1, &e->fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, e->fbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, e->texture, 0);
+			glDrawBuffers(1, buffers);
+			info("render graph: texture %u of %dx%d pixels for %s", e->texture,
+				(int)e->width, (int)e->height, r->name);
+		}
+		pool[i].busy = pool[i].used = true;
+		r->pool = i;
+		r->texture = pool[i].texture;
+		r->fbo = pool[i].fbo;
+		return true;
+	}
+
+	void freeEntry(RenderPoolEntry *e)
+	{
+		if (e->fbo)
+			glDeleteFramebuffers(1, &e->fbo);
+		if (e->texture)
+			glState()->deleteTextures(1, &e->texture);
+		e->texture = e->fbo = 0;
+		e->busy = e->used = false;
+	}
+
+	/* Run the passes declared since begin(). The passes draw without depth
+	* test and writes, which are back to normal afterwards. The framebuffer
+	* of the last pass stays bound.
+	* Returns true if successfull and false in case of an error. */
+	bool execute()
+	{
+		int i, j, k;
+		bool ok = compile();
+
+		transientCount = textureCount = 0;
+		glState()->disable(GL_DEPTH_TEST);
+		glState()->raster(0);
+		for (i = 0; ok && i < orderCount; i++) {
+			RenderPass *p = &passes[order[i]];
+			RenderResource *out = &resources[p->output];
+			GLbitfield barrier = 0;
+
+			for (j = 0; j < p->inputCount; j++) {
+				RenderResource *r = &resources[p->inputs[j]];
+				barrier |= r->barrier;
+				r->barrier = 0;
+				p->inputTextures[j] = r->texture;
+			}
+			if (barrier)
+				glMemoryBarrier(barrier);
+			if (!out->imported && out->pool < 0) {
+				if (!acquire(out)) {
+					ok = false;
+					break;
+				}
+				transientCount++;
+			}
+			p->outputTexture = out->texture;
+			p->width = out->width;
+			p->height = out->height;
+			if (!(p->flags & RENDER_PASS_IMAGE_STORE)) {
+				glBindFramebuffer(GL_FRAMEBUFFER, out->fbo);
+				glState()->viewport(0, 0, out->width, out->height);
+			}
+			p->run(p->object, p);
+			if (p->flags & RENDER_PASS_IMAGE_STORE)
+				out->barrier = GL_TEXTURE_FETCH_BARRIER_BIT;
+
+			/* the transient resources nobody reads any more give their
+			 * texture to the next ones */
+			for (k = 0; k < resourceCount; k++) {
+				RenderResource *r = &resources[k];
+				if (r->lastUse == i && r->pool >= 0)
+					pool[r->pool].busy = false;
+			}
+		}
+		glState()->raster(RASTER_DEFAULT);
+		glState()->enable(GL_DEPTH_TEST);
+
+		for (i = 0; i < RENDER_GRAPH_POOL_SIZE; i++) {
+			if (pool[i].texture && !pool[i].used)
+				freeEntry(&pool[i]);
+			if (pool[i].texture)
+				textureCount++;
+			pool[i].busy = pool[i].used = false;
+		}
+		GL_ERROR_DBG("render graph");
+		return ok;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < RENDER_GRAPH_POOL_SIZE; i++)
+			freeEntry(&pool[i]);
+		init();
+	}
+} RenderGraph;
+
+#endif
@@ -0,0 +1,387 @@
+#ifndef HEADER_RENDERQUEUE_H
+#define HEADER_RENDERQUEUE_H
+
+#include <glad/glad.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "PipelineState.h"
+
+/****************************************************************************
+* RENDER QUEUE                                                             *
+****************************************************************************/
+
+/* RenderQueue: the draws of a frame are first recorded as packets, then
+* sorted and submitted together. Each packet names the state it needs (the
+* program, a material texture and the VAO) and a function doing the actual
+* draw call with that state bound. The 64 bit sort key orders the packets by
+* program, then material, then VAO, then front to back, so packets sharing
+* state end up next to each other, and submit() only binds what differs
+* from the previous packet. The keys are sorted with a radix sort, which is
+* linear in the number of packets.
+* A packet may have a depth pre-pass program, usually the same shaders
+* without any color work (see ProgramRegistry::addPrepass). These packets
+* are drawn twice: first all of them depth only, with color writes off,
+* then the main pass tests GL_EQUAL against that depth without writing it,
+* so their expensive fragment shaders run once per pixel, however much the
+* objects overlap. Packets without a pre-pass are drawn as usual in the
+* main pass. The programs of both passes must compute bit-identical
+* positions, so their vertex shaders declare gl_Position invariant.
+* A packet may also have a shadow program, which submitShadow() draws it
+* with into a depth target before the frame, e.g. the cascades of
+* ShadowMaps.h, as often as needed; those draws keep its culling only.
+* Each packet also carries the raster state of its program (culling, depth
+* writes and blending, see RASTER_* in GLState.h). push() turns all of it
+* into a pipeline state object per pass (see PipelineState.h), which the
+* application usually prebuilt when the programs were loaded, and the sweep
+* binds the state of each packet with one call through the state cache, so
+* usually only when the program changes.
+* Translucent packets (RASTER_TRANSLUCENT) are drawn after all others,
+* between the translucentBegin and translucentEnd hooks, by an
+* order-independent transparency pass (see Transparency.h), so their key
+* drops the depth and they are only sorted by state. Without the hooks,
+* or if translucentBegin fails, they are not drawn.
+* For the fill rate benchmark, overdraw > 1 repeats each opaque packet of
+* the main pass that many times, the repeats with GL_LEQUAL, so that the
+* surfaces in front are shaded that many times per pixel.
+* After the last packet the raster state is back to RASTER_DEFAULT, which
+* the rest of the frame expects. The bindings are not undone, except in
+* debug builds, where this catches code which relies on leftovers from the
+* queue. */
+#define RENDER_QUEUE_MAX 256
+
+/* the bits of the sort key, from the most significant */
+#define RENDER_KEY_PROGRAM_BITS 12
+#define RENDER_KEY_MATERIAL_BITS 12
+#define RENDER_KEY_VAO_BITS 12
+#define RENDER_KEY_DEPTH_BITS 24
+/* above all of them, orders the translucent packets last */
+#define RENDER_KEY_TRANSLUCENT (1ULL << 63)
+
+/* what sweep() draws */
+#define RENDER_PASS_MAIN 0	/* all packets with their programs */
+#define RENDER_PASS_DEPTH 1	/* those with a pre-pass, depth only */
+#define RENDER_PASS_SHADOW 2	/* the opaque ones with a shadow program */
+#define RENDER_PASSES 3
+
+struct DrawPacket;
+
+/* Issues the draw call of packet p, with its state bound. */
+typedef void (*RenderDrawFunc)(void *object, const DrawPacket *p);
+
+/* Starts or ends a phase of the submit, see RenderQueue::translucentBegin.
+* The begin functions return false if the phase can not run. */
+typedef bool (*RenderPhaseBeginFunc)(void *object);
+typedef void (*RenderPhaseEndFunc)(void *object);
+
+typedef struct DrawPacket {
+	GLuint64 key;
+	GLuint program;		/* program, or pipeline if the queue uses pipelines */
+	GLuint texture;		/* GL_TEXTURE_2D on unit 0, 0 if it needs none */
+	GLuint vao;
+	GLuint prepass;		/* depth pre-pass program or pipeline, 0 for none */
+	GLuint shadow;		/* program or pipeline casting its shadows, 0 for none */
+	unsigned int raster;	/* RASTER_* flags */
+	int state[RENDER_PASSES];	/* pipeline state per pass, -1 if it is not drawn in it */
+	RenderDrawFunc draw;
+	void *object;		/* passed to draw */
+} DrawPacket;
+
+/* Build a sort key. program, material and vao are GL names or other small
+* ids; only their low bits are used, so two different ones may share a
+* slot, which just sorts them as one. depth is the view distance mapped to
+* [0, 1], anything outside is clamped. */
+static GLuint64 renderSortKey(GLuint program, GLuint material, GLuint vao, float depth)
+{
+	const GLuint64 depthMax = (1ULL << RENDER_KEY_DEPTH_BITS) - 1;
+	GLuint64 d;
+
+	if (depth < 0.0f)
+		depth = 0.0f;
+	d = (GLuint64)(depth * (float)depthMax);
+	if (d > depthMax)
+		d = depthMax;
+	return ((GLuint64)(program & ((1u << RENDER_KEY_PROGRAM_BITS) - 1)) <<
+			(RENDER_KEY_MATERIAL_BITS + RENDER_KEY_VAO_BITS + RENDER_KEY_DEPTH_BITS)) |
+		((GLuint64)(material & ((1u << RENDER_KEY_MATERIAL_BITS) - 1)) <<
+			(RENDER_KEY_VAO_BITS + RENDER_KEY_DEPTH_BITS)) |
+		((GLuint64)(vao & ((1u << RENDER_KEY_VAO_BITS) - 1)) << RENDER_KEY_DEPTH_BITS) |
+		d;
+}
+
+/* Sort n keys and their values ascending by key, using tmpKeys and
+* tmpValues of the same size as scratch space. It is a least significant
+* digit radix sort over the 8 bytes of the key; bytes which are the same in
+* all keys (e.g. the unused top bits) are skipped. The result ends up in
+* keys and values. */
+static void radixSort(GLuint64 *keys, unsigned short *values, GLuint64 *tmpKeys, unsigned short *tmpValues, int n)
+{
+	int shift, i;
+	unsigned int count[256];
+
+	for (shift = 0; shift < 64; shift += 8) {
+		memset(count, 0, sizeof(count));
+		for (i = 0; i < n; i++)
+			count[(keys[i] >> shift) & 0xff]++;
+		if (n && count[(keys[0] >> shift) & 0xff] == (unsigned int)n)
+			continue;	/* all keys have the same byte */
+		unsigned int sum = 0;
+		for (i = 0; i < 256; i++) {
+			unsigned int c = count[i];
+			count[i] = sum;
+			sum += c;
+		}
+		for (i = 0; i < n; i++) {
+			unsigned int dst = count[(keys[i] >> shift) & 0xff]++;
+			tmpKeys[dst] = keys[i];
+			tmpValues[dst] = values[i];
+		}
+		memcpy(keys, tmpKeys, sizeof(GLuint64) * n);
+		memcpy(values, tmpValues, sizeof(unsigned short) * n);
+	}
+}
+
+typedef struct {
+	DrawPacket packets[RENDER_QUEUE_MAX];
+	int count;
+	bool pipelines;		/* the programs are program pipelines */
+	PipelineStateCache states;	/* of the packets */
+
+	/* the sort input and scratch space */
+	GLuint64 keys[RENDER_QUEUE_MAX], tmpKeys[RENDER_QUEUE_MAX];
+	unsigned short order[RENDER_QUEUE_MAX], tmpOrder[RENDER_QUEUE_MAX];
+
+	/* around the translucent packets, see Transparency.h */
+	RenderPhaseBeginFunc translucentBegin;
+	RenderPhaseEndFunc translucentEnd;
+	void *translucentObject;	/* passed to both */
+
+	/* drawn in place of a program and its pre-pass, see specialize() */
+	GLuint generic[2], specialized[2];
+
+	/* state changes of the last submit() */
+	unsigned int binds;	/* pipeline states and textures issued */
+	unsigned int skipped;	/* not needed since the state was already set */
+	int currentPass;	/* RENDER_PASS_* sweep() draws, for the draw functions */
+	int overdraw;		/* draws of each opaque packet in the main pass */
+
+	void init()
+	{
+		count = 0;
+		currentPass = RENDER_PASS_MAIN;
+		overdraw = 1;
+		pipelines = false;
+		states.clear();
+		states.separable = false;
+		translucentBegin = NULL;
+		translucentEnd = NULL;
+		translucentObject = NULL;
+		generic[0] = generic[1] = specialized[0] = specialized[1] = 0;
+		binds = skipped = 0;
+	}
+
+	/* Draw the packets pushed with program and prepass from now on with
+	* the specialized ones instead, e.g. those of UniformSpecializer.h,
+	* which compute the same; 0 for specialized stops that. The shadow
+	* programs stay as they are. */
+	void specialize(GLuint program, GLuint prepass, GLuint specializedProgram, GLuint specializedPrepass)
+	{
+		generic[0] = program;
+		generic[1] = prepass;
+		specialized[0] = specializedProgram;
+		specialized[1] = specializedPrepass;
+	}
+
+	/* Start recording a new frame. */
+	void begin()
+	{
+		count = 0;
+		states.separable = pipelines;
+	}
+
+	/* Get the pipeline states of the passes of a packet with program,
+	* vao, raster flags, and the prepass and shadow programs (0 for none)
+	* into ids, creating those which do not exist yet: the main pass tests
+	* against the depth of the pre-pass if there is one, which writes it
+	* with the color writes off instead, and the shadow pass keeps the
+	* culling only, since its target has a size of its own, so no shading
+	* rates either. */
+	void prepare(GLuint program, GLuint vao, unsigned int raster, GLuint prepass, GLuint shadow,
+		int ids[RENDER_PASSES])
+	{
+		if (prepass)
+			ids[RENDER_PASS_MAIN] = states.create(program, vao, raster & ~RASTER_DEPTH_WRITE, GL_EQUAL, true,
+				PIPELINE_TARGET_SCENE);
+		else
+			ids[RENDER_PASS_MAIN] = states.create(program, vao, raster, GL_LESS, true, PIPELINE_TARGET_SCENE);
+		ids[RENDER_PASS_DEPTH] = prepass ? states.create(prepass, vao, raster & ~RASTER_BLEND, GL_LESS, false,
+			PIPELINE_TARGET_SCENE) : -1;
+		ids[RENDER_PASS_SHADOW] = (shadow && !(raster & RASTER_TRANSLUCENT)) ?
+			states.create(shadow, vao, (raster & RASTER_CULL) | RASTER_DEPTH_WRITE, GL_LESS, true,
+				PIPELINE_TARGET_SHADOW) : -1;
+	}
+
+	/* Record a draw. Returns false if the queue is full. */
+	bool push(GLuint64 key, GLuint program, GLuint texture, GLuint vao, RenderDrawFunc draw, void *object,
+		GLuint prepass = 0, unsigned int raster = RASTER_DEFAULT, GLuint shadow = 0)
+	{
+		if (count >= RENDER_QUEUE_MAX) {
+			warn("render queue: more than %d packets", RENDER_QUEUE_MAX);
+			return false;
+		}
+		/* both or neither, so they keep the same depth */
+		if (specialized[0] && program == generic[0] && prepass == generic[1]) {
+			program = specialized[0];
+			prepass = specialized[1];
+		}
+		DrawPacket *p = &packets[count++];
+		/* the order of the translucent fragments does not matter, they
+		* only need batching by state */
+		if (raster & RASTER_TRANSLUCENT)
+			key = (key & ~((1ULL << RENDER_KEY_DEPTH_BITS) - 1)) | RENDER_KEY_TRANSLUCENT;
+		p->key = key;
+		p->program = program;
+		p->texture = texture;
+		p->vao = vao;
+		p->prepass = prepass;
+		p->shadow = (raster & RASTER_TRANSLUCENT) ? 0 : shadow;
+		p->raster = raster;
+		prepare(program, vao, raster, prepass, shadow, p->state);
+		p->draw = draw;
+		p->object = object;
+		return true;
+	}
+
+	void bindProgram(GLuint program)
+	{
+		if (pipelines)
+			glState()->bindProgramPipeline(program);
+		else
+			glState()->useProgram(program);
+	}
+
+	/* Draw the sorted packets of pass (RENDER_PASS_*), binding only what
+	* differs from the packet before. The depth pre-pass draws the packets
+	* with a pre-pass with their pre-pass programs, the shadow pass those
+	* with a shadow program with it, and the main pass all of them, each
+	* with its pipeline state of the pass; packets whose state failed
+	* validation are not drawn. The bound state is not known in advance,
+	* so the first packet binds everything, and so does the first
+	* translucent one, after the hook which sets up their pass. */
+	void sweep(int pass)
+	{
+		int i, k, state = -1;
+		bool first = true, translucent = false;
+		GLuint texture = 0;
+
+		currentPass = pass;
+		for (i = 0; i < count; i++) {
+			const DrawPacket *p = &packets[order[i]];
+			int id = p->state[pass];
+			if (id < 0 || !states.states[id].valid)
+				continue;
+			if (pass == RENDER_PASS_MAIN && (p->raster & RASTER_TRANSLUCENT) && !translucent) {
+				/* they are sorted last */
+				if (!translucentBegin || !translucentBegin(translucentObject))
+					break;
+				translucent = true;
+				first = true;
+			}
+			if (first || id != state) {
+				states.bind(id);
+				state = id;
+				binds++;
+			} else {
+				skipped++;
+			}
+			if (p->texture && p->texture != texture) {
+				glState()->activeTexture(GL_TEXTURE0);
+				glState()->bindTexture(GL_TEXTURE_2D, p->texture);
+				texture = p->texture;
+				binds++;
+			} else if (p->texture) {
+				skipped++;
+			}
+			first = false;
+			p->draw(p->object, p);
+			if (pass == RENDER_PASS_MAIN && overdraw > 1 && !translucent) {
+				glState()->depthFunc(GL_LEQUAL);
+				for (k = 1; k < overdraw; k++)
+					p->draw(p->object, p);
+				/* the next packet binds its depth test again */
+				state = -1;
+			}
+		}
+		if (translucent)
+			translucentEnd(translucentObject);
+	}
+
+	/* Sort the recorded packets into order.
+	* Returns true if any of them has a depth pre-pass. */
+	bool sort()
+	{
+		int i;
+		bool prepass = false;
+
+		for (i = 0; i < count; i++) {
+			keys[i] = packets[i].key;
+			order[i] = (unsigned short)i;
+			if (packets[i].prepass)
+				prepass = true;
+		}
+		radixSort(keys, order, tmpKeys, tmpOrder, count);
+		return prepass;
+	}
+
+	/* Draw the packets with a shadow program into the bound depth target,
+	* keeping them for submit(). This may be called more than once per
+	* frame, e.g. for each shadow map drawn. */
+	void submitShadow()
+	{
+		if (!count)
+			return;
+		sort();
+		if (pipelines)
+			glState()->useProgram(0);
+		glDebugPush("shadow casters");
+		sweep(RENDER_PASS_SHADOW);
+		glDebugPop();
+		glState()->depthFunc(GL_LESS);
+		glState()->raster(RASTER_DEFAULT);
+	}
+
+	/* Sort the recorded packets and submit them, with the depth pre-pass
+	* first if any packet has one. */
+	void submit()
+	{
+		binds = skipped = 0;
+		if (!count)
+			return;
+		bool prepass = sort();
+
+		/* a program set by glUseProgram overrides any pipeline */
+		if (pipelines)
+			glState()->useProgram(0);
+		if (prepass) {
+			glDebugPush("depth pre-pass");
+			sweep(RENDER_PASS_DEPTH);
+			glDebugPop();
+		}
+		glDebugPush("main pass");
+		sweep(RENDER_PASS_MAIN);
+		glDebugPop();
+		/* everything else expects the default depth, raster and color
+		* write state */
+		glState()->depthFunc(GL_LESS);
+		glState()->raster(RASTER_DEFAULT);
+		glState()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+#ifndef NDEBUG
+		glState()->bindVertexArray(0);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		bindProgram(0);
+#endif
+		count = 0;
+	}
+} RenderQueue;
+
+#endif
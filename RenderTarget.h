@@ -0,0 +1,207 @@
+#ifndef HEADER_RENDERTARGET_H
+#define HEADER_RENDERTARGET_H
+
+#include <glad/glad.h>
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* OFFSCREEN RENDER TARGET                                                  *
+****************************************************************************/
+
+/* RenderTarget: a framebuffer object with a color texture and a depth
+* renderbuffer. Rendering into it does not involve the window system, so
+* neither vsync nor the compositor show up in the measurements. present()
+* copies the result to the default framebuffer if it should still be
+* visible; the color is a texture so it can also be upscaled by a shader,
+* see DynamicResolution.h, and post-processed, see PostProcess.h, which
+* renders into a half float one.
+* With more than one sample per pixel, fbo has a multisampled color texture
+* and depth buffer instead, and resolve() averages the samples into color
+* with glBlitFramebuffer. The post-processing can also read the samples
+* itself, and resolve and tonemap in the same pass. */
+typedef struct {
+	GLuint fbo;		/* rendered into */
+	GLuint color;		/* GL_TEXTURE_2D, bilinear, the resolved one if multisampled */
+	GLenum format;		/* of color, GL_RGBA8 unless set */
+	GLuint depth;		/* renderbuffer */
+	GLsizei width, height;
+	GLsizei samples;	/* per pixel, 1 unless set */
+	GLuint sampleColor;	/* GL_TEXTURE_2D_MULTISAMPLE of fbo, 0 unless multisampled */
+	GLuint resolveFbo;	/* with color, 0 unless multisampled */
+
+	void clear()
+	{
+		fbo = color = depth = sampleColor = resolveFbo = 0;
+		width = height = 0;
+		format = GL_RGBA8;
+		samples = 1;
+	}
+
+	/* Create the framebuffer object with attachments of w x h pixels.
+	* Returns true if successfull and false in case of an error. */
+	bool init(GLsizei w, GLsizei h)
+	{
+		clear();
+		glGenFramebuffers(1, &fbo);
+		glGenTextures(1, &color);
+		glGenRenderbuffers(1, &depth);
+		info("created render target FBO %u", fbo);
+		return resize(w, h);
+	}
+
+	static bool checkComplete(GLuint fb)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fb);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE) {
+			warn("render target FBO %u is incomplete: 0x%x", fb, (unsigned)status);
+			return false;
+		}
+		return true;
+	}
+
+	/* (Re-)allocate the attachments if the size changed.
+	* Returns true if the framebuffer is complete. */
+	bool resize(GLsizei w, GLsizei h)
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		if (w < 1)
+			w = 1;
+		if (h < 1)
+			h = 1;
+		if (w == width && h == height)
+			return true;
+
+		width = w;
+		height = h;
+		glState()->bindTexture(GL_TEXTURE_2D, color);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGBA,
+			(format == GL_RGBA8) ? GL_UNSIGNED_BYTE : GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glBindRenderbuffer(GL_RENDERBUFFER, depth);
+		if (samples > 1)
+			glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, width, height);
+		else
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		if (samples > 1) {
+			glState()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, sampleColor);
+			glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, format, width, height, GL_TRUE);
+			glState()->bindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, sampleColor, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, resolveFbo);
+		}
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+		if (!checkComplete(fbo) || (resolveFbo && !checkComplete(resolveFbo)))
+			return false;
+		info("render target FBO %u is %dx%d pixels, %d samples", fbo, (int)width, (int)height, (int)samples);
+		return true;
+	}
+
+	/* Change the internal format of the color buffer to f.
+	* Returns true if the framebuffer is complete. */
+	bool setFormat(GLenum f)
+	{
+		if (f == format)
+			return true;
+		format = f;
+		GLsizei w = width, h = height;
+		width = height = 0;
+		return resize(w, h);
+	}
+
+	/* Render with n samples per pixel, 1 for no multisampling. n is
+	* limited to what the implementation supports.
+	* Returns true if the framebuffer is complete. */
+	bool setSamples(GLsizei n)
+	{
+		GLint maxSamples = 1;
+		glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+		if (n > maxSamples)
+			n = maxSamples;
+		if (n < 1)
+			n = 1;
+		if (n == samples)
+			return true;
+		samples = n;
+		if (samples > 1 && !resolveFbo) {
+			glGenTextures(1, &sampleColor);
+			glGenFramebuffers(1, &resolveFbo);
+		} else if (samples == 1 && resolveFbo) {
+			/* color goes back to fbo */
+			glState()->deleteTextures(1, &sampleColor);
+			glDeleteFramebuffers(1, &resolveFbo);
+			sampleColor = resolveFbo = 0;
+		}
+		GLsizei w = width, h = height;
+		width = height = 0;
+		return resize(w, h);
+	}
+
+	/* Render into the target from now on. */
+	void bind()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	}
+
+	/* Average the samples into color, if multisampled. */
+	void resolve()
+	{
+		if (samples < 2)
+			return;
+		GL_DEBUG_GROUP("msaa resolve");
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFbo);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	}
+
+	/* Copy the color buffer, which must be resolved, to the default
+	* framebuffer of size w x h and make that the current framebuffer
+	* again. */
+	void present(GLsizei w, GLsizei h)
+	{
+		GL_DEBUG_GROUP("present");
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFbo ? resolveFbo : fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, w, h, GL_COLOR_BUFFER_BIT,
+			(w == width && h == height) ? GL_NEAREST : GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void destroy()
+	{
+		if (fbo) {
+			info("deleting render target FBO %u", fbo);
+			glDeleteFramebuffers(1, &fbo);
+			fbo = 0;
+		}
+		if (resolveFbo) {
+			glDeleteFramebuffers(1, &resolveFbo);
+			resolveFbo = 0;
+		}
+		if (color) {
+			glState()->deleteTextures(1, &color);
+			color = 0;
+		}
+		if (sampleColor) {
+			glState()->deleteTextures(1, &sampleColor);
+			sampleColor = 0;
+		}
+		if (depth) {
+			glDeleteRenderbuffers(1, &depth);
+			depth = 0;
+		}
+	}
+} RenderTarget;
+
+#endif
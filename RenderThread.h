@@ -0,0 +1,194 @@
+#ifndef HEADER_RENDERTHREAD_H
+#define HEADER_RENDERTHREAD_H
+
+#include <GLFW/glfw3.h>
+#include <glm/mat4x4.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <string.h>
+#include "CpuTopology.h"
+#include "GLState.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Simulation.h"
+
+/****************************************************************************
+* RENDER THREAD: frame packets from the main thread                        *
+****************************************************************************/
+
+/* RenderThread: with a render thread, the main thread only handles the
+* window events and advances the simulation. What a frame needs from that
+* (the simulation state, the model matrix, the framebuffer size and the key
+* presses and clicks since the last frame) goes into a FramePacket, and
+* the render thread, which owns the GL context, draws the packets in order. The
+* packets are a ring of count slots: with 2 the main thread fills the
+* packet of frame N+1 while frame N is submitted, with 3 it may run two
+* frames ahead, which hides an uneven frame better but shows the input one
+* frame later. A full ring blocks the main thread, an empty one the render
+* thread, so neither ever runs further ahead than that.
+* Everything which creates or touches GL objects (switching the programs
+* and modes on a key press, streaming, the camera, which depends on the
+* mode) stays on the render thread; the key presses are only taken from
+* the InputQueue by the main thread and replayed there. GLFW only allows a few calls on other
+* threads than the main one: swapping the buffers is one of them, setting
+* the window title is not, so the render thread leaves the title for the
+* main thread to set. With --pin-threads the render thread takes over the
+* core and the priority of the main thread, which moves to the rest of its
+* NUMA node, see CpuTopology.h. */
+#define FRAME_PACKETS_MAX 3
+#define FRAME_PACKET_EVENTS 32	/* key presses per frame, more are dropped */
+
+typedef struct {
+	int key, action;	/* as passed to the GLFW key callback */
+} FrameKeyEvent;
+
+typedef struct {
+	double time, timeDelta;	/* when the frame started, and since the one before */
+	SimState state;		/* the simulation, interpolated for this frame */
+	glm::mat4 model;	/* of the cube, from state */
+	int width, height;	/* the framebuffer size */
+	FrameKeyEvent events[FRAME_PACKET_EVENTS];
+	int eventCount;
+	bool pick;		/* pick the object at pickX, pickY, -1 to 1 on screen */
+	float pickX, pickY;
+} FramePacket;
+
+/* Draws the frame of packet p, on the render thread. */
+typedef void (*RenderFrameFunc)(void *user, const FramePacket *p);
+
+typedef struct {
+	FramePacket packets[FRAME_PACKETS_MAX];
+	int count;		/* slots in the ring */
+	bool running;		/* the render thread owns the context, set by the main thread */
+	GLFWwindow *win;
+	RenderFrameFunc render;
+	void *user;
+	std::thread thread;
+
+	/* protected by lock */
+	std::mutex lock;
+	std::condition_variable filled;		/* a packet was submitted, or quit */
+	std::condition_variable released;	/* the render thread is done with a packet */
+	unsigned int written;	/* packets submitted */
+	unsigned int read;	/* packets taken by the render thread */
+	unsigned int done;	/* packets the render thread is done with */
+	bool quit;
+	char title[160];	/* the window title the render thread asks for */
+	bool titleChanged;
+
+	void clear()
+	{
+		count = 2;
+		running = false;
+		win = NULL;
+		titleChanged = false;
+	}
+
+	/* Release the context of win on the calling thread and start drawing
+	* packets of n slots (2 or 3) with render(user, packet) on the render
+	* thread. */
+	void start(GLFWwindow *window, int n, RenderFrameFunc func, void *u)
+	{
+		win = window;
+		count = (n < 2) ? 2 : (n > FRAME_PACKETS_MAX ? FRAME_PACKETS_MAX : n);
+		render = func;
+		user = u;
+		written = read = done = 0;
+		quit = false;
+		titleChanged = false;
+		running = true;
+		glfwMakeContextCurrent(NULL);
+		thread = std::thread([this]() { run(); });
+		cpuTopology()->placeMainThread();
+		/* the frames' messages are the ones which must not wait for stdio */
+		logSetProducer(thread.get_id());
+		info("render thread: started, %d frame packets", count);
+	}
+
+	/* Let the render thread finish the packets in the ring, stop it and
+	* make the context current on the calling thread again. */
+	void stop()
+	{
+		if (!running)
+			return;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quit = true;
+		}
+		filled.notify_one();
+		thread.join();
+		logSetProducer(std::this_thread::get_id());
+		cpuTopology()->placeDrawingThread("main");
+		glfwMakeContextCurrent(win);
+		running = false;
+	}
+
+	/* Main thread: the next free packet, waits while the ring is full. */
+	FramePacket *acquire()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		released.wait(guard, [&]() { return written - done < (unsigned int)count; });
+		return &packets[written % count];
+	}
+
+	/* Main thread: hand the packet of acquire() to the render thread. */
+	void submit()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			written++;
+		}
+		filled.notify_one();
+	}
+
+	/* Render thread: ask the main thread to set the window title. */
+	void setTitle(const char *text)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		strncpy(title, text, sizeof(title) - 1);
+		title[sizeof(title) - 1] = 0;
+		titleChanged = true;
+	}
+
+	/* Main thread: set the title the render thread asked for, if any. */
+	void updateTitle()
+	{
+		char text[sizeof(title)];
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (!titleChanged)
+				return;
+			memcpy(text, title, sizeof(title));
+			titleChanged = false;
+		}
+		glfwSetWindowTitle(win, text);
+	}
+
+	/* The render thread. */
+	void run()
+	{
+		cpuTopology()->placeDrawingThread("render");
+		glfwMakeContextCurrent(win);
+		PROFILE_THREAD("render");
+		std::unique_lock<std::mutex> guard(lock);
+		for (;;) {
+			filled.wait(guard, [&]() { return quit || read != written; });
+			if (read == written)
+				break;
+			const FramePacket *p = &packets[read % count];
+			read++;
+			guard.unlock();
+			render(user, p);
+			guard.lock();
+			done++;
+			released.notify_one();
+		}
+		guard.unlock();
+		/* the cache of this thread goes with it */
+		glState()->flushDeletes();
+		glfwMakeContextCurrent(NULL);
+	}
+} RenderThread;
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef HEADER_REPLAY_H
+#define HEADER_REPLAY_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "InputQueue.h"
+#include "Log.h"
+#include "Lz.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* INPUT REPLAY                                                             *
+****************************************************************************/
+
+/* Replay: records what the main loop takes from outside, the input events
+* and the time step of each frame, and feeds it back in a later run, so two
+* builds can be compared on exactly the same frames. Everything else
+* follows from these: the simulation advances by the recorded steps (or by
+* a fixed step), the keys switch the programs and modes in the same frames,
+* and the clicks pick the same objects. The frame times which are measured
+* stay those of the wall clock.
+* The frames are kept in memory while recording and written at the end, the
+* file of a replay is read at the start, so there is no file I/O in the
+* frame loop. The file is a ReplayFileHeader followed by the frames,
+* compressed with lzCompress: per frame the number of events (GLushort),
+* the events as ReplayEvent and the time step (double), packed without
+* padding in the byte order of the machine. A replay ends the main loop
+* after the last frame. */
+#define REPLAY_FILE_MAGIC 0x50524348u	/* "HCRP" */
+#define REPLAY_FILE_VERSION 1
+
+enum {
+	REPLAY_OFF = 0,
+	REPLAY_RECORD,
+	REPLAY_PLAY
+};
+
+typedef struct {
+	GLuint magic;		/* REPLAY_FILE_MAGIC */
+	GLuint version;		/* REPLAY_FILE_VERSION */
+	GLuint frames, events;
+	GLuint size;		/* of the frames */
+	GLuint packedSize;	/* of the compressed frames following the header */
+	GLint width, height;	/* of the framebuffer at the start */
+	double simStep;		/* seconds per step of the simulation */
+} ReplayFileHeader;
+
+/* an InputEvent on disk, the frame tells when it came */
+typedef struct {
+	GLubyte type, action;
+	GLushort mods;
+	GLint key, scancode;
+	float x, y;
+} ReplayEvent;
+
+typedef struct {
+	int mode;		/* REPLAY_* */
+	const char *filename;
+	GLubyte *data;		/* the frames */
+	size_t size, capacity;
+	size_t offset;		/* of the next frame when playing */
+	size_t countOffset;	/* of the event count of the frame being recorded */
+	bool frameOpen;		/* its count is written already */
+	GLushort frameEvents;	/* events of the current frame recorded, or left to play */
+	GLuint frames, events;	/* recorded or played */
+	double fixedStep;	/* seconds per frame when playing, 0 for the recorded ones */
+	double startTime;	/* of the first frame played */
+	int width, height;	/* of the framebuffer when recording started */
+	double simStep;		/* of the simulation when recording started */
+
+	void clear()
+	{
+		mode = REPLAY_OFF;
+		filename = NULL;
+		data = NULL;
+		size = capacity = offset = countOffset = 0;
+		frameOpen = false;
+		frameEvents = 0;
+		frames = events = 0;
+		fixedStep = 0.0;
+		startTime = 0.0;
+		width = height = 0;
+		simStep = 0.0;
+	}
+
+	/* Start recording into the file filename, which is written by stop(),
+	* with a framebuffer of w x h and a simulation step of step seconds. */
+	void record(const char *file, int w, int h, double step)
+	{
+		filename = file;
+		width = w;
+		height = h;
+		simStep = step;
+		mode = REPLAY_RECORD;
+		size = offset = 0;
+		frameOpen = false;
+		frames = events = 0;
+		info("replay: recording into '%s'", filename);
+	}
+
+	/* Read the recording in the file filename and play it, each frame step
+	* seconds apart, or as recorded if step is 0. width, height and simStep
+	* are those of this run, a recording made with others is played, but
+	* warned about, as its frames differ.
+	* Returns true if successfull and false in case of an error. */
+	bool play(const char *file, double step, int w, int h, double sim)
+	{
+		ReplayFileHeader hdr;
+		GLubyte *packed = NULL;
+		FILE *f = fopen(file, "rb");
+		bool ok = f && fread(&hdr, sizeof(hdr), 1, f) == 1;
+
+		if (ok && (hdr.magic != REPLAY_FILE_MAGIC || hdr.version != REPLAY_FILE_VERSION)) {
+			warn("'%s' is no replay of version %u", file, REPLAY_FILE_VERSION);
+			ok = false;
+		}
+		if (ok) {
+			packed = (GLubyte*)malloc(hdr.packedSize ? hdr.packedSize : 1);
+			data = (GLubyte*)realloc(data, hdr.size ? hdr.size : 1);
+			ok = packed && data && fread(packed, 1, hdr.packedSize, f) == hdr.packedSize &&
+				lzDecompress(packed, hdr.packedSize, data, hdr.size);
+		}
+		if (f)
+			fclose(f);
+		free(packed);
+		if (!ok) {
+			warn("failed to read replay '%s'", file);
+			return false;
+		}
+		if (hdr.width != w || hdr.height != h)
+			warn("replay: recorded at %dx%d, playing at %dx%d", hdr.width, hdr.height, w, h);
+		if (hdr.simStep != sim)
+			warn("replay: recorded with a simulation step of %.4fs, playing with %.4fs", hdr.simStep, sim);
+		filename = file;
+		mode = REPLAY_PLAY;
+		size = capacity = hdr.size;
+		offset = 0;
+		frames = events = 0;
+		fixedStep = step;
+		startTime = 0.0;
+		info("replay: playing %u frames with %u events from '%s'%s", hdr.frames, hdr.events, file,
+			step > 0.0 ? ", fixed steps" : "");
+		return true;
+	}
+
+	/* The replay played its last frame. */
+	bool done() const
+	{
+		return mode == REPLAY_PLAY && offset >= size;
+	}
+
+	/* Make room for n more bytes of recording.
+	* Returns false if there is no memory. */
+	bool reserve(size_t n)
+	{
+		if (size + n <= capacity)
+			return true;
+		size_t c = capacity ? 2 * capacity : 65536;
+		while (c < size + n)
+			c *= 2;
+		GLubyte *more = (GLubyte*)realloc(data, c);
+		if (!more) {
+			warn("replay: out of memory, recording stopped");
+			mode = REPLAY_OFF;
+			return false;
+		}
+		data = more;
+		capacity = c;
+		return true;
+	}
+
+	void put(const void *v, size_t n)
+	{
+		memcpy(data + size, v, n);
+		size += n;
+	}
+
+	/* Leave room for the event count of the frame being recorded. */
+	bool openFrame()
+	{
+		if (frameOpen)
+			return true;
+		if (!reserve(sizeof(GLushort)))
+			return false;
+		countOffset = size;
+		size += sizeof(GLushort);
+		frameEvents = 0;
+		frameOpen = true;
+		return true;
+	}
+
+	/* Record event e of the current frame. */
+	void recordEvent(const InputEvent &e)
+	{
+		ReplayEvent r;
+		if (mode != REPLAY_RECORD || frameEvents == 0xffff || !openFrame() || !reserve(sizeof(r)))
+			return;
+		r.type = e.type;
+		r.action = e.action;
+		r.mods = e.mods;
+		r.key = e.key;
+		r.scancode = e.scancode;
+		r.x = e.x;
+		r.y = e.y;
+		put(&r, sizeof(r));
+		frameEvents++;
+		events++;
+	}
+
+	/* Play: start the next frame.
+	* Returns false if there is none. */
+	bool beginFrame()
+	{
+		if (mode != REPLAY_PLAY)
+			return false;
+		if (offset + sizeof(GLushort) + sizeof(double) > size) {
+			offset = size;
+			return false;
+		}
+		memcpy(&frameEvents, data + offset, sizeof(GLushort));
+		offset += sizeof(GLushort);
+		return true;
+	}
+
+	/* Play: the next event of the frame.
+	* Returns false if there is none. */
+	bool nextEvent(InputEvent *e)
+	{
+		ReplayEvent r;
+		if (mode != REPLAY_PLAY || !frameEvents || offset + sizeof(r) > size)
+			return false;
+		memcpy(&r, data + offset, sizeof(r));
+		offset += sizeof(r);
+		frameEvents--;
+		events++;
+		e->time = 0.0;
+		e->type = r.type;
+		e->action = r.action;
+		e->mods = r.mods;
+		e->key = r.key;
+		e->scancode = r.scancode;
+		e->x = r.x;
+		e->y = r.y;
+		return true;
+	}
+
+	/* End the frame which took dt seconds of real time.
+	* Returns the seconds the simulation advances in it: dt, unless playing. */
+	double endFrame(double dt)
+	{
+		if (mode == REPLAY_RECORD && openFrame() && reserve(sizeof(double))) {
+			memcpy(data + countOffset, &frameEvents, sizeof(GLushort));
+			put(&dt, sizeof(double));
+			frameOpen = false;
+			frames++;
+		} else if (mode == REPLAY_PLAY && offset + sizeof(double) <= size) {
+			/* skip what the frame did not take */
+			offset += (size_t)frameEvents * sizeof(ReplayEvent);
+			frameEvents = 0;
+			if (!frames++)
+				startTime = profileSeconds();
+			memcpy(&dt, data + offset, sizeof(double));
+			offset += sizeof(double);
+			if (fixedStep > 0.0)
+				dt = fixedStep;
+		}
+		return dt;
+	}
+
+	/* End recording and write the file, or end playing and log how long
+	* it took.
+	* Returns true if successfull and false in case of an error. */
+	bool stop()
+	{
+		bool ok = true;
+		if (mode == REPLAY_RECORD) {
+			ReplayFileHeader h;
+			size_t bound = lzBound(size);
+			GLubyte *packed = (GLubyte*)malloc(bound);
+			FILE *f = packed ? fopen(filename, "wb") : NULL;
+			memset(&h, 0, sizeof(h));
+			h.magic = REPLAY_FILE_MAGIC;
+			h.version = REPLAY_FILE_VERSION;
+			h.frames = frames;
+			h.events = events;
+			h.size = (GLuint)size;
+			h.packedSize = packed ? (GLuint)lzCompress(data, size, packed, bound) : 0;
+			h.width = width;
+			h.height = height;
+			h.simStep = simStep;
+			ok = f && fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(packed, 1, h.packedSize, f) == h.packedSize;
+			if (f && fclose(f))
+				ok = false;
+			free(packed);
+			if (ok)
+				info("replay: %u frames with %u events into '%s', %u bytes", frames, events, filename,
+					(unsigned)(sizeof(h) + h.packedSize));
+			else
+				warn("replay: failed to write '%s'", filename);
+		} else if (mode == REPLAY_PLAY && frames) {
+			double seconds = profileSeconds() - startTime;
+			info("replay: %u frames in %.3fs, %.3f ms per frame", frames, seconds, 1000.0 * seconds / (double)frames);
+		}
+		mode = REPLAY_OFF;
+		return ok;
+	}
+
+	void destroy()
+	{
+		free(data);
+		clear();
+	}
+} Replay;
+
+#endif
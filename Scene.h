@@ -0,0 +1,1174 @@
+#ifndef HEADER_SCENE_H
+#define HEADER_SCENE_H
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "Cube.h"
+#include "DynamicBuffer.h"
+#include "HiZ.h"
+#include "OcclusionQueries.h"
+#include "FrustumCuller.h"
+#include "CommandList.h"
+#include "MeshSimplifier.h"
+#include "SceneGraph.h"
+#include "GpuSceneGraph.h"
+#include "Entities.h"
+#include "Bvh.h"
+#include "SpatialGrid.h"
+
+/* a square pyramid, one flat color per face */
+static const Vertex scenePyramidGeometry[] = {
+	/*   X     Y     Z       R    G    B    A */
+	/* base */
+	{ { -1.0, -1.0,  1.0 },{ 255, 128,   0, 255 } },
+	{ { -1.0, -1.0, -1.0 },{ 192,  96,   0, 255 } },
+	{ { 1.0, -1.0,  1.0 },{ 192,  96,   0, 255 } },
+	{ { 1.0, -1.0, -1.0 },{ 128,  64,   0, 255 } },
+	/* front, right, back, left */
+	{ { -1.0, -1.0,  1.0 },{ 255, 255, 255, 255 } },
+	{ { 1.0, -1.0,  1.0 },{ 192, 192, 192, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 255, 128,   0, 255 } },
+	{ { 1.0, -1.0,  1.0 },{ 255,  64,  64, 255 } },
+	{ { 1.0, -1.0, -1.0 },{ 192,  48,  48, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 255, 128,   0, 255 } },
+	{ { 1.0, -1.0, -1.0 },{ 64, 255,  64, 255 } },
+	{ { -1.0, -1.0, -1.0 },{ 48, 192,  48, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 255, 128,   0, 255 } },
+	{ { -1.0, -1.0, -1.0 },{ 64,  64, 255, 255 } },
+	{ { -1.0, -1.0,  1.0 },{ 48,  48, 192, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 255, 128,   0, 255 } },
+};
+
+static const GLushort scenePyramidConnectivity[] = {
+	0, 1, 2,  2, 1, 3,	/* base */
+	4, 5, 6,		/* front */
+	7, 8, 9,		/* right */
+	10,11,12,		/* back */
+	13,14,15		/* left */
+};
+
+/* an octahedron, one flat color per face */
+static const Vertex sceneOctahedronGeometry[] = {
+	/*   X     Y     Z       R    G    B    A */
+	/* upper half */
+	{ { 0.0,  0.0,  1.0 },{ 255, 255, 255, 255 } },
+	{ { 1.0,  0.0,  0.0 },{ 255,   0, 128, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 255,   0, 128, 255 } },
+	{ { 1.0,  0.0,  0.0 },{ 128,   0, 255, 255 } },
+	{ { 0.0,  0.0, -1.0 },{ 255, 255, 255, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 128,   0, 255, 255 } },
+	{ { 0.0,  0.0, -1.0 },{ 255, 255, 255, 255 } },
+	{ { -1.0,  0.0,  0.0 },{ 0, 128, 255, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 0, 128, 255, 255 } },
+	{ { -1.0,  0.0,  0.0 },{ 0, 255, 128, 255 } },
+	{ { 0.0,  0.0,  1.0 },{ 255, 255, 255, 255 } },
+	{ { 0.0,  1.0,  0.0 },{ 0, 255, 128, 255 } },
+	/* lower half */
+	{ { 1.0,  0.0,  0.0 },{ 192,   0,  96, 255 } },
+	{ { 0.0,  0.0,  1.0 },{ 128, 128, 128, 255 } },
+	{ { 0.0, -1.0,  0.0 },{ 192,   0,  96, 255 } },
+	{ { 0.0,  0.0, -1.0 },{ 128, 128, 128, 255 } },
+	{ { 1.0,  0.0,  0.0 },{ 96,   0, 192, 255 } },
+	{ { 0.0, -1.0,  0.0 },{ 96,   0, 192, 255 } },
+	{ { -1.0,  0.0,  0.0 },{ 0,  96, 192, 255 } },
+	{ { 0.0,  0.0, -1.0 },{ 128, 128, 128, 255 } },
+	{ { 0.0, -1.0,  0.0 },{ 0,  96, 192, 255 } },
+	{ { 0.0,  0.0,  1.0 },{ 128, 128, 128, 255 } },
+	{ { -1.0,  0.0,  0.0 },{ 0, 192,  96, 255 } },
+	{ { 0.0, -1.0,  0.0 },{ 0, 192,  96, 255 } },
+};
+
+static const GLushort sceneOctahedronConnectivity[] = {
+	0, 1, 2,   3, 4, 5,   6, 7, 8,   9,10,11,
+	12,13,14, 15,16,17, 18,19,20, 21,22,23
+};
+
+/* a sphere, smooth enough that its levels of detail matter: STACKS rings
+ * of SLICES vertices from pole to pole, shared by the triangles around
+ * them, colored from red at the top to blue at the bottom */
+#define SCENE_SPHERE_STACKS 16
+#define SCENE_SPHERE_SLICES 32
+#define SCENE_SPHERE_VERTICES (2 + (SCENE_SPHERE_STACKS - 1) * SCENE_SPHERE_SLICES)
+#define SCENE_SPHERE_INDICES (6 * SCENE_SPHERE_SLICES * (SCENE_SPHERE_STACKS - 1))
+
+static void sceneSphereBuild(Vertex *v, GLushort *idx)
+{
+	int s, k, n = 0;
+	const GLushort south = (GLushort)(SCENE_SPHERE_VERTICES - 1);
+
+	for (s = 0; s <= SCENE_SPHERE_STACKS; s++) {
+		float theta = glm::pi<float>() * (float)s / (float)SCENE_SPHERE_STACKS;
+		GLubyte red = (GLubyte)(255 * (SCENE_SPHERE_STACKS - s) / SCENE_SPHERE_STACKS);
+		for (k = 0; k < SCENE_SPHERE_SLICES; k++) {
+			float phi = glm::two_pi<float>() * (float)k / (float)SCENE_SPHERE_SLICES;
+			Vertex *p = &v[(s == 0) ? 0 : (s == SCENE_SPHERE_STACKS) ? south : 1 + (s - 1) * SCENE_SPHERE_SLICES + k];
+			p->pos[0] = glm::sin(theta) * glm::cos(phi);
+			p->pos[1] = glm::cos(theta);
+			p->pos[2] = -glm::sin(theta) * glm::sin(phi);
+			p->clr[0] = red;
+			p->clr[1] = 64;
+			p->clr[2] = (GLubyte)(255 - red);
+			p->clr[3] = 255;
+			if (s == 0 || s == SCENE_SPHERE_STACKS)
+				break;	/* the poles are a single vertex */
+		}
+	}
+	/* counterclockwise seen from outside */
+	for (k = 0; k < SCENE_SPHERE_SLICES; k++) {
+		GLushort k1 = (GLushort)((k + 1) % SCENE_SPHERE_SLICES);
+		GLushort top = (GLushort)(1 + k), topNext = (GLushort)(1 + k1);
+		GLushort bottom = (GLushort)(south - SCENE_SPHERE_SLICES + k), bottomNext = (GLushort)(south - SCENE_SPHERE_SLICES + k1);
+		idx[n++] = 0; idx[n++] = top; idx[n++] = topNext;
+		idx[n++] = south; idx[n++] = bottomNext; idx[n++] = bottom;
+		for (s = 1; s < SCENE_SPHERE_STACKS - 1; s++) {
+			GLushort a = (GLushort)(1 + (s - 1) * SCENE_SPHERE_SLICES + k);
+			GLushort b = (GLushort)(1 + (s - 1) * SCENE_SPHERE_SLICES + k1);
+			GLushort c = (GLushort)(a + SCENE_SPHERE_SLICES), d = (GLushort)(b + SCENE_SPHERE_SLICES);
+			idx[n++] = a; idx[n++] = c; idx[n++] = b;
+			idx[n++] = b; idx[n++] = c; idx[n++] = d;
+		}
+	}
+}
+
+/* The command layout glMultiDrawElementsIndirect reads from the
+ * GL_DRAW_INDIRECT_BUFFER, defined by the GL spec. */
+typedef struct {
+	GLuint count;		/* number of indices */
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;	/* offsets the per-instance attributes */
+} DrawElementsIndirectCommand;
+
+/* a mesh: a range of the shared vertex and index buffers */
+typedef struct {
+	GLuint firstIndex;	/* of level 0, the full mesh */
+	GLuint indexCount;
+	GLint baseVertex;
+	GLsizei vertexCount;
+	GLfloat radius;		/* of the bounding sphere around the origin */
+	MeshLod lods[MESH_LOD_MAX];	/* ranges of the index buffer, the rest is 0 */
+	int lodCount;
+} SceneMesh;
+
+/* The components of an object, a mesh placed in the scene, see
+ * Scene::entities. */
+typedef struct {
+	int node;		/* in Scene::graph */
+	bool animated;		/* turns with the others, see Scene::animate */
+} SceneTransform;
+
+typedef struct {
+	GLint mesh;
+	GLuint material;	/* index into the MaterialTable */
+	GLuint draw;		/* index of its command and model matrix */
+} SceneDrawable;
+
+typedef struct {
+	glm::vec4 sphere;	/* center and radius */
+} SceneBounds;
+
+/* what the passes over the objects in Scene fill in */
+typedef struct {
+	const void *scene;
+	const int *remap;
+	GLuint *materials, *meshes;
+	EntityId *objects;
+	glm::vec4 *spheres;
+	glm::vec3 *mins, *maxs;
+	GLint *nodeDraws;	/* the draw of each node of the graph */
+} ScenePass;
+
+/* the ray of Scene::pick */
+typedef struct {
+	const glm::vec4 *bounds;
+	glm::vec3 orig, dir;
+} ScenePick;
+
+#define SCENE_MAX_MESHES 16
+#define SCENE_BASIC_MESHES 4	/* cube, pyramid, octahedron and sphere, see initMeshes */
+
+/* a range of draws which a program of its own draws, see SceneGenerator.h */
+#define SCENE_MAX_BATCHES 8
+
+typedef struct {
+	struct Scene *scene;
+	GLsizei first, count;	/* of the draws */
+	int shader;		/* class of the mix, 0 draws with the selected program */
+} SceneBatch;
+
+/* GPU culling, see Scene::cull and shaders/cull.cs.glsl */
+#define SCENE_CULL_SHADER "shaders/cull.cs.glsl"
+#define SCENE_CULL_GROUP_SIZE 64	/* local_size_x of the compute shader */
+
+/* Scene: many objects of several meshes, all packed into one vertex and
+ * one index buffer, so the whole scene is drawn from a single VAO. Each
+ * object is one DrawElementsIndirectCommand, and with
+ * GL_ARB_multi_draw_indirect (core in GL 4.3) all of them are submitted by
+ * a single glMultiDrawElementsIndirect call. The per-draw data (the model
+ * matrix) is the per-instance attribute instModel: the baseInstance of
+ * draw i is i, so draw i fetches the i-th matrix, just like gl_DrawID would
+ * index it, but without GL_ARB_shader_draw_parameters and with the
+ * instanced shader variants as they are. Without multi-draw, the commands
+ * are issued one by one with glDrawElementsInstancedBaseVertexBaseInstance
+ * (GL 4.2 or GL_ARB_base_instance), which starts the attributes at the
+ * base instance just the same, so nothing is bound or set between the
+ * draws and the objects in the command lists keep a group of one call
+ * each. Only older contexts point the attributes at the data of each
+ * object before its glDrawElementsInstancedBaseVertex.
+ * With compute shaders and GL_ARB_indirect_parameters, the objects can be
+ * culled on the GPU: a compute pass tests each object's bounding sphere
+ * against the frustum and compacts the commands of the visible objects,
+ * and the draw reads their number from the GPU too, so the CPU never
+ * touches the objects. Optionally, the objects hidden behind the depth of
+ * the previous frame are culled as well, see HiZ.h. That frame must have
+ * been rendered into a RenderTarget, and with the same program: a pyramid
+ * built with a program which does not discard has no holes where the
+ * "cut" shader would reveal what is behind, so it is invalidated whenever
+ * the program changes. Culling against a pyramid of the previous frame
+ * means an object which becomes visible shows up one frame late.
+ * The objects can also be sorted into the cells of a spatial hash on the
+ * GPU before each culling pass, which then skips the cells outside of the
+ * frustum as a whole, see setGridCulling() and SpatialGrid.h.
+ * The material of each object is the per-instance attribute instMaterial,
+ * fetched by the same baseInstance, see Materials.h, and so is its entity
+ * id, instObject, which the picking writes, see Picking.h; the draws
+ * recorded into command lists only find theirs by the base instance.
+ * Each mesh is simplified into levels of detail when it is added (see
+ * MeshSimplifier.h), stored after it in the index buffer. The culling pass
+ * also picks the level of each visible object, the coarsest one whose
+ * error projects to no more than a pixel or so at its distance (see
+ * meshLodSelect), so distant objects cost few triangles. Without GPU
+ * culling, all objects are drawn in full.
+ * The model matrices are the world matrices of a SceneGraph: every object
+ * is a node below a root at the origin, and only while their rotation
+ * changes are the matrices computed again, see animate(). With
+ * setGpuTransforms(), a compute pass does that instead and writes the
+ * matrices and the centers of the bounding spheres in place, the CPU only
+ * uploads the rotations which changed, see GpuSceneGraph.h.
+ * The objects are entities with a transform, a drawable and bounds
+ * component (see Entities.h), and the passes over them, here and in the
+ * jobs which write the model matrices, go through the chunks of those.
+ * Picking (see pick()) casts a ray through a BvhTree over the boxes around
+ * the bounding spheres, and tests the spheres at its leaves.
+ * A generated scene (see SceneGenerator.h) adds its objects by classes of
+ * programs, each of which is a batch of consecutive draws, drawn by
+ * drawRange() with a program of its own as long as they are not culled on
+ * the GPU, which compacts all of them into one list. */
+typedef struct Scene {
+	GLuint vbo[2];		/* vertex and index buffer names */
+	GLuint vao;
+	GLuint commandBuffer;	/* GL_DRAW_INDIRECT_BUFFER with one command per object */
+	GLuint materialBuffer;	/* material index per object */
+	GLuint objectBuffer;	/* entity id per object, for picking, see Picking.h */
+	bool multiDraw;		/* glMultiDrawElementsIndirect is available */
+	bool baseInstance;	/* the single draws start the instance attributes at their object */
+
+	SceneMesh meshes[SCENE_MAX_MESHES];
+	int meshCount;
+	/* the geometry until upload() */
+	Vertex *vertices;
+	GLushort *indices;
+	GLsizei vertexCount, indexCount;
+	GLsizei vertexCapacity, indexCapacity;
+
+	EntityStore entities;	/* the objects */
+	int transformComponent, drawableComponent, boundsComponent;
+	EcsMask objectMask;	/* all three */
+	DrawElementsIndirectCommand *commands;	/* CPU copy of commandBuffer, by draw */
+	GLsizei objectCount, maxObjects;
+
+	SceneGraph graph;	/* the transforms of the objects, node 0 is the root */
+	BvhTree bvh;		/* over the bounding spheres, by draw */
+	glm::vec4 *bounds;	/* the bounding sphere of each draw */
+	glm::quat spin;		/* the rotation of the animated objects in graph */
+	float extent;		/* the side of the box around the objects */
+	SceneBatch batches[SCENE_MAX_BATCHES];
+	int batchCount;		/* 0 if all objects are drawn with one program */
+
+	DynamicBuffer models;	/* per-object model matrices, only the changed ones uploaded */
+	bool modelsStale;	/* all of them are written next frame */
+	GpuSceneGraph gpuGraph;	/* gpuGraph.program is 0 until it is turned on */
+	bool gpuTransforms;	/* the world matrices are computed by gpuGraph */
+
+	/* GPU culling, see initCulling */
+	GLuint cullProgram;	/* 0 if culling is not supported */
+	GLint cullPlanesLoc, cullCountLoc, cullRadiusScaleLoc;
+	GLint cullOcclusionLoc, cullLevelsLoc, cullHiZSizeLoc, cullHiZViewProjectionLoc;
+	GLuint sphereBuffer;	/* bounding sphere per object */
+	GLuint visibleBuffer;	/* the commands of the visible objects */
+	GLuint counterBuffer;	/* atomic counter, the number of visible objects */
+	GLuint objectMeshBuffer;	/* mesh index per object */
+	GLuint lodBuffer;	/* MESH_LOD_MAX levels of detail per mesh */
+	GLint cullCameraLoc, cullLodScaleLoc;
+	float lodScale;		/* see meshLodSelect, 0 always draws level 0 */
+	bool culling;		/* cull before drawing */
+	bool culled;		/* cull() ran for this frame */
+	float radiusScale;	/* how far the vertex shader may move vertices out */
+
+	/* occlusion culling */
+	HiZBuffer hiz;		/* hiz.program is 0 if not supported */
+	OcclusionQueries queries;	/* or without compute shaders, see initQueries */
+	bool occlusion;		/* also cull occluded objects */
+
+	/* culling by the cells of a spatial hash, see setGridCulling */
+	GpuSpatialGrid grid;	/* grid.program is 0 until it is turned on */
+	GLint cullGridLoc;
+	float gridCellSize;
+	bool gridCulling;
+
+	/* Reset to an empty scene without any GL objects, destroy() then
+	 * has nothing to do. */
+	void clear()
+	{
+		vbo[0] = vbo[1] = vao = commandBuffer = materialBuffer = objectBuffer = 0;
+		models.clear();
+		gpuGraph.clear();
+		gpuTransforms = false;
+		cullProgram = sphereBuffer = visibleBuffer = counterBuffer = 0;
+		objectMeshBuffer = lodBuffer = 0;
+		culling = culled = false;
+		radiusScale = 1.0f;
+		lodScale = 0.0f;
+		hiz.program = hiz.fbo = hiz.depth = hiz.pyramid = 0;
+		queries.clear();
+		occlusion = false;
+		grid.clear();
+		gridCellSize = 1.0f;
+		gridCulling = false;
+		vertices = NULL;
+		indices = NULL;
+		entities.clear();
+		commands = NULL;
+		graph.clear();
+		bvh.clear();
+		bounds = NULL;
+		extent = 0.0f;
+		batchCount = 0;
+		meshCount = 0;
+		vertexCount = indexCount = objectCount = maxObjects = 0;
+	}
+
+	/* Reserve room for the geometry and objects added until upload().
+	 * Returns true if successfull and false in case of an error. */
+	bool init(GLsizei vertexCap, GLsizei indexCap, GLsizei objectCap)
+	{
+		clear();
+		vertexCapacity = vertexCap;
+		indexCapacity = indexCap;
+		maxObjects = objectCap;
+		{
+			MemoryScope scope(MEMORY_MESHES);
+			vertices = (Vertex*)largePageAlloc(sizeof(Vertex) * vertexCapacity);
+			indices = (GLushort*)largePageAlloc(sizeof(GLushort) * indexCapacity);
+		}
+		commands = (DrawElementsIndirectCommand*)malloc(sizeof(DrawElementsIndirectCommand) * maxObjects);
+		bounds = (glm::vec4*)malloc(sizeof(glm::vec4) * (maxObjects ? maxObjects : 1));
+		multiDraw = glCaps()->multiDrawIndirect;
+		baseInstance = glCaps()->baseInstance;
+		if (!vertices || !indices || !commands || !bounds || !graph.init(objectCap + 1) ||
+			!bvh.init(objectCap)) {
+			warn("Scene: failed to allocate %u objects", (unsigned)maxObjects);
+			destroy();
+			return false;
+		}
+		transformComponent = entities.component(sizeof(SceneTransform));
+		drawableComponent = entities.component(sizeof(SceneDrawable));
+		boundsComponent = entities.component(sizeof(SceneBounds));
+		objectMask = (1u << transformComponent) | (1u << drawableComponent) | (1u << boundsComponent);
+		graph.add(-1, glm::vec3(0.0f));
+		spin = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		return true;
+	}
+
+	/* Append a mesh of vertexCnt vertices and indexCnt indices, and its
+	 * levels of detail, as many as fit into the index capacity.
+	 * Returns the mesh index or -1 if there is no room. */
+	int addMesh(const Vertex *v, GLsizei vertexCnt, const GLushort *idx, GLsizei indexCnt)
+	{
+		GLsizei i;
+		int l;
+		SceneMesh *m;
+
+		if (meshCount >= SCENE_MAX_MESHES || vertexCount + vertexCnt > vertexCapacity ||
+			indexCount + indexCnt > indexCapacity) {
+			warn("Scene: no room for another mesh");
+			return -1;
+		}
+		m = &meshes[meshCount];
+		m->firstIndex = (GLuint)indexCount;
+		m->indexCount = (GLuint)indexCnt;
+		m->baseVertex = (GLint)vertexCount;
+		m->vertexCount = vertexCnt;
+		m->radius = 0.0f;
+		for (i = 0; i < vertexCnt; i++) {
+			GLfloat r = glm::length(glm::vec3(v[i].pos[0], v[i].pos[1], v[i].pos[2]));
+			if (r > m->radius)
+				m->radius = r;
+			vertices[vertexCount + i] = v[i];
+		}
+
+		/* the levels of detail go right after the full mesh */
+		GLuint room = (GLuint)(indexCapacity - indexCount);
+		GLuint *lodIndices = (GLuint*)malloc(sizeof(GLuint) * (room ? room : 1));
+		glm::vec3 *positions = (glm::vec3*)malloc(sizeof(glm::vec3) * (vertexCnt ? vertexCnt : 1));
+		memset(m->lods, 0, sizeof(m->lods));
+		m->lods[0].indexCount = (GLuint)indexCnt;
+		m->lodCount = 1;
+		if (lodIndices && positions) {
+			for (i = 0; i < vertexCnt; i++)
+				positions[i] = glm::vec3(v[i].pos[0], v[i].pos[1], v[i].pos[2]);
+			for (i = 0; i < indexCnt; i++)
+				lodIndices[i] = idx[i];
+			m->lodCount = meshLodChain(lodIndices, (GLuint)indexCnt, room, positions, (GLuint)vertexCnt, m->lods);
+			if (!m->lodCount) {
+				memset(m->lods, 0, sizeof(m->lods));
+				m->lods[0].indexCount = (GLuint)indexCnt;
+				m->lodCount = 1;
+			}
+		}
+		free(positions);
+		const MeshLod *last = &m->lods[m->lodCount - 1];
+		GLuint total = last->firstIndex + last->indexCount;
+		for (i = 0; i < (GLsizei)total; i++)
+			indices[indexCount + i] = (m->lodCount > 1) ? (GLushort)lodIndices[i] : idx[i];
+		free(lodIndices);
+		for (l = 0; l < m->lodCount; l++)
+			m->lods[l].firstIndex += m->firstIndex;
+		if (m->lodCount > 1)
+			info("Scene: mesh %d has %d levels of detail, down to %u triangles", meshCount, m->lodCount,
+				(unsigned)(last->indexCount / 3));
+
+		vertexCount += vertexCnt;
+		indexCount += (GLsizei)total;
+		return meshCount++;
+	}
+
+	/* Place mesh at position, turning with the others if animated.
+	 * Returns false if there is no room. */
+	bool addObject(int mesh, const glm::vec3 &position, GLuint material = 0, bool animated = true)
+	{
+		if (objectCount >= maxObjects || mesh < 0 || mesh >= meshCount)
+			return false;
+		const SceneMesh *m = &meshes[mesh];
+		EntityId e = entities.create(objectMask);
+		if (e == ECS_NO_ENTITY)
+			return false;
+		DrawElementsIndirectCommand *c = &commands[objectCount];
+		SceneTransform *t = entities.get<SceneTransform>(e, transformComponent);
+		t->node = graph.add(0, position, spin);
+		t->animated = animated;
+		SceneDrawable *d = entities.get<SceneDrawable>(e, drawableComponent);
+		d->mesh = mesh;
+		d->material = material;
+		d->draw = (GLuint)objectCount;
+		entities.get<SceneBounds>(e, boundsComponent)->sphere = glm::vec4(position, m->radius);
+		c->count = m->indexCount;
+		c->instanceCount = 1;
+		c->firstIndex = m->firstIndex;
+		c->baseVertex = m->baseVertex;
+		c->baseInstance = (GLuint)objectCount;
+		objectCount++;
+		return true;
+	}
+
+	/* Create the buffer objects from everything added so far, with the
+	 * vertices stored in layout. The bounding volume hierarchy is built
+	 * over the objects, unless treeNodes nodes of one built before are
+	 * given in tree, see SceneSnapshot.h.
+	 * Returns true if successfull and false in case of an error. */
+	bool upload(const VertexLayout *layout, const BvhNode *tree = NULL, int treeNodes = 0)
+	{
+		GLsizei i;
+
+		if (!models.init(GL_ARRAY_BUFFER, objectCount * sizeof(glm::mat4), sizeof(glm::mat4), "scene models"))
+			return false;
+		modelsStale = true;
+
+		/* the nodes in the order update() runs through them */
+		ScenePass pass;
+		pass.scene = this;
+		int *remap = (int*)malloc(sizeof(int) * graph.count);
+		if (!remap || !graph.sortLevels(remap)) {
+			free(remap);
+			destroy();
+			return false;
+		}
+		pass.remap = remap;
+		entities.forEach(1u << transformComponent, remapNodes, &pass);
+		free(remap);
+		graph.update();
+
+		/* the objects only rotate around their position, so the tree
+		 * is built once */
+		GLuint *objectMeshes = (GLuint*)malloc(sizeof(GLuint) * (objectCount ? objectCount : 1));
+		glm::vec3 *mins = tree ? NULL : (glm::vec3*)malloc(sizeof(glm::vec3) * (objectCount ? objectCount : 1));
+		glm::vec3 *maxs = tree ? NULL : (glm::vec3*)malloc(sizeof(glm::vec3) * (objectCount ? objectCount : 1));
+		pass.spheres = bounds;
+		pass.meshes = objectMeshes;
+		pass.mins = mins;
+		pass.maxs = maxs;
+		bool built = objectMeshes && (tree || (mins && maxs));
+		if (built) {
+			entities.forEach((1u << drawableComponent) | (1u << boundsComponent), collectBounds, &pass);
+			built = tree ? bvh.load(tree, treeNodes, (int)objectCount) : bvh.build(mins, maxs, (int)objectCount);
+		}
+		free(objectMeshes);
+		free(mins);
+		free(maxs);
+		if (!built) {
+			warn("Scene: failed to build the bounding volume hierarchy");
+			destroy();
+			return false;
+		}
+
+		/* each mesh derives its normals from its own triangles */
+		GLubyte *data = (GLubyte*)malloc((size_t)layout->stride * (vertexCount ? vertexCount : 1));
+		if (!data) {
+			warn("Scene: failed to allocate %u vertices", (unsigned)vertexCount);
+			destroy();
+			return false;
+		}
+		for (i = 0; i < meshCount; i++) {
+			const SceneMesh *m = &meshes[i];
+			vertexLayoutFill(layout, vertices + m->baseVertex, m->vertexCount, indices + m->firstIndex,
+				(GLsizei)m->indexCount, data + (size_t)layout->stride * m->baseVertex);
+		}
+		vbo[0] = meshBufferCreate(GL_ARRAY_BUFFER, (GLsizeiptr)layout->stride * vertexCount, data, "scene vertices");
+		free(data);
+		vbo[1] = meshBufferCreate(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indexCount, indices, "scene indices");
+		vao = meshVertexArrayCreate(layout, vbo[0], vbo[1], 0, "scene");
+
+		/* the model matrices */
+		if (!meshInstanceAttribs(vao, models.buffer)) {
+			warn("Scene: instanced arrays are not supported");
+			destroy();
+			return false;
+		}
+
+		/* the material indices never change */
+		GLuint *ids = (GLuint*)malloc(sizeof(GLuint) * objectCount);
+		if (!ids) {
+			warn("Scene: failed to allocate %u material indices", (unsigned)objectCount);
+			destroy();
+			return false;
+		}
+		pass.materials = ids;
+		entities.forEach(1u << drawableComponent, collectMaterials, &pass);
+		materialBuffer = meshBufferCreate(GL_ARRAY_BUFFER, sizeof(GLuint) * objectCount, ids, "scene materials");
+		/* and neither do the entity ids the picking writes */
+		pass.objects = ids;
+		entities.forEach(1u << drawableComponent, collectObjects, &pass);
+		objectBuffer = meshBufferCreate(GL_ARRAY_BUFFER, sizeof(GLuint) * objectCount, ids, "scene objects");
+		free(ids);
+		if (!meshMaterialAttrib(vao, materialBuffer) || !meshObjectAttrib(vao, objectBuffer)) {
+			destroy();
+			return false;
+		}
+
+		if (multiDraw)
+			commandBuffer = meshBufferCreate(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * objectCount, commands,
+				"scene draw commands");
+		info("Scene: %d meshes (%u %s vertices, %u indices), %u objects, %s", meshCount,
+			(unsigned)vertexCount, layout->name, (unsigned)indexCount, (unsigned)objectCount,
+			multiDraw ? "multi-draw indirect" : "one draw per object");
+		GL_ERROR_DBG("scene initialization");
+		return true;
+	}
+
+	/* Reserve room for objectCap objects and add the cube, pyramid,
+	 * octahedron and sphere meshes, their indices go to mesh.
+	 * Returns true if successfull and false in case of an error. */
+	bool initMeshes(GLsizei objectCap, int mesh[SCENE_BASIC_MESHES])
+	{
+		Vertex sphere[SCENE_SPHERE_VERTICES];
+		GLushort sphereIndices[SCENE_SPHERE_INDICES];
+
+		/* the levels of detail take less than the full meshes again */
+		if (!init(64 + SCENE_SPHERE_VERTICES, 2 * (128 + SCENE_SPHERE_INDICES), objectCap))
+			return false;
+		mesh[0] = addMesh(basicCubeGeometry, sizeof(basicCubeGeometry) / sizeof(Vertex),
+			basicCubeConnectivity, CUBE_INDEX_COUNT);
+		mesh[1] = addMesh(scenePyramidGeometry, sizeof(scenePyramidGeometry) / sizeof(Vertex),
+			scenePyramidConnectivity, sizeof(scenePyramidConnectivity) / sizeof(GLushort));
+		mesh[2] = addMesh(sceneOctahedronGeometry, sizeof(sceneOctahedronGeometry) / sizeof(Vertex),
+			sceneOctahedronConnectivity, sizeof(sceneOctahedronConnectivity) / sizeof(GLushort));
+		sceneSphereBuild(sphere, sphereIndices);
+		mesh[3] = addMesh(sphere, SCENE_SPHERE_VERTICES, sphereIndices, SCENE_SPHERE_INDICES);
+		return true;
+	}
+
+	/* Set up the default scene: grid^3 objects spacing apart, cycling
+	 * through the cube, pyramid, octahedron and sphere meshes and
+	 * materialCount materials, with the vertices stored in layout.
+	 * Returns true if successfull and false in case of an error. */
+	bool initGrid(int grid, float spacing, int materialCount, const VertexLayout *layout)
+	{
+		int x, y, z, mesh[SCENE_BASIC_MESHES];
+		float origin = -0.5f * spacing * (float)(grid - 1);
+
+		if (!initMeshes(grid * grid * grid, mesh))
+			return false;
+		extent = spacing * (float)grid;
+		for (z = 0; z < grid; z++)
+			for (y = 0; y < grid; y++)
+				for (x = 0; x < grid; x++)
+					addObject(mesh[(x + y + z) % 4], glm::vec3(origin) + spacing * glm::vec3((float)x, (float)y, (float)z),
+						(GLuint)((x + 2 * y + 3 * z) % (materialCount > 0 ? materialCount : 1)));
+		return upload(layout);
+	}
+
+	/* Set up GPU culling, the compute shader is loaded via cache. Must be
+	 * called after upload(). If culling is not supported, the scene is
+	 * simply always drawn completely.
+	 * Returns true if successfull and false in case of an error. */
+	bool initCulling(ShaderSourceCache *cache)
+	{
+		GLsizei i;
+		GLuint zero = 0;
+		glm::vec4 *spheres;
+		MemoryScope scope(MEMORY_SCENE);
+
+		if (!multiDraw || !computeShaderSupported() || !glCaps()->drawIndirectCount) {
+			info("Scene: GPU culling is not supported");
+			return false;
+		}
+		cullProgram = computeProgramBuild(cache, SCENE_CULL_SHADER);
+		if (!cullProgram)
+			return false;
+		cullPlanesLoc = glGetUniformLocation(cullProgram, "planes");
+		cullCountLoc = glGetUniformLocation(cullProgram, "objectCount");
+		cullRadiusScaleLoc = glGetUniformLocation(cullProgram, "radiusScale");
+		cullOcclusionLoc = glGetUniformLocation(cullProgram, "occlusion");
+		cullLevelsLoc = glGetUniformLocation(cullProgram, "hizLevels");
+		cullHiZSizeLoc = glGetUniformLocation(cullProgram, "hizSize");
+		cullHiZViewProjectionLoc = glGetUniformLocation(cullProgram, "hizViewProjection");
+		cullCameraLoc = glGetUniformLocation(cullProgram, "cameraPosition");
+		cullLodScaleLoc = glGetUniformLocation(cullProgram, "lodScale");
+		cullGridLoc = glGetUniformLocation(cullProgram, "grid");
+		glState()->useProgram(cullProgram);
+		glUniform1i(glGetUniformLocation(cullProgram, "hiz"), 0);
+		glState()->useProgram(0);
+		if (!hiz.init(cache))
+			info("Scene: occlusion culling is not supported");
+
+		spheres = (glm::vec4*)malloc(sizeof(glm::vec4) * objectCount);
+		GLuint *objectMeshes = (GLuint*)malloc(sizeof(GLuint) * objectCount);
+		if (!spheres || !objectMeshes) {
+			free(spheres);
+			free(objectMeshes);
+			destroyCulling();
+			return false;
+		}
+		/* the objects only rotate around their position, so the
+		 * bounding spheres never change */
+		ScenePass pass;
+		pass.scene = this;
+		pass.spheres = spheres;
+		pass.meshes = objectMeshes;
+		pass.mins = pass.maxs = NULL;
+		entities.forEach((1u << drawableComponent) | (1u << boundsComponent), collectBounds, &pass);
+		MeshLod lods[SCENE_MAX_MESHES * MESH_LOD_MAX];
+		for (i = 0; i < SCENE_MAX_MESHES; i++) {
+			if (i < meshCount)
+				memcpy(&lods[i * MESH_LOD_MAX], meshes[i].lods, sizeof(meshes[i].lods));
+			else
+				memset(&lods[i * MESH_LOD_MAX], 0, sizeof(MeshLod) * MESH_LOD_MAX);
+		}
+		objectMeshBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * objectCount, objectMeshes,
+			"scene object meshes");
+		lodBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(lods), lods, "scene lods");
+		free(objectMeshes);
+
+		GLuint buffers[3];
+		glGenBuffers(3, buffers);
+		sphereBuffer = buffers[0];
+		visibleBuffer = buffers[1];
+		counterBuffer = buffers[2];
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, sphereBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) * objectCount, spheres, GL_STATIC_DRAW);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawElementsIndirectCommand) * objectCount, NULL, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+		glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+		free(spheres);
+
+		culling = true;
+		info("Scene: GPU culling with program %u", cullProgram);
+		GL_ERROR_DBG("scene culling initialization");
+		return true;
+	}
+
+	/* Set up occlusion culling with occlusion queries, for contexts which
+	* do not support GPU culling, the program for the boxes is loaded via
+	* cache. Must be called after upload(). The objects are then drawn one
+	* by one, each under the condition of its query.
+	* Returns true if successfull and false if it is not supported. */
+	bool initQueries(ShaderSourceCache *cache)
+	{
+		if (!queries.init(cache, (int)objectCount)) {
+			info("Scene: occlusion queries are not supported");
+			return false;
+		}
+		return true;
+	}
+
+	void destroyCulling()
+	{
+		hiz.destroy();
+		queries.destroy();
+		occlusion = false;
+		grid.destroy();
+		gridCulling = false;
+		if (cullProgram) {
+			glState()->deleteProgram(cullProgram);
+			cullProgram = 0;
+		}
+		if (sphereBuffer || visibleBuffer || counterBuffer || objectMeshBuffer || lodBuffer) {
+			GLuint buffers[5] = { sphereBuffer, visibleBuffer, counterBuffer, objectMeshBuffer, lodBuffer };
+			glState()->deleteBuffers(5, buffers);
+			sphereBuffer = visibleBuffer = counterBuffer = objectMeshBuffer = lodBuffer = 0;
+		}
+		culling = culled = false;
+	}
+
+	/* Turn culling on or off, if it is supported. */
+	void setCulling(bool enable)
+	{
+		culling = enable && cullProgram;
+		info("Scene: GPU culling %s", culling ? "on" : "off");
+	}
+
+	/* Turn occlusion culling on or off, if it is supported, by the Hi-Z
+	* pyramid or else by the occlusion queries. */
+	void setOcclusion(bool enable)
+	{
+		occlusion = enable && (hiz.program || queries.program);
+		hiz.invalidate();
+		if (!hiz.program)
+			queries.setEnabled(occlusion);
+		info("Scene: occlusion culling %s%s", occlusion ? "on" : "off",
+			(occlusion && !hiz.program) ? ", by occlusion queries" : "");
+	}
+
+	/* Turn culling by the cells of a spatial hash of cellSize on or off,
+	 * if culling is supported. Each cull() then sorts the objects into the
+	 * cells of a GpuSpatialGrid first, rebuilt from scratch as if they all
+	 * moved, and tests the cells against the frustum before the objects.
+	 * Its program is loaded via cache the first time.
+	 * Returns true if successfull and false if it is not supported. */
+	bool setGridCulling(bool enable, ShaderSourceCache *cache, float cellSize)
+	{
+		if (enable && !grid.program && (!cullProgram || !grid.init(cache, objectCount))) {
+			info("Scene: grid culling is not supported");
+			gridCulling = false;
+			return false;
+		}
+		gridCulling = enable;
+		gridCellSize = cellSize;
+		info("Scene: grid culling %s", gridCulling ? "on" : "off");
+		return true;
+	}
+
+	/* Query the objects against the depth of the framebuffer bound, after
+	 * the scene was drawn into it with viewProjection; the next frame
+	 * draws them by the results. Does nothing unless occlusion culling
+	 * uses the queries. */
+	void queryOcclusion(const glm::mat4 &viewProjection)
+	{
+		queries.issue(viewProjection, bounds, radiusScale);
+	}
+
+	/* Build the Hi-Z pyramid the next cull() tests against from target,
+	 * after the scene was drawn into it with viewProjection. Does nothing
+	 * if occlusion culling is off. */
+	void updateOcclusion(const RenderTarget *target, const glm::mat4 &viewProjection)
+	{
+		if (occlusion && !hiz.build(target, viewProjection))
+			hiz.invalidate();
+	}
+
+	/* Cull the objects against the frustum of the view projection matrix
+	 * viewProjection on the GPU, the next draw() only draws the visible
+	 * ones, each in the level of detail for its distance from camera.
+	 * This uses its own program, so it must be called before the program
+	 * for drawing is bound. Does nothing if culling is off. With the
+	 * occlusion queries instead, the objects in the frustum are found on
+	 * the CPU, for drawQueried(). */
+	void cull(const glm::mat4 &viewProjection, const glm::vec3 &camera)
+	{
+		GLuint zero = 0;
+		glm::vec4 planes[6];
+
+		culled = false;
+		if (queries.enabled && objectCount) {
+			frustumPlanes(viewProjection, planes);
+			queries.select(planes, bounds, radiusScale, camera);
+		}
+		if (!culling || !objectCount)
+			return;
+		GL_DEBUG_GROUP("scene culling");
+		frustumPlanes(viewProjection, planes);
+		bool cells = gridCulling && grid.program;
+		if (cells)
+			grid.build(sphereBuffer, (int)objectCount, gridCellSize, viewProjection, radiusScale);
+
+		/* restart the count of visible objects */
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+		glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+		glState()->useProgram(cullProgram);
+		glUniform4fv(cullPlanesLoc, 6, &planes[0][0]);
+		glUniform1ui(cullCountLoc, (GLuint)objectCount);
+		glUniform1f(cullRadiusScaleLoc, radiusScale);
+		glUniform3fv(cullCameraLoc, 1, &camera[0]);
+		glUniform1f(cullLodScaleLoc, lodScale);
+		glUniform1i(cullGridLoc, cells);
+		if (cells)
+			grid.bind();
+		bool occlude = occlusion && hiz.valid;
+		glUniform1i(cullOcclusionLoc, occlude);
+		if (occlude) {
+			glUniform1i(cullLevelsLoc, hiz.levels);
+			glUniform2i(cullHiZSizeLoc, hiz.width, hiz.height);
+			glUniformMatrix4fv(cullHiZViewProjectionLoc, 1, GL_FALSE, &hiz.viewProjection[0][0]);
+			glState()->activeTexture(GL_TEXTURE0);
+			glState()->bindTexture(GL_TEXTURE_2D, hiz.pyramid);
+		}
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sphereBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectMeshBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, lodBuffer);
+		glState()->bindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer);
+		glDispatchCompute(((GLuint)objectCount + SCENE_CULL_GROUP_SIZE - 1) / SCENE_CULL_GROUP_SIZE, 1, 1);
+		if (occlude)
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+		glState()->useProgram(0);
+
+		/* the draw reads the commands and their count written above */
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+		culled = true;
+	}
+
+	/* Turn every object to rotation around its position, and update the
+	 * world matrices on jobs. The matrices are only computed again if the
+	 * rotation differs from the last one. */
+	void animate(const glm::quat &rotation, JobSystem *jobs)
+	{
+		if (rotation.x != spin.x || rotation.y != spin.y || rotation.z != spin.z || rotation.w != spin.w) {
+			spin = rotation;
+			entities.forEach(1u << transformComponent, spinNodes, this);
+		}
+		if (gpuTransforms)
+			gpuGraph.update(jobs, models.buffer, sphereBuffer);
+		else
+			graph.update(jobs);
+	}
+
+	/* Compute the world matrices with a compute pass instead of on the
+	* CPU, the program is loaded via cache. Must be called after upload().
+	* Returns true if successfull and false if it is not supported. */
+	bool setGpuTransforms(bool enable, ShaderSourceCache *cache)
+	{
+		GLsizei i;
+		if (enable && !gpuGraph.program) {
+			GLint *draws = (GLint*)malloc(sizeof(GLint) * graph.count);
+			if (!draws)
+				return false;
+			for (i = 0; i < (GLsizei)graph.count; i++)
+				draws[i] = -1;
+			ScenePass pass;
+			pass.scene = this;
+			pass.nodeDraws = draws;
+			entities.forEach((1u << transformComponent) | (1u << drawableComponent), collectNodeDraws, &pass);
+			bool ok = gpuGraph.init(cache, &graph, draws);
+			free(draws);
+			if (!ok) {
+				info("Scene: GPU transforms are not supported");
+				return false;
+			}
+		}
+		if (enable == gpuTransforms)
+			return true;
+		/* whichever side computes them now starts from scratch, the other
+		 * one did not keep its matrices up to date */
+		if (enable) {
+			gpuGraph.invalidate();
+		} else {
+			for (i = 0; i < (GLsizei)graph.count; i++)
+				graph.dirty[i] = 1;
+			modelsStale = true;
+		}
+		gpuTransforms = enable;
+		info("Scene: world matrices computed on the %s", enable ? "GPU" : "CPU");
+		return true;
+	}
+
+	static void collectNodeDraws(void *user, const EcsView *v)
+	{
+		const ScenePass *pass = (const ScenePass*)user;
+		const Scene *scene = (const Scene*)pass->scene;
+		const SceneTransform *t = v->array<SceneTransform>(scene->transformComponent);
+		const SceneDrawable *d = v->array<SceneDrawable>(scene->drawableComponent);
+		int i;
+		for (i = 0; i < v->count; i++)
+			pass->nodeDraws[t[i].node] = (GLint)d[i].draw;
+	}
+
+	static void remapNodes(void *user, const EcsView *v)
+	{
+		const ScenePass *pass = (const ScenePass*)user;
+		SceneTransform *t = v->array<SceneTransform>(((const Scene*)pass->scene)->transformComponent);
+		int i;
+		for (i = 0; i < v->count; i++)
+			t[i].node = pass->remap[t[i].node];
+	}
+
+	static void collectMaterials(void *user, const EcsView *v)
+	{
+		const ScenePass *pass = (const ScenePass*)user;
+		const SceneDrawable *d = v->array<SceneDrawable>(((const Scene*)pass->scene)->drawableComponent);
+		int i;
+		for (i = 0; i < v->count; i++)
+			pass->materials[d[i].draw] = d[i].material;
+	}
+
+	static void collectObjects(void *user, const EcsView *v)
+	{
+		const ScenePass *pass = (const ScenePass*)user;
+		const SceneDrawable *d = v->array<SceneDrawable>(((const Scene*)pass->scene)->drawableComponent);
+		int i;
+		for (i = 0; i < v->count; i++)
+			pass->objects[d[i].draw] = v->entities[i];
+	}
+
+	static void collectBounds(void *user, const EcsView *v)
+	{
+		const ScenePass *pass = (const ScenePass*)user;
+		const Scene *scene = (const Scene*)pass->scene;
+		const SceneDrawable *d = v->array<SceneDrawable>(scene->drawableComponent);
+		const SceneBounds *b = v->array<SceneBounds>(scene->boundsComponent);
+		int i;
+		for (i = 0; i < v->count; i++) {
+			pass->spheres[d[i].draw] = b[i].sphere;
+			pass->meshes[d[i].draw] = (GLuint)d[i].mesh;
+			if (pass->mins) {
+				pass->mins[d[i].draw] = glm::vec3(b[i].sphere) - b[i].sphere.w;
+				pass->maxs[d[i].draw] = glm::vec3(b[i].sphere) + b[i].sphere.w;
+			}
+		}
+	}
+
+	/* The draw index of the nearest object whose bounding sphere the ray
+	 * from orig along dir hits, and in *dist how far along dir.
+	 * Returns -1 if there is none. */
+	int pick(const glm::vec3 &orig, const glm::vec3 &dir, float *dist) const
+	{
+		ScenePick ray;
+		ray.bounds = bounds;
+		ray.orig = orig;
+		ray.dir = dir;
+		return bvh.raycast(orig, dir, FLT_MAX, pickSphere, &ray, dist);
+	}
+
+	static bool pickSphere(void *user, int object, float *dist)
+	{
+		const ScenePick *ray = (const ScenePick*)user;
+		glm::vec4 s = ray->bounds[object];
+		glm::vec3 oc = ray->orig - glm::vec3(s);
+		float a = glm::dot(ray->dir, ray->dir);
+		float b = glm::dot(oc, ray->dir);
+		float d = b * b - a * (glm::dot(oc, oc) - s.w * s.w);
+		if (d < 0.0f)
+			return false;
+		float t = (-b - glm::sqrt(d)) / a;
+		if (t < 0.0f)
+			t = 0.0f;	/* from inside */
+		if (t >= *dist || (-b + glm::sqrt(d)) / a < 0.0f)
+			return false;
+		*dist = t;
+		return true;
+	}
+
+	static void spinNodes(void *user, const EcsView *v)
+	{
+		Scene *scene = (Scene*)user;
+		const SceneTransform *t = v->array<SceneTransform>(scene->transformComponent);
+		int i;
+		for (i = 0; i < v->count; i++)
+			if (t[i].animated)
+				scene->graph.setRotation(t[i].node, scene->spin);
+	}
+
+	/* Write the world matrix of node as the model matrix of object draw,
+	 * if it changed in the last update of the graph. Any thread may call
+	 * this, for different objects. Call flushModels when done. With GPU
+	 * transforms, the compute pass wrote it already. */
+	void writeModel(GLsizei draw, int node)
+	{
+		if (gpuTransforms)
+			return;
+		if (modelsStale || graph.changed[node])
+			models.write(draw * sizeof(glm::mat4), &graph.world[node], sizeof(glm::mat4));
+	}
+
+	/* Upload the model matrices written this frame. */
+	void flushModels()
+	{
+		models.flush();
+		modelsStale = false;
+		meshInstancePointer(vao, models.buffer, 0);
+	}
+
+	/* Record the draw of object i into list, as a group ordered by key:
+	 * the same calls as draw() without multi-draw, see CommandList.h. Any
+	 * thread may call this. */
+	void recordObject(CommandList *list, GLsizei i, GLuint64 key) const
+	{
+		const DrawElementsIndirectCommand *c = &commands[i];
+		list->group(key);
+		if (baseInstance) {
+			list->drawElements(GL_TRIANGLES, c->count, GL_UNSIGNED_SHORT, c->firstIndex * sizeof(GLushort),
+				c->instanceCount, c->baseVertex, c->baseInstance);
+			return;
+		}
+		list->instancePointer(vao, models.buffer, c->baseInstance * sizeof(glm::mat4));
+		list->materialPointer(vao, materialBuffer, c->baseInstance * sizeof(GLuint));
+		list->drawElements(GL_TRIANGLES, c->count, GL_UNSIGNED_SHORT, c->firstIndex * sizeof(GLushort),
+			c->instanceCount, c->baseVertex);
+	}
+
+	/* Draw the objects recorded with recordObject() instead of all of
+	 * them. Like draw(), this may be called more than once per frame. */
+	void drawRecorded(CommandQueue *queue)
+	{
+		queue->replay();
+	}
+
+	/* Draw all objects. The VAO must be bound. This may be called more
+	 * than once per frame, e.g. for a depth pre-pass. */
+	void draw()
+	{
+		if (culled) {
+			/* both the commands and their number come from cull() */
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, visibleBuffer);
+			glState()->bindBuffer(GL_PARAMETER_BUFFER_ARB, counterBuffer);
+			glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, 0, objectCount, 0);
+			glState()->countDraw();
+			glState()->bindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		} else {
+			drawRange(0, objectCount);
+		}
+	}
+
+	/* Draw the count objects from draw first on, all of them whether
+	 * culled or not, e.g. a batch. The VAO must be bound. */
+	void drawRange(GLsizei first, GLsizei count)
+	{
+		GLsizei i;
+
+		if (multiDraw) {
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+				BUFFER_OFFSET(first * sizeof(DrawElementsIndirectCommand)), count, 0);
+			glState()->countDraw();
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		} else {
+			for (i = first; i < first + count; i++)
+				drawObject(i);
+		}
+	}
+
+	/* Draw object i on its own, with its base instance, or else with the
+	 * instance attributes pointed at its data. The VAO must be bound. */
+	void drawObject(GLsizei i)
+	{
+		const DrawElementsIndirectCommand *c = &commands[i];
+		if (baseInstance) {
+			glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, c->count, GL_UNSIGNED_SHORT,
+				BUFFER_OFFSET(c->firstIndex * sizeof(GLushort)), c->instanceCount, c->baseVertex, c->baseInstance);
+		} else {
+			meshInstancePointer(vao, models.buffer, c->baseInstance * sizeof(glm::mat4));
+			meshMaterialPointer(vao, materialBuffer, c->baseInstance * sizeof(GLuint));
+			meshObjectPointer(vao, objectBuffer, c->baseInstance * sizeof(GLuint));
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, c->count, GL_UNSIGNED_SHORT,
+				BUFFER_OFFSET(c->firstIndex * sizeof(GLushort)), c->instanceCount, c->baseVertex);
+		}
+		glState()->countDraw();
+	}
+
+	/* Draw the objects in the frustum one by one, each only if the box
+	 * of its last occlusion query was visible, see OcclusionQueries.h.
+	 * The VAO must be bound. */
+	void drawQueried()
+	{
+		GLsizei i;
+
+		for (i = 0; i < objectCount; i++) {
+			if (!queries.inFrustum((int)i))
+				continue;
+			bool conditional = queries.begin((int)i);
+			drawObject(i);
+			if (conditional)
+				queries.end();
+		}
+		/* the multi-draw picks the matrices by the base instance */
+		if (multiDraw && !baseInstance) {
+			meshInstancePointer(vao, models.buffer, 0);
+			meshMaterialPointer(vao, materialBuffer, 0);
+			meshObjectPointer(vao, objectBuffer, 0);
+		}
+	}
+
+	void destroy()
+	{
+		destroyCulling();
+		if (vao) {
+			info("Scene: deleting VAO %u", vao);
+			glState()->deleteVertexArrays(1, &vao);
+			vao = 0;
+		}
+		if (vbo[0] || vbo[1]) {
+			glState()->deleteBuffers(2, vbo);
+			vbo[0] = vbo[1] = 0;
+		}
+		if (commandBuffer) {
+			glState()->deleteBuffers(1, &commandBuffer);
+			commandBuffer = 0;
+		}
+		if (materialBuffer) {
+			glState()->deleteBuffers(1, &materialBuffer);
+			materialBuffer = 0;
+		}
+		if (objectBuffer) {
+			glState()->deleteBuffers(1, &objectBuffer);
+			objectBuffer = 0;
+		}
+		gpuGraph.destroy();
+		models.destroy();
+		largePageFree(vertices);
+		largePageFree(indices);
+		free(commands);
+		free(bounds);
+		bvh.destroy();
+		graph.destroy();
+		entities.destroy();
+		vertices = NULL;
+		indices = NULL;
+		commands = NULL;
+		bounds = NULL;
+		meshCount = 0;
+		objectCount = maxObjects = 0;
+	}
+} Scene;
+
+#endif
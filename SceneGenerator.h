@@ -0,0 +1,230 @@
+#ifndef HEADER_SCENEGENERATOR_H
+#define HEADER_SCENEGENERATOR_H
+
+#include <glm/glm.hpp>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Scene.h"
+
+/****************************************************************************
+* SCENE GENERATOR                                                          *
+****************************************************************************/
+
+/* A synthetic scene instead of the grid, for load tests of the culling,
+* the submission and the streaming at any size: the same parameters and
+* seed always give the same scene, whatever the machine. The parameters
+* come as a comma separated list of key=value, e.g.
+*     objects=200000,meshes=4:1:1:2,materials=16,shaders=6:1:1,overlap=8,animated=0.1,seed=3
+* - objects: how many,
+* - meshes: the weights of the cube, pyramid, octahedron and sphere,
+* - materials: how many of the MaterialTable the objects use, 0 all,
+* - shaders: the weights of the classes of programs, one per weight and up
+*   to SCENE_MAX_BATCHES; class 0 draws with the selected program and
+*   class k with the k-th program of the keyboard table after it, see
+*   Scene::batches,
+* - overlap: the depth complexity, how many objects a line of sight along
+*   the default view crosses on average,
+* - animated: the fraction of the objects which turn, the others never
+*   change their model matrices,
+* - seed: of the random numbers.
+* The objects are scattered over a box in front of the default camera
+* whose front is as large as overlap asks for, each object covering about
+* SCENE_GEN_FOOTPRINT of it, and which is deep enough that there is one
+* object per spacing^3 on average. Each class is added as a batch of
+* consecutive draws. */
+#define SCENE_GEN_FOOTPRINT 4.0f	/* the front of a mesh of radius 1, roughly */
+
+typedef struct {
+	int objects;		/* 0 for the grid */
+	float meshWeights[SCENE_BASIC_MESHES];
+	int materials;		/* 0 for all of the MaterialTable */
+	float shaderWeights[SCENE_MAX_BATCHES];
+	int shaders;		/* classes, the number of weights */
+	float overlap;
+	float animated;		/* 0 to 1 */
+	unsigned int seed;
+
+	void clear()
+	{
+		int i;
+		objects = 0;
+		for (i = 0; i < SCENE_BASIC_MESHES; i++)
+			meshWeights[i] = 1.0f;
+		materials = 0;
+		shaderWeights[0] = 1.0f;
+		shaders = 1;
+		overlap = 1.0f;
+		animated = 1.0f;
+		seed = 1;
+	}
+
+	/* Read up to max weights separated by colons from str into w.
+	* Returns the number read, 0 if there is a bad one. */
+	static int parseWeights(const char *str, size_t length, float *w, int max)
+	{
+		int n = 0;
+		const char *end = str + length;
+		while (str < end && n < max) {
+			char *next;
+			w[n] = (float)strtod(str, &next);
+			if (next == str || w[n] < 0.0f || (next < end && *next != ':'))
+				return 0;
+			n++;
+			str = next + 1;
+		}
+		return (str < end) ? 0 : n;
+	}
+
+	/* Set the parameters of spec, those not in it keep their value.
+	* Returns false if spec is malformed. */
+	bool parse(const char *spec)
+	{
+		float w[SCENE_MAX_BATCHES];
+		int i, n;
+
+		while (*spec) {
+			const char *end = strchr(spec, ',');
+			size_t length = end ? (size_t)(end - spec) : strlen(spec);
+			const char *value = (const char*)memchr(spec, '=', length);
+			if (!value) {
+				warn("scene generator: expected key=value in '%.*s'", (int)length, spec);
+				return false;
+			}
+			size_t key = (size_t)(value - spec);
+			value++;
+			size_t valueLength = length - key - 1;
+			if (key == 7 && !strncmp(spec, "objects", 7)) {
+				objects = atoi(value);
+			} else if (key == 6 && !strncmp(spec, "meshes", 6)) {
+				n = parseWeights(value, valueLength, w, SCENE_BASIC_MESHES);
+				if (!n) {
+					warn("scene generator: bad weights in '%.*s'", (int)length, spec);
+					return false;
+				}
+				for (i = 0; i < SCENE_BASIC_MESHES; i++)
+					meshWeights[i] = (i < n) ? w[i] : 0.0f;
+			} else if (key == 9 && !strncmp(spec, "materials", 9)) {
+				materials = atoi(value);
+			} else if (key == 7 && !strncmp(spec, "shaders", 7)) {
+				n = parseWeights(value, valueLength, w, SCENE_MAX_BATCHES);
+				if (!n) {
+					warn("scene generator: bad weights in '%.*s'", (int)length, spec);
+					return false;
+				}
+				memcpy(shaderWeights, w, sizeof(float) * n);
+				shaders = n;
+			} else if (key == 7 && !strncmp(spec, "overlap", 7)) {
+				overlap = (float)atof(value);
+			} else if (key == 8 && !strncmp(spec, "animated", 8)) {
+				animated = (float)atof(value);
+			} else if (key == 4 && !strncmp(spec, "seed", 4)) {
+				seed = (unsigned int)strtoul(value, NULL, 10);
+			} else {
+				warn("scene generator: unknown parameter '%.*s'", (int)key, spec);
+				return false;
+			}
+			spec += length + (end ? 1 : 0);
+		}
+		if (objects < 0 || materials < 0 || overlap <= 0.0f || animated < 0.0f || animated > 1.0f) {
+			warn("scene generator: parameter out of range");
+			return false;
+		}
+		return true;
+	}
+} SceneGenParams;
+
+/* uniform in [0, 1), the same on every platform */
+static float sceneGenRandom(unsigned int *seed)
+{
+	*seed = *seed * 1664525u + 1013904223u;
+	return (float)(*seed >> 8) / 16777216.0f;
+}
+
+/* The index of the weight of n in w which r in [0, 1) falls to, w summing
+* up to total. */
+static int sceneGenPick(const float *w, int n, float total, float r)
+{
+	int i;
+	r *= total;
+	for (i = 0; i < n - 1; i++) {
+		if (r < w[i])
+			return i;
+		r -= w[i];
+	}
+	return n - 1;
+}
+
+/* Build the scene of params into scene, with the objects spacing apart on
+* average, materialCount materials in the MaterialTable and the vertices
+* stored in layout, see above.
+* Returns true if successfull and false in case of an error. */
+static bool sceneGenerate(Scene *scene, const SceneGenParams *params, float spacing, int materialCount,
+	const VertexLayout *layout)
+{
+	int mesh[SCENE_BASIC_MESHES];
+	unsigned int seed = params->seed;
+	float meshTotal = 0.0f, shaderTotal = 0.0f;
+	int i, c, animated = 0;
+
+	for (i = 0; i < SCENE_BASIC_MESHES; i++)
+		meshTotal += params->meshWeights[i];
+	for (i = 0; i < params->shaders; i++)
+		shaderTotal += params->shaderWeights[i];
+	if (meshTotal <= 0.0f || shaderTotal <= 0.0f) {
+		warn("scene generator: the weights of the meshes and shaders must not all be 0");
+		return false;
+	}
+	int materials = (params->materials > 0 && params->materials < materialCount) ? params->materials : materialCount;
+	if (materials < 1)
+		materials = 1;
+	if (!scene->initMeshes(params->objects, mesh))
+		return false;
+
+	/* the front for the overlap, the depth for the density */
+	float side = sqrtf(SCENE_GEN_FOOTPRINT * (float)params->objects / params->overlap);
+	if (side < spacing)
+		side = spacing;
+	float depth = spacing * spacing * spacing * (float)params->objects / (side * side);
+	if (depth < spacing)
+		depth = spacing;
+	glm::vec3 size(side, side, depth);
+	scene->extent = glm::max(side, depth);
+
+	/* the classes one after the other, each as many as its weight asks
+	 * for, the last one the rest */
+	int first = 0;
+	for (c = 0; c < params->shaders; c++) {
+		int count = (c == params->shaders - 1) ? params->objects - first :
+			(int)((float)params->objects * params->shaderWeights[c] / shaderTotal + 0.5f);
+		if (count > params->objects - first)
+			count = params->objects - first;
+		for (i = 0; i < count; i++) {
+			glm::vec3 r(sceneGenRandom(&seed), sceneGenRandom(&seed), sceneGenRandom(&seed));
+			int m = sceneGenPick(params->meshWeights, SCENE_BASIC_MESHES, meshTotal, sceneGenRandom(&seed));
+			GLuint material = (GLuint)(sceneGenRandom(&seed) * (float)materials);
+			bool turns = sceneGenRandom(&seed) < params->animated;
+			if (!scene->addObject(mesh[m], (r - 0.5f) * size, material, turns))
+				return false;
+			if (turns)
+				animated++;
+		}
+		if (count > 0 && scene->batchCount < SCENE_MAX_BATCHES) {
+			SceneBatch *b = &scene->batches[scene->batchCount++];
+			b->scene = scene;
+			b->first = first;
+			b->count = count;
+			b->shader = c;
+		}
+		first += count;
+	}
+	/* a single class needs no batches */
+	if (scene->batchCount == 1)
+		scene->batchCount = 0;
+	info("scene generator: %d objects in %.0f x %.0f x %.0f, %d materials, %d classes of programs, %d animated, seed %u",
+		params->objects, side, side, depth, materials, params->shaders, animated, params->seed);
+	return scene->upload(layout);
+}
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef HEADER_SCENEGRAPH_H
+#define HEADER_SCENEGRAPH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/wide.hpp>
+#include <glm/gtx/wide_quaternion.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include "JobSystem.h"
+#include "LargePages.h"
+#include "Log.h"
+
+/****************************************************************************
+* SCENE GRAPH: a transform hierarchy in flat arrays                        *
+****************************************************************************/
+
+/* SceneGraph: the nodes are indices, and everything about them is stored
+* in arrays of its own: the parent, the local translation, rotation and
+* scale, the world matrix and the dirty flags. A parent always comes before
+* its children, so the world matrices are computed by one pass from the
+* first node to the last, reading nothing but the arrays in order and the
+* world matrix of the parent, which is done already.
+* Only the nodes whose local transform changed since the last update, and
+* all nodes below them, are computed again; the others keep their world
+* matrix, and the pass only reads their flags. Those which are computed are
+* done in batches of SCENE_GRAPH_BATCH with the array functions of
+* glm/gtx/wide.hpp: rotationMatrices() turns the rotations into matrices
+* and multiplyMatrices() applies the parents, several matrices at a time.
+* sortLevels() reorders the nodes by their depth in the tree. The nodes of
+* one level only depend on those of the levels before, so update() then
+* splits each level across the job system, and starts the next one as soon
+* as it is done, without waiting in between.
+* The arrays come from largePageAlloc(), so with --huge-pages a pass over a
+* million nodes does not miss the TLB every few KiB.
+* The tree may be at most SCENE_GRAPH_MAX_LEVELS deep. */
+#define SCENE_GRAPH_MAX_LEVELS 32
+#define SCENE_GRAPH_BATCH 64	/* nodes computed at a time */
+#define SCENE_GRAPH_GRAIN 1024	/* nodes per job */
+
+struct SceneGraph;
+
+/* A level of the nodes in the jobs of update(). */
+typedef struct {
+	struct SceneGraph *graph;
+	int first;
+} SceneGraphLevel;
+
+typedef struct SceneGraph {
+	int *parent;		/* index of the parent, less than the node's own, or -1 */
+	int *depth;		/* 0 for the roots */
+	glm::vec3 *translation;
+	glm::quat *rotation;
+	glm::vec3 *scale;
+	glm::mat4 *world;
+	unsigned char *dirty;	/* the local transform changed since update() */
+	unsigned char *changed;	/* the world matrix changed in the last update() */
+	int count, capacity;
+
+	/* after sortLevels(), the nodes of level l are [levels[l], levels[l + 1]) */
+	int levels[SCENE_GRAPH_MAX_LEVELS + 1];
+	int levelCount;		/* 0 if the nodes are not sorted */
+
+	/* the jobs of update(), which the workers may still touch as it returns */
+	JobCounter done[SCENE_GRAPH_MAX_LEVELS];
+	SceneGraphLevel work[SCENE_GRAPH_MAX_LEVELS];
+
+	void clear()
+	{
+		parent = depth = NULL;
+		translation = scale = NULL;
+		rotation = NULL;
+		world = NULL;
+		dirty = changed = NULL;
+		count = capacity = 0;
+		levelCount = 0;
+	}
+
+	/* Allocate the arrays for up to cap nodes.
+	* Returns true if successfull and false if out of memory. */
+	bool init(int cap)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		capacity = cap;
+		parent = (int*)largePageAlloc(sizeof(int) * cap);
+		depth = (int*)largePageAlloc(sizeof(int) * cap);
+		translation = (glm::vec3*)largePageAlloc(sizeof(glm::vec3) * cap);
+		rotation = (glm::quat*)largePageAlloc(sizeof(glm::quat) * cap);
+		scale = (glm::vec3*)largePageAlloc(sizeof(glm::vec3) * cap);
+		world = (glm::mat4*)largePageAlloc(sizeof(glm::mat4) * cap);
+		dirty = (unsigned char*)largePageAlloc(cap);
+		changed = (unsigned char*)largePageAlloc(cap);
+		if (!parent || !depth || !translation || !rotation || !scale || !world || !dirty || !changed) {
+			warn("SceneGraph: failed to allocate %d nodes", cap);
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void destroy()
+	{
+		largePageFree(parent);
+		largePageFree(depth);
+		largePageFree(translation);
+		largePageFree(rotation);
+		largePageFree(scale);
+		largePageFree(world);
+		largePageFree(dirty);
+		largePageFree(changed);
+		clear();
+	}
+
+	/* Append a node below parentNode, or a root if that is -1, with the
+	* local transform translate(t) * mat4_cast(r) * scale(s). The world
+	* matrix is valid after the next update().
+	* Returns the node index or -1 if there is no room. */
+	int add(int parentNode, const glm::vec3 &t, const glm::quat &r = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+		const glm::vec3 &s = glm::vec3(1.0f))
+	{
+		int d = (parentNode >= 0) ? depth[parentNode] + 1 : 0;
+		if (count >= capacity || parentNode >= count || d >= SCENE_GRAPH_MAX_LEVELS) {
+			warn("SceneGraph: no room for another node");
+			return -1;
+		}
+		parent[count] = parentNode;
+		depth[count] = d;
+		translation[count] = t;
+		rotation[count] = r;
+		scale[count] = s;
+		dirty[count] = 1;
+		changed[count] = 0;
+		levelCount = 0;
+		return count++;
+	}
+
+	void setTranslation(int node, const glm::vec3 &t)
+	{
+		translation[node] = t;
+		dirty[node] = 1;
+	}
+
+	void setRotation(int node, const glm::quat &r)
+	{
+		rotation[node] = r;
+		dirty[node] = 1;
+	}
+
+	void setScale(int node, const glm::vec3 &s)
+	{
+		scale[node] = s;
+		dirty[node] = 1;
+	}
+
+	/* Reorder the nodes by level, keeping their order within each. If remap
+	* is given, remap[i] is set to the new index of node i, for the callers
+	* which hold on to node indices.
+	* Returns true if successfull and false if out of memory. */
+	bool sortLevels(int *remap = NULL)
+	{
+		int i, l, next[SCENE_GRAPH_MAX_LEVELS];
+		int *order = (int*)malloc(sizeof(int) * (count ? count : 1));
+		void *scratch = malloc(sizeof(glm::mat4) * (count ? count : 1));
+		if (!order || !scratch) {
+			warn("SceneGraph: failed to allocate the order of %d nodes", count);
+			free(order);
+			free(scratch);
+			return false;
+		}
+
+		/* count the nodes per level, then place them after those before */
+		memset(levels, 0, sizeof(levels));
+		for (i = 0; i < count; i++)
+			levels[depth[i] + 1]++;
+		levelCount = 0;
+		for (l = 0; l < SCENE_GRAPH_MAX_LEVELS; l++) {
+			levels[l + 1] += levels[l];
+			next[l] = levels[l];
+			if (levels[l + 1] > levels[l])
+				levelCount = l + 1;
+		}
+		for (i = 0; i < count; i++)
+			order[i] = next[depth[i]]++;
+
+		/* the parents come first, so they already have their new index */
+		for (i = 0; i < count; i++)
+			parent[i] = (parent[i] >= 0) ? order[parent[i]] : -1;
+		permute(parent, order, scratch);
+		permute(depth, order, scratch);
+		permute(translation, order, scratch);
+		permute(rotation, order, scratch);
+		permute(scale, order, scratch);
+		permute(world, order, scratch);
+		permute(dirty, order, scratch);
+		permute(changed, order, scratch);
+		if (remap)
+			memcpy(remap, order, sizeof(int) * count);
+		free(order);
+		free(scratch);
+		return true;
+	}
+
+	/* Compute the world matrices of the dirty nodes and of everything
+	* below them, and set changed for exactly those. With jobs and sorted
+	* levels, this runs on the job system and returns when it is done. */
+	void update(JobSystem *jobs = NULL)
+	{
+		int l;
+
+		if (!jobs || !jobs->threadCount || !levelCount || count <= SCENE_GRAPH_GRAIN) {
+			updateRange(0, count);
+			return;
+		}
+		for (l = 0; l < levelCount; l++) {
+			done[l].reset();
+			work[l].graph = this;
+			work[l].first = levels[l];
+			jobs->parallelFor(updateLevel, &work[l], levels[l + 1] - levels[l], SCENE_GRAPH_GRAIN,
+				&done[l], (l > 0) ? &done[l - 1] : NULL);
+		}
+		jobs->wait(&done[levelCount - 1]);
+	}
+
+	/* The pass of update() over the nodes [begin, end). A node whose parent
+	* is computed in the same batch waits for the next one. */
+	void updateRange(int begin, int end)
+	{
+		int i, n = 0;
+		int nodes[SCENE_GRAPH_BATCH];
+		glm::quat r[SCENE_GRAPH_BATCH];
+		glm::mat4 parents[SCENE_GRAPH_BATCH], locals[SCENE_GRAPH_BATCH];
+
+		for (i = begin; i < end; i++) {
+			int p = parent[i];
+			changed[i] = dirty[i] || (p >= 0 && changed[p]);
+			dirty[i] = 0;
+			if (!changed[i])
+				continue;
+			if (n == SCENE_GRAPH_BATCH || (n > 0 && p >= nodes[0] && changed[p])) {
+				computeBatch(nodes, n, r, parents, locals);
+				n = 0;
+			}
+			nodes[n++] = i;
+		}
+		if (n > 0)
+			computeBatch(nodes, n, r, parents, locals);
+	}
+
+	static void updateLevel(void *user, int begin, int end)
+	{
+		SceneGraphLevel *level = (SceneGraphLevel*)user;
+		level->graph->updateRange(level->first + begin, level->first + end);
+	}
+
+	/* world = world of the parent * translate * rotate * scale for the n
+	* nodes, with the scratch arrays passed in by updateRange(). */
+	void computeBatch(const int *nodes, int n, glm::quat *r, glm::mat4 *parents, glm::mat4 *locals)
+	{
+		int k;
+		for (k = 0; k < n; k++)
+			r[k] = rotation[nodes[k]];
+		glm::rotationMatrices(r, locals, (size_t)n);
+		for (k = 0; k < n; k++) {
+			int i = nodes[k];
+			locals[k][0] *= scale[i].x;
+			locals[k][1] *= scale[i].y;
+			locals[k][2] *= scale[i].z;
+			locals[k][3] = glm::vec4(translation[i], 1.0f);
+			parents[k] = (parent[i] >= 0) ? world[parent[i]] : glm::mat4();
+		}
+		glm::multiplyMatrices(parents, locals, locals, (size_t)n);
+		for (k = 0; k < n; k++)
+			world[nodes[k]] = locals[k];
+	}
+
+	/* array[order[i]] = array[i], through scratch */
+	template <typename T> void permute(T *array, const int *order, void *scratch)
+	{
+		int i;
+		T *copy = (T*)scratch;
+		for (i = 0; i < count; i++)
+			copy[order[i]] = array[i];
+		for (i = 0; i < count; i++)
+			array[i] = copy[i];
+	}
+} SceneGraph;
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef HEADER_SCENESNAPSHOT_H
+#define HEADER_SCENESNAPSHOT_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "AssetArchive.h"
+#include "Scene.h"
+
+/****************************************************************************
+* SCENE SNAPSHOTS                                                          *
+****************************************************************************/
+
+/* A scene snapshot holds a Scene as it was set up, so a viewer which is
+* restarted resumes it without generating it again: the levels of detail
+* of the meshes are not simplified again and the bounding volume hierarchy
+* is not built again, which is what takes the time for a large scene.
+*   SceneSnapshotHeader, with the meshes, the batches, the camera and
+*   where the blobs are
+*   the vertices (Vertex) and indices of all meshes, as Scene keeps them
+*   the objects (SceneSnapshotObject), by draw
+*   the nodes of the BvhTree (BvhNode) over the objects
+* Nothing in the file is a pointer: the meshes are ranges of the vertices
+* and indices, the objects refer to the meshes and materials by index and
+* the nodes to each other, so it is valid wherever it is mapped. Opening
+* it maps the file and turns the offsets of the blobs into pointers into
+* the mapping, after checking that they are inside of it, like a mesh
+* file (see MeshFile.h); every blob starts at a multiple of
+* SCENE_SNAPSHOT_ALIGN. sceneFromSnapshot() then adds the meshes and the
+* objects to the scene straight from the mapping and uploads it, which
+* creates the buffer objects and loads the tree as it is.
+* The key of a snapshot is a hash of whatever the scene was generated
+* from, chosen by the writer, so a snapshot of other parameters is not
+* resumed. All values are little endian, the snapshots are meant for the
+* machine which wrote them. */
+#define SCENE_SNAPSHOT_MAGIC 0x4e534348u	/* "HCSN" */
+#define SCENE_SNAPSHOT_VERSION 1
+#define SCENE_SNAPSHOT_ALIGN 4096
+#define SCENE_SNAPSHOT_ANIMATED 1u	/* SceneSnapshotObject::flags */
+
+/* an object of the scene */
+typedef struct {
+	GLfloat position[3];
+	GLint mesh;
+	GLuint material;
+	GLuint flags;		/* SCENE_SNAPSHOT_* */
+} SceneSnapshotObject;
+
+/* a SceneBatch without its scene */
+typedef struct {
+	GLint first, count;
+	GLint shader;
+} SceneSnapshotBatch;
+
+/* where the camera looked from, relative to the origin of the scene */
+typedef struct {
+	GLuint placed;		/* eye and target are used, not the default position */
+	GLfloat eye[3], target[3];
+} SceneSnapshotCamera;
+
+typedef struct {
+	GLuint magic;		/* SCENE_SNAPSHOT_MAGIC */
+	GLuint version;		/* SCENE_SNAPSHOT_VERSION */
+	GLuint64 key;		/* of what the scene was generated from */
+	GLuint meshCount;
+	GLuint vertexCount;
+	GLuint indexCount;
+	GLuint objectCount;
+	GLuint nodeCount;	/* of the tree */
+	GLuint batchCount;
+	GLfloat extent;
+	SceneSnapshotCamera camera;
+	SceneMesh meshes[SCENE_MAX_MESHES];
+	SceneSnapshotBatch batches[SCENE_MAX_BATCHES];
+	GLuint64 vertexOffset;	/* of the blobs, from the start of the file */
+	GLuint64 indexOffset;
+	GLuint64 objectOffset;
+	GLuint64 nodeOffset;
+} SceneSnapshotHeader;
+
+/* Round offset up to a multiple of SCENE_SNAPSHOT_ALIGN. */
+static GLuint64 sceneSnapshotAlign(GLuint64 offset)
+{
+	return (offset + SCENE_SNAPSHOT_ALIGN - 1) / SCENE_SNAPSHOT_ALIGN * SCENE_SNAPSHOT_ALIGN;
+}
+
+typedef struct {
+	const SceneSnapshotHeader *header;
+	const Vertex *vertices;		/* all of these point into the mapping */
+	const GLushort *indices;
+	const SceneSnapshotObject *objects;
+	const BvhNode *nodes;
+	void *map;
+	GLuint64 size;
+#ifdef WIN32
+	HANDLE mapping;
+#endif
+
+	/* Check that the mapped file is a snapshot we can use and set up the
+	* pointers into it. Returns false if it is not. */
+	bool parse(const char *filename)
+	{
+		GLuint i;
+		const SceneSnapshotHeader *h = (const SceneSnapshotHeader*)map;
+
+		if (size < sizeof(SceneSnapshotHeader) || h->magic != SCENE_SNAPSHOT_MAGIC) {
+			warn("'%s' is not a scene snapshot", filename);
+			return false;
+		}
+		if (h->version != SCENE_SNAPSHOT_VERSION) {
+			warn("scene snapshot '%s' has version %u, expected %u", filename, h->version, SCENE_SNAPSHOT_VERSION);
+			return false;
+		}
+		/* the counts are 32 bit, so none of these products overflow */
+		if ((h->vertexOffset | h->indexOffset | h->objectOffset | h->nodeOffset) % SCENE_SNAPSHOT_ALIGN ||
+			h->vertexOffset + (GLuint64)sizeof(Vertex) * h->vertexCount > size ||
+			h->indexOffset + (GLuint64)sizeof(GLushort) * h->indexCount > size ||
+			h->objectOffset + (GLuint64)sizeof(SceneSnapshotObject) * h->objectCount > size ||
+			h->nodeOffset + (GLuint64)sizeof(BvhNode) * h->nodeCount > size) {
+			warn("scene snapshot '%s' is truncated", filename);
+			return false;
+		}
+		if (h->meshCount > SCENE_MAX_MESHES || h->batchCount > SCENE_MAX_BATCHES || h->objectCount > 0x7fffffffu) {
+			warn("scene snapshot '%s' has too many meshes or batches", filename);
+			return false;
+		}
+		for (i = 0; i < h->meshCount; i++) {
+			const SceneMesh *m = &h->meshes[i];
+			const MeshLod *last = &m->lods[m->lodCount > 0 ? m->lodCount - 1 : 0];
+			if (m->lodCount < 1 || m->lodCount > MESH_LOD_MAX || m->baseVertex < 0 || m->vertexCount < 0 ||
+				(GLuint64)m->baseVertex + (GLuint64)m->vertexCount > h->vertexCount ||
+				(GLuint64)last->firstIndex + last->indexCount > h->indexCount ||
+				(GLuint64)m->firstIndex + m->indexCount > h->indexCount) {
+				warn("scene snapshot '%s' has an invalid mesh %u", filename, i);
+				return false;
+			}
+		}
+		for (i = 0; i < h->batchCount; i++) {
+			const SceneSnapshotBatch *b = &h->batches[i];
+			if (b->first < 0 || b->count < 0 || (GLuint64)b->first + (GLuint64)b->count > h->objectCount) {
+				warn("scene snapshot '%s' has an invalid batch %u", filename, i);
+				return false;
+			}
+		}
+		/* the objects and the nodes are checked as they are added, the
+		* indices are trusted like those of a mesh file */
+		header = h;
+		vertices = (const Vertex*)((const GLubyte*)map + h->vertexOffset);
+		indices = (const GLushort*)((const GLubyte*)map + h->indexOffset);
+		objects = (const SceneSnapshotObject*)((const GLubyte*)map + h->objectOffset);
+		nodes = (const BvhNode*)((const GLubyte*)map + h->nodeOffset);
+		return true;
+	}
+
+	/* Map the snapshot filename. The pointers stay valid until close().
+	* Returns true if successfull and false in case of an error. */
+	bool open(const char *filename)
+	{
+		GLuint64 mtime;
+
+		header = NULL;
+		vertices = NULL;
+		indices = NULL;
+		objects = NULL;
+		nodes = NULL;
+		map = NULL;
+		if (!shaderSourceStat(filename, &mtime, &size)) {
+			info("no scene snapshot '%s'", filename);
+			return false;
+		}
+		if (size < sizeof(SceneSnapshotHeader) || size > (GLuint64)(size_t)-1) {
+			warn("'%s' is not a scene snapshot", filename);
+			return false;
+		}
+#ifdef WIN32
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			warn("failed to open scene snapshot '%s'", filename);
+			return false;
+		}
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (mapping)
+			map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+		if (!map) {
+			if (mapping)
+				CloseHandle(mapping);
+			warn("failed to map scene snapshot '%s'", filename);
+			return false;
+		}
+#else
+		int fd = ::open(filename, O_RDONLY);
+		if (fd < 0) {
+			warn("failed to open scene snapshot '%s'", filename);
+			return false;
+		}
+		void *m = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (m == MAP_FAILED) {
+			warn("failed to map scene snapshot '%s'", filename);
+			return false;
+		}
+		/* the blobs are read once, front to back */
+		madvise(m, (size_t)size, MADV_SEQUENTIAL);
+		map = m;
+#endif
+		if (!parse(filename)) {
+			close();
+			return false;
+		}
+		info("scene snapshot '%s': %u meshes, %u objects, %u KB", filename, header->meshCount,
+			header->objectCount, (unsigned)(size >> 10));
+		return true;
+	}
+
+	void close()
+	{
+		if (map) {
+#ifdef WIN32
+			UnmapViewOfFile(map);
+			CloseHandle(mapping);
+#else
+			munmap(map, (size_t)size);
+#endif
+		}
+		map = NULL;
+		header = NULL;
+		vertices = NULL;
+		indices = NULL;
+		objects = NULL;
+		nodes = NULL;
+	}
+} SceneSnapshot;
+
+/* Build scene from the snapshot s, with the materials clamped to the
+* materialCount of the MaterialTable and the vertices stored in layout.
+* Returns true if successfull and false in case of an error. */
+static bool sceneFromSnapshot(Scene *scene, const SceneSnapshot *s, int materialCount, const VertexLayout *layout)
+{
+	const SceneSnapshotHeader *h = s->header;
+	GLuint i;
+
+	if (!scene->init((GLsizei)(h->vertexCount ? h->vertexCount : 1), (GLsizei)(h->indexCount ? h->indexCount : 1),
+		(GLsizei)h->objectCount))
+		return false;
+	/* the meshes as they were added, their levels of detail included */
+	memcpy(scene->meshes, h->meshes, sizeof(SceneMesh) * h->meshCount);
+	memcpy(scene->vertices, s->vertices, sizeof(Vertex) * h->vertexCount);
+	memcpy(scene->indices, s->indices, sizeof(GLushort) * h->indexCount);
+	scene->meshCount = (int)h->meshCount;
+	scene->vertexCount = (GLsizei)h->vertexCount;
+	scene->indexCount = (GLsizei)h->indexCount;
+	scene->extent = h->extent;
+
+	GLuint lastMaterial = (GLuint)(materialCount > 1 ? materialCount - 1 : 0);
+	for (i = 0; i < h->objectCount; i++) {
+		const SceneSnapshotObject *o = &s->objects[i];
+		if (!scene->addObject(o->mesh, glm::vec3(o->position[0], o->position[1], o->position[2]),
+			o->material < lastMaterial ? o->material : lastMaterial, (o->flags & SCENE_SNAPSHOT_ANIMATED) != 0)) {
+			warn("scene snapshot: invalid object %u", i);
+			scene->destroy();
+			return false;
+		}
+	}
+	for (i = 0; i < h->batchCount; i++) {
+		SceneBatch *b = &scene->batches[i];
+		b->scene = scene;
+		b->first = h->batches[i].first;
+		b->count = h->batches[i].count;
+		b->shader = h->batches[i].shader;
+	}
+	scene->batchCount = (int)h->batchCount;
+	return scene->upload(layout, s->nodes, (int)h->nodeCount);
+}
+
+/* the objects of Scene by draw, for sceneSnapshotWrite */
+typedef struct {
+	const Scene *scene;
+	SceneSnapshotObject *objects;
+} SceneSnapshotPass;
+
+static void sceneSnapshotCollect(void *user, const EcsView *v)
+{
+	const SceneSnapshotPass *pass = (const SceneSnapshotPass*)user;
+	const Scene *scene = pass->scene;
+	const SceneTransform *t = v->array<SceneTransform>(scene->transformComponent);
+	const SceneDrawable *d = v->array<SceneDrawable>(scene->drawableComponent);
+	int i;
+	for (i = 0; i < v->count; i++) {
+		SceneSnapshotObject *o = &pass->objects[d[i].draw];
+		/* they only turn around their position, the center of their
+		* bounding sphere */
+		const glm::vec4 &sphere = scene->bounds[d[i].draw];
+		o->position[0] = sphere.x;
+		o->position[1] = sphere.y;
+		o->position[2] = sphere.z;
+		o->mesh = d[i].mesh;
+		o->material = d[i].material;
+		o->flags = t[i].animated ? SCENE_SNAPSHOT_ANIMATED : 0u;
+	}
+}
+
+/* Write zero bytes to file until it is at offset. */
+static bool sceneSnapshotPad(FILE *file, GLuint64 offset)
+{
+	static const GLubyte zero[SCENE_SNAPSHOT_ALIGN] = { 0 };
+	long pos = ftell(file);
+	if (pos < 0 || (GLuint64)pos > offset)
+		return false;
+	return fwrite(zero, 1, (size_t)(offset - (GLuint64)pos), file) == (size_t)(offset - (GLuint64)pos);
+}
+
+/* Write the uploaded scene and camera to the snapshot filename, under
+* key.
+* Returns true if successfull and false in case of an error. */
+static bool sceneSnapshotWrite(const char *filename, Scene *scene, GLuint64 key,
+	const SceneSnapshotCamera *camera)
+{
+	SceneSnapshotHeader h;
+	SceneSnapshotPass pass;
+	GLuint i;
+	FILE *file;
+	bool ok;
+
+	if (!scene->vao) {
+		warn("scene snapshot '%s': the scene is not set up", filename);
+		return false;
+	}
+	pass.scene = scene;
+	pass.objects = (SceneSnapshotObject*)malloc(sizeof(SceneSnapshotObject) * (scene->objectCount ? scene->objectCount : 1));
+	if (!pass.objects) {
+		warn("scene snapshot '%s': failed to allocate %u objects", filename, (unsigned)scene->objectCount);
+		return false;
+	}
+	scene->entities.forEach((1u << scene->transformComponent) | (1u << scene->drawableComponent),
+		sceneSnapshotCollect, &pass);
+
+	memset(&h, 0, sizeof(h));
+	h.magic = SCENE_SNAPSHOT_MAGIC;
+	h.version = SCENE_SNAPSHOT_VERSION;
+	h.key = key;
+	h.meshCount = (GLuint)scene->meshCount;
+	h.vertexCount = (GLuint)scene->vertexCount;
+	h.indexCount = (GLuint)scene->indexCount;
+	h.objectCount = (GLuint)scene->objectCount;
+	h.nodeCount = (GLuint)scene->bvh.nodeCount;
+	h.batchCount = (GLuint)scene->batchCount;
+	h.extent = scene->extent;
+	h.camera = *camera;
+	memcpy(h.meshes, scene->meshes, sizeof(SceneMesh) * scene->meshCount);
+	for (i = 0; i < h.batchCount; i++) {
+		h.batches[i].first = scene->batches[i].first;
+		h.batches[i].count = scene->batches[i].count;
+		h.batches[i].shader = scene->batches[i].shader;
+	}
+	h.vertexOffset = sceneSnapshotAlign(sizeof(h));
+	h.indexOffset = sceneSnapshotAlign(h.vertexOffset + (GLuint64)sizeof(Vertex) * h.vertexCount);
+	h.objectOffset = sceneSnapshotAlign(h.indexOffset + (GLuint64)sizeof(GLushort) * h.indexCount);
+	h.nodeOffset = sceneSnapshotAlign(h.objectOffset + (GLuint64)sizeof(SceneSnapshotObject) * h.objectCount);
+
+	file = fopen(filename, "wb");
+	if (!file) {
+		free(pass.objects);
+		warn("failed to write scene snapshot '%s'", filename);
+		return false;
+	}
+	ok = fwrite(&h, sizeof(h), 1, file) == 1 &&
+		sceneSnapshotPad(file, h.vertexOffset) &&
+		fwrite(scene->vertices, sizeof(Vertex), h.vertexCount, file) == h.vertexCount &&
+		sceneSnapshotPad(file, h.indexOffset) &&
+		fwrite(scene->indices, sizeof(GLushort), h.indexCount, file) == h.indexCount &&
+		sceneSnapshotPad(file, h.objectOffset) &&
+		fwrite(pass.objects, sizeof(SceneSnapshotObject), h.objectCount, file) == h.objectCount &&
+		sceneSnapshotPad(file, h.nodeOffset) &&
+		fwrite(scene->bvh.nodes, sizeof(BvhNode), h.nodeCount, file) == h.nodeCount;
+	free(pass.objects);
+	if (fclose(file) || !ok) {
+		warn("failed to write scene snapshot '%s'", filename);
+		return false;
+	}
+	info("wrote scene snapshot '%s' with %u meshes and %u objects", filename, h.meshCount, h.objectCount);
+	return true;
+}
+
+#endif
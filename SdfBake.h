@@ -0,0 +1,261 @@
+#ifndef HEADER_SDFBAKE_H
+#define HEADER_SDFBAKE_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <math.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "SdfScene.h"
+
+/****************************************************************************
+* SDF BAKING                                                               *
+****************************************************************************/
+
+/* SdfBaker: the distances of an SdfScene baked into a 3D texture, so each
+* step of the raymarching program is one texture fetch instead of an
+* evaluation of every node (see shaders/raymarch.fs.glsl). The texture
+* covers a cube of SDF_BAKE_EXTENT around the origin with SDF_BAKE_SIZE^3
+* R16F texels; outside of it, the nodes are evaluated as before.
+* The volume is split into bricks of SDF_BAKE_BRICK^3 texels, each baked by
+* one dispatch of shaders/sdf_bake.cs.glsl. The distances are truncated to
+* SDF_BAKE_TRUNCATION, which only limits the step length in empty space:
+* with it, a node can only change the texels near its own primitive, so
+* when the scene changes, only the bricks around the nodes which changed
+* (in their old and their new place) are rebaked, at most
+* SDF_BAKE_BRICKS_PER_FRAME per frame. Those bricks show the old scene
+* until then. Intersections change the whole field, that rebakes it all.
+* Needs compute shaders (GL 4.3); otherwise the scene stays unbaked. */
+#define SDF_BAKE_SHADER "shaders/sdf_bake.cs.glsl"
+#define SDF_BAKE_SIZE 128		/* texels per side */
+#define SDF_BAKE_BRICK 16		/* texels per side of a brick, a multiple of SDF_BAKE_GROUP */
+#define SDF_BAKE_GROUP 8		/* local size of the compute shader */
+#define SDF_BAKE_BRICKS (SDF_BAKE_SIZE / SDF_BAKE_BRICK)
+#define SDF_BAKE_EXTENT 4.0f		/* the volume is [-extent, extent]^3 */
+#define SDF_BAKE_TRUNCATION (2.0f * SDF_BAKE_EXTENT / SDF_BAKE_BRICKS)	/* one brick */
+#define SDF_BAKE_BRICKS_PER_FRAME 16
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint brickOriginLoc;
+	GLuint texture;		/* GL_TEXTURE_3D, GL_R16F */
+	bool dirty[SDF_BAKE_BRICKS * SDF_BAKE_BRICKS * SDF_BAKE_BRICKS];
+	int pending;		/* dirty bricks */
+	int cursor;		/* where the search for dirty bricks goes on */
+	GpuSdfNode baked[SDF_NODE_MAX];	/* the nodes the texture holds or is being baked with */
+	GLuint bakedCount;
+	GLuint bakedVersion;	/* SdfScene::version of baked */
+	bool complete;		/* every brick was baked once */
+
+	void clear()
+	{
+		program = 0;
+		texture = 0;
+		pending = cursor = 0;
+		bakedCount = 0;
+		bakedVersion = 0;
+		complete = false;
+	}
+
+	/* Build the bake program and the texture for scene and bake all of
+	* it. Sources are loaded via cache.
+	* Returns true if successfull and false if baking is not supported. */
+	bool init(ShaderSourceCache *cache, SdfScene *scene)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		if (!computeShaderSupported() || !glTexStorage3D || !glBindImageTexture)
+			return false;
+		program = computeProgramBuild(cache, SDF_BAKE_SHADER);
+		if (!program)
+			return false;
+		brickOriginLoc = glGetUniformLocation(program, "brickOrigin");
+		glState()->useProgram(program);
+		glUniform1f(glGetUniformLocation(program, "truncation"), SDF_BAKE_TRUNCATION);
+		glState()->useProgram(0);
+
+		glGenTextures(1, &texture);
+		glState()->bindTexture(GL_TEXTURE_3D, texture);
+		glTexStorage3D(GL_TEXTURE_3D, 1, GL_R16F, SDF_BAKE_SIZE, SDF_BAKE_SIZE, SDF_BAKE_SIZE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glState()->bindTexture(GL_TEXTURE_3D, 0);
+
+		float texel = 2.0f * SDF_BAKE_EXTENT / SDF_BAKE_SIZE;
+		scene->data.bakeMin = glm::vec4(glm::vec3(-SDF_BAKE_EXTENT), 0.5f / SDF_BAKE_SIZE);
+		scene->data.bakeSize = glm::vec4(glm::vec3(2.0f * SDF_BAKE_EXTENT), texel);
+		scene->dirty = true;
+		info("SDF bake: %d^3 texels in bricks of %d^3, program %u", SDF_BAKE_SIZE, SDF_BAKE_BRICK, program);
+
+		/* the first bake happens before the first frame */
+		update(scene, SDF_BAKE_BRICKS * SDF_BAKE_BRICKS * SDF_BAKE_BRICKS);
+		GL_ERROR_DBG("SDF bake initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (texture)
+			glState()->deleteTextures(1, &texture);
+		clear();
+	}
+
+	void markBrick(int x, int y, int z)
+	{
+		bool *d = &dirty[(z * SDF_BAKE_BRICKS + y) * SDF_BAKE_BRICKS + x];
+		if (!*d) {
+			*d = true;
+			pending++;
+		}
+	}
+
+	/* Mark the bricks whose distances node n may change: those within the
+	* truncation distance (and the blend of a smooth union) of its
+	* primitive, for planes those they pass by, for intersections all. */
+	void markNode(const GpuSdfNode *n)
+	{
+		const float brickSize = 2.0f * SDF_BAKE_EXTENT / SDF_BAKE_BRICKS;
+		float margin = SDF_BAKE_TRUNCATION + (n->op == SDF_SMOOTH_UNION ? n->blend : 0.0f);
+		glm::vec3 c(n->position), lo, hi;
+		int x, y, z;
+
+		switch (n->type) {
+			case SDF_SPHERE:
+				lo = c - glm::vec3(n->size.x);
+				hi = c + glm::vec3(n->size.x);
+				break;
+			case SDF_BOX:
+				lo = c - glm::vec3(n->size);
+				hi = c + glm::vec3(n->size);
+				break;
+			case SDF_TORUS: {
+				glm::vec3 r(n->size.x + n->size.y, n->size.y, n->size.x + n->size.y);
+				lo = c - r;
+				hi = c + r;
+				break;
+			}
+			case SDF_CAPSULE:
+				lo = glm::min(c, glm::vec3(n->size)) - glm::vec3(n->size.w);
+				hi = glm::max(c, glm::vec3(n->size)) + glm::vec3(n->size.w);
+				break;
+			default:
+				lo = hi = c;
+				break;
+		}
+		lo -= glm::vec3(margin);
+		hi += glm::vec3(margin);
+		for (z = 0; z < SDF_BAKE_BRICKS; z++) {
+			for (y = 0; y < SDF_BAKE_BRICKS; y++) {
+				for (x = 0; x < SDF_BAKE_BRICKS; x++) {
+					glm::vec3 bmin = glm::vec3(-SDF_BAKE_EXTENT) + glm::vec3((float)x, (float)y, (float)z) * brickSize;
+					glm::vec3 bmax = bmin + glm::vec3(brickSize);
+					bool hit;
+					if (n->op == SDF_INTERSECT) {
+						hit = true;
+					} else if (n->type == SDF_PLANE) {
+						glm::vec3 normal(n->size);
+						glm::vec3 half = glm::vec3(0.5f * brickSize);
+						float d = glm::dot(normal, bmin + half) + n->size.w;
+						hit = fabsf(d) <= glm::dot(glm::abs(normal), half) + margin;
+					} else {
+						hit = glm::all(glm::lessThanEqual(bmin, hi)) && glm::all(glm::lessThanEqual(lo, bmax));
+					}
+					if (hit)
+						markBrick(x, y, z);
+				}
+			}
+		}
+	}
+
+	/* Mark the bricks the changes of the nodes of scene since the last
+	* call affect and take over its nodes. */
+	void diff(const SdfScene *scene)
+	{
+		GLuint i, count = scene->data.count[0];
+		GLuint n = count > bakedCount ? count : bakedCount;
+
+		for (i = 0; i < n; i++) {
+			bool had = i < bakedCount, has = i < count;
+			if (had && has && !memcmp(&baked[i], &scene->data.nodes[i], sizeof(GpuSdfNode)))
+				continue;
+			if (had)
+				markNode(&baked[i]);
+			if (has)
+				markNode(&scene->data.nodes[i]);
+		}
+		for (i = 0; i < count; i++)
+			baked[i] = scene->data.nodes[i];
+		bakedCount = count;
+		bakedVersion = scene->version;
+	}
+
+	/* Rebake up to maxBricks of the bricks affected by changes of scene,
+	* once per frame. They are done before anything reads the texture. */
+	void update(SdfScene *scene, int maxBricks = SDF_BAKE_BRICKS_PER_FRAME)
+	{
+		int done = 0;
+
+		if (!program)
+			return;
+		GL_DEBUG_GROUP("sdf bake");
+		if (!complete && !pending) {
+			/* the first bake */
+			memset(dirty, 0, sizeof(dirty));
+			pending = 0;
+			for (int i = 0; i < SDF_BAKE_BRICKS * SDF_BAKE_BRICKS * SDF_BAKE_BRICKS; i++) {
+				dirty[i] = true;
+				pending++;
+			}
+			diff(scene);
+		} else if (scene->version != bakedVersion) {
+			diff(scene);
+		}
+		if (!pending)
+			return;
+
+		/* the bake reads the nodes from the uniform buffer */
+		scene->bind();
+		glState()->useProgram(program);
+		glBindImageTexture(0, texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+		const int total = SDF_BAKE_BRICKS * SDF_BAKE_BRICKS * SDF_BAKE_BRICKS;
+		while (pending && done < maxBricks) {
+			int b = cursor;
+			cursor = (cursor + 1) % total;
+			if (!dirty[b])
+				continue;
+			dirty[b] = false;
+			pending--;
+			done++;
+			int x = b % SDF_BAKE_BRICKS, y = (b / SDF_BAKE_BRICKS) % SDF_BAKE_BRICKS,
+				z = b / (SDF_BAKE_BRICKS * SDF_BAKE_BRICKS);
+			glUniform3i(brickOriginLoc, x * SDF_BAKE_BRICK, y * SDF_BAKE_BRICK, z * SDF_BAKE_BRICK);
+			glDispatchCompute(SDF_BAKE_BRICK / SDF_BAKE_GROUP, SDF_BAKE_BRICK / SDF_BAKE_GROUP,
+				SDF_BAKE_BRICK / SDF_BAKE_GROUP);
+		}
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		if (!pending && !complete) {
+			/* from now on the raymarching program may use the texture */
+			complete = true;
+			scene->setFlags(SDF_FLAG_BAKED, true);
+		}
+		GL_ERROR_DBG("SDF bake");
+	}
+
+	/* Make the texture available to the raymarching program. */
+	void bind()
+	{
+		if (!texture)
+			return;
+		glState()->activeTexture(GL_TEXTURE0 + SDF_TEXTURE_UNIT);
+		glState()->bindTexture(GL_TEXTURE_3D, texture);
+		glState()->activeTexture(GL_TEXTURE0);
+	}
+} SdfBaker;
+
+#endif
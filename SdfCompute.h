@@ -0,0 +1,103 @@
+#ifndef HEADER_SDFCOMPUTE_H
+#define HEADER_SDFCOMPUTE_H
+
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "SdfScene.h"
+#include "SdfTemporal.h"
+
+/****************************************************************************
+* SDF COMPUTE RAYMARCHER                                                   *
+****************************************************************************/
+
+/* SdfComputeMarcher: the raymarching program as a compute shader
+* (shaders/raymarch.cs.glsl). In the fragment shader, the rays of a warp
+* take as many steps as the longest of them while the others idle, and the
+* hardware decides which pixels go together. Here a work group marches a
+* tile of 8x8 pixels in chunks of steps, and after each chunk it checks in
+* shared memory whether any of its rays still marches, so a finished tile
+* ends right away. There are only SDF_COMPUTE_GROUPS groups, which stay
+* resident and take the tiles one after the other from a queue (a counter
+* in a storage buffer), so the expensive tiles spread over all of them.
+* The hits go into the march target of SdfTemporal, which resolves them
+* with the checkerboard, or just copies them into the framebuffer.
+* Needs compute shaders (GL 4.3). */
+#define SDF_COMPUTE_SHADER "shaders/raymarch.cs.glsl"
+#define SDF_COMPUTE_TILE 8		/* also in shaders/raymarch.cs.glsl */
+#define SDF_COMPUTE_GROUPS 256		/* persistent work groups */
+
+typedef struct {
+	bool enabled;
+	GLuint program;		/* 0 if not supported */
+	GLint viewportSizeLoc;
+	GLuint queue;		/* GL_SHADER_STORAGE_BUFFER with the next tile */
+
+	void clear()
+	{
+		enabled = false;
+		program = queue = 0;
+	}
+
+	/* Build the program, sources are loaded via cache.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		if (!computeShaderSupported() || !glBindImageTexture)
+			return false;
+		program = computeProgramBuild(cache, SDF_COMPUTE_SHADER);
+		if (!program)
+			return false;
+		viewportSizeLoc = glGetUniformLocation(program, "viewportSize");
+		glGenBuffers(1, &queue);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, queue);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		info("SDF compute raymarcher: program %u", program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (queue)
+			glState()->deleteBuffers(1, &queue);
+		clear();
+	}
+
+	/* March the scene for a frame of w x h pixels into the march target of
+	* temporal, with the frame uniforms and scene bound. This uses its own
+	* program and leaves the target bound.
+	* Returns true if successfull and false in case of an error. */
+	bool march(SdfTemporal *temporal, const SdfScene *scene, GLsizei w, GLsizei h)
+	{
+		GLuint zero = 0;
+
+		if (!temporal->beginMarch(scene, w, h))
+			return false;
+		GL_DEBUG_GROUP("sdf march");
+		GLuint tiles = (GLuint)(((w + SDF_COMPUTE_TILE - 1) / SDF_COMPUTE_TILE) *
+			((h + SDF_COMPUTE_TILE - 1) / SDF_COMPUTE_TILE));
+
+		/* restart the queue */
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, queue);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		glState()->useProgram(program);
+		glUniform2i(viewportSizeLoc, w, h);
+		glBindImageTexture(0, temporal->march.color, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		glBindImageTexture(1, temporal->march.depth, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, queue);
+		glDispatchCompute(tiles < SDF_COMPUTE_GROUPS ? tiles : SDF_COMPUTE_GROUPS, 1, 1);
+		/* the resolve samples what was stored */
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		GL_ERROR_DBG("SDF compute raymarcher");
+		return true;
+	}
+} SdfComputeMarcher;
+
+#endif
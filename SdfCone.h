@@ -0,0 +1,134 @@
+#ifndef HEADER_SDFCONE_H
+#define HEADER_SDFCONE_H
+
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "SdfScene.h"
+
+/****************************************************************************
+* SDF CONE PRE-PASS                                                        *
+****************************************************************************/
+
+/* SdfConeMarcher: a pre-pass of the raymarching program at a fraction of
+* the resolution. Most steps of the rays cross the empty space in front of
+* the scene, and neighbouring pixels cross the same. So for every tile of
+* tileSize x tileSize pixels, shaders/sdf_cone.cs.glsl marches a single cone
+* containing the rays of all its pixels, and stores how far it got in a
+* texture of one R32F texel per tile. The steps of the cone only go as far
+* as the whole cone is empty, so the distance is conservative, and each
+* pixel of shaders/raymarch.fs.glsl starts there.
+* The tile size is in the SdfScene block, 0 means there is no pre-pass.
+* Needs compute shaders (GL 4.3); otherwise every pixel marches from the
+* camera. */
+#define SDF_CONE_SHADER "shaders/sdf_cone.cs.glsl"
+#define SDF_CONE_TILE 8		/* default pixels per side of a tile */
+#define SDF_CONE_STEPS 64	/* default step limit of a cone */
+#define SDF_CONE_GROUP 8	/* local size of the compute shader */
+
+typedef struct {
+	GLuint program;		/* 0 if not supported or disabled */
+	GLint viewportSizeLoc;
+	GLint coneStepsLoc;
+	GLuint texture;		/* GL_TEXTURE_2D, GL_R32F, a texel per tile */
+	GLsizei width, height;	/* of texture */
+	int tileSize;
+	int steps;
+
+	void clear()
+	{
+		program = 0;
+		texture = 0;
+		width = height = 0;
+		tileSize = SDF_CONE_TILE;
+		steps = SDF_CONE_STEPS;
+	}
+
+	/* Build the program of the pre-pass for scene, with tiles of tile x
+	* tile pixels and up to coneSteps steps per cone. Sources are loaded
+	* via cache. A tile of 0 disables the pre-pass.
+	* Returns true if successfull and false if it is disabled or not
+	* supported. */
+	bool init(ShaderSourceCache *cache, SdfScene *scene, int tile, int coneSteps)
+	{
+		clear();
+		scene->data.count[2] = 0;
+		scene->dirty = true;
+		if (tile < 1 || !computeShaderSupported() || !glBindImageTexture)
+			return false;
+		program = computeProgramBuild(cache, SDF_CONE_SHADER);
+		if (!program)
+			return false;
+		tileSize = tile;
+		steps = coneSteps;
+		viewportSizeLoc = glGetUniformLocation(program, "viewportSize");
+		coneStepsLoc = glGetUniformLocation(program, "coneSteps");
+		glGenTextures(1, &texture);
+		scene->data.count[2] = (GLuint)tileSize;
+		info("SDF cone pre-pass: tiles of %dx%d pixels, up to %d steps, program %u", tileSize, tileSize, steps,
+			program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (texture)
+			glState()->deleteTextures(1, &texture);
+		clear();
+	}
+
+	/* (Re-)allocate the texture for a viewport of w x h pixels. */
+	void resize(GLsizei w, GLsizei h)
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		w = (w + tileSize - 1) / tileSize;
+		h = (h + tileSize - 1) / tileSize;
+		if (w < 1)
+			w = 1;
+		if (h < 1)
+			h = 1;
+		if (w == width && h == height)
+			return;
+		width = w;
+		height = h;
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	/* March the cones of all tiles of a viewport of w x h pixels, with
+	* the frame uniforms and scene bound, before the raymarching program
+	* draws. This uses its own program, so the program for drawing must be
+	* bound afterwards. */
+	void march(GLsizei w, GLsizei h)
+	{
+		if (!program)
+			return;
+		GL_DEBUG_GROUP("sdf cone march");
+		resize(w, h);
+		glState()->useProgram(program);
+		glUniform2f(viewportSizeLoc, (GLfloat)w, (GLfloat)h);
+		glUniform1i(coneStepsLoc, steps);
+		glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute((GLuint)(width + SDF_CONE_GROUP - 1) / SDF_CONE_GROUP,
+			(GLuint)(height + SDF_CONE_GROUP - 1) / SDF_CONE_GROUP, 1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		GL_ERROR_DBG("SDF cone pre-pass");
+	}
+
+	/* Make the distances available to the raymarching program. */
+	void bind()
+	{
+		if (!texture)
+			return;
+		glState()->activeTexture(GL_TEXTURE0 + SDF_CONE_TEXTURE_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+		glState()->activeTexture(GL_TEXTURE0);
+	}
+} SdfConeMarcher;
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef HEADER_SDFFIELD_H
+#define HEADER_SDFFIELD_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "SdfScene.h"
+
+/****************************************************************************
+* SDF FIELD                                                                *
+****************************************************************************/
+
+/* SdfField: thousands of primitives next to the nodes of an SdfScene,
+* more than its uniform block holds and than the raymarching program could
+* evaluate at every step. They are all united with the scene, so a
+* distance query only needs the primitives near the point: the field has
+* a bounding volume hierarchy, which shaders/sdf.glsl descends to the
+* nearest primitives only (see sdfField there).
+* The hierarchy is built on the GPU by shaders/sdf_field.cs.glsl, from
+* scratch in every frame the primitives move: a linear BVH, the primitives
+* sorted along a Morton curve (a bitonic sort, in shared memory as far as
+* it goes), the inner nodes derived from the sorted codes all at once,
+* then the boxes bottom-up. It takes a dozen dispatches or so, each of a
+* thread per primitive, and nothing goes back to the CPU.
+* The primitives are GpuSdfNode as in the scene, the op is ignored. Each
+* moves up and down by position.w (0 keeps it still) at the phase color.a,
+* with the time of the frame; the build writes where they are into the
+* buffer the queries read. Planes have no bounds, they belong into the
+* scene. Inside overlapping primitives, the distance is negative but not
+* always the deepest, which is all marching needs.
+* Needs compute shaders (GL 4.3), and the raymarching program storage
+* buffers (GL_ARB_shader_storage_buffer_object); without, there is no
+* field. */
+#define SDF_FIELD_SHADER "shaders/sdf_field.cs.glsl"
+#define SDF_FIELD_GROUP 256	/* local size of the compute shader, also the sort block */
+#define SDF_BVH_STACK 64	/* also in shaders/sdf.glsl */
+
+/* the stages of the compute shader, a dispatch each */
+enum {
+	SDF_FIELD_BOUNDS = 0,	/* move the primitives and bound them */
+	SDF_FIELD_MORTON,	/* their codes */
+	SDF_FIELD_SORT,		/* a step of the bitonic sort across groups */
+	SDF_FIELD_SORT_LOCAL,	/* the steps within groups */
+	SDF_FIELD_HIERARCHY,	/* the inner nodes */
+	SDF_FIELD_REFIT		/* their boxes */
+};
+
+/* a node of the hierarchy as the shader sees it, std430 */
+typedef struct {
+	glm::vec3 min;
+	GLint left;		/* child node, or ~primitive in a leaf */
+	glm::vec3 max;
+	GLint right;
+} GpuSdfBvhNode;
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint stageLoc, countLoc, paddedLoc, sortKLoc, sortJLoc;
+	GLuint source;		/* the primitives as added */
+	GLuint field;		/* the count, then where they are this frame, at SDF_FIELD_BINDING */
+	GLuint bvh;		/* 2 * capacity - 1 GpuSdfBvhNode, at SDF_BVH_BINDING */
+	GLuint keys;		/* the sorted codes, a uvec2 per padded primitive */
+	GLuint work;		/* the bounds of the centers, and the parents */
+	GLuint visits;		/* per inner node */
+	GpuSdfNode *primitives;	/* CPU copy of source */
+	int count, capacity;
+	bool dirty;		/* primitives changed since the last upload */
+	bool moving;		/* some primitive moves, rebuild every frame */
+	bool built;		/* the hierarchy is up to date with the primitives */
+
+	void clear()
+	{
+		program = 0;
+		source = field = bvh = keys = work = visits = 0;
+		primitives = NULL;
+		count = capacity = 0;
+		dirty = moving = built = false;
+	}
+
+	/* Build the program and allocate room for up to cap primitives.
+	* Sources are loaded via cache.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache, int cap)
+	{
+		clear();
+		if (cap < 1 || !computeShaderSupported() || !glCaps()->storageBuffers)
+			return false;
+		primitives = (GpuSdfNode*)malloc(sizeof(GpuSdfNode) * cap);
+		if (!primitives) {
+			warn("SDF field: failed to allocate %d primitives", cap);
+			return false;
+		}
+		program = computeProgramBuild(cache, SDF_FIELD_SHADER);
+		if (!program) {
+			destroy();
+			return false;
+		}
+		stageLoc = glGetUniformLocation(program, "stage");
+		countLoc = glGetUniformLocation(program, "count");
+		paddedLoc = glGetUniformLocation(program, "padded");
+		sortKLoc = glGetUniformLocation(program, "sortK");
+		sortJLoc = glGetUniformLocation(program, "sortJ");
+		capacity = cap;
+
+		GLuint buffers[6];
+		GLsizeiptr nodes = 2 * cap - 1, keyCount = padding(cap);
+		glGenBuffers(6, buffers);
+		source = buffers[0];
+		field = buffers[1];
+		bvh = buffers[2];
+		keys = buffers[3];
+		work = buffers[4];
+		visits = buffers[5];
+		allocate(source, sizeof(GpuSdfNode) * cap);
+		allocate(field, 4 * sizeof(GLuint) + sizeof(GpuSdfNode) * cap);
+		allocate(bvh, sizeof(GpuSdfBvhNode) * nodes);
+		allocate(keys, 2 * sizeof(GLuint) * keyCount);
+		allocate(work, 8 * sizeof(GLuint) + sizeof(GLint) * nodes);
+		allocate(visits, sizeof(GLuint) * cap);
+		GL_ERROR_DBG("SDF field initialization");
+		info("SDF field: up to %d primitives, program %u", cap, program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		GLuint buffers[6] = { source, field, bvh, keys, work, visits };
+		int i;
+		for (i = 0; i < 6; i++) {
+			if (buffers[i])
+				glState()->deleteBuffers(1, &buffers[i]);
+		}
+		free(primitives);
+		clear();
+	}
+
+	static void allocate(GLuint buffer, GLsizeiptr size)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	/* the keys the sort runs on: a power of two, at least a group */
+	static int padding(int n)
+	{
+		int padded = SDF_FIELD_GROUP;
+		while (padded < n)
+			padded *= 2;
+		return padded;
+	}
+
+	/* Remove all primitives. */
+	void reset()
+	{
+		count = 0;
+		moving = false;
+		dirty = true;
+	}
+
+	/* Append a primitive which moves up and down by amplitude, at phase.
+	* Returns its index, or -1 if there is no room. */
+	int add(GLuint type, const glm::vec3 &position, const glm::vec4 &size, const glm::vec3 &color,
+		float amplitude = 0.0f, float phase = 0.0f)
+	{
+		if (count >= capacity) {
+			warn("SDF field: more than %d primitives", capacity);
+			return -1;
+		}
+		GpuSdfNode *n = &primitives[count];
+		n->type = type;
+		n->op = SDF_UNION;
+		n->blend = 0.0f;
+		n->pad = 0;
+		n->position = glm::vec4(position, amplitude);
+		n->size = size;
+		n->color = glm::vec4(color, phase);
+		moving = moving || amplitude != 0.0f;
+		dirty = true;
+		return count++;
+	}
+
+	/* Fill the field with n primitives of all bounded types and colors,
+	* scattered over a floor in front of the default scene, each bobbing
+	* at its own phase. */
+	void initRandom(int n)
+	{
+		int i;
+		unsigned int seed = 1;
+		reset();
+		for (i = 0; i < n && i < capacity; i++) {
+			float r[8];
+			int k;
+			for (k = 0; k < 8; k++) {
+				seed = seed * 1664525u + 1013904223u;
+				r[k] = (float)(seed >> 8) / 16777216.0f;
+			}
+			glm::vec3 p(-12.0f + 24.0f * r[0], -1.2f + 0.4f * r[1], 2.0f - 40.0f * r[2]);
+			glm::vec3 color(0.3f + 0.7f * r[3], 0.3f + 0.7f * r[4], 0.3f + 0.7f * r[5]);
+			float s = 0.05f + 0.15f * r[6];
+			switch (i % 4) {
+				case 0:
+					add(SDF_SPHERE, p, glm::vec4(s, 0.0f, 0.0f, 0.0f), color, 0.2f, 6.283f * r[7]);
+					break;
+				case 1:
+					add(SDF_BOX, p, glm::vec4(s, s, s, 0.2f * s), color, 0.2f, 6.283f * r[7]);
+					break;
+				case 2:
+					add(SDF_TORUS, p, glm::vec4(s, 0.3f * s, 0.0f, 0.0f), color, 0.2f, 6.283f * r[7]);
+					break;
+				default:
+					add(SDF_CAPSULE, p, glm::vec4(p + glm::vec3(0.0f, 2.0f * s, 0.0f), 0.4f * s), color,
+						0.2f, 6.283f * r[7]);
+					break;
+			}
+		}
+		info("SDF field: %d primitives", count);
+	}
+
+	/* Upload what changed, and rebuild the hierarchy if the primitives
+	* changed or move, with the frame uniforms bound. This uses its own
+	* program. */
+	void update()
+	{
+		if (!program || !count || (built && !dirty && !moving))
+			return;
+		GL_DEBUG_GROUP("sdf field");
+		if (dirty) {
+			GLuint header[4] = { (GLuint)count, 0, 0, 0 };
+			glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, source);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GpuSdfNode) * count, primitives);
+			glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, field);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+			dirty = false;
+		}
+		/* the bounds of the centers start empty */
+		GLuint bounds[8] = { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0, 0, 0, 0, 0 };
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, work);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(bounds), bounds);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		int padded = padding(count), k, j;
+		glState()->useProgram(program);
+		glUniform1i(countLoc, count);
+		glUniform1i(paddedLoc, padded);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keys);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, work);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visits);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, source);
+		bind();
+
+		dispatch(SDF_FIELD_BOUNDS, count);
+		dispatch(SDF_FIELD_MORTON, padded);
+		/* sorted runs of a group, then the merges: the steps over more
+		* than a group go across groups, the rest within */
+		sort(0, 0, padded);
+		for (k = 2 * SDF_FIELD_GROUP; k <= padded; k *= 2) {
+			for (j = k / 2; j >= SDF_FIELD_GROUP; j /= 2) {
+				glUniform1i(sortKLoc, k);
+				glUniform1i(sortJLoc, j);
+				dispatch(SDF_FIELD_SORT, padded);
+			}
+			sort(k, SDF_FIELD_GROUP / 2, padded);
+		}
+		dispatch(SDF_FIELD_HIERARCHY, count - 1);
+		dispatch(SDF_FIELD_REFIT, count);
+		built = true;
+		GL_ERROR_DBG("SDF field build");
+	}
+
+	void sort(int k, int j, int padded)
+	{
+		glUniform1i(sortKLoc, k);
+		glUniform1i(sortJLoc, j);
+		dispatch(SDF_FIELD_SORT_LOCAL, padded);
+	}
+
+	/* Run stage with a thread per item, after the stage before. */
+	void dispatch(int stage, int items)
+	{
+		glUniform1i(stageLoc, stage);
+		if (items > 0)
+			glDispatchCompute((GLuint)(items + SDF_FIELD_GROUP - 1) / SDF_FIELD_GROUP, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	/* Make the field available to the raymarching program of scene, or
+	* tell it there is none. */
+	void bind(SdfScene *scene)
+	{
+		scene->setFlags(SDF_FLAG_FIELD, program && count && built);
+		if (program && count && built)
+			bind();
+	}
+
+	void bind()
+	{
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, SDF_FIELD_BINDING, field);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, SDF_BVH_BINDING, bvh);
+	}
+} SdfField;
+
+#endif
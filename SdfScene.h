@@ -0,0 +1,268 @@
+#ifndef HEADER_SDFSCENE_H
+#define HEADER_SDFSCENE_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* SDF SCENE                                                                *
+****************************************************************************/
+
+/* SdfScene: a scene of signed distance primitives for the raymarching
+* program (shaders/raymarch.fs.glsl), as data in a uniform block rather
+* than code in the shader, so changing it needs no new program. The scene
+* is a list of nodes, evaluated in order: each node is a primitive, which
+* is combined with the distance of the nodes before it by the node's
+* operation (the first node just starts the distance). Subtracting and
+* intersecting thus apply to everything before them. The smooth union
+* blends over a distance of blend, so shapes melt into each other.
+* The color of the surface is taken from the node nearest to it.
+* Scenes can be read from a text file of one node per line:
+*   op blend type  x y z  a b c d  r g b
+* with op one of union, subtract, intersect or smooth and type one of
+* sphere (radius a), box (half extents a b c, rounded by d), torus (radii
+* a b), plane (unit normal a b c, offset d) and capsule (from x y z to a b c,
+* radius d). '#' starts a comment. */
+#define SDF_NODE_MAX 64		/* also in shaders/sdf.glsl */
+#define SDF_LINE_MAX 256
+#define SDF_MARCH_STEPS 128	/* default step limit of a pixel */
+
+/* primitives, also in shaders/sdf.glsl */
+enum {
+	SDF_SPHERE = 0,
+	SDF_BOX,
+	SDF_TORUS,
+	SDF_PLANE,
+	SDF_CAPSULE,
+	SDF_PRIMITIVE_COUNT
+};
+
+/* operations, also in shaders/sdf.glsl */
+enum {
+	SDF_UNION = 0,
+	SDF_SUBTRACT,
+	SDF_INTERSECT,
+	SDF_SMOOTH_UNION,
+	SDF_OP_COUNT
+};
+
+static const char * const sdfPrimitiveNames[SDF_PRIMITIVE_COUNT] = { "sphere", "box", "torus", "plane", "capsule" };
+static const char * const sdfOpNames[SDF_OP_COUNT] = { "union", "subtract", "intersect", "smooth" };
+
+/* the flags in the scene, also in shaders/sdf.glsl */
+#define SDF_FLAG_BAKED 0x1		/* the distances are baked, see SdfBake.h */
+#define SDF_FLAG_CHECKERBOARD 0x2	/* march half the pixels, see SdfTemporal.h */
+#define SDF_FLAG_FIELD 0x4		/* the field of SdfField.h is bound */
+
+/* a node as the shader sees it, std140 */
+typedef struct {
+	GLuint type;		/* SDF_SPHERE ... */
+	GLuint op;		/* SDF_UNION ... */
+	GLfloat blend;		/* of SDF_SMOOTH_UNION */
+	GLuint pad;
+	glm::vec4 position;	/* xyz, w unused */
+	glm::vec4 size;		/* the parameters of the primitive, see above */
+	glm::vec4 color;	/* rgb, a unused */
+} GpuSdfNode;
+
+/* the uniform block "SdfScene", std140 */
+typedef struct {
+	GLuint count[4];	/* nodes, SDF_FLAG_*, pixels per side of a tile of the cone pre-pass
+				* or 0 (see SdfCone.h), steps per pixel */
+	glm::vec4 bakeMin;	/* corner of the baked volume, w: half a texel in texture coordinates */
+	glm::vec4 bakeSize;	/* extent of the baked volume, w: size of a texel */
+	GpuSdfNode nodes[SDF_NODE_MAX];
+} SdfSceneUniforms;
+
+/* Returns the index of name in the count names, -1 if it is none of them. */
+static int sdfLookup(const char *name, const char * const *names, int count)
+{
+	int i;
+	for (i = 0; i < count; i++) {
+		if (!strcmp(name, names[i]))
+			return i;
+	}
+	return -1;
+}
+
+typedef struct {
+	SdfSceneUniforms data;
+	GLuint buffer;		/* at SDF_UBO_BINDING */
+	GLuint vao;		/* empty, the full-screen triangle needs no attributes */
+	bool dirty;		/* data changed since the last upload */
+	GLuint version;		/* counts the changes of the nodes, see SdfBaker */
+
+	/* Reset to an empty scene without any GL objects. */
+	void clear()
+	{
+		memset(data.count, 0, sizeof(data.count));
+		data.bakeMin = data.bakeSize = glm::vec4(0.0f);
+		buffer = 0;
+		vao = 0;
+		dirty = false;
+		version = 0;
+	}
+
+	/* Create the GL objects for an empty scene.
+	* Returns true if successfull and false in case of an error. */
+	bool init()
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &buffer);
+		glState()->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(data), NULL, GL_DYNAMIC_DRAW);
+		glState()->bindBuffer(GL_UNIFORM_BUFFER, 0);
+		GL_ERROR_DBG("SDF scene initialization");
+		data.count[3] = SDF_MARCH_STEPS;
+		dirty = true;
+		return vao && buffer;
+	}
+
+	/* Limit the steps of the raymarching program to steps per pixel. */
+	void setSteps(int steps)
+	{
+		data.count[3] = (GLuint)(steps > 0 ? steps : 1);
+		dirty = true;
+	}
+
+	/* Set or clear the flags in mask, SDF_FLAG_*. */
+	void setFlags(GLuint mask, bool enable)
+	{
+		GLuint flags = enable ? (data.count[1] | mask) : (data.count[1] & ~mask);
+		dirty = dirty || flags != data.count[1];
+		data.count[1] = flags;
+	}
+
+	/* Remove all nodes. */
+	void reset()
+	{
+		data.count[0] = 0;
+		dirty = true;
+		version++;
+	}
+
+	/* Append a node. Returns its index, or -1 if there is no room. */
+	int add(GLuint type, GLuint op, GLfloat blend, const glm::vec3 &position, const glm::vec4 &size,
+		const glm::vec3 &color)
+	{
+		if (data.count[0] >= SDF_NODE_MAX) {
+			warn("SDF scene: more than %d nodes", SDF_NODE_MAX);
+			return -1;
+		}
+		GpuSdfNode *n = &data.nodes[data.count[0]];
+		n->type = type;
+		n->op = op;
+		n->blend = blend;
+		n->pad = 0;
+		n->position = glm::vec4(position, 1.0f);
+		n->size = size;
+		n->color = glm::vec4(color, 1.0f);
+		dirty = true;
+		version++;
+		return (int)data.count[0]++;
+	}
+
+	/* The scene the default program always showed the cube in. */
+	void initDefault()
+	{
+		reset();
+		add(SDF_PLANE, SDF_UNION, 0.0f, glm::vec3(0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 1.5f),
+			glm::vec3(0.5f, 0.5f, 0.55f));
+		add(SDF_BOX, SDF_UNION, 0.0f, glm::vec3(0.0f), glm::vec4(0.8f, 0.8f, 0.8f, 0.1f),
+			glm::vec3(1.0f, 0.4f, 0.3f));
+		/* a hole through the box, like the "cut" shader */
+		add(SDF_SPHERE, SDF_SUBTRACT, 0.0f, glm::vec3(0.0f), glm::vec4(1.05f, 0.0f, 0.0f, 0.0f),
+			glm::vec3(1.0f, 0.4f, 0.3f));
+		add(SDF_TORUS, SDF_SMOOTH_UNION, 0.3f, glm::vec3(0.0f, -0.9f, 0.0f), glm::vec4(1.6f, 0.2f, 0.0f, 0.0f),
+			glm::vec3(0.3f, 0.5f, 1.0f));
+		add(SDF_SPHERE, SDF_SMOOTH_UNION, 0.4f, glm::vec3(1.6f, -0.7f, 0.0f), glm::vec4(0.45f, 0.0f, 0.0f, 0.0f),
+			glm::vec3(0.3f, 0.9f, 0.4f));
+		add(SDF_CAPSULE, SDF_UNION, 0.0f, glm::vec3(-1.6f, -1.5f, 0.0f), glm::vec4(-1.6f, 0.5f, 0.0f, 0.2f),
+			glm::vec3(1.0f, 0.9f, 0.3f));
+	}
+
+	/* Replace the scene by the one in the text file filename, see above.
+	* Returns true if successfull, otherwise the scene stays as it was. */
+	bool load(const char *filename)
+	{
+		char line[SDF_LINE_MAX], op[32], type[32];
+		SdfSceneUniforms old = data;
+		FILE *file = fopen(filename, "rt");
+		int number = 0;
+		bool ok = true;
+
+		if (!file) {
+			warn("failed to open SDF scene '%s'", filename);
+			return false;
+		}
+		reset();
+		while (ok && fgets(line, sizeof(line), file)) {
+			float blend, p[3], s[4], c[3];
+			char *comment = strchr(line, '#');
+			number++;
+			if (comment)
+				*comment = 0;
+			if (sscanf(line, " %31s", op) != 1)
+				continue;
+			int o, t;
+			ok = sscanf(line, " %31s %f %31s %f %f %f %f %f %f %f %f %f %f", op, &blend, type, &p[0], &p[1],
+				&p[2], &s[0], &s[1], &s[2], &s[3], &c[0], &c[1], &c[2]) == 13 &&
+				(o = sdfLookup(op, sdfOpNames, SDF_OP_COUNT)) >= 0 &&
+				(t = sdfLookup(type, sdfPrimitiveNames, SDF_PRIMITIVE_COUNT)) >= 0;
+			if (!ok)
+				warn("%s:%d: malformed SDF node", filename, number);
+			else
+				ok = add((GLuint)t, (GLuint)o, blend, glm::vec3(p[0], p[1], p[2]),
+					glm::vec4(s[0], s[1], s[2], s[3]), glm::vec3(c[0], c[1], c[2])) >= 0;
+		}
+		fclose(file);
+		if (!ok) {
+			data = old;
+			version++;
+			return false;
+		}
+		info("SDF scene '%s': %u nodes", filename, data.count[0]);
+		return true;
+	}
+
+	/* Upload the nodes if they changed and make them available to the
+	* shaders. */
+	void bind()
+	{
+		if (dirty) {
+			/* only the nodes in use */
+			glState()->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(SdfSceneUniforms, nodes) + sizeof(GpuSdfNode) * data.count[0],
+				&data);
+			glState()->bindBuffer(GL_UNIFORM_BUFFER, 0);
+			dirty = false;
+		}
+		glState()->bindBufferBase(GL_UNIFORM_BUFFER, SDF_UBO_BINDING, buffer);
+	}
+
+	/* The draw call of the full-screen triangle, with the raymarching
+	* program and vao bound. */
+	void draw() const
+	{
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+	}
+
+	void destroy()
+	{
+		if (buffer)
+			glState()->deleteBuffers(1, &buffer);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		buffer = vao = 0;
+	}
+} SdfScene;
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef HEADER_SDFTEMPORAL_H
+#define HEADER_SDFTEMPORAL_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "SdfScene.h"
+
+/****************************************************************************
+* SDF TEMPORAL REPROJECTION                                                *
+****************************************************************************/
+
+/* SdfTemporal: checkerboard rendering of the raymarching program. Each
+* frame only marches the pixels of one color of a checkerboard, which flips
+* every frame, into an FBO with the color and the depth (R32F) of the hits.
+* The resolve (shaders/sdf_resolve.fs.glsl) then fills in the other pixels
+* from the previous frame: their surface, estimated from their marched
+* neighbours, is projected with the previous view projection matrix into
+* the previous frame, whose color and depth are kept in a history. Where
+* the history does not show the same surface, i.e. where it was occluded or
+* outside of the view, or after the scene changed, the neighbours are
+* averaged instead. The resolved frame becomes the next history, and is
+* copied into the framebuffer with its depth (shaders/sdf_present.fs.glsl).
+* So half of the pixels are marched for roughly the same image. */
+#define SDF_TEMPORAL_VS "shaders/raymarch.vs.glsl"
+#define SDF_RESOLVE_FS "shaders/sdf_resolve.fs.glsl"
+#define SDF_PRESENT_FS "shaders/sdf_present.fs.glsl"
+
+/* the texture units during the resolve */
+#define SDF_MARCH_COLOR_UNIT 6
+#define SDF_MARCH_DEPTH_UNIT 7
+#define SDF_HISTORY_COLOR_UNIT 8
+#define SDF_HISTORY_DEPTH_UNIT 9
+
+/* the color and depth of a frame, as two color attachments of an FBO */
+typedef struct {
+	GLuint fbo;
+	GLuint color;		/* GL_RGBA8, alpha 0 where no surface was hit */
+	GLuint depth;		/* GL_R32F window depth, 1 where no surface was hit */
+} SdfFrameTarget;
+
+typedef struct {
+	bool enabled;
+	GLuint resolveProgram, presentProgram;	/* 0 if not supported */
+	GLint previousViewProjectionLoc, previousViewProjectionInverseLoc, historyValidLoc;
+	SdfFrameTarget march;	/* the pixels marched this frame */
+	SdfFrameTarget history[2];	/* the resolved frames, ping-ponged */
+	int current;		/* the history written this frame */
+	GLsizei width, height;
+	bool valid;		/* the other history holds the previous frame */
+	GLuint sceneVersion;	/* SdfScene::version the history shows */
+
+	void clear()
+	{
+		enabled = false;
+		resolveProgram = presentProgram = 0;
+		march.fbo = march.color = march.depth = 0;
+		history[0] = history[1] = march;
+		current = 0;
+		width = height = 0;
+		valid = false;
+		sceneVersion = 0;
+	}
+
+	/* Build the programs of the resolve and the present, sources are
+	* loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		resolveProgram = programBuild(cache, SDF_TEMPORAL_VS, SDF_RESOLVE_FS);
+		presentProgram = programBuild(cache, SDF_TEMPORAL_VS, SDF_PRESENT_FS);
+		if (!resolveProgram || !presentProgram) {
+			destroy();
+			return false;
+		}
+		previousViewProjectionLoc = glGetUniformLocation(resolveProgram, "previousViewProjection");
+		previousViewProjectionInverseLoc = glGetUniformLocation(resolveProgram, "previousViewProjectionInverse");
+		historyValidLoc = glGetUniformLocation(resolveProgram, "historyValid");
+		glState()->useProgram(resolveProgram);
+		glUniform1i(glGetUniformLocation(resolveProgram, "marchColor"), SDF_MARCH_COLOR_UNIT);
+		glUniform1i(glGetUniformLocation(resolveProgram, "marchDepth"), SDF_MARCH_DEPTH_UNIT);
+		glUniform1i(glGetUniformLocation(resolveProgram, "historyColor"), SDF_HISTORY_COLOR_UNIT);
+		glUniform1i(glGetUniformLocation(resolveProgram, "historyDepth"), SDF_HISTORY_DEPTH_UNIT);
+		glState()->useProgram(presentProgram);
+		glUniform1i(glGetUniformLocation(presentProgram, "historyColor"), SDF_HISTORY_COLOR_UNIT);
+		glUniform1i(glGetUniformLocation(presentProgram, "historyDepth"), SDF_HISTORY_DEPTH_UNIT);
+		glState()->useProgram(0);
+		info("SDF temporal: resolve program %u, present program %u", resolveProgram, presentProgram);
+		return true;
+	}
+
+	void destroyTarget(SdfFrameTarget *t)
+	{
+		if (t->fbo)
+			glDeleteFramebuffers(1, &t->fbo);
+		if (t->color)
+			glState()->deleteTextures(1, &t->color);
+		if (t->depth)
+			glState()->deleteTextures(1, &t->depth);
+		t->fbo = t->color = t->depth = 0;
+	}
+
+	void destroyTargets()
+	{
+		destroyTarget(&march);
+		destroyTarget(&history[0]);
+		destroyTarget(&history[1]);
+		width = height = 0;
+		valid = false;
+	}
+
+	void destroy()
+	{
+		destroyTargets();
+		if (resolveProgram)
+			glState()->deleteProgram(resolveProgram);
+		if (presentProgram)
+			glState()->deleteProgram(presentProgram);
+		clear();
+	}
+
+	static GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type, GLsizei w, GLsizei h)
+	{
+		GLuint tex;
+		MemoryScope scope(MEMORY_TARGETS);
+		glGenTextures(1, &tex);
+		glState()->bindTexture(GL_TEXTURE_2D, tex);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		return tex;
+	}
+
+	bool initTarget(SdfFrameTarget *t, GLsizei w, GLsizei h)
+	{
+		static const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+
+		t->color = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, w, h);
+		t->depth = createTexture(GL_R32F, GL_RED, GL_FLOAT, w, h);
+		glGenFramebuffers(1, &t->fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, t->fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t->color, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, t->depth, 0);
+		glDrawBuffers(2, buffers);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		if (status != GL_FRAMEBUFFER_COMPLETE) {
+			warn("SDF temporal: FBO %u is incomplete: 0x%x", t->fbo, (unsigned)status);
+			return false;
+		}
+		return true;
+	}
+
+	/* (Re-)allocate the targets for w x h pixels, which drops the history.
+	* Returns true if successfull and false in case of an error. */
+	bool resize(GLsizei w, GLsizei h)
+	{
+		if (w < 1)
+			w = 1;
+		if (h < 1)
+			h = 1;
+		if (w == width && h == height)
+			return true;
+		destroyTargets();
+		bool ok = initTarget(&march, w, h) && initTarget(&history[0], w, h) && initTarget(&history[1], w, h);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!ok) {
+			destroyTargets();
+			return false;
+		}
+		width = w;
+		height = h;
+		info("SDF temporal: %dx%d pixels", (int)width, (int)height);
+		GL_ERROR_DBG("SDF temporal targets");
+		return true;
+	}
+
+	/* Enable or disable the checkerboard rendering of scene. */
+	void setEnabled(SdfScene *scene, bool enable)
+	{
+		enabled = enable && resolveProgram;
+		valid = false;
+		scene->setFlags(SDF_FLAG_CHECKERBOARD, enabled);
+	}
+
+	/* Set up the march target for a frame of w x h pixels of scene, and
+	* bind it cleared to misses. Also used by the compute raymarcher, so
+	* this works without the checkerboard too.
+	* Returns true if successfull and false in case of an error. */
+	bool beginMarch(const SdfScene *scene, GLsizei w, GLsizei h)
+	{
+		static const GLfloat none[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		static const GLfloat far[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+		if (!presentProgram || !resize(w, h))
+			return false;
+		if (scene->version != sceneVersion) {
+			sceneVersion = scene->version;
+			valid = false;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, march.fbo);
+		glClearBufferfv(GL_COLOR, 0, none);
+		glClearBufferfv(GL_COLOR, 1, far);
+		return true;
+	}
+
+	/* Redirect the raymarching program of this frame of w x h pixels into
+	* the march target. Returns false if the frame is drawn as usual. */
+	bool begin(const SdfScene *scene, GLsizei w, GLsizei h)
+	{
+		if (!enabled)
+			return false;
+		if (!beginMarch(scene, w, h)) {
+			warn("SDF temporal: falling back to marching every pixel");
+			enabled = false;
+			return false;
+		}
+		return true;
+	}
+
+	/* Resolve the frame begin() started into the next history and copy it
+	* into the framebuffer fbo, with the view projection matrix of the
+	* previous frame previousViewProjection. vao is an empty vertex array
+	* object for the full-screen triangles. The raster state of the
+	* raymarching program (depth test and writes) must still be set. */
+	void resolve(GLuint fbo, const glm::mat4 &previousViewProjection, GLuint vao)
+	{
+		SdfFrameTarget *dst = &history[current], *src = &history[current ^ 1];
+		glm::mat4 previousInverse = glm::inverse(previousViewProjection);
+
+		GL_DEBUG_GROUP("sdf temporal resolve");
+		glBindFramebuffer(GL_FRAMEBUFFER, dst->fbo);
+		glState()->useProgram(resolveProgram);
+		glUniformMatrix4fv(previousViewProjectionLoc, 1, GL_FALSE, &previousViewProjection[0][0]);
+		glUniformMatrix4fv(previousViewProjectionInverseLoc, 1, GL_FALSE, &previousInverse[0][0]);
+		glUniform1i(historyValidLoc, valid);
+		bindTexture(SDF_MARCH_COLOR_UNIT, march.color);
+		bindTexture(SDF_MARCH_DEPTH_UNIT, march.depth);
+		bindTexture(SDF_HISTORY_COLOR_UNIT, src->color);
+		bindTexture(SDF_HISTORY_DEPTH_UNIT, src->depth);
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+		present(fbo, dst, vao);
+
+		current ^= 1;
+		valid = true;
+		GL_ERROR_DBG("SDF temporal resolve");
+	}
+
+	/* Copy the frame in src into the framebuffer fbo, with its depth. */
+	void present(GLuint fbo, const SdfFrameTarget *src, GLuint vao)
+	{
+		GL_DEBUG_GROUP("sdf present");
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glState()->useProgram(presentProgram);
+		bindTexture(SDF_HISTORY_COLOR_UNIT, src->color);
+		bindTexture(SDF_HISTORY_DEPTH_UNIT, src->depth);
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+		glState()->activeTexture(GL_TEXTURE0);
+	}
+
+	static void bindTexture(int unit, GLuint texture)
+	{
+		glState()->activeTexture(GL_TEXTURE0 + unit);
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+	}
+} SdfTemporal;
+
+#endif
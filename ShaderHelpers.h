@@ -6,49 +6,57 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include <direct.h>
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Log.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "FrameArena.h"
+#include "GLDebug.h"
+#include "AssetArchive.h"
+#include "RemoteCache.h"
+#include "MemoryStats.h"
 
 /****************************************************************************
-* UTILITY FUNCTIONS: warning output, gl error checking                     *
+* UTILITY FUNCTIONS: gl error checking                                     *
 ****************************************************************************/
 
-/* Print a info message to stdout, use printf syntax. */
-static void info(const char *format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	vfprintf(stdout, format, args);
-	va_end(args);
-	fputc('\n', stdout);
-}
-
-/* Print a warning message to stderr, use printf syntax. */
-static void warn(const char *format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	vfprintf(stderr, format, args);
-	va_end(args);
-	fputc('\n', stderr);
-}
-
 /* Check for GL errors. If ignore is not set, print a warning if an error was
-* encountered.
+* encountered, and for GL_OUT_OF_MEMORY what the memory went to.
 * Returns GL_NO_ERROR if no errors were set. */
 static GLenum getGLError(const char *action, bool ignore = false, const char *file = NULL, const int line = 0)
 {
 	GLenum e, err = GL_NO_ERROR;
+	bool outOfMemory = false;
 
 	do {
 		e = glGetError();
 		if ((e != GL_NO_ERROR) && (!ignore)) {
 			err = e;
+			outOfMemory |= (e == GL_OUT_OF_MEMORY);
 			if (file)
-				fprintf(stderr, "%s:", file);
-			if (line)
-				fprintf(stderr, "%d:", line);
-			warn("GL error 0x%x at %s", (unsigned)err, action);
+				warn("%s:%d: GL error 0x%x at %s", file, line, (unsigned)err, action);
+			else
+				warn("GL error 0x%x at %s", (unsigned)err, action);
 		}
 	} while (e != GL_NO_ERROR);
+	if (outOfMemory)
+		memoryStats()->report();
 	return err;
 }
 
@@ -56,13 +64,74 @@ static GLenum getGLError(const char *action, bool ignore = false, const char *fi
 /* helper macros:
 * define GL_ERROR_DBG() to be present only in DEBUG builds. This way, you can
 * add error checks at strategic places without influencing the performance
-* of the RELEASE build */
+* of the RELEASE build. A context with debug output reports its errors
+* through glDebugCallback, which needs no polling (see GLDebug.h) */
 #ifdef NDEBUG
 #define GL_ERROR_DBG(action) (void)0
 #else
-#define GL_ERROR_DBG(action) getGLError(action, false, __FILE__, __LINE__)
+#define GL_ERROR_DBG(action) (glDebugReporting() ? (void)0 : (void)getGLError(action, false, __FILE__, __LINE__))
 #endif
 
+/* the binding point of the shared per-frame uniform block "Frame" */
+#define FRAME_UBO_BINDING 0
+
+/* the binding point of the uniform block "Materials" and the texture unit
+* of the sampler "materialTextures", see Materials.h */
+#define MATERIAL_UBO_BINDING 1
+#define MATERIAL_TEXTURE_UNIT 1
+
+/* the binding points of the uniform block "VirtualTexture" and the feedback
+* buffer and the texture units of the samplers "virtualTexture" and
+* "virtualMinLod", see VirtualTexture.h */
+#define VT_UBO_BINDING 2
+#define VT_FEEDBACK_BINDING 5	/* also in shaders/virtual.fs.glsl */
+#define VT_TEXTURE_UNIT 2
+#define VT_MIN_LOD_UNIT 3
+
+/* the binding point of the uniform block "SdfScene", see SdfScene.h, the
+* texture unit of the sampler "sdfDistances", see SdfBake.h, and of
+* "sdfConeDistances", see SdfCone.h, and the binding points of the storage
+* blocks "SdfField" and "SdfBvh", see SdfField.h */
+#define SDF_UBO_BINDING 3
+#define SDF_TEXTURE_UNIT 4
+#define SDF_CONE_TEXTURE_UNIT 5
+#define SDF_FIELD_BINDING 6
+#define SDF_BVH_BINDING 7
+
+/* the binding point of the storage block "Lights" of the material
+* shaders, see ClusteredLights.h */
+#define LIGHT_SSBO_BINDING 2
+
+/* the binding point of the storage block "Instances" of the cube shader
+* with vertex pulling, see Cube::drawPulled */
+#define CUBE_INSTANCE_SSBO_BINDING 4
+
+/* the binding point of the storage block "Displaced" of the cube shader
+* with the positions of Displacement.h; shared with "Instances", which the
+* displaced programs do not use, it is bound for each draw */
+#define CUBE_DISPLACED_SSBO_BINDING 4
+
+/* the binding point of the storage block "VoxelOctree" of the voxel
+* raymarching program, see VoxelOctree.h; shared with "Instances", both
+* are bound for each draw */
+#define VOXEL_OCTREE_SSBO_BINDING 4
+
+/* the binding points of the storage blocks "ParticlePositions" and
+* "ParticleOrder" of the particle quads, see Particles.h */
+#define PARTICLE_POSITION_BINDING 0
+#define PARTICLE_ORDER_BINDING 1
+
+/* the texture unit of the sampler "shadowMap" of the material shaders, see
+* ShadowMaps.h */
+#define SHADOW_TEXTURE_UNIT 6
+
+/* the image units of the per-pixel fragment lists of the translucent
+* programs, the images "oitHeads", "oitNodes" and "oitCounter", see
+* Transparency.h */
+#define OIT_HEADS_IMAGE_UNIT 0
+#define OIT_NODES_IMAGE_UNIT 1
+#define OIT_COUNTER_IMAGE_UNIT 2
+
 /* define BUFFER_OFFSET to specify offsets inside VBOs */
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
 
@@ -73,77 +142,112 @@ static GLenum getGLError(const char *action, bool ignore = false, const char *fi
 #define mysnprintf snprintf
 #endif
 
+/* define myMkdir to create a directory (existing ones are fine) */
+#ifdef WIN32
+#define myMkdir(path) _mkdir(path)
+#else
+#define myMkdir(path) mkdir(path, 0755)
+#endif
+
 /****************************************************************************
-* UTILITY FUNCTIONS: print information about the GL context                *
+* UTILITY FUNCTIONS: information about the GL context                      *
 ****************************************************************************/
 
-/* Print info about the OpenGL context */
-static void printGLInfo()
-{
-	/* get infos about the GL implementation */
-	info("OpenGL: %s %s %s",
-		glGetString(GL_VENDOR),
-		glGetString(GL_RENDERER),
-		glGetString(GL_VERSION));
-	info("OpenGL Shading language: %s",
-		glGetString(GL_SHADING_LANGUAGE_VERSION));
-}
-
-/* List all supported GL extensions */
-static void listGLExtensions()
+/* Check whether the GL extension name is supported, also for extensions
+* glad was not generated with and thus has no GLAD_GL_* flag for. The
+* extensions are those glad found when it loaded, see GLCaps.h. */
+static bool glExtensionSupported(const char *name)
 {
-	GLint num = 0;
-	GLuint i;
-	glGetIntegerv(GL_NUM_EXTENSIONS, &num);
-	info("GL extensions supported: %d", num);
-	if (num < 1) {
-		return;
-	}
-
-	for (i = 0; i<(GLuint)num; i++) {
-		const GLubyte *ext = glGetStringi(GL_EXTENSIONS, i);
-		if (ext) {
-			info("  %s", ext);
-		}
-	}
+	return gladHasExtension(name) != 0;
 }
 
 /****************************************************************************
 * SHADER COMPILATION AND LINKING                                           *
 ****************************************************************************/
 
-/* Print the info log of the shader compiler/linker.
+/* The buffer info logs are fetched into. It grows to the longest log seen
+* and is reused, so fetching a log usually does not allocate. Like the log
+* sink, it is shared by all translation units. */
+typedef struct {
+	char *data;
+	size_t capacity;
+} InfoLogBuffer;
+
+inline InfoLogBuffer *infoLogBuffer()
+{
+	static InfoLogBuffer buffer = { NULL, 0 };
+	return &buffer;
+}
+
+/* Free the info log buffer, e.g. when the GL context goes away. */
+static void infoLogRelease()
+{
+	InfoLogBuffer *buffer = infoLogBuffer();
+	free(buffer->data);
+	buffer->data = NULL;
+	buffer->capacity = 0;
+}
+
+/* Print the info log of the shader compiler/linker as a warning.
 * If program is true, obj is assumed to be a program object, otherwise, it
-* is assumed to be a shader object.
+* is assumed to be a shader object. Only the length is queried if the log
+* is empty.
 */
 static void printInfoLog(GLuint obj, bool program)
 {
-	char log[16384];
-	if (program) {
-		glGetProgramInfoLog(obj, 16384, 0, log);
-	}
-	else {
-		glGetShaderInfoLog(obj, 16384, 0, log);
+	InfoLogBuffer *buffer = infoLogBuffer();
+	GLint length = 0;
+	GLsizei written = 0;
+
+	if (program)
+		glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+	else
+		glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+	if (length <= 1)
+		return;		/* just the terminating NUL */
+	if ((size_t)length > buffer->capacity) {
+		frameHeapAlloc("the info log", (size_t)length);
+		char *data = (char*)realloc(buffer->data, (size_t)length);
+		if (!data) {
+			warn("failed to allocate %d bytes for the info log", (int)length);
+			return;
+		}
+		buffer->data = data;
+		buffer->capacity = (size_t)length;
 	}
-	log[16383] = 0;
-	fprintf(stderr, "%s\n", log);
+	if (program)
+		glGetProgramInfoLog(obj, length, &written, buffer->data);
+	else
+		glGetShaderInfoLog(obj, length, &written, buffer->data);
+	while (written > 0 && (buffer->data[written - 1] == '\n' || buffer->data[written - 1] == '\r'))
+		written--;
+	logWrite(LOG_LEVEL_WARN, buffer->data, (size_t)written);
 }
 
-/* Create a new shader object, attach "source" as source string,
-* and compile it.
-* Returns the name of the newly created shader object, or 0 in case of an
-* error.
+/* Create a new shader object, attach the count source strings of the given
+* lengths (NULL if they are NUL-terminated),
+* and start compiling it. The compile status is not queried, so with
+* parallel shader compilation the driver may still work on it when this
+* returns. Use shaderCheckCompiled to get the result.
+* Returns the name of the newly created shader object.
 */
-static  GLuint shaderCreateAndCompile(GLenum type, const GLchar *source)
+static GLuint shaderStartCompile(GLenum type, GLsizei count, const GLchar * const *sources, const GLint *lengths)
 {
-	GLuint shader = 0;
-	GLint status;
-
-	shader = glCreateShader(type);
+	GLuint shader = glCreateShader(type);
 	info("created shader object %u", shader);
-	glShaderSource(shader, 1, (const GLchar**)&source, NULL);
+	glShaderSource(shader, count, (const GLchar**)sources, lengths);
 	info("compiling shader object %u", shader);
 	glCompileShader(shader);
+	return shader;
+}
+
+/* Wait for the compilation of shader to finish and check the result.
+* In case of an error, the info log is printed and the shader is deleted.
+* Returns shader if successfull, or 0 in case of an error.
+*/
+static GLuint shaderCheckCompiled(GLuint shader)
+{
+	GLint status;
 
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 	if (status != GL_TRUE) {
@@ -152,103 +256,1316 @@ static  GLuint shaderCreateAndCompile(GLenum type, const GLchar *source)
 		glDeleteShader(shader);
 		shader = 0;
 	}
-
 	return shader;
 }
 
 
-/* Create a new shader object by loading a file, and compile it.
-* Returns the name of the newly created shader object, or 0 in case of an
-* error.
-*/
-static  GLuint shaderCreateFromFileAndCompile(GLenum type, const char *filename)
+/****************************************************************************
+* SHADER SOURCE FILES                                                      *
+****************************************************************************/
+
+/* Shader source files are memory-mapped instead of read into a buffer, and
+* the mapped range is handed to glShaderSource with an explicit length, so
+* loading a source neither allocates nor copies. A ShaderSourceCache keeps
+* the mappings alive and keyed by path, size and modification time, so
+* rebuilding a program from unchanged files does not touch the files again.
+* Note that a file truncated by an editor while it is mapped must not be
+* read; we check the time stamp right before every use.
+* If an asset archive is open (see AssetArchive.h), the files in there are
+* taken from it instead, and never checked again: they cannot change. */
+#define SHADER_SOURCE_CACHE_MAX 64
+#define SHADER_SOURCE_PATH 256
+#define SHADER_INCLUDE_MAX 16	/* #include directives per file */
+
+/* an #include directive, found by shaderSourceParse */
+typedef struct {
+	GLint begin, end;	/* the directive line, including its newline */
+	GLint line;		/* the number of the line after the directive */
+	GLint path, pathLength;	/* the included file name within the file */
+} ShaderInclude;
+
+typedef struct {
+	char path[SHADER_SOURCE_PATH];	/* empty if the slot is unused */
+	GLuint64 mtime;			/* platform specific time stamp */
+	GLuint64 size;
+	void *map;			/* NULL for empty files */
+	unsigned int lastUse;		/* for LRU eviction */
+	bool parsed;			/* includes are valid */
+	int includeCount;
+	ShaderInclude includes[SHADER_INCLUDE_MAX];
+	AssetData asset;		/* map, if it came from the asset archive */
+#ifdef WIN32
+	HANDLE mapping;
+#endif
+} ShaderSourceEntry;
+
+typedef struct {
+	ShaderSourceEntry entries[SHADER_SOURCE_CACHE_MAX];
+	unsigned int useCounter;
+	unsigned int hits, misses;
+} ShaderSourceCache;
+
+/* Get the time stamp and size of filename. Returns false if it does not
+* exist. */
+static bool shaderSourceStat(const char *filename, GLuint64 *mtime, GLuint64 *size)
 {
+#ifdef WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attr;
+	if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &attr))
+		return false;
+	*mtime = ((GLuint64)attr.ftLastWriteTime.dwHighDateTime << 32) | attr.ftLastWriteTime.dwLowDateTime;
+	*size = ((GLuint64)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+#else
+	struct stat st;
+	if (stat(filename, &st))
+		return false;
+#if defined(__APPLE__)
+	*mtime = (GLuint64)st.st_mtimespec.tv_sec * 1000000000ULL + (GLuint64)st.st_mtimespec.tv_nsec;
+#else
+	*mtime = (GLuint64)st.st_mtim.tv_sec * 1000000000ULL + (GLuint64)st.st_mtim.tv_nsec;
+#endif
+	*size = (GLuint64)st.st_size;
+#endif
+	return true;
+}
 
-	info("loading shader file '%s'", filename);
-	FILE *file = fopen(filename, "rt");
-	if (!file) {
+/* Release the mapping of a cache entry. */
+static void shaderSourceUnmap(ShaderSourceEntry *e)
+{
+	if (e->path[0])
+		memoryStats()->add(MEMORY_CPU, MEMORY_SHADERS, -(long long)e->size);
+	if (e->asset.data) {
+		assetDataRelease(&e->asset);
+	} else if (e->map) {
+#ifdef WIN32
+		UnmapViewOfFile(e->map);
+		CloseHandle(e->mapping);
+#else
+		munmap(e->map, (size_t)e->size);
+#endif
+	}
+	e->map = NULL;
+	e->path[0] = 0;
+	e->parsed = false;
+}
+
+/* Map filename into memory. Returns false in case of an error. */
+static bool shaderSourceMap(ShaderSourceEntry *e, const char *filename)
+{
+	e->map = NULL;
+	if (assetArchive()->read(filename, &e->asset)) {
+		if (e->asset.size > 0x7fffffff) {
+			warn("shader file '%s' is too large", filename);
+			assetDataRelease(&e->asset);
+			return false;
+		}
+		e->mtime = 0;
+		e->size = e->asset.size;
+		e->map = e->size ? (void*)e->asset.data : NULL;
+		mysnprintf(e->path, sizeof(e->path), "%s", filename);
+		memoryStats()->add(MEMORY_CPU, MEMORY_SHADERS, (long long)e->size);
+		return true;
+	}
+	if (!shaderSourceStat(filename, &e->mtime, &e->size)) {
 		warn("Failed to open shader file '%s'", filename);
-		return 0;
+		return false;
 	}
-	fseek(file, 0, SEEK_END);
-	long size = ftell(file);
-	GLchar *source = (GLchar*)malloc(size + 1);
-	if (!source) {
-		warn("Failed to allocate memory for shader file '%s'", filename);
-		fclose(file);
-		return 0;
+	if (e->size > 0x7fffffff) {
+		warn("shader file '%s' is too large", filename);
+		return false;
 	}
-	fseek(file, 0, SEEK_SET);
-	source[fread(source, 1, size, file)] = 0;
-	fclose(file);
+	if (e->size) {
+#ifdef WIN32
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			warn("Failed to open shader file '%s'", filename);
+			return false;
+		}
+		e->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (e->mapping)
+			e->map = MapViewOfFile(e->mapping, FILE_MAP_READ, 0, 0, (SIZE_T)e->size);
+		if (!e->map) {
+			if (e->mapping)
+				CloseHandle(e->mapping);
+			warn("Failed to map shader file '%s'", filename);
+			return false;
+		}
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) {
+			warn("Failed to open shader file '%s'", filename);
+			return false;
+		}
+		void *map = mmap(NULL, (size_t)e->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (map == MAP_FAILED) {
+			warn("Failed to map shader file '%s'", filename);
+			return false;
+		}
+		e->map = map;
+#endif
+	}
+	mysnprintf(e->path, sizeof(e->path), "%s", filename);
+	memoryStats()->add(MEMORY_CPU, MEMORY_SHADERS, (long long)e->size);
+	return true;
+}
 
-	GLuint shader = shaderCreateAndCompile(type, source);
-	free(source);
-	return shader;
+static void shaderSourceCacheInit(ShaderSourceCache *cache)
+{
+	int i;
+	for (i = 0; i < SHADER_SOURCE_CACHE_MAX; i++) {
+		cache->entries[i].path[0] = 0;
+		cache->entries[i].map = NULL;
+		cache->entries[i].lastUse = 0;
+		cache->entries[i].parsed = false;
+		cache->entries[i].asset.data = NULL;
+		cache->entries[i].asset.owned = NULL;
+	}
+	cache->useCounter = 0;
+	cache->hits = cache->misses = 0;
+}
+
+static void shaderSourceCacheDestroy(ShaderSourceCache *cache)
+{
+	int i;
+	for (i = 0; i < SHADER_SOURCE_CACHE_MAX; i++)
+		shaderSourceUnmap(&cache->entries[i]);
+}
+
+/* Get the cache entry of the shader source file filename, mapping it if it
+* is not cached or changed. The entry stays valid until the file changes and
+* is requested again, or until more than SHADER_SOURCE_CACHE_MAX - 1 other
+* files are requested.
+* Returns NULL in case of an error. */
+static ShaderSourceEntry *shaderSourceLookup(ShaderSourceCache *cache, const char *filename)
+{
+	ShaderSourceEntry *e = NULL, *victim = NULL;
+	GLuint64 mtime, size;
+	int i;
+
+	if (strlen(filename) >= SHADER_SOURCE_PATH) {
+		warn("shader file name '%s' is too long", filename);
+		return NULL;
+	}
+	for (i = 0; i < SHADER_SOURCE_CACHE_MAX; i++) {
+		ShaderSourceEntry *c = &cache->entries[i];
+		if (c->path[0] && !strcmp(c->path, filename)) {
+			e = c;
+			break;
+		}
+		if (!victim || !c->path[0] || (victim->path[0] && c->lastUse < victim->lastUse))
+			victim = c;
+	}
+
+	if (e && !e->asset.data && (!shaderSourceStat(filename, &mtime, &size) || mtime != e->mtime || size != e->size)) {
+		/* the file changed since we mapped it */
+		shaderSourceUnmap(e);
+		victim = e;
+		e = NULL;
+	}
+	if (e) {
+		cache->hits++;
+	} else {
+		cache->misses++;
+		shaderSourceUnmap(victim);
+		info("mapping shader file '%s'", filename);
+		if (!shaderSourceMap(victim, filename))
+			return NULL;
+		e = victim;
+	}
+	e->lastUse = ++cache->useCounter;
+	return e;
+}
+
+/****************************************************************************
+* SHADER INCLUDES                                                          *
+****************************************************************************/
+
+/* Shader files may contain lines of the form
+*     #include "file"
+* which are resolved relative to the including file. Instead of building one
+* big concatenated string, a shader is expanded into a ShaderSourceList:
+* the ranges of the mapped files between the directives, in order, which are
+* handed to glShaderSource as a multi-string array. Every file is mapped
+* and scanned for directives only once while it is cached, so headers shared
+* by many shaders cost nothing after their first use. Each file is included
+* at most once per shader, which also breaks include cycles. #line
+* directives keep the line numbers of compiler messages right; the source
+* string number in these messages is the index into files. The directives
+* are found line by line, comments are not taken into account. */
+#define SHADER_SOURCE_MAX_STRINGS 64
+#define SHADER_SOURCE_MAX_FILES 16
+#define SHADER_INCLUDE_DEPTH 8
+
+typedef struct {
+	const GLchar *strings[SHADER_SOURCE_MAX_STRINGS];
+	GLint lengths[SHADER_SOURCE_MAX_STRINGS];
+	int count;
+	char files[SHADER_SOURCE_MAX_FILES][SHADER_SOURCE_PATH];
+	int fileCount;
+	char lines[SHADER_SOURCE_MAX_STRINGS][32];	/* storage for #line directives */
+	int lineCount;
+} ShaderSourceList;
+
+/* Find the #include directives of a mapped file. */
+static bool shaderSourceParse(ShaderSourceEntry *e)
+{
+	const GLchar *data = e->map ? (const GLchar*)e->map : "";
+	GLint size = (GLint)e->size;
+	GLint pos = 0, line = 1;
+
+	e->includeCount = 0;
+	while (pos < size) {
+		GLint begin = pos, end, p;
+
+		/* find the end of the line */
+		for (end = pos; end < size && data[end] != '\n'; end++);
+		if (end < size)
+			end++;
+		line++;
+		pos = end;
+
+		p = begin;
+		while (p < end && (data[p] == ' ' || data[p] == '\t'))
+			p++;
+		if (p >= end || data[p] != '#')
+			continue;
+		p++;
+		while (p < end && (data[p] == ' ' || data[p] == '\t'))
+			p++;
+		if (end - p < 7 || strncmp(data + p, "include", 7))
+			continue;
+		p += 7;
+		while (p < end && (data[p] == ' ' || data[p] == '\t'))
+			p++;
+		if (p >= end || (data[p] != '"' && data[p] != '<')) {
+			warn("%s:%d: malformed #include", e->path, (int)line - 1);
+			return false;
+		}
+		GLchar close = (data[p] == '"') ? '"' : '>';
+		GLint name = ++p;
+		while (p < end && data[p] != close)
+			p++;
+		if (p >= end || p == name) {
+			warn("%s:%d: malformed #include", e->path, (int)line - 1);
+			return false;
+		}
+		if (e->includeCount >= SHADER_INCLUDE_MAX) {
+			warn("%s: too many #include directives", e->path);
+			return false;
+		}
+		ShaderInclude *inc = &e->includes[e->includeCount++];
+		inc->begin = begin;
+		inc->end = end;
+		inc->line = line;
+		inc->path = name;
+		inc->pathLength = p - name;
+	}
+	e->parsed = true;
+	return true;
+}
+
+static bool shaderSourceListAdd(ShaderSourceList *list, const GLchar *str, GLint length)
+{
+	if (!length)
+		return true;
+	if (list->count >= SHADER_SOURCE_MAX_STRINGS) {
+		warn("shader '%s' has too many source strings", list->files[0]);
+		return false;
+	}
+	list->strings[list->count] = str;
+	list->lengths[list->count] = length;
+	list->count++;
+	return true;
+}
+
+/* Add a #line directive setting the next line to line of file. */
+static bool shaderSourceListAddLine(ShaderSourceList *list, GLint line, int file)
+{
+	if (list->lineCount >= SHADER_SOURCE_MAX_STRINGS)
+		return false;
+	char *str = list->lines[list->lineCount++];
+	mysnprintf(str, sizeof(list->lines[0]), "\n#line %d %d\n", (int)line, file);
+	return shaderSourceListAdd(list, str, (GLint)strlen(str));
+}
+
+static bool shaderSourceExpandFile(ShaderSourceCache *cache, ShaderSourceList *list, const char *filename, int depth)
+{
+	int i, file;
+
+	for (i = 0; i < list->fileCount; i++)
+		if (!strcmp(list->files[i], filename))
+			return true;
+	if (depth > SHADER_INCLUDE_DEPTH) {
+		warn("shader includes nested too deeply at '%s'", filename);
+		return false;
+	}
+	if (list->fileCount >= SHADER_SOURCE_MAX_FILES) {
+		warn("shader '%s' includes too many files", list->files[0]);
+		return false;
+	}
+	ShaderSourceEntry *e = shaderSourceLookup(cache, filename);
+	if (!e || (!e->parsed && !shaderSourceParse(e)))
+		return false;
+	file = list->fileCount++;
+	mysnprintf(list->files[file], SHADER_SOURCE_PATH, "%s", filename);
+
+	const GLchar *data = e->map ? (const GLchar*)e->map : "";
+	GLint pos = 0;
+	if (file && !shaderSourceListAddLine(list, 1, file))
+		return false;
+	for (i = 0; i < e->includeCount; i++) {
+		const ShaderInclude *inc = &e->includes[i];
+		char path[SHADER_SOURCE_PATH];
+		const char *slash = strrchr(filename, '/');
+		int dirLength = slash ? (int)(slash - filename) + 1 : 0;
+
+		if (dirLength + inc->pathLength >= SHADER_SOURCE_PATH) {
+			warn("%s:%d: included file name is too long", filename, (int)inc->line - 1);
+			return false;
+		}
+		memcpy(path, filename, dirLength);
+		memcpy(path + dirLength, data + inc->path, inc->pathLength);
+		path[dirLength + inc->pathLength] = 0;
+
+		if (!shaderSourceListAdd(list, data + pos, inc->begin - pos) ||
+			!shaderSourceExpandFile(cache, list, path, depth + 1) ||
+			!shaderSourceListAddLine(list, inc->line, file))
+			return false;
+		pos = inc->end;
+	}
+	return shaderSourceListAdd(list, data + pos, (GLint)e->size - pos);
+}
+
+/* Expand the shader source file filename and everything it includes into
+* list. The strings stay valid as long as the files are cached, see
+* shaderSourceLookup. Returns false in case of an error. */
+static bool shaderSourceExpand(ShaderSourceCache *cache, ShaderSourceList *list, const char *filename)
+{
+	list->count = list->fileCount = list->lineCount = 0;
+	return shaderSourceExpandFile(cache, list, filename, 0);
+}
+
+/****************************************************************************
+* SHADER PERMUTATIONS                                                      *
+****************************************************************************/
+
+/* A permutation of a shader is selected by a bit mask of feature defines:
+* for every bit i set in the mask, "#define names[i] 1" is inserted right
+* after the #version line, so the shader can drop unused features with #ifdef
+* at compile time. The defines are part of the source strings and therefore
+* of the program cache key, so every permutation has its own cache entry.
+* Some builds also insert constants, lines of GLSL after the defines, e.g.
+* the uniform values UniformSpecializer.h bakes in, which go into the key
+* the same way. */
+#define SHADER_DEFINES_MAX 32
+#define SHADER_DEFINES_LENGTH 2048
+
+/* Write the define block for mask, followed by constants if that is not
+* NULL, into buf. line is the number of the line after the #version
+* directive. Returns the length, or -1 if buf is too small. */
+static int shaderDefinesFormat(char *buf, size_t size, const char * const *names, int count, unsigned int mask, int line,
+	const char *constants = NULL)
+{
+	size_t len = 0;
+	int i, n;
+
+	for (i = 0; i < count && i < SHADER_DEFINES_MAX; i++) {
+		if (!(mask & (1u << i)))
+			continue;
+		n = mysnprintf(buf + len, size - len, "#define %s 1\n", names[i]);
+		if (n < 0 || (size_t)n >= size - len)
+			return -1;
+		len += (size_t)n;
+	}
+	if (constants) {
+		n = mysnprintf(buf + len, size - len, "%s", constants);
+		if (n < 0 || (size_t)n >= size - len)
+			return -1;
+		len += (size_t)n;
+	}
+	if (!len)
+		return 0;
+	n = mysnprintf(buf + len, size - len, "#line %d 0\n", line);
+	if (n < 0 || (size_t)n >= size - len)
+		return -1;
+	return (int)(len + (size_t)n);
 }
 
+/* Insert the feature defines for mask, and the constants if given, after
+* the #version line of an expanded shader. buf must stay valid until the
+* strings are passed to GL.
+* Returns false in case of an error. */
+static bool shaderSourceInjectDefines(ShaderSourceList *list, const char * const *names, int count,
+	unsigned int mask, char *buf, size_t size, const char *constants = NULL)
+{
+	GLint split = 0, i;
+	int line = 1, length;
+
+	if ((!mask && !constants) || !list->count)
+		return true;
+
+	/* the #version directive must stay in front, it is on the first
+	* non-empty line if there is one */
+	const GLchar *str = list->strings[0];
+	GLint len = list->lengths[0];
+	GLint p = 0;
+	while (p < len && (str[p] == ' ' || str[p] == '\t' || str[p] == '\r' || str[p] == '\n')) {
+		if (str[p] == '\n')
+			line++;
+		p++;
+	}
+	if (len - p >= 8 && !strncmp(str + p, "#version", 8)) {
+		for (split = p; split < len && str[split] != '\n'; split++);
+		if (split < len)
+			split++;
+		line++;
+	} else {
+		line = 1;
+	}
+
+	length = shaderDefinesFormat(buf, size, names, count, mask, line, constants);
+	if (length < 0) {
+		warn("shader '%s': too many defines", list->files[0]);
+		return false;
+	}
+	if (!length)
+		return true;
+	if (list->count + 2 > SHADER_SOURCE_MAX_STRINGS) {
+		warn("shader '%s' has too many source strings", list->files[0]);
+		return false;
+	}
 
+	/* [0, split) + defines + [split, len) + the rest */
+	for (i = list->count - 1; i >= 1; i--) {
+		list->strings[i + 2] = list->strings[i];
+		list->lengths[i + 2] = list->lengths[i];
+	}
+	list->lengths[0] = split;
+	list->strings[1] = buf;
+	list->lengths[1] = (GLint)length;
+	list->strings[2] = str + split;
+	list->lengths[2] = len - split;
+	list->count += 2;
+	return true;
+}
 
-/* Create a program by linking a vertex and fragment shader object. The shader
-* objects should already be compiled.
-* Returns the name of the newly created program object, or 0 in case of an
-* error.
+/* Set up the state of a freshly linked program which is not stored in the
+* program binary, so this is needed for source- and binary-created programs.
 */
-static GLuint programCreate(GLuint vertex_shader, GLuint fragment_shader)
+static void programSetupLinked(GLuint program)
 {
-	GLuint program = 0;
-	GLint status;
+	/* all programs read the per-frame state from the same binding point,
+	* so switching programs does not require re-uploading anything */
+	GLuint frameBlock = glGetUniformBlockIndex(program, "Frame");
+	if (frameBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, frameBlock, FRAME_UBO_BINDING);
 
-	program = glCreateProgram();
+	/* the same for the materials without bindless textures, see
+	* Materials.h (the bindless ones declare their binding) */
+	GLuint materialBlock = glGetUniformBlockIndex(program, "Materials");
+	if (materialBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, materialBlock, MATERIAL_UBO_BINDING);
+	GLint materialTextures = glGetUniformLocation(program, "materialTextures");
+	if (materialTextures >= 0) {
+		glState()->useProgram(program);
+		glUniform1i(materialTextures, MATERIAL_TEXTURE_UNIT);
+	}
+
+	/* and for the virtual texture, see VirtualTexture.h */
+	GLuint virtualBlock = glGetUniformBlockIndex(program, "VirtualTexture");
+	if (virtualBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, virtualBlock, VT_UBO_BINDING);
+	GLint virtualTexture = glGetUniformLocation(program, "virtualTexture");
+	GLint virtualMinLod = glGetUniformLocation(program, "virtualMinLod");
+	if (virtualTexture >= 0 || virtualMinLod >= 0) {
+		glState()->useProgram(program);
+		glUniform1i(virtualTexture, VT_TEXTURE_UNIT);
+		glUniform1i(virtualMinLod, VT_MIN_LOD_UNIT);
+	}
+
+	/* and for the raymarched scene, see SdfScene.h */
+	GLuint sdfBlock = glGetUniformBlockIndex(program, "SdfScene");
+	if (sdfBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, sdfBlock, SDF_UBO_BINDING);
+	GLint sdfDistances = glGetUniformLocation(program, "sdfDistances");
+	if (sdfDistances >= 0) {
+		glState()->useProgram(program);
+		glUniform1i(sdfDistances, SDF_TEXTURE_UNIT);
+	}
+	GLint sdfConeDistances = glGetUniformLocation(program, "sdfConeDistances");
+	if (sdfConeDistances >= 0) {
+		glState()->useProgram(program);
+		glUniform1i(sdfConeDistances, SDF_CONE_TEXTURE_UNIT);
+	}
+	/* and for the shadows of the lit materials, see ShadowMaps.h */
+	GLint shadowMap = glGetUniformLocation(program, "shadowMap");
+	if (shadowMap >= 0) {
+		glState()->useProgram(program);
+		glUniform1i(shadowMap, SHADOW_TEXTURE_UNIT);
+	}
+
+	/* the programs before GL 4.3 cannot declare the storage blocks'
+	* bindings themselves */
+	if (glShaderStorageBlockBinding && glGetProgramResourceIndex) {
+		GLuint fieldBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "SdfField");
+		GLuint bvhBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "SdfBvh");
+		if (fieldBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, fieldBlock, SDF_FIELD_BINDING);
+		if (bvhBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, bvhBlock, SDF_BVH_BINDING);
+		GLuint lightBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "Lights");
+		if (lightBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, lightBlock, LIGHT_SSBO_BINDING);
+		GLuint instanceBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "Instances");
+		if (instanceBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, instanceBlock, CUBE_INSTANCE_SSBO_BINDING);
+		GLuint displacedBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "Displaced");
+		if (displacedBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, displacedBlock, CUBE_DISPLACED_SSBO_BINDING);
+		GLuint voxelBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "VoxelOctree");
+		if (voxelBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, voxelBlock, VOXEL_OCTREE_SSBO_BINDING);
+		GLuint positionBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "ParticlePositions");
+		GLuint orderBlock = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "ParticleOrder");
+		if (positionBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, positionBlock, PARTICLE_POSITION_BINDING);
+		if (orderBlock != GL_INVALID_INDEX)
+			glShaderStorageBlockBinding(program, orderBlock, PARTICLE_ORDER_BINDING);
+	}
+
+	/* and for the fragment lists of the translucent programs */
+	GLint oitHeads = glGetUniformLocation(program, "oitHeads");
+	GLint oitNodes = glGetUniformLocation(program, "oitNodes");
+	GLint oitCounter = glGetUniformLocation(program, "oitCounter");
+	if (oitHeads >= 0 || oitNodes >= 0 || oitCounter >= 0) {
+		glState()->useProgram(program);
+		glUniform1i(oitHeads, OIT_HEADS_IMAGE_UNIT);
+		glUniform1i(oitNodes, OIT_NODES_IMAGE_UNIT);
+		glUniform1i(oitCounter, OIT_COUNTER_IMAGE_UNIT);
+	}
+
+	/* what the driver keeps of the program is about its binary, see
+	* MemoryStats.h */
+	GLint binaryLength = 0;
+	if (glGetProgramBinary)
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	memoryStats()->setObject(MEMORY_PROGRAM, program, binaryLength, MEMORY_SHADERS);
+}
+
+/* Create a program from a vertex and fragment shader object, and the
+* tessellation shader objects if they are not 0, and start linking it. The
+* link status is not queried, use programCheckLinked to get the result. The
+* shader objects should already be compiled.
+* Returns the name of the newly created program object.
+*/
+static GLuint programStartLink(GLuint vertex_shader, GLuint fragment_shader, bool separable = false,
+	GLuint control_shader = 0, GLuint evaluation_shader = 0)
+{
+	GLuint program = glCreateProgram();
 	info("created program %u", program);
 
+	/* separable programs may contain a single stage, see SEPARABLE PROGRAMS */
+	if (separable)
+		glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+
 	if (vertex_shader)
 		glAttachShader(program, vertex_shader);
 	if (fragment_shader)
 		glAttachShader(program, fragment_shader);
+	if (control_shader)
+		glAttachShader(program, control_shader);
+	if (evaluation_shader)
+		glAttachShader(program, evaluation_shader);
 
 	/* hard-code the attribute indices for the attributeds we use */
 	glBindAttribLocation(program, 0, "pos");
 	glBindAttribLocation(program, 1, "nrm");
 	glBindAttribLocation(program, 2, "clr");
 	glBindAttribLocation(program, 3, "tex");
+	/* per-instance model matrix, uses locations 4 to 7 */
+	glBindAttribLocation(program, 4, "instModel");
+	/* or the packed instance, see Cube::drawCompact */
+	glBindAttribLocation(program, 4, "instCompact");
+	/* per-instance material index, see MESH_ATTRIB_MATERIAL */
+	glBindAttribLocation(program, 8, "instMaterial");
+	/* per-instance entity id, see MESH_ATTRIB_OBJECT */
+	glBindAttribLocation(program, 9, "instObject");
 
 	/* hard-code the color number of the fragment shader output */
 	glBindFragDataLocation(program, 0, "color");
+	/* the second one of the raymarching program, see SdfTemporal.h */
+	glBindFragDataLocation(program, 1, "sdfDepth");
+	/* and that of the translucent programs, see Transparency.h */
+	glBindFragDataLocation(program, 1, "revealage");
+	/* and the object ids of the picking, see Picking.h */
+	glBindFragDataLocation(program, 1, "pickId");
+
+	/* allow the program binary cache to retrieve the binary later on */
+	if (glProgramParameteri)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
 	/* finally link the program */
 	info("linking program %u", program);
 	glLinkProgram(program);
+	return program;
+}
+
+/* Wait for linking of program to finish and check the result. In case of
+* an error, the info log is printed and the program is deleted.
+* Returns program if successfull, or 0 in case of an error.
+*/
+static GLuint programCheckLinked(GLuint program)
+{
+	GLint status;
 
 	glGetProgramiv(program, GL_LINK_STATUS, &status);
 	if (status != GL_TRUE) {
 		warn("Failed to link program!");
 		printInfoLog(program, true);
-		glDeleteProgram(program);
+		glState()->deleteProgram(program);
 		return 0;
 	}
+
+	programSetupLinked(program);
 	return program;
 }
 
 
-/* Create a program object directly from vertex and fragment shader source
-* files.
-* Returns the name of the newly created program object, or 0 in case of an
-* error.
-*/
-static GLenum programCreateFromFiles(const char *vs, const char *fs)
-{
-	GLuint id_vs = shaderCreateFromFileAndCompile(GL_VERTEX_SHADER, vs);
-	GLuint id_fs = shaderCreateFromFileAndCompile(GL_FRAGMENT_SHADER, fs);
-	GLuint program = programCreate(id_vs, id_fs);
-	/* Delete the shader objects. Since they are still in use in the
-	* program object, OpenGL will not destroy them internally until
-	* the program object is destroyed. The caller of this function
-	* does not need to care about the shader objects at all. */
-	info("destroying shader object %u", id_vs);
-	glDeleteShader(id_vs);
-	info("destroying shader object %u", id_fs);
-	glDeleteShader(id_fs);
+/****************************************************************************
+* PROGRAM BINARY CACHE                                                     *
+****************************************************************************/
+
+/* Linked programs are stored in SHADER_CACHE_DIR via glGetProgramBinary and
+* reloaded with glProgramBinary on the next run. The key is a hash of all
+* shader sources plus the GL_RENDERER and GL_VERSION strings, so a driver
+* update or a different GPU never picks up a stale binary. If the driver
+* rejects a cached binary anyway, we silently compile from source again. */
+#ifndef SHADER_CACHE_DIR
+#define SHADER_CACHE_DIR "shadercache"
+#endif
+
+/* magic number at the start of each cache file */
+#define SHADER_CACHE_MAGIC 0x42504348u /* "HCPB" */
+
+/* hashFNV1a is in AssetArchive.h */
+
+/* With --program-cache, the entries are shared with other machines through
+* remoteProgramCache() (see RemoteCache.h): ProgramRegistry::prefetch()
+* downloads those which are missing before the programs are built, and each
+* entry stored here is uploaded. */
+
+/* Returns true if the context can give us program binaries. */
+static bool programCacheSupported()
+{
+	GLint formats = 0;
+	if (!glGetProgramBinary || !glProgramBinary)
+		return false;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return (formats > 0);
+}
+
+/* Compute the cache key for a program built from count source strings of
+* the given lengths. */
+static GLuint64 programCacheKey(const GLchar * const *sources, const GLint *lengths, int count)
+{
+	GLuint64 h = HASH_FNV1A_INIT;
+	const char *renderer = (const char*)glGetString(GL_RENDERER);
+	const char *version = (const char*)glGetString(GL_VERSION);
+	int i;
+
+	if (renderer)
+		h = hashFNV1a(renderer, strlen(renderer), h);
+	if (version)
+		h = hashFNV1a(version, strlen(version), h);
+	for (i = 0; i < count; i++) {
+		/* include the length so that the split between sources counts */
+		h = hashFNV1a(&lengths[i], sizeof(lengths[i]), h);
+		h = hashFNV1a(sources[i], (size_t)lengths[i], h);
+	}
+	return h;
+}
+
+/* Build the file name of a cache entry. */
+static void programCacheFilename(char *buf, size_t size, GLuint64 key)
+{
+	mysnprintf(buf, size, SHADER_CACHE_DIR "/%08x%08x.bin",
+		(unsigned)(key >> 32), (unsigned)(key & 0xffffffffu));
+}
+
+/* Returns true if the size bytes of data are a cache entry, the check for
+* the entries of the remote cache. Whether the binary is any good only the
+* driver can tell. */
+static bool programCacheValid(const unsigned char *data, size_t size)
+{
+	unsigned int header[3];
+	if (size < sizeof(header))
+		return false;
+	memcpy(header, data, sizeof(header));
+	return header[0] == SHADER_CACHE_MAGIC && header[2] > 0 && (size_t)header[2] == size - sizeof(header);
+}
+
+/* Try to create a program from the cache entry for key.
+* Returns the name of the program, or 0 if there is no usable entry. */
+static GLuint programCacheLoad(GLuint64 key)
+{
+	char filename[256];
+	unsigned int header[3];
+	GLuint program;
+	GLint status;
+	void *binary;
+	FILE *file;
+
+	if (!programCacheSupported())
+		return 0;
+
+	programCacheFilename(filename, sizeof(filename), key);
+	file = fopen(filename, "rb");
+	if (!file)
+		return 0;
+
+	/* header: magic, binary format, binary length */
+	if (fread(header, sizeof(header), 1, file) != 1 || header[0] != SHADER_CACHE_MAGIC) {
+		warn("ignoring invalid shader cache file '%s'", filename);
+		fclose(file);
+		return 0;
+	}
+	binary = malloc(header[2]);
+	if (!binary || fread(binary, 1, header[2], file) != header[2]) {
+		warn("failed to read shader cache file '%s'", filename);
+		free(binary);
+		fclose(file);
+		return 0;
+	}
+	fclose(file);
+
+	program = glCreateProgram();
+	glProgramBinary(program, (GLenum)header[1], binary, (GLsizei)header[2]);
+	free(binary);
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE) {
+		/* typically the driver was updated in a way the renderer and
+		* version strings do not reflect, just build from source again */
+		info("cached program binary '%s' was rejected", filename);
+		glState()->deleteProgram(program);
+		return 0;
+	}
+
+	programSetupLinked(program);
+	info("created program %u from cache file '%s'", program, filename);
+	return program;
+}
+
+/* Store the binary of a linked program as the cache entry for key. */
+static void programCacheStore(GLuint64 key, GLuint program)
+{
+	char filename[256];
+	unsigned int header[3];
+	GLint length = 0;
+	GLenum format = 0;
+	void *binary;
+	FILE *file;
+
+	if (!programCacheSupported())
+		return;
+
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length < 1)
+		return;
+	binary = malloc(length);
+	if (!binary)
+		return;
+	glGetProgramBinary(program, length, &length, &format, binary);
+
+	programCacheFilename(filename, sizeof(filename), key);
+	myMkdir(SHADER_CACHE_DIR);
+	file = fopen(filename, "wb");
+	if (!file) {
+		warn("failed to write shader cache file '%s'", filename);
+		free(binary);
+		return;
+	}
+	header[0] = SHADER_CACHE_MAGIC;
+	header[1] = (unsigned int)format;
+	header[2] = (unsigned int)length;
+	bool ok = fwrite(header, sizeof(header), 1, file) == 1 && fwrite(binary, 1, length, file) == (size_t)length;
+	if (fclose(file) || !ok) {
+		warn("failed to write shader cache file '%s'", filename);
+		remove(filename);
+		free(binary);
+		return;
+	}
+	free(binary);
+	info("stored program %u in cache file '%s' (%d bytes)", program, filename, (int)length);
+	remoteProgramCache()->upload(filename);
+}
+
+/****************************************************************************
+* SPIR-V MODULES                                                           *
+****************************************************************************/
+
+/* With GL_ARB_gl_spirv, a shader stage can be loaded from a precompiled
+* SPIR-V module, which skips the GLSL front end of the driver. The module of
+* a stage is looked up next to its GLSL file ("cube.vs.glsl" becomes
+* "cube.vs.spv"); if there is none, or it fails to specialize, the GLSL
+* source is compiled as usual. A module cannot be given #defines, so bit i
+* of the feature define mask sets the boolean specialization constant with
+* constant_id i instead, e.g. "layout(constant_id = 1) const bool CUT = false;".
+* Only the set bits are passed, so a module must declare a constant for
+* every feature its permutations use. */
+
+/* Returns true if the context can load SPIR-V modules. */
+static bool spirvSupported()
+{
+	return glCaps()->spirv;
+}
+
+/* Get the name of the SPIR-V module belonging to the GLSL file filename.
+* Returns false if filename does not end in ".glsl". */
+static bool spirvModuleFilename(char *buf, size_t size, const char *filename)
+{
+	size_t len = strlen(filename);
+	if (len < 5 || strcmp(filename + len - 5, ".glsl") || len >= size)
+		return false;
+	mysnprintf(buf, size, "%.*s.spv", (int)(len - 5), filename);
+	return true;
+}
+
+/* Get the SPIR-V module of the GLSL file filename from cache.
+* Returns NULL if there is no (usable) module. */
+static ShaderSourceEntry *spirvModuleLookup(ShaderSourceCache *cache, const char *filename)
+{
+	char name[SHADER_SOURCE_PATH];
+	GLuint64 mtime, size;
+
+	if (!spirvModuleFilename(name, sizeof(name), filename) ||
+		(!assetArchive()->find(name) && !shaderSourceStat(name, &mtime, &size)))
+		return NULL;
+	ShaderSourceEntry *e = shaderSourceLookup(cache, name);
+	if (e && (!e->size || (e->size & 3))) {
+		warn("'%s' is not a SPIR-V module", name);
+		return NULL;
+	}
+	return e;
+}
+
+/* Create a shader of type from module, specialized for the feature define
+* mask defines. Unlike GLSL compilation, specialization finishes right away.
+* Returns the name of the shader, or 0 in case of an error. */
+static GLuint shaderFromSpirv(GLenum type, const ShaderSourceEntry *module, unsigned int defines)
+{
+	GLuint ids[SHADER_DEFINES_MAX], values[SHADER_DEFINES_MAX];
+	GLuint i, count = 0;
+	GLint status = GL_FALSE;
+
+	for (i = 0; i < SHADER_DEFINES_MAX; i++) {
+		if (defines & (1u << i)) {
+			ids[count] = i;
+			values[count++] = GL_TRUE;
+		}
+	}
+	GLuint shader = glCreateShader(type);
+	glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, module->map, (GLsizei)module->size);
+	glSpecializeShaderARB(shader, "main", count, ids, values);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE) {
+		warn("Failed to specialize SPIR-V module '%s'", module->path);
+		printInfoLog(shader, false);
+		glDeleteShader(shader);
+		return 0;
+	}
+	info("specialized SPIR-V module '%s' as shader %u", module->path, shader);
+	return shader;
+}
+
+/* Start compiling a stage of type: from module if it is not NULL, and from
+* the expanded GLSL source src if there is no module or it failed, in which
+* case *fallback is set.
+* Returns the name of the shader. */
+static GLuint stageStartCompile(GLenum type, const ShaderSourceEntry *module, const ShaderSourceList *src,
+	unsigned int defines, bool *fallback)
+{
+	if (module) {
+		GLuint shader = shaderFromSpirv(type, module, defines);
+		if (shader)
+			return shader;
+		*fallback = true;
+	}
+	return shaderStartCompile(type, src->count, src->strings, src->lengths);
+}
+
+/****************************************************************************
+* ASYNCHRONOUS PROGRAM BUILDS                                              *
+****************************************************************************/
+
+/* With GL_ARB_parallel_shader_compile (the same as KHR_parallel_shader_compile)
+* the driver compiles and links on its own threads, and we can ask whether
+* it is done via GL_COMPLETION_STATUS_ARB without blocking. A ProgramBuild
+* is advanced by programBuildPoll once per frame, so the frame loop never
+* waits for the compiler. Without the extension, the first poll simply
+* finishes the build synchronously. */
+enum {
+	PROGRAM_BUILD_IDLE = 0,		/* nothing in flight */
+	PROGRAM_BUILD_COMPILING,	/* waiting for the shader objects */
+	PROGRAM_BUILD_LINKING,		/* waiting for the program object */
+	PROGRAM_BUILD_DONE,		/* program is ready */
+	PROGRAM_BUILD_FAILED		/* something went wrong */
+};
+
+typedef struct {
+	int state;
+	GLuint vs, fs;		/* shader objects while compiling */
+	GLuint program;		/* the resulting program */
+	GLuint64 cacheKey;	/* key for the program binary cache, 0 for none */
+	bool separable;		/* a single-stage program for a pipeline */
+	char label[GL_DEBUG_LABEL_MAX];	/* of the program, after its sources */
+} ProgramBuild;
+
+/* Returns true if the driver compiles in the background. */
+static bool parallelShaderCompileSupported()
+{
+	return glCaps()->parallelShaderCompile;
+}
+
+/* Returns true if the shader or program obj has finished compiling or
+* linking. Never blocks. */
+static bool objectBuildComplete(GLuint obj, bool program)
+{
+	GLint done = GL_TRUE;
+	if (parallelShaderCompileSupported()) {
+		if (program)
+			glGetProgramiv(obj, GL_COMPLETION_STATUS_ARB, &done);
+		else
+			glGetShaderiv(obj, GL_COMPLETION_STATUS_ARB, &done);
+	}
+	return (done == GL_TRUE);
+}
+
+/* The sources of a program, as they go into its cache key and to the
+* compiler. */
+typedef struct {
+	ShaderSourceList src[2];	/* the expanded GLSL of each stage */
+	ShaderSourceEntry *module[2];	/* the SPIR-V module used instead, or NULL */
+	char defineText[2][SHADER_DEFINES_LENGTH];
+	char moduleKey[2][32];
+	const GLchar *strings[2 * SHADER_SOURCE_MAX_STRINGS];	/* all of them, for the key */
+	GLint lengths[2 * SHADER_SOURCE_MAX_STRINGS];
+	int count;
+} ProgramSources;
+
+/* Gather the sources of the program of vertex and fragment shader source
+* files vs and fs from cache into p, see programBuildStart.
+* Returns false in case of an error. */
+static bool programSourcesGather(ProgramSources *p, ShaderSourceCache *cache, const char *vs, const char *fs,
+	const char * const *defineNames, int defineCount, unsigned int defines, bool spirv, const char *constants = NULL)
+{
+	const char *files[2] = { vs, fs };
+	int i, k;
+
+	p->count = 0;
+	p->module[0] = p->module[1] = NULL;
+	for (k = 0; k < 2; k++) {
+		if (!shaderSourceExpand(cache, &p->src[k], files[k]) ||
+			!shaderSourceInjectDefines(&p->src[k], defineNames, defineCount, defines, p->defineText[k],
+				sizeof(p->defineText[k]), constants))
+			return false;
+	}
+	/* a stage built from a module is keyed by the module and the mask,
+	* the constants only go into the GLSL */
+	for (k = 0; spirv && !constants && spirvSupported() && k < 2; k++)
+		p->module[k] = spirvModuleLookup(cache, files[k]);
+	for (k = 0; k < 2; k++) {
+		if (p->module[k]) {
+			p->strings[p->count] = (const GLchar*)p->module[k]->map;
+			p->lengths[p->count++] = (GLint)p->module[k]->size;
+			mysnprintf(p->moduleKey[k], sizeof(p->moduleKey[k]), "SPIR-V 0x%x", defines);
+			p->strings[p->count] = p->moduleKey[k];
+			p->lengths[p->count++] = (GLint)strlen(p->moduleKey[k]);
+			continue;
+		}
+		for (i = 0; i < p->src[k].count; i++, p->count++) {
+			p->strings[p->count] = p->src[k].strings[i];
+			p->lengths[p->count] = p->src[k].lengths[i];
+		}
+	}
+	return true;
+}
+
+/* Get the program binary cache key programBuildStart would use for the
+* same arguments, without building anything.
+* Returns 0 in case of an error. */
+static GLuint64 programBuildKey(ShaderSourceCache *cache, const char *vs, const char *fs,
+	const char * const *defineNames = NULL, int defineCount = 0, unsigned int defines = 0, bool spirv = false)
+{
+	ProgramSources p;
+	if (!programSourcesGather(&p, cache, vs, fs, defineNames, defineCount, defines, spirv))
+		return 0;
+	return programCacheKey(p.strings, p.lengths, p.count);
+}
+
+/* Start building a program from vertex and fragment shader source files,
+* which are taken from cache, with the feature defines selected by the mask
+* defines (see SHADER PERMUTATIONS). If spirv is set, stages with a SPIR-V
+* module use it instead of the GLSL source (see SPIR-V MODULES), unless
+* there are constants, GLSL lines inserted after the defines. Cache hits
+* are finished immediately.
+* Returns true if the build was started and false in case of an error. */
+static bool programBuildStart(ProgramBuild *build, ShaderSourceCache *cache, const char *vs, const char *fs,
+	const char * const *defineNames = NULL, int defineCount = 0, unsigned int defines = 0, bool spirv = false,
+	const char *constants = NULL)
+{
+	ProgramSources p;
+
+	build->state = PROGRAM_BUILD_IDLE;
+	build->vs = build->fs = build->program = 0;
+	build->separable = false;
+	mysnprintf(build->label, sizeof(build->label), "%s + %s (0x%x%s)", vs, fs, defines,
+		constants ? ", specialized" : "");
+
+	if (!programSourcesGather(&p, cache, vs, fs, defineNames, defineCount, defines, spirv, constants)) {
+		build->state = PROGRAM_BUILD_FAILED;
+		return false;
+	}
+
+	build->cacheKey = programCacheKey(p.strings, p.lengths, p.count);
+	build->program = programCacheLoad(build->cacheKey);
+	if (build->program) {
+		glDebugLabel(GL_PROGRAM, build->program, "%s", build->label);
+		build->state = PROGRAM_BUILD_DONE;
+	} else {
+		bool fallback = false;
+		build->vs = stageStartCompile(GL_VERTEX_SHADER, p.module[0], &p.src[0], defines, &fallback);
+		build->fs = stageStartCompile(GL_FRAGMENT_SHADER, p.module[1], &p.src[1], defines, &fallback);
+		/* do not store a GLSL build under the key of the module */
+		if (fallback)
+			build->cacheKey = 0;
+		build->state = PROGRAM_BUILD_COMPILING;
+	}
+	return true;
+}
+
+static void programBuildCancel(ProgramBuild *build);
+
+/* Advance a build without blocking (if the driver compiles in parallel).
+* If wait is set, block until the build is finished instead.
+* Returns true if the build is finished, check build->state for the result. */
+static bool programBuildPoll(ProgramBuild *build, bool wait = false)
+{
+	if (build->state == PROGRAM_BUILD_COMPILING) {
+		if (!wait && ((build->vs && !objectBuildComplete(build->vs, false)) ||
+			(build->fs && !objectBuildComplete(build->fs, false))))
+			return false;
+		bool compiled = true;
+		if (build->vs && !(build->vs = shaderCheckCompiled(build->vs)))
+			compiled = false;
+		if (build->fs && !(build->fs = shaderCheckCompiled(build->fs)))
+			compiled = false;
+		if (!compiled) {
+			programBuildCancel(build);
+			build->state = PROGRAM_BUILD_FAILED;
+			return true;
+		}
+		build->program = programStartLink(build->vs, build->fs, build->separable);
+		glDebugLabel(GL_PROGRAM, build->program, "%s", build->label);
+		/* the program keeps the shaders alive as long as it needs them */
+		if (build->vs)
+			glDeleteShader(build->vs);
+		if (build->fs)
+			glDeleteShader(build->fs);
+		build->vs = build->fs = 0;
+		build->state = PROGRAM_BUILD_LINKING;
+	}
+	if (build->state == PROGRAM_BUILD_LINKING) {
+		if (!wait && !objectBuildComplete(build->program, true))
+			return false;
+		build->program = programCheckLinked(build->program);
+		if (build->program) {
+			if (build->cacheKey)
+				programCacheStore(build->cacheKey, build->program);
+			build->state = PROGRAM_BUILD_DONE;
+		} else {
+			build->state = PROGRAM_BUILD_FAILED;
+		}
+	}
+	return (build->state != PROGRAM_BUILD_IDLE);
+}
+
+/* Abort a build which is still in flight. */
+static void programBuildCancel(ProgramBuild *build)
+{
+	if (build->vs)
+		glDeleteShader(build->vs);
+	if (build->fs)
+		glDeleteShader(build->fs);
+	if (build->program)
+		glState()->deleteProgram(build->program);
+	build->vs = build->fs = build->program = 0;
+	build->state = PROGRAM_BUILD_IDLE;
+}
+
+/* Build a program from vertex and fragment shader source files right away,
+* for the small helper passes of the renderer which bypass the registry,
+* with the feature defines selected by the mask defines.
+* Returns the name of the program, or 0 in case of an error. */
+static GLuint programBuild(ShaderSourceCache *cache, const char *vs, const char *fs,
+	const char * const *defineNames = NULL, int defineCount = 0, unsigned int defines = 0)
+{
+	ProgramBuild build;
+
+	if (!programBuildStart(&build, cache, vs, fs, defineNames, defineCount, defines)) {
+		warn("failed to build program from '%s' and '%s'", vs, fs);
+		return 0;
+	}
+	programBuildPoll(&build, true);
+	return (build.state == PROGRAM_BUILD_DONE) ? build.program : 0;
+}
+
+/****************************************************************************
+* SEPARABLE PROGRAMS                                                       *
+****************************************************************************/
+
+/* With GL_ARB_separate_shader_objects, each shader stage can be linked on
+* its own into a separable program, and a program pipeline combines the
+* stages at bind time. N vertex and M fragment shaders then need N + M
+* links instead of N * M. Stage programs are built like glCreateShaderProgramv
+* would do it, but step by step via ProgramBuild so that they are compiled
+* in the background too. They bypass the program binary cache, since not
+* every driver restores GL_PROGRAM_SEPARABLE from a binary. */
+
+/* Returns true if the context supports program pipelines. */
+static bool separateShaderObjectsSupported()
+{
+	return glCaps()->separateShaders;
+}
+
+/* Start building a separable program of a single stage of type from the
+* source file filename, with the feature defines selected by the mask
+* defines, or from its SPIR-V module if spirv is set and there is one.
+* Returns true if the build was started and false in case of an error. */
+static bool stageBuildStart(ProgramBuild *build, ShaderSourceCache *cache, GLenum type, const char *filename,
+	const char * const *defineNames, int defineCount, unsigned int defines, bool spirv = false)
+{
+	ShaderSourceList src;
+	char defineText[SHADER_DEFINES_LENGTH];
+
+	build->state = PROGRAM_BUILD_IDLE;
+	build->vs = build->fs = build->program = 0;
+	build->cacheKey = 0;
+	build->separable = true;
+	mysnprintf(build->label, sizeof(build->label), "%s (0x%x)", filename, defines);
+
+	if (!shaderSourceExpand(cache, &src, filename) ||
+		!shaderSourceInjectDefines(&src, defineNames, defineCount, defines, defineText, sizeof(defineText))) {
+		build->state = PROGRAM_BUILD_FAILED;
+		return false;
+	}
+	bool fallback = false;
+	ShaderSourceEntry *module = (spirv && spirvSupported()) ? spirvModuleLookup(cache, filename) : NULL;
+	GLuint shader = stageStartCompile(type, module, &src, defines, &fallback);
+	if (type == GL_VERTEX_SHADER)
+		build->vs = shader;
+	else
+		build->fs = shader;
+	build->state = PROGRAM_BUILD_COMPILING;
+	return true;
+}
+
+/****************************************************************************
+* COMPUTE PROGRAMS                                                         *
+****************************************************************************/
+
+/* Compute shaders need GL 4.3: GL_ARB_compute_shader alone does not give us
+* the shader storage buffers they write their results to. Compute programs
+* are small helpers of the renderer built once at startup, so they are built
+* synchronously and bypass the registry and the program binary cache. */
+
+/* Returns true if the context supports compute shaders and storage buffers. */
+static bool computeShaderSupported()
+{
+	return glCaps()->computeShader;
+}
+
+/* Build a compute program from the source file filename, with its includes
+* and the feature defines selected by the mask defines.
+* Returns the name of the program, or 0 in case of an error. */
+static GLuint computeProgramBuild(ShaderSourceCache *cache, const char *filename,
+	const char * const *defineNames = NULL, int defineCount = 0, unsigned int defines = 0)
+{
+	ShaderSourceList src;
+	char defineText[SHADER_DEFINES_LENGTH];
+	GLuint shader, program;
+
+	if (!shaderSourceExpand(cache, &src, filename) ||
+		!shaderSourceInjectDefines(&src, defineNames, defineCount, defines, defineText, sizeof(defineText)))
+		return 0;
+	shader = shaderCheckCompiled(shaderStartCompile(GL_COMPUTE_SHADER, src.count, src.strings, src.lengths));
+	if (!shader) {
+		warn("compute shader '%s' failed to compile", filename);
+		return 0;
+	}
+	program = glCreateProgram();
+	info("created program %u", program);
+	if (defines)
+		glDebugLabel(GL_PROGRAM, program, "%s (0x%x)", filename, defines);
+	else
+		glDebugLabel(GL_PROGRAM, program, "%s", filename);
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glDeleteShader(shader);
+	return programCheckLinked(program);
+}
+
+/****************************************************************************
+* TESSELLATION PROGRAMS                                                    *
+****************************************************************************/
+
+/* Tessellation shaders need GL 4.0 or GL_ARB_tessellation_shader. Like the
+* compute programs, the few programs with them are built synchronously when
+* first needed, and bypass the registry and the program binary cache. */
+
+/* Returns true if the context supports tessellation shaders. */
+static bool tessellationSupported()
+{
+	return glCaps()->tessellation;
+}
+
+/* Build a program from the vertex, tessellation control, tessellation
+* evaluation and fragment shader source files vs, tcs, tes and fs, all of
+* them with the feature defines selected by the mask defines.
+* Returns the name of the program, or 0 in case of an error. */
+static GLuint tessProgramBuild(ShaderSourceCache *cache, const char *vs, const char *tcs, const char *tes,
+	const char *fs, const char * const *defineNames, int defineCount, unsigned int defines)
+{
+	static const GLenum types[4] = {
+		GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER
+	};
+	const char *files[4] = { vs, tcs, tes, fs };
+	GLuint shaders[4] = { 0, 0, 0, 0 };
+	GLuint program = 0;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		ShaderSourceList src;
+		char defineText[SHADER_DEFINES_LENGTH];
+		if (!shaderSourceExpand(cache, &src, files[i]) ||
+			!shaderSourceInjectDefines(&src, defineNames, defineCount, defines, defineText, sizeof(defineText)))
+			break;
+		shaders[i] = shaderCheckCompiled(shaderStartCompile(types[i], src.count, src.strings, src.lengths));
+		if (!shaders[i]) {
+			warn("shader '%s' failed to compile", files[i]);
+			break;
+		}
+	}
+	if (i == 4) {
+		program = programStartLink(shaders[0], shaders[3], false, shaders[1], shaders[2]);
+		glDebugLabel(GL_PROGRAM, program, "%s + %s (0x%x)", tes, fs, defines);
+		program = programCheckLinked(program);
+	}
+	for (i = 0; i < 4; i++)
+		if (shaders[i])
+			glDeleteShader(shaders[i]);
 	return program;
 }
 
@@ -256,17 +1573,27 @@ static GLenum programCreateFromFiles(const char *vs, const char *fs)
 * is created. */
 static void initGLState()
 {
-	printGLInfo();
-	listGLExtensions();
+	/* the details and the file as --gl-info and --gl-info-out ask */
+	glCaps()->report();
+	glCaps()->dump();
+
+	/* nothing is known about the state of a new context yet */
+	glState()->invalidate();
 
 	/* we set these once and never change them, so there is no need
 	* to set them during the main loop */
-	glEnable(GL_DEPTH_TEST);
+	glState()->enable(GL_DEPTH_TEST);
 
-	/* We do not enable backface culling, since the "cut" shader works
-	* best when one can see through the cut-out front faces... */
-	//glEnable(GL_CULL_FACE);
+	/* Back-face culling is part of the raster state of each program
+	* (see RASTER_* in GLState.h), since the "cut" shader works best when
+	* one can see through the cut-out front faces... */
 	glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
+
+	/* let the driver use as many compiler threads as it likes */
+	if (parallelShaderCompileSupported()) {
+		info("using parallel shader compilation");
+		glMaxShaderCompilerThreadsARB(0xffffffffu);
+	}
 }
 
 #endif // !SHADER_HELPERS_H
@@ -0,0 +1,246 @@
+#ifndef HEADER_SHADERWATCHER_H
+#define HEADER_SHADERWATCHER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#ifdef WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#define SHADER_WATCHER_INOTIFY
+#endif
+
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* SHADER FILE WATCHER                                                      *
+****************************************************************************/
+
+/* ShaderWatcher: watches a directory for modified files on a background
+* thread (inotify on Linux, ReadDirectoryChangesW on Windows). The thread only
+* records the paths of the changed files; the main loop fetches them with
+* poll() and rebuilds the affected programs. Editors often write a file
+* several times per save, duplicates are merged until the next poll(). On
+* other platforms start() just fails and shaders are reloaded via the keys.
+* onChange, if set, is called on the watcher thread for every change, e.g.
+* to wake a main loop which sleeps until there is something to draw. */
+#define SHADER_WATCHER_MAX_CHANGES 64
+#define SHADER_WATCHER_PATH 256
+
+typedef struct {
+	char dir[SHADER_WATCHER_PATH];
+	std::thread thread;
+	std::atomic<bool> running;
+
+	/* the changes since the last poll, protected by lock */
+	std::mutex lock;
+	char changed[SHADER_WATCHER_MAX_CHANGES][SHADER_WATCHER_PATH];
+	int changedCount;
+
+	void (*onChange)(void *user);
+	void *onChangeUser;
+
+#ifdef WIN32
+	HANDLE dirHandle;
+	HANDLE stopEvent;
+#elif defined(SHADER_WATCHER_INOTIFY)
+	int fd;
+	int wakePipe[2];	/* written to by stop() to end the thread */
+#endif
+
+	void init()
+	{
+		running = false;
+		changedCount = 0;
+		dir[0] = 0;
+		onChange = NULL;
+		onChangeUser = NULL;
+	}
+
+	/* Start watching directory. Returns true if successfull. */
+	bool start(const char *directory)
+	{
+		stop();
+		mysnprintf(dir, sizeof(dir), "%s", directory);
+		changedCount = 0;
+#ifdef WIN32
+		dirHandle = CreateFileA(dir, FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+			OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+		if (dirHandle == INVALID_HANDLE_VALUE) {
+			warn("shader watcher: failed to open '%s'", dir);
+			return false;
+		}
+		stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (!stopEvent) {
+			CloseHandle(dirHandle);
+			return false;
+		}
+#elif defined(SHADER_WATCHER_INOTIFY)
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0) {
+			warn("shader watcher: inotify is not available");
+			return false;
+		}
+		/* editors either rewrite the file or rename a new one over it */
+		if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+			warn("shader watcher: failed to watch '%s'", dir);
+			close(fd);
+			return false;
+		}
+		if (pipe(wakePipe)) {
+			close(fd);
+			return false;
+		}
+#else
+		info("shader watcher: not supported on this platform");
+		return false;
+#endif
+		running = true;
+		thread = std::thread([this]() { run(); });
+		info("shader watcher: watching '%s'", dir);
+		return true;
+	}
+
+	/* Stop the background thread. */
+	void stop()
+	{
+		if (!running)
+			return;
+		running = false;
+#ifdef WIN32
+		SetEvent(stopEvent);
+#elif defined(SHADER_WATCHER_INOTIFY)
+		char c = 0;
+		if (write(wakePipe[1], &c, 1) != 1)
+			warn("shader watcher: failed to wake the thread");
+#endif
+		thread.join();
+#ifdef WIN32
+		CloseHandle(dirHandle);
+		CloseHandle(stopEvent);
+#elif defined(SHADER_WATCHER_INOTIFY)
+		close(fd);
+		close(wakePipe[0]);
+		close(wakePipe[1]);
+#endif
+		info("shader watcher: stopped");
+	}
+
+	/* Copy the paths changed since the last call to paths, at most max.
+	* Returns the number of paths. Never blocks on the watcher thread. */
+	int poll(char (*paths)[SHADER_WATCHER_PATH], int max)
+	{
+		int i, n;
+		if (!running || !lock.try_lock())
+			return 0;
+		n = (changedCount < max) ? changedCount : max;
+		for (i = 0; i < n; i++)
+			memcpy(paths[i], changed[i], SHADER_WATCHER_PATH);
+		changedCount = 0;
+		lock.unlock();
+		return n;
+	}
+
+	/* Record that file name in the watched directory changed. */
+	void notify(const char *name)
+	{
+		int i;
+		char path[2 * SHADER_WATCHER_PATH];
+
+		mysnprintf(path, sizeof(path), "%s/%s", dir, name);
+		if (strlen(path) >= SHADER_WATCHER_PATH)
+			return;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (i = 0; i < changedCount; i++)
+				if (!strcmp(changed[i], path))
+					return;
+			if (changedCount < SHADER_WATCHER_MAX_CHANGES)
+				memcpy(changed[changedCount++], path, SHADER_WATCHER_PATH);
+		}
+		if (onChange)
+			onChange(onChangeUser);
+	}
+
+	/* The background thread. */
+	void run()
+	{
+#ifdef WIN32
+		DWORD buffer[4096];
+		OVERLAPPED ov;
+		DWORD bytes;
+		char name[SHADER_WATCHER_PATH];
+
+		memset(&ov, 0, sizeof(ov));
+		ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		while (running) {
+			ResetEvent(ov.hEvent);
+			if (!ReadDirectoryChangesW(dirHandle, buffer, sizeof(buffer), FALSE,
+				FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, NULL, &ov, NULL))
+				break;
+			HANDLE handles[2] = { ov.hEvent, stopEvent };
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+				CancelIo(dirHandle);
+				break;
+			}
+			if (!GetOverlappedResult(dirHandle, &ov, &bytes, FALSE) || !bytes)
+				continue;
+			const char *p = (const char*)buffer;
+			for (;;) {
+				const FILE_NOTIFY_INFORMATION *e = (const FILE_NOTIFY_INFORMATION*)p;
+				if (e->Action == FILE_ACTION_MODIFIED || e->Action == FILE_ACTION_ADDED ||
+					e->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+					int len = WideCharToMultiByte(CP_UTF8, 0, e->FileName, e->FileNameLength / sizeof(WCHAR),
+						name, sizeof(name) - 1, NULL, NULL);
+					name[len] = 0;
+					notify(name);
+				}
+				if (!e->NextEntryOffset)
+					break;
+				p += e->NextEntryOffset;
+			}
+		}
+		CloseHandle(ov.hEvent);
+#elif defined(SHADER_WATCHER_INOTIFY)
+		char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+		struct pollfd fds[2];
+
+		fds[0].fd = fd;
+		fds[0].events = POLLIN;
+		fds[1].fd = wakePipe[0];
+		fds[1].events = POLLIN;
+		while (running) {
+			if (::poll(fds, 2, -1) < 0)
+				continue;
+			if (fds[1].revents)
+				break;
+			ssize_t len;
+			while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+				const char *p = buffer;
+				while (p < buffer + len) {
+					const struct inotify_event *e = (const struct inotify_event*)p;
+					if (e->len)
+						notify(e->name);
+					p += sizeof(struct inotify_event) + e->len;
+				}
+			}
+		}
+#endif
+	}
+} ShaderWatcher;
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef HEADER_SHADINGRATE_H
+#define HEADER_SHADINGRATE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "Log.h"
+#include "GLState.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* VARIABLE-RATE SHADING                                                    *
+****************************************************************************/
+
+/* ShadingRateImage: coarse shading via GL_NV_shading_rate_image for the
+* programs whose registry entry has RASTER_COARSE, i.e. those with
+* expensive fragment shaders. The shading-rate image has a texel per
+* region of usually 16x16 pixels, which selects a rate from the palette:
+* one fragment shader invocation per pixel, per 2x2 or per 4x4 pixels.
+* Before each frame, a compute shader (shaders/shading_rate.cs.glsl) fills
+* it from the previous frame: regions with edges or texture, i.e. a high
+* contrast of the luminance, are shaded at full rate, those with a low
+* contrast at 2x2 and flat ones like the sky at 4x4. We have no motion
+* vectors, so how much the mean luminance of a region changed since the
+* frame before stands in for its velocity, and fast changes get one step
+* coarser, since the motion hides the detail anyway.
+* The previous frame is the color of the offscreen target, so this renders
+* offscreen. Our glad does not know the extension, so its entry points and
+* enums are here. */
+#ifndef GL_NV_shading_rate_image
+#define GL_SHADING_RATE_IMAGE_NV 0x9563
+#define GL_SHADING_RATE_1_INVOCATION_PER_PIXEL_NV 0x9565
+#define GL_SHADING_RATE_1_INVOCATION_PER_2X2_PIXELS_NV 0x9568
+#define GL_SHADING_RATE_1_INVOCATION_PER_4X4_PIXELS_NV 0x956B
+#define GL_SHADING_RATE_IMAGE_TEXEL_WIDTH_NV 0x955C
+#define GL_SHADING_RATE_IMAGE_TEXEL_HEIGHT_NV 0x955D
+#define GL_SHADING_RATE_IMAGE_PALETTE_SIZE_NV 0x955E
+#endif
+typedef void (APIENTRYP ShadingRateImageBindProc)(GLuint texture);
+typedef void (APIENTRYP ShadingRateImagePaletteProc)(GLuint viewport, GLuint first, GLsizei count, const GLenum *rates);
+
+#define SHADING_RATE_CS "shaders/shading_rate.cs.glsl"
+#define SHADING_RATE_COLOR_UNIT 10	/* the previous frame during the update */
+#define SHADING_RATE_PALETTE_SIZE 3	/* the indices in shaders/shading_rate.cs.glsl */
+
+typedef struct {
+	bool enabled;
+	GLuint program;		/* 0 if not supported */
+	GLint texelSizeLoc, viewportSizeLoc, historyValidLoc;
+	ShadingRateImageBindProc bindImage;
+	ShadingRateImagePaletteProc setPalette;
+	GLint texelWidth, texelHeight;	/* pixels per texel of the image */
+	GLuint rates;		/* GL_TEXTURE_2D, GL_R8UI, a palette index per texel */
+	GLuint luma;		/* GL_TEXTURE_2D, GL_R16F, the mean luminance of each texel */
+	GLsizei width, height;	/* of the image in texels */
+	bool valid;		/* luma holds the frame before */
+
+	void clear()
+	{
+		enabled = false;
+		program = rates = luma = 0;
+		bindImage = NULL;
+		setPalette = NULL;
+		texelWidth = texelHeight = 16;
+		width = height = 0;
+		valid = false;
+	}
+
+	/* Load the extension and build the program, sources are loaded via
+	* cache. Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache)
+	{
+		GLint paletteSize = 0;
+		MemoryScope scope(MEMORY_TARGETS);
+
+		clear();
+		if (!computeShaderSupported() || !glTexStorage2D || !glBindImageTexture ||
+			!glExtensionSupported("GL_NV_shading_rate_image"))
+			return false;
+		bindImage = (ShadingRateImageBindProc)glfwGetProcAddress("glBindShadingRateImageNV");
+		setPalette = (ShadingRateImagePaletteProc)glfwGetProcAddress("glShadingRateImagePaletteNV");
+		glGetIntegerv(GL_SHADING_RATE_IMAGE_PALETTE_SIZE_NV, &paletteSize);
+		if (!bindImage || !setPalette || paletteSize < SHADING_RATE_PALETTE_SIZE)
+			return false;
+		glGetIntegerv(GL_SHADING_RATE_IMAGE_TEXEL_WIDTH_NV, &texelWidth);
+		glGetIntegerv(GL_SHADING_RATE_IMAGE_TEXEL_HEIGHT_NV, &texelHeight);
+		if (texelWidth < 1 || texelHeight < 1)
+			return false;
+		program = computeProgramBuild(cache, SHADING_RATE_CS);
+		if (!program)
+			return false;
+		texelSizeLoc = glGetUniformLocation(program, "texelSize");
+		viewportSizeLoc = glGetUniformLocation(program, "viewportSize");
+		historyValidLoc = glGetUniformLocation(program, "historyValid");
+		glState()->useProgram(program);
+		glUniform1i(glGetUniformLocation(program, "previousColor"), SHADING_RATE_COLOR_UNIT);
+		glState()->useProgram(0);
+
+		/* the palette indices of the shader */
+		static const GLenum palette[SHADING_RATE_PALETTE_SIZE] = {
+			GL_SHADING_RATE_1_INVOCATION_PER_PIXEL_NV,
+			GL_SHADING_RATE_1_INVOCATION_PER_2X2_PIXELS_NV,
+			GL_SHADING_RATE_1_INVOCATION_PER_4X4_PIXELS_NV
+		};
+		setPalette(0, 0, SHADING_RATE_PALETTE_SIZE, palette);
+		info("variable-rate shading: program %u, %dx%d pixels per rate", program,
+			(int)texelWidth, (int)texelHeight);
+		return true;
+	}
+
+	void destroyImages()
+	{
+		if (rates)
+			glState()->deleteTextures(1, &rates);
+		if (luma)
+			glState()->deleteTextures(1, &luma);
+		rates = luma = 0;
+		width = height = 0;
+		valid = false;
+	}
+
+	void destroy()
+	{
+		setEnabled(false);
+		destroyImages();
+		if (program)
+			glState()->deleteProgram(program);
+		clear();
+	}
+
+	/* Let RASTER_COARSE shade at the rates of the image, or at full rate. */
+	void setEnabled(bool enable)
+	{
+		if (enable && !program)
+			return;
+		if (!enable && glState()->coarseCap) {
+			glState()->disable(glState()->coarseCap);
+			glState()->coarseCap = 0;
+		}
+		if (enable)
+			glState()->coarseCap = GL_SHADING_RATE_IMAGE_NV;
+		enabled = enable;
+		valid = false;
+	}
+
+	static GLuint createImage(GLenum internalFormat, GLsizei w, GLsizei h)
+	{
+		GLuint tex;
+		MemoryScope scope(MEMORY_TARGETS);
+		glGenTextures(1, &tex);
+		glState()->bindTexture(GL_TEXTURE_2D, tex);
+		/* the shading-rate image must be immutable */
+		glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, w, h);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		return tex;
+	}
+
+	/* (Re-)allocate the images for a viewport of w x h pixels. */
+	void resize(GLsizei w, GLsizei h)
+	{
+		w = (w + texelWidth - 1) / texelWidth;
+		h = (h + texelHeight - 1) / texelHeight;
+		if (w < 1)
+			w = 1;
+		if (h < 1)
+			h = 1;
+		if (w == width && h == height)
+			return;
+		destroyImages();
+		width = w;
+		height = h;
+		rates = createImage(GL_R8UI, width, height);
+		luma = createImage(GL_R16F, width, height);
+	}
+
+	/* Fill the image for a frame of w x h pixels from the previous frame
+	* in the texture color, and bind it for the draws with RASTER_COARSE.
+	* Call this before the frame clears color. This uses its own program,
+	* so the program for drawing must be bound afterwards. */
+	void update(GLuint color, GLsizei w, GLsizei h)
+	{
+		if (!enabled)
+			return;
+		GL_DEBUG_GROUP("shading rate");
+		resize(w, h);
+		glState()->useProgram(program);
+		glUniform2i(texelSizeLoc, texelWidth, texelHeight);
+		glUniform2i(viewportSizeLoc, w, h);
+		glUniform1i(historyValidLoc, valid ? 1 : 0);
+		glState()->activeTexture(GL_TEXTURE0 + SHADING_RATE_COLOR_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, color);
+		glState()->activeTexture(GL_TEXTURE0);
+		glBindImageTexture(0, rates, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+		glBindImageTexture(1, luma, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R16F);
+		glDispatchCompute((GLuint)width, (GLuint)height, 1);
+		/* the rasterizer fetches the rates like a texture */
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		bindImage(rates);
+		valid = true;
+		GL_ERROR_DBG("shading-rate image update");
+	}
+} ShadingRateImage;
+
+#endif
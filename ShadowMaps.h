@@ -0,0 +1,268 @@
+#ifndef HEADER_SHADOWMAPS_H
+#define HEADER_SHADOWMAPS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glad/glad.h>
+#include <math.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* CASCADED SHADOW MAPS                                                     *
+****************************************************************************/
+
+/* ShadowMaps: the shadows of a sun for the material shaders, in
+* SHADOW_CASCADES depth maps, each covering a slice of the view frustum
+* which is farther and larger than the one before, so the texels on screen
+* are about the same size near and far. The slices are split between
+* evenly and logarithmically spaced (SHADOW_SPLIT_LAMBDA).
+* Each cascade is fitted to the bounding sphere of its slice, whose size
+* does not change as the camera turns, and its origin is snapped to whole
+* texels of the map, so the shadow edges do not shimmer as the camera
+* moves. The maps are drawn from the packets of the render queue with the
+* DEPTH_ONLY programs, see RenderQueue::submitShadow(), so the instanced
+* and the multi-draw paths draw them as they draw the frame.
+* The cascades from SHADOW_CACHED_FIRST on are cached: they are fitted a
+* bit larger than their slice, and only drawn again once the camera moved
+* past that margin, or after SHADOW_CACHE_FRAMES frames, one per frame, so
+* what moves in them follows with a delay. Only the near cascades are
+* drawn every frame, which keeps the cost bounded however far the view
+* reaches.
+* The casters are the objects the frame draws, so objects culled from the
+* view cast no shadows into it. */
+#define SHADOW_CASCADES 4		/* also in shaders/frame.glsl */
+#define SHADOW_SIZE 2048		/* texels of a map per side */
+#define SHADOW_SPLIT_LAMBDA 0.75f	/* 0 splits evenly, 1 logarithmically */
+#define SHADOW_CACHED_FIRST 2		/* the first cached cascade */
+#define SHADOW_CACHE_MARGIN 0.125f	/* of its radius a cached cascade is larger */
+#define SHADOW_CACHE_FRAMES 30		/* a cached cascade is drawn at least this often */
+#define SHADOW_SLOPE_BIAS 2.0f		/* glPolygonOffset while drawing the maps */
+#define SHADOW_BIAS 4.0f
+
+/* the shadows as the shaders see them, part of FrameUniforms, std140 */
+typedef struct {
+	glm::mat4 matrices[SHADOW_CASCADES];	/* view space to [0, 1] of each map, depth in z */
+	glm::vec4 splits;	/* the far view depth of each cascade */
+	glm::vec4 texels;	/* a texel of each cascade in world units */
+	glm::vec4 sunDirection;	/* towards the sun in view space, w: 1 with shadows, 0 without the sun */
+} ShadowUniforms;
+
+typedef struct {
+	GLuint texture;		/* GL_TEXTURE_2D_ARRAY, a layer per cascade, 0 if off */
+	GLuint fbo;		/* a layer of texture is attached while drawing it */
+	glm::vec3 sun;		/* towards the sun in world space */
+	glm::mat4 viewProjection[SHADOW_CASCADES];	/* world to the clip space of each map */
+	glm::vec3 centers[SHADOW_CASCADES];	/* of the bounding spheres, in world space */
+	float radius[SHADOW_CASCADES];	/* of the maps, with the margin */
+	float splits[SHADOW_CASCADES];	/* the far view depth of each slice */
+	float casterDistance;	/* of the last update() */
+	unsigned int age[SHADOW_CASCADES];	/* frames since the map was drawn */
+	bool valid;		/* the cached maps may be used */
+	unsigned int drawn;	/* maps drawn by the last update() */
+
+	void clear()
+	{
+		texture = fbo = 0;
+		sun = glm::normalize(glm::vec3(0.4f, 1.0f, 0.5f));
+		casterDistance = 0.0f;
+		valid = false;
+		drawn = 0;
+	}
+
+	/* Create the maps and the framebuffer drawing them.
+	* Returns true if successfull and false in case of an error. */
+	bool init()
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		clear();
+		glGenTextures(1, &texture);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, SHADOW_SIZE, SHADOW_SIZE, SHADOW_CASCADES, 0,
+			GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+		/* the comparison is filtered over 2x2 texels, and what is
+		* outside of a map is lit */
+		const GLfloat border[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		glGenFramebuffers(1, &fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE) {
+			warn("shadow maps: FBO %u is incomplete: 0x%x", fbo, (unsigned)status);
+			destroy();
+			return false;
+		}
+		GL_ERROR_DBG("shadow maps initialization");
+		info("shadow maps: %d cascades of %dx%d", SHADOW_CASCADES, SHADOW_SIZE, SHADOW_SIZE);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (fbo)
+			glDeleteFramebuffers(1, &fbo);
+		if (texture)
+			glState()->deleteTextures(1, &texture);
+		clear();
+	}
+
+	/* Draw all maps again with the next update(), e.g. since the scene
+	* changed. */
+	void invalidate()
+	{
+		valid = false;
+	}
+
+	/* Fit the cascades to the view, whose projection has the near and far
+	* planes zNear and zFar; the casters may be up to casterDistance
+	* outside of a slice towards the sun.
+	* Returns the mask of the cascades to draw this frame. */
+	unsigned int update(const glm::mat4 &view, const glm::mat4 &projection, float zNear, float zFar,
+		float casterDistance)
+	{
+		glm::mat4 projectionInverse = glm::inverse(projection), viewInverse = glm::inverse(view);
+		glm::vec3 corners[4];
+		unsigned int mask = 0;
+		int i, k, oldest = -1;
+
+		if (casterDistance != this->casterDistance)
+			valid = false;
+		this->casterDistance = casterDistance;
+
+		/* the corners of the near plane in view space; the point at
+		* depth d on the ray through one of them is corner * d / zNear */
+		for (k = 0; k < 4; k++) {
+			glm::vec4 c = projectionInverse * glm::vec4((k & 1) ? 1.0f : -1.0f, (k & 2) ? 1.0f : -1.0f, -1.0f, 1.0f);
+			corners[k] = glm::vec3(c) / c.w;
+		}
+		/* the oldest cached map is drawn if it is due */
+		for (i = SHADOW_CACHED_FIRST; i < SHADOW_CASCADES; i++)
+			if (valid && age[i] >= SHADOW_CACHE_FRAMES && (oldest < 0 || age[i] > age[oldest]))
+				oldest = i;
+
+		float slice0 = zNear;
+		for (i = 0; i < SHADOW_CASCADES; i++) {
+			float t = (float)(i + 1) / SHADOW_CASCADES;
+			float slice1 = SHADOW_SPLIT_LAMBDA * zNear * powf(zFar / zNear, t) +
+				(1.0f - SHADOW_SPLIT_LAMBDA) * (zNear + (zFar - zNear) * t);
+			splits[i] = slice1;
+
+			/* the bounding sphere of the slice, which only depends on
+			* its depths; rounded, so it does not jitter either */
+			glm::vec3 p[8], center(0.0f);
+			for (k = 0; k < 4; k++) {
+				p[k] = corners[k] * (slice0 / zNear);
+				p[k + 4] = corners[k] * (slice1 / zNear);
+			}
+			for (k = 0; k < 8; k++)
+				center += p[k] * 0.125f;
+			float r = 0.0f;
+			for (k = 0; k < 8; k++)
+				r = glm::max(r, glm::length(p[k] - center));
+			r = ceilf(r * 16.0f) / 16.0f;
+			center = glm::vec3(viewInverse * glm::vec4(center, 1.0f));
+			slice0 = slice1;
+
+			bool cached = i >= SHADOW_CACHED_FIRST;
+			if (cached && valid && i != oldest && glm::length(center - centers[i]) <= SHADOW_CACHE_MARGIN * r) {
+				age[i]++;
+				continue;
+			}
+			fit(i, center, cached ? r * (1.0f + SHADOW_CACHE_MARGIN) : r);
+			age[i] = 0;
+			mask |= 1u << i;
+		}
+		valid = true;
+		drawn = 0;
+		for (i = 0; i < SHADOW_CASCADES; i++)
+			drawn += (mask >> i) & 1u;
+		return mask;
+	}
+
+	/* Place cascade i around the sphere at center of radius size. */
+	void fit(int i, const glm::vec3 &center, float size)
+	{
+		glm::vec3 up = (fabsf(sun.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 lightView = glm::lookAt(center + sun * (size + casterDistance), center, up);
+		glm::mat4 lightProjection = glm::ortho(-size, size, -size, size, 0.0f, 2.0f * size + casterDistance);
+
+		/* move the map by less than a texel so that the world origin,
+		* and with it every point, falls onto the same spot of a texel
+		* wherever the cascade is */
+		glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		float half = 0.5f * SHADOW_SIZE;
+		glm::vec2 texel(origin.x * half, origin.y * half);
+		glm::vec2 offset = (glm::floor(texel + 0.5f) - texel) / half;
+		lightProjection[3][0] += offset.x;
+		lightProjection[3][1] += offset.y;
+
+		viewProjection[i] = lightProjection * lightView;
+		centers[i] = center;
+		radius[i] = size;
+	}
+
+	/* The uniforms of the shaders for view, with the sun off if not
+	* shadowed, i.e. if the maps are not drawn for this frame. */
+	void uniforms(const glm::mat4 &view, bool shadowed, ShadowUniforms *u) const
+	{
+		int i;
+		for (i = 0; i < SHADOW_CASCADES; i++)
+			u->matrices[i] = glm::mat4(0.0f);
+		u->splits = u->texels = u->sunDirection = glm::vec4(0.0f);
+		if (!shadowed || !texture)
+			return;
+		/* from clip space to texture coordinates and depth */
+		glm::mat4 bias = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+		glm::mat4 viewInverse = glm::inverse(view);
+		for (i = 0; i < SHADOW_CASCADES; i++) {
+			u->matrices[i] = bias * viewProjection[i] * viewInverse;
+			u->splits[i] = splits[i];
+			u->texels[i] = 2.0f * radius[i] / SHADOW_SIZE;
+		}
+		u->sunDirection = glm::vec4(glm::mat3(view) * sun, 1.0f);
+	}
+
+	/* Start drawing cascade i: the depth of its map is cleared, and
+	* polygons are pushed away from the sun a bit against acne. */
+	void begin(int i)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, i);
+		glState()->viewport(0, 0, SHADOW_SIZE, SHADOW_SIZE);
+		glState()->raster(RASTER_DEFAULT);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(SHADOW_SLOPE_BIAS, SHADOW_BIAS);
+	}
+
+	/* Finish drawing the maps, going back to framebuffer. */
+	void end(GLuint framebuffer)
+	{
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(0.0f, 0.0f);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		GL_ERROR_DBG("shadow maps");
+	}
+
+	/* Make the maps available to the material shaders. */
+	void bind() const
+	{
+		glState()->activeTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glState()->activeTexture(GL_TEXTURE0);
+	}
+} ShadowMaps;
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef HEADER_SIMULATION_H
+#define HEADER_SIMULATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/****************************************************************************
+* FIXED-TIMESTEP SIMULATION                                                *
+****************************************************************************/
+
+/* Simulation: the state of the scene advances in fixed steps of 1/hz
+* seconds, independent of the frame rate. Each frame adds its time to an
+* accumulator and runs as many steps as fit, so the cost of the update
+* only depends on the rate, and the result does not depend on how the
+* frames happen to fall. The frame is then rendered between the last two
+* states, interpolated by the fraction of a step the accumulator holds,
+* which keeps the motion smooth when the refresh rate is not a multiple of
+* the update rate. This shows the scene up to one step late.
+* The update function only sees the state, so it could run on another
+* thread, as long as the states it hands over are double buffered like
+* previous and current.
+* After a stall (a breakpoint, a program build the frame waits for), at
+* most SIM_MAX_STEPS steps are taken and the rest of the time is dropped,
+* instead of making the next frames even slower by catching up. */
+#define SIM_DEFAULT_HZ 60.0
+#define SIM_MAX_STEPS 8
+
+/* What the simulation advances: the rotation of the cube, which the
+* instances and the scene objects share, and the time of the animations
+* in the shaders. */
+typedef struct {
+	glm::quat rotation;
+	double time;
+} SimState;
+
+/* Advances s by dt seconds, object is passed through. */
+typedef void (*SimUpdateFunc)(void *object, SimState *s, double dt);
+
+typedef struct {
+	double step;		/* seconds per update */
+	double accumulator;	/* seconds not simulated yet, less than step after advance() */
+	SimState previous, current;
+	unsigned int steps;	/* taken so far */
+
+	void init(double hz = SIM_DEFAULT_HZ)
+	{
+		setRate(hz);
+		accumulator = 0.0;
+		current.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		current.time = 0.0;
+		previous = current;
+		steps = 0;
+	}
+
+	void setRate(double hz)
+	{
+		step = 1.0 / ((hz > 0.0) ? hz : SIM_DEFAULT_HZ);
+	}
+
+	/* Account dt seconds of real time and run the steps which are due.
+	* Returns the number of steps taken. */
+	int advance(double dt, SimUpdateFunc update, void *object)
+	{
+		int n = 0;
+
+		if (dt < 0.0)
+			dt = 0.0;
+		if (dt > SIM_MAX_STEPS * step)
+			dt = SIM_MAX_STEPS * step;
+		accumulator += dt;
+		while (accumulator >= step) {
+			previous = current;
+			update(object, &current, step);
+			current.time += step;
+			accumulator -= step;
+			n++;
+		}
+		steps += n;
+		return n;
+	}
+
+	/* The state to render this frame with, between the last two. */
+	SimState interpolate() const
+	{
+		SimState s;
+		double alpha = accumulator / step;
+		s.rotation = glm::slerp(previous.rotation, current.rotation, (float)alpha);
+		s.time = previous.time + (current.time - previous.time) * alpha;
+		return s;
+	}
+} Simulation;
+
+#endif
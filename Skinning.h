@@ -0,0 +1,330 @@
+#ifndef HEADER_SKINNING_H
+#define HEADER_SKINNING_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glad/glad.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Animation.h"
+#include "Cube.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* SKINNING: vertices skinned once per frame by a compute pass              *
+****************************************************************************/
+
+/* SkinnedCharacters: a mesh for each character of an Animator, a tube of
+* SKIN_SIDES sides around the chain of its joints, each ring of vertices
+* following the one or two joints it is closest to. A compute pass
+* (shaders/skin.cs.glsl) transforms the vertices of the rest pose by the
+* matrices of their joints and writes them into a vertex buffer, in the
+* float layout of Cube.h, the characters one after the other. The buffer
+* is drawn like any other mesh, so the depth pre-pass, the shadow maps and
+* the main pass all read the same skinned vertices instead of each of them
+* skinning in its vertex shader. A character is only skinned again when
+* the version of its pose changed since it was last; its vertices are
+* otherwise kept from an earlier frame, and a frame in which no pose
+* changed does not dispatch at all.
+* The joints are chained: each sits a segment above its parent and turns
+* with it, its local matrix from the Animator on top. The
+* matrices of the characters which are skinned are computed on the job
+* system and uploaded packed, with the list of those characters, and the
+* pass runs a thread per vertex of each of them. All characters are drawn
+* with one glMultiDrawElementsBaseVertex call of the same indices.
+* It needs compute shaders and storage buffers, GL 4.3. */
+#define SKIN_SHADER "shaders/skin.cs.glsl"
+#define SKIN_SIDES 8		/* of the tube */
+#define SKIN_RINGS_PER_JOINT 2	/* rings of vertices along each segment */
+#define SKIN_GROUP 64		/* local size of the compute shader */
+#define SKIN_MAX_DISPATCH 65535	/* characters per dispatch, the minimum of GL_MAX_COMPUTE_WORK_GROUP_COUNT */
+
+/* a vertex of the rest pose as the compute shader reads it, std430 */
+typedef struct {
+	glm::vec4 position;	/* w: the weight of the second joint */
+	GLuint joints[2];	/* the first and the second joint */
+	GLuint color;		/* RGBA8, as in Vertex */
+	GLuint pad;
+} SkinVertex;
+
+static void skinPaletteChunk(void *user, int begin, int end);
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint countsLoc;
+	GLuint restBuffer;	/* SkinVertex of one character */
+	GLuint paletteBuffer;	/* the joint matrices of the characters to skin */
+	GLuint listBuffer;	/* which characters those are */
+	GLuint vertexBuffer;	/* the skinned Vertex of all characters */
+	GLuint indexBuffer;	/* the triangles of one character */
+	GLuint identityBuffer;	/* the instance matrix of the instanced programs */
+	GLuint vao;
+	int count;		/* characters */
+	int joints;		/* of each */
+	GLsizei vertexCount, indexCount;	/* of one character */
+	float segment;		/* distance of a joint from its parent */
+	const Animator *animator;
+	glm::vec3 *bases;	/* per character, where its first joint stands */
+	unsigned int *versions;	/* per character, of the pose it was skinned in, 0 if never */
+	GLuint *list;		/* the characters to skin this frame */
+	glm::mat4 *palette;	/* and their joint matrices, joints each */
+	GLsizei *counts;	/* per character, for glMultiDrawElementsBaseVertex */
+	GLint *baseVertices;
+	const void **indexOffsets;
+	int skinned;		/* characters skinned by the last update() */
+
+	void clear()
+	{
+		program = 0;
+		restBuffer = paletteBuffer = listBuffer = vertexBuffer = indexBuffer = identityBuffer = 0;
+		vao = 0;
+		count = joints = 0;
+		vertexCount = indexCount = 0;
+		animator = NULL;
+		bases = NULL;
+		versions = NULL;
+		list = NULL;
+		palette = NULL;
+		counts = NULL;
+		baseVertices = NULL;
+		indexOffsets = NULL;
+		skinned = 0;
+	}
+
+	/* Whether the context can skin with the compute pass. */
+	static bool supported()
+	{
+		return computeShaderSupported() && glCaps()->storageBuffers && glMultiDrawElementsBaseVertex;
+	}
+
+	/* A storage buffer of size bytes which is uploaded to every frame,
+	* labeled label. */
+	static GLuint dynamicBuffer(GLsizeiptr size, const char *label)
+	{
+		GLuint buffer;
+		MemoryScope scope(MEMORY_MESHES);
+		glGenBuffers(1, &buffer);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glDebugLabel(GL_BUFFER, buffer, "%s", label);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return buffer;
+	}
+
+	/* The rest pose of a character: a tube of the given radius along y,
+	* from 0 to joints segments. */
+	static void buildMesh(int joints, float segment, float radius, SkinVertex *v, GLushort *idx)
+	{
+		const int rings = joints * SKIN_RINGS_PER_JOINT + 1;
+		int r, s, n = 0;
+		for (r = 0; r < rings; r++) {
+			float y = (float)r / (float)SKIN_RINGS_PER_JOINT;
+			/* the middle of a segment follows its joint alone, the ends
+			* are blended with the next one */
+			float f = glm::clamp(y - 0.5f, 0.0f, (float)(joints - 1));
+			int j = glm::min((int)f, joints - 2 >= 0 ? joints - 2 : 0);
+			float w = glm::clamp(f - (float)j, 0.0f, 1.0f);
+			GLubyte shade = (GLubyte)(96 + 159 * r / (rings - 1));
+			for (s = 0; s < SKIN_SIDES; s++) {
+				float a = glm::two_pi<float>() * (float)s / (float)SKIN_SIDES;
+				SkinVertex *p = &v[r * SKIN_SIDES + s];
+				p->position = glm::vec4(radius * cosf(a), y * segment, radius * sinf(a), w);
+				p->joints[0] = (GLuint)j;
+				p->joints[1] = (GLuint)glm::min(j + 1, joints - 1);
+				p->color = (GLuint)shade | ((GLuint)(255 - shade) << 8) | (160u << 16) | (255u << 24);
+				p->pad = 0;
+			}
+		}
+		for (r = 0; r + 1 < rings; r++)
+			for (s = 0; s < SKIN_SIDES; s++) {
+				GLushort a = (GLushort)(r * SKIN_SIDES + s), b = (GLushort)(r * SKIN_SIDES + (s + 1) % SKIN_SIDES);
+				idx[n++] = a;
+				idx[n++] = (GLushort)(a + SKIN_SIDES);
+				idx[n++] = b;
+				idx[n++] = b;
+				idx[n++] = (GLushort)(a + SKIN_SIDES);
+				idx[n++] = (GLushort)(b + SKIN_SIDES);
+			}
+	}
+
+	/* Set up a skinned mesh for each of the characters of a, of which
+	* there must be at least one, each standing at its entry of positions,
+	* segment the length of a segment and radius that of the tube. The
+	* source of the compute shader is loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache, const Animator *a, const glm::vec3 *positions, float segmentLength,
+		float radius)
+	{
+		int i;
+
+		clear();
+		if (!supported() || !a->count)
+			return false;
+		animator = a;
+		count = a->count;
+		joints = a->tracks;
+		segment = segmentLength;
+		vertexCount = (GLsizei)((joints * SKIN_RINGS_PER_JOINT + 1) * SKIN_SIDES);
+		indexCount = (GLsizei)(joints * SKIN_RINGS_PER_JOINT * SKIN_SIDES * 6);
+		if ((size_t)count * (size_t)vertexCount * sizeof(Vertex) > 0x7fffffffu) {
+			warn("skinning: too many characters");
+			return false;
+		}
+
+		program = computeProgramBuild(cache, SKIN_SHADER);
+		if (!program)
+			return false;
+		countsLoc = glGetUniformLocation(program, "counts");
+
+		SkinVertex *rest = (SkinVertex*)malloc(sizeof(SkinVertex) * vertexCount);
+		GLushort *idx = (GLushort*)malloc(sizeof(GLushort) * indexCount);
+		bases = (glm::vec3*)malloc(sizeof(glm::vec3) * count);
+		versions = (unsigned int*)calloc((size_t)count, sizeof(unsigned int));
+		list = (GLuint*)malloc(sizeof(GLuint) * count);
+		palette = (glm::mat4*)malloc(sizeof(glm::mat4) * (size_t)count * joints);
+		counts = (GLsizei*)malloc(sizeof(GLsizei) * count);
+		baseVertices = (GLint*)malloc(sizeof(GLint) * count);
+		indexOffsets = (const void**)malloc(sizeof(void*) * count);
+		if (!rest || !idx || !bases || !versions || !list || !palette || !counts || !baseVertices || !indexOffsets) {
+			free(rest);
+			free(idx);
+			warn("skinning: failed to allocate %d characters", count);
+			destroy();
+			return false;
+		}
+		buildMesh(joints, segment, radius, rest, idx);
+		for (i = 0; i < count; i++) {
+			bases[i] = positions[i];
+			counts[i] = indexCount;
+			baseVertices[i] = (GLint)(i * vertexCount);
+			indexOffsets[i] = NULL;
+		}
+
+		glm::mat4 identity(1.0f);
+		restBuffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, sizeof(SkinVertex) * vertexCount, rest, "skin rest pose");
+		paletteBuffer = dynamicBuffer(sizeof(glm::mat4) * (size_t)count * joints, "skin palettes");
+		listBuffer = dynamicBuffer(sizeof(GLuint) * count, "skin list");
+		/* only ever written by the compute pass */
+		vertexBuffer = meshBufferCreate(GL_ARRAY_BUFFER, sizeof(Vertex) * (size_t)count * vertexCount, NULL,
+			"skinned vertices");
+		indexBuffer = meshBufferCreate(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indexCount, idx, "skin indices");
+		identityBuffer = meshBufferCreate(GL_ARRAY_BUFFER, sizeof(glm::mat4), &identity, "skin identity");
+		free(rest);
+		free(idx);
+		vao = meshVertexArrayCreate(&vertexLayouts[VERTEX_FORMAT_FLOAT], vertexBuffer, indexBuffer, 0,
+			"skinned characters");
+		if (!meshInstanceAttribs(vao, identityBuffer)) {
+			warn("skinning: instanced arrays are not supported");
+			destroy();
+			return false;
+		}
+		GL_ERROR_DBG("skinning initialization");
+		info("skinning: %d characters of %d vertices, program %u", count, (int)vertexCount, program);
+		return true;
+	}
+
+	void destroy()
+	{
+		GLuint buffers[6] = {restBuffer, paletteBuffer, listBuffer, vertexBuffer, indexBuffer, identityBuffer};
+		int i;
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		for (i = 0; i < 6; i++)
+			if (buffers[i])
+				glState()->deleteBuffers(1, &buffers[i]);
+		if (program)
+			glState()->deleteProgram(program);
+		free(bases);
+		free(versions);
+		free(list);
+		free(palette);
+		free(counts);
+		free(baseVertices);
+		free(indexOffsets);
+		clear();
+	}
+
+	/* The joint matrices of the i-th character of list, from the rest
+	* pose to where the animator put them. */
+	void buildPalette(int i)
+	{
+		int c = (int)list[i], j;
+		const glm::mat4 *local = animator->joints + (size_t)c * joints;
+		glm::mat4 *m = palette + (size_t)i * joints;
+		glm::mat4 parent = glm::translate(bases[c]);
+		for (j = 0; j < joints; j++) {
+			/* the joint in the chain, then back from where the rest
+			* pose has it */
+			parent = parent * ((j > 0) ? glm::translate(glm::vec3(0.0f, segment, 0.0f)) : glm::mat4(1.0f)) * local[j];
+			m[j] = parent * glm::translate(glm::vec3(0.0f, -segment * (float)j, 0.0f));
+		}
+	}
+
+	/* Skin the characters whose pose changed since they were last, with
+	* their matrices computed on jobs if given. The animator must have been
+	* updated this frame. Returns the number of characters skinned. */
+	int update(JobSystem *jobs)
+	{
+		int c, n = 0, first;
+
+		skinned = 0;
+		if (!program)
+			return 0;
+		GL_DEBUG_GROUP("skinning");
+		for (c = 0; c < count; c++)
+			if (versions[c] != animator->versions[c]) {
+				versions[c] = animator->versions[c];
+				list[n++] = (GLuint)c;
+			}
+		if (!n)
+			return 0;
+		if (jobs)
+			jobs->run(skinPaletteChunk, this, n, ANIMATION_GRAIN);
+		else
+			skinPaletteChunk(this, 0, n);
+
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, paletteBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(glm::mat4) * (size_t)n * joints, palette);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, listBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * n, list);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glState()->useProgram(program);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, restBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, paletteBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, listBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, vertexBuffer);
+		for (first = 0; first < n; first += SKIN_MAX_DISPATCH) {
+			int part = (n - first < SKIN_MAX_DISPATCH) ? n - first : SKIN_MAX_DISPATCH;
+			glUniform4ui(countsLoc, (GLuint)vertexCount, (GLuint)joints, (GLuint)first, 0u);
+			glDispatchCompute((GLuint)((vertexCount + SKIN_GROUP - 1) / SKIN_GROUP), (GLuint)part, 1);
+		}
+		glState()->useProgram(0);
+		/* all passes draw from the vertices written above */
+		glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+		GL_ERROR_DBG("skinning");
+		skinned = n;
+		return n;
+	}
+
+	/* Draw all characters. The VAO must be bound. */
+	void draw() const
+	{
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, indexOffsets, count, baseVertices);
+		glState()->countDraw();
+	}
+} SkinnedCharacters;
+
+/* The loop body of the palettes of SkinnedCharacters::update. */
+static void skinPaletteChunk(void *user, int begin, int end)
+{
+	SkinnedCharacters *s = (SkinnedCharacters*)user;
+	int i;
+	for (i = begin; i < end; i++)
+		s->buildPalette(i);
+}
+
+#endif
@@ -0,0 +1,564 @@
+#ifndef HEADER_SPATIALGRID_H
+#define HEADER_SPATIALGRID_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <atomic>
+#include <math.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include "LargePages.h"
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* SPATIAL GRID: a spatial hash for many small objects                      *
+****************************************************************************/
+
+/* SpatialGrid: the objects sorted by the cell of a uniform grid their
+* center lies in, for the workloads with a million objects of about the
+* same size, where a hierarchy (Bvh.h) costs more to keep up than it saves.
+* The grid is unbounded: a cell is hashed to one of a power of two slots,
+* and the objects are sorted by slot with a counting sort, in passes over
+* all objects or slots which each split across the job system:
+*   hash:    the slot of each object, and its rank among the objects of
+*            that slot, from an atomic count per slot
+*   scan:    the counts become where each slot starts (a prefix sum, per
+*            chunk of slots, then the chunks)
+*   scatter: each object to its start plus rank, its sphere next to it
+*   bounds:  the box of the spheres of each slot
+* The objects of a slot are contiguous, so cull() tests the box of a slot
+* first, and only the spheres of the slots the frustum cuts one by one. It
+* sets visible[] in the sorted order, where the writes go one after the
+* other, and the objects of a cell end up drawn together. query() finds the neighbours of a point in the cells around it. Cells
+* which collide in a slot share it, so a slot may be larger than a cell,
+* and queries check the cell of each object.
+* GpuSpatialGrid below builds the same on the GPU, from a buffer of spheres,
+* for the culling pass of Scene.h.
+* The arrays per object come from largePageAlloc(), see LargePages.h. */
+#define SPATIAL_GRID_GRAIN 16384	/* objects or slots per parallel chunk */
+#define SPATIAL_GRID_CHUNKS 64		/* of slots in the scan, at most */
+#define SPATIAL_GRID_OBJECTS 32		/* per cell the slots are sized for */
+
+/* what a slot is to the frustum, also in shaders/spatial_grid.glsl */
+#define SPATIAL_GRID_OUTSIDE 0
+#define SPATIAL_GRID_PARTIAL 1
+#define SPATIAL_GRID_INSIDE 2
+
+/* Called for each object a query finds. */
+typedef void (*SpatialGridQueryFunc)(void *user, int object);
+
+/* The hash of cell x y z, as in shaders/spatial_grid.glsl. The primes of
+* Teschner et al., added rather than xor-ed: xor maps cells around the
+* origin which differ in sign onto each other, a third of them collide. */
+static unsigned int spatialGridHash(int x, int y, int z)
+{
+	return (unsigned int)x * 73856093u + (unsigned int)y * 19349663u + (unsigned int)z * 83492791u;
+}
+
+/* The slots for count objects of which about SPATIAL_GRID_OBJECTS share a
+* cell: a power of two, twice the cells, so few of them collide. */
+static int spatialGridSlots(int count, int max)
+{
+	int slots = 1;
+	while (slots < max && slots * SPATIAL_GRID_OBJECTS < 2 * count)
+		slots *= 2;
+	return slots;
+}
+
+static void spatialGridHashJob(void *user, int begin, int end);
+static void spatialGridSumJob(void *user, int begin, int end);
+static void spatialGridStartJob(void *user, int begin, int end);
+static void spatialGridScatterJob(void *user, int begin, int end);
+static void spatialGridBoundsJob(void *user, int begin, int end);
+static void spatialGridCullJob(void *user, int begin, int end);
+
+typedef struct {
+	/* the objects of the last build(), not owned */
+	const float *x, *y, *z, *radius;
+	int count, capacity;
+	float cellSize, invCellSize;
+	int slots;			/* a power of two */
+	std::atomic<unsigned int> *counts;	/* per slot, 0 between builds */
+	unsigned int *starts;		/* slots + 1, where the objects of each slot start */
+	unsigned int *slotOf, *rank;	/* per object */
+	int *items;			/* the objects, sorted by slot */
+	glm::vec4 *sorted;		/* their spheres, in the same order */
+	glm::vec4 *boundsMin, *boundsMax;	/* per slot, of the spheres; w: the largest radius */
+	unsigned char *visible;		/* per sorted object, the result of cull() */
+	unsigned int chunkStarts[SPATIAL_GRID_CHUNKS + 1];
+	int slotGrain;
+	bool concurrent;		/* the hash pass runs on more than one thread */
+	/* of the current cull() */
+	glm::vec4 planes[6];
+	float radiusScale;
+
+	void clear()
+	{
+		x = y = z = radius = NULL;
+		count = capacity = slots = 0;
+		cellSize = invCellSize = 1.0f;
+		counts = NULL;
+		starts = slotOf = rank = NULL;
+		items = NULL;
+		sorted = NULL;
+		boundsMin = boundsMax = NULL;
+		visible = NULL;
+	}
+
+	/* Allocate room for up to cap objects and s slots, a power of two.
+	* Returns true if successfull and false in case of an error. */
+	bool init(int cap, int s)
+	{
+		int i;
+		MemoryScope scope(MEMORY_SCENE);
+		clear();
+		counts = new (std::nothrow) std::atomic<unsigned int>[s];
+		starts = (unsigned int*)largePageAlloc(sizeof(unsigned int) * (s + 1));
+		slotOf = (unsigned int*)largePageAlloc(sizeof(unsigned int) * cap);
+		rank = (unsigned int*)largePageAlloc(sizeof(unsigned int) * cap);
+		items = (int*)largePageAlloc(sizeof(int) * cap);
+		sorted = (glm::vec4*)largePageAlloc(sizeof(glm::vec4) * cap);
+		boundsMin = (glm::vec4*)largePageAlloc(sizeof(glm::vec4) * s);
+		boundsMax = (glm::vec4*)largePageAlloc(sizeof(glm::vec4) * s);
+		visible = (unsigned char*)largePageAlloc(cap);
+		if (!counts || !starts || !slotOf || !rank || !items || !sorted || !boundsMin || !boundsMax || !visible) {
+			warn("spatial grid: failed to allocate %d objects", cap);
+			destroy();
+			return false;
+		}
+		for (i = 0; i < s; i++)
+			counts[i].store(0, std::memory_order_relaxed);
+		capacity = cap;
+		slots = s;
+		slotGrain = (s + SPATIAL_GRID_CHUNKS - 1) / SPATIAL_GRID_CHUNKS;
+		if (slotGrain < SPATIAL_GRID_GRAIN)
+			slotGrain = SPATIAL_GRID_GRAIN;
+		return true;
+	}
+
+	void destroy()
+	{
+		delete[] counts;
+		largePageFree(starts);
+		largePageFree(slotOf);
+		largePageFree(rank);
+		largePageFree(items);
+		largePageFree(sorted);
+		largePageFree(boundsMin);
+		largePageFree(boundsMax);
+		largePageFree(visible);
+		clear();
+	}
+
+	/* The slot of the cell x y z. */
+	unsigned int slot(int cx, int cy, int cz) const
+	{
+		return spatialGridHash(cx, cy, cz) & (unsigned int)(slots - 1);
+	}
+
+	/* The cell p lies in. floorf() is a call without SSE4.1, this is not. */
+	glm::ivec3 cell(const glm::vec3 &p) const
+	{
+		glm::vec3 f = p * invCellSize;
+		glm::ivec3 i(f);
+		return i - glm::ivec3(f.x < (float)i.x, f.y < (float)i.y, f.z < (float)i.z);
+	}
+
+	/* Sort the n spheres in the arrays px, py, pz and pr (which must stay
+	* valid until the next build) into cells of size cs, in parallel on
+	* jobs (which may be NULL). */
+	void build(const float *px, const float *py, const float *pz, const float *pr, int n, float cs,
+		JobSystem *jobs)
+	{
+		int c, chunks = (slots + slotGrain - 1) / slotGrain;
+		x = px;
+		y = py;
+		z = pz;
+		radius = pr;
+		count = n < capacity ? n : capacity;
+		cellSize = cs;
+		invCellSize = 1.0f / cs;
+		concurrent = jobs && jobs->threadCount > 0 && count > SPATIAL_GRID_GRAIN;
+		run(jobs, spatialGridHashJob, count, SPATIAL_GRID_GRAIN);
+		run(jobs, spatialGridSumJob, slots, slotGrain);
+		chunkStarts[0] = 0;
+		for (c = 0; c < chunks; c++)
+			chunkStarts[c + 1] += chunkStarts[c];
+		run(jobs, spatialGridStartJob, slots, slotGrain);
+		starts[slots] = (unsigned int)count;
+		run(jobs, spatialGridScatterJob, count, SPATIAL_GRID_GRAIN);
+		run(jobs, spatialGridBoundsJob, slots, slotGrain);
+	}
+
+	void run(JobSystem *jobs, JobFunc f, int n, int grain)
+	{
+		if (jobs)
+			jobs->run(f, this, n, grain);
+		else if (n > 0)
+			f(this, 0, n);
+	}
+
+	void hashRange(int begin, int end)
+	{
+		int i;
+		for (i = begin; i < end; i++) {
+			glm::ivec3 c = cell(glm::vec3(x[i], y[i], z[i]));
+			unsigned int s = slot(c.x, c.y, c.z);
+			slotOf[i] = s;
+			/* a locked add costs as much as all the rest */
+			if (concurrent) {
+				rank[i] = counts[s].fetch_add(1, std::memory_order_relaxed);
+			} else {
+				rank[i] = counts[s].load(std::memory_order_relaxed);
+				counts[s].store(rank[i] + 1, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/* the objects in the slots of a chunk, at the start of the next */
+	void sumRange(int begin, int end)
+	{
+		unsigned int sum = 0;
+		int s;
+		for (s = begin; s < end; s++)
+			sum += counts[s].load(std::memory_order_relaxed);
+		chunkStarts[begin / slotGrain + 1] = sum;
+	}
+
+	/* the starts of the slots, and the counts back to 0 for the next build */
+	void startRange(int begin, int end)
+	{
+		unsigned int start = chunkStarts[begin / slotGrain];
+		int s;
+		for (s = begin; s < end; s++) {
+			starts[s] = start;
+			start += counts[s].load(std::memory_order_relaxed);
+			counts[s].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void scatterRange(int begin, int end)
+	{
+		int i;
+		for (i = begin; i < end; i++) {
+			unsigned int k = starts[slotOf[i]] + rank[i];
+			items[k] = i;
+			sorted[k] = glm::vec4(x[i], y[i], z[i], radius[i]);
+		}
+	}
+
+	/* empty slots get an inverted box, which is outside of everything */
+	void boundsRange(int begin, int end)
+	{
+		int s;
+		for (s = begin; s < end; s++) {
+			glm::vec3 lo(1e30f), hi(-1e30f);
+			float r = 0.0f;
+			unsigned int k;
+			for (k = starts[s]; k < starts[s + 1]; k++) {
+				glm::vec3 c(sorted[k]);
+				lo = glm::min(lo, c - sorted[k].w);
+				hi = glm::max(hi, c + sorted[k].w);
+				r = glm::max(r, sorted[k].w);
+			}
+			boundsMin[s] = glm::vec4(lo, r);
+			boundsMax[s] = glm::vec4(hi, 0.0f);
+		}
+	}
+
+	/* Cull the spheres, their radii scaled by scale, against the frustum of
+	* the view projection matrix vp and set visible[] accordingly, in
+	* parallel on jobs. If done is given, this returns at once and the
+	* jobs count down done, otherwise it returns when visible[] is
+	* complete. */
+	void cull(const glm::mat4 &vp, float scale, JobSystem *jobs, JobCounter *done = NULL)
+	{
+		frustumPlanes(vp, planes);
+		radiusScale = scale;
+		if (done)
+			jobs->parallelFor(spatialGridCullJob, this, slots, slotGrain, done);
+		else
+			run(jobs, spatialGridCullJob, slots, slotGrain);
+	}
+
+	/* What the box of slot s, grown by the radii scaled beyond 1, is to
+	* the frustum, SPATIAL_GRID_*. */
+	int classify(int s) const
+	{
+		int p, state = SPATIAL_GRID_INSIDE;
+		if (starts[s] == starts[s + 1])
+			return SPATIAL_GRID_OUTSIDE;
+		float grow = (radiusScale > 1.0f) ? boundsMin[s].w * (radiusScale - 1.0f) : 0.0f;
+		glm::vec3 center = 0.5f * (glm::vec3(boundsMin[s]) + glm::vec3(boundsMax[s]));
+		glm::vec3 extent = 0.5f * (glm::vec3(boundsMax[s]) - glm::vec3(boundsMin[s])) + grow;
+		for (p = 0; p < 6; p++) {
+			glm::vec3 n(planes[p]);
+			float d = glm::dot(n, center) + planes[p].w;
+			float e = glm::dot(glm::abs(n), extent);
+			if (d < -e)
+				return SPATIAL_GRID_OUTSIDE;
+			if (d < e)
+				state = SPATIAL_GRID_PARTIAL;
+		}
+		return state;
+	}
+
+	void cullRange(int begin, int end)
+	{
+		int s, p;
+		for (s = begin; s < end; s++) {
+			int state = classify(s);
+			unsigned int k, first = starts[s], last = starts[s + 1];
+			if (state != SPATIAL_GRID_PARTIAL) {
+				memset(visible + first, state == SPATIAL_GRID_INSIDE, last - first);
+				continue;
+			}
+			for (k = first; k < last; k++) {
+				bool inside = true;
+				for (p = 0; p < 6 && inside; p++)
+					inside = glm::dot(glm::vec3(planes[p]), glm::vec3(sorted[k])) + planes[p].w >=
+						-sorted[k].w * radiusScale;
+				visible[k] = inside;
+			}
+		}
+	}
+
+	/* Call f for each object whose center is within r of center. Returns
+	* how many there are. */
+	int query(const glm::vec3 &center, float r, SpatialGridQueryFunc f, void *user) const
+	{
+		glm::ivec3 lo = cell(center - r), hi = cell(center + r);
+		int cx, cy, cz, found = 0;
+		for (cz = lo.z; cz <= hi.z; cz++) {
+			for (cy = lo.y; cy <= hi.y; cy++) {
+				for (cx = lo.x; cx <= hi.x; cx++) {
+					unsigned int s = slot(cx, cy, cz), k;
+					for (k = starts[s]; k < starts[s + 1]; k++) {
+						glm::vec3 p(sorted[k]);
+						/* of this cell, not another one in the slot */
+						if (cell(p) != glm::ivec3(cx, cy, cz))
+							continue;
+						glm::vec3 d = p - center;
+						if (glm::dot(d, d) <= r * r) {
+							f(user, items[k]);
+							found++;
+						}
+					}
+				}
+			}
+		}
+		return found;
+	}
+} SpatialGrid;
+
+/* the passes of SpatialGrid::build and cull, as jobs */
+static void spatialGridHashJob(void *user, int begin, int end)
+{
+	((SpatialGrid*)user)->hashRange(begin, end);
+}
+
+static void spatialGridSumJob(void *user, int begin, int end)
+{
+	((SpatialGrid*)user)->sumRange(begin, end);
+}
+
+static void spatialGridStartJob(void *user, int begin, int end)
+{
+	((SpatialGrid*)user)->startRange(begin, end);
+}
+
+static void spatialGridScatterJob(void *user, int begin, int end)
+{
+	((SpatialGrid*)user)->scatterRange(begin, end);
+}
+
+static void spatialGridBoundsJob(void *user, int begin, int end)
+{
+	((SpatialGrid*)user)->boundsRange(begin, end);
+}
+
+static void spatialGridCullJob(void *user, int begin, int end)
+{
+	((SpatialGrid*)user)->cullRange(begin, end);
+}
+
+/****************************************************************************
+* GPU SPATIAL GRID                                                         *
+****************************************************************************/
+
+/* GpuSpatialGrid: SpatialGrid built on the GPU by
+* shaders/spatial_grid.cs.glsl, from a buffer of spheres (xyz center,
+* w radius) as the culling pass of Scene.h reads them, a dispatch per pass:
+* the counts, the prefix sum in three (each group scans its
+* SPATIAL_GRID_GROUP slots in shared memory, one group scans the sums of
+* the groups, and these are added back), the scatter, and the boxes of the
+* slots, which are tested against the frustum right away. The culling
+* pass then skips the spheres of the slots outside and the plane tests of
+* those inside (see shaders/cull.cs.glsl). Nothing goes back to the CPU.
+* The slots are limited to what the scan covers, a group of groups. */
+#define SPATIAL_GRID_SHADER "shaders/spatial_grid.cs.glsl"
+#define SPATIAL_GRID_GROUP 1024	/* local size of the compute shader */
+#define SPATIAL_GRID_SLOTS_MAX (SPATIAL_GRID_GROUP * SPATIAL_GRID_GROUP)
+
+/* the bindings of the compute shader, and of its results in the culling
+* pass */
+#define SPATIAL_GRID_OBJECT_BINDING 5	/* slot and rank per object */
+#define SPATIAL_GRID_STATE_BINDING 6	/* SPATIAL_GRID_* per slot */
+
+/* the stages of the compute shader, a dispatch each */
+enum {
+	SPATIAL_GRID_COUNT = 0,	/* slot and rank per object */
+	SPATIAL_GRID_SCAN,	/* the starts of the slots within a group */
+	SPATIAL_GRID_SCAN_GROUPS,	/* the starts of the groups */
+	SPATIAL_GRID_ADD,	/* the starts of the slots */
+	SPATIAL_GRID_SCATTER,	/* the sorted objects */
+	SPATIAL_GRID_CELLS	/* the box of each slot, against the frustum */
+};
+
+typedef struct {
+	GLuint program;		/* 0 if not supported */
+	GLint stageLoc, countLoc, slotsLoc, invCellSizeLoc, planesLoc, radiusScaleLoc;
+	GLuint counts;		/* per slot, 0 between builds */
+	GLuint starts;		/* slots + 1 */
+	GLuint groupSums;	/* per group of slots */
+	GLuint objects;		/* slot and rank per object */
+	GLuint items;		/* the objects, sorted by slot */
+	GLuint sorted;		/* their spheres */
+	GLuint states;		/* per slot, of the last build */
+	int count, capacity, slots;
+	bool built;
+
+	void clear()
+	{
+		program = 0;
+		counts = starts = groupSums = objects = items = sorted = states = 0;
+		count = capacity = slots = 0;
+		built = false;
+	}
+
+	/* Build the program and allocate room for up to cap objects, the
+	* sources are loaded via cache.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(ShaderSourceCache *cache, int cap)
+	{
+		clear();
+		if (cap < 1 || !computeShaderSupported())
+			return false;
+		program = computeProgramBuild(cache, SPATIAL_GRID_SHADER);
+		if (!program)
+			return false;
+		stageLoc = glGetUniformLocation(program, "stage");
+		countLoc = glGetUniformLocation(program, "count");
+		slotsLoc = glGetUniformLocation(program, "slots");
+		invCellSizeLoc = glGetUniformLocation(program, "invCellSize");
+		planesLoc = glGetUniformLocation(program, "planes");
+		radiusScaleLoc = glGetUniformLocation(program, "radiusScale");
+		capacity = cap;
+		slots = spatialGridSlots(cap, SPATIAL_GRID_SLOTS_MAX);
+
+		GLuint buffers[7];
+		glGenBuffers(7, buffers);
+		counts = buffers[0];
+		starts = buffers[1];
+		groupSums = buffers[2];
+		objects = buffers[3];
+		items = buffers[4];
+		sorted = buffers[5];
+		states = buffers[6];
+		allocate(counts, sizeof(GLuint) * slots);
+		allocate(starts, sizeof(GLuint) * (slots + 1));
+		allocate(groupSums, sizeof(GLuint) * SPATIAL_GRID_GROUP);
+		allocate(objects, 2 * sizeof(GLuint) * cap);
+		allocate(items, sizeof(GLuint) * cap);
+		allocate(sorted, sizeof(glm::vec4) * cap);
+		allocate(states, sizeof(GLuint) * slots);
+		GLuint zero = 0;
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, counts);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		GL_ERROR_DBG("spatial grid initialization");
+		info("spatial grid: up to %d objects in %d slots, program %u", cap, slots, program);
+		return true;
+	}
+
+	void destroy()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		GLuint buffers[7] = { counts, starts, groupSums, objects, items, sorted, states };
+		int i;
+		for (i = 0; i < 7; i++) {
+			if (buffers[i])
+				glState()->deleteBuffers(1, &buffers[i]);
+		}
+		clear();
+	}
+
+	static void allocate(GLuint buffer, GLsizeiptr size)
+	{
+		MemoryScope scope(MEMORY_SCENE);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	/* Sort the n spheres in the buffer spheres into cells of size
+	* cellSize and classify the slots against the frustum of the view
+	* projection matrix vp, with the radii scaled by radiusScale. This uses
+	* its own program. */
+	void build(GLuint spheres, int n, float cellSize, const glm::mat4 &vp, float radiusScale)
+	{
+		glm::vec4 planes[6];
+		built = false;
+		if (!program || n < 1)
+			return;
+		GL_DEBUG_GROUP("spatial grid");
+		count = n < capacity ? n : capacity;
+		frustumPlanes(vp, planes);
+		glState()->useProgram(program);
+		glUniform1i(countLoc, count);
+		glUniform1i(slotsLoc, slots);
+		glUniform1f(invCellSizeLoc, 1.0f / cellSize);
+		glUniform4fv(planesLoc, 6, &planes[0][0]);
+		glUniform1f(radiusScaleLoc, radiusScale);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, spheres);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, counts);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, starts);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, groupSums);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, objects);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, items);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, sorted);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, states);
+		dispatch(SPATIAL_GRID_COUNT, count);
+		dispatch(SPATIAL_GRID_SCAN, slots);
+		dispatch(SPATIAL_GRID_SCAN_GROUPS, 1);
+		dispatch(SPATIAL_GRID_ADD, slots);
+		dispatch(SPATIAL_GRID_SCATTER, count);
+		dispatch(SPATIAL_GRID_CELLS, slots);
+		glState()->useProgram(0);
+		built = true;
+		GL_ERROR_DBG("spatial grid build");
+	}
+
+	/* Run stage with a thread per item, after the stage before. */
+	void dispatch(int stage, int n)
+	{
+		glUniform1i(stageLoc, stage);
+		glDispatchCompute((GLuint)(n + SPATIAL_GRID_GROUP - 1) / SPATIAL_GRID_GROUP, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	/* Make the slots of the objects and the states of the slots available
+	* to the culling pass. */
+	void bind() const
+	{
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, SPATIAL_GRID_OBJECT_BINDING, objects);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, SPATIAL_GRID_STATE_BINDING, states);
+	}
+} GpuSpatialGrid;
+
+#endif
@@ -0,0 +1,399 @@
+#ifndef HEADER_SPRITEBATCH_H
+#define HEADER_SPRITEBATCH_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Cube.h"
+#include "GLState.h"
+#include "Log.h"
+#include "MemoryStats.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* SPRITE BATCH: the 2D quads of a frame in one draw per blend mode         *
+****************************************************************************/
+
+/* SpriteBatch: the overlay, the HUD and any other 2D element would each
+* need a draw of their own, with their own texture, so all of them go
+* through this batch instead. The images are packed into the layers of one
+* GL_TEXTURE_2D_ARRAY, the atlas, by a shelf packer: each layer is filled
+* with rows (shelves) from the top, an image goes onto the lowest shelf it
+* fits on, or opens a new one below the last, or goes into the next layer.
+* Every image is surrounded by a copy of its edge texels, so the linear
+* filter does not pull in its neighbours. Image 0 is white, for the quads
+* of a single color.
+* A quad is a SpriteQuad of 32 bytes: its corners in 1/16 pixels, the
+* texels of the atlas it shows, the layer and the color. Any thread may
+* reserve quads (reserve, quad and sprite) between begin() and flush(),
+* with an atomic add into the region of the frame of a RingBuffer, and
+* write them right there; there is no list to copy. The quads are not
+* vertices: a buffer texture over the ring hands them to
+* shaders/sprite.vs.glsl, which takes quad gl_VertexID / 6 and builds the
+* corner from the rest, so flush() has no vertex array to set up and
+* issues one glDrawArrays per blend mode with quads, its first vertex
+* selecting the range of that mode in the region.
+* The quads of one reservation are drawn in their order, different
+* reservations of the same mode in the order they were made, which is only
+* defined on one thread. Those of SPRITE_BLEND_ADD go after all of
+* SPRITE_BLEND_ALPHA.
+* begin() and flush() must be called on the thread which owns the context,
+* and flush() after all threads are done writing. If the ring is not
+* persistently mapped, the region stays mapped from one to the other. */
+#define SPRITE_VS "shaders/sprite.vs.glsl"
+#define SPRITE_FS "shaders/sprite.fs.glsl"
+#define SPRITE_ATLAS_SIZE 1024	/* texels of a layer of the atlas, each way */
+#define SPRITE_ATLAS_LAYERS 4
+#define SPRITE_PADDING 1	/* texels around each image */
+#define SPRITE_MAX_IMAGES 1024
+#define SPRITE_MAX_SHELVES 128	/* per layer */
+#define SPRITE_MODE_QUADS 4096	/* per blend mode and frame */
+#define SPRITE_SUBPIXELS 16	/* of a pixel, in the corners of a quad */
+/* the 2x2 white texels of image 0 are at (1, 1), this is their middle,
+* where the filter only reads white */
+#define SPRITE_SOLID_UV (2u | 2u << 16)
+
+enum {
+	SPRITE_BLEND_ALPHA = 0,	/* over what is there, by the alpha of the quad */
+	SPRITE_BLEND_ADD,	/* added to what is there, scaled by the alpha */
+	SPRITE_BLEND_MODES
+};
+
+/* a quad as shaders/sprite.vs.glsl reads it, two RGBA32I texels */
+typedef struct {
+	GLint x0, y0, x1, y1;	/* corners in 1/SPRITE_SUBPIXELS pixels from the top left */
+	GLuint uv0, uv1;	/* texels of the atlas at the corners, u | v << 16 */
+	GLuint layer;		/* of the atlas */
+	GLuint color;		/* 0xRRGGBBAA, multiplies the texels */
+} SpriteQuad;
+
+/* a packed image, in texels of its layer, without the padding */
+typedef struct {
+	GLushort x, y, width, height;
+	GLushort layer;
+} SpriteImage;
+
+/* Write a quad of color rgba (0xRRGGBBAA) from (x0, y0) to (x1, y1), in
+* pixels from the top left corner, to q. */
+static inline void spriteSolid(SpriteQuad *q, float x0, float y0, float x1, float y1, GLuint rgba)
+{
+	q->x0 = (GLint)floorf(x0 * SPRITE_SUBPIXELS + 0.5f);
+	q->y0 = (GLint)floorf(y0 * SPRITE_SUBPIXELS + 0.5f);
+	q->x1 = (GLint)floorf(x1 * SPRITE_SUBPIXELS + 0.5f);
+	q->y1 = (GLint)floorf(y1 * SPRITE_SUBPIXELS + 0.5f);
+	q->uv0 = q->uv1 = SPRITE_SOLID_UV;
+	q->layer = 0;
+	q->color = rgba;
+}
+
+typedef struct SpriteBatch {
+	GLuint program;		/* 0 if not available */
+	GLint viewportSizeLoc;
+	GLuint vao;		/* empty, the quads come from the buffer texture */
+	GLuint atlas;		/* GL_TEXTURE_2D_ARRAY of RGBA8 */
+	GLuint quadTexture;	/* GL_TEXTURE_BUFFER of RGBA32I over ring */
+	RingBuffer ring;	/* SPRITE_BLEND_MODES * SPRITE_MODE_QUADS per frame */
+	SpriteImage images[SPRITE_MAX_IMAGES];
+	int imageCount;
+	/* the shelves of each layer: top, height and the width used */
+	GLushort shelfY[SPRITE_ATLAS_LAYERS][SPRITE_MAX_SHELVES];
+	GLushort shelfHeight[SPRITE_ATLAS_LAYERS][SPRITE_MAX_SHELVES];
+	GLushort shelfX[SPRITE_ATLAS_LAYERS][SPRITE_MAX_SHELVES];
+	int shelfCount[SPRITE_ATLAS_LAYERS];
+	SpriteQuad *quads;	/* the region of the frame, NULL outside of begin() and flush() */
+	GLint firstQuad;	/* of the region in the ring */
+	std::atomic<int> counts[SPRITE_BLEND_MODES];	/* quads reserved in this frame */
+	std::atomic<unsigned int> dropped;	/* quads which did not fit */
+	unsigned int draws;	/* of the last flush() */
+
+	void clear()
+	{
+		int i;
+		program = vao = atlas = quadTexture = 0;
+		memset(&ring, 0, sizeof(ring));
+		imageCount = 0;
+		for (i = 0; i < SPRITE_ATLAS_LAYERS; i++)
+			shelfCount[i] = 0;
+		quads = NULL;
+		firstQuad = 0;
+		for (i = 0; i < SPRITE_BLEND_MODES; i++)
+			counts[i].store(0, std::memory_order_relaxed);
+		dropped.store(0, std::memory_order_relaxed);
+		draws = 0;
+	}
+
+	/* Build the program, the atlas with the white image 0 and the ring,
+	* sources are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		static const GLuint white[4] = { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu };
+		GLsizeiptr size = (GLsizeiptr)(sizeof(SpriteQuad) * SPRITE_BLEND_MODES * SPRITE_MODE_QUADS);
+		GLint texels = 0;
+
+		clear();
+		/* the buffer texture spans all regions of the ring */
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &texels);
+		if ((GLsizeiptr)texels < size * RING_BUFFER_FRAMES / 16) {
+			warn("sprite batch: buffer textures of %d texels are too small", (int)texels);
+			return false;
+		}
+		program = programBuild(cache, SPRITE_VS, SPRITE_FS);
+		if (!program)
+			return false;
+		viewportSizeLoc = glGetUniformLocation(program, "viewportSize");
+		glState()->useProgram(program);
+		glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+		glUniform1i(glGetUniformLocation(program, "quads"), 1);
+		glUniform1f(glGetUniformLocation(program, "atlasScale"), 1.0f / SPRITE_ATLAS_SIZE);
+		glState()->useProgram(0);
+		if (!ring.init(GL_TEXTURE_BUFFER, size, "sprite quads")) {
+			destroy();
+			return false;
+		}
+
+		MemoryScope scope(MEMORY_TEXTURES);
+		glGenTextures(1, &atlas);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+		if (glTexStorage3D)
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, SPRITE_ATLAS_SIZE, SPRITE_ATLAS_SIZE,
+				SPRITE_ATLAS_LAYERS);
+		else
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, SPRITE_ATLAS_SIZE, SPRITE_ATLAS_SIZE,
+				SPRITE_ATLAS_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		glDebugLabel(GL_TEXTURE, atlas, "sprite atlas");
+		glGenTextures(1, &quadTexture);
+		glState()->bindTexture(GL_TEXTURE_BUFFER, quadTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, ring.buffer);
+		glState()->bindTexture(GL_TEXTURE_BUFFER, 0);
+		glDebugLabel(GL_TEXTURE, quadTexture, "sprite quads");
+		glGenVertexArrays(1, &vao);
+		glDebugLabel(GL_VERTEX_ARRAY, vao, "sprites");
+		if (addImage(white, 2, 2) != 0) {
+			destroy();
+			return false;
+		}
+		info("sprite batch: program %u, atlas of %d layers of %dx%d", program, SPRITE_ATLAS_LAYERS,
+			SPRITE_ATLAS_SIZE, SPRITE_ATLAS_SIZE);
+		GL_ERROR_DBG("sprite batch initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (quads)
+			unmap();
+		if (program)
+			glState()->deleteProgram(program);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		if (atlas)
+			glState()->deleteTextures(1, &atlas);
+		if (quadTexture)
+			glState()->deleteTextures(1, &quadTexture);
+		ring.destroy();
+		clear();
+	}
+
+	/* Find room for a rectangle of width x height texels, the padding
+	* included, on the shelves. Stores its corner and layer.
+	* Returns false if the atlas is full. */
+	bool pack(int width, int height, int *x, int *y, int *layer)
+	{
+		int l, i;
+
+		for (l = 0; l < SPRITE_ATLAS_LAYERS; l++) {
+			int best = -1, n = shelfCount[l];
+			for (i = 0; i < n; i++)
+				if (shelfHeight[l][i] >= height && shelfX[l][i] + width <= SPRITE_ATLAS_SIZE &&
+					(best < 0 || shelfHeight[l][i] < shelfHeight[l][best]))
+					best = i;
+			/* a shelf much higher than the image wastes the rest, a new
+			* one may fit it better */
+			int top = n ? shelfY[l][n - 1] + shelfHeight[l][n - 1] : 0;
+			if ((best < 0 || shelfHeight[l][best] > 2 * height) && n < SPRITE_MAX_SHELVES &&
+				top + height <= SPRITE_ATLAS_SIZE && width <= SPRITE_ATLAS_SIZE) {
+				shelfY[l][n] = (GLushort)top;
+				shelfHeight[l][n] = (GLushort)height;
+				shelfX[l][n] = 0;
+				shelfCount[l]++;
+				best = n;
+			}
+			if (best < 0)
+				continue;
+			*x = shelfX[l][best];
+			*y = shelfY[l][best];
+			*layer = l;
+			shelfX[l][best] = (GLushort)(shelfX[l][best] + width);
+			return true;
+		}
+		return false;
+	}
+
+	/* Pack the image of width x height RGBA8 texels, rows from the top,
+	* into the atlas. On the thread which owns the context.
+	* Returns its index for sprite(), -1 if it does not fit. */
+	int addImage(const void *rgba, int width, int height)
+	{
+		int x, y, layer, row;
+		int w = width + 2 * SPRITE_PADDING, h = height + 2 * SPRITE_PADDING;
+
+		if (width <= 0 || height <= 0 || imageCount >= SPRITE_MAX_IMAGES || !pack(w, h, &x, &y, &layer)) {
+			warn("sprite batch: no room for an image of %dx%d", width, height);
+			return -1;
+		}
+		/* the image with its edges repeated into the padding */
+		GLuint *padded = (GLuint*)malloc(sizeof(GLuint) * w * h);
+		if (!padded)
+			return -1;
+		const GLuint *src = (const GLuint*)rgba;
+		for (row = 0; row < h; row++) {
+			int sy = row - SPRITE_PADDING, col;
+			sy = sy < 0 ? 0 : (sy >= height ? height - 1 : sy);
+			for (col = 0; col < w; col++) {
+				int sx = col - SPRITE_PADDING;
+				sx = sx < 0 ? 0 : (sx >= width ? width - 1 : sx);
+				padded[row * w + col] = src[sy * width + sx];
+			}
+		}
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, padded);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		free(padded);
+
+		SpriteImage *image = &images[imageCount];
+		image->x = (GLushort)(x + SPRITE_PADDING);
+		image->y = (GLushort)(y + SPRITE_PADDING);
+		image->width = (GLushort)width;
+		image->height = (GLushort)height;
+		image->layer = (GLushort)layer;
+		return imageCount++;
+	}
+
+	/* Open the region of this frame for the quads, on the thread which
+	* owns the context. A region which was not flushed is dropped. */
+	void begin()
+	{
+		int i;
+		GLintptr offset;
+
+		if (!program)
+			return;
+		if (quads)
+			unmap();
+		ring.beginFrame();
+		quads = (SpriteQuad*)ring.map(ring.regionSize, sizeof(SpriteQuad), &offset);
+		firstQuad = (GLint)(offset / (GLintptr)sizeof(SpriteQuad));
+		for (i = 0; i < SPRITE_BLEND_MODES; i++)
+			counts[i].store(0, std::memory_order_relaxed);
+	}
+
+	/* Reserve n quads of blend mode, from any thread.
+	* Returns where to write them, NULL if they do not fit or the batch
+	* is not open. */
+	SpriteQuad *reserve(int blend, int n)
+	{
+		if (!quads)
+			return NULL;
+		int first = counts[blend].load(std::memory_order_relaxed);
+		do {
+			if (first + n > SPRITE_MODE_QUADS) {
+				dropped.fetch_add((unsigned int)n, std::memory_order_relaxed);
+				return NULL;
+			}
+		} while (!counts[blend].compare_exchange_weak(first, first + n, std::memory_order_relaxed));
+		return quads + blend * SPRITE_MODE_QUADS + first;
+	}
+
+	/* Add a quad of color rgba from (x0, y0) to (x1, y1), in pixels from
+	* the top left corner, from any thread. */
+	void quad(int blend, float x0, float y0, float x1, float y1, GLuint rgba)
+	{
+		SpriteQuad *q = reserve(blend, 1);
+		if (q)
+			spriteSolid(q, x0, y0, x1, y1, rgba);
+	}
+
+	/* Add image, as returned by addImage, with its top left corner at
+	* (x, y) and scaled by scale, its texels multiplied by rgba, from any
+	* thread. */
+	void sprite(int blend, int image, float x, float y, float scale, GLuint rgba)
+	{
+		const SpriteImage *i = &images[image];
+		SpriteQuad *q = reserve(blend, 1);
+		if (!q)
+			return;
+		spriteSolid(q, x, y, x + i->width * scale, y + i->height * scale, rgba);
+		q->uv0 = (GLuint)i->x | (GLuint)i->y << 16;
+		q->uv1 = (GLuint)(i->x + i->width) | (GLuint)(i->y + i->height) << 16;
+		q->layer = i->layer;
+	}
+
+	/* Close the region without drawing it. */
+	void unmap()
+	{
+		if (!ring.mapped)
+			glState()->bindBuffer(ring.target, ring.buffer);
+		ring.unmap();
+		ring.endFrame();
+		quads = NULL;
+	}
+
+	/* Draw the quads of this frame into the bound framebuffer of width x
+	* height pixels, one draw per blend mode with quads, or drop them if
+	* that is empty. */
+	void flush(int width, int height)
+	{
+		GLsizei n[SPRITE_BLEND_MODES];
+		int i;
+
+		draws = 0;
+		if (!quads)
+			return;
+		for (i = 0; i < SPRITE_BLEND_MODES; i++)
+			n[i] = (GLsizei)counts[i].load(std::memory_order_acquire);
+		unmap();
+		if (width <= 0 || height <= 0 || !(n[SPRITE_BLEND_ALPHA] || n[SPRITE_BLEND_ADD]))
+			return;
+
+		GL_DEBUG_GROUP("sprites");
+		glState()->viewport(0, 0, width, height);
+		glState()->disable(GL_DEPTH_TEST);
+		glState()->useProgram(program);
+		glUniform2f(viewportSizeLoc, (GLfloat)width, (GLfloat)height);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+		glState()->activeTexture(GL_TEXTURE1);
+		glState()->bindTexture(GL_TEXTURE_BUFFER, quadTexture);
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->bindVertexArray(vao);
+		glState()->raster(RASTER_BLEND);
+		for (i = 0; i < SPRITE_BLEND_MODES; i++) {
+			if (!n[i])
+				continue;
+			if (i == SPRITE_BLEND_ADD)
+				glState()->blendFunc(GL_SRC_ALPHA, GL_ONE);
+			glDrawArrays(GL_TRIANGLES, 6 * (firstQuad + i * SPRITE_MODE_QUADS), 6 * n[i]);
+			glState()->countDraw();
+			draws++;
+		}
+		glState()->raster(RASTER_DEFAULT);
+		glState()->enable(GL_DEPTH_TEST);
+	}
+} SpriteBatch;
+
+/* the one batch, of the thread which owns the context */
+inline SpriteBatch *spriteBatch()
+{
+	static SpriteBatch batch;
+	return &batch;
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef HEADER_STARTUP_H
+#define HEADER_STARTUP_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <atomic>
+#include "Log.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* STARTUP TIMELINE                                                         *
+****************************************************************************/
+
+/* Where the time from the start of main() to the first frame goes. The
+* startup is cut into phases which follow one another: phase(name) ends the
+* one running and starts the next, firstFrame() ends the last one when the
+* first frame is done. That frame waits for the GPU with glFinish, so it
+* counts until the frame is really drawn, not only until it is submitted;
+* later frames do not. The time between the phases, if end() closed one
+* before the next began, shows up as "other".
+* The breakdown is logged with the total, printed as a table by
+* --startup-bench, which exits right after the first frame, and written as
+* JSON by --startup-out. With PROFILE_ZONES the phases are zones of the
+* thread which ran them as well, so they show up in the Chrome trace. The
+* clock is that of profileNow(), which works before GLFW does. */
+#define STARTUP_PHASES 32
+
+typedef struct {
+	const char *name;	/* a string literal */
+	unsigned long long begin, end;	/* profileNow() */
+} StartupPhase;
+
+typedef struct {
+	StartupPhase phases[STARTUP_PHASES];
+	int count;
+	bool open;		/* the last phase is still running */
+	unsigned long long origin;	/* profileNow() at the start of main() */
+	unsigned long long total;	/* nanoseconds to the first frame, 0 before */
+	std::atomic<bool> done;	/* the first frame is drawn, the main loop may read it */
+	bool exitAfterFirstFrame;	/* --startup-bench */
+
+	/* Start the timeline, first thing in main(). */
+	void start()
+	{
+		origin = profileNow();
+		count = 0;
+		open = false;
+		total = 0;
+		done.store(false, std::memory_order_relaxed);
+	}
+
+	/* End the running phase at now. */
+	void end()
+	{
+		if (!open)
+			return;
+		StartupPhase *p = &phases[count - 1];
+		p->end = profileNow();
+		open = false;
+#ifdef PROFILE_ZONES
+		ProfileThread *t = profileThread();
+		if (t)
+			t->record(p->name, p->begin, p->end, t->depth);
+#endif
+	}
+
+	/* End the running phase and start the phase name, a string literal.
+	* Does nothing after the first frame. */
+	void phase(const char *name)
+	{
+		if (total)
+			return;
+		end();
+		if (count == STARTUP_PHASES)
+			return;
+		phases[count].name = name;
+		phases[count].begin = phases[count].end = profileNow();
+		count++;
+		open = true;
+	}
+
+	/* The first frame was submitted: wait until the GPU drew it and end
+	* the timeline. Only the first call does something. */
+	void firstFrame()
+	{
+		if (total)
+			return;
+		glFinish();
+		end();
+		total = profileNow() - origin;
+		if (!total)
+			total = 1;
+		info("startup: %.1f ms to the first frame", (double)total * 1e-6);
+		done.store(true, std::memory_order_release);
+	}
+
+	/* The main loop should end, the first frame is drawn and that was all
+	* it was run for. */
+	bool exit() const
+	{
+		return exitAfterFirstFrame && done.load(std::memory_order_acquire);
+	}
+
+	/* the time which no phase covers */
+	unsigned long long other() const
+	{
+		unsigned long long covered = 0;
+		for (int i = 0; i < count; i++)
+			covered += phases[i].end - phases[i].begin;
+		return total > covered ? total - covered : 0;
+	}
+
+	/* Print the breakdown as a table into f. */
+	void print(FILE *f) const
+	{
+		int i;
+		if (!total) {
+			fprintf(f, "startup: no frame was drawn\n");
+			return;
+		}
+		fprintf(f, "%-24s %10s %10s %7s\n", "phase", "start ms", "ms", "%");
+		for (i = 0; i < count; i++) {
+			const StartupPhase *p = &phases[i];
+			fprintf(f, "%-24s %10.2f %10.2f %6.1f%%\n", p->name, (double)(p->begin - origin) * 1e-6,
+				(double)(p->end - p->begin) * 1e-6, 100.0 * (double)(p->end - p->begin) / (double)total);
+		}
+		fprintf(f, "%-24s %10s %10.2f %6.1f%%\n", "other", "", (double)other() * 1e-6,
+			100.0 * (double)other() / (double)total);
+		fprintf(f, "%-24s %10s %10.2f\n", "total", "", (double)total * 1e-6);
+	}
+
+	/* Write the breakdown as JSON into filename, or stdout if it is NULL.
+	* Returns true if successfull and false in case of an error. */
+	bool write(const char *filename) const
+	{
+		FILE *f = filename ? fopen(filename, "wt") : stdout;
+		int i;
+		if (!f) {
+			warn("failed to open startup output '%s'", filename);
+			return false;
+		}
+		fprintf(f, "{\n  \"unit\": \"ms\",\n  \"first_frame\": %s,\n  \"total\": %.3f,\n  \"other\": %.3f,\n"
+			"  \"phases\": [", total ? "true" : "false", (double)total * 1e-6, (double)other() * 1e-6);
+		for (i = 0; i < count; i++) {
+			const StartupPhase *p = &phases[i];
+			fprintf(f, "%s\n    {\"name\": \"%s\", \"start\": %.3f, \"duration\": %.3f}", i ? "," : "", p->name,
+				(double)(p->begin - origin) * 1e-6, (double)(p->end - p->begin) * 1e-6);
+		}
+		fprintf(f, "\n  ]\n}\n");
+		bool ok = !ferror(f);
+		if (filename) {
+			ok = (fclose(f) == 0) && ok;
+			info("startup breakdown written to '%s'", filename);
+		}
+		return ok;
+	}
+} StartupTimeline;
+
+/* The timeline of the application, shared by all translation units like
+* logSink(). */
+inline StartupTimeline *startupTimeline()
+{
+	static StartupTimeline timeline;
+	return &timeline;
+}
+
+#endif
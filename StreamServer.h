@@ -0,0 +1,279 @@
+#ifndef HEADER_STREAMSERVER_H
+#define HEADER_STREAMSERVER_H
+
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+#include "Log.h"
+#include "Profiler.h"
+#include "Capture.h"
+#include "InputQueue.h"
+
+/****************************************************************************
+* STREAM SERVER: a remote viewer over UDP                                  *
+****************************************************************************/
+
+/* StreamServer: a session for a viewer on another machine, typically with
+* the application headless on a GPU server (--stream-server PORT). The
+* viewer says hello on the UDP port, and the capture streams the frames to
+* it as a live stream (see Capture.h): converted to NV12 on the GPU,
+* encoded by the hardware encoder and sent by ffmpeg as MPEG-TS over UDP to
+* the port the viewer named, which any player opens (ffplay -fflags nobuffer
+* udp://@:PORT). The key presses and clicks of the viewer come back as
+* datagrams, which poll() pushes into the input queue like the GLFW callbacks
+* do, on the thread which polls the window events; they are handled by the
+* same code as local input.
+* The latency adds up from the frame, the readback (a frame, see
+* CAPTURE_SLOTS), the encoder (no B-frames, no lookahead) and the network;
+* with a hardware encoder it stays well below 50 ms at 60 frames per second.
+* The messages are datagrams of big endian 32 bit numbers behind the type
+* as 4 characters:
+*   HELO  viewer -> server, the UDP port of the video
+*   OKAY  server -> viewer, the width and height of the video
+*   BUSY  server -> viewer, there is a viewer already or a recording
+*   INPT  viewer -> server, an InputEvent: type (INPUT_KEY or INPUT_BUTTON),
+*         action, mods, key, scancode, x and y as the bits of floats
+*   PING  viewer -> server, 8 bytes, answered right away with
+*   PONG  server -> viewer, the same 8 bytes and the frames streamed so far
+*   QUIT  viewer -> server, the viewer leaves
+* A viewer which sends nothing, not even a PING, for STREAM_TIMEOUT seconds
+* has left as well. Not available on Windows. */
+#define STREAM_TIMEOUT 5.0	/* seconds */
+#define STREAM_MESSAGE_MAX 64
+#define STREAM_URL_FORMAT "udp://%s%.*s%s:%u?pkt_size=1316"	/* 7 TS packets a datagram */
+#define STREAM_HOST_MAX 64	/* characters of a numeric address with its scope */
+
+static void streamPut32(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v >> 24);
+	p[1] = (unsigned char)(v >> 16);
+	p[2] = (unsigned char)(v >> 8);
+	p[3] = (unsigned char)v;
+}
+
+static unsigned int streamGet32(const unsigned char *p)
+{
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+typedef struct {
+	int fd;			/* the UDP socket, -1 if there is no server */
+#ifndef _WIN32
+	struct sockaddr_storage viewer;
+	socklen_t viewerLength;	/* 0 if there is no viewer */
+#endif
+	char url[CAPTURE_PATH_MAX];	/* the video goes there */
+	double lastHeard;	/* profileSeconds() of the last message of the viewer */
+	unsigned int events;	/* pushed into the input queue */
+	unsigned int viewers;
+	bool quit;		/* the viewer pressed escape and there is no window to close */
+
+	void clear()
+	{
+		fd = -1;
+#ifndef _WIN32
+		memset(&viewer, 0, sizeof(viewer));
+		viewerLength = 0;
+#endif
+		url[0] = 0;
+		lastHeard = 0.0;
+		events = viewers = 0;
+		quit = false;
+	}
+
+	/* Listen for viewers on UDP port, of IPv6 and IPv4.
+	* Returns true if successfull and false in case of an error. */
+	bool init(int port)
+	{
+#ifdef _WIN32
+		(void)port;
+		clear();
+		warn("stream server: not supported on Windows");
+		return false;
+#else
+		struct sockaddr_in6 addr;
+		int off = 0;
+		clear();
+		fd = socket(AF_INET6, SOCK_DGRAM, 0);
+		if (fd < 0) {
+			warn("stream server: failed to create a socket: %s", strerror(errno));
+			return false;
+		}
+		setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+		memset(&addr, 0, sizeof(addr));
+		addr.sin6_family = AF_INET6;
+		addr.sin6_addr = in6addr_any;
+		addr.sin6_port = htons((unsigned short)port);
+		if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) || fcntl(fd, F_SETFL, O_NONBLOCK)) {
+			warn("stream server: failed to listen on UDP port %d: %s", port, strerror(errno));
+			destroy();
+			return false;
+		}
+		info("stream server: waiting for a viewer on UDP port %d", port);
+		return true;
+#endif
+	}
+
+	bool streaming() const
+	{
+		return url[0] != 0;
+	}
+
+#ifndef _WIN32
+	/* Send message type with count numbers to address. */
+	void send(const struct sockaddr_storage *address, socklen_t length, const char *type, const unsigned int *numbers,
+		int count)
+	{
+		unsigned char m[STREAM_MESSAGE_MAX];
+		int i;
+		memcpy(m, type, 4);
+		for (i = 0; i < count; i++)
+			streamPut32(m + 4 + 4 * i, numbers[i]);
+		sendto(fd, m, 4 + 4 * (size_t)count, 0, (const struct sockaddr*)address, length);
+	}
+
+	/* The viewer at address, which sent HELO for the video on port, takes
+	* over the capture unless something else has it. */
+	void hello(const struct sockaddr_storage *address, socklen_t length, unsigned int port, FrameCapture *capture,
+		int width, int height)
+	{
+		char host[NI_MAXHOST];
+		const char *h = host;
+		unsigned int size[2] = { (unsigned int)width, (unsigned int)height };
+		bool same = viewerLength == length && !memcmp(&viewer, address, length);
+
+		if ((viewerLength && !same) || (capture->recording && !streaming()) || !port || port > 65535) {
+			send(address, length, "BUSY", NULL, 0);
+			return;
+		}
+		/* a repeated hello, its answer got lost */
+		if (same) {
+			send(address, length, "OKAY", size, 2);
+			return;
+		}
+		if (getnameinfo((const struct sockaddr*)address, length, host, sizeof(host), NULL, 0, NI_NUMERICHOST))
+			return;
+		/* an IPv4 viewer on the dual-stack socket */
+		if (!strncmp(h, "::ffff:", 7) && strchr(h, '.'))
+			h += 7;
+		bool v6 = strchr(h, ':') != NULL;
+		int n = mysnprintf(url, sizeof(url), STREAM_URL_FORMAT, v6 ? "[" : "", STREAM_HOST_MAX, h, v6 ? "]" : "",
+			port);
+		if (n < 0 || (size_t)n >= sizeof(url) || strlen(h) > STREAM_HOST_MAX || !capture->start(url, capture->fps)) {
+			url[0] = 0;
+			send(address, length, "BUSY", NULL, 0);
+			return;
+		}
+		memcpy(&viewer, address, length);
+		viewerLength = length;
+		viewers++;
+		info("stream server: viewer %s, video to '%s'", h, url);
+		send(address, length, "OKAY", size, 2);
+	}
+
+	/* The viewer left, or went silent: stop its stream. */
+	void leave(FrameCapture *capture, const char *why)
+	{
+		info("stream server: the viewer %s, %u input events", why, events);
+		if (capture->recording)
+			capture->stop();
+		url[0] = 0;
+		viewerLength = 0;
+	}
+
+	/* Push the event of INPT message numbers into input.
+	* Returns false if it is not one the viewer may send. */
+	bool input(InputQueue *queue, const unsigned int *n)
+	{
+		InputEvent e;
+		e.time = profileSeconds();
+		e.type = (unsigned char)n[0];
+		e.action = (unsigned char)n[1];
+		e.mods = (unsigned short)n[2];
+		e.key = (int)n[3];
+		e.scancode = (int)n[4];
+		memcpy(&e.x, &n[5], sizeof(float));
+		memcpy(&e.y, &n[6], sizeof(float));
+		/* the key is an index into the key state */
+		if (n[1] > GLFW_REPEAT || (n[0] == INPUT_KEY && (e.key < 0 || e.key > GLFW_KEY_LAST)) ||
+			(n[0] == INPUT_BUTTON && (e.key < 0 || e.key > GLFW_MOUSE_BUTTON_LAST)) ||
+			(n[0] != INPUT_KEY && n[0] != INPUT_BUTTON))
+			return false;
+		if (queue->push(e))
+			events++;
+		return true;
+	}
+#endif
+
+	/* Handle the messages which arrived, without waiting: the hello of a
+	* viewer starts the stream of capture, of frames of width x height,
+	* its input goes into input. On the thread which polls the window
+	* events, and of the GL context, where the capture is started. */
+	void poll(InputQueue *queue, FrameCapture *capture, int width, int height)
+	{
+#ifdef _WIN32
+		(void)queue; (void)capture; (void)width; (void)height;
+#else
+		unsigned char m[STREAM_MESSAGE_MAX];
+		unsigned int n[(STREAM_MESSAGE_MAX - 4) / 4];
+		struct sockaddr_storage address;
+		socklen_t length;
+		ssize_t size;
+		int i, count;
+
+		if (fd < 0)
+			return;
+		for (;;) {
+			length = sizeof(address);
+			size = recvfrom(fd, m, sizeof(m), 0, (struct sockaddr*)&address, &length);
+			if (size < 0 && errno == EINTR)
+				continue;
+			if (size < 4)
+				break;
+			count = (int)(size - 4) / 4;
+			for (i = 0; i < count; i++)
+				n[i] = streamGet32(m + 4 + 4 * i);
+			if (!memcmp(m, "HELO", 4) && count >= 1) {
+				hello(&address, length, n[0], capture, width, height);
+				lastHeard = profileSeconds();
+				continue;
+			}
+			/* the rest only from the viewer */
+			if (!viewerLength || length != viewerLength || memcmp(&address, &viewer, length))
+				continue;
+			lastHeard = profileSeconds();
+			if (!memcmp(m, "INPT", 4) && count >= 7) {
+				if (!input(queue, n))
+					warn("stream server: an input event the viewer may not send");
+			} else if (!memcmp(m, "PING", 4) && count >= 2) {
+				unsigned int pong[3] = { n[0], n[1], capture->frames };
+				send(&address, length, "PONG", pong, 3);
+			} else if (!memcmp(m, "QUIT", 4)) {
+				leave(capture, "left");
+			}
+		}
+		if (viewerLength && profileSeconds() - lastHeard > STREAM_TIMEOUT)
+			leave(capture, "went silent");
+#endif
+	}
+
+	void destroy()
+	{
+#ifndef _WIN32
+		if (fd >= 0)
+			close(fd);
+#endif
+		if (viewers)
+			info("stream server: %u viewers", viewers);
+		clear();
+	}
+} StreamServer;
+
+#endif
@@ -0,0 +1,651 @@
+#ifndef HEADER_STREAMER_H
+#define HEADER_STREAMER_H
+
+#include <GLFW/glfw3.h>
+#include <glad/glad.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Profiler.h"
+#include "ShaderHelpers.h"
+#include "MeshFile.h"
+#include "AsyncIO.h"
+#include "AssetTasks.h"
+#include "UnpackRing.h"
+
+/****************************************************************************
+* RESOURCE STREAMING                                                       *
+****************************************************************************/
+
+/* Streamer: loads meshes on a loader thread, so the render thread keeps
+* drawing while they are read and uploaded. The loader has a GL context of
+* its own, created with the one of the window as its share context, so the
+* buffer objects it creates are visible to both. For each request it maps
+* the mesh file, creates the buffers straight from the mapping (the pages
+* of the file are the staging memory, the driver copies them out), places
+* a fence behind the upload and flushes it. The render thread takes a mesh
+* once its fence is signaled, so it never waits for the upload, and only
+* then touches the buffers, e.g. to create a VAO, which is not shared
+* between contexts.
+* The requests and the results each go through a single-producer,
+* single-consumer ring which never blocks: a full ring rejects a request,
+* and the loader holds a result until there is room. Like the writer of
+* the log, the loader sleeps for STREAM_IDLE_MS when it has nothing to do.
+* Besides meshes, the loader commits and fills the pages of sparse textures,
+* and releases them again, for VirtualTexture.h: the texels of a page are
+* generated on the loader thread by the function in the request, right
+* into an UnpackRing, and uploaded from there with an offset, so the loader
+* does not wait for the driver to copy them (without buffer storage, they
+* are generated into memory of the loader's and copied). And it
+* uploads blocks of memory into buffers of their own, e.g. the chunk meshes
+* of VoxelWorld.h, which the requester keeps until the buffer is handed
+* back.
+* The mesh files are not mapped but read with AsyncIO, in chunks which are
+* all in flight together, into a staging buffer which is persistently
+* mapped, and the buffers are copied from there on the GPU; the next file
+* is read into it once those copies are done. Files which do not fit into
+* STREAM_STAGING_SIZE, and those of the asset archive, are mapped as before.
+* Such a load is an AssetTask (see AssetTasks.h) of up to STREAM_TASK_MAX:
+* it waits for the staging memory, for its reads, for the parsing on the
+* job system and for the fence of the copies before it without blocking
+* the loader, which meanwhile goes on with the other requests; so the
+* results come back in the order they are done, not in that of the
+* requests.
+* GLFW only creates windows on the main thread, so init() and destroy() are
+* called from there. */
+#define STREAM_QUEUE_MAX 16	/* requests or results in flight, a power of two */
+#define STREAM_PATH_MAX 256
+#define STREAM_IDLE_MS 2	/* loader sleep when there is nothing to do */
+#define STREAM_STAGING_SIZE (32 << 20)	/* bytes of the mesh files read at once */
+#define STREAM_TASK_MAX 4	/* mesh files loading at once */
+#define STREAM_TASK_POLL_US 250	/* loader sleep while they wait */
+#define STREAM_UNPACK_SIZE (8 << 20)	/* bytes of the texels of pages in flight */
+
+/* kinds of StreamItems */
+enum {
+	STREAM_MESH = 0,	/* load a mesh file */
+	STREAM_PAGE_COMMIT,	/* commit a page of a sparse texture and fill it */
+	STREAM_PAGE_RELEASE,	/* decommit a page */
+	STREAM_BUFFER		/* create a buffer from a block of memory */
+};
+
+/* Fill the width * height RGBA8 texels of a page at x, y of level. Called
+* on the loader thread. */
+typedef void (*StreamPageFunc)(const void *user, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+	GLubyte *rgba);
+
+/* a page of the sparse GL_TEXTURE_2D texture */
+typedef struct {
+	GLuint texture;
+	GLint level, x, y;
+	GLsizei width, height;
+	int index;		/* for the owner */
+	StreamPageFunc fill;
+	const void *user;
+	GLsync wait;		/* release: the GPU is done with the page after this */
+} StreamPage;
+
+/* a block of memory to create a buffer object from */
+typedef struct {
+	const void *data;	/* owned by the requester, read on the loader thread */
+	GLsizeiptr size;
+	const char *label;	/* of the buffer, a string literal */
+	int index;		/* for the owner */
+	GLuint buffer;		/* the result */
+} StreamBuffer;
+
+typedef struct {
+	int kind;		/* STREAM_* */
+	char filename[STREAM_PATH_MAX];
+	MeshBuffers mesh;	/* the result */
+	StreamPage page;
+	StreamBuffer buffer;
+	GLsync fence;		/* signaled once the upload is done, 0 if there is none */
+	bool ok;
+} StreamItem;
+
+struct Streamer;
+
+/* the load of a mesh file through the staging memory */
+typedef struct {
+	AssetTask task;		/* first, the scheduler hands it back */
+	struct Streamer *streamer;
+	StreamItem item;
+	AsyncFile file;
+	MeshFile mesh;
+	bool parsed;
+	bool staging;		/* it holds the staging memory */
+	bool busy;		/* the slot is in use */
+	double start;
+} StreamMeshTask;
+
+/* StreamQueue: a single-producer, single-consumer ring of StreamItems. The
+* producer fills the slot at head before it advances head, the consumer
+* reads the one at tail before it advances tail, so neither ever sees a
+* slot the other is writing. */
+typedef struct {
+	StreamItem items[STREAM_QUEUE_MAX];
+	std::atomic<unsigned int> head;		/* items pushed, advanced by the producer */
+	std::atomic<unsigned int> tail;		/* items popped, advanced by the consumer */
+
+	void init()
+	{
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+	}
+
+	/* Producer: append a copy of item. Returns false if the ring is full. */
+	bool push(const StreamItem *item)
+	{
+		unsigned int h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) >= STREAM_QUEUE_MAX)
+			return false;
+		items[h % STREAM_QUEUE_MAX] = *item;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Consumer: the oldest item, NULL if the ring is empty. It stays in the
+	* ring until pop(). */
+	StreamItem *front()
+	{
+		unsigned int t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire))
+			return NULL;
+		return &items[t % STREAM_QUEUE_MAX];
+	}
+
+	/* Consumer: release the item front() returned. */
+	void pop()
+	{
+		tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+} StreamQueue;
+
+typedef struct Streamer {
+	GLFWwindow *context;	/* hidden window of the loader's context, NULL if not running */
+	std::thread thread;
+	std::atomic<bool> running;
+	StreamQueue requests;	/* render thread to loader */
+	StreamQueue results;	/* loader to render thread */
+	int pending;		/* requested and not handed over yet, render thread only */
+	GLubyte *texels;	/* of a page without the unpack ring, loader thread only */
+	GLsizei texelCapacity;	/* in texels */
+	/* the rest is the loader thread's */
+	UnpackRing unpack;	/* the pages are uploaded from, if supported */
+	bool directIO;		/* the mesh files bypass the page cache */
+	AsyncIO io;
+	GLuint staging;		/* the mesh files are read into, 0 without buffer storage */
+	GLubyte *stagingMap;	/* its mapping, or plain memory */
+	void *stagingMemory;	/* that memory, unaligned */
+	GLsync stagingFence;	/* the copies out of staging are done after this */
+	bool stagingBusy;	/* a task reads into it or copies out of it */
+	JobSystem *jobs;	/* parses the mesh files, may be NULL */
+	AssetScheduler tasks;
+	StreamMeshTask meshTasks[STREAM_TASK_MAX];
+
+	void clear()
+	{
+		context = NULL;
+		running.store(false);
+		pending = 0;
+		texels = NULL;
+		texelCapacity = 0;
+		unpack.clear();
+		directIO = false;
+		staging = 0;
+		stagingMap = NULL;
+		stagingMemory = NULL;
+		stagingFence = 0;
+		stagingBusy = false;
+		jobs = NULL;
+	}
+
+	/* Create the loader context sharing the objects of the context of
+	* share, which must be current, and start the loader thread, which
+	* reads the mesh files direct if asked to and parses them on
+	* jobSystem, if there is one.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(GLFWwindow *share, bool direct = false, JobSystem *jobSystem = NULL)
+	{
+		clear();
+		directIO = direct;
+		jobs = jobSystem;
+		requests.init();
+		results.init();
+		/* the other hints are still those of share */
+		glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+		context = glfwCreateWindow(1, 1, "loader", NULL, share);
+		glfwDefaultWindowHints();
+		if (!context) {
+			info("streamer: failed to create a shared context, loading synchronously");
+			return false;
+		}
+		running.store(true);
+		thread = std::thread([this]() { loader(); });
+		info("streamer: started the loader thread");
+		return true;
+	}
+
+	/* Stop the loader and release the meshes which were never handed
+	* over. The context of the render thread must be current. */
+	void destroy()
+	{
+		StreamItem *item;
+
+		if (!context)
+			return;
+		running.store(false);
+		thread.join();
+		while ((item = requests.front())) {
+			if (item->page.wait)
+				glDeleteSync(item->page.wait);
+			requests.pop();
+		}
+		while ((item = results.front())) {
+			if (item->fence)
+				glDeleteSync(item->fence);
+			if (item->ok && item->kind == STREAM_MESH) {
+				GLuint buffers[3] = { item->mesh.vertexBuffer, item->mesh.indexBuffer, item->mesh.meshletBuffer };
+				glState()->deleteBuffers(3, buffers);
+			}
+			if (item->ok && item->kind == STREAM_BUFFER)
+				glState()->deleteBuffers(1, &item->buffer.buffer);
+			results.pop();
+		}
+		free(texels);
+		glfwDestroyWindow(context);
+		clear();
+	}
+
+	/* Queue loading the mesh file filename. poll() hands it over once it is
+	* on the GPU. Returns false if the streamer is not running or full. */
+	bool requestMesh(const char *filename)
+	{
+		StreamItem item;
+
+		if (!context || strlen(filename) >= STREAM_PATH_MAX)
+			return false;
+		memset(&item, 0, sizeof(item));
+		item.kind = STREAM_MESH;
+		strcpy(item.filename, filename);
+		if (!requests.push(&item)) {
+			warn("streamer: more than %d requests", STREAM_QUEUE_MAX);
+			return false;
+		}
+		pending++;
+		return true;
+	}
+
+	/* Queue committing and filling page (kind STREAM_PAGE_COMMIT) or
+	* releasing it (STREAM_PAGE_RELEASE) once page->wait is signaled, which
+	* the loader deletes. poll() hands it back when it is done. Returns
+	* false if the streamer is not running or full, then the caller keeps
+	* page->wait. */
+	bool requestPage(int kind, const StreamPage *page)
+	{
+		StreamItem item;
+
+		if (!context)
+			return false;
+		memset(&item, 0, sizeof(item));
+		item.kind = kind;
+		item.page = *page;
+		if (!requests.push(&item))
+			return false;
+		pending++;
+		return true;
+	}
+
+	/* Queue creating a buffer from the memory of buffer, which must stay
+	* as it is until poll() hands the buffer back. Returns false if the
+	* streamer is not running or full. */
+	bool requestBuffer(const StreamBuffer *buffer)
+	{
+		StreamItem item;
+
+		if (!context)
+			return false;
+		memset(&item, 0, sizeof(item));
+		item.kind = STREAM_BUFFER;
+		item.buffer = *buffer;
+		item.buffer.buffer = 0;
+		if (!requests.push(&item))
+			return false;
+		pending++;
+		return true;
+	}
+
+	/* Take the next request which is done, without waiting for its upload.
+	* Meshes which failed to load are dropped with a warning.
+	* Returns true and fills done, or false if none is ready. */
+	bool poll(StreamItem *done)
+	{
+		StreamItem *item;
+
+		while (pending && (item = results.front())) {
+			if (item->fence) {
+				GLenum status = glClientWaitSync(item->fence, 0, 0);
+				if (status == GL_TIMEOUT_EXPIRED)
+					return false;
+				if (status == GL_WAIT_FAILED)
+					warn("streamer: waiting for an upload failed");
+				glDeleteSync(item->fence);
+				item->fence = 0;
+			}
+			*done = *item;
+			results.pop();
+			pending--;
+			if (done->kind != STREAM_MESH)
+				return true;
+			if (done->ok) {
+				info("streamer: '%s' is ready", done->filename);
+				return true;
+			}
+			warn("streamer: failed to load '%s'", done->filename);
+		}
+		return false;
+	}
+
+	/* Commit and fill, or release, the page of item. Runs on the loader
+	* thread. */
+	void loadPage(StreamItem *item)
+	{
+		StreamPage *p = &item->page;
+		GLsizei n = p->width * p->height;
+
+		glState()->bindTexture(GL_TEXTURE_2D, p->texture);
+		if (item->kind == STREAM_PAGE_RELEASE) {
+			/* on the GPU, behind the last draw reading the page */
+			glWaitSync(p->wait, 0, GL_TIMEOUT_IGNORED);
+			glDeleteSync(p->wait);
+			p->wait = 0;
+			glTexPageCommitmentARB(GL_TEXTURE_2D, p->level, p->x, p->y, 0, p->width, p->height, 1, GL_FALSE);
+			glState()->bindTexture(GL_TEXTURE_2D, 0);
+			item->ok = true;
+			return;
+		}
+		GLintptr offset = 0;
+		GLubyte *dst = unpack.buffer ? (GLubyte*)unpack.alloc(4 * (GLsizeiptr)n, 4, &offset) : NULL;
+		if (!dst && n > texelCapacity) {
+			GLubyte *t = (GLubyte*)realloc(texels, 4 * (size_t)n);
+			if (!t) {
+				glState()->bindTexture(GL_TEXTURE_2D, 0);
+				item->ok = false;
+				return;
+			}
+			texels = t;
+			texelCapacity = n;
+		}
+		p->fill(p->user, p->level, p->x, p->y, p->width, p->height, dst ? dst : texels);
+		glTexPageCommitmentARB(GL_TEXTURE_2D, p->level, p->x, p->y, 0, p->width, p->height, 1, GL_TRUE);
+		if (dst) {
+			unpack.bind(true);
+			glTexSubImage2D(GL_TEXTURE_2D, p->level, p->x, p->y, p->width, p->height, GL_RGBA, GL_UNSIGNED_BYTE,
+				BUFFER_OFFSET(offset));
+			unpack.bind(false);
+			unpack.fence();
+		} else {
+			glTexSubImage2D(GL_TEXTURE_2D, p->level, p->x, p->y, p->width, p->height, GL_RGBA, GL_UNSIGNED_BYTE,
+				texels);
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		item->ok = true;
+		item->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+	}
+
+	/* Create the staging memory the mesh files are read into: a buffer
+	* which stays mapped, so the reads land where the GPU copies them from,
+	* or, without buffer storage, memory the buffers are created from. */
+	void initStaging()
+	{
+		MemoryScope scope(MEMORY_STAGING);
+		if (glCaps()->bufferStorage) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glGenBuffers(1, &staging);
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, staging);
+			glBufferStorage(GL_COPY_READ_BUFFER, STREAM_STAGING_SIZE, NULL, flags);
+			stagingMap = (GLubyte*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, STREAM_STAGING_SIZE, flags);
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+			glDebugLabel(GL_BUFFER, staging, "stream staging");
+			if (!stagingMap) {
+				glState()->deleteBuffers(1, &staging);
+				staging = 0;
+			}
+		}
+		if (!stagingMap) {
+			stagingMemory = malloc(STREAM_STAGING_SIZE + ASYNC_IO_ALIGN);
+			if (stagingMemory)
+				stagingMap = (GLubyte*)asyncIOAlign((GLuint64)(size_t)stagingMemory);
+		}
+		GL_ERROR_DBG("stream staging");
+	}
+
+	void destroyStaging()
+	{
+		if (stagingFence)
+			glDeleteSync(stagingFence);
+		if (staging) {
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, staging);
+			glUnmapBuffer(GL_COPY_READ_BUFFER);
+			glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+			glState()->deleteBuffers(1, &staging);
+		}
+		free(stagingMemory);
+		staging = 0;
+		stagingMap = NULL;
+		stagingMemory = NULL;
+		stagingFence = 0;
+	}
+
+	/* Delete what the loader made for item, which never reaches the render
+	* thread. */
+	static void discard(StreamItem *item)
+	{
+		if (item->fence)
+			glDeleteSync(item->fence);
+		item->fence = 0;
+		if (item->ok && item->kind == STREAM_MESH) {
+			GLuint buffers[3] = { item->mesh.vertexBuffer, item->mesh.indexBuffer, item->mesh.meshletBuffer };
+			glState()->deleteBuffers(3, buffers);
+		}
+		if (item->ok && item->kind == STREAM_BUFFER)
+			glState()->deleteBuffers(1, &item->buffer.buffer);
+		item->ok = false;
+	}
+
+	/* Start loading the mesh file of request through the staging memory,
+	* as a task. Runs on the loader thread.
+	* Returns 1 if it was started, 0 if it is not loaded that way (see
+	* above) and -1 if all tasks are busy, then the request waits. */
+	int startMesh(const StreamItem *request)
+	{
+		StreamMeshTask *m = NULL;
+		int i;
+
+		if (!stagingMap || assetArchive()->find(request->filename))
+			return 0;
+		for (i = 0; i < STREAM_TASK_MAX && !m; i++) {
+			if (!meshTasks[i].busy)
+				m = &meshTasks[i];
+		}
+		if (!m)
+			return -1;
+		/* direct reads need aligned memory, which a mapping need not be */
+		if (!io.open(&m->file, request->filename, directIO && !((size_t)stagingMap % ASYNC_IO_ALIGN)))
+			return 0;
+		if (asyncIOAlign(m->file.size) > STREAM_STAGING_SIZE) {
+			io.close(&m->file);
+			return 0;
+		}
+		m->streamer = this;
+		m->item = *request;
+		m->parsed = false;
+		m->staging = false;
+		m->busy = true;
+		tasks.start(&m->task, meshTask);
+		return 1;
+	}
+
+	/* Parse the mesh file of a StreamMeshTask in the staging memory. */
+	static void parseMesh(void *user, int begin, int end)
+	{
+		StreamMeshTask *m = (StreamMeshTask*)user;
+		(void)begin;
+		(void)end;
+		m->parsed = m->mesh.openMemory(m->item.filename, m->streamer->stagingMap, m->file.size);
+	}
+
+	/* The steps of a StreamMeshTask: wait for the staging memory and the
+	* copies of the last file out of it, read the file into it, parse it on
+	* the job system, copy the buffers out on the GPU behind a fence, and
+	* hand the result over once there is room. */
+	static void meshTask(AssetTask *t)
+	{
+		StreamMeshTask *m = (StreamMeshTask*)t;
+		Streamer *s = m->streamer;
+
+		ASSET_TASK_BEGIN(t);
+		while (s->stagingBusy && !t->cancelled)
+			ASSET_YIELD(t);
+		if (t->cancelled)
+			goto done;
+		s->stagingBusy = m->staging = true;
+		if (s->stagingFence) {
+			t->fence = s->stagingFence;
+			s->stagingFence = 0;
+			ASSET_AWAIT_FENCE(t);
+			if (t->cancelled)
+				goto done;
+		}
+		m->start = glfwGetTime();
+		s->tasks.read(t, &m->file, 0, m->file.size, s->stagingMap);
+		ASSET_AWAIT_IO(t);
+		if (t->cancelled)
+			goto done;
+		if (!s->tasks.readDone(t)) {
+			warn("streamer: failed to read '%s'", m->item.filename);
+		} else {
+			s->tasks.parallelFor(t, parseMesh, m, 1, 1);
+			ASSET_AWAIT_JOBS(t);
+			if (t->cancelled)
+				goto done;
+		}
+		if (m->parsed) {
+			info("streamer: read '%s', %u KB in %.1f ms (%s%s)", m->item.filename,
+				(unsigned)(m->file.size >> 10), (glfwGetTime() - m->start) * 1000.0, s->io.backend,
+				m->file.direct ? ", direct" : "");
+			m->mesh.createBuffers(&m->item.mesh, s->staging);
+			m->mesh.close();
+			m->item.ok = true;
+			if (s->staging)
+				s->stagingFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			/* the render thread waits for this, it must reach the GPU */
+			m->item.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+		}
+		s->io.close(&m->file);
+		s->stagingBusy = m->staging = false;
+		while (!t->cancelled && !s->results.push(&m->item))
+			ASSET_YIELD(t);
+		if (t->cancelled)
+			discard(&m->item);
+done:
+		s->io.close(&m->file);
+		if (m->staging)
+			s->stagingBusy = m->staging = false;
+		m->busy = false;
+		ASSET_TASK_END(t);
+	}
+
+	/* Load one request into item. Runs on the loader thread. */
+	void load(StreamItem *item)
+	{
+		MeshFile file;
+
+		if (item->kind == STREAM_BUFFER) {
+			StreamBuffer *b = &item->buffer;
+			b->buffer = meshBufferCreate(GL_ARRAY_BUFFER, b->size, b->data, b->label);
+			item->ok = b->buffer != 0;
+			item->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+			return;
+		}
+		if (item->kind != STREAM_MESH) {
+			loadPage(item);
+			return;
+		}
+
+		item->ok = file.open(item->filename);
+		if (!item->ok)
+			return;
+		file.createBuffers(&item->mesh);
+		file.close();
+		/* the render thread waits for this, it must reach the GPU */
+		item->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+	}
+
+	/* The loader thread. */
+	void loader()
+	{
+		StreamItem *request;
+		int i;
+
+		glfwMakeContextCurrent(context);
+		PROFILE_THREAD("streamer");
+		io.init();
+		initStaging();
+		unpack.init(STREAM_UNPACK_SIZE, "stream unpack");
+		tasks.init(&io, jobs);
+		for (i = 0; i < STREAM_TASK_MAX; i++)
+			meshTasks[i].busy = false;
+		while (running.load()) {
+			int waiting = tasks.poll();
+			request = requests.front();
+			if (request && request->kind == STREAM_MESH) {
+				int started = startMesh(request);
+				if (started > 0) {
+					requests.pop();
+					continue;
+				}
+				/* held until a task is free */
+				if (started < 0)
+					request = NULL;
+			}
+			if (!request) {
+				if (waiting)
+					std::this_thread::sleep_for(std::chrono::microseconds(STREAM_TASK_POLL_US));
+				else
+					std::this_thread::sleep_for(std::chrono::milliseconds(STREAM_IDLE_MS));
+				continue;
+			}
+			StreamItem item = *request;
+			requests.pop();
+			{
+				PROFILE_ZONE("load");
+				load(&item);
+			}
+			bool queued = results.push(&item);
+			while (!queued && running.load()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(STREAM_IDLE_MS));
+				tasks.poll();
+				queued = results.push(&item);
+			}
+			/* stopped with a full ring, destroy() never sees this one */
+			if (!queued)
+				discard(&item);
+		}
+		tasks.destroy();
+		unpack.destroy();
+		destroyStaging();
+		io.destroy();
+		glfwMakeContextCurrent(NULL);
+	}
+} Streamer;
+
+#endif
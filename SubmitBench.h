@@ -0,0 +1,455 @@
+#ifndef HEADER_SUBMITBENCH_H
+#define HEADER_SUBMITBENCH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glad/glad.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "FrustumCuller.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Scene.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* DRAW SUBMISSION BENCHMARK                                                *
+****************************************************************************/
+
+/* For the --bench-submit mode: the same grid of n cubes, drawn with every
+* way the application submits its draws, for n from 1 up to a maximum in
+* steps of 10, to tell which one a GPU and its driver like at which count:
+* - per-object: a uniform and a glDrawElements per cube, like the cube
+*   without --instanced,
+* - instanced: one glDrawElementsInstanced, the position a per-instance
+*   attribute, like Cube::drawInstanced,
+* - multi-draw: one glMultiDrawElementsIndirect of a command per cube,
+*   which selects its position by the base instance, like Scene::draw,
+* - multi-draw+culling: the commands of the cubes in the frustum appended by
+*   the culling shader of the scene (shaders/cull.cs.glsl), and drawn by
+*   glMultiDrawElementsIndirectCountARB, like Scene::cull,
+* - pulled: one glDrawArraysInstanced without vertex attributes, the shader
+*   makes up the cube and reads the position from a storage block, like
+*   Cube::drawPulled.
+* The camera sits in front of one side of the grid and looks through it,
+* with a narrow view which leaves out the cubes near the other sides. Each count is drawn SUBMIT_BENCH_FRAMES times after
+* a frame of warm-up; the CPU time is that of the calls which submit the
+* frame, the GPU time that between timestamps around them, and the calls
+* those through the GLStateCache plus the draws, uniforms and dispatches
+* made directly. A strategy whose frames take longer than
+* SUBMIT_BENCH_MAX_MS stops there. The strategies the context does not
+* support are left out. */
+#define SUBMIT_BENCH_VS "shaders/submit_bench.vs.glsl"
+#define SUBMIT_BENCH_FS "shaders/overlay.fs.glsl"
+#define SUBMIT_BENCH_FRAMES 10
+#define SUBMIT_BENCH_MAX_MS 1000.0	/* per frame, CPU or GPU */
+#define SUBMIT_BENCH_SPACING 3.0f	/* between the centers of the cubes of side 1 */
+
+enum {
+	SUBMIT_PER_OBJECT = 0,
+	SUBMIT_INSTANCED,
+	SUBMIT_MULTI_DRAW,
+	SUBMIT_MULTI_DRAW_CULLED,
+	SUBMIT_PULLED,
+	SUBMIT_STRATEGIES
+};
+static const char *const submitStrategyNames[SUBMIT_STRATEGIES] = {
+	"per-object", "instanced", "multi-draw", "multi-draw+culling", "pulled" };
+
+/* the programs, by how they read the positions */
+#define SUBMIT_PROGRAM_INSTANCED 1u
+#define SUBMIT_PROGRAM_PULLED 2u
+#define SUBMIT_PROGRAMS 3
+static const char *const submitBenchDefines[] = { "INSTANCED", "PULLED" };
+
+/* what one strategy measured at one count */
+typedef struct {
+	double cpuMs, gpuMs;	/* mean per frame */
+	double calls, draws;	/* per frame */
+	GLuint visible;		/* cubes drawn */
+} SubmitBenchResult;
+
+typedef struct {
+	GLuint programs[SUBMIT_PROGRAMS];	/* 0 if it failed to build */
+	GLint positionLoc, viewProjectionLoc[SUBMIT_PROGRAMS];
+	GLuint cullProgram;
+	GLint cullPlanesLoc, cullCountLoc;
+	GLuint vao, instancedVao, pulledVao;
+	GLuint vertexBuffer, indexBuffer;
+	GLuint positionBuffer;	/* xyz: center, w: half the side, also the bounding spheres */
+	GLuint commandBuffer, visibleBuffer, counterBuffer;
+	GLuint queries[2];
+	glm::vec4 *positions;	/* of count cubes */
+	GLsizei count;
+	glm::mat4 viewProjection;
+	glm::vec4 planes[6];
+
+	void clear()
+	{
+		int i;
+		for (i = 0; i < SUBMIT_PROGRAMS; i++) {
+			programs[i] = 0;
+			viewProjectionLoc[i] = -1;
+		}
+		positionLoc = -1;
+		cullProgram = 0;
+		cullPlanesLoc = cullCountLoc = -1;
+		vao = instancedVao = pulledVao = 0;
+		vertexBuffer = indexBuffer = positionBuffer = 0;
+		commandBuffer = visibleBuffer = counterBuffer = 0;
+		queries[0] = queries[1] = 0;
+		positions = NULL;
+		count = 0;
+	}
+
+	/* Build the programs from cache and make up the cube.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		static const GLushort indices[36] = { 0, 3, 1, 0, 2, 3, 5, 6, 4, 5, 7, 6, 4, 2, 0, 4, 6, 2,
+			1, 7, 5, 1, 3, 7, 2, 7, 3, 2, 6, 7, 4, 1, 5, 4, 0, 1 };
+		glm::vec3 corners[8];
+		unsigned int i;
+
+		clear();
+		for (i = 0; i < SUBMIT_PROGRAMS; i++) {
+			/* the pulled cubes need storage buffers */
+			if (i == SUBMIT_PROGRAM_PULLED && !glCaps()->storageBuffers)
+				continue;
+			programs[i] = programBuild(cache, SUBMIT_BENCH_VS, SUBMIT_BENCH_FS, submitBenchDefines,
+				(int)(sizeof(submitBenchDefines) / sizeof(submitBenchDefines[0])), i);
+			if (programs[i])
+				viewProjectionLoc[i] = glGetUniformLocation(programs[i], "benchViewProjection");
+		}
+		if (!programs[0] || !programs[SUBMIT_PROGRAM_INSTANCED]) {
+			warn("submission benchmark: failed to build the programs");
+			destroy();
+			return false;
+		}
+		positionLoc = glGetUniformLocation(programs[0], "objectPosition");
+		if (glCaps()->multiDrawIndirect && glCaps()->drawIndirectCount && computeShaderSupported()) {
+			cullProgram = computeProgramBuild(cache, SCENE_CULL_SHADER);
+			if (cullProgram) {
+				cullPlanesLoc = glGetUniformLocation(cullProgram, "planes");
+				cullCountLoc = glGetUniformLocation(cullProgram, "objectCount");
+				/* only the frustum, with the bounding spheres of the cubes */
+				glState()->useProgram(cullProgram);
+				glUniform1f(glGetUniformLocation(cullProgram, "radiusScale"), sqrtf(3.0f));
+				glUniform1f(glGetUniformLocation(cullProgram, "lodScale"), 0.0f);
+				glUniform1i(glGetUniformLocation(cullProgram, "grid"), 0);
+				glUniform1i(glGetUniformLocation(cullProgram, "occlusion"), 0);
+				glState()->useProgram(0);
+			}
+		}
+
+		for (i = 0; i < 8; i++)
+			corners[i] = glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+		GLuint buffers[6];
+		glGenBuffers(6, buffers);
+		vertexBuffer = buffers[0];
+		indexBuffer = buffers[1];
+		positionBuffer = buffers[2];
+		commandBuffer = buffers[3];
+		visibleBuffer = buffers[4];
+		counterBuffer = buffers[5];
+		glState()->bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+		glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+		/* the positions go with the instanced VAO, the pulled one has
+		* nothing at all */
+		GLuint vaos[3];
+		glGenVertexArrays(3, vaos);
+		vao = vaos[0];
+		instancedVao = vaos[1];
+		pulledVao = vaos[2];
+		for (i = 0; i < 2; i++) {
+			glState()->bindVertexArray(vaos[i]);
+			glState()->bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), BUFFER_OFFSET(0));
+			glEnableVertexAttribArray(0);
+			glState()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+			if (i == 0)
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		}
+		glState()->bindVertexArray(0);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+		glDebugLabel(GL_VERTEX_ARRAY, vao, "submission benchmark");
+		glDebugLabel(GL_VERTEX_ARRAY, instancedVao, "submission benchmark instanced");
+		glGenQueries(2, queries);
+		GL_ERROR_DBG("submission benchmark initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < SUBMIT_PROGRAMS; i++)
+			if (programs[i])
+				glState()->deleteProgram(programs[i]);
+		if (cullProgram)
+			glState()->deleteProgram(cullProgram);
+		if (vao) {
+			GLuint vaos[3] = { vao, instancedVao, pulledVao };
+			glState()->deleteVertexArrays(3, vaos);
+		}
+		if (vertexBuffer) {
+			GLuint buffers[6] = { vertexBuffer, indexBuffer, positionBuffer, commandBuffer, visibleBuffer,
+				counterBuffer };
+			glState()->deleteBuffers(6, buffers);
+		}
+		if (queries[0])
+			glDeleteQueries(2, queries);
+		free(positions);
+		clear();
+	}
+
+	/* Whether the context draws with strategy (SUBMIT_*). */
+	bool supported(int strategy) const
+	{
+		if (strategy == SUBMIT_MULTI_DRAW)
+			return glCaps()->multiDrawIndirect;
+		if (strategy == SUBMIT_MULTI_DRAW_CULLED)
+			return cullProgram != 0;
+		if (strategy == SUBMIT_PULLED)
+			return programs[SUBMIT_PROGRAM_PULLED] != 0;
+		return true;
+	}
+
+	/* Lay out n cubes in a grid and aim the camera at it, for a target of
+	* width x height pixels.
+	* Returns true if successfull and false in case of an error. */
+	bool setCount(GLsizei n, int width, int height)
+	{
+		GLsizei i;
+		/* all positions are written anew */
+		free(positions);
+		positions = (glm::vec4*)malloc(sizeof(glm::vec4) * n);
+		DrawElementsIndirectCommand *commands = (DrawElementsIndirectCommand*)malloc(sizeof(DrawElementsIndirectCommand) * n);
+		count = 0;
+		if (!positions || !commands) {
+			warn("submission benchmark: failed to allocate %d cubes", (int)n);
+			free(commands);
+			return false;
+		}
+		count = n;
+		int side = (int)ceil(cbrt((double)n));
+		while (side * side * side < n)
+			side++;
+		float half = 0.5f * (float)(side - 1) * SUBMIT_BENCH_SPACING;
+		for (i = 0; i < n; i++) {
+			glm::vec3 cell((float)(i % side), (float)((i / side) % side), (float)(i / (side * side)));
+			positions[i] = glm::vec4(cell * SUBMIT_BENCH_SPACING - half, 0.5f);
+			commands[i].count = 36;
+			commands[i].instanceCount = 1;
+			commands[i].firstIndex = 0;
+			commands[i].baseVertex = 0;
+			commands[i].baseInstance = (GLuint)i;
+		}
+		glm::vec3 eye(0.0f, 0.0f, -half - 2.0f * SUBMIT_BENCH_SPACING);
+		glm::mat4 projection = glm::perspective(glm::radians(40.0f), (float)width / (float)glm::max(height, 1),
+			0.1f, 4.0f * half + 4.0f * SUBMIT_BENCH_SPACING);
+		viewProjection = projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		frustumPlanes(viewProjection, planes);
+
+		glState()->bindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * n, positions, GL_STATIC_DRAW);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+		if (glCaps()->multiDrawIndirect) {
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * n, commands, GL_STATIC_DRAW);
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, visibleBuffer);
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * n, NULL, GL_DYNAMIC_COPY);
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		}
+		free(commands);
+
+		glState()->bindVertexArray(instancedVao);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+		GLint loc = glGetAttribLocation(programs[SUBMIT_PROGRAM_INSTANCED], "instPosition");
+		if (loc >= 0) {
+			glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), BUFFER_OFFSET(0));
+			glVertexAttribDivisor(loc, 1);
+			glEnableVertexAttribArray(loc);
+		}
+		glState()->bindVertexArray(0);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+		GL_ERROR_DBG("submission benchmark layout");
+		return true;
+	}
+
+	/* Submit one frame of the cubes with strategy. Returns the number of
+	* GL calls made directly, those through the GLStateCache come on top. */
+	unsigned int submit(int strategy)
+	{
+		static const GLuint zero = 0;
+		unsigned int calls = 0;
+		GLsizei i;
+
+		switch (strategy) {
+		case SUBMIT_PER_OBJECT:
+			glState()->useProgram(programs[0]);
+			glState()->bindVertexArray(vao);
+			for (i = 0; i < count; i++) {
+				glUniform4fv(positionLoc, 1, &positions[i][0]);
+				glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, BUFFER_OFFSET(0));
+				glState()->countDraw();
+			}
+			calls += 2 * (unsigned int)count;
+			break;
+		case SUBMIT_INSTANCED:
+			glState()->useProgram(programs[SUBMIT_PROGRAM_INSTANCED]);
+			glState()->bindVertexArray(instancedVao);
+			glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, BUFFER_OFFSET(0), count);
+			glState()->countDraw();
+			calls++;
+			break;
+		case SUBMIT_MULTI_DRAW:
+			glState()->useProgram(programs[SUBMIT_PROGRAM_INSTANCED]);
+			glState()->bindVertexArray(instancedVao);
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, BUFFER_OFFSET(0), count, 0);
+			glState()->countDraw();
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			calls++;
+			break;
+		case SUBMIT_MULTI_DRAW_CULLED:
+			glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+			glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero);
+			glState()->useProgram(cullProgram);
+			glUniform4fv(cullPlanesLoc, 6, &planes[0][0]);
+			glUniform1ui(cullCountLoc, (GLuint)count);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, positionBuffer);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleBuffer);
+			glState()->bindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer);
+			glDispatchCompute(((GLuint)count + SCENE_CULL_GROUP_SIZE - 1) / SCENE_CULL_GROUP_SIZE, 1, 1);
+			glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+			glState()->useProgram(programs[SUBMIT_PROGRAM_INSTANCED]);
+			glState()->bindVertexArray(instancedVao);
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, visibleBuffer);
+			glState()->bindBuffer(GL_PARAMETER_BUFFER_ARB, counterBuffer);
+			glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, 0, count, 0);
+			glState()->countDraw();
+			glState()->bindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+			glState()->bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			calls += 6;
+			break;
+		case SUBMIT_PULLED:
+			glState()->useProgram(programs[SUBMIT_PROGRAM_PULLED]);
+			glState()->bindVertexArray(pulledVao);
+			glState()->bindBufferRange(GL_SHADER_STORAGE_BUFFER, CUBE_INSTANCE_SSBO_BINDING, positionBuffer, 0,
+				sizeof(glm::vec4) * count);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, count);
+			glState()->countDraw();
+			calls++;
+			break;
+		}
+		return calls;
+	}
+
+	/* Draw the cubes with strategy SUBMIT_BENCH_FRAMES times, after a
+	* frame of warm-up, and measure it into r. */
+	void measure(int strategy, SubmitBenchResult *r)
+	{
+		int f;
+		GLuint64 gpu = 0;
+		unsigned long long cpu = 0;
+		unsigned int calls = 0, issued = glState()->issued, draws = glState()->draws;
+
+		unsigned int program = (strategy == SUBMIT_PULLED) ? SUBMIT_PROGRAM_PULLED :
+			(strategy == SUBMIT_PER_OBJECT) ? 0u : SUBMIT_PROGRAM_INSTANCED;
+
+		glState()->useProgram(programs[program]);
+		glUniformMatrix4fv(viewProjectionLoc[program], 1, GL_FALSE, &viewProjection[0][0]);
+		for (f = 0; f <= SUBMIT_BENCH_FRAMES; f++) {
+			GLuint64 begin, end;
+			if (f == 1) {
+				issued = glState()->issued;
+				draws = glState()->draws;
+				calls = 0;
+			}
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glQueryCounter(queries[0], GL_TIMESTAMP);
+			unsigned long long start = profileNow();
+			calls += submit(strategy);
+			unsigned long long stop = profileNow();
+			glQueryCounter(queries[1], GL_TIMESTAMP);
+			glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+			if (f > 0) {
+				cpu += stop - start;
+				gpu += end - begin;
+			}
+		}
+		r->cpuMs = 1.0e-6 * (double)cpu / SUBMIT_BENCH_FRAMES;
+		r->gpuMs = 1.0e-6 * (double)gpu / SUBMIT_BENCH_FRAMES;
+		r->calls = (double)(calls + glState()->issued - issued) / SUBMIT_BENCH_FRAMES;
+		r->draws = (double)(glState()->draws - draws) / SUBMIT_BENCH_FRAMES;
+		r->visible = (GLuint)count;
+		if (strategy == SUBMIT_MULTI_DRAW_CULLED) {
+			glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+			glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &r->visible);
+			glState()->bindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+		}
+	}
+} SubmitBench;
+
+/* For the --bench-submit mode: draw 1, 10, 100, ... up to maxCount cubes
+* (and maxCount itself) with every strategy into the current framebuffer of
+* width x height pixels, and write a CSV line per strategy and count to out.
+* Returns true if successfull and false in case of an error. */
+static bool submitBenchmark(ShaderSourceCache *cache, int maxCount, int width, int height, FILE *out)
+{
+	SubmitBench bench;
+	bool stopped[SUBMIT_STRATEGIES] = { false };
+	int s, n;
+
+	if (maxCount < 1 || !bench.init(cache))
+		return false;
+	glState()->viewport(0, 0, width, height);
+	glState()->enable(GL_DEPTH_TEST);
+	glState()->depthFunc(GL_LESS);
+	glState()->depthMask(GL_TRUE);
+	glState()->enable(GL_CULL_FACE);
+	glState()->disable(GL_BLEND);
+	for (s = 0; s < SUBMIT_STRATEGIES; s++)
+		if (!bench.supported(s))
+			info("submission benchmark: %s is not supported", submitStrategyNames[s]);
+	fprintf(out, "strategy,objects,visible,cpu_ms,gpu_ms,calls,draws\n");
+	for (n = 1; ; n = (n > maxCount / 10) ? maxCount : n * 10) {
+		if (!bench.setCount((GLsizei)n, width, height)) {
+			bench.destroy();
+			return false;
+		}
+		for (s = 0; s < SUBMIT_STRATEGIES; s++) {
+			SubmitBenchResult r;
+			if (stopped[s] || !bench.supported(s))
+				continue;
+			bench.measure(s, &r);
+			fprintf(out, "%s,%d,%u,%.4f,%.4f,%.0f,%.0f\n", submitStrategyNames[s], n, r.visible, r.cpuMs, r.gpuMs,
+				r.calls, r.draws);
+			fflush(out);
+			if (r.cpuMs > SUBMIT_BENCH_MAX_MS || r.gpuMs > SUBMIT_BENCH_MAX_MS) {
+				info("submission benchmark: %s takes %.0fms for %d cubes, stopping it", submitStrategyNames[s],
+					glm::max(r.cpuMs, r.gpuMs), n);
+				stopped[s] = true;
+			}
+		}
+		if (n >= maxCount)
+			break;
+	}
+	glState()->disable(GL_CULL_FACE);
+	glState()->useProgram(0);
+	glState()->bindVertexArray(0);
+	GL_ERROR_DBG("submission benchmark");
+	bench.destroy();
+	return true;
+}
+
+#endif
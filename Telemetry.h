@@ -0,0 +1,471 @@
+#ifndef HEADER_TELEMETRY_H
+#define HEADER_TELEMETRY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#include "Log.h"
+#include "Profiler.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* TELEMETRY: clocks, power and temperatures next to the frame times        *
+****************************************************************************/
+
+/* Telemetry: a thread which reads the clocks, the power draw and the
+* temperatures of the GPU and the CPU every TELEMETRY_PERIOD seconds, so a
+* frame rate which drops because the laptop throttles can be told from one
+* which drops because of the frame. The sources:
+* - NVIDIA GPUs: NVML (libnvidia-ml.so.1, nvml.dll), loaded at run time like
+*   libEGL in HeadlessContext.h, with the energy counter of Volta and later,
+* - AMD and Intel GPUs on Linux: the hwmon of amdgpu, i915 or xe in sysfs,
+*   which is what the AMD SMI library reads as well, and the frequency of
+*   the i915 GT,
+* - the CPU on Linux: the package energy of RAPL (powercap, which may only
+*   be readable by root), the cpufreq of all cores and the temperature of
+*   the coretemp, k10temp or zenpower hwmon.
+* The GPU is picked by the GL vendor. Whatever is missing stays unknown, -1.
+* Besides the last value, every sample adds each metric times the time
+* since the previous sample to an integral, the energy in joules for the
+* power (from the energy counters where there are some), so telemetryDelta()
+* gives the averages and the energy between any two samples, and the energy
+* per frame with the frame count. With PROFILE_ZONES the values are also
+* counters of the traces of Profiler.h, on the clock of the zones, so the
+* clocks line up with the frames. */
+#define TELEMETRY_PERIOD 0.1	/* s between two samples */
+#define TELEMETRY_HWMON_MAX 32	/* /sys/class/hwmon/hwmonN tried */
+#define TELEMETRY_CPU_MAX 256	/* cores whose clocks are averaged */
+#define TELEMETRY_DIR 96	/* bytes of the directories of the sources */
+#define TELEMETRY_PATH 128	/* and of the files in them */
+
+enum {
+	TELEMETRY_GPU_CLOCK = 0,	/* MHz */
+	TELEMETRY_GPU_POWER,		/* W */
+	TELEMETRY_GPU_TEMPERATURE,	/* degrees Celsius */
+	TELEMETRY_CPU_CLOCK,
+	TELEMETRY_CPU_POWER,
+	TELEMETRY_CPU_TEMPERATURE,
+	TELEMETRY_METRICS
+};
+
+/* the names of the counters in the traces */
+static const char *const telemetryNames[TELEMETRY_METRICS] = {
+	"GPU clock (MHz)", "GPU power (W)", "GPU temperature (C)",
+	"CPU clock (MHz)", "CPU power (W)", "CPU temperature (C)"
+};
+
+/* the keys of the benchmark output */
+static const char *const telemetryKeys[TELEMETRY_METRICS] = {
+	"gpu_clock_mhz", "gpu_power_w", "gpu_temperature_c", "cpu_clock_mhz", "cpu_power_w", "cpu_temperature_c"
+};
+
+typedef struct {
+	double time;		/* profileSeconds() */
+	double value[TELEMETRY_METRICS];	/* the last values, -1 if unknown */
+	double integral[TELEMETRY_METRICS];	/* of the values over the time since start() */
+	double covered[TELEMETRY_METRICS];	/* seconds of the integral */
+} TelemetrySample;
+
+/* between two samples */
+typedef struct {
+	double seconds;
+	double average[TELEMETRY_METRICS];	/* -1 if unknown */
+	double joules;		/* of the GPU and the CPU, -1 if neither is known */
+} TelemetryDelta;
+
+/* the averages and the energy from sample a to the later sample b */
+static void telemetryDelta(const TelemetrySample *a, const TelemetrySample *b, TelemetryDelta *d)
+{
+	int m;
+	d->seconds = b->time - a->time;
+	d->joules = -1.0;
+	for (m = 0; m < TELEMETRY_METRICS; m++) {
+		double covered = b->covered[m] - a->covered[m];
+		d->average[m] = (covered > 0.0) ? (b->integral[m] - a->integral[m]) / covered : -1.0;
+		if ((m == TELEMETRY_GPU_POWER || m == TELEMETRY_CPU_POWER) && covered > 0.0)
+			d->joules = ((d->joules < 0.0) ? 0.0 : d->joules) + b->integral[m] - a->integral[m];
+	}
+}
+
+/* Write the averages of d over frames frames into buffer, e.g. for a log
+* message. */
+static void telemetryFormat(const TelemetryDelta *d, unsigned int frames, char *buffer, size_t size)
+{
+	static const char *const devices[2] = { "GPU", "CPU" };
+	static const char *const formats[3] = { " %.0f MHz", " %.1f W", " %.0f C" };
+	size_t used = 0;
+	int i, m, n;
+
+	buffer[0] = 0;
+	for (i = 0; i < 2; i++) {
+		const double *average = &d->average[i * 3];
+		if (average[0] < 0.0 && average[1] < 0.0 && average[2] < 0.0)
+			continue;
+		n = mysnprintf(buffer + used, size - used, "%s%s", used ? ", " : " ", devices[i]);
+		used += (n > 0) ? (size_t)n : 0;
+		for (m = 0; m < 3 && used < size; m++) {
+			if (average[m] < 0.0)
+				continue;
+			n = mysnprintf(buffer + used, size - used, formats[m], average[m]);
+			used += (n > 0) ? (size_t)n : 0;
+		}
+	}
+	if (d->joules >= 0.0 && frames && used < size)
+		mysnprintf(buffer + used, size - used, ", %.2f mJ per frame, %.1f frames per joule",
+			1000.0 * d->joules / (double)frames, (d->joules > 0.0) ? (double)frames / d->joules : 0.0);
+}
+
+/* the functions of NVML used, which return 0 on success */
+typedef struct {
+	void *library;
+	int (*init)(void);
+	int (*shutdown)(void);
+	int (*deviceByIndex)(unsigned int, void**);
+	int (*clockInfo)(void*, int, unsigned int*);
+	int (*powerUsage)(void*, unsigned int*);
+	int (*temperature)(void*, int, unsigned int*);
+	int (*totalEnergy)(void*, unsigned long long*);
+	void *device;		/* the first one, NULL if none */
+} TelemetryNVML;
+
+#define TELEMETRY_NVML_CLOCK_GRAPHICS 0
+#define TELEMETRY_NVML_TEMPERATURE_GPU 0
+
+typedef struct {
+	std::thread thread;
+	std::atomic<bool> running;
+	std::mutex lock;	/* of last, and of stopping */
+	std::condition_variable wake;
+	TelemetrySample last;	/* the newest sample */
+
+	/* the sources, only touched by the thread once it runs */
+	TelemetryNVML nvml;
+	char gpuHwmon[TELEMETRY_DIR];	/* the directory, empty if none */
+	char gpuFrequency[TELEMETRY_PATH];	/* a file in MHz, empty if none */
+	char cpuHwmon[TELEMETRY_DIR];
+	char rapl[TELEMETRY_DIR];	/* the directory of the package domain, empty if none */
+	double raplRange;	/* microjoules at which the counter wraps */
+	int cpus;		/* with cpufreq */
+	/* the energy counters at the last sample, negative if there are none */
+	double gpuEnergy, cpuEnergy;
+
+	void clear()
+	{
+		running = false;
+		memset(&nvml, 0, sizeof(nvml));
+		gpuHwmon[0] = gpuFrequency[0] = cpuHwmon[0] = rapl[0] = 0;
+		raplRange = 0.0;
+		cpus = 0;
+		gpuEnergy = cpuEnergy = -1.0;
+		memset(&last, 0, sizeof(last));
+	}
+
+	/* The first number in the file path, scaled by scale.
+	* Returns false if there is none. */
+	static bool readNumber(const char *path, double scale, double *value)
+	{
+		FILE *f = fopen(path, "r");
+		double v;
+		if (!f)
+			return false;
+		int n = fscanf(f, "%lf", &v);
+		fclose(f);
+		if (n != 1)
+			return false;
+		*value = v * scale;
+		return true;
+	}
+
+	/* The first line of the file path in buffer, without the newline. */
+	static bool readLine(const char *path, char *buffer, int size)
+	{
+		FILE *f = fopen(path, "r");
+		if (!f)
+			return false;
+		bool ok = fgets(buffer, size, f) != NULL;
+		fclose(f);
+		if (ok)
+			buffer[strcspn(buffer, "\n")] = 0;
+		return ok;
+	}
+
+	/* Load NVML and open the first GPU.
+	* Returns true if successfull and false in case of an error. */
+	bool loadNVML()
+	{
+#ifdef _WIN32
+		HMODULE library = LoadLibraryA("nvml.dll");
+		if (!library)
+			return false;
+#define TELEMETRY_SYMBOL(name) (void*)GetProcAddress(library, name)
+#else
+		void *library = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
+		if (!library)
+			return false;
+#define TELEMETRY_SYMBOL(name) dlsym(library, name)
+#endif
+		nvml.library = (void*)library;
+		*(void**)&nvml.init = TELEMETRY_SYMBOL("nvmlInit_v2");
+		*(void**)&nvml.shutdown = TELEMETRY_SYMBOL("nvmlShutdown");
+		*(void**)&nvml.deviceByIndex = TELEMETRY_SYMBOL("nvmlDeviceGetHandleByIndex_v2");
+		*(void**)&nvml.clockInfo = TELEMETRY_SYMBOL("nvmlDeviceGetClockInfo");
+		*(void**)&nvml.powerUsage = TELEMETRY_SYMBOL("nvmlDeviceGetPowerUsage");
+		*(void**)&nvml.temperature = TELEMETRY_SYMBOL("nvmlDeviceGetTemperature");
+		*(void**)&nvml.totalEnergy = TELEMETRY_SYMBOL("nvmlDeviceGetTotalEnergyConsumption");
+#undef TELEMETRY_SYMBOL
+		if (!nvml.init || !nvml.shutdown || !nvml.deviceByIndex || nvml.init() != 0)
+			return false;
+		if (nvml.deviceByIndex(0, &nvml.device) != 0) {
+			nvml.shutdown();
+			nvml.device = NULL;
+			return false;
+		}
+		return true;
+	}
+
+	/* Find the sources of the GPU of the GL vendor vendor and of the CPU. */
+	void probe(const char *vendor)
+	{
+		char path[TELEMETRY_PATH], name[32];
+		double v;
+		int i;
+
+		bool nvidia = vendor && strstr(vendor, "NVIDIA");
+		bool amd = vendor && (strstr(vendor, "AMD") || strstr(vendor, "ATI"));
+		bool intel = vendor && strstr(vendor, "Intel");
+		if (nvidia && !loadNVML())
+			info("telemetry: NVML not available");
+		for (i = 0; i < TELEMETRY_HWMON_MAX; i++) {
+			mysnprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/name", i);
+			if (!readLine(path, name, sizeof(name)))
+				continue;
+			if (!gpuHwmon[0] && ((amd && !strcmp(name, "amdgpu")) || (intel && (!strcmp(name, "i915") ||
+				!strcmp(name, "xe")))))
+				mysnprintf(gpuHwmon, sizeof(gpuHwmon), "/sys/class/hwmon/hwmon%d", i);
+			else if (!cpuHwmon[0] && (!strcmp(name, "coretemp") || !strcmp(name, "k10temp") ||
+				!strcmp(name, "zenpower")))
+				mysnprintf(cpuHwmon, sizeof(cpuHwmon), "/sys/class/hwmon/hwmon%d", i);
+		}
+		for (i = 0; intel && i < 8 && !gpuFrequency[0]; i++) {
+			mysnprintf(path, sizeof(path), "/sys/class/drm/card%d/gt_act_freq_mhz", i);
+			if (readNumber(path, 1.0, &v))
+				mysnprintf(gpuFrequency, sizeof(gpuFrequency), "%s", path);
+		}
+		if (readNumber("/sys/class/powercap/intel-rapl:0/energy_uj", 1.0, &v) &&
+			readNumber("/sys/class/powercap/intel-rapl:0/max_energy_range_uj", 1.0, &raplRange))
+			mysnprintf(rapl, sizeof(rapl), "/sys/class/powercap/intel-rapl:0");
+		for (cpus = 0; cpus < TELEMETRY_CPU_MAX; cpus++) {
+			mysnprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpus);
+			if (!readNumber(path, 1.0, &v))
+				break;
+		}
+		info("telemetry: GPU from %s, CPU energy %s, %d CPU clocks, CPU temperature %s",
+			nvml.device ? "NVML" : (gpuHwmon[0] ? gpuHwmon : "nowhere"), rapl[0] ? "from RAPL" : "unknown",
+			cpus, cpuHwmon[0] ? cpuHwmon : "unknown");
+	}
+
+	/* The energy counter of the GPU in joules, -1 if there is none. */
+	double readGPUEnergy()
+	{
+		char path[TELEMETRY_PATH];
+		unsigned long long mj;
+		double j;
+		if (nvml.device)
+			return (nvml.totalEnergy && nvml.totalEnergy(nvml.device, &mj) == 0) ? 1.0e-3 * (double)mj : -1.0;
+		mysnprintf(path, sizeof(path), "%s/energy1_input", gpuHwmon);
+		return (gpuHwmon[0] && readNumber(path, 1.0e-6, &j)) ? j : -1.0;
+	}
+
+	/* The energy counter of the CPU package in joules, -1 if there is none. */
+	double readCPUEnergy()
+	{
+		char path[TELEMETRY_PATH];
+		double j;
+		mysnprintf(path, sizeof(path), "%s/energy_uj", rapl);
+		return (rapl[0] && readNumber(path, 1.0e-6, &j)) ? j : -1.0;
+	}
+
+	/* Read the values of all sources into value, the energy since the
+	* last sample into energy, or -1 where there is no counter. */
+	void read(double *value, double *energy)
+	{
+		char path[TELEMETRY_PATH];
+		unsigned int u;
+		double v, sum = 0.0;
+		int i, n = 0;
+
+		for (i = 0; i < TELEMETRY_METRICS; i++)
+			value[i] = -1.0;
+		energy[0] = energy[1] = -1.0;
+		if (nvml.device) {
+			if (nvml.clockInfo && nvml.clockInfo(nvml.device, TELEMETRY_NVML_CLOCK_GRAPHICS, &u) == 0)
+				value[TELEMETRY_GPU_CLOCK] = (double)u;
+			if (nvml.powerUsage && nvml.powerUsage(nvml.device, &u) == 0)
+				value[TELEMETRY_GPU_POWER] = 1.0e-3 * (double)u;
+			if (nvml.temperature && nvml.temperature(nvml.device, TELEMETRY_NVML_TEMPERATURE_GPU, &u) == 0)
+				value[TELEMETRY_GPU_TEMPERATURE] = (double)u;
+		} else if (gpuHwmon[0]) {
+			mysnprintf(path, sizeof(path), "%s/freq1_input", gpuHwmon);
+			if (readNumber(path, 1.0e-6, &v))
+				value[TELEMETRY_GPU_CLOCK] = v;
+			mysnprintf(path, sizeof(path), "%s/power1_average", gpuHwmon);
+			if (readNumber(path, 1.0e-6, &v))
+				value[TELEMETRY_GPU_POWER] = v;
+			mysnprintf(path, sizeof(path), "%s/power1_input", gpuHwmon);
+			if (value[TELEMETRY_GPU_POWER] < 0.0 && readNumber(path, 1.0e-6, &v))
+				value[TELEMETRY_GPU_POWER] = v;
+			mysnprintf(path, sizeof(path), "%s/temp1_input", gpuHwmon);
+			if (readNumber(path, 1.0e-3, &v))
+				value[TELEMETRY_GPU_TEMPERATURE] = v;
+		}
+		if (gpuFrequency[0] && readNumber(gpuFrequency, 1.0, &v))
+			value[TELEMETRY_GPU_CLOCK] = v;
+		v = readGPUEnergy();
+		if (v >= 0.0 && gpuEnergy >= 0.0)
+			energy[0] = (v >= gpuEnergy) ? v - gpuEnergy : 0.0;
+		gpuEnergy = v;
+		v = readCPUEnergy();
+		if (v >= 0.0 && cpuEnergy >= 0.0)
+			/* the counter wraps around */
+			energy[1] = (v >= cpuEnergy) ? v - cpuEnergy : v + 1.0e-6 * raplRange - cpuEnergy;
+		cpuEnergy = v;
+		for (i = 0; i < cpus; i++) {
+			mysnprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", i);
+			if (readNumber(path, 1.0e-3, &v)) {
+				sum += v;
+				n++;
+			}
+		}
+		if (n)
+			value[TELEMETRY_CPU_CLOCK] = sum / (double)n;
+		mysnprintf(path, sizeof(path), "%s/temp1_input", cpuHwmon);
+		if (cpuHwmon[0] && readNumber(path, 1.0e-3, &v))
+			value[TELEMETRY_CPU_TEMPERATURE] = v;
+	}
+
+	/* Take a sample, dt seconds after the previous one. */
+	void sample(double dt)
+	{
+		TelemetrySample s;
+		double value[TELEMETRY_METRICS], energy[2];
+		int m;
+
+		read(value, energy);
+		/* the power of the energy counters is exact over dt */
+		if (energy[0] >= 0.0 && dt > 0.0)
+			value[TELEMETRY_GPU_POWER] = energy[0] / dt;
+		if (energy[1] >= 0.0 && dt > 0.0)
+			value[TELEMETRY_CPU_POWER] = energy[1] / dt;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			s = last;
+		}
+		s.time = profileSeconds();
+		for (m = 0; m < TELEMETRY_METRICS; m++) {
+			/* the first sample only has the values */
+			if (value[m] >= 0.0 && dt > 0.0) {
+				s.integral[m] += value[m] * dt;
+				s.covered[m] += dt;
+			}
+			s.value[m] = value[m];
+#ifdef PROFILE_ZONES
+			if (value[m] >= 0.0)
+				profileCounter(telemetryNames[m], value[m]);
+#endif
+		}
+		std::lock_guard<std::mutex> guard(lock);
+		last = s;
+	}
+
+	void run()
+	{
+		double previous = profileSeconds();
+		PROFILE_THREAD("telemetry");
+		sample(0.0);
+		std::unique_lock<std::mutex> guard(lock);
+		while (running) {
+			wake.wait_for(guard, std::chrono::milliseconds((int)(TELEMETRY_PERIOD * 1000.0)));
+			if (!running)
+				break;
+			guard.unlock();
+			double now = profileSeconds();
+			sample(now - previous);
+			previous = now;
+			guard.lock();
+		}
+	}
+
+	/* Find the sources of the GPU of the GL vendor vendor (GL_VENDOR) and
+	* of the CPU and start sampling.
+	* Returns false if there are none. */
+	bool start(const char *vendor)
+	{
+		int m;
+		stop();
+		probe(vendor);
+		if (!nvml.device && !gpuHwmon[0] && !gpuFrequency[0] && !rapl[0] && !cpus && !cpuHwmon[0]) {
+			warn("telemetry: no clocks, power or temperatures to read on this machine");
+			return false;
+		}
+		last.time = profileSeconds();
+		for (m = 0; m < TELEMETRY_METRICS; m++) {
+			last.value[m] = -1.0;
+			last.integral[m] = last.covered[m] = 0.0;
+		}
+		running = true;
+		thread = std::thread([this]() { run(); });
+		return true;
+	}
+
+	void stop()
+	{
+		if (running) {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				running = false;
+			}
+			wake.notify_one();
+			thread.join();
+		}
+		if (nvml.device)
+			nvml.shutdown();
+		nvml.device = NULL;
+#ifdef _WIN32
+		if (nvml.library)
+			FreeLibrary((HMODULE)nvml.library);
+#else
+		if (nvml.library)
+			dlclose(nvml.library);
+#endif
+		nvml.library = NULL;
+	}
+
+	/* Copy the newest sample into s.
+	* Returns false if there is none, telemetry is off. */
+	bool latest(TelemetrySample *s)
+	{
+		if (!running)
+			return false;
+		std::lock_guard<std::mutex> guard(lock);
+		*s = last;
+		return true;
+	}
+} Telemetry;
+
+#endif
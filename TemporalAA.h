@@ -0,0 +1,433 @@
+#ifndef HEADER_TEMPORALAA_H
+#define HEADER_TEMPORALAA_H
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "RenderTarget.h"
+#include "RenderQueue.h"
+
+/****************************************************************************
+* TEMPORAL ANTI-ALIASING                                                   *
+****************************************************************************/
+
+/* TemporalAA: anti-aliasing without extra samples per frame. Each frame is
+* rendered with its projection shifted by a different subpixel offset, from
+* a Halton (2, 3) sequence, so over a few frames every pixel sees several
+* positions of the edges it covers. The resolve (shaders/taa.fs.glsl) blends
+* each frame into a history at the window size: it finds where a pixel was
+* in the previous frame, takes the history from there and limits it to the
+* range of the colors around the pixel in this frame, which rejects what
+* was disoccluded or changed, and mixes in a tenth of the new color.
+* Where a pixel was in the previous frame comes from a velocity target at
+* the render size: after the scene, the cubes are drawn once more by their
+* motion program (shaders/cube.vs.glsl with MOTION,
+* shaders/velocity.fs.glsl), which projects each vertex with this and the
+* previous frame's transforms, with the depth test on the depth of the
+* scene. All other pixels, which keep the sentinel the target is cleared
+* to, are reprojected from their depth with the camera of the previous
+* frame; that is right for everything which does not move by itself.
+* The instances all turn with the cube, so instead of a previous matrix per
+* instance the motion program gets the one matrix which turns the current
+* model transform into the previous one.
+* With a scale below 1, the frames are rendered at that fraction of the
+* window size and the resolve reconstructs the full size: the jittered
+* samples fall on different output pixels each frame, and each is weighted
+* by its distance to the pixel center. The dynamic resolution picks the
+* scale instead, if it is on. */
+#define TAA_VS "shaders/raymarch.vs.glsl"	/* a full-screen triangle */
+#define TAA_RESOLVE_FS "shaders/taa.fs.glsl"
+#define TAA_MOTION_VS "shaders/cube.vs.glsl"
+#define TAA_MOTION_FS "shaders/velocity.fs.glsl"
+#define TAA_JITTER_SAMPLES 16	/* of the Halton sequence, then it repeats */
+#define TAA_BLEND 0.1f		/* of the new frame, at the full size */
+#define TAA_VELOCITY_FORMAT GL_RG16F
+#define TAA_NO_VELOCITY 2.0f	/* the sentinel, reproject by the depth */
+
+/* the motion programs, by the features of the cube program they match */
+#define TAA_MOTION_INSTANCED 1u
+#define TAA_MOTION_PULLED 2u
+#define TAA_MOTION_COMPACT 4u
+#define TAA_MOTION_WOBBLE 8u
+#define TAA_MOTION_DISPLACED 16u	/* the positions of Displacement.h */
+#define TAA_MOTION_VARIANTS 32
+#define TAA_MOTION_DEFINE 32u	/* MOTION itself, in every variant */
+
+static const char *const taaMotionDefines[] = { "INSTANCED", "PULLED", "COMPACT", "WOBBLE", "DISPLACED", "MOTION" };
+
+/* the texture units during the resolve */
+#define TAA_CURRENT_UNIT 0
+#define TAA_HISTORY_UNIT 1
+#define TAA_VELOCITY_UNIT 2
+#define TAA_DEPTH_UNIT 3
+
+/* the uniforms of a motion program */
+typedef struct {
+	GLuint program;		/* 0 until first used */
+	GLint currentLoc, previousLoc, modelLoc;
+} TaaMotionProgram;
+
+typedef struct {
+	bool enabled;
+	double scale;		/* of the sides the frames are rendered at, without the dynamic resolution */
+	ShaderSourceCache *sources;	/* of the motion programs */
+	GLuint resolveProgram;	/* 0 if not supported */
+	GLint currentSizeLoc, outputSizeLoc, jitterLoc, reprojectLoc, blendLoc, historyValidLoc;
+	TaaMotionProgram motion[TAA_MOTION_VARIANTS];
+	GLuint vao;		/* empty, for the full-screen triangle */
+	GLuint velocityFbo;	/* the velocity, with the depth of the scene */
+	GLuint velocity;	/* TAA_VELOCITY_FORMAT, in uv units */
+	GLuint depthFbo;
+	GLuint depth;		/* a copy of the depth of the scene */
+	GLsizei width, height;	/* of the frames */
+	GLuint historyFbo[2];
+	GLuint history[2];	/* the resolved frames, ping-ponged */
+	GLenum historyFormat;
+	GLsizei historyWidth, historyHeight;
+	int current;		/* the history written this frame */
+	bool valid;		/* the other history holds the previous frame */
+	glm::vec2 jitter;	/* of this frame, in pixels of the frame */
+	glm::mat4 reproject;	/* from the clip space of this frame to that of the previous one */
+	RenderTarget output;	/* the history written last, without a depth */
+
+	void clear()
+	{
+		int i;
+		enabled = false;
+		scale = 1.0;
+		sources = NULL;
+		resolveProgram = vao = 0;
+		for (i = 0; i < TAA_MOTION_VARIANTS; i++)
+			motion[i].program = 0;
+		velocityFbo = velocity = depthFbo = depth = 0;
+		width = height = 0;
+		historyFbo[0] = historyFbo[1] = history[0] = history[1] = 0;
+		historyFormat = GL_RGBA8;
+		historyWidth = historyHeight = 0;
+		current = 0;
+		valid = false;
+		jitter = glm::vec2(0.0f);
+		reproject = glm::mat4(1.0f);
+		output.clear();
+	}
+
+	/* Build the resolve program, the sources of it and of the motion
+	* programs, which are built when first used, are loaded via cache.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		sources = cache;
+		resolveProgram = programBuild(cache, TAA_VS, TAA_RESOLVE_FS);
+		if (!resolveProgram)
+			return false;
+		currentSizeLoc = glGetUniformLocation(resolveProgram, "currentSize");
+		outputSizeLoc = glGetUniformLocation(resolveProgram, "outputSize");
+		jitterLoc = glGetUniformLocation(resolveProgram, "jitter");
+		reprojectLoc = glGetUniformLocation(resolveProgram, "reproject");
+		blendLoc = glGetUniformLocation(resolveProgram, "blend");
+		historyValidLoc = glGetUniformLocation(resolveProgram, "historyValid");
+		glState()->useProgram(resolveProgram);
+		glUniform1i(glGetUniformLocation(resolveProgram, "current"), TAA_CURRENT_UNIT);
+		glUniform1i(glGetUniformLocation(resolveProgram, "history"), TAA_HISTORY_UNIT);
+		glUniform1i(glGetUniformLocation(resolveProgram, "velocity"), TAA_VELOCITY_UNIT);
+		glUniform1i(glGetUniformLocation(resolveProgram, "depth"), TAA_DEPTH_UNIT);
+		glState()->useProgram(0);
+		glGenVertexArrays(1, &vao);
+		info("TAA: resolve program %u", resolveProgram);
+		return true;
+	}
+
+	void destroyTargets()
+	{
+		if (velocityFbo)
+			glDeleteFramebuffers(1, &velocityFbo);
+		if (depthFbo)
+			glDeleteFramebuffers(1, &depthFbo);
+		if (velocity)
+			glState()->deleteTextures(1, &velocity);
+		if (depth)
+			glState()->deleteTextures(1, &depth);
+		velocityFbo = depthFbo = velocity = depth = 0;
+		width = height = 0;
+	}
+
+	void destroyHistory()
+	{
+		int i;
+		for (i = 0; i < 2; i++) {
+			if (historyFbo[i])
+				glDeleteFramebuffers(1, &historyFbo[i]);
+			if (history[i])
+				glState()->deleteTextures(1, &history[i]);
+			historyFbo[i] = history[i] = 0;
+		}
+		historyWidth = historyHeight = 0;
+		valid = false;
+	}
+
+	void destroy()
+	{
+		int i;
+		destroyTargets();
+		destroyHistory();
+		for (i = 0; i < TAA_MOTION_VARIANTS; i++) {
+			if (motion[i].program)
+				glState()->deleteProgram(motion[i].program);
+		}
+		if (resolveProgram)
+			glState()->deleteProgram(resolveProgram);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		clear();
+	}
+
+	/* Start or stop the anti-aliasing, rendering at scale times the window
+	* size unless the dynamic resolution scales. */
+	void setEnabled(bool enable, double s)
+	{
+		enabled = enable && resolveProgram;
+		scale = (s > 0.0 && s < 1.0) ? s : 1.0;
+		valid = false;
+	}
+
+	/* The size of a side of length size at the scale. */
+	GLsizei scaled(GLsizei size) const
+	{
+		GLsizei s = (GLsizei)(scale * (double)size + 0.5);
+		return (s < 1) ? 1 : s;
+	}
+
+	static GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type, GLsizei w, GLsizei h, GLenum filter)
+	{
+		GLuint tex;
+		MemoryScope scope(MEMORY_TARGETS);
+		glGenTextures(1, &tex);
+		glState()->bindTexture(GL_TEXTURE_2D, tex);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		return tex;
+	}
+
+	/* (Re-)allocate the velocity and depth targets for frames of w x h
+	* pixels.
+	* Returns true if successfull and false in case of an error. */
+	bool resizeTargets(GLsizei w, GLsizei h)
+	{
+		if (w == width && h == height)
+			return true;
+		destroyTargets();
+		velocity = createTexture(TAA_VELOCITY_FORMAT, GL_RG, GL_FLOAT, w, h, GL_NEAREST);
+		depth = createTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, w, h, GL_NEAREST);
+		glGenFramebuffers(1, &velocityFbo);
+		glGenFramebuffers(1, &depthFbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, velocityFbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, velocity, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!RenderTarget::checkComplete(depthFbo)) {
+			destroyTargets();
+			return false;
+		}
+		width = w;
+		height = h;
+		info("TAA: frames of %dx%d pixels", (int)width, (int)height);
+		return true;
+	}
+
+	/* (Re-)allocate the history for w x h pixels of format, which drops
+	* it.
+	* Returns true if successfull and false in case of an error. */
+	bool resizeHistory(GLsizei w, GLsizei h, GLenum format)
+	{
+		int i;
+		if (w == historyWidth && h == historyHeight && format == historyFormat)
+			return true;
+		destroyHistory();
+		for (i = 0; i < 2; i++) {
+			history[i] = createTexture(format, GL_RGBA, (format == GL_RGBA8) ? GL_UNSIGNED_BYTE : GL_FLOAT,
+				w, h, GL_LINEAR);
+			glGenFramebuffers(1, &historyFbo[i]);
+			glBindFramebuffer(GL_FRAMEBUFFER, historyFbo[i]);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history[i], 0);
+			if (!RenderTarget::checkComplete(historyFbo[i])) {
+				destroyHistory();
+				return false;
+			}
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		historyWidth = w;
+		historyHeight = h;
+		historyFormat = format;
+		info("TAA: history of %dx%d pixels", (int)w, (int)h);
+		return true;
+	}
+
+	/* Radical inverse of i in base, the Halton sequence. */
+	static float halton(unsigned int i, unsigned int base)
+	{
+		float f = 1.0f, r = 0.0f;
+		while (i) {
+			f /= (float)base;
+			r += f * (float)(i % base);
+			i /= base;
+		}
+		return r;
+	}
+
+	/* Pick the subpixel offset of frame number frame of w x h pixels and
+	* clear the velocity target. viewProjection is the one of the frame
+	* without the offset, previousViewProjection that of the previous
+	* frame. Leaves the framebuffer binding undefined. */
+	void beginFrame(GLuint frame, GLsizei w, GLsizei h, const glm::mat4 &viewProjection,
+		const glm::mat4 &previousViewProjection)
+	{
+		static const GLfloat none[4] = { TAA_NO_VELOCITY, TAA_NO_VELOCITY, 0.0f, 0.0f };
+
+		if (!resizeTargets(w, h)) {
+			warn("TAA: failed to create the velocity target, off");
+			enabled = false;
+			return;
+		}
+		unsigned int i = frame % TAA_JITTER_SAMPLES + 1;
+		jitter = glm::vec2(halton(i, 2) - 0.5f, halton(i, 3) - 0.5f);
+		reproject = previousViewProjection * glm::inverse(viewProjection);
+		glBindFramebuffer(GL_FRAMEBUFFER, velocityFbo);
+		glClearBufferfv(GL_COLOR, 0, none);
+	}
+
+	/* What goes in front of the projection matrices of this frame, which
+	* moves the image by the jitter. */
+	glm::mat4 jitterMatrix() const
+	{
+		return glm::translate(glm::vec3(2.0f * jitter.x / (float)width, 2.0f * jitter.y / (float)height, 0.0f));
+	}
+
+	/* Bind the velocity target with depthBuffer, the depth renderbuffer of
+	* the scene, for the draws of the motion programs, with the depth test
+	* on and the depth writes off; raster may add RASTER_CULL. */
+	void beginMotion(GLuint depthBuffer, unsigned int raster)
+	{
+		GL_DEBUG_GROUP("taa motion");
+		glBindFramebuffer(GL_FRAMEBUFFER, velocityFbo);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+		glState()->enable(GL_DEPTH_TEST);
+		glState()->depthFunc(GL_LEQUAL);
+		glState()->raster(raster & RASTER_CULL);
+	}
+
+	/* The motion program of variant (TAA_MOTION_*), built when first used.
+	* Returns NULL if it failed to build. */
+	TaaMotionProgram *motionProgram(unsigned int variant)
+	{
+		TaaMotionProgram *m = &motion[variant];
+		if (m->program)
+			return m;
+		m->program = programBuild(sources, TAA_MOTION_VS, TAA_MOTION_FS, taaMotionDefines,
+			(int)(sizeof(taaMotionDefines) / sizeof(taaMotionDefines[0])), variant | TAA_MOTION_DEFINE);
+		if (!m->program)
+			return NULL;
+		m->currentLoc = glGetUniformLocation(m->program, "motionCurrent");
+		m->previousLoc = glGetUniformLocation(m->program, "motionPrevious");
+		m->modelLoc = glGetUniformLocation(m->program, "motionModel");
+		info("TAA: motion program %u for variant 0x%x", m->program, variant);
+		return m;
+	}
+
+	/* Draw the velocity of object with draw, from vao, with the motion
+	* program of variant: the vertices are transformed by current in this
+	* frame, without the jitter, and by previous in the previous one; the
+	* instance matrices, if any, go between the matrix and the vertices,
+	* and model goes after them in the previous frame. */
+	void drawMotion(unsigned int variant, const glm::mat4 &currentMatrix, const glm::mat4 &previous,
+		const glm::mat4 &model, GLuint vao, RenderDrawFunc draw, void *object)
+	{
+		TaaMotionProgram *m = motionProgram(variant);
+		if (!m)
+			return;
+		glState()->useProgram(m->program);
+		glUniformMatrix4fv(m->currentLoc, 1, GL_FALSE, &currentMatrix[0][0]);
+		glUniformMatrix4fv(m->previousLoc, 1, GL_FALSE, &previous[0][0]);
+		glUniformMatrix4fv(m->modelLoc, 1, GL_FALSE, &model[0][0]);
+		glState()->bindVertexArray(vao);
+		draw(object, NULL);
+	}
+
+	/* Go back to the depth test of the context and to framebuffer fbo. */
+	void endMotion(GLuint fbo)
+	{
+		glState()->depthFunc(GL_LESS);
+		glState()->raster(RASTER_DEFAULT);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	}
+
+	static void bindTexture(int unit, GLuint texture)
+	{
+		glState()->activeTexture(GL_TEXTURE0 + unit);
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+	}
+
+	/* Blend scene, the resolved frame begun with beginFrame(), into the
+	* history at w x h pixels.
+	* Returns the history as a render target to present or post-process,
+	* or scene in case of an error. */
+	RenderTarget *resolve(RenderTarget *scene, GLsizei w, GLsizei h)
+	{
+		if (!resizeHistory(w, h, scene->format)) {
+			warn("TAA: failed to create the history, off");
+			enabled = false;
+			return scene;
+		}
+		GL_DEBUG_GROUP("taa resolve");
+		/* the depth of the scene, as a texture */
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, scene->fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFbo);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+		/* the area of the output pixels per frame pixel speeds up the
+		 * accumulation by as much, each pixel gets fewer samples */
+		float area = (float)w * (float)h / ((float)width * (float)height);
+		glBindFramebuffer(GL_FRAMEBUFFER, historyFbo[current]);
+		glState()->viewport(0, 0, w, h);
+		glState()->disable(GL_DEPTH_TEST);
+		glState()->raster(0);
+		glState()->useProgram(resolveProgram);
+		glUniform2f(currentSizeLoc, (GLfloat)width, (GLfloat)height);
+		glUniform2f(outputSizeLoc, (GLfloat)w, (GLfloat)h);
+		glUniform2f(jitterLoc, jitter.x, jitter.y);
+		glUniformMatrix4fv(reprojectLoc, 1, GL_FALSE, &reproject[0][0]);
+		glUniform1f(blendLoc, glm::min(TAA_BLEND * area, 1.0f));
+		glUniform1i(historyValidLoc, valid);
+		bindTexture(TAA_CURRENT_UNIT, scene->color);
+		bindTexture(TAA_HISTORY_UNIT, history[current ^ 1]);
+		bindTexture(TAA_VELOCITY_UNIT, velocity);
+		bindTexture(TAA_DEPTH_UNIT, depth);
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+		glState()->activeTexture(GL_TEXTURE0);
+		glState()->raster(RASTER_DEFAULT);
+		glState()->enable(GL_DEPTH_TEST);
+
+		output.fbo = historyFbo[current];
+		output.color = history[current];
+		output.format = historyFormat;
+		output.width = w;
+		output.height = h;
+		current ^= 1;
+		valid = true;
+		GL_ERROR_DBG("TAA resolve");
+		return &output;
+	}
+} TemporalAA;
+
+#endif
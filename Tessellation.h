@@ -0,0 +1,137 @@
+#ifndef HEADER_TESSELLATION_H
+#define HEADER_TESSELLATION_H
+
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* TESSELLATION                                                             *
+****************************************************************************/
+
+/* Tessellation: the wobble shader (shaders/cube.vs.glsl with WOBBLE)
+* displaces the vertices of the cube, but the cube has 24 of them, so the
+* wobble moves whole faces; a finer mesh would be wasted on the cubes far
+* away. These programs draw the cube as patches of three vertices instead
+* (Cube::draw with GL_PATCHES): the vertex shader passes the corners on
+* (TESSELLATED), the tessellation control shader (shaders/wobble.tcs.glsl)
+* splits each edge into segments of about edgePixels on screen, and the
+* tessellation evaluation shader (shaders/wobble.tes.glsl) places and
+* wobbles the new vertices. So the cost of the wobble follows the area the
+* cubes cover, not the mesh, and the fragment shader is the same.
+* There is a variant per way of drawing the instances and a depth-only one
+* which casts the shadows, built when first used. The depth pre-pass is
+* skipped for the patches, whose main pass writes the depth itself. The
+* level of an edge comes from the transform of the pass, so the shadow maps
+* are tessellated by the size of the cubes in them, measured as if the maps
+* had the size of the frame. */
+#define TESS_VS "shaders/cube.vs.glsl"
+#define TESS_TCS "shaders/wobble.tcs.glsl"
+#define TESS_TES "shaders/wobble.tes.glsl"
+#define TESS_FS "shaders/cube.fs.glsl"
+#define TESS_EDGE_PIXELS 8.0f	/* the default length of a segment */
+
+/* the programs, by the features of the cube program they match */
+#define TESS_INSTANCED 1u
+#define TESS_PULLED 2u
+#define TESS_COMPACT 4u
+#define TESS_DEPTH_ONLY 8u
+#define TESS_VARIANTS 16
+#define TESS_DEFINES 48u	/* WOBBLE and TESSELLATED, in every variant */
+
+static const char *const tessDefines[] = { "INSTANCED", "PULLED", "COMPACT", "DEPTH_ONLY", "WOBBLE", "TESSELLATED" };
+
+/* a program and the uniforms it was last given */
+typedef struct {
+	GLuint program;		/* 0 until first used */
+	bool failed;		/* do not try to build it again */
+	GLint viewportLoc, edgePixelsLoc;
+	GLsizei width, height;
+	float edgePixels;
+} TessProgram;
+
+typedef struct {
+	bool enabled;
+	float edgePixels;	/* the length of a segment on screen */
+	ShaderSourceCache *sources;
+	TessProgram programs[TESS_VARIANTS];
+
+	void clear()
+	{
+		int i;
+		enabled = false;
+		edgePixels = TESS_EDGE_PIXELS;
+		sources = NULL;
+		for (i = 0; i < TESS_VARIANTS; i++) {
+			programs[i].program = 0;
+			programs[i].failed = false;
+		}
+	}
+
+	/* Check for tessellation shaders, the programs are built when first
+	* used from the sources of cache.
+	* Returns true if successfull and false if they are not supported. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		if (!tessellationSupported())
+			return false;
+		sources = cache;
+		glPatchParameteri(GL_PATCH_VERTICES, 3);
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < TESS_VARIANTS; i++)
+			if (programs[i].program)
+				glState()->deleteProgram(programs[i].program);
+		clear();
+	}
+
+	/* Turn the tessellation on or off, with segments of pixels on screen.
+	* Returns false if it is not supported. */
+	bool setEnabled(bool enable, float pixels)
+	{
+		if (enable && !sources)
+			return false;
+		enabled = enable;
+		if (pixels > 0.0f)
+			edgePixels = pixels;
+		return true;
+	}
+
+	/* The program of variant (TESS_*), built when first used, for a
+	* viewport of w x h pixels.
+	* Returns 0 if it failed to build. */
+	GLuint program(unsigned int variant, GLsizei w, GLsizei h)
+	{
+		TessProgram *t = &programs[variant];
+		if (!t->program && !t->failed) {
+			t->program = tessProgramBuild(sources, TESS_VS, TESS_TCS, TESS_TES, TESS_FS, tessDefines,
+				(int)(sizeof(tessDefines) / sizeof(tessDefines[0])), variant | TESS_DEFINES);
+			if (!t->program) {
+				warn("tessellation: the program for variant 0x%x failed to build", variant);
+				t->failed = true;
+				return 0;
+			}
+			t->viewportLoc = glGetUniformLocation(t->program, "viewport");
+			t->edgePixelsLoc = glGetUniformLocation(t->program, "edgePixels");
+			t->width = t->height = 0;
+			t->edgePixels = 0.0f;
+			info("tessellation: program %u for variant 0x%x", t->program, variant);
+		}
+		if (t->program && (t->width != w || t->height != h || t->edgePixels != edgePixels)) {
+			glState()->useProgram(t->program);
+			glUniform2f(t->viewportLoc, (GLfloat)w, (GLfloat)h);
+			glUniform1f(t->edgePixelsLoc, edgePixels);
+			t->width = w;
+			t->height = h;
+			t->edgePixels = edgePixels;
+		}
+		return t->program;
+	}
+} Tessellation;
+
+#endif
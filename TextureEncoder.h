@@ -0,0 +1,616 @@
+#ifndef HEADER_TEXTUREENCODER_H
+#define HEADER_TEXTUREENCODER_H
+
+#include <glad/glad.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "TextureFile.h"
+
+/****************************************************************************
+* TEXTURE ENCODER                                                          *
+****************************************************************************/
+
+/* Offline building of texture files (see TextureFile.h) from one of:
+*  - an image, binary PPM (P6) or PAM (P7) with 8 bit channels, with the
+*    layers of an array texture stacked from top to bottom. The levels are
+*    box filtered down to 1x1 and each is encoded to BC1, BC3, BC4 or BC5:
+*    the colors of a block are projected onto their principal axis, the
+*    extremes become the endpoints, which are refined once by least
+*    squares for the chosen indices. Single channels take their minimum and
+*    maximum, with 8 interpolated values. That is a fraction of the quality
+*    of a real encoder, but fast and without dependencies.
+*  - a KTX2 file written by a real encoder (e.g. toktx or astcenc), in a
+*    BCn or ASTC format and without supercompression. Its blocks are copied
+*    as they are, so BC6H, BC7 and ASTC come this way.
+* Either way the levels may be supercompressed with Lz.h on top. */
+#define TEXTURE_KTX2_HEADER_SIZE 80	/* up to the level index */
+
+/* an image in memory, RGBA8, rows from the top */
+typedef struct {
+	GLubyte *rgba;
+	GLuint width, height;
+} TextureImage;
+
+/* Read the whole file filename into a new buffer of *size bytes.
+* Returns it, NULL in case of an error. */
+static GLubyte *textureReadFile(const char *filename, size_t *size)
+{
+	FILE *file = fopen(filename, "rb");
+	GLubyte *data = NULL;
+	long len;
+
+	if (!file) {
+		warn("failed to open '%s'", filename);
+		return NULL;
+	}
+	if (fseek(file, 0, SEEK_END) == 0 && (len = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+		data = (GLubyte*)malloc((size_t)len);
+		if (data && fread(data, 1, (size_t)len, file) != (size_t)len) {
+			free(data);
+			data = NULL;
+		}
+		*size = (size_t)len;
+	}
+	fclose(file);
+	if (!data)
+		warn("failed to read '%s'", filename);
+	return data;
+}
+
+/* Read the next whitespace separated token of a PPM or PAM header from
+* data[*i] on into token of capacity bytes, skipping comments.
+* Returns false at the end of the data. */
+static bool textureHeaderToken(const GLubyte *data, size_t size, size_t *i, char *token, size_t capacity)
+{
+	size_t n = 0;
+
+	while (*i < size && (isspace(data[*i]) || data[*i] == '#')) {
+		if (data[*i] == '#') {
+			while (*i < size && data[*i] != '\n')
+				(*i)++;
+		} else {
+			(*i)++;
+		}
+	}
+	while (*i < size && !isspace(data[*i]) && n + 1 < capacity)
+		token[n++] = (char)data[(*i)++];
+	token[n] = 0;
+	return n > 0;
+}
+
+/* Decode the binary PPM (P6) or PAM (P7) image in the size bytes data.
+* Returns true if successfull and false if it is not one we can read. */
+static bool textureImageDecode(const GLubyte *data, size_t size, const char *filename, TextureImage *img)
+{
+	char token[32];
+	size_t i = 2, x, count;
+	GLuint channels = 3, maxval = 0;
+	bool pam;
+
+	img->rgba = NULL;
+	img->width = img->height = 0;
+	if (size < 2 || data[0] != 'P' || (data[1] != '6' && data[1] != '7')) {
+		warn("'%s' is neither a binary PPM nor a PAM image", filename);
+		return false;
+	}
+	pam = data[1] == '7';
+	if (pam) {
+		/* tag value lines up to ENDHDR */
+		while (textureHeaderToken(data, size, &i, token, sizeof(token)) && strcmp(token, "ENDHDR")) {
+			char value[32];
+			if (!textureHeaderToken(data, size, &i, value, sizeof(value)))
+				break;
+			if (!strcmp(token, "WIDTH"))
+				img->width = (GLuint)atoi(value);
+			else if (!strcmp(token, "HEIGHT"))
+				img->height = (GLuint)atoi(value);
+			else if (!strcmp(token, "DEPTH"))
+				channels = (GLuint)atoi(value);
+			else if (!strcmp(token, "MAXVAL"))
+				maxval = (GLuint)atoi(value);
+		}
+	} else if (textureHeaderToken(data, size, &i, token, sizeof(token))) {
+		img->width = (GLuint)atoi(token);
+		if (textureHeaderToken(data, size, &i, token, sizeof(token)))
+			img->height = (GLuint)atoi(token);
+		if (textureHeaderToken(data, size, &i, token, sizeof(token)))
+			maxval = (GLuint)atoi(token);
+	}
+	/* a single whitespace character ends the header */
+	i++;
+	if (!img->width || !img->height || img->width > TEXTURE_FILE_SIZE_MAX ||
+		img->height > TEXTURE_FILE_SIZE_MAX * TEXTURE_FILE_LAYERS_MAX || maxval != 255 || channels < 1 ||
+		channels > 4) {
+		warn("image '%s' has an unsupported size or format", filename);
+		return false;
+	}
+	count = (size_t)img->width * img->height;
+	if (i > size || (size - i) / channels < count) {
+		warn("image '%s' is truncated", filename);
+		return false;
+	}
+	img->rgba = (GLubyte*)malloc(count * 4);
+	if (!img->rgba) {
+		warn("failed to allocate image '%s'", filename);
+		return false;
+	}
+	/* gray and gray alpha are spread to RGB */
+	for (x = 0; x < count; x++) {
+		const GLubyte *s = data + i + x * channels;
+		GLubyte *d = img->rgba + x * 4;
+		if (channels >= 3) {
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+		} else {
+			d[0] = d[1] = d[2] = s[0];
+		}
+		d[3] = (channels == 4 || channels == 2) ? s[channels - 1] : 255;
+	}
+	return true;
+}
+
+/* Box filter src of w x h into dst of half the size, rounded down but at
+* least 1, odd last rows and columns are clamped. */
+static void textureDownsample(const GLubyte *src, GLuint w, GLuint h, GLubyte *dst)
+{
+	GLuint x, y, c;
+	GLuint dw = w > 1 ? w / 2 : 1, dh = h > 1 ? h / 2 : 1;
+
+	for (y = 0; y < dh; y++) {
+		GLuint y0 = 2 * y < h ? 2 * y : h - 1, y1 = 2 * y + 1 < h ? 2 * y + 1 : h - 1;
+		for (x = 0; x < dw; x++) {
+			GLuint x0 = 2 * x < w ? 2 * x : w - 1, x1 = 2 * x + 1 < w ? 2 * x + 1 : w - 1;
+			for (c = 0; c < 4; c++) {
+				GLuint sum = src[4 * (y0 * w + x0) + c] + src[4 * (y0 * w + x1) + c] +
+					src[4 * (y1 * w + x0) + c] + src[4 * (y1 * w + x1) + c];
+				dst[4 * (y * dw + x) + c] = (GLubyte)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+static GLushort texturePack565(const float *c)
+{
+	int r = (int)(c[0] * (31.0f / 255.0f) + 0.5f), g = (int)(c[1] * (63.0f / 255.0f) + 0.5f),
+		b = (int)(c[2] * (31.0f / 255.0f) + 0.5f);
+	r = r < 0 ? 0 : (r > 31 ? 31 : r);
+	g = g < 0 ? 0 : (g > 63 ? 63 : g);
+	b = b < 0 ? 0 : (b > 31 ? 31 : b);
+	return (GLushort)((r << 11) | (g << 5) | b);
+}
+
+static void textureUnpack565(GLushort v, int *c)
+{
+	int r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+	c[0] = (r << 3) | (r >> 2);
+	c[1] = (g << 2) | (g >> 4);
+	c[2] = (b << 3) | (b >> 2);
+}
+
+/* Choose the indices of the 16 RGB texels px for the 4 colors between
+* c0 and c1 and add their squared error to *error. Returns them, 2 bits
+* per texel from the first one on. */
+static GLuint textureBc1Indices(const GLubyte *px, GLushort c0, GLushort c1, int *error)
+{
+	int palette[4][3], i, j, k;
+	GLuint indices = 0;
+
+	textureUnpack565(c0, palette[0]);
+	textureUnpack565(c1, palette[1]);
+	for (k = 0; k < 3; k++) {
+		palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+		palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+	}
+	for (i = 0; i < 16; i++) {
+		int best = 0, bestError = 0x7fffffff;
+		for (j = 0; j < 4; j++) {
+			int dr = px[4 * i] - palette[j][0], dg = px[4 * i + 1] - palette[j][1], db = px[4 * i + 2] - palette[j][2];
+			int e = dr * dr + dg * dg + db * db;
+			if (e < bestError) {
+				bestError = e;
+				best = j;
+			}
+		}
+		indices |= (GLuint)best << (2 * i);
+		*error += bestError;
+	}
+	return indices;
+}
+
+/* Write the 8 byte BC1 block of color0, color1 and indices to out. */
+static void textureBc1Store(GLubyte *out, GLushort c0, GLushort c1, GLuint indices)
+{
+	out[0] = (GLubyte)(c0 & 0xff);
+	out[1] = (GLubyte)(c0 >> 8);
+	out[2] = (GLubyte)(c1 & 0xff);
+	out[3] = (GLubyte)(c1 >> 8);
+	out[4] = (GLubyte)(indices & 0xff);
+	out[5] = (GLubyte)((indices >> 8) & 0xff);
+	out[6] = (GLubyte)((indices >> 16) & 0xff);
+	out[7] = (GLubyte)(indices >> 24);
+}
+
+/* Encode the colors of the 4x4 RGBA texels px as a BC1 block in the four
+* color mode, which BC3 needs, and write it to out. */
+static void textureEncodeBc1(const GLubyte *px, GLubyte *out)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f }, cov[6] = { 0.0f }, axis[3];
+	float lo[3] = { 0.0f, 0.0f, 0.0f }, hi[3] = { 0.0f, 0.0f, 0.0f };
+	float minDot = 1e30f, maxDot = -1e30f;
+	int i, k, iter;
+
+	for (i = 0; i < 16; i++)
+		for (k = 0; k < 3; k++)
+			mean[k] += px[4 * i + k] / 16.0f;
+	for (i = 0; i < 16; i++) {
+		float d[3] = { px[4 * i] - mean[0], px[4 * i + 1] - mean[1], px[4 * i + 2] - mean[2] };
+		cov[0] += d[0] * d[0];
+		cov[1] += d[0] * d[1];
+		cov[2] += d[0] * d[2];
+		cov[3] += d[1] * d[1];
+		cov[4] += d[1] * d[2];
+		cov[5] += d[2] * d[2];
+	}
+	/* the principal axis by power iteration, starting from the luminance */
+	axis[0] = 0.3f;
+	axis[1] = 0.6f;
+	axis[2] = 0.1f;
+	for (iter = 0; iter < 8; iter++) {
+		float a[3] = {
+			cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+			cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+			cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+		};
+		float m = fabsf(a[0]) > fabsf(a[1]) ? fabsf(a[0]) : fabsf(a[1]);
+		m = m > fabsf(a[2]) ? m : fabsf(a[2]);
+		if (m < 1e-6f)
+			break;
+		for (k = 0; k < 3; k++)
+			axis[k] = a[k] / m;
+	}
+	for (i = 0; i < 16; i++) {
+		float d = px[4 * i] * axis[0] + px[4 * i + 1] * axis[1] + px[4 * i + 2] * axis[2];
+		if (d < minDot) {
+			minDot = d;
+			for (k = 0; k < 3; k++)
+				lo[k] = px[4 * i + k];
+		}
+		if (d > maxDot) {
+			maxDot = d;
+			for (k = 0; k < 3; k++)
+				hi[k] = px[4 * i + k];
+		}
+	}
+
+	GLushort c0 = texturePack565(hi), c1 = texturePack565(lo);
+	int error = 0;
+	GLuint indices = textureBc1Indices(px, c0, c1, &error);
+
+	/* least squares endpoints for these indices: each texel is
+	* w * hi + (1 - w) * lo */
+	static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[3] = { 0.0f }, bx[3] = { 0.0f };
+	for (i = 0; i < 16; i++) {
+		float w = weights[(indices >> (2 * i)) & 3], v = 1.0f - w;
+		aa += w * w;
+		ab += w * v;
+		bb += v * v;
+		for (k = 0; k < 3; k++) {
+			ax[k] += w * px[4 * i + k];
+			bx[k] += v * px[4 * i + k];
+		}
+	}
+	float det = aa * bb - ab * ab;
+	if (fabsf(det) > 1e-6f) {
+		for (k = 0; k < 3; k++) {
+			hi[k] = (ax[k] * bb - bx[k] * ab) / det;
+			lo[k] = (bx[k] * aa - ax[k] * ab) / det;
+		}
+		GLushort r0 = texturePack565(hi), r1 = texturePack565(lo);
+		int refinedError = 0;
+		GLuint refined = textureBc1Indices(px, r0, r1, &refinedError);
+		if (refinedError < error) {
+			c0 = r0;
+			c1 = r1;
+			indices = refined;
+		}
+	}
+
+	/* the four color mode needs color0 > color1 */
+	if (c0 < c1) {
+		GLushort t = c0;
+		c0 = c1;
+		c1 = t;
+		/* 0 <-> 1 and 2 <-> 3 */
+		indices ^= 0x55555555u;
+	} else if (c0 == c1) {
+		indices = 0;
+	}
+	textureBc1Store(out, c0, c1, indices);
+}
+
+/* Encode channel c of the 4x4 RGBA texels px as a BC4 block (the alpha
+* block of BC3) with 8 values between the extremes and write it to out. */
+static void textureEncodeBc4(const GLubyte *px, int c, GLubyte *out)
+{
+	int i, j, lo = 255, hi = 0, values[8];
+	GLuint64 indices = 0;
+
+	for (i = 0; i < 16; i++) {
+		int v = px[4 * i + c];
+		lo = v < lo ? v : lo;
+		hi = v > hi ? v : hi;
+	}
+	out[0] = (GLubyte)hi;
+	out[1] = (GLubyte)lo;
+	/* with hi == lo it is the 6 value mode, index 0 is hi all the same */
+	if (hi > lo) {
+		values[0] = hi;
+		values[1] = lo;
+		for (j = 1; j < 7; j++)
+			values[j + 1] = ((7 - j) * hi + j * lo + 3) / 7;
+		for (i = 0; i < 16; i++) {
+			int v = px[4 * i + c], best = 0, bestError = 256;
+			for (j = 0; j < 8; j++) {
+				int e = abs(v - values[j]);
+				if (e < bestError) {
+					bestError = e;
+					best = j;
+				}
+			}
+			indices |= (GLuint64)best << (3 * i);
+		}
+	}
+	for (i = 0; i < 6; i++)
+		out[2 + i] = (GLubyte)((indices >> (8 * i)) & 0xff);
+}
+
+/* Encode the w x h RGBA image src into blocks of format, one of BC1, BC3,
+* BC4 and BC5, in dst. Partial blocks at the edges repeat the last texels.
+* Returns false if the format cannot be encoded. */
+static bool textureEncodeLevel(const GLubyte *src, GLuint w, GLuint h, GLenum format, GLubyte *dst)
+{
+	GLubyte px[16 * 4];
+	GLuint bx, by, x, y;
+
+	switch (format) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_RG_RGTC2:
+			break;
+		default:
+			return false;
+	}
+	for (by = 0; by < (h + 3) / 4; by++) {
+		for (bx = 0; bx < (w + 3) / 4; bx++) {
+			for (y = 0; y < 4; y++) {
+				GLuint sy = 4 * by + y < h ? 4 * by + y : h - 1;
+				for (x = 0; x < 4; x++) {
+					GLuint sx = 4 * bx + x < w ? 4 * bx + x : w - 1;
+					memcpy(px + 4 * (4 * y + x), src + 4 * ((size_t)sy * w + sx), 4);
+				}
+			}
+			switch (format) {
+				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+					textureEncodeBc1(px, dst);
+					dst += 8;
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+					textureEncodeBc4(px, 3, dst);
+					textureEncodeBc1(px, dst + 8);
+					dst += 16;
+					break;
+				case GL_COMPRESSED_RED_RGTC1:
+					textureEncodeBc4(px, 0, dst);
+					dst += 8;
+					break;
+				default:
+					textureEncodeBc4(px, 0, dst);
+					textureEncodeBc4(px, 1, dst + 8);
+					dst += 16;
+					break;
+			}
+		}
+	}
+	return true;
+}
+
+/* Encode img, layerCount layers stacked from top to bottom, with all its
+* levels in format and write it to the texture file out.
+* Returns true if successfull and false in case of an error. */
+static bool textureEncodeImage(const TextureImage *img, GLuint layerCount, GLenum format, const char *out,
+	bool supercompress)
+{
+	const TextureFormatDesc *desc = textureFormatDesc(format);
+	GLubyte *levels[TEXTURE_FILE_LEVELS_MAX];
+	GLubyte *cur = NULL, *next = NULL;
+	GLuint i, j, levelCount = 1, width = img->width, height;
+	bool ok = true;
+
+	if (!layerCount || img->height % layerCount) {
+		warn("texture encoder: %u rows do not split into %u layers", img->height, layerCount);
+		return false;
+	}
+	height = img->height / layerCount;
+	if (height > TEXTURE_FILE_SIZE_MAX) {
+		warn("texture encoder: layers of %u rows are too high", height);
+		return false;
+	}
+	while (levelCount < TEXTURE_FILE_LEVELS_MAX && ((width >> levelCount) | (height >> levelCount)))
+		levelCount++;
+	memset(levels, 0, sizeof(levels));
+
+	size_t layerSize = (size_t)width * height * 4;
+	cur = (GLubyte*)malloc(layerSize);
+	next = (GLubyte*)malloc(layerSize);
+	for (i = 0; i < levelCount && cur && next; i++) {
+		levels[i] = (GLubyte*)malloc((size_t)textureLevelSize(width, height, i, 4, 4, desc->blockBytes) * layerCount);
+		if (!levels[i])
+			break;
+	}
+	if (i < levelCount) {
+		warn("texture encoder: failed to allocate the levels");
+		ok = false;
+	}
+	/* layer by layer, each level is filtered from the one above */
+	for (j = 0; j < layerCount && ok; j++) {
+		GLuint w = width, h = height;
+		memcpy(cur, img->rgba + layerSize * j, layerSize);
+		for (i = 0; i < levelCount && ok; i++) {
+			GLuint64 bytes = textureLevelSize(width, height, i, 4, 4, desc->blockBytes);
+			ok = textureEncodeLevel(cur, w, h, format, levels[i] + (size_t)bytes * j);
+			textureDownsample(cur, w, h, next);
+			GLubyte *t = cur;
+			cur = next;
+			next = t;
+			w = w > 1 ? w / 2 : 1;
+			h = h > 1 ? h / 2 : 1;
+		}
+	}
+	if (ok)
+		ok = textureFileWrite(out, format, width, height, layerCount, levelCount, levels, supercompress);
+	else
+		warn("texture encoder: cannot encode %s", desc->name);
+	for (i = 0; i < levelCount; i++)
+		free(levels[i]);
+	free(cur);
+	free(next);
+	return ok;
+}
+
+/* Returns the GL format of the Vulkan format vkFormat of a KTX2 file, 0 if
+* it is not a block compressed one we know. */
+static GLenum textureKtx2Format(GLuint vkFormat)
+{
+	static const GLenum astc[] = {
+		GL_COMPRESSED_RGBA_ASTC_4x4_KHR, GL_COMPRESSED_RGBA_ASTC_5x4_KHR, GL_COMPRESSED_RGBA_ASTC_5x5_KHR,
+		GL_COMPRESSED_RGBA_ASTC_6x5_KHR, GL_COMPRESSED_RGBA_ASTC_6x6_KHR, GL_COMPRESSED_RGBA_ASTC_8x5_KHR,
+		GL_COMPRESSED_RGBA_ASTC_8x6_KHR, GL_COMPRESSED_RGBA_ASTC_8x8_KHR, GL_COMPRESSED_RGBA_ASTC_10x5_KHR,
+		GL_COMPRESSED_RGBA_ASTC_10x6_KHR, GL_COMPRESSED_RGBA_ASTC_10x8_KHR, GL_COMPRESSED_RGBA_ASTC_10x10_KHR,
+		GL_COMPRESSED_RGBA_ASTC_12x10_KHR, GL_COMPRESSED_RGBA_ASTC_12x12_KHR,
+	};
+
+	switch (vkFormat) {
+		case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	/* VK_FORMAT_BC1_RGB_UNORM_BLOCK */
+		case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;	/* VK_FORMAT_BC1_RGBA_UNORM_BLOCK */
+		case 135: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;	/* VK_FORMAT_BC2_UNORM_BLOCK */
+		case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;	/* VK_FORMAT_BC3_UNORM_BLOCK */
+		case 139: return GL_COMPRESSED_RED_RGTC1;		/* VK_FORMAT_BC4_UNORM_BLOCK */
+		case 140: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+		case 141: return GL_COMPRESSED_RG_RGTC2;		/* VK_FORMAT_BC5_UNORM_BLOCK */
+		case 142: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+		case 143: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;	/* VK_FORMAT_BC6H_UFLOAT_BLOCK */
+		case 144: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+		case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;	/* VK_FORMAT_BC7_UNORM_BLOCK */
+		case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		default:
+			/* VK_FORMAT_ASTC_4x4_UNORM_BLOCK is 157, then pairs of UNORM and SRGB */
+			if (vkFormat >= 157 && vkFormat < 157 + 2 * 14 && !((vkFormat - 157) & 1))
+				return astc[(vkFormat - 157) / 2];
+			return 0;
+	}
+}
+
+static GLuint64 textureRead64(const GLubyte *p)
+{
+	GLuint64 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/* Copy the blocks of the KTX2 file in the size bytes data into the texture
+* file out. Returns true if successfull and false in case of an error. */
+static bool textureTranscodeKtx2(const GLubyte *data, size_t size, const char *in, const char *out,
+	bool supercompress)
+{
+	const GLubyte *levels[TEXTURE_FILE_LEVELS_MAX];
+	GLuint i;
+
+	if (size < TEXTURE_KTX2_HEADER_SIZE) {
+		warn("KTX2 file '%s' is truncated", in);
+		return false;
+	}
+	GLuint vkFormat = lzRead32(data + 12), width = lzRead32(data + 20), height = lzRead32(data + 24),
+		depth = lzRead32(data + 28), layerCount = lzRead32(data + 32), faceCount = lzRead32(data + 36),
+		levelCount = lzRead32(data + 40), scheme = lzRead32(data + 44);
+	GLenum format = textureKtx2Format(vkFormat);
+	const TextureFormatDesc *desc = textureFormatDesc(format);
+
+	if (!desc) {
+		warn("KTX2 file '%s' has format %u, which is not block compressed", in, vkFormat);
+		return false;
+	}
+	if (scheme) {
+		warn("KTX2 file '%s' is supercompressed with scheme %u, decompress it first", in, scheme);
+		return false;
+	}
+	layerCount = layerCount ? layerCount : 1;
+	/* 0 asks the loader to generate the mipmaps, which it cannot for blocks */
+	if (depth > 1 || faceCount != 1 || !levelCount || levelCount > TEXTURE_FILE_LEVELS_MAX ||
+		size < TEXTURE_KTX2_HEADER_SIZE + (size_t)levelCount * 24) {
+		warn("KTX2 file '%s' has an unsupported layout", in);
+		return false;
+	}
+	for (i = 0; i < levelCount; i++) {
+		const GLubyte *l = data + TEXTURE_KTX2_HEADER_SIZE + 24 * i;
+		GLuint64 offset = textureRead64(l), length = textureRead64(l + 8);
+		GLuint64 expected = textureLevelSize(width, height, i, desc->blockWidth, desc->blockHeight,
+			desc->blockBytes) * layerCount;
+		/* textureFileWrite checks width, height and layerCount before it
+		* reads expected bytes */
+		if (length != expected || offset > size || length > size - offset) {
+			warn("KTX2 file '%s' has an invalid level %u", in, i);
+			return false;
+		}
+		levels[i] = data + offset;
+	}
+	info("transcoding KTX2 file '%s': %ux%u %s, %u layers, %u levels", in, width, height, desc->name, layerCount,
+		levelCount);
+	return textureFileWrite(out, format, width, height, layerCount, levelCount, levels, supercompress);
+}
+
+/* Returns the format of the short name as in textureFormats, 0 if there
+* is none. */
+static GLenum textureFormatByName(const char *name)
+{
+	size_t i;
+	for (i = 0; i < sizeof(textureFormats) / sizeof(textureFormats[0]); i++) {
+		if (!strcmp(textureFormats[i].name, name))
+			return textureFormats[i].format;
+	}
+	return 0;
+}
+
+/* Build the texture file out from the image or KTX2 file in. Images are
+* split into layerCount layers and encoded to format, KTX2 files keep the
+* format they have. With supercompress, the levels are compressed with Lz.h.
+* Returns true if successfull and false in case of an error. */
+static bool textureBuildFile(const char *in, const char *out, GLenum format, GLuint layerCount, bool supercompress)
+{
+	static const GLubyte ktx2[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+	TextureImage img;
+	size_t size = 0;
+	bool ok;
+
+	GLubyte *data = textureReadFile(in, &size);
+	if (!data)
+		return false;
+	if (size >= sizeof(ktx2) && !memcmp(data, ktx2, sizeof(ktx2))) {
+		ok = textureTranscodeKtx2(data, size, in, out, supercompress);
+	} else {
+		ok = textureImageDecode(data, size, in, &img);
+		if (ok)
+			ok = textureEncodeImage(&img, layerCount, format, out, supercompress);
+		free(img.rgba);
+	}
+	free(data);
+	return ok;
+}
+
+#endif
@@ -0,0 +1,509 @@
+#ifndef HEADER_TEXTUREFILE_H
+#define HEADER_TEXTUREFILE_H
+
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShaderHelpers.h"
+#include "Lz.h"
+
+/****************************************************************************
+* COMPRESSED TEXTURE FILES                                                 *
+****************************************************************************/
+
+/* A texture file holds a texture in a block compressed format (BC1 to BC7,
+* ASTC) with all of its mip levels, the way glCompressedTexSubImage reads
+* them, like a KTX2 file:
+*   TextureFileHeader, with the format and where the levels are
+*   the levels, largest first, each with all of its layers one after the
+*   other, each layer rows of blocks from the top
+* A level may be supercompressed (TEXTURE_SUPERCOMPRESSION_LZ, see Lz.h),
+* then it is inflated into a scratch buffer before the upload; otherwise
+* the upload reads straight from the mapping. Every level starts at a
+* multiple of TEXTURE_FILE_ALIGN, which keeps the blocks aligned. All values
+* are little endian. The files are written by textureBuildFile, see
+* TextureEncoder.h. A block compressed texture takes a quarter (BC3, BC7,
+* ASTC 4x4) to an eighth (BC1) of the memory and bandwidth of RGBA8. */
+#define TEXTURE_FILE_MAGIC 0x58544348u	/* "HCTX" */
+#define TEXTURE_FILE_VERSION 1
+#define TEXTURE_FILE_ALIGN 16
+#define TEXTURE_FILE_LEVELS_MAX 16
+#define TEXTURE_FILE_SIZE_MAX 16384	/* width and height */
+#define TEXTURE_FILE_LAYERS_MAX 2048
+
+/* supercompression of the levels */
+enum {
+	TEXTURE_SUPERCOMPRESSION_NONE = 0,
+	TEXTURE_SUPERCOMPRESSION_LZ
+};
+
+typedef struct {
+	GLuint64 offset;	/* from the start of the file */
+	GLuint64 length;	/* in the file */
+	GLuint64 uncompressedLength;	/* of all layers, the same as length without supercompression */
+} TextureFileLevel;
+
+typedef struct {
+	GLuint magic;		/* TEXTURE_FILE_MAGIC */
+	GLuint version;		/* TEXTURE_FILE_VERSION */
+	GLuint format;		/* GL internal format, one of textureFormats */
+	GLuint blockWidth, blockHeight, blockBytes;
+	GLuint width, height;	/* of level 0 */
+	GLuint layerCount;	/* at least 1 */
+	GLuint levelCount;	/* 1 to TEXTURE_FILE_LEVELS_MAX */
+	GLuint supercompression;	/* TEXTURE_SUPERCOMPRESSION_* */
+	GLuint pad;
+	TextureFileLevel levels[TEXTURE_FILE_LEVELS_MAX];
+} TextureFileHeader;
+
+/* a block compressed format */
+typedef struct {
+	GLenum format;
+	GLuint blockWidth, blockHeight, blockBytes;
+	const char *name;
+} TextureFormatDesc;
+
+static const TextureFormatDesc textureFormats[] = {
+	{ GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 4, 4, 8, "BC1" },
+	{ GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, 8, "BC1a" },
+	{ GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 4, 4, 16, "BC2" },
+	{ GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 4, 4, 16, "BC3" },
+	{ GL_COMPRESSED_RED_RGTC1, 4, 4, 8, "BC4" },
+	{ GL_COMPRESSED_SIGNED_RED_RGTC1, 4, 4, 8, "BC4s" },
+	{ GL_COMPRESSED_RG_RGTC2, 4, 4, 16, "BC5" },
+	{ GL_COMPRESSED_SIGNED_RG_RGTC2, 4, 4, 16, "BC5s" },
+	{ GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 4, 4, 16, "BC6H" },
+	{ GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 4, 4, 16, "BC6Hs" },
+	{ GL_COMPRESSED_RGBA_BPTC_UNORM, 4, 4, 16, "BC7" },
+	{ GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 4, 4, 16, "BC7 sRGB" },
+	{ GL_COMPRESSED_RGBA_ASTC_4x4_KHR, 4, 4, 16, "ASTC 4x4" },
+	{ GL_COMPRESSED_RGBA_ASTC_5x4_KHR, 5, 4, 16, "ASTC 5x4" },
+	{ GL_COMPRESSED_RGBA_ASTC_5x5_KHR, 5, 5, 16, "ASTC 5x5" },
+	{ GL_COMPRESSED_RGBA_ASTC_6x5_KHR, 6, 5, 16, "ASTC 6x5" },
+	{ GL_COMPRESSED_RGBA_ASTC_6x6_KHR, 6, 6, 16, "ASTC 6x6" },
+	{ GL_COMPRESSED_RGBA_ASTC_8x5_KHR, 8, 5, 16, "ASTC 8x5" },
+	{ GL_COMPRESSED_RGBA_ASTC_8x6_KHR, 8, 6, 16, "ASTC 8x6" },
+	{ GL_COMPRESSED_RGBA_ASTC_8x8_KHR, 8, 8, 16, "ASTC 8x8" },
+	{ GL_COMPRESSED_RGBA_ASTC_10x5_KHR, 10, 5, 16, "ASTC 10x5" },
+	{ GL_COMPRESSED_RGBA_ASTC_10x6_KHR, 10, 6, 16, "ASTC 10x6" },
+	{ GL_COMPRESSED_RGBA_ASTC_10x8_KHR, 10, 8, 16, "ASTC 10x8" },
+	{ GL_COMPRESSED_RGBA_ASTC_10x10_KHR, 10, 10, 16, "ASTC 10x10" },
+	{ GL_COMPRESSED_RGBA_ASTC_12x10_KHR, 12, 10, 16, "ASTC 12x10" },
+	{ GL_COMPRESSED_RGBA_ASTC_12x12_KHR, 12, 12, 16, "ASTC 12x12" },
+};
+
+/* Returns the description of format, NULL if it is not one we know. */
+static const TextureFormatDesc *textureFormatDesc(GLenum format)
+{
+	size_t i;
+	for (i = 0; i < sizeof(textureFormats) / sizeof(textureFormats[0]); i++) {
+		if (textureFormats[i].format == format)
+			return &textureFormats[i];
+	}
+	return NULL;
+}
+
+/* Returns true if the context can sample textures in format. */
+static bool textureFormatSupported(GLenum format)
+{
+	switch (format) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return GLAD_GL_EXT_texture_compression_s3tc;
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+			/* core since 3.0 */
+			return true;
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+		default:
+			return textureFormatDesc(format) && GLAD_GL_KHR_texture_compression_astc_ldr;
+	}
+}
+
+/* Returns the bytes of one layer of level of a texture of width x height
+* in blocks of blockWidth x blockHeight of blockBytes. */
+static GLuint64 textureLevelSize(GLuint width, GLuint height, GLuint level, GLuint blockWidth, GLuint blockHeight,
+	GLuint blockBytes)
+{
+	GLuint w = width >> level, h = height >> level;
+	w = w ? w : 1;
+	h = h ? h : 1;
+	return (GLuint64)((w + blockWidth - 1) / blockWidth) * ((h + blockHeight - 1) / blockHeight) * blockBytes;
+}
+
+/* Round offset up to a multiple of TEXTURE_FILE_ALIGN. */
+static GLuint64 textureFileAlign(GLuint64 offset)
+{
+	return (offset + TEXTURE_FILE_ALIGN - 1) / TEXTURE_FILE_ALIGN * TEXTURE_FILE_ALIGN;
+}
+
+typedef struct {
+	const TextureFileHeader *header;	/* points into the mapping */
+	const TextureFormatDesc *desc;
+	void *map;
+	GLuint64 size;
+	AssetData asset;	/* map, if it came from the asset archive */
+#ifdef WIN32
+	HANDLE mapping;
+#endif
+	GLubyte *scratch;	/* an inflated level */
+	size_t scratchSize;
+
+	/* Check that the mapped file is a texture file we can use. Returns
+	* false if it is not. */
+	bool parse(const char *filename)
+	{
+		GLuint i;
+		const TextureFileHeader *h = (const TextureFileHeader*)map;
+
+		if (size < sizeof(TextureFileHeader) || h->magic != TEXTURE_FILE_MAGIC) {
+			warn("'%s' is not a texture file", filename);
+			return false;
+		}
+		if (h->version != TEXTURE_FILE_VERSION) {
+			warn("texture file '%s' has version %u, expected %u", filename, h->version, TEXTURE_FILE_VERSION);
+			return false;
+		}
+		desc = textureFormatDesc((GLenum)h->format);
+		if (!desc || h->blockWidth != desc->blockWidth || h->blockHeight != desc->blockHeight ||
+			h->blockBytes != desc->blockBytes) {
+			warn("texture file '%s' has an unknown format 0x%x", filename, h->format);
+			return false;
+		}
+		if (!h->width || !h->height || h->width > TEXTURE_FILE_SIZE_MAX || h->height > TEXTURE_FILE_SIZE_MAX ||
+			!h->layerCount || h->layerCount > TEXTURE_FILE_LAYERS_MAX ||
+			!h->levelCount || h->levelCount > TEXTURE_FILE_LEVELS_MAX ||
+			(h->width >> (h->levelCount - 1)) + (h->height >> (h->levelCount - 1)) == 0 ||
+			h->supercompression > TEXTURE_SUPERCOMPRESSION_LZ) {
+			warn("texture file '%s' has an unsupported layout", filename);
+			return false;
+		}
+		/* with the limits above, none of these products overflow */
+		for (i = 0; i < h->levelCount; i++) {
+			const TextureFileLevel *l = &h->levels[i];
+			GLuint64 expected = textureLevelSize(h->width, h->height, i, h->blockWidth, h->blockHeight,
+				h->blockBytes) * h->layerCount;
+			/* the uploads take the size of a level as a GLsizei */
+			if (l->uncompressedLength != expected || expected > 0x7fffffff ||
+				(h->supercompression == TEXTURE_SUPERCOMPRESSION_NONE && l->length != expected)) {
+				warn("texture file '%s' has an invalid level %u", filename, i);
+				return false;
+			}
+			if (l->offset % TEXTURE_FILE_ALIGN || l->offset > size || l->length > size - l->offset) {
+				warn("texture file '%s' is truncated", filename);
+				return false;
+			}
+		}
+		header = h;
+		return true;
+	}
+
+	/* Map the file filename, outside of the asset archive.
+	* Returns true if successfull and false in case of an error. */
+	bool mapFile(const char *filename)
+	{
+		GLuint64 mtime;
+
+		if (!shaderSourceStat(filename, &mtime, &size)) {
+			warn("failed to open texture file '%s'", filename);
+			return false;
+		}
+		if (size < sizeof(TextureFileHeader) || size > (GLuint64)(size_t)-1) {
+			warn("'%s' is not a texture file", filename);
+			return false;
+		}
+#ifdef WIN32
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			warn("failed to open texture file '%s'", filename);
+			return false;
+		}
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (mapping)
+			map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+		if (!map) {
+			if (mapping)
+				CloseHandle(mapping);
+			warn("failed to map texture file '%s'", filename);
+			return false;
+		}
+#else
+		int fd = ::open(filename, O_RDONLY);
+		if (fd < 0) {
+			warn("failed to open texture file '%s'", filename);
+			return false;
+		}
+		void *m = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (m == MAP_FAILED) {
+			warn("failed to map texture file '%s'", filename);
+			return false;
+		}
+		/* the levels are read once, front to back */
+		madvise(m, (size_t)size, MADV_SEQUENTIAL);
+		map = m;
+#endif
+		return true;
+	}
+
+	/* Map filename, or find it in the asset archive. The header stays
+	* valid until close().
+	* Returns true if successfull and false in case of an error. */
+	bool open(const char *filename)
+	{
+		header = NULL;
+		desc = NULL;
+		map = NULL;
+		scratch = NULL;
+		scratchSize = 0;
+		asset.data = NULL;
+		asset.owned = NULL;
+		if (assetArchive()->read(filename, &asset)) {
+			map = (void*)asset.data;
+			size = asset.size;
+		} else if (!mapFile(filename)) {
+			return false;
+		}
+		if (!parse(filename)) {
+			close();
+			return false;
+		}
+		info("texture file '%s': %ux%u %s, %u layers, %u levels%s", filename, header->width, header->height,
+			desc->name, header->layerCount, header->levelCount,
+			header->supercompression == TEXTURE_SUPERCOMPRESSION_LZ ? ", supercompressed" : "");
+		return true;
+	}
+
+	void close()
+	{
+		if (asset.data) {
+			assetDataRelease(&asset);
+		} else if (map) {
+#ifdef WIN32
+			UnmapViewOfFile(map);
+			CloseHandle(mapping);
+#else
+			munmap(map, (size_t)size);
+#endif
+		}
+		free(scratch);
+		scratch = NULL;
+		scratchSize = 0;
+		map = NULL;
+		header = NULL;
+		desc = NULL;
+	}
+
+	/* The blocks of all layers of level, in the mapping or, if the file is
+	* supercompressed, in the scratch buffer until the next call.
+	* Returns NULL if the level cannot be inflated. */
+	const GLubyte *levelData(GLuint level)
+	{
+		const TextureFileLevel *l = &header->levels[level];
+		const GLubyte *data = (const GLubyte*)map + l->offset;
+
+		if (header->supercompression == TEXTURE_SUPERCOMPRESSION_NONE)
+			return data;
+		if (l->uncompressedLength > scratchSize) {
+			GLubyte *s = (GLubyte*)realloc(scratch, (size_t)l->uncompressedLength);
+			if (!s)
+				return NULL;
+			scratch = s;
+			scratchSize = (size_t)l->uncompressedLength;
+		}
+		if (!lzDecompress(data, (size_t)l->length, scratch, (size_t)l->uncompressedLength)) {
+			warn("texture file: level %u is corrupt", level);
+			return NULL;
+		}
+		return scratch;
+	}
+
+	GLsizei levelWidth(GLuint level) const
+	{
+		GLuint w = header->width >> level;
+		return (GLsizei)(w ? w : 1);
+	}
+
+	GLsizei levelHeight(GLuint level) const
+	{
+		GLuint h = header->height >> level;
+		return (GLsizei)(h ? h : 1);
+	}
+
+	/* Allocate all levels of the bound texture of target, GL_TEXTURE_2D
+	* or GL_TEXTURE_2D_ARRAY, immutable if the context has texture storage. */
+	void allocate(GLenum target) const
+	{
+		GLuint i;
+		GLenum format = (GLenum)header->format;
+		GLsizei levels = (GLsizei)header->levelCount, layers = (GLsizei)header->layerCount;
+		MemoryScope scope(MEMORY_TEXTURES);
+
+		if (target == GL_TEXTURE_2D_ARRAY && glTexStorage3D) {
+			glTexStorage3D(target, levels, format, levelWidth(0), levelHeight(0), layers);
+		} else if (target == GL_TEXTURE_2D && glTexStorage2D) {
+			glTexStorage2D(target, levels, format, levelWidth(0), levelHeight(0));
+		} else {
+			for (i = 0; i < header->levelCount; i++) {
+				GLsizei bytes = (GLsizei)(header->levels[i].uncompressedLength / header->layerCount);
+				if (target == GL_TEXTURE_2D_ARRAY)
+					glCompressedTexImage3D(target, i, format, levelWidth(i), levelHeight(i), layers, 0,
+						bytes * layers, NULL);
+				else
+					glCompressedTexImage2D(target, i, format, levelWidth(i), levelHeight(i), 0, bytes, NULL);
+			}
+			glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		}
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+
+	/* Create a GL_TEXTURE_2D_ARRAY texture with all layers and levels.
+	* Returns it, 0 in case of an error. */
+	GLuint createArray()
+	{
+		GLuint i, tex;
+
+		glGenTextures(1, &tex);
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, tex);
+		allocate(GL_TEXTURE_2D_ARRAY);
+		for (i = 0; i < header->levelCount; i++) {
+			const GLubyte *data = levelData(i);
+			if (!data) {
+				glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+				glState()->deleteTextures(1, &tex);
+				return 0;
+			}
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, 0, levelWidth(i), levelHeight(i),
+				(GLsizei)header->layerCount, (GLenum)header->format,
+				(GLsizei)header->levels[i].uncompressedLength, data);
+		}
+		glState()->bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		GL_ERROR_DBG("compressed array texture");
+		return tex;
+	}
+
+	/* Create a GL_TEXTURE_2D texture for each of the count layers from
+	* first on in textures.
+	* Returns true if successfull and false in case of an error. */
+	bool createLayers(GLuint first, GLuint count, GLuint *textures)
+	{
+		GLuint i, j;
+
+		glGenTextures((GLsizei)count, textures);
+		for (j = 0; j < count; j++) {
+			glState()->bindTexture(GL_TEXTURE_2D, textures[j]);
+			allocate(GL_TEXTURE_2D);
+		}
+		/* level by level, so every level is inflated once */
+		for (i = 0; i < header->levelCount; i++) {
+			const GLubyte *data = levelData(i);
+			GLsizei bytes = (GLsizei)(header->levels[i].uncompressedLength / header->layerCount);
+			if (!data) {
+				glState()->bindTexture(GL_TEXTURE_2D, 0);
+				glState()->deleteTextures((GLsizei)count, textures);
+				return false;
+			}
+			for (j = 0; j < count; j++) {
+				glState()->bindTexture(GL_TEXTURE_2D, textures[j]);
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, levelWidth(i), levelHeight(i),
+					(GLenum)header->format, bytes, data + (size_t)bytes * (first + j));
+			}
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		GL_ERROR_DBG("compressed textures");
+		return true;
+	}
+} TextureFile;
+
+/* Write zero bytes to file until it is at offset. */
+static bool textureFilePad(FILE *file, GLuint64 offset)
+{
+	static const GLubyte zero[TEXTURE_FILE_ALIGN] = { 0 };
+	long pos = ftell(file);
+	if (pos < 0 || (GLuint64)pos > offset || offset - (GLuint64)pos > TEXTURE_FILE_ALIGN)
+		return false;
+	return fwrite(zero, 1, (size_t)(offset - (GLuint64)pos), file) == (size_t)(offset - (GLuint64)pos);
+}
+
+/* Write a texture file of layerCount layers of width x height in format
+* with levelCount levels; levels[i] are the blocks of all layers of level
+* i. With supercompress, each level is compressed with lzCompress.
+* Returns true if successfull and false in case of an error. */
+static bool textureFileWrite(const char *filename, GLenum format, GLuint width, GLuint height, GLuint layerCount,
+	GLuint levelCount, const GLubyte * const *levels, bool supercompress)
+{
+	TextureFileHeader h;
+	const TextureFormatDesc *desc = textureFormatDesc(format);
+	GLubyte *packed[TEXTURE_FILE_LEVELS_MAX];
+	GLuint i;
+	GLuint64 offset, total = 0;
+	FILE *file;
+	bool ok = true;
+
+	if (!desc || !width || !height || width > TEXTURE_FILE_SIZE_MAX || height > TEXTURE_FILE_SIZE_MAX ||
+		!layerCount || layerCount > TEXTURE_FILE_LAYERS_MAX || !levelCount || levelCount > TEXTURE_FILE_LEVELS_MAX) {
+		warn("texture file '%s': unsupported layout", filename);
+		return false;
+	}
+	memset(&h, 0, sizeof(h));
+	memset(packed, 0, sizeof(packed));
+	h.magic = TEXTURE_FILE_MAGIC;
+	h.version = TEXTURE_FILE_VERSION;
+	h.format = (GLuint)format;
+	h.blockWidth = desc->blockWidth;
+	h.blockHeight = desc->blockHeight;
+	h.blockBytes = desc->blockBytes;
+	h.width = width;
+	h.height = height;
+	h.layerCount = layerCount;
+	h.levelCount = levelCount;
+	h.supercompression = supercompress ? TEXTURE_SUPERCOMPRESSION_LZ : TEXTURE_SUPERCOMPRESSION_NONE;
+
+	offset = textureFileAlign(sizeof(h));
+	for (i = 0; i < levelCount && ok; i++) {
+		TextureFileLevel *l = &h.levels[i];
+		l->uncompressedLength = textureLevelSize(width, height, i, desc->blockWidth, desc->blockHeight,
+			desc->blockBytes) * layerCount;
+		l->length = l->uncompressedLength;
+		l->offset = offset;
+		if (supercompress) {
+			size_t bound = lzBound((size_t)l->uncompressedLength);
+			packed[i] = (GLubyte*)malloc(bound);
+			l->length = packed[i] ? lzCompress(levels[i], (size_t)l->uncompressedLength, packed[i], bound) : 0;
+			ok = l->length != 0;
+		}
+		offset = textureFileAlign(offset + l->length);
+		total += l->length;
+	}
+
+	file = ok ? fopen(filename, "wb") : NULL;
+	ok = file && fwrite(&h, sizeof(h), 1, file) == 1;
+	for (i = 0; i < levelCount && ok; i++) {
+		ok = textureFilePad(file, h.levels[i].offset) &&
+			fwrite(supercompress ? packed[i] : levels[i], 1, (size_t)h.levels[i].length, file) ==
+			(size_t)h.levels[i].length;
+	}
+	for (i = 0; i < levelCount; i++)
+		free(packed[i]);
+	if ((file && fclose(file)) || !ok) {
+		warn("failed to write texture file '%s'", filename);
+		return false;
+	}
+	info("wrote texture file '%s' with %ux%u %s, %u layers, %u levels, %llu bytes of blocks", filename, width,
+		height, desc->name, layerCount, levelCount, (unsigned long long)total);
+	return true;
+}
+
+#endif
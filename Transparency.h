@@ -0,0 +1,336 @@
+#ifndef HEADER_TRANSPARENCY_H
+#define HEADER_TRANSPARENCY_H
+
+#include <glad/glad.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "GLState.h"
+#include "RenderTarget.h"
+
+/****************************************************************************
+* ORDER-INDEPENDENT TRANSPARENCY                                           *
+****************************************************************************/
+
+/* TransparencyPass: draws the translucent packets of the render queue
+* (those with RASTER_TRANSLUCENT) without sorting them by depth, see
+* RenderQueue.h. The queue calls begin() before the first of them, after
+* all opaque packets, and end() after the last one. Both work on the
+* current render target, whose depth the translucent fragments are tested
+* against without writing it.
+* OIT_WEIGHTED is weighted blended order-independent transparency (McGuire
+* and Bavoil): the fragments are summed into an accumulation target and a
+* revealage target of this pass, with a blend function of their own each
+* (glBlendFunci, GL 4.0), and end() composites the weighted average over
+* the target (shaders/oit_weighted.fs.glsl). It is an approximation, which
+* holds up well for a few layers of similar opacity.
+* OIT_LIST keeps every fragment instead, in a linked list per pixel built
+* with image atomics (GL_ARB_shader_image_load_store): a head image with
+* the last node of each pixel, a node pool of OIT_LIST_NODES_PER_PIXEL nodes
+* per pixel on average, and a counter handing them out. end() sorts the
+* lists and blends them front to back (shaders/oit_list.fs.glsl); this is
+* exact up to the size of the pool, at the price of the memory traffic.
+* The translucent shaders write whatever the mode wants, see
+* shaders/oit.glsl, so each mode has a program variant of its own. */
+#define OIT_VS "shaders/raymarch.vs.glsl"
+#define OIT_WEIGHTED_FS "shaders/oit_weighted.fs.glsl"
+#define OIT_LIST_FS "shaders/oit_list.fs.glsl"
+#define OIT_ACCUM_UNIT 11	/* the targets of the weighted mode while compositing */
+#define OIT_REVEALAGE_UNIT 12
+#define OIT_LIST_NODES_PER_PIXEL 4
+#define OIT_LIST_END 0xffffffffu	/* also in shaders/oit_list.fs.glsl */
+
+enum {
+	OIT_WEIGHTED = 0,
+	OIT_LIST,
+	OIT_MODES
+};
+static const char *oitModeNames[OIT_MODES] = {"weighted blended", "per-pixel lists"};
+
+typedef struct TransparencyPass {
+	int mode;		/* OIT_* */
+	RenderTarget *target;	/* drawn into, NULL if the translucent packets are skipped */
+	GLuint weightedProgram, listProgram;	/* 0 if the mode is not available */
+	GLuint vao;		/* empty, for the full-screen triangle */
+	GLsizei width, height, samples;	/* of the buffers below */
+
+	/* OIT_WEIGHTED */
+	GLuint fbo;		/* accum and revealage, with depth */
+	GLuint accum;		/* GL_RGBA16F, the weighted sums */
+	GLuint revealage;	/* GL_R16F, the product of the transparencies */
+	GLuint depth;		/* renderbuffer, a copy of the target's if multisampled, 0 otherwise */
+
+	/* OIT_LIST */
+	GLuint heads;		/* GL_R32UI, the first node of each pixel */
+	GLuint headsFbo;	/* for clearing heads */
+	GLuint nodeBuffer, nodes;	/* GL_RGBA32UI buffer texture */
+	GLuint counterBuffer, counter;	/* GL_R32UI buffer texture */
+	GLuint maxNodes;
+
+	void clear()
+	{
+		mode = OIT_WEIGHTED;
+		target = NULL;
+		weightedProgram = listProgram = vao = 0;
+		width = height = 0;
+		samples = 1;
+		fbo = accum = revealage = depth = 0;
+		heads = headsFbo = nodeBuffer = nodes = counterBuffer = counter = 0;
+		maxNodes = 0;
+	}
+
+	/* Build the programs of the modes which are supported, sources are
+	* loaded via cache. Returns true if at least one is. */
+	bool init(ShaderSourceCache *cache)
+	{
+		clear();
+		if (glBlendFunci)
+			weightedProgram = programBuild(cache, OIT_VS, OIT_WEIGHTED_FS);
+		if (glBindImageTexture && glTexBuffer)
+			listProgram = programBuild(cache, OIT_VS, OIT_LIST_FS);
+		if (!weightedProgram && !listProgram)
+			return false;
+		if (weightedProgram) {
+			glState()->useProgram(weightedProgram);
+			glUniform1i(glGetUniformLocation(weightedProgram, "oitAccum"), OIT_ACCUM_UNIT);
+			glUniform1i(glGetUniformLocation(weightedProgram, "oitRevealage"), OIT_REVEALAGE_UNIT);
+			glState()->useProgram(0);
+		} else {
+			mode = OIT_LIST;
+		}
+		glGenVertexArrays(1, &vao);
+		info("order-independent transparency: weighted program %u, list program %u",
+			weightedProgram, listProgram);
+		return true;
+	}
+
+	void destroyBuffers()
+	{
+		if (fbo)
+			glDeleteFramebuffers(1, &fbo);
+		if (headsFbo)
+			glDeleteFramebuffers(1, &headsFbo);
+		if (depth)
+			glDeleteRenderbuffers(1, &depth);
+		GLuint textures[5] = { accum, revealage, heads, nodes, counter };
+		glState()->deleteTextures(5, textures);
+		GLuint buffers[2] = { nodeBuffer, counterBuffer };
+		glState()->deleteBuffers(2, buffers);
+		fbo = accum = revealage = depth = 0;
+		heads = headsFbo = nodeBuffer = nodes = counterBuffer = counter = 0;
+		width = height = 0;
+		samples = 1;
+	}
+
+	void destroy()
+	{
+		destroyBuffers();
+		if (weightedProgram)
+			glState()->deleteProgram(weightedProgram);
+		if (listProgram)
+			glState()->deleteProgram(listProgram);
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		clear();
+	}
+
+	bool supported(int m) const
+	{
+		return (m == OIT_WEIGHTED) ? weightedProgram != 0 : (m == OIT_LIST && listProgram != 0);
+	}
+
+	/* Switch to mode m. Returns false if it is not supported. */
+	bool setMode(int m)
+	{
+		if (!supported(m))
+			return false;
+		if (m != mode)
+			destroyBuffers();
+		mode = m;
+		return true;
+	}
+
+	static GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type, GLsizei w, GLsizei h)
+	{
+		GLuint tex;
+		MemoryScope scope(MEMORY_TARGETS);
+		glGenTextures(1, &tex);
+		glState()->bindTexture(GL_TEXTURE_2D, tex);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		return tex;
+	}
+
+	static GLuint createBufferTexture(GLenum internalFormat, GLuint buffer)
+	{
+		GLuint tex;
+		glGenTextures(1, &tex);
+		glState()->bindTexture(GL_TEXTURE_BUFFER, tex);
+		glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+		glState()->bindTexture(GL_TEXTURE_BUFFER, 0);
+		return tex;
+	}
+
+	/* (Re-)allocate the buffers of the current mode for the target.
+	* Returns true if successfull and false in case of an error. */
+	bool resize()
+	{
+		MemoryScope scope(MEMORY_TARGETS);
+		if (target->width == width && target->height == height && target->samples == samples &&
+			(fbo || headsFbo))
+			return true;
+		destroyBuffers();
+		width = target->width;
+		height = target->height;
+		samples = target->samples;
+
+		if (mode == OIT_WEIGHTED) {
+			static const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+			accum = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height);
+			revealage = createTexture(GL_R16F, GL_RED, GL_FLOAT, width, height);
+			glGenFramebuffers(1, &fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accum, 0);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, revealage, 0);
+			glDrawBuffers(2, drawBuffers);
+			/* the attachments must agree in their samples, so the depth
+			* of a multisampled target is copied into one of ours */
+			if (samples > 1) {
+				glGenRenderbuffers(1, &depth);
+				glBindRenderbuffer(GL_RENDERBUFFER, depth);
+				glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+				glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			}
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+				depth ? depth : target->depth);
+			if (!RenderTarget::checkComplete(fbo))
+				return false;
+		} else {
+			GLint maxTexels = 0;
+			GLuint init[2];
+			glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+			maxNodes = (GLuint)width * (GLuint)height * OIT_LIST_NODES_PER_PIXEL;
+			if (maxTexels > 0 && maxNodes > (GLuint)maxTexels)
+				maxNodes = (GLuint)maxTexels;
+
+			heads = createTexture(GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, width, height);
+			glGenFramebuffers(1, &headsFbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, headsFbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, heads, 0);
+			if (!RenderTarget::checkComplete(headsFbo))
+				return false;
+
+			glGenBuffers(1, &nodeBuffer);
+			glState()->bindBuffer(GL_TEXTURE_BUFFER, nodeBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)maxNodes * 4 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+			/* the counter, and the size of the pool the shaders check it against */
+			init[0] = 0;
+			init[1] = maxNodes;
+			glGenBuffers(1, &counterBuffer);
+			glState()->bindBuffer(GL_TEXTURE_BUFFER, counterBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, sizeof(init), init, GL_DYNAMIC_DRAW);
+			glState()->bindBuffer(GL_TEXTURE_BUFFER, 0);
+			nodes = createBufferTexture(GL_RGBA32UI, nodeBuffer);
+			counter = createBufferTexture(GL_R32UI, counterBuffer);
+			info("OIT lists: %u nodes for %dx%d pixels", maxNodes, (int)width, (int)height);
+		}
+		target->bind();
+		return true;
+	}
+
+	/* Prepare drawing the translucent packets into the target: clear the
+	* buffers of the mode and set up the blending or the images the
+	* shaders write. Returns false if they can not be drawn. */
+	bool begin()
+	{
+		static const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		static const GLfloat one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		static const GLuint end[4] = { OIT_LIST_END, 0, 0, 0 };
+		static const GLuint reset = 0;
+
+		if (!target || !supported(mode))
+			return false;
+		if (!resize()) {
+			destroyBuffers();
+			target->bind();
+			return false;
+		}
+		if (mode == OIT_WEIGHTED) {
+			if (depth) {
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, target->fbo);
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+				glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+			}
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+			glState()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glClearBufferfv(GL_COLOR, 0, zero);
+			glClearBufferfv(GL_COLOR, 1, one);
+			/* the sums just add up, the revealage multiplies by 1 - alpha */
+			glState()->enable(GL_BLEND);
+			glState()->blendFunci(0, GL_ONE, GL_ONE);
+			glState()->blendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+		} else {
+			glBindFramebuffer(GL_FRAMEBUFFER, headsFbo);
+			glState()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glClearBufferuiv(GL_COLOR, 0, end);
+			target->bind();
+			glState()->bindBuffer(GL_TEXTURE_BUFFER, counterBuffer);
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(reset), &reset);
+			glState()->bindBuffer(GL_TEXTURE_BUFFER, 0);
+			glBindImageTexture(OIT_HEADS_IMAGE_UNIT, heads, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+			glBindImageTexture(OIT_NODES_IMAGE_UNIT, nodes, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32UI);
+			glBindImageTexture(OIT_COUNTER_IMAGE_UNIT, counter, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+			/* the fragments only go into the lists */
+			glState()->disable(GL_BLEND);
+			glState()->colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		}
+		return true;
+	}
+
+	/* Composite the translucent fragments over the target, which is the
+	* current framebuffer afterwards. This changes the program, the VAO
+	* and the blending. */
+	void end()
+	{
+		GL_DEBUG_GROUP("transparency resolve");
+		if (mode == OIT_WEIGHTED) {
+			target->bind();
+			glState()->useProgram(weightedProgram);
+			glState()->activeTexture(GL_TEXTURE0 + OIT_ACCUM_UNIT);
+			glState()->bindTexture(GL_TEXTURE_2D, accum);
+			glState()->activeTexture(GL_TEXTURE0 + OIT_REVEALAGE_UNIT);
+			glState()->bindTexture(GL_TEXTURE_2D, revealage);
+			glState()->activeTexture(GL_TEXTURE0);
+			glState()->blendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+		} else {
+			/* the lists are complete */
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			glState()->colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glState()->useProgram(listProgram);
+			glState()->enable(GL_BLEND);
+			glState()->blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		/* the full-screen triangle covers the target whatever its depth */
+		glState()->disable(GL_DEPTH_TEST);
+		glState()->depthMask(GL_FALSE);
+		glState()->bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glState()->countDraw();
+		glState()->enable(GL_DEPTH_TEST);
+		GL_ERROR_DBG("transparency composite");
+	}
+
+	/* The RenderPhaseFuncs of the queue, object is the TransparencyPass. */
+	static bool queueBegin(void *object)
+	{
+		return ((TransparencyPass*)object)->begin();
+	}
+
+	static void queueEnd(void *object)
+	{
+		((TransparencyPass*)object)->end();
+	}
+} TransparencyPass;
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef HEADER_UNIFORMSPECIALIZER_H
+#define HEADER_UNIFORMSPECIALIZER_H
+
+#include <glad/glad.h>
+#include <math.h>
+#include <string.h>
+#include "Log.h"
+#include "ProgramRegistry.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* UNIFORM SPECIALIZER: programs with the constant values baked in          *
+****************************************************************************/
+
+/* UniformSpecializer: many of the per-frame values stay the same for
+* minutes, like the projection as long as the window keeps its size, or the
+* radius the CUT programs cut out of the cube, but every shader still loads
+* them from the Frame block and takes the branches which depend on them.
+* The specializer is shown the hot values each frame (observe), and once a
+* value has not changed for a number of frames, it builds the program in
+* use again in the background, with that value as a constant: the line
+* "#define HOT_<name> <value>" after the defines of the permutation, which
+* shaders/frame.glsl puts in place of the member of the block, so the
+* compiler folds it into the code. The build goes through programBuildStart
+* and programBuildPoll like those of the registry, with the same cache, and
+* when it is done, the specialized program is swapped in for the generic
+* one (see RenderQueue::specialize). A program with a depth pre-pass gets a
+* specialized pre-pass with the same constants, so both compute the same
+* depth. Values which become hot later are added by another build.
+* As soon as a baked value changes, the specialized program is dropped and
+* the generic one is drawn with again in the same frame; the values which
+* are still hot are built into the next specialization.
+* Only the main pass is specialized, the shadows draw with blocks of their
+* own. Not in separable mode, where a specialized stage would need a
+* pipeline of its own, and not from SPIR-V modules. */
+#define UNIFORM_SPECIALIZER_MAX 8	/* hot values */
+#define UNIFORM_SPECIALIZER_FRAMES 120	/* default frames a value must stay the same */
+#define UNIFORM_SPECIALIZER_TEXT 1536	/* of the defines of the constants */
+
+typedef struct {
+	const char *name;	/* the member of the Frame block, HOT_<name> in the shaders */
+	GLenum type;		/* GL_FLOAT, GL_UNSIGNED_INT or GL_FLOAT_MAT4 */
+	int components;
+	GLfloat value[16];	/* the last value, ints are stored bitwise */
+	unsigned int stable;	/* frames it has not changed for */
+} HotUniform;
+
+typedef struct UniformSpecializer {
+	bool enabled;
+	unsigned int frames;	/* a value is hot after that many frames unchanged */
+	HotUniform uniforms[UNIFORM_SPECIALIZER_MAX];
+	int count;
+	int entry, variant;	/* the registry entry and variant of generic */
+	int prepassEntry;	/* of genericPrepass, -1 for none */
+	GLuint generic, genericPrepass;	/* the programs to specialize */
+	ProgramBuild build[2];	/* of the program and its pre-pass, in flight */
+	unsigned int buildMask;	/* the values baked into build, 0 if none is in flight */
+	unsigned int failedMask;	/* of the last build which failed, not tried again */
+	GLuint program, prepass;	/* the specialization, 0 for none */
+	unsigned int mask;	/* the values baked into program */
+	unsigned int builds;	/* specializations swapped in */
+	unsigned int flips;	/* and dropped for a changed value */
+	char text[UNIFORM_SPECIALIZER_TEXT];
+
+	void clear()
+	{
+		enabled = false;
+		frames = UNIFORM_SPECIALIZER_FRAMES;
+		count = 0;
+		entry = variant = prepassEntry = -1;
+		generic = genericPrepass = 0;
+		memset(build, 0, sizeof(build));
+		buildMask = failedMask = 0;
+		program = prepass = 0;
+		mask = 0;
+		builds = flips = 0;
+		text[0] = 0;
+	}
+
+	/* Add the hot value name of type, GL_FLOAT, GL_UNSIGNED_INT or
+	* GL_FLOAT_MAT4. Returns its index for observe, -1 if there are too
+	* many. */
+	int add(const char *name, GLenum type)
+	{
+		if (count >= UNIFORM_SPECIALIZER_MAX) {
+			warn("uniform specializer: more than %d values", UNIFORM_SPECIALIZER_MAX);
+			return -1;
+		}
+		HotUniform *u = &uniforms[count];
+		u->name = name;
+		u->type = type;
+		u->components = (type == GL_FLOAT_MAT4) ? 16 : 1;
+		memset(u->value, 0, sizeof(u->value));
+		u->stable = 0;
+		return count++;
+	}
+
+	void destroy()
+	{
+		cancel();
+		drop();
+		clear();
+	}
+
+	/* Abort the build in flight. */
+	void cancel()
+	{
+		programBuildCancel(&build[0]);
+		programBuildCancel(&build[1]);
+		buildMask = 0;
+	}
+
+	/* Go back to the generic programs. */
+	void drop()
+	{
+		if (program)
+			glState()->deleteProgram(program);
+		if (prepass)
+			glState()->deleteProgram(prepass);
+		program = prepass = 0;
+		mask = 0;
+	}
+
+	/* Specialize the program generic of registry entry and variant from
+	* now on, with genericPrepass of prepassEntry, which may be -1 and 0.
+	* Anything built for other programs is dropped. */
+	void select(int e, int v, int pe, GLuint g, GLuint gp)
+	{
+		if (g == generic && gp == genericPrepass && e == entry && v == variant && pe == prepassEntry)
+			return;
+		cancel();
+		drop();
+		entry = e;
+		variant = v;
+		prepassEntry = gp ? pe : -1;
+		generic = g;
+		genericPrepass = gp;
+		failedMask = 0;
+	}
+
+	/* Show this frame's value of the hot value index, of the size of its
+	* type. A change to a value which is baked in drops the specialization
+	* right away. */
+	void observe(int index, const void *data)
+	{
+		if (index < 0)
+			return;
+		HotUniform *u = &uniforms[index];
+		size_t size = u->components * sizeof(GLfloat);
+		if (!memcmp(u->value, data, size)) {
+			if (u->stable < frames)
+				u->stable++;
+			return;
+		}
+		memcpy(u->value, data, size);
+		u->stable = 0;
+		if (buildMask & (1u << index))
+			cancel();
+		if (mask & (1u << index)) {
+			drop();
+			flips++;
+		}
+	}
+
+	/* Advance the build in flight and swap its programs in once they are
+	* linked, or start a build if values became hot which the current
+	* specialization lacks. Call this once per frame, after observe. */
+	void update(ProgramRegistry *registry)
+	{
+		int i;
+
+		if (!enabled || !generic || registry->separable || entry < 0)
+			return;
+		if (buildMask) {
+			bool done = programBuildPoll(&build[0]);
+			if (prepassEntry >= 0)
+				done = programBuildPoll(&build[1]) && done;
+			if (!done)
+				return;
+			if (build[0].state != PROGRAM_BUILD_DONE ||
+				(prepassEntry >= 0 && build[1].state != PROGRAM_BUILD_DONE)) {
+				warn("uniform specializer: the build of program %u with 0x%x baked in failed", generic, buildMask);
+				failedMask = buildMask;
+				cancel();
+				return;
+			}
+			drop();
+			program = build[0].program;
+			prepass = (prepassEntry >= 0) ? build[1].program : 0;
+			mask = buildMask;
+			memset(build, 0, sizeof(build));
+			buildMask = 0;
+			builds++;
+			info("uniform specializer: program %u in place of %u, with 0x%x baked in", program, generic, mask);
+			return;
+		}
+
+		unsigned int hot = 0;
+		for (i = 0; i < count; i++)
+			if (uniforms[i].stable >= frames && constant(&uniforms[i]))
+				hot |= 1u << i;
+		if (!(hot & ~mask) || hot == failedMask)
+			return;
+		if (!format(hot)) {
+			failedMask = hot;
+			return;
+		}
+		const ProgramEntry *e = &registry->entries[entry];
+		bool started = programBuildStart(&build[0], &registry->sources, e->vs[variant], e->fs,
+			registry->defineNames, registry->defineCount, e->defines[variant], false, text);
+		if (started && prepassEntry >= 0) {
+			const ProgramEntry *pe = &registry->entries[prepassEntry];
+			started = programBuildStart(&build[1], &registry->sources, pe->vs[variant], pe->fs,
+				registry->defineNames, registry->defineCount, pe->defines[variant], false, text);
+		}
+		buildMask = hot;
+		if (!started) {
+			failedMask = hot;
+			cancel();
+		}
+	}
+
+	/* Returns true if the value of u can be written as a GLSL constant. */
+	static bool constant(const HotUniform *u)
+	{
+		int i;
+		for (i = 0; u->type != GL_UNSIGNED_INT && i < u->components; i++)
+			if (u->value[i] != u->value[i] || fabsf(u->value[i]) > 3.4e38f)
+				return false;
+		return true;
+	}
+
+	/* Write the defines of the values in bits into text; floats with 9
+	* digits, which gives back the same float.
+	* Returns false if they do not fit. */
+	bool format(unsigned int bits)
+	{
+		size_t len = 0;
+		int i, j, n;
+
+		for (i = 0; i < count; i++) {
+			if (!(bits & (1u << i)))
+				continue;
+			const HotUniform *u = &uniforms[i];
+			if (u->type == GL_UNSIGNED_INT) {
+				GLuint v;
+				memcpy(&v, u->value, sizeof(v));
+				n = mysnprintf(text + len, sizeof(text) - len, "#define HOT_%s %uu\n", u->name, v);
+			} else if (u->type == GL_FLOAT) {
+				n = mysnprintf(text + len, sizeof(text) - len, "#define HOT_%s float(%.9g)\n", u->name,
+					u->value[0]);
+			} else {
+				n = mysnprintf(text + len, sizeof(text) - len, "#define HOT_%s mat4(", u->name);
+				for (j = 0; j < 16 && n >= 0 && (size_t)n < sizeof(text) - len; j++) {
+					len += (size_t)n;
+					n = mysnprintf(text + len, sizeof(text) - len, "%.9g%s", u->value[j], j < 15 ? ", " : ")\n");
+				}
+			}
+			if (n < 0 || (size_t)n >= sizeof(text) - len) {
+				warn("uniform specializer: the values 0x%x do not fit into %d bytes", bits,
+					UNIFORM_SPECIALIZER_TEXT);
+				return false;
+			}
+			len += (size_t)n;
+		}
+		return true;
+	}
+} UniformSpecializer;
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef HEADER_UNPACKRING_H
+#define HEADER_UNPACKRING_H
+
+#include <glad/glad.h>
+#include <string.h>
+#include "GLCaps.h"
+#include "GLState.h"
+#include "Log.h"
+#include "MemoryStats.h"
+#include "Profiler.h"
+
+/****************************************************************************
+* UNPACK RING: texel uploads which never wait for the driver's copy        *
+****************************************************************************/
+
+/* UnpackRing: glTexSubImage2D from client memory copies the texels before
+* it returns, so the thread which uploads waits for the driver, and with
+* it everything behind it. With a buffer bound to GL_PIXEL_UNPACK_BUFFER,
+* the pointer of the upload is an offset into that buffer instead, and the
+* GPU copies the texels from there once it gets to the command.
+* The ring is such a buffer, mapped once (persistent and coherent), so the
+* texels are decoded, generated or read right into it: alloc() hands out a
+* range and its offset, the upload goes behind it, and fence() places a
+* fence behind the uploads of the ranges handed out since the last one.
+* Unlike the RingBuffer, the ranges are not tied to frames: they are taken
+* in order, of any size up to that of the ring, and are free again once
+* their fence is signaled; the fences are polled by alloc(), which only
+* waits for the oldest ones if the ring is full, counted as a stall.
+* It needs buffer storage; without it, init() fails and the uploads read
+* from client memory as before. It is used by one thread, whose context
+* made it. */
+#define UNPACK_RING_SPANS 256	/* ranges not known to be done yet */
+
+/* a range handed out by alloc() */
+typedef struct {
+	GLsizeiptr start;
+	GLsync fence;		/* 0 until fence() */
+} UnpackSpan;
+
+typedef struct {
+	GLuint buffer;
+	GLubyte *mapped;
+	GLsizeiptr size;
+	GLsizeiptr head;	/* the next byte to hand out */
+	UnpackSpan spans[UNPACK_RING_SPANS];	/* oldest first, from first on, wrapping */
+	int first, count;
+	unsigned int uploads;	/* ranges handed out */
+	unsigned long long bytes;	/* in them */
+	unsigned int stalls;	/* times alloc() had to wait for the GPU */
+
+	void clear()
+	{
+		buffer = 0;
+		mapped = NULL;
+		size = head = 0;
+		first = count = 0;
+		uploads = 0;
+		bytes = 0;
+		stalls = 0;
+	}
+
+	/* Create the ring of capacity bytes, labeled label for GL debuggers.
+	* Returns true if successfull and false if it is not supported. */
+	bool init(GLsizeiptr capacity, const char *label = "unpack ring")
+	{
+		MemoryScope scope(MEMORY_STAGING);
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		clear();
+		if (!glCaps()->bufferStorage)
+			return false;
+		glGenBuffers(1, &buffer);
+		glState()->bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, NULL, flags);
+		mapped = (GLubyte*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, flags);
+		glState()->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDebugLabel(GL_BUFFER, buffer, "%s", label);
+		if (!mapped) {
+			warn("UnpackRing: failed to map buffer %u persistently", buffer);
+			destroy();
+			return false;
+		}
+		size = capacity;
+		info("UnpackRing: buffer %u with %u KB", buffer, (unsigned)(size >> 10));
+		GL_ERROR_DBG("unpack ring initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < count; i++) {
+			GLsync f = spans[(first + i) % UNPACK_RING_SPANS].fence;
+			if (f)
+				glDeleteSync(f);
+		}
+		if (buffer) {
+			if (mapped) {
+				glState()->bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				glState()->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+			info("UnpackRing: %u uploads, %.1f MB, %u stalls", uploads, (double)bytes / 1048576.0, stalls);
+			glState()->deleteBuffers(1, &buffer);
+		}
+		clear();
+	}
+
+	/* Free the oldest range, waiting for its fence if wait is set.
+	* Returns false if it is still in use. */
+	bool retire(bool wait)
+	{
+		UnpackSpan *s = &spans[first];
+		if (!s->fence)
+			fence();
+		GLenum res = glClientWaitSync(s->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+			wait ? GL_TIMEOUT_IGNORED : 0);
+		if (res == GL_TIMEOUT_EXPIRED)
+			return false;
+		if (res == GL_WAIT_FAILED)
+			warn("UnpackRing: waiting for an upload failed");
+		glDeleteSync(s->fence);
+		first = (first + 1) % UNPACK_RING_SPANS;
+		count--;
+		return true;
+	}
+
+	/* Get n bytes of the ring, aligned to alignment bytes, for the texels
+	* of an upload, and their offset in the buffer, which the upload takes
+	* as its pointer with the buffer bound (see bind). Waits for the GPU if
+	* the ring is full.
+	* Returns NULL if n is larger than the ring. */
+	void *alloc(GLsizeiptr n, GLsizeiptr alignment, GLintptr *offset)
+	{
+		GLsizeiptr start;
+
+		if (n <= 0 || n > size)
+			return NULL;
+		while (count && retire(false))
+			;
+		for (;;) {
+			if (!count) {
+				start = 0;
+				break;
+			}
+			start = (head + alignment - 1) / alignment * alignment;
+			GLsizeiptr tail = spans[first].start;
+			if (count < UNPACK_RING_SPANS) {
+				if (head > tail) {
+					/* the ranges in use are [tail, head), the rest
+					* is free up to the end and from the start */
+					if (start + n <= size)
+						break;
+					if (n <= tail) {
+						start = 0;
+						break;
+					}
+				} else if (start + n <= tail) {
+					break;
+				}
+			}
+			PROFILE_ZONE("unpack ring stall");
+			stalls++;
+			retire(true);
+		}
+		UnpackSpan *s = &spans[(first + count) % UNPACK_RING_SPANS];
+		s->start = start;
+		s->fence = 0;
+		count++;
+		head = start + n;
+		uploads++;
+		bytes += (unsigned long long)n;
+		*offset = (GLintptr)start;
+		return mapped + start;
+	}
+
+	/* Place a fence behind the uploads from the ranges handed out since
+	* the last one; they are free once it is signaled. */
+	void fence()
+	{
+		int i;
+		for (i = count - 1; i >= 0; i--) {
+			UnpackSpan *s = &spans[(first + i) % UNPACK_RING_SPANS];
+			if (s->fence)
+				break;
+			s->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+	}
+
+	/* Bind the ring for the uploads, or unbind it. */
+	void bind(bool enable)
+	{
+		glState()->bindBuffer(GL_PIXEL_UNPACK_BUFFER, enable ? buffer : 0);
+	}
+} UnpackRing;
+
+#endif
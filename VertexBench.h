@@ -0,0 +1,350 @@
+#ifndef HEADER_VERTEXBENCH_H
+#define HEADER_VERTEXBENCH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glad/glad.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Cube.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "Log.h"
+#include "PerfCounters.h"
+#include "ShaderHelpers.h"
+
+/****************************************************************************
+* VERTEX FORMAT BENCHMARK                                                  *
+****************************************************************************/
+
+/* For the --bench-vertex mode: a grid of about n vertices, in triangles
+* smaller than a pixel so that fetching and shading the vertices is what
+* takes the time, drawn from the same positions and colors in each layout:
+* - float: Vertex of Cube.h as it is, 16 bytes,
+* - float-padded: the same, padded to 32 bytes,
+* - packed: PackedVertex of Cube.h, with a normal and texture coordinates,
+*   20 bytes,
+* - half: the position as four half floats and RGBA8, 12 bytes,
+* - 10_10_10_2: the position as signed normalized GL_INT_2_10_10_10_REV and
+*   RGBA8, 8 bytes, which rounds the grid to 1/511 but fetches the same,
+* - split: the float positions and the colors in two buffers, 12 + 4 bytes,
+* - pulled: Vertex from a storage block by gl_VertexID, no attributes.
+* Each is drawn VERTEX_BENCH_FRAMES times after a frame of warm-up, with one
+* glDrawElements of 32 bit indices per frame and GPU timestamps around it.
+* The bandwidth is the size of the vertices over that time, what the
+* attribute fetch reads at least; with --perf-counters, the counters of
+* PerfCounters.h are sampled per layout as well, e.g. the memory traffic
+* where the driver has it. The layouts the context cannot read are left
+* out. */
+#define VERTEX_BENCH_VS "shaders/vertex_bench.vs.glsl"
+#define VERTEX_BENCH_FS "shaders/overlay.fs.glsl"
+#define VERTEX_BENCH_FRAMES 20
+
+/* the layouts which are not in vertexLayouts */
+static const VertexLayout vertexBenchPadded = { "float-padded", 32, 2, {
+	{ VERTEX_ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, 0 },
+	{ VERTEX_ATTRIB_CLR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 12 } } };
+static const VertexLayout vertexBenchHalf = { "half", 12, 2, {
+	{ VERTEX_ATTRIB_POS, 4, GL_HALF_FLOAT, GL_FALSE, 0 },
+	{ VERTEX_ATTRIB_CLR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 8 } } };
+static const VertexLayout vertexBench1010102 = { "10_10_10_2", 8, 2, {
+	{ VERTEX_ATTRIB_POS, 4, GL_INT_2_10_10_10_REV, GL_TRUE, 0 },
+	{ VERTEX_ATTRIB_CLR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 4 } } };
+static const VertexLayout vertexBenchPositions = { "split positions", 12, 1, {
+	{ VERTEX_ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, 0 } } };
+static const VertexLayout vertexBenchColors = { "split colors", 4, 1, {
+	{ VERTEX_ATTRIB_CLR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0 } } };
+
+#define VERTEX_BENCH_STREAMS 2
+
+/* a layout of the benchmark: its streams, each in a buffer of its own,
+* or pulled from the first */
+typedef struct {
+	const char *name;
+	const VertexLayout *streams[VERTEX_BENCH_STREAMS];
+	int streamCount;
+	bool pulled;
+} VertexBenchLayout;
+
+#define VERTEX_BENCH_LAYOUTS 7
+static const VertexBenchLayout vertexBenchLayouts[VERTEX_BENCH_LAYOUTS] = {
+	{ "float", { &vertexLayouts[VERTEX_FORMAT_FLOAT], NULL }, 1, false },
+	{ "float-padded", { &vertexBenchPadded, NULL }, 1, false },
+	{ "packed", { &vertexLayouts[VERTEX_FORMAT_PACKED], NULL }, 1, false },
+	{ "half", { &vertexBenchHalf, NULL }, 1, false },
+	{ "10_10_10_2", { &vertexBench1010102, NULL }, 1, false },
+	{ "split", { &vertexBenchPositions, &vertexBenchColors }, 2, false },
+	{ "pulled", { &vertexLayouts[VERTEX_FORMAT_FLOAT], NULL }, 1, true }
+};
+
+/* Store the attribute a of the vertex at pos with normal n, texture
+* coordinates uv and color clr at dst. */
+static void vertexBenchWrite(const VertexAttribDesc *a, const glm::vec3 &pos, const glm::vec3 &n,
+	const glm::vec2 &uv, const GLubyte *clr, unsigned char *dst)
+{
+	if (a->location == VERTEX_ATTRIB_CLR) {
+		memcpy(dst, clr, 4);
+	} else if (a->type == GL_FLOAT) {
+		memcpy(dst, &pos[0], sizeof(GLfloat) * 3);
+	} else if (a->type == GL_HALF_FLOAT && a->size == 4) {
+		glm::uint64 half = glm::packHalf4x16(glm::vec4(pos, 1.0f));
+		memcpy(dst, &half, sizeof(half));
+	} else if (a->type == GL_HALF_FLOAT) {
+		GLuint half = glm::packHalf2x16(uv);
+		memcpy(dst, &half, sizeof(half));
+	} else if (a->type == GL_INT_2_10_10_10_REV) {
+		GLuint packed = (a->location == VERTEX_ATTRIB_NRM) ? glm::packSnorm3x10_1x2(glm::vec4(n, 0.0f)) :
+			glm::packSnorm3x10_1x2(glm::vec4(pos, 1.0f));
+		memcpy(dst, &packed, sizeof(packed));
+	}
+}
+
+typedef struct {
+	GLuint program, pulledProgram;	/* 0 if it failed to build */
+	GLuint indexBuffer;
+	GLsizei side;		/* vertices per row and column of the grid */
+	GLsizei vertexCount, indexCount;
+	GLuint vaos[VERTEX_BENCH_LAYOUTS];	/* 0 for the layouts the context cannot read */
+	GLuint buffers[VERTEX_BENCH_LAYOUTS][VERTEX_BENCH_STREAMS];
+	GLuint queries[2];
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	/* Build the programs from cache and make up the grid of about n
+	* vertices in every layout.
+	* Returns true if successfull and false in case of an error. */
+	bool init(ShaderSourceCache *cache, GLsizei n)
+	{
+		static const char *const defines[] = { "PULLED" };
+		GLsizei x, y, i;
+		int l, s, k;
+
+		clear();
+		program = programBuild(cache, VERTEX_BENCH_VS, VERTEX_BENCH_FS);
+		if (glCaps()->storageBuffers) {
+			pulledProgram = programBuild(cache, VERTEX_BENCH_VS, VERTEX_BENCH_FS, defines, 1, 1u);
+			GLuint block = pulledProgram ?
+				glGetProgramResourceIndex(pulledProgram, GL_SHADER_STORAGE_BLOCK, "BenchVertices") : GL_INVALID_INDEX;
+			if (block != GL_INVALID_INDEX)
+				glShaderStorageBlockBinding(pulledProgram, block, 0);
+		}
+		side = glm::max((GLsizei)sqrt((double)n), (GLsizei)2);
+		vertexCount = side * side;
+		indexCount = 6 * (side - 1) * (side - 1);
+		if (!program) {
+			warn("vertex benchmark: failed to build the program");
+			return false;
+		}
+
+		/* a gently curved grid, whose triangles all face the camera */
+		Vertex *vertices = (Vertex*)malloc(sizeof(Vertex) * vertexCount);
+		GLuint *indices = (GLuint*)malloc(sizeof(GLuint) * indexCount);
+		unsigned char *data = (unsigned char*)malloc((size_t)32 * vertexCount);
+		if (!vertices || !indices || !data) {
+			warn("vertex benchmark: failed to allocate %d vertices", (int)vertexCount);
+			free(vertices);
+			free(indices);
+			free(data);
+			return false;
+		}
+		for (y = 0; y < side; y++)
+			for (x = 0; x < side; x++) {
+				Vertex *v = &vertices[y * side + x];
+				float u = (float)x / (float)(side - 1), w = (float)y / (float)(side - 1);
+				v->pos[0] = 2.0f * u - 1.0f;
+				v->pos[1] = 2.0f * w - 1.0f;
+				v->pos[2] = 0.25f * sinf(6.0f * u) * cosf(6.0f * w);
+				v->clr[0] = (GLubyte)(255.0f * u);
+				v->clr[1] = (GLubyte)(255.0f * w);
+				v->clr[2] = 128;
+				v->clr[3] = 255;
+			}
+		for (y = 0, i = 0; y + 1 < side; y++)
+			for (x = 0; x + 1 < side; x++) {
+				GLuint a = (GLuint)(y * side + x), b = a + 1, c = a + (GLuint)side, d = c + 1;
+				indices[i++] = a;
+				indices[i++] = b;
+				indices[i++] = d;
+				indices[i++] = a;
+				indices[i++] = d;
+				indices[i++] = c;
+			}
+		glGenBuffers(1, &indexBuffer);
+		glState()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indexCount, indices, GL_STATIC_DRAW);
+		glState()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		free(indices);
+
+		for (l = 0; l < VERTEX_BENCH_LAYOUTS; l++) {
+			const VertexBenchLayout *b = &vertexBenchLayouts[l];
+			bool packed = false;
+			for (s = 0; s < b->streamCount; s++)
+				for (k = 0; k < b->streams[s]->attribCount; k++)
+					packed = packed || b->streams[s]->attribs[k].type == GL_INT_2_10_10_10_REV;
+			if ((packed && !glCaps()->packedVertices) || (b->pulled && !pulledProgram)) {
+				info("vertex benchmark: layout %s is not supported", b->name);
+				continue;
+			}
+			glGenVertexArrays(1, &vaos[l]);
+			glState()->bindVertexArray(vaos[l]);
+			glDebugLabel(GL_VERTEX_ARRAY, vaos[l], "vertex benchmark %s", b->name);
+			glState()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+			for (s = 0; s < b->streamCount; s++) {
+				const VertexLayout *layout = b->streams[s];
+				memset(data, 0, (size_t)layout->stride * vertexCount);
+				for (i = 0; i < vertexCount; i++) {
+					const Vertex *v = &vertices[i];
+					glm::vec3 pos(v->pos[0], v->pos[1], v->pos[2]);
+					for (k = 0; k < layout->attribCount; k++)
+						vertexBenchWrite(&layout->attribs[k], pos, glm::vec3(0.0f, 0.0f, 1.0f),
+							glm::vec2(pos) * 0.5f + 0.5f, v->clr,
+							data + (size_t)i * layout->stride + layout->attribs[k].offset);
+				}
+				glGenBuffers(1, &buffers[l][s]);
+				glState()->bindBuffer(GL_ARRAY_BUFFER, buffers[l][s]);
+				glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)layout->stride * vertexCount, data, GL_STATIC_DRAW);
+				if (b->pulled)
+					continue;
+				for (k = 0; k < layout->attribCount; k++) {
+					const VertexAttribDesc *a = &layout->attribs[k];
+					glVertexAttribPointer(a->location, a->size, a->type, a->normalized, layout->stride,
+						BUFFER_OFFSET(a->offset));
+					glEnableVertexAttribArray(a->location);
+				}
+			}
+		}
+		glState()->bindVertexArray(0);
+		glState()->bindBuffer(GL_ARRAY_BUFFER, 0);
+		free(vertices);
+		free(data);
+		glGenQueries(2, queries);
+		GL_ERROR_DBG("vertex benchmark initialization");
+		return true;
+	}
+
+	void destroy()
+	{
+		int l;
+		if (program)
+			glState()->deleteProgram(program);
+		if (pulledProgram)
+			glState()->deleteProgram(pulledProgram);
+		for (l = 0; l < VERTEX_BENCH_LAYOUTS; l++) {
+			if (vaos[l])
+				glState()->deleteVertexArrays(1, &vaos[l]);
+			glState()->deleteBuffers(VERTEX_BENCH_STREAMS, buffers[l]);
+		}
+		if (indexBuffer)
+			glState()->deleteBuffers(1, &indexBuffer);
+		if (queries[0])
+			glDeleteQueries(2, queries);
+		clear();
+	}
+
+	/* The bytes of a vertex in layout l, over all of its streams. */
+	static GLsizei stride(int l)
+	{
+		const VertexBenchLayout *b = &vertexBenchLayouts[l];
+		GLsizei bytes = 0;
+		for (int s = 0; s < b->streamCount; s++)
+			bytes += b->streams[s]->stride;
+		return bytes;
+	}
+
+	/* Draw the grid in layout l VERTEX_BENCH_FRAMES times, after a frame
+	* of warm-up, sampling the counters as scope l.
+	* Returns the mean GPU time of a frame in ms. */
+	double measure(int l, PerfCounters *counters)
+	{
+		GLuint64 gpu = 0;
+		int f;
+
+		glState()->useProgram(vertexBenchLayouts[l].pulled ? pulledProgram : program);
+		glState()->bindVertexArray(vaos[l]);
+		if (vertexBenchLayouts[l].pulled)
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[l][0]);
+		for (f = 0; f <= VERTEX_BENCH_FRAMES; f++) {
+			GLuint64 begin, end;
+			counters->beginFrame();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glQueryCounter(queries[0], GL_TIMESTAMP);
+			if (f > 0)
+				counters->begin(l);
+			glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, BUFFER_OFFSET(0));
+			glState()->countDraw();
+			if (f > 0)
+				counters->end(l);
+			glQueryCounter(queries[1], GL_TIMESTAMP);
+			glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+			if (f > 0)
+				gpu += end - begin;
+		}
+		/* the counters of the last frames are ready by now */
+		glFinish();
+		for (f = 0; f < PERF_COUNTER_FRAMES; f++)
+			counters->beginFrame();
+		if (vertexBenchLayouts[l].pulled)
+			glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+		return 1.0e-6 * (double)gpu / VERTEX_BENCH_FRAMES;
+	}
+} VertexBench;
+
+/* For the --bench-vertex mode: draw a grid of about n vertices in every
+* layout into the current framebuffer of width x height pixels, sampling
+* the hardware counters of selection (see PerfCounters.h) if it is not
+* NULL, and write a CSV line per layout to out.
+* Returns true if successfull and false in case of an error. */
+static bool vertexBenchmark(ShaderSourceCache *cache, int n, int width, int height, const char *selection, FILE *out)
+{
+	VertexBench bench;
+	PerfCounters counters;
+	int l, k;
+
+	if (n < 4 || !bench.init(cache, (GLsizei)n)) {
+		bench.destroy();
+		return false;
+	}
+	counters.clear();
+	if (selection)
+		counters.init(selection, VERTEX_BENCH_LAYOUTS);
+	glState()->viewport(0, 0, width, height);
+	glState()->enable(GL_DEPTH_TEST);
+	glState()->depthFunc(GL_LESS);
+	glState()->depthMask(GL_TRUE);
+	glState()->disable(GL_CULL_FACE);
+	glState()->disable(GL_BLEND);
+
+	fprintf(out, "layout,stride,streams,vertices,triangles,gpu_ms,vertex_mb,gb_per_s");
+	for (k = 0; k < counters.count; k++)
+		fprintf(out, ",%s", counters.counters[k].name);
+	fprintf(out, "\n");
+	for (l = 0; l < VERTEX_BENCH_LAYOUTS; l++) {
+		if (!bench.vaos[l])
+			continue;
+		double ms = bench.measure(l, &counters);
+		double bytes = (double)VertexBench::stride(l) * (double)bench.vertexCount;
+		fprintf(out, "%s,%d,%d,%d,%d,%.4f,%.2f,%.2f", vertexBenchLayouts[l].name, (int)VertexBench::stride(l),
+			vertexBenchLayouts[l].streamCount, (int)bench.vertexCount, (int)(bench.indexCount / 3), ms,
+			bytes * 1.0e-6, ms > 0.0 ? bytes * 1.0e-6 / ms : 0.0);
+		for (k = 0; k < counters.count; k++) {
+			const PerfCounter *c = &counters.counters[k];
+			fprintf(out, counters.samples[l] ? ",%.6g" : ",", counters.samples[l] ? c->sum[l] / counters.samples[l] : 0.0);
+		}
+		fprintf(out, "\n");
+		fflush(out);
+	}
+	glState()->useProgram(0);
+	glState()->bindVertexArray(0);
+	GL_ERROR_DBG("vertex benchmark");
+	counters.destroy();
+	bench.destroy();
+	return true;
+}
+
+#endif
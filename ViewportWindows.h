@@ -0,0 +1,184 @@
+#ifndef HEADER_VIEWPORTWINDOWS_H
+#define HEADER_VIEWPORTWINDOWS_H
+
+#include <GLFW/glfw3.h>
+#include <glad/glad.h>
+#include <atomic>
+#include "Log.h"
+
+/****************************************************************************
+* VIEWPORT WINDOWS: more windows sharing the GL objects                    *
+****************************************************************************/
+
+/* ViewportSet: additional windows, e.g. one per screen of a video wall,
+* showing the frame rendered in the main window's context. Their contexts
+* share the objects of the main one, so the meshes, textures and programs
+* exist only once; the frame is rendered once into the offscreen target
+* and each window presents its column of it: with N windows, window i
+* shows the i-th of N vertical stripes, scaled to its framebuffer. The main
+* window keeps showing the whole frame, after the post-processing, which
+* the viewport windows do not get.
+* The windows are presented one after the other on the thread which draws
+* the frames (the render thread, if there is one), by making their context
+* current, blitting the shared color texture through a framebuffer of
+* their own (framebuffers are not shared between contexts) and swapping,
+* then switching back to the main context. Only plain GL calls are made in
+* the viewport contexts: the state cache of GLState.h stays valid for the
+* main context, whose bindings are untouched.
+* Each context has its own swap interval: by default only the main window
+* waits for the VBLANK, waiting in every swap would divide the frame rate
+* by the number of windows.
+* Resizing and closing a viewport window go through their own callbacks,
+* the keys are forwarded to the main window's callback. */
+#define VIEWPORT_WINDOWS_MAX 8
+
+struct ViewportSet;
+
+typedef struct {
+	GLFWwindow *win;
+	GLuint fbo;		/* in the context of win, reads the color texture */
+	std::atomic<int> width, height;	/* of the framebuffer, set by the size callback */
+	int swapInterval;
+	int column;		/* of the frame shown */
+	struct ViewportSet *set;
+} ViewportWindow;
+
+typedef struct ViewportSet {
+	ViewportWindow windows[VIEWPORT_WINDOWS_MAX];
+	int count;
+	GLFWwindow *main;	/* its context is shared */
+	GLFWkeyfun keys;	/* of the main window */
+	unsigned int presented;	/* frames shown in all windows */
+
+	void clear()
+	{
+		count = 0;
+		main = NULL;
+		keys = NULL;
+		presented = 0;
+	}
+
+	/* Main thread, with the context of mainWindow current: open n windows
+	* of w x h pixels sharing its objects, placed right of it. Their swap
+	* interval is swapInterval. keyCallback gets their key events as if
+	* they came from mainWindow.
+	* Returns true if successfull and false in case of an error. */
+	bool create(GLFWwindow *mainWindow, int n, int w, int h, const char *title, GLFWkeyfun keyCallback,
+		int swapInterval)
+	{
+		int i, x, y;
+
+		main = mainWindow;
+		keys = keyCallback;
+		if (n > VIEWPORT_WINDOWS_MAX)
+			n = VIEWPORT_WINDOWS_MAX;
+		glfwGetWindowPos(main, &x, &y);
+		for (i = 0; i < n; i++) {
+			ViewportWindow *v = &windows[i];
+			int fw, fh;
+			v->win = glfwCreateWindow(w, h, title, NULL, main);
+			if (!v->win) {
+				warn("failed to create viewport window %d", i);
+				glfwMakeContextCurrent(main);
+				return false;
+			}
+			count = i + 1;
+			v->fbo = 0;
+			v->column = i;
+			v->swapInterval = swapInterval;
+			v->set = this;
+			glfwGetFramebufferSize(v->win, &fw, &fh);
+			v->width = fw;
+			v->height = fh;
+			glfwSetWindowUserPointer(v->win, v);
+			glfwSetFramebufferSizeCallback(v->win, callbackSize);
+			glfwSetKeyCallback(v->win, callbackKey);
+			glfwSetWindowPos(v->win, x + (i + 1) * (w + 16), y);
+			glfwMakeContextCurrent(v->win);
+			glfwSwapInterval(swapInterval);
+		}
+		glfwMakeContextCurrent(main);
+		info("viewport windows: %d sharing the objects of the main window", count);
+		return true;
+	}
+
+	/* Show the frame in the color texture of w x h pixels in all windows.
+	* The context of the main window must be current on the calling thread,
+	* and is again afterwards. */
+	void present(GLuint color, GLsizei w, GLsizei h)
+	{
+		int i;
+
+		if (!count || !color)
+			return;
+		GL_DEBUG_GROUP("viewport windows");
+		/* the other contexts only see what was flushed in this one */
+		glFlush();
+		for (i = 0; i < count; i++) {
+			ViewportWindow *v = &windows[i];
+			GLint x0 = (GLint)((long long)w * v->column / count);
+			GLint x1 = (GLint)((long long)w * (v->column + 1) / count);
+
+			glfwMakeContextCurrent(v->win);
+			if (!v->fbo)
+				glGenFramebuffers(1, &v->fbo);
+			/* attached every frame: the texture may have been resized, and
+			 * a change made in another context is only picked up on a new
+			 * attachment */
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, v->fbo);
+			glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(x0, 0, x1, h, 0, 0, v->width, v->height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			glfwSwapBuffers(v->win);
+		}
+		glfwMakeContextCurrent(main);
+		presented++;
+	}
+
+	/* Main thread: whether one of the windows was asked to close. */
+	bool shouldClose() const
+	{
+		int i;
+		for (i = 0; i < count; i++)
+			if (glfwWindowShouldClose(windows[i].win))
+				return true;
+		return false;
+	}
+
+	/* Main thread: close all windows. No context may be current on
+	* another thread. The main context is current afterwards. */
+	void destroy()
+	{
+		int i;
+		for (i = 0; i < count; i++) {
+			ViewportWindow *v = &windows[i];
+			if (v->fbo) {
+				glfwMakeContextCurrent(v->win);
+				glDeleteFramebuffers(1, &v->fbo);
+				v->fbo = 0;
+			}
+			glfwDestroyWindow(v->win);
+			v->win = NULL;
+		}
+		if (count)
+			glfwMakeContextCurrent(main);
+		count = 0;
+	}
+
+	static void callbackSize(GLFWwindow *win, int w, int h)
+	{
+		ViewportWindow *v = (ViewportWindow*)glfwGetWindowUserPointer(win);
+		v->width = w;
+		v->height = h;
+	}
+
+	static void callbackKey(GLFWwindow *win, int key, int scancode, int action, int mods)
+	{
+		ViewportWindow *v = (ViewportWindow*)glfwGetWindowUserPointer(win);
+		if (v->set->keys)
+			v->set->keys(v->set->main, key, scancode, action, mods);
+	}
+} ViewportSet;
+
+#endif
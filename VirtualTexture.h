@@ -0,0 +1,588 @@
+#ifndef HEADER_VIRTUALTEXTURE_H
+#define HEADER_VIRTUALTEXTURE_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "ShaderHelpers.h"
+#include "Streamer.h"
+#include "FrameArena.h"
+
+/****************************************************************************
+* VIRTUAL TEXTURE                                                          *
+****************************************************************************/
+
+/* VirtualTexture: a VT_SIZE^2 RGBA8 texture with a full mip chain of which
+* only the pages which are actually seen take memory, so its memory use
+* stays flat however big it is. It is a sparse texture
+* (GL_ARB_sparse_texture): the levels are split into pages of the size the
+* driver dictates, and each page is committed (backed by memory) or not.
+* The levels smaller than a page, the mip tail, are always committed.
+* Every material of the scene has its own region of VT_REGION_SIZE^2 texels,
+* filled procedurally as a stand-in for a big texture dataset.
+* Feedback: the fragment shader (shaders/virtual.fs.glsl) writes the number
+* of the frame into the entry of the page at the level it would like to
+* sample, for one pixel in 16 per frame, in a storage buffer with an entry
+* per page. That buffer is copied into one of VT_READBACK_FRAMES read back
+* buffers behind a fence each frame and read once the fence is signaled,
+* so the CPU never waits for the GPU.
+* Residency: the pages used within the last VT_USE_FRAMES frames which are
+* missing are committed and filled on the loader thread of the Streamer,
+* coarse levels first and never a page before the one covering it in the
+* level above, at most VT_REQUESTS_PER_FRAME per frame. Up to VT_PAGE_CACHE
+* pages are committed at once; beyond that the least recently used page
+* without committed pages below it gives its memory back, after the draws
+* which may still read it, via a fence the loader waits for on the GPU.
+* Sampling: a page which is not committed must never be read, so the shader
+* clamps the level of detail to the finest level committed around the
+* sample, which the min lod texture holds per page of level 0. */
+#define VT_SIZE 16384			/* width and height, a power of two */
+#define VT_REGION_GRID 8		/* regions per side, VT_REGION_GRID^2 >= MATERIAL_MAX */
+#define VT_REGION_SIZE (VT_SIZE / VT_REGION_GRID)
+#define VT_LEVELS_MAX 16		/* also in shaders/virtual.fs.glsl */
+#define VT_PAGE_CACHE 512		/* committed pages at most */
+#define VT_REQUESTS_PER_FRAME 4
+#define VT_USE_FRAMES 32		/* a page counts as used for this long */
+#define VT_READBACK_FRAMES 3
+
+#define VIRTUAL_TEXTURE_FS "shaders/virtual.fs.glsl"
+
+/* page states */
+enum {
+	VT_PAGE_ABSENT = 0,
+	VT_PAGE_LOADING,	/* being committed and filled */
+	VT_PAGE_RESIDENT,
+	VT_PAGE_RELEASING	/* being decommitted */
+};
+
+/* the uniform block "VirtualTexture", std140 */
+typedef struct {
+	GLuint pages[4];	/* pages of level 0 across and down, sparse levels, frame */
+	GLuint levelOffset[VT_LEVELS_MAX];	/* of the first page of each level */
+} VirtualTextureUniforms;
+
+/* The texel at x, y of the region of material, at the resolution of level
+* (0 is the finest). A pattern of the material at three scales in turn
+* (the coarse cells, the bricks in them and the fine grain in those), each
+* faded to its average on levels whose texels are too big to show it, so
+* the levels look like a mip chain. */
+static void virtualTexel(int material, GLint level, GLint x, GLint y, GLubyte *rgba)
+{
+	static const GLubyte tints[8][3] = {
+		{ 230, 180, 120 }, { 120, 200, 120 }, { 120, 160, 230 }, { 230, 120, 120 },
+		{ 200, 200, 200 }, { 230, 210, 90 }, { 170, 120, 220 }, { 90, 200, 210 }
+	};
+	const GLint periods[3] = { 512, 64, 8 };
+	const float amplitudes[3] = { 0.3f, 0.25f, 0.15f };
+	float size = (float)(1 << level);
+	float u = ((float)x + 0.5f) * size, v = ((float)y + 0.5f) * size;
+	float value = 0.55f;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		/* a square wave averages out once a texel covers half a period */
+		float fade = 2.0f * size / (float)periods[i];
+		if (fade >= 1.0f)
+			continue;
+		GLint cu = (GLint)u / periods[i], cv = (GLint)v / periods[i];
+		bool on;
+		switch ((material + i) & 3) {
+			case 0:
+				on = (cu ^ cv) & 1;
+				break;
+			case 1:
+				on = (cu + cv) & 1 ? ((GLint)u % periods[i]) < periods[i] / 2 : ((GLint)v % periods[i]) < periods[i] / 2;
+				break;
+			case 2: {
+				float du = u - ((float)cu + 0.5f) * (float)periods[i], dv = v - ((float)cv + 0.5f) * (float)periods[i];
+				on = du * du + dv * dv < 0.16f * (float)(periods[i] * periods[i]);
+				break;
+			}
+			default:
+				on = ((GLint)(u + (float)((cv & 1) * periods[i] / 2)) % periods[i]) > periods[i] / 8 &&
+					((GLint)v % periods[i]) > periods[i] / 8;
+				break;
+		}
+		value += (on ? 0.5f : -0.5f) * amplitudes[i] * (1.0f - fade);
+	}
+	for (i = 0; i < 3; i++)
+		rgba[i] = (GLubyte)glm::clamp((float)tints[material & 7][i] * value * 1.3f, 0.0f, 255.0f);
+	rgba[3] = 255;
+}
+
+/* StreamPageFunc: fill a page, user is unused. */
+static void virtualPageFill(const void *user, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+	GLubyte *rgba)
+{
+	GLint i, j, regionSize = VT_REGION_SIZE >> level;
+
+	(void)user;
+	if (regionSize < 1)
+		regionSize = 1;
+	for (j = 0; j < height; j++) {
+		for (i = 0; i < width; i++) {
+			GLint tx = x + i, ty = y + j;
+			int material = (ty / regionSize) * VT_REGION_GRID + tx / regionSize;
+			virtualTexel(material, level, tx % regionSize, ty % regionSize, rgba + 4 * (j * width + i));
+		}
+	}
+}
+
+static bool virtualTextureSupported()
+{
+	return glCaps()->sparseTexture;
+}
+
+typedef struct {
+	GLuint texture;		/* the sparse texture, 0 if not set up */
+	GLuint minLodTexture;	/* GL_R8UI, per page of level 0 */
+	GLuint uniformBuffer;
+	GLuint feedbackBuffer;	/* a GLuint per page, written by the shader */
+	GLuint readback[VT_READBACK_FRAMES];
+	GLsync readbackFence[VT_READBACK_FRAMES];
+	int readbackNext;	/* the slot endFrame() copies into */
+	GLint pageWidth, pageHeight;
+	int levels, sparseLevels;
+	int pagesX, pagesY;	/* of level 0 */
+	int levelOffset[VT_LEVELS_MAX];
+	int pageCount;		/* of all sparse levels */
+	GLuint *feedback;	/* the last feedback read back */
+	unsigned int *lastUse;	/* frame a page was last seen in */
+	unsigned char *state;	/* VT_PAGE_* */
+	unsigned char *minLod;	/* the contents of minLodTexture */
+	int committed;		/* pages loading, resident or releasing */
+	unsigned int frame;
+	bool minLodDirty;
+	bool drawn;		/* bind() was called this frame */
+
+	void clear()
+	{
+		texture = minLodTexture = uniformBuffer = feedbackBuffer = 0;
+		memset(readback, 0, sizeof(readback));
+		memset(readbackFence, 0, sizeof(readbackFence));
+		readbackNext = 0;
+		feedback = lastUse = NULL;
+		state = minLod = NULL;
+		pageCount = committed = 0;
+		frame = 0;
+		minLodDirty = drawn = false;
+	}
+
+	/* The pages across and down of level. */
+	int levelPagesX(int level) const
+	{
+		int n = ((VT_SIZE >> level) + pageWidth - 1) / pageWidth;
+		return n ? n : 1;
+	}
+
+	int levelPagesY(int level) const
+	{
+		int n = ((VT_SIZE >> level) + pageHeight - 1) / pageHeight;
+		return n ? n : 1;
+	}
+
+	int pageIndex(int level, int x, int y) const
+	{
+		return levelOffset[level] + y * levelPagesX(level) + x;
+	}
+
+	/* Create the sparse texture and the buffers, with the mip tail
+	* committed and filled right away.
+	* Returns true if successfull and false if it is not supported. */
+	bool init()
+	{
+		int i;
+		MemoryScope scope(MEMORY_TEXTURES);
+
+		clear();
+		if (!virtualTextureSupported()) {
+			info("virtual texture: sparse textures are not supported");
+			return false;
+		}
+		glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageWidth);
+		glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageHeight);
+		if (pageWidth < 1 || pageHeight < 1 || pageWidth > VT_REGION_SIZE || pageHeight > VT_REGION_SIZE) {
+			info("virtual texture: no usable page size for RGBA8");
+			return false;
+		}
+		for (levels = 1; (VT_SIZE >> levels) > 0; levels++)
+			;
+		glGenTextures(1, &texture);
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+		glTexParameteri(GL_TEXTURE_2D, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+		glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, VT_SIZE, VT_SIZE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels);
+		if (sparseLevels > VT_LEVELS_MAX)
+			sparseLevels = VT_LEVELS_MAX;
+		pagesX = levelPagesX(0);
+		pagesY = levelPagesY(0);
+		for (i = 0; i < sparseLevels; i++) {
+			levelOffset[i] = pageCount;
+			pageCount += levelPagesX(i) * levelPagesY(i);
+		}
+
+		/* the tail is committed as a whole, and filled once */
+		for (i = sparseLevels; i < levels; i++) {
+			GLsizei n = VT_SIZE >> i;
+			GLubyte *rgba = (GLubyte*)malloc(4 * (size_t)n * n);
+			glTexPageCommitmentARB(GL_TEXTURE_2D, i, 0, 0, 0, n, n, 1, GL_TRUE);
+			if (rgba) {
+				virtualPageFill(NULL, i, 0, 0, n, n, rgba);
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, n, n, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+				free(rgba);
+			}
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+
+		feedback = (GLuint*)calloc(pageCount ? pageCount : 1, sizeof(GLuint));
+		lastUse = (unsigned int*)calloc(pageCount ? pageCount : 1, sizeof(unsigned int));
+		state = (unsigned char*)calloc(pageCount ? pageCount : 1, 1);
+		minLod = (unsigned char*)malloc((size_t)pagesX * pagesY);
+		if (!feedback || !lastUse || !state || !minLod) {
+			warn("virtual texture: failed to allocate %d pages", pageCount);
+			destroy();
+			return false;
+		}
+		memset(minLod, sparseLevels, (size_t)pagesX * pagesY);
+		glGenTextures(1, &minLodTexture);
+		glState()->bindTexture(GL_TEXTURE_2D, minLodTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, pagesX, pagesY, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, minLod);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+
+		VirtualTextureUniforms u;
+		memset(&u, 0, sizeof(u));
+		u.pages[0] = (GLuint)pagesX;
+		u.pages[1] = (GLuint)pagesY;
+		u.pages[2] = (GLuint)sparseLevels;
+		for (i = 0; i < sparseLevels; i++)
+			u.levelOffset[i] = (GLuint)levelOffset[i];
+		GLuint buffers[2 + VT_READBACK_FRAMES];
+		glGenBuffers(2 + VT_READBACK_FRAMES, buffers);
+		uniformBuffer = buffers[0];
+		feedbackBuffer = buffers[1];
+		glState()->bindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(u), &u, GL_DYNAMIC_DRAW);
+		glState()->bindBuffer(GL_UNIFORM_BUFFER, 0);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, feedbackBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * pageCount, feedback, GL_DYNAMIC_COPY);
+		glState()->bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		for (i = 0; i < VT_READBACK_FRAMES; i++) {
+			readback[i] = buffers[2 + i];
+			glState()->bindBuffer(GL_COPY_WRITE_BUFFER, readback[i]);
+			glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * pageCount, NULL, GL_STREAM_READ);
+		}
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		info("virtual texture: %dx%d, pages of %dx%d, %d of %d levels sparse, %d pages", VT_SIZE, VT_SIZE,
+			(int)pageWidth, (int)pageHeight, sparseLevels, levels, pageCount);
+		GL_ERROR_DBG("virtual texture initialization");
+		return true;
+	}
+
+	/* Release everything. The streamer must be stopped first, it may
+	* still write to the texture. */
+	void destroy()
+	{
+		int i;
+
+		for (i = 0; i < VT_READBACK_FRAMES; i++) {
+			if (readbackFence[i])
+				glDeleteSync(readbackFence[i]);
+		}
+		if (texture || minLodTexture) {
+			GLuint textures[2] = { texture, minLodTexture };
+			glState()->deleteTextures(2, textures);
+		}
+		if (uniformBuffer) {
+			GLuint buffers[2 + VT_READBACK_FRAMES];
+			buffers[0] = uniformBuffer;
+			buffers[1] = feedbackBuffer;
+			for (i = 0; i < VT_READBACK_FRAMES; i++)
+				buffers[2 + i] = readback[i];
+			glState()->deleteBuffers(2 + VT_READBACK_FRAMES, buffers);
+		}
+		free(feedback);
+		free(lastUse);
+		free(state);
+		free(minLod);
+		clear();
+	}
+
+	/* Bind the texture, the min lod texture, the uniforms and the feedback
+	* buffer for drawing with shaders/virtual.fs.glsl. */
+	void bind()
+	{
+		if (!texture)
+			return;
+		glState()->bindBufferBase(GL_UNIFORM_BUFFER, VT_UBO_BINDING, uniformBuffer);
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, VT_FEEDBACK_BINDING, feedbackBuffer);
+		glState()->activeTexture(GL_TEXTURE0 + VT_TEXTURE_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, texture);
+		glState()->activeTexture(GL_TEXTURE0 + VT_MIN_LOD_UNIT);
+		glState()->bindTexture(GL_TEXTURE_2D, minLodTexture);
+		glState()->activeTexture(GL_TEXTURE0);
+		drawn = true;
+	}
+
+	/* After the draws of a frame: copy the feedback for reading it back
+	* later, if a slot is free. */
+	void endFrame()
+	{
+		int slot = readbackNext;
+
+		if (!texture || !drawn)
+			return;
+		drawn = false;
+		if (readbackFence[slot])
+			return;
+		/* the draws wrote the feedback to a storage buffer */
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, feedbackBuffer);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, readback[slot]);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(GLuint) * pageCount);
+		glState()->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		readbackFence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		readbackNext = (slot + 1) % VT_READBACK_FRAMES;
+	}
+
+	/* Read the oldest feedback copy back if the GPU is done with it.
+	* Returns true if there was one. */
+	bool readFeedback()
+	{
+		int i, slot, oldest = -1;
+
+		for (i = 1; i <= VT_READBACK_FRAMES; i++) {
+			slot = (readbackNext + i) % VT_READBACK_FRAMES;
+			if (readbackFence[slot]) {
+				oldest = slot;
+				break;
+			}
+		}
+		if (oldest < 0 || glClientWaitSync(readbackFence[oldest], 0, 0) == GL_TIMEOUT_EXPIRED)
+			return false;
+		glDeleteSync(readbackFence[oldest]);
+		readbackFence[oldest] = 0;
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, readback[oldest]);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(GLuint) * pageCount, feedback);
+		glState()->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		for (i = 0; i < pageCount; i++) {
+			if (feedback[i] > lastUse[i])
+				lastUse[i] = feedback[i];
+		}
+		return true;
+	}
+
+	bool used(int index) const
+	{
+		return lastUse[index] && frame - lastUse[index] < VT_USE_FRAMES;
+	}
+
+	/* Whether the page at level, x, y has committed pages below it. */
+	bool hasChildren(int level, int x, int y) const
+	{
+		int i, j;
+
+		if (level == 0)
+			return false;
+		for (j = 0; j < 2; j++) {
+			for (i = 0; i < 2; i++) {
+				int cx = 2 * x + i, cy = 2 * y + j;
+				if (cx < levelPagesX(level - 1) && cy < levelPagesY(level - 1) &&
+					state[pageIndex(level - 1, cx, cy)] != VT_PAGE_ABSENT)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	/* Release the least recently used resident page without children
+	* which is not in use.
+	* Returns true if successfull and false if there is none. */
+	bool evict(Streamer *streamer)
+	{
+		int level, x, y, best = -1, bestLevel = 0, bestX = 0, bestY = 0;
+
+		for (level = 0; level < sparseLevels; level++) {
+			for (y = 0; y < levelPagesY(level); y++) {
+				for (x = 0; x < levelPagesX(level); x++) {
+					int i = pageIndex(level, x, y);
+					if (state[i] != VT_PAGE_RESIDENT || used(i) || hasChildren(level, x, y))
+						continue;
+					if (best < 0 || lastUse[i] < lastUse[best]) {
+						best = i;
+						bestLevel = level;
+						bestX = x;
+						bestY = y;
+					}
+				}
+			}
+		}
+		if (best < 0)
+			return false;
+		/* no draw after this one samples the page */
+		state[best] = VT_PAGE_RELEASING;
+		updateMinLod();
+		StreamPage p = page(bestLevel, bestX, bestY, best);
+		p.wait = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		if (!streamer->requestPage(STREAM_PAGE_RELEASE, &p)) {
+			glDeleteSync(p.wait);
+			state[best] = VT_PAGE_RESIDENT;
+			minLodDirty = true;
+			return false;
+		}
+		return true;
+	}
+
+	StreamPage page(int level, int x, int y, int index) const
+	{
+		StreamPage p;
+
+		memset(&p, 0, sizeof(p));
+		p.texture = texture;
+		p.level = level;
+		p.x = x * pageWidth;
+		p.y = y * pageHeight;
+		p.width = glm::min((GLsizei)pageWidth, (GLsizei)(VT_SIZE >> level) - p.x);
+		p.height = glm::min((GLsizei)pageHeight, (GLsizei)(VT_SIZE >> level) - p.y);
+		p.index = index;
+		p.fill = virtualPageFill;
+		return p;
+	}
+
+	/* Once per frame: read the feedback back, request the pages which are
+	* missing from streamer, release pages to make room for them, and
+	* update the min lod texture. */
+	void update(Streamer *streamer)
+	{
+		int level, x, y, requested = 0;
+
+		if (!texture)
+			return;
+		frame++;
+		/* the shader compares its low bits to pick its pixels */
+		glState()->bindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 3 * sizeof(GLuint), sizeof(GLuint), &frame);
+		glState()->bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		if (readFeedback()) {
+			/* coarse levels first, a page only after the one above it */
+			for (level = sparseLevels - 1; level >= 0 && requested < VT_REQUESTS_PER_FRAME; level--) {
+				for (y = 0; y < levelPagesY(level) && requested < VT_REQUESTS_PER_FRAME; y++) {
+					for (x = 0; x < levelPagesX(level) && requested < VT_REQUESTS_PER_FRAME; x++) {
+						int i = pageIndex(level, x, y);
+						if (state[i] != VT_PAGE_ABSENT || !(used(i) || usedBelow(level, x, y)))
+							continue;
+						if (level + 1 < sparseLevels && state[pageIndex(level + 1, x / 2, y / 2)] != VT_PAGE_RESIDENT)
+							continue;
+						if (committed >= VT_PAGE_CACHE && !evict(streamer)) {
+							requested = VT_REQUESTS_PER_FRAME;
+							break;
+						}
+						StreamPage p = page(level, x, y, i);
+						if (!streamer->requestPage(STREAM_PAGE_COMMIT, &p)) {
+							requested = VT_REQUESTS_PER_FRAME;
+							break;
+						}
+						state[i] = VT_PAGE_LOADING;
+						committed++;
+						requested++;
+					}
+				}
+			}
+		}
+		if (minLodDirty)
+			updateMinLod();
+	}
+
+	/* Whether a page below the one at level, x, y was seen, which needs
+	* it as its fallback. Only the direct children are checked, the chain
+	* fills in over the frames. */
+	bool usedBelow(int level, int x, int y) const
+	{
+		int i, j;
+
+		if (level == 0)
+			return false;
+		for (j = 0; j < 2; j++) {
+			for (i = 0; i < 2; i++) {
+				int cx = 2 * x + i, cy = 2 * y + j;
+				if (cx < levelPagesX(level - 1) && cy < levelPagesY(level - 1) &&
+					used(pageIndex(level - 1, cx, cy)))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	/* A page request of the streamer is done. */
+	void pageDone(const StreamItem *item)
+	{
+		int i = item->page.index;
+
+		if (!texture || i < 0 || i >= pageCount)
+			return;
+		if (item->kind == STREAM_PAGE_RELEASE || !item->ok) {
+			if (!item->ok)
+				warn("virtual texture: failed to load page %d", i);
+			state[i] = VT_PAGE_ABSENT;
+			committed--;
+		} else {
+			state[i] = VT_PAGE_RESIDENT;
+		}
+		minLodDirty = true;
+	}
+
+	/* Recompute the finest level which can be sampled over each page of
+	* level 0: the pages down to it are resident, for the page and for its
+	* neighbors, which bilinear filtering reaches into. */
+	void updateMinLod()
+	{
+		int x, y, level;
+		/* scratch for this frame only */
+		unsigned char *finest = frameArenas()->current()->allocArray<unsigned char>((size_t)pagesX * pagesY);
+
+		if (!finest)
+			return;
+		for (y = 0; y < pagesY; y++) {
+			for (x = 0; x < pagesX; x++) {
+				level = sparseLevels;
+				while (level > 0) {
+					int px = (x * pageWidth >> (level - 1)) / pageWidth, py = (y * pageHeight >> (level - 1)) / pageHeight;
+					if (state[pageIndex(level - 1, px, py)] != VT_PAGE_RESIDENT)
+						break;
+					level--;
+				}
+				finest[y * pagesX + x] = (unsigned char)level;
+			}
+		}
+		for (y = 0; y < pagesY; y++) {
+			for (x = 0; x < pagesX; x++) {
+				unsigned char m = 0;
+				int dx, dy;
+				for (dy = -1; dy <= 1; dy++) {
+					for (dx = -1; dx <= 1; dx++) {
+						int nx = x + dx, ny = y + dy;
+						if (nx >= 0 && ny >= 0 && nx < pagesX && ny < pagesY && finest[ny * pagesX + nx] > m)
+							m = finest[ny * pagesX + nx];
+					}
+				}
+				minLod[y * pagesX + x] = m;
+			}
+		}
+		glState()->bindTexture(GL_TEXTURE_2D, minLodTexture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, pagesX, pagesY, GL_RED_INTEGER, GL_UNSIGNED_BYTE, minLod);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glState()->bindTexture(GL_TEXTURE_2D, 0);
+		minLodDirty = false;
+	}
+} VirtualTexture;
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef HEADER_VOXELOCTREE_H
+#define HEADER_VOXELOCTREE_H
+
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Profiler.h"
+#include "ShaderHelpers.h"
+#include "Cube.h"
+#include "JobSystem.h"
+#include "VoxelWorld.h"
+
+/****************************************************************************
+* VOXEL OCTREE: raymarching the voxels instead of meshing them             *
+****************************************************************************/
+
+/* VoxelOctree: the voxels of a VoxelWorld as a sparse brick map for the
+* raymarching program (shaders/voxel_march.glsl, the VOXELS variant of
+* shaders/raymarch.fs.glsl), in a single storage buffer. The meshes cost
+* memory and triangles for every visible face however far away it is; the
+* rays cost per pixel, however much of the world is in view.
+*   The world is split into bricks of 8^3 voxels. The brick grid has an
+*   entry per brick: 0 if it is all air, VOXEL_OCTREE_UNIFORM and the type
+*   if it is all one type (most of the ground below the surface), else the
+*   offset of its voxels. Only those bricks are stored, a byte per voxel,
+*   followed by their mip levels of 4^3, 2^3 and 1 voxels, each the most
+*   common solid type of the 8 below it, or air if they are all air.
+*   Above the brick grid, occupancy levels halve it until a single node is
+*   left: an implicit octree whose nodes are 0 if nothing below them is
+*   solid. A ray looks for the coarsest empty node around it, and skips
+*   the whole node at once, down to the single voxels only near surfaces,
+*   stepping from cell to cell like a DDA.
+*   The mip level a ray reads in a brick follows its distance, so a voxel
+*   is never much smaller than a pixel, which is a level of detail for
+*   free.
+* The buffer is built from scratch on the job system whenever the voxels
+* changed, a chunk per job, and uploaded at once. */
+#define VOXEL_OCTREE_BRICK 8	/* voxels per side of a brick, also in shaders/voxel_march.glsl */
+#define VOXEL_OCTREE_BRICK_UINTS 148	/* a brick and its mips, 512 + 64 + 8 + 1 bytes padded */
+#define VOXEL_OCTREE_LODS 4	/* mip levels of a brick */
+#define VOXEL_OCTREE_LEVELS_MAX 8	/* the brick grid and the occupancy levels */
+#define VOXEL_OCTREE_UNIFORM 0x80000000u	/* a brick entry of a single type */
+#define VOXEL_OCTREE_COLORS 16
+
+/* the bricks of a chunk per side */
+#define VOXEL_OCTREE_CHUNK_BRICKS (VOXEL_CHUNK_SIZE / VOXEL_OCTREE_BRICK)
+#define VOXEL_OCTREE_CHUNK_BRICK_COUNT (VOXEL_OCTREE_CHUNK_BRICKS * VOXEL_OCTREE_CHUNK_BRICKS * VOXEL_OCTREE_CHUNK_BRICKS)
+
+/* the offsets of the mip levels in a brick, in uints */
+static const GLuint voxelOctreeMips[VOXEL_OCTREE_LODS] = { 0, 128, 144, 146 };
+
+/* the start of the storage block "VoxelOctree", in the std430 layout;
+* the data follows */
+typedef struct {
+	GLuint size[4];		/* bricks per side x, y, z, and the occupancy levels */
+	GLfloat origin[4];	/* world position of voxel 0, 0, 0 */
+	GLuint levels[VOXEL_OCTREE_LEVELS_MAX];	/* offsets into the data: the brick grid, the occupancy levels */
+	GLuint colors[VOXEL_OCTREE_COLORS];	/* RGBA8 per type */
+} VoxelOctreeHeader;
+
+/* The most common solid type of the n values v, air if there is none. */
+static GLubyte voxelOctreeMajority(const GLubyte *v, int n)
+{
+	int i, j, best = 0, bestCount = 0;
+	for (i = 0; i < n; i++) {
+		int count = 0;
+		if (!v[i])
+			continue;
+		for (j = 0; j < n; j++)
+			count += v[j] == v[i];
+		if (count > bestCount) {
+			best = v[i];
+			bestCount = count;
+		}
+	}
+	return (GLubyte)best;
+}
+
+typedef struct VoxelOctree {
+	GLuint buffer;		/* the storage block, 0 before the first build() */
+	GLsizeiptr size;
+	unsigned int version;	/* of the world it was built from */
+	const VoxelWorld *world;	/* during build() */
+	GLuint *entries;	/* during build(): per brick of a chunk, 1 if it is stored */
+	GLuint *bricks;		/* during build(): their voxels */
+
+	void clear()
+	{
+		buffer = 0;
+		size = 0;
+		version = 0;
+		world = NULL;
+		entries = NULL;
+		bricks = NULL;
+	}
+
+	/* Sort the bricks of chunk c into empty, uniform and stored ones,
+	* and build the mip levels of the stored ones. Runs on the jobs. */
+	void buildChunk(int c)
+	{
+		const int B = VOXEL_OCTREE_BRICK, S = VOXEL_CHUNK_SIZE;
+		GLubyte raw[VOXEL_CHUNK_VOXELS];
+		GLubyte level[VOXEL_OCTREE_BRICK * VOXEL_OCTREE_BRICK * VOXEL_OCTREE_BRICK];
+		GLubyte next[VOXEL_OCTREE_BRICK * VOXEL_OCTREE_BRICK * VOXEL_OCTREE_BRICK];
+		int b, x, y, z, l;
+
+		world->chunks[c].voxels.decode(raw);
+		for (b = 0; b < VOXEL_OCTREE_CHUNK_BRICK_COUNT; b++) {
+			const int n = VOXEL_OCTREE_CHUNK_BRICKS;
+			int bx = b % n, by = (b / n) % n, bz = b / (n * n);
+			GLuint *entry = &entries[c * VOXEL_OCTREE_CHUNK_BRICK_COUNT + b];
+			GLubyte *dst = (GLubyte*)&bricks[((size_t)c * VOXEL_OCTREE_CHUNK_BRICK_COUNT + b) * VOXEL_OCTREE_BRICK_UINTS];
+			bool uniform = true;
+			for (z = 0; z < B; z++)
+				for (y = 0; y < B; y++)
+					for (x = 0; x < B; x++) {
+						GLubyte v = raw[(bx * B + x) + S * ((by * B + y) + S * (bz * B + z))];
+						level[x + B * (y + B * z)] = v;
+						uniform = uniform && v == level[0];
+					}
+			if (uniform) {
+				*entry = level[0] ? (VOXEL_OCTREE_UNIFORM | level[0]) : 0;
+				continue;
+			}
+			*entry = 1;
+			memset(dst, 0, sizeof(GLuint) * VOXEL_OCTREE_BRICK_UINTS);
+			memcpy(dst, level, sizeof(level));
+			for (l = 1; l < VOXEL_OCTREE_LODS; l++) {
+				int s = B >> l;
+				for (z = 0; z < s; z++)
+					for (y = 0; y < s; y++)
+						for (x = 0; x < s; x++) {
+							const int t = 2 * s;
+							GLubyte v[8] = {
+								level[2 * x + t * (2 * y + t * 2 * z)],
+								level[2 * x + 1 + t * (2 * y + t * 2 * z)],
+								level[2 * x + t * (2 * y + 1 + t * 2 * z)],
+								level[2 * x + 1 + t * (2 * y + 1 + t * 2 * z)],
+								level[2 * x + t * (2 * y + t * (2 * z + 1))],
+								level[2 * x + 1 + t * (2 * y + t * (2 * z + 1))],
+								level[2 * x + t * (2 * y + 1 + t * (2 * z + 1))],
+								level[2 * x + 1 + t * (2 * y + 1 + t * (2 * z + 1))] };
+							next[x + s * (y + s * z)] = voxelOctreeMajority(v, 8);
+						}
+				memcpy(level, next, s * s * s);
+				memcpy(dst + 4 * voxelOctreeMips[l], level, s * s * s);
+			}
+		}
+	}
+
+	static void buildChunks(void *user, int begin, int end)
+	{
+		VoxelOctree *o = (VoxelOctree*)user;
+		int c;
+		for (c = begin; c < end; c++)
+			o->buildChunk(c);
+	}
+
+	/* Build the buffer from the voxels of w, a chunk per job on jobs,
+	* replacing the one before.
+	* Returns true if successfull and false in case of an error. */
+	bool build(const VoxelWorld *w, JobSystem *jobs)
+	{
+		const int n = VOXEL_OCTREE_CHUNK_BRICKS;
+		VoxelOctreeHeader h;
+		GLuint dims[VOXEL_OCTREE_LEVELS_MAX][3];
+		int levels = 0, c, b, l;
+
+		PROFILE_ZONE("voxel octree");
+		double start = profileSeconds();
+		/* not again until the voxels change, even if it fails */
+		version = w->version;
+		memset(&h, 0, sizeof(h));
+		h.size[0] = (GLuint)(w->sizeX * n);
+		h.size[1] = (GLuint)(w->sizeY * n);
+		h.size[2] = (GLuint)(w->sizeZ * n);
+		for (l = 0; l < VOXEL_OCTREE_LEVELS_MAX; l++) {
+			dims[l][0] = (h.size[0] + (1u << l) - 1) >> l;
+			dims[l][1] = (h.size[1] + (1u << l) - 1) >> l;
+			dims[l][2] = (h.size[2] + (1u << l) - 1) >> l;
+			levels = l;
+			if (dims[l][0] * dims[l][1] * dims[l][2] == 1)
+				break;
+		}
+		h.size[3] = (GLuint)levels;
+		h.origin[0] = w->origin.x;
+		h.origin[1] = w->origin.y;
+		h.origin[2] = w->origin.z;
+		h.origin[3] = 1.0f;
+		for (c = 0; c < VOXEL_TYPES && c < VOXEL_OCTREE_COLORS; c++)
+			h.colors[c] = voxelColors[c][0] | (voxelColors[c][1] << 8) | (voxelColors[c][2] << 16) | 0xff000000u;
+
+		int brickCount = w->chunkCount * VOXEL_OCTREE_CHUNK_BRICK_COUNT;
+		entries = (GLuint*)malloc(sizeof(GLuint) * brickCount);
+		bricks = (GLuint*)malloc(sizeof(GLuint) * VOXEL_OCTREE_BRICK_UINTS * (size_t)brickCount);
+		if (!entries || !bricks) {
+			warn("voxel octree: failed to allocate %d bricks", brickCount);
+			free(entries);
+			free(bricks);
+			entries = bricks = NULL;
+			return false;
+		}
+		world = w;
+		jobs->run(buildChunks, this, w->chunkCount, 1);
+		world = NULL;
+
+		/* the brick grid and the occupancy levels, then the stored bricks */
+		GLuint offset = 0, stored = 0, uniform = 0;
+		for (l = 0; l <= levels; l++) {
+			h.levels[l] = offset;
+			offset += dims[l][0] * dims[l][1] * dims[l][2];
+		}
+		for (b = 0; b < brickCount; b++) {
+			stored += entries[b] == 1;
+			uniform += (entries[b] & VOXEL_OCTREE_UNIFORM) != 0;
+		}
+		GLuint words = offset + stored * VOXEL_OCTREE_BRICK_UINTS;
+		GLsizeiptr bytes = (GLsizeiptr)sizeof(h) + (GLsizeiptr)sizeof(GLuint) * words;
+		char *data = (char*)calloc(bytes, 1);
+		if (!data) {
+			warn("voxel octree: failed to allocate %u KB", (unsigned)(bytes >> 10));
+			free(entries);
+			free(bricks);
+			entries = bricks = NULL;
+			return false;
+		}
+		memcpy(data, &h, sizeof(h));
+		GLuint *d = (GLuint*)(data + sizeof(h));
+		GLuint pool = offset;
+		for (c = 0; c < w->chunkCount; c++) {
+			const VoxelChunk *chunk = &w->chunks[c];
+			for (b = 0; b < VOXEL_OCTREE_CHUNK_BRICK_COUNT; b++) {
+				GLuint e = entries[c * VOXEL_OCTREE_CHUNK_BRICK_COUNT + b];
+				GLuint x = (GLuint)(chunk->x * n + b % n), y = (GLuint)(chunk->y * n + (b / n) % n);
+				GLuint z = (GLuint)(chunk->z * n + b / (n * n));
+				if (e == 1) {
+					memcpy(&d[pool], &bricks[((size_t)c * VOXEL_OCTREE_CHUNK_BRICK_COUNT + b) * VOXEL_OCTREE_BRICK_UINTS],
+						sizeof(GLuint) * VOXEL_OCTREE_BRICK_UINTS);
+					e = pool;
+					pool += VOXEL_OCTREE_BRICK_UINTS;
+				}
+				d[h.levels[0] + x + h.size[0] * (y + h.size[1] * z)] = e;
+			}
+		}
+		free(entries);
+		free(bricks);
+		entries = bricks = NULL;
+		for (l = 1; l <= levels; l++) {
+			GLuint x, y, z;
+			for (z = 0; z < dims[l - 1][2]; z++)
+				for (y = 0; y < dims[l - 1][1]; y++)
+					for (x = 0; x < dims[l - 1][0]; x++)
+						if (d[h.levels[l - 1] + x + dims[l - 1][0] * (y + dims[l - 1][1] * z)])
+							d[h.levels[l] + (x >> 1) + dims[l][0] * ((y >> 1) + dims[l][1] * (z >> 1))] = 1;
+		}
+
+		if (buffer)
+			glState()->deleteBuffers(1, &buffer);
+		buffer = meshBufferCreate(GL_SHADER_STORAGE_BUFFER, bytes, data, "voxel octree");
+		free(data);
+		size = bytes;
+		info("voxel octree: %u of %d bricks stored, %u uniform, %u KB, built in %.1f ms", stored, brickCount, uniform,
+			(unsigned)(bytes >> 10), 1000.0 * (profileSeconds() - start));
+		return buffer != 0;
+	}
+
+	/* Raymarch the octree with the bound program, in one triangle covering
+	* the screen. */
+	void draw()
+	{
+		glState()->bindBufferBase(GL_SHADER_STORAGE_BUFFER, VOXEL_OCTREE_SSBO_BINDING, buffer);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		GL_ERROR_DBG("raymarching the voxel octree");
+	}
+
+	void destroy()
+	{
+		if (buffer)
+			glState()->deleteBuffers(1, &buffer);
+		clear();
+	}
+} VoxelOctree;
+
+#endif
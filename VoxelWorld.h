@@ -0,0 +1,743 @@
+#ifndef HEADER_VOXELWORLD_H
+#define HEADER_VOXELWORLD_H
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Log.h"
+#include "Profiler.h"
+#include "ShaderHelpers.h"
+#include "Cube.h"
+#include "JobSystem.h"
+#include "Streamer.h"
+
+/****************************************************************************
+* VOXEL WORLD: chunks with greedy meshes                                   *
+****************************************************************************/
+
+/* VoxelWorld: a terrain of voxels, a byte each naming its type (0 is air),
+* stored in chunks of 32^3. Drawing a cube per voxel would cost a draw, or
+* an instance, per voxel; instead each chunk is turned into one mesh of
+* its visible faces, and the world is drawn with a draw per visible chunk.
+*   The voxels of a chunk are palette compressed (VoxelPalette): the few
+*   types a chunk has go into its palette, and each voxel stores an index
+*   into it of 0, 1, 2, 4 or 8 bits, as few as the palette needs, so a
+*   chunk of air or of solid stone takes no more than its palette.
+*   The mesher is greedy: per slice of the chunk along each axis, it
+*   finds the faces between a solid voxel and air, and merges neighbouring
+*   ones of the same type and direction into rectangles, growing each one
+*   along the rows first, then across them, so a flat stretch of ground is
+*   a couple of quads instead of a quad per voxel.
+*   Edits mark the chunks they touch dirty, and the chunks next to them if
+*   a face between the two changes. update() meshes up to
+*   VOXEL_MESH_BATCH dirty chunks per frame, in parallel on the job system,
+*   and hands the meshes to the streamer, which uploads them on its loader
+*   thread; a chunk keeps drawing its old mesh until the new one is on the
+*   GPU. Without a streamer they are uploaded right away.
+* All chunk meshes are in VERTEX_FORMAT_FLOAT, a buffer each with the
+* vertices followed by 32 bit indices, and are drawn through one VAO whose
+* buffers are switched per chunk, so they share a pipeline state. */
+#define VOXEL_CHUNK_BITS 5
+#define VOXEL_CHUNK_SIZE (1 << VOXEL_CHUNK_BITS)	/* voxels per side of a chunk */
+#define VOXEL_CHUNK_VOXELS (VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE)
+#define VOXEL_WORLD_HEIGHT 2	/* chunks on top of each other */
+#define VOXEL_MESH_BATCH 64	/* chunks meshed per frame */
+#define VOXEL_PALETTE_MAX 256
+#define VOXEL_CRATER_RADIUS 6	/* of the craters dug on key E */
+
+/* the types of voxels */
+enum {
+	VOXEL_AIR = 0,
+	VOXEL_STONE,
+	VOXEL_DIRT,
+	VOXEL_GRASS,
+	VOXEL_SAND,
+	VOXEL_WATER,
+	VOXEL_ORE,
+	VOXEL_TYPES
+};
+
+static const GLubyte voxelColors[VOXEL_TYPES][3] = {
+	{ 0, 0, 0 }, { 128, 128, 128 }, { 134, 96, 67 }, { 89, 166, 60 }, { 219, 206, 143 }, { 52, 98, 191 },
+	{ 196, 120, 48 }
+};
+
+/* The voxel index of x, y, z in a chunk. */
+static inline int voxelIndex(int x, int y, int z)
+{
+	return x + VOXEL_CHUNK_SIZE * (y + VOXEL_CHUNK_SIZE * z);
+}
+
+/* VoxelPalette: the palette compressed voxels of a chunk. The indices are
+* packed into 32 bit words, bits of them per voxel; since bits divides 32,
+* none straddles two words. */
+typedef struct {
+	GLubyte palette[VOXEL_PALETTE_MAX];
+	int paletteCount;
+	int bits;		/* per voxel, 0 if the palette has a single type */
+	GLuint *words;		/* NULL with 0 bits */
+
+	void clear()
+	{
+		paletteCount = 1;
+		palette[0] = VOXEL_AIR;
+		bits = 0;
+		words = NULL;
+	}
+
+	GLubyte get(int i) const
+	{
+		if (!bits)
+			return palette[0];
+		int shift = i * bits;
+		return palette[(words[shift >> 5] >> (shift & 31)) & ((1u << bits) - 1)];
+	}
+
+	/* Unpack all voxels into raw, VOXEL_CHUNK_VOXELS bytes. */
+	void decode(GLubyte *raw) const
+	{
+		int i;
+		if (!bits) {
+			memset(raw, palette[0], VOXEL_CHUNK_VOXELS);
+			return;
+		}
+		for (i = 0; i < VOXEL_CHUNK_VOXELS; i++)
+			raw[i] = get(i);
+	}
+
+	/* Store the voxels raw, VOXEL_CHUNK_VOXELS bytes, with a palette of
+	* just the types in it and as few bits as it needs.
+	* Returns true if successfull and false in case of an error. */
+	bool pack(const GLubyte *raw)
+	{
+		GLubyte map[VOXEL_PALETTE_MAX];
+		GLubyte p[VOXEL_PALETTE_MAX];
+		bool used[VOXEL_PALETTE_MAX] = { false };
+		int i, count = 0, b = 0;
+
+		for (i = 0; i < VOXEL_CHUNK_VOXELS; i++) {
+			if (!used[raw[i]]) {
+				used[raw[i]] = true;
+				map[raw[i]] = (GLubyte)count;
+				p[count++] = raw[i];
+			}
+		}
+		while ((1 << b) < count)
+			b = b ? 2 * b : 1;
+		GLuint *w = NULL;
+		if (b) {
+			w = (GLuint*)calloc(VOXEL_CHUNK_VOXELS * b / 32, sizeof(GLuint));
+			if (!w) {
+				warn("voxels: failed to allocate a chunk");
+				return false;
+			}
+			for (i = 0; i < VOXEL_CHUNK_VOXELS; i++) {
+				int shift = i * b;
+				w[shift >> 5] |= (GLuint)map[raw[i]] << (shift & 31);
+			}
+		}
+		free(words);
+		words = w;
+		bits = b;
+		memcpy(palette, p, count);
+		paletteCount = count;
+		return true;
+	}
+
+	/* Set voxel i to type v. A type which is not in the palette yet is
+	* appended while there is room, otherwise the chunk is packed again,
+	* which drops the types no longer used and widens the indices.
+	* Returns true if successfull and false in case of an error. */
+	bool set(int i, GLubyte v)
+	{
+		int p;
+		for (p = 0; p < paletteCount && palette[p] != v; p++)
+			;
+		if (p == paletteCount) {
+			if (paletteCount >= (1 << bits)) {
+				GLubyte *raw = (GLubyte*)malloc(VOXEL_CHUNK_VOXELS);
+				if (!raw) {
+					warn("voxels: failed to allocate a chunk");
+					return false;
+				}
+				decode(raw);
+				raw[i] = v;
+				bool ok = pack(raw);
+				free(raw);
+				return ok;
+			}
+			palette[paletteCount++] = v;
+		}
+		if (!bits)
+			return true;
+		int shift = i * bits;
+		GLuint mask = ((1u << bits) - 1) << (shift & 31);
+		words[shift >> 5] = (words[shift >> 5] & ~mask) | ((GLuint)p << (shift & 31));
+		return true;
+	}
+
+	/* Bytes of the packed voxels. */
+	size_t bytes() const
+	{
+		return sizeof(palette) + (size_t)VOXEL_CHUNK_VOXELS * bits / 8;
+	}
+
+	void destroy()
+	{
+		free(words);
+		clear();
+	}
+} VoxelPalette;
+
+typedef struct {
+	VoxelPalette voxels;
+	int x, y, z;		/* of the chunk, in chunks */
+	GLuint buffer;		/* the mesh drawn: vertices, then indices, 0 if it is empty */
+	GLsizei indexCount;
+	GLintptr indexOffset;	/* of the indices in buffer */
+	/* the mesh built by the mesher, until it is uploaded */
+	void *staging;
+	GLsizeiptr stagingSize;
+	GLsizei stagingIndexCount;
+	GLintptr stagingOffset;
+	unsigned int quads, faces;	/* of the last mesh, and faces before merging */
+	bool dirty;		/* the voxels changed since the last mesh */
+	bool staged;		/* staging waits for the streamer */
+	bool uploading;		/* staging is with the streamer */
+} VoxelChunk;
+
+/* a growing mesh of one chunk */
+typedef struct {
+	Vertex *vertices;
+	GLsizei count, capacity;
+	unsigned int quads, faces;
+	bool failed;
+} VoxelMesh;
+
+typedef struct VoxelWorld {
+	VoxelChunk *chunks;
+	int sizeX, sizeY, sizeZ;	/* in chunks */
+	int chunkCount;
+	glm::vec3 origin;	/* of voxel 0, 0, 0, the world is centered */
+	GLuint vao;		/* of the chunk meshes, 0 until the first one is uploaded */
+	int *visible;		/* the chunks cull() found, with a mesh */
+	int visibleCount;
+	int batch[VOXEL_MESH_BATCH];	/* of update() */
+	int batchCount;
+	unsigned int seed;	/* picks the places carve() digs at */
+	unsigned int meshed;	/* chunks meshed so far */
+	unsigned int version;	/* counts the changes of the voxels */
+
+	void clear()
+	{
+		chunks = NULL;
+		sizeX = sizeY = sizeZ = 0;
+		chunkCount = 0;
+		origin = glm::vec3(0.0f);
+		vao = 0;
+		visible = NULL;
+		visibleCount = 0;
+		batchCount = 0;
+		seed = 1;
+		meshed = 0;
+		version = 0;
+	}
+
+	/* The height of the terrain at column x, z, in voxels. */
+	int terrainHeight(int x, int z) const
+	{
+		float h = 0.45f * (float)(sizeY * VOXEL_CHUNK_SIZE);
+		h += 10.0f * sinf(0.05f * (float)x) * cosf(0.04f * (float)z);
+		h += 5.0f * sinf(0.11f * (float)(x + z));
+		h += 3.0f * sinf(0.23f * (float)x - 0.17f * (float)z);
+		return (int)h;
+	}
+
+	/* Fill chunk c with the terrain: stone with veins of ore, dirt, grass
+	* on top and sand at the shore, and water up to the sea level. */
+	bool generate(int c)
+	{
+		VoxelChunk *chunk = &chunks[c];
+		GLubyte *raw = (GLubyte*)malloc(VOXEL_CHUNK_VOXELS);
+		int x, y, z, sea = (int)(0.4f * (float)(sizeY * VOXEL_CHUNK_SIZE));
+
+		if (!raw) {
+			warn("voxels: failed to allocate a chunk");
+			return false;
+		}
+		for (z = 0; z < VOXEL_CHUNK_SIZE; z++) {
+			for (x = 0; x < VOXEL_CHUNK_SIZE; x++) {
+				int wx = chunk->x * VOXEL_CHUNK_SIZE + x, wz = chunk->z * VOXEL_CHUNK_SIZE + z;
+				int h = terrainHeight(wx, wz);
+				for (y = 0; y < VOXEL_CHUNK_SIZE; y++) {
+					int wy = chunk->y * VOXEL_CHUNK_SIZE + y;
+					GLubyte v = VOXEL_AIR;
+					unsigned int hash = ((unsigned int)wx * 73856093u) ^ ((unsigned int)wy * 19349663u) ^
+						((unsigned int)wz * 83492791u);
+					if (wy < h - 4)
+						v = (hash % 61u == 0) ? VOXEL_ORE : VOXEL_STONE;
+					else if (wy < h)
+						v = VOXEL_DIRT;
+					else if (wy == h)
+						v = (h <= sea + 1) ? VOXEL_SAND : VOXEL_GRASS;
+					else if (wy <= sea)
+						v = VOXEL_WATER;
+					raw[voxelIndex(x, y, z)] = v;
+				}
+			}
+		}
+		bool ok = chunk->voxels.pack(raw);
+		free(raw);
+		return ok;
+	}
+
+	static void generateChunks(void *user, int begin, int end)
+	{
+		VoxelWorld *w = (VoxelWorld*)user;
+		int c;
+		for (c = begin; c < end; c++)
+			w->generate(c);
+	}
+
+	/* Create a world of n x VOXEL_WORLD_HEIGHT x n chunks of terrain,
+	* generated in parallel on jobs. All chunks start dirty, update()
+	* meshes them over the next frames.
+	* Returns true if successfull and false in case of an error. */
+	bool init(int n, JobSystem *jobs)
+	{
+		int x, y, z, c = 0;
+		size_t bytes = 0;
+
+		clear();
+		sizeX = sizeZ = n;
+		sizeY = VOXEL_WORLD_HEIGHT;
+		chunkCount = n * n * sizeY;
+		chunks = (VoxelChunk*)calloc(chunkCount, sizeof(VoxelChunk));
+		visible = (int*)malloc(sizeof(int) * chunkCount);
+		if (!chunks || !visible) {
+			warn("voxels: failed to allocate %d chunks", chunkCount);
+			destroy();
+			return false;
+		}
+		for (z = 0; z < sizeZ; z++)
+			for (y = 0; y < sizeY; y++)
+				for (x = 0; x < sizeX; x++, c++) {
+					chunks[c].voxels.clear();
+					chunks[c].x = x;
+					chunks[c].y = y;
+					chunks[c].z = z;
+					chunks[c].dirty = true;
+				}
+		origin = -0.5f * (float)VOXEL_CHUNK_SIZE * glm::vec3((float)sizeX, (float)sizeY, (float)sizeZ);
+		{
+			PROFILE_ZONE("voxel terrain");
+			jobs->run(generateChunks, this, chunkCount, 1);
+		}
+		version = 1;
+		for (c = 0; c < chunkCount; c++)
+			bytes += chunks[c].voxels.bytes();
+		info("voxels: %d chunks, %u KB packed for %u KB of voxels", chunkCount, (unsigned)(bytes >> 10),
+			(unsigned)(((size_t)chunkCount * VOXEL_CHUNK_VOXELS) >> 10));
+		return true;
+	}
+
+	/* The chunk of voxel x, y, z, -1 if it is outside the world. */
+	int chunkOf(int x, int y, int z) const
+	{
+		if (x < 0 || y < 0 || z < 0)
+			return -1;
+		x >>= VOXEL_CHUNK_BITS;
+		y >>= VOXEL_CHUNK_BITS;
+		z >>= VOXEL_CHUNK_BITS;
+		if (x >= sizeX || y >= sizeY || z >= sizeZ)
+			return -1;
+		return x + sizeX * (y + sizeY * z);
+	}
+
+	/* The type of voxel x, y, z, air outside the world. */
+	GLubyte get(int x, int y, int z) const
+	{
+		int c = chunkOf(x, y, z);
+		const int m = VOXEL_CHUNK_SIZE - 1;
+		return (c < 0) ? (GLubyte)VOXEL_AIR : chunks[c].voxels.get(voxelIndex(x & m, y & m, z & m));
+	}
+
+	/* Mark the chunk of voxel x, y, z dirty, if there is one. */
+	void touch(int x, int y, int z)
+	{
+		int c = chunkOf(x, y, z);
+		if (c >= 0)
+			chunks[c].dirty = true;
+	}
+
+	/* Set voxel x, y, z to type v, marking its chunk dirty, and the chunks
+	* next to it if it is at their border. Not while update() meshes. */
+	void set(int x, int y, int z, GLubyte v)
+	{
+		int c = chunkOf(x, y, z);
+		const int m = VOXEL_CHUNK_SIZE - 1;
+		int i = voxelIndex(x & m, y & m, z & m);
+
+		if (c < 0 || chunks[c].voxels.get(i) == v || !chunks[c].voxels.set(i, v))
+			return;
+		chunks[c].dirty = true;
+		version++;
+		if ((x & m) == 0)
+			touch(x - 1, y, z);
+		if ((x & m) == m)
+			touch(x + 1, y, z);
+		if ((y & m) == 0)
+			touch(x, y - 1, z);
+		if ((y & m) == m)
+			touch(x, y + 1, z);
+		if ((z & m) == 0)
+			touch(x, y, z - 1);
+		if ((z & m) == m)
+			touch(x, y, z + 1);
+	}
+
+	/* Dig a crater of radius voxels into the surface at a place which
+	* changes with every call. */
+	void carve(int radius)
+	{
+		int x, y, z;
+
+		if (!chunks)
+			return;
+		seed = seed * 1664525u + 1013904223u;
+		int cx = (int)((seed >> 8) % (unsigned int)(sizeX * VOXEL_CHUNK_SIZE));
+		seed = seed * 1664525u + 1013904223u;
+		int cz = (int)((seed >> 8) % (unsigned int)(sizeZ * VOXEL_CHUNK_SIZE));
+		int cy = sizeY * VOXEL_CHUNK_SIZE - 1;
+		while (cy > 0 && get(cx, cy, cz) == VOXEL_AIR)
+			cy--;
+		for (z = -radius; z <= radius; z++)
+			for (y = -radius; y <= radius; y++)
+				for (x = -radius; x <= radius; x++)
+					if (x * x + y * y + z * z <= radius * radius)
+						set(cx + x, cy + y, cz + z, VOXEL_AIR);
+		info("voxels: dug a crater at %d, %d, %d", cx, cy, cz);
+	}
+
+	/* Append the quad of type at corner p spanning du and dv, facing
+	* along du x dv if front, else the other way, to mesh. */
+	static void emitQuad(VoxelMesh *mesh, glm::vec3 p, glm::vec3 du, glm::vec3 dv, bool front, GLubyte type,
+		float shade)
+	{
+		int i;
+		if (mesh->count + 4 > mesh->capacity) {
+			GLsizei capacity = mesh->capacity ? 2 * mesh->capacity : 1024;
+			Vertex *v = (Vertex*)realloc(mesh->vertices, sizeof(Vertex) * capacity);
+			if (!v) {
+				mesh->failed = true;
+				return;
+			}
+			mesh->vertices = v;
+			mesh->capacity = capacity;
+		}
+		glm::vec3 corners[4] = { p, p + du, p + du + dv, p + dv };
+		for (i = 0; i < 4; i++) {
+			Vertex *v = &mesh->vertices[mesh->count + i];
+			const glm::vec3 &c = corners[front ? i : (4 - i) & 3];
+			v->pos[0] = c.x;
+			v->pos[1] = c.y;
+			v->pos[2] = c.z;
+			v->clr[0] = (GLubyte)(shade * (float)voxelColors[type][0]);
+			v->clr[1] = (GLubyte)(shade * (float)voxelColors[type][1]);
+			v->clr[2] = (GLubyte)(shade * (float)voxelColors[type][2]);
+			v->clr[3] = 255;
+		}
+		mesh->count += 4;
+		mesh->quads++;
+	}
+
+	/* Build the greedy mesh of chunk c into its staging memory. Reads the
+	* voxels of the chunks next to it too, which must not change
+	* meanwhile. Runs on the jobs. */
+	void meshChunk(int c)
+	{
+		/* the chunk with a border of the voxels next to it */
+		const int S = VOXEL_CHUNK_SIZE, B = VOXEL_CHUNK_SIZE + 2;
+		static const float shades[3][2] = { { 0.8f, 0.8f }, { 0.5f, 1.0f }, { 0.65f, 0.65f } };
+		VoxelChunk *chunk = &chunks[c];
+		GLubyte *vox = (GLubyte*)calloc(B * B * B, 1);
+		int mask[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
+		VoxelMesh mesh;
+		int x, y, z, d, s, i, j, k;
+
+		memset(&mesh, 0, sizeof(mesh));
+		if (!vox) {
+			mesh.failed = true;
+		} else {
+			int wx = chunk->x * S, wy = chunk->y * S, wz = chunk->z * S;
+			for (z = -1; z <= S; z++)
+				for (y = -1; y <= S; y++)
+					for (x = -1; x <= S; x++) {
+						int inside = (x >= 0 && x < S) + (y >= 0 && y < S) + (z >= 0 && z < S);
+						/* the faces of the chunk only need the voxels across them */
+						if (inside == 3)
+							vox[(x + 1) + B * ((y + 1) + B * (z + 1))] = chunk->voxels.get(voxelIndex(x, y, z));
+						else if (inside == 2)
+							vox[(x + 1) + B * ((y + 1) + B * (z + 1))] = get(wx + x, wy + y, wz + z);
+					}
+		}
+		glm::vec3 base = origin + (float)S * glm::vec3((float)chunk->x, (float)chunk->y, (float)chunk->z);
+		for (d = 0; d < 3 && !mesh.failed; d++) {
+			int u = (d + 1) % 3, v = (d + 2) % 3;
+			int step[3] = { 1, B, B * B };
+			for (s = 0; s <= S; s++) {
+				/* the faces between the voxels at s - 1 and s along d:
+				* +type where the one below is solid, which only this
+				* chunk draws for s > 0, -type where the one above is */
+				int n = 0;
+				for (j = 0; j < S; j++)
+					for (i = 0; i < S; i++, n++) {
+						int at = s * step[d] + (i + 1) * step[u] + (j + 1) * step[v];
+						GLubyte a = vox[at], b = vox[at + step[d]];
+						mask[n] = 0;
+						if (a && !b && s > 0)
+							mask[n] = a;
+						else if (!a && b && s < S)
+							mask[n] = -(int)b;
+						if (mask[n])
+							mesh.faces++;
+					}
+				/* grow each face along the row, then the rows */
+				for (j = 0, n = 0; j < S; j++) {
+					for (i = 0; i < S; ) {
+						int m = mask[n], w, h;
+						if (!m) {
+							i++;
+							n++;
+							continue;
+						}
+						for (w = 1; i + w < S && mask[n + w] == m; w++)
+							;
+						for (h = 1; j + h < S; h++) {
+							for (k = 0; k < w && mask[n + k + h * S] == m; k++)
+								;
+							if (k < w)
+								break;
+						}
+						glm::vec3 p(0.0f), du(0.0f), dv(0.0f);
+						p[d] = (float)s;
+						p[u] = (float)i;
+						p[v] = (float)j;
+						du[u] = (float)w;
+						dv[v] = (float)h;
+						emitQuad(&mesh, base + p, du, dv, m > 0, (GLubyte)(m > 0 ? m : -m), shades[d][m > 0]);
+						for (y = 0; y < h; y++)
+							for (x = 0; x < w; x++)
+								mask[n + x + y * S] = 0;
+						i += w;
+						n += w;
+					}
+				}
+			}
+		}
+		free(vox);
+
+		/* the indices go behind the vertices, two triangles a quad */
+		GLsizei indexCount = (GLsizei)mesh.quads * 6;
+		GLintptr offset = (GLintptr)sizeof(Vertex) * mesh.count;
+		GLsizeiptr size = offset + (GLsizeiptr)sizeof(GLuint) * indexCount;
+		void *data = NULL;
+		if (!mesh.failed && indexCount) {
+			data = realloc(mesh.vertices, size);
+			if (!data)
+				mesh.failed = true;
+		}
+		if (mesh.failed || !data) {
+			free(mesh.vertices);
+			if (mesh.failed)
+				warn("voxels: failed to mesh chunk %d", c);
+			indexCount = 0;
+			size = 0;
+			data = NULL;
+		} else {
+			GLuint *idx = (GLuint*)((char*)data + offset);
+			for (k = 0; k < (int)mesh.quads; k++) {
+				GLuint q = 4 * (GLuint)k;
+				idx[6 * k + 0] = q;
+				idx[6 * k + 1] = q + 1;
+				idx[6 * k + 2] = q + 2;
+				idx[6 * k + 3] = q;
+				idx[6 * k + 4] = q + 2;
+				idx[6 * k + 5] = q + 3;
+			}
+		}
+		chunk->staging = data;
+		chunk->stagingSize = size;
+		chunk->stagingIndexCount = indexCount;
+		chunk->stagingOffset = offset;
+		chunk->quads = mesh.quads;
+		chunk->faces = mesh.faces;
+	}
+
+	static void meshChunks(void *user, int begin, int end)
+	{
+		VoxelWorld *w = (VoxelWorld*)user;
+		int k;
+		for (k = begin; k < end; k++)
+			w->meshChunk(w->batch[k]);
+	}
+
+	/* Draw the mesh in buffer, with the staging memory of chunk, from now
+	* on, and free that memory. */
+	void apply(VoxelChunk *chunk, GLuint buffer)
+	{
+		if (chunk->buffer)
+			glState()->deleteBuffers(1, &chunk->buffer);
+		chunk->buffer = buffer;
+		chunk->indexCount = buffer ? chunk->stagingIndexCount : 0;
+		chunk->indexOffset = chunk->stagingOffset;
+		free(chunk->staging);
+		chunk->staging = NULL;
+		chunk->staged = false;
+		chunk->uploading = false;
+		if (buffer && !vao)
+			vao = meshVertexArrayCreate(&vertexLayouts[VERTEX_FORMAT_FLOAT], buffer, buffer, 0, "voxel chunks");
+	}
+
+	/* Upload the staged mesh of chunk c through streamer, or right away
+	* if it is not running. It stays staged if the streamer is full. */
+	void upload(int c, Streamer *streamer)
+	{
+		VoxelChunk *chunk = &chunks[c];
+
+		if (!chunk->staging) {
+			apply(chunk, 0);
+			return;
+		}
+		if (!streamer || !streamer->context) {
+			apply(chunk, meshBufferCreate(GL_ARRAY_BUFFER, chunk->stagingSize, chunk->staging, "voxel chunk"));
+			return;
+		}
+		StreamBuffer b;
+		b.data = chunk->staging;
+		b.size = chunk->stagingSize;
+		b.label = "voxel chunk";
+		b.index = c;
+		b.buffer = 0;
+		chunk->uploading = streamer->requestBuffer(&b);
+		chunk->staged = !chunk->uploading;
+	}
+
+	/* The upload of the streamer in item is done. */
+	void uploaded(const StreamItem *item)
+	{
+		int c = item->buffer.index;
+		GLuint buffer = item->ok ? item->buffer.buffer : 0;
+
+		if (!chunks || c < 0 || c >= chunkCount || !chunks[c].uploading) {
+			if (buffer)
+				glState()->deleteBuffers(1, &buffer);
+			return;
+		}
+		if (!item->ok) {
+			/* try again */
+			warn("voxels: failed to upload chunk %d", c);
+			chunks[c].dirty = true;
+		}
+		apply(&chunks[c], buffer);
+	}
+
+	/* Hand the meshes waiting for the streamer to it, then mesh up to
+	* VOXEL_MESH_BATCH dirty chunks in parallel on jobs and upload them
+	* through streamer (NULL uploads them right away). Chunks whose last
+	* mesh is not uploaded yet wait with their next one. */
+	void update(JobSystem *jobs, Streamer *streamer)
+	{
+		int c, k;
+		unsigned int quads = 0, faces = 0;
+
+		for (c = 0; c < chunkCount; c++)
+			if (chunks[c].staged)
+				upload(c, streamer);
+		batchCount = 0;
+		for (c = 0; c < chunkCount && batchCount < VOXEL_MESH_BATCH; c++) {
+			VoxelChunk *chunk = &chunks[c];
+			if (chunk->dirty && !chunk->staged && !chunk->uploading) {
+				chunk->dirty = false;
+				batch[batchCount++] = c;
+			}
+		}
+		if (!batchCount)
+			return;
+		double start = profileSeconds();
+		{
+			PROFILE_ZONE("voxel meshing");
+			jobs->run(meshChunks, this, batchCount, 1);
+		}
+		double elapsed = profileSeconds() - start;
+		for (k = 0; k < batchCount; k++) {
+			quads += chunks[batch[k]].quads;
+			faces += chunks[batch[k]].faces;
+			upload(batch[k], streamer);
+		}
+		meshed += batchCount;
+		info("voxels: meshed %d chunks in %.1f ms, %u quads for %u faces", batchCount, 1000.0 * elapsed, quads,
+			faces);
+	}
+
+	/* Find the chunks with a mesh which are not entirely outside the six
+	* planes (see frustumPlanes in FrustumCuller.h). */
+	void cull(const glm::vec4 planes[6])
+	{
+		int c, i;
+		visibleCount = 0;
+		for (c = 0; c < chunkCount; c++) {
+			const VoxelChunk *chunk = &chunks[c];
+			if (!chunk->indexCount)
+				continue;
+			glm::vec3 lo = origin + (float)VOXEL_CHUNK_SIZE * glm::vec3((float)chunk->x, (float)chunk->y,
+				(float)chunk->z);
+			glm::vec3 hi = lo + glm::vec3((float)VOXEL_CHUNK_SIZE);
+			bool outside = false;
+			for (i = 0; i < 6 && !outside; i++) {
+				glm::vec3 normal(planes[i]);
+				/* the corner farthest along the normal */
+				glm::vec3 far = glm::mix(lo, hi, glm::vec3(glm::greaterThanEqual(normal, glm::vec3(0.0f))));
+				outside = glm::dot(normal, far) + planes[i].w < 0.0f;
+			}
+			if (!outside)
+				visible[visibleCount++] = c;
+		}
+	}
+
+	/* Draw the visible chunks, with vao bound, pointing it at the buffer of
+	* each in turn. */
+	void draw()
+	{
+		int i;
+		for (i = 0; i < visibleCount; i++) {
+			const VoxelChunk *chunk = &chunks[visible[i]];
+			meshVertexArrayBuffers(vao, &vertexLayouts[VERTEX_FORMAT_FLOAT], chunk->buffer, 0, chunk->buffer);
+			/* without DSA, that unbound it */
+			glState()->bindVertexArray(vao);
+			glDrawElements(GL_TRIANGLES, chunk->indexCount, GL_UNSIGNED_INT, BUFFER_OFFSET(chunk->indexOffset));
+		}
+		GL_ERROR_DBG("drawing the voxel chunks");
+	}
+
+	/* Release everything. The streamer must be stopped first, it may
+	* still read the staging memory. */
+	void destroy()
+	{
+		int c;
+		for (c = 0; c < chunkCount && chunks; c++) {
+			chunks[c].voxels.destroy();
+			free(chunks[c].staging);
+			if (chunks[c].buffer)
+				glState()->deleteBuffers(1, &chunks[c].buffer);
+		}
+		if (vao)
+			glState()->deleteVertexArrays(1, &vao);
+		free(chunks);
+		free(visible);
+		clear();
+	}
+} VoxelWorld;
+
+#endif
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref core
+/// @file glm/detail/_dispatch.hpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "setup.hpp"
+
+#if GLM_HAS_DISPATCH
+#	if GLM_COMPILER & GLM_COMPILER_VC
+#		include <intrin.h>
+#		define GLM_TARGET(Name)
+#	else
+#		include <cpuid.h>
+#		include <immintrin.h>
+#		define GLM_TARGET(Name) __attribute__((target(Name)))
+#	endif
+#else
+#	define GLM_TARGET(Name)
+#endif//GLM_HAS_DISPATCH
+
+// The instruction sets of the AVX2 kernels, which every CPU with AVX2 has.
+#define GLM_TARGET_AVX2 GLM_TARGET("avx2,fma,f16c")
+
+namespace glm{
+namespace detail
+{
+	// The kernels the CPU runs well.
+	enum dispatch_feature
+	{
+		DISPATCH_NONE = 0,
+		DISPATCH_AVX2 = 1,	// AVX2, FMA and F16C, with the AVX registers saved by the OS
+		DISPATCH_BMI2 = 2	// pdep and pext, not microcoded
+	};
+
+#	if GLM_HAS_DISPATCH
+	inline void dispatch_cpuid(int Leaf, int Registers[4])
+	{
+#		if GLM_COMPILER & GLM_COMPILER_VC
+			__cpuidex(Registers, Leaf, 0);
+#		else
+			unsigned int a, b, c, d;
+			__cpuid_count(Leaf, 0, a, b, c, d);
+			Registers[0] = static_cast<int>(a);
+			Registers[1] = static_cast<int>(b);
+			Registers[2] = static_cast<int>(c);
+			Registers[3] = static_cast<int>(d);
+#		endif
+	}
+
+	inline int dispatch_detect()
+	{
+		int Registers[4];
+		dispatch_cpuid(0, Registers);
+		if(Registers[0] < 7)
+			return DISPATCH_NONE;
+		// "AuthenticAMD" and "HygonGenuine"
+		bool const AMD = Registers[1] == 0x68747541 || Registers[1] == 0x6f677948;
+
+		dispatch_cpuid(1, Registers);
+		int Family = (Registers[0] >> 8) & 0xf;
+		if(Family == 0xf)
+			Family += (Registers[0] >> 20) & 0xff;
+		bool const FMA = (Registers[2] & (1 << 12)) != 0;
+		bool const F16C = (Registers[2] & (1 << 29)) != 0;
+		bool YMM = false;
+		if((Registers[2] & (1 << 27)) && (Registers[2] & (1 << 28)))
+		{
+			// the OS saves the AVX registers
+#			if GLM_COMPILER & GLM_COMPILER_VC
+				YMM = (_xgetbv(0) & 6) == 6;
+#			else
+				unsigned int Low, High;
+				__asm__ __volatile__("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+				YMM = (Low & 6) == 6;
+#			endif
+		}
+
+		dispatch_cpuid(7, Registers);
+		int Features = DISPATCH_NONE;
+		if((Registers[1] & (1 << 5)) && FMA && F16C && YMM)
+			Features |= DISPATCH_AVX2;
+		// pdep and pext are microcoded before Zen 3, hundreds of cycles each
+		if((Registers[1] & (1 << 8)) && !(AMD && Family < 0x19))
+			Features |= DISPATCH_BMI2;
+		return Features;
+	}
+#	endif//GLM_HAS_DISPATCH
+
+	// The dispatch_feature flags of the CPU, detected on the first call. The kernels of the
+	// instruction sets GLM_ARCH includes run without asking.
+	inline int dispatch_features()
+	{
+#		if GLM_HAS_DISPATCH
+			static int const Features = dispatch_detect();
+			return Features;
+#		else
+			return DISPATCH_NONE;
+#		endif
+	}
+}//namespace detail
+}//namespace glm
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref core
+/// @file glm/detail/_fast_math.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// The approximations which GLM_FORCE_FAST_MATH puts behind sin, cos, exp and
+/// inversesqrt of the float vectors, evaluated in one SSE2 register.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "setup.hpp"
+#include "type_vec1.hpp"
+#include "type_vec2.hpp"
+#include "type_vec3.hpp"
+#include "type_vec4.hpp"
+#include <cmath>
+#include <limits>
+
+#if GLM_FAST_MATH
+namespace glm{
+namespace detail
+{
+	// The components of a float vector in the lanes of a register and back,
+	// whether the vector has the SSE2 layout or not. The lanes beyond the
+	// vector are zero.
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 load_sse2(tvec1<float, P> const & v)
+	{
+		return _mm_set_ss(v.x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 load_sse2(tvec2<float, P> const & v)
+	{
+		return _mm_setr_ps(v.x, v.y, 0.f, 0.f);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 load_sse2(tvec3<float, P> const & v)
+	{
+		return _mm_setr_ps(v.x, v.y, v.z, 0.f);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 load_sse2(tvec4<float, P> const & v)
+	{
+		return _mm_loadu_ps(&v.x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void store_sse2(__m128 Lanes, tvec1<float, P> & v)
+	{
+		v.x = _mm_cvtss_f32(Lanes);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void store_sse2(__m128 Lanes, tvec2<float, P> & v)
+	{
+		float Out[4];
+		_mm_storeu_ps(Out, Lanes);
+		v.x = Out[0];
+		v.y = Out[1];
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void store_sse2(__m128 Lanes, tvec3<float, P> & v)
+	{
+		float Out[4];
+		_mm_storeu_ps(Out, Lanes);
+		v.x = Out[0];
+		v.y = Out[1];
+		v.z = Out[2];
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void store_sse2(__m128 Lanes, tvec4<float, P> & v)
+	{
+		_mm_storeu_ps(&v.x, Lanes);
+	}
+
+	// sin(r) and cos(r) are polynomials of degree 7 and 8 on [-pi/4, pi/4] (the
+	// coefficients of the Cephes library). x is reduced to r = x - q pi/2 with
+	// pi/2 split in four parts: while |x| <= 8192, q has 13 bits and its
+	// products by the first three parts, of 11 bits at most, are exact. The
+	// other lanes, infinities and NaN included, go to std::sin and std::cos.
+	GLM_FUNC_QUALIFIER __m128 sincos_sse2(__m128 x, int Quadrant)
+	{
+		__m128i const q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772367581343f)));
+		__m128 const qf = _mm_cvtepi32_ps(q);
+		__m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(1.5703125f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(4.837512969970703125e-4f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(7.549533620476723e-8f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(2.5633440682570896e-12f)));
+		__m128 const r2 = _mm_mul_ps(r, r);
+
+		__m128 s = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)), _mm_set1_ps(8.3321608736e-3f));
+		s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+		__m128 c = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)), _mm_set1_ps(-1.388731625493765e-3f));
+		c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+		c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(c, r2), r2));
+
+		// cos(x) = sin(x + pi/2): the cosine starts a quadrant later
+		__m128i const Quadrants = _mm_add_epi32(q, _mm_set1_epi32(Quadrant));
+		__m128 const Odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(Quadrants, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		__m128 const Negate = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(Quadrants, _mm_set1_epi32(2)), 30));
+		__m128 Result = _mm_xor_ps(_mm_or_ps(_mm_and_ps(Odd, c), _mm_andnot_ps(Odd, s)), Negate);
+
+		int const InRange = _mm_movemask_ps(_mm_cmple_ps(_mm_andnot_ps(_mm_set1_ps(-0.f), x), _mm_set1_ps(8192.f)));
+		if(InRange != 0xF)
+		{
+			float In[4], Out[4];
+			_mm_storeu_ps(In, x);
+			_mm_storeu_ps(Out, Result);
+			for(int i = 0; i < 4; ++i)
+				if(!(InRange & (1 << i)))
+					Out[i] = Quadrant ? std::cos(In[i]) : std::sin(In[i]);
+			Result = _mm_loadu_ps(Out);
+		}
+		return Result;
+	}
+
+	// exp(x) = 2^n exp(r), n the integer nearest to x / ln(2) and r in
+	// [-ln(2)/2, ln(2)/2], where exp is a polynomial of degree 7 (Cephes).
+	// 2^n is applied in two halves so that the results between the largest
+	// float and the denormals overflow and underflow as std::exp does, the
+	// clamp only keeps the halves in the exponents of a float. NaN stays NaN.
+	GLM_FUNC_QUALIFIER __m128 exp_sse2(__m128 x)
+	{
+		x = _mm_max_ps(_mm_set1_ps(-104.f), _mm_min_ps(_mm_set1_ps(89.f), x));
+		__m128i const n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)));
+		__m128 const nf = _mm_cvtepi32_ps(n);
+		__m128 r = _mm_sub_ps(x, _mm_mul_ps(nf, _mm_set1_ps(0.693359375f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(nf, _mm_set1_ps(-2.12194440e-4f)));
+
+		__m128 p = _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(1.9875691500e-4f)), _mm_set1_ps(1.3981999507e-3f));
+		p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+		p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+		p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+		p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+		p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, r), r), r), _mm_set1_ps(1.f));
+
+		__m128i const n1 = _mm_srai_epi32(n, 1);
+		__m128i const n2 = _mm_sub_epi32(n, n1);
+		__m128 const Scale1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n1, _mm_set1_epi32(127)), 23));
+		__m128 const Scale2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n2, _mm_set1_epi32(127)), 23));
+		return _mm_mul_ps(_mm_mul_ps(p, Scale1), Scale2);
+	}
+
+	// The estimate of rsqrtps, good to 12 bits, and one Newton-Raphson step.
+	// Zero, the infinities and the denormals, which rsqrtps takes as zero, keep
+	// the estimate: +/-inf for zero, 0 for infinity.
+	GLM_FUNC_QUALIFIER __m128 inversesqrt_sse2(__m128 x)
+	{
+		__m128 const y = _mm_rsqrt_ps(x);
+		__m128 const Step = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(y, y))));
+		__m128 const Normal = _mm_and_ps(
+			_mm_cmpge_ps(x, _mm_set1_ps(std::numeric_limits<float>::min())),
+			_mm_cmplt_ps(x, _mm_set1_ps(std::numeric_limits<float>::infinity())));
+		return _mm_or_ps(_mm_and_ps(Normal, Step), _mm_andnot_ps(Normal, y));
+	}
+}//namespace detail
+}//namespace glm
+#endif//GLM_FAST_MATH
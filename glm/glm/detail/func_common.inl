@@ -113,6 +113,76 @@ namespace detail
 		}
 	};
 
+	// x + a * (y - x), rounded as the scalar code does. With FMA, at lowp and
+	// mediump, the multiply and the add are fused instead.
+#	if GLM_HAS_ANONYMOUS_UNION && GLM_NOT_BUGGY_VC32BITS && (GLM_ARCH & GLM_ARCH_SSE2)
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 mix_sse2(__m128 x, __m128 y, __m128 a)
+	{
+#		if GLM_HAS_FMA
+			if(P != highp)
+				return _mm_fmadd_ps(a, _mm_sub_ps(y, x), x);
+#		endif
+		return _mm_add_ps(x, _mm_mul_ps(a, _mm_sub_ps(y, x)));
+	}
+
+	template <precision P>
+	struct compute_mix_vector<float, float, P, tvec4>
+	{
+		GLM_FUNC_QUALIFIER static tvec4<float, P> call(tvec4<float, P> const & x, tvec4<float, P> const & y, tvec4<float, P> const & a)
+		{
+			tvec4<float, P> Result(uninitialize);
+			Result.data = mix_sse2<P>(x.data, y.data, a.data);
+			return Result;
+		}
+	};
+
+	template <precision P>
+	struct compute_mix_scalar<float, float, P, tvec4>
+	{
+		GLM_FUNC_QUALIFIER static tvec4<float, P> call(tvec4<float, P> const & x, tvec4<float, P> const & y, float const & a)
+		{
+			tvec4<float, P> Result(uninitialize);
+			Result.data = mix_sse2<P>(x.data, y.data, _mm_set1_ps(a));
+			return Result;
+		}
+	};
+#	endif
+
+#	if GLM_HAS_ANONYMOUS_UNION && GLM_NOT_BUGGY_VC32BITS && (GLM_ARCH & GLM_ARCH_AVX)
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m256d mix_avx(__m256d x, __m256d y, __m256d a)
+	{
+#		if GLM_HAS_FMA
+			if(P != highp)
+				return _mm256_fmadd_pd(a, _mm256_sub_pd(y, x), x);
+#		endif
+		return _mm256_add_pd(x, _mm256_mul_pd(a, _mm256_sub_pd(y, x)));
+	}
+
+	template <precision P>
+	struct compute_mix_vector<double, double, P, tvec4>
+	{
+		GLM_FUNC_QUALIFIER static tvec4<double, P> call(tvec4<double, P> const & x, tvec4<double, P> const & y, tvec4<double, P> const & a)
+		{
+			tvec4<double, P> Result(uninitialize);
+			Result.data = mix_avx<P>(x.data, y.data, a.data);
+			return Result;
+		}
+	};
+
+	template <precision P>
+	struct compute_mix_scalar<double, double, P, tvec4>
+	{
+		GLM_FUNC_QUALIFIER static tvec4<double, P> call(tvec4<double, P> const & x, tvec4<double, P> const & y, double const & a)
+		{
+			tvec4<double, P> Result(uninitialize);
+			Result.data = mix_avx<P>(x.data, y.data, _mm256_set1_pd(a));
+			return Result;
+		}
+	};
+#	endif
+
 	template <typename T, typename U>
 	struct compute_mix
 	{
@@ -62,6 +62,8 @@ namespace glm
 	GLM_FUNC_DECL vecType<T, P> pow(vecType<T, P> const & base, vecType<T, P> const & exponent);
 
 	/// Returns the natural exponentiation of x, i.e., e^x.
+	/// With GLM_FORCE_FAST_MATH and SSE2, the exponential of the components of
+	/// a float vector is approximated within 2 ULP where it is a normal float.
 	///
 	/// @param v exp function is defined for input values of v defined in the range (inf-, inf+) in the limit of the type precision.
 	/// @tparam genType Floating-point scalar or vector types.
@@ -117,6 +119,8 @@ namespace glm
 	GLM_FUNC_DECL vecType<T, P> sqrt(vecType<T, P> const & v);
 	
 	/// Returns the reciprocal of the positive square root of v.
+	/// With GLM_FORCE_FAST_MATH and SSE2, the reciprocal square root of a
+	/// float is approximated within 5 ULP, with the denormals taken as zero.
 	/// 
 	/// @param v inversesqrt function is defined for input values of v defined in the range [0, inf+) in the limit of the type precision.
 	/// @tparam genType Floating-point scalar or vector types.
@@ -32,6 +32,7 @@
 
 #include "func_vector_relational.hpp"
 #include "_vectorize.hpp"
+#include "_fast_math.hpp"
 #include <limits>
 #include <cmath>
 #include <cassert>
@@ -66,7 +67,10 @@ namespace detail
 			return static_cast<T>(1) / sqrt(x);
 		}
 	};
-		
+
+	// With GLM_FORCE_FAST_MATH, lowp takes the approximation of the other
+	// precisions, which is both faster and closer.
+#	if !GLM_FAST_MATH
 	template <template <class, precision> class vecType>
 	struct compute_inversesqrt<vecType, float, lowp>
 	{
@@ -82,6 +86,40 @@ namespace detail
 			return tmp;
 		}
 	};
+#	endif//!GLM_FAST_MATH
+
+	template <template <class, precision> class vecType, typename T, precision P>
+	struct compute_exp
+	{
+		GLM_FUNC_QUALIFIER static vecType<T, P> call(vecType<T, P> const & x)
+		{
+			return detail::functor1<T, T, P, vecType>::call(std::exp, x);
+		}
+	};
+
+#	if GLM_FAST_MATH
+	template <template <class, precision> class vecType, precision P>
+	struct compute_exp<vecType, float, P>
+	{
+		GLM_FUNC_QUALIFIER static vecType<float, P> call(vecType<float, P> const & x)
+		{
+			vecType<float, P> Result(uninitialize);
+			store_sse2(exp_sse2(load_sse2(x)), Result);
+			return Result;
+		}
+	};
+
+	template <template <class, precision> class vecType, precision P>
+	struct compute_inversesqrt<vecType, float, P>
+	{
+		GLM_FUNC_QUALIFIER static vecType<float, P> call(vecType<float, P> const & x)
+		{
+			vecType<float, P> Result(uninitialize);
+			store_sse2(inversesqrt_sse2(load_sse2(x)), Result);
+			return Result;
+		}
+	};
+#	endif//GLM_FAST_MATH
 }//namespace detail
 
 	// pow
@@ -94,10 +132,11 @@ namespace detail
 
 	// exp
 	using std::exp;
+
 	template <typename T, precision P, template <typename, precision> class vecType>
 	GLM_FUNC_QUALIFIER vecType<T, P> exp(vecType<T, P> const & x)
 	{
-		return detail::functor1<T, T, P, vecType>::call(exp, x);
+		return detail::compute_exp<vecType, T, P>::call(x);
 	}
 
 	// log
@@ -149,7 +188,11 @@ namespace detail
 	template <typename genType>
 	GLM_FUNC_QUALIFIER genType inversesqrt(genType x)
 	{
-		return static_cast<genType>(1) / sqrt(x);
+#		if GLM_FAST_MATH
+			return inversesqrt(tvec1<genType>(x)).x;
+#		else
+			return static_cast<genType>(1) / sqrt(x);
+#		endif
 	}
 	
 	template <typename T, precision P, template <typename, precision> class vecType>
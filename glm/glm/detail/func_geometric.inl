@@ -80,6 +80,49 @@ namespace detail
 			return (tmp.x + tmp.y) + (tmp.z + tmp.w);
 		}
 	};
+
+	// The products are summed in the order of the scalar code. With FMA, at
+	// lowp and mediump, each odd product is fused into the add of its pair
+	// instead, which rounds once less.
+#	if GLM_HAS_ANONYMOUS_UNION && GLM_NOT_BUGGY_VC32BITS && (GLM_ARCH & GLM_ARCH_SSE2)
+	template <precision P>
+	struct compute_dot<tvec4, float, P>
+	{
+		GLM_FUNC_QUALIFIER static float call(tvec4<float, P> const & x, tvec4<float, P> const & y)
+		{
+			__m128 const xy = _mm_mul_ps(x.data, y.data);
+			__m128 pairs; // x0 * y0 + x1 * y1 in lane 0, x2 * y2 + x3 * y3 in lane 2
+#			if GLM_HAS_FMA
+			if(P != highp)
+				pairs = _mm_fmadd_ps(
+					_mm_shuffle_ps(x.data, x.data, _MM_SHUFFLE(2, 3, 0, 1)),
+					_mm_shuffle_ps(y.data, y.data, _MM_SHUFFLE(2, 3, 0, 1)), xy);
+			else
+#			endif
+				pairs = _mm_add_ps(xy, _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+		}
+	};
+#	endif
+
+#	if GLM_HAS_ANONYMOUS_UNION && GLM_NOT_BUGGY_VC32BITS && (GLM_ARCH & GLM_ARCH_AVX)
+	template <precision P>
+	struct compute_dot<tvec4, double, P>
+	{
+		GLM_FUNC_QUALIFIER static double call(tvec4<double, P> const & x, tvec4<double, P> const & y)
+		{
+			__m256d const xy = _mm256_mul_pd(x.data, y.data);
+			__m256d pairs; // x0 * y0 + x1 * y1 in lane 0, x2 * y2 + x3 * y3 in lane 2
+#			if GLM_HAS_FMA
+			if(P != highp)
+				pairs = _mm256_fmadd_pd(_mm256_permute_pd(x.data, 0x5), _mm256_permute_pd(y.data, 0x5), xy);
+			else
+#			endif
+				pairs = _mm256_hadd_pd(xy, xy);
+			return _mm_cvtsd_f64(_mm_add_sd(_mm256_castpd256_pd128(pairs), _mm256_extractf128_pd(pairs, 1)));
+		}
+	};
+#	endif
 }//namespace detail
 
 	// length
@@ -71,6 +71,9 @@ namespace glm
 
 	/// The standard trigonometric sine function. 
 	/// The values returned by this function will range from [-1, 1].
+	/// With GLM_FORCE_FAST_MATH and SSE2, the sine of the components of a float
+	/// vector is approximated within 2 ULP for |angle| <= 2 pi and 3 ULP up to
+	/// 8192, beyond which std::sin is called.
 	/// 
 	/// @tparam genType Floating-point scalar or vector types.
 	///
@@ -81,6 +84,8 @@ namespace glm
 
 	/// The standard trigonometric cosine function. 
 	/// The values returned by this function will range from [-1, 1].
+	/// With GLM_FORCE_FAST_MATH and SSE2, the cosine of the components of a
+	/// float vector is approximated as the sine is.
 	/// 
 	/// @tparam genType Floating-point scalar or vector types.
 	///
@@ -31,11 +31,56 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include "_vectorize.hpp"
+#include "_fast_math.hpp"
 #include <cmath>
 #include <limits>
 
-namespace glm
+namespace glm{
+namespace detail
 {
+	template <template <class, precision> class vecType, typename T, precision P>
+	struct compute_sin
+	{
+		GLM_FUNC_QUALIFIER static vecType<T, P> call(vecType<T, P> const & v)
+		{
+			return detail::functor1<T, T, P, vecType>::call(std::sin, v);
+		}
+	};
+
+	template <template <class, precision> class vecType, typename T, precision P>
+	struct compute_cos
+	{
+		GLM_FUNC_QUALIFIER static vecType<T, P> call(vecType<T, P> const & v)
+		{
+			return detail::functor1<T, T, P, vecType>::call(std::cos, v);
+		}
+	};
+
+#	if GLM_FAST_MATH
+	template <template <class, precision> class vecType, precision P>
+	struct compute_sin<vecType, float, P>
+	{
+		GLM_FUNC_QUALIFIER static vecType<float, P> call(vecType<float, P> const & v)
+		{
+			vecType<float, P> Result(uninitialize);
+			store_sse2(sincos_sse2(load_sse2(v), 0), Result);
+			return Result;
+		}
+	};
+
+	template <template <class, precision> class vecType, precision P>
+	struct compute_cos<vecType, float, P>
+	{
+		GLM_FUNC_QUALIFIER static vecType<float, P> call(vecType<float, P> const & v)
+		{
+			vecType<float, P> Result(uninitialize);
+			store_sse2(sincos_sse2(load_sse2(v), 1), Result);
+			return Result;
+		}
+	};
+#	endif//GLM_FAST_MATH
+}//namespace detail
+
 	// radians
 	template <typename genType>
 	GLM_FUNC_QUALIFIER genType radians(genType degrees)
@@ -72,7 +117,7 @@ namespace glm
 	template <typename T, precision P, template <typename, precision> class vecType>
 	GLM_FUNC_QUALIFIER vecType<T, P> sin(vecType<T, P> const & v)
 	{
-		return detail::functor1<T, T, P, vecType>::call(sin, v);
+		return detail::compute_sin<vecType, T, P>::call(v);
 	}
 
 	// cos
@@ -81,7 +126,7 @@ namespace glm
 	template <typename T, precision P, template <typename, precision> class vecType>
 	GLM_FUNC_QUALIFIER vecType<T, P> cos(vecType<T, P> const & v)
 	{
-		return detail::functor1<T, T, P, vecType>::call(cos, v);
+		return detail::compute_cos<vecType, T, P>::call(v);
 	}
 
 	// tan
@@ -545,6 +545,15 @@
 #	define GLM_HAS_CONSTEXPR_PARTIAL GLM_HAS_CONSTEXPR || ((GLM_COMPILER & GLM_COMPILER_VC) && (GLM_COMPILER >= GLM_COMPILER_VC2015))
 #endif
 
+// N3652
+#if GLM_COMPILER & (GLM_COMPILER_LLVM | GLM_COMPILER_APPLE_CLANG)
+#	define GLM_HAS_CONSTEXPR_CXX14 __has_feature(cxx_relaxed_constexpr)
+#elif GLM_LANG & GLM_LANG_CXX14_FLAG
+#	define GLM_HAS_CONSTEXPR_CXX14 ((GLM_COMPILER & GLM_COMPILER_GCC) && (__GNUC__ >= 5))
+#else
+#	define GLM_HAS_CONSTEXPR_CXX14 0
+#endif
+
 // N2672
 #if GLM_COMPILER & (GLM_COMPILER_LLVM | GLM_COMPILER_APPLE_CLANG)
 #	define GLM_HAS_INITIALIZER_LISTS __has_feature(cxx_generalized_initializers)
@@ -644,6 +653,17 @@
 		((GLM_COMPILER & GLM_COMPILER_VC) && (GLM_COMPILER >= GLM_COMPILER_VC2013)))
 #endif
 
+// 
+#if GLM_COMPILER & GLM_COMPILER_CLANG
+#	define GLM_HAS_THREAD_LOCAL __has_feature(cxx_thread_local)
+#elif GLM_LANG & GLM_LANG_CXX11_FLAG
+#	define GLM_HAS_THREAD_LOCAL 1
+#else
+#	define GLM_HAS_THREAD_LOCAL (GLM_LANG & GLM_LANG_CXX0X_FLAG) && (\
+		((GLM_COMPILER & GLM_COMPILER_VC) && (GLM_COMPILER >= GLM_COMPILER_VC2015)) || \
+		((GLM_COMPILER & GLM_COMPILER_GCC) && (GLM_COMPILER >= GLM_COMPILER_GCC48)))
+#endif
+
 // 
 #if GLM_ARCH == GLM_ARCH_PURE
 #	define GLM_HAS_BITSCAN_WINDOWS 0
@@ -772,6 +792,44 @@
 #	endif
 #endif//GLM_ARCH
 
+// Every AVX2 processor has FMA3, but GCC and Clang only expose the intrinsics with -mfma
+#if (GLM_ARCH & GLM_ARCH_AVX2) && (defined(__FMA__) || (GLM_COMPILER & GLM_COMPILER_VC))
+#	define GLM_HAS_FMA 1
+#else
+#	define GLM_HAS_FMA 0
+#endif
+
+// F16C, the half conversions of the CPUs with AVX2. GCC and Clang only expose them with -mf16c,
+// Visual C++ with /arch:AVX2.
+#if (GLM_ARCH != GLM_ARCH_PURE) && (defined(__F16C__) || ((GLM_COMPILER & GLM_COMPILER_VC) && (GLM_ARCH & GLM_ARCH_AVX2)))
+#	define GLM_HAS_F16C 1
+#	include <immintrin.h>
+#else
+#	define GLM_HAS_F16C 0
+#endif
+
+// The half conversions of ARM, with the __fp16 type of GCC and Clang: AArch64, or ARMv7 with
+// the fp16 FPU extension and -mfp16-format=ieee. GLM_ARCH is pure on ARM with these compilers.
+#if !defined(GLM_FORCE_PURE) && defined(__ARM_FP16_FORMAT_IEEE) && defined(__ARM_FP) && (__ARM_FP & 2)
+#	define GLM_HAS_ARM_FP16 1
+#else
+#	define GLM_HAS_ARM_FP16 0
+#endif
+
+// User defines: GLM_FORCE_NO_DISPATCH
+
+// Run-time dispatch: on x86-64, a few batch functions carry kernels for instruction sets
+// GLM_ARCH does not include, compiled with the target attribute on GCC and Clang, and pick
+// them by what the CPU supports (see detail/_dispatch.hpp).
+#if (GLM_ARCH != GLM_ARCH_PURE) && !defined(GLM_FORCE_NO_DISPATCH) && (defined(__x86_64__) || defined(_M_X64)) && ( \
+	((GLM_COMPILER & GLM_COMPILER_VC) && (GLM_COMPILER >= GLM_COMPILER_VC2013)) || \
+	((GLM_COMPILER & GLM_COMPILER_GCC) && (GLM_COMPILER >= GLM_COMPILER_GCC49)) || \
+	(GLM_COMPILER & (GLM_COMPILER_LLVM | GLM_COMPILER_APPLE_CLANG)))
+#	define GLM_HAS_DISPATCH 1
+#else
+#	define GLM_HAS_DISPATCH 0
+#endif
+
 #if defined(GLM_MESSAGES) && !defined(GLM_MESSAGE_ARCH_DISPLAYED)
 #	define GLM_MESSAGE_ARCH_DISPLAYED
 #	if(GLM_ARCH == GLM_ARCH_PURE)
@@ -789,6 +847,30 @@
 #	endif//GLM_ARCH
 #endif//GLM_MESSAGE
 
+///////////////////////////////////////////////////////////////////////////////////
+// Fast math
+
+// User defines: GLM_FORCE_FAST_MATH
+
+// With SSE2, sin, cos and exp of the float vectors are approximated with
+// polynomials in one register, and inversesqrt of the float scalars and vectors,
+// normalize included, with rsqrtps and a Newton-Raphson step. The functions
+// document their error bounds. Scalar sin, cos and exp keep the C library, as
+// fast as one lane, and without SSE2 the define has no effect.
+
+#if defined(GLM_FORCE_FAST_MATH) && (GLM_ARCH & GLM_ARCH_SSE2)
+#	define GLM_FAST_MATH 1
+#else
+#	define GLM_FAST_MATH 0
+#endif
+
+#if defined(GLM_MESSAGES) && !defined(GLM_MESSAGE_FAST_MATH_DISPLAYED)
+#	define GLM_MESSAGE_FAST_MATH_DISPLAYED
+#	if GLM_FAST_MATH
+#		pragma message("GLM: Approximated sin, cos, exp and inversesqrt for float")
+#	endif
+#endif//GLM_MESSAGE
+
 ///////////////////////////////////////////////////////////////////////////////////
 // Static assert
 
@@ -885,6 +967,27 @@
 #	define GLM_CONSTEXPR
 #endif
 
+// The constructors and operators of the vectors and of tmat4x4 assign their
+// components one at a time, which constant expressions allow from C++14
+#if GLM_HAS_CONSTEXPR_CXX14
+#	define GLM_CONSTEXPR_CXX14 constexpr
+#else
+#	define GLM_CONSTEXPR_CXX14
+#endif
+
+// Whether a GLM_CONSTEXPR_CXX14 function is evaluated in a constant
+// expression, where it may not take the faster runtime paths (indexing the
+// components through a pointer). Without the builtin, C++14 always takes the
+// constant expression paths.
+#if GLM_HAS_CONSTEXPR_CXX14 && defined(__has_builtin)
+#	if __has_builtin(__builtin_is_constant_evaluated)
+#		define GLM_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#	endif
+#endif
+#ifndef GLM_CONSTANT_EVALUATED
+#	define GLM_CONSTANT_EVALUATED() GLM_HAS_CONSTEXPR_CXX14
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////
 // Length type
 
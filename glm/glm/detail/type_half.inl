@@ -64,7 +64,7 @@ namespace detail
 		uint32 i;
 	};
 
-	GLM_FUNC_QUALIFIER float toFloat32(hdata value)
+	GLM_FUNC_QUALIFIER float toFloat32_soft(hdata value)
 	{
 		int s = (value >> 15) & 0x00000001;
 		int e = (value >> 10) & 0x0000001f;
@@ -138,7 +138,7 @@ namespace detail
 		return Result.f;
 	}
 
-	GLM_FUNC_QUALIFIER hdata toFloat16(float const & f)
+	GLM_FUNC_QUALIFIER hdata toFloat16_soft(float const & f)
 	{
 		uif32 Entry;
 		Entry.f = f;
@@ -273,5 +273,61 @@ namespace detail
 		}
 	}
 
+#	if GLM_HAS_F16C || GLM_HAS_ARM_FP16
+	// The conversions of the CPU, exact but for NaNs: they quiet the signaling ones.
+	GLM_FUNC_QUALIFIER float toFloat32_hardware(hdata value)
+	{
+#		if GLM_HAS_F16C
+			return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(value & 0xffff)));
+#		else
+			union { hdata i; __fp16 h; } Half;
+			Half.i = value;
+			return Half.h;
+#		endif
+	}
+
+	// Rounds to nearest, ties to even as IEEE 754.
+	GLM_FUNC_QUALIFIER hdata toFloat16_hardware(float f)
+	{
+#		if GLM_HAS_F16C
+			return hdata(_mm_cvtsi128_si32(_mm_cvtps_ph(_mm_set_ss(f), _MM_FROUND_TO_NEAREST_INT)));
+#		else
+			union { hdata i; __fp16 h; } Half;
+			Half.h = static_cast<__fp16>(f);
+			return Half.i;
+#		endif
+	}
+#	endif//GLM_HAS_F16C || GLM_HAS_ARM_FP16
+
+	GLM_FUNC_QUALIFIER float toFloat32(hdata value)
+	{
+#		if GLM_HAS_F16C || GLM_HAS_ARM_FP16
+			// NaNs keep their bits the long way
+			if((value & 0x7c00) != 0x7c00 || (value & 0x03ff) == 0)
+				return toFloat32_hardware(value);
+#		endif
+		return toFloat32_soft(value);
+	}
+
+	GLM_FUNC_QUALIFIER hdata toFloat16(float const & f)
+	{
+#		if GLM_HAS_F16C || GLM_HAS_ARM_FP16
+			if(f == f)
+			{
+				// The CPU rounds ties to even, toFloat16_soft away from zero: a tie whose
+				// lower half is even takes the next one. Shift is the number of bits of
+				// the significand a half drops, more for the denormalized halfs. From
+				// 65536 up both give infinity.
+				uif32 const Bits(f);
+				uint32 const Exponent = (Bits.i >> 23) & 0xff;
+				uint32 const Shift = Exponent >= 113 ? 13 : Exponent >= 102 ? 126 - Exponent : 25;
+				uint32 const Significand = (Bits.i & 0x007fffff) | 0x00800000;
+				bool const Tie = (Exponent < 143) & ((Significand & ((2u << Shift) - 1)) == (1u << (Shift - 1)));
+				return hdata(toFloat16_hardware(f) + Tie);
+			}
+#		endif
+		return toFloat16_soft(f);
+	}
+
 }//namespace detail
 }//namespace glm
@@ -33,9 +33,203 @@
 namespace glm{
 namespace detail
 {
-
+	// The four components of a tvec4<double> share one __m256d. Every lane
+	// is rounded exactly as the scalar code does, so these paths are used
+	// at all precisions.
+	template <precision P>
+	GLM_FUNC_QUALIFIER tvec4<double, P> dvec4_avx(__m256d data)
+	{
+		tvec4<double, P> Result(uninitialize);
+		Result.data = data;
+		return Result;
+	}
 }//namespace detail
 
-	
+#	define GLM_DVEC4_AVX(P) \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P>::tvec4() \
+		GLM_DVEC4_AVX_CTOR_INIT \
+	{} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P>::tvec4(tvec4<double, P> const & v) : \
+		data(v.data) \
+	{} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P>::tvec4(double s) : \
+		data(_mm256_set1_pd(s)) \
+	{} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P>::tvec4(double a, double b, double c, double d) : \
+		data(_mm256_set_pd(d, c, b, a)) \
+	{} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator+=<double>(double scalar) \
+	{ \
+		this->data = _mm256_add_pd(this->data, _mm256_set1_pd(scalar)); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator+=<double>(tvec4<double, P> const & v) \
+	{ \
+		this->data = _mm256_add_pd(this->data, v.data); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator-=<double>(double scalar) \
+	{ \
+		this->data = _mm256_sub_pd(this->data, _mm256_set1_pd(scalar)); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator-=<double>(tvec4<double, P> const & v) \
+	{ \
+		this->data = _mm256_sub_pd(this->data, v.data); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator*=<double>(double scalar) \
+	{ \
+		this->data = _mm256_mul_pd(this->data, _mm256_set1_pd(scalar)); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator*=<double>(tvec4<double, P> const & v) \
+	{ \
+		this->data = _mm256_mul_pd(this->data, v.data); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator/=<double>(double scalar) \
+	{ \
+		this->data = _mm256_div_pd(this->data, _mm256_set1_pd(scalar)); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> & tvec4<double, P>::operator/=<double>(tvec4<double, P> const & v) \
+	{ \
+		this->data = _mm256_div_pd(this->data, v.data); \
+		return *this; \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER bool operator==(tvec4<double, P> const & v1, tvec4<double, P> const & v2) \
+	{ \
+		return _mm256_movemask_pd(_mm256_cmp_pd(v1.data, v2.data, _CMP_EQ_OQ)) == 0xF; \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER bool operator!=(tvec4<double, P> const & v1, tvec4<double, P> const & v2) \
+	{ \
+		return _mm256_movemask_pd(_mm256_cmp_pd(v1.data, v2.data, _CMP_NEQ_UQ)) != 0; \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator+(tvec4<double, P> const & v, double scalar) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_add_pd(v.data, _mm256_set1_pd(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator+(double scalar, tvec4<double, P> const & v) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_add_pd(_mm256_set1_pd(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator+(tvec4<double, P> const & v1, tvec4<double, P> const & v2) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_add_pd(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator-(tvec4<double, P> const & v, double scalar) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_sub_pd(v.data, _mm256_set1_pd(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator-(double scalar, tvec4<double, P> const & v) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_sub_pd(_mm256_set1_pd(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator-(tvec4<double, P> const & v1, tvec4<double, P> const & v2) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_sub_pd(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator*(tvec4<double, P> const & v, double scalar) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_mul_pd(v.data, _mm256_set1_pd(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator*(double scalar, tvec4<double, P> const & v) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_mul_pd(_mm256_set1_pd(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator*(tvec4<double, P> const & v1, tvec4<double, P> const & v2) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_mul_pd(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator/(tvec4<double, P> const & v, double scalar) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_div_pd(v.data, _mm256_set1_pd(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator/(double scalar, tvec4<double, P> const & v) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_div_pd(_mm256_set1_pd(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator/(tvec4<double, P> const & v1, tvec4<double, P> const & v2) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_div_pd(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<double, P> operator-(tvec4<double, P> const & v) \
+	{ \
+		return detail::dvec4_avx<P>(_mm256_xor_pd(v.data, _mm256_set1_pd(-0.0))); \
+	}
+
+#	ifndef GLM_FORCE_NO_CTOR_INIT
+#		define GLM_DVEC4_AVX_CTOR_INIT : data(_mm256_setzero_pd())
+#	else
+#		define GLM_DVEC4_AVX_CTOR_INIT
+#	endif
+
+	GLM_DVEC4_AVX(lowp)
+	GLM_DVEC4_AVX(mediump)
+	GLM_DVEC4_AVX(highp)
 
+#	undef GLM_DVEC4_AVX_CTOR_INIT
+#	undef GLM_DVEC4_AVX
 }//namespace glm
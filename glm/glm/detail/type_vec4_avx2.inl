@@ -33,9 +33,91 @@
 namespace glm{
 namespace detail
 {
-
+	// The four components of a tvec4<int64> or tvec4<uint64> share one __m256i.
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER tvec4<T, P> i64vec4_avx2(__m256i data)
+	{
+		tvec4<T, P> Result(uninitialize);
+		Result.data = data;
+		return Result;
+	}
 }//namespace detail
 
-	
+#	define GLM_I64VEC4_AVX2(T, P) \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P>::tvec4(tvec4<T, P> const & v) : \
+		data(v.data) \
+	{} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P>::tvec4(T s) : \
+		data(_mm256_set1_epi64x(static_cast<long long>(s))) \
+	{} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> & tvec4<T, P>::operator+=<T>(tvec4<T, P> const & v) \
+	{ \
+		this->data = _mm256_add_epi64(this->data, v.data); \
+		return *this; \
+	} \
+	\
+	template <> \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> & tvec4<T, P>::operator-=<T>(tvec4<T, P> const & v) \
+	{ \
+		this->data = _mm256_sub_epi64(this->data, v.data); \
+		return *this; \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER bool operator==(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return _mm256_movemask_epi8(_mm256_cmpeq_epi64(v1.data, v2.data)) == -1; \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER bool operator!=(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return _mm256_movemask_epi8(_mm256_cmpeq_epi64(v1.data, v2.data)) != -1; \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> operator+(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return detail::i64vec4_avx2<T, P>(_mm256_add_epi64(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> operator-(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return detail::i64vec4_avx2<T, P>(_mm256_sub_epi64(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> operator&(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return detail::i64vec4_avx2<T, P>(_mm256_and_si256(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> operator|(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return detail::i64vec4_avx2<T, P>(_mm256_or_si256(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<T, P> operator^(tvec4<T, P> const & v1, tvec4<T, P> const & v2) \
+	{ \
+		return detail::i64vec4_avx2<T, P>(_mm256_xor_si256(v1.data, v2.data)); \
+	}
+
+	GLM_I64VEC4_AVX2(int64, lowp)
+	GLM_I64VEC4_AVX2(int64, mediump)
+	GLM_I64VEC4_AVX2(int64, highp)
+	GLM_I64VEC4_AVX2(uint64, lowp)
+	GLM_I64VEC4_AVX2(uint64, mediump)
+	GLM_I64VEC4_AVX2(uint64, highp)
 
+#	undef GLM_I64VEC4_AVX2
 }//namespace glm
@@ -33,7 +33,13 @@
 namespace glm{
 namespace detail
 {
-
+	template <precision P>
+	GLM_FUNC_QUALIFIER tvec4<float, P> vec4_sse2(__m128 data)
+	{
+		tvec4<float, P> Result(uninitialize);
+		Result.data = data;
+		return Result;
+	}
 }//namespace detail
 
 	template <>
@@ -117,4 +123,85 @@ namespace detail
 		this->data = _mm_add_ps(this->data, _mm_set_ps1(static_cast<float>(v.x)));
 		return *this;
 	}
+
+	// Each lane is rounded as the scalar code does, so the binary operators
+	// take these paths at all precisions.
+#	define GLM_VEC4_SSE2_OPERATORS(P) \
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator+(tvec4<float, P> const & v, float scalar) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_add_ps(v.data, _mm_set1_ps(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator+(float scalar, tvec4<float, P> const & v) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_add_ps(_mm_set1_ps(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator+(tvec4<float, P> const & v1, tvec4<float, P> const & v2) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_add_ps(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator-(tvec4<float, P> const & v, float scalar) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_sub_ps(v.data, _mm_set1_ps(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator-(float scalar, tvec4<float, P> const & v) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_sub_ps(_mm_set1_ps(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator-(tvec4<float, P> const & v1, tvec4<float, P> const & v2) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_sub_ps(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator*(tvec4<float, P> const & v, float scalar) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_mul_ps(v.data, _mm_set1_ps(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator*(float scalar, tvec4<float, P> const & v) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_mul_ps(_mm_set1_ps(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator*(tvec4<float, P> const & v1, tvec4<float, P> const & v2) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_mul_ps(v1.data, v2.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator/(tvec4<float, P> const & v, float scalar) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_div_ps(v.data, _mm_set1_ps(scalar))); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator/(float scalar, tvec4<float, P> const & v) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_div_ps(_mm_set1_ps(scalar), v.data)); \
+	} \
+	\
+	template <> \
+	GLM_FUNC_QUALIFIER tvec4<float, P> operator/(tvec4<float, P> const & v1, tvec4<float, P> const & v2) \
+	{ \
+		return detail::vec4_sse2<P>(_mm_div_ps(v1.data, v2.data)); \
+	}
+
+	GLM_VEC4_SSE2_OPERATORS(lowp)
+	GLM_VEC4_SSE2_OPERATORS(mediump)
+	GLM_VEC4_SSE2_OPERATORS(highp)
+
+#	undef GLM_VEC4_SSE2_OPERATORS
 }//namespace glm
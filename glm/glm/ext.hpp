@@ -127,6 +127,12 @@
 #include "./gtx/type_aligned.hpp"
 #include "./gtx/vector_angle.hpp"
 #include "./gtx/vector_query.hpp"
+#include "./gtx/wide.hpp"
+#include "./gtx/wide_intersect.hpp"
+#include "./gtx/wide_noise.hpp"
+#include "./gtx/wide_packing.hpp"
+#include "./gtx/wide_quaternion.hpp"
+#include "./gtx/wide_random.hpp"
 #include "./gtx/wrap.hpp"
 
 #if GLM_HAS_TEMPLATE_ALIASES
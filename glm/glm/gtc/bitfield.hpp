@@ -46,8 +46,11 @@
 #include "../detail/setup.hpp"
 #include "../detail/precision.hpp"
 #include "../detail/type_int.hpp"
+#include "../detail/type_vec3.hpp"
 #include "../detail/_vectorize.hpp"
+#include "../detail/_dispatch.hpp"
 #include <limits>
+#include <cstddef>
 
 #if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
 #	pragma message("GLM: GLM_GTC_bitfield extension included")
@@ -230,6 +233,65 @@ namespace glm
 	/// @see gtc_bitfield
 	GLM_FUNC_DECL uint64 bitfieldInterleave(uint16 x, uint16 y, uint16 z, uint16 w);
 
+	/// Interleaves the bits of the components of each of the count vectors of in
+	/// and writes the codes to out, with the same results as bitfieldInterleave(x, y, z):
+	/// the Morton codes of e.g. quantized positions, to sort or hash them by.
+	/// On x86-64 the CPU is checked at run time: it encodes with BMI2 pdep when it is fast,
+	/// else 16 vectors at a time with AVX2, else one at a time as bitfieldInterleave.
+	///
+	/// @see gtc_bitfield
+	/// @see void bitfieldDeinterleave(uint32 const * in, tvec3<uint8, P> * out, std::size_t count)
+	template <precision P>
+	GLM_FUNC_DECL void bitfieldInterleave(tvec3<uint8, P> const * in, uint32 * out, std::size_t count);
+
+	/// Interleaves the bits of the components of each of the count vectors of in
+	/// and writes the 48-bit codes to out, with the same results as bitfieldInterleave(x, y, z).
+	/// On x86-64 the CPU is checked at run time: it encodes with BMI2 pdep when it is fast,
+	/// else 8 vectors at a time with AVX2, else one at a time as bitfieldInterleave.
+	///
+	/// @see gtc_bitfield
+	/// @see void bitfieldDeinterleave(uint64 const * in, tvec3<uint16, P> * out, std::size_t count)
+	template <precision P>
+	GLM_FUNC_DECL void bitfieldInterleave(tvec3<uint16, P> const * in, uint64 * out, std::size_t count);
+
+	/// Interleaves the low 21 bits of the components of each of the count vectors of in
+	/// and writes the 63-bit codes to out, with the same results as bitfieldInterleave(x, y, z)
+	/// for components below 2^21, whose higher bits are ignored.
+	/// On x86-64 the CPU is checked at run time: it encodes with BMI2 pdep when it is fast,
+	/// else 4 vectors at a time with AVX2, else one at a time as bitfieldInterleave.
+	///
+	/// @see gtc_bitfield
+	/// @see void bitfieldDeinterleave(uint64 const * in, tvec3<uint32, P> * out, std::size_t count)
+	template <precision P>
+	GLM_FUNC_DECL void bitfieldInterleave(tvec3<uint32, P> const * in, uint64 * out, std::size_t count);
+
+	/// Splits each of the count codes of in back into the components it interleaves
+	/// and writes the vectors to out, the inverse of bitfieldInterleave(x, y, z) on uint8 components.
+	/// It uses BMI2 pext or AVX2 as the CPU allows, as the batch bitfieldInterleave does.
+	///
+	/// @see gtc_bitfield
+	/// @see void bitfieldInterleave(tvec3<uint8, P> const * in, uint32 * out, std::size_t count)
+	template <precision P>
+	GLM_FUNC_DECL void bitfieldDeinterleave(uint32 const * in, tvec3<uint8, P> * out, std::size_t count);
+
+	/// Splits each of the count codes of in back into the components it interleaves
+	/// and writes the vectors to out, the inverse of bitfieldInterleave(x, y, z) on uint16 components.
+	/// It uses BMI2 pext or AVX2 as the CPU allows, as the batch bitfieldInterleave does.
+	///
+	/// @see gtc_bitfield
+	/// @see void bitfieldInterleave(tvec3<uint16, P> const * in, uint64 * out, std::size_t count)
+	template <precision P>
+	GLM_FUNC_DECL void bitfieldDeinterleave(uint64 const * in, tvec3<uint16, P> * out, std::size_t count);
+
+	/// Splits each of the count codes of in back into the 21-bit components it interleaves
+	/// and writes the vectors to out, the inverse of bitfieldInterleave(x, y, z) on uint32 components.
+	/// It uses BMI2 pext or AVX2 as the CPU allows, as the batch bitfieldInterleave does.
+	///
+	/// @see gtc_bitfield
+	/// @see void bitfieldInterleave(tvec3<uint32, P> const * in, uint64 * out, std::size_t count)
+	template <precision P>
+	GLM_FUNC_DECL void bitfieldDeinterleave(uint64 const * in, tvec3<uint32, P> * out, std::size_t count);
+
 	/// @}
 } //namespace glm
 
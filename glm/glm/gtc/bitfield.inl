@@ -539,4 +539,397 @@ namespace detail
 	{
 		return detail::bitfieldInterleave<uint16, uint64>(x, y, z, w);
 	}
+
+	// Batch Morton codes. On x86-64 the kernel is chosen at run time by what the CPU supports,
+	// whatever GLM_ARCH says (see _dispatch.hpp): BMI2 pdep and pext give each component in
+	// a single instruction, AVX2 runs the shift-and-mask sequence of the scalar functions on
+	// whole registers. The kernels give the same bits as the scalar
+	// functions, which do the elements a kernel leaves and all of them elsewhere.
+namespace detail
+{
+	// The components of the Morton codes of 3 components of type T: the bits of x in the
+	// code, which take Bits bits of it.
+	template <typename T>
+	struct morton3
+	{};
+
+	template <>
+	struct morton3<uint8>
+	{
+		typedef uint32 code;
+		static uint64 const mask = 0x0000000000249249;
+		static uint32 const bits = 8;
+	};
+
+	template <>
+	struct morton3<uint16>
+	{
+		typedef uint64 code;
+		static uint64 const mask = 0x0000249249249249;
+		static uint32 const bits = 16;
+	};
+
+	template <>
+	struct morton3<uint32>
+	{
+		typedef uint64 code;
+		static uint64 const mask = 0x1249249249249249;
+		static uint32 const bits = 21;
+	};
+
+	// The x component of a code, as the inverse of the shift-and-mask sequence.
+	GLM_FUNC_QUALIFIER uint64 bitfieldCompact3(uint64 v)
+	{
+		v &= 0x9249249249249249;
+		v = (v | (v >>  2)) & 0x30C30C30C30C30C3;
+		v = (v | (v >>  4)) & 0xF00F00F00F00F00F;
+		v = (v | (v >>  8)) & 0x00FF0000FF0000FF;
+		v = (v | (v >> 16)) & 0xFFFF00000000FFFF;
+		return (v | (v >> 32)) & 0x00000000001FFFFF;
+	}
+
+#	if GLM_HAS_DISPATCH
+	template <typename T>
+	GLM_TARGET("bmi2") std::size_t bitfieldInterleave_bmi2(T const * in, typename morton3<T>::code * out, std::size_t count)
+	{
+		uint64 const Mask = morton3<T>::mask;
+		for(std::size_t i = 0; i < count; ++i, in += 3)
+			out[i] = static_cast<typename morton3<T>::code>(
+				_pdep_u64(in[0], Mask) | _pdep_u64(in[1], Mask << 1) | _pdep_u64(in[2], Mask << 2));
+		return count;
+	}
+
+	template <typename T>
+	GLM_TARGET("bmi2") std::size_t bitfieldDeinterleave_bmi2(typename morton3<T>::code const * in, T * out, std::size_t count)
+	{
+		uint64 const Mask = morton3<T>::mask;
+		for(std::size_t i = 0; i < count; ++i, out += 3)
+		{
+			uint64 const Code = in[i];
+			out[0] = static_cast<T>(_pext_u64(Code, Mask));
+			out[1] = static_cast<T>(_pext_u64(Code, Mask << 1));
+			out[2] = static_cast<T>(_pext_u64(Code, Mask << 2));
+		}
+		return count;
+	}
+
+	// The pshufb masks between 48 bytes of vectors of 3 components of Size bytes, in three
+	// registers, and the 16 bytes of each component.
+	struct morton3_shuffle
+	{
+		__m128i split[3][3];	// [component][register]
+		__m128i merge[3][3];	// [register][component]
+
+		GLM_TARGET_AVX2 explicit morton3_shuffle(int Size)
+		{
+			GLM_ALIGN(16) uint8 Split[3][3][16];
+			GLM_ALIGN(16) uint8 Merge[3][3][16];
+			for(int c = 0; c < 3; ++c)
+			for(int j = 0; j < 16; ++j)
+			{
+				int const Byte = (3 * (j / Size) + c) * Size + j % Size;
+				for(int r = 0; r < 3; ++r)
+				{
+					Split[c][r][j] = static_cast<uint8>(Byte / 16 == r ? Byte % 16 : 0x80);
+					int const At = 16 * r + j;
+					Merge[r][c][j] = static_cast<uint8>(At / Size % 3 == c ? At / (3 * Size) * Size + At % Size : 0x80);
+				}
+			}
+			for(int a = 0; a < 3; ++a)
+			for(int b = 0; b < 3; ++b)
+			{
+				split[a][b] = _mm_load_si128(reinterpret_cast<__m128i const*>(Split[a][b]));
+				merge[a][b] = _mm_load_si128(reinterpret_cast<__m128i const*>(Merge[a][b]));
+			}
+		}
+
+		// the 16 bytes of each component of the 48 bytes at in
+		GLM_TARGET_AVX2 void load(void const * in, __m128i Components[3]) const
+		{
+			__m128i const* const p = static_cast<__m128i const*>(in);
+			__m128i const a = _mm_loadu_si128(p + 0);
+			__m128i const b = _mm_loadu_si128(p + 1);
+			__m128i const c = _mm_loadu_si128(p + 2);
+			for(int i = 0; i < 3; ++i)
+				Components[i] = _mm_or_si128(_mm_or_si128(
+					_mm_shuffle_epi8(a, split[i][0]), _mm_shuffle_epi8(b, split[i][1])), _mm_shuffle_epi8(c, split[i][2]));
+		}
+
+		// the inverse of load
+		GLM_TARGET_AVX2 void store(__m128i const Components[3], void * out) const
+		{
+			__m128i* const p = static_cast<__m128i*>(out);
+			for(int i = 0; i < 3; ++i)
+				_mm_storeu_si128(p + i, _mm_or_si128(_mm_or_si128(
+					_mm_shuffle_epi8(Components[0], merge[i][0]), _mm_shuffle_epi8(Components[1], merge[i][1])), _mm_shuffle_epi8(Components[2], merge[i][2])));
+		}
+	};
+
+	// The steps of the scalar bitfieldInterleave of 3 uint8 on 8 lanes of 32 bits, the
+	// <<16 step leaves 8 bits as they are.
+	GLM_TARGET_AVX2 inline __m256i bitfieldSpread3_avx2(__m256i v)
+	{
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi32(v, 8), v), _mm256_set1_epi32(0x0F00F00F));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi32(v, 4), v), _mm256_set1_epi32(static_cast<int>(0xC30C30C3)));
+		return _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi32(v, 2), v), _mm256_set1_epi32(0x49249249));
+	}
+
+	// The steps of the scalar bitfieldInterleave of 3 uint32 on 4 lanes of 64 bits, from the
+	// <<32 step if Bits is more than 16.
+	GLM_TARGET_AVX2 inline __m256i bitfieldSpread3_avx2(__m256i v, uint32 Bits)
+	{
+		if(Bits > 16)
+			v = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(v, 32), v), _mm256_set1_epi64x(static_cast<int64>(0xFFFF00000000FFFF)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(v, 16), v), _mm256_set1_epi64x(static_cast<int64>(0x00FF0000FF0000FF)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(v,  8), v), _mm256_set1_epi64x(static_cast<int64>(0xF00F00F00F00F00F)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(v,  4), v), _mm256_set1_epi64x(static_cast<int64>(0x30C30C30C30C30C3)));
+		return _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(v,  2), v), _mm256_set1_epi64x(static_cast<int64>(0x9249249249249249)));
+	}
+
+	// bitfieldSpread3_avx2 backwards: the x of 8 codes of 32 bits
+	GLM_TARGET_AVX2 inline __m256i bitfieldCompact3_avx2(__m256i v)
+	{
+		v = _mm256_and_si256(v, _mm256_set1_epi32(0x49249249));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi32(v, 2), v), _mm256_set1_epi32(static_cast<int>(0xC30C30C3)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi32(v, 4), v), _mm256_set1_epi32(0x0F00F00F));
+		return _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi32(v, 8), v), _mm256_set1_epi32(0xFF));
+	}
+
+	// the x of 4 codes of 64 bits, the low Bits bits in the low 32 bits of each lane
+	GLM_TARGET_AVX2 inline __m256i bitfieldCompact3_avx2(__m256i v, uint32 Bits)
+	{
+		v = _mm256_and_si256(v, _mm256_set1_epi64x(static_cast<int64>(0x9249249249249249)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(v,  2), v), _mm256_set1_epi64x(static_cast<int64>(0x30C30C30C30C30C3)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(v,  4), v), _mm256_set1_epi64x(static_cast<int64>(0xF00F00F00F00F00F)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(v,  8), v), _mm256_set1_epi64x(static_cast<int64>(0x00FF0000FF0000FF)));
+		v = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(v, 16), v), _mm256_set1_epi64x(static_cast<int64>(0xFFFF00000000FFFF)));
+		if(Bits > 16)
+			v = _mm256_or_si256(_mm256_srli_epi64(v, 32), v);
+		return _mm256_and_si256(v, _mm256_set1_epi64x(static_cast<int64>((uint64(1) << Bits) - 1)));
+	}
+
+	// the low 32 bits of the 4 lanes of 64 bits
+	GLM_TARGET_AVX2 inline __m128i bitfieldNarrow_avx2(__m256i v)
+	{
+		return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+	}
+
+	// 16 vectors of uint8 per 48 bytes
+	GLM_TARGET_AVX2 inline std::size_t bitfieldInterleave_avx2(uint8 const * in, uint32 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(count < 16)
+			return i;
+		morton3_shuffle const Shuffle(1);
+		for(; i + 16 <= count; i += 16, in += 48)
+		{
+			__m128i c[3];
+			Shuffle.load(in, c);
+			for(int h = 0; h < 2; ++h)
+			{
+				__m256i Code = _mm256_setzero_si256();
+				for(int k = 0; k < 3; ++k)
+					Code = _mm256_or_si256(Code, _mm256_slli_epi32(bitfieldSpread3_avx2(_mm256_cvtepu8_epi32(h ? _mm_srli_si128(c[k], 8) : c[k])), k));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8 * h), Code);
+			}
+		}
+		return i;
+	}
+
+	// 8 vectors of uint16 per 48 bytes
+	GLM_TARGET_AVX2 inline std::size_t bitfieldInterleave_avx2(uint16 const * in, uint64 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(count < 8)
+			return i;
+		morton3_shuffle const Shuffle(2);
+		for(; i + 8 <= count; i += 8, in += 24)
+		{
+			__m128i c[3];
+			Shuffle.load(in, c);
+			for(int h = 0; h < 2; ++h)
+			{
+				__m256i Code = _mm256_setzero_si256();
+				for(int k = 0; k < 3; ++k)
+					Code = _mm256_or_si256(Code, _mm256_slli_epi64(bitfieldSpread3_avx2(_mm256_cvtepu16_epi64(h ? _mm_srli_si128(c[k], 8) : c[k]), 16), k));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 4 * h), Code);
+			}
+		}
+		return i;
+	}
+
+	// 4 vectors of uint32 per 48 bytes
+	GLM_TARGET_AVX2 inline std::size_t bitfieldInterleave_avx2(uint32 const * in, uint64 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(count < 4)
+			return i;
+		morton3_shuffle const Shuffle(4);
+		__m256i const Mask = _mm256_set1_epi64x(0x1FFFFF);
+		for(; i + 4 <= count; i += 4, in += 12)
+		{
+			__m128i c[3];
+			Shuffle.load(in, c);
+			__m256i Code = _mm256_setzero_si256();
+			for(int k = 0; k < 3; ++k)
+				Code = _mm256_or_si256(Code, _mm256_slli_epi64(bitfieldSpread3_avx2(_mm256_and_si256(_mm256_cvtepu32_epi64(c[k]), Mask), 21), k));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), Code);
+		}
+		return i;
+	}
+
+	GLM_TARGET_AVX2 inline std::size_t bitfieldDeinterleave_avx2(uint32 const * in, uint8 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(count < 16)
+			return i;
+		morton3_shuffle const Shuffle(1);
+		for(; i + 16 <= count; i += 16, out += 48)
+		{
+			__m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i));
+			__m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i + 8));
+			__m128i c[3];
+			for(int k = 0; k < 3; ++k)
+			{
+				// the lanes hold 8-bit values, so packus can not saturate
+				__m256i const Words = _mm256_permute4x64_epi64(_mm256_packus_epi32(
+					bitfieldCompact3_avx2(_mm256_srli_epi32(a, k)), bitfieldCompact3_avx2(_mm256_srli_epi32(b, k))), 0xD8);
+				c[k] = _mm_packus_epi16(_mm256_castsi256_si128(Words), _mm256_extracti128_si256(Words, 1));
+			}
+			Shuffle.store(c, out);
+		}
+		return i;
+	}
+
+	GLM_TARGET_AVX2 inline std::size_t bitfieldDeinterleave_avx2(uint64 const * in, uint16 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(count < 8)
+			return i;
+		morton3_shuffle const Shuffle(2);
+		for(; i + 8 <= count; i += 8, out += 24)
+		{
+			__m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i));
+			__m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i + 4));
+			__m128i c[3];
+			for(int k = 0; k < 3; ++k)
+				c[k] = _mm_packus_epi32(
+					bitfieldNarrow_avx2(bitfieldCompact3_avx2(_mm256_srli_epi64(a, k), 16)),
+					bitfieldNarrow_avx2(bitfieldCompact3_avx2(_mm256_srli_epi64(b, k), 16)));
+			Shuffle.store(c, out);
+		}
+		return i;
+	}
+
+	GLM_TARGET_AVX2 inline std::size_t bitfieldDeinterleave_avx2(uint64 const * in, uint32 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(count < 4)
+			return i;
+		morton3_shuffle const Shuffle(4);
+		for(; i + 4 <= count; i += 4, out += 12)
+		{
+			__m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i));
+			__m128i c[3];
+			for(int k = 0; k < 3; ++k)
+				c[k] = bitfieldNarrow_avx2(bitfieldCompact3_avx2(_mm256_srli_epi64(a, k), 21));
+			Shuffle.store(c, out);
+		}
+		return i;
+	}
+#	endif//GLM_HAS_DISPATCH
+
+	// The codes of the first vectors of in by the kernel of the CPU, returns how many.
+	template <typename T>
+	GLM_FUNC_QUALIFIER std::size_t bitfieldInterleave_batch(T const * in, typename morton3<T>::code * out, std::size_t count)
+	{
+#		if GLM_HAS_DISPATCH
+			// pdep and pext beat AVX2 where they are fast
+			int const Features = dispatch_features();
+			if(Features & DISPATCH_BMI2)
+				return bitfieldInterleave_bmi2(in, out, count);
+			if(Features & DISPATCH_AVX2)
+				return bitfieldInterleave_avx2(in, out, count);
+#		endif
+		return 0;
+	}
+
+	template <typename T>
+	GLM_FUNC_QUALIFIER std::size_t bitfieldDeinterleave_batch(typename morton3<T>::code const * in, T * out, std::size_t count)
+	{
+#		if GLM_HAS_DISPATCH
+			// pdep and pext beat AVX2 where they are fast
+			int const Features = dispatch_features();
+			if(Features & DISPATCH_BMI2)
+				return bitfieldDeinterleave_bmi2(in, out, count);
+			if(Features & DISPATCH_AVX2)
+				return bitfieldDeinterleave_avx2(in, out, count);
+#		endif
+		return 0;
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void bitfieldInterleave3(tvec3<T, P> const * in, typename morton3<T>::code * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(sizeof(tvec3<T, P>) == sizeof(T) * 3)
+			i = bitfieldInterleave_batch(reinterpret_cast<T const *>(in), out, count);
+		T const Mask = static_cast<T>((uint64(1) << morton3<T>::bits) - 1);
+		for(; i < count; ++i)
+			out[i] = glm::bitfieldInterleave(
+				static_cast<T>(in[i].x & Mask), static_cast<T>(in[i].y & Mask), static_cast<T>(in[i].z & Mask));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void bitfieldDeinterleave3(typename morton3<T>::code const * in, tvec3<T, P> * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		if(sizeof(tvec3<T, P>) == sizeof(T) * 3)
+			i = bitfieldDeinterleave_batch(in, reinterpret_cast<T *>(out), count);
+		for(; i < count; ++i)
+		{
+			uint64 const Code = in[i];
+			out[i] = tvec3<T, P>(
+				static_cast<T>(bitfieldCompact3(Code)),
+				static_cast<T>(bitfieldCompact3(Code >> 1)),
+				static_cast<T>(bitfieldCompact3(Code >> 2)));
+		}
+	}
+}//namespace detail
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void bitfieldInterleave(tvec3<uint8, P> const * in, uint32 * out, std::size_t count)
+	{
+		detail::bitfieldInterleave3(in, out, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void bitfieldInterleave(tvec3<uint16, P> const * in, uint64 * out, std::size_t count)
+	{
+		detail::bitfieldInterleave3(in, out, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void bitfieldInterleave(tvec3<uint32, P> const * in, uint64 * out, std::size_t count)
+	{
+		detail::bitfieldInterleave3(in, out, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void bitfieldDeinterleave(uint32 const * in, tvec3<uint8, P> * out, std::size_t count)
+	{
+		detail::bitfieldDeinterleave3(in, out, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void bitfieldDeinterleave(uint64 const * in, tvec3<uint16, P> * out, std::size_t count)
+	{
+		detail::bitfieldDeinterleave3(in, out, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void bitfieldDeinterleave(uint64 const * in, tvec3<uint32, P> * out, std::size_t count)
+	{
+		detail::bitfieldDeinterleave3(in, out, count);
+	}
 }//namespace glm
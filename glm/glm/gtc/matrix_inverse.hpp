@@ -56,7 +56,9 @@ namespace glm
 	/// @addtogroup gtc_matrix_inverse
 	/// @{
 
-	/// Fast matrix inverse for affine matrix.
+	/// Fast matrix inverse for affine matrix: rotations, scales, shears and
+	/// translations, with a last row of (0, 0, 1) or (0, 0, 0, 1). Only the
+	/// upper 2x2 or 3x3 is inverted.
 	/// 
 	/// @param m Input matrix to invert.
 	/// @tparam genType Squared floating-point matrix: half, float or double. Inverse of matrix based of half-precision floating point value is highly innacurate.
@@ -84,7 +84,7 @@ namespace glm
 	/// @see - translate(tmat4x4<T, P> const & m, T x, T y, T z)
 	/// @see - translate(tvec3<T, P> const & v)
 	template <typename T, precision P>
-	GLM_FUNC_DECL tmat4x4<T, P> translate(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, P> translate(
 		tmat4x4<T, P> const & m,
 		tvec3<T, P> const & v);
 		
@@ -112,7 +112,7 @@ namespace glm
 	/// @see - scale(tmat4x4<T, P> const & m, T x, T y, T z)
 	/// @see - scale(tvec3<T, P> const & v)
 	template <typename T, precision P>
-	GLM_FUNC_DECL tmat4x4<T, P> scale(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, P> scale(
 		tmat4x4<T, P> const & m,
 		tvec3<T, P> const & v);
 
@@ -128,7 +128,7 @@ namespace glm
 	/// @see gtc_matrix_transform
 	/// @see - glm::ortho(T const & left, T const & right, T const & bottom, T const & top)
 	template <typename T>
-	GLM_FUNC_DECL tmat4x4<T, defaultp> ortho(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, defaultp> ortho(
 		T left,
 		T right,
 		T bottom,
@@ -146,7 +146,7 @@ namespace glm
 	/// @see gtc_matrix_transform
 	/// @see - glm::ortho(T const & left, T const & right, T const & bottom, T const & top, T const & zNear, T const & zFar)
 	template <typename T>
-	GLM_FUNC_DECL tmat4x4<T, defaultp> ortho(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, defaultp> ortho(
 		T left,
 		T right,
 		T bottom,
@@ -163,7 +163,7 @@ namespace glm
 	/// @tparam T Value type used to build the matrix. Currently supported: half (not recommanded), float or double.
 	/// @see gtc_matrix_transform
 	template <typename T>
-	GLM_FUNC_DECL tmat4x4<T, defaultp> frustum(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, defaultp> frustum(
 		T left,
 		T right,
 		T bottom,
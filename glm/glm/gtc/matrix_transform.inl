@@ -37,7 +37,7 @@
 namespace glm
 {
 	template <typename T, precision P>
-	GLM_FUNC_QUALIFIER tmat4x4<T, P> translate
+	GLM_FUNC_QUALIFIER GLM_CONSTEXPR_CXX14 tmat4x4<T, P> translate
 	(
 		tmat4x4<T, P> const & m,
 		tvec3<T, P> const & v
@@ -119,18 +119,13 @@ namespace glm
 	}
 
 	template <typename T, precision P>
-	GLM_FUNC_QUALIFIER tmat4x4<T, P> scale
+	GLM_FUNC_QUALIFIER GLM_CONSTEXPR_CXX14 tmat4x4<T, P> scale
 	(
 		tmat4x4<T, P> const & m,
 		tvec3<T, P> const & v
 	)
 	{
-		tmat4x4<T, P> Result(uninitialize);
-		Result[0] = m[0] * v[0];
-		Result[1] = m[1] * v[1];
-		Result[2] = m[2] * v[2];
-		Result[3] = m[3];
-		return Result;
+		return tmat4x4<T, P>(m[0] * v[0], m[1] * v[1], m[2] * v[2], m[3]);
 	}
 
 	template <typename T, precision P>
@@ -148,7 +143,7 @@ namespace glm
 	}
 
 	template <typename T>
-	GLM_FUNC_QUALIFIER tmat4x4<T, defaultp> ortho
+	GLM_FUNC_QUALIFIER GLM_CONSTEXPR_CXX14 tmat4x4<T, defaultp> ortho
 	(
 		T left,
 		T right,
@@ -169,7 +164,7 @@ namespace glm
 	}
 
 	template <typename T>
-	GLM_FUNC_QUALIFIER tmat4x4<T, defaultp> ortho
+	GLM_FUNC_QUALIFIER GLM_CONSTEXPR_CXX14 tmat4x4<T, defaultp> ortho
 	(
 		T left,
 		T right,
@@ -187,7 +182,7 @@ namespace glm
 	}
 
 	template <typename T>
-	GLM_FUNC_QUALIFIER tmat4x4<T, defaultp> frustum
+	GLM_FUNC_QUALIFIER GLM_CONSTEXPR_CXX14 tmat4x4<T, defaultp> frustum
 	(
 		T left,
 		T right,
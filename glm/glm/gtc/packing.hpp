@@ -472,6 +472,65 @@ namespace glm
 	/// @see uint32 packF2x11_1x10(vec3 const & v)
 	GLM_FUNC_DECL vec3 unpackF2x11_1x10(uint32 p);
 
+	/// Converts the count floating-point values of in to the 16-bit floating-point representation
+	/// and writes them to out, with the same results as packHalf1x16 for every value.
+	/// This is meant for converting large arrays, e.g. vertex data at load time: it converts 8 values
+	/// at a time with AVX2, which it uses on x86-64 when the CPU has it whatever GLM_ARCH says,
+	/// or 4 with SSE2.
+	///
+	/// @see gtc_packing
+	/// @see uint16 packHalf1x16(float v)
+	/// @see void unpackHalf(uint16 const * in, float * out, std::size_t count)
+	GLM_FUNC_DECL void packHalf(float const * in, uint16 * out, std::size_t count);
+
+	/// Converts the count 16-bit floating-point values of in to 32-bit floating-point values
+	/// and writes them to out, with the same results as unpackHalf1x16 for every value
+	/// but signaling NaNs, which may come out as quiet NaNs.
+	/// It converts 8 values at a time with AVX2 and F16C, which it uses on x86-64 when the CPU has them
+	/// whatever GLM_ARCH says, or 4 with SSE2.
+	///
+	/// @see gtc_packing
+	/// @see float unpackHalf1x16(uint16 v)
+	/// @see void packHalf(float const * in, uint16 * out, std::size_t count)
+	GLM_FUNC_DECL void unpackHalf(uint16 const * in, float * out, std::size_t count);
+
+	/// Converts the count normalized floating-point values of in to 8-bit unsigned integer values
+	/// and writes them to out, with the same results as packUnorm1x8 for every value but NaNs.
+	/// Four values in a row are the components of a packUnorm4x8 result, so this converts
+	/// e.g. RGBA8 colors. Depending on GLM_ARCH, it converts 16 values at a time.
+	///
+	/// @see gtc_packing
+	/// @see uint8 packUnorm1x8(float v)
+	/// @see void unpackUnorm8(uint8 const * in, float * out, std::size_t count)
+	GLM_FUNC_DECL void packUnorm8(float const * in, uint8 * out, std::size_t count);
+
+	/// Converts the count 8-bit unsigned integer values of in to normalized floating-point values
+	/// and writes them to out, with the same results as unpackUnorm1x8 for every value.
+	/// Depending on GLM_ARCH, it converts 16 values at a time.
+	///
+	/// @see gtc_packing
+	/// @see float unpackUnorm1x8(uint8 p)
+	/// @see void packUnorm8(float const * in, uint8 * out, std::size_t count)
+	GLM_FUNC_DECL void unpackUnorm8(uint8 const * in, float * out, std::size_t count);
+
+	/// Converts the count four-component vectors of in to the signed normalized 3x10_1x2 format
+	/// and writes them to out, with the same results as packSnorm3x10_1x2 for every vector but
+	/// those with NaN components. Depending on GLM_ARCH, it converts 4 vectors at a time.
+	///
+	/// @see gtc_packing
+	/// @see uint32 packSnorm3x10_1x2(vec4 const & v)
+	/// @see void unpackSnorm3x10_1x2(uint32 const * in, vec4 * out, std::size_t count)
+	GLM_FUNC_DECL void packSnorm3x10_1x2(vec4 const * in, uint32 * out, std::size_t count);
+
+	/// Converts the count signed normalized 3x10_1x2 values of in to four-component vectors
+	/// and writes them to out, with the same results as unpackSnorm3x10_1x2 for every value.
+	/// Depending on GLM_ARCH, it converts 4 values at a time.
+	///
+	/// @see gtc_packing
+	/// @see vec4 unpackSnorm3x10_1x2(uint32 p)
+	/// @see void packSnorm3x10_1x2(vec4 const * in, uint32 * out, std::size_t count)
+	GLM_FUNC_DECL void unpackSnorm3x10_1x2(uint32 const * in, vec4 * out, std::size_t count);
+
 	/// @}
 }// namespace glm
 
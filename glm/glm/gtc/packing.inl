@@ -35,6 +35,7 @@
 #include "../vec3.hpp"
 #include "../vec4.hpp"
 #include "../detail/type_half.hpp"
+#include "../detail/_dispatch.hpp"
 #include <cstring>
 
 namespace glm{
@@ -487,4 +488,281 @@ namespace detail
 			detail::packed10bitToFloat(v >> 22));
 	}
 
+
+	// Batch conversions. The SIMD kernels reproduce the scalar functions bit for bit: the same
+	// rounding (to nearest, ties away from zero) and the same handling of denormals, infinities
+	// and NaNs. The elements which do not fill a whole register go through the scalar functions.
+	// The AVX2 kernels also run in the builds without AVX2 when the CPU has it, see _dispatch.hpp.
+namespace detail
+{
+#	if GLM_ARCH & GLM_ARCH_SSE2
+	// Selects a where Mask is set, b elsewhere.
+	GLM_FUNC_QUALIFIER __m128i select_sse2(__m128i Mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(Mask, a), _mm_andnot_si128(Mask, b));
+	}
+
+	// Four floats to four halfs in the low 16 bits of each lane, as toFloat16.
+	GLM_FUNC_QUALIFIER __m128i packHalf_sse2(__m128 v)
+	{
+		__m128i const i = _mm_castps_si128(v);
+		__m128i const Abs = _mm_and_si128(i, _mm_set1_epi32(0x7fffffff));
+		__m128i const Sign = _mm_and_si128(_mm_srli_epi32(i, 16), _mm_set1_epi32(0x8000));
+
+		// Normalized: rebias the exponent and round at the last kept bit, the carry may
+		// increment the exponent. Too large values become infinities.
+		__m128i Norm = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(Abs, _mm_set1_epi32(112 << 23)), _mm_set1_epi32(0x1000)), 13);
+		Norm = select_sse2(_mm_cmpgt_epi32(Norm, _mm_set1_epi32(0x7c00)), _mm_set1_epi32(0x7c00), Norm);
+
+		// Denormalized: the value in units of the smallest half denormal, rounded half up
+		__m128 const Scaled = _mm_add_ps(_mm_mul_ps(_mm_castsi128_ps(Abs), _mm_set1_ps(16777216.f)), _mm_set1_ps(0.5f));
+		__m128i const Denorm = _mm_cvttps_epi32(Scaled);
+
+		// Infinities and NaNs, which keep their 10 leftmost significand bits but at least one
+		__m128i const Mantissa = _mm_srli_epi32(_mm_and_si128(i, _mm_set1_epi32(0x007fffff)), 13);
+		__m128i const IsNaN = _mm_cmpgt_epi32(Abs, _mm_set1_epi32(0x7f800000));
+		__m128i const Quiet = _mm_and_si128(_mm_and_si128(IsNaN, _mm_cmpeq_epi32(Mantissa, _mm_setzero_si128())), _mm_set1_epi32(1));
+		__m128i const Special = _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0x7c00), Mantissa), Quiet);
+
+		__m128i Result = select_sse2(_mm_cmplt_epi32(Abs, _mm_set1_epi32(0x38800000)), Denorm, Norm);
+		Result = _mm_andnot_si128(_mm_cmplt_epi32(Abs, _mm_set1_epi32(0x33000000)), Result);
+		Result = select_sse2(_mm_cmpgt_epi32(Abs, _mm_set1_epi32(0x7f7fffff)), Special, Result);
+		return _mm_or_si128(Result, Sign);
+	}
+
+	// Narrows eight lanes holding 16-bit values to 16 bits, packs_epi32 saturates signed.
+	GLM_FUNC_QUALIFIER __m128i narrow16_sse2(__m128i a, __m128i b)
+	{
+		return _mm_packs_epi32(
+			_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+			_mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+	}
+
+	// Four halfs in the low 16 bits of each lane to four floats, as toFloat32.
+	GLM_FUNC_QUALIFIER __m128 unpackHalf_sse2(__m128i h)
+	{
+		__m128i const Sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+		__m128i const Exponent = _mm_and_si128(h, _mm_set1_epi32(0x7c00));
+		__m128i const Mantissa = _mm_and_si128(h, _mm_set1_epi32(0x03ff));
+
+		__m128i const Norm = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13), _mm_set1_epi32(112 << 23));
+		__m128i const Denorm = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(Mantissa), _mm_set1_ps(1.f / 16777216.f)));
+		__m128i const Special = _mm_or_si128(_mm_set1_epi32(0x7f800000), _mm_slli_epi32(Mantissa, 13));
+
+		__m128i Result = select_sse2(_mm_cmpeq_epi32(Exponent, _mm_setzero_si128()), Denorm, Norm);
+		Result = select_sse2(_mm_cmpeq_epi32(Exponent, _mm_set1_epi32(0x7c00)), Special, Result);
+		return _mm_castsi128_ps(_mm_or_si128(Result, Sign));
+	}
+
+	// Rounds to nearest with ties away from zero, as std::round, then converts to integers.
+	GLM_FUNC_QUALIFIER __m128i round_sse2(__m128 v)
+	{
+		__m128 const SignBit = _mm_set1_ps(-0.f);
+		__m128 const Abs = _mm_andnot_ps(SignBit, v);
+		__m128i Integer = _mm_cvttps_epi32(Abs);
+		__m128 const Fraction = _mm_sub_ps(Abs, _mm_cvtepi32_ps(Integer));
+		Integer = _mm_sub_epi32(Integer, _mm_castps_si128(_mm_cmpge_ps(Fraction, _mm_set1_ps(0.5f))));
+		__m128i const Negative = _mm_srai_epi32(_mm_castps_si128(v), 31);
+		return _mm_sub_epi32(_mm_xor_si128(Integer, Negative), Negative);
+	}
+#	endif//GLM_ARCH & GLM_ARCH_SSE2
+
+#	if (GLM_ARCH & GLM_ARCH_AVX2) || GLM_HAS_DISPATCH
+	GLM_TARGET_AVX2 GLM_FUNC_QUALIFIER __m256i select_avx2(__m256i Mask, __m256i a, __m256i b)
+	{
+		return _mm256_or_si256(_mm256_and_si256(Mask, a), _mm256_andnot_si256(Mask, b));
+	}
+
+	// packHalf_sse2 on eight lanes
+	GLM_TARGET_AVX2 GLM_FUNC_QUALIFIER __m256i packHalf_avx2(__m256 v)
+	{
+		__m256i const i = _mm256_castps_si256(v);
+		__m256i const Abs = _mm256_and_si256(i, _mm256_set1_epi32(0x7fffffff));
+		__m256i const Sign = _mm256_and_si256(_mm256_srli_epi32(i, 16), _mm256_set1_epi32(0x8000));
+
+		__m256i Norm = _mm256_srli_epi32(_mm256_add_epi32(_mm256_sub_epi32(Abs, _mm256_set1_epi32(112 << 23)), _mm256_set1_epi32(0x1000)), 13);
+		Norm = _mm256_min_epi32(Norm, _mm256_set1_epi32(0x7c00));
+
+		__m256 const Scaled = _mm256_add_ps(_mm256_mul_ps(_mm256_castsi256_ps(Abs), _mm256_set1_ps(16777216.f)), _mm256_set1_ps(0.5f));
+		__m256i const Denorm = _mm256_cvttps_epi32(Scaled);
+
+		__m256i const Mantissa = _mm256_srli_epi32(_mm256_and_si256(i, _mm256_set1_epi32(0x007fffff)), 13);
+		__m256i const IsNaN = _mm256_cmpgt_epi32(Abs, _mm256_set1_epi32(0x7f800000));
+		__m256i const Quiet = _mm256_and_si256(_mm256_and_si256(IsNaN, _mm256_cmpeq_epi32(Mantissa, _mm256_setzero_si256())), _mm256_set1_epi32(1));
+		__m256i const Special = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32(0x7c00), Mantissa), Quiet);
+
+		__m256i Result = select_avx2(_mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), Abs), Denorm, Norm);
+		Result = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(0x33000000), Abs), Result);
+		Result = select_avx2(_mm256_cmpgt_epi32(Abs, _mm256_set1_epi32(0x7f7fffff)), Special, Result);
+		Result = _mm256_or_si256(Result, Sign);
+
+		// the lanes hold 16-bit values, so packus can not saturate
+		return _mm256_permute4x64_epi64(_mm256_packus_epi32(Result, Result), 0x08);
+	}
+
+	// The whole registers of packHalf, returns how many values it converted.
+	GLM_TARGET_AVX2 GLM_FUNC_QUALIFIER std::size_t packHalf_avx2(float const * in, uint16 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		for(; i + 8 <= count; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packHalf_avx2(_mm256_loadu_ps(in + i))));
+		return i;
+	}
+
+	// The whole registers of unpackHalf, with the F16C conversions.
+	GLM_TARGET_AVX2 GLM_FUNC_QUALIFIER std::size_t unpackHalf_avx2(uint16 const * in, float * out, std::size_t count)
+	{
+		std::size_t i = 0;
+		for(; i + 8 <= count; i += 8)
+			_mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i))));
+		return i;
+	}
+#	endif//(GLM_ARCH & GLM_ARCH_AVX2) || GLM_HAS_DISPATCH
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void packHalf(float const * in, uint16 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_AVX2
+			i = detail::packHalf_avx2(in, out, count);
+#		elif GLM_HAS_DISPATCH
+			if(detail::dispatch_features() & detail::DISPATCH_AVX2)
+				i = detail::packHalf_avx2(in, out, count);
+#		endif
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const a = detail::packHalf_sse2(_mm_loadu_ps(in + i));
+				__m128i const b = detail::packHalf_sse2(_mm_loadu_ps(in + i + 4));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), detail::narrow16_sse2(a, b));
+			}
+#		endif
+		for(; i < count; ++i)
+			out[i] = packHalf1x16(in[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackHalf(uint16 const * in, float * out, std::size_t count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_AVX2
+			i = detail::unpackHalf_avx2(in, out, count);
+#		elif GLM_HAS_DISPATCH
+			if(detail::dispatch_features() & detail::DISPATCH_AVX2)
+				i = detail::unpackHalf_avx2(in, out, count);
+#		endif
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+				_mm_storeu_ps(out + i, detail::unpackHalf_sse2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+				_mm_storeu_ps(out + i + 4, detail::unpackHalf_sse2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+			}
+#		endif
+		for(; i < count; ++i)
+			out[i] = unpackHalf1x16(in[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packUnorm8(float const * in, uint8 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			__m128 const Zero = _mm_setzero_ps();
+			__m128 const One = _mm_set1_ps(1.0f);
+			__m128 const Scale = _mm_set1_ps(255.0f);
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i v[4];
+				for(int j = 0; j < 4; ++j)
+					v[j] = detail::round_sse2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4 * j), Zero), One), Scale));
+				__m128i const Low = _mm_packs_epi32(v[0], v[1]);
+				__m128i const High = _mm_packs_epi32(v[2], v[3]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(Low, High));
+			}
+#		endif
+		for(; i < count; ++i)
+			out[i] = packUnorm1x8(in[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackUnorm8(uint8 const * in, float * out, std::size_t count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			__m128i const Zero = _mm_setzero_si128();
+			__m128 const Scale = _mm_set1_ps(static_cast<float>(0.0039215686274509803921568627451)); // 1 / 255
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+				__m128i const Low = _mm_unpacklo_epi8(b, Zero);
+				__m128i const High = _mm_unpackhi_epi8(b, Zero);
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Low, Zero)), Scale));
+				_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Low, Zero)), Scale));
+				_mm_storeu_ps(out + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(High, Zero)), Scale));
+				_mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(High, Zero)), Scale));
+			}
+#		endif
+		for(; i < count; ++i)
+			out[i] = unpackUnorm1x8(in[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packSnorm3x10_1x2(vec4 const * in, uint32 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			__m128 const Min = _mm_set1_ps(-1.0f);
+			__m128 const Max = _mm_set1_ps(1.0f);
+			__m128 const Scale = _mm_set1_ps(511.f);
+			__m128i const Mask10 = _mm_set1_epi32(0x3ff);
+			for(; i + 4 <= count; i += 4)
+			{
+				// one register per component of four vectors
+				__m128 x = _mm_loadu_ps(&in[i + 0].x);
+				__m128 y = _mm_loadu_ps(&in[i + 1].x);
+				__m128 z = _mm_loadu_ps(&in[i + 2].x);
+				__m128 w = _mm_loadu_ps(&in[i + 3].x);
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				__m128i const X = detail::round_sse2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, Min), Max), Scale));
+				__m128i const Y = detail::round_sse2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, Min), Max), Scale));
+				__m128i const Z = detail::round_sse2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, Min), Max), Scale));
+				__m128i const W = detail::round_sse2(_mm_min_ps(_mm_max_ps(w, Min), Max));
+				__m128i Result = _mm_and_si128(X, Mask10);
+				Result = _mm_or_si128(Result, _mm_slli_epi32(_mm_and_si128(Y, Mask10), 10));
+				Result = _mm_or_si128(Result, _mm_slli_epi32(_mm_and_si128(Z, Mask10), 20));
+				Result = _mm_or_si128(Result, _mm_slli_epi32(W, 30));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Result);
+			}
+#		endif
+		for(; i < count; ++i)
+			out[i] = packSnorm3x10_1x2(in[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackSnorm3x10_1x2(uint32 const * in, vec4 * out, std::size_t count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			__m128 const Min = _mm_set1_ps(-1.0f);
+			__m128 const Max = _mm_set1_ps(1.0f);
+			__m128 const Scale = _mm_set1_ps(511.f);
+			for(; i + 4 <= count; i += 4)
+			{
+				// sign extend each field into a register of its own
+				__m128i const p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+				__m128 x = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(p, 22), 22));
+				__m128 y = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(p, 12), 22));
+				__m128 z = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(p, 2), 22));
+				__m128 w = _mm_cvtepi32_ps(_mm_srai_epi32(p, 30));
+				x = _mm_min_ps(_mm_max_ps(_mm_div_ps(x, Scale), Min), Max);
+				y = _mm_min_ps(_mm_max_ps(_mm_div_ps(y, Scale), Min), Max);
+				z = _mm_min_ps(_mm_max_ps(_mm_div_ps(z, Scale), Min), Max);
+				w = _mm_min_ps(_mm_max_ps(w, Min), Max);
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(&out[i + 0].x, x);
+				_mm_storeu_ps(&out[i + 1].x, y);
+				_mm_storeu_ps(&out[i + 2].x, z);
+				_mm_storeu_ps(&out[i + 3].x, w);
+			}
+#		endif
+		for(; i < count; ++i)
+			out[i] = unpackSnorm3x10_1x2(in[i]);
+	}
+
 }//namespace glm
@@ -38,6 +38,14 @@
 /// 
 /// @brief Generate random number from various distribution methods.
 /// 
+/// The numbers come from a xoshiro128** generator per thread (Blackman and
+/// Vigna), not from std::rand: the threads neither share nor lock any state,
+/// and each starts its own sequence, the first one to use it sequence 0.
+/// seedRand() restarts the sequence of the calling thread. Compilers without
+/// thread_local (GLM_HAS_THREAD_LOCAL) share one generator, which is then no
+/// more thread safe than std::rand.
+/// GLM_GTX_wide_random fills whole arrays at once.
+/// 
 /// <glm/gtc/random.hpp> need to be included to use these functionalities.
 ///////////////////////////////////////////////////////////////////////////////////
 
@@ -46,6 +54,7 @@
 // Dependency:
 #include "../vec2.hpp"
 #include "../vec3.hpp"
+#include "../detail/type_int.hpp"
 
 #if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
 #	pragma message("GLM: GLM_GTC_random extension included")
@@ -56,6 +65,13 @@ namespace glm
 	/// @addtogroup gtc_random
 	/// @{
 	
+	/// Restart the random numbers of the calling thread at the sequence Seed.
+	/// The same seed gives the same numbers on any thread.
+	/// 
+	/// @param Seed
+	/// @see gtc_random
+	GLM_FUNC_DECL void seedRand(uint64 Seed);
+
 	/// Generate random numbers in the interval [Min, Max], according a linear distribution 
 	/// 
 	/// @param Min 
@@ -32,13 +32,82 @@
 
 #include "../geometric.hpp"
 #include "../exponential.hpp"
-#include <cstdlib>
-#include <ctime>
 #include <cassert>
+#if GLM_HAS_THREAD_LOCAL
+#	include <atomic>
+#endif
 
 namespace glm{
 namespace detail
 {
+	// A xoshiro128** generator, and how many times it was seeded, for the
+	// generators of GLM_GTX_wide_random which start from it
+	struct rand_state
+	{
+		uint32 s[4];
+		uint32 Seeds;
+	};
+
+	GLM_FUNC_QUALIFIER uint64 rand_splitmix64(uint64 & x)
+	{
+		uint64 z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// The state of sequence Seed, never all zero
+	GLM_FUNC_QUALIFIER void rand_seed(rand_state & State, uint64 Seed)
+	{
+		uint64 const a = rand_splitmix64(Seed);
+		uint64 const b = rand_splitmix64(Seed);
+		State.s[0] = static_cast<uint32>(a);
+		State.s[1] = static_cast<uint32>(a >> 32);
+		State.s[2] = static_cast<uint32>(b);
+		State.s[3] = static_cast<uint32>(b >> 32) | 1u;
+		++State.Seeds;
+	}
+
+	GLM_FUNC_QUALIFIER uint32 rand_rotl(uint32 x, int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	}
+
+	GLM_FUNC_QUALIFIER uint32 rand_next(rand_state & State)
+	{
+		uint32 * s = State.s;
+		uint32 const Result = rand_rotl(s[1] * 5u, 7) * 9u;
+		uint32 const t = s[1] << 9;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rand_rotl(s[3], 11);
+		return Result;
+	}
+
+	// The generator of the calling thread, the threads take the sequences
+	// in the order they first ask for one
+	GLM_FUNC_QUALIFIER rand_state & rand_thread_state()
+	{
+#		if GLM_HAS_THREAD_LOCAL
+			static std::atomic<uint32> Threads(0);
+			static thread_local rand_state State = {{0u, 0u, 0u, 0u}, 0u};
+#		else
+			static uint32 Threads = 0;
+			static rand_state State = {{0u, 0u, 0u, 0u}, 0u};
+#		endif
+		if(State.Seeds == 0u)
+			rand_seed(State, static_cast<uint64>(Threads++));
+		return State;
+	}
+
+	GLM_FUNC_QUALIFIER uint32 rand_uint32()
+	{
+		return rand_next(rand_thread_state());
+	}
+
 	template <typename T, precision P, template <class, precision> class vecType>
 	struct compute_rand
 	{
@@ -46,70 +115,66 @@ namespace detail
 	};
 
 	template <precision P>
-	struct compute_rand<uint8, P, tvec1>
+	struct compute_rand<uint32, P, tvec1>
 	{
-		GLM_FUNC_QUALIFIER static tvec1<uint8, P> call()
+		GLM_FUNC_QUALIFIER static tvec1<uint32, P> call()
 		{
-			return tvec1<uint8, P>(
-				std::rand()) % std::numeric_limits<uint8>::max();
+			return tvec1<uint32, P>(rand_uint32());
 		}
 	};
 
 	template <precision P>
-	struct compute_rand<uint8, P, tvec2>
+	struct compute_rand<uint32, P, tvec2>
 	{
-		GLM_FUNC_QUALIFIER static tvec2<uint8, P> call()
+		GLM_FUNC_QUALIFIER static tvec2<uint32, P> call()
 		{
-			return tvec2<uint8, P>(
-				std::rand(),
-				std::rand()) % std::numeric_limits<uint8>::max();
+			uint32 const x = rand_uint32();
+			uint32 const y = rand_uint32();
+			return tvec2<uint32, P>(x, y);
 		}
 	};
 
 	template <precision P>
-	struct compute_rand<uint8, P, tvec3>
+	struct compute_rand<uint32, P, tvec3>
 	{
-		GLM_FUNC_QUALIFIER static tvec3<uint8, P> call()
+		GLM_FUNC_QUALIFIER static tvec3<uint32, P> call()
 		{
-			return tvec3<uint8, P>(
-				std::rand(),
-				std::rand(),
-				std::rand()) % std::numeric_limits<uint8>::max();
+			uint32 const x = rand_uint32();
+			uint32 const y = rand_uint32();
+			uint32 const z = rand_uint32();
+			return tvec3<uint32, P>(x, y, z);
 		}
 	};
 
 	template <precision P>
-	struct compute_rand<uint8, P, tvec4>
+	struct compute_rand<uint32, P, tvec4>
 	{
-		GLM_FUNC_QUALIFIER static tvec4<uint8, P> call()
+		GLM_FUNC_QUALIFIER static tvec4<uint32, P> call()
 		{
-			return tvec4<uint8, P>(
-				std::rand(),
-				std::rand(),
-				std::rand(),
-				std::rand()) % std::numeric_limits<uint8>::max();
+			uint32 const x = rand_uint32();
+			uint32 const y = rand_uint32();
+			uint32 const z = rand_uint32();
+			uint32 const w = rand_uint32();
+			return tvec4<uint32, P>(x, y, z, w);
 		}
 	};
 
+	// the high bits of xoshiro128** are the better ones
 	template <precision P, template <class, precision> class vecType>
-	struct compute_rand<uint16, P, vecType>
+	struct compute_rand<uint8, P, vecType>
 	{
-		GLM_FUNC_QUALIFIER static vecType<uint16, P> call()
+		GLM_FUNC_QUALIFIER static vecType<uint8, P> call()
 		{
-			return
-				(vecType<uint16, P>(compute_rand<uint8, P, vecType>::call()) << static_cast<uint16>(8)) |
-				(vecType<uint16, P>(compute_rand<uint8, P, vecType>::call()) << static_cast<uint16>(0));
+			return vecType<uint8, P>(compute_rand<uint32, P, vecType>::call() >> static_cast<uint32>(24));
 		}
 	};
 
 	template <precision P, template <class, precision> class vecType>
-	struct compute_rand<uint32, P, vecType>
+	struct compute_rand<uint16, P, vecType>
 	{
-		GLM_FUNC_QUALIFIER static vecType<uint32, P> call()
+		GLM_FUNC_QUALIFIER static vecType<uint16, P> call()
 		{
-			return
-				(vecType<uint32, P>(compute_rand<uint16, P, vecType>::call()) << static_cast<uint32>(16)) |
-				(vecType<uint32, P>(compute_rand<uint16, P, vecType>::call()) << static_cast<uint32>(0));
+			return vecType<uint16, P>(compute_rand<uint32, P, vecType>::call() >> static_cast<uint32>(16));
 		}
 	};
 
@@ -284,6 +349,11 @@ namespace detail
 	};
 }//namespace detail
 
+	GLM_FUNC_QUALIFIER void seedRand(uint64 Seed)
+	{
+		detail::rand_seed(detail::rand_thread_state(), Seed);
+	}
+
 	template <typename genType>
 	GLM_FUNC_QUALIFIER genType linearRand(genType Min, genType Max)
 	{
@@ -106,6 +106,17 @@ namespace glm
 		genType & intersectionPosition1, genType & intersectionNormal1, 
 		genType & intersectionPosition2 = genType(), genType & intersectionNormal2 = genType());
 
+	//! Compute the intersection of a ray and an axis aligned box, with the slab test.
+	//! invDir is 1 / dir, infinite along the axes which the ray is parallel to.
+	//! intersectionDistance is where the ray enters the box, 0 if it starts inside.
+	//! A ray parallel to a face and in its plane may hit or miss.
+	//! From GLM_GTX_intersect extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL bool intersectRayBox(
+		tvec3<T, P> const & orig, tvec3<T, P> const & invDir,
+		tvec3<T, P> const & boxMin, tvec3<T, P> const & boxMax,
+		T & intersectionDistance);
+
 	/// @}
 }//namespace glm
 
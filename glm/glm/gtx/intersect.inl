@@ -214,4 +214,31 @@ namespace glm
 		intersectionNormal2 = (intersectionPoint2 - sphereCenter) / sphereRadius;
 		return true;
 	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER bool intersectRayBox
+	(
+		tvec3<T, P> const & orig, tvec3<T, P> const & invDir,
+		tvec3<T, P> const & boxMin, tvec3<T, P> const & boxMax,
+		T & intersectionDistance
+	)
+	{
+		tvec3<T, P> const t1 = (boxMin - orig) * invDir;
+		tvec3<T, P> const t2 = (boxMax - orig) * invDir;
+
+		T Near = static_cast<T>(0);
+		T Far = std::numeric_limits<T>::infinity();
+		for(length_t i = 0; i < 3; ++i)
+		{
+			T const Enter = t1[i] < t2[i] ? t1[i] : t2[i];
+			T const Leave = t1[i] < t2[i] ? t2[i] : t1[i];
+			if(Enter > Near)
+				Near = Enter;
+			if(Leave < Far)
+				Far = Leave;
+		}
+
+		intersectionDistance = Near;
+		return Near <= Far;
+	}
 }//namespace glm
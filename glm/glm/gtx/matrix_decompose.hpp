@@ -26,16 +26,24 @@
 ///
 /// @ref gtx_matrix_decompose
 /// @file glm/gtx/matrix_decompose.hpp
-/// @date 2014-08-29 / 2014-08-29
+/// @date 2014-08-29 / 2026-10-15
 /// @author Christophe Riccio
 /// 
 /// @see core (dependence)
+/// @see gtx_wide (dependence)
 ///
 /// @defgroup gtx_matrix_decompose GLM_GTX_matrix_decompose
 /// @ingroup gtx
 /// 
 /// @brief Decomposes a model matrix to translations, rotation and scale components
 /// 
+/// decompose() handles any matrix, with skew and perspective. Most model
+/// matrices only translate, rotate and scale; decomposeTRS() takes those
+/// apart without solving for the rest, and recomposeTRS() puts them back
+/// together. Their array versions process N matrices at a time in the
+/// GLM_GTX_wide lanes, at the width of GLM_ARCH, for importers and
+/// animation retargeting turning whole scenes into instance transforms.
+/// 
 /// <glm/gtx/decomposition.hpp> need to be included to use these functionalities.
 ///////////////////////////////////////////////////////////////////////////////////
 
@@ -47,6 +55,9 @@
 #include "../vec4.hpp"
 #include "../gtc/quaternion.hpp"
 #include "../gtc/matrix_transform.hpp"
+#include "../gtx/wide.hpp"
+#include <cstddef>
+#include <limits>
 
 #if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
 #	pragma message("GLM: GLM_GTX_matrix_decompose extension included")
@@ -64,6 +75,41 @@ namespace glm
 		tmat4x4<T, P> const & modelMatrix,
 		tvec3<T, P> & scale, tquat<T, P> & orientation, tvec3<T, P> & translation, tvec3<T, P> & skew, tvec4<T, P> & perspective);
 
+	/// Decomposes a model matrix made of a translation, a rotation and a scale,
+	/// modelMatrix = translate(translation) * mat4_cast(orientation) * scale(scale),
+	/// ignoring any skew and perspective. A mirroring matrix gets a negative
+	/// scale.x. Returns false, leaving the outputs as they are, if the matrix
+	/// is singular.
+	/// @see gtx_matrix_decompose
+	template <typename T, precision P>
+	GLM_FUNC_DECL bool decomposeTRS(
+		tmat4x4<T, P> const & modelMatrix,
+		tvec3<T, P> & scale, tquat<T, P> & orientation, tvec3<T, P> & translation);
+
+	/// decomposeTRS() of modelMatrices[i], N matrices at a time. Returns false
+	/// if any of them is singular, whose outputs are left as they are.
+	/// Results may differ from the one at a time decomposition by rounding.
+	/// @see gtx_matrix_decompose
+	template <typename T, precision P>
+	GLM_FUNC_DECL bool decomposeTRS(
+		tmat4x4<T, P> const * modelMatrices,
+		tvec3<T, P> * scale, tquat<T, P> * orientation, tvec3<T, P> * translation, std::size_t count);
+
+	/// Returns translate(translation) * mat4_cast(orientation) * scale(scale),
+	/// for a unit quaternion.
+	/// @see gtx_matrix_decompose
+	template <typename T, precision P>
+	GLM_FUNC_DECL tmat4x4<T, P> recomposeTRS(
+		tvec3<T, P> const & scale, tquat<T, P> const & orientation, tvec3<T, P> const & translation);
+
+	/// out[i] = recomposeTRS(scale[i], orientation[i], translation[i]), N
+	/// matrices at a time.
+	/// @see gtx_matrix_decompose
+	template <typename T, precision P>
+	GLM_FUNC_DECL void recomposeTRS(
+		tvec3<T, P> const * scale, tquat<T, P> const * orientation, tvec3<T, P> const * translation,
+		tmat4x4<T, P> * out, std::size_t count);
+
 	/// @}
 }//namespace glm
 
@@ -26,7 +26,7 @@
 ///
 /// @ref gtx_matrix_decompose
 /// @file glm/gtx/matrix_decompose.inl
-/// @date 2014-08-29 / 2014-08-29
+/// @date 2014-08-29 / 2026-10-15
 /// @author Christophe Riccio
 ///////////////////////////////////////////////////////////////////////////////////
 
@@ -228,4 +228,152 @@ namespace glm
 
 		return true;
 	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER bool decomposeTRS(tmat4x4<T, P> const & ModelMatrix, tvec3<T, P> & Scale, tquat<T, P> & Orientation, tvec3<T, P> & Translation)
+	{
+		tvec3<T, P> const Column[3] = {tvec3<T, P>(ModelMatrix[0]), tvec3<T, P>(ModelMatrix[1]), tvec3<T, P>(ModelMatrix[2])};
+
+		// The sign of the determinant tells a mirroring, put in the X scale
+		T const Determinant = dot(Column[0], cross(Column[1], Column[2]));
+		if(abs(Determinant) < std::numeric_limits<T>::min())
+			return false;
+
+		Scale = tvec3<T, P>(length(Column[0]), length(Column[1]), length(Column[2]));
+		if(Determinant < static_cast<T>(0))
+			Scale.x = -Scale.x;
+		Orientation = quat_cast(tmat3x3<T, P>(Column[0] / Scale.x, Column[1] / Scale.y, Column[2] / Scale.z));
+		Translation = tvec3<T, P>(ModelMatrix[3]);
+		return true;
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER tmat4x4<T, P> recomposeTRS(tvec3<T, P> const & Scale, tquat<T, P> const & Orientation, tvec3<T, P> const & Translation)
+	{
+		tmat3x3<T, P> const Rotation = mat3_cast(Orientation);
+		return tmat4x4<T, P>(
+			tvec4<T, P>(Rotation[0] * Scale.x, static_cast<T>(0)),
+			tvec4<T, P>(Rotation[1] * Scale.y, static_cast<T>(0)),
+			tvec4<T, P>(Rotation[2] * Scale.z, static_cast<T>(0)),
+			tvec4<T, P>(Translation, static_cast<T>(1)));
+	}
+
+namespace detail
+{
+	// N matrices taken apart as decomposeTRS does, the quaternions without
+	// branches: the largest of 4 w^2, 4 x^2, 4 y^2 and 4 z^2 sets the lanes'
+	// divisor as it picks the branch of quat_cast. Returns false if any of
+	// them is singular, before storing anything.
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER bool batch_decompose_trs(T const * in, T * scale, T * orientation, T * translation, bool StreamVec, bool StreamQuat)
+	{
+		typedef wide::scalar<T, N> lane;
+
+		wide::vec4<T, N> const c0 = compute_wide_aos4<T, N>::load(in + 0, 16);
+		wide::vec4<T, N> const c1 = compute_wide_aos4<T, N>::load(in + 4, 16);
+		wide::vec4<T, N> const c2 = compute_wide_aos4<T, N>::load(in + 8, 16);
+		wide::vec4<T, N> const c3 = compute_wide_aos4<T, N>::load(in + 12, 16);
+		wide::vec3<T, N> const x(c0.x, c0.y, c0.z);
+		wide::vec3<T, N> const y(c1.x, c1.y, c1.z);
+		wide::vec3<T, N> const z(c2.x, c2.y, c2.z);
+
+		lane const Determinant = wide::dot(x, wide::cross(y, z));
+		if(wide::lessThan(wide::abs(Determinant), lane(std::numeric_limits<T>::min())))
+			return false;
+
+		lane const One(static_cast<T>(1));
+		wide::vec3<T, N> const s(wide::flipSign(wide::length(x), Determinant), wide::length(y), wide::length(z));
+		wide::vec3<T, N> const r0 = x * (One / s.x);
+		wide::vec3<T, N> const r1 = y * (One / s.y);
+		wide::vec3<T, N> const r2 = z * (One / s.z);
+
+		// The four branches of quat_cast, in the order it tries them
+		lane const tw = One + r0.x + r1.y + r2.z;
+		lane const tx = One + r0.x - r1.y - r2.z;
+		lane const ty = One - r0.x + r1.y - r2.z;
+		lane const tz = One - r0.x - r1.y + r2.z;
+		lane const mw = wide::step(wide::max(tx, wide::max(ty, tz)), tw);
+		lane const mx = (One - mw) * wide::step(wide::max(ty, tz), tx);
+		lane const my = (One - mw - mx) * wide::step(tz, ty);
+		lane const mz = One - mw - mx - my;
+		lane const t = wide::max(wide::max(tw, tx), wide::max(ty, tz));
+		lane const k = lane(static_cast<T>(0.5)) * wide::inversesqrt(t);
+
+		lane const yz = r1.z - r2.y, zx = r2.x - r0.z, xy = r0.y - r1.x;
+		lane const YZ = r1.z + r2.y, ZX = r2.x + r0.z, XY = r0.y + r1.x;
+		wide::vec4<T, N> const q(
+			(mw * yz + mx * t + my * XY + mz * ZX) * k,
+			(mw * zx + mx * XY + my * t + mz * YZ) * k,
+			(mw * xy + mx * ZX + my * YZ + mz * t) * k,
+			(mw * t + mx * yz + my * zx + mz * xy) * k);
+
+		compute_wide_aos3<T, N>::store(s, scale, StreamVec);
+		compute_wide_aos4<T, N>::store(q, orientation, StreamQuat);
+		compute_wide_aos3<T, N>::store(wide::vec3<T, N>(c3.x, c3.y, c3.z), translation, StreamVec);
+		return true;
+	}
+}//namespace detail
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER bool decomposeTRS(tmat4x4<T, P> const * ModelMatrices, tvec3<T, P> * Scale, tquat<T, P> * Orientation, tvec3<T, P> * Translation, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tmat4x4<T, P>) == 16 * sizeof(T), "'decomposeTRS' requires tightly packed tmat4x4");
+		GLM_STATIC_ASSERT(sizeof(tquat<T, P>) == 4 * sizeof(T), "'decomposeTRS' requires tightly packed tquat");
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'decomposeTRS' requires tightly packed tvec3");
+
+		std::size_t const N = detail::wide_batch<T>::matrix_lanes;
+		bool const StreamVec = detail::batch_stream(Scale, count * sizeof(tvec3<T, P>)) && detail::batch_stream(Translation, count * sizeof(tvec3<T, P>));
+		bool const StreamQuat = detail::batch_stream(Orientation, count * sizeof(tquat<T, P>));
+		bool Result = true;
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			if(detail::batch_decompose_trs<T, N>(&ModelMatrices[i][0].x, &Scale[i].x, &Orientation[i].x, &Translation[i].x, StreamVec, StreamQuat))
+				continue;
+			// A singular matrix among them, one at a time
+			for(std::size_t j = i; j < i + N; ++j)
+				Result = decomposeTRS(ModelMatrices[j], Scale[j], Orientation[j], Translation[j]) && Result;
+		}
+		for(std::size_t k = 0, Remaining = count - i; k < Remaining; ++k)
+			Result = decomposeTRS(ModelMatrices[i + k], Scale[i + k], Orientation[i + k], Translation[i + k]) && Result;
+
+		detail::batch_fence(StreamVec || StreamQuat);
+		return Result;
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void recomposeTRS(tvec3<T, P> const * Scale, tquat<T, P> const * Orientation, tvec3<T, P> const * Translation, tmat4x4<T, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tmat4x4<T, P>) == 16 * sizeof(T), "'recomposeTRS' requires tightly packed tmat4x4");
+		GLM_STATIC_ASSERT(sizeof(tquat<T, P>) == 4 * sizeof(T), "'recomposeTRS' requires tightly packed tquat");
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'recomposeTRS' requires tightly packed tvec3");
+
+		std::size_t const N = detail::wide_batch<T>::matrix_lanes;
+		bool const Stream = detail::batch_stream(out, count * sizeof(tmat4x4<T, P>));
+		wide::scalar<T, N> const Zero(static_cast<T>(0));
+		wide::scalar<T, N> const One(static_cast<T>(1));
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			wide::vec3<T, N> const s = detail::compute_wide_aos3<T, N>::load(&Scale[i].x);
+			wide::vec4<T, N> const r = detail::compute_wide_aos4<T, N>::load(&Orientation[i].x);
+			wide::vec3<T, N> const t = detail::compute_wide_aos3<T, N>::load(&Translation[i].x);
+			wide::vec4<T, N> const r2 = r + r;
+			wide::scalar<T, N> const xx = r.x * r2.x, yy = r.y * r2.y, zz = r.z * r2.z;
+			wide::scalar<T, N> const xy = r.x * r2.y, xz = r.x * r2.z, yz = r.y * r2.z;
+			wide::scalar<T, N> const wx = r.w * r2.x, wy = r.w * r2.y, wz = r.w * r2.z;
+
+			T * po = &out[i][0].x;
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>((One - (yy + zz)) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, Zero), po + 0, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>((xy - wz) * s.y, (One - (xx + zz)) * s.y, (yz + wx) * s.y, Zero), po + 4, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>((xz + wy) * s.z, (yz - wx) * s.z, (One - (xx + yy)) * s.z, Zero), po + 8, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(t, One), po + 12, Stream, 16);
+		}
+		for(std::size_t k = 0, Remaining = count - i; k < Remaining; ++k)
+			out[i + k] = recomposeTRS(Scale[i + k], Orientation[i + k], Translation[i + k]);
+
+		detail::batch_fence(Stream);
+	}
 }//namespace glm
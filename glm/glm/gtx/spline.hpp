@@ -26,16 +26,27 @@
 ///
 /// @ref gtx_spline
 /// @file glm/gtx/spline.hpp
-/// @date 2007-01-25 / 2011-06-07
+/// @date 2007-01-25 / 2026-10-15
 /// @author Christophe Riccio
 ///
 /// @see core (dependence)
+/// @see gtx_wide (dependence)
 ///
 /// @defgroup gtx_spline GLM_GTX_spline
 /// @ingroup gtx
 /// 
 /// @brief Spline functions
 /// 
+/// catmullRom(), hermite() and cubic() evaluate one point of one curve.
+/// Camera paths, particle trails and animation rigs evaluate thousands of
+/// them per frame, so the batch functions take whole arrays: the control
+/// points of N curves are transposed into GLM_GTX_wide registers and the
+/// weights of the four points are computed once for all components, at the
+/// width of GLM_ARCH. catmullRomPath() evaluates one path through an array
+/// of points at many parameters, and arcLengthTable() and
+/// arcLengthParameters() reparameterize it by distance, from a table
+/// computed once per path, so a camera moves along it at a constant speed.
+/// 
 /// <glm/gtx/spline.hpp> need to be included to use these functionalities.
 ///////////////////////////////////////////////////////////////////////////////////
 
@@ -44,6 +55,8 @@
 // Dependency:
 #include "../glm.hpp"
 #include "../gtx/optimum_pow.hpp"
+#include "../gtx/wide.hpp"
+#include <cstddef>
 
 #if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
 #	pragma message("GLM: GLM_GTX_spline extension included")
@@ -84,6 +97,67 @@ namespace glm
 		genType const & v4, 
 		typename genType::value_type const & s);
 
+	/// out[i] = catmullRom(v1[i], v2[i], v3[i], v4[i], s[i]), N curves at a
+	/// time. out may be any of the inputs.
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void catmullRomSplines(tvec3<T, P> const * v1, tvec3<T, P> const * v2, tvec3<T, P> const * v3, tvec3<T, P> const * v4, T const * s, tvec3<T, P> * out, std::size_t count);
+
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void catmullRomSplines(tvec4<T, P> const * v1, tvec4<T, P> const * v2, tvec4<T, P> const * v3, tvec4<T, P> const * v4, T const * s, tvec4<T, P> * out, std::size_t count);
+
+	/// out[i] = hermite(v1[i], t1[i], v2[i], t2[i], s[i]), N curves at a
+	/// time. out may be any of the inputs.
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void hermiteSplines(tvec3<T, P> const * v1, tvec3<T, P> const * t1, tvec3<T, P> const * v2, tvec3<T, P> const * t2, T const * s, tvec3<T, P> * out, std::size_t count);
+
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void hermiteSplines(tvec4<T, P> const * v1, tvec4<T, P> const * t1, tvec4<T, P> const * v2, tvec4<T, P> const * t2, T const * s, tvec4<T, P> * out, std::size_t count);
+
+	/// out[i] = cubic(v1[i], v2[i], v3[i], v4[i], s[i]), N curves at a time.
+	/// out may be any of the inputs.
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void cubicSplines(tvec3<T, P> const * v1, tvec3<T, P> const * v2, tvec3<T, P> const * v3, tvec3<T, P> const * v4, T const * s, tvec3<T, P> * out, std::size_t count);
+
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void cubicSplines(tvec4<T, P> const * v1, tvec4<T, P> const * v2, tvec4<T, P> const * v3, tvec4<T, P> const * v4, T const * s, tvec4<T, P> * out, std::size_t count);
+
+	/// out[i] = the point at s[i] of the Catmull-Rom path through the
+	/// pointCount >= 1 points: the whole part of s[i] selects the segment from
+	/// points[k] to points[k + 1], the fraction the point on it, and the first
+	/// and last points are repeated for the segments at the ends. s[i] is
+	/// clamped to [0, pointCount - 1].
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void catmullRomPath(tvec3<T, P> const * points, std::size_t pointCount, T const * s, tvec3<T, P> * out, std::size_t count);
+
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void catmullRomPath(tvec4<T, P> const * points, std::size_t pointCount, T const * s, tvec4<T, P> * out, std::size_t count);
+
+	/// lengths[j] = the length of the catmullRomPath through points from s = 0
+	/// to s = j * (pointCount - 1) / samples, for j from 0 to samples, so
+	/// lengths holds samples + 1 values and lengths[samples] is the length of
+	/// the whole path. The length is that of the chords between the samples,
+	/// a few per segment are enough for a smooth path.
+	/// @see gtx_spline extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void arcLengthTable(tvec3<T, P> const * points, std::size_t pointCount, T * lengths, std::size_t samples);
+
+	/// s[i] = the parameter of catmullRomPath at distances[i] along the path of
+	/// pointCount points whose table arcLengthTable computed, by a binary
+	/// search in the table and a linear interpolation between its samples.
+	/// Distances out of [0, lengths[samples]] are clamped. Evaluated at even
+	/// distances, the path moves at a constant speed.
+	/// @see gtx_spline extension.
+	template <typename T>
+	GLM_FUNC_DECL void arcLengthParameters(T const * lengths, std::size_t samples, std::size_t pointCount, T const * distances, T * s, std::size_t count);
+
 	/// @}
 }//namespace glm
 
@@ -26,7 +26,7 @@
 ///
 /// @ref gtx_spline
 /// @file glm/gtx/spline.inl
-/// @date 2007-01-25 / 2011-06-07
+/// @date 2007-01-25 / 2026-10-15
 /// @author Christophe Riccio
 ///////////////////////////////////////////////////////////////////////////////////
 
@@ -89,4 +89,242 @@ namespace glm
 	{
 		return ((v1 * s + v2) * s + v3) * s + v4;
 	}
+
+namespace detail
+{
+	enum batch_spline_kind
+	{
+		BATCH_CATMULL_ROM,
+		BATCH_HERMITE,
+		BATCH_CUBIC
+	};
+
+	// N values of C components to and from the lanes
+	template <typename T, std::size_t N, std::size_t C>
+	struct batch_spline_io;
+
+	template <typename T, std::size_t N>
+	struct batch_spline_io<T, N, 3>
+	{
+		typedef wide::vec3<T, N> type;
+
+		GLM_FUNC_QUALIFIER static type load(T const * in)
+		{
+			return compute_wide_aos3<T, N>::load(in);
+		}
+
+		GLM_FUNC_QUALIFIER static void store(type const & v, T * out, bool Stream)
+		{
+			compute_wide_aos3<T, N>::store(v, out, Stream);
+		}
+	};
+
+	template <typename T, std::size_t N>
+	struct batch_spline_io<T, N, 4>
+	{
+		typedef wide::vec4<T, N> type;
+
+		GLM_FUNC_QUALIFIER static type load(T const * in)
+		{
+			return compute_wide_aos4<T, N>::load(in);
+		}
+
+		GLM_FUNC_QUALIFIER static void store(type const & v, T * out, bool Stream)
+		{
+			compute_wide_aos4<T, N>::store(v, out, Stream);
+		}
+	};
+
+	// The weights of the four arguments of catmullRom and hermite at s, in
+	// Horner form
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER void batch_spline_weights(batch_spline_kind Kind, wide::scalar<T, N> const & s, wide::scalar<T, N> * f)
+	{
+		typedef wide::scalar<T, N> lane;
+
+		lane const One(static_cast<T>(1));
+		lane const s2 = s * s;
+		if(Kind == BATCH_CATMULL_ROM)
+		{
+			lane const Half(static_cast<T>(0.5));
+			f[0] = Half * s * wide::fma(s, lane(static_cast<T>(2)) - s, -One);
+			f[1] = Half * wide::fma(s2, wide::fma(lane(static_cast<T>(3)), s, lane(static_cast<T>(-5))), lane(static_cast<T>(2)));
+			f[2] = Half * s * wide::fma(s, wide::fma(lane(static_cast<T>(-3)), s, lane(static_cast<T>(4))), One);
+			f[3] = Half * s2 * (s - One);
+		}
+		else
+		{
+			// v1, t1, v2, t2
+			f[0] = wide::fma(s2, wide::fma(lane(static_cast<T>(2)), s, lane(static_cast<T>(-3))), One);
+			f[1] = s * wide::fma(s, s - lane(static_cast<T>(2)), One);
+			f[2] = s2 * wide::fma(lane(static_cast<T>(-2)), s, lane(static_cast<T>(3)));
+			f[3] = s2 * (s - One);
+		}
+	}
+
+	// N curves of Kind at the parameters s, from the four arguments of each
+	template <typename T, std::size_t N, std::size_t C>
+	GLM_FUNC_QUALIFIER void batch_spline(batch_spline_kind Kind, T const * a, T const * b, T const * c, T const * d, T const * s, T * out, bool Stream)
+	{
+		typedef batch_spline_io<T, N, C> io;
+
+		wide::scalar<T, N> const t = compute_wide_gather<T, N>::gather(s, 1);
+		if(Kind == BATCH_CUBIC)
+		{
+			io::store(((io::load(a) * t + io::load(b)) * t + io::load(c)) * t + io::load(d), out, Stream);
+			return;
+		}
+		wide::scalar<T, N> f[4];
+		batch_spline_weights(Kind, t, f);
+		io::store(io::load(a) * f[0] + io::load(b) * f[1] + io::load(c) * f[2] + io::load(d) * f[3], out, Stream);
+	}
+
+	template <typename T, std::size_t C, typename V>
+	GLM_FUNC_QUALIFIER void batch_splines(batch_spline_kind Kind, V const * a, V const * b, V const * c, V const * d, T const * s, V * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(V) == C * sizeof(T), "The batch spline functions require tightly packed vectors");
+
+		std::size_t const N = wide_batch<T>::lanes;
+		bool const Stream = batch_stream(out, count * sizeof(V));
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+			batch_spline<T, N, C>(Kind, &a[i][0], &b[i][0], &c[i][0], &d[i][0], s + i, &out[i][0], Stream);
+		if(i < count)
+		{
+			T A[N * C], B[N * C], Cs[N * C], D[N * C], S[N], Out[N * C];
+			batch_pad<N>(&a[i][0], C, count - i, A);
+			batch_pad<N>(&b[i][0], C, count - i, B);
+			batch_pad<N>(&c[i][0], C, count - i, Cs);
+			batch_pad<N>(&d[i][0], C, count - i, D);
+			batch_pad<N>(s + i, 1, count - i, S);
+			batch_spline<T, N, C>(Kind, A, B, Cs, D, S, Out, false);
+			for(std::size_t j = 0; i + j < count; ++j)
+			for(std::size_t k = 0; k < C; ++k)
+				out[i + j][k] = Out[j * C + k];
+		}
+
+		batch_fence(Stream);
+	}
+
+	// The path a point at a time: finding the segment of each parameter
+	// costs more than weighting its points, and the points of neighbouring
+	// parameters are mostly the same, so it gains nothing from the lanes
+	template <typename T, typename V>
+	GLM_FUNC_QUALIFIER void batch_path(V const * points, std::size_t pointCount, T const * s, V * out, std::size_t count)
+	{
+		if(pointCount == 0)
+			return;
+
+		std::size_t const Last = pointCount - 1;
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			T const p = glm::clamp(s[i], static_cast<T>(0), static_cast<T>(Last));
+			std::size_t k = static_cast<std::size_t>(p);
+			if(k >= Last)
+				k = Last > 0 ? Last - 1 : 0;
+			out[i] = catmullRom(
+				points[k > 0 ? k - 1 : 0], points[k],
+				points[k + 1 <= Last ? k + 1 : Last], points[k + 2 <= Last ? k + 2 : Last],
+				p - static_cast<T>(k));
+		}
+	}
+}//namespace detail
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void catmullRomSplines(tvec3<T, P> const * v1, tvec3<T, P> const * v2, tvec3<T, P> const * v3, tvec3<T, P> const * v4, T const * s, tvec3<T, P> * out, std::size_t count)
+	{
+		detail::batch_splines<T, 3>(detail::BATCH_CATMULL_ROM, v1, v2, v3, v4, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void catmullRomSplines(tvec4<T, P> const * v1, tvec4<T, P> const * v2, tvec4<T, P> const * v3, tvec4<T, P> const * v4, T const * s, tvec4<T, P> * out, std::size_t count)
+	{
+		detail::batch_splines<T, 4>(detail::BATCH_CATMULL_ROM, v1, v2, v3, v4, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void hermiteSplines(tvec3<T, P> const * v1, tvec3<T, P> const * t1, tvec3<T, P> const * v2, tvec3<T, P> const * t2, T const * s, tvec3<T, P> * out, std::size_t count)
+	{
+		detail::batch_splines<T, 3>(detail::BATCH_HERMITE, v1, t1, v2, t2, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void hermiteSplines(tvec4<T, P> const * v1, tvec4<T, P> const * t1, tvec4<T, P> const * v2, tvec4<T, P> const * t2, T const * s, tvec4<T, P> * out, std::size_t count)
+	{
+		detail::batch_splines<T, 4>(detail::BATCH_HERMITE, v1, t1, v2, t2, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void cubicSplines(tvec3<T, P> const * v1, tvec3<T, P> const * v2, tvec3<T, P> const * v3, tvec3<T, P> const * v4, T const * s, tvec3<T, P> * out, std::size_t count)
+	{
+		detail::batch_splines<T, 3>(detail::BATCH_CUBIC, v1, v2, v3, v4, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void cubicSplines(tvec4<T, P> const * v1, tvec4<T, P> const * v2, tvec4<T, P> const * v3, tvec4<T, P> const * v4, T const * s, tvec4<T, P> * out, std::size_t count)
+	{
+		detail::batch_splines<T, 4>(detail::BATCH_CUBIC, v1, v2, v3, v4, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void catmullRomPath(tvec3<T, P> const * points, std::size_t pointCount, T const * s, tvec3<T, P> * out, std::size_t count)
+	{
+		detail::batch_path<T>(points, pointCount, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void catmullRomPath(tvec4<T, P> const * points, std::size_t pointCount, T const * s, tvec4<T, P> * out, std::size_t count)
+	{
+		detail::batch_path<T>(points, pointCount, s, out, count);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void arcLengthTable(tvec3<T, P> const * points, std::size_t pointCount, T * lengths, std::size_t samples)
+	{
+		// the samples are evaluated in chunks, the first point of a chunk
+		// is the last of the one before
+		std::size_t const Chunk = 64;
+		T S[Chunk + 1];
+		tvec3<T, P> Points[Chunk + 1];
+
+		if(samples == 0)
+			return;
+		T const Step = static_cast<T>(pointCount > 0 ? pointCount - 1 : 0) / static_cast<T>(samples);
+		lengths[0] = static_cast<T>(0);
+		for(std::size_t j = 0; j < samples; j += Chunk)
+		{
+			std::size_t const Count = samples - j < Chunk ? samples - j : Chunk;
+			for(std::size_t k = 0; k <= Count; ++k)
+				S[k] = static_cast<T>(j + k) * Step;
+			catmullRomPath(points, pointCount, S, Points, Count + 1);
+			for(std::size_t k = 1; k <= Count; ++k)
+				lengths[j + k] = lengths[j + k - 1] + length(Points[k] - Points[k - 1]);
+		}
+	}
+
+	template <typename T>
+	GLM_FUNC_QUALIFIER void arcLengthParameters(T const * lengths, std::size_t samples, std::size_t pointCount, T const * distances, T * s, std::size_t count)
+	{
+		T const Step = static_cast<T>(pointCount > 0 ? pointCount - 1 : 0) / static_cast<T>(samples > 0 ? samples : 1);
+		T const Total = lengths[samples];
+
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			T const d = glm::clamp(distances[i], static_cast<T>(0), Total);
+			// the last sample at or before d
+			std::size_t Low = 0, High = samples;
+			while(High - Low > 1)
+			{
+				std::size_t const Mid = (Low + High) / 2;
+				if(lengths[Mid] <= d)
+					Low = Mid;
+				else
+					High = Mid;
+			}
+			T const Span = lengths[High] - lengths[Low];
+			T const f = Span > static_cast<T>(0) ? (d - lengths[Low]) / Span : static_cast<T>(0);
+			s[i] = (static_cast<T>(Low) + glm::clamp(f, static_cast<T>(0), static_cast<T>(1))) * Step;
+		}
+	}
 }//namespace glm
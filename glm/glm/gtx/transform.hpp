@@ -61,7 +61,7 @@ namespace glm
 	/// @see gtc_matrix_transform
 	/// @see gtx_transform
 	template <typename T, precision P>
-	GLM_FUNC_DECL tmat4x4<T, P> translate(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, P> translate(
 		tvec3<T, P> const & v);
 
 	/// Builds a rotation 4 * 4 matrix created from an axis of 3 scalars and an angle expressed in degrees. 
@@ -76,7 +76,7 @@ namespace glm
 	/// @see gtc_matrix_transform
 	/// @see gtx_transform
 	template <typename T, precision P>
-	GLM_FUNC_DECL tmat4x4<T, P> scale(
+	GLM_FUNC_DECL GLM_CONSTEXPR_CXX14 tmat4x4<T, P> scale(
 		tvec3<T, P> const & v);
 
 	/// @}
@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide
+/// @file glm/gtx/wide.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// @see core (dependence)
+/// @see gtc_matrix_inverse (dependence)
+///
+/// @defgroup gtx_wide GLM_GTX_wide
+/// @ingroup gtx
+/// 
+/// @brief Structure of arrays vector types, processing N values at once.
+/// 
+/// glm::tvec3 and glm::tvec4 store the components of one value side by side,
+/// so transforming an array of them leaves most SIMD lanes idle. The types of
+/// this extension store N values with each component in its own register
+/// (wide::vec3<float, 8> holds the x of 8 vectors in one AVX register, their
+/// y in another one and their z in a third one): every lane does useful work
+/// and no shuffle is needed between the components.
+/// 
+/// wide::scalar<T, N> is the register; wide::vec3 and wide::vec4 are built
+/// from them. The arithmetic of wide::scalar uses SSE2 for float and double
+/// at N = 4 and N = 2, AVX at N = 8 and N = 4, and plain loops, which the
+/// compiler may vectorize, otherwise: N is best chosen to match GLM_ARCH.
+/// load() and store() transpose from and to arrays of tvec3 and tvec4, with
+/// shuffles at these widths.
+/// transformPoints(), multiplyMatrices(), affineInverses() and normalMatrices()
+/// process whole arrays at the width of GLM_ARCH, for the callers which
+/// transform many points or matrices at a time (a scene graph updating its
+/// nodes). multiplyMatrices() also uses AVX on x86-64 when the CPU has AVX2,
+/// whatever GLM_ARCH says; the others are bound to the registers of the wide
+/// types, which GLM_ARCH sets.
+/// 
+/// <glm/gtx/wide.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/matrix_inverse.hpp"
+#include "../detail/_dispatch.hpp"
+#include <cstddef>
+
+// Batch functions writing at least this many bytes, 32 bytes aligned, use
+// streaming stores which do not evict the caches
+#ifndef GLM_WIDE_STREAM_BYTES
+#	define GLM_WIDE_STREAM_BYTES (1 << 20)
+#endif
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_wide extension included")
+#endif
+
+namespace glm{
+namespace detail
+{
+	template <typename T, std::size_t N>
+	struct wide_simd
+	{
+		typedef T type[N];
+	};
+
+#	if GLM_ARCH & GLM_ARCH_SSE2
+		template <>
+		struct wide_simd<float, 4>
+		{
+			typedef __m128 type;
+		};
+
+		template <>
+		struct wide_simd<double, 2>
+		{
+			typedef __m128d type;
+		};
+#	endif
+
+#	if GLM_ARCH & GLM_ARCH_AVX
+		template <>
+		struct wide_simd<float, 8>
+		{
+			typedef __m256 type;
+		};
+
+		template <>
+		struct wide_simd<double, 4>
+		{
+			typedef __m256d type;
+		};
+#	endif
+}//namespace detail
+
+namespace wide
+{
+	/// @addtogroup gtx_wide
+	/// @{
+
+	/// N lanes of type T, one component of N vectors.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	struct scalar
+	{
+		typedef T value_type;
+		static std::size_t const lanes = N;
+
+		union
+		{
+			T lane[N];
+			typename detail::wide_simd<T, N>::type data;
+		};
+
+		GLM_FUNC_DECL scalar();
+		GLM_FUNC_DECL explicit scalar(ctor);
+		GLM_FUNC_DECL scalar(T s);
+
+		GLM_FUNC_DECL T & operator[](std::size_t i);
+		GLM_FUNC_DECL T const & operator[](std::size_t i) const;
+	};
+
+	/// N three components vectors, one wide::scalar per component.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	struct vec3
+	{
+		typedef T value_type;
+		typedef scalar<T, N> lane_type;
+		static std::size_t const lanes = N;
+
+		scalar<T, N> x, y, z;
+
+		GLM_FUNC_DECL vec3();
+		GLM_FUNC_DECL vec3(scalar<T, N> const & x, scalar<T, N> const & y, scalar<T, N> const & z);
+		/// The same vector in all lanes.
+		template <precision P>
+		GLM_FUNC_DECL explicit vec3(tvec3<T, P> const & v);
+
+		/// The vector in lane i.
+		GLM_FUNC_DECL tvec3<T, defaultp> at(std::size_t i) const;
+	};
+
+	/// N four components vectors, one wide::scalar per component.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	struct vec4
+	{
+		typedef T value_type;
+		typedef scalar<T, N> lane_type;
+		static std::size_t const lanes = N;
+
+		scalar<T, N> x, y, z, w;
+
+		GLM_FUNC_DECL vec4();
+		GLM_FUNC_DECL vec4(scalar<T, N> const & x, scalar<T, N> const & y, scalar<T, N> const & z, scalar<T, N> const & w);
+		GLM_FUNC_DECL vec4(vec3<T, N> const & v, scalar<T, N> const & w);
+		/// The same vector in all lanes.
+		template <precision P>
+		GLM_FUNC_DECL explicit vec4(tvec4<T, P> const & v);
+
+		/// The vector in lane i.
+		GLM_FUNC_DECL tvec4<T, defaultp> at(std::size_t i) const;
+	};
+
+	template <typename T, std::size_t N> GLM_FUNC_DECL scalar<T, N> operator+(scalar<T, N> const & a, scalar<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL scalar<T, N> operator-(scalar<T, N> const & a, scalar<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL scalar<T, N> operator*(scalar<T, N> const & a, scalar<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL scalar<T, N> operator/(scalar<T, N> const & a, scalar<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL scalar<T, N> operator-(scalar<T, N> const & a);
+
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator+(vec3<T, N> const & a, vec3<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator-(vec3<T, N> const & a, vec3<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator*(vec3<T, N> const & a, vec3<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator*(vec3<T, N> const & a, scalar<T, N> const & s);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator*(scalar<T, N> const & s, vec3<T, N> const & a);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator/(vec3<T, N> const & a, scalar<T, N> const & s);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec3<T, N> operator-(vec3<T, N> const & a);
+
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator+(vec4<T, N> const & a, vec4<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator-(vec4<T, N> const & a, vec4<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator*(vec4<T, N> const & a, vec4<T, N> const & b);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator*(vec4<T, N> const & a, scalar<T, N> const & s);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator*(scalar<T, N> const & s, vec4<T, N> const & a);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator/(vec4<T, N> const & a, scalar<T, N> const & s);
+	template <typename T, std::size_t N> GLM_FUNC_DECL vec4<T, N> operator-(vec4<T, N> const & a);
+
+	/// a * b + c, fused when GLM_HAS_FMA.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> fma(scalar<T, N> const & a, scalar<T, N> const & b, scalar<T, N> const & c);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> sqrt(scalar<T, N> const & x);
+
+	/// 1 / sqrt(x).
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> inversesqrt(scalar<T, N> const & x);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> min(scalar<T, N> const & a, scalar<T, N> const & b);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> max(scalar<T, N> const & a, scalar<T, N> const & b);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> floor(scalar<T, N> const & x);
+
+	/// x - floor(x).
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> fract(scalar<T, N> const & x);
+
+	/// 0 in the lanes where x < edge, 1 in the others, as glm::step.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> step(scalar<T, N> const & edge, scalar<T, N> const & x);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> abs(scalar<T, N> const & x);
+
+	/// x with its sign flipped in the lanes where s is negative.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> flipSign(scalar<T, N> const & x, scalar<T, N> const & s);
+
+	/// Bit i is set if a < b in lane i. N must not exceed 32.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL unsigned int lessThan(scalar<T, N> const & a, scalar<T, N> const & b);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> dot(vec3<T, N> const & a, vec3<T, N> const & b);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> dot(vec4<T, N> const & a, vec4<T, N> const & b);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL vec3<T, N> cross(vec3<T, N> const & a, vec3<T, N> const & b);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> length(vec3<T, N> const & v);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> length(vec4<T, N> const & v);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL vec3<T, N> normalize(vec3<T, N> const & v);
+
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL vec4<T, N> normalize(vec4<T, N> const & v);
+
+	/// m * v in every lane.
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P, std::size_t N>
+	GLM_FUNC_DECL vec4<T, N> operator*(tmat4x4<T, P> const & m, vec4<T, N> const & v);
+
+	/// The xyz of m * vec4(p, 1) in every lane, for affine matrices.
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P, std::size_t N>
+	GLM_FUNC_DECL vec3<T, N> transformPoint(tmat4x4<T, P> const & m, vec3<T, N> const & p);
+
+	/// The xyz of m * vec4(v, 0) in every lane.
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P, std::size_t N>
+	GLM_FUNC_DECL vec3<T, N> transformVector(tmat4x4<T, P> const & m, vec3<T, N> const & v);
+
+	/// The N vectors starting at in, transposed into the lanes.
+	/// From GLM_GTX_wide extension.
+	template <std::size_t N, typename T, precision P>
+	GLM_FUNC_DECL vec3<T, N> load(tvec3<T, P> const * in);
+
+	/// The N vectors starting at in, transposed into the lanes.
+	/// From GLM_GTX_wide extension.
+	template <std::size_t N, typename T, precision P>
+	GLM_FUNC_DECL vec4<T, N> load(tvec4<T, P> const * in);
+
+	/// Write the N vectors of the lanes to out.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_DECL void store(vec3<T, N> const & v, tvec3<T, P> * out);
+
+	/// Write the N vectors of the lanes to out.
+	/// From GLM_GTX_wide extension.
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_DECL void store(vec4<T, N> const & v, tvec4<T, P> * out);
+
+	/// @}
+}//namespace wide
+
+	/// @addtogroup gtx_wide
+	/// @{
+
+	/// out[i] = the xyz of m * vec4(in[i], 1), for affine matrices, N points
+	/// at a time. in and out may be the same array. Results may differ from
+	/// the one at a time product by rounding, the lanes use fma.
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void transformPoints(tmat4x4<T, P> const & m, tvec3<T, P> const * in, tvec3<T, P> * out, std::size_t count);
+
+	/// out[i] = a[i] * b[i]. out may be a or b.
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void multiplyMatrices(tmat4x4<T, P> const * a, tmat4x4<T, P> const * b, tmat4x4<T, P> * out, std::size_t count);
+
+	/// out[i] = affineInverse(in[i]), N matrices at a time. The matrices may
+	/// only rotate, scale, shear and translate. out may be in.
+	/// @see gtc_matrix_inverse
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void affineInverses(tmat4x4<T, P> const * in, tmat4x4<T, P> * out, std::size_t count);
+
+	/// out[i] = inverseTranspose(tmat3x3(in[i])), the matrices transforming
+	/// the normals, N matrices at a time.
+	/// @see gtc_matrix_inverse
+	/// From GLM_GTX_wide extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void normalMatrices(tmat4x4<T, P> const * in, tmat3x3<T, P> * out, std::size_t count);
+
+	/// @}
+}//namespace glm
+
+#include "wide.inl"
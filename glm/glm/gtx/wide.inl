@@ -0,0 +1,1346 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide
+/// @file glm/gtx/wide.inl
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+namespace glm{
+namespace detail
+{
+	template <typename T, std::size_t N>
+	struct compute_wide
+	{
+		typedef wide::scalar<T, N> type;
+
+		GLM_FUNC_QUALIFIER static type set(T s)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = s;
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type add(type const & a, type const & b)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] + b.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type sub(type const & a, type const & b)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] - b.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type mul(type const & a, type const & b)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] * b.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type div(type const & a, type const & b)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] / b.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type neg(type const & a)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = -a.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type fma(type const & a, type const & b, type const & c)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] * b.lane[i] + c.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type sqrt(type const & a)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = std::sqrt(a.lane[i]);
+			return Result;
+		}
+
+		// as glm::min and glm::max
+		GLM_FUNC_QUALIFIER static type min(type const & a, type const & b)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = b.lane[i] < a.lane[i] ? b.lane[i] : a.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type max(type const & a, type const & b)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] < b.lane[i] ? b.lane[i] : a.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type floor(type const & a)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = std::floor(a.lane[i]);
+			return Result;
+		}
+
+		// as glm::step
+		GLM_FUNC_QUALIFIER static type step(type const & edge, type const & x)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = x.lane[i] < edge.lane[i] ? static_cast<T>(0) : static_cast<T>(1);
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type abs(type const & a)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = a.lane[i] < static_cast<T>(0) ? -a.lane[i] : a.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static type flipSign(type const & a, type const & s)
+		{
+			type Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = s.lane[i] < static_cast<T>(0) ? -a.lane[i] : a.lane[i];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static unsigned int lessThan(type const & a, type const & b)
+		{
+			unsigned int Result = 0;
+			for(std::size_t i = 0; i < N; ++i)
+				Result |= (a.lane[i] < b.lane[i] ? 1u : 0u) << i;
+			return Result;
+		}
+	};
+
+#	if GLM_ARCH & GLM_ARCH_SSE2
+		// Without SSE4.1 floor truncates to int and corrects the negatives.
+		// Floats from 2^23 up are integers already; doubles out of the int
+		// range, rare, go through std::floor
+		GLM_FUNC_QUALIFIER __m128 floor_sse2(__m128 x)
+		{
+			__m128 const One = _mm_set1_ps(1.0f);
+			__m128 const Trunc = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			__m128 const Floor = _mm_sub_ps(Trunc, _mm_and_ps(_mm_cmplt_ps(x, Trunc), One));
+			__m128 const Large = _mm_cmpnlt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), _mm_set1_ps(8388608.0f));
+			return _mm_or_ps(_mm_and_ps(Large, x), _mm_andnot_ps(Large, Floor));
+		}
+
+		GLM_FUNC_QUALIFIER __m128d floor_sse2(__m128d x)
+		{
+			__m128d const Large = _mm_cmpnlt_pd(_mm_andnot_pd(_mm_set1_pd(-0.0), x), _mm_set1_pd(2147483647.0));
+			if(_mm_movemask_pd(Large))
+			{
+				double Lanes[2];
+				_mm_storeu_pd(Lanes, x);
+				return _mm_set_pd(std::floor(Lanes[1]), std::floor(Lanes[0]));
+			}
+			__m128d const Trunc = _mm_cvtepi32_pd(_mm_cvttpd_epi32(x));
+			return _mm_sub_pd(Trunc, _mm_and_pd(_mm_cmplt_pd(x, Trunc), _mm_set1_pd(1.0)));
+		}
+#	endif
+
+	// The SSE2 and AVX versions only differ in the prefix and the suffix of the intrinsics
+#	define GLM_WIDE_SIMD(T, N, PREFIX, SUFFIX, CMPLT, FLOOR) \
+	template <> \
+	struct compute_wide<T, N> \
+	{ \
+		typedef wide::scalar<T, N> type; \
+		typedef wide_simd<T, N>::type simd; \
+		\
+		GLM_FUNC_QUALIFIER static type wrap(simd d) \
+		{ \
+			type Result(uninitialize); \
+			Result.data = d; \
+			return Result; \
+		} \
+		\
+		GLM_FUNC_QUALIFIER static type set(T s) {return wrap(PREFIX##_set1_##SUFFIX(s));} \
+		GLM_FUNC_QUALIFIER static type add(type const & a, type const & b) {return wrap(PREFIX##_add_##SUFFIX(a.data, b.data));} \
+		GLM_FUNC_QUALIFIER static type sub(type const & a, type const & b) {return wrap(PREFIX##_sub_##SUFFIX(a.data, b.data));} \
+		GLM_FUNC_QUALIFIER static type mul(type const & a, type const & b) {return wrap(PREFIX##_mul_##SUFFIX(a.data, b.data));} \
+		GLM_FUNC_QUALIFIER static type div(type const & a, type const & b) {return wrap(PREFIX##_div_##SUFFIX(a.data, b.data));} \
+		GLM_FUNC_QUALIFIER static type neg(type const & a) {return wrap(PREFIX##_xor_##SUFFIX(a.data, PREFIX##_set1_##SUFFIX(T(-0.0))));} \
+		GLM_FUNC_QUALIFIER static type fma(type const & a, type const & b, type const & c) {return wrap(GLM_WIDE_FMA(PREFIX, SUFFIX, a.data, b.data, c.data));} \
+		GLM_FUNC_QUALIFIER static type sqrt(type const & a) {return wrap(PREFIX##_sqrt_##SUFFIX(a.data));} \
+		GLM_FUNC_QUALIFIER static type min(type const & a, type const & b) {return wrap(PREFIX##_min_##SUFFIX(b.data, a.data));} \
+		GLM_FUNC_QUALIFIER static type max(type const & a, type const & b) {return wrap(PREFIX##_max_##SUFFIX(b.data, a.data));} \
+		GLM_FUNC_QUALIFIER static type floor(type const & a) {return wrap(FLOOR(a.data));} \
+		GLM_FUNC_QUALIFIER static type step(type const & edge, type const & x) {return wrap(PREFIX##_andnot_##SUFFIX(CMPLT(x.data, edge.data), PREFIX##_set1_##SUFFIX(T(1))));} \
+		GLM_FUNC_QUALIFIER static type abs(type const & a) {return wrap(PREFIX##_andnot_##SUFFIX(PREFIX##_set1_##SUFFIX(T(-0.0)), a.data));} \
+		GLM_FUNC_QUALIFIER static type flipSign(type const & a, type const & s) {return wrap(PREFIX##_xor_##SUFFIX(a.data, PREFIX##_and_##SUFFIX(s.data, PREFIX##_set1_##SUFFIX(T(-0.0)))));} \
+		GLM_FUNC_QUALIFIER static unsigned int lessThan(type const & a, type const & b) {return static_cast<unsigned int>(PREFIX##_movemask_##SUFFIX(CMPLT(a.data, b.data)));} \
+	};
+
+#	if GLM_HAS_FMA
+#		define GLM_WIDE_FMA(PREFIX, SUFFIX, a, b, c) PREFIX##_fmadd_##SUFFIX(a, b, c)
+#	else
+#		define GLM_WIDE_FMA(PREFIX, SUFFIX, a, b, c) PREFIX##_add_##SUFFIX(PREFIX##_mul_##SUFFIX(a, b), c)
+#	endif
+
+#	define GLM_WIDE_CMPLT_AVX_PS(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#	define GLM_WIDE_CMPLT_AVX_PD(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+
+	// SSE4.1 has the rounding instructions, every AVX processor has SSE4.1
+#	if GLM_ARCH & (GLM_ARCH_SSE4 | GLM_ARCH_AVX)
+#		define GLM_WIDE_FLOOR_PS _mm_floor_ps
+#		define GLM_WIDE_FLOOR_PD _mm_floor_pd
+#	else
+#		define GLM_WIDE_FLOOR_PS floor_sse2
+#		define GLM_WIDE_FLOOR_PD floor_sse2
+#	endif
+
+#	if GLM_ARCH & GLM_ARCH_SSE2
+		GLM_WIDE_SIMD(float, 4, _mm, ps, _mm_cmplt_ps, GLM_WIDE_FLOOR_PS)
+		GLM_WIDE_SIMD(double, 2, _mm, pd, _mm_cmplt_pd, GLM_WIDE_FLOOR_PD)
+#	endif
+#	if GLM_ARCH & GLM_ARCH_AVX
+		GLM_WIDE_SIMD(float, 8, _mm256, ps, GLM_WIDE_CMPLT_AVX_PS, _mm256_floor_ps)
+		GLM_WIDE_SIMD(double, 4, _mm256, pd, GLM_WIDE_CMPLT_AVX_PD, _mm256_floor_pd)
+#	endif
+
+#	undef GLM_WIDE_FLOOR_PD
+#	undef GLM_WIDE_FLOOR_PS
+#	undef GLM_WIDE_CMPLT_AVX_PD
+#	undef GLM_WIDE_CMPLT_AVX_PS
+#	undef GLM_WIDE_FMA
+#	undef GLM_WIDE_SIMD
+
+	// One component of N vectors Stride values apart
+	template <typename T, std::size_t N>
+	struct compute_wide_gather
+	{
+		GLM_FUNC_QUALIFIER static wide::scalar<T, N> gather(T const * in, std::size_t Stride)
+		{
+			wide::scalar<T, N> Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = in[i * Stride];
+			return Result;
+		}
+
+		GLM_FUNC_QUALIFIER static void scatter(wide::scalar<T, N> const & v, T * out, std::size_t Stride)
+		{
+			for(std::size_t i = 0; i < N; ++i)
+				out[i * Stride] = v.lane[i];
+		}
+	};
+
+	// N tvec3 to and from the lanes
+	template <typename T, std::size_t N>
+	struct compute_wide_aos3
+	{
+		GLM_FUNC_QUALIFIER static wide::vec3<T, N> load(T const * in)
+		{
+			return wide::vec3<T, N>(
+				compute_wide_gather<T, N>::gather(in + 0, 3),
+				compute_wide_gather<T, N>::gather(in + 1, 3),
+				compute_wide_gather<T, N>::gather(in + 2, 3));
+		}
+
+		GLM_FUNC_QUALIFIER static void store(wide::vec3<T, N> const & v, T * out, bool = false)
+		{
+			compute_wide_gather<T, N>::scatter(v.x, out + 0, 3);
+			compute_wide_gather<T, N>::scatter(v.y, out + 1, 3);
+			compute_wide_gather<T, N>::scatter(v.z, out + 2, 3);
+		}
+	};
+
+	// N tvec4 Stride values apart to and from the lanes, the columns of
+	// tmat4x4 arrays are 16 values apart
+	template <typename T, std::size_t N>
+	struct compute_wide_aos4
+	{
+		GLM_FUNC_QUALIFIER static wide::vec4<T, N> load(T const * in, std::size_t Stride = 4)
+		{
+			return wide::vec4<T, N>(
+				compute_wide_gather<T, N>::gather(in + 0, Stride),
+				compute_wide_gather<T, N>::gather(in + 1, Stride),
+				compute_wide_gather<T, N>::gather(in + 2, Stride),
+				compute_wide_gather<T, N>::gather(in + 3, Stride));
+		}
+
+		GLM_FUNC_QUALIFIER static void store(wide::vec4<T, N> const & v, T * out, bool = false, std::size_t Stride = 4)
+		{
+			compute_wide_gather<T, N>::scatter(v.x, out + 0, Stride);
+			compute_wide_gather<T, N>::scatter(v.y, out + 1, Stride);
+			compute_wide_gather<T, N>::scatter(v.z, out + 2, Stride);
+			compute_wide_gather<T, N>::scatter(v.w, out + 3, Stride);
+		}
+	};
+
+	// The SIMD widths load whole registers and transpose them with shuffles,
+	// which is faster than the AVX2 gathers with these strides.
+#	if GLM_ARCH & GLM_ARCH_SSE2
+		// Streaming stores bypass the caches, out must then be 16 bytes aligned
+		GLM_FUNC_QUALIFIER void store_sse2(float * out, __m128 v, bool Stream)
+		{
+			if(Stream)
+				_mm_stream_ps(out, v);
+			else
+				_mm_storeu_ps(out, v);
+		}
+
+		GLM_FUNC_QUALIFIER void store_sse2(double * out, __m128d v, bool Stream)
+		{
+			if(Stream)
+				_mm_stream_pd(out, v);
+			else
+				_mm_storeu_pd(out, v);
+		}
+
+		// x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 to x0..x3 | y0..y3 | z0..z3 and back
+		GLM_FUNC_QUALIFIER void transpose3_sse2(__m128 r0, __m128 r1, __m128 r2, __m128 & x, __m128 & y, __m128 & z)
+		{
+			__m128 const u = _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+			__m128 const v = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+			x = _mm_shuffle_ps(r0, u, _MM_SHUFFLE(2, 0, 3, 0));
+			y = _mm_shuffle_ps(v, u, _MM_SHUFFLE(3, 1, 2, 0));
+			z = _mm_shuffle_ps(v, r2, _MM_SHUFFLE(3, 0, 3, 1));
+		}
+
+		GLM_FUNC_QUALIFIER void untranspose3_sse2(__m128 x, __m128 y, __m128 z, __m128 & r0, __m128 & r1, __m128 & r2)
+		{
+			__m128 const lo = _mm_unpacklo_ps(x, y); // x0 y0 x1 y1
+			__m128 const hi = _mm_unpackhi_ps(x, y); // x2 y2 x3 y3
+			r0 = _mm_shuffle_ps(lo, _mm_shuffle_ps(z, lo, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+			r1 = _mm_shuffle_ps(_mm_shuffle_ps(lo, z, _MM_SHUFFLE(1, 1, 3, 3)), hi, _MM_SHUFFLE(1, 0, 2, 0));
+			r2 = _mm_shuffle_ps(_mm_shuffle_ps(z, hi, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(hi, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		}
+
+		// x0 y0 | z0 x1 | y1 z1 to x0 x1 | y0 y1 | z0 z1 and back
+		GLM_FUNC_QUALIFIER void transpose3_sse2(__m128d r0, __m128d r1, __m128d r2, __m128d & x, __m128d & y, __m128d & z)
+		{
+			x = _mm_shuffle_pd(r0, r1, 2);
+			y = _mm_shuffle_pd(r0, r2, 1);
+			z = _mm_shuffle_pd(r1, r2, 2);
+		}
+
+		GLM_FUNC_QUALIFIER void untranspose3_sse2(__m128d x, __m128d y, __m128d z, __m128d & r0, __m128d & r1, __m128d & r2)
+		{
+			r0 = _mm_unpacklo_pd(x, y);
+			r1 = _mm_shuffle_pd(z, x, 2);
+			r2 = _mm_unpackhi_pd(y, z);
+		}
+
+		template <>
+		struct compute_wide_aos3<float, 4>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec3<float, 4> load(float const * in)
+			{
+				wide::vec3<float, 4> Result;
+				transpose3_sse2(_mm_loadu_ps(in), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), Result.x.data, Result.y.data, Result.z.data);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec3<float, 4> const & v, float * out, bool Stream = false)
+			{
+				__m128 r0, r1, r2;
+				untranspose3_sse2(v.x.data, v.y.data, v.z.data, r0, r1, r2);
+				store_sse2(out, r0, Stream);
+				store_sse2(out + 4, r1, Stream);
+				store_sse2(out + 8, r2, Stream);
+			}
+		};
+
+		template <>
+		struct compute_wide_aos3<double, 2>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec3<double, 2> load(double const * in)
+			{
+				wide::vec3<double, 2> Result;
+				transpose3_sse2(_mm_loadu_pd(in), _mm_loadu_pd(in + 2), _mm_loadu_pd(in + 4), Result.x.data, Result.y.data, Result.z.data);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec3<double, 2> const & v, double * out, bool Stream = false)
+			{
+				__m128d r0, r1, r2;
+				untranspose3_sse2(v.x.data, v.y.data, v.z.data, r0, r1, r2);
+				store_sse2(out, r0, Stream);
+				store_sse2(out + 2, r1, Stream);
+				store_sse2(out + 4, r2, Stream);
+			}
+		};
+
+		// Four vec4 are a 4x4 transpose
+		template <>
+		struct compute_wide_aos4<float, 4>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec4<float, 4> load(float const * in, std::size_t Stride = 4)
+			{
+				wide::vec4<float, 4> Result;
+				__m128 r0 = _mm_loadu_ps(in);
+				__m128 r1 = _mm_loadu_ps(in + Stride);
+				__m128 r2 = _mm_loadu_ps(in + Stride * 2);
+				__m128 r3 = _mm_loadu_ps(in + Stride * 3);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				Result.x.data = r0;
+				Result.y.data = r1;
+				Result.z.data = r2;
+				Result.w.data = r3;
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec4<float, 4> const & v, float * out, bool Stream = false, std::size_t Stride = 4)
+			{
+				__m128 r0 = v.x.data;
+				__m128 r1 = v.y.data;
+				__m128 r2 = v.z.data;
+				__m128 r3 = v.w.data;
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				store_sse2(out, r0, Stream);
+				store_sse2(out + Stride, r1, Stream);
+				store_sse2(out + Stride * 2, r2, Stream);
+				store_sse2(out + Stride * 3, r3, Stream);
+			}
+		};
+
+		// Two dvec4 are two 2x2 transposes
+		template <>
+		struct compute_wide_aos4<double, 2>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec4<double, 2> load(double const * in, std::size_t Stride = 4)
+			{
+				__m128d const a0 = _mm_loadu_pd(in);
+				__m128d const a1 = _mm_loadu_pd(in + 2);
+				__m128d const b0 = _mm_loadu_pd(in + Stride);
+				__m128d const b1 = _mm_loadu_pd(in + Stride + 2);
+
+				wide::vec4<double, 2> Result;
+				Result.x.data = _mm_unpacklo_pd(a0, b0);
+				Result.y.data = _mm_unpackhi_pd(a0, b0);
+				Result.z.data = _mm_unpacklo_pd(a1, b1);
+				Result.w.data = _mm_unpackhi_pd(a1, b1);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec4<double, 2> const & v, double * out, bool Stream = false, std::size_t Stride = 4)
+			{
+				store_sse2(out, _mm_unpacklo_pd(v.x.data, v.y.data), Stream);
+				store_sse2(out + 2, _mm_unpacklo_pd(v.z.data, v.w.data), Stream);
+				store_sse2(out + Stride, _mm_unpackhi_pd(v.x.data, v.y.data), Stream);
+				store_sse2(out + Stride + 2, _mm_unpackhi_pd(v.z.data, v.w.data), Stream);
+			}
+		};
+#	endif//GLM_ARCH & GLM_ARCH_SSE2
+
+#	if GLM_ARCH & GLM_ARCH_AVX
+		// out must be 32 bytes aligned for streaming stores
+		GLM_FUNC_QUALIFIER void store_avx(double * out, __m256d v, bool Stream)
+		{
+			if(Stream)
+				_mm256_stream_pd(out, v);
+			else
+				_mm256_storeu_pd(out, v);
+		}
+
+		// Two halves of four and two vectors
+		template <>
+		struct compute_wide_aos3<float, 8>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec3<float, 8> load(float const * in)
+			{
+				__m128 x0, y0, z0, x1, y1, z1;
+				transpose3_sse2(_mm_loadu_ps(in), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), x0, y0, z0);
+				transpose3_sse2(_mm_loadu_ps(in + 12), _mm_loadu_ps(in + 16), _mm_loadu_ps(in + 20), x1, y1, z1);
+				wide::vec3<float, 8> Result;
+				Result.x.data = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+				Result.y.data = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+				Result.z.data = _mm256_insertf128_ps(_mm256_castps128_ps256(z0), z1, 1);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec3<float, 8> const & v, float * out, bool Stream = false)
+			{
+				__m128 r0, r1, r2;
+				untranspose3_sse2(_mm256_castps256_ps128(v.x.data), _mm256_castps256_ps128(v.y.data), _mm256_castps256_ps128(v.z.data), r0, r1, r2);
+				store_sse2(out, r0, Stream);
+				store_sse2(out + 4, r1, Stream);
+				store_sse2(out + 8, r2, Stream);
+				untranspose3_sse2(_mm256_extractf128_ps(v.x.data, 1), _mm256_extractf128_ps(v.y.data, 1), _mm256_extractf128_ps(v.z.data, 1), r0, r1, r2);
+				store_sse2(out + 12, r0, Stream);
+				store_sse2(out + 16, r1, Stream);
+				store_sse2(out + 20, r2, Stream);
+			}
+		};
+
+		template <>
+		struct compute_wide_aos3<double, 4>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec3<double, 4> load(double const * in)
+			{
+				__m128d x0, y0, z0, x1, y1, z1;
+				transpose3_sse2(_mm_loadu_pd(in), _mm_loadu_pd(in + 2), _mm_loadu_pd(in + 4), x0, y0, z0);
+				transpose3_sse2(_mm_loadu_pd(in + 6), _mm_loadu_pd(in + 8), _mm_loadu_pd(in + 10), x1, y1, z1);
+				wide::vec3<double, 4> Result;
+				Result.x.data = _mm256_insertf128_pd(_mm256_castpd128_pd256(x0), x1, 1);
+				Result.y.data = _mm256_insertf128_pd(_mm256_castpd128_pd256(y0), y1, 1);
+				Result.z.data = _mm256_insertf128_pd(_mm256_castpd128_pd256(z0), z1, 1);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec3<double, 4> const & v, double * out, bool Stream = false)
+			{
+				__m128d r0, r1, r2;
+				untranspose3_sse2(_mm256_castpd256_pd128(v.x.data), _mm256_castpd256_pd128(v.y.data), _mm256_castpd256_pd128(v.z.data), r0, r1, r2);
+				store_sse2(out, r0, Stream);
+				store_sse2(out + 2, r1, Stream);
+				store_sse2(out + 4, r2, Stream);
+				untranspose3_sse2(_mm256_extractf128_pd(v.x.data, 1), _mm256_extractf128_pd(v.y.data, 1), _mm256_extractf128_pd(v.z.data, 1), r0, r1, r2);
+				store_sse2(out + 6, r0, Stream);
+				store_sse2(out + 8, r1, Stream);
+				store_sse2(out + 10, r2, Stream);
+			}
+		};
+
+		// Four dvec4 are a 4x4 transpose, which is its own inverse
+		GLM_FUNC_QUALIFIER void transpose4_avx(__m256d r0, __m256d r1, __m256d r2, __m256d r3, __m256d & x, __m256d & y, __m256d & z, __m256d & w)
+		{
+			__m256d const t0 = _mm256_unpacklo_pd(r0, r1);
+			__m256d const t1 = _mm256_unpackhi_pd(r0, r1);
+			__m256d const t2 = _mm256_unpacklo_pd(r2, r3);
+			__m256d const t3 = _mm256_unpackhi_pd(r2, r3);
+			x = _mm256_permute2f128_pd(t0, t2, 0x20);
+			y = _mm256_permute2f128_pd(t1, t3, 0x20);
+			z = _mm256_permute2f128_pd(t0, t2, 0x31);
+			w = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+
+		template <>
+		struct compute_wide_aos4<double, 4>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec4<double, 4> load(double const * in, std::size_t Stride = 4)
+			{
+				wide::vec4<double, 4> Result;
+				transpose4_avx(_mm256_loadu_pd(in), _mm256_loadu_pd(in + Stride), _mm256_loadu_pd(in + Stride * 2), _mm256_loadu_pd(in + Stride * 3),
+					Result.x.data, Result.y.data, Result.z.data, Result.w.data);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec4<double, 4> const & v, double * out, bool Stream = false, std::size_t Stride = 4)
+			{
+				__m256d r0, r1, r2, r3;
+				transpose4_avx(v.x.data, v.y.data, v.z.data, v.w.data, r0, r1, r2, r3);
+				store_avx(out, r0, Stream);
+				store_avx(out + Stride, r1, Stream);
+				store_avx(out + Stride * 2, r2, Stream);
+				store_avx(out + Stride * 3, r3, Stream);
+			}
+		};
+
+		// Eight vec4 are two 4x4 transposes, one per half
+		template <>
+		struct compute_wide_aos4<float, 8>
+		{
+			GLM_FUNC_QUALIFIER static wide::vec4<float, 8> load(float const * in, std::size_t Stride = 4)
+			{
+				__m128 r0 = _mm_loadu_ps(in);
+				__m128 r1 = _mm_loadu_ps(in + Stride);
+				__m128 r2 = _mm_loadu_ps(in + Stride * 2);
+				__m128 r3 = _mm_loadu_ps(in + Stride * 3);
+				__m128 r4 = _mm_loadu_ps(in + Stride * 4);
+				__m128 r5 = _mm_loadu_ps(in + Stride * 5);
+				__m128 r6 = _mm_loadu_ps(in + Stride * 6);
+				__m128 r7 = _mm_loadu_ps(in + Stride * 7);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_MM_TRANSPOSE4_PS(r4, r5, r6, r7);
+
+				wide::vec4<float, 8> Result;
+				Result.x.data = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), r4, 1);
+				Result.y.data = _mm256_insertf128_ps(_mm256_castps128_ps256(r1), r5, 1);
+				Result.z.data = _mm256_insertf128_ps(_mm256_castps128_ps256(r2), r6, 1);
+				Result.w.data = _mm256_insertf128_ps(_mm256_castps128_ps256(r3), r7, 1);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void store(wide::vec4<float, 8> const & v, float * out, bool Stream = false, std::size_t Stride = 4)
+			{
+				__m128 r0 = _mm256_castps256_ps128(v.x.data);
+				__m128 r1 = _mm256_castps256_ps128(v.y.data);
+				__m128 r2 = _mm256_castps256_ps128(v.z.data);
+				__m128 r3 = _mm256_castps256_ps128(v.w.data);
+				__m128 r4 = _mm256_extractf128_ps(v.x.data, 1);
+				__m128 r5 = _mm256_extractf128_ps(v.y.data, 1);
+				__m128 r6 = _mm256_extractf128_ps(v.z.data, 1);
+				__m128 r7 = _mm256_extractf128_ps(v.w.data, 1);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_MM_TRANSPOSE4_PS(r4, r5, r6, r7);
+				store_sse2(out, r0, Stream);
+				store_sse2(out + Stride, r1, Stream);
+				store_sse2(out + Stride * 2, r2, Stream);
+				store_sse2(out + Stride * 3, r3, Stream);
+				store_sse2(out + Stride * 4, r4, Stream);
+				store_sse2(out + Stride * 5, r5, Stream);
+				store_sse2(out + Stride * 6, r6, Stream);
+				store_sse2(out + Stride * 7, r7, Stream);
+			}
+		};
+#	endif//GLM_ARCH & GLM_ARCH_AVX
+}//namespace detail
+
+namespace wide
+{
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N>::scalar()
+	{
+#		ifndef GLM_FORCE_NO_CTOR_INIT
+			for(std::size_t i = 0; i < N; ++i)
+				lane[i] = T(0);
+#		endif
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N>::scalar(ctor)
+	{}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N>::scalar(T s)
+	{
+		*this = detail::compute_wide<T, N>::set(s);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER T & scalar<T, N>::operator[](std::size_t i)
+	{
+		assert(i < N);
+		return lane[i];
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER T const & scalar<T, N>::operator[](std::size_t i) const
+	{
+		assert(i < N);
+		return lane[i];
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N>::vec3()
+	{}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N>::vec3(scalar<T, N> const & x, scalar<T, N> const & y, scalar<T, N> const & z) :
+		x(x), y(y), z(z)
+	{}
+
+	template <typename T, std::size_t N>
+	template <precision P>
+	GLM_FUNC_QUALIFIER vec3<T, N>::vec3(tvec3<T, P> const & v) :
+		x(v.x), y(v.y), z(v.z)
+	{}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER tvec3<T, defaultp> vec3<T, N>::at(std::size_t i) const
+	{
+		return tvec3<T, defaultp>(x[i], y[i], z[i]);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N>::vec4()
+	{}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N>::vec4(scalar<T, N> const & x, scalar<T, N> const & y, scalar<T, N> const & z, scalar<T, N> const & w) :
+		x(x), y(y), z(z), w(w)
+	{}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N>::vec4(vec3<T, N> const & v, scalar<T, N> const & w) :
+		x(v.x), y(v.y), z(v.z), w(w)
+	{}
+
+	template <typename T, std::size_t N>
+	template <precision P>
+	GLM_FUNC_QUALIFIER vec4<T, N>::vec4(tvec4<T, P> const & v) :
+		x(v.x), y(v.y), z(v.z), w(v.w)
+	{}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER tvec4<T, defaultp> vec4<T, N>::at(std::size_t i) const
+	{
+		return tvec4<T, defaultp>(x[i], y[i], z[i], w[i]);
+	}
+
+	// scalar
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> operator+(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		return detail::compute_wide<T, N>::add(a, b);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> operator-(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		return detail::compute_wide<T, N>::sub(a, b);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> operator*(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		return detail::compute_wide<T, N>::mul(a, b);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> operator/(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		return detail::compute_wide<T, N>::div(a, b);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> operator-(scalar<T, N> const & a)
+	{
+		return detail::compute_wide<T, N>::neg(a);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> fma(scalar<T, N> const & a, scalar<T, N> const & b, scalar<T, N> const & c)
+	{
+		return detail::compute_wide<T, N>::fma(a, b, c);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> sqrt(scalar<T, N> const & x)
+	{
+		return detail::compute_wide<T, N>::sqrt(x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> inversesqrt(scalar<T, N> const & x)
+	{
+		return scalar<T, N>(static_cast<T>(1)) / sqrt(x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> min(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		return detail::compute_wide<T, N>::min(a, b);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> max(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		return detail::compute_wide<T, N>::max(a, b);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> floor(scalar<T, N> const & x)
+	{
+		return detail::compute_wide<T, N>::floor(x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> fract(scalar<T, N> const & x)
+	{
+		return x - detail::compute_wide<T, N>::floor(x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> step(scalar<T, N> const & edge, scalar<T, N> const & x)
+	{
+		return detail::compute_wide<T, N>::step(edge, x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> abs(scalar<T, N> const & x)
+	{
+		return detail::compute_wide<T, N>::abs(x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> flipSign(scalar<T, N> const & x, scalar<T, N> const & s)
+	{
+		return detail::compute_wide<T, N>::flipSign(x, s);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER unsigned int lessThan(scalar<T, N> const & a, scalar<T, N> const & b)
+	{
+		GLM_STATIC_ASSERT(N <= 32, "'lessThan' returns one bit per lane in an unsigned int");
+		return detail::compute_wide<T, N>::lessThan(a, b);
+	}
+
+	// vec3
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator+(vec3<T, N> const & a, vec3<T, N> const & b)
+	{
+		return vec3<T, N>(a.x + b.x, a.y + b.y, a.z + b.z);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator-(vec3<T, N> const & a, vec3<T, N> const & b)
+	{
+		return vec3<T, N>(a.x - b.x, a.y - b.y, a.z - b.z);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator*(vec3<T, N> const & a, vec3<T, N> const & b)
+	{
+		return vec3<T, N>(a.x * b.x, a.y * b.y, a.z * b.z);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator*(vec3<T, N> const & a, scalar<T, N> const & s)
+	{
+		return vec3<T, N>(a.x * s, a.y * s, a.z * s);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator*(scalar<T, N> const & s, vec3<T, N> const & a)
+	{
+		return vec3<T, N>(s * a.x, s * a.y, s * a.z);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator/(vec3<T, N> const & a, scalar<T, N> const & s)
+	{
+		return vec3<T, N>(a.x / s, a.y / s, a.z / s);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> operator-(vec3<T, N> const & a)
+	{
+		return vec3<T, N>(-a.x, -a.y, -a.z);
+	}
+
+	// vec4
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator+(vec4<T, N> const & a, vec4<T, N> const & b)
+	{
+		return vec4<T, N>(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator-(vec4<T, N> const & a, vec4<T, N> const & b)
+	{
+		return vec4<T, N>(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator*(vec4<T, N> const & a, vec4<T, N> const & b)
+	{
+		return vec4<T, N>(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator*(vec4<T, N> const & a, scalar<T, N> const & s)
+	{
+		return vec4<T, N>(a.x * s, a.y * s, a.z * s, a.w * s);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator*(scalar<T, N> const & s, vec4<T, N> const & a)
+	{
+		return vec4<T, N>(s * a.x, s * a.y, s * a.z, s * a.w);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator/(vec4<T, N> const & a, scalar<T, N> const & s)
+	{
+		return vec4<T, N>(a.x / s, a.y / s, a.z / s, a.w / s);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator-(vec4<T, N> const & a)
+	{
+		return vec4<T, N>(-a.x, -a.y, -a.z, -a.w);
+	}
+
+	// geometric
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> dot(vec3<T, N> const & a, vec3<T, N> const & b)
+	{
+		return fma(a.z, b.z, fma(a.y, b.y, a.x * b.x));
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> dot(vec4<T, N> const & a, vec4<T, N> const & b)
+	{
+		return fma(a.w, b.w, fma(a.z, b.z, fma(a.y, b.y, a.x * b.x)));
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> cross(vec3<T, N> const & a, vec3<T, N> const & b)
+	{
+		return vec3<T, N>(
+			a.y * b.z - b.y * a.z,
+			a.z * b.x - b.z * a.x,
+			a.x * b.y - b.x * a.y);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> length(vec3<T, N> const & v)
+	{
+		return sqrt(dot(v, v));
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> length(vec4<T, N> const & v)
+	{
+		return sqrt(dot(v, v));
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> normalize(vec3<T, N> const & v)
+	{
+		return v * inversesqrt(dot(v, v));
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> normalize(vec4<T, N> const & v)
+	{
+		return v * inversesqrt(dot(v, v));
+	}
+
+	// transforms, the matrix is broadcast to all lanes
+
+	template <typename T, precision P, std::size_t N>
+	GLM_FUNC_QUALIFIER vec4<T, N> operator*(tmat4x4<T, P> const & m, vec4<T, N> const & v)
+	{
+		vec4<T, N> Result;
+		Result.x = fma(scalar<T, N>(m[3][0]), v.w, fma(scalar<T, N>(m[2][0]), v.z, fma(scalar<T, N>(m[1][0]), v.y, scalar<T, N>(m[0][0]) * v.x)));
+		Result.y = fma(scalar<T, N>(m[3][1]), v.w, fma(scalar<T, N>(m[2][1]), v.z, fma(scalar<T, N>(m[1][1]), v.y, scalar<T, N>(m[0][1]) * v.x)));
+		Result.z = fma(scalar<T, N>(m[3][2]), v.w, fma(scalar<T, N>(m[2][2]), v.z, fma(scalar<T, N>(m[1][2]), v.y, scalar<T, N>(m[0][2]) * v.x)));
+		Result.w = fma(scalar<T, N>(m[3][3]), v.w, fma(scalar<T, N>(m[2][3]), v.z, fma(scalar<T, N>(m[1][3]), v.y, scalar<T, N>(m[0][3]) * v.x)));
+		return Result;
+	}
+
+	template <typename T, precision P, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> transformPoint(tmat4x4<T, P> const & m, vec3<T, N> const & p)
+	{
+		vec3<T, N> Result;
+		Result.x = fma(scalar<T, N>(m[2][0]), p.z, fma(scalar<T, N>(m[1][0]), p.y, fma(scalar<T, N>(m[0][0]), p.x, scalar<T, N>(m[3][0]))));
+		Result.y = fma(scalar<T, N>(m[2][1]), p.z, fma(scalar<T, N>(m[1][1]), p.y, fma(scalar<T, N>(m[0][1]), p.x, scalar<T, N>(m[3][1]))));
+		Result.z = fma(scalar<T, N>(m[2][2]), p.z, fma(scalar<T, N>(m[1][2]), p.y, fma(scalar<T, N>(m[0][2]), p.x, scalar<T, N>(m[3][2]))));
+		return Result;
+	}
+
+	template <typename T, precision P, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> transformVector(tmat4x4<T, P> const & m, vec3<T, N> const & v)
+	{
+		vec3<T, N> Result;
+		Result.x = fma(scalar<T, N>(m[2][0]), v.z, fma(scalar<T, N>(m[1][0]), v.y, scalar<T, N>(m[0][0]) * v.x));
+		Result.y = fma(scalar<T, N>(m[2][1]), v.z, fma(scalar<T, N>(m[1][1]), v.y, scalar<T, N>(m[0][1]) * v.x));
+		Result.z = fma(scalar<T, N>(m[2][2]), v.z, fma(scalar<T, N>(m[1][2]), v.y, scalar<T, N>(m[0][2]) * v.x));
+		return Result;
+	}
+
+	// arrays of structures
+
+	template <std::size_t N, typename T, precision P>
+	GLM_FUNC_QUALIFIER vec3<T, N> load(tvec3<T, P> const * in)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'load' requires tightly packed tvec3");
+		return detail::compute_wide_aos3<T, N>::load(&in[0].x);
+	}
+
+	template <std::size_t N, typename T, precision P>
+	GLM_FUNC_QUALIFIER vec4<T, N> load(tvec4<T, P> const * in)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec4<T, P>) == 4 * sizeof(T), "'load' requires tightly packed tvec4");
+		return detail::compute_wide_aos4<T, N>::load(&in[0].x);
+	}
+
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_QUALIFIER void store(vec3<T, N> const & v, tvec3<T, P> * out)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'store' requires tightly packed tvec3");
+		detail::compute_wide_aos3<T, N>::store(v, &out[0].x);
+	}
+
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_QUALIFIER void store(vec4<T, N> const & v, tvec4<T, P> * out)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec4<T, P>) == 4 * sizeof(T), "'store' requires tightly packed tvec4");
+		detail::compute_wide_aos4<T, N>::store(v, &out[0].x);
+	}
+}//namespace wide
+
+namespace detail
+{
+	// Lanes used by the batch functions, matching GLM_ARCH. The matrix
+	// functions keep the columns of N matrices in registers, which only pays
+	// off at the SSE2 width: wider, the transposes spill.
+	template <typename T>
+	struct wide_batch
+	{
+		static std::size_t const lanes = 4;
+		static std::size_t const matrix_lanes = 4;
+	};
+
+#	if GLM_ARCH & GLM_ARCH_AVX
+		template <>
+		struct wide_batch<float>
+		{
+			static std::size_t const lanes = 8;
+			static std::size_t const matrix_lanes = 4;
+		};
+
+		template <>
+		struct wide_batch<double>
+		{
+			static std::size_t const lanes = 4;
+			static std::size_t const matrix_lanes = 2;
+		};
+#	elif GLM_ARCH & GLM_ARCH_SSE2
+		template <>
+		struct wide_batch<double>
+		{
+			static std::size_t const lanes = 2;
+			static std::size_t const matrix_lanes = 2;
+		};
+#	endif
+
+	// Outputs too large to stay in the caches are written with streaming
+	// stores, which need 32 bytes aligned addresses at the widest
+	GLM_FUNC_QUALIFIER bool batch_stream(void const * out, std::size_t Bytes)
+	{
+		return Bytes >= GLM_WIDE_STREAM_BYTES && (reinterpret_cast<std::size_t>(out) & 31) == 0;
+	}
+
+	// Streaming stores are weakly ordered, fence them before returning
+	GLM_FUNC_QUALIFIER void batch_fence(bool Stream)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2
+			if(Stream)
+				_mm_sfence();
+#		else
+			(void)Stream;
+#		endif
+	}
+
+	// The last Left < N elements of Size values of an array, padded to N by
+	// repeating the last one, so the tail goes through the same lanes
+	template <std::size_t N, typename T>
+	GLM_FUNC_QUALIFIER void batch_pad(T const * in, std::size_t Size, std::size_t Left, T * Tmp)
+	{
+		for(std::size_t i = 0; i < N; ++i)
+		for(std::size_t j = 0; j < Size; ++j)
+			Tmp[i * Size + j] = in[(i < Left ? i : Left - 1) * Size + j];
+	}
+
+	template <typename T, precision P>
+	struct compute_batch_mat4
+	{
+		GLM_FUNC_QUALIFIER static void call(tmat4x4<T, P> const * a, tmat4x4<T, P> const * b, tmat4x4<T, P> * out, std::size_t count, bool)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = a[i] * b[i];
+		}
+	};
+
+	// The columns of a * b are the columns of a weighted by the components of
+	// the columns of b, each broadcast across a register. The AVX kernels also
+	// run in the builds without AVX, on the CPUs with AVX2 (see _dispatch.hpp):
+	// the products are only fused when GLM_ARCH has FMA, so that either kernel
+	// gives the same results.
+#	if (GLM_ARCH & GLM_ARCH_AVX) || GLM_HAS_DISPATCH
+		template <precision P>
+		GLM_TARGET("avx") GLM_FUNC_QUALIFIER __m256 batch_madd_avx(__m256 a, __m256 b, __m256 c)
+		{
+#			if GLM_HAS_FMA
+			if(P != highp)
+				return _mm256_fmadd_ps(a, b, c);
+#			endif
+			return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+		}
+
+		template <precision P>
+		GLM_TARGET("avx") GLM_FUNC_QUALIFIER __m256d batch_madd_avx(__m256d a, __m256d b, __m256d c)
+		{
+#			if GLM_HAS_FMA
+			if(P != highp)
+				return _mm256_fmadd_pd(a, b, c);
+#			endif
+			return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+		}
+
+		// Two columns of b and of the result per register
+		template <precision P>
+		GLM_TARGET("avx") GLM_FUNC_QUALIFIER void batch_mat4_avx(tmat4x4<float, P> const * a, tmat4x4<float, P> const * b, tmat4x4<float, P> * out, std::size_t count, bool Stream)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				float const * pa = &a[i][0].x;
+				float const * pb = &b[i][0].x;
+				float * po = &out[i][0].x;
+
+				__m256 const a0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pa + 0));
+				__m256 const a1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pa + 4));
+				__m256 const a2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pa + 8));
+				__m256 const a3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pa + 12));
+
+				for(std::size_t c = 0; c < 16; c += 8)
+				{
+					__m256 const bc = _mm256_loadu_ps(pb + c);
+					__m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00));
+					r = batch_madd_avx<P>(a1, _mm256_permute_ps(bc, 0x55), r);
+					r = batch_madd_avx<P>(a2, _mm256_permute_ps(bc, 0xAA), r);
+					r = batch_madd_avx<P>(a3, _mm256_permute_ps(bc, 0xFF), r);
+					if(Stream)
+						_mm256_stream_ps(po + c, r);
+					else
+						_mm256_storeu_ps(po + c, r);
+				}
+			}
+		}
+
+		// A column of the result per register
+		template <precision P>
+		GLM_TARGET("avx") GLM_FUNC_QUALIFIER void batch_mat4_avx(tmat4x4<double, P> const * a, tmat4x4<double, P> const * b, tmat4x4<double, P> * out, std::size_t count, bool Stream)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				double const * pa = &a[i][0].x;
+				double const * pb = &b[i][0].x;
+				double * po = &out[i][0].x;
+
+				__m256d const a0 = _mm256_loadu_pd(pa + 0);
+				__m256d const a1 = _mm256_loadu_pd(pa + 4);
+				__m256d const a2 = _mm256_loadu_pd(pa + 8);
+				__m256d const a3 = _mm256_loadu_pd(pa + 12);
+
+				for(std::size_t c = 0; c < 16; c += 4)
+				{
+					__m256d r = _mm256_mul_pd(a0, _mm256_broadcast_sd(pb + c + 0));
+					r = batch_madd_avx<P>(a1, _mm256_broadcast_sd(pb + c + 1), r);
+					r = batch_madd_avx<P>(a2, _mm256_broadcast_sd(pb + c + 2), r);
+					r = batch_madd_avx<P>(a3, _mm256_broadcast_sd(pb + c + 3), r);
+					if(Stream)
+						_mm256_stream_pd(po + c, r);
+					else
+						_mm256_storeu_pd(po + c, r);
+				}
+			}
+		}
+
+		template <precision P>
+		struct compute_batch_mat4<double, P>
+		{
+			GLM_FUNC_QUALIFIER static void call(tmat4x4<double, P> const * a, tmat4x4<double, P> const * b, tmat4x4<double, P> * out, std::size_t count, bool Stream)
+			{
+#				if GLM_ARCH & GLM_ARCH_AVX
+					batch_mat4_avx(a, b, out, count, Stream);
+#				else
+					if(dispatch_features() & DISPATCH_AVX2)
+						batch_mat4_avx(a, b, out, count, Stream);
+					else
+						for(std::size_t i = 0; i < count; ++i)
+							out[i] = a[i] * b[i];
+#				endif
+			}
+		};
+#	endif//(GLM_ARCH & GLM_ARCH_AVX) || GLM_HAS_DISPATCH
+
+#	if GLM_ARCH & GLM_ARCH_SSE2
+		template <precision P>
+		struct compute_batch_mat4<float, P>
+		{
+			GLM_FUNC_QUALIFIER static __m128 madd(__m128 a, __m128 b, __m128 c)
+			{
+#				if GLM_HAS_FMA
+				if(P != highp)
+					return _mm_fmadd_ps(a, b, c);
+#				endif
+				return _mm_add_ps(_mm_mul_ps(a, b), c);
+			}
+
+			GLM_FUNC_QUALIFIER static void call(tmat4x4<float, P> const * a, tmat4x4<float, P> const * b, tmat4x4<float, P> * out, std::size_t count, bool Stream)
+			{
+#				if GLM_ARCH & GLM_ARCH_AVX
+					batch_mat4_avx(a, b, out, count, Stream);
+#				else
+#					if GLM_HAS_DISPATCH
+					if(dispatch_features() & DISPATCH_AVX2)
+					{
+						batch_mat4_avx(a, b, out, count, Stream);
+						return;
+					}
+#					endif
+					for(std::size_t i = 0; i < count; ++i)
+					{
+						float const * pa = &a[i][0].x;
+						float const * pb = &b[i][0].x;
+						float * po = &out[i][0].x;
+
+						__m128 const a0 = _mm_loadu_ps(pa + 0);
+						__m128 const a1 = _mm_loadu_ps(pa + 4);
+						__m128 const a2 = _mm_loadu_ps(pa + 8);
+						__m128 const a3 = _mm_loadu_ps(pa + 12);
+
+						for(std::size_t c = 0; c < 16; c += 4)
+						{
+							__m128 const bc = _mm_loadu_ps(pb + c);
+							__m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, 0x00));
+							r = madd(a1, _mm_shuffle_ps(bc, bc, 0x55), r);
+							r = madd(a2, _mm_shuffle_ps(bc, bc, 0xAA), r);
+							r = madd(a3, _mm_shuffle_ps(bc, bc, 0xFF), r);
+							store_sse2(po + c, r, Stream);
+						}
+					}
+#				endif
+			}
+		};
+#	endif//GLM_ARCH & GLM_ARCH_SSE2
+
+	// The columns of the inverse transpose of the upper 3x3 of N matrices,
+	// the rows of its inverse: the cross products of its columns over the
+	// determinant
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER void batch_inverse3(T const * in, wide::vec3<T, N> & r0, wide::vec3<T, N> & r1, wide::vec3<T, N> & r2)
+	{
+		wide::vec4<T, N> const c0 = compute_wide_aos4<T, N>::load(in + 0, 16);
+		wide::vec4<T, N> const c1 = compute_wide_aos4<T, N>::load(in + 4, 16);
+		wide::vec4<T, N> const c2 = compute_wide_aos4<T, N>::load(in + 8, 16);
+		wide::vec3<T, N> const a(c0.x, c0.y, c0.z);
+		wide::vec3<T, N> const b(c1.x, c1.y, c1.z);
+		wide::vec3<T, N> const c(c2.x, c2.y, c2.z);
+
+		r0 = wide::cross(b, c);
+		r1 = wide::cross(c, a);
+		r2 = wide::cross(a, b);
+
+		wide::scalar<T, N> const InvDet = wide::scalar<T, N>(static_cast<T>(1)) / wide::dot(a, r0);
+		r0 = r0 * InvDet;
+		r1 = r1 * InvDet;
+		r2 = r2 * InvDet;
+	}
+}//namespace detail
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void transformPoints(tmat4x4<T, P> const & m, tvec3<T, P> const * in, tvec3<T, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'transformPoints' requires tightly packed tvec3");
+
+		std::size_t const N = detail::wide_batch<T>::lanes;
+		bool const Stream = detail::batch_stream(out, count * sizeof(tvec3<T, P>));
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+			detail::compute_wide_aos3<T, N>::store(wide::transformPoint(m, wide::load<N>(in + i)), &out[i].x, Stream);
+		for(; i < count; ++i)
+			out[i] = tvec3<T, P>(m * tvec4<T, P>(in[i], static_cast<T>(1)));
+
+		detail::batch_fence(Stream);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void multiplyMatrices(tmat4x4<T, P> const * a, tmat4x4<T, P> const * b, tmat4x4<T, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tmat4x4<T, P>) == 16 * sizeof(T), "'multiplyMatrices' requires tightly packed tmat4x4");
+
+		bool const Stream = detail::batch_stream(out, count * sizeof(tmat4x4<T, P>));
+		detail::compute_batch_mat4<T, P>::call(a, b, out, count, Stream);
+		detail::batch_fence(Stream);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void affineInverses(tmat4x4<T, P> const * in, tmat4x4<T, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tmat4x4<T, P>) == 16 * sizeof(T), "'affineInverses' requires tightly packed tmat4x4");
+
+		std::size_t const N = detail::wide_batch<T>::matrix_lanes;
+		bool const Stream = detail::batch_stream(out, count * sizeof(tmat4x4<T, P>));
+		wide::scalar<T, N> const Zero(static_cast<T>(0));
+		wide::scalar<T, N> const One(static_cast<T>(1));
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			wide::vec3<T, N> r0, r1, r2;
+			detail::batch_inverse3<T, N>(&in[i][0].x, r0, r1, r2);
+			wide::vec4<T, N> const c3 = detail::compute_wide_aos4<T, N>::load(&in[i][3].x, 16);
+			wide::vec3<T, N> const t(c3.x, c3.y, c3.z);
+
+			T * po = &out[i][0].x;
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(r0.x, r1.x, r2.x, Zero), po + 0, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(r0.y, r1.y, r2.y, Zero), po + 4, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(r0.z, r1.z, r2.z, Zero), po + 8, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(-wide::dot(r0, t), -wide::dot(r1, t), -wide::dot(r2, t), One), po + 12, Stream, 16);
+		}
+		for(; i < count; ++i)
+			out[i] = affineInverse(in[i]);
+
+		detail::batch_fence(Stream);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void normalMatrices(tmat4x4<T, P> const * in, tmat3x3<T, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tmat4x4<T, P>) == 16 * sizeof(T), "'normalMatrices' requires tightly packed tmat4x4");
+		GLM_STATIC_ASSERT(sizeof(tmat3x3<T, P>) == 9 * sizeof(T), "'normalMatrices' requires tightly packed tmat3x3");
+
+		std::size_t const N = detail::wide_batch<T>::matrix_lanes;
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			wide::vec3<T, N> r0, r1, r2;
+			detail::batch_inverse3<T, N>(&in[i][0].x, r0, r1, r2);
+
+			T * po = &out[i][0].x;
+			detail::compute_wide_gather<T, N>::scatter(r0.x, po + 0, 9);
+			detail::compute_wide_gather<T, N>::scatter(r0.y, po + 1, 9);
+			detail::compute_wide_gather<T, N>::scatter(r0.z, po + 2, 9);
+			detail::compute_wide_gather<T, N>::scatter(r1.x, po + 3, 9);
+			detail::compute_wide_gather<T, N>::scatter(r1.y, po + 4, 9);
+			detail::compute_wide_gather<T, N>::scatter(r1.z, po + 5, 9);
+			detail::compute_wide_gather<T, N>::scatter(r2.x, po + 6, 9);
+			detail::compute_wide_gather<T, N>::scatter(r2.y, po + 7, 9);
+			detail::compute_wide_gather<T, N>::scatter(r2.z, po + 8, 9);
+		}
+		for(; i < count; ++i)
+			out[i] = inverseTranspose(tmat3x3<T, P>(in[i]));
+	}
+}//namespace glm
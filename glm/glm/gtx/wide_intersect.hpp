@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_intersect
+/// @file glm/gtx/wide_intersect.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// @see core (dependence)
+/// @see gtx_intersect (dependence)
+/// @see gtx_wide (dependence)
+///
+/// @defgroup gtx_wide_intersect GLM_GTX_wide_intersect
+/// @ingroup gtx
+/// 
+/// @brief Ray against triangle and box tests of N rays or N primitives at once.
+/// 
+/// Picking and the traversal of bounding volume hierarchies test one ray
+/// against many triangles or boxes, or many rays against one of them. The
+/// functions of this extension run the tests of GLM_GTX_intersect on the
+/// lanes of the GLM_GTX_wide registers: N rays against one triangle or box,
+/// or one ray against N triangles or boxes, in structure of arrays layout.
+/// They return one bit per lane, set for the lanes which hit.
+/// intersectRayTriangles() finds the nearest of a whole array of triangles
+/// at the width of GLM_ARCH.
+/// 
+/// <glm/gtx/wide_intersect.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtx/intersect.hpp"
+#include "../gtx/wide.hpp"
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_wide_intersect extension included")
+#endif
+
+namespace glm{
+namespace wide
+{
+	/// @addtogroup gtx_wide_intersect
+	/// @{
+
+	/// N rays against the front face of one triangle, as glm::intersectRayTriangle.
+	/// Bit i is set if ray i hits; the lanes of baryPosition are then the
+	/// barycentric coordinates of the hit in x and y and its distance in z,
+	/// in units of the length of dir.
+	/// @see gtx_intersect
+	/// From GLM_GTX_wide_intersect extension.
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_DECL unsigned int intersectRayTriangle(
+		vec3<T, N> const & orig, vec3<T, N> const & dir,
+		tvec3<T, P> const & vert0, tvec3<T, P> const & vert1, tvec3<T, P> const & vert2,
+		vec3<T, N> & baryPosition);
+
+	/// One ray against the front faces of N triangles, the bits and lanes as above.
+	/// @see gtx_intersect
+	/// From GLM_GTX_wide_intersect extension.
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_DECL unsigned int intersectRayTriangle(
+		tvec3<T, P> const & orig, tvec3<T, P> const & dir,
+		vec3<T, N> const & vert0, vec3<T, N> const & vert1, vec3<T, N> const & vert2,
+		vec3<T, N> & baryPosition);
+
+	/// N rays against one axis aligned box, as glm::intersectRayBox. invDir
+	/// is 1 / dir. Bit i is set if ray i hits; lane i of intersectionDistance
+	/// is then where it enters the box, 0 if it starts inside.
+	/// @see gtx_intersect
+	/// From GLM_GTX_wide_intersect extension.
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_DECL unsigned int intersectRayBox(
+		vec3<T, N> const & orig, vec3<T, N> const & invDir,
+		tvec3<T, P> const & boxMin, tvec3<T, P> const & boxMax,
+		scalar<T, N> & intersectionDistance);
+
+	/// One ray against N axis aligned boxes, the children of a node of a
+	/// bounding volume hierarchy, the bits and lanes as above.
+	/// @see gtx_intersect
+	/// From GLM_GTX_wide_intersect extension.
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_DECL unsigned int intersectRayBox(
+		tvec3<T, P> const & orig, tvec3<T, P> const & invDir,
+		vec3<T, N> const & boxMin, vec3<T, N> const & boxMax,
+		scalar<T, N> & intersectionDistance);
+
+	/// @}
+}//namespace wide
+
+	/// @addtogroup gtx_wide_intersect
+	/// @{
+
+	/// The index of the nearest of count triangles whose front face the ray
+	/// hits, count if it hits none. Triangle i is vertices[3 * i] to
+	/// vertices[3 * i + 2]. baryPosition is set as by intersectRayTriangle
+	/// for the triangle found.
+	/// @see gtx_intersect
+	/// From GLM_GTX_wide_intersect extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL std::size_t intersectRayTriangles(
+		tvec3<T, P> const & orig, tvec3<T, P> const & dir,
+		tvec3<T, P> const * vertices, std::size_t count,
+		tvec3<T, P> & baryPosition);
+
+	/// @}
+}//namespace glm
+
+#include "wide_intersect.inl"
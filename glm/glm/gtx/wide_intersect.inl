@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_intersect
+/// @file glm/gtx/wide_intersect.inl
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <limits>
+
+namespace glm{
+namespace detail
+{
+	// The bits of the N lanes
+	template <std::size_t N>
+	GLM_FUNC_QUALIFIER unsigned int wide_lanes()
+	{
+		return ~0u >> (32 - N);
+	}
+
+	// The steps of glm::intersectRayTriangle (Moller-Trumbore) on the lanes,
+	// its early returns becoming the bits of the misses
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER unsigned int wide_ray_triangle(
+		wide::vec3<T, N> const & orig, wide::vec3<T, N> const & dir,
+		wide::vec3<T, N> const & v0, wide::vec3<T, N> const & v1, wide::vec3<T, N> const & v2,
+		wide::vec3<T, N> & baryPosition)
+	{
+		typedef wide::scalar<T, N> lane;
+
+		wide::vec3<T, N> const e1 = v1 - v0;
+		wide::vec3<T, N> const e2 = v2 - v0;
+		wide::vec3<T, N> const p = wide::cross(dir, e2);
+		lane const a = wide::dot(e1, p);
+		lane const f = lane(static_cast<T>(1)) / a;
+
+		wide::vec3<T, N> const s = orig - v0;
+		wide::vec3<T, N> const q = wide::cross(s, e1);
+		lane const u = f * wide::dot(s, p);
+		lane const v = f * wide::dot(dir, q);
+		lane const t = f * wide::dot(e2, q);
+		baryPosition = wide::vec3<T, N>(u, v, t);
+
+		lane const Zero(static_cast<T>(0));
+		lane const One(static_cast<T>(1));
+		unsigned int const Miss =
+			wide::lessThan(a, lane(std::numeric_limits<T>::epsilon())) |
+			wide::lessThan(u, Zero) | wide::lessThan(One, u) |
+			wide::lessThan(v, Zero) | wide::lessThan(One, u + v) |
+			wide::lessThan(t, Zero);
+		return ~Miss & wide_lanes<N>();
+	}
+
+	// The slab test: the ray is in the box between the largest of the
+	// distances where it enters the slabs of the three axes and the smallest
+	// of those where it leaves them
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER unsigned int wide_ray_box(
+		wide::vec3<T, N> const & orig, wide::vec3<T, N> const & invDir,
+		wide::vec3<T, N> const & boxMin, wide::vec3<T, N> const & boxMax,
+		wide::scalar<T, N> & intersectionDistance)
+	{
+		wide::vec3<T, N> const t1 = (boxMin - orig) * invDir;
+		wide::vec3<T, N> const t2 = (boxMax - orig) * invDir;
+
+		wide::scalar<T, N> const Near = wide::max(
+			wide::max(wide::min(t1.x, t2.x), wide::min(t1.y, t2.y)),
+			wide::max(wide::min(t1.z, t2.z), wide::scalar<T, N>(static_cast<T>(0))));
+		wide::scalar<T, N> const Far = wide::min(
+			wide::min(wide::max(t1.x, t2.x), wide::max(t1.y, t2.y)),
+			wide::max(t1.z, t2.z));
+
+		intersectionDistance = Near;
+		return ~wide::lessThan(Far, Near) & wide_lanes<N>();
+	}
+
+	// The vertices of N triangles, Stride values apart
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::vec3<T, N> wide_gather3(T const * in, std::size_t Stride)
+	{
+		return wide::vec3<T, N>(
+			compute_wide_gather<T, N>::gather(in + 0, Stride),
+			compute_wide_gather<T, N>::gather(in + 1, Stride),
+			compute_wide_gather<T, N>::gather(in + 2, Stride));
+	}
+}//namespace detail
+
+namespace wide
+{
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_QUALIFIER unsigned int intersectRayTriangle(
+		vec3<T, N> const & orig, vec3<T, N> const & dir,
+		tvec3<T, P> const & vert0, tvec3<T, P> const & vert1, tvec3<T, P> const & vert2,
+		vec3<T, N> & baryPosition)
+	{
+		return detail::wide_ray_triangle<T, N>(orig, dir, vec3<T, N>(vert0), vec3<T, N>(vert1), vec3<T, N>(vert2), baryPosition);
+	}
+
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_QUALIFIER unsigned int intersectRayTriangle(
+		tvec3<T, P> const & orig, tvec3<T, P> const & dir,
+		vec3<T, N> const & vert0, vec3<T, N> const & vert1, vec3<T, N> const & vert2,
+		vec3<T, N> & baryPosition)
+	{
+		return detail::wide_ray_triangle<T, N>(vec3<T, N>(orig), vec3<T, N>(dir), vert0, vert1, vert2, baryPosition);
+	}
+
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_QUALIFIER unsigned int intersectRayBox(
+		vec3<T, N> const & orig, vec3<T, N> const & invDir,
+		tvec3<T, P> const & boxMin, tvec3<T, P> const & boxMax,
+		scalar<T, N> & intersectionDistance)
+	{
+		return detail::wide_ray_box<T, N>(orig, invDir, vec3<T, N>(boxMin), vec3<T, N>(boxMax), intersectionDistance);
+	}
+
+	template <typename T, std::size_t N, precision P>
+	GLM_FUNC_QUALIFIER unsigned int intersectRayBox(
+		tvec3<T, P> const & orig, tvec3<T, P> const & invDir,
+		vec3<T, N> const & boxMin, vec3<T, N> const & boxMax,
+		scalar<T, N> & intersectionDistance)
+	{
+		return detail::wide_ray_box<T, N>(vec3<T, N>(orig), vec3<T, N>(invDir), boxMin, boxMax, intersectionDistance);
+	}
+}//namespace wide
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER std::size_t intersectRayTriangles(
+		tvec3<T, P> const & orig, tvec3<T, P> const & dir,
+		tvec3<T, P> const * vertices, std::size_t count,
+		tvec3<T, P> & baryPosition)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'intersectRayTriangles' requires tightly packed tvec3");
+
+		std::size_t const N = detail::wide_batch<T>::lanes;
+		wide::vec3<T, N> const Orig(orig);
+		wide::vec3<T, N> const Dir(dir);
+		std::size_t Nearest = count;
+		T Distance = std::numeric_limits<T>::infinity();
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			T const * v = &vertices[i * 3].x;
+			wide::vec3<T, N> Bary;
+			unsigned int Hits = detail::wide_ray_triangle<T, N>(Orig, Dir,
+				detail::wide_gather3<T, N>(v + 0, 9), detail::wide_gather3<T, N>(v + 3, 9), detail::wide_gather3<T, N>(v + 6, 9), Bary);
+			Hits &= wide::lessThan(Bary.z, wide::scalar<T, N>(Distance));
+			for(std::size_t j = 0; Hits; ++j, Hits >>= 1)
+				if((Hits & 1) && Bary.z[j] < Distance)
+				{
+					Distance = Bary.z[j];
+					Nearest = i + j;
+					baryPosition = tvec3<T, P>(Bary.at(j));
+				}
+		}
+		for(; i < count; ++i)
+		{
+			tvec3<T, P> Bary;
+			if(intersectRayTriangle(orig, dir, vertices[i * 3 + 0], vertices[i * 3 + 1], vertices[i * 3 + 2], Bary) && Bary.z < Distance)
+			{
+				Distance = Bary.z;
+				Nearest = i;
+				baryPosition = Bary;
+			}
+		}
+
+		return Nearest;
+	}
+}//namespace glm
@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_noise
+/// @file glm/gtx/wide_noise.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// @see core (dependence)
+/// @see gtc_noise (dependence)
+/// @see gtx_wide (dependence)
+///
+/// @defgroup gtx_wide_noise GLM_GTX_wide_noise
+/// @ingroup gtx
+/// 
+/// @brief Perlin and simplex noise of N points at once, and of whole arrays.
+/// 
+/// The noise of GLM_GTC_noise hashes the lattice points with a polynomial
+/// modulo 289 instead of a permutation table, so it has no lookup which
+/// would need a gather: the functions of this extension evaluate it for N
+/// points at once with the same arithmetic, one point per lane of the
+/// GLM_GTX_wide registers. They return the values of glm::perlin and
+/// glm::simplex up to the rounding.
+/// perlinNoise() and simplexNoise() evaluate whole arrays of points at the
+/// width of GLM_ARCH, perlinFbm() and simplexFbm() sum octaves of them
+/// (fractional Brownian motion), for terrains and turbulence.
+/// 
+/// <glm/gtx/wide_noise.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/noise.hpp"
+#include "../gtx/wide.hpp"
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_wide_noise extension included")
+#endif
+
+namespace glm{
+namespace wide
+{
+	/// @addtogroup gtx_wide_noise
+	/// @{
+
+	/// Classic perlin noise of the N points (x, y).
+	/// @see gtc_noise
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> perlin(scalar<T, N> const & x, scalar<T, N> const & y);
+
+	/// Classic perlin noise of N points.
+	/// @see gtc_noise
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> perlin(vec3<T, N> const & p);
+
+	/// Simplex noise of the N points (x, y).
+	/// @see gtc_noise
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> simplex(scalar<T, N> const & x, scalar<T, N> const & y);
+
+	/// Simplex noise of N points.
+	/// @see gtc_noise
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> simplex(vec3<T, N> const & p);
+
+	/// @}
+}//namespace wide
+
+	/// @addtogroup gtx_wide_noise
+	/// @{
+
+	/// out[i] = perlin(p[i]).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void perlinNoise(tvec2<T, P> const * p, T * out, std::size_t count);
+
+	/// out[i] = perlin(p[i]).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void perlinNoise(tvec3<T, P> const * p, T * out, std::size_t count);
+
+	/// out[i] = simplex(p[i]).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void simplexNoise(tvec2<T, P> const * p, T * out, std::size_t count);
+
+	/// out[i] = simplex(p[i]).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void simplexNoise(tvec3<T, P> const * p, T * out, std::size_t count);
+
+	/// out[i] = the sum over the octaves o of gain^o * perlin(p[i] * lacunarity^o).
+	/// The sum is not normalized, with a gain below 1 it stays below
+	/// 1 / (1 - gain) in magnitude.
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void perlinFbm(tvec2<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity = static_cast<T>(2), T gain = static_cast<T>(0.5));
+
+	/// out[i] = the sum over the octaves o of gain^o * perlin(p[i] * lacunarity^o).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void perlinFbm(tvec3<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity = static_cast<T>(2), T gain = static_cast<T>(0.5));
+
+	/// out[i] = the sum over the octaves o of gain^o * simplex(p[i] * lacunarity^o).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void simplexFbm(tvec2<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity = static_cast<T>(2), T gain = static_cast<T>(0.5));
+
+	/// out[i] = the sum over the octaves o of gain^o * simplex(p[i] * lacunarity^o).
+	/// From GLM_GTX_wide_noise extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void simplexFbm(tvec3<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity = static_cast<T>(2), T gain = static_cast<T>(0.5));
+
+	/// @}
+}//namespace glm
+
+#include "wide_noise.inl"
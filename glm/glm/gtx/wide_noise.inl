@@ -0,0 +1,458 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_noise
+/// @file glm/gtx/wide_noise.inl
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+// The lanes follow glm/gtc/noise.inl step by step, the vectors of the scalar
+// code spread over one wide::scalar per component.
+///////////////////////////////////////////////////////////////////////////////////
+
+namespace glm{
+namespace detail
+{
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> wide_mod289(wide::scalar<T, N> const & x)
+	{
+		wide::scalar<T, N> const Modulo(static_cast<T>(289));
+		return x - wide::floor(x / Modulo) * Modulo;
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> wide_permute(wide::scalar<T, N> const & x)
+	{
+		return wide_mod289((x * wide::scalar<T, N>(static_cast<T>(34)) + wide::scalar<T, N>(static_cast<T>(1))) * x);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> wide_taylorInvSqrt(wide::scalar<T, N> const & r)
+	{
+		return wide::scalar<T, N>(static_cast<T>(1.79284291400159)) - wide::scalar<T, N>(static_cast<T>(0.85373472095314)) * r;
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> wide_fade(wide::scalar<T, N> const & t)
+	{
+		return (t * t * t) * (t * (t * wide::scalar<T, N>(static_cast<T>(6)) - wide::scalar<T, N>(static_cast<T>(15))) + wide::scalar<T, N>(static_cast<T>(10)));
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> wide_mix(wide::scalar<T, N> const & x, wide::scalar<T, N> const & y, wide::scalar<T, N> const & a)
+	{
+		return x + a * (y - x);
+	}
+
+	// The contribution of the corner hashed to h of the 3D perlin noise, at
+	// the offset (x, y, z) from it
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> wide_perlin_corner(wide::scalar<T, N> const & h,
+		wide::scalar<T, N> const & x, wide::scalar<T, N> const & y, wide::scalar<T, N> const & z)
+	{
+		typedef wide::scalar<T, N> lane;
+
+		lane const Half(static_cast<T>(0.5));
+		lane const Zero(static_cast<T>(0));
+		lane gx = h * lane(static_cast<T>(1.0 / 7.0));
+		lane gy = wide::fract(wide::floor(gx) * lane(static_cast<T>(1.0 / 7.0))) - Half;
+		gx = wide::fract(gx);
+		lane const gz = Half - wide::abs(gx) - wide::abs(gy);
+		lane const sz = wide::step(gz, Zero);
+		gx = gx - sz * (wide::step(Zero, gx) - Half);
+		gy = gy - sz * (wide::step(Zero, gy) - Half);
+
+		lane const Norm = wide_taylorInvSqrt(gx * gx + gy * gy + gz * gz);
+		return (gx * Norm) * x + (gy * Norm) * y + (gz * Norm) * z;
+	}
+
+	struct wide_perlin
+	{
+		template <typename T, std::size_t N>
+		GLM_FUNC_QUALIFIER static wide::scalar<T, N> call(wide::scalar<T, N> const & x, wide::scalar<T, N> const & y)
+		{
+			return wide::perlin(x, y);
+		}
+
+		template <typename T, std::size_t N>
+		GLM_FUNC_QUALIFIER static wide::scalar<T, N> call(wide::vec3<T, N> const & p)
+		{
+			return wide::perlin(p);
+		}
+
+		template <typename T, precision P, template <typename, precision> class vecType>
+		GLM_FUNC_QUALIFIER static T call(vecType<T, P> const & p)
+		{
+			return glm::perlin(p);
+		}
+	};
+
+	struct wide_simplex
+	{
+		template <typename T, std::size_t N>
+		GLM_FUNC_QUALIFIER static wide::scalar<T, N> call(wide::scalar<T, N> const & x, wide::scalar<T, N> const & y)
+		{
+			return wide::simplex(x, y);
+		}
+
+		template <typename T, std::size_t N>
+		GLM_FUNC_QUALIFIER static wide::scalar<T, N> call(wide::vec3<T, N> const & p)
+		{
+			return wide::simplex(p);
+		}
+
+		template <typename T, precision P, template <typename, precision> class vecType>
+		GLM_FUNC_QUALIFIER static T call(vecType<T, P> const & p)
+		{
+			return glm::simplex(p);
+		}
+	};
+
+	template <typename Noise, typename T, precision P>
+	GLM_FUNC_QUALIFIER void batch_fbm(tvec2<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity, T gain)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec2<T, P>) == 2 * sizeof(T), "'perlinNoise' and 'simplexNoise' require tightly packed tvec2");
+
+		std::size_t const N = wide_batch<T>::lanes;
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			wide::scalar<T, N> const x = compute_wide_gather<T, N>::gather(&p[i].x, 2);
+			wide::scalar<T, N> const y = compute_wide_gather<T, N>::gather(&p[i].y, 2);
+			wide::scalar<T, N> Sum(static_cast<T>(0));
+			T Frequency = static_cast<T>(1);
+			T Amplitude = static_cast<T>(1);
+			for(int o = 0; o < octaves; ++o, Frequency *= lacunarity, Amplitude *= gain)
+				Sum = Sum + wide::scalar<T, N>(Amplitude) * Noise::call(x * wide::scalar<T, N>(Frequency), y * wide::scalar<T, N>(Frequency));
+			compute_wide_gather<T, N>::scatter(Sum, out + i, 1);
+		}
+		for(std::size_t k = 0, Remaining = count - i; k < Remaining; ++k)
+		{
+			T Sum = static_cast<T>(0);
+			T Frequency = static_cast<T>(1);
+			T Amplitude = static_cast<T>(1);
+			for(int o = 0; o < octaves; ++o, Frequency *= lacunarity, Amplitude *= gain)
+				Sum += Amplitude * Noise::call(p[i + k] * Frequency);
+			out[i + k] = Sum;
+		}
+	}
+
+	template <typename Noise, typename T, precision P>
+	GLM_FUNC_QUALIFIER void batch_fbm(tvec3<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity, T gain)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'perlinNoise' and 'simplexNoise' require tightly packed tvec3");
+
+		std::size_t const N = wide_batch<T>::lanes;
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			wide::vec3<T, N> const v = compute_wide_aos3<T, N>::load(&p[i].x);
+			wide::scalar<T, N> Sum(static_cast<T>(0));
+			T Frequency = static_cast<T>(1);
+			T Amplitude = static_cast<T>(1);
+			for(int o = 0; o < octaves; ++o, Frequency *= lacunarity, Amplitude *= gain)
+				Sum = Sum + wide::scalar<T, N>(Amplitude) * Noise::call(v * wide::scalar<T, N>(Frequency));
+			compute_wide_gather<T, N>::scatter(Sum, out + i, 1);
+		}
+		for(std::size_t k = 0, Remaining = count - i; k < Remaining; ++k)
+		{
+			T Sum = static_cast<T>(0);
+			T Frequency = static_cast<T>(1);
+			T Amplitude = static_cast<T>(1);
+			for(int o = 0; o < octaves; ++o, Frequency *= lacunarity, Amplitude *= gain)
+				Sum += Amplitude * Noise::call(p[i + k] * Frequency);
+			out[i + k] = Sum;
+		}
+	}
+}//namespace detail
+
+namespace wide
+{
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> perlin(scalar<T, N> const & x, scalar<T, N> const & y)
+	{
+		typedef scalar<T, N> lane;
+
+		lane const One(static_cast<T>(1));
+		lane const Half(static_cast<T>(0.5));
+
+		// Integer and fractional parts of the corners (x0, y0) and (x1, y1)
+		lane const Fx = floor(x);
+		lane const Fy = floor(y);
+		lane const ix0 = detail::wide_mod289(Fx);
+		lane const iy0 = detail::wide_mod289(Fy);
+		lane const ix1 = detail::wide_mod289(Fx + One);
+		lane const iy1 = detail::wide_mod289(Fy + One);
+		lane const fx0 = fract(x);
+		lane const fy0 = fract(y);
+		lane const fx1 = fx0 - One;
+		lane const fy1 = fy0 - One;
+
+		lane const px0 = detail::wide_permute(ix0);
+		lane const px1 = detail::wide_permute(ix1);
+		lane const Hash[4] = {
+			detail::wide_permute(px0 + iy0),
+			detail::wide_permute(px1 + iy0),
+			detail::wide_permute(px0 + iy1),
+			detail::wide_permute(px1 + iy1)};
+		lane const Fxs[4] = {fx0, fx1, fx0, fx1};
+		lane const Fys[4] = {fy0, fy0, fy1, fy1};
+
+		lane n[4];
+		for(std::size_t k = 0; k < 4; ++k)
+		{
+			lane gx = lane(static_cast<T>(2)) * fract(Hash[k] / lane(static_cast<T>(41))) - One;
+			lane const gy = abs(gx) - Half;
+			gx = gx - floor(gx + Half);
+			lane const Norm = detail::wide_taylorInvSqrt(gx * gx + gy * gy);
+			n[k] = (gx * Norm) * Fxs[k] + (gy * Norm) * Fys[k];
+		}
+
+		lane const FadeX = detail::wide_fade(fx0);
+		lane const FadeY = detail::wide_fade(fy0);
+		return lane(static_cast<T>(2.3)) * detail::wide_mix(detail::wide_mix(n[0], n[1], FadeX), detail::wide_mix(n[2], n[3], FadeX), FadeY);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> perlin(vec3<T, N> const & p)
+	{
+		typedef scalar<T, N> lane;
+
+		lane const One(static_cast<T>(1));
+
+		lane const Fx = floor(p.x);
+		lane const Fy = floor(p.y);
+		lane const Fz = floor(p.z);
+		lane const ix0 = detail::wide_mod289(Fx);
+		lane const iy0 = detail::wide_mod289(Fy);
+		lane const iz0 = detail::wide_mod289(Fz);
+		lane const ix1 = detail::wide_mod289(Fx + One);
+		lane const iy1 = detail::wide_mod289(Fy + One);
+		lane const iz1 = detail::wide_mod289(Fz + One);
+		lane const fx0 = fract(p.x);
+		lane const fy0 = fract(p.y);
+		lane const fz0 = fract(p.z);
+		lane const fx1 = fx0 - One;
+		lane const fy1 = fy0 - One;
+		lane const fz1 = fz0 - One;
+
+		lane const px0 = detail::wide_permute(ix0);
+		lane const px1 = detail::wide_permute(ix1);
+		lane const Hash[4] = {
+			detail::wide_permute(px0 + iy0),
+			detail::wide_permute(px1 + iy0),
+			detail::wide_permute(px0 + iy1),
+			detail::wide_permute(px1 + iy1)};
+		lane const Fxs[4] = {fx0, fx1, fx0, fx1};
+		lane const Fys[4] = {fy0, fy0, fy1, fy1};
+
+		// The corners of the z0 and z1 faces mixed along z
+		lane const FadeZ = detail::wide_fade(fz0);
+		lane nz[4];
+		for(std::size_t k = 0; k < 4; ++k)
+		{
+			lane const n0 = detail::wide_perlin_corner(detail::wide_permute(Hash[k] + iz0), Fxs[k], Fys[k], fz0);
+			lane const n1 = detail::wide_perlin_corner(detail::wide_permute(Hash[k] + iz1), Fxs[k], Fys[k], fz1);
+			nz[k] = detail::wide_mix(n0, n1, FadeZ);
+		}
+
+		lane const FadeX = detail::wide_fade(fx0);
+		lane const FadeY = detail::wide_fade(fy0);
+		return lane(static_cast<T>(2.2)) * detail::wide_mix(detail::wide_mix(nz[0], nz[2], FadeY), detail::wide_mix(nz[1], nz[3], FadeY), FadeX);
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> simplex(scalar<T, N> const & x, scalar<T, N> const & y)
+	{
+		typedef scalar<T, N> lane;
+
+		lane const Cx(static_cast<T>(0.211324865405187));	// (3.0 - sqrt(3.0)) / 6.0
+		lane const Cy(static_cast<T>(0.366025403784439));	// 0.5 * (sqrt(3.0) - 1.0)
+		lane const Cz(static_cast<T>(-0.577350269189626));	// -1.0 + 2.0 * C.x
+		lane const Cw(static_cast<T>(0.024390243902439));	// 1.0 / 41.0
+		lane const Zero(static_cast<T>(0));
+		lane const One(static_cast<T>(1));
+		lane const Half(static_cast<T>(0.5));
+
+		// First corner
+		lane const s = x * Cy + y * Cy;
+		lane ix = floor(x + s);
+		lane iy = floor(y + s);
+		lane const t = ix * Cx + iy * Cx;
+		lane const x0 = x - ix + t;
+		lane const y0 = y - iy + t;
+
+		// Other corners, x0 > y0 ? (1, 0) : (0, 1)
+		lane const i1y = step(x0, y0);
+		lane const i1x = One - i1y;
+		lane const Xs[3] = {x0, x0 + Cx - i1x, x0 + Cz};
+		lane const Ys[3] = {y0, y0 + Cx - i1y, y0 + Cz};
+
+		// Permutations
+		ix = detail::wide_mod289(ix);
+		iy = detail::wide_mod289(iy);
+		lane const Hash[3] = {
+			detail::wide_permute(detail::wide_permute(iy) + ix),
+			detail::wide_permute(detail::wide_permute(iy + i1y) + ix + i1x),
+			detail::wide_permute(detail::wide_permute(iy + One) + ix + One)};
+
+		// Gradients: 41 points uniformly over a line, mapped onto a diamond,
+		// normalized implicitly by scaling m
+		lane Sum = Zero;
+		for(std::size_t k = 0; k < 3; ++k)
+		{
+			lane m = max(Half - (Xs[k] * Xs[k] + Ys[k] * Ys[k]), Zero);
+			m = m * m;
+			m = m * m;
+
+			lane const gx = lane(static_cast<T>(2)) * fract(Hash[k] * Cw) - One;
+			lane const h = abs(gx) - Half;
+			lane const a0 = gx - floor(gx + Half);
+			m = m * detail::wide_taylorInvSqrt(a0 * a0 + h * h);
+			Sum = Sum + m * (a0 * Xs[k] + h * Ys[k]);
+		}
+		return lane(static_cast<T>(130)) * Sum;
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> simplex(vec3<T, N> const & v)
+	{
+		typedef scalar<T, N> lane;
+
+		lane const Cx(static_cast<T>(1.0 / 6.0));
+		lane const Cy(static_cast<T>(1.0 / 3.0));
+		lane const Zero(static_cast<T>(0));
+		lane const One(static_cast<T>(1));
+		lane const Half(static_cast<T>(0.5));
+
+		// First corner
+		lane const s = v.x * Cy + v.y * Cy + v.z * Cy;
+		lane ix = floor(v.x + s);
+		lane iy = floor(v.y + s);
+		lane iz = floor(v.z + s);
+		lane const t = ix * Cx + iy * Cx + iz * Cx;
+		lane const x0 = v.x - ix + t;
+		lane const y0 = v.y - iy + t;
+		lane const z0 = v.z - iz + t;
+
+		// Other corners
+		lane const gx = step(y0, x0);
+		lane const gy = step(z0, y0);
+		lane const gz = step(x0, z0);
+		lane const lx = One - gx;
+		lane const ly = One - gy;
+		lane const lz = One - gz;
+		lane const Ox[4] = {Zero, min(gx, lz), max(gx, lz), One};
+		lane const Oy[4] = {Zero, min(gy, lx), max(gy, lx), One};
+		lane const Oz[4] = {Zero, min(gz, ly), max(gz, ly), One};
+		lane const Xs[4] = {x0, x0 - Ox[1] + Cx, x0 - Ox[2] + Cy, x0 - Half};
+		lane const Ys[4] = {y0, y0 - Oy[1] + Cx, y0 - Oy[2] + Cy, y0 - Half};
+		lane const Zs[4] = {z0, z0 - Oz[1] + Cx, z0 - Oz[2] + Cy, z0 - Half};
+
+		ix = detail::wide_mod289(ix);
+		iy = detail::wide_mod289(iy);
+		iz = detail::wide_mod289(iz);
+
+		// Gradients: 7x7 points over a square, mapped onto an octahedron.
+		// The ring size 17*17 = 289 is close to a multiple of 49 (49*6 = 294)
+		lane const n_(static_cast<T>(0.142857142857)); // 1.0/7.0
+		lane const nsx = n_ * lane(static_cast<T>(2));
+		lane const nsy = n_ * Half - One;
+
+		lane Sum = Zero;
+		for(std::size_t k = 0; k < 4; ++k)
+		{
+			lane const p = detail::wide_permute(detail::wide_permute(detail::wide_permute(
+				iz + Oz[k]) + iy + Oy[k]) + ix + Ox[k]);
+
+			lane const j = p - lane(static_cast<T>(49)) * floor(p * n_ * n_); // mod(p,7*7)
+			lane const x_ = floor(j * n_);
+			lane const y_ = floor(j - lane(static_cast<T>(7)) * x_); // mod(j,N)
+			lane const gx = x_ * nsx + nsy;
+			lane const gy = y_ * nsx + nsy;
+			lane const h = One - abs(gx) - abs(gy);
+			lane const sh = -step(h, Zero);
+			lane const ax = gx + (floor(gx) * lane(static_cast<T>(2)) + One) * sh;
+			lane const ay = gy + (floor(gy) * lane(static_cast<T>(2)) + One) * sh;
+
+			lane const Norm = detail::wide_taylorInvSqrt(ax * ax + ay * ay + h * h);
+			lane m = max(lane(static_cast<T>(0.6)) - (Xs[k] * Xs[k] + Ys[k] * Ys[k] + Zs[k] * Zs[k]), Zero);
+			m = m * m;
+			Sum = Sum + (m * m) * ((ax * Norm) * Xs[k] + (ay * Norm) * Ys[k] + (h * Norm) * Zs[k]);
+		}
+		return lane(static_cast<T>(42)) * Sum;
+	}
+}//namespace wide
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void perlinNoise(tvec2<T, P> const * p, T * out, std::size_t count)
+	{
+		detail::batch_fbm<detail::wide_perlin>(p, out, count, 1, static_cast<T>(1), static_cast<T>(1));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void perlinNoise(tvec3<T, P> const * p, T * out, std::size_t count)
+	{
+		detail::batch_fbm<detail::wide_perlin>(p, out, count, 1, static_cast<T>(1), static_cast<T>(1));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void simplexNoise(tvec2<T, P> const * p, T * out, std::size_t count)
+	{
+		detail::batch_fbm<detail::wide_simplex>(p, out, count, 1, static_cast<T>(1), static_cast<T>(1));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void simplexNoise(tvec3<T, P> const * p, T * out, std::size_t count)
+	{
+		detail::batch_fbm<detail::wide_simplex>(p, out, count, 1, static_cast<T>(1), static_cast<T>(1));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void perlinFbm(tvec2<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity, T gain)
+	{
+		detail::batch_fbm<detail::wide_perlin>(p, out, count, octaves, lacunarity, gain);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void perlinFbm(tvec3<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity, T gain)
+	{
+		detail::batch_fbm<detail::wide_perlin>(p, out, count, octaves, lacunarity, gain);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void simplexFbm(tvec2<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity, T gain)
+	{
+		detail::batch_fbm<detail::wide_simplex>(p, out, count, octaves, lacunarity, gain);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void simplexFbm(tvec3<T, P> const * p, T * out, std::size_t count, int octaves, T lacunarity, T gain)
+	{
+		detail::batch_fbm<detail::wide_simplex>(p, out, count, octaves, lacunarity, gain);
+	}
+}//namespace glm
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_packing
+/// @file glm/gtx/wide_packing.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// @see core (dependence)
+/// @see gtc_quaternion (dependence)
+/// @see gtc_type_precision (dependence)
+/// @see gtx_wide (dependence)
+///
+/// @defgroup gtx_wide_packing GLM_GTX_wide_packing
+/// @ingroup gtx
+/// 
+/// @brief Compact encodings of rotations and instance transforms.
+/// 
+/// A mat4 per instance is 64 bytes. A rotation packs into 32 bits with the
+/// smallest three components of its quaternion, the largest being
+/// recovered from the unit length, and a translation in a known box into
+/// 16 bits per axis: an instance which rotates, moves and scales uniformly
+/// takes 12 bytes, which a vertex shader unpacks as unpackInstance() does.
+/// packInstances() encodes whole arrays of matrices, N at a time in the
+/// GLM_GTX_wide registers.
+/// 
+/// <glm/gtx/wide_packing.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/quaternion.hpp"
+#include "../gtc/type_precision.hpp"
+#include "../gtx/wide.hpp"
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_wide_packing extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_wide_packing
+	/// @{
+
+	/// Packs a unit quaternion into a 32 bits unsigned integer: the index
+	/// of its component of the largest magnitude in the two highest bits,
+	/// then the three others in x, y, z, w order, 10 bits each, as
+	/// round(c * 511 * sqrt(2)) + 512. The quaternion is negated first if
+	/// the largest component is negative, which is the same rotation.
+	/// The three components are within 0.0007 of q's.
+	/// @see unpackQuatSmallestThree(uint32 const & p)
+	/// From GLM_GTX_wide_packing extension.
+	GLM_FUNC_DECL uint32 packQuatSmallestThree(quat const & q);
+
+	/// Unpacks a quaternion packed by packQuatSmallestThree(), the largest
+	/// component being sqrt(1 - the sum of the squares of the others).
+	/// @see packQuatSmallestThree(quat const & q)
+	/// From GLM_GTX_wide_packing extension.
+	GLM_FUNC_DECL quat unpackQuatSmallestThree(uint32 const & p);
+
+	/// Packs m, a rotation scaled uniformly then translated, into 12 bytes:
+	/// x: the rotation, as packQuatSmallestThree()
+	/// y: the translation in steps of unit from origin, x | y << 16
+	/// z: z | s << 16, with the scale as 2^((s - 128) / 32)
+	/// The translation is clamped to [0, 65535] steps and s to [0, 255],
+	/// the scale is the mean length of the three first columns.
+	/// @see unpackInstance(u32vec3 const & p, vec3 const & origin, float unit)
+	/// From GLM_GTX_wide_packing extension.
+	GLM_FUNC_DECL u32vec3 packInstance(mat4 const & m, vec3 const & origin, float unit);
+
+	/// Unpacks a transform packed by packInstance() with the same origin
+	/// and unit.
+	/// @see packInstance(mat4 const & m, vec3 const & origin, float unit)
+	/// From GLM_GTX_wide_packing extension.
+	GLM_FUNC_DECL mat4 unpackInstance(u32vec3 const & p, vec3 const & origin, float unit);
+
+	/// out[i] = packInstance(in[i], origin, unit), N matrices at a time.
+	/// From GLM_GTX_wide_packing extension.
+	GLM_FUNC_DECL void packInstances(mat4 const * in, u32vec3 * out, std::size_t count, vec3 const & origin, float unit);
+
+	/// @}
+}//namespace glm
+
+#include "wide_packing.inl"
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_packing
+/// @file glm/gtx/wide_packing.inl
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+namespace glm{
+namespace detail
+{
+	// A component in [-1 / sqrt(2), 1 / sqrt(2)] in steps of this
+	GLM_FUNC_QUALIFIER float smallest_three_scale()
+	{
+		return 511.0f * 1.41421356237f;
+	}
+
+	// The step of the scale of an instance is 2^(1/32)
+	GLM_FUNC_QUALIFIER uint32 pack_instance_scale(float s)
+	{
+		if(!(s > 0.0f))
+			return 0;
+		return static_cast<uint32>(clamp(floor(log2(s) * 32.0f + 128.5f), 0.0f, 255.0f));
+	}
+
+	// N matrices of in packed into the 3 words each of out
+	template <std::size_t N>
+	GLM_FUNC_QUALIFIER void batch_pack_instances(float const * in, uint32 * out, wide::vec3<float, N> const & Origin, wide::scalar<float, N> const & InvUnit)
+	{
+		typedef wide::scalar<float, N> lane;
+		typedef wide::vec3<float, N> vec;
+
+		wide::vec4<float, N> const c0 = compute_wide_aos4<float, N>::load(in + 0, 16);
+		wide::vec4<float, N> const c1 = compute_wide_aos4<float, N>::load(in + 4, 16);
+		wide::vec4<float, N> const c2 = compute_wide_aos4<float, N>::load(in + 8, 16);
+		wide::vec4<float, N> const c3 = compute_wide_aos4<float, N>::load(in + 12, 16);
+		lane const l0 = wide::length(vec(c0.x, c0.y, c0.z));
+		lane const l1 = wide::length(vec(c1.x, c1.y, c1.z));
+		lane const l2 = wide::length(vec(c2.x, c2.y, c2.z));
+		lane const Scale = (l0 + l1 + l2) * lane(1.0f / 3.0f);
+
+		// The rotation, the magnitudes of its quaternion from the diagonal
+		// and their signs from the rest, w being positive
+		lane const Zero(0.0f), One(1.0f), Half(0.5f);
+		lane const m00 = c0.x / l0, m11 = c1.y / l1, m22 = c2.z / l2;
+		lane const x = wide::flipSign(Half * wide::sqrt(wide::max(One + m00 - m11 - m22, Zero)), c1.z / l1 - c2.y / l2);
+		lane const y = wide::flipSign(Half * wide::sqrt(wide::max(One - m00 + m11 - m22, Zero)), c2.x / l2 - c0.z / l0);
+		lane const z = wide::flipSign(Half * wide::sqrt(wide::max(One - m00 - m11 + m22, Zero)), c0.y / l0 - c1.x / l1);
+		lane const w = Half * wide::sqrt(wide::max(One + m00 + m11 + m22, Zero));
+
+		// The index of the largest as 0 to 3, the others in order
+		lane const ax = wide::abs(x), ay = wide::abs(y), az = wide::abs(z);
+		lane const yx = wide::step(ax, ay), wz = wide::step(az, w);
+		lane const hi = wide::step(wide::max(ax, ay), wide::max(az, w));
+		lane const Index = hi * (lane(2.0f) + wz - yx) + yx;
+		lane const Largest = (hi * (z + (w - z) * wz - x - (y - x) * yx)) + x + (y - x) * yx;
+		lane const g1 = wide::step(One, Index), g2 = wide::step(lane(2.0f), Index), g3 = wide::step(lane(3.0f), Index);
+		lane const Scale3(smallest_three_scale()), Round(512.5f), Max10(1023.0f);
+		lane const a = wide::flipSign(y + (x - y) * g1, Largest);
+		lane const b = wide::flipSign(z + (y - z) * g2, Largest);
+		lane const c = wide::flipSign(w + (z - w) * g3, Largest);
+		lane const qa = wide::min(wide::floor(wide::fma(a, Scale3, Round)), Max10);
+		lane const qb = wide::min(wide::floor(wide::fma(b, Scale3, Round)), Max10);
+		lane const qc = wide::min(wide::floor(wide::fma(c, Scale3, Round)), Max10);
+
+		lane const Max16(65535.0f);
+		vec const p = (vec(c3.x, c3.y, c3.z) - Origin) * InvUnit;
+		lane const px = wide::min(wide::max(wide::floor(p.x + Half), Zero), Max16);
+		lane const py = wide::min(wide::max(wide::floor(p.y + Half), Zero), Max16);
+		lane const pz = wide::min(wide::max(wide::floor(p.z + Half), Zero), Max16);
+
+		for(std::size_t j = 0; j < N; ++j)
+		{
+			out[j * 3 + 0] = static_cast<uint32>(Index[j]) << 30 | static_cast<uint32>(qa[j]) << 20 | static_cast<uint32>(qb[j]) << 10 | static_cast<uint32>(qc[j]);
+			out[j * 3 + 1] = static_cast<uint32>(px[j]) | static_cast<uint32>(py[j]) << 16;
+			out[j * 3 + 2] = static_cast<uint32>(pz[j]) | pack_instance_scale(Scale[j]) << 16;
+		}
+	}
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER uint32 packQuatSmallestThree(quat const & q)
+	{
+		float const c[4] = {q.x, q.y, q.z, q.w};
+		uint32 Index = 0;
+		for(uint32 i = 1; i < 4; ++i)
+			if(abs(c[i]) > abs(c[Index]))
+				Index = i;
+
+		float const Sign = c[Index] < 0.0f ? -1.0f : 1.0f;
+		uint32 Result = Index << 30;
+		int Shift = 20;
+		for(uint32 i = 0; i < 4; ++i)
+		{
+			if(i == Index)
+				continue;
+			float const v = min(floor(c[i] * Sign * detail::smallest_three_scale() + 512.5f), 1023.0f);
+			Result |= static_cast<uint32>(max(v, 0.0f)) << Shift;
+			Shift -= 10;
+		}
+		return Result;
+	}
+
+	GLM_FUNC_QUALIFIER quat unpackQuatSmallestThree(uint32 const & p)
+	{
+		uint32 const Index = p >> 30;
+		float c[4];
+		float Sum = 0.0f;
+		int Shift = 20;
+		for(uint32 i = 0; i < 4; ++i)
+		{
+			if(i == Index)
+				continue;
+			c[i] = (static_cast<float>((p >> Shift) & 1023u) - 512.0f) / detail::smallest_three_scale();
+			Sum += c[i] * c[i];
+			Shift -= 10;
+		}
+		c[Index] = sqrt(max(1.0f - Sum, 0.0f));
+		return quat(c[3], c[0], c[1], c[2]);
+	}
+
+	GLM_FUNC_QUALIFIER u32vec3 packInstance(mat4 const & m, vec3 const & origin, float unit)
+	{
+		u32vec3 Result;
+		packInstances(&m, &Result, 1, origin, unit);
+		return Result;
+	}
+
+	GLM_FUNC_QUALIFIER mat4 unpackInstance(u32vec3 const & p, vec3 const & origin, float unit)
+	{
+		float const Scale = exp2((static_cast<float>(p.z >> 16) - 128.0f) / 32.0f);
+		mat4 Result = mat4_cast(unpackQuatSmallestThree(p.x));
+		Result[0] *= Scale;
+		Result[1] *= Scale;
+		Result[2] *= Scale;
+		Result[3] = vec4(origin + vec3(p.y & 0xffffu, p.y >> 16, p.z & 0xffffu) * unit, 1.0f);
+		return Result;
+	}
+
+	GLM_FUNC_QUALIFIER void packInstances(mat4 const * in, u32vec3 * out, std::size_t count, vec3 const & origin, float unit)
+	{
+		GLM_STATIC_ASSERT(sizeof(mat4) == 16 * sizeof(float), "'packInstances' requires tightly packed mat4");
+		GLM_STATIC_ASSERT(sizeof(u32vec3) == 3 * sizeof(uint32), "'packInstances' requires tightly packed u32vec3");
+
+		std::size_t const N = detail::wide_batch<float>::matrix_lanes;
+		wide::vec3<float, N> const Origin(origin);
+		wide::scalar<float, N> const InvUnit(1.0f / unit);
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+			detail::batch_pack_instances<N>(&in[i][0].x, &out[i].x, Origin, InvUnit);
+		if(i < count)
+		{
+			float In[N * 16];
+			uint32 Out[N * 3];
+			// Padded with the last matrix
+			for(std::size_t j = 0; j < N; ++j)
+			{
+				float const * m = &in[i + j < count ? i + j : count - 1][0].x;
+				for(std::size_t k = 0; k < 16; ++k)
+					In[j * 16 + k] = m[k];
+			}
+			detail::batch_pack_instances<N>(In, Out, Origin, InvUnit);
+			for(std::size_t j = 0; i + j < count; ++j)
+				out[i + j] = u32vec3(Out[j * 3 + 0], Out[j * 3 + 1], Out[j * 3 + 2]);
+		}
+	}
+}//namespace glm
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_quaternion
+/// @file glm/gtx/wide_quaternion.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// @see core (dependence)
+/// @see gtc_quaternion (dependence)
+/// @see gtx_dual_quaternion (dependence)
+/// @see gtx_wide (dependence)
+///
+/// @defgroup gtx_wide_quaternion GLM_GTX_wide_quaternion
+/// @ingroup gtx
+/// 
+/// @brief Interpolation, conversion and skinning of whole arrays of quaternions.
+/// 
+/// The animation of a skeleton interpolates a pair of keys per joint, turns
+/// the rotations into matrices and blends the dual quaternions of the joints
+/// for every vertex. The functions of this extension do it for whole arrays:
+/// N quaternions are transposed into GLM_GTX_wide registers, one component
+/// per register, and processed at the width of GLM_ARCH, like the batch
+/// functions of GLM_GTX_wide.
+/// 
+/// <glm/gtx/wide_quaternion.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/quaternion.hpp"
+#include "../gtx/dual_quaternion.hpp"
+#include "../gtx/wide.hpp"
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_wide_quaternion extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_wide_quaternion
+	/// @{
+
+	/// out[i] = the normalized linear interpolation from a[i] to b[i] at t[i],
+	/// along the shortest arc. out may be a or b.
+	/// From GLM_GTX_wide_quaternion extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void nlerpQuats(tquat<T, P> const * a, tquat<T, P> const * b, T const * t, tquat<T, P> * out, std::size_t count);
+
+	/// out[i] approximates slerp(a[i], b[i], t[i]): the interpolation of
+	/// nlerpQuats() with t[i] corrected by a polynomial of the angle, so the
+	/// rotation speed is almost constant. The result is within 0.001 radians
+	/// of slerp's, without any trigonometric function. out may be a or b.
+	/// @see gtc_quaternion
+	/// From GLM_GTX_wide_quaternion extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void slerpQuats(tquat<T, P> const * a, tquat<T, P> const * b, T const * t, tquat<T, P> * out, std::size_t count);
+
+	/// out[i] = mat4_cast(q[i]) for unit quaternions.
+	/// @see gtc_quaternion
+	/// From GLM_GTX_wide_quaternion extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void rotationMatrices(tquat<T, P> const * q, tmat4x4<T, P> * out, std::size_t count);
+
+	/// Dual quaternion linear blending: out[i] is in[i] transformed by the
+	/// normalized sum of the four unit dual quaternions joints[indices[i][k]]
+	/// weighted by weights[i][k], each taken on the side of the first one.
+	/// in and out may be the same array.
+	/// From GLM_GTX_wide_quaternion extension.
+	template <typename T, precision P, typename I, precision Q>
+	GLM_FUNC_DECL void skinDualQuats(
+		tdualquat<T, P> const * joints, tvec4<I, Q> const * indices, tvec4<T, P> const * weights,
+		tvec3<T, P> const * in, tvec3<T, P> * out, std::size_t count);
+
+	/// The same, also rotating the normals inNormals[i] into outNormals[i].
+	/// From GLM_GTX_wide_quaternion extension.
+	template <typename T, precision P, typename I, precision Q>
+	GLM_FUNC_DECL void skinDualQuats(
+		tdualquat<T, P> const * joints, tvec4<I, Q> const * indices, tvec4<T, P> const * weights,
+		tvec3<T, P> const * in, tvec3<T, P> * out,
+		tvec3<T, P> const * inNormals, tvec3<T, P> * outNormals, std::size_t count);
+
+	/// @}
+}//namespace glm
+
+#include "wide_quaternion.inl"
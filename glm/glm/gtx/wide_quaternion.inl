@@ -0,0 +1,244 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_quaternion
+/// @file glm/gtx/wide_quaternion.inl
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+namespace glm{
+namespace detail
+{
+	// Corrects t so the nlerp of two quaternions d = |dot(a, b)| apart
+	// follows their slerp: a fit of the error of nlerp in t and d, from
+	// "Approximating slerp", Arseny Kapoulkine
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER wide::scalar<T, N> batch_slerp_t(wide::scalar<T, N> const & d, wide::scalar<T, N> const & t)
+	{
+		typedef wide::scalar<T, N> lane;
+
+		lane const A = wide::fma(d, wide::fma(d, wide::fma(d, lane(static_cast<T>(-1.43519)), lane(static_cast<T>(3.55645))), lane(static_cast<T>(-3.2452))), lane(static_cast<T>(1.0904)));
+		lane const B = wide::fma(d, wide::fma(d, lane(static_cast<T>(0.215638)), lane(static_cast<T>(-1.06021))), lane(static_cast<T>(0.848013)));
+		lane const h = t - lane(static_cast<T>(0.5));
+		lane const k = wide::fma(A * h, h, B);
+		return wide::fma(t * h * (t - lane(static_cast<T>(1))), k, t);
+	}
+
+	// N quaternions of a and b interpolated at t along the shortest arc
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER void batch_lerp_quats(T const * a, T const * b, T const * t, T * out, bool Slerp, bool Stream)
+	{
+		wide::vec4<T, N> const qa = compute_wide_aos4<T, N>::load(a);
+		wide::vec4<T, N> const qb = compute_wide_aos4<T, N>::load(b);
+		wide::scalar<T, N> const d = wide::dot(qa, qb);
+		wide::scalar<T, N> s = compute_wide_gather<T, N>::gather(t, 1);
+		if(Slerp)
+			s = batch_slerp_t(wide::abs(d), s);
+
+		wide::vec4<T, N> const r(
+			wide::fma(wide::flipSign(qb.x, d) - qa.x, s, qa.x),
+			wide::fma(wide::flipSign(qb.y, d) - qa.y, s, qa.y),
+			wide::fma(wide::flipSign(qb.z, d) - qa.z, s, qa.z),
+			wide::fma(wide::flipSign(qb.w, d) - qa.w, s, qa.w));
+		compute_wide_aos4<T, N>::store(r * wide::inversesqrt(wide::dot(r, r)), out, Stream);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void batch_lerp_quats(tquat<T, P> const * a, tquat<T, P> const * b, T const * t, tquat<T, P> * out, std::size_t count, bool Slerp)
+	{
+		GLM_STATIC_ASSERT(sizeof(tquat<T, P>) == 4 * sizeof(T), "'nlerpQuats' and 'slerpQuats' require tightly packed tquat");
+
+		std::size_t const N = wide_batch<T>::lanes;
+		bool const Stream = batch_stream(out, count * sizeof(tquat<T, P>));
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+			batch_lerp_quats<T, N>(&a[i].x, &b[i].x, t + i, &out[i].x, Slerp, Stream);
+		if(i < count)
+		{
+			T A[N * 4], B[N * 4], S[N], Out[N * 4];
+			batch_pad<N>(&a[i].x, 4, count - i, A);
+			batch_pad<N>(&b[i].x, 4, count - i, B);
+			batch_pad<N>(t + i, 1, count - i, S);
+			batch_lerp_quats<T, N>(A, B, S, Out, Slerp, false);
+			for(std::size_t j = 0; i + j < count; ++j)
+				out[i + j] = tquat<T, P>(Out[j * 4 + 3], Out[j * 4 + 0], Out[j * 4 + 1], Out[j * 4 + 2]);
+		}
+
+		batch_fence(Stream);
+	}
+
+	// Adds the joints indices[0], indices[4], ... of N vertices weighted by w
+	// to the blend, each on the side of the sum so far
+	template <typename T, std::size_t N, typename I>
+	GLM_FUNC_QUALIFIER void batch_blend(T const * joints, I const * indices, wide::scalar<T, N> const & w, wide::vec4<T, N> & real, wide::vec4<T, N> & dual)
+	{
+		T Tmp[N * 8];
+		for(std::size_t l = 0; l < N; ++l)
+		{
+			T const * q = joints + static_cast<std::size_t>(indices[l * 4]) * 8;
+			for(std::size_t j = 0; j < 8; ++j)
+				Tmp[l * 8 + j] = q[j];
+		}
+		wide::vec4<T, N> const r = compute_wide_aos4<T, N>::load(Tmp, 8);
+		wide::vec4<T, N> const d = compute_wide_aos4<T, N>::load(Tmp + 4, 8);
+
+		wide::scalar<T, N> const k = wide::flipSign(w, wide::dot(real, r));
+		real = wide::vec4<T, N>(wide::fma(r.x, k, real.x), wide::fma(r.y, k, real.y), wide::fma(r.z, k, real.z), wide::fma(r.w, k, real.w));
+		dual = wide::vec4<T, N>(wide::fma(d.x, k, dual.x), wide::fma(d.y, k, dual.y), wide::fma(d.z, k, dual.z), wide::fma(d.w, k, dual.w));
+	}
+
+	// N vertices skinned, as tdualquat * tvec3 with the blended dual quaternion
+	template <typename T, std::size_t N, typename I>
+	GLM_FUNC_QUALIFIER void batch_skin(T const * joints, I const * indices, T const * weights,
+		T const * in, T * out, T const * inNormals, T * outNormals, bool Stream)
+	{
+		wide::vec4<T, N> const w = compute_wide_aos4<T, N>::load(weights);
+		wide::scalar<T, N> const Zero(static_cast<T>(0));
+		wide::vec4<T, N> real(Zero, Zero, Zero, Zero), dual(real);
+		batch_blend<T, N>(joints, indices + 0, w.x, real, dual);
+		batch_blend<T, N>(joints, indices + 1, w.y, real, dual);
+		batch_blend<T, N>(joints, indices + 2, w.z, real, dual);
+		batch_blend<T, N>(joints, indices + 3, w.w, real, dual);
+
+		wide::scalar<T, N> const InvLength = wide::inversesqrt(wide::dot(real, real));
+		wide::vec3<T, N> const r(real.x * InvLength, real.y * InvLength, real.z * InvLength);
+		wide::vec3<T, N> const d(dual.x * InvLength, dual.y * InvLength, dual.z * InvLength);
+		wide::scalar<T, N> const rw = real.w * InvLength;
+		wide::scalar<T, N> const dw = dual.w * InvLength;
+		wide::scalar<T, N> const Two(static_cast<T>(2));
+
+		wide::vec3<T, N> const p = compute_wide_aos3<T, N>::load(in);
+		compute_wide_aos3<T, N>::store((wide::cross(r, wide::cross(r, p) + p * rw + d) + d * rw - r * dw) * Two + p, out, Stream);
+		if(inNormals)
+		{
+			wide::vec3<T, N> const n = compute_wide_aos3<T, N>::load(inNormals);
+			compute_wide_aos3<T, N>::store(wide::cross(r, wide::cross(r, n) + n * rw) * Two + n, outNormals, Stream);
+		}
+	}
+
+	template <typename T, precision P, typename I, precision Q>
+	GLM_FUNC_QUALIFIER void batch_skin(
+		tdualquat<T, P> const * joints, tvec4<I, Q> const * indices, tvec4<T, P> const * weights,
+		tvec3<T, P> const * in, tvec3<T, P> * out,
+		tvec3<T, P> const * inNormals, tvec3<T, P> * outNormals, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tdualquat<T, P>) == 8 * sizeof(T), "'skinDualQuats' requires tightly packed tdualquat");
+		GLM_STATIC_ASSERT(sizeof(tvec4<I, Q>) == 4 * sizeof(I), "'skinDualQuats' requires tightly packed tvec4");
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'skinDualQuats' requires tightly packed tvec3");
+
+		// The blend holds as many registers as the columns of a matrix
+		std::size_t const N = wide_batch<T>::matrix_lanes;
+		bool const Stream = batch_stream(out, count * sizeof(tvec3<T, P>));
+		T const * Joints = &joints[0].real.x;
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+			batch_skin<T, N>(Joints, &indices[i].x, &weights[i].x, &in[i].x, &out[i].x,
+				inNormals ? &inNormals[i].x : 0, inNormals ? &outNormals[i].x : 0, Stream);
+		if(i < count)
+		{
+			I Indices[N * 4];
+			T Weights[N * 4], In[N * 3], Out[N * 3], InNormals[N * 3], OutNormals[N * 3];
+			batch_pad<N>(&indices[i].x, 4, count - i, Indices);
+			batch_pad<N>(&weights[i].x, 4, count - i, Weights);
+			batch_pad<N>(&in[i].x, 3, count - i, In);
+			if(inNormals)
+				batch_pad<N>(&inNormals[i].x, 3, count - i, InNormals);
+			batch_skin<T, N>(Joints, Indices, Weights, In, Out, inNormals ? InNormals : 0, OutNormals, false);
+			for(std::size_t j = 0; i + j < count; ++j)
+			{
+				out[i + j] = tvec3<T, P>(Out[j * 3 + 0], Out[j * 3 + 1], Out[j * 3 + 2]);
+				if(inNormals)
+					outNormals[i + j] = tvec3<T, P>(OutNormals[j * 3 + 0], OutNormals[j * 3 + 1], OutNormals[j * 3 + 2]);
+			}
+		}
+
+		batch_fence(Stream);
+	}
+}//namespace detail
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void nlerpQuats(tquat<T, P> const * a, tquat<T, P> const * b, T const * t, tquat<T, P> * out, std::size_t count)
+	{
+		detail::batch_lerp_quats(a, b, t, out, count, false);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void slerpQuats(tquat<T, P> const * a, tquat<T, P> const * b, T const * t, tquat<T, P> * out, std::size_t count)
+	{
+		detail::batch_lerp_quats(a, b, t, out, count, true);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void rotationMatrices(tquat<T, P> const * q, tmat4x4<T, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tquat<T, P>) == 4 * sizeof(T), "'rotationMatrices' requires tightly packed tquat");
+		GLM_STATIC_ASSERT(sizeof(tmat4x4<T, P>) == 16 * sizeof(T), "'rotationMatrices' requires tightly packed tmat4x4");
+
+		std::size_t const N = detail::wide_batch<T>::matrix_lanes;
+		bool const Stream = detail::batch_stream(out, count * sizeof(tmat4x4<T, P>));
+		wide::scalar<T, N> const Zero(static_cast<T>(0));
+		wide::scalar<T, N> const One(static_cast<T>(1));
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+		{
+			wide::vec4<T, N> const r = detail::compute_wide_aos4<T, N>::load(&q[i].x);
+			wide::vec4<T, N> const r2 = r + r;
+			wide::scalar<T, N> const xx = r.x * r2.x, yy = r.y * r2.y, zz = r.z * r2.z;
+			wide::scalar<T, N> const xy = r.x * r2.y, xz = r.x * r2.z, yz = r.y * r2.z;
+			wide::scalar<T, N> const wx = r.w * r2.x, wy = r.w * r2.y, wz = r.w * r2.z;
+
+			T * po = &out[i][0].x;
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(One - (yy + zz), xy + wz, xz - wy, Zero), po + 0, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(xy - wz, One - (xx + zz), yz + wx, Zero), po + 4, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(xz + wy, yz - wx, One - (xx + yy), Zero), po + 8, Stream, 16);
+			detail::compute_wide_aos4<T, N>::store(wide::vec4<T, N>(Zero, Zero, Zero, One), po + 12, Stream, 16);
+		}
+		for(; i < count; ++i)
+			out[i] = mat4_cast(q[i]);
+
+		detail::batch_fence(Stream);
+	}
+
+	template <typename T, precision P, typename I, precision Q>
+	GLM_FUNC_QUALIFIER void skinDualQuats(
+		tdualquat<T, P> const * joints, tvec4<I, Q> const * indices, tvec4<T, P> const * weights,
+		tvec3<T, P> const * in, tvec3<T, P> * out, std::size_t count)
+	{
+		detail::batch_skin(joints, indices, weights, in, out, static_cast<tvec3<T, P> const *>(0), static_cast<tvec3<T, P> *>(0), count);
+	}
+
+	template <typename T, precision P, typename I, precision Q>
+	GLM_FUNC_QUALIFIER void skinDualQuats(
+		tdualquat<T, P> const * joints, tvec4<I, Q> const * indices, tvec4<T, P> const * weights,
+		tvec3<T, P> const * in, tvec3<T, P> * out,
+		tvec3<T, P> const * inNormals, tvec3<T, P> * outNormals, std::size_t count)
+	{
+		detail::batch_skin(joints, indices, weights, in, out, inNormals, outNormals, count);
+	}
+}//namespace glm
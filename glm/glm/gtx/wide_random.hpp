@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_random
+/// @file glm/gtx/wide_random.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// @see core (dependence)
+/// @see gtc_random (dependence)
+/// @see gtx_wide (dependence)
+///
+/// @defgroup gtx_wide_random GLM_GTX_wide_random
+/// @ingroup gtx
+/// 
+/// @brief Random numbers N at a time, and whole arrays of them.
+/// 
+/// wide::random<N> is N xoshiro128** generators, one per lane of the
+/// GLM_GTX_wide registers, stepped together with SSE2 or AVX2 integer
+/// instructions. uniform() turns a step into N values in [0, 1), spherical()
+/// into N unit vectors, with a polynomial sine and cosine instead of the C
+/// library.
+/// linearRands() and sphericalRands() fill whole arrays at the width of
+/// GLM_ARCH from generators of the calling thread, which start from its
+/// generator of GLM_GTC_random: the threads do not share any state, and
+/// after seedRand() a thread gets the same numbers again.
+/// 
+/// <glm/gtx/wide_random.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/random.hpp"
+#include "../gtx/wide.hpp"
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_wide_random extension included")
+#endif
+
+namespace glm{
+namespace wide
+{
+	/// @addtogroup gtx_wide_random
+	/// @{
+
+	/// N xoshiro128** generators, the state of lane i in s[0][i] to s[3][i].
+	/// From GLM_GTX_wide_random extension.
+	template <std::size_t N>
+	struct random
+	{
+		static std::size_t const lanes = N;
+
+		uint32 s[4][N];
+	};
+
+	/// Start the N generators at the sequence Seed.
+	/// From GLM_GTX_wide_random extension.
+	template <std::size_t N>
+	GLM_FUNC_DECL void seed(random<N> & r, uint64 Seed);
+
+	/// N values in [0, 1): 24 bits of one step for float, 53 bits of two
+	/// steps for double.
+	/// From GLM_GTX_wide_random extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL scalar<T, N> uniform(random<N> & r);
+
+	/// N vectors uniformly distributed on the unit sphere.
+	/// From GLM_GTX_wide_random extension.
+	template <typename T, std::size_t N>
+	GLM_FUNC_DECL vec3<T, N> spherical(random<N> & r);
+
+	/// @}
+}//namespace wide
+
+	/// @addtogroup gtx_wide_random
+	/// @{
+
+	/// out[i] = linearRand(Min, Max), in [Min, Max).
+	/// From GLM_GTX_wide_random extension.
+	template <typename T>
+	GLM_FUNC_DECL void linearRands(T * out, std::size_t count, T Min, T Max);
+
+	/// out[i] = linearRand(Min, Max), in [Min, Max).
+	/// From GLM_GTX_wide_random extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void linearRands(tvec3<T, P> * out, std::size_t count, tvec3<T, P> const & Min, tvec3<T, P> const & Max);
+
+	/// out[i] = linearRand(Min, Max), in [Min, Max).
+	/// From GLM_GTX_wide_random extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void linearRands(tvec4<T, P> * out, std::size_t count, tvec4<T, P> const & Min, tvec4<T, P> const & Max);
+
+	/// out[i] = sphericalRand(Radius).
+	/// From GLM_GTX_wide_random extension.
+	template <typename T, precision P>
+	GLM_FUNC_DECL void sphericalRands(tvec3<T, P> * out, std::size_t count, T Radius);
+
+	/// @}
+}//namespace glm
+
+#include "wide_random.inl"
@@ -0,0 +1,418 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_wide_random
+/// @file glm/gtx/wide_random.inl
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+namespace glm{
+namespace detail
+{
+	// One step of the N generators, the lanes follow rand_next of
+	// glm/gtc/random.inl
+	template <std::size_t N>
+	struct compute_wide_random
+	{
+		GLM_FUNC_QUALIFIER static void next(wide::random<N> & r, uint32 * out)
+		{
+			for(std::size_t i = 0; i < N; ++i)
+			{
+				uint32 const t = r.s[1][i] << 9;
+				out[i] = rand_rotl(r.s[1][i] * 5u, 7) * 9u;
+				r.s[2][i] ^= r.s[0][i];
+				r.s[3][i] ^= r.s[1][i];
+				r.s[1][i] ^= r.s[2][i];
+				r.s[0][i] ^= r.s[3][i];
+				r.s[2][i] ^= t;
+				r.s[3][i] = rand_rotl(r.s[3][i], 11);
+			}
+		}
+	};
+
+	// 24 bits, so that every value converts exactly
+	template <typename T, std::size_t N>
+	struct compute_wide_uniform
+	{
+		GLM_FUNC_QUALIFIER static wide::scalar<T, N> call(wide::random<N> & r)
+		{
+			uint32 x[N];
+			compute_wide_random<N>::next(r, x);
+			wide::scalar<T, N> Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = static_cast<T>(x[i] >> 8) * static_cast<T>(1.0 / 16777216.0);
+			return Result;
+		}
+	};
+
+	// 26 high bits and 27 low bits of 53
+	template <std::size_t N>
+	struct compute_wide_uniform<double, N>
+	{
+		GLM_FUNC_QUALIFIER static wide::scalar<double, N> call(wide::random<N> & r)
+		{
+			uint32 Hi[N], Lo[N];
+			compute_wide_random<N>::next(r, Hi);
+			compute_wide_random<N>::next(r, Lo);
+			wide::scalar<double, N> Result(uninitialize);
+			for(std::size_t i = 0; i < N; ++i)
+				Result.lane[i] = (static_cast<double>(Hi[i] >> 6) * 134217728.0 + static_cast<double>(Lo[i] >> 5)) * (1.0 / 9007199254740992.0);
+			return Result;
+		}
+	};
+
+#	if GLM_ARCH & GLM_ARCH_SSE2
+		// x * 5 and x * 9 as shifts and adds, SSE2 has no 32 bit multiply
+		template <int K>
+		GLM_FUNC_QUALIFIER __m128i rotl_sse2(__m128i x)
+		{
+			return _mm_or_si128(_mm_slli_epi32(x, K), _mm_srli_epi32(x, 32 - K));
+		}
+
+		template <>
+		struct compute_wide_random<4>
+		{
+			GLM_FUNC_QUALIFIER static __m128i next(wide::random<4> & r)
+			{
+				__m128i s0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(r.s[0]));
+				__m128i s1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(r.s[1]));
+				__m128i s2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(r.s[2]));
+				__m128i s3 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(r.s[3]));
+
+				__m128i const x5 = _mm_add_epi32(s1, _mm_slli_epi32(s1, 2));
+				__m128i const r7 = rotl_sse2<7>(x5);
+				__m128i const Result = _mm_add_epi32(r7, _mm_slli_epi32(r7, 3));
+				__m128i const t = _mm_slli_epi32(s1, 9);
+				s2 = _mm_xor_si128(s2, s0);
+				s3 = _mm_xor_si128(s3, s1);
+				s1 = _mm_xor_si128(s1, s2);
+				s0 = _mm_xor_si128(s0, s3);
+				s2 = _mm_xor_si128(s2, t);
+				s3 = rotl_sse2<11>(s3);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(r.s[0]), s0);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(r.s[1]), s1);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(r.s[2]), s2);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(r.s[3]), s3);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void next(wide::random<4> & r, uint32 * out)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out), next(r));
+			}
+		};
+
+		template <>
+		struct compute_wide_uniform<float, 4>
+		{
+			GLM_FUNC_QUALIFIER static wide::scalar<float, 4> call(wide::random<4> & r)
+			{
+				wide::scalar<float, 4> Result(uninitialize);
+				__m128 const x = _mm_cvtepi32_ps(_mm_srli_epi32(compute_wide_random<4>::next(r), 8));
+				Result.data = _mm_mul_ps(x, _mm_set1_ps(1.0f / 16777216.0f));
+				return Result;
+			}
+		};
+#	endif
+
+#	if GLM_ARCH & GLM_ARCH_AVX2
+		template <int K>
+		GLM_FUNC_QUALIFIER __m256i rotl_avx2(__m256i x)
+		{
+			return _mm256_or_si256(_mm256_slli_epi32(x, K), _mm256_srli_epi32(x, 32 - K));
+		}
+
+		template <>
+		struct compute_wide_random<8>
+		{
+			GLM_FUNC_QUALIFIER static __m256i next(wide::random<8> & r)
+			{
+				__m256i s0 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(r.s[0]));
+				__m256i s1 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(r.s[1]));
+				__m256i s2 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(r.s[2]));
+				__m256i s3 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(r.s[3]));
+
+				__m256i const x5 = _mm256_add_epi32(s1, _mm256_slli_epi32(s1, 2));
+				__m256i const r7 = rotl_avx2<7>(x5);
+				__m256i const Result = _mm256_add_epi32(r7, _mm256_slli_epi32(r7, 3));
+				__m256i const t = _mm256_slli_epi32(s1, 9);
+				s2 = _mm256_xor_si256(s2, s0);
+				s3 = _mm256_xor_si256(s3, s1);
+				s1 = _mm256_xor_si256(s1, s2);
+				s0 = _mm256_xor_si256(s0, s3);
+				s2 = _mm256_xor_si256(s2, t);
+				s3 = rotl_avx2<11>(s3);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(r.s[0]), s0);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(r.s[1]), s1);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(r.s[2]), s2);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(r.s[3]), s3);
+				return Result;
+			}
+
+			GLM_FUNC_QUALIFIER static void next(wide::random<8> & r, uint32 * out)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), next(r));
+			}
+		};
+
+		template <>
+		struct compute_wide_uniform<float, 8>
+		{
+			GLM_FUNC_QUALIFIER static wide::scalar<float, 8> call(wide::random<8> & r)
+			{
+				wide::scalar<float, 8> Result(uninitialize);
+				__m256 const x = _mm256_cvtepi32_ps(_mm256_srli_epi32(compute_wide_random<8>::next(r), 8));
+				Result.data = _mm256_mul_ps(x, _mm256_set1_ps(1.0f / 16777216.0f));
+				return Result;
+			}
+		};
+#	endif
+
+	// The generators of the calling thread, taken from its generator of
+	// GLM_GTC_random each time that one is seeded
+	template <std::size_t N>
+	struct wide_rand_state
+	{
+		wide::random<N> Random;
+		uint32 Seeds;
+	};
+
+	template <std::size_t N>
+	GLM_FUNC_QUALIFIER wide::random<N> & wide_rand_thread_state()
+	{
+#		if GLM_HAS_THREAD_LOCAL
+			static thread_local wide_rand_state<N> State;
+#		else
+			static wide_rand_state<N> State;
+#		endif
+		rand_state & Thread = rand_thread_state();
+		if(State.Seeds != Thread.Seeds)
+		{
+			for(std::size_t i = 0; i < N; ++i)
+			{
+				for(std::size_t k = 0; k < 4; ++k)
+					State.Random.s[k][i] = rand_next(Thread);
+				State.Random.s[3][i] |= 1u;
+			}
+			State.Seeds = Thread.Seeds;
+		}
+		return State.Random;
+	}
+
+	// sin and cos of 2 pi a for a in [-1/2, 1/2): the quarter turn q nearest
+	// to a is taken out, the rest, within an eighth of a turn, goes through
+	// the Taylor series to the 13th and 12th power, and (cos, sin) of q
+	// turns it back. |q| <= 2, so the rotation needs no selects:
+	// cos q = 1 - |q| and sin q = q (2 - |q|).
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER void wide_sincos_turns(wide::scalar<T, N> const & a, wide::scalar<T, N> & Sin, wide::scalar<T, N> & Cos)
+	{
+		typedef wide::scalar<T, N> lane;
+
+		lane const One(static_cast<T>(1));
+		lane const q = wide::floor(a * lane(static_cast<T>(4)) + lane(static_cast<T>(0.5)));
+		lane const x = (a - q * lane(static_cast<T>(0.25))) * lane(static_cast<T>(6.283185307179586476925286766559));
+		lane const x2 = x * x;
+
+		lane s(static_cast<T>(1.0 / 6227020800.0));
+		s = s * x2 - lane(static_cast<T>(1.0 / 39916800.0));
+		s = s * x2 + lane(static_cast<T>(1.0 / 362880.0));
+		s = s * x2 - lane(static_cast<T>(1.0 / 5040.0));
+		s = s * x2 + lane(static_cast<T>(1.0 / 120.0));
+		s = s * x2 - lane(static_cast<T>(1.0 / 6.0));
+		s = (s * x2 + One) * x;
+
+		lane c(static_cast<T>(1.0 / 479001600.0));
+		c = c * x2 - lane(static_cast<T>(1.0 / 3628800.0));
+		c = c * x2 + lane(static_cast<T>(1.0 / 40320.0));
+		c = c * x2 - lane(static_cast<T>(1.0 / 720.0));
+		c = c * x2 + lane(static_cast<T>(1.0 / 24.0));
+		c = c * x2 - lane(static_cast<T>(0.5));
+		c = c * x2 + One;
+
+		lane const Abs = wide::abs(q);
+		lane const Cq = One - Abs;
+		lane const Sq = q * (lane(static_cast<T>(2)) - Abs);
+		Cos = c * Cq - s * Sq;
+		Sin = s * Cq + c * Sq;
+	}
+
+	// N values of Gen per step: whole steps straight to out, the last
+	// partial one through a buffer
+	template <typename T, std::size_t N>
+	struct wide_rand_linear
+	{
+		T Min, Range;
+
+		GLM_FUNC_QUALIFIER void operator()(wide::random<N> & r, T * out) const
+		{
+			wide::scalar<T, N> const v = wide::scalar<T, N>(Min) + wide::uniform<T>(r) * wide::scalar<T, N>(Range);
+			compute_wide_gather<T, N>::scatter(v, out, 1);
+		}
+	};
+
+	template <typename T, std::size_t N>
+	struct wide_rand_linear3
+	{
+		tvec3<T, defaultp> Min, Range;
+
+		GLM_FUNC_QUALIFIER void operator()(wide::random<N> & r, T * out) const
+		{
+			wide::scalar<T, N> const x = wide::uniform<T>(r);
+			wide::scalar<T, N> const y = wide::uniform<T>(r);
+			wide::scalar<T, N> const z = wide::uniform<T>(r);
+			compute_wide_aos3<T, N>::store(wide::vec3<T, N>(Min) + wide::vec3<T, N>(x, y, z) * wide::vec3<T, N>(Range), out);
+		}
+	};
+
+	template <typename T, std::size_t N>
+	struct wide_rand_linear4
+	{
+		tvec4<T, defaultp> Min, Range;
+
+		GLM_FUNC_QUALIFIER void operator()(wide::random<N> & r, T * out) const
+		{
+			wide::scalar<T, N> const x = wide::uniform<T>(r);
+			wide::scalar<T, N> const y = wide::uniform<T>(r);
+			wide::scalar<T, N> const z = wide::uniform<T>(r);
+			wide::scalar<T, N> const w = wide::uniform<T>(r);
+			compute_wide_aos4<T, N>::store(wide::vec4<T, N>(Min) + wide::vec4<T, N>(x, y, z, w) * wide::vec4<T, N>(Range), out);
+		}
+	};
+
+	template <typename T, std::size_t N>
+	struct wide_rand_spherical
+	{
+		T Radius;
+
+		GLM_FUNC_QUALIFIER void operator()(wide::random<N> & r, T * out) const
+		{
+			compute_wide_aos3<T, N>::store(wide::spherical<T>(r) * wide::scalar<T, N>(Radius), out);
+		}
+	};
+
+	// Components values of type T per item
+	template <std::size_t Components, typename T, typename Gen>
+	GLM_FUNC_QUALIFIER void batch_rand(T * out, std::size_t count, Gen const & Generate)
+	{
+		std::size_t const N = wide_batch<T>::lanes;
+		wide::random<N> & Random = wide_rand_thread_state<N>();
+
+		std::size_t i = 0;
+		for(; i + N <= count; i += N)
+			Generate(Random, out + i * Components);
+		if(i < count)
+		{
+			T Rest[N * Components];
+			Generate(Random, Rest);
+			for(std::size_t k = 0; k < (count - i) * Components; ++k)
+				out[i * Components + k] = Rest[k];
+		}
+	}
+}//namespace detail
+
+namespace wide
+{
+	template <std::size_t N>
+	GLM_FUNC_QUALIFIER void seed(random<N> & r, uint64 Seed)
+	{
+		detail::rand_state State;
+		State.Seeds = 0u;
+		detail::rand_seed(State, Seed);
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			for(std::size_t k = 0; k < 4; ++k)
+				r.s[k][i] = detail::rand_next(State);
+			r.s[3][i] |= 1u;
+		}
+	}
+
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER scalar<T, N> uniform(random<N> & r)
+	{
+		return detail::compute_wide_uniform<T, N>::call(r);
+	}
+
+	// z uniform in [-1, 1] gives equal areas (Archimedes), the angle around
+	// it uniform too
+	template <typename T, std::size_t N>
+	GLM_FUNC_QUALIFIER vec3<T, N> spherical(random<N> & r)
+	{
+		typedef scalar<T, N> lane;
+
+		lane const One(static_cast<T>(1));
+		lane const z = uniform<T>(r) * lane(static_cast<T>(2)) - One;
+		lane const a = uniform<T>(r) - lane(static_cast<T>(0.5));
+		lane Sin, Cos;
+		detail::wide_sincos_turns(a, Sin, Cos);
+		lane const Ring = sqrt(max(One - z * z, lane(static_cast<T>(0))));
+		return vec3<T, N>(Ring * Cos, Ring * Sin, z);
+	}
+}//namespace wide
+
+	template <typename T>
+	GLM_FUNC_QUALIFIER void linearRands(T * out, std::size_t count, T Min, T Max)
+	{
+		detail::wide_rand_linear<T, detail::wide_batch<T>::lanes> Generate;
+		Generate.Min = Min;
+		Generate.Range = Max - Min;
+		detail::batch_rand<1>(out, count, Generate);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void linearRands(tvec3<T, P> * out, std::size_t count, tvec3<T, P> const & Min, tvec3<T, P> const & Max)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'linearRands' requires tightly packed tvec3");
+
+		detail::wide_rand_linear3<T, detail::wide_batch<T>::lanes> Generate;
+		Generate.Min = tvec3<T, defaultp>(Min);
+		Generate.Range = tvec3<T, defaultp>(Max - Min);
+		detail::batch_rand<3>(&out[0].x, count, Generate);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void linearRands(tvec4<T, P> * out, std::size_t count, tvec4<T, P> const & Min, tvec4<T, P> const & Max)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec4<T, P>) == 4 * sizeof(T), "'linearRands' requires tightly packed tvec4");
+
+		detail::wide_rand_linear4<T, detail::wide_batch<T>::lanes> Generate;
+		Generate.Min = tvec4<T, defaultp>(Min);
+		Generate.Range = tvec4<T, defaultp>(Max - Min);
+		detail::batch_rand<4>(&out[0].x, count, Generate);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER void sphericalRands(tvec3<T, P> * out, std::size_t count, T Radius)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<T, P>) == 3 * sizeof(T), "'sphericalRands' requires tightly packed tvec3");
+
+		detail::wide_rand_spherical<T, detail::wide_batch<T>::lanes> Generate;
+		Generate.Radius = Radius;
+		detail::batch_rand<3>(&out[0].x, count, Generate);
+	}
+}//namespace glm
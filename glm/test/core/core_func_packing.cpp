@@ -33,6 +33,9 @@
 #include <glm/gtc/epsilon.hpp>
 #include <glm/vector_relational.hpp>
 #include <glm/packing.hpp>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <vector>
 
 int test_packUnorm2x16()
@@ -165,6 +168,99 @@ int test_packDouble2x32()
 	return Error;
 }
 
+namespace half
+{
+	float as_float(glm::uint32 i)
+	{
+		float f;
+		std::memcpy(&f, &i, sizeof(f));
+		return f;
+	}
+
+	glm::uint32 as_uint(float f)
+	{
+		glm::uint32 i;
+		std::memcpy(&i, &f, sizeof(i));
+		return i;
+	}
+
+	// toFloat16 and toFloat32 give the bits of the soft conversions, F16C or ARM FP16 included.
+	int test()
+	{
+		int Error = 0;
+
+		// every half, the NaNs keep their payloads
+		for(glm::uint32 i = 0; i < 0x10000; ++i)
+		{
+			glm::detail::hdata const h = static_cast<glm::detail::hdata>(i);
+			Error += as_uint(glm::detail::toFloat32(h)) == as_uint(glm::detail::toFloat32_soft(h)) ? 0 : 1;
+		}
+
+		// every half as a float, the ties between it and the next, and the floats around them
+		std::vector<float> Floats;
+		for(glm::uint32 i = 0; i < 0x10000; ++i)
+		{
+			glm::uint32 const Bits = as_uint(glm::detail::toFloat32_soft(static_cast<glm::detail::hdata>(i)));
+			glm::uint32 const Tie = as_uint((glm::detail::toFloat32_soft(static_cast<glm::detail::hdata>(i)) +
+				glm::detail::toFloat32_soft(static_cast<glm::detail::hdata>(i + 1))) * 0.5f);
+			glm::uint32 const Values[] = {Bits, Bits - 1, Bits + 1, Tie, Tie - 1, Tie + 1};
+			for(std::size_t j = 0; j < sizeof(Values) / sizeof(Values[0]); ++j)
+				Floats.push_back(as_float(Values[j]));
+		}
+		// random bit patterns, and the NaNs whose payloads are below the bits of a half
+		glm::uint32 State = 0x12345678;
+		for(std::size_t i = 0; i < (1 << 20); ++i)
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+			Floats.push_back(as_float(State));
+		}
+		Floats.push_back(as_float(0x7f800001));
+		Floats.push_back(as_float(0xff801fff));
+		Floats.push_back(as_float(0x7fc00000));
+
+		for(std::size_t i = 0; i < Floats.size(); ++i)
+			Error += glm::detail::toFloat16(Floats[i]) == glm::detail::toFloat16_soft(Floats[i]) ? 0 : 1;
+
+		return Error;
+	}
+
+	int perf()
+	{
+		std::size_t const Count = 1 << 24;
+		std::vector<float> Floats(Count);
+		std::vector<glm::detail::hdata> Halfs(Count);
+		glm::uint32 State = 0x12345678;
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+			Floats[i] = static_cast<float>(static_cast<int>(State)) / static_cast<float>(1 << 17);
+		}
+
+		std::clock_t const Time0 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			Halfs[i] = glm::detail::toFloat16_soft(Floats[i]);
+		std::clock_t const Time1 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			Halfs[i] = glm::detail::toFloat16(Floats[i]);
+		std::clock_t const Time2 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			Floats[i] = glm::detail::toFloat32_soft(Halfs[i]);
+		std::clock_t const Time3 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			Floats[i] = glm::detail::toFloat32(Halfs[i]);
+		std::clock_t const Time4 = std::clock();
+
+		std::printf("toFloat16: soft %d clocks, %d clocks\n", static_cast<int>(Time1 - Time0), static_cast<int>(Time2 - Time1));
+		std::printf("toFloat32: soft %d clocks, %d clocks\n", static_cast<int>(Time3 - Time2), static_cast<int>(Time4 - Time3));
+
+		return 0;
+	}
+}//namespace half
+
 int main()
 {
 	int Error = 0;
@@ -175,6 +271,11 @@ int main()
 	Error += test_packUnorm2x16();
 	Error += test_packHalf2x16();
 	Error += test_packDouble2x32();
+	Error += half::test();
+
+#	ifdef NDEBUG
+		Error += half::perf();
+#	endif//NDEBUG
 
 	return Error;
 }
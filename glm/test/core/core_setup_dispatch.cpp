@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref test
+/// @file test/core/core_setup_dispatch.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/gtx/wide.hpp>
+#include <cstdio>
+#include <vector>
+
+// The kernels of the run-time dispatch against the functions they stand for,
+// on the CPUs which have them, whatever GLM_ARCH says.
+int test_features()
+{
+	int Error(0);
+
+	int const Features = glm::detail::dispatch_features();
+	Error += glm::detail::dispatch_features() == Features ? 0 : 1;
+
+#	if !GLM_HAS_DISPATCH
+		Error += Features == glm::detail::DISPATCH_NONE ? 0 : 1;
+#	elif (GLM_ARCH & GLM_ARCH_AVX2) && defined(__FMA__) && defined(__F16C__)
+		// this runs, so the CPU has them
+		Error += (Features & glm::detail::DISPATCH_AVX2) ? 0 : 1;
+#	endif
+
+	std::printf("dispatch: AVX2 %s, BMI2 %s\n",
+		(Features & glm::detail::DISPATCH_AVX2) ? "yes" : "no",
+		(Features & glm::detail::DISPATCH_BMI2) ? "yes" : "no");
+
+	return Error;
+}
+
+int test_packing()
+{
+	int Error(0);
+
+#	if GLM_HAS_DISPATCH
+	if(!(glm::detail::dispatch_features() & glm::detail::DISPATCH_AVX2))
+		return Error;
+
+	// every half, and floats around the rounding cases of the halfs
+	std::size_t const Count = 1 << 16;
+	std::vector<glm::uint16> Halfs(Count);
+	std::vector<float> Floats(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		Halfs[i] = static_cast<glm::uint16>(i);
+		glm::uint32 const Bits = (static_cast<glm::uint32>(i) << 16) | (static_cast<glm::uint32>(i * 0x9e37) & 0xffff);
+		Floats[i] = glm::uintBitsToFloat(Bits);
+	}
+
+	std::vector<float> Unpacked(Count);
+	std::size_t const Unpacks = glm::detail::unpackHalf_avx2(&Halfs[0], &Unpacked[0], Count);
+	Error += Unpacks == Count ? 0 : 1;
+	for(std::size_t i = 0; i < Unpacks; ++i)
+	{
+		float const Expected = glm::unpackHalf1x16(Halfs[i]);
+		bool const NaN = Expected != Expected;
+		Error += (NaN ? Unpacked[i] != Unpacked[i] : glm::floatBitsToUint(Unpacked[i]) == glm::floatBitsToUint(Expected)) ? 0 : 1;
+	}
+
+	std::vector<glm::uint16> Packed(Count);
+	std::size_t const Packs = glm::detail::packHalf_avx2(&Floats[0], &Packed[0], Count);
+	Error += Packs == Count ? 0 : 1;
+	for(std::size_t i = 0; i < Packs; ++i)
+		Error += Packed[i] == glm::packHalf1x16(Floats[i]) ? 0 : 1;
+#	endif//GLM_HAS_DISPATCH
+
+	return Error;
+}
+
+template <typename T>
+int test_matrix()
+{
+	int Error(0);
+
+#	if GLM_HAS_DISPATCH
+	if(!(glm::detail::dispatch_features() & glm::detail::DISPATCH_AVX2))
+		return Error;
+
+	std::size_t const Count = 64;
+	std::vector<glm::tmat4x4<T, glm::highp> > A(Count), B(Count), Out(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+		for(glm::length_t c = 0; c < 4; ++c)
+			for(glm::length_t r = 0; r < 4; ++r)
+			{
+				A[i][c][r] = static_cast<T>((i * 7 + c * 5 + r * 3) % 17) / static_cast<T>(8) - static_cast<T>(1);
+				B[i][c][r] = static_cast<T>((i * 3 + c * 11 + r * 13) % 19) / static_cast<T>(9) - static_cast<T>(1);
+			}
+
+	glm::detail::batch_mat4_avx(&A[0], &B[0], &Out[0], Count, false);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::tmat4x4<T, glm::highp> const Expected = A[i] * B[i];
+		for(glm::length_t c = 0; c < 4; ++c)
+			Error += glm::all(glm::epsilonEqual(Out[i][c], Expected[c], static_cast<T>(1e-5))) ? 0 : 1;
+	}
+#	endif//GLM_HAS_DISPATCH
+
+	return Error;
+}
+
+int main()
+{
+	int Error(0);
+
+	Error += test_features();
+	Error += test_packing();
+	Error += test_matrix<float>();
+	Error += test_matrix<double>();
+
+	return Error;
+}
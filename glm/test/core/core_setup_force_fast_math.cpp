@@ -0,0 +1,247 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref test
+/// @file test/core/core_setup_force_fast_math.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#define GLM_FORCE_FAST_MATH
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+#include <vector>
+
+// Distance from x to the exact value, in units in the last place of the
+// floats around the exact value
+double ulps(float x, double Exact)
+{
+	int Exponent = 0;
+	std::frexp(Exact, &Exponent);
+	if(Exponent < -125)
+		Exponent = -125; // the denormals
+	return std::fabs(static_cast<double>(x) - Exact) / std::ldexp(1.0, Exponent - 24);
+}
+
+bool same(float a, float b)
+{
+	return a == b || (a != a && b != b);
+}
+
+struct sine
+{
+	static char const * name() {return "sin";}
+	static float single(float x) {return glm::sin(glm::vec1(x)).x;}
+	static glm::vec4 vector(glm::vec4 const & x) {return glm::sin(x);}
+	static double exact(double x) {return std::sin(x);}
+	static float standard(float x) {return std::sin(x);}
+};
+
+struct cosine
+{
+	static char const * name() {return "cos";}
+	static float single(float x) {return glm::cos(glm::vec1(x)).x;}
+	static glm::vec4 vector(glm::vec4 const & x) {return glm::cos(x);}
+	static double exact(double x) {return std::cos(x);}
+	static float standard(float x) {return std::cos(x);}
+};
+
+struct exponential
+{
+	static char const * name() {return "exp";}
+	static float single(float x) {return glm::exp(glm::vec1(x)).x;}
+	static glm::vec4 vector(glm::vec4 const & x) {return glm::exp(x);}
+	static double exact(double x) {return std::exp(x);}
+	static float standard(float x) {return std::exp(x);}
+};
+
+struct inverse_sqrt
+{
+	static char const * name() {return "inversesqrt";}
+	static float single(float x) {return glm::inversesqrt(x);}
+	static glm::vec4 vector(glm::vec4 const & x) {return glm::inversesqrt(x);}
+	static double exact(double x) {return 1.0 / std::sqrt(x);}
+	static float standard(float x) {return 1.f / std::sqrt(x);}
+};
+
+// The worst error over values spread from Min to Max, which must be within
+// Bound ULP, and the lanes of the vec4 which must be the values of one component
+template <typename func>
+int test_bound(float Min, float Max, double Bound)
+{
+	int Error = 0;
+
+	int const Count = 1 << 20;
+	double Worst = 0.0;
+	float WorstValue = 0.f;
+	for(int i = 0; i < Count; i += 4)
+	{
+		glm::vec4 x;
+		for(int j = 0; j < 4; ++j)
+			x[j] = static_cast<float>(Min + (static_cast<double>(Max) - Min) * (i + j) / (Count - 1));
+
+		glm::vec4 const Result = func::vector(x);
+		for(int j = 0; j < 4; ++j)
+		{
+			Error += same(func::single(x[j]), Result[j]) ? 0 : 1;
+
+			double const Distance = ulps(Result[j], func::exact(x[j]));
+			if(Distance > Worst)
+			{
+				Worst = Distance;
+				WorstValue = x[j];
+			}
+		}
+	}
+
+	std::printf("%s over [%g, %g]: %.2f ULP at %.8g\n", func::name(), Min, Max, Worst, WorstValue);
+	Error += Worst <= Bound ? 0 : 1;
+
+	return Error;
+}
+
+int test_special()
+{
+	int Error = 0;
+
+	float const Infinity = std::numeric_limits<float>::infinity();
+	float const NaN = std::numeric_limits<float>::quiet_NaN();
+
+	// Beyond the reduction, and not a number
+	glm::vec4 const Large(1e10f, -9000.f, 0.f, NaN);
+	glm::vec4 const Sin = glm::sin(Large);
+	glm::vec4 const Cos = glm::cos(Large);
+	Error += Sin.x == std::sin(1e10f) && Sin.y == std::sin(-9000.f) && Sin.z == 0.f && Sin.w != Sin.w ? 0 : 1;
+	Error += Cos.x == std::cos(1e10f) && Cos.y == std::cos(-9000.f) && Cos.z == 1.f && Cos.w != Cos.w ? 0 : 1;
+	Error += glm::isnan(glm::sin(glm::vec1(Infinity))).x ? 0 : 1;
+
+	// Overflow and underflow as std::exp
+	glm::vec4 const Exp = glm::exp(glm::vec4(0.f, 100.f, -200.f, NaN));
+	Error += Exp.x == 1.f && Exp.y == Infinity && Exp.z == 0.f && Exp.w != Exp.w ? 0 : 1;
+	glm::vec2 const Infinities = glm::exp(glm::vec2(-Infinity, Infinity));
+	Error += Infinities.x == 0.f && Infinities.y == Infinity ? 0 : 1;
+	Error += ulps(glm::exp(glm::vec1(88.7f)).x, std::exp(static_cast<double>(88.7f))) <= 2.0 ? 0 : 1;
+	float const Denormal = glm::exp(glm::vec1(-100.f)).x;
+	Error += std::fabs(Denormal - std::exp(-100.0)) <= 2.0 * std::numeric_limits<float>::denorm_min() ? 0 : 1;
+
+	glm::vec4 const InverseSqrt = glm::inversesqrt(glm::vec4(0.f, Infinity, 4.f, -1.f));
+	Error += InverseSqrt.x == Infinity && InverseSqrt.y == 0.f && InverseSqrt.w != InverseSqrt.w ? 0 : 1;
+	Error += ulps(InverseSqrt.z, 0.5) <= 5.0 ? 0 : 1;
+	Error += ulps(glm::inversesqrt(1e-30f), 1.0 / std::sqrt(static_cast<double>(1e-30f))) <= 5.0 ? 0 : 1;
+	Error += ulps(glm::inversesqrt(1e30f), 1.0 / std::sqrt(static_cast<double>(1e30f))) <= 5.0 ? 0 : 1;
+
+	glm::vec4 const Normal4 = glm::normalize(glm::vec4(3.f, 0.f, -4.f, 0.f));
+	glm::vec3 const Normal3 = glm::normalize(glm::vec3(0.f, -3.f, 4.f));
+	glm::vec2 const Normal2 = glm::normalize(glm::vec2(1e-10f, 1e-10f));
+	Error += glm::all(glm::epsilonEqual(Normal4, glm::vec4(0.6f, 0.f, -0.8f, 0.f), 1e-6f)) ? 0 : 1;
+	Error += glm::all(glm::epsilonEqual(Normal3, glm::vec3(0.f, -0.6f, 0.8f), 1e-6f)) ? 0 : 1;
+	Error += glm::all(glm::epsilonEqual(Normal2, glm::vec2(0.70710678f), 1e-6f)) ? 0 : 1;
+
+	// The other types keep the standard library
+	glm::dvec4 const Double = glm::sin(glm::dvec4(1.0, 2.0, 3.0, 4.0));
+	Error += glm::sin(0.5) == std::sin(0.5) && Double.w == std::sin(4.0) ? 0 : 1;
+	Error += glm::exp(0.5) == std::exp(0.5) && glm::inversesqrt(2.0) == 1.0 / std::sqrt(2.0) ? 0 : 1;
+
+	return Error;
+}
+
+// The smaller vectors share the register code of vec4, the scalars keep the
+// standard library but inversesqrt
+int test_vectors()
+{
+	int Error = 0;
+
+	glm::vec3 const x(-1.5f, 0.25f, 100.f);
+	glm::vec2 const y(3.f, 1e20f);
+	glm::vec4 const x4(x, 0.f);
+	glm::vec4 const y4(y, 0.f, 0.f);
+	Error += glm::all(glm::equal(glm::sin(x), glm::vec3(glm::sin(x4)))) ? 0 : 1;
+	Error += glm::all(glm::equal(glm::cos(x), glm::vec3(glm::cos(x4)))) ? 0 : 1;
+	Error += glm::all(glm::equal(glm::exp(x), glm::vec3(glm::exp(x4)))) ? 0 : 1;
+	Error += glm::all(glm::equal(glm::sin(y), glm::vec2(glm::sin(y4)))) ? 0 : 1;
+	Error += glm::all(glm::equal(glm::inversesqrt(y), glm::vec2(glm::inversesqrt(y.x), glm::inversesqrt(y.y)))) ? 0 : 1;
+	Error += glm::sin(2.f) == std::sin(2.f) && glm::exp(2.f) == std::exp(2.f) ? 0 : 1;
+#	if GLM_FAST_MATH
+		Error += glm::all(glm::equal(glm::inversesqrt(glm::lowp_vec4(4.f)), glm::lowp_vec4(glm::inversesqrt(4.f)))) ? 0 : 1;
+#	endif//GLM_FAST_MATH
+
+	return Error;
+}
+
+template <typename func>
+int perf(float Min, float Max)
+{
+	std::size_t const Count = 1 << 18;
+	std::vector<glm::vec4> In(Count), Out(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+		for(int j = 0; j < 4; ++j)
+			In[i][j] = Min + (Max - Min) * static_cast<float>(i * 4 + j) / static_cast<float>(Count * 4);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = func::vector(In[i]);
+	std::clock_t FastTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		for(int j = 0; j < 4; ++j)
+			Out[i][j] = func::standard(In[i][j]);
+	std::clock_t ExactTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		for(int j = 0; j < 4; ++j)
+			Out[i][j] = func::single(In[i][j]);
+	std::clock_t ScalarTime = std::clock();
+
+	std::printf("%s: vec4 %d clocks, std %d clocks, vec1 %d clocks\n", func::name(),
+		static_cast<int>(FastTime - StartTime), static_cast<int>(ExactTime - FastTime), static_cast<int>(ScalarTime - ExactTime));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_bound<sine>(-6.28318531f, 6.28318531f, 2.0);
+	Error += test_bound<sine>(-8192.f, 8192.f, 3.0);
+	Error += test_bound<cosine>(-6.28318531f, 6.28318531f, 2.0);
+	Error += test_bound<cosine>(-8192.f, 8192.f, 3.0);
+	Error += test_bound<exponential>(-87.f, 88.7f, 2.0);
+	Error += test_bound<exponential>(-1.f, 1.f, 2.0);
+	Error += test_bound<inverse_sqrt>(0.25f, 4.f, 5.0);
+	Error += test_bound<inverse_sqrt>(1e-37f, 1e37f, 5.0);
+	Error += test_special();
+	Error += test_vectors();
+
+#	ifdef NDEBUG
+		Error += perf<sine>(-10.f, 10.f);
+		Error += perf<exponential>(-10.f, 10.f);
+		Error += perf<inverse_sqrt>(0.1f, 100.f);
+#	endif//NDEBUG
+
+	return Error;
+}
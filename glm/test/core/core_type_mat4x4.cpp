@@ -274,6 +274,31 @@ int perf_mul()
 	return Error;
 }
 
+#if GLM_HAS_CONSTEXPR_CXX14
+	constexpr glm::mat4 constexpr_mat4()
+	{
+		glm::mat4 m(2.0f);
+		m[3] = glm::vec4(1, 2, 3, 1);
+		return m * glm::mat4(0.5f);
+	}
+#endif//GLM_HAS_CONSTEXPR_CXX14
+
+// The constructors and operators evaluated by the compiler
+int test_constexpr()
+{
+	int Error = 0;
+
+#	if GLM_HAS_CONSTEXPR_CXX14
+		constexpr glm::mat4 M = constexpr_mat4();
+		constexpr glm::vec4 P = M * glm::vec4(1);
+		static_assert(M[0][0] == 1.0f && M[3][2] == 1.5f, "mat4 is not constexpr");
+		static_assert(P.x == 1.5f && P.y == 2.0f && P.z == 2.5f && P.w == 0.5f, "mat4 * vec4 is not constexpr");
+		Error += M * glm::vec4(1) == P ? 0 : 1;
+#	endif//GLM_HAS_CONSTEXPR_CXX14
+
+	return Error;
+}
+
 int main()
 {
 	int Error = 0;
@@ -283,6 +308,7 @@ int main()
 	Error += test_inverse_mat4x4();
 	Error += test_operators();
 	Error += test_inverse();
+	Error += test_constexpr();
 
 	Error += perf_mul();
 
@@ -32,11 +32,16 @@
 //#define GLM_FORCE_AVX2
 #define GLM_SWIZZLE
 #include <glm/vector_relational.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/gtc/epsilon.hpp>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <limits>
 #include <vector>
 
 template <int Value>
@@ -442,6 +447,227 @@ int test_vec4_perf_SoA(std::size_t Size)
 	return Error;
 }
 
+namespace simd
+{
+	// xorshift, so the runs are reproducible
+	glm::uint32 random(glm::uint32 & State)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return State;
+	}
+
+	template <typename T>
+	T value(glm::uint32 & State)
+	{
+		return static_cast<T>(static_cast<int>(random(State) % 20001) - 10000) / static_cast<T>(97);
+	}
+
+	template <typename T, glm::precision P>
+	glm::tvec4<T, P> vec(glm::uint32 & State)
+	{
+		T const x = value<T>(State);
+		T const y = value<T>(State);
+		T const z = value<T>(State);
+		T const w = value<T>(State);
+		return glm::tvec4<T, P>(x, y, z, w);
+	}
+
+	template <typename T>
+	bool same(T a, T b)
+	{
+		return std::memcmp(&a, &b, sizeof(T)) == 0;
+	}
+
+	template <typename T, glm::precision P>
+	bool same(glm::tvec4<T, P> const & a, T x, T y, T z, T w)
+	{
+		return same(a.x, x) && same(a.y, y) && same(a.z, z) && same(a.w, w);
+	}
+
+	// The operators of the SIMD paths round each component as the scalar code does
+	template <typename T, glm::precision P>
+	int test_operators()
+	{
+		int Error = 0;
+
+		glm::uint32 State = 0x12345678;
+		for(std::size_t i = 0; i < 1000; ++i)
+		{
+			glm::tvec4<T, P> const A = vec<T, P>(State);
+			glm::tvec4<T, P> const B = vec<T, P>(State);
+			T const s = value<T>(State) + static_cast<T>(1000);
+
+			Error += same(A + B, A.x + B.x, A.y + B.y, A.z + B.z, A.w + B.w) ? 0 : 1;
+			Error += same(A - B, A.x - B.x, A.y - B.y, A.z - B.z, A.w - B.w) ? 0 : 1;
+			Error += same(A * B, A.x * B.x, A.y * B.y, A.z * B.z, A.w * B.w) ? 0 : 1;
+			Error += same(A / s, A.x / s, A.y / s, A.z / s, A.w / s) ? 0 : 1;
+			Error += same(s / A, s / A.x, s / A.y, s / A.z, s / A.w) ? 0 : 1;
+			Error += same(s * A, s * A.x, s * A.y, s * A.z, s * A.w) ? 0 : 1;
+			Error += same(A - s, A.x - s, A.y - s, A.z - s, A.w - s) ? 0 : 1;
+			Error += same(-A, -A.x, -A.y, -A.z, -A.w) ? 0 : 1;
+
+			glm::tvec4<T, P> C(A);
+			C += B;
+			C *= s;
+			C -= A;
+			C /= B;
+			Error += same(C, ((A.x + B.x) * s - A.x) / B.x, ((A.y + B.y) * s - A.y) / B.y, ((A.z + B.z) * s - A.z) / B.z, ((A.w + B.w) * s - A.w) / B.w) ? 0 : 1;
+
+			Error += A == A && !(A != A) ? 0 : 1;
+			Error += A != B && !(A == B) ? 0 : 1;
+			Error += glm::tvec4<T, P>(A.x, A.y, A.z, B.w) != A ? 0 : 1;
+		}
+
+		return Error;
+	}
+
+	// highp gives the results of the scalar code, lowp and mediump may use FMA
+	template <typename T, glm::precision P>
+	int test_dot_mix()
+	{
+		int Error = 0;
+
+		T const Epsilon = std::numeric_limits<T>::epsilon() * static_cast<T>(64);
+		glm::uint32 State = 0x9abcdef0;
+		for(std::size_t i = 0; i < 1000; ++i)
+		{
+			glm::tvec4<T, P> const A = vec<T, P>(State);
+			glm::tvec4<T, P> const B = vec<T, P>(State);
+			glm::tvec4<T, P> const C = vec<T, P>(State) / static_cast<T>(100);
+			T const a = C.x;
+
+			T const Dot = (A.x * B.x + A.y * B.y) + (A.z * B.z + A.w * B.w);
+			T const Scale = glm::abs(A.x * B.x) + glm::abs(A.y * B.y) + glm::abs(A.z * B.z) + glm::abs(A.w * B.w);
+			glm::tvec4<T, P> const MixVec(A.x + C.x * (B.x - A.x), A.y + C.y * (B.y - A.y), A.z + C.z * (B.z - A.z), A.w + C.w * (B.w - A.w));
+			glm::tvec4<T, P> const MixScalar(A.x + a * (B.x - A.x), A.y + a * (B.y - A.y), A.z + a * (B.z - A.z), A.w + a * (B.w - A.w));
+
+			if(P == glm::highp)
+			{
+				Error += same(glm::dot(A, B), Dot) ? 0 : 1;
+				Error += glm::mix(A, B, C) == MixVec ? 0 : 1;
+				Error += glm::mix(A, B, a) == MixScalar ? 0 : 1;
+			}
+			else
+			{
+				Error += glm::abs(glm::dot(A, B) - Dot) <= Scale * Epsilon ? 0 : 1;
+				Error += glm::all(glm::epsilonEqual(glm::mix(A, B, C), MixVec, Epsilon * static_cast<T>(1000))) ? 0 : 1;
+				Error += glm::all(glm::epsilonEqual(glm::mix(A, B, a), MixScalar, Epsilon * static_cast<T>(1000))) ? 0 : 1;
+			}
+		}
+
+		return Error;
+	}
+
+	template <typename T, glm::precision P>
+	int test_int64()
+	{
+		int Error = 0;
+
+		glm::tvec4<T, P> const A(T(1) << 40, T(3), T(0) - T(1), T(7) << 50);
+		glm::tvec4<T, P> const B(T(5), T(1) << 33, T(2), T(9));
+		Error += (A + B) == glm::tvec4<T, P>(A.x + B.x, A.y + B.y, A.z + B.z, A.w + B.w) ? 0 : 1;
+		Error += (A - B) == glm::tvec4<T, P>(A.x - B.x, A.y - B.y, A.z - B.z, A.w - B.w) ? 0 : 1;
+		Error += (A & B) == glm::tvec4<T, P>(A.x & B.x, A.y & B.y, A.z & B.z, A.w & B.w) ? 0 : 1;
+		Error += (A | B) == glm::tvec4<T, P>(A.x | B.x, A.y | B.y, A.z | B.z, A.w | B.w) ? 0 : 1;
+		Error += (A ^ B) == glm::tvec4<T, P>(A.x ^ B.x, A.y ^ B.y, A.z ^ B.z, A.w ^ B.w) ? 0 : 1;
+		Error += A != B ? 0 : 1;
+		Error += glm::tvec4<T, P>(A.x, A.y, A.z, B.w) != A ? 0 : 1;
+
+		glm::tvec4<T, P> C(A);
+		C += B;
+		C -= A;
+		Error += C == B ? 0 : 1;
+
+		return Error;
+	}
+
+	int test()
+	{
+		int Error = 0;
+
+		Error += test_operators<float, glm::lowp>();
+		Error += test_operators<float, glm::mediump>();
+		Error += test_operators<float, glm::highp>();
+		Error += test_operators<double, glm::mediump>();
+		Error += test_operators<double, glm::highp>();
+		Error += test_dot_mix<float, glm::mediump>();
+		Error += test_dot_mix<float, glm::highp>();
+		Error += test_dot_mix<double, glm::mediump>();
+		Error += test_dot_mix<double, glm::highp>();
+		Error += test_int64<glm::int64, glm::highp>();
+		Error += test_int64<glm::uint64, glm::mediump>();
+
+		return Error;
+	}
+
+	// Transforms a point cloud with the operators, mix and dot, Count times
+	// over, small enough to stay in the cache
+	template <typename T, glm::precision P>
+	int perf(char const * Name, std::size_t Count)
+	{
+		std::size_t const Size = 4096;
+		glm::uint32 State = 0x0badf00d;
+		std::vector<glm::tvec4<T, P> > In(Size);
+		for(std::size_t i = 0; i < Size; ++i)
+			In[i] = vec<T, P>(State);
+		glm::tvec4<T, P> const Row(static_cast<T>(0.5), static_cast<T>(0.25), static_cast<T>(-1), static_cast<T>(1));
+		glm::tvec4<T, P> const Offset(static_cast<T>(1), static_cast<T>(2), static_cast<T>(3), static_cast<T>(0));
+
+		std::vector<T> Out(Size);
+
+		std::clock_t StartTime = std::clock();
+		for(std::size_t j = 0; j < Count; ++j)
+		for(std::size_t i = 0; i < Size; ++i)
+		{
+			glm::tvec4<T, P> const v = In[i] * static_cast<T>(2) + Offset;
+			Out[i] += glm::dot(glm::mix(v, Row, static_cast<T>(0.25)), Row);
+		}
+		std::clock_t EndTime = std::clock();
+
+		T Sum(0);
+		for(std::size_t i = 0; i < Size; ++i)
+			Sum += Out[i];
+
+		std::printf("%s: %d clocks (%f)\n", Name, static_cast<int>(EndTime - StartTime), static_cast<double>(Sum));
+
+		return 0;
+	}
+}//namespace simd
+
+#if GLM_HAS_CONSTEXPR_CXX14
+	constexpr glm::vec4 constexpr_vec4()
+	{
+		glm::vec4 v(1, 2, 3, 4);
+		v += glm::vec4(1);
+		v *= 2.0f;
+		v[3] = -v.x;
+		return v - glm::vec4(glm::vec2(1, 0), glm::vec2(0, 1));
+	}
+#endif//GLM_HAS_CONSTEXPR_CXX14
+
+// The constructors and operators evaluated by the compiler
+int test_vec4_constexpr()
+{
+	int Error = 0;
+
+#	if GLM_HAS_CONSTEXPR_CXX14
+		constexpr glm::vec4 A = constexpr_vec4();
+		static_assert(A.x == 3.0f && A.y == 6.0f && A.z == 8.0f && A.w == -5.0f, "vec4 is not constexpr");
+		Error += A == glm::vec4(3, 6, 8, -5) ? 0 : 1;
+
+		constexpr glm::ivec2 B = glm::ivec2(7, 3) / 2 + glm::ivec2(1);
+		static_assert(B.x == 4 && B.y == 2, "ivec2 is not constexpr");
+
+		constexpr glm::vec3 C[] = {glm::vec3(-1, -1, 1), glm::vec3(1, -1, 1), -glm::vec3(1, -1, 1)};
+		static_assert(C[2][0] == -1.0f && C[2][1] == 1.0f, "vec3 is not constexpr");
+		Error += C[2] == glm::vec3(-1, 1, -1) ? 0 : 1;
+#	endif//GLM_HAS_CONSTEXPR_CXX14
+
+	return Error;
+}
+
 int main()
 {
 	int Error(0);
@@ -451,6 +677,10 @@ int main()
 #	ifdef NDEBUG
 		Error += test_vec4_perf_AoS(Size);
 		Error += test_vec4_perf_SoA(Size);
+		Error += simd::perf<float, glm::highp>("vec4", 4096);
+		Error += simd::perf<float, glm::mediump>("mediump_vec4", 4096);
+		Error += simd::perf<double, glm::highp>("dvec4", 4096);
+		Error += simd::perf<double, glm::mediump>("mediump_dvec4", 4096);
 #	endif//NDEBUG
 
 	Error += test_vec4_ctor();
@@ -458,6 +688,8 @@ int main()
 	Error += test_vec4_operators();
 	Error += test_vec4_swizzle_partial();
 	Error += test_operator_increment();
+	Error += simd::test();
+	Error += test_vec4_constexpr();
 
 	return Error;
 }
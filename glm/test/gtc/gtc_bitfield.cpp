@@ -654,6 +654,167 @@ namespace bitfieldInterleave
 	}
 }//namespace bitfieldInterleave
 
+namespace bitfieldInterleaveBatch
+{
+	// xorshift, so the runs are reproducible
+	glm::uint32 random(glm::uint32 & State)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return State;
+	}
+
+	// Count random vectors, with all bits of the components set, where the batch functions
+	// only use the low Bits of them. Count is not a multiple of a register, so the tail runs.
+	template <typename T>
+	std::vector<glm::tvec3<T, glm::defaultp> > vectors(std::size_t Count)
+	{
+		std::vector<glm::tvec3<T, glm::defaultp> > Result(Count);
+		glm::uint32 State = 0x12345678;
+		for(std::size_t i = 0; i < Count; ++i)
+			Result[i] = glm::tvec3<T, glm::defaultp>(
+				static_cast<T>(random(State)), static_cast<T>(random(State)), static_cast<T>(random(State)));
+		Result[0] = glm::tvec3<T, glm::defaultp>(0);
+		Result[1] = glm::tvec3<T, glm::defaultp>(static_cast<T>(~T(0)));
+		return Result;
+	}
+
+	// The components which bitfieldInterleave keeps, as the batch functions do
+	template <typename T>
+	glm::tvec3<T, glm::defaultp> masked(glm::tvec3<T, glm::defaultp> const & v, glm::uint32 Bits)
+	{
+		T const Mask = static_cast<T>((glm::uint64(1) << Bits) - 1);
+		return glm::tvec3<T, glm::defaultp>(
+			static_cast<T>(v.x & Mask), static_cast<T>(v.y & Mask), static_cast<T>(v.z & Mask));
+	}
+
+	// The codes of the batch function, and of the kernels of this CPU, against the scalar
+	// function and the bitwise reference, and the components they decode back to.
+	template <typename T, typename C>
+	int test_type(glm::uint32 Bits)
+	{
+		int Error(0);
+
+		std::size_t const Count = 1003;
+		std::vector<glm::tvec3<T, glm::defaultp> > const In = vectors<T>(Count);
+		std::vector<C> Codes(Count);
+		glm::bitfieldInterleave(&In[0], &Codes[0], Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::tvec3<T, glm::defaultp> const v = masked(In[i], Bits);
+			Error += Codes[i] == glm::bitfieldInterleave(v.x, v.y, v.z) ? 0 : 1;
+			Error += Codes[i] == bitfieldInterleave3::refBitfieldInterleave<T, C>(v.x, v.y, v.z) ? 0 : 1;
+		}
+
+		std::vector<glm::tvec3<T, glm::defaultp> > Out(Count);
+		glm::bitfieldDeinterleave(&Codes[0], &Out[0], Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += glm::all(glm::equal(Out[i], masked(In[i], Bits))) ? 0 : 1;
+
+		// any code decodes as the scalar code does, which drops the bits over 3 * Bits
+		std::vector<C> Random(Count);
+		glm::uint32 State = 0x9e3779b9;
+		for(std::size_t i = 0; i < Count; ++i)
+			Random[i] = static_cast<C>((glm::uint64(random(State)) << 32) | random(State));
+		std::vector<glm::tvec3<T, glm::defaultp> > Expected(Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::uint64 const Code = Random[i];
+			Expected[i] = glm::tvec3<T, glm::defaultp>(
+				static_cast<T>(glm::detail::bitfieldCompact3(Code)),
+				static_cast<T>(glm::detail::bitfieldCompact3(Code >> 1)),
+				static_cast<T>(glm::detail::bitfieldCompact3(Code >> 2)));
+			Expected[i] = masked(Expected[i], Bits);
+		}
+		glm::bitfieldDeinterleave(&Random[0], &Out[0], Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += glm::all(glm::equal(Out[i], Expected[i])) ? 0 : 1;
+
+#		if GLM_HAS_DISPATCH
+		{
+			// both kernels, whichever the dispatch picks, where the CPU has them
+			T const * const Components = &In[0].x;
+			int const Features = glm::detail::dispatch_features();
+			bool const BMI2 = (Features & glm::detail::DISPATCH_BMI2) != 0;
+			bool const AVX2 = (Features & glm::detail::DISPATCH_AVX2) != 0;
+
+			std::vector<C> Kernel(Count);
+			std::vector<glm::tvec3<T, glm::defaultp> > Decoded(Count);
+			if(BMI2)
+			{
+				std::size_t const Done = glm::detail::bitfieldInterleave_bmi2(Components, &Kernel[0], Count);
+				Error += Done == Count ? 0 : 1;
+				for(std::size_t i = 0; i < Done; ++i)
+					Error += Kernel[i] == Codes[i] ? 0 : 1;
+				glm::detail::bitfieldDeinterleave_bmi2(&Random[0], &Decoded[0].x, Count);
+				for(std::size_t i = 0; i < Count; ++i)
+					Error += glm::all(glm::equal(Decoded[i], Expected[i])) ? 0 : 1;
+			}
+			if(AVX2)
+			{
+				std::size_t const Done = glm::detail::bitfieldInterleave_avx2(Components, &Kernel[0], Count);
+				Error += Done > Count - 16 ? 0 : 1;
+				for(std::size_t i = 0; i < Done; ++i)
+					Error += Kernel[i] == Codes[i] ? 0 : 1;
+				std::size_t const Decodes = glm::detail::bitfieldDeinterleave_avx2(&Random[0], &Decoded[0].x, Count);
+				for(std::size_t i = 0; i < Decodes; ++i)
+					Error += glm::all(glm::equal(Decoded[i], Expected[i])) ? 0 : 1;
+			}
+		}
+#		endif//GLM_HAS_DISPATCH
+
+		return Error;
+	}
+
+	int test()
+	{
+		int Error(0);
+
+		Error += test_type<glm::uint8, glm::uint32>(8);
+		Error += test_type<glm::uint16, glm::uint64>(16);
+		Error += test_type<glm::uint32, glm::uint64>(21);
+
+		return Error;
+	}
+
+	template <typename T, typename C>
+	void perf_type(char const * Name, std::size_t Count)
+	{
+		std::vector<glm::tvec3<T, glm::defaultp> > const In = vectors<T>(Count);
+		std::vector<glm::tvec3<T, glm::defaultp> > Out(Count);
+		std::vector<C> Codes(Count);
+
+		std::clock_t const Time0 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			Codes[i] = glm::bitfieldInterleave(In[i].x, In[i].y, In[i].z);
+		std::clock_t const Time1 = std::clock();
+		glm::bitfieldInterleave(&In[0], &Codes[0], Count);
+		std::clock_t const Time2 = std::clock();
+		glm::bitfieldDeinterleave(&Codes[0], &Out[0], Count);
+		std::clock_t const Time3 = std::clock();
+
+		std::printf("bitfieldInterleave %s: scalar %d clocks, batch %d clocks, batch decode %d clocks\n", Name,
+			static_cast<int>(Time1 - Time0), static_cast<int>(Time2 - Time1), static_cast<int>(Time3 - Time2));
+	}
+
+	int perf()
+	{
+#		if GLM_HAS_DISPATCH
+			int const Features = glm::detail::dispatch_features();
+			std::printf("bitfieldInterleave batch kernel: %s\n",
+				(Features & glm::detail::DISPATCH_BMI2) ? "BMI2" : (Features & glm::detail::DISPATCH_AVX2) ? "AVX2" : "scalar");
+#		endif
+
+		std::size_t const Count = 1 << 22;
+		perf_type<glm::uint8, glm::uint32>("u8vec3", Count);
+		perf_type<glm::uint16, glm::uint64>("u16vec3", Count);
+		perf_type<glm::uint32, glm::uint64>("u32vec3", Count);
+
+		return 0;
+	}
+}//namespace bitfieldInterleaveBatch
+
 int main()
 {
 	int Error(0);
@@ -662,11 +823,13 @@ int main()
 	Error += ::bitfieldInterleave3::test();
 	Error += ::bitfieldInterleave4::test();
 	Error += ::bitfieldInterleave::test();
+	Error += ::bitfieldInterleaveBatch::test();
 	//Error += ::bitRevert::test();
 
 #	ifdef NDEBUG
 		Error += ::mask::perf();
 		Error += ::bitfieldInterleave::perf();
+		Error += ::bitfieldInterleaveBatch::perf();
 #	endif//NDEBUG
 
 	return Error;
@@ -30,10 +30,39 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/epsilon.hpp>
+
+// affineInverse must agree with inverse with scales, not only rotations
+int test_affine()
+{
+	int Error = 0;
+
+	glm::mat4 const M = glm::scale(glm::rotate(glm::translate(glm::mat4(1), glm::vec3(4, -5, 6)), 0.7f, glm::vec3(1, 2, 3)), glm::vec3(2, 0.5f, 3));
+	glm::mat4 const A = glm::affineInverse(M);
+	glm::mat4 const I = glm::inverse(M);
+	for(glm::length_t i = 0; i < 4; ++i)
+		Error += glm::all(glm::epsilonEqual(A[i], I[i], 0.0001f)) ? 0 : 1;
+
+	glm::mat3 const M3(glm::vec3(0.6f, 1.6f, 0), glm::vec3(-2.4f, 0.9f, 0), glm::vec3(7, -3, 1));
+	glm::mat3 const A3 = glm::affineInverse(M3);
+	glm::mat3 const I3 = glm::inverse(M3);
+	for(glm::length_t i = 0; i < 3; ++i)
+		Error += glm::all(glm::epsilonEqual(A3[i], I3[i], 0.0001f)) ? 0 : 1;
+
+	glm::dmat4 const D = glm::scale(glm::rotate(glm::translate(glm::dmat4(1), glm::dvec3(4, -5, 6)), 0.7, glm::dvec3(1, 2, 3)), glm::dvec3(2, 0.5, 3));
+	glm::dmat4 const Identity = glm::affineInverse(D) * D;
+	for(glm::length_t i = 0; i < 4; ++i)
+		Error += glm::all(glm::epsilonEqual(Identity[i], glm::dmat4(1)[i], 1e-12)) ? 0 : 1;
+
+	return Error;
+}
 
 int main()
 {
 	int Error = 0;
 
+	Error += test_affine();
+
 	return Error;
 }
@@ -72,6 +72,28 @@ int test_translate()
 	return Error;
 }
 
+// A fixed model, view and projection built by the compiler
+int test_constexpr()
+{
+	int Error = 0;
+
+#	if GLM_HAS_CONSTEXPR_CXX14
+		constexpr glm::mat4 View = glm::translate(glm::mat4(1), glm::vec3(0, 0, -4));
+		constexpr glm::mat4 Model = glm::scale(glm::mat4(1), glm::vec3(2));
+		constexpr glm::mat4 Ortho = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.5f, 4.5f);
+		constexpr glm::mat4 Frustum = glm::frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 3.0f);
+		constexpr glm::vec4 P = View * Model * glm::vec4(1);
+		static_assert(P.x == 2.0f && P.z == -2.0f && P.w == 1.0f, "translate and scale are not constexpr");
+		static_assert(Ortho[2][2] == -0.5f && Ortho[3][2] == -1.25f, "ortho is not constexpr");
+		static_assert(Frustum[2][2] == -2.0f && Frustum[3][2] == -3.0f, "frustum is not constexpr");
+
+		Error += View == glm::translate(glm::mat4(1), glm::vec3(0, 0, -4)) ? 0 : 1;
+		Error += Frustum == glm::frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 3.0f) ? 0 : 1;
+#	endif//GLM_HAS_CONSTEXPR_CXX14
+
+	return Error;
+}
+
 int main()
 {
 	int Error = 0;
@@ -80,6 +102,7 @@ int main()
 	Error += test_tweakedInfinitePerspective();
 	Error += test_pick();
 	Error += test_perspective();
+	Error += test_constexpr();
 
 	return Error;
 }
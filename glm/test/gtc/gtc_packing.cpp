@@ -32,6 +32,9 @@
 #include <glm/gtc/packing.hpp>
 #include <glm/gtc/epsilon.hpp>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <limits>
 #include <vector>
 
 void print_bits(float const & s)
@@ -501,6 +504,178 @@ int test_packSnorm4x8()
 	return Error;
 }
 
+namespace batch
+{
+	// xorshift, so the runs are reproducible
+	glm::uint32 random(glm::uint32 & State)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return State;
+	}
+
+	float as_float(glm::uint32 i)
+	{
+		float f;
+		std::memcpy(&f, &i, sizeof(f));
+		return f;
+	}
+
+	glm::uint32 as_uint(float f)
+	{
+		glm::uint32 i;
+		std::memcpy(&i, &f, sizeof(i));
+		return i;
+	}
+
+	// Random bit patterns, covering every exponent, and the edge cases of the conversions.
+	// The count is not a multiple of any SIMD width, so the scalar tail runs as well.
+	std::vector<float> floats()
+	{
+		float const Special[] =
+		{
+			0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 65504.f, 65520.f, 65536.f, 1e-5f, 6.1e-5f, 5.96e-8f, 2.98e-8f,
+			std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+			as_float(0x7fc00000), as_float(0x7f800001), as_float(0xff801000), as_float(0x7f802000),
+			1.0f / 510.f, 3.0f / 510.f, 0.99f, 1.5f, -0.5f
+		};
+
+		std::vector<float> Result(Special, Special + sizeof(Special) / sizeof(Special[0]));
+		glm::uint32 State = 0x12345678;
+		while(Result.size() < 4099)
+			Result.push_back(as_float(random(State)));
+		// and many values in the range of halfs, unorms and snorms
+		for(std::size_t i = 0; i < 4096; ++i)
+			Result.push_back(as_float((random(State) & 0x807fffff) | ((100 + random(State) % 48) << 23)));
+		return Result;
+	}
+
+	int test_half()
+	{
+		int Error = 0;
+
+		std::vector<float> const A = floats();
+		std::vector<glm::uint16> B(A.size());
+		glm::packHalf(&A[0], &B[0], A.size());
+		for(std::size_t i = 0; i < A.size(); ++i)
+			Error += B[i] == glm::packHalf1x16(A[i]) ? 0 : 1;
+		assert(!Error);
+
+		std::vector<glm::uint16> C(65536 + 3);
+		for(std::size_t i = 0; i < C.size(); ++i)
+			C[i] = static_cast<glm::uint16>(i);
+		std::vector<float> D(C.size());
+		glm::unpackHalf(&C[0], &D[0], C.size());
+		for(std::size_t i = 0; i < C.size(); ++i)
+		{
+			float const E = glm::unpackHalf1x16(C[i]);
+			// F16C may quiet signaling NaNs
+			Error += glm::isnan(E) ? (glm::isnan(D[i]) ? 0 : 1) : (as_uint(D[i]) == as_uint(E) ? 0 : 1);
+		}
+		assert(!Error);
+
+		return Error;
+	}
+
+	int test_unorm8()
+	{
+		int Error = 0;
+
+		std::vector<float> const A = floats();
+		std::vector<glm::uint8> B(A.size());
+		glm::packUnorm8(&A[0], &B[0], A.size());
+		for(std::size_t i = 0; i < A.size(); ++i)
+			Error += glm::isnan(A[i]) || B[i] == glm::packUnorm1x8(A[i]) ? 0 : 1;
+		assert(!Error);
+
+		std::vector<glm::uint8> C(256 + 7);
+		for(std::size_t i = 0; i < C.size(); ++i)
+			C[i] = static_cast<glm::uint8>(i);
+		std::vector<float> D(C.size());
+		glm::unpackUnorm8(&C[0], &D[0], C.size());
+		for(std::size_t i = 0; i < C.size(); ++i)
+			Error += as_uint(D[i]) == as_uint(glm::unpackUnorm1x8(C[i])) ? 0 : 1;
+		assert(!Error);
+
+		return Error;
+	}
+
+	int test_Snorm3x10_1x2()
+	{
+		int Error = 0;
+
+		std::vector<float> const F = floats();
+		std::vector<glm::vec4> A;
+		for(std::size_t i = 0; i + 4 <= F.size(); i += 4)
+			if(!glm::isnan(F[i]) && !glm::isnan(F[i + 1]) && !glm::isnan(F[i + 2]) && !glm::isnan(F[i + 3]))
+				A.push_back(glm::vec4(F[i], F[i + 1], F[i + 2], F[i + 3]));
+		A.resize(A.size() / 4 * 4 + 3);
+
+		std::vector<glm::uint32> B(A.size());
+		glm::packSnorm3x10_1x2(&A[0], &B[0], A.size());
+		for(std::size_t i = 0; i < A.size(); ++i)
+			Error += B[i] == glm::packSnorm3x10_1x2(A[i]) ? 0 : 1;
+		assert(!Error);
+
+		glm::uint32 State = 0x9abcdef0;
+		std::vector<glm::uint32> C(1027);
+		for(std::size_t i = 0; i < C.size(); ++i)
+			C[i] = random(State);
+		std::vector<glm::vec4> D(C.size());
+		glm::unpackSnorm3x10_1x2(&C[0], &D[0], C.size());
+		for(std::size_t i = 0; i < C.size(); ++i)
+		{
+			glm::vec4 const E = glm::unpackSnorm3x10_1x2(C[i]);
+			for(glm::length_t j = 0; j < 4; ++j)
+				Error += as_uint(D[i][j]) == as_uint(E[j]) ? 0 : 1;
+		}
+		assert(!Error);
+
+		return Error;
+	}
+
+	// Throughput of the batch functions compared to calling the scalar ones in a loop.
+	int perf()
+	{
+		std::size_t const Count = 1 << 22;
+
+		std::vector<float> A(Count);
+		std::vector<glm::uint16> H(Count);
+		std::vector<glm::uint8> U(Count);
+		glm::uint32 State = 0x2468ace0;
+		for(std::size_t i = 0; i < Count; ++i)
+			A[i] = static_cast<float>(random(State) % 2048) / 1024.f - 0.5f;
+
+		std::clock_t Timestamp0 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			H[i] = glm::packHalf1x16(A[i]);
+		std::clock_t Timestamp1 = std::clock();
+		glm::packHalf(&A[0], &H[0], Count);
+		std::clock_t Timestamp2 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			A[i] = glm::unpackHalf1x16(H[i]);
+		std::clock_t Timestamp3 = std::clock();
+		glm::unpackHalf(&H[0], &A[0], Count);
+		std::clock_t Timestamp4 = std::clock();
+		for(std::size_t i = 0; i < Count; ++i)
+			U[i] = glm::packUnorm1x8(A[i]);
+		std::clock_t Timestamp5 = std::clock();
+		glm::packUnorm8(&A[0], &U[0], Count);
+		std::clock_t Timestamp6 = std::clock();
+
+		printf("packHalf[scalar]: %d\n", static_cast<unsigned int>(Timestamp1 - Timestamp0));
+		printf("packHalf[batch]: %d\n", static_cast<unsigned int>(Timestamp2 - Timestamp1));
+		printf("unpackHalf[scalar]: %d\n", static_cast<unsigned int>(Timestamp3 - Timestamp2));
+		printf("unpackHalf[batch]: %d\n", static_cast<unsigned int>(Timestamp4 - Timestamp3));
+		printf("packUnorm8[scalar]: %d\n", static_cast<unsigned int>(Timestamp5 - Timestamp4));
+		printf("packUnorm8[batch]: %d\n", static_cast<unsigned int>(Timestamp6 - Timestamp5));
+
+		// keep the results alive
+		return H[Count / 2] == 0xffff && U[Count / 2] == 0xff && A[0] > 2.f ? 1 : 0;
+	}
+}//namespace batch
+
 int main()
 {
 	int Error(0);
@@ -529,5 +704,13 @@ int main()
 	Error += test_Half1x16();
 	Error += test_U3x10_1x2();
 
+	Error += batch::test_half();
+	Error += batch::test_unorm8();
+	Error += batch::test_Snorm3x10_1x2();
+
+#	ifdef NDEBUG
+		Error += batch::perf();
+#	endif//NDEBUG
+
 	return Error;
 }
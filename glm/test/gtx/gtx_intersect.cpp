@@ -31,9 +31,38 @@
 
 #include <glm/gtx/intersect.hpp>
 
+int test_intersectRayBox()
+{
+	int Error(0);
+
+	glm::vec3 const Min(-1.f, -1.f, -1.f);
+	glm::vec3 const Max(1.f, 2.f, 1.f);
+	float Distance(0.f);
+
+	// Entering the face z = -1, 3 units away
+	Error += glm::intersectRayBox(glm::vec3(0.5f, 0.f, -4.f), 1.f / glm::vec3(0.f, 0.f, 1.f), Min, Max, Distance) ? 0 : 1;
+	Error += Distance == 3.f ? 0 : 1;
+
+	// Starting inside
+	Error += glm::intersectRayBox(glm::vec3(0.f), 1.f / glm::vec3(1.f, 1.f, 0.5f), Min, Max, Distance) ? 0 : 1;
+	Error += Distance == 0.f ? 0 : 1;
+
+	// Pointing away, and passing beside
+	Error += !glm::intersectRayBox(glm::vec3(0.f, 0.f, -4.f), 1.f / glm::vec3(0.f, 0.f, -1.f), Min, Max, Distance) ? 0 : 1;
+	Error += !glm::intersectRayBox(glm::vec3(0.f, 0.f, -4.f), 1.f / glm::vec3(1.f, 0.f, 1.f), Min, Max, Distance) ? 0 : 1;
+
+	// Starting on a face and leaving through the edge x = 1, y = 2
+	Error += glm::intersectRayBox(glm::vec3(-1.f, 0.f, 0.f), 1.f / glm::vec3(2.f, 2.f, 0.f), Min, Max, Distance) ? 0 : 1;
+	Error += Distance == 0.f ? 0 : 1;
+
+	return Error;
+}
+
 int main()
 {
 	int Error(0);
 
+	Error += test_intersectRayBox();
+
 	return Error;
 }
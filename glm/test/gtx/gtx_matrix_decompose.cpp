@@ -30,10 +30,203 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/gtc/constants.hpp>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+// xorshift, so the runs are reproducible
+glm::uint32 random(glm::uint32 & State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+template <typename T>
+T value(glm::uint32 & State)
+{
+	return static_cast<T>(static_cast<int>(random(State) % 2001) - 1000) / static_cast<T>(1000);
+}
+
+// Scales, rotations and translations, some mirroring, some of the rotations
+// half turns whose quaternions have no w to divide by
+template <typename T>
+void transforms(std::size_t Count, glm::uint32 Seed,
+	std::vector<glm::tvec3<T, glm::highp> > & Scale, std::vector<glm::tquat<T, glm::highp> > & Orientation, std::vector<glm::tvec3<T, glm::highp> > & Translation)
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	glm::uint32 State = Seed;
+	Scale.resize(Count);
+	Orientation.resize(Count);
+	Translation.resize(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		vec3 const Axis(value<T>(State), value<T>(State), value<T>(State) + static_cast<T>(1.5));
+		T const Angle = i % 4 == 3 ? glm::pi<T>() : value<T>(State) * glm::pi<T>();
+		Scale[i] = vec3(value<T>(State), value<T>(State), value<T>(State)) * static_cast<T>(2) + vec3(static_cast<T>(2.5));
+		if(i % 5 == 1)
+			Scale[i].x = -Scale[i].x;
+		Orientation[i] = glm::angleAxis(Angle, glm::normalize(Axis));
+		Translation[i] = vec3(value<T>(State), value<T>(State), value<T>(State)) * static_cast<T>(100);
+	}
+}
+
+template <typename T>
+bool sameRotation(glm::tquat<T, glm::highp> const & a, glm::tquat<T, glm::highp> const & b, T Epsilon)
+{
+	return glm::abs(glm::abs(glm::dot(a, b)) - static_cast<T>(1)) < Epsilon;
+}
+
+template <typename T>
+bool sameMatrix(glm::tmat4x4<T, glm::highp> const & a, glm::tmat4x4<T, glm::highp> const & b, T Epsilon)
+{
+	for(glm::length_t i = 0; i < 4; ++i)
+	if(!glm::all(glm::epsilonEqual(a[i], b[i], Epsilon)))
+		return false;
+	return true;
+}
+
+template <typename T>
+int test_trs(T Epsilon)
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+	typedef glm::tquat<T, glm::highp> quat;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+	int Error(0);
+
+	std::vector<vec3> Scale, Translation;
+	std::vector<quat> Orientation;
+	transforms<T>(64, 0x12345678, Scale, Orientation, Translation);
+	for(std::size_t i = 0; i < Scale.size(); ++i)
+	{
+		mat4 const Model = glm::translate(mat4(static_cast<T>(1)), Translation[i]) * glm::mat4_cast(Orientation[i]) * glm::scale(mat4(static_cast<T>(1)), Scale[i]);
+		Error += sameMatrix(glm::recomposeTRS(Scale[i], Orientation[i], Translation[i]), Model, Epsilon * static_cast<T>(100)) ? 0 : 1;
+
+		vec3 S, T3;
+		quat Q;
+		Error += glm::decomposeTRS(Model, S, Q, T3) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(S, Scale[i], Epsilon)) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(T3, Translation[i], Epsilon * static_cast<T>(100))) ? 0 : 1;
+		Error += sameRotation(Q, Orientation[i], Epsilon) ? 0 : 1;
+	}
+
+	// a singular matrix is left alone
+	vec3 S(static_cast<T>(7)), T3(static_cast<T>(7));
+	quat Q;
+	Error += glm::decomposeTRS(glm::scale(mat4(static_cast<T>(1)), vec3(static_cast<T>(1), static_cast<T>(0), static_cast<T>(1))), S, Q, T3) ? 1 : 0;
+	Error += S == vec3(static_cast<T>(7)) && T3 == vec3(static_cast<T>(7)) ? 0 : 1;
+
+	return Error;
+}
+
+template <typename T>
+int test_batch(T Epsilon)
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+	typedef glm::tquat<T, glm::highp> quat;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+	int Error(0);
+
+	std::vector<vec3> Scale, Translation;
+	std::vector<quat> Orientation;
+	transforms<T>(37, 0x23456789, Scale, Orientation, Translation);
+
+	// every count, so the tail goes through every path
+	for(std::size_t Count = 1; Count <= Scale.size(); ++Count)
+	{
+		std::vector<mat4> Model(Count);
+		glm::recomposeTRS(&Scale[0], &Orientation[0], &Translation[0], &Model[0], Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += sameMatrix(Model[i], glm::recomposeTRS(Scale[i], Orientation[i], Translation[i]), Epsilon * static_cast<T>(100)) ? 0 : 1;
+
+		std::vector<vec3> S(Count), T3(Count);
+		std::vector<quat> Q(Count);
+		Error += glm::decomposeTRS(&Model[0], &S[0], &Q[0], &T3[0], Count) ? 0 : 1;
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			Error += glm::all(glm::epsilonEqual(S[i], Scale[i], Epsilon)) ? 0 : 1;
+			Error += glm::all(glm::epsilonEqual(T3[i], Translation[i], Epsilon * static_cast<T>(100))) ? 0 : 1;
+			Error += sameRotation(Q[i], Orientation[i], Epsilon) ? 0 : 1;
+		}
+	}
+
+	// a singular matrix among others fails alone
+	std::vector<mat4> Model(Scale.size());
+	glm::recomposeTRS(&Scale[0], &Orientation[0], &Translation[0], &Model[0], Model.size());
+	Model[5] = mat4(static_cast<T>(0));
+	std::vector<vec3> S(Model.size(), vec3(static_cast<T>(7))), T3(Model.size());
+	std::vector<quat> Q(Model.size());
+	Error += glm::decomposeTRS(&Model[0], &S[0], &Q[0], &T3[0], Model.size()) ? 1 : 0;
+	for(std::size_t i = 0; i < Model.size(); ++i)
+		Error += i == 5 ? (S[i] == vec3(static_cast<T>(7)) ? 0 : 1) : (sameRotation(Q[i], Orientation[i], Epsilon) ? 0 : 1);
+
+	return Error;
+}
+
+#ifdef NDEBUG
+template <typename T>
+int perf(char const * Name)
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+	typedef glm::tvec4<T, glm::highp> vec4;
+	typedef glm::tquat<T, glm::highp> quat;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+
+	// the nodes of an imported scene
+	std::size_t const Count = 1 << 16;
+	std::size_t const Repeat = 1 << 4;
+	std::vector<vec3> Scale, Translation, Skew(Count);
+	std::vector<vec4> Perspective(Count);
+	std::vector<quat> Orientation;
+	transforms<T>(Count, 0x3456789a, Scale, Orientation, Translation);
+	std::vector<mat4> Model(Count);
+	glm::recomposeTRS(&Scale[0], &Orientation[0], &Translation[0], &Model[0], Count);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+		glm::decompose(Model[i], Scale[i], Orientation[i], Translation[i], Skew[i], Perspective[i]);
+	std::clock_t DecomposeTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+		glm::decomposeTRS(Model[i], Scale[i], Orientation[i], Translation[i]);
+	std::clock_t ScalarTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+		glm::decomposeTRS(&Model[0], &Scale[0], &Orientation[0], &Translation[0], Count);
+	std::clock_t BatchTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+		Model[i] = glm::recomposeTRS(Scale[i], Orientation[i], Translation[i]);
+	std::clock_t RecomposeTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+		glm::recomposeTRS(&Scale[0], &Orientation[0], &Translation[0], &Model[0], Count);
+	std::clock_t BatchRecomposeTime = std::clock();
+
+	std::printf("%s: decompose %d clocks, decomposeTRS %d, batch %d clocks; recomposeTRS %d, batch %d clocks\n", Name,
+		static_cast<int>(DecomposeTime - StartTime), static_cast<int>(ScalarTime - DecomposeTime), static_cast<int>(BatchTime - ScalarTime),
+		static_cast<int>(RecomposeTime - BatchTime), static_cast<int>(BatchRecomposeTime - RecomposeTime));
+
+	return 0;
+}
+#endif//NDEBUG
 
 int main()
 {
 	int Error(0);
 
+	Error += test_trs<float>(1e-4f);
+	Error += test_trs<double>(1e-9);
+	Error += test_batch<float>(1e-4f);
+	Error += test_batch<double>(1e-9);
+
+#	ifdef NDEBUG
+		Error += perf<float>("float");
+		Error += perf<double>("double");
+#	endif//NDEBUG
+
 	return Error;
 }
@@ -33,6 +33,10 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/gtx/spline.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <cstdio>
+#include <ctime>
+#include <vector>
 
 namespace catmullRom
 {
@@ -118,6 +122,211 @@ namespace cubic
 	}
 }//catmullRom
 
+namespace batch
+{
+	// xorshift, so the runs are reproducible
+	glm::uint32 random(glm::uint32 & State)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return State;
+	}
+
+	template <typename T>
+	T value(glm::uint32 & State)
+	{
+		return static_cast<T>(static_cast<int>(random(State) % 2001) - 1000) / static_cast<T>(100);
+	}
+
+	template <typename vec>
+	std::vector<vec> points(std::size_t Count, glm::uint32 Seed)
+	{
+		typedef typename vec::value_type T;
+		glm::uint32 State = Seed;
+		std::vector<vec> Result(Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		for(glm::length_t j = 0; j < Result[i].length(); ++j)
+			Result[i][j] = value<T>(State);
+		return Result;
+	}
+
+	template <typename vec>
+	int near(vec const & a, vec const & b)
+	{
+		typedef typename vec::value_type T;
+		T const Epsilon = static_cast<T>(sizeof(T) == 4 ? 1e-3 : 1e-9);
+		return glm::all(glm::epsilonEqual(a, b, Epsilon)) ? 0 : 1;
+	}
+
+	// Every count up to a few times the widest batch, so the tails of all
+	// lengths are covered, against the scalar functions
+	template <typename vec>
+	int test_splines()
+	{
+		typedef typename vec::value_type T;
+		int Error(0);
+
+		std::size_t const Max = 37;
+		std::vector<vec> const A = points<vec>(Max, 0x12345678);
+		std::vector<vec> const B = points<vec>(Max, 0x23456789);
+		std::vector<vec> const C = points<vec>(Max, 0x3456789a);
+		std::vector<vec> const D = points<vec>(Max, 0x456789ab);
+		std::vector<T> S(Max);
+		for(std::size_t i = 0; i < Max; ++i)
+			S[i] = static_cast<T>(i) / static_cast<T>(Max - 1);
+
+		for(std::size_t Count = 1; Count <= Max; ++Count)
+		{
+			std::vector<vec> Out(Count);
+			glm::catmullRomSplines(&A[0], &B[0], &C[0], &D[0], &S[0], &Out[0], Count);
+			for(std::size_t i = 0; i < Count; ++i)
+				Error += near(Out[i], glm::catmullRom(A[i], B[i], C[i], D[i], S[i]));
+			glm::hermiteSplines(&A[0], &B[0], &C[0], &D[0], &S[0], &Out[0], Count);
+			for(std::size_t i = 0; i < Count; ++i)
+				Error += near(Out[i], glm::hermite(A[i], B[i], C[i], D[i], S[i]));
+			glm::cubicSplines(&A[0], &B[0], &C[0], &D[0], &S[0], &Out[0], Count);
+			for(std::size_t i = 0; i < Count; ++i)
+				Error += near(Out[i], glm::cubic(A[i], B[i], C[i], D[i], S[i]));
+		}
+
+		// in place
+		std::vector<vec> InPlace(A);
+		glm::catmullRomSplines(&InPlace[0], &B[0], &C[0], &D[0], &S[0], &InPlace[0], Max);
+		for(std::size_t i = 0; i < Max; ++i)
+			Error += near(InPlace[i], glm::catmullRom(A[i], B[i], C[i], D[i], S[i]));
+
+		return Error;
+	}
+
+	template <typename vec>
+	int test_path()
+	{
+		typedef typename vec::value_type T;
+		int Error(0);
+
+		std::size_t const Count = 8;
+		std::vector<vec> const P = points<vec>(Count, 0x56789abc);
+		std::size_t const Samples = 29;
+		std::vector<T> S(Samples);
+		std::vector<vec> Out(Samples);
+		for(std::size_t i = 0; i < Samples; ++i)
+			S[i] = static_cast<T>(i) * static_cast<T>(Count + 1) / static_cast<T>(Samples - 1) - static_cast<T>(1);
+		glm::catmullRomPath(&P[0], Count, &S[0], &Out[0], Samples);
+		for(std::size_t i = 0; i < Samples; ++i)
+		{
+			T const s = glm::clamp(S[i], static_cast<T>(0), static_cast<T>(Count - 1));
+			std::size_t k = static_cast<std::size_t>(s);
+			if(k > Count - 2)
+				k = Count - 2;
+			vec const Expected = glm::catmullRom(P[k > 0 ? k - 1 : 0], P[k], P[k + 1], P[k + 2 < Count ? k + 2 : Count - 1], s - static_cast<T>(k));
+			Error += near(Out[i], Expected);
+		}
+		// through its points
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			T const s = static_cast<T>(i);
+			vec Point;
+			glm::catmullRomPath(&P[0], Count, &s, &Point, 1);
+			Error += near(Point, P[i]);
+		}
+		// a single point
+		T const Half = static_cast<T>(0.5);
+		vec Single;
+		glm::catmullRomPath(&P[0], 1, &Half, &Single, 1);
+		Error += near(Single, P[0]);
+
+		return Error;
+	}
+
+	template <typename T>
+	int test_arc_length()
+	{
+		typedef glm::tvec3<T, glm::highp> vec3;
+		int Error(0);
+
+		// evenly spaced points on a line: the path is the line, its
+		// length that of the line and the parameters follow the distances
+		std::size_t const Count = 5;
+		std::vector<vec3> Line(Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Line[i] = vec3(static_cast<T>(i) * static_cast<T>(2), static_cast<T>(0), static_cast<T>(0));
+		std::size_t const Samples = 100;
+		std::vector<T> Lengths(Samples + 1);
+		glm::arcLengthTable(&Line[0], Count, &Lengths[0], Samples);
+		Error += glm::epsilonEqual(Lengths[Samples], static_cast<T>(8), static_cast<T>(1e-4)) ? 0 : 1;
+		T const Distances[4] = { static_cast<T>(-1), static_cast<T>(2), static_cast<T>(5), static_cast<T>(9) };
+		T const Expected[4] = { static_cast<T>(0), static_cast<T>(1), static_cast<T>(2.5), static_cast<T>(4) };
+		T S[4];
+		glm::arcLengthParameters(&Lengths[0], Samples, Count, Distances, S, 4);
+		for(std::size_t i = 0; i < 4; ++i)
+			Error += glm::epsilonEqual(S[i], Expected[i], static_cast<T>(1e-3)) ? 0 : 1;
+
+		// on a smooth curve, even distances give points evenly apart: a
+		// helix, whose chords are as long as their arcs nearly
+		std::vector<vec3> P(6);
+		for(std::size_t i = 0; i < P.size(); ++i)
+		{
+			T const a = static_cast<T>(i) * static_cast<T>(0.5);
+			P[i] = vec3(glm::cos(a) * static_cast<T>(10), static_cast<T>(i), glm::sin(a) * static_cast<T>(10));
+		}
+		glm::arcLengthTable(&P[0], P.size(), &Lengths[0], Samples);
+		std::size_t const Steps = 16;
+		std::vector<T> Even(Steps + 1), Params(Steps + 1);
+		for(std::size_t i = 0; i <= Steps; ++i)
+			Even[i] = Lengths[Samples] * static_cast<T>(i) / static_cast<T>(Steps);
+		glm::arcLengthParameters(&Lengths[0], Samples, P.size(), &Even[0], &Params[0], Steps + 1);
+		std::vector<vec3> Out(Steps + 1);
+		glm::catmullRomPath(&P[0], P.size(), &Params[0], &Out[0], Steps + 1);
+		T const Step = Lengths[Samples] / static_cast<T>(Steps);
+		for(std::size_t i = 0; i < Steps; ++i)
+			Error += glm::distance(Out[i], Out[i + 1]) <= Step * static_cast<T>(1.001) && glm::distance(Out[i], Out[i + 1]) >= Step * static_cast<T>(0.99) ? 0 : 1;
+		Error += Params[0] == static_cast<T>(0) && glm::epsilonEqual(Params[Steps], static_cast<T>(5), static_cast<T>(1e-3)) ? 0 : 1;
+
+		return Error;
+	}
+
+	template <typename T>
+	int perf(char const * Name)
+	{
+		typedef glm::tvec3<T, glm::highp> vec3;
+
+		// the particle trails of a frame
+		std::size_t const Count = 1 << 14;
+		std::size_t const Repeat = 1 << 7;
+		std::vector<vec3> const A = points<vec3>(Count, 0x12345678);
+		std::vector<vec3> const B = points<vec3>(Count, 0x23456789);
+		std::vector<vec3> const C = points<vec3>(Count, 0x3456789a);
+		std::vector<vec3> const D = points<vec3>(Count, 0x456789ab);
+		std::vector<T> S(Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			S[i] = static_cast<T>(i % 64) / static_cast<T>(64);
+		std::vector<vec3> Out(Count);
+
+		std::clock_t StartTime = std::clock();
+		for(std::size_t j = 0; j < Repeat; ++j)
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = glm::catmullRom(A[i], B[i], C[i], D[i], S[i]);
+		std::clock_t ScalarTime = std::clock();
+		for(std::size_t j = 0; j < Repeat; ++j)
+			glm::catmullRomSplines(&A[0], &B[0], &C[0], &D[0], &S[0], &Out[0], Count);
+		std::clock_t BatchTime = std::clock();
+
+		// a camera path through 64 points
+		std::vector<T> Params(Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Params[i] = static_cast<T>(i) * static_cast<T>(63) / static_cast<T>(Count);
+		for(std::size_t j = 0; j < Repeat; ++j)
+			glm::catmullRomPath(&A[0], 64, &Params[0], &Out[0], Count);
+		std::clock_t PathTime = std::clock();
+
+		std::printf("%s: catmullRom %d clocks, catmullRomSplines %d clocks, catmullRomPath %d clocks\n", Name,
+			static_cast<int>(ScalarTime - StartTime), static_cast<int>(BatchTime - ScalarTime), static_cast<int>(PathTime - BatchTime));
+
+		return 0;
+	}
+}//namespace batch
+
 int main()
 {
 	int Error(0);
@@ -125,6 +334,19 @@ int main()
 	Error += catmullRom::test();
 	Error += hermite::test();
 	Error += cubic::test();
+	Error += batch::test_splines<glm::vec3>();
+	Error += batch::test_splines<glm::vec4>();
+	Error += batch::test_splines<glm::dvec3>();
+	Error += batch::test_splines<glm::dvec4>();
+	Error += batch::test_path<glm::vec3>();
+	Error += batch::test_path<glm::dvec4>();
+	Error += batch::test_arc_length<float>();
+	Error += batch::test_arc_length<double>();
+
+#	ifdef NDEBUG
+		Error += batch::perf<float>("float");
+		Error += batch::perf<double>("double");
+#	endif//NDEBUG
 
 	return Error;
 }
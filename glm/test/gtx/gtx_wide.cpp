@@ -0,0 +1,430 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_wide.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/wide.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+
+// xorshift, so the runs are reproducible
+glm::uint32 random(glm::uint32 & State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+template <typename T>
+T value(glm::uint32 & State)
+{
+	return static_cast<T>(static_cast<int>(random(State) % 2001) - 1000) / static_cast<T>(97);
+}
+
+template <typename T>
+std::vector<glm::tvec3<T, glm::highp> > points(std::size_t Count)
+{
+	glm::uint32 State = 0x12345678;
+	std::vector<glm::tvec3<T, glm::highp> > Result(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		T const x = value<T>(State);
+		T const y = value<T>(State);
+		T const z = value<T>(State) + static_cast<T>(0.5);
+		Result[i] = glm::tvec3<T, glm::highp>(x, y, z);
+	}
+	return Result;
+}
+
+// Each lane against the functions of the core on the same vectors
+template <typename T, std::size_t N>
+int test_lanes()
+{
+	int Error = 0;
+
+	T const Epsilon = std::numeric_limits<T>::epsilon() * static_cast<T>(256);
+	std::vector<glm::tvec3<T, glm::highp> > const A = points<T>(N * 2);
+	std::vector<glm::tvec4<T, glm::highp> > A4(N);
+	for(std::size_t i = 0; i < N; ++i)
+		A4[i] = glm::tvec4<T, glm::highp>(A[i], A[i + N].x);
+
+	glm::wide::vec3<T, N> const a = glm::wide::load<N>(&A[0]);
+	glm::wide::vec3<T, N> const b = glm::wide::load<N>(&A[N]);
+	glm::wide::vec4<T, N> const a4 = glm::wide::load<N>(&A4[0]);
+	glm::tmat4x4<T, glm::highp> const M = glm::translate(glm::rotate(glm::tmat4x4<T, glm::highp>(1), static_cast<T>(0.7), glm::tvec3<T, glm::highp>(1, 2, 3)), glm::tvec3<T, glm::highp>(4, -5, 6));
+
+	glm::wide::scalar<T, N> const Dot = glm::wide::dot(a, b);
+	glm::wide::scalar<T, N> const Length = glm::wide::length(a);
+	glm::wide::scalar<T, N> const Dot4 = glm::wide::dot(a4, a4);
+	glm::wide::vec3<T, N> const Cross = glm::wide::cross(a, b);
+	glm::wide::vec3<T, N> const Normalized = glm::wide::normalize(a);
+	glm::wide::vec3<T, N> const Sum = a + b * glm::wide::scalar<T, N>(2) - a / glm::wide::scalar<T, N>(4);
+	glm::wide::vec3<T, N> const Point = glm::wide::transformPoint(M, a);
+	glm::wide::vec3<T, N> const Vector = glm::wide::transformVector(M, a);
+	glm::wide::vec4<T, N> const Product = M * a4;
+	glm::wide::scalar<T, N> const Min = glm::wide::min(a.x, b.x);
+	glm::wide::scalar<T, N> const Max = glm::wide::max(a.x, b.x);
+	glm::wide::scalar<T, N> const Floor = glm::wide::floor(a.x);
+	glm::wide::scalar<T, N> const Fract = glm::wide::fract(a.y);
+	glm::wide::scalar<T, N> const Step = glm::wide::step(a.x, b.x);
+	glm::wide::scalar<T, N> const Abs = glm::wide::abs(a.x);
+	glm::wide::scalar<T, N> const Flip = glm::wide::flipSign(a.y, b.x);
+	unsigned int const Less = glm::wide::lessThan(a.x, b.x);
+
+	for(std::size_t i = 0; i < N; ++i)
+	{
+		glm::tvec3<T, glm::highp> const u = A[i];
+		glm::tvec3<T, glm::highp> const v = A[i + N];
+
+		Error += glm::all(glm::equal(a.at(i), u)) ? 0 : 1;
+		Error += glm::all(glm::equal(a4.at(i), A4[i])) ? 0 : 1;
+		Error += glm::epsilonEqual(Dot[i], glm::dot(u, v), Epsilon * static_cast<T>(100)) ? 0 : 1;
+		Error += glm::epsilonEqual(Length[i], glm::length(u), Epsilon * static_cast<T>(10)) ? 0 : 1;
+		Error += glm::epsilonEqual(Dot4[i], glm::dot(A4[i], A4[i]), Epsilon * static_cast<T>(100)) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Cross.at(i), glm::cross(u, v), Epsilon * static_cast<T>(100))) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Normalized.at(i), glm::normalize(u), Epsilon)) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Sum.at(i), u + v * static_cast<T>(2) - u / static_cast<T>(4), Epsilon * static_cast<T>(10))) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Point.at(i), glm::tvec3<T, glm::highp>(M * glm::tvec4<T, glm::highp>(u, 1)), Epsilon * static_cast<T>(100))) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Vector.at(i), glm::tvec3<T, glm::highp>(M * glm::tvec4<T, glm::highp>(u, 0)), Epsilon * static_cast<T>(100))) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Product.at(i), M * A4[i], Epsilon * static_cast<T>(100))) ? 0 : 1;
+		Error += Min[i] == glm::min(u.x, v.x) ? 0 : 1;
+		Error += Max[i] == glm::max(u.x, v.x) ? 0 : 1;
+		Error += Floor[i] == glm::floor(u.x) ? 0 : 1;
+		Error += Fract[i] == glm::fract(u.y) ? 0 : 1;
+		Error += Step[i] == (v.x < u.x ? static_cast<T>(0) : static_cast<T>(1)) ? 0 : 1;
+		Error += Abs[i] == glm::abs(u.x) ? 0 : 1;
+		Error += Flip[i] == (v.x < static_cast<T>(0) ? -u.y : u.y) ? 0 : 1;
+		Error += ((Less >> i) & 1u) == (u.x < v.x ? 1u : 0u) ? 0 : 1;
+	}
+
+	std::vector<glm::tvec3<T, glm::highp> > B(N);
+	glm::wide::store(a, &B[0]);
+	std::vector<glm::tvec4<T, glm::highp> > B4(N);
+	glm::wide::store(a4, &B4[0]);
+	for(std::size_t i = 0; i < N; ++i)
+	{
+		Error += glm::all(glm::equal(B[i], A[i])) ? 0 : 1;
+		Error += glm::all(glm::equal(B4[i], A4[i])) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+// Count values of type U in Storage, 32 bytes aligned so the large outputs are streamed
+// Integers, negatives and values out of the int range
+template <typename T, std::size_t N>
+int test_floor()
+{
+	int Error = 0;
+
+	T const Values[] = {
+		static_cast<T>(-1e12), static_cast<T>(-3), static_cast<T>(-2.5), static_cast<T>(-0.5),
+		static_cast<T>(0), static_cast<T>(0.25), static_cast<T>(3), static_cast<T>(16777217.5),
+		static_cast<T>(1e12), static_cast<T>(1e30), static_cast<T>(-1e30), static_cast<T>(2147483647.5)};
+	std::size_t const Count = sizeof(Values) / sizeof(Values[0]);
+
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::wide::scalar<T, N> x(static_cast<T>(0));
+		for(std::size_t j = 0; j < N; ++j)
+			x[j] = Values[(i + j) % Count];
+		glm::wide::scalar<T, N> const Floor = glm::wide::floor(x);
+		for(std::size_t j = 0; j < N; ++j)
+			Error += Floor[j] == glm::floor(x[j]) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+template <typename U>
+U * aligned(std::vector<char> & Storage, std::size_t Count)
+{
+	Storage.resize(Count * sizeof(U) + 32);
+	std::size_t const Address = reinterpret_cast<std::size_t>(&Storage[0]);
+	return reinterpret_cast<U *>(&Storage[0] + ((32 - (Address & 31)) & 31));
+}
+
+template <typename T>
+std::vector<glm::tmat4x4<T, glm::highp> > matrices(std::size_t Count, glm::uint32 Seed)
+{
+	glm::uint32 State = Seed;
+	std::vector<glm::tmat4x4<T, glm::highp> > Result(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::tvec3<T, glm::highp> const Axis(value<T>(State), value<T>(State), static_cast<T>(1));
+		glm::tvec3<T, glm::highp> const Offset(value<T>(State), value<T>(State), value<T>(State));
+		Result[i] = glm::translate(glm::rotate(glm::tmat4x4<T, glm::highp>(1), value<T>(State), Axis), Offset);
+	}
+	return Result;
+}
+
+// Rotations, scales and translations, as in a scene graph
+template <typename T>
+std::vector<glm::tmat4x4<T, glm::highp> > scaled(std::size_t Count)
+{
+	glm::uint32 State = 0x2468ace0;
+	std::vector<glm::tmat4x4<T, glm::highp> > Result = matrices<T>(Count, 0x13579bdf);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		T const x = static_cast<T>(1) + glm::abs(value<T>(State)) / static_cast<T>(4);
+		T const y = static_cast<T>(1) + glm::abs(value<T>(State)) / static_cast<T>(4);
+		T const z = static_cast<T>(1) + glm::abs(value<T>(State)) / static_cast<T>(4);
+		Result[i] = glm::scale(Result[i], glm::tvec3<T, glm::highp>(x, y, z));
+	}
+	return Result;
+}
+
+// The batch functions against the core, with tails and streamed outputs
+template <typename T>
+int test_batch()
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+	typedef glm::tvec4<T, glm::highp> vec4;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+
+	int Error = 0;
+
+	T const Epsilon = std::numeric_limits<T>::epsilon() * static_cast<T>(256 * 100);
+	mat4 const M = glm::translate(glm::rotate(mat4(1), static_cast<T>(0.7), vec3(1, 2, 3)), vec3(4, -5, 6));
+
+	std::size_t const PointCounts[] = {0, 1, 7, 37, (1 << 20) / sizeof(vec3) + 5};
+	for(std::size_t k = 0; k < sizeof(PointCounts) / sizeof(PointCounts[0]); ++k)
+	{
+		std::size_t const Count = PointCounts[k];
+		std::vector<vec3> const In = points<T>(Count + 1);
+		std::vector<char> Storage;
+		vec3 * Out = aligned<vec3>(Storage, Count + 1);
+
+		glm::transformPoints(M, &In[0], Out, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += glm::all(glm::epsilonEqual(Out[i], vec3(M * vec4(In[i], 1)), Epsilon)) ? 0 : 1;
+
+		std::copy(In.begin(), In.end(), Out);
+		glm::transformPoints(M, Out, Out, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += glm::all(glm::epsilonEqual(Out[i], vec3(M * vec4(In[i], 1)), Epsilon)) ? 0 : 1;
+	}
+
+	std::size_t const MatrixCounts[] = {0, 1, 3, (1 << 20) / sizeof(mat4) + 3};
+	for(std::size_t k = 0; k < sizeof(MatrixCounts) / sizeof(MatrixCounts[0]); ++k)
+	{
+		std::size_t const Count = MatrixCounts[k];
+		std::vector<mat4> const A = matrices<T>(Count + 1, 0x12345678);
+		std::vector<mat4> const B = matrices<T>(Count + 1, 0x9abcdef0);
+		std::vector<char> Storage;
+		mat4 * Out = aligned<mat4>(Storage, Count + 1);
+
+		glm::multiplyMatrices(&A[0], &B[0], Out, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		for(glm::length_t c = 0; c < 4; ++c)
+			Error += glm::all(glm::epsilonEqual(Out[i][c], (A[i] * B[i])[c], Epsilon)) ? 0 : 1;
+
+		std::copy(A.begin(), A.end(), Out);
+		glm::multiplyMatrices(Out, &B[0], Out, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		for(glm::length_t c = 0; c < 4; ++c)
+			Error += glm::all(glm::epsilonEqual(Out[i][c], (A[i] * B[i])[c], Epsilon)) ? 0 : 1;
+	}
+
+	std::size_t const InverseCounts[] = {0, 1, 3, 9, (1 << 20) / sizeof(mat4) + 3};
+	for(std::size_t k = 0; k < sizeof(InverseCounts) / sizeof(InverseCounts[0]); ++k)
+	{
+		std::size_t const Count = InverseCounts[k];
+		std::vector<mat4> const A = scaled<T>(Count + 1);
+		std::vector<char> Storage;
+		mat4 * Out = aligned<mat4>(Storage, Count + 1);
+		std::vector<glm::tmat3x3<T, glm::highp> > Normals(Count + 1);
+
+		glm::affineInverses(&A[0], Out, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			mat4 const Inverse = glm::inverse(A[i]);
+			for(glm::length_t c = 0; c < 4; ++c)
+				Error += glm::all(glm::epsilonEqual(Out[i][c], Inverse[c], Epsilon)) ? 0 : 1;
+		}
+
+		std::copy(A.begin(), A.end(), Out);
+		glm::affineInverses(Out, Out, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			mat4 const Inverse = glm::inverse(A[i]);
+			for(glm::length_t c = 0; c < 4; ++c)
+				Error += glm::all(glm::epsilonEqual(Out[i][c], Inverse[c], Epsilon)) ? 0 : 1;
+		}
+
+		glm::normalMatrices(&A[0], &Normals[0], Count);
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::tmat3x3<T, glm::highp> const Normal = glm::transpose(glm::inverse(glm::tmat3x3<T, glm::highp>(A[i])));
+			for(glm::length_t c = 0; c < 3; ++c)
+				Error += glm::all(glm::epsilonEqual(Normals[i][c], Normal[c], Epsilon)) ? 0 : 1;
+		}
+	}
+
+	return Error;
+}
+
+// Transforms and normalizes an array of points, one value at a time and N at a time
+template <typename T, std::size_t N>
+int perf(char const * Name)
+{
+	std::size_t const Count = 1 << 12;
+	std::size_t const Repeat = 1 << 10;
+	std::vector<glm::tvec3<T, glm::highp> > const In = points<T>(Count);
+	std::vector<glm::tvec3<T, glm::highp> > Out(Count);
+	glm::tmat4x4<T, glm::highp> const M = glm::rotate(glm::tmat4x4<T, glm::highp>(1), static_cast<T>(0.7), glm::tvec3<T, glm::highp>(1, 2, 3));
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = glm::normalize(glm::tvec3<T, glm::highp>(M * glm::tvec4<T, glm::highp>(In[i], 1)));
+	std::clock_t MiddleTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; i += N)
+		glm::wide::store(glm::wide::normalize(glm::wide::transformPoint(M, glm::wide::load<N>(&In[i]))), &Out[i]);
+	std::clock_t EndTime = std::clock();
+
+	std::printf("%s: tvec3 %d clocks, wide %d clocks\n", Name, static_cast<int>(MiddleTime - StartTime), static_cast<int>(EndTime - MiddleTime));
+
+	return 0;
+}
+
+// Updates the world matrices and points of a large scene, one at a time and in batches
+template <typename T>
+int perf_batch(char const * Name)
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+	typedef glm::tvec4<T, glm::highp> vec4;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+
+	std::size_t const Count = 100000;
+	std::size_t const Repeat = 16;
+	std::vector<mat4> const Parents = matrices<T>(Count, 0x12345678);
+	std::vector<mat4> const Locals = matrices<T>(Count, 0x9abcdef0);
+	std::vector<vec3> const In = points<T>(Count);
+	std::vector<char> MatrixStorage, PointStorage;
+	mat4 * Worlds = aligned<mat4>(MatrixStorage, Count);
+	vec3 * Out = aligned<vec3>(PointStorage, Count);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Worlds[i] = Parents[i] * Locals[i];
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = vec3(Worlds[j] * vec4(In[i], 1));
+	}
+	std::clock_t MiddleTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	{
+		glm::multiplyMatrices(&Parents[0], &Locals[0], Worlds, Count);
+		glm::transformPoints(Worlds[j], &In[0], Out, Count);
+	}
+	std::clock_t EndTime = std::clock();
+
+	std::printf("%s: one at a time %d clocks, batch %d clocks\n", Name, static_cast<int>(MiddleTime - StartTime), static_cast<int>(EndTime - MiddleTime));
+
+	return 0;
+}
+
+// The inverses and normal matrices of a large scene, with inverse, affineInverse and in batches
+template <typename T>
+int perf_inverse(char const * Name)
+{
+	typedef glm::tmat3x3<T, glm::highp> mat3;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+
+	std::size_t const Count = 1 << 12;
+	std::size_t const Repeat = 1 << 8;
+	std::vector<mat4> const Worlds = scaled<T>(Count);
+	std::vector<mat4> Inverses(Count);
+	std::vector<mat3> Normals(Count);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		Inverses[i] = glm::inverse(Worlds[i]);
+		Normals[i] = glm::inverseTranspose(mat3(Worlds[i]));
+	}
+	std::clock_t AffineTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		Inverses[i] = glm::affineInverse(Worlds[i]);
+		Normals[i] = glm::inverseTranspose(mat3(Worlds[i]));
+	}
+	std::clock_t BatchTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	{
+		glm::affineInverses(&Worlds[0], &Inverses[0], Count);
+		glm::normalMatrices(&Worlds[0], &Normals[0], Count);
+	}
+	std::clock_t EndTime = std::clock();
+
+	std::printf("%s: inverse %d clocks, affineInverse %d clocks, batch %d clocks\n", Name,
+		static_cast<int>(AffineTime - StartTime), static_cast<int>(BatchTime - AffineTime), static_cast<int>(EndTime - BatchTime));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_lanes<float, 1>();
+	Error += test_lanes<float, 4>();
+	Error += test_lanes<float, 8>();
+	Error += test_lanes<float, 16>();
+	Error += test_lanes<double, 2>();
+	Error += test_lanes<double, 4>();
+	Error += test_lanes<double, 3>();
+	Error += test_floor<float, 4>();
+	Error += test_floor<float, 8>();
+	Error += test_floor<double, 2>();
+	Error += test_floor<double, 4>();
+	Error += test_batch<float>();
+	Error += test_batch<double>();
+
+#	ifdef NDEBUG
+		Error += perf<float, 4>("vec3<float, 4>");
+		Error += perf<float, 8>("vec3<float, 8>");
+		Error += perf<double, 4>("vec3<double, 4>");
+		Error += perf_batch<float>("float");
+		Error += perf_batch<double>("double");
+		Error += perf_inverse<float>("float");
+		Error += perf_inverse<double>("double");
+#	endif//NDEBUG
+
+	return Error;
+}
@@ -0,0 +1,313 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_wide_intersect.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/wide_intersect.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+// xorshift, so the runs are reproducible
+glm::uint32 random(glm::uint32 & State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+template <typename T>
+T value(glm::uint32 & State)
+{
+	return static_cast<T>(static_cast<int>(random(State) % 2001) - 1000) / static_cast<T>(1000);
+}
+
+template <typename T>
+glm::tvec3<T, glm::highp> point(glm::uint32 & State)
+{
+	return glm::tvec3<T, glm::highp>(value<T>(State), value<T>(State), value<T>(State));
+}
+
+// Triangles around the origin, half of them facing away from the rays
+template <typename T>
+std::vector<glm::tvec3<T, glm::highp> > triangles(std::size_t Count, glm::uint32 Seed)
+{
+	glm::uint32 State = Seed;
+	std::vector<glm::tvec3<T, glm::highp> > Result(Count * 3);
+	for(std::size_t i = 0; i < Count * 3; ++i)
+		Result[i] = point<T>(State);
+	return Result;
+}
+
+// Rays from behind z = -2 through the cube around the origin
+template <typename T>
+void ray(glm::uint32 & State, glm::tvec3<T, glm::highp> & Orig, glm::tvec3<T, glm::highp> & Dir)
+{
+	Orig = point<T>(State) + glm::tvec3<T, glm::highp>(static_cast<T>(0), static_cast<T>(0), static_cast<T>(-3));
+	Dir = point<T>(State) - Orig;
+}
+
+// Whether the hit of a scalar test is too close to an edge of the triangle
+// for the lanes, which round differently, to agree on it
+template <typename T>
+bool edge(glm::tvec3<T, glm::highp> const & Bary)
+{
+	T const Margin = static_cast<T>(1e-3);
+	return glm::abs(Bary.x) < Margin || glm::abs(Bary.x - static_cast<T>(1)) < Margin ||
+		glm::abs(Bary.y) < Margin || glm::abs(Bary.x + Bary.y - static_cast<T>(1)) < Margin ||
+		glm::abs(Bary.z) < Margin;
+}
+
+// The lanes against glm::intersectRayTriangle, N rays against one triangle
+// and one ray against N triangles
+template <typename T, std::size_t N>
+int test_triangle()
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	int Error = 0;
+	int Hits = 0;
+
+	glm::uint32 State = 0x2545F491;
+	for(int k = 0; k < 2000; ++k)
+	{
+		glm::wide::vec3<T, N> Orig, Dir, Vert0, Vert1, Vert2;
+		vec3 o[N], d[N], v0[N], v1[N], v2[N];
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			ray(State, o[i], d[i]);
+			v0[i] = point<T>(State);
+			v1[i] = point<T>(State);
+			v2[i] = point<T>(State);
+			Orig.x[i] = o[i].x; Orig.y[i] = o[i].y; Orig.z[i] = o[i].z;
+			Dir.x[i] = d[i].x; Dir.y[i] = d[i].y; Dir.z[i] = d[i].z;
+			Vert0.x[i] = v0[i].x; Vert0.y[i] = v0[i].y; Vert0.z[i] = v0[i].z;
+			Vert1.x[i] = v1[i].x; Vert1.y[i] = v1[i].y; Vert1.z[i] = v1[i].z;
+			Vert2.x[i] = v2[i].x; Vert2.y[i] = v2[i].y; Vert2.z[i] = v2[i].z;
+		}
+
+		glm::wide::vec3<T, N> Rays, Triangles;
+		unsigned int const RaysHits = glm::wide::intersectRayTriangle(Orig, Dir, v0[0], v1[0], v2[0], Rays);
+		unsigned int const TrianglesHits = glm::wide::intersectRayTriangle(o[0], d[0], Vert0, Vert1, Vert2, Triangles);
+		Error += (RaysHits >> N) == 0 && (TrianglesHits >> N) == 0 ? 0 : 1;
+
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			vec3 Bary;
+			bool const Hit = glm::intersectRayTriangle(o[i], d[i], v0[0], v1[0], v2[0], Bary);
+			Hits += Hit ? 1 : 0;
+			if(!edge(Bary))
+				Error += Hit == ((RaysHits >> i) & 1) ? 0 : 1;
+			if(Hit && ((RaysHits >> i) & 1))
+				Error += glm::all(glm::epsilonEqual(Bary, Rays.at(i), static_cast<T>(1e-4))) ? 0 : 1;
+
+			bool const HitTriangle = glm::intersectRayTriangle(o[0], d[0], v0[i], v1[i], v2[i], Bary);
+			if(!edge(Bary))
+				Error += HitTriangle == ((TrianglesHits >> i) & 1) ? 0 : 1;
+			if(HitTriangle && ((TrianglesHits >> i) & 1))
+				Error += glm::all(glm::epsilonEqual(Bary, Triangles.at(i), static_cast<T>(1e-4))) ? 0 : 1;
+		}
+	}
+
+	// Enough hits for the test to mean something
+	Error += Hits > 2000 * static_cast<int>(N) / 100 ? 0 : 1;
+
+	return Error;
+}
+
+// The lanes against glm::intersectRayBox, which does the same operations
+template <typename T, std::size_t N>
+int test_box()
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	int Error = 0;
+	int Hits = 0;
+
+	glm::uint32 State = 0x7F4A7C15;
+	for(int k = 0; k < 2000; ++k)
+	{
+		glm::wide::vec3<T, N> Orig, InvDir, BoxMin, BoxMax;
+		vec3 o[N], InvD[N], Min[N], Max[N];
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			vec3 d;
+			ray(State, o[i], d);
+			// Rays starting inside some of the boxes
+			if(i == 1)
+				o[i] = point<T>(State) * static_cast<T>(0.1);
+			InvD[i] = static_cast<T>(1) / d;
+			vec3 const a = point<T>(State), b = point<T>(State);
+			Min[i] = glm::min(a, b);
+			Max[i] = glm::max(a, b);
+			Orig.x[i] = o[i].x; Orig.y[i] = o[i].y; Orig.z[i] = o[i].z;
+			InvDir.x[i] = InvD[i].x; InvDir.y[i] = InvD[i].y; InvDir.z[i] = InvD[i].z;
+			BoxMin.x[i] = Min[i].x; BoxMin.y[i] = Min[i].y; BoxMin.z[i] = Min[i].z;
+			BoxMax.x[i] = Max[i].x; BoxMax.y[i] = Max[i].y; BoxMax.z[i] = Max[i].z;
+		}
+
+		glm::wide::scalar<T, N> Rays, Boxes;
+		unsigned int const RaysHits = glm::wide::intersectRayBox(Orig, InvDir, Min[0], Max[0], Rays);
+		unsigned int const BoxesHits = glm::wide::intersectRayBox(o[0], InvD[0], BoxMin, BoxMax, Boxes);
+		Error += (RaysHits >> N) == 0 && (BoxesHits >> N) == 0 ? 0 : 1;
+
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			T Distance = static_cast<T>(0);
+			bool const Hit = glm::intersectRayBox(o[i], InvD[i], Min[0], Max[0], Distance);
+			Hits += Hit ? 1 : 0;
+			Error += Hit == ((RaysHits >> i) & 1) ? 0 : 1;
+			Error += !Hit || Distance == Rays[i] ? 0 : 1;
+
+			bool const HitBox = glm::intersectRayBox(o[0], InvD[0], Min[i], Max[i], Distance);
+			Error += HitBox == ((BoxesHits >> i) & 1) ? 0 : 1;
+			Error += !HitBox || Distance == Boxes[i] ? 0 : 1;
+		}
+	}
+
+	Error += Hits > 2000 * static_cast<int>(N) / 100 ? 0 : 1;
+
+	return Error;
+}
+
+// The nearest hit against the scalar loop, the tail included
+template <typename T>
+int test_batch()
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	int Error = 0;
+
+	std::size_t const Count = 1003;
+	std::vector<vec3> const Vertices = triangles<T>(Count, 0x9E3779B9);
+
+	glm::uint32 State = 0x3C6EF372;
+	int Hits = 0;
+	for(int k = 0; k < 200; ++k)
+	{
+		vec3 Orig, Dir;
+		ray(State, Orig, Dir);
+
+		std::size_t Nearest = Count;
+		vec3 Bary, NearestBary;
+		T Distance = std::numeric_limits<T>::infinity();
+		for(std::size_t i = 0; i < Count; ++i)
+			if(glm::intersectRayTriangle(Orig, Dir, Vertices[i * 3], Vertices[i * 3 + 1], Vertices[i * 3 + 2], Bary) && Bary.z < Distance)
+			{
+				Distance = Bary.z;
+				Nearest = i;
+				NearestBary = Bary;
+			}
+
+		std::size_t const Found = glm::intersectRayTriangles(Orig, Dir, &Vertices[0], Count, Bary);
+		Hits += Nearest < Count ? 1 : 0;
+		Error += Found == Nearest ? 0 : 1;
+		if(Found == Nearest && Found < Count)
+			Error += glm::all(glm::epsilonEqual(Bary, NearestBary, static_cast<T>(1e-4))) ? 0 : 1;
+	}
+	Error += Hits > 50 ? 0 : 1;
+
+	// Fewer triangles than lanes, and none
+	vec3 const Orig(static_cast<T>(0.25), static_cast<T>(0.25), static_cast<T>(-1));
+	vec3 const Dir(static_cast<T>(0), static_cast<T>(0), static_cast<T>(1));
+	vec3 const Triangle[3] = {vec3(0, 0, 0), vec3(0, 1, 0), vec3(1, 0, 0)};
+	vec3 Bary;
+	Error += glm::intersectRayTriangles(Orig, Dir, Triangle, 1, Bary) == 0 ? 0 : 1;
+	Error += glm::all(glm::epsilonEqual(Bary, vec3(0.25, 0.25, 1), static_cast<T>(1e-6))) ? 0 : 1;
+	Error += glm::intersectRayTriangles(Orig, Dir, Triangle, 0, Bary) == 0 ? 0 : 1;
+
+	return Error;
+}
+
+// Picking: one ray against a dense mesh
+template <typename T>
+int perf(char const * Name)
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	std::size_t const Count = 1 << 18;
+	std::vector<vec3> const Vertices = triangles<T>(Count, 0x9E3779B9);
+	glm::uint32 State = 0x3C6EF372;
+	int const Rays = 16;
+	std::size_t Sum = 0;
+
+	std::clock_t StartTime = std::clock();
+	for(int k = 0; k < Rays; ++k)
+	{
+		vec3 Orig, Dir, Bary;
+		ray(State, Orig, Dir);
+		T Distance = std::numeric_limits<T>::infinity();
+		std::size_t Nearest = Count;
+		for(std::size_t i = 0; i < Count; ++i)
+			if(glm::intersectRayTriangle(Orig, Dir, Vertices[i * 3], Vertices[i * 3 + 1], Vertices[i * 3 + 2], Bary) && Bary.z < Distance)
+			{
+				Distance = Bary.z;
+				Nearest = i;
+			}
+		Sum += Nearest;
+	}
+	std::clock_t LoopTime = std::clock();
+	for(int k = 0; k < Rays; ++k)
+	{
+		vec3 Orig, Dir, Bary;
+		ray(State, Orig, Dir);
+		Sum += glm::intersectRayTriangles(Orig, Dir, &Vertices[0], Count, Bary);
+	}
+	std::clock_t BatchTime = std::clock();
+
+	std::printf("%s: intersectRayTriangle loop %d clocks, intersectRayTriangles %d clocks (%d)\n", Name,
+		static_cast<int>(LoopTime - StartTime), static_cast<int>(BatchTime - LoopTime), static_cast<int>(Sum & 1));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_triangle<float, 4>();
+	Error += test_triangle<float, 8>();
+	Error += test_triangle<float, 5>();
+	Error += test_triangle<double, 2>();
+	Error += test_triangle<double, 4>();
+	Error += test_box<float, 4>();
+	Error += test_box<float, 8>();
+	Error += test_box<double, 2>();
+	Error += test_box<double, 4>();
+	Error += test_batch<float>();
+	Error += test_batch<double>();
+
+#	ifdef NDEBUG
+		Error += perf<float>("float");
+		Error += perf<double>("double");
+#	endif//NDEBUG
+
+	return Error;
+}
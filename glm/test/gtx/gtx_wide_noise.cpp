@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_wide_noise.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/wide_noise.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+#include <vector>
+
+// xorshift, so the runs are reproducible
+glm::uint32 random(glm::uint32 & State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+// Over several periods of the hash, negatives included
+template <typename T>
+T value(glm::uint32 & State)
+{
+	return static_cast<T>(static_cast<int>(random(State) % 200001) - 100000) / static_cast<T>(97);
+}
+
+template <typename T>
+std::vector<glm::tvec3<T, glm::highp> > points(std::size_t Count)
+{
+	glm::uint32 State = 0x12345678;
+	std::vector<glm::tvec3<T, glm::highp> > Result(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+		Result[i] = glm::tvec3<T, glm::highp>(value<T>(State), value<T>(State), value<T>(State));
+	// Lattice points and their neighbours
+	Result[0] = glm::tvec3<T, glm::highp>(0);
+	Result[1] = glm::tvec3<T, glm::highp>(static_cast<T>(-1), static_cast<T>(2), static_cast<T>(-3));
+	Result[2] = glm::tvec3<T, glm::highp>(static_cast<T>(288), static_cast<T>(289), static_cast<T>(-289));
+	return Result;
+}
+
+template <typename T>
+std::vector<glm::tvec2<T, glm::highp> > points2(std::vector<glm::tvec3<T, glm::highp> > const & Points)
+{
+	std::vector<glm::tvec2<T, glm::highp> > Result(Points.size());
+	for(std::size_t i = 0; i < Points.size(); ++i)
+		Result[i] = glm::tvec2<T, glm::highp>(Points[i]);
+	return Result;
+}
+
+// With FMA, the compiler may fuse the products of glm::perlin and
+// glm::simplex, and of the lanes, differently. That flips the gradients whose
+// hash maps onto an edge of the gradient set, where the rounding picks the
+// side: a few percent of the values differ then, the same code unfused
+// gives the same values
+int limit(std::size_t Values)
+{
+	return GLM_HAS_FMA ? static_cast<int>(Values / 10) : 0;
+}
+
+// The lanes at any width, against the one point at a time functions
+template <typename T, std::size_t N>
+int test_lanes()
+{
+	int Error = 0;
+	int Flipped = 0;
+
+	std::vector<glm::tvec3<T, glm::highp> > const Points = points<T>(N * 16);
+	T const Epsilon = std::numeric_limits<T>::epsilon() * static_cast<T>(1000);
+
+	for(std::size_t i = 0; i + N <= Points.size(); i += N)
+	{
+		glm::wide::vec3<T, N> v;
+		for(std::size_t j = 0; j < N; ++j)
+		{
+			v.x[j] = Points[i + j].x;
+			v.y[j] = Points[i + j].y;
+			v.z[j] = Points[i + j].z;
+		}
+
+		glm::wide::scalar<T, N> const Perlin2 = glm::wide::perlin(v.x, v.y);
+		glm::wide::scalar<T, N> const Perlin3 = glm::wide::perlin(v);
+		glm::wide::scalar<T, N> const Simplex2 = glm::wide::simplex(v.x, v.y);
+		glm::wide::scalar<T, N> const Simplex3 = glm::wide::simplex(v);
+
+		for(std::size_t j = 0; j < N; ++j)
+		{
+			glm::tvec3<T, glm::highp> const p = Points[i + j];
+			Flipped += glm::epsilonEqual(Perlin2[j], glm::perlin(glm::tvec2<T, glm::highp>(p)), Epsilon) ? 0 : 1;
+			Flipped += glm::epsilonEqual(Perlin3[j], glm::perlin(p), Epsilon) ? 0 : 1;
+			Flipped += glm::epsilonEqual(Simplex2[j], glm::simplex(glm::tvec2<T, glm::highp>(p)), Epsilon) ? 0 : 1;
+			Flipped += glm::epsilonEqual(Simplex3[j], glm::simplex(p), Epsilon) ? 0 : 1;
+		}
+	}
+	Error += Flipped <= limit(Points.size() * 4) ? 0 : 1;
+
+	return Error;
+}
+
+template <typename T>
+int test_batch()
+{
+	int Error = 0;
+	int Flipped = 0;
+
+	// Not a multiple of the lanes, so the tail is taken
+	std::size_t const Count = 1001;
+	int const Octaves = 5;
+	std::vector<glm::tvec3<T, glm::highp> > const Points = points<T>(Count);
+	std::vector<glm::tvec2<T, glm::highp> > const Points2 = points2(Points);
+	std::vector<T> Perlin2(Count), Perlin3(Count), Simplex2(Count), Simplex3(Count), Fbm2(Count), Fbm3(Count);
+
+	glm::perlinNoise(&Points2[0], &Perlin2[0], Count);
+	glm::perlinNoise(&Points[0], &Perlin3[0], Count);
+	glm::simplexNoise(&Points2[0], &Simplex2[0], Count);
+	glm::simplexNoise(&Points[0], &Simplex3[0], Count);
+	glm::perlinFbm(&Points2[0], &Fbm2[0], Count, Octaves);
+	glm::simplexFbm(&Points[0], &Fbm3[0], Count, Octaves, static_cast<T>(1.9), static_cast<T>(0.6));
+
+	T const Epsilon = std::numeric_limits<T>::epsilon() * static_cast<T>(1000);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		Flipped += glm::epsilonEqual(Perlin2[i], glm::perlin(Points2[i]), Epsilon) ? 0 : 1;
+		Flipped += glm::epsilonEqual(Perlin3[i], glm::perlin(Points[i]), Epsilon) ? 0 : 1;
+		Flipped += glm::epsilonEqual(Simplex2[i], glm::simplex(Points2[i]), Epsilon) ? 0 : 1;
+		Flipped += glm::epsilonEqual(Simplex3[i], glm::simplex(Points[i]), Epsilon) ? 0 : 1;
+
+		T Expected2 = static_cast<T>(0);
+		T Expected3 = static_cast<T>(0);
+		for(int o = 0; o < Octaves; ++o)
+		{
+			Expected2 += glm::pow(static_cast<T>(0.5), static_cast<T>(o)) * glm::perlin(Points2[i] * glm::pow(static_cast<T>(2), static_cast<T>(o)));
+			Expected3 += glm::pow(static_cast<T>(0.6), static_cast<T>(o)) * glm::simplex(Points[i] * glm::pow(static_cast<T>(1.9), static_cast<T>(o)));
+		}
+		Flipped += glm::epsilonEqual(Fbm2[i], Expected2, Epsilon * static_cast<T>(10)) ? 0 : 1;
+		Flipped += glm::epsilonEqual(Fbm3[i], Expected3, Epsilon * static_cast<T>(10)) ? 0 : 1;
+	}
+	Error += Flipped <= limit(Count * 6) ? 0 : 1;
+
+	return Error;
+}
+
+template <typename T>
+int perf(char const * Name)
+{
+	// A 256 x 256 terrain, 6 octaves
+	std::size_t const Count = 1 << 16;
+	int const Octaves = 6;
+	std::vector<glm::tvec3<T, glm::highp> > const Points = points<T>(Count);
+	std::vector<glm::tvec2<T, glm::highp> > const Points2 = points2(Points);
+	std::vector<T> Out(Count);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = glm::perlin(Points[i]);
+	std::clock_t PerlinTime = std::clock();
+	glm::perlinNoise(&Points[0], &Out[0], Count);
+	std::clock_t PerlinsTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = glm::simplex(Points[i]);
+	std::clock_t SimplexTime = std::clock();
+	glm::simplexNoise(&Points[0], &Out[0], Count);
+	std::clock_t SimplexesTime = std::clock();
+
+	std::printf("%s 3D: perlin %d clocks, perlinNoise %d clocks, simplex %d clocks, simplexNoise %d clocks\n", Name,
+		static_cast<int>(PerlinTime - StartTime), static_cast<int>(PerlinsTime - PerlinTime),
+		static_cast<int>(SimplexTime - PerlinsTime), static_cast<int>(SimplexesTime - SimplexTime));
+
+	StartTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		T Sum = static_cast<T>(0);
+		T Frequency = static_cast<T>(1);
+		T Amplitude = static_cast<T>(1);
+		for(int o = 0; o < Octaves; ++o, Frequency *= static_cast<T>(2), Amplitude *= static_cast<T>(0.5))
+			Sum += Amplitude * glm::simplex(Points2[i] * Frequency);
+		Out[i] = Sum;
+	}
+	std::clock_t FbmTime = std::clock();
+	glm::simplexFbm(&Points2[0], &Out[0], Count, Octaves);
+	std::clock_t FbmsTime = std::clock();
+
+	std::printf("%s 2D: simplex fbm %d clocks, simplexFbm %d clocks\n", Name,
+		static_cast<int>(FbmTime - StartTime), static_cast<int>(FbmsTime - FbmTime));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_lanes<float, 4>();
+	Error += test_lanes<float, 8>();
+	Error += test_lanes<float, 5>();
+	Error += test_lanes<double, 2>();
+	Error += test_lanes<double, 4>();
+	Error += test_batch<float>();
+	Error += test_batch<double>();
+
+#	ifdef NDEBUG
+		Error += perf<float>("float");
+		Error += perf<double>("double");
+#	endif//NDEBUG
+
+	return Error;
+}
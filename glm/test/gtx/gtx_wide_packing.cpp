@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_wide_packing.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/wide_packing.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+// xorshift, so the runs are reproducible
+glm::uint32 random(glm::uint32 & State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+float value(glm::uint32 & State)
+{
+	return static_cast<float>(static_cast<int>(random(State) % 2001) - 1000) / 1000.0f;
+}
+
+glm::quat rotation(glm::uint32 & State)
+{
+	glm::vec3 const Axis(value(State), value(State), value(State) + 0.01f);
+	return glm::angleAxis(value(State) * glm::pi<float>(), glm::normalize(Axis));
+}
+
+// The angle of the rotation from a to b
+float angle(glm::quat const & a, glm::quat const & b)
+{
+	glm::quat const c = glm::dot(a, b) < 0.0f ? a + b : a + -b;
+	return 4.0f * glm::asin(glm::min(glm::length(c) / 2.0f, 1.0f));
+}
+
+int test_quat()
+{
+	int Error = 0;
+
+	glm::uint32 State = 0x12345678;
+	float MaxAngle = 0.0f;
+	for(std::size_t i = 0; i < 10000; ++i)
+	{
+		glm::quat const q = rotation(State);
+		glm::quat const r = glm::unpackQuatSmallestThree(glm::packQuatSmallestThree(q));
+		Error += glm::epsilonEqual(glm::length(r), 1.0f, 0.0001f) ? 0 : 1;
+		MaxAngle = glm::max(MaxAngle, angle(q, r));
+	}
+	Error += MaxAngle < 0.005f ? 0 : 1;
+
+	// The identity, the axes and either sign are exact
+	glm::quat const Exact[] = {
+		glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::quat(-1.0f, 0.0f, 0.0f, 0.0f),
+		glm::quat(0.0f, 1.0f, 0.0f, 0.0f), glm::quat(0.0f, 0.0f, -1.0f, 0.0f), glm::quat(0.0f, 0.0f, 0.0f, 1.0f)};
+	for(std::size_t i = 0; i < sizeof(Exact) / sizeof(Exact[0]); ++i)
+	{
+		glm::quat const r = glm::unpackQuatSmallestThree(glm::packQuatSmallestThree(Exact[i]));
+		Error += glm::abs(glm::dot(r, Exact[i])) == 1.0f ? 0 : 1;
+	}
+
+	return Error;
+}
+
+std::vector<glm::mat4> instances(std::size_t Count, glm::uint32 Seed)
+{
+	glm::uint32 State = Seed;
+	std::vector<glm::mat4> Result(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::vec3 const Position(value(State) * 100.0f, value(State) * 10.0f, value(State) * 100.0f);
+		float const Scale = glm::exp2(value(State) * 2.0f);
+		Result[i] = glm::scale(glm::translate(glm::mat4(1.0f), Position) * glm::mat4_cast(rotation(State)), glm::vec3(Scale));
+	}
+	return Result;
+}
+
+int test_instances()
+{
+	int Error = 0;
+
+	// Not a multiple of the lanes, so the tail is taken
+	std::size_t const Count = 1001;
+	glm::vec3 const Origin(-101.0f, -11.0f, -101.0f);
+	float const Unit = 202.0f / 65535.0f;
+	std::vector<glm::mat4> const In = instances(Count, 0x9abcdef0);
+	std::vector<glm::u32vec3> Out(Count);
+	glm::packInstances(&In[0], &Out[0], Count, Origin, Unit);
+
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		Error += Out[i] == glm::packInstance(In[i], Origin, Unit) ? 0 : 1;
+
+		glm::mat4 const m = glm::unpackInstance(Out[i], Origin, Unit);
+		float const Scale = glm::length(glm::vec3(In[i][0]));
+		glm::quat const q = glm::quat_cast(glm::mat3(In[i]) / Scale);
+		Error += angle(q, glm::unpackQuatSmallestThree(Out[i].x)) < 0.005f ? 0 : 1;
+		// Half a step of the scale, 2^(1/64)
+		Error += glm::epsilonEqual(glm::length(glm::vec3(m[0])) / Scale, 1.0f, 0.011f) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(glm::vec3(m[3]), glm::vec3(In[i][3]), Unit * 0.5f + 0.00001f)) ? 0 : 1;
+	}
+
+	// Outside of the box the translation is clamped, no rotation nor scale
+	// is exact
+	glm::mat4 const Far = glm::translate(glm::mat4(1.0f), glm::vec3(-1000.0f, 0.0f, 1000.0f));
+	glm::u32vec3 const p = glm::packInstance(Far, Origin, Unit);
+	Error += (p.y & 0xffffu) == 0 && (p.z & 0xffffu) == 0xffffu && (p.z >> 16) == 128 ? 0 : 1;
+	Error += glm::unpackQuatSmallestThree(p.x) == glm::quat(1.0f, 0.0f, 0.0f, 0.0f) ? 0 : 1;
+
+	return Error;
+}
+
+int perf()
+{
+	std::size_t const Count = 1 << 14;
+	std::size_t const Repeat = 1 << 6;
+	glm::vec3 const Origin(-101.0f, -11.0f, -101.0f);
+	float const Unit = 202.0f / 65535.0f;
+	std::vector<glm::mat4> const In = instances(Count, 0x9abcdef0);
+	std::vector<glm::u32vec3> Out(Count);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::mat4 const & m = In[i];
+		float const Scale = glm::length(glm::vec3(m[0]));
+		glm::vec3 const p = glm::clamp(glm::floor((glm::vec3(m[3]) - Origin) / Unit + 0.5f), 0.0f, 65535.0f);
+		Out[i] = glm::u32vec3(
+			glm::packQuatSmallestThree(glm::quat_cast(glm::mat3(m) / Scale)),
+			static_cast<glm::uint32>(p.x) | static_cast<glm::uint32>(p.y) << 16,
+			static_cast<glm::uint32>(p.z) | static_cast<glm::uint32>(glm::log2(Scale) * 32.0f + 128.5f) << 16);
+	}
+	std::clock_t ScalarTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+		glm::packInstances(&In[0], &Out[0], Count, Origin, Unit);
+	std::clock_t BatchTime = std::clock();
+
+	std::printf("quat_cast and packQuatSmallestThree %d clocks, packInstances %d clocks\n",
+		static_cast<int>(ScalarTime - StartTime), static_cast<int>(BatchTime - ScalarTime));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_quat();
+	Error += test_instances();
+
+#	ifdef NDEBUG
+		Error += perf();
+#	endif//NDEBUG
+
+	return Error;
+}
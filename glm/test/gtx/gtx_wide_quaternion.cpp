@@ -0,0 +1,315 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_wide_quaternion.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/wide_quaternion.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/gtc/constants.hpp>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+
+// xorshift, so the runs are reproducible
+glm::uint32 random(glm::uint32 & State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+template <typename T>
+T value(glm::uint32 & State)
+{
+	return static_cast<T>(static_cast<int>(random(State) % 2001) - 1000) / static_cast<T>(1000);
+}
+
+template <typename T>
+std::vector<glm::tquat<T, glm::highp> > rotations(std::size_t Count, glm::uint32 Seed)
+{
+	glm::uint32 State = Seed;
+	std::vector<glm::tquat<T, glm::highp> > Result(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::tvec3<T, glm::highp> const Axis(value<T>(State), value<T>(State), static_cast<T>(2));
+		Result[i] = glm::angleAxis(value<T>(State) * glm::pi<T>() * static_cast<T>(2), glm::normalize(Axis));
+	}
+	return Result;
+}
+
+// The angle of the rotation from a to b, from the chord between them which,
+// unlike acos(dot(a, b)), is precise for small angles
+template <typename T>
+T angle(glm::tquat<T, glm::highp> const & a, glm::tquat<T, glm::highp> const & b)
+{
+	glm::tquat<T, glm::highp> const c = glm::dot(a, b) < static_cast<T>(0) ? a + b : a + -b;
+	return static_cast<T>(4) * glm::asin(glm::min(glm::length(c) / static_cast<T>(2), static_cast<T>(1)));
+}
+
+template <typename T>
+int test_lerp()
+{
+	typedef glm::tquat<T, glm::highp> quat;
+
+	int Error = 0;
+
+	// Not a multiple of the lanes, so the tail is taken
+	std::size_t const Count = 1001;
+	std::vector<quat> const A = rotations<T>(Count, 0x12345678);
+	std::vector<quat> B = rotations<T>(Count, 0x9abcdef0);
+	std::vector<T> S(Count);
+	glm::uint32 State = 0x2468ace0;
+	for(std::size_t i = 0; i < Count; ++i)
+		S[i] = glm::abs(value<T>(State));
+	// Nearly the same and opposite rotations
+	B[1] = A[1];
+	B[2] = -A[2];
+	B[3] = glm::normalize(A[3] + quat(static_cast<T>(0), static_cast<T>(0.001), static_cast<T>(0), static_cast<T>(0)));
+	S[Count - 1] = static_cast<T>(1);
+	S[Count - 2] = static_cast<T>(0);
+
+	std::vector<quat> Nlerp(Count), Slerp(Count);
+	glm::nlerpQuats(&A[0], &B[0], &S[0], &Nlerp[0], Count);
+	glm::slerpQuats(&A[0], &B[0], &S[0], &Slerp[0], Count);
+
+	T MaxError = static_cast<T>(0);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		quat const b = glm::dot(A[i], B[i]) < static_cast<T>(0) ? -B[i] : B[i];
+		quat const Expected = glm::normalize(A[i] * (static_cast<T>(1) - S[i]) + b * S[i]);
+		Error += glm::all(glm::epsilonEqual(glm::vec4(Nlerp[i].x, Nlerp[i].y, Nlerp[i].z, Nlerp[i].w), glm::vec4(Expected.x, Expected.y, Expected.z, Expected.w), 0.0001f)) ? 0 : 1;
+		Error += glm::epsilonEqual(glm::length(Slerp[i]), static_cast<T>(1), static_cast<T>(0.0001)) ? 0 : 1;
+		MaxError = glm::max(MaxError, angle(Slerp[i], glm::slerp(A[i], B[i], S[i])));
+	}
+	Error += MaxError < static_cast<T>(0.001) ? 0 : 1;
+
+	// In place
+	std::vector<quat> C(A);
+	glm::slerpQuats(&C[0], &B[0], &S[0], &C[0], Count);
+	for(std::size_t i = 0; i < Count; ++i)
+		Error += C[i] == Slerp[i] ? 0 : 1;
+
+	return Error;
+}
+
+template <typename T>
+int test_matrices()
+{
+	typedef glm::tquat<T, glm::highp> quat;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+
+	int Error = 0;
+
+	std::size_t const Count = 1001;
+	std::vector<quat> const Q = rotations<T>(Count, 0x12345678);
+	std::vector<mat4> M(Count);
+	glm::rotationMatrices(&Q[0], &M[0], Count);
+
+	T const Epsilon = std::numeric_limits<T>::epsilon() * static_cast<T>(10);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		mat4 const Expected = glm::mat4_cast(Q[i]);
+		for(glm::length_t j = 0; j < 4; ++j)
+			Error += glm::all(glm::epsilonEqual(M[i][j], Expected[j], Epsilon)) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+template <typename T>
+std::vector<glm::tdualquat<T, glm::highp> > joints(std::size_t Count)
+{
+	std::vector<glm::tquat<T, glm::highp> > const Q = rotations<T>(Count, 0x13579bdf);
+	std::vector<glm::tdualquat<T, glm::highp> > Result(Count);
+	glm::uint32 State = 0x0f1e2d3c;
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::tvec3<T, glm::highp> const Translation(value<T>(State), value<T>(State), value<T>(State));
+		// Either side of the sphere, the blend must pick the nearest
+		Result[i] = glm::tdualquat<T, glm::highp>(i & 1 ? -Q[i] : Q[i], Translation * static_cast<T>(10));
+	}
+	return Result;
+}
+
+template <typename T>
+struct skin
+{
+	std::vector<glm::tvec4<glm::uint16, glm::highp> > Indices;
+	std::vector<glm::tvec4<T, glm::highp> > Weights;
+	std::vector<glm::tvec3<T, glm::highp> > Positions;
+	std::vector<glm::tvec3<T, glm::highp> > Normals;
+
+	skin(std::size_t Count, std::size_t Joints) :
+		Indices(Count), Weights(Count), Positions(Count), Normals(Count)
+	{
+		glm::uint32 State = 0x76543210;
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::tvec4<T, glm::highp> const w(glm::abs(value<T>(State)), glm::abs(value<T>(State)), glm::abs(value<T>(State)), glm::abs(value<T>(State)));
+			Indices[i] = glm::tvec4<glm::uint16, glm::highp>(random(State) % Joints, random(State) % Joints, random(State) % Joints, random(State) % Joints);
+			Weights[i] = w / (w.x + w.y + w.z + w.w + static_cast<T>(0.001));
+			Positions[i] = glm::tvec3<T, glm::highp>(value<T>(State), value<T>(State), value<T>(State)) * static_cast<T>(10);
+			Normals[i] = glm::normalize(glm::tvec3<T, glm::highp>(value<T>(State), value<T>(State), static_cast<T>(1)));
+		}
+	}
+};
+
+// Dual quaternion linear blending, one vertex at a time
+template <typename T>
+glm::tdualquat<T, glm::highp> blend(glm::tdualquat<T, glm::highp> const * Joints, glm::tvec4<glm::uint16, glm::highp> const & Indices, glm::tvec4<T, glm::highp> const & Weights)
+{
+	glm::tquat<T, glm::highp> const Zero(static_cast<T>(0), static_cast<T>(0), static_cast<T>(0), static_cast<T>(0));
+	glm::tdualquat<T, glm::highp> Sum(Zero, Zero);
+	for(glm::length_t k = 0; k < 4; ++k)
+	{
+		glm::tdualquat<T, glm::highp> const & q = Joints[Indices[k]];
+		Sum = Sum + q * (glm::dot(Sum.real, q.real) < static_cast<T>(0) ? -Weights[k] : Weights[k]);
+	}
+	return glm::normalize(Sum);
+}
+
+template <typename T>
+int test_skin()
+{
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	int Error = 0;
+
+	std::size_t const Count = 1001;
+	std::vector<glm::tdualquat<T, glm::highp> > const Joints = joints<T>(64);
+	skin<T> const Skin(Count, Joints.size());
+
+	std::vector<vec3> Positions(Count), Normals(Count), Alone(Count);
+	glm::skinDualQuats(&Joints[0], &Skin.Indices[0], &Skin.Weights[0], &Skin.Positions[0], &Positions[0], &Skin.Normals[0], &Normals[0], Count);
+	glm::skinDualQuats(&Joints[0], &Skin.Indices[0], &Skin.Weights[0], &Skin.Positions[0], &Alone[0], Count);
+
+	T const Epsilon = static_cast<T>(0.0001);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::tdualquat<T, glm::highp> const q = blend(&Joints[0], Skin.Indices[i], Skin.Weights[i]);
+		Error += glm::all(glm::epsilonEqual(Positions[i], q * Skin.Positions[i], Epsilon * static_cast<T>(100))) ? 0 : 1;
+		Error += glm::all(glm::epsilonEqual(Normals[i], q.real * Skin.Normals[i], Epsilon)) ? 0 : 1;
+		Error += Alone[i] == Positions[i] ? 0 : 1;
+	}
+
+	// In place
+	std::vector<vec3> Vertices(Skin.Positions);
+	glm::skinDualQuats(&Joints[0], &Skin.Indices[0], &Skin.Weights[0], &Vertices[0], &Vertices[0], Count);
+	Error += Vertices == Positions ? 0 : 1;
+
+	return Error;
+}
+
+template <typename T>
+int perf(char const * Name)
+{
+	typedef glm::tquat<T, glm::highp> quat;
+	typedef glm::tmat4x4<T, glm::highp> mat4;
+	typedef glm::tvec3<T, glm::highp> vec3;
+
+	// A crowd: 64 skeletons of 64 joints, 1024 vertices per skeleton
+	std::size_t const Count = 1 << 12;
+	std::size_t const Repeat = 1 << 8;
+	std::vector<quat> const A = rotations<T>(Count, 0x12345678);
+	std::vector<quat> const B = rotations<T>(Count, 0x9abcdef0);
+	std::vector<T> const S(Count, static_cast<T>(0.3));
+	std::vector<quat> Out(Count);
+	std::vector<mat4> Matrices(Count);
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = glm::slerp(A[i], B[i], S[i]);
+	std::clock_t SlerpTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+		glm::slerpQuats(&A[0], &B[0], &S[0], &Out[0], Count);
+	std::clock_t SlerpsTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+		glm::nlerpQuats(&A[0], &B[0], &S[0], &Out[0], Count);
+	std::clock_t NlerpsTime = std::clock();
+
+	std::printf("%s: slerp %d clocks, slerpQuats %d clocks, nlerpQuats %d clocks\n", Name,
+		static_cast<int>(SlerpTime - StartTime), static_cast<int>(SlerpsTime - SlerpTime), static_cast<int>(NlerpsTime - SlerpsTime));
+
+	StartTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+	for(std::size_t i = 0; i < Count; ++i)
+		Matrices[i] = glm::mat4_cast(A[i]);
+	std::clock_t CastTime = std::clock();
+	for(std::size_t j = 0; j < Repeat; ++j)
+		glm::rotationMatrices(&A[0], &Matrices[0], Count);
+	std::clock_t MatricesTime = std::clock();
+
+	std::printf("%s: mat4_cast %d clocks, rotationMatrices %d clocks\n", Name,
+		static_cast<int>(CastTime - StartTime), static_cast<int>(MatricesTime - CastTime));
+
+	std::size_t const Vertices = 1 << 16;
+	std::size_t const Frames = 1 << 4;
+	std::vector<glm::tdualquat<T, glm::highp> > const Joints = joints<T>(64);
+	skin<T> const Skin(Vertices, Joints.size());
+	std::vector<vec3> Positions(Vertices), Normals(Vertices);
+
+	StartTime = std::clock();
+	for(std::size_t j = 0; j < Frames; ++j)
+	for(std::size_t i = 0; i < Vertices; ++i)
+	{
+		glm::tdualquat<T, glm::highp> const q = blend(&Joints[0], Skin.Indices[i], Skin.Weights[i]);
+		Positions[i] = q * Skin.Positions[i];
+		Normals[i] = q.real * Skin.Normals[i];
+	}
+	std::clock_t BlendTime = std::clock();
+	for(std::size_t j = 0; j < Frames; ++j)
+		glm::skinDualQuats(&Joints[0], &Skin.Indices[0], &Skin.Weights[0], &Skin.Positions[0], &Positions[0], &Skin.Normals[0], &Normals[0], Vertices);
+	std::clock_t SkinTime = std::clock();
+
+	std::printf("%s: dual quaternion blend %d clocks, skinDualQuats %d clocks\n", Name,
+		static_cast<int>(BlendTime - StartTime), static_cast<int>(SkinTime - BlendTime));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_lerp<float>();
+	Error += test_lerp<double>();
+	Error += test_matrices<float>();
+	Error += test_matrices<double>();
+	Error += test_skin<float>();
+	Error += test_skin<double>();
+
+#	ifdef NDEBUG
+		Error += perf<float>("float");
+		Error += perf<double>("double");
+#	endif//NDEBUG
+
+	return Error;
+}
@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_wide_random.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/wide_random.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+// The published first outputs of xoshiro128** from the state 1, 2, 3, 4
+int test_reference()
+{
+	int Error = 0;
+
+	glm::uint32 const Expected[4] = {11520u, 0u, 5927040u, 70819200u};
+	glm::detail::rand_state State = {{1u, 2u, 3u, 4u}, 1u};
+	glm::wide::random<4> Wide;
+	for(std::size_t i = 0; i < 4; ++i)
+		for(std::size_t k = 0; k < 4; ++k)
+			Wide.s[k][i] = State.s[k];
+
+	for(std::size_t n = 0; n < 4; ++n)
+	{
+		glm::uint32 Lanes[4];
+		glm::detail::compute_wide_random<4>::next(Wide, Lanes);
+		Error += glm::detail::rand_next(State) == Expected[n] ? 0 : 1;
+		for(std::size_t i = 0; i < 4; ++i)
+			Error += Lanes[i] == Expected[n] ? 0 : 1;
+	}
+
+	return Error;
+}
+
+// Each lane is the scalar generator started from its state
+template <typename T, std::size_t N>
+int test_lanes()
+{
+	int Error = 0;
+
+	glm::wide::random<N> Wide;
+	glm::wide::seed(Wide, 42);
+	glm::detail::rand_state Lanes[N];
+	for(std::size_t i = 0; i < N; ++i)
+		for(std::size_t k = 0; k < 4; ++k)
+			Lanes[i].s[k] = Wide.s[k][i];
+
+	for(std::size_t n = 0; n < 1000; ++n)
+	{
+		glm::wide::scalar<T, N> const u = glm::wide::uniform<T>(Wide);
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			glm::uint32 const x = glm::detail::rand_next(Lanes[i]);
+			T Expected = static_cast<T>(x >> 8) / static_cast<T>(16777216);
+			if(sizeof(T) == sizeof(double))
+				Expected = (static_cast<T>(x >> 6) * static_cast<T>(134217728) +
+					static_cast<T>(glm::detail::rand_next(Lanes[i]) >> 5)) / static_cast<T>(9007199254740992.0);
+			Error += u[i] == Expected ? 0 : 1;
+			Error += u[i] >= static_cast<T>(0) && u[i] < static_cast<T>(1) ? 0 : 1;
+		}
+	}
+
+	return Error;
+}
+
+template <typename T, std::size_t N>
+int test_spherical()
+{
+	int Error = 0;
+
+	T const Epsilon = sizeof(T) == sizeof(float) ? static_cast<T>(1e-5) : static_cast<T>(1e-12);
+	std::size_t const Count = 100000;
+	glm::wide::random<N> Wide;
+	glm::wide::seed(Wide, 7);
+	glm::tvec3<T, glm::highp> Sum(static_cast<T>(0));
+	std::size_t Hemisphere[2] = {0, 0};
+	for(std::size_t n = 0; n < Count / N; ++n)
+	{
+		glm::wide::vec3<T, N> const v = glm::wide::spherical<T>(Wide);
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			glm::tvec3<T, glm::highp> const p = v.at(i);
+			Error += glm::epsilonEqual(glm::length(p), static_cast<T>(1), Epsilon) ? 0 : 1;
+			Sum += p;
+			++Hemisphere[p.x < static_cast<T>(0) ? 0 : 1];
+		}
+	}
+	// a uniform distribution has its mean at the center, and as many
+	// points on either side of any plane through it
+	Error += glm::all(glm::lessThan(glm::abs(Sum / static_cast<T>(Count)), glm::tvec3<T, glm::highp>(static_cast<T>(0.01)))) ? 0 : 1;
+	Error += Hemisphere[0] > Count * 49 / 100 && Hemisphere[1] > Count * 49 / 100 ? 0 : 1;
+
+	return Error;
+}
+
+// In range, the tails included, and the same numbers after the same seed
+template <typename T>
+int test_batch()
+{
+	int Error = 0;
+
+	std::size_t const Count = 100003;
+	std::vector<T> Values(Count);
+	std::vector<glm::tvec3<T, glm::highp> > Points(Count), Directions(Count);
+	std::vector<glm::tvec4<T, glm::highp> > Colors(Count);
+	glm::tvec3<T, glm::highp> const Min3(static_cast<T>(-1), static_cast<T>(2), static_cast<T>(10));
+	glm::tvec3<T, glm::highp> const Max3(static_cast<T>(1), static_cast<T>(3), static_cast<T>(20));
+	glm::tvec4<T, glm::highp> const Min4(static_cast<T>(0));
+	glm::tvec4<T, glm::highp> const Max4(static_cast<T>(1), static_cast<T>(2), static_cast<T>(4), static_cast<T>(8));
+
+	glm::seedRand(1234);
+	glm::linearRands(&Values[0], Count, static_cast<T>(-5), static_cast<T>(5));
+	glm::linearRands(&Points[0], Count, Min3, Max3);
+	glm::linearRands(&Colors[0], Count, Min4, Max4);
+	glm::sphericalRands(&Directions[0], Count, static_cast<T>(3));
+
+	T Sum = static_cast<T>(0);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		Error += Values[i] >= static_cast<T>(-5) && Values[i] < static_cast<T>(5) ? 0 : 1;
+		Error += glm::all(glm::greaterThanEqual(Points[i], Min3)) && glm::all(glm::lessThanEqual(Points[i], Max3)) ? 0 : 1;
+		Error += glm::all(glm::greaterThanEqual(Colors[i], Min4)) && glm::all(glm::lessThanEqual(Colors[i], Max4)) ? 0 : 1;
+		Error += glm::epsilonEqual(glm::length(Directions[i]), static_cast<T>(3), static_cast<T>(1e-4)) ? 0 : 1;
+		Sum += Values[i];
+	}
+	Error += glm::abs(Sum / static_cast<T>(Count)) < static_cast<T>(0.05) ? 0 : 1;
+	// the tail is random too
+	Error += Values[Count - 1] != Values[Count - 2] && Points[Count - 1] != Points[Count - 2] ? 0 : 1;
+
+	std::vector<T> Again(Count);
+	glm::seedRand(1234);
+	glm::linearRands(&Again[0], Count, static_cast<T>(-5), static_cast<T>(5));
+	Error += Again == Values ? 0 : 1;
+	glm::seedRand(1235);
+	glm::linearRands(&Again[0], Count, static_cast<T>(-5), static_cast<T>(5));
+	Error += Again != Values ? 0 : 1;
+
+	return Error;
+}
+
+int test_seedRand()
+{
+	int Error = 0;
+
+	glm::seedRand(99);
+	glm::vec3 const a = glm::linearRand(glm::vec3(0), glm::vec3(1));
+	float const b = glm::gaussRand(0.0f, 1.0f);
+	glm::seedRand(99);
+	Error += glm::linearRand(glm::vec3(0), glm::vec3(1)) == a ? 0 : 1;
+	Error += glm::gaussRand(0.0f, 1.0f) == b ? 0 : 1;
+
+	return Error;
+}
+
+template <typename T>
+int perf(char const * Name)
+{
+	// the particles of an emitter burst
+	std::size_t const Count = 1 << 20;
+	std::vector<glm::tvec3<T, glm::highp> > Out(Count);
+	glm::tvec3<T, glm::highp> const Min(static_cast<T>(-1));
+	glm::tvec3<T, glm::highp> const Max(static_cast<T>(1));
+
+	std::clock_t StartTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = glm::linearRand(Min, Max);
+	std::clock_t LinearTime = std::clock();
+	glm::linearRands(&Out[0], Count, Min, Max);
+	std::clock_t LinearsTime = std::clock();
+	for(std::size_t i = 0; i < Count; ++i)
+		Out[i] = glm::sphericalRand(static_cast<T>(1));
+	std::clock_t SphericalTime = std::clock();
+	glm::sphericalRands(&Out[0], Count, static_cast<T>(1));
+	std::clock_t SphericalsTime = std::clock();
+
+	std::printf("%s: linearRand %d clocks, linearRands %d clocks, sphericalRand %d clocks, sphericalRands %d clocks\n", Name,
+		static_cast<int>(LinearTime - StartTime), static_cast<int>(LinearsTime - LinearTime),
+		static_cast<int>(SphericalTime - LinearsTime), static_cast<int>(SphericalsTime - SphericalTime));
+
+	return 0;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_reference();
+	Error += test_lanes<float, 4>();
+	Error += test_lanes<float, 8>();
+	Error += test_lanes<float, 5>();
+	Error += test_lanes<double, 2>();
+	Error += test_lanes<double, 4>();
+	Error += test_spherical<float, 4>();
+	Error += test_spherical<float, 8>();
+	Error += test_spherical<double, 2>();
+	Error += test_batch<float>();
+	Error += test_batch<double>();
+	Error += test_seedRand();
+
+#	ifdef NDEBUG
+		Error += perf<float>("float");
+		Error += perf<double>("double");
+#	endif//NDEBUG
+
+	return Error;
+}
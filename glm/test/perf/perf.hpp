@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf.hpp
+/// @date 2026-10-15 / 2026-10-15
+///
+/// The harness of the micro-benchmarks. Each case is run until it has been
+/// warm for a while, then timed over several repetitions of enough calls to
+/// last a few milliseconds. The median time per item and the median absolute
+/// deviation (MAD) are written as one JSON object per line, so the outputs
+/// of several runs, scalar and SIMD builds, concatenate into one file.
+///
+/// Command line: --repetitions=N, --filter=text to run only the cases whose
+/// name contains text, --output=file to append the results to file instead
+/// of writing them to the standard output.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <vector>
+#if GLM_HAS_CXX11_STL
+#	include <chrono>
+#endif
+
+namespace perf
+{
+	// The build: GLM_FORCE_PURE or not, and the instructions GLM uses
+	inline char const * variant()
+	{
+#		ifdef GLM_FORCE_PURE
+			return "pure";
+#		else
+			return "simd";
+#		endif
+	}
+
+	inline char const * arch()
+	{
+#		if GLM_ARCH & GLM_ARCH_AVX2
+			return "avx2";
+#		elif GLM_ARCH & GLM_ARCH_AVX
+			return "avx";
+#		elif GLM_ARCH & GLM_ARCH_SSE4
+			return "sse4";
+#		elif GLM_ARCH & GLM_ARCH_SSE3
+			return "sse3";
+#		elif GLM_ARCH & GLM_ARCH_SSE2
+			return "sse2";
+#		else
+			return "pure";
+#		endif
+	}
+
+	// Seconds from an arbitrary origin; the processor time without the
+	// C++11 clocks, whose resolution the long samples make up for
+	inline double now()
+	{
+#		if GLM_HAS_CXX11_STL
+			return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#		else
+			return static_cast<double>(std::clock()) / static_cast<double>(CLOCKS_PER_SEC);
+#		endif
+	}
+
+	// Makes the compiler compute x, whose value nothing reads
+	template <typename T>
+	inline void keep(T const & x)
+	{
+#		if (GLM_COMPILER & (GLM_COMPILER_GCC | GLM_COMPILER_LLVM | GLM_COMPILER_APPLE_CLANG))
+			__asm__ __volatile__("" : : "r"(&x) : "memory");
+#		else
+			static void const * volatile Sink;
+			Sink = &x;
+#		endif
+	}
+
+	// Reproducible values in [-1, 1], xorshift
+	inline float value()
+	{
+		static glm::uint32 State = 0x2545F491;
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return static_cast<float>(static_cast<int>(State % 2001) - 1000) / 1000.f;
+	}
+
+	// Count T, 64 bytes aligned, which std::vector only guarantees to the
+	// types of the wide registers from C++17
+	template <typename T>
+	class aligned_array
+	{
+	public:
+		explicit aligned_array(std::size_t Count) :
+			Storage(new char[Count * sizeof(T) + 64]),
+			Data(reinterpret_cast<T *>(Storage + (64 - reinterpret_cast<std::size_t>(Storage) % 64) % 64))
+		{
+			for(std::size_t i = 0; i < Count; ++i)
+				new(Data + i) T;
+		}
+
+		~aligned_array()
+		{
+			delete[] Storage;
+		}
+
+		T & operator[](std::size_t i) {return Data[i];}
+		T const & operator[](std::size_t i) const {return Data[i];}
+
+	private:
+		aligned_array(aligned_array const &);
+		aligned_array & operator=(aligned_array const &);
+
+		char * Storage;
+		T * Data;
+	};
+
+	inline double median(std::vector<double> Values)
+	{
+		std::sort(Values.begin(), Values.end());
+		std::size_t const Half = Values.size() / 2;
+		return Values.size() % 2 ? Values[Half] : (Values[Half - 1] + Values[Half]) / 2.0;
+	}
+
+	class bench
+	{
+	public:
+		bench(int argc, char * argv[]) :
+			Repetitions(15),
+			Output(stdout)
+		{
+			for(int i = 1; i < argc; ++i)
+			{
+				if(std::strncmp(argv[i], "--repetitions=", 14) == 0)
+					Repetitions = std::max(std::atoi(argv[i] + 14), 1);
+				else if(std::strncmp(argv[i], "--filter=", 9) == 0)
+					Filter = argv[i] + 9;
+				else if(std::strncmp(argv[i], "--output=", 9) == 0)
+				{
+					std::FILE * File = std::fopen(argv[i] + 9, "a");
+					if(File)
+						Output = File;
+					else
+						std::fprintf(stderr, "perf: can't open %s\n", argv[i] + 9);
+				}
+			}
+		}
+
+		~bench()
+		{
+			if(Output != stdout)
+				std::fclose(Output);
+		}
+
+		// Times Func, a functor whose call processes Items items, and
+		// writes the time per item
+		template <typename func>
+		void run(char const * Name, std::size_t Items, func Func)
+		{
+			if(!Filter.empty() && std::string(Name).find(Filter) == std::string::npos)
+				return;
+
+			// Warm up for 50 ms, doubling the calls of a sample until it
+			// lasts 5 ms
+			std::size_t Calls = 1;
+			double const WarmStart = now();
+			for(;;)
+			{
+				double const Start = now();
+				for(std::size_t i = 0; i < Calls; ++i)
+					Func();
+				double const Time = now() - Start;
+				if(Time >= 0.05 || (Time >= 0.005 && now() - WarmStart >= 0.05))
+					break;
+				if(Time < 0.005)
+					Calls *= 2;
+			}
+
+			std::vector<double> Samples(Repetitions);
+			for(int r = 0; r < Repetitions; ++r)
+			{
+				double const Start = now();
+				for(std::size_t i = 0; i < Calls; ++i)
+					Func();
+				Samples[r] = (now() - Start) * 1e9 / static_cast<double>(Calls * Items);
+			}
+
+			double const Median = median(Samples);
+			std::vector<double> Deviations(Repetitions);
+			for(int r = 0; r < Repetitions; ++r)
+				Deviations[r] = Samples[r] > Median ? Samples[r] - Median : Median - Samples[r];
+
+			std::fprintf(Output,
+				"{\"benchmark\": \"%s\", \"variant\": \"%s\", \"arch\": \"%s\", \"items\": %u, \"repetitions\": %d, \"median_ns\": %.4f, \"mad_ns\": %.4f}\n",
+				Name, variant(), arch(), static_cast<unsigned int>(Items), Repetitions, Median, median(Deviations));
+			std::fflush(Output);
+		}
+
+	private:
+		int Repetitions;
+		std::string Filter;
+		std::FILE * Output;
+	};
+}//namespace perf
@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf_geometric.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "perf.hpp"
+#include <glm/gtx/fast_square_root.hpp>
+
+std::size_t const Count = 1024;
+
+struct data
+{
+	data() :
+		A3(Count), B3(Count), Out3(Count), A4(Count), B4(Count), Out4(Count), Out(Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			A3[i] = glm::vec3(perf::value(), perf::value(), perf::value()) + glm::vec3(2.f);
+			B3[i] = glm::vec3(perf::value(), perf::value(), perf::value());
+			A4[i] = glm::vec4(A3[i], perf::value());
+			B4[i] = glm::vec4(B3[i], perf::value());
+		}
+	}
+
+	std::vector<glm::vec3> A3, B3, Out3;
+	std::vector<glm::vec4> A4, B4, Out4;
+	std::vector<float> Out;
+};
+
+struct normalize3
+{
+	data & Data;
+	normalize3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out3[i] = glm::normalize(Data.A3[i]);
+		perf::keep(Data.Out3[0]);
+	}
+};
+
+struct normalize4
+{
+	data & Data;
+	normalize4(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out4[i] = glm::normalize(Data.A4[i]);
+		perf::keep(Data.Out4[0]);
+	}
+};
+
+struct fast_normalize3
+{
+	data & Data;
+	fast_normalize3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out3[i] = glm::fastNormalize(Data.A3[i]);
+		perf::keep(Data.Out3[0]);
+	}
+};
+
+struct length3
+{
+	data & Data;
+	length3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::length(Data.A3[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct dot4
+{
+	data & Data;
+	dot4(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::dot(Data.A4[i], Data.B4[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct cross3
+{
+	data & Data;
+	cross3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out3[i] = glm::cross(Data.A3[i], Data.B3[i]);
+		perf::keep(Data.Out3[0]);
+	}
+};
+
+struct reflect3
+{
+	data & Data;
+	reflect3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out3[i] = glm::reflect(Data.A3[i], Data.B3[i]);
+		perf::keep(Data.Out3[0]);
+	}
+};
+
+int main(int argc, char * argv[])
+{
+	perf::bench Bench(argc, argv);
+	data Data;
+
+	Bench.run("normalize(vec3)", Count, normalize3(Data));
+	Bench.run("normalize(vec4)", Count, normalize4(Data));
+	Bench.run("fastNormalize(vec3)", Count, fast_normalize3(Data));
+	Bench.run("length(vec3)", Count, length3(Data));
+	Bench.run("dot(vec4)", Count, dot4(Data));
+	Bench.run("cross(vec3)", Count, cross3(Data));
+	Bench.run("reflect(vec3)", Count, reflect3(Data));
+
+	return 0;
+}
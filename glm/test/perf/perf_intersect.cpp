@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf_intersect.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "perf.hpp"
+#include <glm/gtx/intersect.hpp>
+#include <glm/gtx/wide_intersect.hpp>
+
+// Larger than the branch predictors remember: the same ray against a few
+// thousand triangles would train them and flatter the scalar loop
+std::size_t const Count = 1 << 16;
+
+glm::vec3 point()
+{
+	return glm::vec3(perf::value(), perf::value(), perf::value());
+}
+
+// One ray from behind z = -2 against triangles and boxes around the origin
+struct data
+{
+	data() :
+		Orig(point() - glm::vec3(0.f, 0.f, 3.f)), Vertices(Count * 3), Min(Count), Max(Count)
+	{
+		Dir = point() - Orig;
+		for(std::size_t i = 0; i < Count * 3; ++i)
+			Vertices[i] = point();
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::vec3 const a = point(), b = point() * 0.1f;
+			Min[i] = glm::min(a, a + b);
+			Max[i] = glm::max(a, a + b);
+		}
+	}
+
+	glm::vec3 Orig, Dir;
+	std::vector<glm::vec3> Vertices;
+	std::vector<glm::vec3> Min, Max;
+};
+
+struct ray_triangle
+{
+	data & Data;
+	ray_triangle(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		std::size_t Nearest = Count;
+		float Distance = std::numeric_limits<float>::infinity();
+		glm::vec3 Bary;
+		for(std::size_t i = 0; i < Count; ++i)
+			if(glm::intersectRayTriangle(Data.Orig, Data.Dir, Data.Vertices[i * 3], Data.Vertices[i * 3 + 1], Data.Vertices[i * 3 + 2], Bary) && Bary.z < Distance)
+			{
+				Distance = Bary.z;
+				Nearest = i;
+			}
+		perf::keep(Nearest);
+	}
+};
+
+struct ray_triangles
+{
+	data & Data;
+	ray_triangles(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::vec3 Bary;
+		std::size_t const Nearest = glm::intersectRayTriangles(Data.Orig, Data.Dir, &Data.Vertices[0], Count, Bary);
+		perf::keep(Nearest);
+	}
+};
+
+struct ray_box
+{
+	data & Data;
+	ray_box(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::vec3 const InvDir = 1.f / Data.Dir;
+		std::size_t Hits = 0;
+		float Distance = 0.f;
+		for(std::size_t i = 0; i < Count; ++i)
+			Hits += glm::intersectRayBox(Data.Orig, InvDir, Data.Min[i], Data.Max[i], Distance) ? 1 : 0;
+		perf::keep(Hits);
+	}
+};
+
+// The boxes transposed beforehand, as the nodes of a hierarchy store them
+template <std::size_t N>
+struct wide_boxes
+{
+	perf::aligned_array<glm::wide::vec3<float, N> > Min, Max;
+	wide_boxes(data const & Data) : Min(Count / N), Max(Count / N)
+	{
+		for(std::size_t i = 0; i < Count / N; ++i)
+		{
+			Min[i] = glm::wide::load<N>(&Data.Min[i * N]);
+			Max[i] = glm::wide::load<N>(&Data.Max[i * N]);
+		}
+	}
+};
+
+template <std::size_t N>
+struct ray_boxes
+{
+	data & Data;
+	wide_boxes<N> & Boxes;
+	ray_boxes(data & Data, wide_boxes<N> & Boxes) : Data(Data), Boxes(Boxes) {}
+	void operator()()
+	{
+		glm::vec3 const InvDir = 1.f / Data.Dir;
+		std::size_t Hits = 0;
+		glm::wide::scalar<float, N> Distance;
+		for(std::size_t i = 0; i < Count / N; ++i)
+			Hits += glm::wide::intersectRayBox(Data.Orig, InvDir, Boxes.Min[i], Boxes.Max[i], Distance) != 0 ? 1 : 0;
+		perf::keep(Hits);
+	}
+};
+
+int main(int argc, char * argv[])
+{
+	perf::bench Bench(argc, argv);
+	data Data;
+
+	Bench.run("intersectRayTriangle, nearest", Count, ray_triangle(Data));
+	Bench.run("intersectRayTriangles", Count, ray_triangles(Data));
+	Bench.run("intersectRayBox", Count, ray_box(Data));
+	wide_boxes<4> Boxes4(Data);
+	wide_boxes<8> Boxes8(Data);
+	Bench.run("wide::intersectRayBox, 4 boxes", Count, ray_boxes<4>(Data, Boxes4));
+	Bench.run("wide::intersectRayBox, 8 boxes", Count, ray_boxes<8>(Data, Boxes8));
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf_matrix.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "perf.hpp"
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/wide.hpp>
+
+std::size_t const Count = 1024;
+
+// Rotations, scales and translations, which all the inverses accept
+std::vector<glm::mat4> matrices()
+{
+	std::vector<glm::mat4> Result(Count);
+	for(std::size_t i = 0; i < Count; ++i)
+	{
+		glm::vec3 const Axis(perf::value(), perf::value(), 2.f);
+		glm::mat4 const Rotation = glm::rotate(glm::mat4(1.f), perf::value() * 3.f, glm::normalize(Axis));
+		glm::mat4 const Scale = glm::scale(glm::mat4(1.f), glm::vec3(2.f + perf::value(), 2.f + perf::value(), 2.f + perf::value()));
+		Result[i] = glm::translate(glm::mat4(1.f), glm::vec3(perf::value(), perf::value(), perf::value())) * Rotation * Scale;
+	}
+	return Result;
+}
+
+struct data
+{
+	data() :
+		A(matrices()), B(matrices()), Out(Count), DA(A.begin(), A.end()), DB(B.begin(), B.end()), DOut(Count),
+		Normals(Count), Points(Count), Vectors(Count), OutPoints(Count), OutVectors(Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			Points[i] = glm::vec3(perf::value(), perf::value(), perf::value());
+			Vectors[i] = glm::vec4(Points[i], 1.f);
+		}
+	}
+
+	std::vector<glm::mat4> A, B, Out;
+	std::vector<glm::dmat4> DA, DB, DOut;
+	std::vector<glm::mat3> Normals;
+	std::vector<glm::vec3> Points;
+	std::vector<glm::vec4> Vectors;
+	std::vector<glm::vec3> OutPoints;
+	std::vector<glm::vec4> OutVectors;
+};
+
+struct multiply
+{
+	data & Data;
+	multiply(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = Data.A[i] * Data.B[i];
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct multiply_double
+{
+	data & Data;
+	multiply_double(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.DOut[i] = Data.DA[i] * Data.DB[i];
+		perf::keep(Data.DOut[0]);
+	}
+};
+
+struct multiply_matrices
+{
+	data & Data;
+	multiply_matrices(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::multiplyMatrices(&Data.A[0], &Data.B[0], &Data.Out[0], Count);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct transform
+{
+	data & Data;
+	transform(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.OutVectors[i] = Data.A[0] * Data.Vectors[i];
+		perf::keep(Data.OutVectors[0]);
+	}
+};
+
+struct transform_points
+{
+	data & Data;
+	transform_points(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::transformPoints(Data.A[0], &Data.Points[0], &Data.OutPoints[0], Count);
+		perf::keep(Data.OutPoints[0]);
+	}
+};
+
+struct inverse
+{
+	data & Data;
+	inverse(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::inverse(Data.A[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct affine_inverse
+{
+	data & Data;
+	affine_inverse(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::affineInverse(Data.A[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct affine_inverses
+{
+	data & Data;
+	affine_inverses(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::affineInverses(&Data.A[0], &Data.Out[0], Count);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct normal_matrix
+{
+	data & Data;
+	normal_matrix(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Normals[i] = glm::inverseTranspose(glm::mat3(Data.A[i]));
+		perf::keep(Data.Normals[0]);
+	}
+};
+
+struct normal_matrices
+{
+	data & Data;
+	normal_matrices(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::normalMatrices(&Data.A[0], &Data.Normals[0], Count);
+		perf::keep(Data.Normals[0]);
+	}
+};
+
+int main(int argc, char * argv[])
+{
+	perf::bench Bench(argc, argv);
+	data Data;
+
+	Bench.run("mat4 * mat4", Count, multiply(Data));
+	Bench.run("dmat4 * dmat4", Count, multiply_double(Data));
+	Bench.run("multiplyMatrices", Count, multiply_matrices(Data));
+	Bench.run("mat4 * vec4", Count, transform(Data));
+	Bench.run("transformPoints", Count, transform_points(Data));
+	Bench.run("inverse(mat4)", Count, inverse(Data));
+	Bench.run("affineInverse(mat4)", Count, affine_inverse(Data));
+	Bench.run("affineInverses", Count, affine_inverses(Data));
+	Bench.run("inverseTranspose(mat3)", Count, normal_matrix(Data));
+	Bench.run("normalMatrices", Count, normal_matrices(Data));
+
+	return 0;
+}
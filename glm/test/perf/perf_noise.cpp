@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf_noise.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "perf.hpp"
+#include <glm/gtc/noise.hpp>
+#include <glm/gtx/wide_noise.hpp>
+
+std::size_t const Count = 1024;
+
+struct data
+{
+	data() :
+		Points2(Count), Points3(Count), Out(Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			Points3[i] = glm::vec3(perf::value(), perf::value(), perf::value()) * 100.f;
+			Points2[i] = glm::vec2(Points3[i]);
+		}
+	}
+
+	std::vector<glm::vec2> Points2;
+	std::vector<glm::vec3> Points3;
+	std::vector<float> Out;
+};
+
+struct perlin3
+{
+	data & Data;
+	perlin3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::perlin(Data.Points3[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct perlin_noise3
+{
+	data & Data;
+	perlin_noise3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::perlinNoise(&Data.Points3[0], &Data.Out[0], Data.Out.size());
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct simplex2
+{
+	data & Data;
+	simplex2(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::simplex(Data.Points2[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct simplex_noise2
+{
+	data & Data;
+	simplex_noise2(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::simplexNoise(&Data.Points2[0], &Data.Out[0], Data.Out.size());
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct simplex3
+{
+	data & Data;
+	simplex3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::simplex(Data.Points3[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct simplex_noise3
+{
+	data & Data;
+	simplex_noise3(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::simplexNoise(&Data.Points3[0], &Data.Out[0], Data.Out.size());
+		perf::keep(Data.Out[0]);
+	}
+};
+
+// 6 octaves, a terrain
+struct simplex_fbm2
+{
+	data & Data;
+	simplex_fbm2(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::simplexFbm(&Data.Points2[0], &Data.Out[0], Data.Out.size(), 6);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+int main(int argc, char * argv[])
+{
+	perf::bench Bench(argc, argv);
+	data Data;
+
+	Bench.run("perlin(vec3)", Count, perlin3(Data));
+	Bench.run("perlinNoise(vec3)", Count, perlin_noise3(Data));
+	Bench.run("simplex(vec2)", Count, simplex2(Data));
+	Bench.run("simplexNoise(vec2)", Count, simplex_noise2(Data));
+	Bench.run("simplex(vec3)", Count, simplex3(Data));
+	Bench.run("simplexNoise(vec3)", Count, simplex_noise3(Data));
+	Bench.run("simplexFbm(vec2), 6 octaves", Count, simplex_fbm2(Data));
+
+	return 0;
+}
@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf_packing.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "perf.hpp"
+#include <glm/gtc/packing.hpp>
+
+std::size_t const Count = 1024;
+
+struct data
+{
+	data() :
+		Values(Count * 4), Vectors(Count), Words(Count), Halves(Count * 4), Bytes(Count * 4), Out(Count * 4), OutVectors(Count)
+	{
+		for(std::size_t i = 0; i < Count * 4; ++i)
+			Values[i] = perf::value();
+		for(std::size_t i = 0; i < Count; ++i)
+			Vectors[i] = glm::vec4(Values[i * 4], Values[i * 4 + 1], Values[i * 4 + 2], Values[i * 4 + 3]);
+		glm::packHalf(&Values[0], &Halves[0], Count * 4);
+		glm::packUnorm8(&Values[0], &Bytes[0], Count * 4);
+		glm::packSnorm3x10_1x2(&Vectors[0], &Words[0], Count);
+	}
+
+	std::vector<float> Values;
+	std::vector<glm::vec4> Vectors;
+	std::vector<glm::uint32> Words;
+	std::vector<glm::uint16> Halves;
+	std::vector<glm::uint8> Bytes;
+	std::vector<float> Out;
+	std::vector<glm::vec4> OutVectors;
+};
+
+struct pack_unorm4x8
+{
+	data & Data;
+	pack_unorm4x8(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Words[i] = glm::packUnorm4x8(Data.Vectors[i]);
+		perf::keep(Data.Words[0]);
+	}
+};
+
+struct unpack_unorm4x8
+{
+	data & Data;
+	unpack_unorm4x8(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.OutVectors[i] = glm::unpackUnorm4x8(Data.Words[i]);
+		perf::keep(Data.OutVectors[0]);
+	}
+};
+
+struct pack_half2x16
+{
+	data & Data;
+	pack_half2x16(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Words[i] = glm::packHalf2x16(glm::vec2(Data.Vectors[i]));
+		perf::keep(Data.Words[0]);
+	}
+};
+
+struct pack_half4x16
+{
+	data & Data;
+	pack_half4x16(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::uint64 Sum = 0;
+		for(std::size_t i = 0; i < Count; ++i)
+			Sum += glm::packHalf4x16(Data.Vectors[i]);
+		perf::keep(Sum);
+	}
+};
+
+struct pack_half
+{
+	data & Data;
+	pack_half(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::packHalf(&Data.Values[0], &Data.Halves[0], Data.Values.size());
+		perf::keep(Data.Halves[0]);
+	}
+};
+
+struct unpack_half
+{
+	data & Data;
+	unpack_half(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::unpackHalf(&Data.Halves[0], &Data.Out[0], Data.Halves.size());
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct pack_unorm8
+{
+	data & Data;
+	pack_unorm8(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::packUnorm8(&Data.Values[0], &Data.Bytes[0], Data.Values.size());
+		perf::keep(Data.Bytes[0]);
+	}
+};
+
+struct pack_snorm3x10_1x2
+{
+	data & Data;
+	pack_snorm3x10_1x2(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Words[i] = glm::packSnorm3x10_1x2(Data.Vectors[i]);
+		perf::keep(Data.Words[0]);
+	}
+};
+
+struct pack_snorm3x10_1x2_array
+{
+	data & Data;
+	pack_snorm3x10_1x2_array(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::packSnorm3x10_1x2(&Data.Vectors[0], &Data.Words[0], Count);
+		perf::keep(Data.Words[0]);
+	}
+};
+
+int main(int argc, char * argv[])
+{
+	perf::bench Bench(argc, argv);
+	data Data;
+
+	Bench.run("packUnorm4x8", Count, pack_unorm4x8(Data));
+	Bench.run("unpackUnorm4x8", Count, unpack_unorm4x8(Data));
+	Bench.run("packHalf2x16", Count, pack_half2x16(Data));
+	Bench.run("packHalf4x16", Count, pack_half4x16(Data));
+	Bench.run("packHalf, per float", Count * 4, pack_half(Data));
+	Bench.run("unpackHalf, per float", Count * 4, unpack_half(Data));
+	Bench.run("packUnorm8, per float", Count * 4, pack_unorm8(Data));
+	Bench.run("packSnorm3x10_1x2", Count, pack_snorm3x10_1x2(Data));
+	Bench.run("packSnorm3x10_1x2, array", Count, pack_snorm3x10_1x2_array(Data));
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2012 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// 
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/perf/perf_quaternion.cpp
+/// @date 2026-10-15 / 2026-10-15
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "perf.hpp"
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/wide_quaternion.hpp>
+
+std::size_t const Count = 1024;
+
+glm::quat rotation()
+{
+	glm::vec3 const Axis(perf::value(), perf::value(), 2.f);
+	return glm::angleAxis(perf::value() * 3.f, glm::normalize(Axis));
+}
+
+struct data
+{
+	data() :
+		A(Count), B(Count), Out(Count), T(Count), Matrices(Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			A[i] = rotation();
+			B[i] = rotation();
+			T[i] = perf::value() * 0.5f + 0.5f;
+		}
+	}
+
+	std::vector<glm::quat> A, B, Out;
+	std::vector<float> T;
+	std::vector<glm::mat4> Matrices;
+};
+
+struct slerp
+{
+	data & Data;
+	slerp(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Out[i] = glm::slerp(Data.A[i], Data.B[i], Data.T[i]);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct slerp_quats
+{
+	data & Data;
+	slerp_quats(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::slerpQuats(&Data.A[0], &Data.B[0], &Data.T[0], &Data.Out[0], Count);
+		perf::keep(Data.Out[0]);
+	}
+};
+
+struct mat4_cast
+{
+	data & Data;
+	mat4_cast(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Data.Matrices[i] = glm::mat4_cast(Data.A[i]);
+		perf::keep(Data.Matrices[0]);
+	}
+};
+
+struct rotation_matrices
+{
+	data & Data;
+	rotation_matrices(data & Data) : Data(Data) {}
+	void operator()()
+	{
+		glm::rotationMatrices(&Data.A[0], &Data.Matrices[0], Count);
+		perf::keep(Data.Matrices[0]);
+	}
+};
+
+int main(int argc, char * argv[])
+{
+	perf::bench Bench(argc, argv);
+	data Data;
+
+	Bench.run("slerp(quat)", Count, slerp(Data));
+	Bench.run("slerpQuats", Count, slerp_quats(Data));
+	Bench.run("mat4_cast(quat)", Count, mat4_cast(Data));
+	Bench.run("rotationMatrices", Count, rotation_matrices(Data));
+
+	return 0;
+}
@@ -0,0 +1,46 @@
+#version 150 core
+
+// Blends an effect of HalfResEffects.h, computed at a reduced size, into
+// the scene at the full size: the four reduced texels around the pixel are
+// weighted bilinearly, and each also by how close its linear depth is to
+// that of the pixel, so the effect does not leak across the edges of
+// objects. The blending adds the rgb of the result to the scene times its
+// alpha.
+uniform sampler2D effect;	// rgb: added light, a: transmittance
+uniform sampler2D reduced;	// the reduced depth the effect was computed at
+uniform sampler2D depth;	// of the scene
+uniform vec2 reducedSize;	// in texels
+uniform vec2 depthRange;	// near and far plane
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+#define DEPTH_TOLERANCE 0.02	// relative, which still counts as the same surface
+
+float linearDepth(float d)
+{
+	return depthRange.x * depthRange.y / (depthRange.y - d * (depthRange.y - depthRange.x));
+}
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	float z = linearDepth(texelFetch(depth, ivec2(gl_FragCoord.xy), 0).r);
+	vec2 p = uv * reducedSize - 0.5;
+	ivec2 base = ivec2(floor(p));
+	vec2 f = p - vec2(base);
+	ivec2 last = ivec2(reducedSize) - 1;
+	vec4 sum = vec4(0.0);
+	float total = 0.0;
+	for (int i = 0; i < 4; i++) {
+		ivec2 o = ivec2(i & 1, i >> 1);
+		ivec2 t = clamp(base + o, ivec2(0), last);
+		vec2 b = mix(1.0 - f, f, vec2(o));
+		float dz = abs(linearDepth(texelFetch(reduced, t, 0).r) - z) / z;
+		float w = b.x * b.y / (DEPTH_TOLERANCE + dz) + 1e-5;
+		sum += w * texelFetch(effect, t, 0);
+		total += w;
+	}
+	color = sum / total;
+}
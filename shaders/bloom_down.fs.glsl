@@ -0,0 +1,69 @@
+#version 150 core
+
+// One step down the mip chain of the bloom, see PostProcess.h: the 13 taps
+// of Jorge Jimenez' downsample, five overlapping boxes of 2x2 source texels
+// each read with a single bilinear fetch, which do not flicker as a plain
+// box filter would when edges move. FIRST reads the scene, whose sRGB
+// encoded colors are decoded, and weights each box by 1 / (1 + luma) as
+// Brian Karis suggested, so that single very bright pixels do not bloom
+// into blinking squares; MULTISAMPLE reads the first sample of each pixel
+// of the multisampled scene instead of filtering.
+#ifdef MULTISAMPLE
+uniform sampler2DMS source;
+#else
+uniform sampler2D source;
+#endif
+uniform vec2 sourceSize;	// in texels
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+vec3 fetch(vec2 uv)
+{
+#ifdef MULTISAMPLE
+	vec3 c = texelFetch(source, ivec2(clamp(uv * sourceSize, vec2(0.0), sourceSize - 1.0)), 0).rgb;
+#else
+	vec3 c = texture(source, uv).rgb;
+#endif
+#ifdef FIRST
+	c = pow(max(c, vec3(0.0)), vec3(2.2));
+#endif
+	return c;
+}
+
+vec3 box(vec3 a, vec3 b, vec3 c, vec3 d, float weight, inout float total)
+{
+	vec3 sum = 0.25 * (a + b + c + d);
+#ifdef FIRST
+	weight /= 1.0 + dot(sum, vec3(0.2126, 0.7152, 0.0722));
+#endif
+	total += weight;
+	return sum * weight;
+}
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	vec2 t = 1.0 / sourceSize;
+	vec3 a = fetch(uv + t * vec2(-2.0, 2.0));
+	vec3 b = fetch(uv + t * vec2(0.0, 2.0));
+	vec3 c = fetch(uv + t * vec2(2.0, 2.0));
+	vec3 d = fetch(uv + t * vec2(-1.0, 1.0));
+	vec3 e = fetch(uv + t * vec2(1.0, 1.0));
+	vec3 f = fetch(uv + t * vec2(-2.0, 0.0));
+	vec3 g = fetch(uv);
+	vec3 h = fetch(uv + t * vec2(2.0, 0.0));
+	vec3 i = fetch(uv + t * vec2(-1.0, -1.0));
+	vec3 j = fetch(uv + t * vec2(1.0, -1.0));
+	vec3 k = fetch(uv + t * vec2(-2.0, -2.0));
+	vec3 l = fetch(uv + t * vec2(0.0, -2.0));
+	vec3 m = fetch(uv + t * vec2(2.0, -2.0));
+	float total = 0.0;
+	vec3 sum = box(d, e, i, j, 0.5, total);
+	sum += box(a, b, f, g, 0.125, total);
+	sum += box(b, c, g, h, 0.125, total);
+	sum += box(f, g, k, l, 0.125, total);
+	sum += box(g, h, l, m, 0.125, total);
+	color = vec4(sum / total, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 150 core
+
+// One step up the mip chain of the bloom, see PostProcess.h: the level
+// below is stretched with a 3x3 tent filter and added to this level of the
+// way down, so each level adds a wider blur to the result.
+uniform sampler2D source;	// the level below, half the size
+uniform sampler2D base;		// this level of the way down
+uniform vec2 sourceSize;	// in texels
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	vec2 t = 1.0 / sourceSize;
+	vec3 sum = 4.0 * texture(source, uv).rgb;
+	sum += 2.0 * (texture(source, uv + vec2(t.x, 0.0)).rgb + texture(source, uv - vec2(t.x, 0.0)).rgb +
+		texture(source, uv + vec2(0.0, t.y)).rgb + texture(source, uv - vec2(0.0, t.y)).rgb);
+	sum += texture(source, uv + t).rgb + texture(source, uv - t).rgb +
+		texture(source, uv + vec2(t.x, -t.y)).rgb + texture(source, uv + vec2(-t.x, t.y)).rgb;
+	color = vec4(texture(base, uv).rgb + sum / 16.0, 1.0);
+}
@@ -0,0 +1,36 @@
+#version 150 core
+
+// Converts the captured frame into NV12 for the video encoder, see
+// Capture.h: the target is an R8 image as wide as the frame (rounded up to
+// even) and 1.5 times as high. The first lumaRows rows are the luma of the
+// pixels, the rows below them the chroma of 2x2 pixels, U and V next to each
+// other. BT.601 limited range, what ffmpeg assumes of untagged input. The
+// source is flipped already, row 0 is the top.
+uniform sampler2D source;
+uniform ivec2 sourceSize;	// in texels, the last row and column repeat
+uniform int lumaRows;
+
+out vec4 color;
+
+vec3 fetch(ivec2 p)
+{
+	return texelFetch(source, min(p, sourceSize - 1), 0).rgb;
+}
+
+void main()
+{
+	ivec2 p = ivec2(gl_FragCoord.xy);
+	float value;
+	if (p.y < lumaRows) {
+		value = dot(fetch(p), vec3(0.256788, 0.504129, 0.097906)) + 16.0 / 255.0;
+	} else {
+		ivec2 q = ivec2(p.x & ~1, 2 * (p.y - lumaRows));
+		vec3 c = 0.25 * (fetch(q) + fetch(q + ivec2(1, 0)) + fetch(q + ivec2(0, 1)) + fetch(q + ivec2(1, 1)));
+		if ((p.x & 1) == 0)
+			value = dot(c, vec3(-0.148223, -0.290993, 0.439216)) + 128.0 / 255.0;
+		else
+			value = dot(c, vec3(0.439216, -0.367788, -0.071427)) + 128.0 / 255.0;
+	}
+	// blending, if it is on, keeps it as it is
+	color = vec4(value, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,61 @@
+#version 150 core
+#ifdef OIT_LIST
+#extension GL_ARB_shader_image_load_store : require
+#endif
+
+// This is the base of several permutations, see cube.vs.glsl.
+// CUT: cut a sphere out of the cube, PATTERN: an experimental pattern
+// instead of the vertex colors, DEPTH_ONLY: the depth pre-pass, which
+// only keeps the discard, TRANSLUCENT: see-through faces, drawn with
+// order-independent transparency (shaders/oit.glsl), into per-pixel lists
+// with OIT_LIST, FADE: drop the pixels the billboards of Impostors.h
+// cover in their crossfade, PICKING: write the entity id of the object
+// into the second target, see Picking.h
+
+in vec4 v_clr;
+#ifdef CUT
+#include "frame.glsl"
+
+in vec3 v_pos;
+#endif
+#ifdef FADE
+#include "impostor.glsl"
+
+in float v_fade;
+#endif
+
+#ifdef TRANSLUCENT
+#include "oit.glsl"
+
+#define TRANSLUCENT_ALPHA 0.45
+#else
+out vec4 color;
+#endif
+#ifdef PICKING
+flat in uint v_object;
+out uint pickId;
+#endif
+
+void main()
+{
+#ifdef CUT
+	if(length(v_pos) < cutRadius)
+		discard;
+#endif
+#ifdef FADE
+	if (impostorDither(gl_FragCoord.xy) < v_fade)
+		discard;
+#endif
+#ifdef TRANSLUCENT
+	oitWrite(vec4(v_clr.rgb, TRANSLUCENT_ALPHA));
+#elif defined(DEPTH_ONLY)
+	color = vec4(0.0);
+#elif defined(PATTERN)
+	color = sin(gl_FragCoord*0.1);
+#else
+	color = v_clr;
+#endif
+#ifdef PICKING
+	pickId = v_object;
+#endif
+}
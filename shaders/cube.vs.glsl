@@ -0,0 +1,203 @@
+#version 150 core
+#if defined(PULLED) || defined(DISPLACED)
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+// This is the base of several permutations, the program registry inserts
+// the feature defines (see shaderFeatureNames in HelloCube.cpp):
+// INSTANCED: per-instance model matrix, CUT: pass the position on to the
+// fragment shader, WOBBLE: animate the vertices, PULLED: no vertex
+// attributes at all, see Cube::drawPulled (with INSTANCED), COMPACT: the
+// instances packed into 12 bytes, see Cube::drawCompact (with INSTANCED),
+// SPINNING: the instances spin by themselves, see Cube::drawSpinning (with
+// PULLED),
+// MOTION: the velocity pass of TemporalAA.h, with shaders/velocity.fs.glsl,
+// TESSELLATED: hand the vertices to shaders/wobble.tcs.glsl, which
+// subdivides the triangles, see Tessellation.h, DISPLACED: the positions
+// were wobbled by shaders/displace.cs.glsl, see Displacement.h, FADE: the
+// instances fade out where the billboards of Impostors.h fade in (with
+// INSTANCED), PICKING: pass the entity id of the scene object on, see
+// Picking.h (with INSTANCED)
+#include "frame.glsl"
+
+// the depth pre-pass variant must compute the same depth, see RenderQueue.h
+invariant gl_Position;
+
+#ifdef PULLED
+#ifdef SPINNING
+// the CubeSpin of each instance, at CUBE_INSTANCE_SSBO_BINDING: the
+// position from instanceBox.xyz and the phase, then the axis and the
+// angular velocity
+readonly buffer Instances {
+	vec4 instanceSpins[];
+};
+
+// the model matrix of instance i at time, glm::rotate around its axis
+mat4 spinInstance(int i)
+{
+	vec4 p = instanceSpins[2 * i], a = instanceSpins[2 * i + 1];
+	float angle = p.w + a.w * time;
+	float c = cos(angle), s = sin(angle);
+	vec3 t = a.xyz * (1.0 - c), r = a.xyz * s;
+	return mat4(vec4(t.x * a.xyz + vec3(c, r.z, -r.y), 0.0),
+		vec4(t.y * a.xyz + vec3(-r.z, c, r.x), 0.0),
+		vec4(t.z * a.xyz + vec3(r.y, -r.x, c), 0.0),
+		vec4(instanceBox.xyz + p.xyz, 1.0));
+}
+#else
+// the model matrices of this frame, at CUBE_INSTANCE_SSBO_BINDING
+readonly buffer Instances {
+	mat4 instanceModels[];
+};
+#endif
+
+// the faces of basicCubeGeometry in Cube.h: corner c of face f is at
+// faceNormal + faceRight * (c & 1 ? 1 : -1) + faceUp * (c & 2 ? 1 : -1),
+// the color of the face is darker towards corner 3
+const vec3 faceNormal[6] = vec3[6](vec3(0, 0, 1), vec3(0, 0, -1), vec3(-1, 0, 0), vec3(1, 0, 0),
+	vec3(0, 1, 0), vec3(0, -1, 0));
+const vec3 faceRight[6] = vec3[6](vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 0, 1), vec3(0, 0, -1),
+	vec3(1, 0, 0), vec3(-1, 0, 0));
+const vec3 faceUp[6] = vec3[6](vec3(0, 1, 0), vec3(0, 1, 0), vec3(0, 1, 0), vec3(0, 1, 0),
+	vec3(0, 0, -1), vec3(0, 0, -1));
+const vec3 faceColor[6] = vec3[6](vec3(1, 0, 0), vec3(0, 1, 1), vec3(0, 1, 0), vec3(1, 0, 1),
+	vec3(0, 0, 1), vec3(1, 1, 0));
+#else
+in vec3 pos;
+in vec4 clr;
+#ifdef COMPACT
+// glm::packInstance: the rotation as the smallest three components of its
+// quaternion, the position in steps of instanceBox.w from instanceBox.xyz
+// and the uniform scale as 2^((s - 128) / 32)
+in uvec3 instCompact;
+
+mat4 unpackInstance(uvec3 p)
+{
+	uint largest = p.x >> 30;
+	vec3 c = (vec3(uvec3(p.x >> 20, p.x >> 10, p.x) & 1023u) - 512.0) / (511.0 * 1.41421356);
+	float l = sqrt(max(1.0 - dot(c, c), 0.0));
+	vec4 q = (largest == 0u) ? vec4(l, c) : (largest == 1u) ? vec4(c.x, l, c.yz) :
+		(largest == 2u) ? vec4(c.xy, l, c.z) : vec4(c, l);
+	vec3 q2 = q.xyz * 2.0;
+	float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+	float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+	float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+	float s = exp2(float(p.z >> 16) / 32.0 - 4.0);
+	vec3 t = instanceBox.xyz + vec3(p.y & 0xffffu, p.y >> 16, p.z & 0xffffu) * instanceBox.w;
+	return mat4(vec4(s * vec3(1.0 - (yy + zz), xy + wz, xz - wy), 0.0),
+		vec4(s * vec3(xy - wz, 1.0 - (xx + zz), yz + wx), 0.0),
+		vec4(s * vec3(xz + wy, yz - wx, 1.0 - (xx + yy)), 0.0),
+		vec4(t, 1.0));
+}
+#elif defined(INSTANCED)
+in mat4 instModel;
+#endif
+#ifdef PICKING
+in uint instObject;
+#endif
+#endif
+
+#ifdef DISPLACED
+// the positions of this frame, of the vertex with the same index in the
+// vertex buffer, at CUBE_DISPLACED_SSBO_BINDING
+readonly buffer Displaced {
+	vec4 displacedPositions[];
+};
+#endif
+
+#ifdef TESSELLATED
+// the vertex as it is and the transform to clip space, the tessellation
+// evaluation shader places and wobbles the vertices of the patches
+out vec3 tc_pos;
+out vec4 tc_clr;
+out mat4 tc_transform;
+#else
+out vec4 v_clr;
+#ifdef CUT
+out vec3 v_pos;
+#endif
+#endif
+
+#ifdef FADE
+// the distances the crossfade starts and ends at, see Impostors.h
+uniform vec2 impostorFade;
+out float v_fade;
+#endif
+
+#ifdef PICKING
+flat out uint v_object;
+#endif
+
+#ifdef MOTION
+// the position in this frame without the jitter, and in the previous one:
+// the instance matrix goes between motionCurrent or motionPrevious and the
+// vertex, motionModel after it in the previous frame
+uniform mat4 motionCurrent;
+uniform mat4 motionPrevious;
+uniform mat4 motionModel;
+out vec4 v_current;
+out vec4 v_previous;
+#endif
+
+void main()
+{
+#ifdef PULLED
+	// six vertices per face, the corners of its two triangles as in
+	// basicCubeConnectivity: 0 1 2, 2 1 3
+	int face = gl_VertexID / 6;
+	int corner = (0x312210 >> (4 * (gl_VertexID % 6))) & 3;
+	vec3 pos = faceNormal[face] + faceRight[face] * ((corner & 1) != 0 ? 1.0 : -1.0) +
+		faceUp[face] * ((corner & 2) != 0 ? 1.0 : -1.0);
+	float shade = (corner == 0) ? 1.0 : (corner == 3) ? 128.0 / 255.0 : 192.0 / 255.0;
+	vec4 clr = vec4(faceColor[face] * shade, 1.0);
+#ifdef SPINNING
+	mat4 instModel = spinInstance(gl_InstanceID);
+#else
+	mat4 instModel = instanceModels[gl_InstanceID];
+#endif
+#elif defined(COMPACT)
+	mat4 instModel = unpackInstance(instCompact);
+#endif
+#ifdef TESSELLATED
+	tc_pos = pos;
+	tc_clr = clr;
+#ifdef INSTANCED
+	tc_transform = modelViewProjection * instModel;
+#else
+	tc_transform = modelViewProjection;
+#endif
+#else
+	v_clr = clr;
+#ifdef CUT
+	v_pos = pos;
+#endif
+#ifdef PICKING
+	v_object = instObject;
+#endif
+#ifdef FADE
+	v_fade = clamp((distance(instanceEye.xyz, instModel[3].xyz) - impostorFade.x) /
+		(impostorFade.y - impostorFade.x), 0.0, 1.0);
+#endif
+#ifdef WOBBLE
+	vec3 new_pos = pos * (1.0 + 0.25*sin(pos.x+pos.y+pos.z+5.0*time));
+#elif defined(DISPLACED)
+	vec3 new_pos = displacedPositions[gl_VertexID].xyz;
+#else
+	vec3 new_pos = pos;
+#endif
+#ifdef INSTANCED
+	gl_Position = modelViewProjection * (instModel * vec4(new_pos, 1.0));
+#else
+	gl_Position = modelViewProjection * vec4(new_pos, 1.0);
+#endif
+#ifdef MOTION
+#ifdef INSTANCED
+	v_current = motionCurrent * instModel * vec4(new_pos, 1.0);
+	v_previous = motionPrevious * instModel * motionModel * vec4(new_pos, 1.0);
+#else
+	v_current = motionCurrent * vec4(new_pos, 1.0);
+	v_previous = motionPrevious * motionModel * vec4(new_pos, 1.0);
+#endif
+#endif
+#endif
+}
@@ -0,0 +1,151 @@
+#version 430 core
+
+// GPU frustum culling of the scene, see Scene::cull in Scene.h. One
+// invocation per object tests the bounding sphere against the frustum
+// planes and appends the draw command of a visible object to the output.
+// The atomic counter ends up holding the number of visible objects, it is
+// the draw count of glMultiDrawElementsIndirectCountARB.
+// With occlusion set, objects hidden behind the depth of the previous frame
+// are culled too, using the Hi-Z pyramid of HiZ.h. The pyramid is built from
+// what was actually rendered, so the holes of the "cut" shader's discard
+// are in it and keep the objects behind them visible.
+// A visible object is drawn in the coarsest level of detail of its mesh
+// whose error is below lodScale pixels at its distance, see meshLodSelect
+// in Cube.h.
+// With grid set, the slots of the spatial grid of SpatialGrid.h were
+// tested against the frustum already: the objects of a slot outside are
+// culled, and those of a slot inside are not tested again.
+#include "spatial_grid.glsl"
+
+layout(local_size_x = 64) in;
+
+// see DrawElementsIndirectCommand in Scene.h
+struct DrawCommand {
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+// xyz: center in world space, w: radius
+layout(std430, binding = 0) readonly buffer Spheres {
+	vec4 spheres[];
+};
+layout(std430, binding = 1) readonly buffer Commands {
+	DrawCommand commands[];
+};
+layout(std430, binding = 2) writeonly buffer Visible {
+	DrawCommand visible[];
+};
+layout(binding = 0, offset = 0) uniform atomic_uint visibleCount;
+
+// see MeshLod in Cube.h
+struct Lod {
+	uint firstIndex;
+	uint count;
+	float error;
+	uint pad;
+};
+
+layout(std430, binding = 3) readonly buffer ObjectMeshes {
+	uint objectMeshes[];
+};
+// lodMax levels per mesh, the unused ones have a count of 0
+layout(std430, binding = 4) readonly buffer Lods {
+	Lod lods[];
+};
+const uint lodMax = 8u;	// MESH_LOD_MAX in Cube.h
+
+// SPATIAL_GRID_OBJECT_BINDING and SPATIAL_GRID_STATE_BINDING in SpatialGrid.h
+layout(std430, binding = 5) readonly buffer GridObjects {
+	uvec2 gridObjects[];	// slot and rank
+};
+layout(std430, binding = 6) readonly buffer GridStates {
+	uint gridStates[];
+};
+uniform bool grid;
+
+// the planes of the view frustum in world space, normals point inside
+uniform vec4 planes[6];
+uniform uint objectCount;
+// scales the bounding radii, for shaders which displace the vertices
+uniform float radiusScale;
+uniform vec3 cameraPosition;
+// the pixels of an error at distance 1 over the acceptable error, 0 to
+// always draw the full meshes
+uniform float lodScale;
+
+uniform bool occlusion;
+uniform sampler2D hiz;
+uniform int hizLevels;
+uniform ivec2 hizSize;		// of the depth buffer, level 0 may be padded
+uniform mat4 hizViewProjection;	// of the frame the pyramid was built from
+
+// Returns true if the sphere s is behind the depth in the Hi-Z pyramid.
+bool occluded(vec4 s)
+{
+	// the screen rectangle and the nearest depth of the box around s
+	vec3 lo = vec3(1e30), hi = vec3(-1e30);
+	for (int i = 0; i < 8; i++) {
+		vec3 corner = s.xyz + s.w * vec3(((i & 1) != 0) ? 1.0 : -1.0,
+			((i & 2) != 0) ? 1.0 : -1.0, ((i & 4) != 0) ? 1.0 : -1.0);
+		vec4 c = hizViewProjection * vec4(corner, 1.0);
+		if (c.w <= 0.0)
+			return false;	// reaches behind the camera
+		lo = min(lo, c.xyz / c.w);
+		hi = max(hi, c.xyz / c.w);
+	}
+	if (lo.z < -1.0)
+		return false;	// reaches in front of the near plane
+
+	// the level at which the rectangle covers at most 2x2 texels
+	vec2 size = vec2(hizSize);
+	vec2 r0 = clamp(lo.xy * 0.5 + 0.5, 0.0, 1.0) * size;
+	vec2 r1 = clamp(hi.xy * 0.5 + 0.5, 0.0, 1.0) * size;
+	float extent = max(r1.x - r0.x, r1.y - r0.y);
+	int level = clamp(int(ceil(log2(max(extent, 1.0)))), 0, hizLevels - 1);
+	ivec2 levelSize = textureSize(hiz, level);
+	ivec2 t0 = min(ivec2(r0) >> level, levelSize - ivec2(1));
+	ivec2 t1 = min(ivec2(r1) >> level, levelSize - ivec2(1));
+
+	float far = 0.0;
+	for (int y = t0.y; y <= t1.y; y++)
+		for (int x = t0.x; x <= t1.x; x++)
+			far = max(far, texelFetch(hiz, ivec2(x, y), level).r);
+	return lo.z * 0.5 + 0.5 > far;
+}
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= objectCount)
+		return;
+	bool inside = false;
+	if (grid) {
+		uint state = gridStates[gridObjects[i].x];
+		if (state == SPATIAL_GRID_OUTSIDE)
+			return;
+		inside = state == SPATIAL_GRID_INSIDE;
+	}
+	vec4 s = spheres[i];
+	s.w *= radiusScale;
+	for (int p = 0; p < 6 && !inside; p++) {
+		if (dot(planes[p].xyz, s.xyz) + planes[p].w < -s.w)
+			return;
+	}
+	if (occlusion && occluded(s))
+		return;
+
+	DrawCommand c = commands[i];
+	if (lodScale > 0.0) {
+		uint base = objectMeshes[i] * lodMax;
+		float distance = length(s.xyz - cameraPosition) - s.w;
+		for (uint l = 1u; l < lodMax && lods[base + l].count > 0u &&
+			lods[base + l].error * lodScale <= distance; l++) {
+			c.count = lods[base + l].count;
+			c.firstIndex = lods[base + l].firstIndex;
+		}
+	}
+	visible[atomicCounterIncrement(visibleCount)] = c;
+}
@@ -0,0 +1,17 @@
+#version 150 core
+
+// The lines and points of the debug drawing, see DebugDraw.h. The positions
+// are relative to the origin of the grid.
+uniform mat4 debugViewProjection;
+
+in vec3 pos;
+in vec4 clr;
+
+out vec4 v_color;
+
+void main()
+{
+	v_color = clr;
+	gl_PointSize = 5.0;
+	gl_Position = debugViewProjection * vec4(pos, 1.0);
+}
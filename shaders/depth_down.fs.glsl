@@ -0,0 +1,26 @@
+#version 150 core
+
+// The depth of the scene reduced to the size of the effects of
+// HalfResEffects.h: each texel covers factor x factor pixels and takes
+// the nearest of their depths on the black squares of a checkerboard and
+// the farthest on the white ones, so both sides of an edge stay in the
+// reduced depth for the bilateral upsample to match.
+uniform sampler2D depth;	// of the scene
+uniform int factor;		// 2 or 4
+
+out vec4 color;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	ivec2 size = textureSize(depth, 0) - 1;
+	bool nearest = ((texel.x + texel.y) & 1) == 0;
+	float d = nearest ? 1.0 : 0.0;
+	for (int y = 0; y < factor; y++) {
+		for (int x = 0; x < factor; x++) {
+			float s = texelFetch(depth, min(texel * factor + ivec2(x, y), size), 0).r;
+			d = nearest ? min(d, s) : max(d, s);
+		}
+	}
+	color = vec4(d, 0.0, 0.0, 1.0);
+}
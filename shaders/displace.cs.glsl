@@ -0,0 +1,35 @@
+#version 430 core
+
+// Wobbles the vertices of the cube once per frame for Displacement.h, a
+// thread per vertex: the vertex is read from a copy of the cube's vertex
+// buffer, in either vertex format of Cube.h, moved as shaders/cube.vs.glsl
+// does with WOBBLE and written as a vec4, which all passes then read by
+// gl_VertexID (cube.vs.glsl with DISPLACED).
+#define GROUP 64	// DISPLACE_GROUP in Displacement.h
+
+layout(local_size_x = GROUP) in;
+
+// the vertices as they are, counts.y words each
+layout(std430, binding = 0) readonly buffer Rest {
+	uint rest[];
+};
+layout(std430, binding = 1) writeonly buffer Positions {
+	vec4 positions[];
+};
+
+uniform uvec4 counts;	// vertices, words per vertex, half float positions
+uniform float seconds;	// the time of the frame
+
+void main()
+{
+	uint v = gl_GlobalInvocationID.x;
+	if (v >= counts.x)
+		return;
+	uint i = v * counts.y;
+	vec3 pos;
+	if (counts.z != 0u)
+		pos = vec3(unpackHalf2x16(rest[i]), unpackHalf2x16(rest[i + 1u]).x);
+	else
+		pos = uintBitsToFloat(uvec3(rest[i], rest[i + 1u], rest[i + 2u]));
+	positions[v] = vec4(pos * (1.0 + 0.25*sin(pos.x+pos.y+pos.z+5.0*seconds)), 1.0);
+}
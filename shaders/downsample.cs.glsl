@@ -0,0 +1,223 @@
+#version 430 core
+
+// The single-pass downsampler of MipDownsampler.h, after AMD's SPD: one
+// dispatch writes up to 8 (WIDE: 12) levels of a mip chain. Every work
+// group takes a tile of 64x64 texels of the source and reduces it in shared
+// memory to a single texel, writing the 6 levels on the way; the last group
+// to get there, found with an atomic counter, then takes the texels of all
+// groups through the remaining levels, so nothing waits for a second
+// dispatch. MIN and MAX keep the nearest and farthest value, as the Hi-Z
+// pyramid needs, otherwise the texels are averaged. COPY first copies the
+// source (the depth buffer) into mip0 and reduces it from there.
+// The tiles halve exactly and texels beyond the source repeat its edge, so
+// an odd level of a tile drops its last row or column; the levels of the
+// last group cover it like shaders/hiz.cs.glsl. Must match MipDownsampler.h.
+#define GROUP 256
+#define TILE_LEVELS 6
+
+layout(local_size_x = GROUP) in;
+
+#if defined(FORMAT_R32F)
+#define FORMAT r32f
+#elif defined(FORMAT_R11F_G11F_B10F)
+#define FORMAT r11f_g11f_b10f
+#else
+#define FORMAT rgba8
+#endif
+#ifdef COPY
+#define FIRST 1		// the image of the first reduced level
+#else
+#define FIRST 0
+#endif
+
+uniform sampler2D source;
+uniform int sourceLevel;
+uniform ivec2 sourceSize;	// of sourceLevel
+uniform int levels;		// images to write, mip0 on
+
+layout(std430, binding = 0) coherent buffer MipCounter {
+	uint groupsDone;	// reset by the last group
+};
+
+layout(FORMAT, binding = 0) coherent uniform image2D mip0;
+layout(FORMAT, binding = 1) coherent uniform image2D mip1;
+layout(FORMAT, binding = 2) coherent uniform image2D mip2;
+layout(FORMAT, binding = 3) coherent uniform image2D mip3;
+layout(FORMAT, binding = 4) coherent uniform image2D mip4;
+layout(FORMAT, binding = 5) coherent uniform image2D mip5;
+layout(FORMAT, binding = 6) coherent uniform image2D mip6;
+layout(FORMAT, binding = 7) coherent uniform image2D mip7;
+#ifdef WIDE
+layout(FORMAT, binding = 8) coherent uniform image2D mip8;
+layout(FORMAT, binding = 9) coherent uniform image2D mip9;
+layout(FORMAT, binding = 10) coherent uniform image2D mip10;
+layout(FORMAT, binding = 11) coherent uniform image2D mip11;
+#endif
+
+shared vec4 tile[32 * 32];	// the level being reduced, row by row
+shared bool lastGroup;
+
+// arrays of images may only be indexed by constants before GLSL 4.50
+void store(int i, ivec2 p, vec4 v)
+{
+	switch (i) {
+	case 0: imageStore(mip0, p, v); break;
+	case 1: imageStore(mip1, p, v); break;
+	case 2: imageStore(mip2, p, v); break;
+	case 3: imageStore(mip3, p, v); break;
+	case 4: imageStore(mip4, p, v); break;
+	case 5: imageStore(mip5, p, v); break;
+	case 6: imageStore(mip6, p, v); break;
+	case 7: imageStore(mip7, p, v); break;
+#ifdef WIDE
+	case 8: imageStore(mip8, p, v); break;
+	case 9: imageStore(mip9, p, v); break;
+	case 10: imageStore(mip10, p, v); break;
+	case 11: imageStore(mip11, p, v); break;
+#endif
+	}
+}
+
+vec4 load(int i, ivec2 p)
+{
+	switch (i) {
+	case 0: return imageLoad(mip0, p);
+	case 1: return imageLoad(mip1, p);
+	case 2: return imageLoad(mip2, p);
+	case 3: return imageLoad(mip3, p);
+	case 4: return imageLoad(mip4, p);
+	case 5: return imageLoad(mip5, p);
+	case 6: return imageLoad(mip6, p);
+	case 7: return imageLoad(mip7, p);
+#ifdef WIDE
+	case 8: return imageLoad(mip8, p);
+	case 9: return imageLoad(mip9, p);
+	case 10: return imageLoad(mip10, p);
+#endif
+	}
+	return vec4(0.0);
+}
+
+ivec2 size(int i)
+{
+	switch (i) {
+	case 0: return imageSize(mip0);
+	case 1: return imageSize(mip1);
+	case 2: return imageSize(mip2);
+	case 3: return imageSize(mip3);
+	case 4: return imageSize(mip4);
+	case 5: return imageSize(mip5);
+	case 6: return imageSize(mip6);
+	case 7: return imageSize(mip7);
+#ifdef WIDE
+	case 8: return imageSize(mip8);
+	case 9: return imageSize(mip9);
+	case 10: return imageSize(mip10);
+	case 11: return imageSize(mip11);
+#endif
+	}
+	return ivec2(0);
+}
+
+vec4 combine(vec4 a, vec4 b)
+{
+#if defined(MIN)
+	return min(a, b);
+#elif defined(MAX)
+	return max(a, b);
+#else
+	return a + b;
+#endif
+}
+
+vec4 reduce(vec4 a, vec4 b, vec4 c, vec4 d)
+{
+	vec4 v = combine(combine(a, b), combine(c, d));
+#if !defined(MIN) && !defined(MAX)
+	v *= 0.25;
+#endif
+	return v;
+}
+
+vec4 fetch(ivec2 p)
+{
+	vec4 v = texelFetch(source, clamp(p, ivec2(0), sourceSize - ivec2(1)), sourceLevel);
+#ifdef COPY
+	store(0, p, v);
+#endif
+	return v;
+}
+
+vec4 tileAt(ivec2 q)
+{
+	return tile[q.y * 32 + q.x];
+}
+
+void main()
+{
+	int t = int(gl_LocalInvocationIndex);
+	ivec2 group = ivec2(gl_WorkGroupID.xy);
+	int k, n;
+
+	// the first level of the tile, 2x2 texels of the source for each of
+	// the 4 texels of a thread
+	for (int b = 0; b < 2; b++)
+		for (int a = 0; a < 2; a++) {
+			ivec2 q = ivec2(t & 15, t >> 4) + 16 * ivec2(a, b);
+			ivec2 p = 2 * (32 * group + q);
+			vec4 v = reduce(fetch(p), fetch(p + ivec2(1, 0)), fetch(p + ivec2(0, 1)), fetch(p + ivec2(1, 1)));
+			store(FIRST, 32 * group + q, v);
+			tile[q.y * 32 + q.x] = v;
+		}
+	barrier();
+
+	// the others, each from the one before, down to a single texel
+	for (k = 1, n = 16; k < TILE_LEVELS && FIRST + k < levels; k++, n >>= 1) {
+		ivec2 q = ivec2(t % n, t / n);
+		bool active = t < n * n;
+		vec4 v = vec4(0.0);
+		if (active)
+			v = reduce(tileAt(2 * q), tileAt(2 * q + ivec2(1, 0)), tileAt(2 * q + ivec2(0, 1)),
+				tileAt(2 * q + ivec2(1, 1)));
+		barrier();
+		if (active) {
+			tile[q.y * 32 + q.x] = v;
+			store(FIRST + k, n * group + q, v);
+		}
+		barrier();
+	}
+	if (FIRST + TILE_LEVELS >= levels)
+		return;
+
+	// the last group to finish its tile has all texels of the level
+	memoryBarrierImage();
+	barrier();
+	if (t == 0)
+		lastGroup = atomicAdd(groupsDone, 1u) == gl_NumWorkGroups.x * gl_NumWorkGroups.y - 1u;
+	barrier();
+	if (!lastGroup)
+		return;
+	if (t == 0)
+		groupsDone = 0u;
+	for (k = FIRST + TILE_LEVELS; k < levels; k++) {
+		ivec2 src = size(k - 1);
+		ivec2 dst = size(k);
+		for (int i = t; i < dst.x * dst.y; i += GROUP) {
+			ivec2 p = ivec2(i % dst.x, i / dst.x);
+			ivec2 first = 2 * p;
+			ivec2 last = first + ivec2(1) + ivec2(equal(p, dst - ivec2(1))) * (src & ivec2(1));
+			last = min(last, src - ivec2(1));
+			vec4 v = load(k - 1, first);
+			for (int y = first.y; y <= last.y; y++)
+				for (int x = first.x; x <= last.x; x++)
+					if (x != first.x || y != first.y)
+						v = combine(v, load(k - 1, ivec2(x, y)));
+#if !defined(MIN) && !defined(MAX)
+			v /= float((last.x - first.x + 1) * (last.y - first.y + 1));
+#endif
+			store(k, p, v);
+		}
+		memoryBarrierImage();
+		barrier();
+	}
+}
@@ -0,0 +1,51 @@
+#version 430 core
+
+// The auto exposure of PostProcess.h, a single work group after
+// shaders/histogram.cs.glsl: the mean log2 luminance of the pixels which
+// are not black gives the exposure which maps it to KEY, which the adapted
+// exposure approaches by adaptation of the way each frame. The bins are
+// cleared for the next frame on the way.
+#define BINS 64
+#define LOG_MIN -10.0
+#define LOG_RANGE 22.0
+#define KEY 0.18
+#define EXPOSURE_MIN 0.25
+#define EXPOSURE_MAX 4.0
+
+layout(local_size_x = BINS) in;
+
+layout(std430, binding = 0) buffer Histogram {
+	uint bins[BINS];
+};
+layout(r32f, binding = 0) uniform image2D adapted;
+uniform float adaptation;	// 1 - e^(-rate * seconds since the last frame)
+
+shared float weighted[BINS];
+shared float counts[BINS];
+
+void main()
+{
+	uint i = gl_LocalInvocationIndex;
+	float n = (i == 0u) ? 0.0 : float(bins[i]);
+	bins[i] = 0u;
+	counts[i] = n;
+	weighted[i] = n * float(i);
+	barrier();
+
+	for (uint s = uint(BINS) / 2u; s > 0u; s >>= 1u) {
+		if (i < s) {
+			counts[i] += counts[i + s];
+			weighted[i] += weighted[i + s];
+		}
+		barrier();
+	}
+
+	if (i == 0u && counts[0] > 0.0) {
+		// the bin centers are at (b - 0.5) / (BINS - 2) of the range
+		float bin = weighted[0] / counts[0];
+		float logLuminance = LOG_MIN + (bin - 0.5) / float(BINS - 2) * LOG_RANGE;
+		float target = clamp(KEY / exp2(logLuminance), EXPOSURE_MIN, EXPOSURE_MAX);
+		float exposure = imageLoad(adapted, ivec2(0)).r;
+		imageStore(adapted, ivec2(0), vec4(exposure + (target - exposure) * adaptation));
+	}
+}
@@ -0,0 +1,78 @@
+#version 150 core
+
+// Height fog, an effect of HalfResEffects.h computed at a reduced size:
+// the ray of each texel is marched from the camera to the reduced depth
+// through fog whose density falls off exponentially with the height and
+// drifts with a value noise. Each step scatters the ambient light and the
+// sun, with a forward lobe, towards the camera and takes away some of what
+// is behind it. The distances are in units of the far plane, so the fog
+// looks the same however large the scene is. The steps start at an offset
+// per texel, which the upsample and the temporal anti-aliasing smooth.
+uniform sampler2D depth;	// the reduced depth
+uniform mat4 clipToWorld;
+uniform vec3 eye;
+uniform vec3 sun;		// towards the sun in world space
+uniform vec2 depthRange;	// near and far plane
+uniform float seconds;
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+#define STEPS 24
+#define DENSITY 3.0		// extinction at the base height, per far plane distance
+#define FALLOFF 8.0		// of the density with the height, per far plane distance
+#define BASE_HEIGHT -0.05	// in far plane distances
+#define NOISE_SCALE 20.0	// features per far plane distance
+#define ANISOTROPY 0.6		// of the Henyey-Greenstein phase function
+#define AMBIENT vec3(0.45, 0.5, 0.6)
+#define SUNLIGHT vec3(1.0, 0.85, 0.6)
+
+float hash(vec3 p)
+{
+	p = fract(p * 0.3183099 + 0.1);
+	p *= 17.0;
+	return fract(p.x * p.y * p.z * (p.x + p.y + p.z));
+}
+
+float noise(vec3 p)
+{
+	vec3 i = floor(p);
+	vec3 f = p - i;
+	f = f * f * (3.0 - 2.0 * f);
+	return mix(mix(mix(hash(i), hash(i + vec3(1, 0, 0)), f.x),
+			mix(hash(i + vec3(0, 1, 0)), hash(i + vec3(1, 1, 0)), f.x), f.y),
+		mix(mix(hash(i + vec3(0, 0, 1)), hash(i + vec3(1, 0, 1)), f.x),
+			mix(hash(i + vec3(0, 1, 1)), hash(i + vec3(1, 1, 1)), f.x), f.y), f.z);
+}
+
+void main()
+{
+	float d = texelFetch(depth, ivec2(gl_FragCoord.xy), 0).r;
+	vec4 p = clipToWorld * vec4(v_ndc, 2.0 * d - 1.0, 1.0);
+	vec3 ray = p.xyz / p.w - eye;
+	float far = depthRange.y;
+	float span = min(length(ray), far);
+	vec3 dir = normalize(ray);
+
+	float mu = dot(dir, sun);
+	float g2 = ANISOTROPY * ANISOTROPY;
+	float phase = (1.0 - g2) / (4.0 * 3.14159265 * pow(1.0 + g2 - 2.0 * ANISOTROPY * mu, 1.5));
+	vec3 light = AMBIENT * 0.25 + SUNLIGHT * phase * max(sun.y, 0.0);
+
+	// interleaved gradient noise
+	float offset = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+	float dt = span / float(STEPS);
+	vec3 drift = vec3(0.3, 0.0, 0.1) * seconds;
+	vec3 inscatter = vec3(0.0);
+	float transmittance = 1.0;
+	for (int i = 0; i < STEPS; i++) {
+		vec3 x = (eye + dir * (float(i) + offset) * dt) / far;
+		float density = DENSITY / far * exp(-FALLOFF * (x.y - BASE_HEIGHT)) *
+			(0.5 + noise(x * NOISE_SCALE + drift));
+		float extinction = exp(-density * dt);
+		inscatter += transmittance * (1.0 - extinction) * light;
+		transmittance *= extinction;
+	}
+	color = vec4(inscatter, transmittance);
+}
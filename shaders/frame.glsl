@@ -0,0 +1,41 @@
+// shared per-frame state, see FrameUniforms in BaseApplication.h
+// this file is included by the vertex shaders, see SHADER INCLUDES in
+// ShaderHelpers.h
+// A specialized program has some of the values baked in as constants,
+// HOT_<name> replaces the member of the block then, see
+// UniformSpecializer.h
+layout(std140) uniform Frame {
+	mat4 projection;
+	mat4 modelView;
+	vec4 cameraPosition;
+	float time;
+	uint frameIndex;		// counts the frames
+	uint lightCount;		// of ClusteredLights.h, 0 without lighting
+	float cutRadius;		// of the sphere the CUT programs cut out of the cube
+	mat4 viewProjection;		// without the model transform
+	mat4 viewProjectionInverse;
+	// the sun and its shadows, see ShadowMaps.h
+	mat4 shadowMatrices[4];		// SHADOW_CASCADES, view space to the maps
+	vec4 shadowSplits;		// the far view depth of each cascade
+	vec4 shadowTexels;		// a texel of each cascade in world units
+	vec4 sunDirection;		// towards the sun in view space, w: 1 with shadows, 0 without the sun
+	vec4 instanceBox;		// of the packed instances: xyz the lowest corner, w the step
+	vec4 instanceEye;		// the camera in the space of the instance matrices
+	mat4 modelViewProjection;	// projection * modelView, multiplied once on the CPU
+};
+
+#ifdef HOT_projection
+#define projection HOT_projection
+#endif
+#ifdef HOT_modelView
+#define modelView HOT_modelView
+#endif
+#ifdef HOT_modelViewProjection
+#define modelViewProjection HOT_modelViewProjection
+#endif
+#ifdef HOT_lightCount
+#define lightCount HOT_lightCount
+#endif
+#ifdef HOT_cutRadius
+#define cutRadius HOT_cutRadius
+#endif
@@ -0,0 +1,49 @@
+#version 150 core
+
+// Fast approximate anti-aliasing after the tonemapping, see PostProcess.h.
+// The luminance of the diagonal neighbours gives the direction along the
+// edge through the pixel, and the pixel is blurred along it, over up to
+// SPAN_MAX texels for flat edges. If the wider blur takes in colors from
+// outside of the range the neighbours show, it crossed another edge, and
+// the narrower one is used.
+#define REDUCE_MIN (1.0 / 128.0)
+#define REDUCE_MUL (1.0 / 8.0)
+#define SPAN_MAX 8.0
+
+uniform sampler2D source;
+uniform vec2 sourceSize;	// in texels
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+float luma(vec3 c)
+{
+	return dot(c, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	vec2 texel = 1.0 / sourceSize;
+	vec3 m = texture(source, uv).rgb;
+	float lumaM = luma(m);
+	float lumaNW = luma(texture(source, uv + vec2(-1.0, -1.0) * texel).rgb);
+	float lumaNE = luma(texture(source, uv + vec2(1.0, -1.0) * texel).rgb);
+	float lumaSW = luma(texture(source, uv + vec2(-1.0, 1.0) * texel).rgb);
+	float lumaSE = luma(texture(source, uv + vec2(1.0, 1.0) * texel).rgb);
+	float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+	vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+	float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+	float scale = 1.0 / (min(abs(dir.x), abs(dir.y)) + reduce);
+	dir = clamp(dir * scale, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texel;
+
+	vec3 narrow = 0.5 * (texture(source, uv + dir * (1.0 / 3.0 - 0.5)).rgb +
+		texture(source, uv + dir * (2.0 / 3.0 - 0.5)).rgb);
+	vec3 wide = 0.5 * narrow + 0.25 * (texture(source, uv - dir * 0.5).rgb +
+		texture(source, uv + dir * 0.5).rgb);
+	float lumaWide = luma(wide);
+	color = vec4((lumaWide < lumaMin || lumaWide > lumaMax) ? narrow : wide, 1.0);
+}
@@ -0,0 +1,84 @@
+#version 430 core
+
+// Propagates the world matrices of GpuSceneGraph in GpuSceneGraph.h, a
+// dispatch per level of the tree and a thread per node of the level: a
+// node whose local transform was written in this version, or whose parent
+// was computed in it, gets the world matrix of its parent times its local
+// one, which the node with a draw also writes as the model matrix of that
+// draw, and as the center of its bounding sphere for the culling pass.
+#define GROUP 64	// GPU_SCENE_GRAPH_GROUP in GpuSceneGraph.h
+
+layout(local_size_x = GROUP) in;
+
+// GpuSceneNode
+struct Local {
+	vec4 translation;	// w: the version it was written in, as the bits of a uint
+	vec4 rotation;		// quaternion x, y, z, w
+	vec4 scale;
+};
+
+layout(std430, binding = 0) readonly buffer Locals {
+	Local locals[];
+};
+layout(std430, binding = 1) readonly buffer Parents {
+	int parents[];
+};
+layout(std430, binding = 2) readonly buffer Draws {
+	int draws[];
+};
+layout(std430, binding = 3) buffer Worlds {
+	mat4 worlds[];
+};
+// the version each node was last computed in
+layout(std430, binding = 4) buffer Changed {
+	uint changed[];
+};
+// the instance attributes of the draws
+layout(std430, binding = 5) writeonly buffer Models {
+	mat4 models[];
+};
+// the bounding spheres of the draws, the radius is kept
+layout(std430, binding = 6) buffer Spheres {
+	vec4 spheres[];
+};
+
+uniform uint first;	// the first node of the level
+uniform uint count;	// nodes of this dispatch
+uniform uint version;	// of this update
+uniform bool writeSpheres;
+
+// as glm::mat3_cast
+mat3 rotationMatrix(vec4 q)
+{
+	vec3 q2 = q.xyz * 2.0;
+	vec3 d = q.xyz * q2;	// xx, yy, zz
+	float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+	vec3 w = q.w * q2;
+	return mat3(1.0 - d.y - d.z, xy + w.z, xz - w.y,
+		xy - w.z, 1.0 - d.x - d.z, yz + w.x,
+		xz + w.y, yz - w.x, 1.0 - d.x - d.y);
+}
+
+void main()
+{
+	if (gl_GlobalInvocationID.x >= count)
+		return;
+	uint i = first + gl_GlobalInvocationID.x;
+	Local l = locals[i];
+	int p = parents[i];
+	if (floatBitsToUint(l.translation.w) != version && (p < 0 || changed[p] != version))
+		return;
+	changed[i] = version;
+	mat3 r = rotationMatrix(l.rotation);
+	mat4 m = mat4(vec4(r[0] * l.scale.x, 0.0), vec4(r[1] * l.scale.y, 0.0), vec4(r[2] * l.scale.z, 0.0),
+		vec4(l.translation.xyz, 1.0));
+	if (p >= 0)
+		m = worlds[p] * m;
+	worlds[i] = m;
+	int d = draws[i];
+	if (d >= 0) {
+		models[d] = m;
+		if (writeSpheres)
+			spheres[d].xyz = m[3].xyz;
+	}
+}
@@ -0,0 +1,42 @@
+#version 430 core
+
+// The luminance histogram of the auto exposure, see PostProcess.h, from the
+// first level of the mip chain of the bloom, which is linear and a quarter
+// of the pixels. Each work group counts its pixels into bins in shared
+// memory first, so the bins in the buffer only see one atomic add per bin
+// and group. Bin 0 holds the black pixels, the others the log2 luminance
+// from LOG_MIN over LOG_RANGE. Must match shaders/exposure.cs.glsl.
+#define GROUP 16
+#define BINS 64
+#define LOG_MIN -10.0
+#define LOG_RANGE 22.0
+
+layout(local_size_x = GROUP, local_size_y = GROUP) in;
+
+layout(std430, binding = 0) buffer Histogram {
+	uint bins[BINS];
+};
+uniform sampler2D source;
+
+shared uint groupBins[BINS];
+
+void main()
+{
+	uint i = gl_LocalInvocationIndex;
+	if (i < uint(BINS))
+		groupBins[i] = 0u;
+	barrier();
+
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	if (all(lessThan(p, textureSize(source, 0)))) {
+		float l = dot(texelFetch(source, p, 0).rgb, vec3(0.2126, 0.7152, 0.0722));
+		uint bin = 0u;
+		if (l > 1e-5)
+			bin = uint(clamp((log2(l) - LOG_MIN) / LOG_RANGE, 0.0, 1.0) * float(BINS - 2)) + 1u;
+		atomicAdd(groupBins[bin], 1u);
+	}
+	barrier();
+
+	if (i < uint(BINS) && groupBins[i] != 0u)
+		atomicAdd(bins[i], groupBins[i]);
+}
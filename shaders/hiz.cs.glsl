@@ -0,0 +1,35 @@
+#version 430 core
+
+// Builds one level of the Hi-Z pyramid, see HiZ.h. Level 0 is a copy of
+// the depth buffer, every other texel is the farthest depth of the texels
+// it covers in the level below, so culling against it is conservative.
+// With an odd size, the last texel of a row or column also covers the
+// extra texel that a plain 2x2 reduction would lose.
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D depthBuffer;	// the source of level 0
+layout(r32f, binding = 0) readonly uniform image2D src;
+layout(r32f, binding = 1) writeonly uniform image2D dst;
+uniform bool fromDepth;
+uniform ivec2 srcSize;
+uniform ivec2 dstSize;
+
+void main()
+{
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(p, dstSize)))
+		return;
+	if (fromDepth) {
+		imageStore(dst, p, vec4(texelFetch(depthBuffer, p, 0).r));
+		return;
+	}
+	ivec2 first = 2 * p;
+	ivec2 last = first + ivec2(1) + ivec2(equal(p, dstSize - ivec2(1))) * (srcSize & ivec2(1));
+	last = min(last, srcSize - ivec2(1));
+	float d = 0.0;
+	for (int y = first.y; y <= last.y; y++)
+		for (int x = first.x; x <= last.x; x++)
+			d = max(d, imageLoad(src, ivec2(x, y)).r);
+	imageStore(dst, p, vec4(d));
+}
@@ -0,0 +1,21 @@
+#version 150 core
+
+// The billboards of Impostors.h, see shaders/impostor.vs.glsl: the texels
+// outside of the mesh are dropped, and so are the pixels the instances
+// still cover in the crossfade.
+#include "impostor.glsl"
+
+uniform sampler2D impostorAtlas;
+
+in vec2 v_uv;
+in float v_fade;
+
+out vec4 color;
+
+void main()
+{
+	vec4 texel = texture(impostorAtlas, v_uv);
+	if (texel.a < 0.5 || impostorDither(gl_FragCoord.xy) >= v_fade)
+		discard;
+	color = vec4(texel.rgb, 1.0);
+}
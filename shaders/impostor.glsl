@@ -0,0 +1,45 @@
+// the octahedral impostor atlas of Impostors.h, shared by the pass which
+// bakes it, the billboards which show it and the instances which fade out
+// where the billboards fade in. The atlas holds IMPOSTOR_VIEWS x
+// IMPOSTOR_VIEWS views of the mesh, each from the direction of the center
+// of its cell in the octahedral map of the sphere around the mesh, looking
+// at the origin with an orthographic projection of its bounding sphere.
+
+// IMPOSTOR_VIEWS in Impostors.h
+#define IMPOSTOR_VIEWS 8
+
+// The direction of the view in cell, from the model's origin towards the
+// viewer; the octahedron is folded out along y. As the views are even, no
+// cell is centered on a pole, so y is never parallel to a direction.
+vec3 impostorDirection(vec2 cell)
+{
+	vec2 p = (cell + 0.5) * (2.0 / float(IMPOSTOR_VIEWS)) - 1.0;
+	vec3 d = vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+	if (d.y < 0.0)
+		d.xz = (1.0 - abs(d.zx)) * vec2(d.x >= 0.0 ? 1.0 : -1.0, d.z >= 0.0 ? 1.0 : -1.0);
+	return normalize(d);
+}
+
+// the cell whose view is closest to direction d
+vec2 impostorCell(vec3 d)
+{
+	d /= abs(d.x) + abs(d.y) + abs(d.z);
+	vec2 p = d.xz;
+	if (d.y < 0.0)
+		p = (1.0 - abs(p.yx)) * vec2(p.x >= 0.0 ? 1.0 : -1.0, p.y >= 0.0 ? 1.0 : -1.0);
+	return clamp(floor((p * 0.5 + 0.5) * float(IMPOSTOR_VIEWS)), 0.0, float(IMPOSTOR_VIEWS - 1));
+}
+
+// the right and up axes of the image of the view from direction d
+void impostorBasis(vec3 d, out vec3 right, out vec3 up)
+{
+	right = normalize(cross(vec3(0.0, 1.0, 0.0), d));
+	up = cross(d, right);
+}
+
+// a threshold per pixel in [0, 1) for the crossfade, interleaved gradient
+// noise: where the instances keep a pixel, the billboards drop it
+float impostorDither(vec2 fragCoord)
+{
+	return fract(52.9829189 * fract(dot(fragCoord, vec2(0.06711056, 0.00583715))));
+}
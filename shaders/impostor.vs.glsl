@@ -0,0 +1,35 @@
+#version 150 core
+
+// The billboards of Impostors.h, without any vertex attributes: the four
+// corners of a triangle strip come from the bits of gl_VertexID. Each
+// instance shows the view of the atlas closest to the direction of the
+// camera in the model space of the instance, on a square through its
+// origin across that direction, which the model matrix turns like the
+// mesh, so the image lines up with it. The billboards fade in from
+// impostorFade.x to impostorFade.y, the distances of the crossfade.
+#include "frame.glsl"
+#include "impostor.glsl"
+
+in mat4 instModel;
+
+uniform vec2 impostorFade;
+uniform float impostorRadius;	// of the bounding sphere of the mesh
+
+out vec2 v_uv;
+out float v_fade;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	vec3 center = instModel[3].xyz;
+	// the model matrix is a rotation and a uniform scale, the transpose
+	// only scales the direction
+	vec2 cell = impostorCell(transpose(mat3(instModel)) * (instanceEye.xyz - center));
+	vec3 right, up;
+	impostorBasis(impostorDirection(cell), right, up);
+	vec3 p = (corner.x * right + corner.y * up) * impostorRadius;
+	gl_Position = modelViewProjection * (instModel * vec4(p, 1.0));
+	v_uv = (cell + corner * 0.5 + 0.5) / float(IMPOSTOR_VIEWS);
+	v_fade = clamp((distance(instanceEye.xyz, center) - impostorFade.x) / (impostorFade.y - impostorFade.x),
+		0.0, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 150 core
+
+// Bakes a view of the impostor atlas of Impostors.h: the mesh as seen from
+// the direction of bakeCell, projected orthographically onto the square
+// around its bounding sphere of radius bakeRadius; the fragment shader is
+// shaders/cube.fs.glsl.
+#include "impostor.glsl"
+
+in vec3 pos;
+in vec4 clr;
+
+uniform vec2 bakeCell;
+uniform float bakeRadius;
+
+out vec4 v_clr;
+
+void main()
+{
+	vec3 d = impostorDirection(bakeCell), right, up;
+	impostorBasis(d, right, up);
+	v_clr = clr;
+	// the nearest point of the sphere at depth -1
+	gl_Position = vec4(dot(pos, right), dot(pos, up), -dot(pos, d), bakeRadius);
+}
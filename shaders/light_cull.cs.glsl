@@ -0,0 +1,88 @@
+#version 430 core
+
+// Assigns the lights of ClusteredLights.h to the clusters of the view
+// frustum, a thread per cluster: screen tiles, each split into slices
+// which get exponentially deeper, so a cluster is about as deep as it is
+// wide. Each thread bounds its cluster by a box in view space and tests
+// every light's sphere against it, the lights loaded by the group into
+// shared memory a batch at a time. It counts the lights first, reserves
+// that many entries of the index list at once, then writes them, so the
+// lists of all clusters are packed one after the other.
+#define LIGHTS_CULL
+#include "lights.glsl"
+
+#define GROUP 64	// LIGHT_CULL_GROUP in ClusteredLights.h
+
+layout(local_size_x = GROUP) in;
+
+uniform mat4 projectionInverse;
+uniform vec2 viewport;	// pixels
+
+shared vec4 batch[GROUP];
+
+// The point of the near plane at ndc, in view space.
+vec3 unproject(vec2 ndc)
+{
+	vec4 p = projectionInverse * vec4(ndc, -1.0, 1.0);
+	return p.xyz / p.w;
+}
+
+// Whether the sphere s touches the box lo hi.
+bool touches(vec4 s, vec3 lo, vec3 hi)
+{
+	vec3 d = max(max(lo - s.xyz, s.xyz - hi), 0.0);
+	return dot(d, d) <= s.w * s.w;
+}
+
+// The lights touching the box lo hi, written from first on, as long as
+// there are fewer than limit. Returns how many there are, all threads of
+// the group take part.
+uint assign(bool active, vec3 lo, vec3 hi, uint first, uint limit)
+{
+	uint local = gl_LocalInvocationID.x, n = 0u;
+	for (uint base = 0u; base < lightGrid.w; base += uint(GROUP)) {
+		uint l = base + local;
+		batch[local] = (l < lightGrid.w) ? lights[l].position : vec4(0.0, 0.0, 0.0, -1.0);
+		barrier();
+		for (uint k = 0u; active && k < uint(GROUP) && base + k < lightGrid.w; k++) {
+			if (touches(batch[k], lo, hi)) {
+				if (n < limit)
+					lightIndices[first + n] = base + k;
+				n++;
+			}
+		}
+		barrier();
+	}
+	return n;
+}
+
+void main()
+{
+	uint c = gl_GlobalInvocationID.x;
+	bool active = c < uint(LIGHT_CLUSTER_COUNT);
+	uvec3 g = lightGrid.xyz;
+	uvec3 cell = uvec3(c % g.x, (c / g.x) % g.y, c / (g.x * g.y));
+
+	// the depths of the slice, inverting the slice of lightsShade()
+	float near = exp((float(cell.z) - lightSlices.w) / lightSlices.z);
+	float far = exp((float(cell.z + 1u) - lightSlices.w) / lightSlices.z);
+	vec2 ndc0 = vec2(cell.xy) * lightSlices.xy / viewport * 2.0 - 1.0;
+	vec2 ndc1 = min(vec2(cell.xy + 1u) * lightSlices.xy / viewport * 2.0 - 1.0, vec2(1.0));
+
+	// the box around the corners of the tile at both depths
+	vec3 lo = vec3(1e30), hi = vec3(-1e30);
+	for (int i = 0; i < 4; i++) {
+		vec3 d = unproject(vec2((i & 1) != 0 ? ndc1.x : ndc0.x, (i & 2) != 0 ? ndc1.y : ndc0.y));
+		vec3 p0 = d * (near / -d.z), p1 = d * (far / -d.z);
+		lo = min(lo, min(p0, p1));
+		hi = max(hi, max(p0, p1));
+	}
+
+	uint n = assign(active, lo, hi, 0u, 0u);
+	uint first = (active && n > 0u) ? atomicAdd(lightIndexCount.x, n) : 0u;
+	// what is left of the index list, if it overflows
+	uint limit = (first < lightIndexCount.y) ? min(n, lightIndexCount.y - first) : 0u;
+	assign(active && limit > 0u, lo, hi, first, limit);
+	if (active)
+		lightClusters[c] = uvec2(first, limit);
+}
@@ -0,0 +1,98 @@
+// the point lights of ClusteredLights.h, shared by the pass which assigns
+// them to the clusters of the view frustum (light_cull.cs.glsl) and the
+// fragment shaders which are lit by them, which only loop over the lights
+// of the cluster they are in; and the sun with the shadows of ShadowMaps.h
+#include "frame.glsl"
+
+// as in ClusteredLights.h
+#define LIGHT_MAX 1024
+#define LIGHT_CLUSTER_COUNT (16 * 9 * 24)
+#define LIGHT_AMBIENT 0.35
+#define LIGHT_SUN 0.65	// of ShadowMaps.h, with the ambient part up to 1
+
+// GpuLight in ClusteredLights.h
+struct Light {
+	vec4 position;	// view space, w: radius
+	vec4 color;	// rgb, a unused
+};
+
+// The lights need storage buffers, which the programs before GL 4.3 only
+// have with the extension enabled. The culling pass defines LIGHTS_CULL,
+// which declares them writable and leaves out the shading, as a compute
+// shader has no derivatives.
+#if __VERSION__ >= 430 || defined(GL_ARB_shader_storage_buffer_object)
+#define LIGHTS_SUPPORTED
+#ifdef LIGHTS_CULL
+#define LIGHTS_ACCESS
+#else
+#define LIGHTS_ACCESS readonly
+#endif
+
+// LIGHT_SSBO_BINDING
+layout(std430) LIGHTS_ACCESS buffer Lights {
+	uvec4 lightGrid;	// clusters in x, y and z, lights
+	vec4 lightSlices;	// pixels per cluster in x and y, scale and bias of a slice in log(depth)
+	uvec4 lightIndexCount;	// used, capacity
+	Light lights[LIGHT_MAX];
+	uvec2 lightClusters[LIGHT_CLUSTER_COUNT];	// first index and count
+	uint lightIndices[];
+};
+#endif
+
+#ifndef LIGHTS_CULL
+// the cascades of the sun, see ShadowMaps.h
+uniform sampler2DArrayShadow shadowMap;	// SHADOW_TEXTURE_UNIT
+
+// How much of the sun reaches the surface at p in view space with the
+// normal n, from the cascade p is in, four filtered taps around it. The
+// point is moved off the surface by about a texel against acne.
+float lightsSunShadow(vec3 p, vec3 n)
+{
+	int c = 0;
+	while (c < 3 && -p.z > shadowSplits[c])
+		c++;
+	if (-p.z > shadowSplits[3])
+		return 1.0;
+	vec4 s = shadowMatrices[c] * vec4(p + n * (1.5 * shadowTexels[c]), 1.0);
+	vec2 texel = 0.5 / vec2(textureSize(shadowMap, 0).xy);
+	float lit = texture(shadowMap, vec4(s.xy + vec2(-texel.x, -texel.y), float(c), s.z));
+	lit += texture(shadowMap, vec4(s.xy + vec2(texel.x, -texel.y), float(c), s.z));
+	lit += texture(shadowMap, vec4(s.xy + vec2(-texel.x, texel.y), float(c), s.z));
+	lit += texture(shadowMap, vec4(s.xy + vec2(texel.x, texel.y), float(c), s.z));
+	return 0.25 * lit;
+}
+
+// The light falling onto the surface at p in view space, at the pixel
+// fragCoord, including the ambient part: 1 without lights and without the
+// sun, so a color stays as it was.
+vec3 lightsShade(vec3 p, vec2 fragCoord)
+{
+	bool sun = sunDirection.w > 0.0;
+	if (lightCount == 0u && !sun)
+		return vec3(1.0);
+
+	// the face normal, towards the camera
+	vec3 n = normalize(cross(dFdx(p), dFdy(p)));
+	if (dot(n, p) > 0.0)
+		n = -n;
+
+	vec3 sum = vec3(LIGHT_AMBIENT);
+	if (sun)
+		sum += vec3(LIGHT_SUN) * (max(dot(n, sunDirection.xyz), 0.0) * lightsSunShadow(p, n));
+#ifdef LIGHTS_SUPPORTED
+	if (lightCount > 0u) {
+		float slice = log(max(-p.z, 1e-6)) * lightSlices.z + lightSlices.w;
+		uvec3 c = min(uvec3(uvec2(fragCoord / lightSlices.xy), uint(max(slice, 0.0))), lightGrid.xyz - 1u);
+		uvec2 range = lightClusters[c.x + lightGrid.x * (c.y + lightGrid.y * c.z)];
+		for (uint k = 0u; k < range.y; k++) {
+			Light l = lights[lightIndices[range.x + k]];
+			vec3 d = l.position.xyz - p;
+			float distance = length(d);
+			float falloff = clamp(1.0 - distance / l.position.w, 0.0, 1.0);
+			sum += l.color.rgb * (max(dot(n, d / max(distance, 1e-6)), 0.0) * falloff * falloff);
+		}
+	}
+#endif
+	return sum;
+}
+#endif
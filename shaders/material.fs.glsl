@@ -0,0 +1,33 @@
+#version 150 core
+#extension GL_ARB_shader_storage_buffer_object : enable
+
+// The materials without bindless textures: all textures are layers of one
+// array texture, the materials are in a uniform block. The lights need
+// storage buffers, which are there where the extension is.
+#include "material.glsl"
+#include "lights.glsl"
+
+layout(std140) uniform Materials {
+	Material materials[MATERIAL_MAX];
+};
+uniform sampler2DArray materialTextures;
+
+in vec4 v_clr;
+in vec3 v_pos;
+in vec3 v_view;
+flat in uint v_material;
+
+out vec4 color;
+
+void main()
+{
+#ifdef DEPTH_ONLY
+	// the depth pre-pass, see RenderQueue.h
+	color = vec4(0.0);
+#else
+	Material m = materials[v_material];
+	vec4 texel = texture(materialTextures, vec3(materialTexCoord(v_pos), float(m.layer)));
+	color = texel * m.tint * (0.5 + 0.5 * v_clr);
+	color.rgb *= lightsShade(v_view, gl_FragCoord.xy);
+#endif
+}
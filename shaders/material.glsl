@@ -0,0 +1,20 @@
+// shared by the material fragment shaders, see Materials.h
+
+#define MATERIAL_MAX 64	// as in Materials.h
+
+// GpuMaterial in Materials.h
+struct Material {
+	uvec2 handle;	// bindless texture handle
+	uint layer;	// array texture layer
+	uint pad;
+	vec4 tint;
+};
+
+// Texture coordinates of a box mapping: the object space position,
+// projected along the axis the surface faces most.
+vec2 materialTexCoord(vec3 pos)
+{
+	vec3 n = abs(cross(dFdx(pos), dFdy(pos)));
+	vec2 uv = (n.x > n.y && n.x > n.z) ? pos.yz : ((n.y > n.z) ? pos.xz : pos.xy);
+	return 0.5 * uv + 0.5;
+}
@@ -0,0 +1,35 @@
+#version 150 core
+
+// Shades each object with its material, see Materials.h and the fragment
+// shaders material.fs.glsl and material_bindless.fs.glsl.
+// INSTANCED: per-instance model matrix
+#include "frame.glsl"
+
+// the depth pre-pass variant must compute the same depth, see RenderQueue.h
+invariant gl_Position;
+
+in vec3 pos;
+in vec4 clr;
+#ifdef INSTANCED
+in mat4 instModel;
+#endif
+in uint instMaterial;
+
+out vec4 v_clr;
+out vec3 v_pos;
+out vec3 v_view;	// the position in view space, for the lights
+flat out uint v_material;
+
+void main()
+{
+	v_clr = clr;
+	v_pos = pos;
+	v_material = instMaterial;
+#ifdef INSTANCED
+	vec4 view = modelView * instModel * vec4(pos, 1.0);
+#else
+	vec4 view = modelView * vec4(pos, 1.0);
+#endif
+	v_view = view.xyz;
+	gl_Position = projection * view;
+}
@@ -0,0 +1,33 @@
+#version 430 core
+#extension GL_ARB_bindless_texture : require
+
+// The materials with bindless textures: each material holds the handle of
+// its texture, the materials are in a shader storage buffer, so their
+// number is not limited by the size of a uniform block. The objects are
+// lit by the lights of their cluster, see shaders/lights.glsl.
+#include "material.glsl"
+#include "lights.glsl"
+
+layout(std430, binding = 3) readonly buffer Materials {	// MATERIAL_SSBO_BINDING
+	Material materials[];
+};
+
+in vec4 v_clr;
+in vec3 v_pos;
+in vec3 v_view;
+flat in uint v_material;
+
+out vec4 color;
+
+void main()
+{
+#ifdef DEPTH_ONLY
+	// the depth pre-pass, see RenderQueue.h
+	color = vec4(0.0);
+#else
+	Material m = materials[v_material];
+	vec4 texel = texture(sampler2D(m.handle), materialTexCoord(v_pos));
+	color = texel * m.tint * (0.5 + 0.5 * v_clr);
+	color.rgb *= lightsShade(v_view, gl_FragCoord.xy);
+#endif
+}
@@ -0,0 +1,72 @@
+#version 430 core
+
+// GPU culling of the meshlets of a mesh, see MeshletCuller in Meshlets.h.
+// One invocation per meshlet tests its bounding sphere against the frustum
+// and its normal cone against the camera, and appends the draw command of
+// the index range of a visible meshlet to the output. Everything is in the
+// space of the mesh. The atomic counter ends up holding the number of
+// visible meshlets, it is the draw count of
+// glMultiDrawElementsIndirectCountARB.
+
+layout(local_size_x = 64) in;
+
+// see MeshFileMeshlet in MeshFile.h
+struct Meshlet {
+	vec4 sphere;	// xyz: center, w: radius
+	vec4 cone;	// xyz: axis, w: cutoff, 1 for none
+	uvec4 range;	// x: first index, y: index count
+};
+
+// see DrawElementsIndirectCommand in Scene.h
+struct DrawCommand {
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Meshlets {
+	Meshlet meshlets[];
+};
+layout(std430, binding = 1) writeonly buffer Visible {
+	DrawCommand visible[];
+};
+layout(binding = 0, offset = 0) uniform atomic_uint visibleCount;
+
+// the planes of the view frustum, normals point inside
+uniform vec4 planes[6];
+uniform vec3 cameraPosition;
+uniform uint meshletCount;
+// scales the bounding radii, for shaders which displace the vertices
+uniform float radiusScale;
+// test the cones, only if back faces are culled
+uniform bool cones;
+// the first index of the mesh in the index buffer
+uniform uint indexBase;
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= meshletCount)
+		return;
+	Meshlet m = meshlets[i];
+	vec4 s = vec4(m.sphere.xyz, m.sphere.w * radiusScale);
+	for (int p = 0; p < 6; p++) {
+		if (dot(planes[p].xyz, s.xyz) + planes[p].w < -s.w)
+			return;
+	}
+	// all triangles face away if the camera looks at the sphere from
+	// within the cone around the axis
+	vec3 v = s.xyz - cameraPosition;
+	if (cones && m.cone.w < 1.0 && dot(v, m.cone.xyz) >= m.cone.w * length(v) + s.w)
+		return;
+
+	DrawCommand c;
+	c.count = m.range.y;
+	c.instanceCount = 1u;
+	c.firstIndex = indexBase + m.range.x;
+	c.baseVertex = 0;
+	c.baseInstance = 0u;
+	visible[atomicCounterIncrement(visibleCount)] = c;
+}
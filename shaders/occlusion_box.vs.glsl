@@ -0,0 +1,15 @@
+#version 150 core
+
+// The box around a bounding sphere of OcclusionQueries.h, without any
+// vertex attributes: the 14 vertices of a triangle strip over the faces of
+// the unit cube come from the bits of gl_VertexID. Only its depth matters,
+// the fragment shader is shaders/minimal.fs.glsl with color writes off.
+uniform vec4 box;		// center and radius of the sphere
+uniform mat4 boxViewProjection;
+
+void main()
+{
+	int b = 1 << gl_VertexID;
+	vec3 corner = vec3((0x287a & b) != 0, (0x02af & b) != 0, (0x31e3 & b) != 0);
+	gl_Position = boxViewProjection * vec4(box.xyz + box.w * (2.0 * corner - 1.0), 1.0);
+}
@@ -0,0 +1,41 @@
+// The output of the translucent programs, see Transparency.h. Without
+// OIT_LIST, this is weighted blended order-independent transparency (after
+// McGuire and Bavoil): each fragment adds its premultiplied color, weighted
+// to favor the near ones, to the accumulation in "color", and multiplies
+// its transparency into the revealage, both by fixed blending, so the
+// order of the fragments does not matter. The composite divides the sum
+// by the summed weights.
+// With OIT_LIST, every fragment is appended to a linked list of its pixel
+// instead, which the composite sorts by depth: exact, as long as the node
+// pool does not run out. The depth test runs before the shader, so the
+// fragments hidden by opaque geometry take no node.
+#ifdef OIT_LIST
+layout(early_fragment_tests) in;
+
+layout(r32ui) coherent uniform uimage2D oitHeads;	// the first node of each pixel
+layout(rgba32ui) writeonly uniform uimageBuffer oitNodes;	// color, depth, next
+layout(r32ui) coherent uniform uimageBuffer oitCounter;	// [0] nodes taken, [1] nodes there are
+
+void oitWrite(vec4 c)
+{
+	uint node = imageAtomicAdd(oitCounter, 0, 1u);
+	if (node >= imageLoad(oitCounter, 1).r)
+		return;
+	uvec4 q = uvec4(clamp(c, 0.0, 1.0) * 255.0 + 0.5);
+	uint next = imageAtomicExchange(oitHeads, ivec2(gl_FragCoord.xy), node);
+	imageStore(oitNodes, int(node), uvec4(q.r | (q.g << 8) | (q.b << 16) | (q.a << 24),
+		uint(gl_FragCoord.z * 16777215.0), next, 0u));
+}
+#else
+out vec4 color;
+out float revealage;
+
+void oitWrite(vec4 c)
+{
+	// the depth weight of the paper for the window depth, the clamp
+	// keeps the sums in the range of half floats
+	float w = clamp(c.a * 3e3 * pow(1.0 - gl_FragCoord.z, 3.0), 1e-2, 3e3);
+	color = vec4(c.rgb * c.a, c.a) * w;
+	revealage = c.a;
+}
+#endif
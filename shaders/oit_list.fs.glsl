@@ -0,0 +1,58 @@
+#version 150 core
+#extension GL_ARB_shader_image_load_store : require
+
+// Composites the per-pixel lists of translucent fragments over the scene,
+// see Transparency.h and shaders/oit.glsl. The fragments of a pixel are
+// sorted by depth and blended front to back; with more than OIT_LIST_MAX of
+// them, the farthest ones are dropped. The result is premultiplied, and is
+// blended with (1, 1 - alpha).
+#define OIT_LIST_MAX 16
+#define OIT_LIST_END 0xffffffffu
+
+layout(r32ui) uniform uimage2D oitHeads;
+layout(rgba32ui) readonly uniform uimageBuffer oitNodes;
+
+out vec4 color;
+
+void main()
+{
+	uvec2 frags[OIT_LIST_MAX];	// color, depth
+	int i, j, n = 0;
+	uint node = imageLoad(oitHeads, ivec2(gl_FragCoord.xy)).r;
+
+	if (node == OIT_LIST_END)
+		discard;
+	while (node != OIT_LIST_END) {
+		uvec4 v = imageLoad(oitNodes, int(node));
+		if (n < OIT_LIST_MAX) {
+			frags[n++] = v.xy;
+		} else {
+			// replace the farthest one if this is nearer
+			int far = 0;
+			for (i = 1; i < n; i++)
+				if (frags[i].y > frags[far].y)
+					far = i;
+			if (v.y < frags[far].y)
+				frags[far] = v.xy;
+		}
+		node = v.z;
+	}
+
+	// insertion sort, near to far
+	for (i = 1; i < n; i++) {
+		uvec2 f = frags[i];
+		for (j = i - 1; j >= 0 && frags[j].y > f.y; j--)
+			frags[j + 1] = frags[j];
+		frags[j + 1] = f;
+	}
+
+	vec3 c = vec3(0.0);
+	float transmittance = 1.0;
+	for (i = 0; i < n; i++) {
+		uint p = frags[i].x;
+		vec4 f = vec4(uvec4(p, p >> 8, p >> 16, p >> 24) & 0xffu) / 255.0;
+		c += transmittance * f.a * f.rgb;
+		transmittance *= 1.0 - f.a;
+	}
+	color = vec4(c, 1.0 - transmittance);
+}
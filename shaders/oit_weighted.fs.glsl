@@ -0,0 +1,21 @@
+#version 150 core
+
+// Composites the weighted blended translucent fragments over the scene,
+// see Transparency.h and shaders/oit.glsl. This is blended with
+// (1 - alpha, alpha): the weighted average of their colors covers the
+// scene by one minus the product of their transparencies.
+uniform sampler2D oitAccum;
+uniform sampler2D oitRevealage;
+
+out vec4 color;
+
+void main()
+{
+	ivec2 p = ivec2(gl_FragCoord.xy);
+	float revealage = texelFetch(oitRevealage, p, 0).r;
+	// no translucent fragment, leave the scene alone
+	if (revealage >= 1.0)
+		discard;
+	vec4 accum = texelFetch(oitAccum, p, 0);
+	color = vec4(accum.rgb / max(accum.a, 1e-5), revealage);
+}
@@ -1,10 +1,10 @@
-#version 150 core
-
-in vec4 v_clr;
-
-out vec4 color;
-
-void main()
-{
-	color = v_clr;
-}
+#version 150 core
+
+in vec4 v_color;
+
+out vec4 color;
+
+void main()
+{
+	color = v_color;
+}
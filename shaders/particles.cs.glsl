@@ -0,0 +1,152 @@
+#version 430 core
+
+// Emits and moves the particles of GpuParticles in Particles.h, a stage
+// per dispatch. The particles live in the arrays of their positions and
+// velocities; which of them are free is the dead list, a stack of their
+// indices, which are alive the alive list. Each frame:
+//   begin:    how many to emit, at most as many as are dead, and the
+//             groups to emit them with
+//   emit:     pop the dead, start them at the emitter, push them alive
+//   args:     the groups to move all that are alive now with
+//   simulate: move them, push those still alive to the next alive list
+//             with the key to sort them back to front by, the others dead
+//   end:      the arguments of the draw, an instance per alive particle
+// The dispatches after begin and args are indirect, so the CPU never needs
+// to know how many are alive.
+#define GROUP 256	// PARTICLE_GROUP in Particles.h
+
+// the stages, as in Particles.h
+#define STAGE_BEGIN 0
+#define STAGE_EMIT 1
+#define STAGE_ARGS 2
+#define STAGE_SIMULATE 3
+#define STAGE_END 4
+
+layout(local_size_x = GROUP) in;
+
+// ParticleCounters in Particles.h
+layout(std430, binding = 0) buffer Counters {
+	uint deadCount;
+	uint aliveCount[2];
+	uint emitCount;
+	uvec4 emitArgs;		// glDispatchComputeIndirect, w unused
+	uvec4 simulateArgs;
+	uvec4 drawArgs;		// glDrawArraysIndirect: 6 vertices, an instance each
+};
+// xyz, w: the part of its life left, from 1 down to 0
+layout(std430, binding = 1) buffer Positions {
+	vec4 positions[];
+};
+// xyz, w: the part of its life a second takes
+layout(std430, binding = 2) buffer Velocities {
+	vec4 velocities[];
+};
+layout(std430, binding = 3) buffer Dead {
+	uint dead[];
+};
+// alive at the start of the frame, aliveCount[current]
+layout(std430, binding = 4) buffer Alive {
+	uint alive[];
+};
+// alive at the end of it, aliveCount[1 - current]
+layout(std430, binding = 5) writeonly buffer NextAlive {
+	uint nextAlive[];
+};
+// the sort keys of nextAlive
+layout(std430, binding = 6) writeonly buffer Keys {
+	uint keys[];
+};
+
+uniform int stage;
+uniform int current;	// which of aliveCount is for alive
+uniform uint emitRequest;	// particles to emit this frame
+uniform uint seed;		// of the random numbers of this frame
+uniform float dt;		// seconds since the last frame
+uniform vec4 emitter;		// xyz: the position of the fountain, w: its size
+uniform vec4 eye;		// xyz: the camera, w: how far it sees
+
+uint hash(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+// a random number in [0, 1)
+float random(inout uint state)
+{
+	state = hash(state);
+	return float(state >> 8) / 16777216.0;
+}
+
+// a particle shot up from the fountain, to the side a little
+void emit(uint i)
+{
+	uint index = dead[atomicAdd(deadCount, 0xffffffffu) - 1u];
+	uint state = seed ^ hash(i);
+	float scale = emitter.w;
+	float angle = 6.2831853 * random(state), spread = 0.35 * random(state);
+	float speed = scale * (1.2 + 0.4 * random(state));
+	vec3 jitter = vec3(random(state), random(state), random(state)) - 0.5;
+
+	positions[index] = vec4(emitter.xyz + 0.05 * scale * jitter, 1.0);
+	velocities[index] = vec4(speed * vec3(spread * cos(angle), 1.0, spread * sin(angle)),
+		1.0 / (2.0 + 2.0 * random(state)));
+	alive[atomicAdd(aliveCount[current], 1u)] = index;
+}
+
+// gravity, drag and a bouncy floor below the fountain
+void simulate(uint i)
+{
+	uint index = alive[i];
+	vec4 p = positions[index], v = velocities[index];
+	float scale = emitter.w, floorY = emitter.y - scale;
+
+	v.y -= scale * dt;
+	v.xyz *= 1.0 - 0.1 * dt;
+	p.xyz += v.xyz * dt;
+	if (p.y < floorY) {
+		p.y = floorY;
+		v.y = -0.5 * v.y;
+		v.xz *= 0.8;
+	}
+	p.w -= v.w * dt;
+	positions[index] = p;
+	velocities[index] = v;
+	if (p.w > 0.0) {
+		// the far ones first: the keys go down with the distance
+		uint slot = atomicAdd(aliveCount[1 - current], 1u);
+		float depth = clamp(length(p.xyz - eye.xyz) / eye.w, 0.0, 1.0);
+		nextAlive[slot] = index;
+		keys[slot] = 65535u - uint(depth * 65535.0);
+	} else {
+		dead[atomicAdd(deadCount, 1u)] = index;
+	}
+}
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+
+	if (stage == STAGE_BEGIN) {
+		if (i == 0u) {
+			emitCount = min(emitRequest, deadCount);
+			emitArgs = uvec4((emitCount + uint(GROUP - 1)) / uint(GROUP), 1u, 1u, 0u);
+			aliveCount[1 - current] = 0u;
+		}
+	} else if (stage == STAGE_EMIT) {
+		if (i < emitCount)
+			emit(i);
+	} else if (stage == STAGE_ARGS) {
+		if (i == 0u)
+			simulateArgs = uvec4((aliveCount[current] + uint(GROUP - 1)) / uint(GROUP), 1u, 1u, 0u);
+	} else if (stage == STAGE_SIMULATE) {
+		if (i < aliveCount[current])
+			simulate(i);
+	} else if (i == 0u) {
+		drawArgs = uvec4(6u, aliveCount[1 - current], 0u, 0u);
+	}
+}
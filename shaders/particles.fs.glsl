@@ -0,0 +1,15 @@
+#version 150 core
+
+// a round spot, soft towards the edge, blended with the alpha
+in vec4 v_clr;
+in vec2 v_uv;
+
+out vec4 color;
+
+void main()
+{
+	float r = dot(v_uv, v_uv);
+	if (r > 1.0)
+		discard;
+	color = vec4(v_clr.rgb, v_clr.a * (1.0 - r));
+}
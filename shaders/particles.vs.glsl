@@ -0,0 +1,40 @@
+#version 150 core
+#extension GL_ARB_shader_storage_buffer_object : require
+
+// The particles of Particles.h as quads facing the camera, an instance of
+// 6 vertices each and no vertex attributes: the instances are the alive
+// list, sorted back to front, and the vertex index picks the corner.
+#include "frame.glsl"
+
+// at PARTICLE_POSITION_BINDING, xyz, w: the part of its life left
+readonly buffer ParticlePositions {
+	vec4 particlePositions[];
+};
+// at PARTICLE_ORDER_BINDING, the alive particles in the order to draw
+readonly buffer ParticleOrder {
+	uint particleOrder[];
+};
+
+uniform float particleSize;
+
+out vec4 v_clr;
+out vec2 v_uv;
+
+void main()
+{
+	vec4 p = particlePositions[particleOrder[gl_InstanceID]];
+	// the corners of the two triangles as in basicCubeConnectivity
+	int corner = (0x312210 >> (4 * gl_VertexID)) & 3;
+	v_uv = vec2((corner & 1) != 0 ? 1.0 : -1.0, (corner & 2) != 0 ? 1.0 : -1.0);
+
+	// hot when new, cooling and fading towards the end
+	float life = p.w;
+	v_clr = vec4(mix(vec3(0.8, 0.15, 0.05), vec3(1.0, 0.85, 0.4), life), life);
+
+	vec3 toCamera = normalize(cameraPosition.xyz - p.xyz);
+	vec3 right = cross(vec3(0.0, 1.0, 0.0), toCamera);
+	right = (dot(right, right) > 1e-6) ? normalize(right) : vec3(1.0, 0.0, 0.0);
+	vec3 up = cross(toCamera, right);
+	float size = particleSize * (0.5 + 0.5 * life);
+	gl_Position = viewProjection * vec4(p.xyz + size * (v_uv.x * right + v_uv.y * up), 1.0);
+}
@@ -0,0 +1,331 @@
+#version 430 core
+
+// The parallel primitives of GpuPrimitives in GpuPrimitives.h, a stage per
+// dispatch. The scan and the compaction take a single pass over the items:
+// each group takes the next tile in the order the groups start, sums it,
+// and finds the sum of the tiles before it by the decoupled look-back of
+// Merrill and Garland, reading the states the earlier tiles published.
+// The radix sort counts the digits of all passes in one histogram pass
+// (onesweep, Adinets and Merrill), and then each pass of 4 bits sorts each
+// tile by the digit in shared memory and scatters it, with a look-back per
+// digit for where the digits of the tiles before it end.
+#define GROUP 256	// GPU_PRIMITIVES_GROUP in GpuPrimitives.h
+#define ITEMS 4		// GPU_PRIMITIVES_ITEMS, per thread of the scans and reductions
+#define TILE (GROUP * ITEMS)
+#define RADIX 16	// GPU_PRIMITIVES_RADIX, the digits of 4 bits
+#define PASSES 8	// of a sort of 32 bits
+
+// the stages, as in GpuPrimitives.h
+#define STAGE_SCAN 0
+#define STAGE_COMPACT 1
+#define STAGE_REDUCE 2
+#define STAGE_HISTOGRAM 3
+#define STAGE_OFFSETS 4
+#define STAGE_SCATTER 5
+
+// the operations of the reduction
+#define REDUCE_ADD 0
+#define REDUCE_MIN 1
+#define REDUCE_MAX 2
+
+// the state of a tile in the look-back: its sum alone, or with the sums of
+// all tiles before it, in the low 30 bits; 0 if it is not known yet
+#define STATE_AGGREGATE 0x40000000u
+#define STATE_PREFIX 0x80000000u
+#define STATE_VALUE 0x3fffffffu
+
+layout(local_size_x = GROUP) in;
+
+// the items, the keys of a sort pass
+layout(std430, binding = 0) readonly buffer Input {
+	uint inputs[];
+};
+// the sums, the kept items, the sorted keys
+layout(std430, binding = 1) writeonly buffer Output {
+	uint outputs[];
+};
+// the next tile, then the states of the tiles, RADIX per tile in a sort
+layout(std430, binding = 2) coherent buffer States {
+	uint states[];
+};
+// which items the compaction keeps
+layout(std430, binding = 3) readonly buffer Flags {
+	uint flags[];
+};
+// the values going with the keys of a sort pass
+layout(std430, binding = 4) readonly buffer Values {
+	uint values[];
+};
+layout(std430, binding = 5) writeonly buffer SortedValues {
+	uint sortedValues[];
+};
+// the total of a scan or a compaction, the reduction, the digit counts
+// and then offsets of the passes of a sort
+layout(std430, binding = 6) buffer Result {
+	uint result[];
+};
+// the number of keys of a sort, if only the GPU knows it
+layout(std430, binding = 7) readonly buffer Counts {
+	uint counts[];
+};
+
+uniform int stage;
+uniform int count;	// items, or how many there are at most
+uniform int countIndex;	// of the number of keys in counts, -1 for count
+uniform int op;		// REDUCE_*
+uniform int pass;	// of a sort, its digit is at 4 * pass
+uniform int passes;
+uniform bool hasValues;
+
+shared uint scan[2][GROUP];
+shared uint groupTotal;
+shared uint tileIndex;
+shared uint tilePrefix;
+shared uint digitCounts[RADIX];
+shared uint digitStarts[RADIX];
+shared uint digitPrefix[RADIX];
+shared uint tileKeys[GROUP];
+shared uint tileValues[GROUP];
+shared uint histogram[PASSES * RADIX];
+
+// the number of items
+int items;
+
+// The sum of the values of the threads of the group before this one, and
+// the sum of all of them in groupTotal.
+uint groupExclusiveSum(uint value)
+{
+	uint local = gl_LocalInvocationID.x;
+	int from = 0;
+	scan[0][local] = value;
+	barrier();
+	// Hillis and Steele, between two halves of the shared memory
+	for (uint offset = 1u; offset < uint(GROUP); offset <<= 1) {
+		uint sum = scan[from][local];
+		if (local >= offset)
+			sum += scan[from][local - offset];
+		scan[1 - from][local] = sum;
+		from = 1 - from;
+		barrier();
+	}
+	uint sum = scan[from][local];
+	if (local == uint(GROUP - 1))
+		groupTotal = sum;
+	barrier();
+	return sum - value;
+}
+
+// The next tile in the order the groups start: the tiles a group waits for
+// in the look-back are running or done, whatever order the GPU runs the
+// groups in.
+uint nextTile()
+{
+	if (gl_LocalInvocationID.x == 0u)
+		tileIndex = atomicAdd(states[0], 1u);
+	barrier();
+	return tileIndex;
+}
+
+// Publish aggregate, the sum of lane of tile, and return the sum of lane
+// of all tiles before it: walk back over the tiles which only published
+// their own sums until one has its prefix.
+uint lookBack(uint tile, uint lanes, uint lane, uint aggregate)
+{
+	uint at = 1u + tile * lanes + lane;
+	if (tile == 0u) {
+		atomicExchange(states[at], STATE_PREFIX | aggregate);
+		return 0u;
+	}
+	atomicExchange(states[at], STATE_AGGREGATE | aggregate);
+	uint prefix = 0u;
+	uint before = at - lanes;
+	for (;;) {
+		uint state = atomicOr(states[before], 0u);
+		if (state == 0u)
+			continue;
+		prefix += state & STATE_VALUE;
+		if ((state & STATE_PREFIX) != 0u)
+			break;
+		before -= lanes;
+	}
+	atomicExchange(states[at], STATE_PREFIX | (prefix + aggregate));
+	return prefix;
+}
+
+// the exclusive sums of the items, or the items whose flags are set
+// packed to the front, in a single pass
+void scanTile()
+{
+	uint local = gl_LocalInvocationID.x, tile = nextTile();
+	uint base = tile * uint(TILE) + local * uint(ITEMS);
+	uint v[ITEMS], sum = 0u;
+	int k;
+
+	for (k = 0; k < ITEMS; k++) {
+		uint i = base + uint(k), x = 0u;
+		if (i < uint(items))
+			x = (stage == STAGE_COMPACT) ? uint(flags[i] != 0u) : inputs[i];
+		v[k] = x;
+		sum += x;
+	}
+	uint at = groupExclusiveSum(sum);
+	if (local == 0u)
+		tilePrefix = lookBack(tile, 1u, 0u, groupTotal);
+	barrier();
+	at += tilePrefix;
+	for (k = 0; k < ITEMS; k++) {
+		uint i = base + uint(k);
+		if (i >= uint(items))
+			break;
+		if (stage == STAGE_SCAN)
+			outputs[i] = at;
+		else if (v[k] != 0u)
+			outputs[at] = inputs[i];
+		at += v[k];
+	}
+	// the last tile knows the total
+	if (tile == uint((items - 1) / TILE) && local == uint(GROUP - 1))
+		result[0] = at;
+}
+
+uint reduceOp(uint a, uint b)
+{
+	return (op == REDUCE_ADD) ? a + b : (op == REDUCE_MIN) ? min(a, b) : max(a, b);
+}
+
+// the items of a tile combined in a tree, and into the result
+void reduceTile()
+{
+	uint local = gl_LocalInvocationID.x;
+	uint base = gl_WorkGroupID.x * uint(TILE) + local * uint(ITEMS);
+	uint value = (op == REDUCE_MIN) ? 0xffffffffu : 0u;
+	int k;
+
+	for (k = 0; k < ITEMS; k++) {
+		uint i = base + uint(k);
+		if (i < uint(items))
+			value = reduceOp(value, inputs[i]);
+	}
+	scan[0][local] = value;
+	barrier();
+	for (uint stride = uint(GROUP / 2); stride > 0u; stride >>= 1) {
+		if (local < stride)
+			scan[0][local] = reduceOp(scan[0][local], scan[0][local + stride]);
+		barrier();
+	}
+	if (local == 0u) {
+		if (op == REDUCE_ADD)
+			atomicAdd(result[0], scan[0][0]);
+		else if (op == REDUCE_MIN)
+			atomicMin(result[0], scan[0][0]);
+		else
+			atomicMax(result[0], scan[0][0]);
+	}
+}
+
+// the counts of the digits of all passes, of a tile in shared memory first
+void histogramTile()
+{
+	uint local = gl_LocalInvocationID.x;
+	uint base = gl_WorkGroupID.x * uint(TILE) + local * uint(ITEMS);
+	uint i;
+	int k, p;
+
+	for (i = local; i < uint(PASSES * RADIX); i += uint(GROUP))
+		histogram[i] = 0u;
+	barrier();
+	for (k = 0; k < ITEMS; k++) {
+		if (base + uint(k) >= uint(items))
+			break;
+		uint key = inputs[base + uint(k)];
+		for (p = 0; p < passes; p++)
+			atomicAdd(histogram[p * RADIX + int((key >> uint(4 * p)) & uint(RADIX - 1))], 1u);
+	}
+	barrier();
+	for (i = local; i < uint(passes * RADIX); i += uint(GROUP))
+		if (histogram[i] != 0u)
+			atomicAdd(result[i], histogram[i]);
+}
+
+// one pass of the sort: the keys of a tile sorted by the digit, stable,
+// and each digit to its place
+void scatterTile()
+{
+	uint local = gl_LocalInvocationID.x, tile = nextTile();
+	uint i = tile * uint(GROUP) + local;
+	// the groups are for as many keys as there may be
+	if (i - local >= uint(items))
+		return;
+	uint valid = min(uint(items) - tile * uint(GROUP), uint(GROUP));
+	uint shift = uint(4 * pass);
+	// the rest of the last tile goes behind all keys of the tile
+	uint key = 0xffffffffu, value = 0u;
+	int b;
+
+	if (i < uint(items)) {
+		key = inputs[i];
+		if (hasValues)
+			value = values[i];
+	}
+	if (local < uint(RADIX))
+		digitCounts[local] = 0u;
+	barrier();
+	if (local < valid)
+		atomicAdd(digitCounts[(key >> shift) & uint(RADIX - 1)], 1u);
+
+	// a split by each bit of the digit, from the lowest
+	for (b = 0; b < 4; b++) {
+		uint bit = (key >> (shift + uint(b))) & 1u;
+		uint zeros = groupExclusiveSum(1u - bit);
+		uint slot = (bit == 0u) ? zeros : groupTotal + local - zeros;
+		tileKeys[slot] = key;
+		tileValues[slot] = value;
+		barrier();
+		key = tileKeys[local];
+		value = tileValues[local];
+		barrier();
+	}
+
+	if (local == 0u) {
+		uint start = 0u;
+		for (b = 0; b < RADIX; b++) {
+			digitStarts[b] = start;
+			start += digitCounts[b];
+		}
+	}
+	if (local < uint(RADIX))
+		digitPrefix[local] = lookBack(tile, uint(RADIX), local, digitCounts[local]);
+	barrier();
+	if (local < valid) {
+		uint digit = (key >> shift) & uint(RADIX - 1);
+		uint at = result[pass * RADIX + int(digit)] + digitPrefix[digit] + local - digitStarts[digit];
+		outputs[at] = key;
+		if (hasValues)
+			sortedValues[at] = value;
+	}
+}
+
+void main()
+{
+	items = (countIndex >= 0) ? int(counts[countIndex]) : count;
+	if (stage == STAGE_SCAN || stage == STAGE_COMPACT) {
+		scanTile();
+	} else if (stage == STAGE_REDUCE) {
+		reduceTile();
+	} else if (stage == STAGE_HISTOGRAM) {
+		histogramTile();
+	} else if (stage == STAGE_OFFSETS) {
+		// the counts of each pass become where its digits start
+		uint local = gl_LocalInvocationID.x;
+		if (local < uint(passes)) {
+			uint start = 0u;
+			for (int d = 0; d < RADIX; d++) {
+				uint n = result[local * uint(RADIX) + uint(d)];
+				result[local * uint(RADIX) + uint(d)] = start;
+				start += n;
+			}
+		}
+	} else {
+		scatterTile();
+	}
+}
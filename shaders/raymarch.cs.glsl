@@ -0,0 +1,97 @@
+#version 430 core
+
+// The compute version of the raymarching program, see SdfCompute.h. A work
+// group marches the 64 rays of a tile of 8x8 pixels, and stays resident:
+// when it is done with a tile, it takes the next one from the queue, until
+// there are none left, so groups with cheap tiles do more of them.
+// The rays march in chunks of MARCH_CHUNK steps. After each chunk, the
+// group counts in shared memory how many of its rays still march, and the
+// whole group moves on once none does, i.e. all of them hit or missed, so
+// no lanes idle in a tile nobody marches any more. Only the hits are
+// stored, the target was cleared to misses.
+#include "frame.glsl"
+#include "sdf_march.glsl"
+
+#define TILE 8
+#define MARCH_CHUNK 16
+
+layout(local_size_x = TILE, local_size_y = TILE) in;
+
+layout(rgba8, binding = 0) writeonly uniform image2D marchColor;
+layout(r32f, binding = 1) writeonly uniform image2D marchDepth;
+layout(std430, binding = 0) buffer SdfTileQueue {
+	uint nextTile;
+};
+uniform sampler2D sdfConeDistances;
+uniform ivec2 viewportSize;
+
+shared uint tile;
+shared uint marching[3];	// rays still marching, a slot per chunk
+
+void main()
+{
+	ivec2 tiles = (viewportSize + TILE - 1) / TILE;
+	uint tileCount = uint(tiles.x * tiles.y);
+	bool first = gl_LocalInvocationIndex == 0u;
+
+	for (;;) {
+		if (first) {
+			tile = atomicAdd(nextTile, 1u);
+			marching[0] = marching[1] = marching[2] = 0u;
+		}
+		barrier();
+		if (tile >= tileCount)
+			break;
+
+		ivec2 pixel = ivec2(int(tile) % tiles.x, int(tile) / tiles.x) * TILE + ivec2(gl_LocalInvocationID.xy);
+		vec2 ndc = (vec2(pixel) + 0.5) / vec2(viewportSize) * 2.0 - 1.0;
+		vec4 nearPoint = viewProjectionInverse * vec4(ndc, -1.0, 1.0);
+		vec4 farPoint = viewProjectionInverse * vec4(ndc, 1.0, 1.0);
+		vec3 origin = cameraPosition.xyz;
+		vec3 dir = normalize(farPoint.xyz / farPoint.w - nearPoint.xyz / nearPoint.w);
+		float t = length(nearPoint.xyz / nearPoint.w - origin);
+		float far = min(length(farPoint.xyz / farPoint.w - origin), SDF_FAR);
+		int i = 0, chunk, steps = int(sdfCount.w);
+		bool inside = all(lessThan(pixel, viewportSize));
+		// the pixels of the other color of the board are left to the resolve
+		bool marched = inside && ((sdfCount.y & SDF_FLAG_CHECKERBOARD) == 0u ||
+			((pixel.x + pixel.y + int(frameIndex)) & 1) == 0);
+		bool active = marched, hit = false;
+
+		if (marched && sdfCount.z != 0u)
+			t = max(t, texelFetch(sdfConeDistances, pixel / int(sdfCount.z), 0).r);
+		for (chunk = 0; ; chunk++) {
+			int end = min(i + MARCH_CHUNK, steps);
+			for (; active && i < end; i++) {
+				float d = sdfMarch(origin + t * dir);
+				// the tolerance grows with the distance, like the pixel footprint
+				if (d < MARCH_EPSILON * t) {
+					hit = true;
+					break;
+				}
+				t += d;
+				if (t >= far)
+					break;
+			}
+			active = active && !hit && t < far && i < steps;
+			if (active)
+				atomicAdd(marching[chunk % 3], 1u);
+			barrier();
+			bool going = marching[chunk % 3] != 0u;
+			// everybody read the slot of the chunk before, it can be reused
+			if (first)
+				marching[(chunk + 2) % 3] = 0u;
+			if (!going)
+				break;
+		}
+
+		if (hit) {
+			vec3 p = origin + t * dir;
+			vec4 clip = viewProjection * vec4(p, 1.0);
+			imageStore(marchColor, pixel, sdfShade(p));
+			imageStore(marchDepth, pixel, vec4(0.5 + 0.5 * clip.z / clip.w));
+		}
+		// everybody is done with the shared state of this tile
+		barrier();
+	}
+}
@@ -1,10 +1,82 @@
 #version 150 core
+#extension GL_ARB_shader_storage_buffer_object : enable
 
-in vec4 v_clr;
+// Sphere tracing of the signed distance scene in the uniform block
+// SdfScene, see SdfScene.h. The ray of each pixel is unprojected with the
+// inverse view projection, and the depth of the hit is written, so the
+// scene composes with rasterized geometry.
+// Each pixel starts at the distance the cone pre-pass found free for its
+// tile (see SdfCone.h), so the steps through the empty space in front of
+// the scene are shared by the pixels of a tile.
+// With the checkerboard flag, only every other pixel is marched, the
+// others are reconstructed from the previous frame (see SdfTemporal.h),
+// which also takes the depth from the second output.
+// The field of SdfField.h needs storage buffers, hence the extension; the
+// scene without it does not.
+// The VOXELS variant marches the voxels of VoxelOctree.h instead, with
+// neither the cone pre-pass nor the checkerboard.
+#include "frame.glsl"
+#ifdef VOXELS
+#include "voxel_march.glsl"
+#else
+#include "sdf_march.glsl"
+
+uniform sampler2D sdfConeDistances;
+#endif
+
+in vec2 v_ndc;
 
 out vec4 color;
+out float sdfDepth;
 
 void main()
 {
-	color = v_clr;
+#ifndef VOXELS
+	// the pixels of the other color of the board are left to the resolve
+	if ((sdfCount.y & SDF_FLAG_CHECKERBOARD) != 0u &&
+		((int(gl_FragCoord.x) + int(gl_FragCoord.y) + int(frameIndex)) & 1) != 0)
+		discard;
+#endif
+
+	vec4 nearPoint = viewProjectionInverse * vec4(v_ndc, -1.0, 1.0);
+	vec4 farPoint = viewProjectionInverse * vec4(v_ndc, 1.0, 1.0);
+	vec3 origin = cameraPosition.xyz;
+	vec3 dir = normalize(farPoint.xyz / farPoint.w - nearPoint.xyz / nearPoint.w);
+	float t = length(nearPoint.xyz / nearPoint.w - origin), far = length(farPoint.xyz / farPoint.w - origin);
+	bool hit = false;
+
+#ifdef VOXELS
+	// the angle between the rays of neighboring pixels
+	float pixelAngle = max(length(dFdx(dir)), length(dFdy(dir)));
+	vec4 voxelColor;
+	voxelMarch(origin, dir, t, far, pixelAngle, hit, voxelColor);
+#else
+	int i, steps = int(sdfCount.w);
+
+	far = min(far, SDF_FAR);
+	if (sdfCount.z != 0u)
+		t = max(t, texelFetch(sdfConeDistances, ivec2(gl_FragCoord.xy) / int(sdfCount.z), 0).r);
+	for (i = 0; i < steps && t < far; i++) {
+		float d = sdfMarch(origin + t * dir);
+		// the tolerance grows with the distance, like the pixel footprint
+		if (d < MARCH_EPSILON * t) {
+			hit = true;
+			break;
+		}
+		t += d;
+	}
+#endif
+	if (!hit)
+		discard;
+
+	vec3 p = origin + t * dir;
+#ifdef VOXELS
+	color = voxelColor;
+#else
+	color = sdfShade(p);
+#endif
+
+	vec4 clip = viewProjection * vec4(p, 1.0);
+	gl_FragDepth = 0.5 + 0.5 * clip.z / clip.w;
+	sdfDepth = gl_FragDepth;
 }
@@ -1,15 +1,14 @@
 #version 150 core
 
-uniform mat4 modelView;
-uniform mat4 projection;
+// A single triangle covering the whole viewport, without any vertex
+// attributes: the corners (-1,-1), (3,-1) and (-1,3) come from the vertex
+// index. See SdfScene.h.
+#include "frame.glsl"
 
-in vec3 pos;
-in vec4 clr;
-
-out vec4 v_clr;
+out vec2 v_ndc;
 
 void main()
 {
-	v_clr = clr;
-	gl_Position = projection * modelView * vec4(pos, 1.0);
+	v_ndc = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);
+	gl_Position = vec4(v_ndc, 0.0, 1.0);
 }
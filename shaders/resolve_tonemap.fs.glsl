@@ -0,0 +1,26 @@
+#version 150 core
+
+// Resolves the samples of the multisampled scene and tonemaps them in the
+// same pass, instead of a blit followed by shaders/tonemap.fs.glsl, see
+// PostProcess.h. Each sample is tonemapped before they are averaged, so a
+// bright sample does not outweigh the others at an edge, which would alias
+// again after the tonemap.
+#include "tonemap.glsl"
+
+uniform sampler2DMS samples;
+uniform int sampleCount;
+
+out vec4 color;
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	vec3 b = bloomAt(gl_FragCoord.xy / vec2(textureSize(samples)));
+	float e = frameExposure();
+	vec3 sum = vec3(0.0);
+	int i;
+
+	for (i = 0; i < sampleCount; i++)
+		sum += tonemap(texelFetch(samples, pixel, i).rgb, b, e);
+	color = vec4(sum / float(sampleCount), 1.0);
+}
@@ -0,0 +1,208 @@
+// the signed distance scene, shared by the raymarching program and the
+// bake pass, see SdfScene.h and SdfBake.h, and the field of primitives with
+// its bounding volume hierarchy, see SdfField.h
+
+#define SDF_NODE_MAX 64	// as in SdfScene.h
+
+// primitives and operations, as in SdfScene.h
+#define SDF_SPHERE 0u
+#define SDF_BOX 1u
+#define SDF_TORUS 2u
+#define SDF_PLANE 3u
+#define SDF_CAPSULE 4u
+#define SDF_UNION 0u
+#define SDF_SUBTRACT 1u
+#define SDF_INTERSECT 2u
+#define SDF_SMOOTH_UNION 3u
+
+// the flags in sdfCount.y, as in SdfScene.h
+#define SDF_FLAG_BAKED 1u
+#define SDF_FLAG_CHECKERBOARD 2u
+#define SDF_FLAG_FIELD 4u
+
+#define SDF_FAR 100.0
+
+// GpuSdfNode in SdfScene.h
+struct SdfNode {
+	uint type;
+	uint op;
+	float blend;
+	uint pad;
+	vec4 position;
+	vec4 size;
+	vec4 color;
+};
+
+// SdfSceneUniforms in SdfScene.h
+layout(std140) uniform SdfScene {
+	uvec4 sdfCount;		// nodes, SDF_FLAG_*, cone tile size, march steps
+	vec4 sdfBakeMin;	// w: half a texel in texture coordinates
+	vec4 sdfBakeSize;	// w: size of a texel
+	SdfNode nodes[SDF_NODE_MAX];
+};
+
+#define SDF_BVH_STACK 64	// nodes pending in a query, as in SdfField.h
+
+// GpuSdfBvhNode in SdfField.h: the bounds, and in w the children as int
+// bits, or ~primitive in lo.w of a leaf
+struct SdfBvhNode {
+	vec4 lo;
+	vec4 hi;
+};
+
+// The field needs storage buffers, which the programs before GL 4.3 only
+// have with the extension enabled. The build pass declares them writable.
+#if __VERSION__ >= 430 || defined(GL_ARB_shader_storage_buffer_object)
+#define SDF_FIELD_SUPPORTED
+#ifndef SDF_FIELD_ACCESS
+#define SDF_FIELD_ACCESS readonly
+#endif
+
+// the primitives of the field where they are in this frame, SDF_FIELD_BINDING
+layout(std430) SDF_FIELD_ACCESS buffer SdfField {
+	uvec4 sdfFieldCount;	// primitives
+	SdfNode field[];
+};
+
+// SDF_BVH_BINDING, the root is node 0
+layout(std430) SDF_FIELD_ACCESS buffer SdfBvh {
+	SdfBvhNode bvh[];
+};
+#endif
+
+float sdfPrimitive(SdfNode n, vec3 p)
+{
+	vec3 q = p - n.position.xyz;
+	if (n.type == SDF_SPHERE)
+		return length(q) - n.size.x;
+	if (n.type == SDF_BOX) {
+		vec3 d = abs(q) - n.size.xyz + n.size.w;
+		return length(max(d, 0.0)) + min(max(d.x, max(d.y, d.z)), 0.0) - n.size.w;
+	}
+	if (n.type == SDF_TORUS)
+		return length(vec2(length(q.xz) - n.size.x, q.y)) - n.size.y;
+	if (n.type == SDF_PLANE)
+		return dot(p, n.size.xyz) + n.size.w;
+	// SDF_CAPSULE from position to size.xyz
+	vec3 ba = n.size.xyz - n.position.xyz;
+	float h = clamp(dot(q, ba) / dot(ba, ba), 0.0, 1.0);
+	return length(q - ba * h) - n.size.w;
+}
+
+// The distance of the nodes at p, and in nearest the index of the node
+// whose surface is closest.
+float sdfNodes(vec3 p, out int nearest)
+{
+	float d = SDF_FAR, closest = SDF_FAR;
+	int i;
+
+	nearest = 0;
+	for (i = 0; i < int(sdfCount.x); i++) {
+		SdfNode n = nodes[i];
+		float s = sdfPrimitive(n, p);
+		if (i == 0 || n.op == SDF_UNION) {
+			d = (i == 0) ? s : min(d, s);
+		} else if (n.op == SDF_SUBTRACT) {
+			d = max(d, -s);
+		} else if (n.op == SDF_INTERSECT) {
+			d = max(d, s);
+		} else {
+			float h = clamp(0.5 + 0.5 * (s - d) / max(n.blend, 1e-4), 0.0, 1.0);
+			d = mix(s, d, h) - n.blend * h * (1.0 - h);
+		}
+		if (abs(s) < closest) {
+			closest = abs(s);
+			nearest = i;
+		}
+	}
+	return d;
+}
+
+// How far p is outside of the box of n, 0 inside.
+float sdfBoxDistance(vec3 p, SdfBvhNode n)
+{
+	return length(max(max(n.lo.xyz - p, p - n.hi.xyz), 0.0));
+}
+
+// The union of the field with the distance bound at p. The primitives lie
+// inside the boxes of the hierarchy, so a subtree whose box is no nearer
+// than the closest primitive so far is skipped: only the primitives around
+// p are evaluated. If one of them is closer than bound, nearest becomes
+// SDF_NODE_MAX plus its index.
+float sdfField(vec3 p, float bound, inout int nearest)
+{
+#ifdef SDF_FIELD_SUPPORTED
+	if ((sdfCount.y & SDF_FLAG_FIELD) == 0u || sdfFieldCount.x == 0u)
+		return bound;
+
+	int stack[SDF_BVH_STACK];
+	float stackDistance[SDF_BVH_STACK];
+	int sp = 1;
+	float d = bound;
+
+	stack[0] = 0;
+	stackDistance[0] = 0.0;
+	while (sp > 0) {
+		sp--;
+		if (stackDistance[sp] >= d)
+			continue;
+		SdfBvhNode n = bvh[stack[sp]];
+		int left = floatBitsToInt(n.lo.w);
+		if (left < 0) {
+			float s = sdfPrimitive(field[~left], p);
+			if (s < d) {
+				d = s;
+				nearest = SDF_NODE_MAX + ~left;
+			}
+			continue;
+		}
+		if (sp + 2 > SDF_BVH_STACK)
+			break;
+		int right = floatBitsToInt(n.hi.w);
+		float dl = sdfBoxDistance(p, bvh[left]), dr = sdfBoxDistance(p, bvh[right]);
+		// the nearer child is taken first, it most likely shrinks d
+		bool leftFirst = dl < dr;
+		if (max(dl, dr) < d) {
+			stack[sp] = leftFirst ? right : left;
+			stackDistance[sp++] = max(dl, dr);
+		}
+		if (min(dl, dr) < d) {
+			stack[sp] = leftFirst ? left : right;
+			stackDistance[sp++] = min(dl, dr);
+		}
+	}
+	return d;
+#else
+	return bound;
+#endif
+}
+
+// The distance of the scene at p, the nodes and the field, and in nearest
+// the node or primitive whose surface is closest, see sdfColor().
+float sdfScene(vec3 p, out int nearest)
+{
+	float d = sdfNodes(p, nearest);
+	return sdfField(p, d, nearest);
+}
+
+vec3 sdfColor(int nearest)
+{
+#ifdef SDF_FIELD_SUPPORTED
+	if (nearest >= SDF_NODE_MAX)
+		return field[nearest - SDF_NODE_MAX].color.rgb;
+#endif
+	return nodes[nearest].color.rgb;
+}
+
+float sdfDistance(vec3 p)
+{
+	int nearest;
+	return sdfScene(p, nearest);
+}
+
+// The distance of the nodes alone, which is what the bake pass stores.
+float sdfNodesDistance(vec3 p)
+{
+	int nearest;
+	return sdfNodes(p, nearest);
+}
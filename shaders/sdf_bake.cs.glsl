@@ -0,0 +1,21 @@
+#version 430 core
+
+// Bakes one brick of the distance texture of the SDF scene, see
+// SdfBake.h. The distances are truncated, so a node only changes the
+// texels within the truncation distance of its surface and a change of
+// the scene only needs the bricks around it rebaked. The field of
+// SdfField.h is left out, it moves every frame.
+#include "sdf.glsl"
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+
+layout(r16f, binding = 0) writeonly uniform image3D distances;
+uniform ivec3 brickOrigin;	// first texel of the brick
+uniform float truncation;
+
+void main()
+{
+	ivec3 v = brickOrigin + ivec3(gl_GlobalInvocationID);
+	vec3 p = sdfBakeMin.xyz + (vec3(v) + 0.5) * sdfBakeSize.w;
+	imageStore(distances, v, vec4(clamp(sdfNodesDistance(p), -truncation, truncation)));
+}
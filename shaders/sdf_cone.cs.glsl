@@ -0,0 +1,49 @@
+#version 430 core
+
+// The cone pre-pass of the raymarching program, see SdfCone.h: one
+// invocation marches a cone from the camera which contains the rays of all
+// pixels of a tile, and stores how far all of them can skip. A step is
+// only as long as the sphere of the scene's distance still contains the
+// cone's cross section along it, so the whole cone up to the stored
+// distance is empty.
+#include "frame.glsl"
+#include "sdf_march.glsl"
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(r32f, binding = 0) writeonly uniform image2D coneDistances;
+uniform vec2 viewportSize;
+uniform int coneSteps;
+
+vec3 rayDirection(vec2 ndc)
+{
+	vec4 nearPoint = viewProjectionInverse * vec4(ndc, -1.0, 1.0);
+	vec4 farPoint = viewProjectionInverse * vec4(ndc, 1.0, 1.0);
+	return normalize(farPoint.xyz / farPoint.w - nearPoint.xyz / nearPoint.w);
+}
+
+void main()
+{
+	ivec2 tile = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(tile, imageSize(coneDistances))))
+		return;
+
+	vec2 lo = vec2(tile * int(sdfCount.z)) / viewportSize * 2.0 - 1.0;
+	vec2 hi = vec2((tile + 1) * int(sdfCount.z)) / viewportSize * 2.0 - 1.0;
+	vec3 origin = cameraPosition.xyz;
+	vec3 axis = rayDirection(0.5 * (lo + hi));
+	// at distance t, the rays of the tile are at most t * spread off the axis
+	float spread = max(max(distance(rayDirection(lo), axis), distance(rayDirection(hi), axis)),
+		max(distance(rayDirection(vec2(lo.x, hi.y)), axis), distance(rayDirection(vec2(hi.x, lo.y)), axis)));
+	float t = 0.0;
+	int i;
+
+	for (i = 0; i < coneSteps && t < SDF_FAR; i++) {
+		float room = sdfMarch(origin + t * axis) - t * spread;
+		if (room <= 0.0)
+			break;
+		// the rays move away from the axis while stepping along it
+		t += room / (1.0 + spread);
+	}
+	imageStore(coneDistances, tile, vec4(t));
+}
@@ -0,0 +1,276 @@
+#version 430 core
+
+// Builds the bounding volume hierarchy of the field of SdfField.h, a stage
+// per dispatch, as a linear BVH (Karras, "Maximizing Parallelism in the
+// Construction of BVHs, Octrees, and k-d Trees"): the primitives are moved
+// and bounded, sorted along a Morton curve through the bounds of their
+// centers, and the tree follows from the sorted codes alone, every inner
+// node independently of the others. The boxes are then filled in from the
+// leaves up, the second thread to arrive at a node computing it.
+// The n - 1 inner nodes come first, node 0 is the root, then the leaf of
+// each primitive, n - 1 + its index.
+#define SDF_FIELD_ACCESS coherent
+#include "frame.glsl"
+#include "sdf.glsl"
+
+#define GROUP 256	// SDF_FIELD_GROUP in SdfField.h
+
+// the stages, as in SdfField.h
+#define STAGE_BOUNDS 0
+#define STAGE_MORTON 1
+#define STAGE_SORT 2
+#define STAGE_SORT_LOCAL 3
+#define STAGE_HIERARCHY 4
+#define STAGE_REFIT 5
+
+layout(local_size_x = GROUP) in;
+
+// Morton code and primitive, sorted by both
+layout(std430, binding = 0) buffer SdfFieldKeys {
+	uvec2 keys[];
+};
+// the bounds of the centers as ordered uints, then the parent of each node
+layout(std430, binding = 1) coherent buffer SdfFieldWork {
+	uvec4 centerMin;
+	uvec4 centerMax;
+	int parents[];
+};
+// the children which arrived at each inner node
+layout(std430, binding = 2) coherent buffer SdfFieldVisits {
+	uint visits[];
+};
+// the primitives as they were added
+layout(std430, binding = 3) readonly buffer SdfFieldSource {
+	SdfNode source[];
+};
+
+uniform int stage;
+uniform int count;	// primitives
+uniform int padded;	// keys, a power of two
+uniform int sortK, sortJ;	// the bitonic merge
+
+shared uvec2 sorted[GROUP];
+
+// floats in an order of uints, so atomicMin and atomicMax compare them
+uint orderedBits(float f)
+{
+	uint u = floatBitsToUint(f);
+	return (u & 0x80000000u) != 0u ? ~u : (u | 0x80000000u);
+}
+
+float orderedFloat(uint u)
+{
+	return uintBitsToFloat((u & 0x80000000u) != 0u ? (u & 0x7fffffffu) : ~u);
+}
+
+// 10 bits spread out to every third bit
+uint spreadBits(uint v)
+{
+	v = (v * 0x00010001u) & 0xff0000ffu;
+	v = (v * 0x00000101u) & 0x0f00f00fu;
+	v = (v * 0x00000011u) & 0xc30c30c3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
+}
+
+bool greater(uvec2 a, uvec2 b)
+{
+	return a.x > b.x || (a.x == b.x && a.y > b.y);
+}
+
+// The length of the common prefix of the keys i and j, -1 outside; equal
+// codes are told apart by their position.
+int delta(int i, int j)
+{
+	if (j < 0 || j >= count)
+		return -1;
+	uint a = keys[i].x, b = keys[j].x;
+	if (a == b)
+		return 32 + 31 - findMSB(uint(i ^ j));
+	return 31 - findMSB(a ^ b);
+}
+
+void bounds(int i)
+{
+	// the motion: up and down by position.w, at the phase color.a
+	SdfNode n = source[i];
+	float offset = n.position.w * sin(time + n.color.a);
+	n.position.y += offset;
+	if (n.type == SDF_CAPSULE)
+		n.size.y += offset;
+	field[i] = n;
+
+	vec3 lo, hi;
+	if (n.type == SDF_SPHERE) {
+		lo = n.position.xyz - n.size.x;
+		hi = n.position.xyz + n.size.x;
+	} else if (n.type == SDF_BOX) {
+		lo = n.position.xyz - n.size.xyz;
+		hi = n.position.xyz + n.size.xyz;
+	} else if (n.type == SDF_TORUS) {
+		vec3 r = vec3(n.size.x + n.size.y, n.size.y, n.size.x + n.size.y);
+		lo = n.position.xyz - r;
+		hi = n.position.xyz + r;
+	} else if (n.type == SDF_CAPSULE) {
+		lo = min(n.position.xyz, n.size.xyz) - n.size.w;
+		hi = max(n.position.xyz, n.size.xyz) + n.size.w;
+	} else {
+		lo = vec3(-SDF_FAR);
+		hi = vec3(SDF_FAR);
+	}
+	int leaf = count - 1 + i;
+	bvh[leaf].lo = vec4(lo, intBitsToFloat(~i));
+	bvh[leaf].hi = vec4(hi, 0.0);
+
+	vec3 center = 0.5 * (lo + hi);
+	atomicMin(centerMin.x, orderedBits(center.x));
+	atomicMin(centerMin.y, orderedBits(center.y));
+	atomicMin(centerMin.z, orderedBits(center.z));
+	atomicMax(centerMax.x, orderedBits(center.x));
+	atomicMax(centerMax.y, orderedBits(center.y));
+	atomicMax(centerMax.z, orderedBits(center.z));
+}
+
+void morton(int i)
+{
+	if (i < count - 1)
+		visits[i] = 0u;
+	if (i == 0)
+		parents[0] = -1;	// the root, inner or, with one primitive, a leaf
+	if (i >= count) {
+		keys[i] = uvec2(0xffffffffu, uint(i));	// after all primitives
+		return;
+	}
+	vec3 lo = vec3(orderedFloat(centerMin.x), orderedFloat(centerMin.y), orderedFloat(centerMin.z));
+	vec3 hi = vec3(orderedFloat(centerMax.x), orderedFloat(centerMax.y), orderedFloat(centerMax.z));
+	int leaf = count - 1 + i;
+	vec3 center = 0.5 * (bvh[leaf].lo.xyz + bvh[leaf].hi.xyz);
+	uvec3 q = uvec3(clamp((center - lo) / max(hi - lo, vec3(1e-6)) * 1024.0, 0.0, 1023.0));
+	keys[i] = uvec2(spreadBits(q.x) * 4u + spreadBits(q.y) * 2u + spreadBits(q.z), uint(i));
+}
+
+// one compare and exchange step of the bitonic sort, across the groups
+void sortStep(int i)
+{
+	int l = i ^ sortJ;
+	if (l <= i)
+		return;
+	uvec2 a = keys[i], b = keys[l];
+	if (greater(a, b) == ((i & sortK) == 0)) {
+		keys[i] = b;
+		keys[l] = a;
+	}
+}
+
+// the steps of the bitonic sort within a group, in shared memory: with
+// sortK 0 all of them up to sorted runs of GROUP keys, otherwise those of
+// sortK from sortJ down
+void sortLocal()
+{
+	int local = int(gl_LocalInvocationID.x);
+	int i = int(gl_WorkGroupID.x) * GROUP + local;
+	int k = (sortK == 0) ? 2 : sortK, last = (sortK == 0) ? GROUP : sortK;
+
+	sorted[local] = keys[i];
+	barrier();
+	for (; k <= last; k <<= 1) {
+		for (int j = (sortK == 0) ? k >> 1 : sortJ; j > 0; j >>= 1) {
+			int l = local ^ j;
+			if (l > local) {
+				uvec2 a = sorted[local], b = sorted[l];
+				if (greater(a, b) == ((i & k) == 0)) {
+					sorted[local] = b;
+					sorted[l] = a;
+				}
+			}
+			barrier();
+		}
+	}
+	keys[i] = sorted[local];
+}
+
+// the children of inner node i, from the range of keys it covers
+void hierarchy(int i)
+{
+	int d = (delta(i, i + 1) - delta(i, i - 1)) >= 0 ? 1 : -1;
+	int minDelta = delta(i, i - d);
+
+	// the other end of the range, by doubling, then by halving
+	int lengthMax = 2;
+	while (delta(i, i + lengthMax * d) > minDelta)
+		lengthMax *= 2;
+	int range = 0;
+	for (int t = lengthMax >> 1; t > 0; t >>= 1) {
+		if (delta(i, i + (range + t) * d) > minDelta)
+			range += t;
+	}
+	int j = i + range * d;
+
+	// where the keys of the range stop sharing the prefix of the whole
+	int nodeDelta = delta(i, j), split = 0, t = range;
+	do {
+		t = (t + 1) >> 1;
+		if (delta(i, i + (split + t) * d) > nodeDelta)
+			split += t;
+	} while (t > 1);
+	int gamma = i + split * d + min(d, 0);
+
+	int left = (min(i, j) == gamma) ? count - 1 + int(keys[gamma].y) : gamma;
+	int right = (max(i, j) == gamma + 1) ? count - 1 + int(keys[gamma + 1].y) : gamma + 1;
+	bvh[i].lo.w = intBitsToFloat(left);
+	bvh[i].hi.w = intBitsToFloat(right);
+	parents[left] = i;
+	parents[right] = i;
+}
+
+// the boxes from the leaf of primitive i up, as far as this thread is the
+// second to arrive
+void refit(int i)
+{
+	int node = count - 1 + i;
+	for (;;) {
+		int p = parents[node];
+		if (p < 0)
+			break;
+		// the box of node is written before the other child may read it
+		memoryBarrierBuffer();
+		if (atomicAdd(visits[p], 1u) == 0u)
+			break;
+		SdfBvhNode n = bvh[p];
+		SdfBvhNode l = bvh[floatBitsToInt(n.lo.w)], r = bvh[floatBitsToInt(n.hi.w)];
+		bvh[p].lo.xyz = min(l.lo.xyz, r.lo.xyz);
+		bvh[p].hi.xyz = max(l.hi.xyz, r.hi.xyz);
+		node = p;
+	}
+}
+
+void main()
+{
+	int i = int(gl_GlobalInvocationID.x);
+
+	if (stage == STAGE_SORT_LOCAL) {
+		sortLocal();
+		return;
+	}
+	if (stage == STAGE_MORTON) {
+		if (i < padded)
+			morton(i);
+		return;
+	}
+	if (stage == STAGE_SORT) {
+		if (i < padded)
+			sortStep(i);
+		return;
+	}
+	if (stage == STAGE_HIERARCHY) {
+		if (i < count - 1)
+			hierarchy(i);
+		return;
+	}
+	if (i >= count)
+		return;
+	if (stage == STAGE_BOUNDS)
+		bounds(i);
+	else
+		refit(i);
+}
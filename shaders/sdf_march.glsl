@@ -0,0 +1,46 @@
+// marching through the signed distance scene and shading it, shared by
+// the raymarching program, the cone pre-pass and the compute raymarcher,
+// see SdfBake.h, SdfCone.h and SdfCompute.h
+#include "sdf.glsl"
+
+#define MARCH_EPSILON 0.001
+
+uniform sampler3D sdfDistances;
+
+// The distance of the scene at p, for marching. Once the scene is baked,
+// inside the baked volume this is a single fetch however many nodes there
+// are. Only near a surface, where the texels are too coarse, the nodes are
+// evaluated. The field moves, so it is not baked, but the fetched distance
+// bounds its query.
+float sdfMarch(vec3 p)
+{
+	if ((sdfCount.y & SDF_FLAG_BAKED) != 0u) {
+		vec3 uvw = (p - sdfBakeMin.xyz) / sdfBakeSize.xyz;
+		if (all(greaterThan(uvw, vec3(sdfBakeMin.w))) && all(lessThan(uvw, vec3(1.0 - sdfBakeMin.w)))) {
+			// filtering may overestimate the distance by up to a texel
+			float d = texture(sdfDistances, uvw).r - sdfBakeSize.w;
+			if (d > sdfBakeSize.w) {
+				int nearest;
+				return sdfField(p, d, nearest);
+			}
+		}
+	}
+	return sdfDistance(p);
+}
+
+vec3 sdfNormal(vec3 p)
+{
+	const vec2 e = vec2(0.5 * MARCH_EPSILON, -0.5 * MARCH_EPSILON);
+	return normalize(e.xyy * sdfDistance(p + e.xyy) + e.yyx * sdfDistance(p + e.yyx) +
+		e.yxy * sdfDistance(p + e.yxy) + e.xxx * sdfDistance(p + e.xxx));
+}
+
+// The color of the surface at p, lit by a directional light.
+vec4 sdfShade(vec3 p)
+{
+	int nearest;
+	vec3 light = normalize(vec3(0.6, 0.8, 0.4));
+	float diffuse = max(dot(sdfNormal(p), light), 0.0);
+	sdfScene(p, nearest);
+	return vec4(sdfColor(nearest) * (0.25 + 0.75 * diffuse), 1.0);
+}
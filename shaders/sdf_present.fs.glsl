@@ -0,0 +1,18 @@
+#version 150 core
+
+// Copies the resolved frame of the raymarching program, with its depth,
+// into the framebuffer, see SdfTemporal.h.
+uniform sampler2D historyColor;
+uniform sampler2D historyDepth;
+
+out vec4 color;
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(historyDepth, pixel, 0).r;
+	if (depth >= 1.0)
+		discard;
+	color = texelFetch(historyColor, pixel, 0);
+	gl_FragDepth = depth;
+}
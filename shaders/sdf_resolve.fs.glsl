@@ -0,0 +1,85 @@
+#version 150 core
+
+// The resolve of the checkerboard rendering of the raymarching program,
+// see SdfTemporal.h. The pixels marched this frame are taken as they are.
+// Each of the others was marched in the previous frame: its surface is
+// estimated from the closest of its four marched neighbours, projected
+// into the previous frame, and the color found there is used if the
+// previous frame saw the same surface there. Otherwise (a disocclusion, or
+// no history) the neighbours are averaged. The history is clamped to the
+// colors of the neighbours, which keeps stale colors from smearing.
+#include "frame.glsl"
+
+#define REPROJECT_TOLERANCE 0.02	// relative to the distance from the camera
+
+uniform sampler2D marchColor;
+uniform sampler2D marchDepth;
+uniform sampler2D historyColor;
+uniform sampler2D historyDepth;
+uniform mat4 previousViewProjection;
+uniform mat4 previousViewProjectionInverse;
+uniform int historyValid;
+
+in vec2 v_ndc;
+
+out vec4 color;
+out float sdfDepth;
+
+vec3 unproject(mat4 inverse, vec2 ndc, float depth)
+{
+	vec4 p = inverse * vec4(ndc, 2.0 * depth - 1.0, 1.0);
+	return p.xyz / p.w;
+}
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	if (((pixel.x + pixel.y + int(frameIndex)) & 1) == 0) {
+		color = texelFetch(marchColor, pixel, 0);
+		sdfDepth = texelFetch(marchDepth, pixel, 0).r;
+		return;
+	}
+
+	// the neighbours which hit the scene (alpha 1, misses were cleared)
+	const ivec2 offsets[4] = ivec2[4](ivec2(-1, 0), ivec2(1, 0), ivec2(0, -1), ivec2(0, 1));
+	ivec2 size = textureSize(marchColor, 0);
+	vec4 lo = vec4(1.0), hi = vec4(0.0), sum = vec4(0.0);
+	float depth = 1.0;
+	int i;
+	for (i = 0; i < 4; i++) {
+		ivec2 q = pixel + offsets[i];
+		if (any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, size)))
+			continue;
+		vec4 c = texelFetch(marchColor, q, 0);
+		lo = min(lo, c);
+		hi = max(hi, c);
+		if (c.a > 0.0) {
+			sum += c;
+			depth = min(depth, texelFetch(marchDepth, q, 0).r);
+		}
+	}
+	color = vec4(0.0);
+	sdfDepth = 1.0;
+	if (depth >= 1.0)
+		return;
+
+	vec3 p = unproject(viewProjectionInverse, v_ndc, depth);
+	if (historyValid != 0) {
+		vec4 clip = previousViewProjection * vec4(p, 1.0);
+		vec2 uv = 0.5 + 0.5 * clip.xy / clip.w;
+		if (clip.w > 0.0 && all(greaterThanEqual(uv, vec2(0.0))) && all(lessThan(uv, vec2(1.0)))) {
+			ivec2 h = ivec2(uv * vec2(size));
+			float d = texelFetch(historyDepth, h, 0).r;
+			vec3 q = unproject(previousViewProjectionInverse, (vec2(h) + 0.5) / vec2(size) * 2.0 - 1.0, d);
+			if (d < 1.0 && distance(p, q) < REPROJECT_TOLERANCE * distance(p, cameraPosition.xyz)) {
+				// the surface of the history, seen from this frame
+				vec4 current = viewProjection * vec4(q, 1.0);
+				color = clamp(texelFetch(historyColor, h, 0), lo, hi);
+				sdfDepth = 0.5 + 0.5 * current.z / current.w;
+				return;
+			}
+		}
+	}
+	color = sum / sum.a;
+	sdfDepth = depth;
+}
@@ -0,0 +1,73 @@
+#version 430 core
+
+// Fills the shading-rate image of ShadingRate.h from the previous frame. A
+// work group looks at the pixels of one texel of the image and half a texel
+// around it, where the edges may have moved since, and picks the palette
+// index by the contrast of their luminance: full rate at edges and in
+// textured regions, 2x2 where it is low and 4x4 where there is nothing to
+// see, like the sky and plain faces. The change of the mean luminance since
+// the frame before stands in for the velocity, and makes fast changing
+// regions one step coarser.
+
+#define GROUP 8
+#define RATE_FULL 0u
+#define RATE_2X2 1u
+#define RATE_4X4 2u
+#define CONTRAST_FULL 0.1
+#define CONTRAST_2X2 0.02
+#define CHANGE_COARSER 0.15
+#define LUMA_SCALE 1023.0
+
+layout(local_size_x = GROUP, local_size_y = GROUP) in;
+
+layout(r8ui, binding = 0) writeonly uniform uimage2D shadingRates;
+layout(r16f, binding = 1) uniform image2D tileLuma;
+uniform sampler2D previousColor;
+uniform ivec2 texelSize;
+uniform ivec2 viewportSize;
+uniform bool historyValid;
+
+shared uint lumaMin, lumaMax, lumaSum;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_WorkGroupID.xy);
+	bool first = gl_LocalInvocationIndex == 0u;
+
+	if (first) {
+		lumaMin = 0xffffffffu;
+		lumaMax = lumaSum = 0u;
+	}
+	barrier();
+
+	// each invocation takes 2x2 samples of its cell of the region
+	vec2 cell = 2.0 * vec2(texelSize) / float(GROUP);
+	vec2 origin = (vec2(texel) - 0.5) * vec2(texelSize) + vec2(gl_LocalInvocationID.xy) * cell;
+	uint lo = 0xffffffffu, hi = 0u, sum = 0u;
+	int i;
+	for (i = 0; i < 4; i++) {
+		vec2 pixel = origin + (vec2(i & 1, i >> 1) + 0.5) * 0.5 * cell;
+		vec3 c = textureLod(previousColor, pixel / vec2(viewportSize), 0.0).rgb;
+		uint l = uint(dot(c, vec3(0.2126, 0.7152, 0.0722)) * LUMA_SCALE + 0.5);
+		lo = min(lo, l);
+		hi = max(hi, l);
+		sum += l;
+	}
+	atomicMin(lumaMin, lo);
+	atomicMax(lumaMax, hi);
+	atomicAdd(lumaSum, sum);
+	barrier();
+	if (!first)
+		return;
+
+	float contrast = float(lumaMax - lumaMin) / LUMA_SCALE;
+	float mean = float(lumaSum) / (LUMA_SCALE * float(4 * GROUP * GROUP));
+	uint rate = contrast > CONTRAST_FULL ? RATE_FULL : (contrast > CONTRAST_2X2 ? RATE_2X2 : RATE_4X4);
+	// what the previous frame showed is unknown, e.g. after a resize
+	if (!historyValid)
+		rate = RATE_FULL;
+	else if (abs(mean - imageLoad(tileLuma, texel).r) > CHANGE_COARSER)
+		rate = min(rate + 1u, RATE_4X4);
+	imageStore(tileLuma, texel, vec4(mean));
+	imageStore(shadingRates, texel, uvec4(rate));
+}
@@ -0,0 +1,50 @@
+#version 430 core
+
+// Skins the characters of SkinnedCharacters in Skinning.h whose pose
+// changed, a thread per vertex and a row of groups per character: the
+// vertex of the rest pose is moved by the matrices of its two joints,
+// blended by its weight, and written where the character's vertices are
+// in the vertex buffer, which all passes then draw from.
+#define GROUP 64	// SKIN_GROUP in Skinning.h
+
+layout(local_size_x = GROUP) in;
+
+struct SkinVertex {
+	vec4 position;	// w: the weight of the second joint
+	uvec4 joints;	// x, y: the joints, z: the color
+};
+
+layout(std430, binding = 0) readonly buffer Rest {
+	SkinVertex rest[];
+};
+// the joints of each character to skin, one after the other
+layout(std430, binding = 1) readonly buffer Palette {
+	mat4 palette[];
+};
+// which characters those are
+layout(std430, binding = 2) readonly buffer List {
+	uint list[];
+};
+// Vertex of Cube.h: x, y, z and the color
+layout(std430, binding = 3) writeonly buffer Skinned {
+	uint skinned[];
+};
+
+uniform uvec4 counts;	// vertices and joints per character, the first entry of list
+
+void main()
+{
+	uint v = gl_GlobalInvocationID.x;
+	uint i = gl_WorkGroupID.y + counts.z;
+	if (v >= counts.x)
+		return;
+	SkinVertex s = rest[v];
+	uint first = i * counts.y;
+	mat4 m = palette[first + s.joints.x] * (1.0 - s.position.w) + palette[first + s.joints.y] * s.position.w;
+	vec3 p = (m * vec4(s.position.xyz, 1.0)).xyz;
+	uint dst = (list[i] * counts.x + v) * 4u;
+	skinned[dst] = floatBitsToUint(p.x);
+	skinned[dst + 1u] = floatBitsToUint(p.y);
+	skinned[dst + 2u] = floatBitsToUint(p.z);
+	skinned[dst + 3u] = s.joints.z;
+}
@@ -0,0 +1,154 @@
+#version 430 core
+
+// Builds the spatial hash grid of GpuSpatialGrid in SpatialGrid.h, a stage
+// per dispatch: a counting sort of the spheres by the slot of their cell.
+// Each sphere takes its rank within its slot from an atomic count, the
+// counts become the starts of the slots by a prefix sum, and each sphere
+// goes to the start of its slot plus its rank. The box of each slot is
+// then tested against the frustum, for the culling pass.
+#include "spatial_grid.glsl"
+
+#define GROUP 1024	// SPATIAL_GRID_GROUP in SpatialGrid.h
+
+// the stages, as in SpatialGrid.h
+#define STAGE_COUNT 0
+#define STAGE_SCAN 1
+#define STAGE_SCAN_GROUPS 2
+#define STAGE_ADD 3
+#define STAGE_SCATTER 4
+#define STAGE_CELLS 5
+
+layout(local_size_x = GROUP) in;
+
+// xyz: center, w: radius, as in shaders/cull.cs.glsl
+layout(std430, binding = 0) readonly buffer Spheres {
+	vec4 spheres[];
+};
+// per slot, 0 again once the starts are known
+layout(std430, binding = 1) buffer Counts {
+	uint counts[];
+};
+// slots + 1
+layout(std430, binding = 2) buffer Starts {
+	uint starts[];
+};
+layout(std430, binding = 3) buffer GroupSums {
+	uint groupSums[];
+};
+// slot and rank per sphere
+layout(std430, binding = 4) buffer Objects {
+	uvec2 objects[];
+};
+layout(std430, binding = 5) writeonly buffer Items {
+	uint items[];
+};
+layout(std430, binding = 6) buffer Sorted {
+	vec4 sorted[];
+};
+// SPATIAL_GRID_* per slot
+layout(std430, binding = 7) writeonly buffer States {
+	uint states[];
+};
+
+uniform int stage;
+uniform int count;	// spheres
+uniform int slots;	// a power of two, at most GROUP * GROUP
+uniform float invCellSize;
+// of the frustum, normals point inside
+uniform vec4 planes[6];
+uniform float radiusScale;
+
+shared uint scan[2][GROUP];
+
+// The sum of the values of the threads of the group before this one.
+uint groupExclusiveSum(uint value)
+{
+	uint local = gl_LocalInvocationID.x;
+	int from = 0;
+	scan[0][local] = value;
+	barrier();
+	// Hillis and Steele, between two halves of the shared memory
+	for (uint offset = 1u; offset < uint(GROUP); offset <<= 1) {
+		uint sum = scan[from][local];
+		if (local >= offset)
+			sum += scan[from][local - offset];
+		scan[1 - from][local] = sum;
+		from = 1 - from;
+		barrier();
+	}
+	return scan[from][local] - value;
+}
+
+void countSphere(int i)
+{
+	uint s = gridSlot(gridCell(spheres[i].xyz, invCellSize), slots);
+	objects[i] = uvec2(s, atomicAdd(counts[s], 1u));
+}
+
+// what the box of the spheres of slot s is to the frustum
+uint classify(int s)
+{
+	uint begin = starts[s], end = starts[s + 1];
+	if (begin == end)
+		return SPATIAL_GRID_OUTSIDE;
+	vec3 lo = vec3(1e30), hi = vec3(-1e30);
+	for (uint k = begin; k < end; k++) {
+		vec4 sphere = sorted[k];
+		float r = sphere.w * radiusScale;
+		lo = min(lo, sphere.xyz - r);
+		hi = max(hi, sphere.xyz + r);
+	}
+	vec3 center = 0.5 * (lo + hi), extent = 0.5 * (hi - lo);
+	uint state = SPATIAL_GRID_INSIDE;
+	for (int p = 0; p < 6; p++) {
+		float d = dot(planes[p].xyz, center) + planes[p].w;
+		float e = dot(abs(planes[p].xyz), extent);
+		if (d < -e)
+			return SPATIAL_GRID_OUTSIDE;
+		if (d < e)
+			state = SPATIAL_GRID_PARTIAL;
+	}
+	return state;
+}
+
+void main()
+{
+	int i = int(gl_GlobalInvocationID.x);
+
+	if (stage == STAGE_COUNT) {
+		if (i == 0)
+			starts[slots] = uint(count);
+		if (i < count)
+			countSphere(i);
+	} else if (stage == STAGE_SCAN) {
+		// all threads of a group take part in the barriers
+		uint value = 0u;
+		if (i < slots) {
+			value = counts[i];
+			counts[i] = 0u;
+		}
+		uint start = groupExclusiveSum(value);
+		if (i < slots)
+			starts[i] = start;
+		if (gl_LocalInvocationID.x == uint(GROUP - 1))
+			groupSums[gl_WorkGroupID.x] = start + value;
+	} else if (stage == STAGE_SCAN_GROUPS) {
+		int groups = (slots + GROUP - 1) / GROUP;
+		uint value = (i < groups) ? groupSums[i] : 0u;
+		uint start = groupExclusiveSum(value);
+		if (i < groups)
+			groupSums[i] = start;
+	} else if (stage == STAGE_ADD) {
+		if (i < slots)
+			starts[i] += groupSums[i / GROUP];
+	} else if (stage == STAGE_SCATTER) {
+		if (i < count) {
+			uvec2 o = objects[i];
+			uint k = starts[o.x] + o.y;
+			items[k] = uint(i);
+			sorted[k] = spheres[i];
+		}
+	} else if (i < slots) {
+		states[i] = classify(i);
+	}
+}
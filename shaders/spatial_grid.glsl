@@ -0,0 +1,28 @@
+// the spatial hash grid of SpatialGrid.h, shared by the pass which builds
+// it and those which read it: the cell of a point and the slot it is
+// hashed to. The objects of slot s are items[starts[s]] up to
+// items[starts[s + 1]], their spheres next to them in sorted[], so the
+// neighbours of a point are found in the slots of the cells around it,
+// skipping the objects whose cell is another one of the same slot.
+
+// what a slot is to the frustum, as in SpatialGrid.h
+#define SPATIAL_GRID_OUTSIDE 0u
+#define SPATIAL_GRID_PARTIAL 1u
+#define SPATIAL_GRID_INSIDE 2u
+
+// spatialGridHash in SpatialGrid.h
+uint gridHash(ivec3 c)
+{
+	return uint(c.x) * 73856093u + uint(c.y) * 19349663u + uint(c.z) * 83492791u;
+}
+
+ivec3 gridCell(vec3 p, float invCellSize)
+{
+	return ivec3(floor(p * invCellSize));
+}
+
+// slots is a power of two
+uint gridSlot(ivec3 c, int slots)
+{
+	return gridHash(c) & uint(slots - 1);
+}
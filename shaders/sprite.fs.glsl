@@ -0,0 +1,14 @@
+#version 150 core
+
+// The texels of the atlas times the color of the quad, see SpriteBatch.h.
+uniform sampler2DArray atlas;
+
+in vec3 v_texCoord;
+in vec4 v_color;
+
+out vec4 color;
+
+void main()
+{
+	color = v_color * texture(atlas, v_texCoord);
+}
@@ -0,0 +1,30 @@
+#version 150 core
+
+// The quads of the sprite batch, see SpriteBatch.h. There are no vertex
+// attributes: each quad is two texels of the buffer texture, six vertices
+// of two triangles, and the vertex finds its quad and corner by its ID.
+// The positions are in 1/16 pixels from the top left corner of the window,
+// the texture coordinates in texels of the atlas.
+uniform vec2 viewportSize;
+uniform float atlasScale;	// 1 / the size of a layer of the atlas
+uniform isamplerBuffer quads;
+
+out vec3 v_texCoord;
+out vec4 v_color;
+
+void main()
+{
+	int quad = gl_VertexID / 6, corner = gl_VertexID - 6 * quad;
+	ivec4 rect = texelFetch(quads, 2 * quad);
+	ivec4 tex = texelFetch(quads, 2 * quad + 1);
+	// the corners as (x0, y0), (x1, y0), (x0, y1), (x0, y1), (x1, y0), (x1, y1)
+	bool right = corner == 1 || corner == 4 || corner == 5;
+	bool bottom = corner == 2 || corner == 3 || corner == 5;
+	vec2 pos = vec2(right ? rect.z : rect.x, bottom ? rect.w : rect.y) * (1.0 / 16.0);
+	int u = (right ? tex.y : tex.x) & 0xffff;
+	int v = ((bottom ? tex.y : tex.x) >> 16) & 0xffff;
+	uint rgba = uint(tex.w);
+	v_texCoord = vec3(vec2(u, v) * atlasScale, float(tex.z));
+	v_color = vec4(uvec4(rgba >> 24, rgba >> 16, rgba >> 8, rgba) & 0xffu) * (1.0 / 255.0);
+	gl_Position = vec4(2.0 * pos.x / viewportSize.x - 1.0, 1.0 - 2.0 * pos.y / viewportSize.y, 0.0, 1.0);
+}
@@ -0,0 +1,51 @@
+#version 150 core
+#ifdef PULLED
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+// The cubes of the submission benchmark, see SubmitBench.h. Every strategy
+// draws the same cubes from the same positions (xyz: center, w: half the
+// side), which they read differently: one uniform per draw by default,
+// INSTANCED: a per-instance attribute, also for the multi-draw, whose
+// commands select it by their base instance, PULLED: no vertex attributes
+// at all, the corner comes from gl_VertexID and the position from a
+// storage block by gl_InstanceID.
+uniform mat4 benchViewProjection;
+
+#ifdef PULLED
+// at CUBE_INSTANCE_SSBO_BINDING, like the model matrices of cube.vs.glsl
+readonly buffer Instances {
+	vec4 instancePositions[];
+};
+
+// the indices of the cube, into its corners at bit 0 (x), 1 (y) and 2 (z)
+const int corners[36] = int[36](0, 3, 1, 0, 2, 3, 5, 6, 4, 5, 7, 6, 4, 2, 0, 4, 6, 2,
+	1, 7, 5, 1, 3, 7, 2, 7, 3, 2, 6, 7, 4, 1, 5, 4, 0, 1);
+#else
+in vec3 pos;
+#ifdef INSTANCED
+in vec4 instPosition;
+#else
+uniform vec4 objectPosition;
+#endif
+#endif
+
+out vec4 v_color;
+
+void main()
+{
+#ifdef PULLED
+	int c = corners[gl_VertexID];
+	vec3 corner = vec3(c & 1, (c >> 1) & 1, (c >> 2) & 1) * 2.0 - 1.0;
+	vec4 position = instancePositions[gl_InstanceID];
+#else
+	vec3 corner = pos;
+#ifdef INSTANCED
+	vec4 position = instPosition;
+#else
+	vec4 position = objectPosition;
+#endif
+#endif
+	v_color = vec4(corner * 0.5 + 0.5, 1.0);
+	gl_Position = benchViewProjection * vec4(position.xyz + corner * position.w, 1.0);
+}
@@ -0,0 +1,71 @@
+#version 150 core
+
+// Blends the jittered frame into the history, see TemporalAA.h. Each output
+// pixel takes the frame sample nearest to its center, weighted by how far
+// off the center it is, which only matters when the frame is smaller than
+// the output. The history is taken from where the sample was in the
+// previous frame and limited to the range of the samples around it, so
+// what was occluded or changed does not leave trails. The colors are
+// blended with weights of 1 / (1 + luma), so single bright samples of a
+// half float scene do not flicker.
+uniform sampler2D current;	// the frame, at its render size
+uniform sampler2D history;	// the previous result, at the output size
+uniform sampler2D velocity;	// in texture coordinates, x > 1 where none was drawn
+uniform sampler2D depth;	// of the frame
+uniform vec2 currentSize;	// in texels
+uniform vec2 outputSize;
+uniform vec2 jitter;		// of the frame, in its texels
+uniform mat4 reproject;		// from the clip space of the frame to that of the previous one
+uniform float blend;		// of the new sample, at the pixel center
+uniform bool historyValid;
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+float luma(vec3 c)
+{
+	return dot(c, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	// the sample centers of the frame are moved by the jitter
+	vec2 texel = uv * currentSize - 0.5 + jitter;
+	vec2 nearest = floor(texel + 0.5);
+	ivec2 p = ivec2(clamp(nearest, vec2(0.0), currentSize - 1.0));
+	ivec2 last = ivec2(currentSize) - 1;
+	vec3 c = texelFetch(current, p, 0).rgb;
+	vec3 lo = c, hi = c;
+	for (int y = -1; y <= 1; y++) {
+		for (int x = -1; x <= 1; x++) {
+			vec3 n = texelFetch(current, clamp(p + ivec2(x, y), ivec2(0), last), 0).rgb;
+			lo = min(lo, n);
+			hi = max(hi, n);
+		}
+	}
+
+	// where the sample was in the previous frame: drawn by the motion
+	// programs, or else from its depth with the previous camera
+	vec2 sampleUv = (nearest + 0.5 - jitter) / currentSize;
+	vec2 v = texelFetch(velocity, p, 0).xy;
+	if (v.x > 1.0) {
+		float z = texelFetch(depth, p, 0).r;
+		vec4 previous = reproject * vec4(2.0 * sampleUv - 1.0, 2.0 * z - 1.0, 1.0);
+		v = sampleUv - (0.5 + 0.5 * previous.xy / previous.w);
+	}
+	vec2 h = uv - v;
+
+	// the weight of the sample by its distance to the pixel center, in
+	// output pixels, a Gaussian of about half a pixel
+	vec2 d = (nearest - texel) * outputSize / currentSize;
+	float alpha = clamp(blend * exp(-2.29 * dot(d, d)), 0.0, 1.0);
+	if (!historyValid || any(lessThan(h, vec2(0.0))) || any(greaterThan(h, vec2(1.0))))
+		alpha = 1.0;
+	vec3 past = clamp(texture(history, h).rgb, lo, hi);
+
+	float wc = alpha / (1.0 + luma(c));
+	float wp = (1.0 - alpha) / (1.0 + luma(past));
+	color = vec4((c * wc + past * wp) / max(wc + wp, 1e-6), 1.0);
+}
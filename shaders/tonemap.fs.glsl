@@ -0,0 +1,17 @@
+#version 150 core
+
+// Maps the scene, rendered into a half float target, to the display, see
+// PostProcess.h and shaders/tonemap.glsl.
+#include "tonemap.glsl"
+
+uniform sampler2D source;
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	color = vec4(tonemap(texture(source, uv).rgb, bloomAt(uv), frameExposure()), 1.0);
+}
@@ -0,0 +1,34 @@
+// The tonemap of PostProcess.h, shared by shaders/tonemap.fs.glsl and
+// shaders/resolve_tonemap.fs.glsl. The colors of the shaders are taken as
+// sRGB encoded, so they are decoded, blended with the bloom, scaled by the
+// exposure, compressed with the filmic curve of ACES (in Krzysztof
+// Narkowicz's fit) and encoded again.
+uniform float exposure;		// set by hand, times the adapted one
+uniform sampler2D bloom;	// the top of the mip chain of the bloom, linear
+uniform vec2 bloomMix;		// weights of the scene and of the bloom, (1, 0) without it
+uniform sampler2D adaptedExposure;	// 1x1, of shaders/exposure.cs.glsl
+uniform bool autoExposure;
+
+vec3 aces(vec3 x)
+{
+	return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+// the exposure of this frame
+float frameExposure()
+{
+	return autoExposure ? exposure * texelFetch(adaptedExposure, ivec2(0), 0).r : exposure;
+}
+
+// the bloom at uv, scaled by its weight
+vec3 bloomAt(vec2 uv)
+{
+	return (bloomMix.y > 0.0) ? bloomMix.y * texture(bloom, uv).rgb : vec3(0.0);
+}
+
+// c is the scene color, b what bloomAt returned, e what frameExposure did
+vec3 tonemap(vec3 c, vec3 b, float e)
+{
+	c = pow(max(c, vec3(0.0)), vec3(2.2)) * bloomMix.x + b;
+	return pow(aces(c * e), vec3(1.0 / 2.2));
+}
@@ -0,0 +1,28 @@
+#version 150 core
+
+// Stretches the offscreen render target over the window, see
+// DynamicResolution.h. Bilinear filtering blurs what it enlarges, so an
+// unsharp mask restores the contrast. It is limited to the range of the
+// neighbouring texels, so it does not ring at edges.
+uniform sampler2D source;
+uniform vec2 sourceSize;	// in texels
+uniform float sharpness;
+
+in vec2 v_ndc;
+
+out vec4 color;
+
+void main()
+{
+	vec2 uv = 0.5 + 0.5 * v_ndc;
+	vec2 texel = 1.0 / sourceSize;
+	vec3 c = texture(source, uv).rgb;
+	vec3 n = texture(source, uv + vec2(0.0, texel.y)).rgb;
+	vec3 s = texture(source, uv - vec2(0.0, texel.y)).rgb;
+	vec3 e = texture(source, uv + vec2(texel.x, 0.0)).rgb;
+	vec3 w = texture(source, uv - vec2(texel.x, 0.0)).rgb;
+	vec3 lo = min(c, min(min(n, s), min(e, w)));
+	vec3 hi = max(c, max(max(n, s), max(e, w)));
+	vec3 sharp = c + sharpness * (c - 0.25 * (n + s + e + w));
+	color = vec4(clamp(sharp, lo, hi), 1.0);
+}
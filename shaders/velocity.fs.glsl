@@ -0,0 +1,14 @@
+#version 150 core
+
+// The velocity pass of TemporalAA.h, after shaders/cube.vs.glsl with
+// MOTION: how far the surface moved since the previous frame, in texture
+// coordinates of the frame.
+in vec4 v_current;
+in vec4 v_previous;
+
+out vec2 color;
+
+void main()
+{
+	color = 0.5 * (v_current.xy / v_current.w - v_previous.xy / v_previous.w);
+}
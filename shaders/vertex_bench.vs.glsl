@@ -0,0 +1,36 @@
+#version 150 core
+#ifdef PULLED
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+// The grid of the vertex format benchmark, see VertexBench.h. The positions
+// are in clip space already, from -1 to 1. Every attribute of a layout goes
+// into the color, so none of them is left unfetched; the attributes a
+// layout does not have read as (0, 0, 0, 1). PULLED: no vertex attributes,
+// the vertex of gl_VertexID, which is its index, is read from a storage
+// block of Vertex of Cube.h, 3 floats and RGBA8.
+#ifdef PULLED
+readonly buffer BenchVertices {
+	uvec4 benchVertices[];
+};
+#else
+in vec4 pos;
+in vec4 nrm;
+in vec4 clr;
+in vec2 tex;
+#endif
+
+out vec4 v_color;
+
+void main()
+{
+#ifdef PULLED
+	uvec4 v = benchVertices[gl_VertexID];
+	vec4 pos = vec4(uintBitsToFloat(v.xyz), 1.0);
+	vec4 clr = vec4((uvec4(v.w) >> uvec4(0u, 8u, 16u, 24u)) & 255u) / 255.0;
+	v_color = clr;
+#else
+	v_color = clr + 0.001 * vec4(nrm.xyz, tex.x + tex.y);
+#endif
+	gl_Position = vec4(0.9 * pos.xy, 0.5 * pos.z, 1.0);
+}
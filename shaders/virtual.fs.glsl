@@ -0,0 +1,56 @@
+#version 430 core
+
+// The materials from the virtual texture, see VirtualTexture.h: each
+// material has its own region of it, which is sampled no finer than the
+// pages committed around the sample, and the page at the level the sample
+// would like is reported to the CPU through the feedback buffer.
+#include "material.glsl"
+
+#define VT_LEVELS_MAX 16	// as in VirtualTexture.h
+#define VT_REGION_GRID 8u
+
+uniform sampler2D virtualTexture;
+uniform usampler2D virtualMinLod;	// per page of level 0
+
+layout(std140) uniform VirtualTexture {
+	uvec4 vtPages;		// pages of level 0 across and down, sparse levels, frame
+	uvec4 vtLevelOffset[VT_LEVELS_MAX / 4];	// of the first page of each level
+};
+
+// the frame each page was last wanted in, VT_FEEDBACK_BINDING
+layout(std430, binding = 5) buffer VirtualFeedback {
+	uint feedback[];
+};
+
+in vec4 v_clr;
+in vec3 v_pos;
+flat in uint v_material;
+
+out vec4 color;
+
+void main()
+{
+#ifdef DEPTH_ONLY
+	// the depth pre-pass, see RenderQueue.h
+	color = vec4(0.0);
+#else
+	uint region = v_material % (VT_REGION_GRID * VT_REGION_GRID);
+	vec2 uv = (vec2(region % VT_REGION_GRID, region / VT_REGION_GRID) + clamp(materialTexCoord(v_pos), 0.0, 1.0)) /
+		float(VT_REGION_GRID);
+	float lod = textureQueryLod(virtualTexture, uv).x;
+
+	// one pixel of each 4x4 block per frame reports the page it wants
+	uint wanted = uint(lod);
+	uvec2 pixel = uvec2(gl_FragCoord.xy) & 3u;
+	if (wanted < vtPages.z && pixel.x + 4u * pixel.y == (vtPages.w & 15u)) {
+		uvec2 n = max(vtPages.xy >> wanted, uvec2(1u));
+		uvec2 page = min(uvec2(uv * vec2(n)), n - 1u);
+		feedback[vtLevelOffset[wanted / 4u][wanted % 4u] + page.y * n.x + page.x] = vtPages.w;
+	}
+
+	uvec2 page0 = min(uvec2(uv * vec2(vtPages.xy)), vtPages.xy - 1u);
+	float minLod = float(texelFetch(virtualMinLod, ivec2(page0), 0).r);
+	vec4 texel = textureLod(virtualTexture, uv, max(lod, minLod));
+	color = texel * (0.5 + 0.5 * v_clr);
+#endif
+}
@@ -0,0 +1,104 @@
+// marching through the voxels of a VoxelWorld, stored as the bricks and
+// the occupancy levels of VoxelOctree.h, for the VOXELS variant of the
+// raymarching program
+
+#define VOXEL_BRICK 8		// VOXEL_OCTREE_BRICK
+#define VOXEL_UNIFORM 0x80000000u	// VOXEL_OCTREE_UNIFORM
+#define VOXEL_MARCH_STEPS 512
+#define VOXEL_MARCH_EPSILON 0.001
+
+// at VOXEL_OCTREE_SSBO_BINDING, the header is VoxelOctreeHeader
+readonly buffer VoxelOctree {
+	uvec4 voxelSize;	// bricks per side x, y, z, and the occupancy levels
+	vec4 voxelOrigin;	// world position of voxel 0, 0, 0
+	uint voxelLevels[8];	// offsets into voxelData: the brick grid, the occupancy levels
+	uint voxelColors[16];	// RGBA8 per type
+	uint voxelData[];
+};
+
+// the offsets of the mip levels in a brick, voxelOctreeMips
+const uint voxelMips[4] = uint[4](0u, 128u, 144u, 146u);
+
+uint voxelNode(int level, ivec3 n)
+{
+	uvec3 dims = (voxelSize.xyz + uvec3((1u << uint(level)) - 1u)) >> uint(level);
+	return voxelData[voxelLevels[level] + uint(n.x) + dims.x * (uint(n.y) + dims.y * uint(n.z))];
+}
+
+// The type of voxel v in the stored brick at entry, in mip level lod.
+uint voxelBrickType(uint entry, ivec3 v, int lod)
+{
+	int s = VOXEL_BRICK >> lod;
+	ivec3 c = (v & (VOXEL_BRICK - 1)) >> lod;
+	uint i = uint(c.x + s * (c.y + s * c.z));
+	return (voxelData[entry + voxelMips[lod] + (i >> 2u)] >> (8u * (i & 3u))) & 0xffu;
+}
+
+// March the ray from origin along dir, from t to far, which ends in the
+// first solid voxel (hit, and t and its color). Each step looks for the
+// coarsest empty node of the occupancy levels around the ray, and leaves
+// it at once: the empty space is crossed in few steps, the single voxels
+// only near a surface. pixelAngle is the angle of a pixel, inside the
+// bricks a ray reads the mip level whose voxels cover about a pixel.
+void voxelMarch(vec3 origin, vec3 dir, inout float t, float far, float pixelAngle, out bool hit, out vec4 color)
+{
+	vec3 ro = origin - voxelOrigin.xyz;
+	vec3 invDir = 1.0 / mix(dir, vec3(1e-8), lessThan(abs(dir), vec3(1e-8)));
+	vec3 extent = vec3(voxelSize.xyz * uint(VOXEL_BRICK));
+	int levels = int(voxelSize.w), axis = 0, i;
+
+	hit = false;
+	color = vec4(0.0);
+
+	// clip the ray to the grid
+	vec3 t0 = (vec3(0.0) - ro) * invDir, t1 = (extent - ro) * invDir;
+	vec3 tNear = min(t0, t1), tFar = max(t0, t1);
+	float enter = max(max(tNear.x, tNear.y), tNear.z);
+	far = min(far, min(min(tFar.x, tFar.y), tFar.z));
+	if (enter > t) {
+		t = enter;
+		axis = (tNear.x == enter) ? 0 : (tNear.y == enter) ? 1 : 2;
+	}
+
+	for (i = 0; i < VOXEL_MARCH_STEPS && t < far; i++) {
+		vec3 p = ro + (t + VOXEL_MARCH_EPSILON) * dir;
+		ivec3 v = clamp(ivec3(floor(p)), ivec3(0), ivec3(extent) - 1);
+		ivec3 b = v / VOXEL_BRICK;
+		int size = 0, l;
+		uint type = 0u;
+
+		// the coarsest empty node is skipped as a whole
+		for (l = levels; l > 0 && size == 0; l--)
+			if (voxelNode(l, b >> l) == 0u)
+				size = VOXEL_BRICK << l;
+		if (size == 0) {
+			uint entry = voxelNode(0, b);
+			if (entry == 0u) {
+				size = VOXEL_BRICK;
+			} else if ((entry & VOXEL_UNIFORM) != 0u) {
+				type = entry & 0xffu;
+			} else {
+				int lod = clamp(int(floor(log2(max(t * pixelAngle, 1.0)))), 0, 3);
+				type = voxelBrickType(entry, v, lod);
+				size = 1 << lod;
+			}
+		}
+		if (type != 0u) {
+			// the face the ray entered through, shaded like the meshes
+			const vec3 shades = vec3(0.8, 1.0, 0.65);
+			float shade = (axis == 1 && dir.y > 0.0) ? 0.5 : shades[axis];
+			uint c = voxelColors[type];
+			color = vec4(float(c & 0xffu), float((c >> 8u) & 0xffu), float((c >> 16u) & 0xffu), 255.0) / 255.0;
+			color.rgb *= shade;
+			hit = true;
+			return;
+		}
+
+		// leave the aligned cell of size around v
+		vec3 lo = vec3(v & ~(size - 1));
+		vec3 exits = (mix(lo, lo + float(size), greaterThan(dir, vec3(0.0))) - ro) * invDir;
+		float exit = min(min(exits.x, exits.y), exits.z);
+		axis = (exits.x == exit) ? 0 : (exits.y == exit) ? 1 : 2;
+		t = max(exit, t + VOXEL_MARCH_EPSILON);
+	}
+}
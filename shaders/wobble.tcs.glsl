@@ -0,0 +1,49 @@
+#version 400 core
+
+// Tessellation control of the wobbling cube, see Tessellation.h: each
+// triangle of shaders/cube.vs.glsl with TESSELLATED is a patch, and each
+// edge is split into as many segments as it is edgePixels long on screen,
+// so near cubes get a fine mesh for the wobble and far ones stay at their
+// triangles. An edge shared by two patches gets the same level from the
+// same corners, so the mesh has no cracks.
+layout(vertices = 3) out;
+
+uniform vec2 viewport;		// in pixels
+uniform float edgePixels;	// per segment
+
+in vec3 tc_pos[];
+in vec4 tc_clr[];
+in mat4 tc_transform[];
+
+out vec3 te_pos[];
+out vec4 te_clr[];
+patch out mat4 te_transform;
+
+#define MAX_LEVEL 64.0		// GL_MAX_TESS_GEN_LEVEL is at least that
+
+// the level of the edge from corner a to corner b
+float edgeLevel(int a, int b)
+{
+	vec4 pa = tc_transform[0] * vec4(tc_pos[a], 1.0);
+	vec4 pb = tc_transform[0] * vec4(tc_pos[b], 1.0);
+	// an edge through the camera plane is as long as it gets
+	if (pa.w <= 0.0 || pb.w <= 0.0)
+		return MAX_LEVEL;
+	float pixels = length((pa.xy / pa.w - pb.xy / pb.w) * 0.5 * viewport);
+	return clamp(pixels / edgePixels, 1.0, MAX_LEVEL);
+}
+
+void main()
+{
+	te_pos[gl_InvocationID] = tc_pos[gl_InvocationID];
+	te_clr[gl_InvocationID] = tc_clr[gl_InvocationID];
+	if (gl_InvocationID == 0) {
+		te_transform = tc_transform[0];
+		// outer level i belongs to the edge opposite corner i
+		float l0 = edgeLevel(1, 2), l1 = edgeLevel(2, 0), l2 = edgeLevel(0, 1);
+		gl_TessLevelOuter[0] = l0;
+		gl_TessLevelOuter[1] = l1;
+		gl_TessLevelOuter[2] = l2;
+		gl_TessLevelInner[0] = max(l0, max(l1, l2));
+	}
+}
@@ -0,0 +1,30 @@
+#version 400 core
+
+// Tessellation evaluation of the wobbling cube, see Tessellation.h: the
+// vertices of the subdivided patch are interpolated from its corners and
+// displaced like shaders/cube.vs.glsl does with WOBBLE, so the wobble is as
+// smooth as the patch is fine. The outputs are those cube.vs.glsl has for
+// shaders/cube.fs.glsl.
+layout(triangles, fractional_odd_spacing, ccw) in;
+
+#include "frame.glsl"
+
+in vec3 te_pos[];
+in vec4 te_clr[];
+patch in mat4 te_transform;
+
+out vec4 v_clr;
+#ifdef CUT
+out vec3 v_pos;
+#endif
+
+void main()
+{
+	vec3 pos = gl_TessCoord.x * te_pos[0] + gl_TessCoord.y * te_pos[1] + gl_TessCoord.z * te_pos[2];
+	v_clr = gl_TessCoord.x * te_clr[0] + gl_TessCoord.y * te_clr[1] + gl_TessCoord.z * te_clr[2];
+#ifdef CUT
+	v_pos = pos;
+#endif
+	vec3 new_pos = pos * (1.0 + 0.25*sin(pos.x+pos.y+pos.z+5.0*time));
+	gl_Position = te_transform * vec4(new_pos, 1.0);
+}